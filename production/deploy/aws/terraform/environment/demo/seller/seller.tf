@@ -57,11 +57,44 @@ module "seller" {
 
     ENABLE_AUCTION_SERVICE_BENCHMARK       = "" # Example: "false"
     GET_BID_RPC_TIMEOUT_MS                 = "" # Example: "60000"
+    GET_BID_HEDGE_DELAY_MS                 = "" # Example: "200"
+    GET_BID_DEADLINE_RESERVE_MS            = "" # Example: "100"
+    ENABLE_GET_BIDS_BATCHING               = "" # Example: "true"
+    SELLER_KV_MIN_WARM_CONNECTIONS         = "" # Example: "4"
+    SELLER_KV_REWARM_INTERVAL_MS           = "" # Example: "60000"
+    SELLER_KV_HEDGE_PERCENTILE             = "" # Example: "95"
+    AUCTION_GRPC_NUM_CHANNELS              = "" # Example: "4"
+    AUCTION_SERVER_ZONAL_HOSTS             = "" # Example: "us-east1-b=auction-b:50051,us-east1-c=auction-c:50051"
+    AUCTION_ZONE_SPILLOVER_RPCS            = "" # Example: "16"
+    AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS    = "" # Example: "5"
+    BUYER_GRPC_NUM_CHANNELS                = "" # Example: "4"
+    SFE_GRPC_KEEPALIVE_MS                  = "" # Example: "30000"
+    SFE_GRPC_STREAM_WINDOW_BYTES           = "" # Example: "1048576"
+    SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES  = "" # Example: "32768"
+    DEBUG_REPORTING_MAX_QUEUED_PINGS       = "" # Example: "10000"
+    DEBUG_REPORTING_MAX_PINGS_PER_HOST     = "" # Example: "16"
+    DEBUG_REPORTING_SAMPLING_PERCENT       = "" # Example: "100"
+    DEBUG_REPORTING_MAX_CONNECTIONS        = "" # Example: "64"
+    DEBUG_REPORTING_KV_PENDING_THRESHOLD   = "" # Example: "256"
+    SELLER_KV_MAX_KEYS_PER_REQUEST         = "" # Example: "100"
+    SELLER_KV_POST_KEYS                    = "" # Example: "false"
+    MAX_BIDS_PER_BUYER                     = "" # Example: "100"
+    MAX_BIDS_PER_AUCTION                   = "" # Example: "500"
+    SCORING_SIGNALS_CACHE_TTL_MS           = "" # Example: "60000"
+    BUYER_INPUT_COMPRESSION_DICTIONARY     = "" # Example: "<base64 encoded dictionary>"
+    SFE_BACKEND_PRECONNECT_TIMEOUT_MS      = "" # Example: "2000"
+    SFE_BACKEND_READY_PERCENT              = "" # Example: "80"
+    SFE_REQUEST_CAPTURE_PATH               = "" # Example: "/tmp/requests.corpus"
+    SFE_HTTP_INGRESS_PORT                  = "" # Example: "8080"
+    SFE_HTTP_INGRESS_THREADS               = "" # Example: "4"
+    GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK = "" # Example: "1000"
     KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS = "" # Example: "60000"
     SCORE_ADS_RPC_TIMEOUT_MS               = "" # Example: "60000"
     SELLER_ORIGIN_DOMAIN                   = "" # Example: "https://securepubads.g.doubleclick.net"
     AUCTION_SERVER_HOST                    = "" # Example: "dns:///auction.seller-frontend.com:443"
     KEY_VALUE_SIGNALS_HOST                 = "" # Example: "https://pubads.g.doubleclick.net/td/sts"
+    SELLER_TEE_KV_SERVER_ADDR              = "" # Example: "xds:///seller-kv-service-host"
+    SELLER_TEE_KV_SERVER_EGRESS_TLS        = "" # Example: "true"
     BUYER_SERVER_HOSTS                     = "" # Example: "{ \"https://bid1.com\": { \"url\": \"dns:///bidding1.com:443\", \"cloudPlatform\": \"AWS\" } }"
     SELLER_CLOUD_PLATFORMS_MAP             = "" # Example: "{ \"https://partner-seller1.com\": "GCP", \"https://partner-seller2.com\": "AWS"}"
     ENABLE_SELLER_FRONTEND_BENCHMARKING    = "" # Example: "false"
@@ -70,6 +103,23 @@ module "seller" {
     ENABLE_PROTECTED_APP_SIGNALS           = "" # Example: "false"
     ENABLE_PROTECTED_AUDIENCE              = "" # Example: "true"
     PS_VERBOSITY                           = "" # Example: "10"
+    REQUEST_PHASE_TRACING_PER_MILLE        = "" # Example: "10"
+    TRACE_SAMPLING_PER_MILLE               = "" # Example: "1"
+    ENABLE_PROFILING                       = "" # Example: "false"
+    PROFILING_INTERVAL_MS                  = "" # Example: "600000"
+    MEMORY_ADMISSION_HEAP_LIMIT_MB         = "" # Example: "0"
+    MEMORY_ADMISSION_REQUEST_SIZE_FACTOR   = "" # Example: "10"
+    GRPC_SERVER_NUM_CQS                    = "" # Example: "0"
+    GRPC_SERVER_MAX_POLLERS                = "" # Example: "0"
+    GRPC_SERVER_MAX_MEMORY_MB              = "" # Example: "0"
+    GRPC_SERVER_MAX_THREADS                = "" # Example: "0"
+    CPU_PLACEMENT                          = "" # Example: "roma=0-15;grpc=16-19;io=20-23"
+    DRAIN_HEALTH_CHECK_GRACE_MS            = "" # Example: "10000"
+    DRAIN_DEADLINE_MS                      = "" # Example: "30000"
+    KEY_WARM_UP_TIMEOUT_MS                 = "" # Example: "30000"
+    WORK_STEALING_EXECUTOR_WORKERS         = "" # Example: "16"
+    LARGE_BUFFER_POOL_MB                   = "" # Example: "256"
+    LARGE_BUFFER_HUGE_PAGES                = "" # Example: "thp"
     CREATE_NEW_EVENT_ENGINE                = "" # Example: "false"
     TELEMETRY_CONFIG                       = "" # Example: "mode: EXPERIMENT"
     ENABLE_OTEL_BASED_LOGGING              = "" # Example: "true"
@@ -99,7 +149,14 @@ module "seller" {
     JS_NUM_WORKERS                  = "" # Example: "48" Must be <=vCPUs in auction_enclave_cpu_count.
     JS_WORKER_QUEUE_LEN             = "" # Example: "100".
     ROMA_TIMEOUT_MS                 = "" # Example: "10000"
+    ROMA_BATCH_DEADLINE_MS = "" # Example: "0"
+    ENABLE_ROMA_ADMISSION_CONTROL = "" # Example: "false"
+    ROMA_MAX_BATCH_SIZE           = "" # Example: "32"
     ENABLE_REPORT_WIN_INPUT_NOISING = "" # Example: "true"
+    AUCTION_CONFIG_CACHE_SIZE       = "" # Example: "1000"
+    SCORE_AD_RESPONSE_PARSE_THREADS = "" # Example: "4"
+    SCORE_ADS_MAX_CHUNK_SIZE        = "" # Example: "8"
+    SCORE_ADS_OWNER_BUDGET_MS       = "" # Example: "50"
     # Reach out to the Privacy Sandbox B&A team to enroll with Coordinators and update the following flag values.
     # More information on enrollment can be found here: https://github.com/privacysandbox/fledge-docs/blob/main/bidding_auction_services_api.md#enroll-with-coordinators
     # Coordinator-based attestation flags:
@@ -126,5 +183,11 @@ module "seller" {
     AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES             = "10737418240"
     SFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND     = "4096"
     SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES                 = "10737418240"
+    TCMALLOC_TUNING_INTERVAL_MS                               = "" # Example: "10000"
+    TCMALLOC_TUNING_MIN_THREAD_CACHE_MB                       = "" # Example: "16"
+    TCMALLOC_TUNING_MAX_THREAD_CACHE_MB                       = "" # Example: "256"
+    TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND                 = "" # Example: "1"
+    TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND                 = "" # Example: "64"
+    ENABLE_PIPELINED_SCORING_SIGNALS_FETCH                    = "" # Example: "true"
   }
 }
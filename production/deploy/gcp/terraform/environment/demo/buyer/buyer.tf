@@ -58,18 +58,68 @@ module "buyer" {
 
     ENABLE_BIDDING_SERVICE_BENCHMARK              = "" # Example: "false"
     BUYER_KV_SERVER_ADDR                          = "" # Example: "https://googleads.g.doubleclick.net/td/bts"
+    BUYER_TEE_KV_SERVER_ADDR                      = "" # Example: "xds:///buyer-kv-service-host"
+    BUYER_TEE_KV_SERVER_EGRESS_TLS                = "" # Example: "true"
     TEE_AD_RETRIEVAL_KV_SERVER_ADDR               = "" # Example: "xds:///ad-retrieval-host"
     TEE_KV_SERVER_ADDR                            = "" # Example: "xds:///kv-service-host"
     AD_RETRIEVAL_TIMEOUT_MS                       = "" # Example: "60000"
+    ENABLE_PIPELINED_ADS_RETRIEVAL                = "" # Example: "false"
+    ADS_METADATA_CACHE_TTL_MS                     = "" # Example: "60000"
+    PREPARED_DATA_CACHE_TTL_MS                    = "" # Example: "10000"
     GENERATE_BID_TIMEOUT_MS                       = "" # Example: "60000"
     PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS = "" # Example: "60000"
     BIDDING_SIGNALS_LOAD_TIMEOUT_MS               = "" # Example: "60000"
     ENABLE_BUYER_FRONTEND_BENCHMARKING            = "" # Example: "false"
     CREATE_NEW_EVENT_ENGINE                       = "" # Example: "false"
+    BFE_HTTP_FETCHER_NUM_SHARDS                   = "" # Example: "4"
+    BUYER_KV_MIN_WARM_CONNECTIONS                 = "" # Example: "4"
+    BUYER_KV_REWARM_INTERVAL_MS                   = "" # Example: "60000"
+    ENABLE_BUYER_KV_REQUEST_COALESCING            = "" # Example: "false"
+    BUYER_KV_CACHE_TTL_MS                         = "" # Example: "2000"
+    BUYER_KV_CACHE_MAX_BYTES                      = "" # Example: "67108864"
+    BUYER_KV_BATCH_WINDOW_US                      = "" # Example: "500"
+    BUYER_KV_HEDGE_PERCENTILE                     = "" # Example: "95"
+    BIDDING_GRPC_NUM_CHANNELS                     = "" # Example: "4"
+    BIDDING_GRPC_KEEPALIVE_MS                     = "" # Example: "30000"
+    BIDDING_GRPC_STREAM_WINDOW_BYTES              = "" # Example: "1048576"
+    BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES     = "" # Example: "32768"
+    BIDDING_SERVER_ZONAL_ADDRS                    = "" # Example: "us-east1-b=bidding-b:50051,us-east1-c=bidding-c:50051"
+    BIDDING_ZONE_SPILLOVER_RPCS                   = "" # Example: "16"
+    BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS           = "" # Example: "5"
+    MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST = "" # Example: "200"
+    MAX_BIDS_PER_GET_BIDS_RESPONSE                = "" # Example: "100"
+    MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST      = "" # Example: "50"
+    INTEREST_GROUP_PRIORITY                       = "" # Example: "recency"
+    BFE_MAX_GET_BIDS_IN_FLIGHT                    = "" # Example: "1000"
+    BFE_GET_BIDS_PER_SELLER_QPS                   = "" # Example: "500"
+    BFE_SELLER_ADMISSION_WEIGHTS                  = "" # Example: "https://seller.com=2"
+    BFE_MIN_GET_BIDS_TIME_LEFT_MS                 = "" # Example: "50"
+    BFE_BACKEND_PRECONNECT_TIMEOUT_MS             = "" # Example: "2000"
+    BFE_BACKEND_READY_PERCENT                     = "" # Example: "80"
+    BFE_REQUEST_CAPTURE_PATH                      = "" # Example: "/tmp/requests.corpus"
+    PRUNE_TRUSTED_BIDDING_SIGNALS                 = "" # Example: "true"
+    SEND_INTEREST_GROUP_COLUMNS                   = "" # Example: "true"
     ENABLE_BIDDING_COMPRESSION                    = "" # Example: "true"
     ENABLE_PROTECTED_APP_SIGNALS                  = "" # Example: "false"
     ENABLE_PROTECTED_AUDIENCE                     = "" # Example: "true"
     PS_VERBOSITY                                  = "" # Example: "10"
+    REQUEST_PHASE_TRACING_PER_MILLE               = "" # Example: "10"
+    TRACE_SAMPLING_PER_MILLE                      = "" # Example: "1"
+    ENABLE_PROFILING                              = "" # Example: "false"
+    PROFILING_INTERVAL_MS                         = "" # Example: "600000"
+    MEMORY_ADMISSION_HEAP_LIMIT_MB                = "" # Example: "0"
+    MEMORY_ADMISSION_REQUEST_SIZE_FACTOR          = "" # Example: "10"
+    GRPC_SERVER_NUM_CQS                           = "" # Example: "0"
+    GRPC_SERVER_MAX_POLLERS                       = "" # Example: "0"
+    GRPC_SERVER_MAX_MEMORY_MB                     = "" # Example: "0"
+    GRPC_SERVER_MAX_THREADS                       = "" # Example: "0"
+    CPU_PLACEMENT                                 = "" # Example: "roma=0-15;grpc=16-19;io=20-23"
+    DRAIN_HEALTH_CHECK_GRACE_MS                   = "" # Example: "10000"
+    DRAIN_DEADLINE_MS                             = "" # Example: "30000"
+    KEY_WARM_UP_TIMEOUT_MS                        = "" # Example: "30000"
+    WORK_STEALING_EXECUTOR_WORKERS                = "" # Example: "16"
+    LARGE_BUFFER_POOL_MB                          = "" # Example: "256"
+    LARGE_BUFFER_HUGE_PAGES                       = "" # Example: "thp"
     # This flag should only be set if console.logs from the AdTech code(Ex:generateBid()) execution need to be exported as VLOG.
     # Note: turning on this flag will lead to higher memory consumption for AdTech code execution
     # and additional latency for parsing the logs.
@@ -91,6 +141,9 @@ module "buyer" {
     JS_NUM_WORKERS            = "" # Example: "64" Must be <=vCPUs in bidding_machine_type.
     JS_WORKER_QUEUE_LEN       = "" # Example: "200".
     ROMA_TIMEOUT_MS           = "" # Example: "10000"
+    ROMA_BATCH_DEADLINE_MS = "" # Example: "0"
+    ENABLE_ROMA_ADMISSION_CONTROL = "" # Example: "false"
+    ROMA_MAX_BATCH_SIZE           = "" # Example: "32"
     TELEMETRY_CONFIG          = "" # Example: "mode: EXPERIMENT"
     COLLECTOR_ENDPOINT        = "" # Example: "collector-buyer-1-${local.environment}.bfe-gcp.com:4317"
     ENABLE_OTEL_BASED_LOGGING = "" # Example: "false"
@@ -119,9 +172,14 @@ module "buyer" {
     MAX_ALLOWED_SIZE_DEBUG_URL_BYTES   = ""                      # Example: "65536"
     MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB = ""                      # Example: "3000"
 
-    INFERENCE_SIDECAR_BINARY_PATH = "" # Example: "/server/bin/inference_sidecar"
-    INFERENCE_MODEL_BUCKET_NAME   = "" # Example: "<bucket_name>"
-    INFERENCE_MODEL_BUCKET_PATHS  = "" # Example: "<model_path1>,<model_path2>"
+    INFERENCE_SIDECAR_BINARY_PATH   = "" # Example: "/server/bin/inference_sidecar"
+    INFERENCE_MODEL_BUCKET_NAME     = "" # Example: "<bucket_name>"
+    INFERENCE_MODEL_BUCKET_PATHS    = "" # Example: "<model_path1>,<model_path2>"
+    INFERENCE_SIDECAR_NUM_REPLICAS  = "" # Example: "2"
+    INFERENCE_SIDECAR_STANDBY       = "" # Example: "true"
+    INFERENCE_MODEL_FETCH_PERIOD_MS = "" # Example: "300000"
+    INFERENCE_CACHE_MAX_BYTES       = "" # Example: "67108864"
+    INFERENCE_CACHE_TTL_MS          = "" # Example: "60000"
 
     # TCMalloc related config parameters.
     # See: https://github.com/google/tcmalloc/blob/master/docs/tuning.md
@@ -129,6 +187,11 @@ module "buyer" {
     BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES             = "10737418240" # Example: 10737418240
     BFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND     = "4096"
     BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES                 = "10737418240"
+    TCMALLOC_TUNING_INTERVAL_MS                               = "" # Example: "10000"
+    TCMALLOC_TUNING_MIN_THREAD_CACHE_MB                       = "" # Example: "16"
+    TCMALLOC_TUNING_MAX_THREAD_CACHE_MB                       = "" # Example: "256"
+    TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND                 = "" # Example: "1"
+    TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND                 = "" # Example: "64"
   }
 
   # Please manually create a Google Cloud domain name, dns zone, and SSL certificate.
@@ -21,6 +21,9 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 constexpr char DispatchHandlerFunctionWithSellerWrapper[] =
     "scoreAdEntryFunction";
+// Scores a chunk of ads in one invocation, see BuildScoreAdsChunkRequest.
+constexpr char kScoreAdsBatchHandlerFunctionName[] =
+    "scoreAdsBatchEntryFunction";
 constexpr char kNoTrustedScoringSignals[] = "Empty trusted scoring signals";
 constexpr char kAdComponentRenderUrlsProperty[] = "adComponentRenderUrls";
 constexpr char kRenderUrlsPropertyForKVResponse[] = "renderUrls";
@@ -40,6 +43,8 @@ constexpr char kAdMetadataForComponentAuction[] = "ad";
 constexpr char kModifiedBidForComponentAuction[] = "bid";
 constexpr char kIncomingBidInSellerCurrency[] = "incomingBidInSellerCurrency";
 constexpr char kDebugReportUrlsPropertyForScoreAd[] = "debugReportUrls";
+// Prefix of the records of the output of scoreAd, see ParseScoreAdRecord.
+constexpr char kScoreAdRecordPrefix[] = "psScore1|";
 constexpr char kScoreAdBlobVersion[] = "v1";
 constexpr char kIGOwnerPropertyForScoreAd[] = "interestGroupOwner";
 constexpr char kTopWindowHostnamePropertyForScoreAd[] = "topWindowHostname";
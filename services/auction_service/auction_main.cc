@@ -12,9 +12,11 @@
 //  See the License for the specific language governing permissions and
 //  limitations under the License.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -41,12 +43,23 @@
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/runtime_flags.h"
 #include "services/auction_service/seller_code_fetch_manager.h"
+#include "services/auction_service/utils/auction_config_cache.h"
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/concurrent/work_stealing_executor.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/cpu_placement.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/large_buffer_pool.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/request_phase_tracer.h"
+#include "services/common/util/server_drain.h"
+#include "services/common/util/startup_tasks.h"
 #include "services/common/util/tcmalloc_utils.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
@@ -85,6 +98,29 @@ ABSL_FLAG(std::optional<int64_t>, auction_tcmalloc_max_total_thread_cache_bytes,
           std::nullopt,
           "Maximum amount of cached memory in bytes across all threads (or "
           "logical CPUs)");
+ABSL_FLAG(std::optional<int64_t>, auction_config_cache_size, std::nullopt,
+          "Max number of serialized auction configs cached across requests. "
+          "Caching is disabled when 0 (default).");
+ABSL_FLAG(std::optional<int64_t>, score_ad_response_parse_threads, std::nullopt,
+          "Number of parallel tasks on the server executor used to parse the "
+          "scoreAd responses of large batches. Responses are parsed "
+          "sequentially when 1 (default).");
+ABSL_FLAG(std::optional<bool>, enable_roma_admission_control, false,
+          "Sheds or truncates scoreAd batches before they reach Roma when "
+          "they are not predicted to run within ROMA_TIMEOUT_MS, and keeps "
+          "part of the Roma capacity for reporting.");
+ABSL_FLAG(std::optional<int>, roma_max_batch_size, 0,
+          "Splits the scoreAd batches larger than this into sub-batches of "
+          "this size, which take turns in Roma with those of the other "
+          "batches. Batches are not split if 0.");
+ABSL_FLAG(std::optional<int>, score_ads_max_chunk_size, 0,
+          "Most ads scored by a single scoreAd invocation, which amortizes "
+          "the cost of an invocation over the ads of a chunk. Ads are scored "
+          "one by one if 1 or less.");
+ABSL_FLAG(std::optional<int>, score_ads_owner_budget_ms, 0,
+          "Most time the scoreAd invocations of the ads of an interest group "
+          "owner may run for in a request before its ads are left out of the "
+          "auction. Owners have no budget if 0.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -95,6 +131,10 @@ using ::google::scp::cpio::LogOption;
 using ::grpc::Server;
 using ::grpc::ServerBuilder;
 
+// Connections the reporting fetcher may open, so that reporting bursts do not
+// compete with the UDF fetches for sockets.
+inline constexpr int kReportingMaxConnections = 64;
+
 absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
     absl::string_view config_param_prefix) {
   TrustedServersConfigClient config_client(GetServiceFlags());
@@ -104,6 +144,7 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         ENABLE_AUCTION_SERVICE_BENCHMARK);
   config_client.SetFlag(FLAGS_test_mode, TEST_MODE);
   config_client.SetFlag(FLAGS_roma_timeout_ms, ROMA_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_roma_batch_deadline_ms, ROMA_BATCH_DEADLINE_MS);
   config_client.SetFlag(FLAGS_public_key_endpoint, PUBLIC_KEY_ENDPOINT);
   config_client.SetFlag(FLAGS_primary_coordinator_private_key_endpoint,
                         PRIMARY_COORDINATOR_PRIVATE_KEY_ENDPOINT);
@@ -143,6 +184,41 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_enable_protected_app_signals,
                         ENABLE_PROTECTED_APP_SIGNALS);
   config_client.SetFlag(FLAGS_ps_verbosity, PS_VERBOSITY);
+  config_client.SetFlag(FLAGS_request_phase_tracing_per_mille,
+                        REQUEST_PHASE_TRACING_PER_MILLE);
+  config_client.SetFlag(FLAGS_trace_sampling_per_mille,
+                        TRACE_SAMPLING_PER_MILLE);
+  config_client.SetFlag(FLAGS_enable_profiling, ENABLE_PROFILING);
+  config_client.SetFlag(FLAGS_profiling_interval_ms, PROFILING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_memory_admission_heap_limit_mb,
+                        MEMORY_ADMISSION_HEAP_LIMIT_MB);
+  config_client.SetFlag(FLAGS_memory_admission_request_size_factor,
+                        MEMORY_ADMISSION_REQUEST_SIZE_FACTOR);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_server_max_pollers, GRPC_SERVER_MAX_POLLERS);
+  config_client.SetFlag(FLAGS_grpc_server_max_memory_mb,
+                        GRPC_SERVER_MAX_MEMORY_MB);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads, GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_cpu_placement, CPU_PLACEMENT);
+  config_client.SetFlag(FLAGS_drain_health_check_grace_ms,
+                        DRAIN_HEALTH_CHECK_GRACE_MS);
+  config_client.SetFlag(FLAGS_drain_deadline_ms, DRAIN_DEADLINE_MS);
+  config_client.SetFlag(FLAGS_key_warm_up_timeout_ms, KEY_WARM_UP_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_work_stealing_executor_workers,
+                        WORK_STEALING_EXECUTOR_WORKERS);
+  config_client.SetFlag(FLAGS_large_buffer_pool_mb, LARGE_BUFFER_POOL_MB);
+  config_client.SetFlag(FLAGS_large_buffer_huge_pages,
+                        LARGE_BUFFER_HUGE_PAGES);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_interval_ms,
+                        TCMALLOC_TUNING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_thread_cache_mb,
+                        TCMALLOC_TUNING_MIN_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_thread_cache_mb,
+                        TCMALLOC_TUNING_MAX_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_release_mb_per_second,
+                        TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_release_mb_per_second,
+                        TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND);
   config_client.SetFlag(FLAGS_max_allowed_size_debug_url_bytes,
                         MAX_ALLOWED_SIZE_DEBUG_URL_BYTES);
   config_client.SetFlag(FLAGS_max_allowed_size_all_debug_urls_kb,
@@ -152,6 +228,17 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
       AUCTION_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND);
   config_client.SetFlag(FLAGS_auction_tcmalloc_max_total_thread_cache_bytes,
                         AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES);
+  config_client.SetFlag(FLAGS_auction_config_cache_size,
+                        AUCTION_CONFIG_CACHE_SIZE);
+  config_client.SetFlag(FLAGS_score_ad_response_parse_threads,
+                        SCORE_AD_RESPONSE_PARSE_THREADS);
+  config_client.SetFlag(FLAGS_enable_roma_admission_control,
+                        ENABLE_ROMA_ADMISSION_CONTROL);
+  config_client.SetFlag(FLAGS_roma_max_batch_size, ROMA_MAX_BATCH_SIZE);
+  config_client.SetFlag(FLAGS_score_ads_max_chunk_size,
+                        SCORE_ADS_MAX_CHUNK_SIZE);
+  config_client.SetFlag(FLAGS_score_ads_owner_budget_ms,
+                        SCORE_ADS_OWNER_BUDGET_MS);
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
         << "Config client failed to initialize.";
@@ -159,6 +246,16 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   // Set verbosity
   server_common::log::PS_VLOG_IS_ON(
       0, config_client.GetIntParameter(PS_VERBOSITY));
+  RequestPhaseTracer::SetSamplingPerMille(
+      config_client.GetIntParameter(REQUEST_PHASE_TRACING_PER_MILLE));
+  RequestTrace::SetSamplingPerMille(
+      config_client.GetIntParameter(TRACE_SAMPLING_PER_MILLE));
+  MemoryAdmissionController::Get().Configure(
+      {.heap_limit_bytes =
+           config_client.GetInt64Parameter(MEMORY_ADMISSION_HEAP_LIMIT_MB) *
+           1024 * 1024,
+       .request_size_factor = config_client.GetIntParameter(
+           MEMORY_ADMISSION_REQUEST_SIZE_FACTOR)});
 
   PS_LOG(INFO) << "Protected App Signals support enabled on the service: "
                << config_client.GetBooleanParameter(
@@ -167,16 +264,47 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   return config_client;
 }
 
+// Admission control in front of Roma, if enabled. Scoring and reporting each
+// keep a share of the capacity, so that reporting of finished auctions is not
+// starved by the scoring of new ones.
+std::optional<RomaAdmissionConfig> GetRomaAdmissionConfig(
+    const TrustedServersConfigClient& config_client) {
+  if (!config_client.GetBooleanParameter(ENABLE_ROMA_ADMISSION_CONTROL)) {
+    return std::nullopt;
+  }
+  const int num_workers = config_client.GetIntParameter(JS_NUM_WORKERS);
+  const int queue_len = config_client.GetIntParameter(JS_WORKER_QUEUE_LEN);
+  if (num_workers <= 0 || queue_len <= 0) {
+    PS_LOG(WARNING) << "Roma admission control needs JS_NUM_WORKERS and "
+                       "JS_WORKER_QUEUE_LEN to be set, it is disabled.";
+    return std::nullopt;
+  }
+  return RomaAdmissionConfig{.num_workers = num_workers,
+                             .capacity = num_workers * (queue_len + 1),
+                             .reserved_shares = {0.5, 0, 0.2}};
+}
+
 // Brings up the gRPC AuctionService on FLAGS_port.
 absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_ASSIGN_OR_RETURN(
+      const CpuPlacement cpu_placement,
+      ParseCpuPlacement(config_client.GetStringParameter(CPU_PLACEMENT)));
 
   MaySetBackgroundReleaseRate(config_client.GetInt64Parameter(
       AUCTION_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND));
   MaySetMaxTotalThreadCacheBytes(config_client.GetInt64Parameter(
       AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES));
+  PS_ASSIGN_OR_RETURN(const HugePages large_buffer_huge_pages,
+                      ParseHugePages(config_client.GetStringParameter(
+                          LARGE_BUFFER_HUGE_PAGES)));
+  LargeBufferPool::Configure(
+      {.huge_pages = large_buffer_huge_pages,
+       .max_pooled_bytes = static_cast<size_t>(config_client.GetInt64Parameter(
+                               LARGE_BUFFER_POOL_MB)) *
+                           1024 * 1024});
 
   std::string_view port = config_client.GetStringParameter(PORT);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
@@ -190,15 +318,40 @@ absl::Status RunServer() {
         config_client.GetIntParameter(JS_WORKER_QUEUE_LEN);
     config.number_of_workers = config_client.GetIntParameter(JS_NUM_WORKERS);
     return config;
-  }());
-  CodeDispatchClient client(dispatcher);
-
-  PS_RETURN_IF_ERROR(dispatcher.Init()) << "Could not start code dispatcher.";
+  }(),
+  GetRomaAdmissionConfig(config_client));
+  dispatcher.SplitBatchesOver(
+      config_client.GetIntParameter(ROMA_MAX_BATCH_SIZE));
+
+  // The slow steps of the startup run concurrently, as soon as the steps they
+  // need are done. The server starts, and so reports itself as serving, once
+  // all of them are done.
+  StartupTasks startup;
+  startup.Run("Roma", {}, [&dispatcher, &cpu_placement]() -> absl::Status {
+    // Roma forks its worker processes from this thread.
+    ScopedCpuPlacement roma_placement("Roma workers", cpu_placement.roma_cpus);
+    PS_RETURN_IF_ERROR(dispatcher.Init()) << "Could not start code dispatcher.";
+    return absl::OkStatus();
+  });
 
   server_common::GrpcInit gprc_init;
-  std::unique_ptr<server_common::Executor> executor =
-      std::make_unique<server_common::EventEngineExecutor>(
+  std::unique_ptr<server_common::Executor> executor;
+  {
+    // The event engine starts its thread pool, which runs the I/O loops and
+    // their callbacks, as do the workers of a work-stealing executor.
+    ScopedCpuPlacement io_placement("I/O loops", cpu_placement.io_cpus);
+    if (const int work_stealing_executor_workers =
+            config_client.GetIntParameter(WORK_STEALING_EXECUTOR_WORKERS);
+        work_stealing_executor_workers > 0) {
+      executor = std::make_unique<WorkStealingExecutor>(
+          WorkStealingExecutorOptions{.num_workers =
+                                          work_stealing_executor_workers});
+    } else {
+      executor = std::make_unique<server_common::EventEngineExecutor>(
           grpc_event_engine::experimental::CreateEventEngine());
+    }
+  }
+  CodeDispatchClient client(dispatcher, executor.get());
 
   // Convert Json string into a AuctionCodeBlobFetcherConfig proto
   auction_service::SellerCodeFetchConfig code_fetch_proto;
@@ -208,6 +361,12 @@ absl::Status RunServer() {
   CHECK(result.ok()) << "Could not parse SELLER_CODE_FETCH_CONFIG JsonString "
                         "to a proto message: "
                      << result;
+  PS_ASSIGN_OR_RETURN(
+      std::vector<DispatchRequest> warm_up_samples,
+      BuildWarmUpSamples(DispatchHandlerFunctionWithSellerWrapper,
+                         code_fetch_proto.score_ad_warm_up_inputs()));
+  dispatcher.WarmUpAfterLoads(std::move(warm_up_samples),
+                              code_fetch_proto.warm_up_rounds());
 
   bool enable_seller_debug_url_generation =
       code_fetch_proto.enable_seller_debug_url_generation();
@@ -228,21 +387,47 @@ absl::Status RunServer() {
       BlobStorageClientFactory::Create(), executor.get(), seller_udf_fetcher,
       buyer_reporting_udf_fetcher, &dispatcher, code_fetch_proto,
       enable_protected_app_signals);
-  PS_RETURN_IF_ERROR(code_fetch_manager.Init())
-      << "Failed to initialize UDF fetch.";
+  // The code is loaded into the Roma workers.
+  startup.Run("UDF fetch", {"Roma"}, [&code_fetch_manager]() -> absl::Status {
+    PS_RETURN_IF_ERROR(code_fetch_manager.Init())
+        << "Failed to initialize UDF fetch.";
+    return absl::OkStatus();
+  });
 
   bool enable_auction_service_benchmark =
       config_client.GetBooleanParameter(ENABLE_AUCTION_SERVICE_BENCHMARK);
 
   InitTelemetry<ScoreAdsRequest>(config_util, config_client, metric::kAs);
+  metric::AuctionContextMap()->AddObserverable(metric::kRomaQueueDepth,
+                                               V8Dispatcher::GetQueueDepth);
+  metric::AuctionContextMap()->AddObserverable(
+      metric::kRomaWarmUpLatency, V8Dispatcher::GetWarmUpLatency);
+  metric::AuctionContextMap()->AddObserverable(
+      metric::kRomaPayloadSize, V8Dispatcher::GetPayloadSizeBytes);
+  std::unique_ptr<ProfilingService> profiling_service =
+      MayStartProfiling(config_client);
+  std::unique_ptr<TcmallocTuner> tcmalloc_tuner =
+      MayStartTcmallocTuning(config_client);
 
   // TODO(b/334909636) : AsyncReporter should not own HttpFetcher,
   // this needs to be decoupled so we can test different configurations.
   std::unique_ptr<AsyncReporter> async_reporter =
       std::make_unique<AsyncReporter>(
-          std::make_unique<MultiCurlHttpFetcherAsync>(executor.get()));
+          std::make_unique<MultiCurlHttpFetcherAsync>(
+              executor.get(),
+              HttpFetcherLaneOptions{
+                  .priority = HttpFetcherPriority::kLow,
+                  .max_connections = kReportingMaxConnections}));
+  std::unique_ptr<AuctionConfigCache> auction_config_cache;
+  if (const int64_t auction_config_cache_size =
+          config_client.GetInt64Parameter(AUCTION_CONFIG_CACHE_SIZE);
+      auction_config_cache_size > 0) {
+    auction_config_cache =
+        std::make_unique<AuctionConfigCache>(auction_config_cache_size);
+  }
   auto score_ads_reactor_factory =
-      [&client, &async_reporter, enable_auction_service_benchmark](
+      [&client, &async_reporter, &auction_config_cache,
+       enable_auction_service_benchmark](
           const ScoreAdsRequest* request, ScoreAdsResponse* response,
           server_common::KeyFetcherManagerInterface* key_fetcher_manager,
           CryptoClientWrapperInterface* crypto_client,
@@ -257,7 +442,7 @@ absl::Status RunServer() {
         return std::make_unique<ScoreAdsReactor>(
             client, request, response, std::move(benchmarkingLogger),
             key_fetcher_manager, crypto_client, async_reporter.get(),
-            runtime_config);
+            runtime_config, auction_config_cache.get());
       };
 
   std::string default_code_version =
@@ -269,6 +454,8 @@ absl::Status RunServer() {
       .enable_seller_debug_url_generation = enable_seller_debug_url_generation,
       .roma_timeout_ms =
           config_client.GetStringParameter(ROMA_TIMEOUT_MS).data(),
+      .roma_batch_deadline_ms =
+          config_client.GetIntParameter(ROMA_BATCH_DEADLINE_MS),
       .enable_adtech_code_logging = enable_adtech_code_logging,
       .enable_report_result_url_generation =
           enable_report_result_url_generation,
@@ -281,11 +468,35 @@ absl::Status RunServer() {
           config_client.GetIntParameter(MAX_ALLOWED_SIZE_DEBUG_URL_BYTES),
       .max_allowed_size_all_debug_urls_kb =
           config_client.GetIntParameter(MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB),
-      .default_code_version = default_code_version};
-  AuctionService auction_service(
-      std::move(score_ads_reactor_factory),
-      CreateKeyFetcherManager(config_client, /* public_key_fetcher= */ nullptr),
-      CreateCryptoClient(), std::move(runtime_config));
+      .num_score_ad_response_parse_threads = std::max(
+          1, static_cast<int>(config_client.GetInt64Parameter(
+                 SCORE_AD_RESPONSE_PARSE_THREADS))),
+      .score_ads_max_chunk_size =
+          config_client.GetIntParameter(SCORE_ADS_MAX_CHUNK_SIZE),
+      .score_ads_owner_budget_ms =
+          config_client.GetIntParameter(SCORE_ADS_OWNER_BUDGET_MS),
+      .num_js_workers = config_client.GetIntParameter(JS_NUM_WORKERS),
+      .enable_native_scoring = code_fetch_proto.has_native_scoring(),
+      .native_scoring_bid_floor =
+          code_fetch_proto.native_scoring().bid_floor(),
+      .native_scoring_allow_component_auction =
+          code_fetch_proto.native_scoring().allow_component_auction(),
+      .default_code_version = default_code_version,
+      .report_result_url_template =
+          code_fetch_proto.report_result_url_template(),
+      .buyer_report_win_url_templates = {
+          code_fetch_proto.buyer_report_win_url_templates().begin(),
+          code_fetch_proto.buyer_report_win_url_templates().end()}};
+  // The keys are fetched while the startup tasks run.
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      key_fetcher_manager = CreateKeyFetcherManager(
+          config_client, /* public_key_fetcher= */ nullptr);
+  PS_RETURN_IF_ERROR(startup.Wait());
+
+  AuctionService auction_service(std::move(score_ads_reactor_factory),
+                                 std::move(key_fetcher_manager),
+                                 CreateCryptoClient(),
+                                 std::move(runtime_config));
 
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
@@ -308,19 +519,52 @@ absl::Status RunServer() {
   // Set max message size to 256 MB.
   builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
                              256L * 1024L * 1024L);
+  ApplyGrpcServerOptions(
+      {.num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_pollers = config_client.GetIntParameter(GRPC_SERVER_MAX_POLLERS),
+       .max_memory_bytes =
+           config_client.GetInt64Parameter(GRPC_SERVER_MAX_MEMORY_MB) * 1024 *
+           1024,
+       .max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS)},
+      builder);
+  // ScoreAds is served over its raw messages, which are on an arena of each
+  // call, see RawCiphertextCall.
   builder.RegisterService(&auction_service);
 
-  std::unique_ptr<Server> server(builder.BuildAndStart());
+  std::unique_ptr<Server> server;
+  {
+    // The threads serving the completion queues start with the server.
+    ScopedCpuPlacement grpc_placement("gRPC threads", cpu_placement.grpc_cpus);
+    server = builder.BuildAndStart();
+  }
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
-  // Wait for the server to shutdown. Note that some other thread must be
-  // responsible for shutting down the server for this call to ever return.
   PS_LOG(INFO) << "Server listening on " << server_address;
-  server->Wait();
-  // Ends periodic code blob fetching from an arbitrary url.
-  PS_RETURN_IF_ERROR(code_fetch_manager.End())
-      << "Error shutting down UDF fetcher.";
+  // Drains the server on SIGTERM, then stops the UDF fetcher before Roma, into
+  // which it loads the code it fetches.
+  ServerDrain drain(
+      {.health_check_grace = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_HEALTH_CHECK_GRACE_MS)),
+       .deadline = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_DEADLINE_MS))});
+  absl::Status udf_fetcher_status;
+  drain.AddStep("UDF fetcher",
+                [&code_fetch_manager, &udf_fetcher_status](absl::Time) {
+                  // Ends periodic code blob fetching from an arbitrary url.
+                  udf_fetcher_status = code_fetch_manager.End();
+                });
+  drain.AddStep("reporters", [&async_reporter](absl::Time deadline) {
+    if (!async_reporter->Flush(deadline)) {
+      PS_LOG(WARNING) << "Reports left unsent at the drain deadline";
+    }
+  });
+  drain.AddStep("Roma", [&dispatcher](absl::Time) {
+    dispatcher.Stop().IgnoreError();
+  });
+  drain.AddStep("telemetry", FlushTelemetry);
+  drain.Wait(*server);
+  PS_RETURN_IF_ERROR(udf_fetcher_status) << "Error shutting down UDF fetcher.";
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,22 +14,72 @@
 
 #include "services/auction_service/auction_service.h"
 
+#include <memory>
+#include <utility>
+
 #include <grpcpp/grpcpp.h>
 
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/backend_load.h"
+#include "services/common/util/memory_admission_controller.h"
 #include "src/telemetry/telemetry.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 grpc::ServerUnaryReactor* AuctionService::ScoreAds(
     grpc::CallbackServerContext* context, const ScoreAdsRequest* request,
     ScoreAdsResponse* response) {
-  LogCommonMetric(request, response);
+  return ServeScoreAds(context, request, response, /*raw_call=*/nullptr);
+}
+
+grpc::ServerUnaryReactor* AuctionService::ScoreAds(
+    grpc::CallbackServerContext* context, const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+  absl::StatusOr<
+      std::shared_ptr<RawCiphertextCall<ScoreAdsRequest, ScoreAdsResponse>>>
+      raw_call = RawCiphertextCall<ScoreAdsRequest, ScoreAdsResponse>::Read(
+          *request, response);
+  if (!raw_call.ok()) {
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(raw_call.status()));
+    return reactor;
+  }
+  return ServeScoreAds(context, (*raw_call)->request(), (*raw_call)->response(),
+                       *std::move(raw_call));
+}
+
+grpc::ServerUnaryReactor* AuctionService::ServeScoreAds(
+    grpc::CallbackServerContext* context, const ScoreAdsRequest* request,
+    ScoreAdsResponse* response,
+    std::shared_ptr<RawCiphertextCall<ScoreAdsRequest, ScoreAdsResponse>>
+        raw_call) {
+  // Lets the clients steer their RPCs away from busy replicas.
+  context->AddInitialMetadata(
+      kBackendLoadMetadataKey,
+      SerializeBackendLoadReport(BackendLoadTracker::Get().Report()));
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    LogRejectedRequestMetric(request, response, memory_reservation.status());
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
   // Heap allocate the reactor. Deleted in reactor's OnDone call.
   auto reactor =
       score_ads_reactor_factory_(request, response, key_fetcher_manager_.get(),
                                  crypto_client_.get(), runtime_config_);
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
+  if (raw_call != nullptr) {
+    reactor->ServeRawCall(std::move(raw_call));
+  }
+  reactor->SetDeadline(absl::FromChrono(context->deadline()));
+  reactor->StartTrace(
+      "ScoreAds", RequestTrace::GetTraceParent(context->client_metadata()));
   reactor->Execute();
   return reactor.release();
 }
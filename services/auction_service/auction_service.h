@@ -24,6 +24,7 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/score_ads_reactor.h"
+#include "services/common/util/raw_ciphertext_call.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 #include "src/public/cpio/interface/crypto_client/crypto_client_interface.h"
 
@@ -42,7 +43,9 @@ using ScoreAdsReactorFactory =
 // The auction uses proprietary AdTech code that runs in a secure privacy
 // sandbox inside a secure Virtual Machine. The implementation dispatches
 // to V8 to run the AdTech code.
-class AuctionService final : public Auction::CallbackService {
+// ScoreAds is served over its raw messages, see RawCiphertextCall.
+class AuctionService final
+    : public Auction::WithRawCallbackMethod_ScoreAds<Auction::CallbackService> {
  public:
   explicit AuctionService(
       ScoreAdsReactorFactory score_ads_reactor_factory,
@@ -69,7 +72,19 @@ class AuctionService final : public Auction::CallbackService {
                                      const ScoreAdsRequest* request,
                                      ScoreAdsResponse* response) override;
 
+  // Serves ScoreAds over its raw messages, as above.
+  grpc::ServerUnaryReactor* ScoreAds(grpc::CallbackServerContext* context,
+                                     const grpc::ByteBuffer* request,
+                                     grpc::ByteBuffer* response) override;
+
  private:
+  // Serves a ScoreAds call, over the raw messages of `raw_call` if not null.
+  grpc::ServerUnaryReactor* ServeScoreAds(
+      grpc::CallbackServerContext* context, const ScoreAdsRequest* request,
+      ScoreAdsResponse* response,
+      std::shared_ptr<RawCiphertextCall<ScoreAdsRequest, ScoreAdsResponse>>
+          raw_call);
+
   ScoreAdsReactorFactory score_ads_reactor_factory_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
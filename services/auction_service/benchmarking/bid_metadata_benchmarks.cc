@@ -0,0 +1,120 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the bid metadata passed to scoreAd for each ad, written by
+// WriteJsonObject into a single allocation of its exact size, with the
+// previous StrAppend chains growing the string as they go.
+//
+// Run the benchmark as follows:
+// builders/tools/bazel-debian run --dynamic_mode=off -c opt --copt=-gmlt \
+//   --copt=-fno-omit-frame-pointer --fission=yes --strip=never \
+//   services/auction_service/benchmarking:bid_metadata_benchmarks \
+//   -- --benchmark_time_unit=ns --benchmark_repetitions=10
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "services/auction_service/auction_constants.h"
+#include "services/auction_service/utils/proto_utils.h"
+#include "services/common/util/reporting_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kPublisherHostname[] = "www.example-publisher.com";
+constexpr char kInterestGroupOwner[] = "https://www.example-dsp.com";
+constexpr char kRenderUrl[] =
+    "https://adtech.example-dsp.com/ads?id=1234567890&campaign=summer";
+constexpr char kTopLevelSeller[] = "https://www.example-top-ssp.com";
+constexpr char kBidCurrency[] = "USD";
+
+google::protobuf::RepeatedPtrField<std::string> MakeAdComponents(
+    int num_components) {
+  google::protobuf::RepeatedPtrField<std::string> ad_components;
+  for (int i = 0; i < num_components; ++i) {
+    *ad_components.Add() =
+        absl::StrCat("https://adtech.example-dsp.com/component?id=", i);
+  }
+  return ad_components;
+}
+
+// Previous writer of the bid metadata, without escaping or pre-sizing.
+std::string PreviousMakeBidMetadata(
+    absl::string_view publisher_hostname,
+    absl::string_view interest_group_owner, absl::string_view render_url,
+    const google::protobuf::RepeatedPtrField<std::string>&
+        ad_component_render_urls,
+    absl::string_view top_level_seller, absl::string_view bid_currency) {
+  std::string bid_metadata = "{";
+  if (!interest_group_owner.empty()) {
+    absl::StrAppend(&bid_metadata, R"JSON(")JSON", kIGOwnerPropertyForScoreAd,
+                    R"JSON(":")JSON", interest_group_owner, R"JSON(",)JSON");
+  }
+  if (!publisher_hostname.empty()) {
+    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
+                    kTopWindowHostnamePropertyForScoreAd, R"JSON(":")JSON",
+                    publisher_hostname, R"JSON(",)JSON");
+  }
+  if (!ad_component_render_urls.empty()) {
+    absl::StrAppend(&bid_metadata, R"("adComponents":[)");
+    for (int i = 0; i < ad_component_render_urls.size(); i++) {
+      absl::StrAppend(&bid_metadata, "\"", ad_component_render_urls.at(i),
+                      "\"");
+      if (i != ad_component_render_urls.size() - 1) {
+        absl::StrAppend(&bid_metadata, ",");
+      }
+    }
+    absl::StrAppend(&bid_metadata, R"(],)");
+  }
+  absl::StrAppend(&bid_metadata, R"JSON(")JSON",
+                  kBidCurrencyPropertyForScoreAd, R"JSON(":")JSON",
+                  bid_currency.empty() ? kEmptyBidCurrencyCode : bid_currency,
+                  R"JSON(",)JSON");
+  if (!top_level_seller.empty()) {
+    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
+                    kTopLevelSellerFieldPropertyForScoreAd, R"JSON(":")JSON",
+                    top_level_seller, R"JSON(",)JSON");
+  }
+  absl::StrAppend(&bid_metadata, R"JSON(")JSON", kRenderUrlsPropertyForScoreAd,
+                  R"JSON(":")JSON", render_url, R"JSON("})JSON");
+  return bid_metadata;
+}
+
+// Args: {number of ad components of the ad}.
+static void BM_MakeBidMetadata(benchmark::State& state) {
+  const auto ad_components = MakeAdComponents(state.range(0));
+  for (auto _ : state) {
+    std::string bid_metadata =
+        MakeBidMetadata(kPublisherHostname, kInterestGroupOwner, kRenderUrl,
+                        ad_components, kTopLevelSeller, kBidCurrency);
+    benchmark::DoNotOptimize(bid_metadata);
+  }
+}
+
+static void BM_PreviousMakeBidMetadata(benchmark::State& state) {
+  const auto ad_components = MakeAdComponents(state.range(0));
+  for (auto _ : state) {
+    std::string bid_metadata = PreviousMakeBidMetadata(
+        kPublisherHostname, kInterestGroupOwner, kRenderUrl, ad_components,
+        kTopLevelSeller, kBidCurrency);
+    benchmark::DoNotOptimize(bid_metadata);
+  }
+}
+
+BENCHMARK(BM_MakeBidMetadata)->Arg(0)->Arg(4)->Arg(20);
+BENCHMARK(BM_PreviousMakeBidMetadata)->Arg(0)->Arg(4)->Arg(20);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
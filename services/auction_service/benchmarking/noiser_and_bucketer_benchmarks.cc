@@ -0,0 +1,112 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the batched random source of the reportWin noiser with a fresh
+// RAND_bytes draw per value, and checks that the distributions match: the
+// chi_square counters of uniform draws over kNumBuckets buckets should stay
+// around kNumBuckets - 1 for both, and noised_ratio should stay around 1/101.
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include "absl/log/check.h"
+#include "benchmark/benchmark.h"
+#include "openssl/rand.h"
+#include "services/auction_service/reporting/noiser_and_bucketer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kNumBuckets = 32;
+
+// The previous random source, drawing from RAND_bytes for every value.
+uint64_t RandGeneratorPerCallRandBytes(uint64_t range) {
+  const uint64_t max_acceptable_value =
+      (std::numeric_limits<uint64_t>::max() / range) * range - 1;
+  uint64_t value;
+  do {
+    CHECK_EQ(RAND_bytes(reinterpret_cast<uint8_t*>(&value), sizeof(value)), 1);
+  } while (value > max_acceptable_value);
+  return value % range;
+}
+
+// Returns the chi-square statistic of the counts against a uniform
+// distribution.
+double ChiSquare(const std::array<int64_t, kNumBuckets>& counts,
+                 int64_t num_draws) {
+  const double expected = static_cast<double>(num_draws) / kNumBuckets;
+  double chi_square = 0;
+  for (int64_t count : counts) {
+    chi_square += (count - expected) * (count - expected) / expected;
+  }
+  return chi_square;
+}
+
+static void BM_RandGenerator_Batched(benchmark::State& state) {
+  std::array<int64_t, kNumBuckets> counts = {};
+  for (auto _ : state) {
+    absl::StatusOr<uint64_t> value = RandGenerator(kNumBuckets);
+    CHECK_OK(value);
+    ++counts[*value];
+  }
+  state.counters["chi_square"] = ChiSquare(counts, state.iterations());
+}
+BENCHMARK(BM_RandGenerator_Batched);
+
+static void BM_RandGenerator_PerCallRandBytes(benchmark::State& state) {
+  std::array<int64_t, kNumBuckets> counts = {};
+  for (auto _ : state) {
+    ++counts[RandGeneratorPerCallRandBytes(kNumBuckets)];
+  }
+  state.counters["chi_square"] = ChiSquare(counts, state.iterations());
+}
+BENCHMARK(BM_RandGenerator_PerCallRandBytes);
+
+static void BM_NoiseAndBucketRecency(benchmark::State& state) {
+  constexpr long kRecency = 100;
+  const uint8_t bucket = BucketRecency(kRecency);
+  int64_t num_noised = 0;
+  for (auto _ : state) {
+    absl::StatusOr<uint8_t> noised = NoiseAndBucketRecency(kRecency);
+    CHECK_OK(noised);
+    num_noised += *noised != bucket;
+  }
+  // A noised value equals the bucket 1 in 32 times.
+  state.counters["noised_ratio"] =
+      static_cast<double>(num_noised) / state.iterations() * kNumBuckets /
+      (kNumBuckets - 1);
+}
+BENCHMARK(BM_NoiseAndBucketRecency);
+
+static void BM_BucketJoinCount(benchmark::State& state) {
+  int32_t join_count = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BucketJoinCount(join_count));
+    join_count = (join_count + 7) % 128;
+  }
+}
+BENCHMARK(BM_BucketJoinCount);
+
+static void BM_BucketRecency(benchmark::State& state) {
+  long recency = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BucketRecency(recency));
+    recency = (recency + 997) % 50000;
+  }
+}
+BENCHMARK(BM_BucketRecency);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -351,8 +351,7 @@ static void BM_ScoreAdsProtectedAudience(benchmark::State& state) {
   for (auto _ : state) {
     // This code gets timed.
     metric::MetricContextMap<ScoreAdsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&score_ads_request);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     ScoreAdsReactor reactor(dispatcher, &score_ads_request, &response,
                             std::make_unique<ScoreAdsNoOpLogger>(),
                             key_fetcher_manager.get(), &crypto_client,
@@ -397,8 +396,7 @@ static void BM_ScoreAdsProtectedAudienceAndAppSignals(benchmark::State& state) {
   for (auto _ : state) {
     // This code gets timed.
     metric::MetricContextMap<ScoreAdsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&score_ads_request);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     ScoreAdsReactor reactor(dispatcher, &score_ads_request, &response,
                             std::make_unique<ScoreAdsNoOpLogger>(),
                             key_fetcher_manager.get(), &crypto_client,
@@ -107,7 +107,7 @@ std::string GetSellerWrappedCode(
     const absl::flat_hash_map<std::string, std::string>& buyer_origin_code_map,
     const absl::flat_hash_map<std::string, std::string>&
         protected_app_signals_buyer_origin_code_map) {
-  std::string wrap_code{kEntryFunction};
+  std::string wrap_code = absl::StrCat(kUdfProfilingFunction, kEntryFunction);
   if (enable_protected_app_signals) {
     ABSL_LOG(INFO) << "Protected app signals are enabled, appending the "
                       "protected app signals report win code blob";
@@ -144,7 +144,7 @@ std::string GetSellerWrappedCode(
 
 std::string GetSellerWrappedCode(absl::string_view seller_js_code,
                                  bool enable_report_result_url_generation) {
-  std::string wrap_code{kEntryFunction};
+  std::string wrap_code = absl::StrCat(kUdfProfilingFunction, kEntryFunction);
   if (enable_report_result_url_generation) {
     wrap_code.append(kReportResultWrapperFunction);
   }
@@ -37,6 +37,9 @@ inline constexpr char kReportWinWrapperFunctionName[] = "reportWinWrapper";
 // The dispatch function name will be scoreAdEntryFunction.
 // This wrapper supports the features below:
 //- Exporting logs to Auction Service using console.log
+//- Returning the common fields of the output of scoreAd as a record of `|`
+//  separated fields instead of JSON, see ParseScoreAdRecord
+//- Scoring a chunk of ads in one invocation, with scoreAdsBatchEntryFunction
 constexpr absl::string_view kEntryFunction = R"JS_CODE(
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
@@ -49,6 +52,46 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -62,9 +105,11 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -77,12 +122,42 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
+      }
+    }
+
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
       }
+      return psResponses;
     }
 )JS_CODE";
 
@@ -243,6 +243,60 @@ constexpr absl::string_view kTopLevelAuctionCode = R"JS_CODE(
 )JS_CODE";
 
 constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
     const forDebuggingOnly = {};
@@ -254,6 +308,46 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -267,9 +361,11 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -282,14 +378,44 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
+      }
+      return psResponses;
+    }
+
     //Handler method to call adTech provided reportResult method and wrap the
     // response with reportResult url and interaction reporting urls.
     function reportingEntryFunction(auctionConfig, sellerReportingSignals, directFromSellerSignals, enable_logging, buyerReportingMetadata, ) {
@@ -488,6 +614,60 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
 
 constexpr absl::string_view kExpectedSellerCodeWithScoreAdAndReportResult =
     R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
     const forDebuggingOnly = {};
@@ -499,6 +679,46 @@ constexpr absl::string_view kExpectedSellerCodeWithScoreAdAndReportResult =
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -512,9 +732,11 @@ constexpr absl::string_view kExpectedSellerCodeWithScoreAdAndReportResult =
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -527,14 +749,44 @@ constexpr absl::string_view kExpectedSellerCodeWithScoreAdAndReportResult =
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
+      }
+      return psResponses;
+    }
+
     //Handler method to call adTech provided reportResult method and wrap the
     // response with reportResult url and interaction reporting urls.
     function reportingResultEntryFunction(auctionConfig, sellerReportingSignals, directFromSellerSignals, enable_logging) {
@@ -613,6 +865,60 @@ constexpr absl::string_view kExpectedSellerCodeWithScoreAdAndReportResult =
 )JS_CODE";
 
 constexpr absl::string_view kExpectedProtectedAppSignalsFinalCode = R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
     const forDebuggingOnly = {};
@@ -624,6 +930,46 @@ constexpr absl::string_view kExpectedProtectedAppSignalsFinalCode = R"JS_CODE(
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -637,9 +983,11 @@ constexpr absl::string_view kExpectedProtectedAppSignalsFinalCode = R"JS_CODE(
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -652,14 +1000,44 @@ constexpr absl::string_view kExpectedProtectedAppSignalsFinalCode = R"JS_CODE(
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
+      }
+      return psResponses;
+    }
+
     //Handler method to call adTech provided reportResult method and wrap the
     // response with reportResult url and interaction reporting urls.
     function reportingEntryFunctionProtectedAppSignals(auctionConfig, sellerReportingSignals, directFromSellerSignals, enable_logging, buyerReportingMetadata, egressPayload, temporaryUnlimitedEgressPayload) {
@@ -974,6 +1352,60 @@ constexpr absl::string_view kExpectedProtectedAppSignalsFinalCode = R"JS_CODE(
 )JS_CODE";
 
 constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
     const forDebuggingOnly = {};
@@ -985,6 +1417,46 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -998,9 +1470,11 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -1013,14 +1487,44 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
+      }
+      return psResponses;
+    }
+
     //Handler method to call adTech provided reportResult method and wrap the
     // response with reportResult url and interaction reporting urls.
     function reportingEntryFunction(auctionConfig, sellerReportingSignals, directFromSellerSignals, enable_logging, buyerReportingMetadata, ) {
@@ -1137,6 +1641,60 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
 )JS_CODE";
 
 constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
     var forDebuggingOnly_auction_loss_url = undefined;
     var forDebuggingOnly_auction_win_url = undefined;
     const forDebuggingOnly = {};
@@ -1148,6 +1706,46 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
     }
     globalThis.forDebuggingOnly = forDebuggingOnly;
 
+    // Index and type of the fields of the output of scoreAd in its record.
+    const psScoreAdRecordFields = {
+      desirability: [0, 'number'],
+      allowComponentAuction: [1, 'boolean'],
+      bid: [2, 'number'],
+      bidCurrency: [3, 'string'],
+      incomingBidInSellerCurrency: [4, 'number'],
+      rejectReason: [5, 'string']
+    };
+    // Returns the output of scoreAd as a record of `|` separated fields,
+    // read by the auction service without parsing JSON, or undefined if the
+    // record cannot hold the output.
+    function psScoreAdRecord(scoreAdResponse) {
+      if (typeof scoreAdResponse === 'number') {
+        scoreAdResponse = {desirability: scoreAdResponse};
+      }
+      if (scoreAdResponse === null || typeof scoreAdResponse !== 'object' ||
+          Array.isArray(scoreAdResponse)) {
+        return undefined;
+      }
+      const fields = ['', '', '', '', '', ''];
+      for (const key of Object.keys(scoreAdResponse)) {
+        const value = scoreAdResponse[key];
+        if (value === undefined) {
+          continue;
+        }
+        if (!psScoreAdRecordFields.hasOwnProperty(key)) {
+          return undefined;
+        }
+        const [index, type] = psScoreAdRecordFields[key];
+        if (typeof value !== type ||
+            (type === 'number' && !Number.isFinite(value)) ||
+            (type === 'string' && !/^[\w-]*$/.test(value))) {
+          return undefined;
+        }
+        fields[index] = type === 'boolean' ? (value ? '1' : '0') : String(value);
+      }
+      return 'psScore1|' + fields.join('|');
+    }
+
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
       const ps_logs = [];
@@ -1161,9 +1759,11 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
       console.log = console.warn = console.error = function() {};
     }
       var scoreAdResponse = {};
+      let psProfile = undefined;
       try {
-        scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
-              trustedScoringSignals, browserSignals, directFromSellerSignals);
+        [scoreAdResponse, psProfile] = psRunProfiled(featureFlags,
+            () => scoreAd(adMetadata, bid, auctionConfig,
+              trustedScoringSignals, browserSignals, directFromSellerSignals));
       } catch({error, message}) {
           console.error("[Error: " + error + "; Message: " + message + "]");
       } finally {
@@ -1176,14 +1776,44 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
           }
         }
       }
+      if (!ps_logs.length && !ps_errors.length && !ps_warns.length &&
+          psProfile === undefined) {
+        const psRecord = psScoreAdRecord(scoreAdResponse);
+        if (psRecord !== undefined) {
+          return psRecord;
+        }
+      }
       return {
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
+    // Scores a chunk of ads in one invocation, as scoreAdEntryFunction would
+    // each of them. The arguments specific to an ad are arrays of an element
+    // per ad, while auctionConfig and the other arguments are shared by the
+    // ads. The trusted scoring signals of the ads are
+    // trustedScoringSignals.signals, at the index of each ad in
+    // trustedScoringSignals.indices, so that those shared by ads are passed
+    // once. Returns the array of the outputs for the ads.
+    function scoreAdsBatchEntryFunction(adMetadata, bid, auctionConfig,
+        trustedScoringSignals, browserSignals, directFromSellerSignals,
+        featureFlags){
+      const psResponses = [];
+      for (let i = 0; i < bid.length; i++) {
+        forDebuggingOnly_auction_loss_url = undefined;
+        forDebuggingOnly_auction_win_url = undefined;
+        psResponses.push(scoreAdEntryFunction(adMetadata[i], bid[i],
+            auctionConfig,
+            trustedScoringSignals.signals[trustedScoringSignals.indices[i]],
+            browserSignals[i], directFromSellerSignals, featureFlags));
+      }
+      return psResponses;
+    }
+
     function fibonacci(num) {
       if (num <= 1) return 1;
       return fibonacci(num - 1) + fibonacci(num - 2);
@@ -19,6 +19,8 @@
 
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "services/auction_service/auction_constants.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -27,6 +29,9 @@ struct AuctionServiceRuntimeConfig {
   bool enable_seller_debug_url_generation = false;
   // Sets the timeout used by Roma for dispatch requests
   std::string roma_timeout_ms = "10000";
+  // If positive, scoreAd batches end after this many milliseconds with the
+  // ads scored by then.
+  int roma_batch_deadline_ms = 0;
 
   // Enables Seller Code Wrapper for complete code generation.
   bool enable_seller_code_wrapper = false;
@@ -52,9 +57,32 @@ struct AuctionServiceRuntimeConfig {
   // The max allowed size of all debug win or loss URLs for an auction.
   // Default value is 3000 kilobytes.
   int max_allowed_size_all_debug_urls_kb = 3000;
+  // Number of tasks the scoreAd responses of a large batch are parsed in, on
+  // the callback thread and the server executor. Responses are parsed on the
+  // callback thread alone when 1 (default).
+  int num_score_ad_response_parse_threads = 1;
+  // Most ads scored by a single scoreAd invocation. Ads are scored one by one
+  // when 1 or less (default).
+  int score_ads_max_chunk_size = 0;
+  // Most time the scoreAd invocations of the ads of an interest group owner
+  // may run for in a request before its ads are left out of the auction. No
+  // budget when 0 or less (default).
+  int score_ads_owner_budget_ms = 0;
+  // Number of Roma workers, over which the chunks of ads are spread.
+  int num_js_workers = 0;
+  // Scores the ads natively instead of running scoreAd, with the options
+  // below. See NativeScoring in auction_code_fetch_config.proto.
+  bool enable_native_scoring = false;
+  double native_scoring_bid_floor = 0;
+  bool native_scoring_allow_component_auction = false;
 
   // Default code version to pass to Roma.
   std::string default_code_version = kScoreAdBlobVersion;
+
+  // Reporting URL templates rendered natively instead of running
+  // reportResult, and reportWin by buyer origin. See RenderReportingUrl.
+  std::string report_result_url_template;
+  absl::flat_hash_map<std::string, std::string> buyer_report_win_url_templates;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -13,6 +13,8 @@
 //  limitations under the License
 #include "services/auction_service/reporting/noiser_and_bucketer.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -23,133 +25,118 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
-// Uses OpenSSL's RAND_bytes to generate a 64 bit unsigned random integer.
-absl::StatusOr<uint64_t> RandUint64() {
-  uint64_t rand_64;
-  if (RAND_bytes(reinterpret_cast<uint8_t*>(&rand_64), sizeof(rand_64)) != 1) {
-    return absl::InternalError("Error generating number.");
+namespace {
+
+// Upper bounds (inclusive) of the join count buckets 1 to 15. Larger join
+// counts fall in bucket 16.
+constexpr std::array<int32_t, 15> kJoinCountBucketBounds = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 20, 30, 40, 50, 100};
+
+// Upper bounds (exclusive) of the recency buckets 0 to 30. Larger recencies
+// fall in bucket 31.
+// clang-format off
+constexpr std::array<long, 31> kRecencyBucketBounds = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10,
+    15, 20, 30, 40, 50, 60, 75, 90, 105, 120,
+    240, 720, 1440, 2160, 2880, 4320, 5760, 10080, 20160, 30240, 40320};
+// clang-format on
+
+// Random values drawn from RAND_bytes in batches. Each thread has its own
+// buffer, so that most draws are a read from the buffer without locking.
+class ThreadRandomBuffer {
+ public:
+  // Sets `value` to the next random value, returns false if RAND_bytes failed.
+  bool Next(uint64_t& value) {
+    if (next_ == values_.size()) {
+      if (RAND_bytes(reinterpret_cast<uint8_t*>(values_.data()),
+                     sizeof(values_)) != 1) {
+        return false;
+      }
+      next_ = 0;
+    }
+    value = values_[next_];
+    // Values handed out are not kept around.
+    values_[next_++] = 0;
+    return true;
   }
-  return rand_64;
+
+ private:
+  std::array<uint64_t, 64> values_ = {};
+  size_t next_ = values_.size();
+};
+
+bool NextRandUint64(uint64_t& value) {
+  thread_local ThreadRandomBuffer buffer;
+  return buffer.Next(value);
 }
 
-// Generates a 64 bit unsigned random integer within [0,range].
-absl::StatusOr<uint64_t> RandGenerator(uint64_t range) {
+// Sets `value` to a uniformly distributed random integer within [0,range).
+bool NextRandBelow(uint64_t range, uint64_t& value) {
   // We must discard random results above this number, as they would
   // make the random generator non-uniform (consider e.g. if
   // MAX_UINT64 was 7 and range was 5, then a result of 1 would be twice
   // as likely as a result of 3 or 4).
-  uint64_t max_acceptable_value =
+  const uint64_t max_acceptable_value =
       (std::numeric_limits<uint64_t>::max() / range) * range - 1;
-
-  uint64_t rand_unit64;
+  uint64_t rand_uint64;
   do {
-    PS_ASSIGN_OR_RETURN(rand_unit64, RandUint64());
-  } while (rand_unit64 > max_acceptable_value);
-
-  return rand_unit64 % range;
+    if (!NextRandUint64(rand_uint64)) {
+      return false;
+    }
+  } while (rand_uint64 > max_acceptable_value);
+  value = rand_uint64 % range;
+  return true;
 }
 
-// Generates a random integer within the range of [min,max]
-absl::StatusOr<int> RandInt(int min, int max) {
+// Sets `value` to a random integer within the range of [min,max].
+bool NextRandInt(int min, int max, int& value) {
   if (min >= max) {
-    return absl::InternalError("Invalid range for random number generation.");
+    return false;
+  }
+  // |range| is at most UINT_MAX + 1, so the result is at most UINT_MAX and
+  // fits in an int once offset by min.
+  uint64_t rand_uint64;
+  if (!NextRandBelow(static_cast<uint64_t>(max - min) + 1, rand_uint64)) {
+    return false;
   }
-  uint64_t range = static_cast<uint64_t>(max - min) + 1;
-  // |range| is at most UINT_MAX + 1, so the result of RandGenerator(range)
-  // is at most UINT_MAX.  Hence it's safe to cast it from uint64_t to int64_t.
-  int rand_unit64;
-  PS_ASSIGN_OR_RETURN(rand_unit64, RandGenerator(range));
-  return rand_unit64 + min;
+  value = static_cast<int>(rand_uint64) + min;
+  return true;
 }
 
-uint8_t BucketJoinCount(int32_t join_count) {
-  if (join_count < 1) {
-    join_count = 1;
-  }
+}  // namespace
 
-  if (join_count <= 10) {
-    return join_count;
-  } else if (join_count <= 20) {
-    return 11;
-  } else if (join_count <= 30) {
-    return 12;
-  } else if (join_count <= 40) {
-    return 13;
-  } else if (join_count <= 50) {
-    return 14;
-  } else if (join_count <= 100) {
-    return 15;
+// Generates a 64 bit unsigned random integer within [0,range).
+absl::StatusOr<uint64_t> RandGenerator(uint64_t range) {
+  uint64_t value;
+  if (!NextRandBelow(range, value)) {
+    return absl::InternalError("Error generating number.");
   }
+  return value;
+}
 
-  return 16;
+uint8_t BucketJoinCount(int32_t join_count) {
+  return std::lower_bound(kJoinCountBucketBounds.begin(),
+                          kJoinCountBucketBounds.end(), join_count) -
+         kJoinCountBucketBounds.begin() + 1;
 }
 
 uint8_t BucketRecency(long recency) {
-  if (recency < 0) {
-    recency = 0;
-  }
-
-  if (recency < 10) {
-    return recency;
-  } else if (recency < 15) {
-    return 10;
-  } else if (recency < 20) {
-    return 11;
-  } else if (recency < 30) {
-    return 12;
-  } else if (recency < 40) {
-    return 13;
-  } else if (recency < 50) {
-    return 14;
-  } else if (recency < 60) {
-    return 15;
-  } else if (recency < 75) {
-    return 16;
-  } else if (recency < 90) {
-    return 17;
-  } else if (recency < 105) {
-    return 18;
-  } else if (recency < 120) {
-    return 19;
-  } else if (recency < 240) {
-    return 20;
-  } else if (recency < 720) {
-    return 21;
-  } else if (recency < 1440) {
-    return 22;
-  } else if (recency < 2160) {
-    return 23;
-  } else if (recency < 2880) {
-    return 24;
-  } else if (recency < 4320) {
-    return 25;
-  } else if (recency < 5760) {
-    return 26;
-  } else if (recency < 10080) {
-    return 27;
-  } else if (recency < 20160) {
-    return 28;
-  } else if (recency < 30240) {
-    return 29;
-  } else if (recency < 40320) {
-    return 30;
-  }
-
-  return 31;
+  return std::upper_bound(kRecencyBucketBounds.begin(),
+                          kRecencyBucketBounds.end(), recency) -
+         kRecencyBucketBounds.begin();
 }
 
-// Noises 1/100 inputs. If noised, returns a random integer in the range of
-// [min,max). If not noised, returns the input as it is.
+// Noises 1/101 inputs. If noised, returns a random integer in the range of
+// [min,max]. If not noised, returns the input as it is.
 template <typename T>
 absl::StatusOr<T> Noise(T input, int min, int max) {
-  absl::StatusOr<int> rand_one_percent_int = RandInt(0, 100);
-  if (!rand_one_percent_int.ok()) {
-    return rand_one_percent_int;
+  int rand_one_percent_int;
+  if (!NextRandInt(0, 100, rand_one_percent_int)) {
+    return absl::InternalError("Error generating number.");
   }
-  if (rand_one_percent_int.value() == 1) {
-    absl::StatusOr<int> rand_int = RandInt(min, max);
-    if (rand_int.ok()) {
-      return static_cast<T>(rand_int.value());
+  if (rand_one_percent_int == 1) {
+    if (int rand_int; NextRandInt(min, max, rand_int)) {
+      return static_cast<T>(rand_int);
     }
   }
   return input;
@@ -168,7 +155,9 @@ double BitsToOpenEndedUnitInterval(uint64_t bits) {
 
 absl::StatusOr<double> RandDouble() {
   uint64_t rand_64;
-  PS_ASSIGN_OR_RETURN(rand_64, RandUint64());
+  if (!NextRandUint64(rand_64)) {
+    return absl::InternalError("Error generating number.");
+  }
   return BitsToOpenEndedUnitInterval(rand_64);
 }
 
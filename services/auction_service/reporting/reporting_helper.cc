@@ -19,6 +19,8 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "rapidjson/document.h"
@@ -31,11 +33,41 @@
 #include "services/common/util/post_auction_signals.h"
 #include "services/common/util/reporting_util.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/url_template.h"
 #include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 constexpr int kStochasticalRoundingBits = 8;
+// Distinct reporting URL templates whose parsed templates are kept across
+// auctions.
+constexpr int kReportingUrlTemplateCacheSize = 1024;
+
+namespace {
+
+UrlTemplateCache& GetReportingUrlTemplateCache() {
+  static UrlTemplateCache* cache = new UrlTemplateCache(
+      kReportingUrlTemplateCacheSize,
+      {kReportingUrlPlaceholders.begin(), kReportingUrlPlaceholders.end()});
+  return *cache;
+}
+
+// Escapes the characters other than the unreserved ones of RFC 3986.
+std::string PercentEncode(absl::string_view value) {
+  std::string encoded;
+  encoded.reserve(value.size());
+  for (char c : value) {
+    if (absl::ascii_isalnum(c) || c == '-' || c == '.' || c == '_' ||
+        c == '~') {
+      encoded.push_back(c);
+    } else {
+      absl::StrAppendFormat(&encoded, "%%%02X", static_cast<unsigned char>(c));
+    }
+  }
+  return encoded;
+}
+
+}  // namespace
 
 // Collects log of the provided type into the output vector.
 void ParseLogs(const rapidjson::Document& document, const std::string& log_type,
@@ -125,6 +157,24 @@ double GetEightBitRoundedValue(bool enable_noising, double value) {
   return -1;
 }
 
+// The arguments below are the same for every reporting request, so they are
+// shared by all of them instead of being allocated per request. Roma does not
+// modify its inputs.
+const std::shared_ptr<std::string>& GetEmptyDirectFromSellerSignals() {
+  static const std::shared_ptr<std::string>* empty_signals =
+      new std::shared_ptr<std::string>(std::make_shared<std::string>("{}"));
+  return *empty_signals;
+}
+
+const std::shared_ptr<std::string>& GetEnableAdTechCodeLoggingArg(
+    bool enable_adtech_code_logging) {
+  static const std::shared_ptr<std::string>* enabled =
+      new std::shared_ptr<std::string>(std::make_shared<std::string>("true"));
+  static const std::shared_ptr<std::string>* disabled =
+      new std::shared_ptr<std::string>(std::make_shared<std::string>("false"));
+  return enable_adtech_code_logging ? *enabled : *disabled;
+}
+
 absl::StatusOr<std::string> GetSellerReportingSignals(
     const ReportingDispatchRequestData& dispatch_request_data,
     const ReportingDispatchRequestConfig& dispatch_request_config) {
@@ -198,11 +248,6 @@ absl::StatusOr<std::string> GetSellerReportingSignals(
         dispatch_request_data.component_reporting_metadata.top_level_seller
             .c_str(),
         document.GetAllocator());
-    rapidjson::Value component_seller;
-    component_seller.SetString(
-        dispatch_request_data.component_reporting_metadata.component_seller
-            .c_str(),
-        document.GetAllocator());
     document.AddMember(kTopLevelSellerTag, top_level_seller,
                        document.GetAllocator());
     double modified_bid = GetEightBitRoundedValue(
@@ -221,6 +266,16 @@ absl::StatusOr<std::string> GetSellerReportingSignals(
       document.AddMember(kModifiedBidCurrencyTag, modified_bid_currency,
                          document.GetAllocator());
     }
+  }
+  // Set for component auctions and for top-level auctions, where it is the
+  // seller of the component auction the winning ad came from.
+  if (!dispatch_request_data.component_reporting_metadata.component_seller
+           .empty()) {
+    rapidjson::Value component_seller;
+    component_seller.SetString(
+        dispatch_request_data.component_reporting_metadata.component_seller
+            .c_str(),
+        document.GetAllocator());
     document.AddMember(kComponentSeller, component_seller,
                        document.GetAllocator());
   }
@@ -379,18 +434,17 @@ std::vector<std::shared_ptr<std::string>> GetReportingInput(
   input[ReportingArgIndex(ReportingArgs::kAuctionConfig)] =
       dispatch_request_data.auction_config;
   input[ReportingArgIndex(ReportingArgs::kSellerReportingSignals)] =
-      std::make_shared<std::string>(seller_reporting_signals.value());
+      std::make_shared<std::string>(*std::move(seller_reporting_signals));
   // This is only added to prevent errors in the reporting ad script, and
   // will always be an empty object.
   input[ReportingArgIndex(ReportingArgs::kDirectFromSellerSignals)] =
-      std::make_shared<std::string>("{}");
+      GetEmptyDirectFromSellerSignals();
   input[ReportingArgIndex(ReportingArgs::kEnableAdTechCodeLogging)] =
-      std::make_shared<std::string>(absl::StrFormat(
-          "%v", dispatch_request_config.enable_adtech_code_logging));
-  std::string buyer_reporting_metadata_json =
-      GetBuyerMetadataJson(dispatch_request_config, dispatch_request_data);
+      GetEnableAdTechCodeLoggingArg(
+          dispatch_request_config.enable_adtech_code_logging);
   input[ReportingArgIndex(ReportingArgs::kBuyerReportingMetadata)] =
-      std::make_shared<std::string>(buyer_reporting_metadata_json);
+      std::make_shared<std::string>(
+          GetBuyerMetadataJson(dispatch_request_config, dispatch_request_data));
   if (dispatch_request_config.enable_protected_app_signals) {
     input[ReportingArgIndex(ReportingArgs::kEgressPayload)] =
         std::make_shared<std::string>(dispatch_request_data.egress_payload);
@@ -431,4 +485,33 @@ DispatchRequest GetReportingDispatchRequest(
   };
 }
 
+std::string RenderReportingUrl(
+    absl::string_view url_template,
+    const ReportingDispatchRequestData& dispatch_request_data) {
+  const PostAuctionSignals& signals =
+      dispatch_request_data.post_auction_signals;
+  const std::string winning_bid = absl::StrCat(signals.winning_bid);
+  const std::string bid_currency = PercentEncode(signals.winning_bid_currency);
+  const std::string highest_scoring_other_bid =
+      absl::StrCat(signals.has_highest_scoring_other_bid
+                       ? signals.highest_scoring_other_bid
+                       : 0);
+  const std::string desirability = absl::StrCat(signals.winning_score);
+  const std::string top_window_hostname =
+      PercentEncode(dispatch_request_data.publisher_hostname);
+  const std::string interest_group_owner =
+      PercentEncode(signals.winning_ig_owner);
+  const std::string interest_group_name =
+      PercentEncode(signals.winning_ig_name);
+  const std::string render_url = PercentEncode(signals.winning_ad_render_url);
+  // Values are in the order of kReportingUrlPlaceholders.
+  const absl::string_view values[] = {
+      winning_bid,         bid_currency,         highest_scoring_other_bid,
+      desirability,        top_window_hostname,  interest_group_owner,
+      interest_group_name, render_url};
+  static_assert(std::size(values) == kReportingUrlPlaceholders.size());
+  return GetReportingUrlTemplateCache().GetOrParse(url_template)->Render(
+      values);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
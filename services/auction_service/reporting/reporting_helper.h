@@ -15,6 +15,7 @@
 #ifndef SERVICES_AUCTION_SERVICE_REPORTING_REPORTING_HELPER_H_
 #define SERVICES_AUCTION_SERVICE_REPORTING_REPORTING_HELPER_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/auction_service/reporting/reporting_response.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
@@ -76,6 +78,14 @@ inline constexpr char kMadeHighestScoringOtherBid[] =
 inline constexpr char kInteractionReportingUrlsWrapperResponse[] =
     "interactionReportingUrls";
 
+// Placeholders of the reporting URL templates, see RenderReportingUrl.
+inline constexpr std::array<absl::string_view, 8> kReportingUrlPlaceholders = {
+    "${winningBid}",         "${bidCurrency}",
+    "${highestScoringOtherBid}",
+    "${desirability}",       "${topWindowHostname}",
+    "${interestGroupOwner}", "${interestGroupName}",
+    "${renderUrl}"};
+
 enum class ReportingArgs : int {
   kAuctionConfig = 0,
   kSellerReportingSignals,
@@ -179,6 +189,15 @@ DispatchRequest GetReportingDispatchRequest(
     const ReportingDispatchRequestConfig& dispatch_request_config,
     const ReportingDispatchRequestData& dispatch_request_data);
 
+// Renders a reporting URL template natively, in place of running a
+// reportResult or reportWin that only builds a URL from the signals of the
+// auction. The kReportingUrlPlaceholders of the template are replaced by the
+// signals of the auction in `dispatch_request_data`, percent-encoded. Parsed
+// templates are cached across auctions.
+std::string RenderReportingUrl(
+    absl::string_view url_template,
+    const ReportingDispatchRequestData& dispatch_request_data);
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_AUCTION_SERVICE_REPORTING_REPORTING_HELPER_H_
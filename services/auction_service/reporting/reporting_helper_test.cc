@@ -585,5 +585,40 @@ TEST(GetReportingDispatchRequest,
   EXPECT_EQ(request.handler_name, kReportingProtectedAppSignalsFunctionName);
   EXPECT_EQ(request.version_string, kReportingBlobVersion);
 }
+
+TEST(RenderReportingUrl, ReplacesPlaceholdersWithEncodedSignals) {
+  server_common::log::ContextImpl log_context(
+      {}, server_common::ConsentedDebugConfiguration());
+  ReportingDispatchRequestData dispatch_request_data = {
+      .post_auction_signals = {.winning_ig_name = "ig name",
+                               .winning_ig_owner = "https://owner.com",
+                               .winning_bid = 1.5,
+                               .winning_bid_currency = "USD",
+                               .highest_scoring_other_bid = 0.75,
+                               .has_highest_scoring_other_bid = true,
+                               .winning_score = 3,
+                               .winning_ad_render_url =
+                                   "https://ad.com/?a=1&b=2"},
+      .publisher_hostname = "publisher.com",
+      .log_context = log_context};
+  EXPECT_EQ(
+      RenderReportingUrl(
+          "https://report.com/?bid=${winningBid}&cur=${bidCurrency}"
+          "&other=${highestScoringOtherBid}&score=${desirability}"
+          "&top=${topWindowHostname}&owner=${interestGroupOwner}"
+          "&ig=${interestGroupName}&ad=${renderUrl}",
+          dispatch_request_data),
+      "https://report.com/?bid=1.5&cur=USD&other=0.75&score=3"
+      "&top=publisher.com&owner=https%3A%2F%2Fowner.com&ig=ig%20name"
+      "&ad=https%3A%2F%2Fad.com%2F%3Fa%3D1%26b%3D2");
+
+  dispatch_request_data.post_auction_signals.has_highest_scoring_other_bid =
+      false;
+  EXPECT_EQ(RenderReportingUrl("https://report.com/?other="
+                               "${highestScoringOtherBid}",
+                               dispatch_request_data),
+            "https://report.com/?other=0");
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -34,6 +34,10 @@ inline constexpr absl::string_view JS_NUM_WORKERS = "JS_NUM_WORKERS";
 inline constexpr absl::string_view JS_WORKER_QUEUE_LEN = "JS_WORKER_QUEUE_LEN";
 inline constexpr absl::string_view ENABLE_REPORT_WIN_INPUT_NOISING =
     "ENABLE_REPORT_WIN_INPUT_NOISING";
+inline constexpr absl::string_view AUCTION_CONFIG_CACHE_SIZE =
+    "AUCTION_CONFIG_CACHE_SIZE";
+inline constexpr absl::string_view SCORE_AD_RESPONSE_PARSE_THREADS =
+    "SCORE_AD_RESPONSE_PARSE_THREADS";
 inline constexpr char
     AUCTION_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND[] =
         "AUCTION_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND";
@@ -41,7 +45,15 @@ inline constexpr absl::string_view
     AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES =
         "AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES";
 
-inline constexpr int kNumRuntimeFlags = 9;
+inline constexpr absl::string_view ENABLE_ROMA_ADMISSION_CONTROL =
+    "ENABLE_ROMA_ADMISSION_CONTROL";
+inline constexpr absl::string_view ROMA_MAX_BATCH_SIZE = "ROMA_MAX_BATCH_SIZE";
+inline constexpr absl::string_view SCORE_ADS_MAX_CHUNK_SIZE =
+    "SCORE_ADS_MAX_CHUNK_SIZE";
+inline constexpr absl::string_view SCORE_ADS_OWNER_BUDGET_MS =
+    "SCORE_ADS_OWNER_BUDGET_MS";
+
+inline constexpr int kNumRuntimeFlags = 15;
 inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     PORT,
     HEALTHCHECK_PORT,
@@ -52,6 +64,12 @@ inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     ENABLE_REPORT_WIN_INPUT_NOISING,
     AUCTION_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND,
     AUCTION_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES,
+    AUCTION_CONFIG_CACHE_SIZE,
+    SCORE_AD_RESPONSE_PARSE_THREADS,
+    ENABLE_ROMA_ADMISSION_CONTROL,
+    ROMA_MAX_BATCH_SIZE,
+    SCORE_ADS_MAX_CHUNK_SIZE,
+    SCORE_ADS_OWNER_BUDGET_MS,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
@@ -16,7 +16,6 @@
 
 #include <algorithm>
 #include <limits>
-#include <list>
 #include <optional>
 #include <string>
 #include <utility>
@@ -26,13 +25,19 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_replace.h"
+#include "absl/types/span.h"
 #include "rapidjson/document.h"
 #include "services/auction_service/auction_constants.h"
 #include "services/auction_service/code_wrapper/seller_code_wrapper.h"
 #include "services/auction_service/reporting/reporting_response.h"
 #include "services/auction_service/utils/proto_utils.h"
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
 #include "services/common/util/auction_scope_util.h"
+#include "services/common/util/cycle_clock.h"
 #include "services/common/util/json_util.h"
+#include "services/common/util/log_throttle.h"
+#include "services/common/util/parallel_for.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/util/status_macro/status_macros.h"
 #include "src/util/status_macro/status_util.h"
@@ -52,6 +57,14 @@ using server_common::log::ContextImpl;
 using server_common::log::PS_VLOG_IS_ON;
 
 constexpr int kBytesMultiplyer = 1024;
+// Minimum number of scoreAd responses parsed by each task. Smaller batches
+// are not worth the overhead of scheduling a task.
+constexpr int kMinScoreAdResponsesPerParseChunk = 64;
+// Ads whose scoreAd inputs are built by the same task.
+constexpr int kBuildInputChunkSize = 64;
+// Minimum interval between the logs of each bad scoreAd response site. A
+// broken script fails for every ad of every request.
+constexpr int kBadResponseLogIntervalSec = 1;
 
 inline void MayVlogRomaResponses(
     const std::vector<absl::StatusOr<DispatchResponse>>& responses,
@@ -70,26 +83,52 @@ inline void MayVlogRomaResponses(
 inline void LogWarningForBadResponse(
     const absl::Status& status, const DispatchResponse& response,
     const AdWithBidMetadata* ad_with_bid_metadata, ContextImpl& log_context) {
-  PS_LOG(ERROR, log_context) << "Failed to parse response from Roma ",
-      status.ToString(absl::StatusToStringMode::kWithEverything);
+  PS_LOG_EVERY_N_SEC(kBadResponseLogIntervalSec, ERROR, log_context)
+      << "Failed to parse response from Roma "
+      << status.ToString(absl::StatusToStringMode::kWithEverything);
   if (ad_with_bid_metadata) {
-    PS_LOG(WARNING, log_context)
+    PS_LOG_EVERY_N_SEC(kBadResponseLogIntervalSec, WARNING, log_context)
         << "Invalid json output from code execution for interest group "
         << ad_with_bid_metadata->interest_group_name() << ": " << response.resp;
   } else {
-    PS_LOG(WARNING, log_context)
+    PS_LOG_EVERY_N_SEC(kBadResponseLogIntervalSec, WARNING, log_context)
         << "Invalid json output from code execution for protected app signals "
            "ad: "
         << response.resp;
   }
 }
 
-inline void UpdateHighestScoringOtherBidMap(
-    float bid, absl::string_view owner,
-    HighestScoringOtherBidsMap& highest_scoring_other_bids_map) {
-  highest_scoring_other_bids_map.try_emplace(owner,
-                                             google::protobuf::ListValue());
-  highest_scoring_other_bids_map.at(owner).add_values()->set_number_value(bid);
+// Parses the output of every scoreAd invocation. The responses are
+// independent from each other, so large batches are split into up to
+// `max_chunks` chunks parsed in parallel over `executor`. The documents are
+// allocated from `json_arenas`, one per chunk, which must outlive them. Score
+// ad records are left unparsed.
+std::vector<absl::StatusOr<rapidjson::Document>> ParseScoreAdResponses(
+    const std::vector<absl::StatusOr<DispatchResponse>>& responses,
+    server_common::Executor* executor, int max_chunks,
+    std::vector<std::unique_ptr<JsonArena>>& json_arenas) {
+  std::vector<absl::StatusOr<rapidjson::Document>> parsed_responses(
+      responses.size());
+  const int num_responses = responses.size();
+  const int num_chunks = std::clamp(
+      num_responses / kMinScoreAdResponsesPerParseChunk, 1, max_chunks);
+  const int chunk_size =
+      std::max(1, (num_responses + num_chunks - 1) / num_chunks);
+  json_arenas.clear();
+  for (int i = 0; i < num_chunks; ++i) {
+    json_arenas.push_back(std::make_unique<JsonArena>());
+  }
+  ParallelForChunks(
+      executor, num_responses, chunk_size, [&](int begin, int end) {
+        JsonArena& json_arena = *json_arenas[begin / chunk_size];
+        for (int i = begin; i < end; ++i) {
+          if (responses[i].ok() && !IsScoreAdRecord(responses[i]->resp)) {
+            parsed_responses[i] =
+                ParseJsonString(responses[i]->resp, json_arena);
+          }
+        }
+      });
+  return parsed_responses;
 }
 
 long DebugReportUrlsLength(const ScoreAdsResponse::AdScore& ad_score) {
@@ -171,19 +210,35 @@ ScoreAdsReactor::ScoreAdsReactor(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
     const AsyncReporter* async_reporter,
-    const AuctionServiceRuntimeConfig& runtime_config)
+    const AuctionServiceRuntimeConfig& runtime_config,
+    AuctionConfigCache* auction_config_cache)
     : CodeDispatchReactor<ScoreAdsRequest, ScoreAdsRequest::ScoreAdsRawRequest,
                           ScoreAdsResponse,
                           ScoreAdsResponse::ScoreAdsRawResponse>(
           dispatcher, request, response, key_fetcher_manager, crypto_client),
       benchmarking_logger_(std::move(benchmarking_logger)),
       async_reporter_(*async_reporter),
+      auction_config_cache_(auction_config_cache),
       enable_seller_debug_url_generation_(
           runtime_config.enable_seller_debug_url_generation),
       roma_timeout_ms_(runtime_config.roma_timeout_ms),
+      roma_batch_deadline_(
+          absl::Milliseconds(runtime_config.roma_batch_deadline_ms)),
+      score_ads_max_chunk_size_(runtime_config.score_ads_max_chunk_size),
+      num_js_workers_(runtime_config.num_js_workers),
+      enable_native_scoring_(runtime_config.enable_native_scoring),
+      native_scoring_bid_floor_(runtime_config.native_scoring_bid_floor),
+      native_scoring_allow_component_auction_(
+          runtime_config.native_scoring_allow_component_auction),
+      roma_cost_account_(runtime_config.score_ads_owner_budget_ms > 0
+                             ? absl::Milliseconds(
+                                   runtime_config.score_ads_owner_budget_ms)
+                             : absl::InfiniteDuration()),
       log_context_(GetLoggingContext(raw_request_),
                    raw_request_.consented_debug_config(),
                    [this]() { return raw_response_.mutable_debug_info(); }),
+      debug_log_(log_context_, raw_request_.consented_debug_config()
+                                   .is_debug_info_in_response()),
       enable_adtech_code_logging_(log_context_.is_consented()),
       enable_report_result_url_generation_(
           runtime_config.enable_report_result_url_generation),
@@ -197,16 +252,18 @@ ScoreAdsReactor::ScoreAdsReactor(
           runtime_config.max_allowed_size_debug_url_bytes),
       max_allowed_size_all_debug_urls_chars_(
           kBytesMultiplyer * runtime_config.max_allowed_size_all_debug_urls_kb),
+      num_score_ad_response_parse_threads_(
+          runtime_config.num_score_ad_response_parse_threads),
       auction_scope_(GetAuctionScope(raw_request_)),
-      code_version_(runtime_config.default_code_version) {
-  CHECK_OK([this]() {
-    PS_ASSIGN_OR_RETURN(metric_context_,
-                        metric::AuctionContextMap()->Remove(request_));
-    if (log_context_.is_consented()) {
-      metric_context_->SetConsented(raw_request_.log_context().generation_id());
-    }
-    return absl::OkStatus();
-  }()) << "AuctionContextMap()->Get(request) should have been called";
+      code_version_(runtime_config.default_code_version),
+      report_result_url_template_(runtime_config.report_result_url_template),
+      buyer_report_win_url_templates_(
+          runtime_config.buyer_report_win_url_templates) {
+  metric_context_ = metric::CreateMetricContext<ScoreAdsRequest>();
+  LogCommonMetric(request_, response_, *metric_context_);
+  if (log_context_.is_consented()) {
+    metric_context_->SetConsented(raw_request_.log_context().generation_id());
+  }
 }
 
 absl::btree_map<std::string, std::string> ScoreAdsReactor::GetLoggingContext(
@@ -223,6 +280,8 @@ absl::Status ScoreAdsReactor::PopulateTopLevelAuctionDispatchRequests(
         component_auction_results) {
   absl::string_view generation_id;
   PS_VLOG(8, log_context_) << __func__;
+  // Component auction winners have no trusted scoring signals.
+  auto scoring_signals = std::make_shared<std::string>("{}");
   for (auto& auction_result : component_auction_results) {
     if (auction_result.is_chaff() ||
         auction_result.auction_params().component_seller().empty()) {
@@ -241,7 +300,7 @@ absl::Status ScoreAdsReactor::PopulateTopLevelAuctionDispatchRequests(
 
     auto dispatch_request = BuildScoreAdRequest(
         auction_result.ad_render_url(), auction_result.ad_metadata(),
-        /*scoring_signals = */ "{}", auction_result.bid(), auction_config,
+        scoring_signals, auction_result.bid(), auction_config,
         MakeBidMetadataForTopLevelAuction(
             raw_request_.publisher_hostname(),
             auction_result.interest_group_owner(),
@@ -257,14 +316,17 @@ absl::Status ScoreAdsReactor::PopulateTopLevelAuctionDispatchRequests(
           << dispatch_request.status();
       continue;
     }
+    MayLogScoreAdsInput(dispatch_request->input, log_context_);
 
     // Map all fields from a component auction result to a
     // AdWithBidMetadata used in this reactor. This way all the parsing
     // and result handling logic for single seller auctions can be
     // re-used for top-level auctions.
     auto [unused_it, inserted] =
-        ad_data_.emplace(dispatch_request->id,
-                         MapAuctionResultToAdWithBidMetadata(auction_result));
+        ad_data_.emplace(dispatch_ids_.Intern(dispatch_request->id),
+                         ArenaAwarePtr<AdWithBidMetadata>(
+                             MapAuctionResultToAdWithBidMetadata(auction_result)
+                                 .release()));
     if (!inserted) {
       PS_VLOG(kNoisyWarn, log_context_)
           << "Protected Audience ScoreAd Request id "
@@ -273,7 +335,9 @@ absl::Status ScoreAdsReactor::PopulateTopLevelAuctionDispatchRequests(
       continue;
     }
 
-    dispatch_request->tags[kRomaTimeoutMs] = roma_timeout_ms_;
+    component_sellers_.emplace(
+        dispatch_ids_.Find(dispatch_request->id),
+        auction_result.auction_params().component_seller());
     dispatch_requests_.push_back(*std::move(dispatch_request));
   }
   return absl::OkStatus();
@@ -281,55 +345,84 @@ absl::Status ScoreAdsReactor::PopulateTopLevelAuctionDispatchRequests(
 
 void ScoreAdsReactor::PopulateProtectedAudienceDispatchRequests(
     bool enable_debug_reporting,
-    const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-        scoring_signals,
+    const TrustedScoringSignals& scoring_signals,
     const std::shared_ptr<std::string>& auction_config,
     google::protobuf::RepeatedPtrField<AdWithBidMetadata>& ads) {
+  std::vector<ArenaAwarePtr<AdWithBidMetadata>> scored_ads;
+  scored_ads.reserve(ads.size());
   while (!ads.empty()) {
-    std::unique_ptr<AdWithBidMetadata> ad(ads.ReleaseLast());
-    if (scoring_signals.contains(ad->render())) {
-      auto dispatch_request = BuildScoreAdRequest(
-          *ad, auction_config, scoring_signals, enable_debug_reporting,
-          log_context_, enable_adtech_code_logging_,
-          MakeBidMetadata(raw_request_.publisher_hostname(),
-                          ad->interest_group_owner(), ad->render(),
-                          ad->ad_components(), raw_request_.top_level_seller(),
-                          ad->bid_currency()),
-          code_version_);
-      if (!dispatch_request.ok()) {
-        PS_VLOG(kNoisyWarn, log_context_)
-            << "Failed to create scoring request for protected audience: "
-            << dispatch_request.status();
-        continue;
-      }
-      auto [unused_it, inserted] =
-          ad_data_.emplace(dispatch_request->id, std::move(ad));
-      if (!inserted) {
-        PS_VLOG(kNoisyWarn, log_context_)
-            << "Protected Audience ScoreAd Request id "
-               "conflict detected: "
-            << dispatch_request->id;
-        continue;
-      }
+    ArenaAwarePtr<AdWithBidMetadata> ad(ads.UnsafeArenaReleaseLast());
+    if (scoring_signals.contains(ScoringSignalsKey(*ad))) {
+      scored_ads.push_back(std::move(ad));
+    }
+  }
 
-      dispatch_request->tags[kRomaTimeoutMs] = roma_timeout_ms_;
-      dispatch_requests_.push_back(*std::move(dispatch_request));
+  // The requests of large auctions are built in chunks over the executor,
+  // then merged in order.
+  std::vector<absl::StatusOr<DispatchRequest>> dispatch_requests(
+      scored_ads.size());
+  ParallelForChunks(
+      dispatcher_.executor(), scored_ads.size(), kBuildInputChunkSize,
+      [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          const AdWithBidMetadata& ad = *scored_ads[i];
+          if (enable_native_scoring_) {
+            // Only the id is used, no input of scoreAd is needed.
+            DispatchRequest dispatch_request;
+            dispatch_request.id = ad.render();
+            dispatch_requests[i] = std::move(dispatch_request);
+            continue;
+          }
+          dispatch_requests[i] = BuildScoreAdRequest(
+              ad, auction_config, scoring_signals, enable_debug_reporting,
+              log_context_, enable_adtech_code_logging_,
+              MakeBidMetadata(raw_request_.publisher_hostname(),
+                              ad.interest_group_owner(), ad.render(),
+                              ad.ad_components(),
+                              raw_request_.top_level_seller(),
+                              ad.bid_currency()),
+              code_version_);
+        }
+      });
+
+  dispatch_requests_.reserve(dispatch_requests_.size() + scored_ads.size());
+  for (int i = 0; i < scored_ads.size(); ++i) {
+    absl::StatusOr<DispatchRequest>& dispatch_request = dispatch_requests[i];
+    if (!dispatch_request.ok()) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Failed to create scoring request for protected audience: "
+          << dispatch_request.status();
+      continue;
+    }
+    // The inputs are logged once merged, from this thread only.
+    if (!enable_native_scoring_) {
+      MayLogScoreAdsInput(dispatch_request->input, log_context_);
+    }
+    auto [unused_it, inserted] = ad_data_.emplace(
+        dispatch_ids_.Intern(dispatch_request->id), std::move(scored_ads[i]));
+    if (!inserted) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Protected Audience ScoreAd Request id "
+             "conflict detected: "
+          << dispatch_request->id;
+      continue;
     }
+
+    dispatch_requests_.push_back(*std::move(dispatch_request));
   }
 }
 
 void ScoreAdsReactor::MayPopulateProtectedAppSignalsDispatchRequests(
     bool enable_debug_reporting,
-    const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-        scoring_signals,
+    const TrustedScoringSignals& scoring_signals,
     const std::shared_ptr<std::string>& auction_config,
     RepeatedPtrField<ProtectedAppSignalsAdWithBidMetadata>&
         protected_app_signals_ad_bids) {
   PS_VLOG(8, log_context_) << __func__;
   while (!protected_app_signals_ad_bids.empty()) {
-    std::unique_ptr<ProtectedAppSignalsAdWithBidMetadata> pas_ad_with_bid(
-        protected_app_signals_ad_bids.ReleaseLast());
-    if (!scoring_signals.contains(pas_ad_with_bid->render())) {
+    ArenaAwarePtr<ProtectedAppSignalsAdWithBidMetadata> pas_ad_with_bid(
+        protected_app_signals_ad_bids.UnsafeArenaReleaseLast());
+    if (!scoring_signals.contains(ScoringSignalsKey(*pas_ad_with_bid))) {
       PS_VLOG(5, log_context_)
           << "Skipping protected app signals ad since render "
              "URL is not found in the scoring signals: "
@@ -351,9 +444,10 @@ void ScoreAdsReactor::MayPopulateProtectedAppSignalsDispatchRequests(
           << dispatch_request.status();
       continue;
     }
+    MayLogScoreAdsInput(dispatch_request->input, log_context_);
 
     auto [unused_it, inserted] = protected_app_signals_ad_data_.emplace(
-        dispatch_request->id, std::move(pas_ad_with_bid));
+        dispatch_ids_.Intern(dispatch_request->id), std::move(pas_ad_with_bid));
     if (!inserted) {
       PS_VLOG(kNoisyWarn, log_context_)
           << "ProtectedAppSignals ScoreAd Request id conflict detected: "
@@ -361,16 +455,14 @@ void ScoreAdsReactor::MayPopulateProtectedAppSignalsDispatchRequests(
       continue;
     }
 
-    dispatch_request->tags[kRomaTimeoutMs] = roma_timeout_ms_;
     dispatch_requests_.push_back(*std::move(dispatch_request));
   }
 }
 
 void ScoreAdsReactor::Execute() {
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted ScoreAdsRequest:\n"
-                                    << request_->ShortDebugString();
-  PS_VLOG(kPlain, log_context_) << "ScoreAdsRawRequest:\n"
-                                << raw_request_.ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted ScoreAdsRequest:\n",
+                        *request_);
+  debug_log_.AddMessage(kPlain, "ScoreAdsRawRequest:\n", raw_request_);
 
   DCHECK(raw_request_.protected_app_signals_ad_bids().empty() ||
          enable_protected_app_signals_)
@@ -389,9 +481,17 @@ void ScoreAdsReactor::Execute() {
     return;
   }
 
+  // Nothing is scored once the client has given up on the call.
+  absl::StatusOr<std::string> roma_timeout_ms = RomaTimeoutMs(roma_timeout_ms_);
+  if (!roma_timeout_ms.ok()) {
+    PS_LOG(ERROR, log_context_)
+        << "Skipping scoreAd: " << roma_timeout_ms.status();
+    FinishWithStatus(server_common::FromAbslStatus(roma_timeout_ms.status()));
+    return;
+  }
+
   benchmarking_logger_->BuildInputBegin();
-  std::shared_ptr<std::string> auction_config =
-      BuildAuctionConfig(raw_request_);
+  const std::shared_ptr<std::string>& auction_config = GetAuctionConfig();
   bool enable_debug_reporting = enable_seller_debug_url_generation_ &&
                                 raw_request_.enable_debug_reporting();
   if (auction_scope_ == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
@@ -414,9 +514,8 @@ void ScoreAdsReactor::Execute() {
     auto ads = raw_request_.ad_bids();
     auto protected_app_signals_ad_bids =
         raw_request_.protected_app_signals_ad_bids();
-    absl::StatusOr<absl::flat_hash_map<std::string, rapidjson::StringBuffer>>
-        scoring_signals =
-            BuildTrustedScoringSignals(raw_request_, log_context_);
+    absl::StatusOr<TrustedScoringSignals> scoring_signals =
+        BuildTrustedScoringSignals(raw_request_, log_context_);
 
     if (!scoring_signals.ok()) {
       PS_LOG(ERROR, log_context_) << "No scoring signals found, finishing RPC: "
@@ -439,24 +538,102 @@ void ScoreAdsReactor::Execute() {
                                     kNoAdsWithValidScoringSignals));
     return;
   }
-  absl::Time start_js_execution_time = absl::Now();
-  auto status = dispatcher_.BatchExecute(
-      dispatch_requests_,
-      [this, start_js_execution_time, enable_debug_reporting](
-          const std::vector<absl::StatusOr<DispatchResponse>>& result) {
-        int js_execution_time_ms =
-            (absl::Now() - start_js_execution_time) / absl::Milliseconds(1);
-        LogIfError(metric_context_->LogHistogram<metric::kJSExecutionDuration>(
-            js_execution_time_ms));
-        ScoreAdsCallback(result, enable_debug_reporting);
-      });
+  if (enable_native_scoring_) {
+    // Roma is skipped, FindWinningAd scores the ads.
+    std::vector<absl::StatusOr<DispatchResponse>> responses;
+    responses.reserve(dispatch_requests_.size());
+    for (const DispatchRequest& dispatch_request : dispatch_requests_) {
+      DispatchResponse response;
+      response.id = dispatch_request.id;
+      responses.push_back(std::move(response));
+    }
+    ScoreAdsCallback(responses, enable_debug_reporting);
+    return;
+  }
+  for (DispatchRequest& dispatch_request : dispatch_requests_) {
+    dispatch_request.tags[kRomaTimeoutMs] = *roma_timeout_ms;
+  }
+  CycleTimer js_execution_timer;
+  roma_execution_timer_.emplace(absl::Now());
+  phase_tracer_.Start(RequestPhase::kRomaDispatch);
+  std::vector<DispatchRequest>& batch = MayBuildScoreAdsChunks();
+  absl::Status status;
+  if (roma_batch_deadline_ > absl::ZeroDuration()) {
+    // The winner is only picked once the batch ends, out of the ads scored
+    // by the deadline.
+    streamed_responses_.assign(
+        dispatch_requests_.size(),
+        absl::DeadlineExceededError("Ad not scored by the batch deadline"));
+    status = dispatcher_.BatchExecuteStreaming(
+        batch,
+        [this](int index, absl::StatusOr<DispatchResponse> response) {
+          roma_execution_timer_->AddResponse(response);
+          AccountRomaCost(index, response);
+          if (score_ads_chunks_.empty()) {
+            streamed_responses_[index] = std::move(response);
+          } else {
+            SplitChunkResponse(index, response, streamed_responses_);
+          }
+        },
+        [this, js_execution_timer,
+         enable_debug_reporting](bool deadline_exceeded) {
+          if (deadline_exceeded) {
+            PS_VLOG(kNoisyWarn, log_context_)
+                << "Batch deadline reached before all ads were scored";
+          }
+          phase_tracer_.End(RequestPhase::kRomaDispatch);
+          int js_execution_time_ms =
+              js_execution_timer.Elapsed() / absl::Milliseconds(1);
+          LogIfError(
+              metric_context_->LogHistogram<metric::kJSExecutionDuration>(
+                  js_execution_time_ms));
+          metric::LogJSExecutionSplit(roma_execution_timer_->queue_waits(),
+                                      roma_execution_timer_->executions(),
+                                      roma_execution_timer_->GetSkew(),
+                                      *metric_context_);
+          LogRomaCostByOwner();
+          ScoreAdsCallback(streamed_responses_, enable_debug_reporting);
+        },
+        roma_batch_deadline_);
+  } else {
+    status = dispatcher_.BatchExecute(
+        batch,
+        [this, js_execution_timer, enable_debug_reporting](
+            const std::vector<absl::StatusOr<DispatchResponse>>& result) {
+          phase_tracer_.End(RequestPhase::kRomaDispatch);
+          int js_execution_time_ms =
+              js_execution_timer.Elapsed() / absl::Milliseconds(1);
+          LogIfError(
+              metric_context_->LogHistogram<metric::kJSExecutionDuration>(
+                  js_execution_time_ms));
+          roma_execution_timer_->AddBatch(result);
+          metric::LogJSExecutionSplit(roma_execution_timer_->queue_waits(),
+                                      roma_execution_timer_->executions(),
+                                      roma_execution_timer_->GetSkew(),
+                                      *metric_context_);
+          for (int index = 0; index < result.size(); ++index) {
+            AccountRomaCost(index, result[index]);
+          }
+          LogRomaCostByOwner();
+          if (score_ads_chunks_.empty()) {
+            ScoreAdsCallback(result, enable_debug_reporting);
+            return;
+          }
+          std::vector<absl::StatusOr<DispatchResponse>> ad_responses(
+              dispatch_requests_.size());
+          for (int index = 0; index < result.size(); ++index) {
+            SplitChunkResponse(index, result[index], ad_responses);
+          }
+          ScoreAdsCallback(ad_responses, enable_debug_reporting);
+        });
+  }
 
   if (!status.ok()) {
     LogIfError(metric_context_
                    ->AccumulateMetric<metric::kAuctionErrorCountByErrorCode>(
                        1, metric::kAuctionScoreAdsFailedToDispatchCode));
     PS_LOG(ERROR, log_context_)
-        << "Execution request failed for batch: " << raw_request_.DebugString()
+        << "Execution request failed for batch: "
         << status.ToString(absl::StatusToStringMode::kWithEverything);
     LogIfError(
         metric_context_->LogUpDownCounter<metric::kJSExecutionErrorCount>(1));
@@ -465,18 +642,32 @@ void ScoreAdsReactor::Execute() {
   }
 }
 
+const std::shared_ptr<std::string>& ScoreAdsReactor::GetAuctionConfig() {
+  if (auction_config_ == nullptr) {
+    auction_config_ = auction_config_cache_ != nullptr
+                          ? auction_config_cache_->GetOrBuild(raw_request_)
+                          : BuildAuctionConfig(raw_request_);
+  }
+  return auction_config_;
+}
+
 void ScoreAdsReactor::PerformReporting(
-    const ScoreAdsResponse::AdScore& winning_ad_score, absl::string_view id) {
+    const ScoreAdsResponse::AdScore& winning_ad_score, absl::string_view id,
+    PostAuctionSignals post_auction_signals) {
   if (auction_scope_ == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
-    // TODO: Implement reporting for top level auction
-    // The following properties will not be available:
-    // raw_request_.per_buyer_signals()
-    // ad->join_count()
-    // ad->recency()
-    // ad->modeling_signals(),
-    // ad->ad_cost()
-    benchmarking_logger_->HandleResponseEnd();
-    EncryptAndFinishOK();
+    // The buyer and the component seller of the winning ad already reported
+    // in its component auction, so only the top-level seller's reportResult
+    // runs here.
+    auto component_seller_it = component_sellers_.find(id);
+    if (component_seller_it == component_sellers_.end()) {
+      PS_LOG(ERROR, log_context_)
+          << "No component seller found for the winning ad: " << id;
+      benchmarking_logger_->HandleResponseEnd();
+      EncryptAndFinishOK();
+      return;
+    }
+    DispatchReportingRequestForTopLevelAuction(std::move(post_auction_signals),
+                                               component_seller_it->second);
     return;
   }
   if (auto ad_it = ad_data_.find(id); ad_it != ad_data_.end()) {
@@ -499,8 +690,8 @@ void ScoreAdsReactor::PerformReporting(
       }
     }
     DispatchReportingRequestForPA(winning_ad_score,
-                                  BuildAuctionConfig(raw_request_),
-                                  buyer_reporting_metadata);
+                                  std::move(post_auction_signals),
+                                  GetAuctionConfig(), buyer_reporting_metadata);
 
   } else if (auto protected_app_signals_ad_it =
                  protected_app_signals_ad_data_.find(id);
@@ -518,7 +709,7 @@ void ScoreAdsReactor::PerformReporting(
           .ad_cost = ad->ad_cost()};
     }
     DispatchReportingRequestForPAS(
-        winning_ad_score, BuildAuctionConfig(raw_request_),
+        std::move(post_auction_signals), GetAuctionConfig(),
         buyer_reporting_metadata, ad->egress_payload(),
         ad->temporary_unlimited_egress_payload());
   } else {
@@ -531,25 +722,15 @@ void ScoreAdsReactor::PerformReporting(
   }
 }
 
-void ScoreAdsReactor::HandleScoredAd(int index, float buyer_bid,
-                                     absl::string_view ad_with_bid_currency,
-                                     absl::string_view interest_group_name,
-                                     absl::string_view interest_group_owner,
-                                     absl::string_view interest_group_origin,
-                                     const rapidjson::Document& response_json,
-                                     AdType ad_type,
-                                     ScoreAdsResponse::AdScore& ad_score,
-                                     ScoringData& scoring_data,
-                                     const std::string& dispatch_response_id) {
-  // Get ad rejection reason before updating the scoring data.
-  std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
-      ad_rejection_reason;
-  if (!response_json.IsNumber()) {
-    // Parse Ad rejection reason and store only if it has value.
-    ad_rejection_reason = ParseAdRejectionReason(
-        response_json, interest_group_owner, interest_group_name, log_context_);
-  }
-
+void ScoreAdsReactor::HandleScoredAd(
+    int index, float buyer_bid, absl::string_view ad_with_bid_currency,
+    absl::string_view interest_group_name,
+    absl::string_view interest_group_owner,
+    absl::string_view interest_group_origin,
+    std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
+        ad_rejection_reason,
+    AdType ad_type, ScoreAdsResponse::AdScore& ad_score,
+    ScoringData& scoring_data, const std::string& dispatch_response_id) {
   ad_score.set_interest_group_name(interest_group_name);
   ad_score.set_interest_group_owner(interest_group_owner);
   ad_score.set_interest_group_origin(interest_group_origin);
@@ -559,7 +740,7 @@ void ScoreAdsReactor::HandleScoredAd(int index, float buyer_bid,
   // Used for debug reporting.
   // Should include bids rejected by bid currency mismatch
   // and those not allowed in component auctions.
-  ad_scores_.emplace(dispatch_response_id,
+  ad_scores_.emplace(dispatch_ids_.Intern(dispatch_response_id),
                      std::make_unique<ScoreAdsResponse::AdScore>(ad_score));
 
   if (CheckAndUpdateModifiedBid(auction_scope_, buyer_bid, ad_with_bid_currency,
@@ -634,7 +815,7 @@ void ScoreAdsReactor::HandleScoredAd(int index, float buyer_bid,
     // set to
     //    "not-available".
     // Only consider valid bids for populating other highest bids.
-    scoring_data.score_ad_map[ad_score.desirability()].push_back(index);
+    scoring_data.highest_scores.Add(ad_score.desirability(), index);
     return;
   }
 
@@ -653,10 +834,85 @@ void ScoreAdsReactor::HandleScoredAd(int index, float buyer_bid,
   }
   scoring_data.ad_rejection_reasons.push_back(*ad_rejection_reason);
   scoring_data.seller_rejected_bid_count += 1;
-  LogIfError(
-      metric_context_->AccumulateMetric<metric::kAuctionBidRejectedCount>(
-          1, ToSellerRejectionReasonString(
-                 ad_rejection_reason->rejection_reason())));
+  scoring_data.rejected_bid_counts.Add(
+      ToSellerRejectionReasonString(ad_rejection_reason->rejection_reason()));
+}
+
+std::vector<DispatchRequest>& ScoreAdsReactor::MayBuildScoreAdsChunks() {
+  const int num_ads = dispatch_requests_.size();
+  int chunk_size = score_ads_max_chunk_size_;
+  if (num_js_workers_ > 0) {
+    // Smaller chunks are spread over more workers.
+    chunk_size =
+        std::min(chunk_size, (num_ads + num_js_workers_ - 1) / num_js_workers_);
+  }
+  if (chunk_size <= 1) {
+    return dispatch_requests_;
+  }
+  score_ads_chunk_size_ = chunk_size;
+  const absl::Span<const DispatchRequest> ads(dispatch_requests_);
+  score_ads_chunks_.reserve((num_ads + chunk_size - 1) / chunk_size);
+  for (int begin = 0; begin < num_ads; begin += chunk_size) {
+    score_ads_chunks_.push_back(
+        BuildScoreAdsChunkRequest(ads.subspan(begin, chunk_size)));
+  }
+  return score_ads_chunks_;
+}
+
+void ScoreAdsReactor::SplitChunkResponse(
+    int chunk_index, const absl::StatusOr<DispatchResponse>& chunk_response,
+    std::vector<absl::StatusOr<DispatchResponse>>& ad_responses) {
+  const int begin = chunk_index * score_ads_chunk_size_;
+  const int end = std::min<int>(begin + score_ads_chunk_size_,
+                                dispatch_requests_.size());
+  absl::StatusOr<std::vector<std::string>> outputs =
+      chunk_response.ok()
+          ? SplitScoreAdsChunkResponse(chunk_response->resp, end - begin)
+          : chunk_response.status();
+  for (int index = begin; index < end; ++index) {
+    if (!outputs.ok()) {
+      ad_responses[index] = outputs.status();
+      continue;
+    }
+    DispatchResponse ad_response;
+    ad_response.id = dispatch_requests_[index].id;
+    ad_response.resp = std::move((*outputs)[index - begin]);
+    ad_responses[index] = std::move(ad_response);
+  }
+}
+
+void ScoreAdsReactor::AccountRomaCost(
+    int index, const absl::StatusOr<DispatchResponse>& response) {
+  std::optional<absl::Duration> cost = GetRomaExecutionDuration(response);
+  if (!cost.has_value()) {
+    return;
+  }
+  int begin = index;
+  int end = index + 1;
+  if (!score_ads_chunks_.empty()) {
+    begin = index * score_ads_chunk_size_;
+    end = std::min<int>(begin + score_ads_chunk_size_,
+                        dispatch_requests_.size());
+  }
+  const absl::Duration cost_per_ad = *cost / (end - begin);
+  for (int i = begin; i < end; ++i) {
+    AdWithBidMetadata* ad = nullptr;
+    ProtectedAppSignalsAdWithBidMetadata* protected_app_signals_ad = nullptr;
+    FindScoredAdType(dispatch_requests_[i].id, &ad, &protected_app_signals_ad);
+    if (ad) {
+      roma_cost_account_.Add(ad->interest_group_owner(), cost_per_ad);
+    } else if (protected_app_signals_ad) {
+      roma_cost_account_.Add(protected_app_signals_ad->owner(), cost_per_ad);
+    }
+  }
+}
+
+void ScoreAdsReactor::LogRomaCostByOwner() {
+  for (const auto& [owner, cost] : roma_cost_account_.costs()) {
+    LogIfError(metric_context_
+                   ->AccumulateMetric<metric::kJSExecutionDurationByOwner>(
+                       static_cast<int>(cost / absl::Milliseconds(1)), owner));
+  }
 }
 
 void ScoreAdsReactor::FindScoredAdType(
@@ -678,20 +934,30 @@ ScoringData ScoreAdsReactor::FindWinningAd(
     const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
   ScoringData scoring_data;
   int64_t current_all_debug_urls_chars = 0;
+  const bool device_component_auction =
+      auction_scope_ ==
+          AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER ||
+      auction_scope_ ==
+          AuctionScope::AUCTION_SCOPE_SERVER_COMPONENT_MULTI_SELLER;
+  // Holds the memory of the parsed responses until the winner is found.
+  std::vector<std::unique_ptr<JsonArena>> json_arenas;
+  std::vector<absl::StatusOr<rapidjson::Document>> parsed_responses;
+  if (!enable_native_scoring_) {
+    parsed_responses =
+        ParseScoreAdResponses(responses, dispatcher_.executor(),
+                              num_score_ad_response_parse_threads_,
+                              json_arenas);
+  }
   for (int index = 0; index < responses.size(); ++index) {
     const auto& response = responses[index];
     if (!response.ok()) {
-      PS_LOG(WARNING, log_context_)
+      PS_LOG_EVERY_N_SEC(kBadResponseLogIntervalSec, WARNING, log_context_)
           << "Invalid execution (possibly invalid input): "
           << responses[index].status().ToString(
                  absl::StatusToStringMode::kWithEverything);
       continue;
     }
 
-    absl::StatusOr<rapidjson::Document> response_json =
-        ParseAndGetScoreAdResponseJson(enable_adtech_code_logging_,
-                                       response->resp, log_context_);
-
     // Determine what type of ad was scored in this response.
     AdWithBidMetadata* ad = nullptr;
     ProtectedAppSignalsAdWithBidMetadata* protected_app_signals_ad_with_bid =
@@ -707,21 +973,71 @@ ScoringData ScoreAdsReactor::FindWinningAd(
           << response->resp;
       continue;
     }
-
-    if (!response_json.ok()) {
-      LogWarningForBadResponse(response_json.status(), *response, ad,
-                               log_context_);
+    absl::string_view interest_group_owner =
+        ad ? ad->interest_group_owner()
+           : protected_app_signals_ad_with_bid->owner();
+    absl::string_view interest_group_name =
+        ad ? absl::string_view(ad->interest_group_name()) : "";
+    if (roma_cost_account_.IsOverBudget(interest_group_owner)) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Ad of " << interest_group_owner
+          << " not considered, its owner is over its scoring budget";
+      LogIfError(
+          metric_context_
+              ->AccumulateMetric<metric::kAuctionBidOverBudgetCountByOwner>(
+                  1, std::string(interest_group_owner)));
       continue;
     }
 
-    auto ad_score = ParseScoreAdResponse(
-        *response_json, max_allowed_size_debug_url_chars_,
-        max_allowed_size_all_debug_urls_chars_,
-        (auction_scope_ ==
-             AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER ||
-         auction_scope_ ==
-             AuctionScope::AUCTION_SCOPE_SERVER_COMPONENT_MULTI_SELLER),
-        current_all_debug_urls_chars);
+    absl::StatusOr<ScoreAdsResponse::AdScore> ad_score;
+    // Get ad rejection reason before updating the scoring data.
+    std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
+        ad_rejection_reason;
+    if (enable_native_scoring_) {
+      std::optional<SellerRejectionReason> rejection_reason;
+      ad_score = ScoreAdNatively(
+          ad ? ad->bid() : protected_app_signals_ad_with_bid->bid(),
+          ad ? absl::string_view(ad->bid_currency()) : "",
+          raw_request_.seller_currency(), native_scoring_bid_floor_,
+          native_scoring_allow_component_auction_, device_component_auction,
+          rejection_reason);
+      if (rejection_reason.has_value()) {
+        ad_rejection_reason = ScoreAdsResponse::AdScore::AdRejectionReason{};
+        ad_rejection_reason->set_interest_group_owner(interest_group_owner);
+        ad_rejection_reason->set_interest_group_name(interest_group_name);
+        ad_rejection_reason->set_rejection_reason(*rejection_reason);
+      }
+    } else if (IsScoreAdRecord(response->resp)) {
+      // The common fields of the output are read without parsing JSON.
+      absl::string_view reject_reason;
+      ad_score = ParseScoreAdRecord(response->resp, device_component_auction,
+                                    reject_reason);
+      if (ad_score.ok()) {
+        ad_rejection_reason = ParseAdRejectionReason(
+            reject_reason, interest_group_owner, interest_group_name);
+      }
+    } else {
+      absl::StatusOr<rapidjson::Document> response_json =
+          std::move(parsed_responses[index]);
+      if (!response_json.ok()) {
+        LogWarningForBadResponse(response_json.status(), *response, ad,
+                                 log_context_);
+        continue;
+      }
+      *response_json =
+          GetScoreAdResponseJson(enable_adtech_code_logging_, *response_json,
+                                 log_context_, json_arenas[0].get());
+      ad_score = ParseScoreAdResponse(
+          *response_json, max_allowed_size_debug_url_chars_,
+          max_allowed_size_all_debug_urls_chars_, device_component_auction,
+          current_all_debug_urls_chars);
+      if (ad_score.ok() && !response_json->IsNumber()) {
+        // Parse Ad rejection reason and store only if it has value.
+        ad_rejection_reason =
+            ParseAdRejectionReason(*response_json, interest_group_owner,
+                                   interest_group_name, log_context_);
+      }
+    }
     if (!ad_score.ok()) {
       LogWarningForBadResponse(ad_score.status(), *response, ad, log_context_);
       continue;
@@ -731,14 +1047,16 @@ ScoringData ScoreAdsReactor::FindWinningAd(
     if (ad) {
       HandleScoredAd(index, ad->bid(), ad->bid_currency(),
                      ad->interest_group_name(), ad->interest_group_owner(),
-                     ad->interest_group_origin(), *response_json,
+                     ad->interest_group_origin(),
+                     std::move(ad_rejection_reason),
                      AdType::AD_TYPE_PROTECTED_AUDIENCE_AD, *ad_score,
                      scoring_data, response->id);
     } else {
       HandleScoredAd(index, protected_app_signals_ad_with_bid->bid(),
                      /*ad_with_bid_currency=*/"", /*interest_group_name=*/"",
                      protected_app_signals_ad_with_bid->owner(),
-                     /*interest_group_origin=*/"", *response_json,
+                     /*interest_group_origin=*/"",
+                     std::move(ad_rejection_reason),
                      AdType::AD_TYPE_PROTECTED_APP_SIGNALS_AD, *ad_score,
                      scoring_data, response->id);
     }
@@ -768,32 +1086,19 @@ void ScoreAdsReactor::PopulateRelevantFieldsInResponse(
 
 void ScoreAdsReactor::PopulateHighestScoringOtherBidsData(
     int index_of_most_desirable_ad_score,
-    const absl::flat_hash_map<float, std::list<int>>& score_ad_map,
+    const TopScores<kNumHighestScoringOtherBidsTiers>& highest_scores,
     const std::vector<absl::StatusOr<DispatchResponse>>& responses,
     ScoreAdsResponse::AdScore& winning_ad_score) {
   if (auction_scope_ == AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
     return;
   }
-  std::vector<float> scores_list;
-  // Logic to calculate the list of highest scoring other bids and
-  // corresponding IG owners.
-  for (const auto& [score, unused_ad_indices] : score_ad_map) {
-    scores_list.push_back(score);
-  }
-
-  // Sort the scores in descending order.
-  std::sort(scores_list.begin(), scores_list.end(),
-            [](int a, int b) { return a > b; });
-
   // Add all the bids with the top 2 scores (excluding the winner and bids
   // with 0 score) and corresponding interest group owners to
   // ig_owner_highest_scoring_other_bids_map.
-  for (int i = 0; i < 2 && i < scores_list.size(); i++) {
-    if (scores_list.at(i) == 0) {
-      break;
-    }
-
-    for (int current_index : score_ad_map.at(scores_list.at(i))) {
+  auto& highest_scoring_other_bids_map =
+      *winning_ad_score.mutable_ig_owner_highest_scoring_other_bids_map();
+  for (const auto& tier : highest_scores.tiers()) {
+    for (int current_index : tier.indices) {
       if (index_of_most_desirable_ad_score == current_index) {
         continue;
       }
@@ -806,17 +1111,15 @@ void ScoreAdsReactor::PopulateHighestScoringOtherBidsData(
                        &protected_app_signals_ad_with_bid);
       DCHECK(ad_with_bid_metadata_from_buyer ||
              protected_app_signals_ad_with_bid);
-      auto* highest_scoring_other_bids_map =
-          winning_ad_score.mutable_ig_owner_highest_scoring_other_bids_map();
 
-      std::string owner;
+      const std::string* owner;
       float bid = 0.0;
       if (ad_with_bid_metadata_from_buyer != nullptr) {
         bid = ad_with_bid_metadata_from_buyer->bid();
-        owner = ad_with_bid_metadata_from_buyer->interest_group_owner();
+        owner = &ad_with_bid_metadata_from_buyer->interest_group_owner();
       } else {
         bid = protected_app_signals_ad_with_bid->bid();
-        owner = protected_app_signals_ad_with_bid->owner();
+        owner = &protected_app_signals_ad_with_bid->owner();
       }
       if (!raw_request_.seller_currency().empty()) {
         auto ad_score_it = ad_scores_.find(responses[current_index]->id);
@@ -824,8 +1127,8 @@ void ScoreAdsReactor::PopulateHighestScoringOtherBidsData(
           bid = ad_score_it->second->incoming_bid_in_seller_currency();
         }
       }
-      UpdateHighestScoringOtherBidMap(bid, owner,
-                                      *highest_scoring_other_bids_map);
+      highest_scoring_other_bids_map[*owner].add_values()->set_number_value(
+          bid);
     }
   }
 }
@@ -843,6 +1146,7 @@ void ScoreAdsReactor::ScoreAdsCallback(
   LogIfError(metric_context_->AccumulateMetric<metric::kAuctionTotalBidsCount>(
       total_bid_count));
   ScoringData scoring_data = FindWinningAd(responses);
+  LogIfError(scoring_data.rejected_bid_counts.LogTo(*metric_context_));
   LogIfError(metric_context_->LogHistogram<metric::kAuctionBidRejectedPercent>(
       (static_cast<double>(scoring_data.seller_rejected_bid_count)) /
       total_bid_count));
@@ -854,7 +1158,8 @@ void ScoreAdsReactor::ScoreAdsCallback(
                        1, metric::kAuctionScoreAdsNoAdSelected));
     PS_LOG(WARNING, log_context_) << "No ad was selected as most desirable";
     if (enable_debug_reporting) {
-      PerformDebugReporting(winning_ad);
+      PerformDebugReporting(GeneratePostAuctionSignals(
+          winning_ad, raw_request_.seller_currency()));
     }
     benchmarking_logger_->HandleResponseEnd();
     EncryptAndFinishOK();
@@ -868,15 +1173,22 @@ void ScoreAdsReactor::ScoreAdsCallback(
   PopulateRelevantFieldsInResponse(index_of_most_desirable_ad, id, *winning_ad);
 
   PopulateHighestScoringOtherBidsData(index_of_most_desirable_ad,
-                                      scoring_data.score_ad_map, responses,
+                                      scoring_data.highest_scores, responses,
                                       *winning_ad);
 
   const auto& ad_rejection_reasons = scoring_data.ad_rejection_reasons;
   winning_ad->mutable_ad_rejection_reasons()->Assign(
       ad_rejection_reasons.begin(), ad_rejection_reasons.end());
 
+  // Debug reporting and reporting share the signals of the winning ad, which
+  // are built once.
+  PostAuctionSignals post_auction_signals;
+  if (enable_debug_reporting || enable_report_result_url_generation_) {
+    post_auction_signals =
+        GeneratePostAuctionSignals(winning_ad, raw_request_.seller_currency());
+  }
   if (enable_debug_reporting) {
-    PerformDebugReporting(winning_ad);
+    PerformDebugReporting(post_auction_signals);
   }
   *raw_response_.mutable_ad_score() = *winning_ad;
   if (!enable_report_result_url_generation_) {
@@ -884,7 +1196,7 @@ void ScoreAdsReactor::ScoreAdsCallback(
     EncryptAndFinishOK();
     return;
   }
-  PerformReporting(*winning_ad, id);
+  PerformReporting(*winning_ad, id, std::move(post_auction_signals));
 }
 
 void ScoreAdsReactor::ReportingCallback(
@@ -936,58 +1248,7 @@ void ScoreAdsReactor::ReportingCallback(
               << "Warning Log from Buyer's execution script:" << log;
         }
       }
-      // For component auctions, the reporting urls for seller are set in
-      // the component_seller_reporting_urls field. For single seller
-      // auctions and top level auctions, the reporting urls are set in the
-      // top_level_seller_reporting_urls field.
-      if (auction_scope_ ==
-          AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER) {
-        raw_response_.mutable_ad_score()
-            ->mutable_win_reporting_urls()
-            ->mutable_component_seller_reporting_urls()
-            ->set_reporting_url(reporting_response.value()
-                                    .report_result_response.report_result_url);
-        for (const auto& [event, interactionReportingUrl] :
-             reporting_response.value()
-                 .report_result_response.interaction_reporting_urls) {
-          raw_response_.mutable_ad_score()
-              ->mutable_win_reporting_urls()
-              ->mutable_component_seller_reporting_urls()
-              ->mutable_interaction_reporting_urls()
-              ->try_emplace(event, interactionReportingUrl);
-        }
-
-      } else {
-        raw_response_.mutable_ad_score()
-            ->mutable_win_reporting_urls()
-            ->mutable_top_level_seller_reporting_urls()
-            ->set_reporting_url(reporting_response.value()
-                                    .report_result_response.report_result_url);
-        for (const auto& [event, interactionReportingUrl] :
-             reporting_response.value()
-                 .report_result_response.interaction_reporting_urls) {
-          raw_response_.mutable_ad_score()
-              ->mutable_win_reporting_urls()
-              ->mutable_top_level_seller_reporting_urls()
-              ->mutable_interaction_reporting_urls()
-              ->try_emplace(event, interactionReportingUrl);
-        }
-      }
-      raw_response_.mutable_ad_score()
-          ->mutable_win_reporting_urls()
-          ->mutable_buyer_reporting_urls()
-          ->set_reporting_url(
-              reporting_response.value().report_win_response.report_win_url);
-
-      for (const auto& [event, interactionReportingUrl] :
-           reporting_response.value()
-               .report_win_response.interaction_reporting_urls) {
-        raw_response_.mutable_ad_score()
-            ->mutable_win_reporting_urls()
-            ->mutable_buyer_reporting_urls()
-            ->mutable_interaction_reporting_urls()
-            ->try_emplace(event, interactionReportingUrl);
-      }
+      SetReportingUrls(*reporting_response);
     } else {
       LogIfError(metric_context_
                      ->AccumulateMetric<metric::kAuctionErrorCountByErrorCode>(
@@ -1002,13 +1263,75 @@ void ScoreAdsReactor::ReportingCallback(
   EncryptAndFinishOK();
 }
 
+void ScoreAdsReactor::SetReportingUrls(
+    const ReportingResponse& reporting_response) {
+  // For component auctions, the reporting urls for seller are set in the
+  // component_seller_reporting_urls field. For single seller auctions and top
+  // level auctions, the reporting urls are set in the
+  // top_level_seller_reporting_urls field.
+  auto& seller_reporting_urls =
+      auction_scope_ ==
+              AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER
+          ? *raw_response_.mutable_ad_score()
+                 ->mutable_win_reporting_urls()
+                 ->mutable_component_seller_reporting_urls()
+          : *raw_response_.mutable_ad_score()
+                 ->mutable_win_reporting_urls()
+                 ->mutable_top_level_seller_reporting_urls();
+  seller_reporting_urls.set_reporting_url(
+      reporting_response.report_result_response.report_result_url);
+  for (const auto& [event, interactionReportingUrl] :
+       reporting_response.report_result_response.interaction_reporting_urls) {
+    seller_reporting_urls.mutable_interaction_reporting_urls()->try_emplace(
+        event, interactionReportingUrl);
+  }
+  if (auction_scope_ == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
+    return;
+  }
+  auto& buyer_reporting_urls = *raw_response_.mutable_ad_score()
+                                    ->mutable_win_reporting_urls()
+                                    ->mutable_buyer_reporting_urls();
+  buyer_reporting_urls.set_reporting_url(
+      reporting_response.report_win_response.report_win_url);
+  for (const auto& [event, interactionReportingUrl] :
+       reporting_response.report_win_response.interaction_reporting_urls) {
+    buyer_reporting_urls.mutable_interaction_reporting_urls()->try_emplace(
+        event, interactionReportingUrl);
+  }
+}
+
+bool ScoreAdsReactor::MayReportNatively(
+    const ReportingDispatchRequestData& dispatch_request_data) {
+  if (report_result_url_template_.empty() ||
+      dispatch_request_data.handler_name !=
+          kReportingDispatchHandlerFunctionName) {
+    return false;
+  }
+  ReportingResponse reporting_response;
+  // reportWin of top-level auctions runs in the component auctions.
+  if (enable_report_win_url_generation_ &&
+      auction_scope_ != AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
+    auto it = buyer_report_win_url_templates_.find(
+        dispatch_request_data.post_auction_signals.winning_ig_owner);
+    if (it == buyer_report_win_url_templates_.end()) {
+      // reportWin of the buyer runs in Roma, along with reportResult.
+      return false;
+    }
+    reporting_response.report_win_response.report_win_url =
+        RenderReportingUrl(it->second, dispatch_request_data);
+  }
+  reporting_response.report_result_response.report_result_url =
+      RenderReportingUrl(report_result_url_template_, dispatch_request_data);
+  SetReportingUrls(reporting_response);
+  EncryptAndFinishOK();
+  return true;
+}
+
 void ScoreAdsReactor::PerformDebugReporting(
-    const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score) {
+    const PostAuctionSignals& post_auction_signals) {
   if (auction_scope_ == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
     return;
   }
-  PostAuctionSignals post_auction_signals = GeneratePostAuctionSignals(
-      winning_ad_score, raw_request_.seller_currency());
   for (const auto& [id, ad_score] : ad_scores_) {
     if (ad_score->has_debug_report_urls()) {
       absl::string_view debug_url;
@@ -1055,11 +1378,9 @@ void ScoreAdsReactor::PerformDebugReporting(
 }
 
 void ScoreAdsReactor::EncryptAndFinishOK() {
-  PS_VLOG(kPlain, log_context_) << "ScoreAdsRawResponse:\n"
-                                << raw_response_.ShortDebugString();
+  debug_log_.AddMessage(kPlain, "ScoreAdsRawResponse:\n", raw_response_);
   EncryptResponse();
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted ScoreAdsResponse\n"
-                                    << response_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted ScoreAdsResponse\n", *response_);
   benchmarking_logger_->HandleResponseEnd();
   FinishWithStatus(grpc::Status::OK);
 }
@@ -1068,18 +1389,20 @@ void ScoreAdsReactor::FinishWithStatus(const grpc::Status& status) {
   if (status.error_code() != grpc::StatusCode::OK) {
     metric_context_->SetRequestResult(server_common::ToAbslStatus(status));
   }
+  metric::LogRequestPhases(phase_tracer_, *metric_context_);
+  trace_.End(status);
   Finish(status);
 }
 
 void ScoreAdsReactor::DispatchReportingRequestForPA(
     const ScoreAdsResponse::AdScore& winning_ad_score,
+    PostAuctionSignals post_auction_signals,
     const std::shared_ptr<std::string>& auction_config,
     const BuyerReportingMetadata& buyer_reporting_metadata) {
   ReportingDispatchRequestData dispatch_request_data = {
       .handler_name = kReportingDispatchHandlerFunctionName,
       .auction_config = auction_config,
-      .post_auction_signals = GeneratePostAuctionSignals(
-          winning_ad_score, raw_request_.seller_currency()),
+      .post_auction_signals = std::move(post_auction_signals),
       .publisher_hostname = raw_request_.publisher_hostname(),
       .log_context = log_context_,
       .buyer_reporting_metadata = buyer_reporting_metadata};
@@ -1107,8 +1430,22 @@ void ScoreAdsReactor::DispatchReportingRequestForPA(
   DispatchReportingRequest(dispatch_request_data);
 }
 
+void ScoreAdsReactor::DispatchReportingRequestForTopLevelAuction(
+    PostAuctionSignals post_auction_signals,
+    absl::string_view component_seller) {
+  ReportingDispatchRequestData dispatch_request_data = {
+      .handler_name = kReportingDispatchHandlerFunctionName,
+      .auction_config = GetAuctionConfig(),
+      .post_auction_signals = std::move(post_auction_signals),
+      .publisher_hostname = raw_request_.publisher_hostname(),
+      .log_context = log_context_,
+      .component_reporting_metadata = {
+          .component_seller = std::string(component_seller)}};
+  DispatchReportingRequest(dispatch_request_data);
+}
+
 void ScoreAdsReactor::DispatchReportingRequestForPAS(
-    const ScoreAdsResponse::AdScore& winning_ad_score,
+    PostAuctionSignals post_auction_signals,
     const std::shared_ptr<std::string>& auction_config,
     const BuyerReportingMetadata& buyer_reporting_metadata,
     std::string_view egress_payload,
@@ -1116,8 +1453,7 @@ void ScoreAdsReactor::DispatchReportingRequestForPAS(
   DispatchReportingRequest(
       {.handler_name = kReportingProtectedAppSignalsFunctionName,
        .auction_config = auction_config,
-       .post_auction_signals = GeneratePostAuctionSignals(
-           winning_ad_score, raw_request_.seller_currency()),
+       .post_auction_signals = std::move(post_auction_signals),
        .publisher_hostname = raw_request_.publisher_hostname(),
        .log_context = log_context_,
        .buyer_reporting_metadata = buyer_reporting_metadata,
@@ -1127,14 +1463,32 @@ void ScoreAdsReactor::DispatchReportingRequestForPAS(
 
 void ScoreAdsReactor::DispatchReportingRequest(
     const ReportingDispatchRequestData& dispatch_request_data) {
+  if (MayReportNatively(dispatch_request_data)) {
+    return;
+  }
   ReportingDispatchRequestConfig dispatch_request_config = {
-      .enable_report_win_url_generation = enable_report_win_url_generation_,
+      // reportWin of top-level auctions runs in the component auctions.
+      .enable_report_win_url_generation =
+          enable_report_win_url_generation_ &&
+          auction_scope_ !=
+              AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER,
       .enable_protected_app_signals = enable_protected_app_signals_,
       .enable_report_win_input_noising = enable_report_win_input_noising_,
       .enable_adtech_code_logging = enable_adtech_code_logging_};
+  // The winner is returned without reporting once no time is left to the
+  // call.
+  absl::StatusOr<std::string> roma_timeout_ms = RomaTimeoutMs(roma_timeout_ms_);
+  if (!roma_timeout_ms.ok()) {
+    PS_LOG(ERROR, log_context_)
+        << "Skipping reporting: " << roma_timeout_ms.status();
+    EncryptAndFinishOK();
+    return;
+  }
   DispatchRequest dispatch_request = GetReportingDispatchRequest(
       dispatch_request_config, dispatch_request_data);
-  dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms_;
+  dispatch_request.tags[kRomaTimeoutMs] = *std::move(roma_timeout_ms);
+  dispatch_request.tags[kDispatchTenantTag] =
+      std::string(DispatchTenantTagValue(DispatchTenant::kReporting));
 
   std::vector<DispatchRequest> dispatch_requests = {dispatch_request};
   auto status = dispatcher_.BatchExecute(
@@ -1153,4 +1507,9 @@ void ScoreAdsReactor::DispatchReportingRequest(
     EncryptAndFinishOK();
   }
 }
+
+void ScoreAdsReactor::OnDone() {
+  debug_log_.Flush();
+  delete this;
+}
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -16,7 +16,6 @@
 #define SERVICES_AUCTION_SERVICE_SCORE_ADS_REACTOR_H_
 
 #include <limits>
-#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,16 +28,26 @@
 #include <rapidjson/stringbuffer.h>
 
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/auction_service/benchmarking/score_ads_benchmarking_logger.h"
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/reporting/reporting_helper.h"
 #include "services/auction_service/reporting/reporting_response.h"
+#include "services/auction_service/utils/auction_config_cache.h"
+#include "services/auction_service/utils/proto_utils.h"
+#include "services/auction_service/utils/top_scores.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/roma_cost_account.h"
+#include "services/common/clients/code_dispatcher/roma_execution_timer.h"
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/loggers/deferred_debug_log.h"
+#include "services/common/metric/partitioned_counts.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/reporters/async_reporter.h"
+#include "services/common/util/arena_message_allocator.h"
+#include "services/common/util/string_interner.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 #include "src/logger/request_context_impl.h"
 
@@ -51,6 +60,9 @@ inline constexpr char kNoAdsWithValidScoringSignals[] =
     "No ads with valid scoring signals.";
 inline constexpr char kNoValidComponentAuctions[] =
     "No component auction results in request.";
+// Number of distinct highest scores whose bids are reported as highest scoring
+// other bids.
+inline constexpr int kNumHighestScoringOtherBidsTiers = 2;
 // An aggregate of the data we track when scoring all the ads.
 struct ScoringData {
   // Index of the most desirable ad. This helps us to set the overall response
@@ -58,9 +70,15 @@ struct ScoringData {
   int index_of_most_desirable_ad = 0;
   // Count of rejected bids.
   int seller_rejected_bid_count = 0;
-  // Map of all the desirability/scores and corresponding scored ad's index in
-  // the response from the scoreAd's UDF.
-  absl::flat_hash_map<float, std::list<int>> score_ad_map;
+  // Counts of rejected bids by rejection reason, logged once all the ads are
+  // scored.
+  metric::PartitionedCounts<metric::kAuctionBidRejectedCount,
+                            metric::kSellerRejectReasons>
+      rejected_bid_counts;
+  // Indices (in the response from the scoreAd's UDF) of the valid ads with
+  // the two highest desirability scores. Used to populate the highest scoring
+  // other bids.
+  TopScores<kNumHighestScoringOtherBidsTiers> highest_scores;
   // Saving the desirability allows us to compare desirability between ads
   // without re-parsing the current most-desirable ad every time.
   float desirability_of_most_desirable_ad = 0;
@@ -89,7 +107,8 @@ class ScoreAdsReactor
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
       const AsyncReporter* async_reporter,
-      const AuctionServiceRuntimeConfig& runtime_config);
+      const AuctionServiceRuntimeConfig& runtime_config,
+      AuctionConfigCache* auction_config_cache = nullptr);
 
   // Initiates the asynchronous execution of the ScoreAdsRequest.
   void Execute() override;
@@ -99,6 +118,10 @@ class ScoreAdsReactor
       ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata;
   using ProtectedAppSignalsAdWithBidMetadata =
       ScoreAdsRequest::ScoreAdsRawRequest::ProtectedAppSignalsAdWithBidMetadata;
+  // Emits the debug logs of the request, then deletes the ScoreAdsReactor.
+  // Called by the grpc library after the response has finished.
+  void OnDone() override;
+
   // Finds the ad type of the scored ad and set it. After the function call,
   // expect one of the input pointers to be populated.
   void FindScoredAdType(absl::string_view response_id,
@@ -120,7 +143,7 @@ class ScoreAdsReactor
   // be returned to SFE.
   void PopulateHighestScoringOtherBidsData(
       int index_of_most_desirable_ad,
-      const absl::flat_hash_map<float, std::list<int>>& score_ad_map,
+      const TopScores<kNumHighestScoringOtherBidsTiers>& highest_scores,
       const std::vector<absl::StatusOr<DispatchResponse>>& responses,
       ScoreAdsResponse::AdScore& winning_ad);
 
@@ -134,22 +157,53 @@ class ScoreAdsReactor
       const std::vector<absl::StatusOr<DispatchResponse>>& output,
       bool enable_debug_reporting);
 
+  // Groups consecutive scoreAd dispatch requests into chunks, each scored by
+  // a single invocation, when enabled and there are enough ads to keep every
+  // JS worker busy. Returns the chunks, or the dispatch requests if the ads
+  // are scored one by one.
+  std::vector<DispatchRequest>& MayBuildScoreAdsChunks();
+
+  // Sets the outputs of the ads of the chunk at `chunk_index` in
+  // `ad_responses`, which has a response per dispatch request.
+  void SplitChunkResponse(
+      int chunk_index, const absl::StatusOr<DispatchResponse>& chunk_response,
+      std::vector<absl::StatusOr<DispatchResponse>>& ad_responses);
+
+  // Attributes the run time of the response at `index` of the batch to the
+  // owners of the ads it scored, splitting that of a chunk evenly.
+  void AccountRomaCost(int index,
+                       const absl::StatusOr<DispatchResponse>& response);
+
+  // Logs the run time attributed to each owner of the scored ads.
+  void LogRomaCostByOwner();
+
   absl::btree_map<std::string, std::string> GetLoggingContext(
       const ScoreAdsRequest::ScoreAdsRawRequest& score_ads_request);
 
+  // Returns the serialized auction config of this request. It is built on the
+  // first call and then shared, without modification, by the scoring and
+  // reporting dispatch requests.
+  const std::shared_ptr<std::string>& GetAuctionConfig();
+
   // Performs debug reporting for all scored ads by the seller.
-  void PerformDebugReporting(
-      const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score);
+  void PerformDebugReporting(const PostAuctionSignals& post_auction_signals);
 
   static constexpr char kRomaTimeoutMs[] = "TimeoutMs";
 
   void DispatchReportingRequestForPA(
       const ScoreAdsResponse::AdScore& winning_ad_score,
+      PostAuctionSignals post_auction_signals,
       const std::shared_ptr<std::string>& auction_config,
       const BuyerReportingMetadata& buyer_reporting_metadata);
 
+  // Runs the top-level seller's reportResult for the winner of a top-level
+  // auction, which came from the auction of `component_seller`.
+  void DispatchReportingRequestForTopLevelAuction(
+      PostAuctionSignals post_auction_signals,
+      absl::string_view component_seller);
+
   void DispatchReportingRequestForPAS(
-      const ScoreAdsResponse::AdScore& winning_ad_score,
+      PostAuctionSignals post_auction_signals,
       const std::shared_ptr<std::string>& auction_config,
       const BuyerReportingMetadata& buyer_reporting_metadata,
       std::string_view egress_payload,
@@ -157,8 +211,11 @@ class ScoreAdsReactor
 
   void DispatchReportingRequest(
       const ReportingDispatchRequestData& dispatch_request_data);
+  // post_auction_signals: signals of the winning ad, as already built for
+  // debug reporting.
   void PerformReporting(const ScoreAdsResponse::AdScore& winning_ad_score,
-                        absl::string_view id);
+                        absl::string_view id,
+                        PostAuctionSignals post_auction_signals);
 
   // Publishes metrics and Finishes the RPC call with a status.
   void FinishWithStatus(const grpc::Status& status);
@@ -169,12 +226,20 @@ class ScoreAdsReactor
   void ReportingCallback(
       const std::vector<absl::StatusOr<DispatchResponse>>& responses);
 
+  // Sets the reporting URLs of the winning ad in the response.
+  void SetReportingUrls(const ReportingResponse& reporting_response);
+
+  // Renders the reporting URLs from the configured URL templates instead of
+  // dispatching reportingEntryFunction, if there is a template for each of
+  // them, and finishes the RPC. Returns false if reporting has to run in Roma.
+  bool MayReportNatively(
+      const ReportingDispatchRequestData& dispatch_request_data);
+
   // Creates and populates dispatch requests using AdWithBidMetadata objects
   // in the input proto for single seller and component auctions.
   void PopulateProtectedAudienceDispatchRequests(
       bool enable_debug_reporting,
-      const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-          scoring_signals,
+      const TrustedScoringSignals& scoring_signals,
       const std::shared_ptr<std::string>& auction_config,
       google::protobuf::RepeatedPtrField<AdWithBidMetadata>& ads);
 
@@ -192,48 +257,83 @@ class ScoreAdsReactor
   // if the feature flag is enabled.
   void MayPopulateProtectedAppSignalsDispatchRequests(
       bool enable_debug_reporting,
-      const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-          scoring_signals,
+      const TrustedScoringSignals& scoring_signals,
       const std::shared_ptr<std::string>& auction_config,
       google::protobuf::RepeatedPtrField<ProtectedAppSignalsAdWithBidMetadata>&
           protected_app_signals_ad_bids);
 
   // Sets the required fields in the passed AdScore object and populates
   // scoring data.
-  // The AdScore fields that need to be parsed from ROMA response
-  // must be populated separately before this is called.
-  void HandleScoredAd(int index, float buyer_bid,
-                      absl::string_view ad_with_bid_currency,
-                      absl::string_view interest_group_name,
-                      absl::string_view interest_group_owner,
-                      absl::string_view interest_group_origin,
-                      const rapidjson::Document& response_json, AdType ad_type,
-                      ScoreAdsResponse::AdScore& score_ads_response,
-                      ScoringData& scoring_data,
-                      const std::string& dispatch_response_id);
-
+  // The AdScore fields that need to be parsed from ROMA response, and the
+  // rejection reason set by scoreAd if any, must be populated separately
+  // before this is called.
+  void HandleScoredAd(
+      int index, float buyer_bid, absl::string_view ad_with_bid_currency,
+      absl::string_view interest_group_name,
+      absl::string_view interest_group_owner,
+      absl::string_view interest_group_origin,
+      std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
+          ad_rejection_reason,
+      AdType ad_type, ScoreAdsResponse::AdScore& score_ads_response,
+      ScoringData& scoring_data, const std::string& dispatch_response_id);
+
+  // Holds the dispatch ids the maps below key on, so that each is held once
+  // rather than copied into every map. Outlives the maps.
+  StringInterner dispatch_ids_;
   // The key is the id of the DispatchRequest, and the value is the ad
   // used to create the dispatch request. This map is used to amend each ad's
   // DispatchResponse with more data which is then passed into the final
   // ScoreAdsResponse.
+  // The ads are released from the raw request, without copies if it is on an
+  // arena.
   absl::flat_hash_map<
-      std::string,
-      std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata>>
+      absl::string_view,
+      ArenaAwarePtr<ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata>>
       ad_data_;
-  absl::flat_hash_map<std::string,
-                      std::unique_ptr<ProtectedAppSignalsAdWithBidMetadata>>
+  absl::flat_hash_map<absl::string_view,
+                      ArenaAwarePtr<ProtectedAppSignalsAdWithBidMetadata>>
       protected_app_signals_ad_data_;
+  // Sellers of the component auctions of top-level auctions, by dispatch id.
+  absl::flat_hash_map<absl::string_view, std::string> component_sellers_;
   std::unique_ptr<ScoreAdsBenchmarkingLogger> benchmarking_logger_;
   const AsyncReporter& async_reporter_;
+  // Optional cache of auction configs shared across requests, not owned.
+  AuctionConfigCache* auction_config_cache_;
+  // Serialized auction config, lazily built by GetAuctionConfig().
+  std::shared_ptr<std::string> auction_config_;
   bool enable_seller_debug_url_generation_;
   std::string roma_timeout_ms_;
+  // Scores still running this long after dispatch are dropped, if positive.
+  absl::Duration roma_batch_deadline_;
+  // Responses of a streamed batch, by dispatch request index.
+  std::vector<absl::StatusOr<DispatchResponse>> streamed_responses_;
+  // Most ads scored by a scoreAd invocation, and the number of JS workers
+  // the chunks of ads are spread over if known.
+  int score_ads_max_chunk_size_;
+  int num_js_workers_;
+  // Whether the ads are scored natively instead of by scoreAd, and the
+  // NativeScoring options then.
+  bool enable_native_scoring_;
+  double native_scoring_bid_floor_;
+  bool native_scoring_allow_component_auction_;
+  // Ads per chunk and the chunks dispatched, if the ads are scored in chunks.
+  int score_ads_chunk_size_ = 1;
+  std::vector<DispatchRequest> score_ads_chunks_;
+  // Splits the JS execution time of the batch, set once it is dispatched.
+  std::optional<RomaExecutionTimer> roma_execution_timer_;
+  // Run time of the batch by owner of the scored ads. The ads of owners over
+  // their budget are not considered for the win.
+  RomaCostAccount roma_cost_account_;
   server_common::log::ContextImpl log_context_;
+  // Dumps of the protos of the request, formatted off the request thread.
+  DeferredDebugLog debug_log_;
 
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::AuctionContext> metric_context_;
 
   // Used for debug reporting. Keyed on Roma dispatch ID.
-  absl::flat_hash_map<std::string, std::unique_ptr<ScoreAdsResponse::AdScore>>
+  absl::flat_hash_map<absl::string_view,
+                      std::unique_ptr<ScoreAdsResponse::AdScore>>
       ad_scores_;
 
   // Flags needed to be passed as input to the code which wraps AdTech provided
@@ -246,6 +346,8 @@ class ScoreAdsReactor
   std::string seller_origin_;
   int max_allowed_size_debug_url_chars_;
   long max_allowed_size_all_debug_urls_chars_;
+  // Number of threads used to parse the scoreAd responses of large batches.
+  int num_score_ad_response_parse_threads_;
 
   // Specifies whether this is a single seller or component auction.
   // Impacts the creation of scoreAd input params and
@@ -255,6 +357,12 @@ class ScoreAdsReactor
   // Specifies which verison of scoreAd to use for this request.
   absl::string_view code_version_;
 
+  // Reporting URL templates rendered in place of running reportResult, and
+  // reportWin by buyer origin, owned by the runtime config.
+  absl::string_view report_result_url_template_;
+  const absl::flat_hash_map<std::string, std::string>&
+      buyer_report_win_url_templates_;
+
   google::protobuf::RepeatedPtrField<std::string>
   GetEmptyAdComponentRenderUrls() {
     static google::protobuf::RepeatedPtrField<std::string>
@@ -23,7 +23,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
@@ -892,6 +894,153 @@ TEST_F(ScoreAdsReactorTest, EmptySignalsResultsInNoResponse) {
   EXPECT_FALSE(raw_response.has_ad_score());
 }
 
+TEST_F(ScoreAdsReactorTest, ScoresChunksOfAdsPerInvocation) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo_two, bar, barbecue;
+  GetTestAdWithBidSameComponentAsFoo(foo_two);
+  GetTestAdWithBidBar(bar);
+  GetTestAdWithBidBarbecue(barbecue);
+  BuildRawRequest({bar, foo_two, barbecue}, kTestSellerSignals,
+                  kTestAuctionSignals, kTestScoringSignals,
+                  kTestPublisherHostname, raw_request);
+  std::string last_ad_id;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&last_ad_id](std::vector<DispatchRequest>& batch,
+                              BatchDispatchDoneCallback done_callback) {
+        // 3 ads in chunks of up to 2 ads.
+        EXPECT_EQ(batch.size(), 2);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        int desirability = 1;
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.handler_name, kScoreAdsBatchHandlerFunctionName);
+          std::vector<std::string> ad_scores;
+          const int num_ads = &request == &batch.front() ? 2 : 1;
+          for (int i = 0; i < num_ads; ++i) {
+            ad_scores.push_back(absl::Substitute(
+                kOneSellerSimpleAdScoreTemplate, desirability++, 0, "false"));
+          }
+          last_ad_id = request.id;
+          DispatchResponse response;
+          response.id = request.id;
+          response.resp =
+              absl::StrCat("[", absl::StrJoin(ad_scores, ","), "]");
+          responses.push_back(std::move(response));
+        }
+        done_callback(responses);
+        return absl::OkStatus();
+      });
+  AuctionServiceRuntimeConfig runtime_config = {.score_ads_max_chunk_size = 2};
+  const ScoreAdsResponse response =
+      ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  ASSERT_TRUE(raw_response.has_ad_score());
+  // The last chunk holds only the last ad, which is the most desirable.
+  EXPECT_EQ(raw_response.ad_score().desirability(), 3);
+  EXPECT_EQ(raw_response.ad_score().render(), last_ad_id);
+}
+
+TEST_F(ScoreAdsReactorTest, LeavesOutAdsOfOwnersOverTheirBudget) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo, bar;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({foo, bar}, kTestSellerSignals, kTestAuctionSignals,
+                  kTestScoringSignals, kTestPublisherHostname, raw_request);
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&foo](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback done_callback) {
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const DispatchRequest& request : batch) {
+          // The ad of bar is the most desirable, but takes longer to score
+          // than the budget of its owner.
+          const bool is_foo = request.id == foo.render();
+          DispatchResponse response;
+          response.id = request.id;
+          response.resp = absl::Substitute(kOneSellerSimpleAdScoreTemplate,
+                                           is_foo ? 1 : 2, 0, "false");
+          response.metrics[std::string(kRomaExecutionDurationMetric)] =
+              absl::Milliseconds(is_foo ? 10 : 30);
+          responses.push_back(std::move(response));
+        }
+        done_callback(responses);
+        return absl::OkStatus();
+      });
+  AuctionServiceRuntimeConfig runtime_config = {.score_ads_owner_budget_ms =
+                                                    20};
+  const ScoreAdsResponse response =
+      ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  ASSERT_TRUE(raw_response.has_ad_score());
+  EXPECT_EQ(raw_response.ad_score().render(), foo.render());
+}
+
+TEST_F(ScoreAdsReactorTest, ScoresAdsNativelyWithoutRoma) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo, bar;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({foo, bar}, kTestSellerSignals, kTestAuctionSignals,
+                  kTestScoringSignals, kTestPublisherHostname, raw_request);
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  // The bid of bar is below the floor, the one of foo above.
+  AuctionServiceRuntimeConfig runtime_config = {
+      .enable_native_scoring = true, .native_scoring_bid_floor = 2.05};
+  const ScoreAdsResponse response =
+      ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  ASSERT_TRUE(raw_response.has_ad_score());
+  EXPECT_EQ(raw_response.ad_score().render(), foo.render());
+  EXPECT_FLOAT_EQ(raw_response.ad_score().desirability(), foo.bid());
+  ASSERT_EQ(raw_response.ad_score().ad_rejection_reasons_size(), 1);
+  const auto& rejection_reason =
+      raw_response.ad_score().ad_rejection_reasons(0);
+  EXPECT_EQ(rejection_reason.interest_group_name(), bar.interest_group_name());
+  EXPECT_EQ(rejection_reason.rejection_reason(),
+            SellerRejectionReason::BID_BELOW_AUCTION_FLOOR);
+}
+
+TEST_F(ScoreAdsReactorTest, RendersReportingUrlsFromTemplatesWithoutRoma) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, kTestSellerSignals, kTestAuctionSignals,
+                  kTestScoringSignals, kTestPublisherHostname, raw_request);
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  AuctionServiceRuntimeConfig runtime_config = {
+      .enable_report_result_url_generation = true,
+      .enable_report_win_url_generation = true,
+      .enable_native_scoring = true,
+      .report_result_url_template = "https://seller.com/?bid=${winningBid}",
+      .buyer_report_win_url_templates = {
+          {foo.interest_group_owner(),
+           "https://buyer.com/?ig=${interestGroupName}"}}};
+  const ScoreAdsResponse response = ExecuteScoreAds(
+      raw_request, dispatcher, runtime_config,
+      /*enable_report_result_url_generation=*/true);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  ASSERT_TRUE(raw_response.has_ad_score());
+  const auto& win_reporting_urls =
+      raw_response.ad_score().win_reporting_urls();
+  EXPECT_EQ(win_reporting_urls.top_level_seller_reporting_urls()
+                .reporting_url(),
+            absl::StrCat("https://seller.com/?bid=", foo.bid()));
+  EXPECT_EQ(win_reporting_urls.buyer_reporting_urls().reporting_url(),
+            absl::StrCat("https://buyer.com/?ig=",
+                         foo.interest_group_name()));
+}
+
 TEST_F(ScoreAdsReactorTest,
        CreatesScoresForAllAdsRequestedWithoutComponentAuction) {
   MockCodeDispatchClient dispatcher;
@@ -83,8 +83,7 @@ void SetupTelemetryCheck(const ScoreAdsRequest& request) {
   server_common::telemetry::TelemetryConfig config_proto;
   config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
   metric::MetricContextMap<ScoreAdsRequest>(
-      server_common::telemetry::BuildDependentConfig(config_proto))
-      ->Get(&request);
+      server_common::telemetry::BuildDependentConfig(config_proto));
 }
 
 ScoreAdsReactorTestHelper::ScoreAdsReactorTestHelper() {
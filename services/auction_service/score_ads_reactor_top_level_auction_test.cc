@@ -12,6 +12,7 @@
 //  See the License for the specific language governing permissions and
 //  limitations under the License.
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/auction_service/auction_constants.h"
@@ -30,6 +31,7 @@ constexpr char kTestPublisherHostname[] = "publisher_hostname";
 constexpr char kTestTopLevelSeller[] = "top_level_seller";
 constexpr char kTestGenerationId[] = "test_generation_id";
 
+using ::testing::HasSubstr;
 using RawRequest = ScoreAdsRequest::ScoreAdsRawRequest;
 
 RawRequest BuildTopLevelAuctionRawRequest(
@@ -172,12 +174,13 @@ TEST(ScoreAdsReactorTopLevelAuctionTest, DoesNotPopulateHighestOtherBid) {
   EXPECT_TRUE(scored_ad.ig_owner_highest_scoring_other_bids_map().empty());
 }
 
-TEST(ScoreAdsReactorTopLevelAuctionTest, DoesNotSupportWinReporting) {
+TEST(ScoreAdsReactorTopLevelAuctionTest, PerformsTopLevelSellerReportingOnly) {
   MockCodeDispatchClient dispatcher;
   AuctionResult car_1 = MakeARandomComponentAuctionResult(MakeARandomString(),
                                                           kTestTopLevelSeller);
   RawRequest raw_request = BuildTopLevelAuctionRawRequest(
       {car_1}, kTestSellerSignals, kTestAuctionSignals, kTestPublisherHostname);
+  std::string reporting_input;
   EXPECT_CALL(dispatcher, BatchExecute)
       .WillOnce([](std::vector<DispatchRequest>& batch,
                    BatchDispatchDoneCallback done_callback) {
@@ -195,6 +198,22 @@ TEST(ScoreAdsReactorTopLevelAuctionTest, DoesNotSupportWinReporting) {
                 )");
         return FakeExecute(batch, std::move(done_callback),
                            std::move(score_logic), false);
+      })
+      .WillOnce([&reporting_input](std::vector<DispatchRequest>& batch,
+                                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        EXPECT_EQ(batch[0].handler_name, kReportingDispatchHandlerFunctionName);
+        for (const auto& input : batch[0].input) {
+          absl::StrAppend(&reporting_input, *input);
+        }
+        std::vector<std::string> reporting_logic(
+            batch.size(),
+            R"({"reportResultResponse":{)"
+            R"("reportResultUrl":"http://reportResultUrl.com",)"
+            R"("interactionReportingUrls":{"click":"http://event.com"}},)"
+            R"("reportWinResponse":{"reportWinUrl":"http://win.com"}})");
+        return FakeExecute(batch, std::move(done_callback),
+                           std::move(reporting_logic), false);
       });
   AuctionServiceRuntimeConfig runtime_config = {
       .enable_seller_debug_url_generation = false,
@@ -207,33 +226,23 @@ TEST(ScoreAdsReactorTopLevelAuctionTest, DoesNotSupportWinReporting) {
   ScoreAdsResponse::ScoreAdsRawResponse raw_response;
   ASSERT_TRUE(raw_response.ParseFromString(response.response_ciphertext()));
   const auto& scored_ad = raw_response.ad_score();
-  EXPECT_TRUE(scored_ad.win_reporting_urls()
-                  .top_level_seller_reporting_urls()
-                  .reporting_url()
-                  .empty());
+  EXPECT_THAT(reporting_input,
+              HasSubstr(absl::StrCat(
+                  R"("componentSeller":")",
+                  car_1.auction_params().component_seller(), "\"")));
   EXPECT_EQ(scored_ad.win_reporting_urls()
                 .top_level_seller_reporting_urls()
-                .interaction_reporting_urls()
-                .size(),
-            0);
-  EXPECT_TRUE(scored_ad.win_reporting_urls()
-                  .component_seller_reporting_urls()
-                  .reporting_url()
-                  .empty());
+                .reporting_url(),
+            "http://reportResultUrl.com");
   EXPECT_EQ(scored_ad.win_reporting_urls()
-                .component_seller_reporting_urls()
-                .interaction_reporting_urls()
-                .size(),
-            0);
-  EXPECT_TRUE(scored_ad.win_reporting_urls()
-                  .buyer_reporting_urls()
-                  .reporting_url()
-                  .empty());
-  EXPECT_EQ(scored_ad.win_reporting_urls()
-                .buyer_reporting_urls()
+                .top_level_seller_reporting_urls()
                 .interaction_reporting_urls()
                 .size(),
-            0);
+            1);
+  // The component seller and the buyer report in the component auction.
+  EXPECT_FALSE(
+      scored_ad.win_reporting_urls().has_component_seller_reporting_urls());
+  EXPECT_FALSE(scored_ad.win_reporting_urls().has_buyer_reporting_urls());
 }
 
 TEST(ScoreAdsReactorTopLevelAuctionTest, DoesNotPerformDebugReporting) {
@@ -0,0 +1,71 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/auction_service/utils/auction_config_cache.h"
+
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "services/auction_service/utils/proto_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+AuctionConfigCache::AuctionConfigCache(int capacity) : capacity_(capacity) {}
+
+std::shared_ptr<std::string> AuctionConfigCache::GetOrBuild(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request) {
+  const size_t hash =
+      absl::HashOf(raw_request.auction_signals(), raw_request.seller_signals());
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = index_.find(hash); it != index_.end()) {
+      const Entry& entry = *it->second;
+      if (entry.auction_signals == raw_request.auction_signals() &&
+          entry.seller_signals == raw_request.seller_signals()) {
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return entry.auction_config;
+      }
+    }
+  }
+
+  // Build outside of the lock, concurrent misses for the same inputs are
+  // rare and only result in redundant work.
+  std::shared_ptr<std::string> auction_config =
+      BuildAuctionConfig(raw_request);
+  if (capacity_ <= 0) {
+    return auction_config;
+  }
+  absl::MutexLock lock(&mu_);
+  if (auto it = index_.find(hash); it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front({.hash = hash,
+                       .auction_signals = raw_request.auction_signals(),
+                       .seller_signals = raw_request.seller_signals(),
+                       .auction_config = auction_config});
+  index_[hash] = entries_.begin();
+  if (entries_.size() > static_cast<size_t>(capacity_)) {
+    index_.erase(entries_.back().hash);
+    entries_.pop_back();
+  }
+  return auction_config;
+}
+
+int AuctionConfigCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
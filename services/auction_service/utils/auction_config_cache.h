@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_AUCTION_SERVICE_UTILS_AUCTION_CONFIG_CACHE_H_
+#define SERVICES_AUCTION_SERVICE_UTILS_AUCTION_CONFIG_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Thread-safe LRU cache of serialized auction configs shared across ScoreAds
+// requests. Entries are keyed by a hash of the seller provided inputs of the
+// auction config (auction signals and seller signals), so that publishers
+// sending static signals skip building the auction config JSON altogether.
+// Hash collisions are detected by comparing the inputs and treated as misses.
+class AuctionConfigCache {
+ public:
+  // `capacity` is the max number of auction configs held by the cache.
+  explicit AuctionConfigCache(int capacity);
+
+  // Returns the serialized auction config for the request, built with
+  // BuildAuctionConfig on a cache miss. The returned string must not be
+  // modified since it can be shared across requests.
+  std::shared_ptr<std::string> GetOrBuild(
+      const ScoreAdsRequest::ScoreAdsRawRequest& raw_request);
+
+  // Returns the number of auction configs currently cached.
+  int size() const;
+
+ private:
+  struct Entry {
+    size_t hash;
+    std::string auction_signals;
+    std::string seller_signals;
+    std::shared_ptr<std::string> auction_config;
+  };
+
+  const int capacity_;
+  mutable absl::Mutex mu_;
+  // Most recently used entries first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_AUCTION_SERVICE_UTILS_AUCTION_CONFIG_CACHE_H_
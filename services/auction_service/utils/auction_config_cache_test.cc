@@ -0,0 +1,81 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/auction_service/utils/auction_config_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "services/auction_service/utils/proto_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using RawRequest = ScoreAdsRequest::ScoreAdsRawRequest;
+
+RawRequest MakeRawRequest(absl::string_view auction_signals,
+                          absl::string_view seller_signals) {
+  RawRequest raw_request;
+  raw_request.set_auction_signals(auction_signals);
+  raw_request.set_seller_signals(seller_signals);
+  return raw_request;
+}
+
+TEST(AuctionConfigCacheTest, BuildsSameConfigAsBuildAuctionConfig) {
+  AuctionConfigCache cache(/*capacity=*/2);
+  RawRequest raw_request = MakeRawRequest(R"({"a":1})", R"({"b":2})");
+
+  EXPECT_EQ(*cache.GetOrBuild(raw_request), *BuildAuctionConfig(raw_request));
+}
+
+TEST(AuctionConfigCacheTest, SharesConfigForSameInputs) {
+  AuctionConfigCache cache(/*capacity=*/2);
+
+  std::shared_ptr<std::string> first =
+      cache.GetOrBuild(MakeRawRequest(R"({"a":1})", R"({"b":2})"));
+  std::shared_ptr<std::string> second =
+      cache.GetOrBuild(MakeRawRequest(R"({"a":1})", R"({"b":2})"));
+  EXPECT_EQ(first.get(), second.get());
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(AuctionConfigCacheTest, EvictsLeastRecentlyUsed) {
+  AuctionConfigCache cache(/*capacity=*/2);
+  RawRequest first = MakeRawRequest("1", "");
+  RawRequest second = MakeRawRequest("2", "");
+  RawRequest third = MakeRawRequest("3", "");
+
+  std::shared_ptr<std::string> first_config = cache.GetOrBuild(first);
+  cache.GetOrBuild(second);
+  // Marks the first config as most recently used.
+  EXPECT_EQ(cache.GetOrBuild(first).get(), first_config.get());
+  std::shared_ptr<std::string> second_config = cache.GetOrBuild(second);
+  cache.GetOrBuild(third);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.GetOrBuild(second).get(), second_config.get());
+  EXPECT_NE(cache.GetOrBuild(first).get(), first_config.get());
+}
+
+TEST(AuctionConfigCacheTest, DoesNotCacheWithoutCapacity) {
+  AuctionConfigCache cache(/*capacity=*/0);
+  RawRequest raw_request = MakeRawRequest("1", "2");
+
+  EXPECT_NE(cache.GetOrBuild(raw_request).get(),
+            cache.GetOrBuild(raw_request).get());
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,11 +14,19 @@
 
 #include "services/auction_service/utils/proto_utils.h"
 
-#include "absl/container/flat_hash_set.h"
+#include <optional>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "rapidjson/error/en.h"
 #include "rapidjson/pointer.h"
 #include "rapidjson/writer.h"
+#include "services/common/util/json_span_util.h"
 #include "services/common/util/json_util.h"
+#include "services/common/util/json_writer.h"
 #include "services/common/util/reporting_util.h"
 #include "services/common/util/request_response_constants.h"
 
@@ -33,161 +41,41 @@ using server_common::log::ContextImpl;
 
 namespace {
 
-// Builds a map of render urls to JSON objects holding the scoring signals.
-// An entry looks like: url_to_signals["fooAds.com/123"] = {"fooAds.com/123":
-// {"some", "scoring", "signals"}}. Notice the render URL is present in the map
-// both as its key, and again in each entry as a key to the JSON object. This is
-// intentional, as it allows moving the key to the new signals objects being
-// built for each AdWithBid.
-absl::flat_hash_map<std::string, rapidjson::Document> BuildAdScoringSignalsMap(
-    rapidjson::Value& trusted_scoring_signals_value) {
-  absl::flat_hash_map<std::string, rapidjson::Document> url_to_signals;
-  for (rapidjson::Value::MemberIterator itr =
-           trusted_scoring_signals_value.MemberBegin();
-       itr != trusted_scoring_signals_value.MemberEnd(); ++itr) {
-    // Moving the name will render it inaccessible unless a copy is made first.
-    std::string ad_url = itr->name.GetString();
-    // A Document rather than a Value is created, as a Document has an
-    // Allocator.
-    rapidjson::Document ad_details;
-    ad_details.SetObject();
-    // AddMember moves itr's Values, do not reference them anymore.
-    ad_details.AddMember(itr->name, itr->value, ad_details.GetAllocator());
-    url_to_signals.try_emplace(std::move(ad_url), std::move(ad_details));
-  }
-  return url_to_signals;
-}
-
-// Builds a set of ad component render urls for components used in more than one
-// ad with bid. Since a single ad component might be a part of multiple ads, and
-// since rapidjson enforces moves over copies unless explicitly specified
-// otherwise (that's what makes it "rapid"), we need to know which ad component
-// scoring signals need to be copied rather than moved. Otherwise, for an ad
-// component used n times, moving its signals would fail on all times except the
-// first. O(n) operation, where n is the number of ad component render urls.
-absl::flat_hash_set<std::string> FindSharedComponentUrls(
-    const google::protobuf::RepeatedPtrField<AdWithBidMetadata>&
-        ads_with_bids) {
-  absl::flat_hash_map<std::string, int> url_occurrences;
-  absl::flat_hash_set<std::string> multiple_occurrence_component_urls;
-  for (const auto& ad_with_bid : ads_with_bids) {
-    for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
-      ++url_occurrences[ad_component_render_url];
-      if (url_occurrences[ad_component_render_url] > 1) {
-        std::string copy_of_ad_component_render_url = ad_component_render_url;
-        multiple_occurrence_component_urls.emplace(
-            std::move(copy_of_ad_component_render_url));
-      }
-    }
-  }
-  return multiple_occurrence_component_urls;
+// Appends `"url":signals` to `out`.
+void AppendUrlSignals(absl::string_view url, absl::string_view signals,
+                      std::string& out) {
+  AppendJsonString(url, out);
+  out.push_back(':');
+  AppendMinifiedJson(signals, out);
 }
 
-// Adds scoring signals for ad component render urls to signals object
-// for a single ad with bid, `ad_with_bid`.
-// `ad_with_bid` and `multiple_occurrence_component_urls` will only
-// be read from. `component_signals` must be filled with the trusted scoring
-// signals for this ad's ad component render urls. If an ad component render url
-// is not in `multiple_occurrence_component_urls`, then its signals will be
-// moved out from `component signals`. Else they will be copied for use here and
-// left intact for use in future calls to this method.
-// Returns a JSON document that contains the scoring signals for all ad
-// component render URLs in this ad_with_bid.
-absl::StatusOr<rapidjson::Document> AddComponentSignals(
-    const AdWithBidMetadata& ad_with_bid,
-    const absl::flat_hash_set<std::string>& multiple_occurrence_component_urls,
-    absl::flat_hash_map<std::string, rapidjson::Document>& component_signals) {
-  // Create overall signals object.
-  rapidjson::Document combined_signals_for_this_bid;
-  combined_signals_for_this_bid.SetObject();
-  // Create empty expandable object to add ad component signals to.
-  rapidjson::Document empty_object;
-  empty_object.SetObject();
-  // Add the expandable object to the combined signals object.
-  auto combined_signals_itr =
-      combined_signals_for_this_bid
-          .AddMember(kAdComponentRenderUrlsProperty, empty_object,
-                     combined_signals_for_this_bid.GetAllocator())
-          .MemberBegin();
-
-  for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
-    // Check if there are signals for this component ad.
-    auto component_url_signals_itr =
-        component_signals.find(ad_component_render_url);
-    if (component_url_signals_itr == component_signals.end()) {
-      continue;
-    }
-    // Copy only if necessary.
-    rapidjson::Document to_add;
-    if (multiple_occurrence_component_urls.contains(ad_component_render_url)) {
-      // Use the allocator of the object to which these signals are
-      // ultimately going.
-      to_add.CopyFrom(component_url_signals_itr->second,
-                      combined_signals_for_this_bid.GetAllocator());
-    } else {
-      to_add.Swap(component_url_signals_itr->second);
-    }
-    // Grab member to avoid finding it twice.
-    auto comp_url_signals_to_move_from =
-        to_add.FindMember(ad_component_render_url.c_str());
-    // This should never happen, the map entry's signals should always
-    // be for the URL on which the map is keyed.
-    if (comp_url_signals_to_move_from == to_add.MemberEnd()) {
-      // This can only be caused by an error forming the map on our
-      // side.
-      return absl::Status(
-          absl::StatusCode::kInternal,
-          "Internal error while processing trusted scoring signals.");
-    }
-    // AddMember moves the values input into it, do not reference them
-    // anymore.
-    combined_signals_itr->value.AddMember(
-        comp_url_signals_to_move_from->name,
-        comp_url_signals_to_move_from->value,
-        combined_signals_for_this_bid.GetAllocator());
-  }
-  return combined_signals_for_this_bid;
-}
-
-// Create bid metadata json string but doesn't close the json object
-// for adding more fields.
-std::string MakeOpenBidMetadataJson(
+constexpr JsonKey kIGOwnerKey(kIGOwnerPropertyForScoreAd);
+constexpr JsonKey kTopWindowHostnameKey(kTopWindowHostnamePropertyForScoreAd);
+constexpr JsonKey kAdComponentsKey("adComponents");
+constexpr JsonKey kBidCurrencyKey(kBidCurrencyPropertyForScoreAd);
+constexpr JsonKey kTopLevelSellerKey(kTopLevelSellerFieldPropertyForScoreAd);
+constexpr JsonKey kComponentSellerKey(kComponentSellerFieldPropertyForScoreAd);
+constexpr JsonKey kRenderUrlKey(kRenderUrlsPropertyForScoreAd);
+
+// Writes the bid metadata fields shared by all auctions, which come first.
+template <typename JsonWriter>
+void WriteBidMetadataFields(
     absl::string_view publisher_hostname,
-    absl::string_view interest_group_owner, absl::string_view render_url,
+    absl::string_view interest_group_owner,
     const google::protobuf::RepeatedPtrField<std::string>&
         ad_component_render_urls,
-    absl::string_view bid_currency) {
-  std::string bid_metadata = "{";
+    absl::string_view bid_currency, JsonWriter& writer) {
   if (!interest_group_owner.empty()) {
-    absl::StrAppend(&bid_metadata, R"JSON(")JSON", kIGOwnerPropertyForScoreAd,
-                    R"JSON(":")JSON", interest_group_owner, R"JSON(",)JSON");
+    writer.String(kIGOwnerKey, interest_group_owner);
   }
   if (!publisher_hostname.empty()) {
-    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
-                    kTopWindowHostnamePropertyForScoreAd, R"JSON(":")JSON",
-                    publisher_hostname, R"JSON(",)JSON");
+    writer.String(kTopWindowHostnameKey, publisher_hostname);
   }
   if (!ad_component_render_urls.empty()) {
-    absl::StrAppend(&bid_metadata, R"("adComponents":[)");
-    for (int i = 0; i < ad_component_render_urls.size(); i++) {
-      absl::StrAppend(&bid_metadata, "\"", ad_component_render_urls.at(i),
-                      "\"");
-      if (i != ad_component_render_urls.size() - 1) {
-        absl::StrAppend(&bid_metadata, ",");
-      }
-    }
-    absl::StrAppend(&bid_metadata, R"(],)");
-  }
-  if (!bid_currency.empty()) {
-    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
-                    kBidCurrencyPropertyForScoreAd, R"JSON(":")JSON",
-                    bid_currency, R"JSON(",)JSON");
-  } else {
-    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
-                    kBidCurrencyPropertyForScoreAd, R"JSON(":")JSON",
-                    kEmptyBidCurrencyCode, R"JSON(",)JSON");
+    writer.StringArray(kAdComponentsKey, ad_component_render_urls);
   }
-  return bid_metadata;
+  writer.String(kBidCurrencyKey,
+                bid_currency.empty() ? kEmptyBidCurrencyCode : bid_currency);
 }
 
 // Gets the debug reporting URL (either win or loss URL) if the URL will not
@@ -224,6 +112,82 @@ inline absl::string_view GetDebugUrlIfInLimit(
   return "";
 }
 
+// Fields of a score ad record, in order.
+enum class ScoreAdRecordField : int {
+  kDesirability = 0,
+  kAllowComponentAuction,
+  kBid,
+  kBidCurrency,
+  kIncomingBidInSellerCurrency,
+  kRejectReason,
+  kNumFields,
+};
+
+constexpr int ScoreAdRecordIndex(ScoreAdRecordField field) {
+  return static_cast<int>(field);
+}
+
+// Strips the quotes of a score ad record returned as a JSON string. The record
+// has no characters that JSON escapes.
+absl::string_view UnquoteScoreAdRecord(absl::string_view response) {
+  if (response.size() >= 2 && response.front() == '"' &&
+      response.back() == '"') {
+    response.remove_prefix(1);
+    response.remove_suffix(1);
+  }
+  return response;
+}
+
+// Parses the number of a field of a score ad record unless it is empty.
+absl::Status ParseScoreAdRecordNumber(absl::string_view field,
+                                      absl::string_view name,
+                                      std::optional<float>& number) {
+  if (field.empty()) {
+    return absl::OkStatus();
+  }
+  double value;
+  if (!absl::SimpleAtod(field, &value)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid ", name, " in score ad record: ", field));
+  }
+  number = static_cast<float>(value);
+  return absl::OkStatus();
+}
+
+// Returns the scoring signals argument of a chunk of ads, which holds the
+// signals bound into several ads once.
+std::shared_ptr<std::string> BuildScoringSignalsOfChunk(
+    absl::Span<const DispatchRequest> ads) {
+  const int index = ScoreArgIndex(ScoreAdArgs::kScoringSignals);
+  absl::flat_hash_map<const std::string*, int> signals_indices;
+  std::vector<const std::string*> signals;
+  std::vector<int> indices;
+  indices.reserve(ads.size());
+  size_t size = 32 + 8 * ads.size();
+  for (const DispatchRequest& ad : ads) {
+    const std::string* ad_signals = ad.input[index].get();
+    auto [it, inserted] =
+        signals_indices.try_emplace(ad_signals, signals.size());
+    if (inserted) {
+      signals.push_back(ad_signals);
+      size += ad_signals->size() + 1;
+    }
+    indices.push_back(it->second);
+  }
+  auto values = std::make_shared<std::string>();
+  values->reserve(size);
+  values->append(R"JSON({"signals":[)JSON");
+  for (const std::string* ad_signals : signals) {
+    if (ad_signals != signals.front()) {
+      values->push_back(',');
+    }
+    values->append(*ad_signals);
+  }
+  absl::StrAppend(values.get(), R"JSON(],"indices":[)JSON",
+                  absl::StrJoin(indices, ","), "]}");
+  return values;
+}
+
 }  // namespace
 
 void MayLogScoreAdsInput(const std::vector<std::shared_ptr<std::string>>& input,
@@ -259,18 +223,15 @@ std::string MakeBidMetadata(
     const google::protobuf::RepeatedPtrField<std::string>&
         ad_component_render_urls,
     absl::string_view top_level_seller, absl::string_view bid_currency) {
-  std::string bid_metadata = MakeOpenBidMetadataJson(
-      publisher_hostname, interest_group_owner, render_url,
-      ad_component_render_urls, bid_currency);
-  // Only add top level seller to bid metadata if it's non empty.
-  if (!top_level_seller.empty()) {
-    absl::StrAppend(&bid_metadata, R"JSON(")JSON",
-                    kTopLevelSellerFieldPropertyForScoreAd, R"JSON(":")JSON",
-                    top_level_seller, R"JSON(",)JSON");
-  }
-  absl::StrAppend(&bid_metadata, R"JSON(")JSON", kRenderUrlsPropertyForScoreAd,
-                  R"JSON(":")JSON", render_url, R"JSON("})JSON");
-  return bid_metadata;
+  return WriteJsonObject([&](auto& writer) {
+    WriteBidMetadataFields(publisher_hostname, interest_group_owner,
+                           ad_component_render_urls, bid_currency, writer);
+    // Only add top level seller to bid metadata if it's non empty.
+    if (!top_level_seller.empty()) {
+      writer.String(kTopLevelSellerKey, top_level_seller);
+    }
+    writer.String(kRenderUrlKey, render_url);
+  });
 }
 
 std::string MakeBidMetadataForTopLevelAuction(
@@ -279,124 +240,140 @@ std::string MakeBidMetadataForTopLevelAuction(
     const google::protobuf::RepeatedPtrField<std::string>&
         ad_component_render_urls,
     absl::string_view component_seller, absl::string_view bid_currency) {
-  std::string bid_metadata = MakeOpenBidMetadataJson(
-      publisher_hostname, interest_group_owner, render_url,
-      ad_component_render_urls, bid_currency);
-  absl::StrAppend(&bid_metadata, R"JSON(")JSON",
-                  kComponentSellerFieldPropertyForScoreAd, R"JSON(":")JSON",
-                  component_seller, R"JSON(",)JSON");
-  absl::StrAppend(&bid_metadata, R"JSON(")JSON", kRenderUrlsPropertyForScoreAd,
-                  R"JSON(":")JSON", render_url, R"JSON("})JSON");
-  return bid_metadata;
+  return WriteJsonObject([&](auto& writer) {
+    WriteBidMetadataFields(publisher_hostname, interest_group_owner,
+                           ad_component_render_urls, bid_currency, writer);
+    writer.String(kComponentSellerKey, component_seller);
+    writer.String(kRenderUrlKey, render_url);
+  });
+}
+
+std::string ScoringSignalsKey(
+    absl::string_view render_url,
+    const RepeatedPtrField<std::string>& ad_component_render_urls) {
+  if (ad_component_render_urls.empty()) {
+    return std::string(render_url);
+  }
+  // URLs do not hold spaces, so that the key cannot be that of other URLs.
+  return absl::StrCat(render_url, " ",
+                      absl::StrJoin(ad_component_render_urls, " "));
 }
 
-absl::StatusOr<absl::flat_hash_map<std::string, rapidjson::StringBuffer>>
-BuildTrustedScoringSignals(
+absl::StatusOr<TrustedScoringSignals> BuildTrustedScoringSignals(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
     ContextImpl& log_context) {
-  rapidjson::Document trusted_scoring_signals_value;
-  // TODO (b/285214424): De-nest, use a guard.
-  if (!raw_request.scoring_signals().empty()) {
-    // Attempt to parse into an object.
-    auto start_parse_time = absl::Now();
-    rapidjson::ParseResult parse_result =
-        trusted_scoring_signals_value.Parse<rapidjson::kParseFullPrecisionFlag>(
-            raw_request.scoring_signals().data());
-    if (parse_result.IsError()) {
-      // TODO (b/285215004): Print offset to ease debugging.
-      PS_VLOG(kNoisyWarn, log_context)
-          << "Trusted scoring signals JSON parse error: "
-          << rapidjson::GetParseError_En(parse_result.Code())
-          << ", trusted signals were: " << raw_request.scoring_signals();
-      return absl::InvalidArgumentError("Malformed trusted scoring signals");
+  if (raw_request.scoring_signals().empty()) {
+    return absl::InvalidArgumentError(kNoTrustedScoringSignals);
+  }
+  auto start_parse_time = absl::Now();
+  // Only the signals of the render URLs and ad component render URLs used in
+  // this request are located in the KV response, and they are referenced in
+  // place instead of being parsed into documents.
+  JsonObjectSpans render_url_signals;
+  JsonObjectSpans component_signals;
+  for (const auto& ad_with_bid : raw_request.ad_bids()) {
+    render_url_signals.members.try_emplace(ad_with_bid.render());
+    for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
+      component_signals.members.try_emplace(ad_component_render_url);
+    }
+  }
+  for (const auto& protected_app_signals_ad_bid :
+       raw_request.protected_app_signals_ad_bids()) {
+    render_url_signals.members.try_emplace(
+        protected_app_signals_ad_bid.render());
+  }
+  if (absl::Status status = FindJsonMemberSpans(
+          raw_request.scoring_signals(),
+          {{kRenderUrlsPropertyForKVResponse, &render_url_signals},
+           {kAdComponentRenderUrlsProperty, &component_signals}});
+      !status.ok()) {
+    PS_VLOG(kNoisyWarn, log_context)
+        << "Trusted scoring signals JSON parse error: " << status.message()
+        << ", trusted signals were: " << raw_request.scoring_signals();
+    return absl::InvalidArgumentError("Malformed trusted scoring signals");
+  }
+  if (!render_url_signals.found) {
+    // If there are no scoring signals for any render urls, none can be
+    // scored. Abort now.
+    return absl::InvalidArgumentError(
+        "Trusted scoring signals include no render urls.");
+  }
+
+  // Each AdWithBid needs signals for both its render URL and its ad component
+  // render urls, which are concatenated from the spans of the KV response
+  // once for all the ads of the same render URL and ad components.
+  TrustedScoringSignals combined_signals;
+  combined_signals.reserve(raw_request.ad_bids_size() +
+                           raw_request.protected_app_signals_ad_bids_size());
+  for (const auto& ad_with_bid : raw_request.ad_bids()) {
+    // Check for the render URL's signals; skip if none.
+    // (Ad with bid will not be scored anyways in that case.)
+    absl::string_view ad_signals =
+        render_url_signals.members.find(ad_with_bid.render())->second;
+    if (ad_signals.data() == nullptr) {
+      continue;
     }
-    // Build a map of the signals for each render URL.
-    auto render_urls_itr = trusted_scoring_signals_value.FindMember(
-        kRenderUrlsPropertyForKVResponse);
-    if (render_urls_itr == trusted_scoring_signals_value.MemberEnd()) {
-      // If there are no scoring signals for any render urls, none can be
-      // scored. Abort now.
-      return absl::InvalidArgumentError(
-          "Trusted scoring signals include no render urls.");
+    auto [it, inserted] = combined_signals.try_emplace(
+        ScoringSignalsKey(ad_with_bid.render(), ad_with_bid.ad_components()));
+    if (!inserted) {
+      continue;
     }
-    absl::flat_hash_map<std::string, rapidjson::Document> render_url_signals =
-        BuildAdScoringSignalsMap(render_urls_itr->value);
-    // No scoring signals for ad component render urls are required,
-    // however if present we build a map to their scoring signals in the same
-    // way.
-    absl::flat_hash_map<std::string, rapidjson::Document> component_signals;
-    auto component_urls_itr = trusted_scoring_signals_value.FindMember(
-        kAdComponentRenderUrlsProperty);
-    if (component_urls_itr != trusted_scoring_signals_value.MemberEnd()) {
-      component_signals = BuildAdScoringSignalsMap(component_urls_itr->value);
+    // Upper bound of the size, the spans only shrink when minified.
+    size_t signals_size = ad_with_bid.render().size() + ad_signals.size() +
+                          sizeof(kAdComponentRenderUrlsProperty) +
+                          sizeof(kRenderUrlsPropertyForScoreAd) + 16;
+    for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
+      signals_size +=
+          ad_component_render_url.size() +
+          component_signals.members.find(ad_component_render_url)
+              ->second.size() +
+          4;
     }
-
-    // Find the ad component render urls used more than once so we know which
-    // signals we must copy rather than move.
-    absl::flat_hash_set<std::string> multiple_occurrence_component_urls =
-        FindSharedComponentUrls(raw_request.ad_bids());
-    // Each AdWithBid needs signals for both its render URL and its ad component
-    // render urls.
-    absl::flat_hash_map<std::string, rapidjson::Document> combined_signals;
-    for (const auto& ad_with_bid : raw_request.ad_bids()) {
-      // Now that we have a map of all component signals and all ad signals, we
-      // can build the object.
-      // Check for the render URL's signals; skip if none.
-      // (Ad with bid will not be scored anyways in that case.)
-      auto render_url_signals_itr =
-          render_url_signals.find(ad_with_bid.render());
-      if (render_url_signals_itr == render_url_signals.end()) {
+    std::string signals_for_this_bid;
+    signals_for_this_bid.reserve(signals_size);
+    absl::StrAppend(&signals_for_this_bid, R"JSON({")JSON",
+                    kAdComponentRenderUrlsProperty, R"JSON(":{)JSON");
+    bool first_component = true;
+    for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
+      absl::string_view component_url_signals =
+          component_signals.members.find(ad_component_render_url)->second;
+      if (component_url_signals.data() == nullptr) {
         continue;
       }
-      absl::StatusOr<rapidjson::Document> combined_signals_for_this_bid;
-      PS_ASSIGN_OR_RETURN(
-          combined_signals_for_this_bid,
-          AddComponentSignals(ad_with_bid, multiple_occurrence_component_urls,
-                              component_signals));
-      // Do not reference values after move.
-      combined_signals_for_this_bid->AddMember(
-          kRenderUrlsPropertyForScoreAd, render_url_signals_itr->second,
-          combined_signals_for_this_bid->GetAllocator());
-      combined_signals.try_emplace(ad_with_bid.render(),
-                                   *std::move(combined_signals_for_this_bid));
+      if (!first_component) {
+        signals_for_this_bid.push_back(',');
+      }
+      first_component = false;
+      AppendUrlSignals(ad_component_render_url, component_url_signals,
+                       signals_for_this_bid);
     }
+    absl::StrAppend(&signals_for_this_bid, R"JSON(},")JSON",
+                    kRenderUrlsPropertyForScoreAd, R"JSON(":{)JSON");
+    AppendUrlSignals(ad_with_bid.render(), ad_signals, signals_for_this_bid);
+    absl::StrAppend(&signals_for_this_bid, "}}");
+    it->second = std::make_shared<std::string>(std::move(signals_for_this_bid));
+  }
 
-    MayPopulateScoringSignalsForProtectedAppSignals(
-        raw_request, render_url_signals, combined_signals, log_context);
-
-    // Now turn the editable JSON documents into string buffers before
-    // returning.
-    absl::flat_hash_map<std::string, rapidjson::StringBuffer>
-        combined_formatted_ad_signals;
-    for (const auto& [render_url, scoring_signals_json_obj] :
-         combined_signals) {
-      rapidjson::StringBuffer buffer;
-      rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-      scoring_signals_json_obj.Accept(writer);
-      combined_formatted_ad_signals.try_emplace(render_url, std::move(buffer));
-    }
+  MayPopulateScoringSignalsForProtectedAppSignals(
+      raw_request, render_url_signals.members, combined_signals, log_context);
 
-    PS_VLOG(kStats, log_context)
-        << "\nTrusted Scoring Signals Deserialize Time: "
-        << ToInt64Microseconds((absl::Now() - start_parse_time))
-        << " microseconds for " << combined_formatted_ad_signals.size()
-        << " signals.";
-    return combined_formatted_ad_signals;
-  } else {
-    return absl::InvalidArgumentError(kNoTrustedScoringSignals);
-  }
+  PS_VLOG(kStats, log_context)
+      << "\nTrusted Scoring Signals Deserialize Time: "
+      << ToInt64Microseconds((absl::Now() - start_parse_time))
+      << " microseconds for " << combined_signals.size() << " signals.";
+  return combined_signals;
 }
 
 void MayPopulateScoringSignalsForProtectedAppSignals(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
-    absl::flat_hash_map<std::string, rapidjson::Document>& render_url_signals,
-    absl::flat_hash_map<std::string, rapidjson::Document>& combined_signals,
-    ContextImpl& log_context) {
+    const absl::flat_hash_map<absl::string_view, absl::string_view>&
+        render_url_signals,
+    TrustedScoringSignals& combined_signals, ContextImpl& log_context) {
   PS_VLOG(8, log_context) << __func__;
   for (const auto& protected_app_signals_ad_bid :
        raw_request.protected_app_signals_ad_bids()) {
     auto it = render_url_signals.find(protected_app_signals_ad_bid.render());
-    if (it == render_url_signals.end()) {
+    if (it == render_url_signals.end() || it->second.data() == nullptr) {
       PS_VLOG(5, log_context)
           << "Skipping protected app signals ad since render "
              "URL is not found in the scoring signals: "
@@ -404,13 +381,18 @@ void MayPopulateScoringSignalsForProtectedAppSignals(
       continue;
     }
 
-    rapidjson::Document combined_signals_for_this_bid(rapidjson::kObjectType);
-    combined_signals_for_this_bid.AddMember(
-        kRenderUrlsPropertyForScoreAd, it->second,
-        combined_signals_for_this_bid.GetAllocator());
-    const auto& [unused_it, succeeded] =
-        combined_signals.try_emplace(protected_app_signals_ad_bid.render(),
-                                     std::move(combined_signals_for_this_bid));
+    std::string combined_signals_for_this_bid;
+    combined_signals_for_this_bid.reserve(
+        it->first.size() + it->second.size() +
+        sizeof(kRenderUrlsPropertyForScoreAd) + 8);
+    absl::StrAppend(&combined_signals_for_this_bid, R"JSON({")JSON",
+                    kRenderUrlsPropertyForScoreAd, R"JSON(":{)JSON");
+    AppendUrlSignals(it->first, it->second, combined_signals_for_this_bid);
+    absl::StrAppend(&combined_signals_for_this_bid, "}}");
+    const auto& [unused_it, succeeded] = combined_signals.try_emplace(
+        protected_app_signals_ad_bid.render(),
+        std::make_shared<std::string>(
+            std::move(combined_signals_for_this_bid)));
     if (!succeeded) {
       PS_LOG(ERROR, log_context) << "Render URL overlaps between bids: "
                                  << protected_app_signals_ad_bid.render();
@@ -422,8 +404,18 @@ absl::StatusOr<rapidjson::Document> ParseAndGetScoreAdResponseJson(
     bool enable_ad_tech_code_logging, const std::string& response,
     ContextImpl& log_context) {
   PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  return GetScoreAdResponseJson(enable_ad_tech_code_logging, document,
+                                log_context);
+}
+
+rapidjson::Document GetScoreAdResponseJson(bool enable_ad_tech_code_logging,
+                                           const rapidjson::Document& document,
+                                           ContextImpl& log_context,
+                                           JsonArena* json_arena) {
   MayVlogAdTechCodeLogs(enable_ad_tech_code_logging, document, log_context);
-  rapidjson::Document response_obj;
+  rapidjson::Document response_obj = json_arena == nullptr
+                                         ? rapidjson::Document()
+                                         : json_arena->NewDocument();
   auto iterator = document.FindMember("response");
   if (iterator != document.MemberEnd()) {
     if (iterator->value.IsObject()) {
@@ -446,10 +438,10 @@ ParseAdRejectionReason(const rapidjson::Document& score_ad_resp,
       !reject_reason_itr->value.IsString()) {
     return std::nullopt;
   }
-  std::string rejection_reason_str =
-      score_ad_resp[kRejectReasonPropertyForScoreAd].GetString();
   SellerRejectionReason rejection_reason =
-      ToSellerRejectionReason(rejection_reason_str);
+      ToSellerRejectionReason(absl::string_view(
+          reject_reason_itr->value.GetString(),
+          reject_reason_itr->value.GetStringLength()));
   ScoreAdsResponse::AdScore::AdRejectionReason ad_rejection_reason;
   ad_rejection_reason.set_interest_group_owner(interest_group_owner);
   ad_rejection_reason.set_interest_group_name(interest_group_name);
@@ -457,6 +449,22 @@ ParseAdRejectionReason(const rapidjson::Document& score_ad_resp,
   return ad_rejection_reason;
 }
 
+std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
+ParseAdRejectionReason(absl::string_view reject_reason,
+                       absl::string_view interest_group_owner,
+                       absl::string_view interest_group_name) {
+  // An empty rejectReason is not available, just like an unset one.
+  if (reject_reason.empty()) {
+    return std::nullopt;
+  }
+  ScoreAdsResponse::AdScore::AdRejectionReason ad_rejection_reason;
+  ad_rejection_reason.set_interest_group_owner(interest_group_owner);
+  ad_rejection_reason.set_interest_group_name(interest_group_name);
+  ad_rejection_reason.set_rejection_reason(
+      ToSellerRejectionReason(reject_reason));
+  return ad_rejection_reason;
+}
+
 absl::StatusOr<ScoreAdsResponse::AdScore> ParseScoreAdResponse(
     const rapidjson::Document& score_ad_resp,
     int max_allowed_size_debug_url_chars,
@@ -570,9 +578,98 @@ absl::StatusOr<ScoreAdsResponse::AdScore> ParseScoreAdResponse(
   return score_ads_response;
 }
 
+bool IsScoreAdRecord(absl::string_view response) {
+  return absl::StartsWith(UnquoteScoreAdRecord(response), kScoreAdRecordPrefix);
+}
+
+absl::StatusOr<ScoreAdsResponse::AdScore> ParseScoreAdRecord(
+    absl::string_view response, bool device_component_auction,
+    absl::string_view& reject_reason) {
+  absl::string_view record = UnquoteScoreAdRecord(response);
+  if (!absl::ConsumePrefix(&record, kScoreAdRecordPrefix)) {
+    return absl::InvalidArgumentError("Not a score ad record");
+  }
+  constexpr int kNumFields =
+      ScoreAdRecordIndex(ScoreAdRecordField::kNumFields);
+  absl::string_view fields[kNumFields];
+  int num_fields = 0;
+  for (absl::string_view field : absl::StrSplit(record, '|')) {
+    if (num_fields == kNumFields) {
+      return absl::InvalidArgumentError("Too many fields in score ad record");
+    }
+    fields[num_fields++] = field;
+  }
+  if (num_fields != kNumFields) {
+    return absl::InvalidArgumentError("Too few fields in score ad record");
+  }
+  auto field = [&fields](ScoreAdRecordField record_field) {
+    return fields[ScoreAdRecordIndex(record_field)];
+  };
+
+  ScoreAdsResponse::AdScore score_ads_response;
+  // Default value.
+  score_ads_response.set_allow_component_auction(false);
+  std::optional<float> desirability;
+  PS_RETURN_IF_ERROR(ParseScoreAdRecordNumber(
+      field(ScoreAdRecordField::kDesirability),
+      kDesirabilityPropertyForScoreAd, desirability));
+  score_ads_response.set_desirability(desirability.value_or(0.0));
+  std::optional<float> incoming_bid_in_seller_currency;
+  PS_RETURN_IF_ERROR(ParseScoreAdRecordNumber(
+      field(ScoreAdRecordField::kIncomingBidInSellerCurrency),
+      kIncomingBidInSellerCurrency, incoming_bid_in_seller_currency));
+  if (incoming_bid_in_seller_currency.has_value()) {
+    score_ads_response.set_incoming_bid_in_seller_currency(
+        *incoming_bid_in_seller_currency);
+  }
+  // For now component auction fields are only valid for ProtectedAuction ads.
+  if (device_component_auction) {
+    score_ads_response.set_allow_component_auction(
+        field(ScoreAdRecordField::kAllowComponentAuction) == "1");
+    std::optional<float> bid;
+    PS_RETURN_IF_ERROR(
+        ParseScoreAdRecordNumber(field(ScoreAdRecordField::kBid),
+                                 kModifiedBidForComponentAuction, bid));
+    if (bid.has_value()) {
+      score_ads_response.set_bid(*bid);
+    }
+    if (absl::string_view bid_currency =
+            field(ScoreAdRecordField::kBidCurrency);
+        !bid_currency.empty()) {
+      score_ads_response.set_bid_currency(bid_currency);
+    }
+  }
+  reject_reason = field(ScoreAdRecordField::kRejectReason);
+  return score_ads_response;
+}
+
+ScoreAdsResponse::AdScore ScoreAdNatively(
+    float bid, absl::string_view bid_currency,
+    absl::string_view seller_currency, double bid_floor,
+    bool allow_component_auction, bool device_component_auction,
+    std::optional<SellerRejectionReason>& rejection_reason) {
+  ScoreAdsResponse::AdScore score_ads_response;
+  score_ads_response.set_allow_component_auction(false);
+  if (!seller_currency.empty() && !bid_currency.empty() &&
+      bid_currency != seller_currency) {
+    rejection_reason =
+        SellerRejectionReason::BID_FROM_GENERATE_BID_FAILED_CURRENCY_CHECK;
+    return score_ads_response;
+  }
+  if (bid < bid_floor) {
+    rejection_reason = SellerRejectionReason::BID_BELOW_AUCTION_FLOOR;
+    return score_ads_response;
+  }
+  score_ads_response.set_desirability(bid);
+  if (device_component_auction) {
+    score_ads_response.set_allow_component_auction(allow_component_auction);
+  }
+  return score_ads_response;
+}
+
 absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
     absl::string_view ad_render_url, absl::string_view ad_metadata_json,
-    absl::string_view scoring_signals, float ad_bid,
+    std::shared_ptr<std::string> scoring_signals, float ad_bid,
     const std::shared_ptr<std::string>& auction_config,
     absl::string_view bid_metadata,
     server_common::log::ContextImpl& log_context,
@@ -597,7 +694,7 @@ absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
       auction_config;
   // TODO(b/258697130): Roma client string support bug
   score_ad_request.input[ScoreArgIndex(ScoreAdArgs::kScoringSignals)] =
-      std::make_shared<std::string>(scoring_signals);
+      std::move(scoring_signals);
   score_ad_request.input[ScoreArgIndex(ScoreAdArgs::kBidMetadata)] =
       std::make_shared<std::string>(bid_metadata);
   // This is only added to prevent errors in the score ad script, and
@@ -606,12 +703,62 @@ absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
       std::make_shared<std::string>("{}");
   score_ad_request.input[ScoreArgIndex(ScoreAdArgs::kFeatureFlags)] =
       std::make_shared<std::string>(GetFeatureFlagJson(
-          enable_adtech_code_logging, enable_debug_reporting));
-
-  MayLogScoreAdsInput(score_ad_request.input, log_context);
+          enable_adtech_code_logging, enable_debug_reporting,
+          /*enable_udf_profiling=*/enable_adtech_code_logging &&
+              log_context.is_consented()));
   return score_ad_request;
 }
 
+DispatchRequest BuildScoreAdsChunkRequest(
+    absl::Span<const DispatchRequest> ads) {
+  DispatchRequest chunk_request;
+  chunk_request.id = ads.front().id;
+  chunk_request.version_string = ads.front().version_string;
+  chunk_request.handler_name = kScoreAdsBatchHandlerFunctionName;
+  chunk_request.tags = ads.front().tags;
+  chunk_request.input = ads.front().input;
+  chunk_request.input[ScoreArgIndex(ScoreAdArgs::kScoringSignals)] =
+      BuildScoringSignalsOfChunk(ads);
+  for (ScoreAdArgs arg : {ScoreAdArgs::kAdMetadata, ScoreAdArgs::kBid,
+                          ScoreAdArgs::kBidMetadata}) {
+    const int index = ScoreArgIndex(arg);
+    size_t size = ads.size() + 1;
+    for (const DispatchRequest& ad : ads) {
+      size += ad.input[index]->size();
+    }
+    auto values = std::make_shared<std::string>();
+    values->reserve(size);
+    values->push_back('[');
+    for (const DispatchRequest& ad : ads) {
+      if (&ad != &ads.front()) {
+        values->push_back(',');
+      }
+      values->append(*ad.input[index]);
+    }
+    values->push_back(']');
+    chunk_request.input[index] = std::move(values);
+  }
+  return chunk_request;
+}
+
+absl::StatusOr<std::vector<std::string>> SplitScoreAdsChunkResponse(
+    absl::string_view response, int num_ads) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  if (!document.IsArray() || document.Size() != num_ads) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected the outputs of ", num_ads, " ads from scoreAd batch"));
+  }
+  std::vector<std::string> responses;
+  responses.reserve(num_ads);
+  for (const rapidjson::Value& ad_response : document.GetArray()) {
+    // Records are kept as JSON strings, which IsScoreAdRecord accepts.
+    PS_ASSIGN_OR_RETURN(std::string ad_response_json,
+                        SerializeJsonDoc(ad_response));
+    responses.push_back(std::move(ad_response_json));
+  }
+  return responses;
+}
+
 std::unique_ptr<AdWithBidMetadata> MapAuctionResultToAdWithBidMetadata(
     AuctionResult& auction_result) {
   auto ad = std::make_unique<AdWithBidMetadata>();
@@ -17,6 +17,7 @@
 #define SERVICES_AUCTION_SERVICE_PROTO_UTILS_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,6 +26,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "include/rapidjson/document.h"
@@ -32,6 +34,7 @@
 #include "services/auction_service/auction_constants.h"
 #include "services/auction_service/code_wrapper/seller_code_wrapper.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/util/json_util.h"
 #include "src/logger/request_context_impl.h"
 #include "src/util/status_macro/status_macros.h"
 
@@ -54,15 +57,43 @@ std::string MakeBidMetadataForTopLevelAuction(
 std::shared_ptr<std::string> BuildAuctionConfig(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request);
 
-absl::StatusOr<absl::flat_hash_map<std::string, rapidjson::StringBuffer>>
-BuildTrustedScoringSignals(
+/**
+ * Trusted scoring signals of the ads of a request, keyed by ScoringSignalsKey.
+ * The ads of the same render URL and ad component render URLs share the same
+ * immutable signals, which are bound by pointer into their dispatch requests.
+ */
+using TrustedScoringSignals =
+    absl::flat_hash_map<std::string, std::shared_ptr<std::string>>;
+
+/**
+ * Returns the key of the trusted scoring signals of an ad, which combine the
+ * signals of its render URL with those of its ad component render URLs.
+ */
+std::string ScoringSignalsKey(
+    absl::string_view render_url,
+    const google::protobuf::RepeatedPtrField<std::string>&
+        ad_component_render_urls);
+
+inline std::string ScoringSignalsKey(
+    const ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata& ad) {
+  return ScoringSignalsKey(ad.render(), ad.ad_components());
+}
+
+inline std::string ScoringSignalsKey(
+    const ScoreAdsRequest::ScoreAdsRawRequest::
+        ProtectedAppSignalsAdWithBidMetadata& ad) {
+  return ad.render();
+}
+
+absl::StatusOr<TrustedScoringSignals> BuildTrustedScoringSignals(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
     server_common::log::ContextImpl& log_context);
 
 void MayPopulateScoringSignalsForProtectedAppSignals(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
-    absl::flat_hash_map<std::string, rapidjson::Document>& render_url_signals,
-    absl::flat_hash_map<std::string, rapidjson::Document>& combined_signals,
+    const absl::flat_hash_map<absl::string_view, absl::string_view>&
+        render_url_signals,
+    TrustedScoringSignals& combined_signals,
     server_common::log::ContextImpl& log_context);
 
 void MayLogScoreAdsInput(const std::vector<std::shared_ptr<std::string>>& input,
@@ -72,18 +103,58 @@ absl::StatusOr<rapidjson::Document> ParseAndGetScoreAdResponseJson(
     bool enable_ad_tech_code_logging, const std::string& response,
     server_common::log::ContextImpl& log_context);
 
+// Same as ParseAndGetScoreAdResponseJson for output of scoreAd that was
+// already parsed. The returned document is allocated from `json_arena` if set.
+rapidjson::Document GetScoreAdResponseJson(
+    bool enable_ad_tech_code_logging, const rapidjson::Document& document,
+    server_common::log::ContextImpl& log_context,
+    JsonArena* json_arena = nullptr);
+
 std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
 ParseAdRejectionReason(const rapidjson::Document& score_ad_resp,
                        absl::string_view interest_group_owner,
                        absl::string_view interest_group_name,
                        server_common::log::ContextImpl& log_context);
 
+// Same as above for the rejectReason of a score ad record, empty if unset.
+std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
+ParseAdRejectionReason(absl::string_view reject_reason,
+                       absl::string_view interest_group_owner,
+                       absl::string_view interest_group_name);
+
 absl::StatusOr<ScoreAdsResponse::AdScore> ParseScoreAdResponse(
     const rapidjson::Document& score_ad_resp,
     int max_allowed_size_debug_url_chars,
     int64_t max_allowed_size_all_debug_urls_chars,
     bool device_component_auction, int64_t& current_all_debug_urls_chars);
 
+// Whether `response`, the output of scoreAdEntryFunction, is a record of the
+// output of scoreAd instead of JSON. The seller code wrapper writes a record
+// when the output only has the fields below and no logs, as `|` separated
+// fields after kScoreAdRecordPrefix, possibly quoted as a JSON string:
+//   psScore1|desirability|allowComponentAuction as 0 or 1|bid|bidCurrency|
+//   incomingBidInSellerCurrency|rejectReason
+// Fields that scoreAd does not set are empty.
+bool IsScoreAdRecord(absl::string_view response);
+
+// Same as ParseScoreAdResponse for a score ad record, without parsing JSON.
+// Sets `reject_reason` to the rejectReason of the record, which points into
+// `response`.
+absl::StatusOr<ScoreAdsResponse::AdScore> ParseScoreAdRecord(
+    absl::string_view response, bool device_component_auction,
+    absl::string_view& reject_reason);
+
+// Scores an ad natively, in place of scoreAd, for the sellers configured
+// with NativeScoring: the desirability of the ad is its bid. Bids in another
+// currency than the seller currency, if both are set, and bids below
+// `bid_floor` are rejected with a desirability of 0, and `rejection_reason`
+// set. Component auction fields are only set if `device_component_auction`.
+ScoreAdsResponse::AdScore ScoreAdNatively(
+    float bid, absl::string_view bid_currency,
+    absl::string_view seller_currency, double bid_floor,
+    bool allow_component_auction, bool device_component_auction,
+    std::optional<SellerRejectionReason>& rejection_reason);
+
 constexpr int ScoreArgIndex(ScoreAdArgs arg) {
   return static_cast<std::underlying_type_t<ScoreAdArgs>>(arg);
 }
@@ -111,24 +182,47 @@ MapAuctionResultToAdWithBidMetadata(AuctionResult& auction_result);
  * empty string is mapped to undefined
  * all strings have to be valid JSON objects ({}) or escaped JSON Strings
  * (\"hello-world\").
+ *
+ * The scoring signals are bound by pointer, so that the ads sharing them
+ * share the same argument. The inputs are not logged, callers log them with
+ * MayLogScoreAdsInput, so that requests built concurrently do not log into
+ * the same context at once.
  */
 absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
     absl::string_view ad_render_url, absl::string_view ad_metadata_json,
-    absl::string_view scoring_signals, float ad_bid,
+    std::shared_ptr<std::string> scoring_signals, float ad_bid,
     const std::shared_ptr<std::string>& auction_config,
     absl::string_view bid_metadata,
     server_common::log::ContextImpl& log_context,
     const bool enable_adtech_code_logging, const bool enable_debug_reporting,
     absl::string_view code_version);
 
+/**
+ * Builds the request scoring `ads`, requests built by BuildScoreAdRequest for
+ * the same auction, in a single invocation of scoreAdsBatchEntryFunction. The
+ * arguments specific to an ad are passed as JSON arrays with an element per
+ * ad, and the auction config and other arguments shared by the ads once. The
+ * scoring signals are passed as {"signals":[...],"indices":[...]}, which holds
+ * the signals bound into several ads once, and the index of those of each ad.
+ * The request takes the id and tags of the first ad.
+ */
+DispatchRequest BuildScoreAdsChunkRequest(
+    absl::Span<const DispatchRequest> ads);
+
+/**
+ * Splits the output of scoreAdsBatchEntryFunction for `num_ads` ads into the
+ * outputs of scoreAdEntryFunction for each of them, in order.
+ */
+absl::StatusOr<std::vector<std::string>> SplitScoreAdsChunkResponse(
+    absl::string_view response, int num_ads);
+
 /**
  * Builds ScoreAdInput with AdWithBid or ProtectedAppSignalsAdWithBid.
  */
 template <typename T>
 absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
     const T& ad, const std::shared_ptr<std::string>& auction_config,
-    const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-        scoring_signals,
+    const TrustedScoringSignals& scoring_signals,
     const bool enable_debug_reporting,
     server_common::log::ContextImpl& log_context,
     const bool enable_adtech_code_logging, absl::string_view bid_metadata,
@@ -137,7 +231,7 @@ absl::StatusOr<DispatchRequest> BuildScoreAdRequest(
   PS_RETURN_IF_ERROR(
       google::protobuf::util::MessageToJsonString(ad.ad(), &ad_object_json));
   return BuildScoreAdRequest(
-      ad.render(), ad_object_json, scoring_signals.at(ad.render()).GetString(),
+      ad.render(), ad_object_json, scoring_signals.at(ScoringSignalsKey(ad)),
       ad.bid(), auction_config, bid_metadata, log_context,
       enable_adtech_code_logging, enable_debug_reporting, code_version);
 }
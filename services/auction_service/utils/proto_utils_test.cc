@@ -15,7 +15,10 @@
 #include "services/auction_service/utils/proto_utils.h"
 
 #include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
@@ -105,6 +108,15 @@ TEST(MakeBidMetadataTest, PopulatesExpectedValuesForComponentAuction) {
   EXPECT_EQ(parsed_output["bidCurrency"], kTestBidCurrency);
 }
 
+TEST(MakeBidMetadataTest, EscapesStringsAndDefaultsCurrency) {
+  EXPECT_EQ(
+      MakeBidMetadata(/*publisher_hostname=*/"", "owner\"1\"",
+                      "https://ad?q=\\", {}, /*top_level_seller=*/"",
+                      /*bid_currency=*/""),
+      R"JSON({"interestGroupOwner":"owner\"1\"",)JSON"
+      R"JSON("bidCurrency":"???","renderUrl":"https://ad?q=\\"})JSON");
+}
+
 using AdWithBidMetadata =
     ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata;
 using google::scp::core::test::EqualsProto;
@@ -154,7 +166,8 @@ google::protobuf::Value GetTestAdMetadata() {
 TEST(BuildScoreAdRequestTest, PopulatesExpectedValuesInDispatchRequest) {
   float test_bid = MakeARandomNumber<float>(0.1, 10.1);
   auto output = BuildScoreAdRequest(
-      kTestRenderUrl, kTestAdMetadataJson, kTestScoringSignals, test_bid,
+      kTestRenderUrl, kTestAdMetadataJson,
+      std::make_shared<std::string>(kTestScoringSignals), test_bid,
       std::make_shared<std::string>(kTestAuctionConfig), kTestBidMetadata,
       log_context,
       /*enable_adtech_code_logging = */ false,
@@ -183,7 +196,8 @@ TEST(BuildScoreAdRequestTest, HandlesAdsMetadataString) {
   float test_bid = MakeARandomNumber<float>(0.1, 10.1);
   std::string ad_metadata_json = R"JSON("test_ads_data")JSON";
   auto output = BuildScoreAdRequest(
-      kTestRenderUrl, ad_metadata_json, kTestScoringSignals, test_bid,
+      kTestRenderUrl, ad_metadata_json,
+      std::make_shared<std::string>(kTestScoringSignals), test_bid,
       std::make_shared<std::string>(kTestAuctionConfig), kTestBidMetadata,
       log_context,
       /*enable_adtech_code_logging = */ false,
@@ -214,16 +228,10 @@ AdWithBidMetadata MakeAnAdWithMetadata(float bid) {
   return ad;
 }
 
-absl::flat_hash_map<std::string, rapidjson::StringBuffer>
-MakeScoringSignalsForAd() {
-  absl::flat_hash_map<std::string, rapidjson::StringBuffer>
-      combined_formatted_ad_signals;
-  rapidjson::Document scoring_signal;
-  scoring_signal.Parse(kTestScoringSignals);
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-  scoring_signal.Accept(writer);
-  combined_formatted_ad_signals.try_emplace(kTestRenderUrl, std::move(buffer));
+TrustedScoringSignals MakeScoringSignalsForAd() {
+  TrustedScoringSignals combined_formatted_ad_signals;
+  combined_formatted_ad_signals.try_emplace(
+      kTestRenderUrl, std::make_shared<std::string>(kTestScoringSignals));
   return combined_formatted_ad_signals;
 }
 
@@ -319,7 +327,8 @@ TEST(BuildScoreAdRequestTest, PopulatesFeatureFlagsInDispatchRequest) {
   for (auto flag_1 : flag_values) {
     for (auto flag_2 : flag_values) {
       auto output = BuildScoreAdRequest(
-          kTestRenderUrl, kTestAdMetadataJson, kTestScoringSignals,
+          kTestRenderUrl, kTestAdMetadataJson,
+          std::make_shared<std::string>(kTestScoringSignals),
           MakeARandomNumber<float>(0.1, 10.1),
           std::make_shared<std::string>(kTestAuctionConfig), kTestBidMetadata,
           log_context,
@@ -366,6 +375,94 @@ TEST(BuildScoreAdRequestTest, PopulatesFeatureFlagsForPASAdWithBidMetadata) {
   }
 }
 
+TEST(BuildTrustedScoringSignalsTest, CombinesRenderUrlAndComponentSignals) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(absl::StrFormat(
+      R"JSON({
+        "renderUrls": {"%s": [1, 2], "https://other": [3]},
+        "adComponentRenderUrls": {"%s": {"a": "b c"}, "%s": null}
+      })JSON",
+      kTestRenderUrl, kTestAdComponentUrl_1, kTestAdComponentUrl_2));
+  AdWithBidMetadata* ad = raw_request.add_ad_bids();
+  ad->set_render(kTestRenderUrl);
+  *ad->mutable_ad_components() = MakeMockAdComponentUrls();
+  ad->add_ad_components("https://no_signals");
+  raw_request.add_ad_bids()->set_render("https://no_signals");
+
+  auto output = BuildTrustedScoringSignals(raw_request, log_context);
+  ASSERT_TRUE(output.ok()) << output.status();
+  ASSERT_EQ(output->size(), 1);
+  EXPECT_EQ(*output->at(ScoringSignalsKey(*ad)),
+            absl::StrFormat(R"JSON({"adComponentRenderUrls":{)JSON"
+                            R"JSON("%s":{"a":"b c"},"%s":null},)JSON"
+                            R"JSON("renderUrl":{"%s":[1,2]}})JSON",
+                            kTestAdComponentUrl_1, kTestAdComponentUrl_2,
+                            kTestRenderUrl));
+}
+
+TEST(BuildTrustedScoringSignalsTest, PopulatesProtectedAppSignalsAds) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(absl::StrFormat(
+      R"JSON({"renderUrls": {"%s": ["signal"]}})JSON", kTestRenderUrl));
+  raw_request.add_protected_app_signals_ad_bids()->set_render(kTestRenderUrl);
+
+  auto output = BuildTrustedScoringSignals(raw_request, log_context);
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output->at(kTestRenderUrl),
+            absl::StrFormat(R"JSON({"renderUrl":{"%s":["signal"]}})JSON",
+                            kTestRenderUrl));
+}
+
+TEST(BuildTrustedScoringSignalsTest, SharesSignalsOfAdsWithSameUrls) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(absl::StrFormat(
+      R"JSON({
+        "renderUrls": {"%s": [1]},
+        "adComponentRenderUrls": {"%s": [2]}
+      })JSON",
+      kTestRenderUrl, kTestAdComponentUrl_1));
+  for (int i = 0; i < 3; ++i) {
+    raw_request.add_ad_bids()->set_render(kTestRenderUrl);
+  }
+  raw_request.mutable_ad_bids(2)->add_ad_components(kTestAdComponentUrl_1);
+
+  auto output = BuildTrustedScoringSignals(raw_request, log_context);
+  ASSERT_TRUE(output.ok()) << output.status();
+  ASSERT_EQ(output->size(), 2);
+  std::vector<DispatchRequest> requests;
+  for (int i = 0; i < 3; ++i) {
+    auto request = BuildScoreAdRequest(
+        raw_request.ad_bids(i),
+        std::make_shared<std::string>(kTestAuctionConfig), *output,
+        /*enable_debug_reporting = */ false, log_context,
+        /*enable_adtech_code_logging = */ false, kTestBidMetadata,
+        kScoreAdBlobVersion);
+    CHECK_OK(request);
+    requests.push_back(*std::move(request));
+  }
+  const int index = ScoreArgIndex(ScoreAdArgs::kScoringSignals);
+  // The ads of the same URLs share the signals, but not the ad of other ad
+  // components.
+  EXPECT_EQ(requests[0].input[index], requests[1].input[index]);
+  EXPECT_NE(*requests[0].input[index], *requests[2].input[index]);
+}
+
+TEST(BuildTrustedScoringSignalsTest, FailsWithoutRenderUrls) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(R"JSON({"adComponentRenderUrls": {}})JSON");
+  raw_request.add_ad_bids()->set_render(kTestRenderUrl);
+
+  EXPECT_FALSE(BuildTrustedScoringSignals(raw_request, log_context).ok());
+}
+
+TEST(BuildTrustedScoringSignalsTest, FailsOnMalformedSignals) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(R"JSON({"renderUrls": {)JSON");
+  raw_request.add_ad_bids()->set_render(kTestRenderUrl);
+
+  EXPECT_FALSE(BuildTrustedScoringSignals(raw_request, log_context).ok());
+}
+
 TEST(ScoreAdsTest, ParsesScoreAdResponseRespectsDebugUrlLimits) {
   std::string long_win_url(1024, 'A');
   std::string long_loss_url(1025, 'B');
@@ -396,5 +493,144 @@ TEST(ScoreAdsTest, ParsesScoreAdResponseRespectsDebugUrlLimits) {
       parsed_response->debug_report_urls().auction_debug_loss_url().empty());
 }
 
+TEST(ScoreAdsTest, ParsesScoreAdRecordLikeJson) {
+  auto scored_ad = ParseJsonString(R"JSON({
+    "desirability": 2.5,
+    "allowComponentAuction": true,
+    "bid": 1.25,
+    "bidCurrency": "USD",
+    "incomingBidInSellerCurrency": 0.75
+  })JSON");
+  CHECK_OK(scored_ad);
+  int64_t current_all_debug_urls_chars = 0;
+  auto expected = ParseScoreAdResponse(
+      *scored_ad, /*max_allowed_size_debug_url_chars=*/65536,
+      /*max_allowed_size_all_debug_urls_chars=*/65536,
+      /*device_component_auction=*/true, current_all_debug_urls_chars);
+  CHECK_OK(expected);
+
+  std::string record = R"("psScore1|2.5|1|1.25|USD|0.75|invalid-bid")";
+  ASSERT_TRUE(IsScoreAdRecord(record));
+  absl::string_view reject_reason;
+  auto parsed_record = ParseScoreAdRecord(
+      record, /*device_component_auction=*/true, reject_reason);
+  CHECK_OK(parsed_record);
+  EXPECT_THAT(*parsed_record, EqualsProto(*expected));
+  EXPECT_EQ(reject_reason, "invalid-bid");
+}
+
+TEST(ScoreAdsTest, ParsesScoreAdRecordOfDesirabilityOnly) {
+  absl::string_view reject_reason = "unset";
+  auto parsed_record = ParseScoreAdRecord(
+      "psScore1|3|1|1.25|USD||", /*device_component_auction=*/false,
+      reject_reason);
+  CHECK_OK(parsed_record);
+  EXPECT_FLOAT_EQ(parsed_record->desirability(), 3);
+  // Component auction fields are ignored outside of component auctions.
+  EXPECT_FALSE(parsed_record->allow_component_auction());
+  EXPECT_EQ(parsed_record->bid(), 0);
+  EXPECT_TRUE(parsed_record->bid_currency().empty());
+  EXPECT_TRUE(reject_reason.empty());
+  EXPECT_FALSE(ParseAdRejectionReason(reject_reason, "owner", "name"));
+}
+
+TEST(ScoreAdsTest, FailsOnMalformedScoreAdRecord) {
+  EXPECT_FALSE(IsScoreAdRecord(R"JSON({"response": 1})JSON"));
+  absl::string_view reject_reason;
+  EXPECT_FALSE(ParseScoreAdRecord("psScore1|1|||", false, reject_reason).ok());
+  EXPECT_FALSE(
+      ParseScoreAdRecord("psScore1|1||||||", false, reject_reason).ok());
+  EXPECT_FALSE(
+      ParseScoreAdRecord("psScore1|high|||||", false, reject_reason).ok());
+}
+
+TEST(ScoreAdsTest, ScoresAdNativelyByBid) {
+  std::optional<SellerRejectionReason> rejection_reason;
+  ScoreAdsResponse::AdScore ad_score = ScoreAdNatively(
+      /*bid=*/2.5, /*bid_currency=*/"USD", /*seller_currency=*/"USD",
+      /*bid_floor=*/1, /*allow_component_auction=*/true,
+      /*device_component_auction=*/false, rejection_reason);
+  EXPECT_FALSE(rejection_reason.has_value());
+  EXPECT_EQ(ad_score.desirability(), 2.5);
+  EXPECT_FALSE(ad_score.allow_component_auction());
+
+  ad_score = ScoreAdNatively(
+      /*bid=*/2.5, /*bid_currency=*/"", /*seller_currency=*/"USD",
+      /*bid_floor=*/0, /*allow_component_auction=*/true,
+      /*device_component_auction=*/true, rejection_reason);
+  EXPECT_FALSE(rejection_reason.has_value());
+  EXPECT_EQ(ad_score.desirability(), 2.5);
+  EXPECT_TRUE(ad_score.allow_component_auction());
+}
+
+TEST(ScoreAdsTest, RejectsAdsNativelyBelowFloorOrInOtherCurrency) {
+  std::optional<SellerRejectionReason> rejection_reason;
+  ScoreAdsResponse::AdScore ad_score = ScoreAdNatively(
+      /*bid=*/0.5, /*bid_currency=*/"", /*seller_currency=*/"",
+      /*bid_floor=*/1, /*allow_component_auction=*/false,
+      /*device_component_auction=*/false, rejection_reason);
+  EXPECT_EQ(rejection_reason, SellerRejectionReason::BID_BELOW_AUCTION_FLOOR);
+  EXPECT_EQ(ad_score.desirability(), 0);
+
+  rejection_reason.reset();
+  ad_score = ScoreAdNatively(
+      /*bid=*/2, /*bid_currency=*/"EUR", /*seller_currency=*/"USD",
+      /*bid_floor=*/0, /*allow_component_auction=*/false,
+      /*device_component_auction=*/false, rejection_reason);
+  EXPECT_EQ(rejection_reason,
+            SellerRejectionReason::BID_FROM_GENERATE_BID_FAILED_CURRENCY_CHECK);
+  EXPECT_EQ(ad_score.desirability(), 0);
+}
+
+TEST(ScoreAdsChunkTest, BuildsArraysOfPerAdInputs) {
+  std::vector<DispatchRequest> ads;
+  auto scoring_signals = std::make_shared<std::string>(kTestScoringSignals);
+  for (int i = 0; i < 3; ++i) {
+    auto ad = BuildScoreAdRequest(
+        absl::StrCat(kTestRenderUrl, i), kTestAdMetadataJson,
+        i < 2 ? scoring_signals : std::make_shared<std::string>("{}"),
+        /*ad_bid=*/i + 1,
+        std::make_shared<std::string>(kTestAuctionConfig), kTestBidMetadata,
+        log_context,
+        /*enable_adtech_code_logging = */ false,
+        /*enable_debug_reporting = */ false, kScoreAdBlobVersion);
+    CHECK_OK(ad);
+    ads.push_back(*std::move(ad));
+  }
+
+  DispatchRequest chunk = BuildScoreAdsChunkRequest(ads);
+  EXPECT_EQ(chunk.id, ads[0].id);
+  EXPECT_EQ(chunk.version_string, kScoreAdBlobVersion);
+  EXPECT_EQ(chunk.handler_name, kScoreAdsBatchHandlerFunctionName);
+  EXPECT_EQ(*chunk.input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)],
+            absl::StrCat("[", kTestAdMetadataJson, ",", kTestAdMetadataJson,
+                         ",", kTestAdMetadataJson, "]"));
+  EXPECT_EQ(*chunk.input[ScoreArgIndex(ScoreAdArgs::kBid)],
+            absl::StrCat("[", std::to_string(1.0f), ",", std::to_string(2.0f),
+                         ",", std::to_string(3.0f), "]"));
+  // The signals shared by the first two ads are passed once.
+  EXPECT_EQ(*chunk.input[ScoreArgIndex(ScoreAdArgs::kScoringSignals)],
+            absl::StrCat(R"JSON({"signals":[)JSON", kTestScoringSignals,
+                         R"JSON(,{}],"indices":[0,0,1]})JSON"));
+  // The auction config is the same for all ads and passed once.
+  EXPECT_EQ(chunk.input[ScoreArgIndex(ScoreAdArgs::kAuctionConfig)],
+            ads[0].input[ScoreArgIndex(ScoreAdArgs::kAuctionConfig)]);
+}
+
+TEST(ScoreAdsChunkTest, SplitsOutputsOfEachAd) {
+  auto responses = SplitScoreAdsChunkResponse(
+      R"JSON(["psScore1|2.5||||",{"response":{"desirability":1}}])JSON",
+      /*num_ads=*/2);
+  CHECK_OK(responses);
+  ASSERT_EQ(responses->size(), 2);
+  EXPECT_TRUE(IsScoreAdRecord((*responses)[0]));
+  EXPECT_EQ((*responses)[1], R"JSON({"response":{"desirability":1}})JSON");
+}
+
+TEST(ScoreAdsChunkTest, FailsOnMissingOutputs) {
+  EXPECT_FALSE(SplitScoreAdsChunkResponse(R"JSON([{}])JSON", 2).ok());
+  EXPECT_FALSE(SplitScoreAdsChunkResponse(R"JSON({})JSON", 1).ok());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
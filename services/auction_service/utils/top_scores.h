@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_AUCTION_SERVICE_UTILS_TOP_SCORES_H_
+#define SERVICES_AUCTION_SERVICE_UTILS_TOP_SCORES_H_
+
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Tracks, in a single pass, the indices of the scored ads with the `K`
+// highest distinct positive desirability scores. Replaces sorting all the
+// scores after the fact: every Add() is O(K) and only the ads of the top `K`
+// scores are retained.
+template <int K>
+class TopScores {
+ public:
+  static_assert(K > 0);
+
+  // All the ads that received the same desirability score.
+  struct Tier {
+    float desirability = 0;
+    // Indices of the ads, in the order they were added.
+    std::vector<int> indices;
+  };
+
+  // Records the ad at `index` with the given desirability score. Ads with a
+  // non-positive desirability are ignored.
+  void Add(float desirability, int index) {
+    if (desirability <= 0) {
+      return;
+    }
+    int position = 0;
+    while (position < size_ && tiers_[position].desirability > desirability) {
+      ++position;
+    }
+    if (position == K) {
+      return;
+    }
+    if (position < size_ && tiers_[position].desirability == desirability) {
+      tiers_[position].indices.push_back(index);
+      return;
+    }
+    // Shifts the lower tiers down, dropping the lowest one when full.
+    for (int i = std::min(size_, K - 1); i > position; --i) {
+      tiers_[i] = std::move(tiers_[i - 1]);
+    }
+    tiers_[position].desirability = desirability;
+    tiers_[position].indices.clear();
+    tiers_[position].indices.push_back(index);
+    size_ = std::min(size_ + 1, K);
+  }
+
+  // Returns the tiers in descending order of desirability.
+  absl::Span<const Tier> tiers() const {
+    return absl::MakeConstSpan(tiers_.data(), size_);
+  }
+
+ private:
+  std::array<Tier, K> tiers_;
+  int size_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_AUCTION_SERVICE_UTILS_TOP_SCORES_H_
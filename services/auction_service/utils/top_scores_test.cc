@@ -0,0 +1,79 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/auction_service/utils/top_scores.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(TopScoresTest, IsEmptyByDefault) {
+  TopScores<2> top_scores;
+  EXPECT_TRUE(top_scores.tiers().empty());
+}
+
+TEST(TopScoresTest, KeepsHighestDistinctScoresInDescendingOrder) {
+  TopScores<2> top_scores;
+  top_scores.Add(1.5, 0);
+  top_scores.Add(3.25, 1);
+  top_scores.Add(1.2, 2);
+  top_scores.Add(2.75, 3);
+  top_scores.Add(1.5, 4);
+
+  ASSERT_EQ(top_scores.tiers().size(), 2);
+  EXPECT_EQ(top_scores.tiers()[0].desirability, 3.25f);
+  EXPECT_THAT(top_scores.tiers()[0].indices, ElementsAre(1));
+  EXPECT_EQ(top_scores.tiers()[1].desirability, 2.75f);
+  EXPECT_THAT(top_scores.tiers()[1].indices, ElementsAre(3));
+}
+
+TEST(TopScoresTest, GroupsTiesInInsertionOrder) {
+  TopScores<2> top_scores;
+  top_scores.Add(2, 0);
+  top_scores.Add(1, 1);
+  top_scores.Add(2, 2);
+  top_scores.Add(1, 3);
+  top_scores.Add(2, 4);
+
+  ASSERT_EQ(top_scores.tiers().size(), 2);
+  EXPECT_THAT(top_scores.tiers()[0].indices, ElementsAre(0, 2, 4));
+  EXPECT_THAT(top_scores.tiers()[1].indices, ElementsAre(1, 3));
+}
+
+TEST(TopScoresTest, DropsLowestTierWhenHigherScoreArrives) {
+  TopScores<2> top_scores;
+  top_scores.Add(1, 0);
+  top_scores.Add(2, 1);
+  top_scores.Add(1, 2);
+  top_scores.Add(3, 3);
+
+  ASSERT_EQ(top_scores.tiers().size(), 2);
+  EXPECT_THAT(top_scores.tiers()[0].indices, ElementsAre(3));
+  EXPECT_THAT(top_scores.tiers()[1].indices, ElementsAre(1));
+}
+
+TEST(TopScoresTest, IgnoresNonPositiveScores) {
+  TopScores<2> top_scores;
+  top_scores.Add(0, 0);
+  top_scores.Add(-1, 1);
+
+  EXPECT_TRUE(top_scores.tiers().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,562 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end benchmark of an auction through SFE, BFE, Bidding and Auction,
+// all running in this process and talking over local gRPC channels. The
+// services are the real ones, with real Roma and encryption between them.
+// Only the KV servers are faked, with FakeBuyerKeyValueAsyncHttpClient and
+// FakeSellerKeyValueAsyncHttpClient serving signals of the configured size.
+//
+// Besides the end-to-end time, the mean server-side time of each RPC is
+// reported as a counter, which splits the auction into its phases: SelectAd
+// in SFE, GetBids in BFE, GenerateBids in Bidding and ScoreAds in Auction.
+//
+// Run the benchmark as follows:
+// builders/tools/bazel-debian run --dynamic_mode=off -c opt --copt=-gmlt \
+//   --copt=-fno-omit-frame-pointer --fission=yes --strip=never \
+//   services/benchmarking:auction_pipeline_benchmarks -- \
+//   --benchmark_time_unit=ms --benchmark_repetitions=10
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/support/server_interceptor.h>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "services/auction_service/auction_constants.h"
+#include "services/auction_service/auction_service.h"
+#include "services/auction_service/benchmarking/score_ads_no_op_logger.h"
+#include "services/auction_service/code_wrapper/seller_code_wrapper.h"
+#include "services/bidding_service/benchmarking/bidding_no_op_logger.h"
+#include "services/bidding_service/bidding_service.h"
+#include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
+#include "services/bidding_service/constants.h"
+#include "services/buyer_frontend_service/buyer_frontend_service.h"
+#include "services/buyer_frontend_service/providers/http_bidding_signals_async_provider.h"
+#include "services/common/clients/auction_server/scoring_async_client.h"
+#include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client_factory.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/buyer/fake_buyer_key_value_async_http_client.h"
+#include "services/common/clients/http_kv_server/seller/fake_seller_key_value_async_http_client.h"
+#include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/test/random.h"
+#include "services/common/test/utils/cbor_test_utils.h"
+#include "services/seller_frontend_service/providers/http_scoring_signals_async_provider.h"
+#include "services/seller_frontend_service/seller_frontend_service.h"
+#include "services/seller_frontend_service/util/select_ad_reactor_test_utils.h"
+#include "src/concurrent/event_engine_executor.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Must match the render URLs built by kGenerateBidJs.
+constexpr char kRenderUrlPrefix[] = "https://ads.example.com/";
+constexpr char kKvE2eTestMode[] = "E2E_TEST_MODE";
+constexpr int kRpcTimeoutMs = 60000;
+
+constexpr absl::string_view kGenerateBidJs = R"JS_CODE(
+    function generateBid(interest_group,
+                         auction_signals,
+                         buyer_signals,
+                         trusted_bidding_signals,
+                         device_signals) {
+      return {
+        render: "https://ads.example.com/" + interest_group.adRenderIds[0],
+        ad: {"signalKeys": Object.keys(trusted_bidding_signals).length},
+        bid: 1 + Math.random(),
+        allowComponentAuction: false
+      };
+    }
+  )JS_CODE";
+
+constexpr absl::string_view kScoreAdJs = R"JS_CODE(
+    function scoreAd(ad_metadata,
+                     bid,
+                     auction_config,
+                     scoring_signals,
+                     bid_metadata,
+                     direct_from_seller_signals) {
+      return {
+        "desirability": bid,
+        "allowComponentAuction": false
+      };
+    }
+  )JS_CODE";
+
+// Shape of the auction run by a benchmark.
+struct AuctionShape {
+  int num_buyers;
+  int interest_groups_per_buyer;
+  int ads_per_interest_group;
+  // Size of the value of each trusted bidding and scoring signal.
+  int signal_bytes;
+};
+
+AuctionShape GetAuctionShape(const benchmark::State& state) {
+  return {.num_buyers = static_cast<int>(state.range(0)),
+          .interest_groups_per_buyer = static_cast<int>(state.range(1)),
+          .ads_per_interest_group = static_cast<int>(state.range(2)),
+          .signal_bytes = static_cast<int>(state.range(3))};
+}
+
+std::string BuyerOrigin(int buyer) {
+  return absl::StrCat("https://buyer", buyer, ".com");
+}
+
+// No key is a substring of another, since the fake KV clients match the keys
+// in the request URL by substring.
+std::string BiddingSignalsKey(int buyer, int interest_group) {
+  return absl::StrCat("buyer_", buyer, "_ig_", interest_group);
+}
+
+std::string AdRenderId(int buyer, int interest_group, int ad) {
+  return absl::StrCat("ad_", buyer, "_", interest_group, "_", ad);
+}
+
+// Server-side time of each RPC, by method name. Thread-safe.
+class RpcTimes {
+ public:
+  static RpcTimes& Get() {
+    static RpcTimes* rpc_times = new RpcTimes;
+    return *rpc_times;
+  }
+
+  void Record(absl::string_view method, absl::Duration duration)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    Times& times = times_[method.substr(method.rfind('/') + 1)];
+    times.total += duration;
+    ++times.count;
+  }
+
+  void Reset() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    times_.clear();
+  }
+
+  // Adds the mean time and the number of calls per iteration of each method
+  // to the counters of the benchmark.
+  void Report(benchmark::State& state) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    for (const auto& [method, times] : times_) {
+      state.counters[absl::StrCat(method, "_ms")] =
+          absl::ToDoubleMilliseconds(times.total) / times.count;
+      state.counters[absl::StrCat(method, "_calls")] = benchmark::Counter(
+          times.count, benchmark::Counter::kAvgIterations);
+    }
+  }
+
+ private:
+  struct Times {
+    absl::Duration total;
+    int64_t count = 0;
+  };
+
+  absl::Mutex mu_;
+  absl::btree_map<std::string, Times> times_ ABSL_GUARDED_BY(mu_);
+};
+
+// Times RPCs from the reception of their metadata to the sending of their
+// status.
+class RpcTimingInterceptor : public grpc::experimental::Interceptor {
+ public:
+  explicit RpcTimingInterceptor(grpc::experimental::ServerRpcInfo* info)
+      : method_(info->method()) {}
+
+  void Intercept(
+      grpc::experimental::InterceptorBatchMethods* methods) override {
+    using grpc::experimental::InterceptionHookPoints;
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::POST_RECV_INITIAL_METADATA)) {
+      start_ = absl::Now();
+    }
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::PRE_SEND_STATUS)) {
+      RpcTimes::Get().Record(method_, absl::Now() - start_);
+    }
+    methods->Proceed();
+  }
+
+ private:
+  const std::string method_;
+  absl::Time start_ = absl::Now();
+};
+
+class RpcTimingInterceptorFactory
+    : public grpc::experimental::ServerInterceptorFactoryInterface {
+ public:
+  grpc::experimental::Interceptor* CreateServerInterceptor(
+      grpc::experimental::ServerRpcInfo* info) override {
+    return new RpcTimingInterceptor(info);
+  }
+};
+
+// A service listening on a local port, with its RPCs timed.
+struct LocalServer {
+  std::unique_ptr<grpc::Server> server;
+  std::string address;
+
+  ~LocalServer() {
+    if (server != nullptr) {
+      server->Shutdown();
+    }
+  }
+};
+
+std::unique_ptr<LocalServer> StartServer(grpc::Service* service) {
+  grpc::ServerBuilder builder;
+  int port = 0;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
+                             256L * 1024L * 1024L);
+  builder.RegisterService(service);
+  std::vector<
+      std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>>
+      interceptor_factories;
+  interceptor_factories.push_back(
+      std::make_unique<RpcTimingInterceptorFactory>());
+  builder.experimental().SetInterceptorCreators(
+      std::move(interceptor_factories));
+  auto local_server = std::make_unique<LocalServer>();
+  local_server->server = builder.BuildAndStart();
+  CHECK(local_server->server != nullptr) << "Could not start server";
+  local_server->address = absl::StrCat("localhost:", port);
+  return local_server;
+}
+
+std::unique_ptr<server_common::KeyFetcherManagerInterface>
+CreateTestKeyFetcherManager() {
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest(kTrue, TEST_MODE);
+  return CreateKeyFetcherManager(config_client,
+                                 /*public_key_fetcher=*/nullptr);
+}
+
+// Writes `contents` to a new file for the fake KV clients to serve.
+std::string WriteSignalsFile(absl::string_view name,
+                             absl::string_view contents) {
+  std::filesystem::path path = std::filesystem::temp_directory_path() /
+                               absl::StrCat("auction_pipeline_", name);
+  std::ofstream(path) << contents;
+  return path.string();
+}
+
+// Roma for the buyer and the seller code, started once for all the
+// benchmarks.
+struct RomaDispatchers {
+  RomaDispatchers() : bidding_client(bidding), auction_client(auction) {
+    CHECK_OK(bidding.Init());
+    CHECK_OK(bidding.LoadSync(
+        kProtectedAudienceGenerateBidBlobVersion,
+        GetBuyerWrappedCode(kGenerateBidJs)));
+    CHECK_OK(auction.Init());
+    CHECK_OK(auction.LoadSync(
+        kScoreAdBlobVersion,
+        GetSellerWrappedCode(kScoreAdJs,
+                             /*enable_report_result_url_generation=*/false,
+                             /*enable_report_win_url_generation=*/false,
+                             /*buyer_origin_code_map=*/{})));
+  }
+
+  static RomaDispatchers& Get() {
+    static RomaDispatchers* dispatchers = new RomaDispatchers;
+    return *dispatchers;
+  }
+
+  V8Dispatcher bidding;
+  V8Dispatcher auction;
+  CodeDispatchClient bidding_client;
+  CodeDispatchClient auction_client;
+};
+
+// The four services of an auction, wired to each other. One BFE and one
+// Bidding service serve all the buyers.
+class AuctionPipeline {
+ public:
+  explicit AuctionPipeline(const AuctionShape& shape)
+      : executor_(std::make_unique<server_common::EventEngineExecutor>(
+            grpc_event_engine::experimental::CreateEventEngine())),
+        sfe_config_(CreateConfig()) {
+    // The timeouts of CreateConfig() are meant for mocked dependencies.
+    const std::string timeout_ms = absl::StrCat(kRpcTimeoutMs);
+    sfe_config_.SetFlagForTest(timeout_ms, GET_BID_RPC_TIMEOUT_MS);
+    sfe_config_.SetFlagForTest(timeout_ms,
+                               KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS);
+    sfe_config_.SetFlagForTest(timeout_ms, SCORE_ADS_RPC_TIMEOUT_MS);
+    sfe_config_.SetFlagForTest(kFalse, ENABLE_SELLER_FRONTEND_BENCHMARKING);
+    sfe_config_.SetFlagForTest("", CONSENTED_DEBUG_TOKEN);
+    sfe_config_.SetFlagForTest(kFalse, ENABLE_PROTECTED_APP_SIGNALS);
+    server_common::telemetry::TelemetryConfig config_proto;
+    config_proto.set_mode(server_common::telemetry::TelemetryConfig::OFF);
+    metric::MetricContextMap<SelectAdRequest>(
+        server_common::telemetry::BuildDependentConfig(config_proto));
+    metric::MetricContextMap<GetBidsRequest>(
+        server_common::telemetry::BuildDependentConfig(config_proto));
+    metric::MetricContextMap<GenerateBidsRequest>(
+        server_common::telemetry::BuildDependentConfig(config_proto));
+    metric::MetricContextMap<ScoreAdsRequest>(
+        server_common::telemetry::BuildDependentConfig(config_proto));
+    RomaDispatchers& roma = RomaDispatchers::Get();
+
+    StartBidding(roma.bidding_client);
+    StartBuyerFrontEnd(shape);
+    StartAuction(roma.auction_client);
+    StartSellerFrontEnd(shape);
+    sfe_stub_ = SellerFrontEnd::NewStub(grpc::CreateChannel(
+        sfe_server_->address, grpc::InsecureChannelCredentials()));
+  }
+
+  // Runs an auction, returning the status of the SelectAd call.
+  grpc::Status SelectAd(const SelectAdRequest& request) {
+    grpc::ClientContext context;
+    context.AddMetadata("x-bna-client-ip", "127.0.0.1");
+    context.AddMetadata("x-user-agent", "auction_pipeline_benchmarks");
+    context.AddMetadata("x-accept-language", "en-US");
+    SelectAdResponse response;
+    return sfe_stub_->SelectAd(&context, request, &response);
+  }
+
+ private:
+  void StartBidding(CodeDispatchClient& client) {
+    bidding_service_ = std::make_unique<BiddingService>(
+        [&client](
+            const GenerateBidsRequest* request, GenerateBidsResponse* response,
+            server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+            CryptoClientWrapperInterface* crypto_client,
+            const BiddingServiceRuntimeConfig& runtime_config) {
+          return new GenerateBidsReactor(
+              client, request, response,
+              std::make_unique<BiddingNoOpLogger>(), key_fetcher_manager,
+              crypto_client, runtime_config);
+        },
+        CreateTestKeyFetcherManager(), CreateCryptoClient(),
+        BiddingServiceRuntimeConfig{.is_protected_audience_enabled = true},
+        [](auto&&...) -> ProtectedAppSignalsGenerateBidsReactor* {
+          return nullptr;
+        });
+    bidding_server_ = StartServer(bidding_service_.get());
+  }
+
+  void StartBuyerFrontEnd(const AuctionShape& shape) {
+    absl::btree_map<std::string, std::string> request_to_path;
+    for (int buyer = 0; buyer < shape.num_buyers; ++buyer) {
+      std::vector<std::string> signals;
+      for (int ig = 0; ig < shape.interest_groups_per_buyer; ++ig) {
+        signals.push_back(absl::StrFormat(
+            R"("%s": "%s")", BiddingSignalsKey(buyer, ig),
+            std::string(shape.signal_bytes, 'b')));
+      }
+      request_to_path[BiddingSignalsKey(buyer, 0)] = WriteSignalsFile(
+          absl::StrCat("bidding_signals_", buyer, ".json"),
+          absl::StrCat(R"({"keys": {)", absl::StrJoin(signals, ", "), "}}"));
+    }
+    bfe_service_ = std::make_unique<BuyerFrontEndService>(
+        std::make_unique<HttpBiddingSignalsAsyncProvider>(
+            std::make_unique<FakeBuyerKeyValueAsyncHttpClient>(
+                kKvE2eTestMode, std::move(request_to_path))),
+        BiddingServiceClientConfig{.server_addr = bidding_server_->address,
+                                   .secure_client = false},
+        CreateTestKeyFetcherManager(), CreateCryptoClient(),
+        GetBidsConfig{
+            .generate_bid_timeout_ms = kRpcTimeoutMs,
+            .bidding_signals_load_timeout_ms = kRpcTimeoutMs,
+            .protected_app_signals_generate_bid_timeout_ms = kRpcTimeoutMs,
+            .is_protected_app_signals_enabled = false,
+            .is_protected_audience_enabled = true});
+    bfe_server_ = StartServer(bfe_service_.get());
+  }
+
+  void StartAuction(CodeDispatchClient& client) {
+    async_reporter_ = std::make_unique<AsyncReporter>(
+        std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()));
+    auction_service_ = std::make_unique<AuctionService>(
+        [&client, async_reporter = async_reporter_.get()](
+            const ScoreAdsRequest* request, ScoreAdsResponse* response,
+            server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+            CryptoClientWrapperInterface* crypto_client,
+            const AuctionServiceRuntimeConfig& runtime_config) {
+          return std::make_unique<ScoreAdsReactor>(
+              client, request, response,
+              std::make_unique<ScoreAdsNoOpLogger>(), key_fetcher_manager,
+              crypto_client, async_reporter, runtime_config);
+        },
+        CreateTestKeyFetcherManager(), CreateCryptoClient(),
+        AuctionServiceRuntimeConfig());
+    auction_server_ = StartServer(auction_service_.get());
+  }
+
+  void StartSellerFrontEnd(const AuctionShape& shape) {
+    std::vector<std::string> signals;
+    for (int buyer = 0; buyer < shape.num_buyers; ++buyer) {
+      for (int ig = 0; ig < shape.interest_groups_per_buyer; ++ig) {
+        signals.push_back(absl::StrFormat(
+            R"("%s%s": "%s")", kRenderUrlPrefix, AdRenderId(buyer, ig, 0),
+            std::string(shape.signal_bytes, 's')));
+      }
+    }
+    scoring_signals_provider_ =
+        std::make_unique<HttpScoringSignalsAsyncProvider>(
+            std::make_unique<FakeSellerKeyValueAsyncHttpClient>(
+                kKvE2eTestMode,
+                absl::btree_map<std::string, std::string>{
+                    {"", WriteSignalsFile("scoring_signals.json",
+                                          absl::StrCat(R"({"renderUrls": {)",
+                                                       absl::StrJoin(
+                                                           signals, ", "),
+                                                       "}}"))}}));
+    sfe_key_fetcher_manager_ = CreateTestKeyFetcherManager();
+    sfe_crypto_client_ = CreateCryptoClient();
+    scoring_client_ = std::make_unique<ScoringAsyncGrpcClient>(
+        sfe_key_fetcher_manager_.get(), sfe_crypto_client_.get(),
+        AuctionServiceClientConfig{.server_addr = auction_server_->address,
+                                   .secure_client = false});
+    absl::flat_hash_map<std::string, BuyerServiceEndpoint> buyer_endpoints;
+    for (int buyer = 0; buyer < shape.num_buyers; ++buyer) {
+      buyer_endpoints[BuyerOrigin(buyer)] = {
+          .endpoint = bfe_server_->address,
+          .cloud_platform = server_common::CloudPlatform::kGcp};
+    }
+    buyer_factory_ = std::make_unique<BuyerFrontEndAsyncClientFactory>(
+        buyer_endpoints, sfe_key_fetcher_manager_.get(),
+        sfe_crypto_client_.get(),
+        BuyerServiceClientConfig{.secure_client = false});
+    sfe_service_ = std::make_unique<SellerFrontEndService>(
+        &sfe_config_,
+        ClientRegistry{*scoring_signals_provider_, *scoring_client_,
+                       *buyer_factory_, *sfe_key_fetcher_manager_,
+                       sfe_crypto_client_.get(),
+                       std::make_unique<AsyncReporter>(
+                           std::make_unique<MultiCurlHttpFetcherAsync>(
+                               executor_.get()))});
+    sfe_server_ = StartServer(sfe_service_.get());
+  }
+
+  std::unique_ptr<server_common::Executor> executor_;
+  TrustedServersConfigClient sfe_config_;
+
+  std::unique_ptr<BiddingService> bidding_service_;
+  std::unique_ptr<LocalServer> bidding_server_;
+  std::unique_ptr<BuyerFrontEndService> bfe_service_;
+  std::unique_ptr<LocalServer> bfe_server_;
+  std::unique_ptr<AsyncReporter> async_reporter_;
+  std::unique_ptr<AuctionService> auction_service_;
+  std::unique_ptr<LocalServer> auction_server_;
+  std::unique_ptr<ScoringSignalsAsyncProvider> scoring_signals_provider_;
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      sfe_key_fetcher_manager_;
+  std::unique_ptr<CryptoClientWrapperInterface> sfe_crypto_client_;
+  std::unique_ptr<ScoringAsyncGrpcClient> scoring_client_;
+  std::unique_ptr<BuyerFrontEndAsyncClientFactory> buyer_factory_;
+  std::unique_ptr<SellerFrontEndService> sfe_service_;
+  std::unique_ptr<LocalServer> sfe_server_;
+  std::unique_ptr<SellerFrontEnd::Stub> sfe_stub_;
+};
+
+// A browser SelectAdRequest with the interest groups of `shape`, encrypted
+// with the test keys of the services.
+SelectAdRequest BuildSelectAdRequest(const AuctionShape& shape) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  SelectAdRequest request;
+  for (int buyer = 0; buyer < shape.num_buyers; ++buyer) {
+    BuyerInput& buyer_input = buyer_inputs[BuyerOrigin(buyer)];
+    for (int ig = 0; ig < shape.interest_groups_per_buyer; ++ig) {
+      auto* interest_group = buyer_input.add_interest_groups();
+      interest_group->set_name(absl::StrCat("ig_", ig));
+      interest_group->add_bidding_signals_keys(BiddingSignalsKey(buyer, ig));
+      for (int ad = 0; ad < shape.ads_per_interest_group; ++ad) {
+        interest_group->add_ad_render_ids(AdRenderId(buyer, ig, ad));
+      }
+      *interest_group->mutable_browser_signals() =
+          MakeRandomBrowserSignalsForIG(interest_group->ad_render_ids());
+    }
+    request.mutable_auction_config()->add_buyer_list(BuyerOrigin(buyer));
+  }
+  ProtectedAuctionInput protected_auction_input;
+  protected_auction_input.set_generation_id(MakeARandomString());
+  protected_auction_input.set_publisher_name("publisher.com");
+  *protected_auction_input.mutable_buyer_input() =
+      *GetEncodedBuyerInputMap(buyer_inputs);
+  request.mutable_auction_config()->set_seller(kSellerOriginDomain);
+  request.mutable_auction_config()->set_seller_signals("{}");
+  request.mutable_auction_config()->set_auction_signals("{}");
+  request.set_client_type(CLIENT_TYPE_BROWSER);
+  *request.mutable_protected_auction_ciphertext() =
+      GetCborEncodedEncryptedInputAndOhttpContext(protected_auction_input)
+          .first;
+  return request;
+}
+
+static void BM_AuctionPipeline(benchmark::State& state) {
+  const AuctionShape shape = GetAuctionShape(state);
+  AuctionPipeline pipeline(shape);
+  const SelectAdRequest request = BuildSelectAdRequest(shape);
+  // Warms up the channels and Roma.
+  if (grpc::Status status = pipeline.SelectAd(request); !status.ok()) {
+    state.SkipWithError(status.error_message().c_str());
+    return;
+  }
+
+  RpcTimes::Get().Reset();
+  int64_t num_failed = 0;
+  for (auto _ : state) {
+    // This code gets timed.
+    if (!pipeline.SelectAd(request).ok()) {
+      ++num_failed;
+    }
+  }
+  RpcTimes::Get().Report(state);
+  state.counters["failed"] = num_failed;
+}
+
+// Args: buyers, interest groups per buyer, ads per interest group, bytes per
+// signal value.
+BENCHMARK(BM_AuctionPipeline)
+    ->ArgNames({"buyers", "igs", "ads", "signal_bytes"})
+    ->Args({1, 10, 5, 100})
+    ->Args({3, 10, 5, 100})
+    ->Args({3, 50, 5, 100})
+    ->Args({3, 50, 20, 1000})
+    ->Args({10, 50, 20, 1000})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -0,0 +1,136 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Measures how the front ends forward the ad metadata of bids, which is
+// parsed lazily. The *_ReadAds variants read the metadata of every bid, which
+// parses it as if it were not lazy, and are the baseline to compare with.
+
+#include <memory>
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/buyer_frontend_service/util/proto_factory.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using GenerateBidsRawResponse = GenerateBidsResponse::GenerateBidsRawResponse;
+using GetBidsRawResponse = GetBidsResponse::GetBidsRawResponse;
+using ScoreAdsRawRequest = ScoreAdsRequest::ScoreAdsRawRequest;
+
+constexpr int kNumBids = 50;
+
+// Returns ad metadata of the given number of string fields.
+google::protobuf::Value MakeAd(int num_fields) {
+  google::protobuf::Value ad;
+  auto& fields = *ad.mutable_struct_value()->mutable_fields();
+  for (int i = 0; i < num_fields; ++i) {
+    fields[absl::StrCat("key-", i)].set_string_value(
+        std::string(64, 'a' + i % 26));
+  }
+  return ad;
+}
+
+// Returns the wire format of a response with kNumBids bids, every other one
+// of which has no bid price.
+template <typename Response>
+std::string MakeSerializedBids(int num_ad_fields) {
+  Response response;
+  for (int i = 0; i < kNumBids; ++i) {
+    AdWithBid* bid = response.add_bids();
+    *bid->mutable_ad() = MakeAd(num_ad_fields);
+    bid->set_bid(i % 2 == 0 ? 1.0 + i : 0.0);
+    bid->set_render(absl::StrCat("https://ads.adtech.com/ad-", i, ".html"));
+    bid->set_interest_group_name(absl::StrCat("ig-", i));
+  }
+  return response.SerializeAsString();
+}
+
+void ForwardBidsFromBidding(benchmark::State& state, bool read_ads) {
+  const std::string wire =
+      MakeSerializedBids<GenerateBidsRawResponse>(state.range(0));
+  for (auto _ : state) {
+    auto raw_response = std::make_unique<GenerateBidsRawResponse>();
+    CHECK(raw_response->ParseFromString(wire));
+    if (read_ads) {
+      for (const AdWithBid& bid : raw_response->bids()) {
+        benchmark::DoNotOptimize(bid.ad().kind_case());
+      }
+    }
+    std::string forwarded =
+        CreateGetBidsRawResponse(std::move(raw_response))->SerializeAsString();
+    benchmark::DoNotOptimize(forwarded);
+  }
+  state.SetBytesProcessed(state.iterations() * wire.size());
+}
+
+// Mirrors GetBidsUnaryReactor, which swaps the bids of the bidding response
+// into the GetBids response.
+static void BM_ForwardBidsFromBidding(benchmark::State& state) {
+  ForwardBidsFromBidding(state, /*read_ads=*/false);
+}
+BENCHMARK(BM_ForwardBidsFromBidding)->Arg(10)->Arg(100);
+
+static void BM_ForwardBidsFromBidding_ReadAds(benchmark::State& state) {
+  ForwardBidsFromBidding(state, /*read_ads=*/true);
+}
+BENCHMARK(BM_ForwardBidsFromBidding_ReadAds)->Arg(10)->Arg(100);
+
+void ForwardBidsToAuction(benchmark::State& state, bool read_ads) {
+  const std::string wire =
+      MakeSerializedBids<GetBidsRawResponse>(state.range(0));
+  for (auto _ : state) {
+    GetBidsRawResponse response;
+    CHECK(response.ParseFromString(wire));
+    if (read_ads) {
+      for (const AdWithBid& bid : response.bids()) {
+        benchmark::DoNotOptimize(bid.ad().kind_case());
+      }
+    }
+    ScoreAdsRawRequest request;
+    for (AdWithBid& bid : *response.mutable_bids()) {
+      // Bids without a price are filtered out before scoring.
+      if (bid.bid() <= 0) {
+        continue;
+      }
+      auto* ad_with_bid = request.add_ad_bids();
+      ad_with_bid->mutable_ad()->Swap(bid.mutable_ad());
+      ad_with_bid->set_bid(bid.bid());
+      ad_with_bid->set_render(std::move(*bid.mutable_render()));
+      ad_with_bid->set_interest_group_name(bid.interest_group_name());
+    }
+    std::string forwarded = request.SerializeAsString();
+    benchmark::DoNotOptimize(forwarded);
+  }
+  state.SetBytesProcessed(state.iterations() * wire.size());
+}
+
+// Mirrors SelectAdReactor::CreateScoreAdsRequest, which moves the metadata of
+// the bids left after filtering into the ScoreAds request. The metadata moved
+// is parsed, but not that of the bids filtered out.
+static void BM_ForwardBidsToAuction(benchmark::State& state) {
+  ForwardBidsToAuction(state, /*read_ads=*/false);
+}
+BENCHMARK(BM_ForwardBidsToAuction)->Arg(10)->Arg(100);
+
+static void BM_ForwardBidsToAuction_ReadAds(benchmark::State& state) {
+  ForwardBidsToAuction(state, /*read_ads=*/true);
+}
+BENCHMARK(BM_ForwardBidsToAuction_ReadAds)->Arg(10)->Arg(100);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,297 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Throughput of the crypto done on every hop between the servers: HPKE and
+// AEAD through the crypto client, HPKE encryption of the requests to the
+// BFE and the auction service, and the OHTTP encapsulation of the requests
+// to the SFE. Each benchmark runs over payloads of 1 KB to 32 MB, on up to
+// kMaxThreads threads sharing the crypto client and the keys, and reports
+// the bytes processed per second and the heap allocations per operation.
+//
+// To run:
+//   bazel run -c opt //services/benchmarking:crypto_benchmarks
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/common/clients/async_grpc/grpc_client_utils.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/seller_frontend_service/util/encryption_util.h"
+#include "src/encryption/key_fetcher/fake_key_fetcher_manager.h"
+
+// Heap allocations of the calling thread, counted by the operator new below.
+// Allocations of BoringSSL go through malloc and are not counted, so these
+// are the copies of the payload and the protos around the crypto.
+thread_local int64_t num_allocations = 0;
+
+void* operator new(std::size_t size) {
+  ++num_allocations;
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+
+constexpr int64_t kMinPayloadBytes = 1 << 10;
+constexpr int64_t kMaxPayloadBytes = 32 << 20;
+constexpr int kMaxThreads = 8;
+constexpr server_common::CloudPlatform kCloudPlatform =
+    server_common::CloudPlatform::kGcp;
+
+// The crypto client and the keys are shared by all the threads, as in the
+// servers.
+CryptoClientWrapperInterface& GetCryptoClient() {
+  static CryptoClientWrapperInterface* crypto_client =
+      CreateCryptoClient().release();
+  return *crypto_client;
+}
+
+server_common::KeyFetcherManagerInterface& GetKeyFetcherManager() {
+  static auto* key_fetcher_manager = new server_common::FakeKeyFetcherManager();
+  return *key_fetcher_manager;
+}
+
+const PublicKey& GetPublicKey() {
+  static const PublicKey* public_key = []() {
+    absl::StatusOr<PublicKey> key =
+        GetKeyFetcherManager().GetPublicKey(kCloudPlatform);
+    CHECK_OK(key);
+    return new PublicKey(*std::move(key));
+  }();
+  return *public_key;
+}
+
+const server_common::PrivateKey& GetPrivateKey() {
+  static const server_common::PrivateKey* private_key = []() {
+    std::optional<server_common::PrivateKey> key =
+        GetKeyFetcherManager().GetPrivateKey(GetPublicKey().key_id());
+    CHECK(key.has_value());
+    return new server_common::PrivateKey(*std::move(key));
+  }();
+  return *private_key;
+}
+
+// The contents do not matter to the crypto, only the size.
+std::string MakePayload(int64_t size) {
+  std::string payload(size, '\0');
+  for (int64_t i = 0; i < size; ++i) {
+    payload[i] = 'a' + i % 26;
+  }
+  return payload;
+}
+
+// Reports the throughput over the payload of each operation, and the heap
+// allocations of the operations, averaged over all the threads.
+void ReportPerOperation(benchmark::State& state, int64_t payload_bytes,
+                        int64_t allocations) {
+  state.SetBytesProcessed(state.iterations() * payload_bytes);
+  state.counters["allocs_per_op"] = benchmark::Counter(
+      static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+static void BM_HpkeEncrypt(benchmark::State& state) {
+  CryptoClientWrapperInterface& crypto_client = GetCryptoClient();
+  const PublicKey& public_key = GetPublicKey();
+  const std::string payload = MakePayload(state.range(0));
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t start = num_allocations;
+    absl::StatusOr<HpkeEncryptResponse> response =
+        crypto_client.HpkeEncrypt(public_key, payload);
+    allocations += num_allocations - start;
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+static void BM_HpkeDecrypt(benchmark::State& state) {
+  CryptoClientWrapperInterface& crypto_client = GetCryptoClient();
+  const server_common::PrivateKey& private_key = GetPrivateKey();
+  const std::string payload = MakePayload(state.range(0));
+  absl::StatusOr<HpkeEncryptResponse> encrypted =
+      crypto_client.HpkeEncrypt(GetPublicKey(), payload);
+  CHECK_OK(encrypted);
+  const std::string& ciphertext = encrypted->encrypted_data().ciphertext();
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t start = num_allocations;
+    auto response = crypto_client.HpkeDecrypt(private_key, ciphertext);
+    allocations += num_allocations - start;
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+// The secret of the HPKE context the response is encrypted with.
+std::string MakeSecret() {
+  absl::StatusOr<HpkeEncryptResponse> encrypted =
+      GetCryptoClient().HpkeEncrypt(GetPublicKey(), "request");
+  CHECK_OK(encrypted);
+  return encrypted->secret();
+}
+
+static void BM_AeadEncrypt(benchmark::State& state) {
+  CryptoClientWrapperInterface& crypto_client = GetCryptoClient();
+  const std::string secret = MakeSecret();
+  const std::string payload = MakePayload(state.range(0));
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t start = num_allocations;
+    absl::StatusOr<AeadEncryptResponse> response =
+        crypto_client.AeadEncrypt(payload, secret);
+    allocations += num_allocations - start;
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+static void BM_AeadDecrypt(benchmark::State& state) {
+  CryptoClientWrapperInterface& crypto_client = GetCryptoClient();
+  const std::string secret = MakeSecret();
+  const std::string payload = MakePayload(state.range(0));
+  absl::StatusOr<AeadEncryptResponse> encrypted =
+      crypto_client.AeadEncrypt(payload, secret);
+  CHECK_OK(encrypted);
+  const std::string& ciphertext = encrypted->encrypted_data().ciphertext();
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t start = num_allocations;
+    auto response = crypto_client.AeadDecrypt(ciphertext, secret);
+    allocations += num_allocations - start;
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+// Encrypts a GetBids request from the SFE to the BFE, with the payload as
+// buyer signals.
+static void BM_EncryptRequestWithHpke(benchmark::State& state) {
+  CryptoClientWrapperInterface& crypto_client = GetCryptoClient();
+  server_common::KeyFetcherManagerInterface& key_fetcher_manager =
+      GetKeyFetcherManager();
+  GetBidsRequest::GetBidsRawRequest raw_request;
+  raw_request.set_buyer_signals(MakePayload(state.range(0)));
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    // The request is consumed, as built for every call by the clients.
+    state.PauseTiming();
+    auto request =
+        std::make_unique<GetBidsRequest::GetBidsRawRequest>(raw_request);
+    state.ResumeTiming();
+    const int64_t start = num_allocations;
+    auto encrypted =
+        EncryptRequestWithHpke<GetBidsRequest::GetBidsRawRequest,
+                               GetBidsRequest>(std::move(request),
+                                               crypto_client,
+                                               key_fetcher_manager,
+                                               kCloudPlatform);
+    allocations += num_allocations - start;
+    CHECK_OK(encrypted);
+    benchmark::DoNotOptimize(encrypted);
+  }
+  ReportPerOperation(state, raw_request.ByteSizeLong(), allocations);
+}
+
+static void BM_HpkeEncryptAndOHTTPEncapsulate(benchmark::State& state) {
+  server_common::KeyFetcherManagerInterface& key_fetcher_manager =
+      GetKeyFetcherManager();
+  const std::string payload = MakePayload(state.range(0));
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    // The plaintext is consumed, as built for every call by the callers.
+    state.PauseTiming();
+    std::string plaintext = payload;
+    state.ResumeTiming();
+    const int64_t start = num_allocations;
+    absl::StatusOr<OhttpHpkeEncryptedMessage> encrypted =
+        HpkeEncryptAndOHTTPEncapsulate(
+            std::move(plaintext),
+            server_common::kBiddingAuctionOhttpRequestLabel,
+            key_fetcher_manager, kCloudPlatform);
+    allocations += num_allocations - start;
+    CHECK_OK(encrypted);
+    benchmark::DoNotOptimize(encrypted);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+static void BM_DecryptOHTTPEncapsulatedHpkeCiphertext(
+    benchmark::State& state) {
+  server_common::KeyFetcherManagerInterface& key_fetcher_manager =
+      GetKeyFetcherManager();
+  const std::string payload = MakePayload(state.range(0));
+  absl::StatusOr<OhttpHpkeEncryptedMessage> encrypted =
+      HpkeEncryptAndOHTTPEncapsulate(
+          payload, server_common::kBiddingAuctionOhttpRequestLabel,
+          key_fetcher_manager, kCloudPlatform);
+  CHECK_OK(encrypted);
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    const int64_t start = num_allocations;
+    auto decrypted = DecryptOHTTPEncapsulatedHpkeCiphertext(
+        encrypted->ciphertext, key_fetcher_manager);
+    allocations += num_allocations - start;
+    CHECK_OK(decrypted);
+    benchmark::DoNotOptimize(decrypted);
+  }
+  ReportPerOperation(state, payload.size(), allocations);
+}
+
+void PayloadsAndThreads(benchmark::internal::Benchmark* benchmark) {
+  benchmark->RangeMultiplier(8)
+      ->Range(kMinPayloadBytes, kMaxPayloadBytes)
+      ->ThreadRange(1, kMaxThreads)
+      ->UseRealTime();
+}
+
+BENCHMARK(BM_HpkeEncrypt)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_HpkeDecrypt)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_AeadEncrypt)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_AeadDecrypt)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_EncryptRequestWithHpke)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_HpkeEncryptAndOHTTPEncapsulate)->Apply(PayloadsAndThreads);
+BENCHMARK(BM_DecryptOHTTPEncapsulatedHpkeCiphertext)
+    ->Apply(PayloadsAndThreads);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
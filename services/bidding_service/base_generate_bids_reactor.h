@@ -17,13 +17,19 @@
 #ifndef SERVICES_BIDDING_SERVICE_BASE_GENERATE_BIDS_REACTOR_H_
 #define SERVICES_BIDDING_SERVICE_BASE_GENERATE_BIDS_REACTOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "services/bidding_service/data/runtime_config.h"
 #include "services/common/clients/code_dispatcher/request_context.h"
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
+#include "services/common/loggers/deferred_debug_log.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/logger/request_context_impl.h"
 
@@ -31,6 +37,8 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 inline constexpr char kDispatchHandlerFunctionNameWithCodeWrapper[] =
     "generateBidEntryFunction";
+inline constexpr char kLiteDispatchHandlerFunctionName[] =
+    "generateBidLiteEntryFunction";
 inline constexpr int kBytesMultiplyer = 1024;
 
 // Returns up the index of the provided enum as int from the underlying enum
@@ -64,6 +72,8 @@ class BaseGenerateBidsReactor
             GetLoggingContext(this->raw_request_),
             this->raw_request_.consented_debug_config(),
             [this]() { return this->raw_response_.mutable_debug_info(); }),
+        debug_log_(log_context_, this->raw_request_.consented_debug_config()
+                                     .is_debug_info_in_response()),
         max_allowed_size_debug_url_chars_(
             runtime_config.max_allowed_size_debug_url_bytes),
         max_allowed_size_all_debug_urls_chars_(
@@ -87,11 +97,23 @@ class BaseGenerateBidsReactor
     return bid.bid() != 0.0f;
   }
 
+  // Bounds the calls made out of the Roma executions dispatched now with the
+  // timeout, e.g. those to the inference sidecar, by the time Roma gives
+  // them. The executions start after now, so they are never bound past it.
+  void SetRomaDeadline(absl::string_view roma_timeout_ms) {
+    if (int64_t timeout_ms; absl::SimpleAtoi(roma_timeout_ms, &timeout_ms)) {
+      roma_request_context_factory_.SetDeadline(
+          absl::Now() + absl::Milliseconds(timeout_ms));
+    }
+  }
+
   bool enable_buyer_debug_url_generation_;
   std::string roma_timeout_ms_;
   RomaRequestContextFactory roma_request_context_factory_;
   bool enable_adtech_code_logging_;
   server_common::log::ContextImpl log_context_;
+  // Dumps of the protos of the request, formatted off the request thread.
+  DeferredDebugLog debug_log_;
   int max_allowed_size_debug_url_chars_;
   long max_allowed_size_all_debug_urls_chars_;
 };
@@ -0,0 +1,187 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the generateBid input writers with the previous serializers of
+// the interest group and browser signals, and with proto reflection.
+//
+// Run the benchmark as follows:
+// builders/tools/bazel-debian run --dynamic_mode=off -c opt --copt=-gmlt \
+//   --copt=-fno-omit-frame-pointer --fission=yes --strip=never \
+//   services/bidding_service/benchmarking:generate_bid_input_json_benchmarks \
+//   -- --benchmark_time_unit=us --benchmark_repetitions=10
+
+#include <string>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "rapidjson/document.h"
+#include "services/bidding_service/utils/generate_bid_input_json.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using IGForBidding =
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
+
+constexpr int kUserBiddingSignalsSize = 512;
+
+IGForBidding MakeInterestGroup(int num_ids) {
+  IGForBidding interest_group;
+  interest_group.set_name("interest_group_name");
+  for (int i = 0; i < num_ids; ++i) {
+    interest_group.add_trusted_bidding_signals_keys(
+        absl::StrCat("trusted_bidding_signals_key_", i));
+    interest_group.add_ad_render_ids(absl::StrCat("ad_render_id_", i));
+    interest_group.add_ad_component_render_ids(
+        absl::StrCat("ad_component_render_id_", i));
+  }
+  interest_group.set_user_bidding_signals(absl::StrCat(
+      R"JSON({"signals":")JSON", std::string(kUserBiddingSignalsSize, 'x'),
+      R"JSON("})JSON"));
+  return interest_group;
+}
+
+BrowserSignals MakeBrowserSignals() {
+  BrowserSignals browser_signals;
+  browser_signals.set_join_count(5);
+  browser_signals.set_bid_count(25);
+  browser_signals.set_recency_ms(1684134092000);
+  browser_signals.set_prev_wins(R"JSON([[1,"1689"],[1,"1776"]])JSON");
+  return browser_signals;
+}
+
+// Previous serializer of the interest group, building JSON arrays through
+// rapidjson documents.
+std::string SerializeRepeatedStringField(
+    const google::protobuf::RepeatedPtrField<std::string>& values) {
+  rapidjson::Document json_array;
+  json_array.SetArray();
+  for (const auto& item : values) {
+    json_array.PushBack(
+        rapidjson::Value(item.c_str(), json_array.GetAllocator()).Move(),
+        json_array.GetAllocator());
+  }
+  auto json = SerializeJsonDoc(json_array);
+  CHECK_OK(json);
+  return *std::move(json);
+}
+
+std::string PreviousSerializeIG(const IGForBidding& ig) {
+  std::string serialized_ig =
+      absl::StrFormat(R"JSON({"%s":"%s")JSON", "name", ig.name());
+  if (!ig.trusted_bidding_signals_keys().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON",
+                                    "trustedBiddingSignalsKeys",
+                                    SerializeRepeatedStringField(
+                                        ig.trusted_bidding_signals_keys())));
+  }
+  if (!ig.ad_render_ids().empty()) {
+    absl::StrAppend(
+        &serialized_ig,
+        absl::StrFormat(R"JSON(,"%s":%s)JSON", "adRenderIds",
+                        SerializeRepeatedStringField(ig.ad_render_ids())));
+  }
+  if (!ig.ad_component_render_ids().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON",
+                                    "adComponentRenderIds",
+                                    SerializeRepeatedStringField(
+                                        ig.ad_component_render_ids())));
+  }
+  if (!ig.user_bidding_signals().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON", "userBiddingSignals",
+                                    ig.user_bidding_signals()));
+  }
+  absl::StrAppend(&serialized_ig, "}");
+  return serialized_ig;
+}
+
+// Previous serializer of the browser signals.
+std::string PreviousSerializeBrowserSignals(
+    absl::string_view publisher_name, absl::string_view seller,
+    const BrowserSignals& browser_signals) {
+  return absl::StrCat(
+      R"JSON({"topWindowHostname":")JSON", publisher_name,
+      R"JSON(","seller":")JSON", seller, R"JSON(","joinCount":)JSON",
+      browser_signals.join_count(), R"JSON(,"bidCount":)JSON",
+      browser_signals.bid_count(), R"JSON(,"recency":)JSON",
+      browser_signals.recency_ms(), R"JSON(,"prevWins":)JSON",
+      browser_signals.prev_wins(), "}");
+}
+
+static void BM_InterestGroupToJson(benchmark::State& state) {
+  IGForBidding interest_group = MakeInterestGroup(state.range(0));
+  for (auto _ : state) {
+    std::string json = InterestGroupToJson(interest_group);
+    benchmark::DoNotOptimize(json);
+  }
+}
+
+static void BM_PreviousSerializeIG(benchmark::State& state) {
+  IGForBidding interest_group = MakeInterestGroup(state.range(0));
+  for (auto _ : state) {
+    std::string json = PreviousSerializeIG(interest_group);
+    benchmark::DoNotOptimize(json);
+  }
+}
+
+static void BM_MessageToJsonString(benchmark::State& state) {
+  IGForBidding interest_group = MakeInterestGroup(state.range(0));
+  for (auto _ : state) {
+    std::string json;
+    CHECK_OK(
+        google::protobuf::util::MessageToJsonString(interest_group, &json));
+    benchmark::DoNotOptimize(json);
+  }
+}
+
+static void BM_BrowserSignalsToJson(benchmark::State& state) {
+  BrowserSignals browser_signals = MakeBrowserSignals();
+  for (auto _ : state) {
+    std::string json = BrowserSignalsToJson(
+        "www.example-publisher.com", "https://www.example-ssp.com",
+        /*top_level_seller=*/"", browser_signals);
+    benchmark::DoNotOptimize(json);
+  }
+}
+
+static void BM_PreviousSerializeBrowserSignals(benchmark::State& state) {
+  BrowserSignals browser_signals = MakeBrowserSignals();
+  for (auto _ : state) {
+    std::string json = PreviousSerializeBrowserSignals(
+        "www.example-publisher.com", "https://www.example-ssp.com",
+        browser_signals);
+    benchmark::DoNotOptimize(json);
+  }
+}
+
+// Args: {number of keys, ads and ad components of the interest group}.
+BENCHMARK(BM_InterestGroupToJson)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_PreviousSerializeIG)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_MessageToJsonString)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK(BM_BrowserSignalsToJson);
+BENCHMARK(BM_PreviousSerializeBrowserSignals);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+// Run the benchmark
+BENCHMARK_MAIN();
@@ -248,8 +248,7 @@ static void BM_ProtectedAudience(benchmark::State& state) {
   for (auto _ : state) {
     // This code gets timed.
     metric::MetricContextMap<GenerateBidsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     GenerateBidsReactor reactor(
         dispatcher, &request, &response, std::make_unique<BiddingNoOpLogger>(),
         key_fetcher_manager.get(), &crypto_client, runtime_config);
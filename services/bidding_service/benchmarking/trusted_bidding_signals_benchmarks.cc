@@ -0,0 +1,93 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Run the benchmark as follows:
+// builders/tools/bazel-debian run --dynamic_mode=off -c opt --copt=-gmlt \
+//   --copt=-fno-omit-frame-pointer --fission=yes --strip=never \
+//   services/bidding_service/benchmarking:trusted_bidding_signals_benchmarks \
+//   -- --benchmark_time_unit=us --benchmark_repetitions=10
+
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "services/bidding_service/utils/trusted_bidding_signals_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kKeyTemplate[] = "trusted_bidding_signals_key_%d";
+constexpr int kKeysPerInterestGroup = 10;
+constexpr int kValueSize = 512;
+
+using RawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+
+// Builds a request with `num_igs` interest groups, each requesting
+// kKeysPerInterestGroup keys out of a KV response with `num_keys` keys.
+RawRequest MakeRawRequest(int num_igs, int num_keys) {
+  RawRequest raw_request;
+  std::string bidding_signals = R"JSON({"keys":{)JSON";
+  for (int i = 0; i < num_keys; ++i) {
+    absl::StrAppend(&bidding_signals, i == 0 ? "" : ",", "\"",
+                    absl::StrFormat(kKeyTemplate, i), R"JSON(":{"value":")JSON",
+                    std::string(kValueSize, 'x'), R"JSON(","list":[1,2,3]})JSON");
+  }
+  absl::StrAppend(&bidding_signals, "}}");
+  raw_request.set_bidding_signals(std::move(bidding_signals));
+  for (int i = 0; i < num_igs; ++i) {
+    auto* ig = raw_request.add_interest_group_for_bidding();
+    ig->set_name(absl::StrCat("ig_", i));
+    for (int j = 0; j < kKeysPerInterestGroup; ++j) {
+      ig->add_trusted_bidding_signals_keys(absl::StrFormat(
+          kKeyTemplate, (i * kKeysPerInterestGroup + j) % num_keys));
+    }
+  }
+  return raw_request;
+}
+
+static void BM_SerializeTrustedBiddingSignalsPerIG(benchmark::State& state) {
+  RawRequest raw_request = MakeRawRequest(state.range(0), state.range(1));
+  for (auto _ : state) {
+    auto result = SerializeTrustedBiddingSignalsPerIG(raw_request);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          raw_request.bidding_signals().size());
+}
+
+static void BM_ProjectTrustedBiddingSignalsPerIG(benchmark::State& state) {
+  RawRequest raw_request = MakeRawRequest(state.range(0), state.range(1));
+  for (auto _ : state) {
+    auto result = ProjectTrustedBiddingSignalsPerIG(raw_request);
+    CHECK_OK(result);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          raw_request.bidding_signals().size());
+}
+
+// Args: {number of interest groups, number of keys in the KV response}.
+BENCHMARK(BM_SerializeTrustedBiddingSignalsPerIG)
+    ->ArgsProduct({{10, 200}, {100, 1000, 10000}});
+BENCHMARK(BM_ProjectTrustedBiddingSignalsPerIG)
+    ->ArgsProduct({{10, 200}, {100, 1000, 10000}});
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+// Run the benchmark
+BENCHMARK_MAIN();
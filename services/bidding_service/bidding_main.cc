@@ -16,6 +16,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -27,12 +28,14 @@
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "grpcpp/ext/proto_server_reflection_plugin.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/health_check_service_interface.h"
 #include "sandbox/sandbox_executor.h"
 #include "sandboxed_api/sandbox2/comms.h"
+#include "services/bidding_service/base_generate_bids_reactor.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/benchmarking/bidding_no_op_logger.h"
 #include "services/bidding_service/bidding_code_fetch_config.pb.h"
@@ -41,20 +44,36 @@
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 #include "services/bidding_service/constants.h"
 #include "services/bidding_service/data/runtime_config.h"
+#include "services/bidding_service/inference/inference_metrics.h"
 #include "services/bidding_service/inference/inference_utils.h"
+#include "services/bidding_service/inference/periodic_model_fetcher.h"
 #include "services/bidding_service/protected_app_signals_generate_bids_reactor.h"
 #include "services/bidding_service/runtime_flags.h"
+#include "services/bidding_service/utils/ads_metadata_cache.h"
+#include "services/bidding_service/utils/prepared_data_cache.h"
+#include "services/bidding_service/utils/generate_bid_cache.h"
 #include "services/common/blob_fetch/blob_fetcher.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
 #include "services/common/code_fetch/periodic_code_fetcher.h"
+#include "services/common/concurrent/work_stealing_executor.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/arena_message_allocator.h"
+#include "services/common/util/cpu_placement.h"
+#include "services/common/util/grpc_server_options.h"
 #include "services/common/util/file_util.h"
+#include "services/common/util/large_buffer_pool.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/request_phase_tracer.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/server_drain.h"
+#include "services/common/util/startup_tasks.h"
 #include "services/common/util/tcmalloc_utils.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
@@ -101,10 +120,34 @@ ABSL_FLAG(std::optional<int64_t>, bidding_tcmalloc_max_total_thread_cache_bytes,
           std::nullopt,
           "Maximum amount of cached memory in bytes across all threads (or "
           "logical CPUs)");
+ABSL_FLAG(std::optional<bool>, enable_roma_admission_control, false,
+          "Sheds or truncates generateBid batches before they reach Roma when "
+          "they are not predicted to run within ROMA_TIMEOUT_MS, and keeps "
+          "part of the Roma capacity for protected app signals.");
+ABSL_FLAG(std::optional<bool>, enable_pipelined_ads_retrieval, false,
+          "For protected app signals requests with contextual ad render ids "
+          "that also fetch ads from the retrieval service, looks up the "
+          "contextual ads metadata while prepareDataForAdsRetrieval runs and "
+          "runs generateBid on each set of ads as soon as it is fetched.");
+ABSL_FLAG(std::optional<int>, ads_metadata_cache_ttl_ms, 0,
+          "Time in milliseconds for which the metadata looked up for the "
+          "contextual ads of protected app signals requests is reused by "
+          "requests with the same ad render ids. Not cached if 0.");
+ABSL_FLAG(std::optional<int>, prepared_data_cache_ttl_ms, 0,
+          "Time in milliseconds for which the output of "
+          "prepareDataForAdsRetrieval is reused by protected app signals "
+          "requests with the same inputs. Only for buyers whose UDF is "
+          "deterministic, i.e. has the same output for the same inputs. Not "
+          "cached if 0.");
+ABSL_FLAG(std::optional<int>, roma_max_batch_size, 0,
+          "Splits the generateBid batches larger than this into sub-batches "
+          "of this size, which take turns in Roma with those of the other "
+          "batches. Batches are not split if 0.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 using bidding_service::BuyerCodeFetchConfig;
+using bidding_service::V8ResourceConfig;
 using ::google::scp::cpio::BlobStorageClientFactory;
 using ::google::scp::cpio::BlobStorageClientInterface;
 using ::google::scp::cpio::Cpio;
@@ -122,6 +165,7 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         ENABLE_BIDDING_SERVICE_BENCHMARK);
   config_client.SetFlag(FLAGS_test_mode, TEST_MODE);
   config_client.SetFlag(FLAGS_roma_timeout_ms, ROMA_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_roma_batch_deadline_ms, ROMA_BATCH_DEADLINE_MS);
   config_client.SetFlag(FLAGS_public_key_endpoint, PUBLIC_KEY_ENDPOINT);
   config_client.SetFlag(FLAGS_primary_coordinator_private_key_endpoint,
                         PRIMARY_COORDINATOR_PRIVATE_KEY_ENDPOINT);
@@ -164,6 +208,41 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_tee_kv_server_addr, TEE_KV_SERVER_ADDR);
   config_client.SetFlag(FLAGS_ad_retrieval_timeout_ms, AD_RETRIEVAL_TIMEOUT_MS);
   config_client.SetFlag(FLAGS_ps_verbosity, PS_VERBOSITY);
+  config_client.SetFlag(FLAGS_request_phase_tracing_per_mille,
+                        REQUEST_PHASE_TRACING_PER_MILLE);
+  config_client.SetFlag(FLAGS_trace_sampling_per_mille,
+                        TRACE_SAMPLING_PER_MILLE);
+  config_client.SetFlag(FLAGS_enable_profiling, ENABLE_PROFILING);
+  config_client.SetFlag(FLAGS_profiling_interval_ms, PROFILING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_memory_admission_heap_limit_mb,
+                        MEMORY_ADMISSION_HEAP_LIMIT_MB);
+  config_client.SetFlag(FLAGS_memory_admission_request_size_factor,
+                        MEMORY_ADMISSION_REQUEST_SIZE_FACTOR);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_server_max_pollers, GRPC_SERVER_MAX_POLLERS);
+  config_client.SetFlag(FLAGS_grpc_server_max_memory_mb,
+                        GRPC_SERVER_MAX_MEMORY_MB);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads, GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_cpu_placement, CPU_PLACEMENT);
+  config_client.SetFlag(FLAGS_drain_health_check_grace_ms,
+                        DRAIN_HEALTH_CHECK_GRACE_MS);
+  config_client.SetFlag(FLAGS_drain_deadline_ms, DRAIN_DEADLINE_MS);
+  config_client.SetFlag(FLAGS_key_warm_up_timeout_ms, KEY_WARM_UP_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_work_stealing_executor_workers,
+                        WORK_STEALING_EXECUTOR_WORKERS);
+  config_client.SetFlag(FLAGS_large_buffer_pool_mb, LARGE_BUFFER_POOL_MB);
+  config_client.SetFlag(FLAGS_large_buffer_huge_pages,
+                        LARGE_BUFFER_HUGE_PAGES);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_interval_ms,
+                        TCMALLOC_TUNING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_thread_cache_mb,
+                        TCMALLOC_TUNING_MIN_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_thread_cache_mb,
+                        TCMALLOC_TUNING_MAX_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_release_mb_per_second,
+                        TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_release_mb_per_second,
+                        TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND);
   config_client.SetFlag(FLAGS_max_allowed_size_debug_url_bytes,
                         MAX_ALLOWED_SIZE_DEBUG_URL_BYTES);
   config_client.SetFlag(FLAGS_max_allowed_size_all_debug_urls_kb,
@@ -179,11 +258,29 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         INFERENCE_MODEL_BUCKET_PATHS);
   config_client.SetFlag(FLAGS_inference_sidecar_runtime_config,
                         INFERENCE_SIDECAR_RUNTIME_CONFIG);
+  config_client.SetFlag(FLAGS_inference_sidecar_num_replicas,
+                        INFERENCE_SIDECAR_NUM_REPLICAS);
+  config_client.SetFlag(FLAGS_inference_sidecar_standby,
+                        INFERENCE_SIDECAR_STANDBY);
+  config_client.SetFlag(FLAGS_inference_model_fetch_period_ms,
+                        INFERENCE_MODEL_FETCH_PERIOD_MS);
+  config_client.SetFlag(FLAGS_inference_cache_max_bytes,
+                        INFERENCE_CACHE_MAX_BYTES);
+  config_client.SetFlag(FLAGS_inference_cache_ttl_ms, INFERENCE_CACHE_TTL_MS);
   config_client.SetFlag(
       FLAGS_bidding_tcmalloc_background_release_rate_bytes_per_second,
       BIDDING_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND);
   config_client.SetFlag(FLAGS_bidding_tcmalloc_max_total_thread_cache_bytes,
                         BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES);
+  config_client.SetFlag(FLAGS_enable_roma_admission_control,
+                        ENABLE_ROMA_ADMISSION_CONTROL);
+  config_client.SetFlag(FLAGS_enable_pipelined_ads_retrieval,
+                        ENABLE_PIPELINED_ADS_RETRIEVAL);
+  config_client.SetFlag(FLAGS_ads_metadata_cache_ttl_ms,
+                        ADS_METADATA_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_prepared_data_cache_ttl_ms,
+                        PREPARED_DATA_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_roma_max_batch_size, ROMA_MAX_BATCH_SIZE);
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
         << "Config client failed to initialize.";
@@ -191,6 +288,16 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   // Set verbosity
   server_common::log::PS_VLOG_IS_ON(
       0, config_client.GetIntParameter(PS_VERBOSITY));
+  RequestPhaseTracer::SetSamplingPerMille(
+      config_client.GetIntParameter(REQUEST_PHASE_TRACING_PER_MILLE));
+  RequestTrace::SetSamplingPerMille(
+      config_client.GetIntParameter(TRACE_SAMPLING_PER_MILLE));
+  MemoryAdmissionController::Get().Configure(
+      {.heap_limit_bytes =
+           config_client.GetInt64Parameter(MEMORY_ADMISSION_HEAP_LIMIT_MB) *
+           1024 * 1024,
+       .request_size_factor = config_client.GetIntParameter(
+           MEMORY_ADMISSION_REQUEST_SIZE_FACTOR)});
 
   const bool enable_protected_app_signals =
       config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS);
@@ -217,31 +324,102 @@ absl::string_view GetStringParameterSafe(
   return "";
 }
 
+// Sets the heap limits and GC flags of the V8 isolates of the Roma workers.
+void ConfigureV8Resources(const V8ResourceConfig& resources,
+                          DispatchConfig& config) {
+  if (resources.max_heap_size_mb() > 0) {
+    config.ConfigureJsEngineResourceConstraints(
+        resources.initial_heap_size_mb(), resources.max_heap_size_mb());
+  }
+  if (resources.max_semi_space_size_mb() > 0) {
+    config.SetV8Flags().push_back(absl::StrCat(
+        "--max-semi-space-size=", resources.max_semi_space_size_mb()));
+  }
+  switch (resources.gc_policy()) {
+    case bidding_service::V8_GC_POLICY_OPTIMIZE_FOR_SIZE:
+      config.SetV8Flags().push_back("--optimize-for-size");
+      break;
+    case bidding_service::V8_GC_POLICY_SINGLE_THREADED:
+      config.SetV8Flags().push_back("--single-threaded-gc");
+      break;
+    default:
+      break;
+  }
+}
+
+// Admission control in front of Roma, if enabled. With protected app signals
+// enabled, protected audience and protected app signals each keep a share of
+// the capacity.
+std::optional<RomaAdmissionConfig> GetRomaAdmissionConfig(
+    const TrustedServersConfigClient& config_client,
+    bool enable_protected_app_signals) {
+  if (!config_client.GetBooleanParameter(ENABLE_ROMA_ADMISSION_CONTROL)) {
+    return std::nullopt;
+  }
+  const int num_workers = config_client.GetIntParameter(JS_NUM_WORKERS);
+  const int queue_len = config_client.GetIntParameter(JS_WORKER_QUEUE_LEN);
+  if (num_workers <= 0 || queue_len <= 0) {
+    PS_LOG(WARNING) << "Roma admission control needs JS_NUM_WORKERS and "
+                       "JS_WORKER_QUEUE_LEN to be set, it is disabled.";
+    return std::nullopt;
+  }
+  return RomaAdmissionConfig{
+      .num_workers = num_workers,
+      .capacity = num_workers * (queue_len + 1),
+      .reserved_shares =
+          enable_protected_app_signals
+              ? std::array<double, kNumDispatchTenants>{0.5, 0.2, 0}
+              : std::array<double, kNumDispatchTenants>{}};
+}
+
 // Brings up the gRPC BiddingService on FLAGS_port.
 absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_ASSIGN_OR_RETURN(
+      const CpuPlacement cpu_placement,
+      ParseCpuPlacement(config_client.GetStringParameter(CPU_PLACEMENT)));
 
   MaySetBackgroundReleaseRate(config_client.GetInt64Parameter(
       BIDDING_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND));
   MaySetMaxTotalThreadCacheBytes(config_client.GetInt64Parameter(
       BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES));
+  PS_ASSIGN_OR_RETURN(const HugePages large_buffer_huge_pages,
+                      ParseHugePages(config_client.GetStringParameter(
+                          LARGE_BUFFER_HUGE_PAGES)));
+  LargeBufferPool::Configure(
+      {.huge_pages = large_buffer_huge_pages,
+       .max_pooled_bytes = static_cast<size_t>(config_client.GetInt64Parameter(
+                               LARGE_BUFFER_POOL_MB)) *
+                           1024 * 1024});
   std::string_view port = config_client.GetStringParameter(PORT);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
 
   CHECK(!config_client.GetStringParameter(BUYER_CODE_FETCH_CONFIG).empty())
       << "BUYER_CODE_FETCH_CONFIG is a mandatory flag.";
 
+  // Convert Json string into a BiddingCodeBlobFetcherConfig proto
+  BuyerCodeFetchConfig udf_config;
+  absl::Status result = google::protobuf::util::JsonStringToMessage(
+      config_client.GetStringParameter(BUYER_CODE_FETCH_CONFIG).data(),
+      &udf_config);
+  PS_RETURN_IF_ERROR(result)
+      << "Could not parse BUYER_CODE_FETCH_CONFIG JsonString to "
+         "a proto message: "
+      << result.message();
+
   std::string_view inference_sidecar_binary_path =
       GetStringParameterSafe(config_client, INFERENCE_SIDECAR_BINARY_PATH);
   const bool enable_inference = !inference_sidecar_binary_path.empty();
 
-  auto dispatcher = V8Dispatcher([&config_client, &enable_inference]() {
+  auto dispatcher = V8Dispatcher([&config_client, &enable_inference,
+                                  &udf_config]() {
     DispatchConfig config;
     config.worker_queue_max_items =
         config_client.GetIntParameter(JS_WORKER_QUEUE_LEN);
     config.number_of_workers = config_client.GetIntParameter(JS_NUM_WORKERS);
+    ConfigureV8Resources(udf_config.v8_resources(), config);
 
     if (enable_inference) {
       PS_LOG(INFO) << "Register runInference API.";
@@ -254,8 +432,7 @@ absl::Status RunServer() {
       config.RegisterFunctionBinding(std::move(run_inference_function_object));
       PS_LOG(INFO) << "RunInference registered.";
 
-      PS_LOG(INFO) << "Start the inference sidecar.";
-      // This usage of the following two flags is not consistent with rest of
+      // This usage of the following flags is not consistent with rest of
       // the codebase, where we use the parameter from the config client
       // directly instead of passing it back to the absl flag.
       absl::SetFlag(
@@ -264,29 +441,106 @@ absl::Status RunServer() {
       absl::SetFlag(&FLAGS_inference_sidecar_runtime_config,
                     GetStringParameterSafe(config_client,
                                            INFERENCE_SIDECAR_RUNTIME_CONFIG));
-      inference::SandboxExecutor& inference_executor = inference::Executor();
-      CHECK_EQ(inference_executor.StartSandboxee().code(),
-               absl::StatusCode::kOk);
+      int num_replicas = 1;
+      if (absl::string_view value = GetStringParameterSafe(
+              config_client, INFERENCE_SIDECAR_NUM_REPLICAS);
+          !value.empty() && !absl::SimpleAtoi(value, &num_replicas)) {
+        PS_LOG(ERROR) << "Invalid INFERENCE_SIDECAR_NUM_REPLICAS: " << value;
+        num_replicas = 1;
+      }
+      absl::SetFlag(&FLAGS_inference_sidecar_num_replicas, num_replicas);
+      absl::SetFlag(
+          &FLAGS_inference_sidecar_standby,
+          GetStringParameterSafe(config_client, INFERENCE_SIDECAR_STANDBY) ==
+              "true");
+      int64_t cache_max_bytes = 0;
+      if (absl::string_view value =
+              GetStringParameterSafe(config_client, INFERENCE_CACHE_MAX_BYTES);
+          !value.empty() && !absl::SimpleAtoi(value, &cache_max_bytes)) {
+        PS_LOG(ERROR) << "Invalid INFERENCE_CACHE_MAX_BYTES: " << value;
+        cache_max_bytes = 0;
+      }
+      absl::SetFlag(&FLAGS_inference_cache_max_bytes, cache_max_bytes);
+      int64_t cache_ttl_ms = 0;
+      if (absl::string_view value =
+              GetStringParameterSafe(config_client, INFERENCE_CACHE_TTL_MS);
+          !value.empty() && !absl::SimpleAtoi(value, &cache_ttl_ms)) {
+        PS_LOG(ERROR) << "Invalid INFERENCE_CACHE_TTL_MS: " << value;
+        cache_ttl_ms = 0;
+      }
+      absl::SetFlag(&FLAGS_inference_cache_ttl_ms, cache_ttl_ms);
     }
     return config;
-  }());
-  CodeDispatchClient client(dispatcher);
-  PS_RETURN_IF_ERROR(dispatcher.Init()) << "Could not start code dispatcher.";
+  }(),
+  GetRomaAdmissionConfig(
+      config_client,
+      config_client.HasParameter(ENABLE_PROTECTED_APP_SIGNALS) &&
+          config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS)));
+  dispatcher.RecycleWorkersEvery(
+      udf_config.v8_resources().recycle_workers_after_executions());
+  dispatcher.SplitBatchesOver(
+      config_client.GetIntParameter(ROMA_MAX_BATCH_SIZE));
+  PS_ASSIGN_OR_RETURN(
+      std::vector<DispatchRequest> warm_up_samples,
+      BuildWarmUpSamples(
+          kDispatchHandlerFunctionNameWithCodeWrapper,
+          udf_config.protected_auction_generate_bid_warm_up_inputs()));
+  dispatcher.WarmUpAfterLoads(std::move(warm_up_samples),
+                              udf_config.warm_up_rounds());
+
+  const bool is_protected_app_signals_enabled =
+      config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS);
+  std::string tee_ad_retrieval_kv_server_addr = std::string(
+      config_client.GetStringParameter(TEE_AD_RETRIEVAL_KV_SERVER_ADDR));
+  std::string tee_kv_server_addr =
+      std::string(config_client.GetStringParameter(TEE_KV_SERVER_ADDR));
+  if (is_protected_app_signals_enabled &&
+      tee_ad_retrieval_kv_server_addr.empty() && tee_kv_server_addr.empty()) {
+    return absl::InvalidArgumentError(
+        "Missing: Ad Retrieval server address "
+        "and KV server address. Must specify at "
+        "least one.");
+  }
+
+  // The slow steps of the startup run concurrently, as soon as the steps they
+  // need are done. The server starts, and so reports itself as serving, once
+  // all of them are done.
+  StartupTasks startup;
+  if (enable_inference) {
+    startup.Run("inference sidecars", {}, [&cpu_placement]() {
+      PS_LOG(INFO) << "Start the inference sidecar.";
+      // The sidecars are forked from this thread, then pin themselves within
+      // the inherited CPUs to the `cpuset` of their runtime config, if set.
+      ScopedCpuPlacement inference_placement("inference sidecars",
+                                             cpu_placement.inference_cpus);
+      return inference::SidecarPool().Start();
+    });
+  }
+  startup.Run("Roma", {}, [&dispatcher, &cpu_placement]() -> absl::Status {
+    // Roma forks its worker processes from this thread.
+    ScopedCpuPlacement roma_placement("Roma workers", cpu_placement.roma_cpus);
+    PS_RETURN_IF_ERROR(dispatcher.Init()) << "Could not start code dispatcher.";
+    return absl::OkStatus();
+  });
 
   server_common::GrpcInit gprc_init;
-  std::unique_ptr<server_common::Executor> executor =
-      std::make_unique<server_common::EventEngineExecutor>(
+  std::unique_ptr<server_common::Executor> executor;
+  {
+    // The event engine starts its thread pool, which runs the I/O loops and
+    // their callbacks, as do the workers of a work-stealing executor.
+    ScopedCpuPlacement io_placement("I/O loops", cpu_placement.io_cpus);
+    if (const int work_stealing_executor_workers =
+            config_client.GetIntParameter(WORK_STEALING_EXECUTOR_WORKERS);
+        work_stealing_executor_workers > 0) {
+      executor = std::make_unique<WorkStealingExecutor>(
+          WorkStealingExecutorOptions{.num_workers =
+                                          work_stealing_executor_workers});
+    } else {
+      executor = std::make_unique<server_common::EventEngineExecutor>(
           grpc_event_engine::experimental::CreateEventEngine());
-
-  // Convert Json string into a BiddingCodeBlobFetcherConfig proto
-  BuyerCodeFetchConfig udf_config;
-  absl::Status result = google::protobuf::util::JsonStringToMessage(
-      config_client.GetStringParameter(BUYER_CODE_FETCH_CONFIG).data(),
-      &udf_config);
-  PS_RETURN_IF_ERROR(result)
-      << "Could not parse BUYER_CODE_FETCH_CONFIG JsonString to "
-         "a proto message: "
-      << result.message();
+    }
+  }
+  CodeDispatchClient client(dispatcher, executor.get());
 
   bool enable_buyer_debug_url_generation =
       udf_config.enable_buyer_debug_url_generation();
@@ -304,56 +558,102 @@ absl::Status RunServer() {
       executor.get(), http_fetcher_async.get(), &dispatcher,
       BlobStorageClientFactory::Create(), udf_config, enable_protected_audience,
       enable_protected_app_signals);
-  PS_RETURN_IF_ERROR(udf_fetcher.Init()) << "Failed to initialize UDF fetch.";
+  // The code is loaded into the Roma workers.
+  startup.Run("UDF fetch", {"Roma"}, [&udf_fetcher]() -> absl::Status {
+    PS_RETURN_IF_ERROR(udf_fetcher.Init()) << "Failed to initialize UDF fetch.";
+    return absl::OkStatus();
+  });
 
   bool init_config_client = absl::GetFlag(FLAGS_init_config_client);
+  // Polls the model bucket for new model versions until the server stops.
+  std::unique_ptr<inference::PeriodicModelFetcher> model_fetcher;
   if (enable_inference) {
-    if (init_config_client) {
-      PS_LOG(INFO) << "Start blob fetcher to read from a cloud bucket.";
-      std::string_view bucket_name =
-          GetStringParameterSafe(config_client, INFERENCE_MODEL_BUCKET_NAME);
-      std::string_view bucket_paths =
-          GetStringParameterSafe(config_client, INFERENCE_MODEL_BUCKET_PATHS);
-      std::vector<std::string> models = absl::StrSplit(bucket_paths, ',');
-
-      if (!bucket_name.empty() && !bucket_paths.empty()) {
-        std::unique_ptr<BlobStorageClientInterface> blob_storage_client =
-            BlobStorageClientFactory::Create();
-        auto blob_fetcher = std::make_unique<BlobFetcher>(
-            bucket_name, executor.get(), std::move(blob_storage_client));
-        CHECK(blob_fetcher->FetchSync().ok()) << "FetchSync() failed.";
-        const std::vector<BlobFetcher::Blob>& files = blob_fetcher->snapshot();
-        PS_LOG(INFO) << "Register models from bucket.";
-        if (absl::Status status =
-                inference::RegisterModelsFromBucket(bucket_name, models, files);
-            !status.ok()) {
-          PS_LOG(INFO) << "Skip registering models from bucket: "
-                       << status.message();
+    // The models are registered with the sidecars.
+    auto register_models = [&config_client, &executor, &model_fetcher,
+                            init_config_client]() {
+      if (init_config_client) {
+        PS_LOG(INFO) << "Start blob fetcher to read from a cloud bucket.";
+        std::string_view bucket_name =
+            GetStringParameterSafe(config_client, INFERENCE_MODEL_BUCKET_NAME);
+        std::string_view bucket_paths =
+            GetStringParameterSafe(config_client, INFERENCE_MODEL_BUCKET_PATHS);
+        std::vector<std::string> models = absl::StrSplit(bucket_paths, ',');
+
+        if (!bucket_name.empty() && !bucket_paths.empty()) {
+          int64_t fetch_period_ms = 0;
+          if (absl::string_view value = GetStringParameterSafe(
+                  config_client, INFERENCE_MODEL_FETCH_PERIOD_MS);
+              !value.empty() && !absl::SimpleAtoi(value, &fetch_period_ms)) {
+            PS_LOG(ERROR) << "Invalid INFERENCE_MODEL_FETCH_PERIOD_MS: "
+                          << value;
+            fetch_period_ms = 0;
+          }
+          model_fetcher = std::make_unique<inference::PeriodicModelFetcher>(
+              bucket_name, std::move(models),
+              absl::Milliseconds(fetch_period_ms), executor.get(),
+              BlobStorageClientFactory::Create(),
+              [](const inference::RegisterModelRequest& request) {
+                return inference::RegisterModel(request);
+              });
+          PS_LOG(INFO) << "Register models from bucket.";
+          if (absl::Status status = model_fetcher->Start(); !status.ok()) {
+            PS_LOG(INFO) << "Skip registering models from bucket: "
+                         << status.message();
+          }
+        } else {
+          PS_LOG(INFO)
+              << "Skip blob fetcher read from a cloud bucket due to empty "
+                 "required arguements.";
         }
-      } else {
-        PS_LOG(INFO)
-            << "Skip blob fetcher read from a cloud bucket due to empty "
-               "required arguements.";
       }
-    }
 
-    if (std::optional<std::string> local_paths =
-            absl::GetFlag(FLAGS_inference_model_local_paths);
-        local_paths.has_value()) {
-      PS_LOG(INFO) << "Register models from local for testing.";
-      if (absl::Status status = inference::RegisterModelsFromLocal(
-              absl::StrSplit(local_paths.value(), ','));
-          !status.ok()) {
-        PS_LOG(INFO) << "Skip registering models from local: "
-                     << status.message();
+      if (std::optional<std::string> local_paths =
+              absl::GetFlag(FLAGS_inference_model_local_paths);
+          local_paths.has_value()) {
+        PS_LOG(INFO) << "Register models from local for testing.";
+        if (absl::Status status = inference::RegisterModelsFromLocal(
+                absl::StrSplit(local_paths.value(), ','));
+            !status.ok()) {
+          PS_LOG(INFO) << "Skip registering models from local: "
+                       << status.message();
+        }
       }
-    }
+      return absl::OkStatus();
+    };
+    startup.Run("models", {"inference sidecars"}, std::move(register_models));
   }
 
   bool enable_bidding_service_benchmark =
       config_client.GetBooleanParameter(ENABLE_BIDDING_SERVICE_BENCHMARK);
 
   InitTelemetry<GenerateBidsRequest>(config_util, config_client, metric::kBs);
+  metric::BiddingContextMap()->AddObserverable(metric::kRomaQueueDepth,
+                                               V8Dispatcher::GetQueueDepth);
+  metric::BiddingContextMap()->AddObserverable(
+      metric::kRomaWorkerRecycles, V8Dispatcher::GetWorkerRecycles);
+  metric::BiddingContextMap()->AddObserverable(
+      metric::kRomaWarmUpLatency, V8Dispatcher::GetWarmUpLatency);
+  metric::BiddingContextMap()->AddObserverable(
+      metric::kRomaPayloadSize, V8Dispatcher::GetPayloadSizeBytes);
+  if (enable_inference && inference::OutputCache() != nullptr) {
+    metric::BiddingContextMap()->AddObserverable(
+        metric::kInferenceCacheLookupRatio,
+        inference::InferenceCache::GetLookupRatios);
+  }
+  if (enable_inference) {
+    metric::BiddingContextMap()->AddObserverable(
+        metric::kInferenceModelLatency, inference::GetModelInferenceTimes);
+    metric::BiddingContextMap()->AddObserverable(
+        metric::kInferenceModelQueueTime, inference::GetModelQueueTimes);
+    metric::BiddingContextMap()->AddObserverable(
+        metric::kInferenceModelBatchSize, inference::GetModelBatchSizes);
+    metric::BiddingContextMap()->AddObserverable(
+        metric::kInferenceModelErrorCount, inference::GetModelErrorCounts);
+  }
+  std::unique_ptr<ProfilingService> profiling_service =
+      MayStartProfiling(config_client);
+  std::unique_ptr<TcmallocTuner> tcmalloc_tuner =
+      MayStartTcmallocTuning(config_client);
 
   auto generate_bids_reactor_factory =
       [&client, enable_bidding_service_benchmark](
@@ -375,20 +675,6 @@ absl::Status RunServer() {
         return generate_bids_reactor.release();
       };
 
-  const bool is_protected_app_signals_enabled =
-      config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS);
-  std::string tee_ad_retrieval_kv_server_addr = std::string(
-      config_client.GetStringParameter(TEE_AD_RETRIEVAL_KV_SERVER_ADDR));
-  std::string tee_kv_server_addr =
-      std::string(config_client.GetStringParameter(TEE_KV_SERVER_ADDR));
-  if (is_protected_app_signals_enabled &&
-      tee_ad_retrieval_kv_server_addr.empty() && tee_kv_server_addr.empty()) {
-    return absl::InvalidArgumentError(
-        "Missing: Ad Retrieval server address "
-        "and KV server address. Must specify at "
-        "least one.");
-  }
-
   BiddingServiceRuntimeConfig runtime_config = {
       .tee_ad_retrieval_kv_server_addr =
           std::move(tee_ad_retrieval_kv_server_addr),
@@ -396,11 +682,15 @@ absl::Status RunServer() {
       .enable_buyer_debug_url_generation = enable_buyer_debug_url_generation,
       .roma_timeout_ms =
           config_client.GetStringParameter(ROMA_TIMEOUT_MS).data(),
+      .roma_batch_deadline_ms =
+          config_client.GetIntParameter(ROMA_BATCH_DEADLINE_MS),
       .enable_adtech_code_logging = enable_adtech_code_logging,
       .is_protected_app_signals_enabled = enable_protected_app_signals,
       .is_protected_audience_enabled = enable_protected_audience,
       .ad_retrieval_timeout_ms =
           config_client.GetIntParameter(AD_RETRIEVAL_TIMEOUT_MS),
+      .enable_pipelined_ads_retrieval =
+          config_client.GetBooleanParameter(ENABLE_PIPELINED_ADS_RETRIEVAL),
       .max_allowed_size_debug_url_bytes =
           config_client.GetIntParameter(MAX_ALLOWED_SIZE_DEBUG_URL_BYTES),
       .max_allowed_size_all_debug_urls_kb =
@@ -410,10 +700,63 @@ absl::Status RunServer() {
       .kv_server_egress_tls =
           config_client.GetBooleanParameter(KV_SERVER_EGRESS_TLS)};
 
+  if (enable_protected_audience &&
+      udf_config.protected_auction_generate_bid_is_deterministic()) {
+    runtime_config.deduplicate_generate_bids = true;
+    runtime_config.generate_bid_ignores_interest_group_name =
+        udf_config
+            .protected_auction_generate_bid_ignores_interest_group_name();
+    if (udf_config.protected_auction_generate_bid_cache_ttl_ms() > 0) {
+      runtime_config.generate_bid_cache = std::make_shared<GenerateBidCache>(
+          kGenerateBidCacheCapacity,
+          absl::Milliseconds(
+              udf_config.protected_auction_generate_bid_cache_ttl_ms()));
+    }
+  }
+
+  if (enable_protected_audience &&
+      udf_config.protected_auction_generate_bid_wasm()) {
+    runtime_config.generate_bid_wasm = true;
+  } else if (enable_inference && enable_protected_audience &&
+             udf_config.protected_auction_batch_inference()) {
+    runtime_config.run_batch_inference = inference::RunBatchInference;
+  }
+  if (enable_protected_audience) {
+    runtime_config.generate_bids_max_chunk_size =
+        udf_config.protected_auction_generate_bid_max_chunk_size();
+    runtime_config.num_js_workers =
+        config_client.GetIntParameter(JS_NUM_WORKERS);
+  }
+
+  if (const int ads_metadata_cache_ttl_ms =
+          config_client.GetIntParameter(ADS_METADATA_CACHE_TTL_MS);
+      enable_protected_app_signals && ads_metadata_cache_ttl_ms > 0) {
+    runtime_config.ads_metadata_cache = CreateAdsMetadataCache(
+        kAdsMetadataCacheMaxBytes,
+        absl::Milliseconds(ads_metadata_cache_ttl_ms));
+  }
+  if (const int prepared_data_cache_ttl_ms =
+          config_client.GetIntParameter(PREPARED_DATA_CACHE_TTL_MS);
+      enable_protected_app_signals && prepared_data_cache_ttl_ms > 0) {
+    runtime_config.prepared_data_cache = CreatePreparedDataCache(
+        kPreparedDataCacheMaxBytes,
+        absl::Milliseconds(prepared_data_cache_ttl_ms));
+  }
+
+  // The keys are fetched while the startup tasks run.
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      key_fetcher_manager = CreateKeyFetcherManager(
+          config_client, enable_protected_app_signals
+                             ? CreatePublicKeyFetcher(config_client)
+                             : nullptr);
+  PS_RETURN_IF_ERROR(startup.Wait());
+
   if (udf_config.fetch_mode() == bidding_service::FETCH_MODE_BUCKET) {
     if (enable_protected_audience) {
       runtime_config.default_protected_auction_generate_bid_version =
           udf_config.protected_auction_bidding_js_bucket_default_blob();
+      runtime_config.protected_auction_generate_bid_version_splitter =
+          udf_fetcher.protected_auction_version_splitter();
     }
     if (enable_protected_app_signals) {
       runtime_config.default_protected_app_signals_generate_bid_version =
@@ -442,11 +785,7 @@ absl::Status RunServer() {
       };
 
   BiddingService bidding_service(
-      std::move(generate_bids_reactor_factory),
-      CreateKeyFetcherManager(config_client,
-                              enable_protected_app_signals
-                                  ? CreatePublicKeyFetcher(config_client)
-                                  : nullptr),
+      std::move(generate_bids_reactor_factory), std::move(key_fetcher_manager),
       CreateCryptoClient(), std::move(runtime_config),
       std::move(protected_app_signals_generate_bids_reactor_factory));
 
@@ -471,16 +810,61 @@ absl::Status RunServer() {
   // Set max message size to 256 MB.
   builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
                              256L * 1024L * 1024L);
+  ApplyGrpcServerOptions(
+      {.num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_pollers = config_client.GetIntParameter(GRPC_SERVER_MAX_POLLERS),
+       .max_memory_bytes =
+           config_client.GetInt64Parameter(GRPC_SERVER_MAX_MEMORY_MB) * 1024 *
+           1024,
+       .max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS)},
+      builder);
+  // The messages of each call are on an arena freed at once with the call.
+  // GenerateBids is served over its raw messages, which are on an arena of
+  // each call, see RawCiphertextCall.
+  ArenaMessageAllocator<GenerateProtectedAppSignalsBidsRequest,
+                        GenerateProtectedAppSignalsBidsResponse>
+      pas_generate_bids_allocator;
+  bidding_service.SetMessageAllocatorFor_GenerateProtectedAppSignalsBids(
+      &pas_generate_bids_allocator);
   builder.RegisterService(&bidding_service);
 
-  std::unique_ptr<Server> server(builder.BuildAndStart());
+  std::unique_ptr<Server> server;
+  {
+    // The threads serving the completion queues start with the server.
+    ScopedCpuPlacement grpc_placement("gRPC threads", cpu_placement.grpc_cpus);
+    server = builder.BuildAndStart();
+  }
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
-  // Wait for the server to shutdown. Note that some other thread must be
-  // responsible for shutting down the server for this call to ever return.
+  if (enable_inference) {
+    // The sidecars started with the other startup tasks, before the server.
+    // The health check reports the server as not serving while none of them
+    // takes inference calls, so that traffic goes to other servers meanwhile.
+    // Once the server drains, it stays reported as not serving.
+    inference::SidecarPool().SetReadinessListener(
+        [health_check_service = server->GetHealthCheckService()](bool ready) {
+          health_check_service->SetServingStatus(ready &&
+                                                 !ServerDrain::Draining());
+        });
+  }
   PS_LOG(INFO) << "Server listening on " << server_address;
-  server->Wait();
+  // Drains the server on SIGTERM, then stops Roma before the inference
+  // sidecars its UDFs call.
+  ServerDrain drain(
+      {.health_check_grace = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_HEALTH_CHECK_GRACE_MS)),
+       .deadline = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_DEADLINE_MS))});
+  drain.AddStep("Roma", [&dispatcher](absl::Time) {
+    dispatcher.Stop().IgnoreError();
+  });
+  if (enable_inference) {
+    drain.AddStep("inference sidecars",
+                  [](absl::Time) { inference::SidecarPool().Stop(); });
+  }
+  drain.AddStep("telemetry", FlushTelemetry);
+  drain.Wait(*server);
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,23 +14,75 @@
 
 #include "services/bidding_service/bidding_service.h"
 
+#include <memory>
+#include <utility>
+
 #include <grpcpp/grpcpp.h>
 
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/bidding_service/generate_bids_reactor.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/backend_load.h"
+#include "services/common/util/memory_admission_controller.h"
 #include "src/telemetry/telemetry.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 grpc::ServerUnaryReactor* BiddingService::GenerateBids(
     grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
     GenerateBidsResponse* response) {
-  LogCommonMetric(request, response);
+  return ServeGenerateBids(context, request, response, /*raw_call=*/nullptr);
+}
+
+grpc::ServerUnaryReactor* BiddingService::GenerateBids(
+    grpc::CallbackServerContext* context, const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+  absl::StatusOr<std::shared_ptr<
+      RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>>>
+      raw_call =
+          RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>::Read(
+              *request, response);
+  if (!raw_call.ok()) {
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(raw_call.status()));
+    return reactor;
+  }
+  return ServeGenerateBids(context, (*raw_call)->request(),
+                           (*raw_call)->response(), *std::move(raw_call));
+}
+
+grpc::ServerUnaryReactor* BiddingService::ServeGenerateBids(
+    grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
+    GenerateBidsResponse* response,
+    std::shared_ptr<
+        RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>>
+        raw_call) {
+  // Lets the clients steer their RPCs away from busy replicas.
+  context->AddInitialMetadata(
+      kBackendLoadMetadataKey,
+      SerializeBackendLoadReport(BackendLoadTracker::Get().Report()));
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    LogRejectedRequestMetric(request, response, memory_reservation.status());
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
   // Heap allocate the reactor. Deleted in reactor's OnDone call.
   auto* reactor = generate_bids_reactor_factory_(
       request, response, key_fetcher_manager_.get(), crypto_client_.get(),
       runtime_config_);
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
+  if (raw_call != nullptr) {
+    reactor->ServeRawCall(std::move(raw_call));
+  }
+  reactor->SetDeadline(absl::FromChrono(context->deadline()));
+  reactor->StartTrace(
+      "GenerateBids", RequestTrace::GetTraceParent(context->client_metadata()));
   reactor->Execute();
   return reactor;
 }
@@ -39,11 +91,26 @@ grpc::ServerUnaryReactor* BiddingService::GenerateProtectedAppSignalsBids(
     grpc::CallbackServerContext* context,
     const GenerateProtectedAppSignalsBidsRequest* request,
     GenerateProtectedAppSignalsBidsResponse* response) {
+  context->AddInitialMetadata(
+      kBackendLoadMetadataKey,
+      SerializeBackendLoadReport(BackendLoadTracker::Get().Report()));
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
   // Heap allocate the reactor. Deleted in reactor's OnDone call.
   auto* reactor = protected_app_signals_generate_bids_reactor_factory_(
       context, request, runtime_config_, response, key_fetcher_manager_.get(),
       crypto_client_.get(), ad_retrieval_async_client_.get(),
       kv_async_client_.get());
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
+  reactor->SetDeadline(absl::FromChrono(context->deadline()));
+  reactor->StartTrace(
+      "GenerateProtectedAppSignalsBids",
+      RequestTrace::GetTraceParent(context->client_metadata()));
   reactor->Execute();
   return reactor;
 }
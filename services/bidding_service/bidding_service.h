@@ -26,6 +26,7 @@
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
 #include "services/common/clients/kv_server/kv_async_client.h"
+#include "services/common/util/raw_ciphertext_call.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
@@ -55,7 +56,10 @@ using ProtectedAppSignalsGenerateBidsReactorFactory =
 // The bid generation uses proprietary AdTech code that runs in a secure privacy
 // sandbox inside a secure Virtual Machine. The implementation dispatches to
 // V8 to run the AdTech code.
-class BiddingService final : public Bidding::CallbackService {
+// GenerateBids is served over its raw messages, see RawCiphertextCall.
+class BiddingService final
+    : public Bidding::WithRawCallbackMethod_GenerateBids<
+          Bidding::CallbackService> {
  public:
   explicit BiddingService(
       GenerateBidsReactorFactory generate_bids_reactor_factory,
@@ -114,6 +118,11 @@ class BiddingService final : public Bidding::CallbackService {
       grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
       GenerateBidsResponse* response) override;
 
+  // Serves GenerateBids over its raw messages, as above.
+  grpc::ServerUnaryReactor* GenerateBids(grpc::CallbackServerContext* context,
+                                         const grpc::ByteBuffer* request,
+                                         grpc::ByteBuffer* response) override;
+
   // Generates bids for protected app signals.
   grpc::ServerUnaryReactor* GenerateProtectedAppSignalsBids(
       grpc::CallbackServerContext* context,
@@ -121,6 +130,15 @@ class BiddingService final : public Bidding::CallbackService {
       GenerateProtectedAppSignalsBidsResponse* response) override;
 
  private:
+  // Serves a GenerateBids call, over the raw messages of `raw_call` if not
+  // null.
+  grpc::ServerUnaryReactor* ServeGenerateBids(
+      grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
+      GenerateBidsResponse* response,
+      std::shared_ptr<
+          RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>>
+          raw_call);
+
   GenerateBidsReactorFactory generate_bids_reactor_factory_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
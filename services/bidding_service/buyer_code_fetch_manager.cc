@@ -24,6 +24,7 @@
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 #include "services/bidding_service/constants.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 #include "services/common/code_fetch/periodic_bucket_fetcher.h"
 #include "services/common/code_fetch/periodic_code_fetcher.h"
 #include "services/common/util/file_util.h"
@@ -90,7 +91,9 @@ absl::Status BuyerCodeFetchManager::InitializeLocalCodeFetch() {
   PS_ASSIGN_OR_RETURN(auto adtech_code_blob,
                       GetFileContent(udf_config_.bidding_js_path(),
                                      /*log_on_error=*/true));
-  adtech_code_blob = GetBuyerWrappedCode(adtech_code_blob, "");
+  adtech_code_blob = udf_config_.protected_auction_generate_bid_wasm()
+                         ? GetBuyerWasmWrappedCode(adtech_code_blob)
+                         : GetBuyerWrappedCode(adtech_code_blob, "");
   return dispatcher_.LoadSync(kProtectedAudienceGenerateBidBlobVersion,
                               adtech_code_blob);
 }
@@ -109,11 +112,31 @@ absl::Status BuyerCodeFetchManager::InitializeBucketCodeFetch() {
 }
 
 absl::Status BuyerCodeFetchManager::InitializeBucketCodeFetchForPA() {
-  auto wrap_code = [](const std::vector<std::string>& adtech_code_blobs) {
+  auto wrap_code = [wasm = udf_config_.protected_auction_generate_bid_wasm()](
+                       const std::vector<std::string>& adtech_code_blobs) {
+    if (wasm) {
+      return GetBuyerWasmWrappedCode(adtech_code_blobs[kJsBlobIndex]);
+    }
     return GetBuyerWrappedCode(adtech_code_blobs[kJsBlobIndex], kUnusedWasmBlob,
                                AuctionType::kProtectedAudience);
   };
 
+  if (!udf_config_.protected_auction_bidding_js_bucket_canary_blobs().empty()) {
+    std::vector<CanaryCodeVersion> canaries;
+    for (const bidding_service::CanaryCodeBlob& canary :
+         udf_config_.protected_auction_bidding_js_bucket_canary_blobs()) {
+      canaries.push_back({.version = canary.blob_name(),
+                          .traffic_percent = canary.traffic_percent()});
+    }
+    PS_ASSIGN_OR_RETURN(
+        pa_version_splitter_,
+        CodeVersionSplitter::Create(
+            udf_config_.protected_auction_bidding_js_bucket_default_blob(),
+            std::move(canaries),
+            udf_config_.protected_auction_bidding_js_max_resident_bytes()),
+        _ << "Invalid canary blobs for " << kProtectedAuctionJsId << ": ");
+  }
+
   PS_ASSIGN_OR_RETURN(
       pa_udf_fetcher_,
       StartBucketFetch(
@@ -121,7 +144,7 @@ absl::Status BuyerCodeFetchManager::InitializeBucketCodeFetchForPA() {
           udf_config_.protected_auction_bidding_js_bucket_default_blob(),
           kProtectedAuctionJsId,
           absl::Milliseconds(udf_config_.url_fetch_period_ms()),
-          std::move(wrap_code)));
+          std::move(wrap_code), pa_version_splitter_.get()));
 
   return absl::OkStatus();
 }
@@ -175,7 +198,12 @@ absl::Status BuyerCodeFetchManager::InitializeUrlCodeFetch() {
 }
 
 absl::Status BuyerCodeFetchManager::InitializeUrlCodeFetchForPA() {
-  auto wrap_code = [](const std::vector<std::string>& adtech_code_blobs) {
+  auto wrap_code = [wasm = udf_config_.protected_auction_generate_bid_wasm()](
+                       const std::vector<std::string>& adtech_code_blobs) {
+    // The code blob is the module itself, without a wasm helper.
+    if (wasm) {
+      return GetBuyerWasmWrappedCode(adtech_code_blobs[kJsBlobIndex]);
+    }
     return GetBuyerWrappedCode(adtech_code_blobs[kJsBlobIndex],
                                adtech_code_blobs.size() == kMaxNumCodeBlobs
                                    ? adtech_code_blobs[kWasmBlobIndex]
@@ -275,7 +303,8 @@ BuyerCodeFetchManager::StartBucketFetch(
     const std::string& bucket_name, const std::string& default_version,
     absl::string_view script_logging_name, absl::Duration url_fetch_period_ms,
     absl::AnyInvocable<std::string(const std::vector<std::string>&)>
-        wrap_code) {
+        wrap_code,
+    CodeVersionSplitter* version_splitter) {
   if (bucket_name.empty()) {
     return absl::InvalidArgumentError(
         absl::StrCat(kEmptyBucketName, script_logging_name));
@@ -286,7 +315,7 @@ BuyerCodeFetchManager::StartBucketFetch(
 
   auto bucket_fetcher = std::make_unique<PeriodicBucketFetcher>(
       bucket_name, url_fetch_period_ms, &dispatcher_, &executor_,
-      std::move(wrap_code), blob_storage_client_.get());
+      std::move(wrap_code), blob_storage_client_.get(), version_splitter);
   PS_RETURN_IF_ERROR(bucket_fetcher->Start())
       << absl::StrCat("Failed bucket fetch startup for ", script_logging_name,
                       " ", bucket_name);
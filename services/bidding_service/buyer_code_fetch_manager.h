@@ -24,6 +24,7 @@
 #include "services/bidding_service/bidding_code_fetch_config.pb.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
 #include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 #include "services/common/code_fetch/periodic_bucket_fetcher.h"
 #include "services/common/code_fetch/periodic_code_fetcher.h"
 #include "src/concurrent/event_engine_executor.h"
@@ -78,6 +79,14 @@ class BuyerCodeFetchManager {
   // A successful Init means that Roma has succeeded in loading a UDF.
   absl::Status Init();
 
+  // Returns the split of the protected auction traffic between the default
+  // and the canary bucket blobs, or nullptr if no canary blob is configured.
+  // Set by Init.
+  std::shared_ptr<CodeVersionSplitter> protected_auction_version_splitter()
+      const {
+    return pa_version_splitter_;
+  }
+
  private:
   // Must be called exactly once. This should only be called on server shutdown,
   // and only after Init has returned (either a success or error is fine).
@@ -96,7 +105,8 @@ class BuyerCodeFetchManager {
       const std::string& bucket_name, const std::string& default_version,
       absl::string_view script_logging_name, absl::Duration url_fetch_period_ms,
       absl::AnyInvocable<std::string(const std::vector<std::string>&)>
-          wrap_code);
+          wrap_code,
+      CodeVersionSplitter* version_splitter = nullptr);
 
   absl::Status InitializeUrlCodeFetch();
   absl::Status InitializeUrlCodeFetchForPA();
@@ -118,6 +128,7 @@ class BuyerCodeFetchManager {
   const bool enable_protected_audience_;
   const bool enable_protected_app_signals_;
 
+  std::shared_ptr<CodeVersionSplitter> pa_version_splitter_;
   std::unique_ptr<CodeFetcherInterface> pa_udf_fetcher_;
   std::unique_ptr<CodeFetcherInterface> pas_bidding_udf_fetcher_;
   std::unique_ptr<CodeFetcherInterface> pas_ads_retrieval_udf_fetcher_;
@@ -15,11 +15,12 @@
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 
 #include <string>
-#include <vector>
 
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
 #include "services/bidding_service/constants.h"
 #include "services/common/util/reporting_util.h"
 #include "src/logger/request_context_impl.h"
@@ -28,16 +29,7 @@ namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 std::string WasmBytesToJavascript(absl::string_view wasm_bytes) {
-  std::string hex_array = "";
-
-  for (const uint8_t& byte :
-       std::vector<uint8_t>(wasm_bytes.begin(), wasm_bytes.end())) {
-    absl::StrAppend(&hex_array, absl::StrFormat("%#x,", byte));
-  }
-  // In javascript, it is ok to leave a comma after the last element in the
-  // array.
-
-  return absl::StrFormat(kWasmModuleTemplate, hex_array);
+  return absl::StrFormat(kWasmModuleTemplate, absl::Base64Escape(wasm_bytes));
 }
 
 absl::string_view GetGenerateBidArgs(AuctionType auction_type) {
@@ -60,10 +52,25 @@ std::string GetBuyerWrappedCode(absl::string_view ad_tech_js,
                                 AuctionType auction_type,
                                 absl::string_view auction_specific_setup) {
   absl::string_view args = GetGenerateBidArgs(auction_type);
+  std::string lite_entry_function;
+  std::string prepare_inference_inputs_entry_function;
+  absl::string_view batch_entry_function;
+  if (auction_type == AuctionType::kProtectedAudience) {
+    lite_entry_function =
+        absl::Substitute(kLiteEntryFunction, args, auction_specific_setup);
+    prepare_inference_inputs_entry_function =
+        absl::Substitute(kPrepareInferenceInputsEntryFunction, args);
+    batch_entry_function = kBatchEntryFunction;
+  }
   return absl::StrCat(
-      WasmBytesToJavascript(ad_tech_wasm),
+      WasmBytesToJavascript(ad_tech_wasm), kUdfProfilingFunction,
       absl::Substitute(kEntryFunction, args, auction_specific_setup),
-      ad_tech_js);
+      lite_entry_function, prepare_inference_inputs_entry_function,
+      batch_entry_function, ad_tech_js);
+}
+
+std::string GetBuyerWasmWrappedCode(absl::string_view ad_tech_wasm) {
+  return absl::StrCat(WasmBytesToJavascript(ad_tech_wasm), kWasmEntryFunction);
 }
 
 std::string GetProtectedAppSignalsGenericBuyerWrappedCode(
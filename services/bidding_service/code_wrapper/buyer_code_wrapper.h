@@ -29,6 +29,11 @@ namespace privacy_sandbox::bidding_auction_servers {
 // - Generation of event level debug reporting
 // - Exporting console.logs from the AdTech execution.
 // - wasmHelper added to device_signals
+// - prepareInferenceInputs for the batch inference, for Protected Audience
+// - A lighter generateBid entry function without logging nor debug
+//   reporting, for Protected Audience
+// - A generateBid entry function for chunks of interest groups, for Protected
+//   Audience
 std::string GetBuyerWrappedCode(
     absl::string_view ad_tech_js, absl::string_view ad_tech_wasm = "",
     AuctionType auction_type = AuctionType::kProtectedAudience,
@@ -44,12 +49,18 @@ std::string GetProtectedAppSignalsGenericBuyerWrappedCode(
     absl::string_view ad_tech_js, absl::string_view ad_tech_wasm,
     absl::string_view function_name, absl::string_view args);
 
+// Returns the complete wrapped code for a Buyer which ships a standalone wasm
+// module exporting generateBid instead of javascript. See
+// kWasmEntryFunction for the binary interface of the module.
+std::string GetBuyerWasmWrappedCode(absl::string_view ad_tech_wasm);
+
 // Wrapper Javascript over AdTech code.
 // This wrapper supports the features below:
 //- Exporting logs to Bidding Service using console.log
 //- Hooks in wasm module
+//- Profiling generateBid for consented requests, see kUdfProfilingFunction
 inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
-    function generateBidEntryFunction($0, featureFlags){
+    function generateBidEntryFunction($0, featureFlags, inferenceOutputs){
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -77,8 +88,10 @@ inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
       globalThis.forDebuggingOnly = forDebuggingOnly;
 
       var generateBidResponse = {};
+      var psProfile = undefined;
       try {
-        generateBidResponse = generateBid($0);
+        [generateBidResponse, psProfile] = psRunProfiled(featureFlags,
+            () => generateBid($0, inferenceOutputs));
       if( featureFlags.enable_debug_url_generation &&
              (forDebuggingOnly_auction_loss_url
                   || forDebuggingOnly_auction_win_url)) {
@@ -96,11 +109,94 @@ inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
         response: generateBidResponse !== undefined ? generateBidResponse : {},
         logs: ps_logs,
         errors: ps_errors,
+        warnings: ps_warns,
+        profile: psProfile
+      }
+    }
+)JS_CODE";
+
+// Wrapper Javascript over AdTech code for the requests without logging nor
+// debug reporting. It skips their instrumentation and returns the output of
+// generateBid as is, instead of within an object with the logs.
+inline constexpr absl::string_view kLiteEntryFunction = R"JS_CODE(
+    const psNoOpForDebuggingOnly = {
+      reportAdAuctionLoss: function(url){},
+      reportAdAuctionWin: function(url){}
+    };
+    function generateBidLiteEntryFunction($0, featureFlags, inferenceOutputs){
+      $1
+      globalThis.forDebuggingOnly = psNoOpForDebuggingOnly;
+      try {
+        const generateBidResponse = generateBid($0, inferenceOutputs);
+        return generateBidResponse !== undefined ? generateBidResponse : {};
+      } catch(e) {
+        return {};
+      }
+    }
+)JS_CODE";
+
+// Wrapper Javascript over the optional prepareInferenceInputs function of
+// the AdTech, which returns the inference requests of an interest group for
+// the batch inference of all the interest groups of a request.
+inline constexpr absl::string_view kPrepareInferenceInputsEntryFunction =
+    R"JS_CODE(
+    function prepareInferenceInputsEntryFunction($0, featureFlags){
+      var ps_logs = [];
+      var ps_errors = [];
+      var ps_warns = [];
+      if(featureFlags.enable_logging){
+        console.log = function(...args) {
+          ps_logs.push(JSON.stringify(args))
+        }
+        console.error = function(...args) {
+          ps_errors.push(JSON.stringify(args))
+        }
+        console.warn = function(...args) {
+          ps_warns.push(JSON.stringify(args))
+        }
+      }
+      var inferenceInputs = [];
+      try {
+        if (typeof prepareInferenceInputs === 'function') {
+          inferenceInputs = prepareInferenceInputs($0);
+        }
+      } catch({error, message}) {
+        if (featureFlags.enable_logging) {
+          console.error("[Error: " + error + "; Message: " + message + "]");
+        }
+      }
+      return {
+        response: inferenceInputs !== undefined ? inferenceInputs : [],
+        logs: ps_logs,
+        errors: ps_errors,
         warnings: ps_warns
       }
     }
 )JS_CODE";
 
+// Wrapper Javascript running generateBid for a chunk of interest groups in a
+// single invocation, so that the arguments shared by the interest groups are
+// parsed once per chunk. The arguments of an interest group are arrays of an
+// element per interest group. Each interest group goes through the entry
+// function its requests use on their own, and the array of their outputs is
+// returned.
+inline constexpr absl::string_view kBatchEntryFunction = R"JS_CODE(
+    function generateBidsBatchEntryFunction(interest_group, auction_signals,
+        buyer_signals, trusted_bidding_signals, device_signals, featureFlags,
+        inferenceOutputs){
+      const psEntryFunction = featureFlags.enable_logging ||
+          featureFlags.enable_debug_url_generation ?
+          generateBidEntryFunction : generateBidLiteEntryFunction;
+      const psOutputs = [];
+      for (let i = 0; i < interest_group.length; i++) {
+        psOutputs.push(psEntryFunction(interest_group[i], auction_signals,
+            buyer_signals, trusted_bidding_signals[i], device_signals[i],
+            featureFlags, inferenceOutputs?.[i] ?? undefined));
+      }
+      return psOutputs;
+    }
+)JS_CODE";
+
 // Wrapper Javascript over AdTech code.
 // This wrapper supports the features below:
 //- Exporting logs to Bidding Service using console.log
@@ -135,11 +231,77 @@ inline constexpr absl::string_view kPrepareDataForAdRetrievalEntryFunction =
     }
 )JS_CODE";
 
-// This is used to create a javascript array that contains a hex representation
-// of the raw wasm bytecode.
+// Wrapper Javascript over a standalone AdTech wasm module. Each argument is
+// the base64 of its bytes instead of JSON: the serialized
+// InterestGroupForBidding, the auction, buyer and trusted bidding signals JSON
+// as is, and a serialized GenerateBidsRawRequest with only the publisher name,
+// seller and top level seller as device signals, next to the browser or
+// android signals of the interest group. The module is instantiated for every
+// call, without imports, and must export:
+// - memory: its linear memory.
+// - allocate(length): returns the address of `length` bytes of memory.
+// - generateBid(interestGroupAddress, interestGroupLength, auctionSignals...,
+//   buyerSignals..., trustedBiddingSignals..., deviceSignals...): returns the
+//   address of the little endian 32 bits length of the serialized AdWithBid
+//   followed by its bytes, or 0 for no bid.
+// The bid is returned as the base64 of its bytes.
+inline constexpr absl::string_view kWasmEntryFunction = R"JS_CODE(
+    function psEncodeBase64(bytes) {
+      const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+      const chars = [];
+      for (let i = 0; i < bytes.length; i += 3) {
+        const n = bytes[i] << 16 | (bytes[i + 1] || 0) << 8 | (bytes[i + 2] || 0);
+        chars.push(alphabet[n >> 18 & 63], alphabet[n >> 12 & 63],
+            i + 1 < bytes.length ? alphabet[n >> 6 & 63] : '=',
+            i + 2 < bytes.length ? alphabet[n & 63] : '=');
+      }
+      return chars.join('');
+    }
+    function generateBidWasmEntryFunction(interest_group, auction_signals,
+        buyer_signals, trusted_bidding_signals, device_signals) {
+      const exports = new WebAssembly.Instance(globalWasmHelper, {}).exports;
+      const args = [];
+      for (const base64 of [interest_group, auction_signals, buyer_signals,
+                            trusted_bidding_signals, device_signals]) {
+        const bytes = psDecodeWasmBase64(base64);
+        const address = exports.allocate(bytes.length);
+        new Uint8Array(exports.memory.buffer, address, bytes.length).set(bytes);
+        args.push(address, bytes.length);
+      }
+      const address = exports.generateBid(...args);
+      if (!address) {
+        return '';
+      }
+      const length = new DataView(exports.memory.buffer).getUint32(address, true);
+      return psEncodeBase64(
+          new Uint8Array(exports.memory.buffer, address + 4, length));
+    }
+)JS_CODE";
+
+// This is used to create a javascript string literal that contains the base64
+// encoding of the raw wasm bytecode. Every Roma worker parses and compiles the
+// wrapped code on each load, and a single string literal is much cheaper to
+// parse than an array literal with an element per byte.
 inline constexpr absl::string_view kWasmModuleTemplate = R"JS_CODE(
-  const globalWasmHex = [%s];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+  function psDecodeWasmBase64(base64) {
+    const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+    const lookup = new Uint8Array(128);
+    for (let i = 0; i < alphabet.length; ++i) {
+      lookup[alphabet.charCodeAt(i)] = i;
+    }
+    const padding = base64.endsWith('==') ? 2 : base64.endsWith('=') ? 1 : 0;
+    const bytes = new Uint8Array(base64.length / 4 * 3 - padding);
+    for (let i = 0, j = 0; i < base64.length; i += 4) {
+      const n = lookup[base64.charCodeAt(i)] << 18 | lookup[base64.charCodeAt(i + 1)] << 12 |
+          lookup[base64.charCodeAt(i + 2)] << 6 | lookup[base64.charCodeAt(i + 3)];
+      bytes[j++] = n >> 16;
+      if (j < bytes.length) bytes[j++] = n >> 8;
+      if (j < bytes.length) bytes[j++] = n;
+    }
+    return bytes;
+  }
+  const globalWasmBase64 = "%s";
+  const globalWasmHelper = globalWasmBase64.length ? new WebAssembly.Module(psDecodeWasmBase64(globalWasmBase64)) : null;
 )JS_CODE";
 
 }  // namespace privacy_sandbox::bidding_auction_servers
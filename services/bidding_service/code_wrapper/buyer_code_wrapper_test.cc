@@ -17,6 +17,7 @@
 #include <future>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "gtest/gtest.h"
 #include "rapidjson/document.h"
@@ -43,8 +44,8 @@ TEST(GetBuyerWrappedCode, GeneratesCompleteFinalJavascript) {
 TEST(GetBuyerWrappedCode, GeneratesCompleteFinalJavascriptWithWasm) {
   std::string expected =
       absl::StrReplaceAll(kExpectedGenerateBidCode_template,
-                          {{"const globalWasmHex = [];",
-                            "const globalWasmHex = [0x74,0x65,0x73,0x74,];"}});
+                          {{"const globalWasmBase64 = \"\";",
+                            "const globalWasmBase64 = \"dGVzdA==\";"}});
   EXPECT_EQ(GetBuyerWrappedCode(kBuyerBaseCode_template, "test"), expected);
 }
 
@@ -56,6 +57,17 @@ TEST(GetBuyerWrappedCode, GeneratesCompleteProtectedAppSignalsFinalJavaScript) {
             kExpectedProtectedAppSignalsGenerateBidCodeTemplate);
 }
 
+TEST(GetBuyerWasmWrappedCode, WrapsWasmModuleWithoutJavascript) {
+  std::string wrapped_code = GetBuyerWasmWrappedCode("test");
+
+  EXPECT_NE(wrapped_code.find("const globalWasmBase64 = \"dGVzdA==\";"),
+            std::string::npos);
+  EXPECT_NE(wrapped_code.find(absl::StrCat(
+                "function ", kGenerateBidWasmEntryFunctionName, "(")),
+            std::string::npos);
+  EXPECT_EQ(wrapped_code.find("generateBidEntryFunction"), std::string::npos);
+}
+
 void GenerateFeatureFlagsTestHelper(bool is_logging_enabled,
                                     bool is_debug_url_generation_enabled) {
   std::string actual_json =
@@ -41,10 +41,81 @@ constexpr absl::string_view kBuyerBaseCode_template = R"JS_CODE(
     }
 )JS_CODE";
 constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
-  const globalWasmHex = [];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+  function psDecodeWasmBase64(base64) {
+    const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+    const lookup = new Uint8Array(128);
+    for (let i = 0; i < alphabet.length; ++i) {
+      lookup[alphabet.charCodeAt(i)] = i;
+    }
+    const padding = base64.endsWith('==') ? 2 : base64.endsWith('=') ? 1 : 0;
+    const bytes = new Uint8Array(base64.length / 4 * 3 - padding);
+    for (let i = 0, j = 0; i < base64.length; i += 4) {
+      const n = lookup[base64.charCodeAt(i)] << 18 | lookup[base64.charCodeAt(i + 1)] << 12 |
+          lookup[base64.charCodeAt(i + 2)] << 6 | lookup[base64.charCodeAt(i + 3)];
+      bytes[j++] = n >> 16;
+      if (j < bytes.length) bytes[j++] = n >> 8;
+      if (j < bytes.length) bytes[j++] = n;
+    }
+    return bytes;
+  }
+  const globalWasmBase64 = "";
+  const globalWasmHelper = globalWasmBase64.length ? new WebAssembly.Module(psDecodeWasmBase64(globalWasmBase64)) : null;
 
-    function generateBidEntryFunction(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, featureFlags){
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
+    function generateBidEntryFunction(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, featureFlags, inferenceOutputs){
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -72,8 +143,10 @@ constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
       globalThis.forDebuggingOnly = forDebuggingOnly;
 
       var generateBidResponse = {};
+      var psProfile = undefined;
       try {
-        generateBidResponse = generateBid(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals);
+        [generateBidResponse, psProfile] = psRunProfiled(featureFlags,
+            () => generateBid(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, inferenceOutputs));
       if( featureFlags.enable_debug_url_generation &&
              (forDebuggingOnly_auction_loss_url
                   || forDebuggingOnly_auction_win_url)) {
@@ -91,10 +164,74 @@ constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
         response: generateBidResponse !== undefined ? generateBidResponse : {},
         logs: ps_logs,
         errors: ps_errors,
+        warnings: ps_warns,
+        profile: psProfile
+      }
+    }
+
+    const psNoOpForDebuggingOnly = {
+      reportAdAuctionLoss: function(url){},
+      reportAdAuctionWin: function(url){}
+    };
+    function generateBidLiteEntryFunction(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, featureFlags, inferenceOutputs){
+      device_signals.wasmHelper = globalWasmHelper;
+      globalThis.forDebuggingOnly = psNoOpForDebuggingOnly;
+      try {
+        const generateBidResponse = generateBid(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, inferenceOutputs);
+        return generateBidResponse !== undefined ? generateBidResponse : {};
+      } catch(e) {
+        return {};
+      }
+    }
+
+    function prepareInferenceInputsEntryFunction(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals, featureFlags){
+      var ps_logs = [];
+      var ps_errors = [];
+      var ps_warns = [];
+      if(featureFlags.enable_logging){
+        console.log = function(...args) {
+          ps_logs.push(JSON.stringify(args))
+        }
+        console.error = function(...args) {
+          ps_errors.push(JSON.stringify(args))
+        }
+        console.warn = function(...args) {
+          ps_warns.push(JSON.stringify(args))
+        }
+      }
+      var inferenceInputs = [];
+      try {
+        if (typeof prepareInferenceInputs === 'function') {
+          inferenceInputs = prepareInferenceInputs(interest_group, auction_signals, buyer_signals, trusted_bidding_signals, device_signals);
+        }
+      } catch({error, message}) {
+        if (featureFlags.enable_logging) {
+          console.error("[Error: " + error + "; Message: " + message + "]");
+        }
+      }
+      return {
+        response: inferenceInputs !== undefined ? inferenceInputs : [],
+        logs: ps_logs,
+        errors: ps_errors,
         warnings: ps_warns
       }
     }
 
+    function generateBidsBatchEntryFunction(interest_group, auction_signals,
+        buyer_signals, trusted_bidding_signals, device_signals, featureFlags,
+        inferenceOutputs){
+      const psEntryFunction = featureFlags.enable_logging ||
+          featureFlags.enable_debug_url_generation ?
+          generateBidEntryFunction : generateBidLiteEntryFunction;
+      const psOutputs = [];
+      for (let i = 0; i < interest_group.length; i++) {
+        psOutputs.push(psEntryFunction(interest_group[i], auction_signals,
+            buyer_signals, trusted_bidding_signals[i], device_signals[i],
+            featureFlags, inferenceOutputs?.[i] ?? undefined));
+      }
+      return psOutputs;
+    }
+
     function fibonacci(num) {
       if (num <= 1) return 1;
       return fibonacci(num - 1) + fibonacci(num - 2);
@@ -114,10 +251,81 @@ constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
 )JS_CODE";
 constexpr absl::string_view
     kExpectedProtectedAppSignalsGenerateBidCodeTemplate = R"JS_CODE(
-  const globalWasmHex = [];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+  function psDecodeWasmBase64(base64) {
+    const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+    const lookup = new Uint8Array(128);
+    for (let i = 0; i < alphabet.length; ++i) {
+      lookup[alphabet.charCodeAt(i)] = i;
+    }
+    const padding = base64.endsWith('==') ? 2 : base64.endsWith('=') ? 1 : 0;
+    const bytes = new Uint8Array(base64.length / 4 * 3 - padding);
+    for (let i = 0, j = 0; i < base64.length; i += 4) {
+      const n = lookup[base64.charCodeAt(i)] << 18 | lookup[base64.charCodeAt(i + 1)] << 12 |
+          lookup[base64.charCodeAt(i + 2)] << 6 | lookup[base64.charCodeAt(i + 3)];
+      bytes[j++] = n >> 16;
+      if (j < bytes.length) bytes[j++] = n >> 8;
+      if (j < bytes.length) bytes[j++] = n;
+    }
+    return bytes;
+  }
+  const globalWasmBase64 = "";
+  const globalWasmHelper = globalWasmBase64.length ? new WebAssembly.Module(psDecodeWasmBase64(globalWasmBase64)) : null;
 
-    function generateBidEntryFunction(ads, sellerAuctionSignals, buyerSignals, preprocessedDataForRetrieval, encodedOnDeviceSignals, encodingVersion, featureFlags){
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+
+    function generateBidEntryFunction(ads, sellerAuctionSignals, buyerSignals, preprocessedDataForRetrieval, encodedOnDeviceSignals, encodingVersion, featureFlags, inferenceOutputs){
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -153,8 +361,10 @@ constexpr absl::string_view
       globalThis.forDebuggingOnly = forDebuggingOnly;
 
       var generateBidResponse = {};
+      var psProfile = undefined;
       try {
-        generateBidResponse = generateBid(ads, sellerAuctionSignals, buyerSignals, preprocessedDataForRetrieval, encodedOnDeviceSignals, encodingVersion);
+        [generateBidResponse, psProfile] = psRunProfiled(featureFlags,
+            () => generateBid(ads, sellerAuctionSignals, buyerSignals, preprocessedDataForRetrieval, encodedOnDeviceSignals, encodingVersion, inferenceOutputs));
       if( featureFlags.enable_debug_url_generation &&
              (forDebuggingOnly_auction_loss_url
                   || forDebuggingOnly_auction_win_url)) {
@@ -172,7 +382,8 @@ constexpr absl::string_view
         response: generateBidResponse !== undefined ? generateBidResponse : {},
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        profile: psProfile
       }
     }
 
@@ -195,8 +406,25 @@ constexpr absl::string_view
 )JS_CODE";
 constexpr absl::string_view kExpectedPrepareDataForAdRetrievalTemplate =
     R"JS_CODE(
-  const globalWasmHex = [];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+  function psDecodeWasmBase64(base64) {
+    const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+    const lookup = new Uint8Array(128);
+    for (let i = 0; i < alphabet.length; ++i) {
+      lookup[alphabet.charCodeAt(i)] = i;
+    }
+    const padding = base64.endsWith('==') ? 2 : base64.endsWith('=') ? 1 : 0;
+    const bytes = new Uint8Array(base64.length / 4 * 3 - padding);
+    for (let i = 0, j = 0; i < base64.length; i += 4) {
+      const n = lookup[base64.charCodeAt(i)] << 18 | lookup[base64.charCodeAt(i + 1)] << 12 |
+          lookup[base64.charCodeAt(i + 2)] << 6 | lookup[base64.charCodeAt(i + 3)];
+      bytes[j++] = n >> 16;
+      if (j < bytes.length) bytes[j++] = n >> 8;
+      if (j < bytes.length) bytes[j++] = n;
+    }
+    return bytes;
+  }
+  const globalWasmBase64 = "";
+  const globalWasmHelper = globalWasmBase64.length ? new WebAssembly.Module(psDecodeWasmBase64(globalWasmBase64)) : null;
 
     function prepareDataForAdRetrievalEntryFunction(onDeviceEncodedSignalsHexString, testArg, featureFlags){
       var ps_logs = [];
@@ -26,6 +26,14 @@ namespace privacy_sandbox::bidding_auction_servers {
 inline constexpr char kProtectedAudienceGenerateBidBlobVersion[] = "v1";
 inline constexpr char kProtectedAppSignalsGenerateBidBlobVersion[] = "v2";
 inline constexpr char kPrepareDataForAdRetrievalBlobVersion[] = "v3";
+// Max number of generateBid outputs cached across requests.
+inline constexpr int kGenerateBidCacheCapacity = 10000;
+// Max total size of the protected app signals ads metadata cached across
+// requests.
+inline constexpr int64_t kAdsMetadataCacheMaxBytes = 64 << 20;
+// Max total size of the prepareDataForAdsRetrieval outputs cached across
+// requests.
+inline constexpr int64_t kPreparedDataCacheMaxBytes = 64 << 20;
 inline constexpr char kDecodedSignals[] = "decodedSignals";
 inline constexpr char kRetrievalData[] = "retrievalData";
 inline constexpr char kPrepareDataForAdRetrievalHandler[] =
@@ -35,6 +43,10 @@ inline constexpr char kPrepareDataForAdRetrievalEntryFunctionName[] =
 inline constexpr char kPrepareDataForAdRetrievalArgs[] =
     "encodedOnDeviceSignalsVersion, "
     "sellerAuctionSignals, contextualSignals";
+inline constexpr char kPrepareInferenceInputsEntryFunctionName[] =
+    "prepareInferenceInputsEntryFunction";
+inline constexpr char kGenerateBidWasmEntryFunctionName[] =
+    "generateBidWasmEntryFunction";
 constexpr absl::string_view kProtectedAudienceGenerateBidsArgs =
     "interest_group, auction_signals, buyer_signals, trusted_bidding_signals, "
     "device_signals";
@@ -17,9 +17,18 @@
 #ifndef SERVICES_BIDDING_SERVICE_DATA_RUNTIME_CONFIG_H_
 #define SERVICES_BIDDING_SERVICE_DATA_RUNTIME_CONFIG_H_
 
+#include <functional>
+#include <memory>
 #include <string>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "services/bidding_service/constants.h"
+#include "services/bidding_service/utils/ads_metadata_cache.h"
+#include "services/bidding_service/utils/generate_bid_cache.h"
+#include "services/bidding_service/utils/prepared_data_cache.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -34,6 +43,9 @@ struct BiddingServiceRuntimeConfig {
   bool enable_buyer_debug_url_generation = false;
   // Sets the timeout used by Roma for dispatch requests
   std::string roma_timeout_ms = "10000";
+  // If positive, generateBid batches end after this many milliseconds with
+  // the bids of the interest groups done by then.
+  int roma_batch_deadline_ms = 0;
   // Enables Buyer Code Wrapper for wrapping the AdTech code before loading it
   // in Roma. This wrapper can be used to enable multiple features such as :
   // - Exporting console.logs from Roma
@@ -47,6 +59,10 @@ struct BiddingServiceRuntimeConfig {
   bool is_protected_audience_enabled = true;
   // Time to wait for the ad retrieval request to complete.
   int ad_retrieval_timeout_ms = 60000;
+  // Overlaps the contextual ads metadata lookup with the
+  // prepareDataForAdsRetrieval UDF for requests that use both contextual and
+  // retrieved ads, and runs generateBid on each set of ads once it is fetched.
+  bool enable_pipelined_ads_retrieval = false;
   // The max allowed size of a debug win or loss URL. Default value is 64 KB.
   int max_allowed_size_debug_url_bytes = 65536;
   // The max allowed size of all debug win or loss URLs for an auction.
@@ -63,6 +79,38 @@ struct BiddingServiceRuntimeConfig {
       kProtectedAppSignalsGenerateBidBlobVersion;
   std::string default_ad_retrieval_version =
       kPrepareDataForAdRetrievalBlobVersion;
+  // Split of the protected auction traffic between the default and canary
+  // generateBid versions. The default version is used for all the requests
+  // if not set.
+  std::shared_ptr<CodeVersionSplitter>
+      protected_auction_generate_bid_version_splitter;
+  // Executes the interest groups of a request with the same generateBid
+  // inputs once, for deterministic generateBid functions.
+  bool deduplicate_generate_bids = false;
+  // Whether the interest groups deduplicated above may differ by name, for
+  // generateBid functions whose output does not depend on the name.
+  bool generate_bid_ignores_interest_group_name = false;
+  // Cache of generateBid outputs shared across requests, if any.
+  std::shared_ptr<GenerateBidCache> generate_bid_cache;
+  // Whether the protected auction generateBid is a standalone WASM module
+  // which takes its arguments as bytes instead of JSON.
+  bool generate_bid_wasm = false;
+  // Most interest groups run by a single generateBid invocation, for buyers
+  // opting in. Interest groups are run one by one when 1 or less (default).
+  int generate_bids_max_chunk_size = 0;
+  // Number of Roma workers, over which the chunks of interest groups are
+  // spread.
+  int num_js_workers = 0;
+  // Runs a JSON inference request of the interest groups of a request in
+  // the inference sidecar, until the deadline, if batch inference is enabled.
+  std::function<absl::StatusOr<std::string>(absl::string_view, absl::Time)>
+      run_batch_inference;
+  // Cache of the ads metadata looked up for contextual protected app signals
+  // ads, shared across requests, if any.
+  std::shared_ptr<AdsMetadataCache> ads_metadata_cache;
+  // Cache of the outputs of a deterministic prepareDataForAdsRetrieval,
+  // shared across requests, if any.
+  std::shared_ptr<PreparedDataCache> prepared_data_cache;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,20 +14,34 @@
 
 #include "services/bidding_service/generate_bids_reactor.h"
 
+#include <algorithm>
+#include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/json_util.h>
 #include <google/protobuf/util/message_differencer.h>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "absl/strings/str_format.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 #include "services/bidding_service/constants.h"
+#include "services/bidding_service/utils/batch_inference.h"
+#include "services/bidding_service/utils/generate_bid_input_json.h"
+#include "services/bidding_service/utils/generate_bids_chunk.h"
+#include "services/bidding_service/utils/trusted_bidding_signals_util.h"
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
+#include "services/common/util/interest_group_columns.h"
 #include "services/common/util/json_util.h"
+#include "services/common/util/parallel_for.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/util/status_macro/status_macros.h"
 #include "src/util/status_macro/status_util.h"
@@ -39,14 +53,9 @@ using ::google::protobuf::TextFormat;
 using RawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
 using IGForBidding =
     GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
-struct ParsedTrustedBiddingSignals {
-  std::shared_ptr<std::string> json = std::make_shared<std::string>();
-  absl::flat_hash_set<std::string> keys;
-};
-using TrustedBiddingSignalsByIg =
-    absl::flat_hash_map<std::string,
-                        absl::StatusOr<ParsedTrustedBiddingSignals>>;
 constexpr int kArgsSizeWithWrapper = 6;
+// Interest groups whose generateBid inputs are built by the same task.
+constexpr int kBuildInputChunkSize = 64;
 
 absl::StatusOr<std::string> ProtoToJson(
     const google::protobuf::Message& proto) {
@@ -57,243 +66,169 @@ absl::StatusOr<std::string> ProtoToJson(
   return json;
 }
 
-// Creates a json of trusted bidding signals for a single IG. Queries the
-// bidding signals for -
-// 1. IG Name and moves the bidding signal values to the new json document.
-// 2. Bidding signal keys in the IG and copies them to the new json document.
-absl::StatusOr<ParsedTrustedBiddingSignals> GetSignalsForIG(
-    const GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding&
-        ig,
-    rapidjson::Value* bidding_signals_obj, long avg_signal_str_size) {
-  // Insert bidding signal values for this Interest Group.
-  ParsedTrustedBiddingSignals parsed_trusted_bidding_signals;
-  rapidjson::Document ig_signals;
-  ig_signals.SetObject();
-  // If no bidding signals passed, return empty document.
-  if (bidding_signals_obj == nullptr) {
-    return parsed_trusted_bidding_signals;
-  }
-
-  // Copy bidding signals with key name in bidding signal keys.
-  for (const auto& key : ig.trusted_bidding_signals_keys()) {
-    if (parsed_trusted_bidding_signals.keys.contains(key)) {
-      // Do not process duplicate keys.
-      continue;
-    }
-    rapidjson::Value::ConstMemberIterator trusted_bidding_signals_key_itr =
-        bidding_signals_obj->FindMember(key.c_str());
-    if (trusted_bidding_signals_key_itr != bidding_signals_obj->MemberEnd()) {
-      rapidjson::Value json_key;
-      // Keep string reference. Assumes safe lifecycle.
-      json_key.SetString(rapidjson::StringRef(key.c_str()));
-      rapidjson::Value json_value;
-      // Copy instead of move, could be referenced by multiple IGs.
-      json_value.CopyFrom(trusted_bidding_signals_key_itr->value,
-                          ig_signals.GetAllocator());
-      // AddMember moves Values, do not reference them anymore.
-      ig_signals.AddMember(json_key, json_value, ig_signals.GetAllocator());
-      parsed_trusted_bidding_signals.keys.emplace(key);
-    }
-  }
-  if (ig_signals.MemberCount() > 0) {
-    absl::StatusOr<std::shared_ptr<std::string>> ig_signals_str =
-        SerializeJsonDoc(ig_signals, avg_signal_str_size);
-    PS_ASSIGN_OR_RETURN(parsed_trusted_bidding_signals.json, ig_signals_str);
-  }
-  return parsed_trusted_bidding_signals;
-}
-
-constexpr char kTopWindowHostname[] = "topWindowHostname";
-constexpr char kSeller[] = "seller";
-constexpr char kTopLevelSeller[] = "topLevelSeller";
-constexpr char kJoinCount[] = "joinCount";
-constexpr char kBidCount[] = "bidCount";
-constexpr char kRecency[] = "recency";
-constexpr char kPrevWins[] = "prevWins";
-constexpr char kJsonStringEnd[] = R"JSON(",")JSON";
-constexpr char kJsonStringValueStart[] = R"JSON(":")JSON";
-constexpr char kJsonValueStart[] = R"JSON(":)JSON";
-constexpr char kJsonValueEnd[] = R"JSON(,")JSON";
-constexpr char kJsonEmptyString[] = R"JSON("")JSON";
 constexpr char kEmptyDeviceSignals[] = R"JSON({})JSON";
 
-std::string MakeBrowserSignalsForScript(absl::string_view publisher_name,
-                                        absl::string_view seller,
-                                        absl::string_view top_level_seller,
-                                        const BrowserSignals& browser_signals) {
-  std::string device_signals_str = absl::StrCat(
-      R"JSON({")JSON", kTopWindowHostname, kJsonStringValueStart,
-      publisher_name, kJsonStringEnd, kSeller, kJsonStringValueStart, seller);
-  if (!top_level_seller.empty()) {
-    absl::StrAppend(&device_signals_str, kJsonStringEnd, kTopLevelSeller,
-                    kJsonStringValueStart, top_level_seller);
-  }
-  int64_t recency_ms;
-  if (browser_signals.has_recency_ms()) {
-    recency_ms = browser_signals.recency_ms();
-  } else {
-    recency_ms = browser_signals.recency() * 1000;
-  }
-  absl::StrAppend(
-      &device_signals_str, kJsonStringEnd, kJoinCount, kJsonValueStart,
-      browser_signals.join_count(), kJsonValueEnd, kBidCount, kJsonValueStart,
-      browser_signals.bid_count(), kJsonValueEnd, kRecency, kJsonValueStart,
-      /*recency is expected to be in milli seconds.*/
-      recency_ms, kJsonValueEnd, kPrevWins, kJsonValueStart,
-      browser_signals.prev_wins().empty() ? kJsonEmptyString
-                                          : browser_signals.prev_wins(),
-      "}");
-  return device_signals_str;
+// Returns the argument of the WASM generateBid for `bytes`: a JSON string of
+// their base64, which is cheap to parse in the sandbox.
+std::shared_ptr<std::string> WasmBytesArg(absl::string_view bytes) {
+  return std::make_shared<std::string>(
+      absl::StrCat("\"", absl::Base64Escape(bytes), "\""));
 }
 
-absl::StatusOr<std::string> SerializeRepeatedStringField(
-    const google::protobuf::RepeatedPtrField<std::string>&
-        repeated_string_field) {
-  rapidjson::Document json_array;
-  json_array.SetArray();
-  for (const auto& item : repeated_string_field) {
-    json_array.PushBack(
-        rapidjson::Value(item.c_str(), json_array.GetAllocator()).Move(),
-        json_array.GetAllocator());
-  }
-  return SerializeJsonDoc(json_array);
+// Returns the device signals of the WASM generateBid, shared by all the
+// interest groups of a request.
+std::shared_ptr<std::string> BuildWasmDeviceSignals(
+    const RawRequest& raw_request) {
+  RawRequest device_signals;
+  device_signals.set_publisher_name(raw_request.publisher_name());
+  device_signals.set_seller(raw_request.seller());
+  device_signals.set_top_level_seller(raw_request.top_level_seller());
+  return WasmBytesArg(device_signals.SerializeAsString());
 }
 
-constexpr char kName[] = "name";
-constexpr char kTrustedBiddingSignalsKeys[] = "trustedBiddingSignalsKeys";
-constexpr char kAdRenderIds[] = "adRenderIds";
-constexpr char kAdComponentRenderIds[] = "adComponentRenderIds";
-constexpr char kUserBiddingSignals[] = "userBiddingSignals";
-
-// Manual/Custom serializer for Interest Group.
-// Empty fields will not be included at all in the serialized JSON.
-// No default, null, or dummy values are filled in.
-// Device signals are not serialized since they are passed to generateBid()
-// in a different parameter.
-absl::StatusOr<std::string> SerializeIG(const IGForBidding& ig) {
-  // Insert the name in quotes.
-  std::string serialized_ig =
-      absl::StrFormat(R"JSON({"%s":"%s")JSON", kName, ig.name());
-  // Bidding signals keys.
-  if (!ig.trusted_bidding_signals_keys().empty()) {
-    absl::StatusOr<std::string> bidding_signals_keys_json_arr =
-        SerializeRepeatedStringField(ig.trusted_bidding_signals_keys());
-    if (!bidding_signals_keys_json_arr.ok()) {
-      return bidding_signals_keys_json_arr.status();
-    }
-    absl::StrAppend(
-        &serialized_ig,
-        absl::StrFormat(R"JSON(,"%s":%s)JSON", kTrustedBiddingSignalsKeys,
-                        bidding_signals_keys_json_arr.value()));
-  }
-  // Ad render IDs.
-  if (!ig.ad_render_ids().empty()) {
-    PS_ASSIGN_OR_RETURN(std::string ad_render_ids_json_arr,
-                        SerializeRepeatedStringField(ig.ad_render_ids()));
-    absl::StrAppend(&serialized_ig,
-                    absl::StrFormat(R"JSON(,"%s":%s)JSON", kAdRenderIds,
-                                    ad_render_ids_json_arr));
-  }
-  // Ad component render IDs.
-  if (!ig.ad_component_render_ids().empty()) {
-    PS_ASSIGN_OR_RETURN(
-        absl::StatusOr<std::string> ad_component_render_ids_json_arr,
-        SerializeRepeatedStringField(ig.ad_component_render_ids()));
-    absl::StrAppend(
-        &serialized_ig,
-        absl::StrFormat(R"JSON(,"%s":%s)JSON", kAdComponentRenderIds,
-                        ad_component_render_ids_json_arr.value()));
-  }
-  // User Bidding Signals gets no quotes as it needs no transformation.
-  if (!ig.user_bidding_signals().empty()) {
-    absl::StrAppend(&serialized_ig,
-                    absl::StrFormat(R"JSON(,"%s":%s)JSON", kUserBiddingSignals,
-                                    ig.user_bidding_signals()));
-  }
-  // Device signals do not have to be serialized.
-  absl::StrAppend(&serialized_ig, "}");
-  return serialized_ig;
+// Parses the bid of the output of the WASM generateBid, the JSON string of
+// the base64 of the serialized bid, empty if there is no bid.
+absl::Status ParseWasmBid(absl::string_view output, AdWithBid& bid) {
+  std::string serialized_bid;
+  if (output.size() < 2 || output.front() != '"' || output.back() != '"' ||
+      !absl::Base64Unescape(output.substr(1, output.size() - 2),
+                            &serialized_bid) ||
+      !bid.ParseFromString(serialized_bid)) {
+    return absl::InvalidArgumentError("Invalid WASM generateBid output");
+  }
+  return absl::OkStatus();
 }
 
 // Creates a map of Interest Group names -> trusted bidding signals json
-// strings. Parses the trusted bidding signals string and calls GetSignalsForIG
-// in a loop for all Interest Groups.
+// strings with a single pass over the trusted bidding signals.
 absl::StatusOr<TrustedBiddingSignalsByIg> SerializeTrustedBiddingSignalsPerIG(
     const GenerateBidsRequest::GenerateBidsRawRequest& raw_request,
     server_common::log::ContextImpl& log_context) {
-  // Parse into JSON.
-  auto start_parse_time = absl::Now();
-  PS_ASSIGN_OR_RETURN((rapidjson::Document parsed_signals),
-                      ParseJsonString(raw_request.bidding_signals()));
+  CycleTimer parse_timer;
+  absl::StatusOr<TrustedBiddingSignalsByIg> per_ig_signals_map =
+      ProjectTrustedBiddingSignalsPerIG(raw_request);
+  if (!per_ig_signals_map.ok()) {
+    PS_VLOG(kNoisyWarn, log_context)
+        << "Trusted bidding signals JSON validate error: "
+        << per_ig_signals_map.status().message();
+    return per_ig_signals_map;
+  }
   PS_VLOG(kStats, log_context)
-      << "\nTrusted Bidding Signals Deserialize Time: "
-      << ToInt64Microseconds((absl::Now() - start_parse_time))
+      << "\nTrusted Bidding Signals Projection Time: "
+      << ToInt64Microseconds(parse_timer.Elapsed())
       << " microseconds for " << raw_request.bidding_signals().size()
       << " bytes.";
+  return per_ig_signals_map;
+}
 
-  // Select root key.
-  if (!parsed_signals.HasMember("keys")) {
-    PS_VLOG(kNoisyWarn, log_context)
-        << "Trusted bidding signals JSON validate error (Missing property "
-           "\"keys\")";
+// Appends `part` to `inputs`, prefixed by its size so that the boundaries of
+// the parts are kept.
+void AppendInput(absl::string_view part, std::string& inputs) {
+  absl::StrAppend(&inputs, part.size(), ":", part);
+}
 
-    return absl::InvalidArgumentError(
-        "Malformed trusted bidding signals (Missing property \"keys\")");
+// Serializes the inputs of a generateBid call which differ across interest
+// groups. The interest group name is left out if `ignore_name`, so that
+// interest groups with otherwise the same inputs get the same serialization.
+std::string SerializeGenerateBidInputs(IGForBidding& interest_group,
+                                       const DispatchRequest& request,
+                                       bool ignore_name) {
+  std::string name;
+  if (ignore_name) {
+    name = std::move(*interest_group.mutable_name());
+    interest_group.clear_name();
+  }
+  std::string serialized_ig;
+  {
+    google::protobuf::io::StringOutputStream stream(&serialized_ig);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    interest_group.SerializeToCodedStream(&coded_stream);
+  }
+  if (ignore_name) {
+    interest_group.set_name(std::move(name));
   }
-  rapidjson::Value& bidding_signals_obj = parsed_signals["keys"];
+  auto input = [&request](GenerateBidArgs arg) {
+    const std::shared_ptr<std::string>& value = request.input[ArgIndex(arg)];
+    return value == nullptr ? absl::string_view() : absl::string_view(*value);
+  };
+  std::string inputs;
+  AppendInput(request.version_string, inputs);
+  AppendInput(serialized_ig, inputs);
+  AppendInput(input(GenerateBidArgs::kTrustedBiddingSignals), inputs);
+  AppendInput(input(GenerateBidArgs::kDeviceSignals), inputs);
+  return inputs;
+}
 
-  // Create IG -> TrustedBiddingSignals Map.
-  TrustedBiddingSignalsByIg per_ig_signals_map;
-  long avg_signal_size_per_ig = raw_request.bidding_signals().size() /
-                                raw_request.interest_group_for_bidding_size();
-  for (const auto& ig : raw_request.interest_group_for_bidding()) {
-    per_ig_signals_map.try_emplace(
-        ig.name(),
-        GetSignalsForIG(ig, &bidding_signals_obj, avg_signal_size_per_ig));
+// Serializes the inputs of a generateBid call shared by a batch.
+std::string SerializeSharedInput(const BatchSharedInput& shared_input) {
+  std::string inputs;
+  for (GenerateBidArgs arg :
+       {GenerateBidArgs::kAuctionSignals, GenerateBidArgs::kBuyerSignals,
+        GenerateBidArgs::kFeatureFlags}) {
+    std::shared_ptr<std::string> value = shared_input.Get(ArgIndex(arg));
+    AppendInput(value == nullptr ? absl::string_view() : *value, inputs);
   }
-  return per_ig_signals_map;
+  return inputs;
 }
 
-// Builds a vector containing commonly shared inputs, following the description
-// here:
+// Builds the inputs shared by all dispatch requests of the batch, following
+// the description here:
 // https://github.com/privacysandbox/fledge-docs/blob/main/bidding_auction_services_api.md#generatebids
 //
 // raw_request: The raw request used to generate inputs.
-// return: a vector of shared ptrs to strings. Fields (indices) that are not
-// shared by all dispatch requests are left empty, to be  filled in with values
-// specific to the request.
-std::vector<std::shared_ptr<std::string>> BuildBaseInput(
-    const RawRequest& raw_request) {
-  int args_size = kArgsSizeWithWrapper;
-
-  std::vector<std::shared_ptr<std::string>> input(
-      args_size, std::make_shared<std::string>());  // GenerateBidArgs size.
-  input[ArgIndex(GenerateBidArgs::kAuctionSignals)] =
-      std::make_shared<std::string>((raw_request.auction_signals().empty())
-                                        ? "\"\""
-                                        : raw_request.auction_signals());
-  input[ArgIndex(GenerateBidArgs::kBuyerSignals)] =
-      std::make_shared<std::string>((raw_request.buyer_signals().empty())
-                                        ? "\"\""
-                                        : raw_request.buyer_signals());
-  return input;
+// return: the shared arguments (auction signals, buyer signals and feature
+// flags) that are bound once into every dispatch request of the batch. The
+// remaining arguments are specific to each interest group.
+BatchSharedInput BuildSharedInput(const RawRequest& raw_request,
+                                  const bool enable_buyer_debug_url_generation,
+                                  const bool enable_adtech_code_logging,
+                                  const bool enable_udf_profiling,
+                                  const bool generate_bid_wasm) {
+  BatchSharedInput shared_input;
+  if (generate_bid_wasm) {
+    // The signals are passed to the module as is, even when empty.
+    shared_input.Set(ArgIndex(GenerateBidArgs::kAuctionSignals),
+                     WasmBytesArg(raw_request.auction_signals()));
+    shared_input.Set(ArgIndex(GenerateBidArgs::kBuyerSignals),
+                     WasmBytesArg(raw_request.buyer_signals()));
+    return shared_input;
+  }
+  shared_input.Set(ArgIndex(GenerateBidArgs::kAuctionSignals),
+                   std::make_shared<std::string>(
+                       (raw_request.auction_signals().empty())
+                           ? "\"\""
+                           : raw_request.auction_signals()));
+  shared_input.Set(ArgIndex(GenerateBidArgs::kBuyerSignals),
+                   std::make_shared<std::string>(
+                       (raw_request.buyer_signals().empty())
+                           ? "\"\""
+                           : raw_request.buyer_signals()));
+  shared_input.Set(ArgIndex(GenerateBidArgs::kFeatureFlags),
+                   std::make_shared<std::string>(GetFeatureFlagJson(
+                       enable_adtech_code_logging,
+                       enable_buyer_debug_url_generation &&
+                           raw_request.enable_debug_reporting(),
+                       enable_udf_profiling)));
+  return shared_input;
 }
 
 // Builds a Dispatch Request for the ROMA Engine for a single Interest Group.
+// Arguments shared by the whole batch are left empty and bound later by the
+// dispatcher from the BatchSharedInput. The arguments are bytes for the WASM
+// generateBid if `wasm_device_signals` are set.
 absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
     IGForBidding& interest_group, const RawRequest& raw_request,
-    const std::vector<std::shared_ptr<std::string>>& base_input,
     const TrustedBiddingSignalsByIg& ig_trusted_signals_map,
-    const bool enable_buyer_debug_url_generation,
-    server_common::log::ContextImpl& log_context,
-    const bool enable_adtech_code_logging, const std::string& version) {
+    const std::string& version, absl::string_view handler_name,
+    const std::shared_ptr<std::string>& wasm_device_signals) {
   // Construct the wrapper struct for our V8 Dispatch Request.
   DispatchRequest generate_bid_request;
   generate_bid_request.id = interest_group.name();
   // TODO(b/258790164) Update after code is fetched periodically.
   generate_bid_request.version_string = version;
-  // Copy base input and amend with custom interest_group
-  generate_bid_request.input = base_input;
+  generate_bid_request.input =
+      std::vector<std::shared_ptr<std::string>>(kArgsSizeWithWrapper);
 
   // IG must have trusted bidding signals to participate in Bidding.
   const auto& trusted_bidding_signals_itr =
@@ -314,6 +249,27 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
         "signals to generate bids.");
   }
 
+  // Only add parsed keys.
+  interest_group.clear_trusted_bidding_signals_keys();
+  interest_group.mutable_trusted_bidding_signals_keys()->Add(
+      trusted_bidding_signals_itr->second.value().keys.begin(),
+      trusted_bidding_signals_itr->second.value().keys.end());
+
+  if (wasm_device_signals != nullptr) {
+    generate_bid_request
+        .input[ArgIndex(GenerateBidArgs::kTrustedBiddingSignals)] =
+        WasmBytesArg(*trusted_bidding_signals_itr->second.value().json);
+    // The module reads the browser or android signals off the interest group.
+    generate_bid_request.input[ArgIndex(GenerateBidArgs::kDeviceSignals)] =
+        wasm_device_signals;
+    generate_bid_request.handler_name = kGenerateBidWasmEntryFunctionName;
+    generate_bid_request.input[ArgIndex(GenerateBidArgs::kInterestGroup)] =
+        WasmBytesArg(interest_group.SerializeAsString());
+    // The module takes no feature flags.
+    generate_bid_request.input.resize(ArgIndex(GenerateBidArgs::kFeatureFlags));
+    return generate_bid_request;
+  }
+
   generate_bid_request
       .input[ArgIndex(GenerateBidArgs::kTrustedBiddingSignals)] =
       trusted_bidding_signals_itr->second.value().json;
@@ -325,7 +281,7 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
       !differencer.Equals(BrowserSignals::default_instance(),
                           interest_group.browser_signals())) {
     generate_bid_request.input[ArgIndex(GenerateBidArgs::kDeviceSignals)] =
-        std::make_shared<std::string>(MakeBrowserSignalsForScript(
+        std::make_shared<std::string>(BrowserSignalsToJson(
             raw_request.publisher_name(), raw_request.seller(),
             raw_request.top_level_seller(), interest_group.browser_signals()));
   } else if (interest_group.has_android_signals() &&
@@ -342,39 +298,9 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
     generate_bid_request.input[ArgIndex(GenerateBidArgs::kDeviceSignals)] =
         std::make_shared<std::string>(kEmptyDeviceSignals);
   }
-  generate_bid_request.input[ArgIndex(GenerateBidArgs::kFeatureFlags)] =
-      std::make_shared<std::string>(
-          GetFeatureFlagJson(enable_adtech_code_logging,
-                             enable_buyer_debug_url_generation &&
-                                 raw_request.enable_debug_reporting()));
-  generate_bid_request.handler_name =
-      kDispatchHandlerFunctionNameWithCodeWrapper;
-
-  // Only add parsed keys.
-  interest_group.clear_trusted_bidding_signals_keys();
-  interest_group.mutable_trusted_bidding_signals_keys()->Add(
-      trusted_bidding_signals_itr->second.value().keys.begin(),
-      trusted_bidding_signals_itr->second.value().keys.end());
-  auto start_parse_time = absl::Now();
-  auto serialized_ig = SerializeIG(interest_group);
-  if (!serialized_ig.ok()) {
-    return serialized_ig.status();
-  }
+  generate_bid_request.handler_name = handler_name;
   generate_bid_request.input[ArgIndex(GenerateBidArgs::kInterestGroup)] =
-      std::make_shared<std::string>(std::move(serialized_ig.value()));
-  PS_VLOG(kStats, log_context)
-      << "\nInterest Group Serialize Time: "
-      << ToInt64Microseconds((absl::Now() - start_parse_time))
-      << " microseconds for "
-      << generate_bid_request.input[ArgIndex(GenerateBidArgs::kInterestGroup)]
-             ->size()
-      << " bytes.";
-  if (server_common::log::PS_VLOG_IS_ON(10)) {
-    PS_VLOG(10, log_context) << "\n\nGenerateBid Input Args:";
-    for (const auto& it : generate_bid_request.input) {
-      PS_VLOG(10, log_context) << *it;
-    }
-  }
+      std::make_shared<std::string>(InterestGroupToJson(interest_group));
   return generate_bid_request;
 }
 
@@ -429,25 +355,54 @@ GenerateBidsReactor::GenerateBidsReactor(
       auction_scope_(raw_request_.top_level_seller().empty()
                          ? AuctionScope::kSingleSeller
                          : AuctionScope::kDeviceComponentSeller),
+      version_splitter_(
+          runtime_config.protected_auction_generate_bid_version_splitter.get()),
+      // Requests of the same generation id run the same version.
       protected_auction_generate_bid_version_(
-          runtime_config.default_protected_auction_generate_bid_version) {
-  CHECK_OK([this]() {
-    PS_ASSIGN_OR_RETURN(metric_context_,
-                        metric::BiddingContextMap()->Remove(request_));
-    if (log_context_.is_consented()) {
-      metric_context_->SetConsented(raw_request_.log_context().generation_id());
-    }
-    return absl::OkStatus();
-  }()) << "BiddingContextMap()->Get(request) should have been called";
+          version_splitter_ == nullptr
+              ? runtime_config.default_protected_auction_generate_bid_version
+              : version_splitter_->PickVersion(
+                    raw_request_.log_context().generation_id())),
+      roma_batch_deadline_(
+          absl::Milliseconds(runtime_config.roma_batch_deadline_ms)),
+      deduplicate_generate_bids_(runtime_config.deduplicate_generate_bids),
+      generate_bid_ignores_interest_group_name_(
+          runtime_config.generate_bid_ignores_interest_group_name),
+      // Outputs logging console messages are specific to their request.
+      generate_bid_cache_(enable_adtech_code_logging_
+                              ? nullptr
+                              : runtime_config.generate_bid_cache.get()),
+      run_batch_inference_(runtime_config.run_batch_inference),
+      generate_bid_wasm_(runtime_config.generate_bid_wasm),
+      generate_bids_max_chunk_size_(
+          runtime_config.generate_bids_max_chunk_size),
+      num_js_workers_(runtime_config.num_js_workers),
+      // Requests without logs nor debug URLs skip their instrumentation.
+      lite_generate_bid_(!enable_adtech_code_logging_ &&
+                         (!enable_buyer_debug_url_generation_ ||
+                          !raw_request_.enable_debug_reporting())) {
+  metric_context_ = metric::CreateMetricContext<GenerateBidsRequest>();
+  LogCommonMetric(request_, response_, *metric_context_);
+  if (log_context_.is_consented()) {
+    metric_context_->SetConsented(raw_request_.log_context().generation_id());
+  }
 }
 
 void GenerateBidsReactor::Execute() {
   benchmarking_logger_->BuildInputBegin();
 
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted GenerateBidsRequest:\n"
-                                    << request_->ShortDebugString();
-  PS_VLOG(kPlain, log_context_) << "GenerateBidsRawRequest:\n"
-                                << raw_request_.ShortDebugString();
+  // Interest groups sent in columns are read as if sent one by one.
+  if (absl::Status status = DecodeInterestGroupColumns(raw_request_);
+      !status.ok()) {
+    PS_LOG(ERROR, log_context_)
+        << "Request failed while reading interest group columns: " << status;
+    EncryptResponseAndFinish(server_common::FromAbslStatus(status));
+    return;
+  }
+
+  debug_log_.AddMessage(kEncrypted, "Encrypted GenerateBidsRequest:\n",
+                        *request_);
+  debug_log_.AddMessage(kPlain, "GenerateBidsRawRequest:\n", raw_request_);
 
   auto interest_groups = raw_request_.interest_group_for_bidding();
 
@@ -464,54 +419,323 @@ void GenerateBidsReactor::Execute() {
     return;
   }
 
-  // Build base input.
-  std::vector<std::shared_ptr<std::string>> base_input =
-      BuildBaseInput(raw_request_);
+  // Build the input shared by all interest groups.
+  // The UDFs of consented requests are profiled, the profiles being logged
+  // with their ad tech code logs.
+  shared_input_ = BuildSharedInput(
+      raw_request_, enable_buyer_debug_url_generation_,
+      enable_adtech_code_logging_,
+      /*enable_udf_profiling=*/enable_adtech_code_logging_ &&
+          log_context_.is_consented(),
+      generate_bid_wasm_);
+  // Tags and metadata are the same for every interest group, so they are
+  // bound from the shared input instead of being built per request.
+  if (!SetRomaTimeout()) {
+    return;
+  }
+  shared_input_.SetMetadata(roma_request_context_factory_.Create());
+  dispatch_requests_.reserve(interest_groups.size());
+  // Executed interest group, by its serialized generateBid inputs.
+  absl::flat_hash_map<std::string, std::string> executed_igs;
+  const std::shared_ptr<const std::string> shared_inputs =
+      generate_bid_cache_ == nullptr
+          ? nullptr
+          : std::make_shared<const std::string>(
+                SerializeSharedInput(shared_input_));
+  std::vector<DispatchResponse> cached_responses;
+  const std::shared_ptr<std::string> wasm_device_signals =
+      generate_bid_wasm_ ? BuildWasmDeviceSignals(raw_request_) : nullptr;
+  const absl::string_view handler_name =
+      lite_generate_bid_ ? kLiteDispatchHandlerFunctionName
+                         : kDispatchHandlerFunctionNameWithCodeWrapper;
+  // The requests of large batches are built in chunks over the executor, then
+  // merged in order, so that duplicates are resolved as if built one by one.
+  std::vector<absl::StatusOr<DispatchRequest>> generate_bid_requests(
+      interest_groups.size());
+  std::vector<std::string> ig_inputs(
+      deduplicate_generate_bids_ ? interest_groups.size() : 0);
+  CycleTimer build_timer;
+  ParallelForChunks(
+      dispatcher_.executor(), interest_groups.size(), kBuildInputChunkSize,
+      [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          generate_bid_requests[i] = BuildGenerateBidRequest(
+              *interest_groups.Mutable(i), raw_request_,
+              ig_trusted_signals_map.value(),
+              protected_auction_generate_bid_version_, handler_name,
+              wasm_device_signals);
+          if (deduplicate_generate_bids_ && generate_bid_requests[i].ok()) {
+            ig_inputs[i] = SerializeGenerateBidInputs(
+                *interest_groups.Mutable(i), *generate_bid_requests[i],
+                generate_bid_ignores_interest_group_name_);
+          }
+        }
+      });
+  // The requests are only logged once merged, from this thread.
+  const absl::Duration build_time = build_timer.Elapsed();
+  size_t ig_bytes = 0;
   for (int i = 0; i < interest_groups.size(); i++) {
-    absl::StatusOr<DispatchRequest> generate_bid_request =
-        BuildGenerateBidRequest(interest_groups.at(i), raw_request_, base_input,
-                                ig_trusted_signals_map.value(),
-                                enable_buyer_debug_url_generation_,
-                                log_context_, enable_adtech_code_logging_,
-                                protected_auction_generate_bid_version_);
+    absl::StatusOr<DispatchRequest>& generate_bid_request =
+        generate_bid_requests[i];
     if (!generate_bid_request.ok()) {
       PS_VLOG(kNoisyWarn, log_context_)
           << "Unable to build GenerateBidRequest: "
           << generate_bid_request.status().ToString(
                  absl::StatusToStringMode::kWithEverything);
-    } else {
-      auto dispatch_request = generate_bid_request.value();
-      dispatch_request.tags[kTimeoutMs] = roma_timeout_ms_;
-      dispatch_request.metadata = roma_request_context_factory_.Create();
-      dispatch_requests_.push_back(dispatch_request);
+      continue;
+    }
+    ig_bytes +=
+        generate_bid_request->input[ArgIndex(GenerateBidArgs::kInterestGroup)]
+            ->size();
+    if (server_common::log::PS_VLOG_IS_ON(10)) {
+      PS_VLOG(10, log_context_) << "\n\nGenerateBid Input Args:";
+      for (const auto& it : generate_bid_request->input) {
+        if (it != nullptr) {
+          PS_VLOG(10, log_context_) << *it;
+        }
+      }
+    }
+    if (deduplicate_generate_bids_) {
+      auto [it, inserted] = executed_igs.try_emplace(
+          std::move(ig_inputs[i]), generate_bid_request->id);
+      if (!inserted) {
+        duplicate_igs_[it->second].push_back(generate_bid_request->id);
+        ++num_duplicate_igs_;
+        continue;
+      }
+      if (generate_bid_cache_ != nullptr) {
+        GenerateBidInputs inputs = {.shared = shared_inputs,
+                                    .interest_group = it->first};
+        if (std::optional<std::string> output =
+                generate_bid_cache_->Get(inputs);
+            output.has_value()) {
+          cached_responses.push_back(
+              {.id = generate_bid_request->id, .resp = *std::move(output)});
+          continue;
+        }
+        cache_inputs_[generate_bid_request->id] = std::move(inputs);
+      }
+    }
+    dispatch_requests_.push_back(*std::move(generate_bid_request));
+  }
+  PS_VLOG(kStats, log_context_)
+      << "\nInterest Groups Build Time: " << ToInt64Microseconds(build_time)
+      << " microseconds for " << interest_groups.size()
+      << " interest groups, serialized into " << ig_bytes << " bytes.";
+
+  // Bids served from the cache are added before the others are dispatched.
+  if (!cached_responses.empty()) {
+    PS_VLOG(kStats, log_context_)
+        << "Bids of " << cached_responses.size()
+        << " interest groups served from the cache";
+    num_cached_bids_ = cached_responses.size();
+    for (const DispatchResponse& response : cached_responses) {
+      HandleBids(response);
     }
   }
 
   if (dispatch_requests_.empty()) {
+    if (num_cached_bids_ > 0) {
+      benchmarking_logger_->HandleResponseBegin();
+      FinishGenerateBids();
+    }
     EncryptResponseAndFinish(grpc::Status::OK);
     return;
   }
 
   benchmarking_logger_->BuildInputEnd();
-  absl::Time start_js_execution_time = absl::Now();
-  auto status = dispatcher_.BatchExecute(
-      dispatch_requests_,
-      [this, start_js_execution_time](
-          const std::vector<absl::StatusOr<DispatchResponse>>& result) {
-        int js_execution_time_ms =
-            (absl::Now() - start_js_execution_time) / absl::Milliseconds(1);
-        LogIfError(metric_context_->LogHistogram<metric::kJSExecutionDuration>(
-            js_execution_time_ms));
-        GenerateBidsCallback(result);
-        EncryptResponseAndFinish(grpc::Status::OK);
+  if (run_batch_inference_) {
+    PrepareInferenceInputs();
+    return;
+  }
+  DispatchGenerateBids();
+}
+
+bool GenerateBidsReactor::SetRomaTimeout() {
+  absl::StatusOr<std::string> roma_timeout_ms = RomaTimeoutMs(roma_timeout_ms_);
+  if (!roma_timeout_ms.ok()) {
+    PS_LOG(ERROR, log_context_)
+        << "Skipping generateBid: " << roma_timeout_ms.status();
+    EncryptResponseAndFinish(
+        server_common::FromAbslStatus(roma_timeout_ms.status()));
+    return false;
+  }
+  SetRomaDeadline(*roma_timeout_ms);
+  shared_input_.SetTag(kTimeoutMs, *std::move(roma_timeout_ms));
+  return true;
+}
+
+void GenerateBidsReactor::PrepareInferenceInputs() {
+  prepare_inference_requests_ = dispatch_requests_;
+  for (DispatchRequest& request : prepare_inference_requests_) {
+    request.handler_name = kPrepareInferenceInputsEntryFunctionName;
+  }
+  absl::Status status = dispatcher_.BatchExecute(
+      prepare_inference_requests_, shared_input_,
+      [this](const std::vector<absl::StatusOr<DispatchResponse>>& result) {
+        // The batch inference blocks until its response, so it runs on the
+        // executor rather than on the Roma worker returning the result.
+        auto run_inference = [this, result]() {
+          RunBatchInference(result);
+          // The inference used up some of the time left to the call.
+          if (SetRomaTimeout()) {
+            DispatchGenerateBids();
+          }
+        };
+        if (server_common::Executor* executor = dispatcher_.executor();
+            executor != nullptr) {
+          executor->Run(std::move(run_inference));
+        } else {
+          run_inference();
+        }
       });
+  if (!status.ok()) {
+    // generateBid still runs, and may run the inference of its interest
+    // group itself.
+    PS_LOG(ERROR, log_context_)
+        << "Execution request failed for prepareInferenceInputs: " << status;
+    DispatchGenerateBids();
+  }
+}
+
+void GenerateBidsReactor::RunBatchInference(
+    const std::vector<absl::StatusOr<DispatchResponse>>& output) {
+  absl::flat_hash_map<absl::string_view, int> request_indices;
+  for (int i = 0; i < dispatch_requests_.size(); ++i) {
+    request_indices[dispatch_requests_[i].id] = i;
+  }
+  std::vector<std::string> inference_inputs(dispatch_requests_.size());
+  for (const absl::StatusOr<DispatchResponse>& result : output) {
+    if (!result.ok()) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "prepareInferenceInputs failed: " << result.status();
+      continue;
+    }
+    auto it = request_indices.find(result->id);
+    if (it == request_indices.end()) {
+      continue;
+    }
+    absl::StatusOr<std::string> inference_input = ParseAndGetResponseJson(
+        enable_adtech_code_logging_, result->resp, log_context_);
+    if (inference_input.ok()) {
+      inference_inputs[it->second] = *std::move(inference_input);
+    }
+  }
+  const MergedInferenceRequest merged =
+      MergeInferenceRequests(inference_inputs);
+  if (std::all_of(merged.num_model_requests.begin(),
+                  merged.num_model_requests.end(),
+                  [](int num_model_requests) {
+                    return num_model_requests == 0;
+                  })) {
+    return;
+  }
+  // Leaves generateBid its share of the time left to the call.
+  absl::StatusOr<std::string> response =
+      run_batch_inference_(merged.request, deadline_ - kRomaDeadlineMargin);
+  if (!response.ok()) {
+    PS_LOG(ERROR, log_context_) << "Batch inference failed: "
+                                << response.status();
+    return;
+  }
+  absl::StatusOr<std::vector<std::optional<std::string>>> outputs =
+      SplitInferenceResponse(*response, merged.num_model_requests);
+  if (!outputs.ok()) {
+    PS_LOG(ERROR, log_context_) << "Invalid batch inference response: "
+                                << outputs.status();
+    return;
+  }
+  constexpr int kInferenceOutputsIndex =
+      ArgIndex(GenerateBidArgs::kInferenceOutputs);
+  for (int i = 0; i < dispatch_requests_.size(); ++i) {
+    std::optional<std::string>& ig_outputs = (*outputs)[i];
+    if (!ig_outputs.has_value()) {
+      continue;
+    }
+    dispatch_requests_[i].input.resize(kInferenceOutputsIndex + 1);
+    dispatch_requests_[i].input[kInferenceOutputsIndex] =
+        std::make_shared<std::string>(*std::move(ig_outputs));
+  }
+}
+
+void GenerateBidsReactor::MayBuildGenerateBidsChunks() {
+  // The WASM module has no batch entry function.
+  if (generate_bid_wasm_) {
+    return;
+  }
+  const int num_igs = dispatch_requests_.size();
+  int chunk_size = generate_bids_max_chunk_size_;
+  if (num_js_workers_ > 0) {
+    // Smaller chunks are spread over more workers.
+    chunk_size =
+        std::min(chunk_size, (num_igs + num_js_workers_ - 1) / num_js_workers_);
+  }
+  if (chunk_size <= 1) {
+    return;
+  }
+  constexpr int kPerIgArgs[] = {
+      ArgIndex(GenerateBidArgs::kInterestGroup),
+      ArgIndex(GenerateBidArgs::kTrustedBiddingSignals),
+      ArgIndex(GenerateBidArgs::kDeviceSignals),
+      ArgIndex(GenerateBidArgs::kInferenceOutputs)};
+  generate_bids_chunk_size_ = chunk_size;
+  const absl::Span<const DispatchRequest> requests(dispatch_requests_);
+  generate_bids_chunks_.reserve((num_igs + chunk_size - 1) / chunk_size);
+  for (int begin = 0; begin < num_igs; begin += chunk_size) {
+    generate_bids_chunks_.push_back(BuildGenerateBidsChunkRequest(
+        requests.subspan(begin, chunk_size), kPerIgArgs));
+  }
+}
+
+void GenerateBidsReactor::DispatchGenerateBids() {
+  MayBuildGenerateBidsChunks();
+  std::vector<DispatchRequest>& batch = generate_bids_chunks_.empty()
+                                            ? dispatch_requests_
+                                            : generate_bids_chunks_;
+  CycleTimer js_execution_timer;
+  roma_execution_timer_.emplace(absl::Now());
+  phase_tracer_.Start(RequestPhase::kRomaDispatch);
+  absl::Status status;
+  if (roma_batch_deadline_ > absl::ZeroDuration()) {
+    // Bids are handled as their interest group finishes, and the batch ends
+    // at the deadline with the bids received by then.
+    benchmarking_logger_->HandleResponseBegin();
+    status = dispatcher_.BatchExecuteStreaming(
+        batch, shared_input_,
+        [this](int index, absl::StatusOr<DispatchResponse> response) {
+          roma_execution_timer_->AddResponse(response);
+          HandleDispatchResponse(index, response);
+        },
+        [this, js_execution_timer](bool deadline_exceeded) {
+          if (deadline_exceeded) {
+            PS_VLOG(kNoisyWarn, log_context_)
+                << "Batch deadline reached with "
+                << dispatch_requests_.size() - num_bid_responses_
+                << " interest groups still running";
+          }
+          RecordJsExecution(
+              js_execution_timer.Elapsed() / absl::Milliseconds(1),
+              dispatch_requests_.size());
+          FinishGenerateBids();
+          EncryptResponseAndFinish(grpc::Status::OK);
+        },
+        roma_batch_deadline_);
+  } else {
+    status = dispatcher_.BatchExecute(
+        batch, shared_input_,
+        [this, js_execution_timer](
+            const std::vector<absl::StatusOr<DispatchResponse>>& result) {
+          GenerateBidsCallback(result, js_execution_timer);
+          EncryptResponseAndFinish(grpc::Status::OK);
+        });
+  }
 
   if (!status.ok()) {
     LogIfError(metric_context_
                    ->AccumulateMetric<metric::kBiddingErrorCountByErrorCode>(
                        1, metric::kBiddingGenerateBidsFailedToDispatchCode));
     PS_LOG(ERROR, log_context_)
-        << "Execution request failed for batch: " << raw_request_.DebugString()
+        << "Execution request failed for batch: "
         << status.ToString(absl::StatusToStringMode::kWithEverything);
     LogIfError(
         metric_context_->LogUpDownCounter<metric::kJSExecutionErrorCount>(1));
@@ -525,31 +749,107 @@ void GenerateBidsReactor::Execute() {
 // conforming to the generateBid function output described here:
 // https://github.com/WICG/turtledove/blob/main/FLEDGE.md#32-on-device-bidding
 void GenerateBidsReactor::GenerateBidsCallback(
-    const std::vector<absl::StatusOr<DispatchResponse>>& output) {
-  if (server_common::log::PS_VLOG_IS_ON(2)) {
-    for (const auto& dispatch_response : output) {
-      PS_VLOG(kDispatch, log_context_)
-          << "Generate Bids V8 Response: " << dispatch_response.status();
-      if (dispatch_response.ok()) {
-        PS_VLOG(kDispatch, log_context_) << dispatch_response.value().resp;
-      }
+    const std::vector<absl::StatusOr<DispatchResponse>>& output,
+    const CycleTimer& js_execution_timer) {
+  int js_execution_time_ms =
+      js_execution_timer.Elapsed() / absl::Milliseconds(1);
+  roma_execution_timer_->AddBatch(output);
+  benchmarking_logger_->HandleResponseBegin();
+  for (int index = 0; index < output.size(); ++index) {
+    HandleDispatchResponse(index, output[index]);
+  }
+  RecordJsExecution(js_execution_time_ms, dispatch_requests_.size());
+  FinishGenerateBids();
+}
+
+void GenerateBidsReactor::HandleDispatchResponse(
+    int index, const absl::StatusOr<DispatchResponse>& result) {
+  if (generate_bids_chunks_.empty()) {
+    HandleGenerateBidResponse(result);
+    return;
+  }
+  const int begin = index * generate_bids_chunk_size_;
+  const int end = std::min<int>(begin + generate_bids_chunk_size_,
+                                dispatch_requests_.size());
+  absl::StatusOr<std::vector<std::string>> outputs =
+      result.ok() ? SplitGenerateBidsChunkResponse(result->resp, end - begin)
+                  : result.status();
+  for (int i = begin; i < end; ++i) {
+    if (!outputs.ok()) {
+      HandleGenerateBidResponse(outputs.status());
+      continue;
     }
+    DispatchResponse response;
+    response.id = dispatch_requests_[i].id;
+    response.resp = std::move((*outputs)[i - begin]);
+    HandleGenerateBidResponse(response);
   }
-  benchmarking_logger_->HandleResponseBegin();
-  int total_bid_count = static_cast<int>(output.size());
-  int zero_bid_count = 0;
-  LogIfError(metric_context_->AccumulateMetric<metric::kBiddingTotalBidsCount>(
-      total_bid_count));
-  int failed_requests = 0;
-  long current_all_debug_urls_chars = 0;
-  for (int i = 0; i < output.size(); i++) {
-    auto& result = output.at(i);
-    bool is_bid_zero = true;
+}
+
+void GenerateBidsReactor::HandleGenerateBidResponse(
+    const absl::StatusOr<DispatchResponse>& result) {
+  if (server_common::log::PS_VLOG_IS_ON(2)) {
+    PS_VLOG(kDispatch, log_context_)
+        << "Generate Bids V8 Response: " << result.status();
     if (result.ok()) {
-      AdWithBid bid;
+      PS_VLOG(kDispatch, log_context_) << result->resp;
+    }
+  }
+  ++num_bid_responses_;
+  if (!result.ok()) {
+    ++num_failed_bid_responses_;
+  } else if (auto it = cache_inputs_.find(result->id);
+             it != cache_inputs_.end()) {
+    generate_bid_cache_->Put(std::move(it->second), result->resp);
+  }
+  HandleBids(result);
+}
+
+void GenerateBidsReactor::HandleBids(
+    const absl::StatusOr<DispatchResponse>& result) {
+  HandleBid(result);
+  if (!result.ok()) {
+    return;
+  }
+  auto it = duplicate_igs_.find(result->id);
+  if (it == duplicate_igs_.end()) {
+    return;
+  }
+  // Interest groups sharing the inputs get the same bid under their name.
+  for (const std::string& interest_group_name : it->second) {
+    DispatchResponse response = *result;
+    response.id = interest_group_name;
+    HandleBid(response);
+  }
+}
+
+void GenerateBidsReactor::HandleBid(
+    const absl::StatusOr<DispatchResponse>& result) {
+  ++num_handled_bids_;
+  bool is_bid_zero = true;
+  if (result.ok()) {
+    AdWithBid bid;
+    absl::Status valid;
+    if (generate_bid_wasm_) {
+      valid = ParseWasmBid(result->resp, bid);
+      // The JS wrapper only reports the debug URLs if enabled.
+      if (!enable_buyer_debug_url_generation_ ||
+          !raw_request_.enable_debug_reporting()) {
+        bid.clear_debug_report_urls();
+      }
+    } else if (lite_generate_bid_) {
+      // The output is the bid itself, without logs.
+      google::protobuf::json::ParseOptions parse_options;
+      parse_options.ignore_unknown_fields = true;
+      valid = google::protobuf::util::JsonStringToMessage(result->resp, &bid,
+                                                          parse_options);
+    } else {
       absl::StatusOr<std::string> generate_bid_response =
           ParseAndGetResponseJson(enable_adtech_code_logging_, result->resp,
-                                  log_context_);
+                                  log_context_, &json_arena_);
+      // The document is gone once serialized, its memory is reused for the
+      // next response.
+      json_arena_.Clear();
       if (!generate_bid_response.ok()) {
         PS_LOG(ERROR, log_context_)
             << "Failed to parse response from Roma "
@@ -558,68 +858,104 @@ void GenerateBidsReactor::GenerateBidsCallback(
       }
       google::protobuf::json::ParseOptions parse_options;
       parse_options.ignore_unknown_fields = true;
-      auto valid = google::protobuf::util::JsonStringToMessage(
-          generate_bid_response.value(), &bid, parse_options);
-      const std::string interest_group_name = result->id;
-      if (valid.ok()) {
-        if (current_all_debug_urls_chars >=
-            max_allowed_size_all_debug_urls_chars_) {
-          bid.clear_debug_report_urls();
-        } else {
-          current_all_debug_urls_chars +=
-              SetAndReturnDebugUrlSize(&bid, max_allowed_size_debug_url_chars_,
-                                       max_allowed_size_all_debug_urls_chars_,
-                                       current_all_debug_urls_chars);
-        }
-        if (!IsValidBid(bid)) {
-          PS_VLOG(kNoisyWarn, log_context_)
-              << "Skipping 0 bid for " << interest_group_name << ": "
-              << bid.DebugString();
-        } else if (
-            // If this is a component auction and bid is not allowed, skip it.
-            auction_scope_ == AuctionScope::kDeviceComponentSeller &&
-            !bid.allow_component_auction()) {
-          // TODO(b/311234165): Add metric for rejected component ads.
-          PS_LOG(ERROR, log_context_)
-              << "Skipping component bid as it is not allowed for "
-              << interest_group_name << ": " << bid.DebugString();
-        } else {
-          bid.set_interest_group_name(interest_group_name);
-          *raw_response_.add_bids() = std::move(bid);
-          is_bid_zero = false;
-        }
+      valid = generate_bid_response.ok()
+                  ? google::protobuf::util::JsonStringToMessage(
+                        *generate_bid_response, &bid, parse_options)
+                  : generate_bid_response.status();
+    }
+    const std::string interest_group_name = result->id;
+    if (valid.ok()) {
+      if (current_all_debug_urls_chars_ >=
+          max_allowed_size_all_debug_urls_chars_) {
+        bid.clear_debug_report_urls();
       } else {
+        current_all_debug_urls_chars_ +=
+            SetAndReturnDebugUrlSize(&bid, max_allowed_size_debug_url_chars_,
+                                     max_allowed_size_all_debug_urls_chars_,
+                                     current_all_debug_urls_chars_);
+      }
+      if (!IsValidBid(bid)) {
+        PS_VLOG(kNoisyWarn, log_context_)
+            << "Skipping 0 bid for " << interest_group_name << ": "
+            << bid.DebugString();
+      } else if (
+          // If this is a component auction and bid is not allowed, skip it.
+          auction_scope_ == AuctionScope::kDeviceComponentSeller &&
+          !bid.allow_component_auction()) {
+        // TODO(b/311234165): Add metric for rejected component ads.
         PS_LOG(ERROR, log_context_)
-            << "Invalid json output from code execution for interest_group "
-            << interest_group_name << ": " << result->resp;
+            << "Skipping component bid as it is not allowed for "
+            << interest_group_name << ": " << bid.DebugString();
+      } else {
+        bid.set_interest_group_name(interest_group_name);
+        *raw_response_.add_bids() = std::move(bid);
+        is_bid_zero = false;
       }
     } else {
-      failed_requests = failed_requests + 1;
-      LogIfError(metric_context_
-                     ->AccumulateMetric<metric::kBiddingErrorCountByErrorCode>(
-                         1, metric::kBiddingGenerateBidsDispatchResponseError));
       PS_LOG(ERROR, log_context_)
-          << "Invalid execution (possibly invalid input): "
-          << result.status().ToString(
-                 absl::StatusToStringMode::kWithEverything);
-    }
-    if (is_bid_zero) {
-      zero_bid_count += 1;
-      LogIfError(
-          metric_context_->AccumulateMetric<metric::kBiddingZeroBidCount>(1));
+          << "Invalid json output from code execution for interest_group "
+          << interest_group_name << ": " << result->resp;
     }
+  } else {
+    LogIfError(metric_context_
+                   ->AccumulateMetric<metric::kBiddingErrorCountByErrorCode>(
+                       1, metric::kBiddingGenerateBidsDispatchResponseError));
+    PS_LOG(ERROR, log_context_)
+        << "Invalid execution (possibly invalid input): "
+        << result.status().ToString(
+               absl::StatusToStringMode::kWithEverything);
+  }
+  if (is_bid_zero) {
+    ++num_zero_bids_;
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kBiddingZeroBidCount>(1));
   }
+}
+
+void GenerateBidsReactor::RecordJsExecution(int js_execution_time_ms,
+                                            int num_executions) {
+  phase_tracer_.End(RequestPhase::kRomaDispatch);
+  LogIfError(metric_context_->LogHistogram<metric::kJSExecutionDuration>(
+      js_execution_time_ms));
+  if (roma_execution_timer_.has_value()) {
+    metric::LogJSExecutionSplit(roma_execution_timer_->queue_waits(),
+                                roma_execution_timer_->executions(),
+                                roma_execution_timer_->GetSkew(),
+                                *metric_context_);
+  }
+  if (version_splitter_ != nullptr) {
+    // Interest groups still running at the batch deadline count as failed.
+    version_splitter_->RecordExecutions(
+        protected_auction_generate_bid_version_, js_execution_time_ms,
+        num_executions,
+        num_failed_bid_responses_ + num_executions - num_bid_responses_);
+  }
+}
+
+void GenerateBidsReactor::FinishGenerateBids() {
+  const int total_bid_count =
+      dispatch_requests_.size() + num_cached_bids_ + num_duplicate_igs_;
+  // Interest groups still running at the batch deadline, or sharing the
+  // inputs of a failed execution, bid nothing.
+  const int num_dropped_bids = total_bid_count - num_handled_bids_;
+  if (num_dropped_bids > 0) {
+    num_zero_bids_ += num_dropped_bids;
+    LogIfError(metric_context_->AccumulateMetric<metric::kBiddingZeroBidCount>(
+        num_dropped_bids));
+  }
+  LogIfError(metric_context_->AccumulateMetric<metric::kBiddingTotalBidsCount>(
+      total_bid_count));
   LogIfError(metric_context_->LogHistogram<metric::kBiddingZeroBidPercent>(
-      (static_cast<double>(zero_bid_count)) / total_bid_count));
+      (static_cast<double>(num_zero_bids_)) / total_bid_count));
 
   PS_VLOG(kNoisyInfo, log_context_)
-      << "\n\nFailed of total: " << failed_requests << "/" << output.size();
+      << "\n\nFailed of total: " << num_failed_bid_responses_ << "/"
+      << total_bid_count;
   benchmarking_logger_->HandleResponseEnd();
 }
 
 void GenerateBidsReactor::EncryptResponseAndFinish(grpc::Status status) {
-  PS_VLOG(kPlain, log_context_) << "GenerateBidsRawResponse:\n"
-                                << raw_response_.ShortDebugString();
+  debug_log_.AddMessage(kPlain, "GenerateBidsRawResponse:\n", raw_response_);
 
   if (!EncryptResponse()) {
     PS_LOG(ERROR, log_context_)
@@ -629,11 +965,16 @@ void GenerateBidsReactor::EncryptResponseAndFinish(grpc::Status status) {
   if (status.error_code() != grpc::StatusCode::OK) {
     metric_context_->SetRequestResult(server_common::ToAbslStatus(status));
   }
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted GenerateBidsResponse\n"
-                                    << response_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted GenerateBidsResponse\n",
+                        *response_);
+  metric::LogRequestPhases(phase_tracer_, *metric_context_);
+  trace_.End(status);
   Finish(status);
 }
 
-void GenerateBidsReactor::OnDone() { delete this; }
+void GenerateBidsReactor::OnDone() {
+  debug_log_.Flush();
+  delete this;
+}
 
 }  // namespace privacy_sandbox::bidding_auction_servers
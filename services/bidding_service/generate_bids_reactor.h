@@ -15,21 +15,31 @@
 #ifndef SERVICES_BIDDING_SERVICE_GENERATE_BIDS_REACTOR_H_
 #define SERVICES_BIDDING_SERVICE_GENERATE_BIDS_REACTOR_H_
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/bidding_service/base_generate_bids_reactor.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/data/runtime_config.h"
+#include "services/bidding_service/utils/generate_bid_cache.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/roma_execution_timer.h"
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/util/cycle_clock.h"
+#include "services/common/util/json_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -40,7 +50,9 @@ enum class GenerateBidArgs : int {
   kBuyerSignals,
   kTrustedBiddingSignals,
   kDeviceSignals,
-  kFeatureFlags
+  kFeatureFlags,
+  // Outputs of the batch inference for the interest group, if any.
+  kInferenceOutputs
 };
 
 //  This is a gRPC reactor that serves a single GenerateBidsRequest.
@@ -69,6 +81,25 @@ class GenerateBidsReactor
   // after the response has finished.
   void OnDone() override;
 
+  // Sets the timeout of the executions in the shared input from what is left
+  // of the deadline of the call. Finishes the call and returns false if
+  // nothing is left.
+  bool SetRomaTimeout();
+
+  // Runs prepareInferenceInputs for the interest groups to dispatch, then
+  // their inference in a single request on the executor of the dispatcher,
+  // then dispatches generateBid.
+  void PrepareInferenceInputs();
+
+  // Runs the inference requests returned by prepareInferenceInputs at once
+  // and adds the outputs of each interest group to its dispatch request.
+  // Interest groups get no outputs if the batch inference fails.
+  void RunBatchInference(
+      const std::vector<absl::StatusOr<DispatchResponse>>& output);
+
+  // Dispatches generateBid for the interest groups to execute.
+  void DispatchGenerateBids();
+
   // Asynchronous callback used by the v8 code executor to return a result. This
   // will be called in a different thread owned by the code dispatch library.
   //
@@ -77,7 +108,37 @@ class GenerateBidsReactor
   // interest_group_name: the name of the interest group that issued the
   // code dispatch request.
   void GenerateBidsCallback(
-      const std::vector<absl::StatusOr<DispatchResponse>>& output);
+      const std::vector<absl::StatusOr<DispatchResponse>>& output,
+      const CycleTimer& js_execution_timer);
+
+  // Groups consecutive dispatch requests into chunks of interest groups, each
+  // run by a single generateBid invocation, when enabled and there are enough
+  // interest groups to keep every JS worker busy.
+  void MayBuildGenerateBidsChunks();
+
+  // Handles the response to the dispatch request, or chunk, at `index`.
+  void HandleDispatchResponse(int index,
+                              const absl::StatusOr<DispatchResponse>& result);
+
+  // Handles a generateBid output. Called once per executed interest group, in
+  // completion order when the batch is streamed.
+  void HandleGenerateBidResponse(
+      const absl::StatusOr<DispatchResponse>& result);
+
+  // Adds the bid of a generateBid output to the response for its interest
+  // group and for the interest groups sharing its inputs.
+  void HandleBids(const absl::StatusOr<DispatchResponse>& result);
+
+  // Adds the bid of a generateBid output to the response for its interest
+  // group only.
+  void HandleBid(const absl::StatusOr<DispatchResponse>& result);
+
+  // Logs the JS execution time of the batch, by UDF version if split.
+  void RecordJsExecution(int js_execution_time_ms, int num_executions);
+
+  // Logs the bid metrics once all the responses were handled. Interest groups
+  // without a bid count as zero bids.
+  void FinishGenerateBids();
 
   // Encrypts the response before the GRPC call is finished with the provided
   // status.
@@ -93,8 +154,73 @@ class GenerateBidsReactor
   // parsing of generateBid output.
   AuctionScope auction_scope_;
 
+  // Split of the traffic between the UDF versions, if any.
+  const CodeVersionSplitter* version_splitter_;
+
   // UDF version to use for this request.
   const std::string& protected_auction_generate_bid_version_;
+
+  // Bids still running this long after dispatch are dropped, if positive.
+  absl::Duration roma_batch_deadline_;
+
+  // Splits the JS execution time of the batch, set once it is dispatched.
+  std::optional<RomaExecutionTimer> roma_execution_timer_;
+
+  // Executes the interest groups with the same generateBid inputs once.
+  bool deduplicate_generate_bids_;
+
+  // Whether interest groups differing only by name have the same inputs.
+  bool generate_bid_ignores_interest_group_name_;
+
+  // Cache of generateBid outputs shared across requests, if any.
+  GenerateBidCache* generate_bid_cache_;
+
+  // Runs the inference of all the interest groups at once, if set.
+  std::function<absl::StatusOr<std::string>(absl::string_view, absl::Time)>
+      run_batch_inference_;
+
+  // Whether generateBid is a standalone WASM module taking bytes arguments.
+  const bool generate_bid_wasm_;
+
+  // Most interest groups run by a generateBid invocation, and the number of
+  // JS workers the chunks of interest groups are spread over if known.
+  const int generate_bids_max_chunk_size_;
+  const int num_js_workers_;
+  // Interest groups per chunk and the chunks dispatched, if the interest
+  // groups run in chunks.
+  int generate_bids_chunk_size_ = 1;
+  std::vector<DispatchRequest> generate_bids_chunks_;
+
+  // Whether generateBid runs in the lite entry function of the wrapper, which
+  // returns the bid as is, without logs nor debug URLs.
+  const bool lite_generate_bid_;
+
+  // Inputs shared by the dispatch requests of the batch.
+  BatchSharedInput shared_input_;
+
+  // Requests of the prepareInferenceInputs batch.
+  std::vector<DispatchRequest> prepare_inference_requests_;
+
+  // Names of the interest groups sharing the inputs of an executed interest
+  // group, by name of the executed interest group.
+  absl::flat_hash_map<std::string, std::vector<std::string>> duplicate_igs_;
+  int num_duplicate_igs_ = 0;
+
+  // Inputs of the outputs to cache, by name of the interest group.
+  absl::flat_hash_map<std::string, GenerateBidInputs> cache_inputs_;
+  int num_cached_bids_ = 0;
+
+  // Counts of the handled dispatch responses, and of the handled bids which
+  // include the bids shared with other interest groups or cached.
+  int num_bid_responses_ = 0;
+  int num_failed_bid_responses_ = 0;
+  int num_handled_bids_ = 0;
+  int num_zero_bids_ = 0;
+  long current_all_debug_urls_chars_ = 0;
+
+  // Memory of the documents parsed from the responses. Responses are handled
+  // one at a time, even when streamed.
+  JsonArena json_arena_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
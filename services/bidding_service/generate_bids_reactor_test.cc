@@ -21,21 +21,30 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/benchmarking/bidding_no_op_logger.h"
+#include "services/bidding_service/constants.h"
 #include "services/bidding_service/generate_bids_reactor_test_utils.h"
+#include "services/bidding_service/utils/generate_bid_cache.h"
+#include "services/bidding_service/utils/generate_bids_chunk.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/encryption/mock_crypto_client_wrapper.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/test/mocks.h"
 #include "services/common/test/random.h"
+#include "services/common/util/json_util.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -55,14 +64,34 @@ using Response = GenerateBidsResponse;
 using IGForBidding =
     GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
 
+// Returns what the entry function of `request` returns for `response_json`,
+// the output of the full wrapper: the lite wrapper only returns the bid.
+std::string EntryFunctionOutput(const DispatchRequest& request,
+                                absl::string_view response_json) {
+  if (request.handler_name != kLiteDispatchHandlerFunctionName) {
+    EXPECT_EQ(request.handler_name,
+              kDispatchHandlerFunctionNameWithCodeWrapper);
+    return std::string(response_json);
+  }
+  absl::StatusOr<rapidjson::Document> document =
+      ParseJsonString(response_json);
+  EXPECT_TRUE(document.ok()) << document.status();
+  if (!document.ok() || !document->IsObject() ||
+      !document->HasMember("response")) {
+    return std::string(response_json);
+  }
+  absl::StatusOr<std::string> bid = SerializeJsonDoc((*document)["response"]);
+  EXPECT_TRUE(bid.ok()) << bid.status();
+  return bid.ok() ? *std::move(bid) : std::string(response_json);
+}
+
 absl::Status FakeExecute(std::vector<DispatchRequest>& batch,
                          BatchDispatchDoneCallback batch_callback,
                          absl::string_view response_json) {
   std::vector<absl::StatusOr<DispatchResponse>> responses;
   for (const auto& request : batch) {
-    EXPECT_EQ(request.handler_name, "generateBidEntryFunction");
     DispatchResponse dispatch_response = {};
-    dispatch_response.resp = response_json;
+    dispatch_response.resp = EntryFunctionOutput(request, response_json);
     dispatch_response.id = request.id;
     responses.emplace_back(dispatch_response);
   }
@@ -139,8 +168,7 @@ class GenerateBidsReactorTest : public testing::Test {
     server_common::telemetry::TelemetryConfig config_proto;
     config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
     metric::MetricContextMap<GenerateBidsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request_);
+        server_common::telemetry::BuildDependentConfig(config_proto));
 
     TrustedServersConfigClient config_client({});
     config_client.SetFlagForTest(kTrue, TEST_MODE);
@@ -156,12 +184,18 @@ class GenerateBidsReactorTest : public testing::Test {
                          const Response& expected_response,
                          bool enable_buyer_debug_url_generation = false,
                          bool enable_adtech_code_logging = false) {
+    CheckGenerateBids(
+        raw_request, expected_response,
+        {.enable_buyer_debug_url_generation = enable_buyer_debug_url_generation,
+         .enable_adtech_code_logging = enable_adtech_code_logging});
+  }
+
+  void CheckGenerateBids(const RawRequest& raw_request,
+                         const Response& expected_response,
+                         const BiddingServiceRuntimeConfig& runtime_config) {
     Response response;
     std::unique_ptr<BiddingBenchmarkingLogger> benchmarkingLogger =
         std::make_unique<BiddingNoOpLogger>();
-    BiddingServiceRuntimeConfig runtime_config = {
-        .enable_buyer_debug_url_generation = enable_buyer_debug_url_generation,
-        .enable_adtech_code_logging = enable_adtech_code_logging};
     request_.set_request_ciphertext(raw_request.SerializeAsString());
     GenerateBidsReactor reactor(
         dispatcher_, &request_, &response, std::move(benchmarkingLogger),
@@ -365,6 +399,61 @@ TEST_F(GenerateBidsReactorTest, GenerateBidSuccessfulWithCodeWrapper) {
                     enable_adtech_code_logging);
 }
 
+TEST_F(GenerateBidsReactorTest, UsesLiteWrapperWithoutLoggingOrDebugUrls) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  AdWithBid bid;
+  bid.set_render(kTestRenderUrl);
+  bid.set_bid(1);
+  bid.set_interest_group_name("ig_name_Bar");
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  *raw_response.add_bids() = bid;
+  Response ads;
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+  std::vector<IGForBidding> igs;
+  igs.push_back(GetIGForBiddingBar());
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.handler_name, kLiteDispatchHandlerFunctionName);
+        }
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      })
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.handler_name,
+                    kDispatchHandlerFunctionNameWithCodeWrapper);
+        }
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      });
+  RawRequest raw_request;
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads);
+  CheckGenerateBids(raw_request, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/true);
+}
+
+TEST_F(GenerateBidsReactorTest, SkipsGenerateBidOncePastTheDeadline) {
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo()};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  EXPECT_CALL(dispatcher_, BatchExecute).Times(0);
+  EXPECT_CALL(dispatcher_, BatchExecuteStreaming).Times(0);
+  Response response;
+  GenerateBidsReactor reactor(
+      dispatcher_, &request_, &response, std::make_unique<BiddingNoOpLogger>(),
+      key_fetcher_manager_.get(), crypto_client_.get(), /*runtime_config=*/{});
+  reactor.SetDeadline(absl::Now() - absl::Seconds(1));
+  reactor.Execute();
+}
+
 TEST_F(GenerateBidsReactorTest, BuyerReportingIdSetInResponse) {
   bool enable_debug_reporting = false;
   bool enable_buyer_debug_url_generation = false;
@@ -558,9 +647,8 @@ TEST_F(GenerateBidsReactorTest, FiltersBidsWithZeroBidPrice) {
         EXPECT_EQ(batch.size(), 2);
         for (int i = 0; i < 2; i++) {
           const auto& request = batch[i];
-          EXPECT_EQ(request.handler_name, "generateBidEntryFunction");
           DispatchResponse dispatch_response = {};
-          dispatch_response.resp = json_arr[i];
+          dispatch_response.resp = EntryFunctionOutput(request, json_arr[i]);
           dispatch_response.id = request.id;
           responses.emplace_back(dispatch_response);
         }
@@ -579,6 +667,244 @@ TEST_F(GenerateBidsReactorTest, FiltersBidsWithZeroBidPrice) {
   CheckGenerateBids(raw_request, ads);
 }
 
+TEST_F(GenerateBidsReactorTest, ReturnsBidsStreamedByTheBatchDeadline) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  AdWithBid bid;
+  bid.set_render(kTestRenderUrl);
+  bid.set_bid(1);
+  bid.set_interest_group_name("ig_name_Bar");
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  *raw_response.add_bids() = bid;
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecuteStreaming)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                DispatchResponseCallback response_callback,
+                                BatchStreamDoneCallback done_callback,
+                                absl::Duration deadline) {
+        EXPECT_EQ(batch.size(), 2);
+        EXPECT_EQ(deadline, absl::Milliseconds(50));
+        // Only the first interest group bids before the deadline.
+        DispatchResponse dispatch_response = {};
+        dispatch_response.resp = EntryFunctionOutput(batch[0], response_json);
+        dispatch_response.id = batch[0].id;
+        response_callback(0, dispatch_response);
+        done_callback(/*deadline_exceeded=*/true);
+        return absl::OkStatus();
+      });
+  EXPECT_CALL(dispatcher_, BatchExecute).Times(0);
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  igs.push_back(GetIGForBiddingBar());
+  igs.push_back(GetIGForBiddingFoo());
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads, {.roma_batch_deadline_ms = 50});
+}
+
+TEST_F(GenerateBidsReactorTest, ExecutesInterestGroupsWithTheSameInputsOnce) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  IGForBidding foo = GetIGForBiddingFoo();
+  IGForBidding foo_copy = foo;
+  foo_copy.set_name("ig_name_Foo_copy");
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const IGForBidding& interest_group : {foo, foo_copy}) {
+    AdWithBid* bid = raw_response.add_bids();
+    bid->set_render(kTestRenderUrl);
+    bid->set_bid(1);
+    bid->set_interest_group_name(interest_group.name());
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      });
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {foo, foo_copy};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads,
+                    {.deduplicate_generate_bids = true,
+                     .generate_bid_ignores_interest_group_name = true});
+}
+
+TEST_F(GenerateBidsReactorTest, ExecutesInterestGroupsWithDifferentNames) {
+  IGForBidding foo = GetIGForBiddingFoo();
+  IGForBidding foo_copy = foo;
+  foo_copy.set_name("ig_name_Foo_copy");
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const IGForBidding& interest_group : {foo, foo_copy}) {
+    AdWithBid* bid = raw_response.add_bids();
+    bid->set_render(kTestRenderUrl);
+    bid->set_bid(1);
+    bid->set_interest_group_name(interest_group.name());
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 2);
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      });
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {foo, foo_copy};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads, {.deduplicate_generate_bids = true});
+}
+
+TEST_F(GenerateBidsReactorTest, ReusesCachedBidsAcrossRequests) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  AdWithBid bid;
+  bid.set_render(kTestRenderUrl);
+  bid.set_bid(1);
+  bid.set_interest_group_name("ig_name_Foo");
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  *raw_response.add_bids() = bid;
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      });
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo()};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  BiddingServiceRuntimeConfig runtime_config = {
+      .deduplicate_generate_bids = true,
+      .generate_bid_cache = std::make_shared<GenerateBidCache>(
+          /*capacity=*/10, absl::Minutes(1))};
+  // Only the first request executes generateBid.
+  CheckGenerateBids(raw_request, ads, runtime_config);
+  CheckGenerateBids(raw_request, ads, runtime_config);
+  EXPECT_EQ(runtime_config.generate_bid_cache->size(), 1);
+}
+
+TEST_F(GenerateBidsReactorTest, RunsInferenceOfAllInterestGroupsAtOnce) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  IGForBidding foo = GetIGForBiddingFoo();
+  IGForBidding bar = GetIGForBiddingFoo();
+  bar.set_name("ig_name_Bar");
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const IGForBidding& interest_group : {foo, bar}) {
+    AdWithBid* bid = raw_response.add_bids();
+    bid->set_render(kTestRenderUrl);
+    bid->set_bid(1);
+    bid->set_interest_group_name(interest_group.name());
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  const int inference_outputs_index =
+      ArgIndex(GenerateBidArgs::kInferenceOutputs);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.handler_name,
+                    kPrepareInferenceInputsEntryFunctionName);
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp = absl::Substitute(
+              R"JSON({"response":[{"model_path":"$0"}]})JSON", request.id);
+          responses.emplace_back(dispatch_response);
+        }
+        batch_callback(responses);
+        return absl::OkStatus();
+      })
+      .WillOnce([response_json, inference_outputs_index](
+                    std::vector<DispatchRequest>& batch,
+                    BatchDispatchDoneCallback batch_callback) {
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.input.size(), inference_outputs_index + 1);
+          if (request.input.size() > inference_outputs_index) {
+            EXPECT_EQ(*request.input[inference_outputs_index],
+                      absl::Substitute(R"JSON([{"model_path":"$0"}])JSON",
+                                       request.id));
+          }
+        }
+        return FakeExecute(batch, std::move(batch_callback), response_json);
+      });
+  int num_inference_requests = 0;
+  BiddingServiceRuntimeConfig runtime_config = {
+      .run_batch_inference =
+          [&num_inference_requests](absl::string_view request,
+                                    absl::Time deadline) {
+            ++num_inference_requests;
+            EXPECT_EQ(request,
+                      R"JSON({"request":[{"model_path":"ig_name_Foo"},)JSON"
+                      R"JSON({"model_path":"ig_name_Bar"}]})JSON");
+            return absl::StrCat(R"JSON({"response":)JSON",
+                                request.substr(11));
+          }};
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {foo, bar};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads, runtime_config);
+  EXPECT_EQ(num_inference_requests, 1);
+}
+
+TEST_F(GenerateBidsReactorTest, RunsChunksOfInterestGroupsPerInvocation) {
+  std::string response_json = GetTestResponse(kTestRenderUrl, 1);
+  std::vector<IGForBidding> igs;
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (absl::string_view name : {"ig_name_Foo", "ig_name_Bar", "ig_name_Baz"}) {
+    IGForBidding interest_group = GetIGForBiddingFoo();
+    interest_group.set_name(name);
+    igs.push_back(interest_group);
+    AdWithBid* bid = raw_response.add_bids();
+    bid->set_render(kTestRenderUrl);
+    bid->set_bid(1);
+    bid->set_interest_group_name(name);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([response_json](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        // 3 interest groups in chunks of up to 2 interest groups.
+        EXPECT_EQ(batch.size(), 2);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const DispatchRequest& request : batch) {
+          EXPECT_EQ(request.handler_name, kGenerateBidsBatchEntryFunctionName);
+          const int num_igs = &request == &batch.front() ? 2 : 1;
+          // The auction signals are shared by the interest groups of a chunk.
+          EXPECT_EQ(
+              *request.input[ArgIndex(GenerateBidArgs::kAuctionSignals)],
+              kTestAuctionSignals);
+          const std::vector<std::string> outputs(num_igs, response_json);
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              absl::StrCat("[", absl::StrJoin(outputs, ","), "]");
+          responses.emplace_back(dispatch_response);
+        }
+        batch_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads, {.generate_bids_max_chunk_size = 2});
+}
+
 TEST_F(GenerateBidsReactorTest, CreatesGenerateBidInputsInCorrectOrder) {
   std::string response_json = GetTestResponse(kTestRenderUrl, 1);
 
@@ -973,6 +1299,66 @@ TEST_F(GenerateBidsReactorTest, GenerateBidResponseWithoutDebugUrls) {
   CheckGenerateBids(raw_request, ads, enable_buyer_debug_url_generation);
 }
 
+TEST_F(GenerateBidsReactorTest, PassesBytesToWasmGenerateBid) {
+  AdWithBid wasm_bid;
+  wasm_bid.set_render(kTestRenderUrl);
+  wasm_bid.set_bid(1);
+  // Dropped since debug reporting is not enabled.
+  wasm_bid.mutable_debug_report_urls()->set_auction_debug_win_url(
+      "test.com/debugWin");
+  const std::string response_json =
+      absl::StrCat("\"", absl::Base64Escape(wasm_bid.SerializeAsString()),
+                   "\"");
+
+  AdWithBid bid;
+  bid.set_render(kTestRenderUrl);
+  bid.set_bid(1);
+  bid.set_interest_group_name("ig_name_Foo");
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  *raw_response.add_bids() = bid;
+  Response ads;
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([&response_json](std::vector<DispatchRequest>& batch,
+                                 BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        const DispatchRequest& request = batch[0];
+        EXPECT_EQ(request.handler_name, kGenerateBidWasmEntryFunctionName);
+        EXPECT_EQ(request.input.size(),
+                  ArgIndex(GenerateBidArgs::kFeatureFlags));
+        auto bytes = [&request](GenerateBidArgs arg) {
+          absl::string_view input = *request.input[ArgIndex(arg)];
+          std::string decoded;
+          EXPECT_TRUE(absl::Base64Unescape(
+              input.substr(1, input.size() - 2), &decoded));
+          return decoded;
+        };
+        IGForBidding interest_group;
+        EXPECT_TRUE(interest_group.ParseFromString(
+            bytes(GenerateBidArgs::kInterestGroup)));
+        EXPECT_EQ(interest_group.name(), "ig_name_Foo");
+        EXPECT_EQ(bytes(GenerateBidArgs::kAuctionSignals), kTestAuctionSignals);
+        EXPECT_EQ(bytes(GenerateBidArgs::kBuyerSignals), kTestBuyerSignals);
+        RawRequest device_signals;
+        EXPECT_TRUE(device_signals.ParseFromString(
+            bytes(GenerateBidArgs::kDeviceSignals)));
+        EXPECT_EQ(device_signals.seller(), kSeller);
+        EXPECT_EQ(device_signals.publisher_name(), kPublisherName);
+
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        responses.push_back(
+            DispatchResponse{.id = request.id, .resp = response_json});
+        batch_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo()};
+  BuildRawRequest(igs, kTestAuctionSignals, kTestBuyerSignals,
+                  kTestBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads, {.generate_bid_wasm = true});
+}
+
 TEST_F(GenerateBidsReactorTest, AddsTrustedBiddingSignalsKeysToScriptInput) {
   Response response;
   RawRequest raw_request;
@@ -0,0 +1,175 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/inference_cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "openssl/sha.h"
+#include "services/common/util/json_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr char kRequest[] = "request";
+constexpr char kResponse[] = "response";
+constexpr char kModelPath[] = "model_path";
+constexpr char kError[] = "error";
+
+// Model requests of all instances since the last GetLookupRatios call.
+std::atomic<int64_t> num_hits = 0;
+std::atomic<int64_t> num_misses = 0;
+
+bool IsArrayMember(const rapidjson::Value& value, const char* name) {
+  return value.IsObject() && value.HasMember(name) && value[name].IsArray();
+}
+
+}  // namespace
+
+InferenceCache::InferenceCache(int64_t max_bytes, absl::Duration ttl)
+    : outputs_({.max_weight = max_bytes,
+                .ttl = ttl,
+                .weigher = [](const std::string& key,
+                              const std::string& output) -> int64_t {
+                  return key.size() + output.size();
+                }}) {}
+
+absl::StatusOr<std::string> InferenceCache::Predict(absl::string_view input,
+                                                    PredictFn predict) {
+  rapidjson::Document request;
+  if (request.Parse(input.data(), input.size()).HasParseError() ||
+      !IsArrayMember(request, kRequest)) {
+    // Leaves the malformed request to the sidecar to report.
+    return predict(input);
+  }
+  rapidjson::Value& model_requests = request[kRequest];
+  const int num_requests = model_requests.Size();
+  std::vector<std::string> keys(num_requests);
+  std::vector<std::shared_ptr<const std::string>> outputs(num_requests);
+  rapidjson::Document missed_request(rapidjson::kObjectType,
+                                     &request.GetAllocator());
+  rapidjson::Value missed_model_requests(rapidjson::kArrayType);
+  std::vector<int> missed;
+  for (int i = 0; i < num_requests; ++i) {
+    keys[i] = Key(model_requests[i]);
+    if (!keys[i].empty()) {
+      outputs[i] = outputs_.LookUp(keys[i]);
+    }
+    if (outputs[i] != nullptr) {
+      continue;
+    }
+    missed.push_back(i);
+    missed_model_requests.PushBack(model_requests[i],
+                                   missed_request.GetAllocator());
+  }
+  num_hits.fetch_add(num_requests - missed.size(), std::memory_order_relaxed);
+  num_misses.fetch_add(missed.size(), std::memory_order_relaxed);
+
+  const bool all_missed = static_cast<int>(missed.size()) == num_requests;
+  if (!missed.empty()) {
+    std::string missed_input;
+    if (!all_missed) {
+      missed_request.AddMember(kRequest, missed_model_requests,
+                               missed_request.GetAllocator());
+      PS_ASSIGN_OR_RETURN(missed_input, SerializeJsonDoc(missed_request));
+    }
+    PS_ASSIGN_OR_RETURN(std::string missed_output,
+                        predict(all_missed ? input
+                                           : absl::string_view(missed_input)));
+    rapidjson::Document response;
+    if (response.Parse(missed_output.data(), missed_output.size())
+            .HasParseError() ||
+        !IsArrayMember(response, kResponse) ||
+        response[kResponse].Size() != missed.size()) {
+      if (all_missed) {
+        return missed_output;
+      }
+      return absl::InternalError(
+          "Inference response does not match the uncached model requests");
+    }
+    rapidjson::Value& model_outputs = response[kResponse];
+    for (int j = 0; j < static_cast<int>(missed.size()); ++j) {
+      const int i = missed[j];
+      PS_ASSIGN_OR_RETURN(std::string output,
+                          SerializeJsonDoc(model_outputs[j]));
+      outputs[i] = std::make_shared<const std::string>(std::move(output));
+      if (!keys[i].empty() && !(model_outputs[j].IsObject() &&
+                                model_outputs[j].HasMember(kError))) {
+        outputs_.Insert(keys[i], outputs[i]);
+      }
+    }
+    if (all_missed) {
+      return missed_output;
+    }
+  }
+
+  std::string output = absl::StrCat("{\"", kResponse, "\":[");
+  for (int i = 0; i < num_requests; ++i) {
+    absl::StrAppend(&output, i == 0 ? "" : ",", *outputs[i]);
+  }
+  absl::StrAppend(&output, "]}");
+  return output;
+}
+
+void InferenceCache::InvalidateModel(absl::string_view model_path) {
+  absl::MutexLock lock(&mu_);
+  ++model_versions_[model_path];
+}
+
+absl::flat_hash_map<std::string, double> InferenceCache::GetLookupRatios() {
+  const double hits = num_hits.exchange(0, std::memory_order_relaxed);
+  const double misses = num_misses.exchange(0, std::memory_order_relaxed);
+  const double total = hits + misses;
+  if (total == 0) {
+    return {};
+  }
+  return {{kInferenceCacheHit, hits / total},
+          {kInferenceCacheMiss, misses / total}};
+}
+
+std::string InferenceCache::Key(const rapidjson::Value& model_request) {
+  if (!model_request.IsObject() || !model_request.HasMember(kModelPath) ||
+      !model_request[kModelPath].IsString()) {
+    return "";
+  }
+  absl::StatusOr<std::string> canonical_request =
+      SerializeJsonDoc(model_request);
+  if (!canonical_request.ok()) {
+    return "";
+  }
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(canonical_request->data()),
+         canonical_request->size(), reinterpret_cast<uint8_t*>(digest.data()));
+  absl::string_view model_path(model_request[kModelPath].GetString(),
+                               model_request[kModelPath].GetStringLength());
+  int64_t model_version = 0;
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = model_versions_.find(model_path);
+        it != model_versions_.end()) {
+      model_version = it->second;
+    }
+  }
+  return absl::StrCat(model_path, "\n", model_version, "\n", digest);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,83 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_CACHE_H_
+#define SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_CACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "rapidjson/document.h"
+#include "services/common/concurrent/sharded_local_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Labels of the outcomes returned by GetLookupRatios.
+inline constexpr char kInferenceCacheHit[] = "hit";
+inline constexpr char kInferenceCacheMiss[] = "miss";
+
+// Caches the outputs of the models of the inference sidecar, so that model
+// requests seen recently skip the IPC and the inference. An output is keyed by
+// the path of its model, the version of the model and a SHA-256 digest of the
+// canonical JSON of its model request, i.e. of its tensors. Every registration
+// of a model, such as a new version fetched from the bucket, starts a new
+// version, so that outputs of the previous model are never returned.
+class InferenceCache {
+ public:
+  // Sends a JSON inference request to the sidecar and returns its output.
+  using PredictFn =
+      absl::FunctionRef<absl::StatusOr<std::string>(absl::string_view)>;
+
+  // Caches up to `max_bytes` of keys and outputs, each for `ttl`.
+  InferenceCache(int64_t max_bytes, absl::Duration ttl);
+
+  // InferenceCache is neither copyable nor movable.
+  InferenceCache(const InferenceCache&) = delete;
+  InferenceCache& operator=(const InferenceCache&) = delete;
+
+  // Serves the model requests of a JSON inference request, {"request":[...]},
+  // from the cache and sends the others to `predict` as a request of the same
+  // format. Returns the outputs of all the model requests in order, as
+  // {"response":[...]}. Error outputs are not cached.
+  absl::StatusOr<std::string> Predict(absl::string_view input,
+                                      PredictFn predict);
+
+  // Starts a new version of the model, called when it is registered.
+  void InvalidateModel(absl::string_view model_path);
+
+  // Shares of the model requests of all instances since the last call served
+  // from the cache or sent to the sidecar.
+  static absl::flat_hash_map<std::string, double> GetLookupRatios();
+
+ private:
+  // Returns the cache key of a model request, or an empty key if the request
+  // has no model path.
+  std::string Key(const rapidjson::Value& model_request);
+
+  ShardedLocalCache<std::string, const std::string> outputs_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, int64_t> model_versions_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_CACHE_H_
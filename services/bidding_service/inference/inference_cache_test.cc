@@ -0,0 +1,158 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/inference_cache.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+constexpr int64_t kMaxBytes = 1 << 20;
+
+// Records the requests sent to the sidecar and answers them with the given
+// responses in order.
+class FakeSidecar {
+ public:
+  explicit FakeSidecar(std::vector<std::string> responses)
+      : responses_(std::move(responses)) {}
+
+  absl::StatusOr<std::string> Predict(absl::string_view input) {
+    requests_.emplace_back(input);
+    if (requests_.size() > responses_.size()) {
+      return absl::InternalError("Unexpected request");
+    }
+    return responses_[requests_.size() - 1];
+  }
+
+  const std::vector<std::string>& requests() const { return requests_; }
+
+ private:
+  std::vector<std::string> responses_;
+  std::vector<std::string> requests_;
+};
+
+absl::StatusOr<std::string> Predict(InferenceCache& cache, FakeSidecar& sidecar,
+                                    absl::string_view input) {
+  return cache.Predict(input, [&sidecar](absl::string_view input) {
+    return sidecar.Predict(input);
+  });
+}
+
+TEST(InferenceCacheTest, SendsOnlyUncachedModelRequests) {
+  InferenceCache cache(kMaxBytes, absl::InfiniteDuration());
+  FakeSidecar sidecar({R"({"response":[{"model_path":"a","tensors":[1]}]})",
+                       R"({"response":[{"model_path":"b","tensors":[2]}]})"});
+  InferenceCache::GetLookupRatios();
+
+  auto first = Predict(cache, sidecar,
+                       R"({"request":[{"model_path":"a","tensors":[0]}]})");
+  auto second = Predict(cache, sidecar,
+                        R"({"request":[{"model_path":"a","tensors":[0]},)"
+                        R"({"model_path":"b","tensors":[0]}]})");
+
+  ASSERT_TRUE(first.ok()) << first.status();
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_EQ(*second,
+            R"({"response":[{"model_path":"a","tensors":[1]},)"
+            R"({"model_path":"b","tensors":[2]}]})");
+  EXPECT_THAT(sidecar.requests(),
+              ElementsAre(R"({"request":[{"model_path":"a","tensors":[0]}]})",
+                          R"({"request":[{"model_path":"b","tensors":[0]}]})"));
+  EXPECT_THAT(InferenceCache::GetLookupRatios(),
+              UnorderedElementsAre(Pair(kInferenceCacheHit, 1.0 / 3),
+                                   Pair(kInferenceCacheMiss, 2.0 / 3)));
+}
+
+TEST(InferenceCacheTest, KeysByCanonicalRequest) {
+  InferenceCache cache(kMaxBytes, absl::InfiniteDuration());
+  FakeSidecar sidecar({R"({"response":[{"model_path":"a"}]})"});
+
+  ASSERT_TRUE(Predict(cache, sidecar,
+                      R"({"request":[{"model_path":"a","tensors":[0]}]})")
+                  .ok());
+  ASSERT_TRUE(
+      Predict(cache, sidecar,
+              R"({"request":[ { "model_path" : "a", "tensors" : [ 0 ] } ]})")
+          .ok());
+
+  EXPECT_EQ(sidecar.requests().size(), 1);
+}
+
+TEST(InferenceCacheTest, InvalidatesRegisteredModels) {
+  InferenceCache cache(kMaxBytes, absl::InfiniteDuration());
+  FakeSidecar sidecar({R"({"response":[{"model_path":"a","tensors":[1]}]})",
+                       R"({"response":[{"model_path":"a","tensors":[2]}]})"});
+  constexpr char kInput[] = R"({"request":[{"model_path":"a"}]})";
+
+  ASSERT_TRUE(Predict(cache, sidecar, kInput).ok());
+  cache.InvalidateModel("a");
+  auto output = Predict(cache, sidecar, kInput);
+
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output, R"({"response":[{"model_path":"a","tensors":[2]}]})");
+  EXPECT_EQ(sidecar.requests().size(), 2);
+}
+
+TEST(InferenceCacheTest, DoesNotCacheErrors) {
+  InferenceCache cache(kMaxBytes, absl::InfiniteDuration());
+  FakeSidecar sidecar({R"({"response":[{"model_path":"a","error":{}}]})",
+                       R"({"response":[{"model_path":"a"}]})"});
+  constexpr char kInput[] = R"({"request":[{"model_path":"a"}]})";
+
+  ASSERT_TRUE(Predict(cache, sidecar, kInput).ok());
+  ASSERT_TRUE(Predict(cache, sidecar, kInput).ok());
+
+  EXPECT_EQ(sidecar.requests().size(), 2);
+}
+
+TEST(InferenceCacheTest, ExpiresOutputs) {
+  InferenceCache cache(kMaxBytes, absl::ZeroDuration());
+  FakeSidecar sidecar({R"({"response":[{"model_path":"a"}]})",
+                       R"({"response":[{"model_path":"a"}]})"});
+  constexpr char kInput[] = R"({"request":[{"model_path":"a"}]})";
+
+  ASSERT_TRUE(Predict(cache, sidecar, kInput).ok());
+  ASSERT_TRUE(Predict(cache, sidecar, kInput).ok());
+
+  EXPECT_EQ(sidecar.requests().size(), 2);
+}
+
+TEST(InferenceCacheTest, PassesThroughMalformedRequests) {
+  InferenceCache cache(kMaxBytes, absl::InfiniteDuration());
+  FakeSidecar sidecar({R"({"error":{}})"});
+
+  auto output = Predict(cache, sidecar, "not json");
+
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output, R"({"error":{}})");
+  EXPECT_THAT(sidecar.requests(), ElementsAre("not json"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
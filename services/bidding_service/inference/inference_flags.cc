@@ -14,6 +14,7 @@
 
 #include "services/bidding_service/inference/inference_flags.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -47,3 +48,21 @@ ABSL_FLAG(std::optional<std::string>, inference_model_bucket_paths,
 ABSL_FLAG(std::optional<std::string>, inference_sidecar_runtime_config,
           std::nullopt,
           "JSON string configurations for the inference sidecar runtime.");
+ABSL_FLAG(std::optional<int>, inference_sidecar_num_replicas, std::nullopt,
+          "Number of inference sidecar processes, each pinned to its share of "
+          "the cpuset of the runtime config. Defaults to 1.");
+ABSL_FLAG(std::optional<bool>, inference_sidecar_standby, std::nullopt,
+          "Whether each inference sidecar process has a standby process with "
+          "the same models, which takes over right away if it crashes.");
+ABSL_FLAG(std::optional<int64_t>, inference_model_fetch_period_ms,
+          std::nullopt,
+          "Period in milliseconds of the fetches of the model bucket, which "
+          "register a new version of each changed model. The models are only "
+          "fetched at startup if unset or 0.");
+ABSL_FLAG(std::optional<int64_t>, inference_cache_max_bytes, std::nullopt,
+          "Max size in bytes of the cached outputs of the models, keyed by "
+          "model version and request tensors. The outputs are not cached if "
+          "unset or 0.");
+ABSL_FLAG(std::optional<int64_t>, inference_cache_ttl_ms, std::nullopt,
+          "Time in milliseconds a model output stays cached. Outputs only "
+          "expire on eviction or on a new model version if unset or 0.");
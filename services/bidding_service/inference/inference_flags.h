@@ -15,6 +15,7 @@
 #ifndef SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_FLAGS_H_
 #define SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_FLAGS_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -26,6 +27,11 @@ ABSL_DECLARE_FLAG(std::optional<std::string>, inference_model_local_paths);
 ABSL_DECLARE_FLAG(std::optional<std::string>, inference_model_bucket_name);
 ABSL_DECLARE_FLAG(std::optional<std::string>, inference_model_bucket_paths);
 ABSL_DECLARE_FLAG(std::optional<std::string>, inference_sidecar_runtime_config);
+ABSL_DECLARE_FLAG(std::optional<int>, inference_sidecar_num_replicas);
+ABSL_DECLARE_FLAG(std::optional<bool>, inference_sidecar_standby);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, inference_model_fetch_period_ms);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, inference_cache_max_bytes);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, inference_cache_ttl_ms);
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -37,9 +43,19 @@ inline constexpr char INFERENCE_MODEL_BUCKET_PATHS[] =
     "INFERENCE_MODEL_BUCKET_PATHS";
 inline constexpr char INFERENCE_SIDECAR_RUNTIME_CONFIG[] =
     "INFERENCE_SIDECAR_RUNTIME_CONFIG";
+inline constexpr char INFERENCE_SIDECAR_NUM_REPLICAS[] =
+    "INFERENCE_SIDECAR_NUM_REPLICAS";
+inline constexpr char INFERENCE_SIDECAR_STANDBY[] = "INFERENCE_SIDECAR_STANDBY";
+inline constexpr char INFERENCE_MODEL_FETCH_PERIOD_MS[] =
+    "INFERENCE_MODEL_FETCH_PERIOD_MS";
+inline constexpr char INFERENCE_CACHE_MAX_BYTES[] = "INFERENCE_CACHE_MAX_BYTES";
+inline constexpr char INFERENCE_CACHE_TTL_MS[] = "INFERENCE_CACHE_TTL_MS";
 inline constexpr absl::string_view kInferenceFlags[] = {
-    INFERENCE_SIDECAR_BINARY_PATH, INFERENCE_MODEL_BUCKET_NAME,
-    INFERENCE_MODEL_BUCKET_PATHS, INFERENCE_SIDECAR_RUNTIME_CONFIG};
+    INFERENCE_SIDECAR_BINARY_PATH,   INFERENCE_MODEL_BUCKET_NAME,
+    INFERENCE_MODEL_BUCKET_PATHS,    INFERENCE_SIDECAR_RUNTIME_CONFIG,
+    INFERENCE_SIDECAR_NUM_REPLICAS,  INFERENCE_SIDECAR_STANDBY,
+    INFERENCE_MODEL_FETCH_PERIOD_MS, INFERENCE_CACHE_MAX_BYTES,
+    INFERENCE_CACHE_TTL_MS};
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
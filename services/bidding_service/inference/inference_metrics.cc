@@ -0,0 +1,120 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#include "services/bidding_service/inference/inference_metrics.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Sums of the values of a metric by model path, taken out on export.
+class ModelSums {
+ public:
+  void Add(absl::string_view model_path, double value) {
+    absl::MutexLock lock(&mu_);
+    Sum& sum = sums_[model_path];
+    sum.total += value;
+    ++sum.count;
+  }
+
+  absl::flat_hash_map<std::string, double> TakeMeans() {
+    absl::flat_hash_map<std::string, double> means;
+    for (const auto& [model_path, sum] : Take()) {
+      means.emplace(model_path, sum.total / sum.count);
+    }
+    return means;
+  }
+
+  absl::flat_hash_map<std::string, double> TakeTotals() {
+    absl::flat_hash_map<std::string, double> totals;
+    for (const auto& [model_path, sum] : Take()) {
+      totals.emplace(model_path, sum.total);
+    }
+    return totals;
+  }
+
+ private:
+  struct Sum {
+    double total = 0;
+    int64_t count = 0;
+  };
+
+  absl::flat_hash_map<std::string, Sum> Take() {
+    absl::flat_hash_map<std::string, Sum> sums;
+    absl::MutexLock lock(&mu_);
+    sums.swap(sums_);
+    return sums;
+  }
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Sum> sums_ ABSL_GUARDED_BY(mu_);
+};
+
+// The sums of the models of all the sidecars since the last export.
+ModelSums& InferenceTimes() {
+  static ModelSums* sums = new ModelSums();
+  return *sums;
+}
+
+ModelSums& QueueTimes() {
+  static ModelSums* sums = new ModelSums();
+  return *sums;
+}
+
+ModelSums& BatchSizes() {
+  static ModelSums* sums = new ModelSums();
+  return *sums;
+}
+
+ModelSums& Errors() {
+  static ModelSums* sums = new ModelSums();
+  return *sums;
+}
+
+}  // namespace
+
+void RecordModelMetrics(const PredictResponse& response) {
+  for (const ModelMetrics& metrics : response.model_metrics()) {
+    InferenceTimes().Add(metrics.model_path(),
+                         metrics.inference_time_us() / 1000.0);
+    QueueTimes().Add(metrics.model_path(), metrics.queue_time_us() / 1000.0);
+    BatchSizes().Add(metrics.model_path(), metrics.batch_size());
+    Errors().Add(metrics.model_path(), metrics.error_code() != 0 ? 1 : 0);
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetModelInferenceTimes() {
+  return InferenceTimes().TakeMeans();
+}
+
+absl::flat_hash_map<std::string, double> GetModelQueueTimes() {
+  return QueueTimes().TakeMeans();
+}
+
+absl::flat_hash_map<std::string, double> GetModelBatchSizes() {
+  return BatchSizes().TakeMeans();
+}
+
+absl::flat_hash_map<std::string, double> GetModelErrorCounts() {
+  return Errors().TakeTotals();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
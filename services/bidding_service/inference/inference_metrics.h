@@ -0,0 +1,49 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#ifndef SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_METRICS_H_
+#define SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_METRICS_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Adds the metrics of the models that the inference sidecar returned with a
+// Predict response to those exported by the functions below.
+void RecordModelMetrics(const PredictResponse& response);
+
+// Each of the functions below returns, by model path, a value over the model
+// inferences recorded since its previous call, for the gauges partitioned by
+// model path.
+
+// Mean time spent on the inference of each model, in milliseconds.
+absl::flat_hash_map<std::string, double> GetModelInferenceTimes();
+
+// Mean time the inference of each model waited for a worker thread of the
+// sidecar, or of the model if it has its own, in milliseconds.
+absl::flat_hash_map<std::string, double> GetModelQueueTimes();
+
+// Mean batch size of the inferences of each model.
+absl::flat_hash_map<std::string, double> GetModelBatchSizes();
+
+// Number of failed inferences of each model.
+absl::flat_hash_map<std::string, double> GetModelErrorCounts();
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_METRICS_H_
@@ -0,0 +1,75 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+
+#include "services/bidding_service/inference/inference_metrics.h"
+
+#include <cstdint>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+void AddModelMetrics(PredictResponse& response, const std::string& model_path,
+                     int64_t inference_time_us, int32_t error_code) {
+  ModelMetrics* metrics = response.add_model_metrics();
+  metrics->set_model_path(model_path);
+  metrics->set_batch_size(4);
+  metrics->set_queue_time_us(500);
+  metrics->set_inference_time_us(inference_time_us);
+  metrics->set_error_code(error_code);
+}
+
+TEST(InferenceMetricsTest, ExportsTheMetricsByModelPath) {
+  PredictResponse response;
+  AddModelMetrics(response, "pcvr", 1000, 0);
+  AddModelMetrics(response, "pcvr", 3000, 13);
+  AddModelMetrics(response, "pctr", 2000, 0);
+  RecordModelMetrics(response);
+
+  EXPECT_THAT(GetModelInferenceTimes(),
+              UnorderedElementsAre(Pair("pcvr", DoubleEq(2)),
+                                   Pair("pctr", DoubleEq(2))));
+  EXPECT_THAT(GetModelQueueTimes(),
+              UnorderedElementsAre(Pair("pcvr", DoubleEq(0.5)),
+                                   Pair("pctr", DoubleEq(0.5))));
+  EXPECT_THAT(GetModelBatchSizes(),
+              UnorderedElementsAre(Pair("pcvr", DoubleEq(4)),
+                                   Pair("pctr", DoubleEq(4))));
+  EXPECT_THAT(GetModelErrorCounts(),
+              UnorderedElementsAre(Pair("pcvr", DoubleEq(1)),
+                                   Pair("pctr", DoubleEq(0))));
+}
+
+TEST(InferenceMetricsTest, ExportsEachInferenceOnce) {
+  PredictResponse response;
+  AddModelMetrics(response, "pcvr", 1000, 0);
+  RecordModelMetrics(response);
+
+  EXPECT_THAT(GetModelInferenceTimes(), SizeIs(1));
+  EXPECT_THAT(GetModelInferenceTimes(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
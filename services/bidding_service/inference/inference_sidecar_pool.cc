@@ -0,0 +1,526 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/inference_sidecar_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.grpc.pb.h"
+#include "src/logger/request_context_logger.h"
+#include "src/util/status_macro/status_macros.h"
+#include "src/util/status_macro/status_util.h"
+#include "utils/predict_stream.h"
+#include "utils/register_model_chunks.h"
+#include "utils/shared_memory_transport.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr absl::Duration kHealthCheckInterval = absl::Seconds(1);
+
+absl::Status RegisterModelWith(InferenceService::StubInterface& stub,
+                               const RegisterModelRequest& request) {
+  grpc::ClientContext context;
+  RegisterModelResponse response;
+  // Streams the model in chunks, so that neither side serializes the whole
+  // model in one message.
+  std::unique_ptr<grpc::ClientWriterInterface<RegisterModelChunk>> writer =
+      stub.RegisterModelStream(&context, &response);
+  // A failed write means the stream is broken, whose status Finish() returns.
+  if (WriteRegisterModelChunks(request, kRegisterModelChunkBytes,
+                               [&writer](const RegisterModelChunk& chunk) {
+                                 return writer->Write(chunk);
+                               })) {
+    writer->WritesDone();
+  }
+  grpc::Status status = writer->Finish();
+  if (!status.ok()) {
+    return server_common::ToAbslStatus(status);
+  }
+  return absl::OkStatus();
+}
+
+// Returns the time left to the deadline of the request, infinite if it has
+// none.
+absl::Duration TimeLeft(const PredictRequest& request) {
+  if (request.deadline_unix_micros() <= 0) {
+    return absl::InfiniteDuration();
+  }
+  return absl::FromUnixMicros(request.deadline_unix_micros()) - absl::Now();
+}
+
+}  // namespace
+
+// A running sandboxee and the clients of its transports.
+struct InferenceSidecarPool::Sidecar {
+  std::unique_ptr<SandboxExecutor> executor;
+  std::unique_ptr<InferenceService::StubInterface> stub;
+  // Null if Predict calls go over gRPC.
+  std::unique_ptr<SharedMemoryPredictClient> shared_memory_client;
+  // Predict calls over gRPC share its stream. Null if they go over shared
+  // memory. Declared after the stub it calls.
+  std::unique_ptr<PredictStreamClient> predict_stream_client;
+
+  // Fails the calls in flight once the sandboxee stopped, since no response
+  // is coming for them.
+  void CancelCallsInFlight() {
+    const absl::Status status =
+        absl::UnavailableError("Inference sidecar stopped");
+    if (shared_memory_client != nullptr) {
+      shared_memory_client->Cancel(status);
+    }
+    if (predict_stream_client != nullptr) {
+      predict_stream_client->Cancel(status);
+    }
+  }
+};
+
+struct InferenceSidecarPool::Replica {
+  int index;
+  // Runtime config with the CPU share of the replica.
+  std::string runtime_config;
+  std::atomic<int> in_flight = 0;
+  // Unset while the sandboxee is stopped.
+  std::atomic<bool> available = false;
+
+  absl::Mutex mu;
+  // Held by the calls in flight, so that a sidecar started again does not
+  // take the old one away from under them.
+  std::shared_ptr<Sidecar> sidecar ABSL_GUARDED_BY(mu);
+  // Takes the place of the sidecar when it stops. Null if the pool runs no
+  // standby, or until it is started again after taking over.
+  std::shared_ptr<Sidecar> standby ABSL_GUARDED_BY(mu);
+};
+
+std::vector<std::vector<int>> SplitCpuset(const std::vector<int>& cpus,
+                                          int num_replicas) {
+  std::vector<std::vector<int>> shares(num_replicas);
+  if (cpus.empty()) {
+    return shares;
+  }
+  if (cpus.size() < shares.size()) {
+    for (int i = 0; i < num_replicas; ++i) {
+      shares[i].push_back(cpus[i % cpus.size()]);
+    }
+    return shares;
+  }
+  for (int i = 0; i < num_replicas; ++i) {
+    shares[i].assign(cpus.begin() + cpus.size() * i / num_replicas,
+                     cpus.begin() + cpus.size() * (i + 1) / num_replicas);
+  }
+  return shares;
+}
+
+InferenceSidecarPool::InferenceSidecarPool(absl::string_view binary_path,
+                                           absl::string_view runtime_config,
+                                           int num_replicas, bool standby)
+    : binary_path_(binary_path), standby_(standby) {
+  num_replicas = std::max(num_replicas, 1);
+  for (int i = 0; i < num_replicas; ++i) {
+    replicas_.push_back(std::make_unique<Replica>());
+    replicas_[i]->index = i;
+    replicas_[i]->runtime_config = std::string(runtime_config);
+  }
+
+  InferenceSidecarRuntimeConfig config;
+  if (absl::Status status = google::protobuf::util::JsonStringToMessage(
+          runtime_config, &config);
+      !status.ok()) {
+    // Left to the sidecars to report.
+    PS_LOG(ERROR) << "Cannot parse the inference sidecar runtime config: "
+                  << status;
+    return;
+  }
+  shared_memory_transport_ = config.shared_memory_transport();
+  if (config.shared_model_store_mb() > 0) {
+    absl::StatusOr<std::unique_ptr<SharedModelStore>> model_store =
+        SharedModelStore::Create(
+            static_cast<size_t>(config.shared_model_store_mb()) << 20);
+    if (model_store.ok()) {
+      model_store_ = *std::move(model_store);
+    } else {
+      // Models are sent with their files, as without a store.
+      PS_LOG(ERROR) << "Cannot create the shared model store: "
+                    << model_store.status();
+    }
+  }
+  if (num_replicas == 1) {
+    return;
+  }
+  const std::vector<std::vector<int>> cpu_shares = SplitCpuset(
+      std::vector<int>(config.cpuset().begin(), config.cpuset().end()),
+      num_replicas);
+  for (int i = 0; i < num_replicas; ++i) {
+    config.clear_cpuset();
+    for (int cpu : cpu_shares[i]) {
+      config.add_cpuset(cpu);
+    }
+    if (absl::Status status = google::protobuf::util::MessageToJsonString(
+            config, &replicas_[i]->runtime_config);
+        !status.ok()) {
+      PS_LOG(ERROR) << "Cannot split the CPUs of the inference sidecars: "
+                    << status;
+      replicas_[i]->runtime_config = std::string(runtime_config);
+    }
+  }
+}
+
+InferenceSidecarPool::~InferenceSidecarPool() { StopHealthCheck(); }
+
+void InferenceSidecarPool::StopHealthCheck() {
+  {
+    absl::MutexLock lock(&health_mu_);
+    stopping_ = true;
+  }
+  if (health_checker_.joinable()) {
+    health_checker_.join();
+  }
+}
+
+void InferenceSidecarPool::Stop() {
+  // Stopped first, so that it does not start the sandboxees again.
+  StopHealthCheck();
+  for (auto& replica : replicas_) {
+    replica->available = false;
+    std::shared_ptr<Sidecar> sidecars[2];
+    {
+      absl::MutexLock lock(&replica->mu);
+      sidecars[0] = std::move(replica->sidecar);
+      sidecars[1] = std::move(replica->standby);
+    }
+    for (const std::shared_ptr<Sidecar>& sidecar : sidecars) {
+      if (sidecar != nullptr) {
+        sidecar->executor->StopSandboxee().IgnoreError();
+        sidecar->CancelCallsInFlight();
+      }
+    }
+  }
+}
+
+absl::Status InferenceSidecarPool::Start() {
+  {
+    absl::MutexLock lock(&models_mu_);
+    for (auto& replica : replicas_) {
+      PS_ASSIGN_OR_RETURN(std::shared_ptr<Sidecar> sidecar,
+                          StartSidecar(*replica));
+      std::shared_ptr<Sidecar> standby;
+      if (standby_) {
+        PS_ASSIGN_OR_RETURN(standby, StartSidecar(*replica));
+      }
+      absl::MutexLock replica_lock(&replica->mu);
+      replica->sidecar = std::move(sidecar);
+      replica->standby = std::move(standby);
+      replica->available = true;
+    }
+  }
+  health_checker_ = std::thread(&InferenceSidecarPool::CheckHealth, this);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<InferenceSidecarPool::Sidecar>>
+InferenceSidecarPool::StartSidecar(const Replica& replica) {
+  auto sidecar = std::make_shared<Sidecar>();
+  sidecar->executor = std::make_unique<SandboxExecutor>(
+      binary_path_, std::vector<std::string>{replica.runtime_config},
+      model_store_ != nullptr ? model_store_->FileDescriptor() : -1);
+  PS_RETURN_IF_ERROR(sidecar->executor->StartSandboxee());
+  sidecar->stub = InferenceService::NewStub(grpc::CreateInsecureChannelFromFd(
+      "GrpcChannel", sidecar->executor->FileDescriptor()));
+  if (shared_memory_transport_) {
+    if (sidecar->executor->RequestRing() == nullptr ||
+        sidecar->executor->ResponseRing() == nullptr) {
+      PS_LOG(ERROR) << "Shared memory rings are not set up, Predict calls to "
+                       "inference sidecar "
+                    << replica.index << " go over gRPC";
+    } else {
+      sidecar->shared_memory_client =
+          std::make_unique<SharedMemoryPredictClient>(
+              *sidecar->executor->RequestRing(),
+              *sidecar->executor->ResponseRing());
+    }
+  }
+  if (sidecar->shared_memory_client == nullptr) {
+    sidecar->predict_stream_client =
+        std::make_unique<PredictStreamClient>(*sidecar->stub);
+  }
+  for (const RegisterModelRequest& request : models_) {
+    PS_RETURN_IF_ERROR(RegisterModelWith(*sidecar->stub, request));
+  }
+  return sidecar;
+}
+
+absl::Status InferenceSidecarPool::RegisterModel(
+    const RegisterModelRequest& model_request) {
+  const RegisterModelRequest* request_ptr = &model_request;
+  RegisterModelRequest shared_request;
+  if (model_store_ != nullptr) {
+    shared_request = model_request;
+    if (absl::Status status =
+            MoveModelFilesToStore(*model_store_, shared_request);
+        status.ok()) {
+      request_ptr = &shared_request;
+    } else {
+      PS_LOG(WARNING) << "Model " << model_request.model_spec().model_path()
+                      << " is sent with its files to the inference sidecars: "
+                      << status;
+    }
+  }
+  const RegisterModelRequest& request = *request_ptr;
+  absl::MutexLock lock(&models_mu_);
+  for (auto& replica : replicas_) {
+    std::shared_ptr<Sidecar> sidecar;
+    std::shared_ptr<Sidecar> standby;
+    {
+      absl::ReaderMutexLock replica_lock(&replica->mu);
+      sidecar = replica->sidecar;
+      standby = replica->standby;
+    }
+    if (sidecar == nullptr) {
+      return absl::FailedPreconditionError("Inference sidecar is not started");
+    }
+    PS_RETURN_IF_ERROR(RegisterModelWith(*sidecar->stub, request));
+    if (standby == nullptr) {
+      continue;
+    }
+    if (absl::Status status = RegisterModelWith(*standby->stub, request);
+        !status.ok()) {
+      // A standby missing a model cannot take over, it is started again with
+      // every model by the health check.
+      PS_LOG(ERROR) << "Cannot register the model with the standby of "
+                       "inference sidecar "
+                    << replica->index << ": " << status;
+      absl::MutexLock replica_lock(&replica->mu);
+      if (replica->standby == standby) {
+        replica->standby = nullptr;
+      }
+      RequestHealthCheck();
+    }
+  }
+  // Restarted replicas register the latest version of each model only.
+  for (RegisterModelRequest& model : models_) {
+    if (model.model_spec().model_path() == request.model_spec().model_path()) {
+      model = request;
+      return absl::OkStatus();
+    }
+  }
+  models_.push_back(request);
+  return absl::OkStatus();
+}
+
+InferenceSidecarPool::Replica& InferenceSidecarPool::LeastLoaded() {
+  const uint32_t start = next_replica_.fetch_add(1, std::memory_order_relaxed);
+  Replica* least_loaded = nullptr;
+  bool least_loaded_available = false;
+  int least_loaded_in_flight = 0;
+  for (size_t i = 0; i < replicas_.size(); ++i) {
+    Replica& replica = *replicas_[(start + i) % replicas_.size()];
+    const bool available = replica.available;
+    const int in_flight = replica.in_flight;
+    if (least_loaded == nullptr || available > least_loaded_available ||
+        (available == least_loaded_available &&
+         in_flight < least_loaded_in_flight)) {
+      least_loaded = &replica;
+      least_loaded_available = available;
+      least_loaded_in_flight = in_flight;
+    }
+  }
+  return *least_loaded;
+}
+
+absl::StatusOr<PredictResponse> InferenceSidecarPool::Predict(
+    const PredictRequest& request) {
+  Replica& replica = LeastLoaded();
+  absl::StatusOr<PredictResponse> response = Predict(replica, request);
+  if (response.ok() || !MarkIfStopped(replica)) {
+    return response;
+  }
+  // The call failed because the sidecar is gone, another one may take it.
+  RequestHealthCheck();
+  return Predict(LeastLoaded(), request);
+}
+
+absl::StatusOr<PredictResponse> InferenceSidecarPool::Predict(
+    Replica& replica, const PredictRequest& request) {
+  const absl::Duration timeout = TimeLeft(request);
+  if (timeout <= absl::ZeroDuration()) {
+    return absl::DeadlineExceededError(
+        "Predict request expired before it was sent");
+  }
+  std::shared_ptr<Sidecar> sidecar;
+  {
+    absl::ReaderMutexLock lock(&replica.mu);
+    sidecar = replica.sidecar;
+  }
+  if (sidecar == nullptr) {
+    return absl::FailedPreconditionError("Inference sidecar is not started");
+  }
+
+  ++replica.in_flight;
+  absl::StatusOr<PredictResponse> response;
+  if (sidecar->shared_memory_client != nullptr) {
+    response = sidecar->shared_memory_client->Predict(request, timeout);
+  } else {
+    response = sidecar->predict_stream_client->Predict(request, timeout);
+  }
+  --replica.in_flight;
+  return response;
+}
+
+bool InferenceSidecarPool::MarkIfStopped(Replica& replica) {
+  absl::MutexLock lock(&replica.mu);
+  if (replica.sidecar == nullptr ||
+      replica.sidecar->executor->IsSandboxeeRunning()) {
+    return false;
+  }
+  if (replica.standby != nullptr &&
+      replica.standby->executor->IsSandboxeeRunning()) {
+    PS_LOG(ERROR) << "Inference sidecar " << replica.index
+                  << " stopped, its standby takes over";
+    replica.sidecar->CancelCallsInFlight();
+    replica.sidecar = std::move(replica.standby);
+    replica.available = true;
+    return true;
+  }
+  if (replica.available.exchange(false)) {
+    PS_LOG(ERROR) << "Inference sidecar " << replica.index << " stopped";
+    replica.sidecar->CancelCallsInFlight();
+  }
+  return true;
+}
+
+absl::StatusOr<sandbox2::Result> InferenceSidecarPool::StopReplica(int index) {
+  Replica& replica = *replicas_[index];
+  absl::MutexLock lock(&replica.mu);
+  if (replica.sidecar == nullptr) {
+    return absl::FailedPreconditionError("Inference sidecar is not started");
+  }
+  return replica.sidecar->executor->StopSandboxee();
+}
+
+void InferenceSidecarPool::RequestHealthCheck() {
+  absl::MutexLock lock(&health_mu_);
+  health_check_requested_ = true;
+}
+
+void InferenceSidecarPool::CheckHealth() {
+  while (true) {
+    {
+      absl::MutexLock lock(&health_mu_);
+      health_mu_.AwaitWithTimeout(
+          absl::Condition(
+              +[](InferenceSidecarPool* pool)
+                   ABSL_EXCLUSIVE_LOCKS_REQUIRED(pool->health_mu_) {
+                     return pool->health_check_requested_ || pool->stopping_;
+                   },
+              this),
+          kHealthCheckInterval);
+      if (stopping_) {
+        return;
+      }
+      health_check_requested_ = false;
+    }
+    for (auto& replica : replicas_) {
+      MarkIfStopped(*replica);
+      if (!replica->available) {
+        Restart(*replica);
+      }
+      RestartStandby(*replica);
+    }
+    ReportReadiness();
+  }
+}
+
+void InferenceSidecarPool::Restart(Replica& replica) {
+  PS_LOG(INFO) << "Starting inference sidecar " << replica.index << " again";
+  std::shared_ptr<Sidecar> sidecar;
+  {
+    absl::MutexLock lock(&models_mu_);
+    absl::StatusOr<std::shared_ptr<Sidecar>> started = StartSidecar(replica);
+    if (!started.ok()) {
+      // Tried again on the next health check.
+      PS_LOG(ERROR) << "Cannot start inference sidecar " << replica.index
+                    << " again: " << started.status();
+      return;
+    }
+    sidecar = *std::move(started);
+    absl::MutexLock replica_lock(&replica.mu);
+    std::swap(replica.sidecar, sidecar);
+    replica.available = true;
+  }
+  PS_LOG(INFO) << "Started inference sidecar " << replica.index << " again";
+  // The stopped sidecar goes away once its last call returns.
+}
+
+void InferenceSidecarPool::RestartStandby(Replica& replica) {
+  if (!standby_ || !replica.available) {
+    return;
+  }
+  {
+    absl::ReaderMutexLock lock(&replica.mu);
+    if (replica.standby != nullptr &&
+        replica.standby->executor->IsSandboxeeRunning()) {
+      return;
+    }
+  }
+  absl::MutexLock lock(&models_mu_);
+  absl::StatusOr<std::shared_ptr<Sidecar>> started = StartSidecar(replica);
+  if (!started.ok()) {
+    // Tried again on the next health check.
+    PS_LOG(ERROR) << "Cannot start the standby of inference sidecar "
+                  << replica.index << ": " << started.status();
+    return;
+  }
+  absl::MutexLock replica_lock(&replica.mu);
+  replica.standby = *std::move(started);
+}
+
+bool InferenceSidecarPool::Ready() const {
+  return std::any_of(replicas_.begin(), replicas_.end(),
+                     [](const std::unique_ptr<Replica>& replica) {
+                       return replica->available.load();
+                     });
+}
+
+void InferenceSidecarPool::SetReadinessListener(
+    absl::AnyInvocable<void(bool)> listener) {
+  absl::MutexLock lock(&health_mu_);
+  readiness_listener_ = std::move(listener);
+  reported_ready_ = std::nullopt;
+  health_check_requested_ = true;
+}
+
+void InferenceSidecarPool::ReportReadiness() {
+  const bool ready = Ready();
+  absl::MutexLock lock(&health_mu_);
+  if (readiness_listener_ == nullptr || reported_ready_ == ready) {
+    return;
+  }
+  PS_LOG(INFO) << "Inference sidecars " << (ready ? "ready" : "not ready");
+  readiness_listener_(ready);
+  reported_ready_ = ready;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
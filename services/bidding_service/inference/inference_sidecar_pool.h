@@ -0,0 +1,162 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_SIDECAR_POOL_H_
+#define SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_SIDECAR_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "proto/inference_sidecar.pb.h"
+#include "sandbox/sandbox_executor.h"
+#include "utils/shared_model_store.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Splits the CPUs between the replicas, in contiguous and even shares. If
+// there are fewer CPUs than replicas, they are shared in turn. Empty shares if
+// cpus is empty.
+std::vector<std::vector<int>> SplitCpuset(const std::vector<int>& cpus,
+                                          int num_replicas);
+
+// Runs a number of inference sidecar processes, each under its own
+// `SandboxExecutor`, pinned to its own share of the CPUs of the runtime config
+// and with every model registered. Predict calls go to the replica with the
+// fewest calls in flight.
+//
+// A replica whose sandboxee stops, e.g. crashes, is started again with the
+// models registered so far. The health check looks for stopped replicas every
+// second, and right away when a call fails on one. With `standby`, each
+// replica also keeps a second sandboxee running with the same models, which
+// takes the calls as soon as the first one is found stopped, so that a crash
+// costs the calls in flight instead of seconds of failed calls. With a
+// `shared_model_store_mb` in the runtime config, the files of the models are
+// written once into a shared model store every sidecar maps, rather than sent
+// to each of them and kept for the restarts. Thread-safe.
+class InferenceSidecarPool {
+ public:
+  // runtime_config: JSON InferenceSidecarRuntimeConfig of the sidecars. Its
+  // `cpuset` is split between the replicas.
+  InferenceSidecarPool(absl::string_view binary_path,
+                       absl::string_view runtime_config, int num_replicas,
+                       bool standby = false);
+  ~InferenceSidecarPool();
+
+  InferenceSidecarPool(const InferenceSidecarPool&) = delete;
+  InferenceSidecarPool& operator=(const InferenceSidecarPool&) = delete;
+
+  // Starts the sandboxees and the health check. You should not call more than
+  // once.
+  absl::Status Start() ABSL_LOCKS_EXCLUDED(models_mu_);
+
+  // Registers the model with every replica, and with the ones started again
+  // later.
+  absl::Status RegisterModel(const RegisterModelRequest& request)
+      ABSL_LOCKS_EXCLUDED(models_mu_);
+
+  // Fails with DeadlineExceeded, without waiting any longer for the response,
+  // once the deadline of the request is past.
+  absl::StatusOr<PredictResponse> Predict(const PredictRequest& request)
+      ABSL_LOCKS_EXCLUDED(models_mu_);
+
+  // Stops the sandboxee of the replica. It is started again like a crashed
+  // one.
+  absl::StatusOr<sandbox2::Result> StopReplica(int index);
+
+  // Stops the health check, then the sandboxees of the replicas and their
+  // standbys, which are not started again, e.g. once the server drained.
+  // Calls in flight fail.
+  void Stop() ABSL_LOCKS_EXCLUDED(health_mu_);
+
+  // Returns true while a replica takes calls.
+  bool Ready() const;
+
+  // Has `listener` called by the health check with the readiness of the pool,
+  // now and whenever it changes, e.g. to stop serving traffic while no
+  // replica takes calls.
+  void SetReadinessListener(absl::AnyInvocable<void(bool)> listener)
+      ABSL_LOCKS_EXCLUDED(health_mu_);
+
+  int size() const { return replicas_.size(); }
+
+ private:
+  struct Sidecar;
+  struct Replica;
+
+  // Starts a sandboxee for the replica and registers the models with it.
+  absl::StatusOr<std::shared_ptr<Sidecar>> StartSidecar(const Replica& replica)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(models_mu_);
+
+  // Returns the replica with the fewest calls in flight, leaving out the
+  // stopped ones if possible.
+  Replica& LeastLoaded();
+
+  absl::StatusOr<PredictResponse> Predict(Replica& replica,
+                                          const PredictRequest& request);
+
+  // Returns true if the sandboxee of the replica stopped. Its standby takes
+  // its place if running, otherwise the replica no longer takes calls until
+  // it is started again.
+  bool MarkIfStopped(Replica& replica);
+
+  // Starts the stopped replicas and standbys again, until the pool is
+  // destroyed.
+  void CheckHealth() ABSL_LOCKS_EXCLUDED(health_mu_, models_mu_);
+  void Restart(Replica& replica) ABSL_LOCKS_EXCLUDED(models_mu_);
+  void RestartStandby(Replica& replica) ABSL_LOCKS_EXCLUDED(models_mu_);
+  // Calls the readiness listener if the readiness changed.
+  void ReportReadiness() ABSL_LOCKS_EXCLUDED(health_mu_);
+  void StopHealthCheck() ABSL_LOCKS_EXCLUDED(health_mu_);
+  // Has the health check run without waiting for its interval.
+  void RequestHealthCheck() ABSL_LOCKS_EXCLUDED(health_mu_);
+
+  const std::string binary_path_;
+  const bool standby_;
+  bool shared_memory_transport_ = false;
+  // Null if the models are sent with their files.
+  std::unique_ptr<SharedModelStore> model_store_;
+  std::vector<std::unique_ptr<Replica>> replicas_;
+  // Rotates the replica the least loaded search starts from, to spread ties.
+  std::atomic<uint32_t> next_replica_ = 0;
+
+  // Held while models are registered, so that a replica started again does
+  // not miss any. Acquired before the mutex of any replica. The models refer
+  // to their files in the shared model store, if they fit in it.
+  absl::Mutex models_mu_;
+  std::vector<RegisterModelRequest> models_ ABSL_GUARDED_BY(models_mu_);
+
+  absl::Mutex health_mu_;
+  bool health_check_requested_ ABSL_GUARDED_BY(health_mu_) = false;
+  bool stopping_ ABSL_GUARDED_BY(health_mu_) = false;
+  absl::AnyInvocable<void(bool)> readiness_listener_
+      ABSL_GUARDED_BY(health_mu_);
+  // Readiness last reported to the listener, unset until reported.
+  std::optional<bool> reported_ready_ ABSL_GUARDED_BY(health_mu_);
+  std::thread health_checker_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_BIDDING_SERVICE_INFERENCE_INFERENCE_SIDECAR_POOL_H_
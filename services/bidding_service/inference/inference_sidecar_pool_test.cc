@@ -0,0 +1,203 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/inference_sidecar_pool.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "utils/file_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr absl::string_view kSidecarBinary =
+    "__main__/external/inference_common/inference_sidecar";
+constexpr absl::string_view kTestModelPath =
+    "external/inference_common/testdata/models/tensorflow_1_mib_saved_model.pb";
+constexpr absl::string_view kRuntimeConfig = R"json({
+  "num_interop_threads": 4,
+  "num_intraop_threads": 5,
+  "module_name": "test",
+  "cpuset": [0, 1]
+})json";
+
+TEST(SplitCpusetTest, SplitsEvenly) {
+  EXPECT_EQ(SplitCpuset({0, 1, 2, 3, 4}, 2),
+            (std::vector<std::vector<int>>{{0, 1}, {2, 3, 4}}));
+  EXPECT_EQ(SplitCpuset({0, 1}, 1), (std::vector<std::vector<int>>{{0, 1}}));
+}
+
+TEST(SplitCpusetTest, SharesFewerCpusThanReplicas) {
+  EXPECT_EQ(SplitCpuset({0, 1}, 3),
+            (std::vector<std::vector<int>>{{0}, {1}, {0}}));
+}
+
+TEST(SplitCpusetTest, LeavesEmptyCpusetsEmpty) {
+  EXPECT_EQ(SplitCpuset({}, 2), (std::vector<std::vector<int>>{{}, {}}));
+}
+
+class InferenceSidecarPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    absl::SetFlag(&FLAGS_testonly_allow_policies_for_bazel, true);
+  }
+
+ private:
+  absl::FlagSaver flag_saver_;
+};
+
+TEST_F(InferenceSidecarPoolTest, PredictsOnEveryReplica) {
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary), kRuntimeConfig, 2);
+  ASSERT_TRUE(pool.Start().ok());
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_request).ok());
+  ASSERT_TRUE(pool.RegisterModel(register_request).ok());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 10; ++i) {
+    threads.emplace_back([&pool]() {
+      PredictRequest request;
+      request.set_input("1.0");
+      absl::StatusOr<PredictResponse> response = pool.Predict(request);
+      ASSERT_TRUE(response.ok()) << response.status();
+      EXPECT_EQ(response->output(), "0.57721");
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST_F(InferenceSidecarPoolTest, RegistersModelsThroughSharedModelStore) {
+  constexpr absl::string_view kSharedStoreRuntimeConfig = R"json({
+    "module_name": "test",
+    "shared_model_store_mb": 4
+  })json";
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary),
+                            kSharedStoreRuntimeConfig, 2);
+  ASSERT_TRUE(pool.Start().ok());
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_request).ok());
+  ASSERT_TRUE(pool.RegisterModel(register_request).ok());
+  // A replica started again registers the model from the store.
+  ASSERT_TRUE(pool.StopReplica(0).ok());
+  absl::SleepFor(absl::Seconds(3));
+
+  for (int i = 0; i < 4; ++i) {
+    PredictRequest request;
+    request.set_input("1.0");
+    absl::StatusOr<PredictResponse> response = pool.Predict(request);
+    ASSERT_TRUE(response.ok()) << response.status();
+    EXPECT_EQ(response->output(), "0.57721");
+  }
+}
+
+TEST_F(InferenceSidecarPoolTest, RestartsStoppedReplicas) {
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary), kRuntimeConfig, 2);
+  ASSERT_TRUE(pool.Start().ok());
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_request).ok());
+  ASSERT_TRUE(pool.RegisterModel(register_request).ok());
+
+  absl::StatusOr<sandbox2::Result> result = pool.StopReplica(0);
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+
+  // Calls go to the other replica until the stopped one starts again.
+  for (int i = 0; i < 4; ++i) {
+    PredictRequest request;
+    request.set_input("1.0");
+    absl::StatusOr<PredictResponse> response = pool.Predict(request);
+    ASSERT_TRUE(response.ok()) << response.status();
+  }
+
+  // Started again by the health check, with the model registered.
+  absl::SleepFor(absl::Seconds(3));
+  pool.StopReplica(1).IgnoreError();
+  PredictRequest request;
+  request.set_input("1.0");
+  absl::StatusOr<PredictResponse> response = pool.Predict(request);
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_EQ(response->output(), "0.57721");
+}
+
+TEST_F(InferenceSidecarPoolTest, StandbyTakesOverStoppedReplica) {
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary), kRuntimeConfig, 1,
+                            /*standby=*/true);
+  ASSERT_TRUE(pool.Start().ok());
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_request).ok());
+  ASSERT_TRUE(pool.RegisterModel(register_request).ok());
+
+  ASSERT_TRUE(pool.StopReplica(0).ok());
+
+  // The only replica takes calls again without waiting for a restart, with
+  // the model registered.
+  PredictRequest request;
+  request.set_input("1.0");
+  absl::StatusOr<PredictResponse> response = pool.Predict(request);
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_EQ(response->output(), "0.57721");
+  EXPECT_TRUE(pool.Ready());
+}
+
+TEST_F(InferenceSidecarPoolTest, StopsReplicasForGood) {
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary), kRuntimeConfig, 2);
+  ASSERT_TRUE(pool.Start().ok());
+
+  pool.Stop();
+
+  EXPECT_FALSE(pool.Ready());
+  // Not started again by the health check.
+  absl::SleepFor(absl::Seconds(3));
+  EXPECT_FALSE(pool.Ready());
+  PredictRequest request;
+  request.set_input("1.0");
+  EXPECT_FALSE(pool.Predict(request).ok());
+}
+
+TEST_F(InferenceSidecarPoolTest, ReportsReadiness) {
+  // Outlive the health check of the pool, which calls the listener.
+  absl::Notification reported;
+  bool reported_ready = false;
+  InferenceSidecarPool pool(GetFilePath(kSidecarBinary), kRuntimeConfig, 1);
+  EXPECT_FALSE(pool.Ready());
+  ASSERT_TRUE(pool.Start().ok());
+  EXPECT_TRUE(pool.Ready());
+
+  pool.SetReadinessListener([&reported, &reported_ready](bool ready) {
+    reported_ready = ready;
+    if (!reported.HasBeenNotified()) {
+      reported.Notify();
+    }
+  });
+  ASSERT_TRUE(reported.WaitForNotificationWithTimeout(absl::Seconds(5)));
+  EXPECT_TRUE(reported_ready);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
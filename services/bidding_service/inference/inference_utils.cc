@@ -21,50 +21,71 @@
 #include <utility>
 #include <vector>
 
-#include <grpcpp/grpcpp.h>
-#include <grpcpp/server_context.h>
-#include <grpcpp/server_posix.h>
-
 #include "absl/base/const_init.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
-#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/mutex.h"
-#include "proto/inference_sidecar.grpc.pb.h"
+#include "absl/time/time.h"
+#include "rapidjson/document.h"
 #include "services/bidding_service/inference/inference_flags.h"
+#include "services/bidding_service/inference/inference_metrics.h"
+#include "services/bidding_service/inference/periodic_model_fetcher.h"
 #include "services/common/clients/code_dispatcher/request_context.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/log_throttle.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/logger/request_context_logger.h"
 #include "src/roma/interface/roma.h"
 #include "src/util/status_macro/status_macros.h"
-#include "src/util/status_macro/status_util.h"
 #include "utils/file_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Inference errors of every generateBid are logged once a second at most.
+constexpr int kInferenceErrorLogIntervalSec = 1;
 
-SandboxExecutor& Executor() {
+}  // namespace
+
+InferenceSidecarPool& SidecarPool() {
   // TODO(b/314976301): Use absl::NoDestructor<T> when it becomes available.
   // Static object will be lazily initiated within static storage.
 
-  // TODO(b/317124648): Pass a SandboxExecutor object via Roma's `TMetadata`.
-  static SandboxExecutor* executor = new SandboxExecutor(
+  // TODO(b/317124648): Pass the sidecar pool via Roma's `TMetadata`.
+  static InferenceSidecarPool* pool = new InferenceSidecarPool(
       *absl::GetFlag(FLAGS_inference_sidecar_binary_path),
-      {*absl::GetFlag(FLAGS_inference_sidecar_runtime_config)});
-  return *executor;
+      absl::GetFlag(FLAGS_inference_sidecar_runtime_config).value_or("{}"),
+      absl::GetFlag(FLAGS_inference_sidecar_num_replicas).value_or(1),
+      absl::GetFlag(FLAGS_inference_sidecar_standby).value_or(false));
+  return *pool;
 }
 
-std::shared_ptr<grpc::Channel> InferenceChannel(
-    const SandboxExecutor& executor) {
-  // TODO(b/314976301): Use absl::NoDestructor<T> when it becomes available.
-  // Static object will be lazily initiated within static storage.
+InferenceCache* OutputCache() {
+  static InferenceCache* cache = []() -> InferenceCache* {
+    const int64_t max_bytes =
+        absl::GetFlag(FLAGS_inference_cache_max_bytes).value_or(0);
+    if (max_bytes <= 0) {
+      return nullptr;
+    }
+    const int64_t ttl_ms =
+        absl::GetFlag(FLAGS_inference_cache_ttl_ms).value_or(0);
+    return new InferenceCache(max_bytes, ttl_ms > 0
+                                             ? absl::Milliseconds(ttl_ms)
+                                             : absl::InfiniteDuration());
+  }();
+  return cache;
+}
 
-  // TODO(b/317124648): Pass a gRPC channel object via Roma's `TMetadata`.
-  static std::shared_ptr<grpc::Channel> client_channel =
-      grpc::CreateInsecureChannelFromFd("GrpcChannel",
-                                        executor.FileDescriptor());
-  return client_channel;
+absl::Status RegisterModel(const RegisterModelRequest& request) {
+  absl::Status status = SidecarPool().RegisterModel(request);
+  // Drops the outputs even on failure, since some replicas may have swapped
+  // the model.
+  if (InferenceCache* cache = OutputCache(); cache != nullptr) {
+    cache->InvalidateModel(request.model_spec().model_path());
+  }
+  return status;
 }
 
 absl::Status RegisterModelsFromLocal(const std::vector<std::string>& paths) {
@@ -72,21 +93,10 @@ absl::Status RegisterModelsFromLocal(const std::vector<std::string>& paths) {
     return absl::NotFoundError("No model to register in local disk");
   }
 
-  SandboxExecutor& executor = Executor();
-  std::unique_ptr<InferenceService::StubInterface> stub =
-      InferenceService::NewStub(InferenceChannel(executor));
-
   for (const auto& path : paths) {
     RegisterModelRequest register_request;
     PS_RETURN_IF_ERROR(PopulateRegisterModelRequest(path, register_request));
-    grpc::ClientContext context;
-    RegisterModelResponse register_response;
-    grpc::Status status =
-        stub->RegisterModel(&context, register_request, &register_response);
-
-    if (!status.ok()) {
-      return server_common::ToAbslStatus(status);
-    }
+    PS_RETURN_IF_ERROR(RegisterModel(register_request));
   }
   return absl::OkStatus();
 }
@@ -102,61 +112,92 @@ absl::Status RegisterModelsFromBucket(
     return absl::NotFoundError("No model to register in the cloud bucket");
   }
 
-  SandboxExecutor& executor = Executor();
-  std::unique_ptr<InferenceService::StubInterface> stub =
-      InferenceService::NewStub(InferenceChannel(executor));
-
   for (const auto& model_path : paths) {
-    RegisterModelRequest request;
-    request.mutable_model_spec()->set_model_path(model_path);
-    PS_VLOG(10) << "model_path: " << model_path;
-
-    for (const BlobFetcher::Blob& blob : blobs) {
-      if (absl::StartsWith(blob.path, model_path)) {
-        (*request.mutable_model_files())[blob.path] = blob.bytes;
-        PS_VLOG(10) << "model_files: " << blob.path;
-      }
+    RegisterModelRequest request = BuildRegisterModelRequest(model_path, blobs);
+    PS_VLOG(10) << "model_path: " << model_path
+                << ", version: " << request.model_spec().version();
+    for (const auto& [file_path, bytes] : request.model_files()) {
+      PS_VLOG(10) << "model_files: " << file_path;
     }
 
-    grpc::ClientContext context;
-    RegisterModelResponse response;
-    grpc::Status status = stub->RegisterModel(&context, request, &response);
-
-    if (!status.ok()) {
-      return server_common::ToAbslStatus(status);
-    }
+    PS_RETURN_IF_ERROR(RegisterModel(request));
   }
   // TODO(b/316960066): Handles register models response once the proto has been
   // fleshed out.
   return absl::OkStatus();
 }
 
+namespace {
+
+absl::StatusOr<std::string> PredictWithSidecar(absl::string_view input,
+                                               absl::Time deadline) {
+  PredictRequest predict_request;
+  predict_request.set_input(input.data(), input.size());
+  if (deadline != absl::InfiniteFuture()) {
+    predict_request.set_deadline_unix_micros(absl::ToUnixMicros(deadline));
+  }
+  PS_ASSIGN_OR_RETURN(PredictResponse predict_response,
+                      SidecarPool().Predict(predict_request));
+  RecordModelMetrics(predict_response);
+  return std::move(*predict_response.mutable_output());
+}
+
+// Returns the deadline of the Roma execution calling the API, if any.
+absl::Time RomaDeadline(const RomaRequestSharedContext& shared_context) {
+  absl::StatusOr<std::shared_ptr<RomaRequestContext>> context =
+      shared_context.GetRomaRequestContext();
+  if (!context.ok()) {
+    return absl::InfiniteFuture();
+  }
+  return (*context)->GetDeadline();
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> RunBatchInference(absl::string_view input,
+                                              absl::Time deadline) {
+  auto predict = [deadline](absl::string_view request) {
+    return PredictWithSidecar(request, deadline);
+  };
+  if (InferenceCache* cache = OutputCache(); cache != nullptr) {
+    return cache->Predict(input, predict);
+  }
+  return predict(input);
+}
+
+std::string InferenceErrorToJson(const absl::Status& status) {
+  rapidjson::Document document;
+  document.SetObject();
+  rapidjson::MemoryPoolAllocator<>& allocator = document.GetAllocator();
+  rapidjson::Value error(rapidjson::kObjectType);
+  error.AddMember("code", static_cast<int>(status.code()), allocator);
+  rapidjson::Value message;
+  message.SetString(status.message().data(), status.message().size(),
+                    allocator);
+  error.AddMember("message", message, allocator);
+  document.AddMember("error", error, allocator);
+  absl::StatusOr<std::string> json = SerializeJsonDoc(document);
+  return json.ok() ? *std::move(json) : R"({"error":{"code":2}})";
+}
+
 void RunInference(
     google::scp::roma::FunctionBindingPayload<RomaRequestSharedContext>&
         wrapper) {
   const std::string& payload = wrapper.io_proto.input_string();
 
-  SandboxExecutor& executor = Executor();
-  std::unique_ptr<InferenceService::StubInterface> stub =
-      InferenceService::NewStub(InferenceChannel(executor));
-
   PS_VLOG(kNoisyInfo) << "RunInference input: " << payload;
-  PredictRequest predict_request;
-  predict_request.set_input(payload);
-
-  grpc::ClientContext context;
-  PredictResponse predict_response;
-  grpc::Status rpc_status =
-      stub->Predict(&context, predict_request, &predict_response);
-  if (rpc_status.ok()) {
-    wrapper.io_proto.set_output_string(predict_response.output());
-    PS_VLOG(10) << "Inference response received: "
-                << predict_response.DebugString();
+  absl::StatusOr<std::string> output =
+      RunBatchInference(payload, RomaDeadline(wrapper.metadata));
+  if (output.ok()) {
+    PS_VLOG(10) << "Inference response received: " << *output;
+    wrapper.io_proto.set_output_string(*std::move(output));
     return;
   }
-  absl::Status status = server_common::ToAbslStatus(rpc_status);
-  // TODO(b/321284008): Communicate inference failure with JS caller.
-  PS_LOG(ERROR) << "Response error: " << status.message();
+  // The caller gets the error rather than waiting out its Roma timeout, e.g.
+  // to fall back to a bid without the model.
+  PS_LOG_EVERY_N_SEC(kInferenceErrorLogIntervalSec, ERROR)
+      << "Response error: " << output.status().message();
+  wrapper.io_proto.set_output_string(InferenceErrorToJson(output.status()));
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
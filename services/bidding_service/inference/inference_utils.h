@@ -19,9 +19,13 @@
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "proto/inference_sidecar.pb.h"
-#include "sandbox/sandbox_executor.h"
+#include "services/bidding_service/inference/inference_cache.h"
+#include "services/bidding_service/inference/inference_sidecar_pool.h"
 #include "services/common/blob_fetch/blob_fetcher.h"
 #include "services/common/clients/code_dispatcher/request_context.h"
 #include "src/roma/interface/roma.h"
@@ -30,8 +34,16 @@ namespace privacy_sandbox::bidding_auction_servers::inference {
 
 constexpr absl::string_view kInferenceFunctionName = "runInference";
 
-// Accesses a sandbox exectuor that uses static storage.
-SandboxExecutor& Executor();
+// Accesses the inference sidecar replicas, which use static storage.
+InferenceSidecarPool& SidecarPool();
+
+// Accesses the cache of the model outputs, which uses static storage. Null if
+// the outputs are not cached.
+InferenceCache* OutputCache();
+
+// Registers a model, or a new version of it, with the inference sidecar and
+// drops its cached outputs.
+absl::Status RegisterModel(const RegisterModelRequest& request);
 
 // Registers AdTech models with the inference sidecar. These models are
 // downloaded to the bidding server and sent to the inference sidecar via IPC.
@@ -40,8 +52,24 @@ absl::Status RegisterModelsFromBucket(
     absl::string_view bucket_name, const std::vector<std::string>& paths,
     const std::vector<BlobFetcher::Blob>& blobs);
 
+// Sends a JSON inference request, such as the merged request of all the
+// interest groups of a GenerateBids request, to the inference sidecar and
+// returns its JSON output. Cached model outputs are not sent again. Fails with
+// DeadlineExceeded once the `deadline` is past, and the sidecar drops the
+// request if it is still queued then.
+absl::StatusOr<std::string> RunBatchInference(
+    absl::string_view input, absl::Time deadline = absl::InfiniteFuture());
+
+// Returns the JSON output of a failed inference request for the JS caller,
+// {"error":{"code":<absl::StatusCode>,"message":"..."}}, in the format of the
+// errors of the models of a request allowing partial results.
+std::string InferenceErrorToJson(const absl::Status& status);
+
 // Registered with Roma to provide an inference API in JS code. It sends a
-// single inference request to the inference sidecar.
+// single inference request to the inference sidecar, bounded by the deadline
+// of the Roma execution, see RomaRequestContext::GetDeadline. If it fails,
+// e.g. since the sidecar is overloaded, JS gets the InferenceErrorToJson of
+// the failure, to fall back to a bid without the model.
 //
 // wrapper: Inference request backed by JS string.
 void RunInference(
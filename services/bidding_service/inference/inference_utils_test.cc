@@ -18,8 +18,11 @@
 #include "absl/flags/reflection.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "gtest/gtest.h"
 #include "services/bidding_service/inference/inference_flags.h"
+#include "services/common/clients/code_dispatcher/request_context.h"
 #include "src/roma/interface/roma.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
@@ -55,8 +58,7 @@ class InferenceUtilsTest : public ::testing::Test {
 // tests.
 
 TEST_F(InferenceUtilsTest, ReturnValueIsSet) {
-  SandboxExecutor& inference_executor = Executor();
-  CHECK_EQ(inference_executor.StartSandboxee().code(), absl::StatusCode::kOk);
+  CHECK_EQ(SidecarPool().Start().code(), absl::StatusCode::kOk);
 
   ASSERT_TRUE(RegisterModelsFromLocal({std::string(kTestModelPath)}).ok());
   google::scp::roma::proto::FunctionBindingIoProto input_output_proto;
@@ -70,12 +72,31 @@ TEST_F(InferenceUtilsTest, ReturnValueIsSet) {
   // populate the output string.
   ASSERT_EQ(wrapper.io_proto.output_string(), "0.57721");
 
-  absl::StatusOr<sandbox2::Result> result = inference_executor.StopSandboxee();
+  absl::StatusOr<sandbox2::Result> result = SidecarPool().StopReplica(0);
   ASSERT_TRUE(result.ok());
   ASSERT_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
   ASSERT_EQ(result->reason_code(), 0);
 }
 
+TEST_F(InferenceUtilsTest, ReturnsErrorToJsPastTheRomaDeadline) {
+  RomaRequestContextFactory context_factory({}, {});
+  context_factory.SetDeadline(absl::Now() - absl::Seconds(1));
+  google::scp::roma::proto::FunctionBindingIoProto input_output_proto;
+  google::scp::roma::FunctionBindingPayload<RomaRequestSharedContext> wrapper{
+      input_output_proto, context_factory.Create()};
+  wrapper.io_proto.set_input_string("1.0");
+  wrapper.io_proto.set_output_string(kInit);
+  RunInference(wrapper);
+  EXPECT_EQ(wrapper.io_proto.output_string(),
+            R"({"error":{"code":4,"message":)"
+            R"("Predict request expired before it was sent"}})");
+}
+
+TEST(InferenceErrorToJsonTest, HoldsTheCodeAndMessage) {
+  EXPECT_EQ(InferenceErrorToJson(absl::UnavailableError("Sidecar \"down\"")),
+            R"({"error":{"code":14,"message":"Sidecar \"down\""}})");
+}
+
 TEST_F(InferenceUtilsTest, RegisterModelsFromLocal_NoPath_Error) {
   EXPECT_EQ(RegisterModelsFromLocal({}).code(), absl::StatusCode::kNotFound);
 }
@@ -0,0 +1,159 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/periodic_model_fetcher.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "src/logger/request_context_logger.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+using ::google::scp::cpio::BlobStorageClientInterface;
+
+namespace {
+
+// Returns the blobs under the model path, which are adjacent in blobs sorted
+// by path.
+absl::Span<const BlobFetcher::Blob> ModelBlobs(
+    absl::string_view model_path, const std::vector<BlobFetcher::Blob>& blobs) {
+  auto begin = std::lower_bound(
+      blobs.begin(), blobs.end(), model_path,
+      [](const BlobFetcher::Blob& blob, absl::string_view path) {
+        return absl::string_view(blob.path) < path;
+      });
+  auto end = begin;
+  while (end != blobs.end() && absl::StartsWith(end->path, model_path)) {
+    ++end;
+  }
+  return absl::MakeConstSpan(blobs.data() + (begin - blobs.begin()),
+                             end - begin);
+}
+
+std::string ModelVersion(absl::Span<const BlobFetcher::Blob> model_blobs) {
+  std::vector<std::pair<absl::string_view, absl::string_view>> files;
+  files.reserve(model_blobs.size());
+  for (const BlobFetcher::Blob& blob : model_blobs) {
+    files.emplace_back(blob.path, blob.bytes);
+  }
+  return absl::StrCat(
+      absl::Hex(absl::Hash<decltype(files)>()(files), absl::kZeroPad16));
+}
+
+RegisterModelRequest BuildRegisterModelRequest(
+    absl::string_view model_path,
+    absl::Span<const BlobFetcher::Blob> model_blobs, std::string version) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path(std::string(model_path));
+  request.mutable_model_spec()->set_version(std::move(version));
+  for (const BlobFetcher::Blob& blob : model_blobs) {
+    (*request.mutable_model_files())[blob.path] = blob.bytes;
+  }
+  return request;
+}
+
+}  // namespace
+
+RegisterModelRequest BuildRegisterModelRequest(
+    absl::string_view model_path, const std::vector<BlobFetcher::Blob>& blobs) {
+  absl::Span<const BlobFetcher::Blob> model_blobs =
+      ModelBlobs(model_path, blobs);
+  return BuildRegisterModelRequest(model_path, model_blobs,
+                                   ModelVersion(model_blobs));
+}
+
+PeriodicModelFetcher::PeriodicModelFetcher(
+    absl::string_view bucket_name, std::vector<std::string> model_paths,
+    absl::Duration fetch_period, server_common::Executor* executor,
+    std::unique_ptr<BlobStorageClientInterface> blob_storage_client,
+    RegisterModelFn register_model)
+    : bucket_name_(bucket_name),
+      model_paths_(std::move(model_paths)),
+      fetch_period_(fetch_period),
+      executor_(*executor),
+      // Only fetches the files of the models.
+      blob_fetcher_(bucket_name, executor, std::move(blob_storage_client),
+                    {.included_prefixes = model_paths_}),
+      register_model_(std::move(register_model)) {}
+
+absl::Status PeriodicModelFetcher::Start() {
+  absl::Status status = FetchAndRegister();
+  if (fetch_period_ > absl::ZeroDuration()) {
+    task_id_ = executor_.RunAfter(fetch_period_,
+                                  [this]() { PeriodicFetchAndRegister(); });
+  }
+  return status;
+}
+
+void PeriodicModelFetcher::End() {
+  if (task_id_.has_value()) {
+    executor_.Cancel(*task_id_);
+    task_id_ = std::nullopt;
+  }
+}
+
+absl::Status PeriodicModelFetcher::FetchAndRegister() {
+  PS_RETURN_IF_ERROR(blob_fetcher_.FetchSync());
+  absl::Status status;
+  for (const std::string& model_path : model_paths_) {
+    absl::Span<const BlobFetcher::Blob> model_blobs =
+        ModelBlobs(model_path, blob_fetcher_.snapshot());
+    if (model_blobs.empty()) {
+      status.Update(absl::NotFoundError(absl::StrCat(
+          "No file of model ", model_path, " in bucket ", bucket_name_)));
+      continue;
+    }
+    // Unchanged models are skipped before their files are copied.
+    std::string version = ModelVersion(model_blobs);
+    auto it = versions_.find(model_path);
+    if (it != versions_.end() && it->second == version) {
+      continue;
+    }
+    RegisterModelRequest request =
+        BuildRegisterModelRequest(model_path, model_blobs, version);
+    PS_VLOG(10) << "Registering model " << model_path << " version "
+                << version;
+    // Versions which failed to register are tried again on the next fetch.
+    if (absl::Status register_status = register_model_(request);
+        !register_status.ok() && !absl::IsAlreadyExists(register_status)) {
+      PS_LOG(ERROR) << "Failed to register model " << model_path
+                    << " version " << version << ": " << register_status;
+      status.Update(register_status);
+      continue;
+    }
+    versions_[model_path] = version;
+  }
+  return status;
+}
+
+void PeriodicModelFetcher::PeriodicFetchAndRegister() {
+  if (absl::Status status = FetchAndRegister(); !status.ok()) {
+    PS_LOG(ERROR) << "Periodic model fetch failed for bucket " << bucket_name_
+                  << ": " << status << ". Will try again in " << fetch_period_;
+  }
+  task_id_ = executor_.RunAfter(fetch_period_,
+                                [this]() { PeriodicFetchAndRegister(); });
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
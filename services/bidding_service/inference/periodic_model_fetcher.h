@@ -0,0 +1,93 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BIDDING_SERVICE_INFERENCE_PERIODIC_MODEL_FETCHER_H_
+#define SERVICES_BIDDING_SERVICE_INFERENCE_PERIODIC_MODEL_FETCHER_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.pb.h"
+#include "services/common/blob_fetch/blob_fetcher.h"
+#include "src/concurrent/executor.h"
+#include "src/public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Builds the registration request of the model from the bucket files under
+// its path, with blobs sorted by path as in BlobFetcher::snapshot(). The
+// version of the model is a fingerprint of its files, so that changed files
+// register as a new version.
+RegisterModelRequest BuildRegisterModelRequest(
+    absl::string_view model_path, const std::vector<BlobFetcher::Blob>& blobs);
+
+// Fetches the models from a cloud bucket and registers them, then polls the
+// bucket and registers a new version of each model whose files changed.
+class PeriodicModelFetcher {
+ public:
+  using RegisterModelFn =
+      absl::AnyInvocable<absl::Status(const RegisterModelRequest&)>;
+
+  // `model_paths`: The bucket paths of the models.
+  // `register_model`: Registers a model, or a new version of it.
+  PeriodicModelFetcher(
+      absl::string_view bucket_name, std::vector<std::string> model_paths,
+      absl::Duration fetch_period, server_common::Executor* executor,
+      std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
+          blob_storage_client,
+      RegisterModelFn register_model);
+
+  ~PeriodicModelFetcher() { End(); }
+
+  // Not copyable or movable.
+  PeriodicModelFetcher(const PeriodicModelFetcher&) = delete;
+  PeriodicModelFetcher& operator=(const PeriodicModelFetcher&) = delete;
+
+  // Fetches and registers the models, then starts the periodic fetch. This
+  // may only be called once.
+  absl::Status Start();
+  // Ends the periodic fetch by canceling the last scheduled task.
+  void End();
+
+ private:
+  // Fetches the bucket and registers the models whose files changed since
+  // their last registration.
+  absl::Status FetchAndRegister();
+  void PeriodicFetchAndRegister();
+
+  const std::string bucket_name_;
+  const std::vector<std::string> model_paths_;
+  const absl::Duration fetch_period_;
+  server_common::Executor& executor_;
+  BlobFetcher blob_fetcher_;
+  RegisterModelFn register_model_;
+
+  // Versions of the registered models, by model path. Only touched by the
+  // fetches, which run one at a time.
+  absl::flat_hash_map<std::string, std::string> versions_;
+
+  // Keeps track of the next task to be performed on the executor.
+  std::optional<server_common::TaskId> task_id_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_BIDDING_SERVICE_INFERENCE_PERIODIC_MODEL_FETCHER_H_
@@ -0,0 +1,156 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/inference/periodic_model_fetcher.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+#include "src/core/interface/async_context.h"
+#include "src/public/cpio/mock/blob_storage_client/mock_blob_storage_client.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobRequest;
+using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobResponse;
+using ::google::cmrt::sdk::blob_storage_service::v1::ListBlobsMetadataRequest;
+using ::google::cmrt::sdk::blob_storage_service::v1::ListBlobsMetadataResponse;
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::SuccessExecutionResult;
+using ::google::scp::cpio::MockBlobStorageClient;
+
+constexpr char kBucketName[] = "BucketName";
+constexpr char kModelPath[] = "models/pcvr";
+constexpr char kModelFile[] = "models/pcvr/saved_model.pb";
+constexpr char kOtherModelFile[] = "models/pctr/saved_model.pb";
+constexpr absl::Duration kFetchPeriod = absl::Minutes(1);
+
+TEST(BuildRegisterModelRequestTest, VersionsModelsByTheirFiles) {
+  std::vector<BlobFetcher::Blob> blobs = {{kOtherModelFile, "v1"},
+                                          {kModelFile, "v1"}};
+  RegisterModelRequest request = BuildRegisterModelRequest(kModelPath, blobs);
+  EXPECT_EQ(request.model_spec().model_path(), kModelPath);
+  ASSERT_EQ(request.model_files().size(), 1);
+  EXPECT_EQ(request.model_files().at(kModelFile), "v1");
+  EXPECT_FALSE(request.model_spec().version().empty());
+
+  blobs[0].bytes = "v2";
+  EXPECT_EQ(BuildRegisterModelRequest(kModelPath, blobs).model_spec().version(),
+            request.model_spec().version());
+  blobs[1].bytes = "v2";
+  EXPECT_NE(BuildRegisterModelRequest(kModelPath, blobs).model_spec().version(),
+            request.model_spec().version());
+}
+
+class PeriodicModelFetcherTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    EXPECT_CALL(executor_, Run)
+        .WillRepeatedly([](absl::AnyInvocable<void()> closure) { closure(); });
+    EXPECT_CALL(executor_, RunAfter)
+        .WillRepeatedly(
+            [this](absl::Duration duration,
+                   absl::AnyInvocable<void()> closure) {
+              EXPECT_EQ(duration, kFetchPeriod);
+              next_fetch_ = std::move(closure);
+              return server_common::TaskId();
+            });
+    EXPECT_CALL(executor_, Cancel).WillRepeatedly([](auto) { return true; });
+
+    auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+    EXPECT_CALL(*blob_storage_client, ListBlobsMetadata)
+        .WillRepeatedly(
+            [](AsyncContext<ListBlobsMetadataRequest, ListBlobsMetadataResponse>
+                   context) {
+              context.response = std::make_shared<ListBlobsMetadataResponse>();
+              context.response->add_blob_metadatas()->set_blob_name(
+                  kModelFile);
+              context.result = SuccessExecutionResult();
+              context.Finish();
+              return absl::OkStatus();
+            });
+    EXPECT_CALL(*blob_storage_client, GetBlob)
+        .WillRepeatedly(
+            [this](AsyncContext<GetBlobRequest, GetBlobResponse> context) {
+              context.response = std::make_shared<GetBlobResponse>();
+              auto* blob = context.response->mutable_blob();
+              blob->mutable_metadata()->set_blob_name(
+                  context.request->blob_metadata().blob_name());
+              blob->set_data(model_bytes_);
+              context.result = SuccessExecutionResult();
+              context.Finish();
+              return absl::OkStatus();
+            });
+    fetcher_ = std::make_unique<PeriodicModelFetcher>(
+        kBucketName, std::vector<std::string>{kModelPath}, kFetchPeriod,
+        &executor_, std::move(blob_storage_client),
+        [this](const RegisterModelRequest& request) {
+          registered_.push_back(request);
+          return register_status_;
+        });
+  }
+
+  // Runs the scheduled fetch, which schedules the next one.
+  void RunNextFetch() {
+    absl::AnyInvocable<void()> fetch = std::move(next_fetch_);
+    fetch();
+  }
+
+  MockExecutor executor_;
+  std::unique_ptr<PeriodicModelFetcher> fetcher_;
+  absl::AnyInvocable<void()> next_fetch_;
+  std::string model_bytes_ = "v1";
+  absl::Status register_status_;
+  std::vector<RegisterModelRequest> registered_;
+};
+
+TEST_F(PeriodicModelFetcherTest, RegistersChangedModels) {
+  ASSERT_TRUE(fetcher_->Start().ok());
+  ASSERT_EQ(registered_.size(), 1);
+  EXPECT_EQ(registered_[0].model_files().at(kModelFile), "v1");
+
+  // Unchanged models are not registered again.
+  RunNextFetch();
+  EXPECT_EQ(registered_.size(), 1);
+
+  model_bytes_ = "v2";
+  RunNextFetch();
+  ASSERT_EQ(registered_.size(), 2);
+  EXPECT_EQ(registered_[1].model_files().at(kModelFile), "v2");
+  EXPECT_NE(registered_[1].model_spec().version(),
+            registered_[0].model_spec().version());
+}
+
+TEST_F(PeriodicModelFetcherTest, RetriesFailedRegistrations) {
+  register_status_ = absl::UnavailableError("Sidecar is restarting");
+  EXPECT_EQ(fetcher_->Start().code(), absl::StatusCode::kUnavailable);
+  ASSERT_EQ(registered_.size(), 1);
+
+  register_status_ = absl::OkStatus();
+  RunNextFetch();
+  EXPECT_EQ(registered_.size(), 2);
+  RunNextFetch();
+  EXPECT_EQ(registered_.size(), 2);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
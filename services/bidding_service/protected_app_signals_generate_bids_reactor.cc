@@ -28,6 +28,7 @@
 #include "public/applications/pas/retrieval_response_parser.h"
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 #include "services/bidding_service/constants.h"
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
 #include "services/common/feature_flags.h"
 #include "services/common/util/json_util.h"
 #include "services/common/util/reporting_util.h"
@@ -66,6 +67,14 @@ inline std::string GetBidDebugInfo(const ProtectedAppSignalsAdWithBid& bid) {
                       ", has debug report urls: ", bid.has_debug_report_urls());
 }
 
+// Returns the prepared data for ads retrieval in the response of the
+// prepareDataForAdsRetrieval UDF.
+absl::StatusOr<std::string> ParsePrepareDataForAdsRetrievalResponse(
+    const std::string& response) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  return SerializeJsonDoc(document["response"]);
+}
+
 }  // namespace
 
 ProtectedAppSignalsGenerateBidsReactor::ProtectedAppSignalsGenerateBidsReactor(
@@ -89,6 +98,10 @@ ProtectedAppSignalsGenerateBidsReactor::ProtectedAppSignalsGenerateBidsReactor(
       ad_bids_retrieval_timeout_ms_(runtime_config.ad_retrieval_timeout_ms),
       metadata_(GrpcMetadataToRequestMetadata(context->client_metadata(),
                                               kBuyerMetadataKeysMap)),
+      enable_pipelined_ads_retrieval_(
+          runtime_config.enable_pipelined_ads_retrieval),
+      ads_metadata_cache_(runtime_config.ads_metadata_cache),
+      prepared_data_cache_(runtime_config.prepared_data_cache),
       protected_app_signals_generate_bid_version_(
           runtime_config.default_protected_app_signals_generate_bid_version),
       ad_retrieval_version_(runtime_config.default_ad_retrieval_version) {
@@ -153,6 +166,37 @@ ProtectedAppSignalsGenerateBidsReactor::CreateKVLookupRequest(
   return request;
 }
 
+std::unique_ptr<kv_server::v2::GetValuesResponse>
+ProtectedAppSignalsGenerateBidsReactor::GetCachedAdsMetadata() {
+  // Lookups with a consented debug config are not shared with other requests.
+  if (ads_metadata_cache_ == nullptr ||
+      raw_request_.has_consented_debug_config()) {
+    return nullptr;
+  }
+  std::shared_ptr<const kv_server::v2::GetValuesResponse> cached =
+      ads_metadata_cache_->LookUp(GetAdsMetadataCacheKey(
+          raw_request_.contextual_protected_app_signals_data()
+              .ad_render_ids()));
+  if (cached == nullptr) {
+    return nullptr;
+  }
+  PS_VLOG(8, log_context_) << "Using cached ads metadata";
+  return std::make_unique<kv_server::v2::GetValuesResponse>(*cached);
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::CacheAdsMetadata(
+    const kv_server::v2::GetValuesResponse& response) {
+  if (ads_metadata_cache_ == nullptr ||
+      raw_request_.has_consented_debug_config()) {
+    return;
+  }
+  ads_metadata_cache_->Insert(
+      GetAdsMetadataCacheKey(
+          raw_request_.contextual_protected_app_signals_data()
+              .ad_render_ids()),
+      std::make_shared<const kv_server::v2::GetValuesResponse>(response));
+}
+
 void ProtectedAppSignalsGenerateBidsReactor::FetchAds(
     const std::string& prepare_data_for_ads_retrieval_response) {
   PS_VLOG(8, log_context_) << __func__;
@@ -171,7 +215,7 @@ void ProtectedAppSignalsGenerateBidsReactor::FetchAds(
         OnFetchAdsDataDone(*std::move(ad_retrieval_result),
                            prepare_data_for_ads_retrieval_response);
       },
-      absl::Milliseconds(ad_bids_retrieval_timeout_ms_));
+      absl::Milliseconds(ad_bids_retrieval_timeout_ms_), cancellation_);
 
   if (!status.ok()) {
     PS_VLOG(kNoisyWarn, log_context_)
@@ -214,7 +258,9 @@ ProtectedAppSignalsGenerateBidsReactor::CreateGenerateBidsRequest(
   PopulateArgInRomaRequest(
       GetFeatureFlagJson(enable_adtech_code_logging_,
                          enable_buyer_debug_url_generation_ &&
-                             raw_request_.enable_debug_reporting()),
+                             raw_request_.enable_debug_reporting(),
+                         /*enable_udf_profiling=*/enable_adtech_code_logging_ &&
+                             log_context_.is_consented()),
       ArgIndex(GenerateBidsUdfArgs::kFeatureFlags), input);
   DispatchRequest request = {
       .id = raw_request_.log_context().generation_id(),
@@ -223,7 +269,9 @@ ProtectedAppSignalsGenerateBidsReactor::CreateGenerateBidsRequest(
       .input = std::move(input),
       .metadata = roma_request_context_factory_.Create(),
   };
-  request.tags[kTimeoutMs] = roma_timeout_ms_;
+  // The timeout is set by ExecuteRomaRequests, from the deadline of the call.
+  request.tags[kDispatchTenantTag] =
+      std::string(DispatchTenantTagValue(DispatchTenant::kProtectedAppSignals));
   return request;
 }
 
@@ -263,25 +311,30 @@ void ProtectedAppSignalsGenerateBidsReactor::OnFetchAdsDataDone(
         return ParseProtectedSignalsGenerateBidsResponse(response);
       },
       [this](const ProtectedAppSignalsAdWithBid& bid) {
-        if (!IsValidBid(bid)) {
-          PS_VLOG(kNoisyWarn, log_context_)
-              << "Skipping protected app signals bid (" << GetBidDebugInfo(bid)
-              << ")";
-        } else {
-          PS_VLOG(kNoisyInfo, log_context_)
-              << "Successful non-zero protected app signals bid received";
-          auto* added_bid = raw_response_.add_bids();
-          *added_bid = bid;
-          added_bid->clear_egress_payload();
-          if (!raw_request_.enable_unlimited_egress() ||
-              !absl::GetFlag(FLAGS_enable_temporary_unlimited_egress)) {
-            added_bid->clear_temporary_unlimited_egress_payload();
-          }
-        }
+        AddBid(bid);
         EncryptResponseAndFinish(grpc::Status::OK);
       });
 }
 
+void ProtectedAppSignalsGenerateBidsReactor::AddBid(
+    const ProtectedAppSignalsAdWithBid& bid) {
+  if (!IsValidBid(bid)) {
+    PS_VLOG(kNoisyWarn, log_context_)
+        << "Skipping protected app signals bid (" << GetBidDebugInfo(bid)
+        << ")";
+    return;
+  }
+  PS_VLOG(kNoisyInfo, log_context_)
+      << "Successful non-zero protected app signals bid received";
+  auto* added_bid = raw_response_.add_bids();
+  *added_bid = bid;
+  added_bid->clear_egress_payload();
+  if (!raw_request_.enable_unlimited_egress() ||
+      !absl::GetFlag(FLAGS_enable_temporary_unlimited_egress)) {
+    added_bid->clear_temporary_unlimited_egress_payload();
+  }
+}
+
 DispatchRequest ProtectedAppSignalsGenerateBidsReactor::
     CreatePrepareDataForAdsRetrievalRequest() {
   PS_VLOG(8, log_context_) << __func__;
@@ -321,23 +374,48 @@ DispatchRequest ProtectedAppSignalsGenerateBidsReactor::
           << "Roma request input to prepared data for ads retrieval: " << *i;
     }
   }
-  request.tags[kTimeoutMs] = roma_timeout_ms_;
+  // The timeout is set by ExecuteRomaRequests, from the deadline of the call.
+  request.tags[kDispatchTenantTag] =
+      std::string(DispatchTenantTagValue(DispatchTenant::kProtectedAppSignals));
   return request;
 }
 
-void ProtectedAppSignalsGenerateBidsReactor::StartNonContextualAdsRetrieval() {
-  PS_VLOG(8, log_context_) << __func__;
+void ProtectedAppSignalsGenerateBidsReactor::PrepareDataForAdsRetrieval(
+    std::function<void(const std::string&)> on_done,
+    std::function<void(grpc::Status)> on_failure) {
   embeddings_requests_.emplace_back(CreatePrepareDataForAdsRetrievalRequest());
+  // The UDF runs for the logs of the ad tech and for consented debugging.
+  std::string cache_key;
+  if (prepared_data_cache_ != nullptr && !enable_adtech_code_logging_ &&
+      !raw_request_.has_consented_debug_config()) {
+    cache_key = GetPreparedDataCacheKey(ad_retrieval_version_,
+                                        embeddings_requests_.back().input);
+    if (std::shared_ptr<const std::string> cached =
+            prepared_data_cache_->LookUp(cache_key)) {
+      PS_VLOG(8, log_context_) << "Using cached prepared data";
+      on_done(*cached);
+      return;
+    }
+  }
   ExecuteRomaRequests<std::string>(
       embeddings_requests_, kPrepareDataForAdRetrievalHandler,
-      [](const std::string& response) -> absl::StatusOr<std::string> {
-        PS_ASSIGN_OR_RETURN(rapidjson::Document document,
-                            ParseJsonString(response));
-        return SerializeJsonDoc(document["response"]);
+      ParsePrepareDataForAdsRetrievalResponse,
+      [this, cache_key = std::move(cache_key),
+       on_done = std::move(on_done)](const std::string& prepared_data) {
+        if (!cache_key.empty()) {
+          prepared_data_cache_->Insert(
+              cache_key, std::make_shared<const std::string>(prepared_data));
+        }
+        on_done(prepared_data);
       },
-      [this](const std::string& parsed_response) {
-        FetchAds(parsed_response);
-      });
+      std::move(on_failure));
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::StartNonContextualAdsRetrieval() {
+  PS_VLOG(8, log_context_) << __func__;
+  PrepareDataForAdsRetrieval([this](const std::string& parsed_response) {
+    FetchAds(parsed_response);
+  });
 }
 
 bool ProtectedAppSignalsGenerateBidsReactor::IsContextualRetrievalRequest() {
@@ -378,6 +456,11 @@ void ProtectedAppSignalsGenerateBidsReactor::FetchAdsMetadata(
                                       .contextual_protected_app_signals_data()
                                       .ad_render_ids(),
                                   ", ");
+  if (auto cached = GetCachedAdsMetadata()) {
+    OnFetchAdsDataDone(std::move(cached),
+                       prepare_data_for_ads_retrieval_response);
+    return;
+  }
   auto status = kv_async_client_->ExecuteInternal(
       CreateKVLookupRequest(ad_render_ids), {},
       [this, prepare_data_for_ads_retrieval_response](
@@ -391,10 +474,11 @@ void ProtectedAppSignalsGenerateBidsReactor::FetchAdsMetadata(
           return;
         }
 
+        CacheAdsMetadata(**kv_look_up_result);
         OnFetchAdsDataDone(*std::move(kv_look_up_result),
                            prepare_data_for_ads_retrieval_response);
       },
-      absl::Milliseconds(ad_bids_retrieval_timeout_ms_));
+      absl::Milliseconds(ad_bids_retrieval_timeout_ms_), cancellation_);
 
   if (!status.ok()) {
     PS_VLOG(kNoisyWarn, log_context_)
@@ -409,6 +493,194 @@ void ProtectedAppSignalsGenerateBidsReactor::StartContextualAdsRetrieval() {
   FetchAdsMetadata(prepare_data_for_ads_retrieval_response);
 }
 
+bool ProtectedAppSignalsGenerateBidsReactor::IsPipelinedRetrievalRequest() {
+  if (!enable_pipelined_ads_retrieval_ ||
+      !raw_request_.has_contextual_protected_app_signals_data()) {
+    return false;
+  }
+  const auto& protected_app_signals_data =
+      raw_request_.contextual_protected_app_signals_data();
+  return !protected_app_signals_data.ad_render_ids().empty() &&
+         protected_app_signals_data.fetch_ads_from_retrieval_service();
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::StartPipelinedAdsRetrieval() {
+  PS_VLOG(8, log_context_) << __func__;
+  {
+    absl::MutexLock lock(&pipeline_mu_);
+    pending_pipelined_operations_ = 2;
+  }
+  // The contextual ads metadata does not depend on the prepared data, so it
+  // is looked up while prepareDataForAdsRetrieval runs.
+  if (auto cached = GetCachedAdsMetadata()) {
+    OnPipelinedAdsMetadataDone(std::move(cached));
+  } else {
+    auto status = kv_async_client_->ExecuteInternal(
+        CreateKVLookupRequest(
+            raw_request_.contextual_protected_app_signals_data()
+                .ad_render_ids()),
+        {},
+        [this](KVLookUpResult kv_look_up_result) {
+          if (kv_look_up_result.ok()) {
+            CacheAdsMetadata(**kv_look_up_result);
+          }
+          OnPipelinedAdsMetadataDone(std::move(kv_look_up_result));
+        },
+        absl::Milliseconds(ad_bids_retrieval_timeout_ms_), cancellation_);
+    if (!status.ok()) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Failed to execute ads metadata KV lookup request: " << status;
+      OnPipelinedOperationDone(
+          grpc::Status(grpc::INTERNAL, status.ToString()));
+    }
+  }
+
+  PrepareDataForAdsRetrieval(
+      [this](const std::string& prepared_data) {
+        OnPipelinedPrepareDataDone(prepared_data);
+      },
+      [this](grpc::Status status) {
+        OnPipelinedOperationDone(std::move(status));
+      });
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::OnPipelinedPrepareDataDone(
+    const std::string& prepared_data) {
+  PS_VLOG(8, log_context_) << __func__;
+  bool fetch_ads = false;
+  std::unique_ptr<kv_server::v2::GetValuesResponse> contextual_ads;
+  {
+    absl::MutexLock lock(&pipeline_mu_);
+    if (pipeline_status_.ok()) {
+      fetch_ads = true;
+      prepared_data_ = prepared_data;
+      contextual_ads = std::move(contextual_ads_);
+      // Started before this operation is marked as done, so that the RPC is
+      // not finished in between.
+      pending_pipelined_operations_ += contextual_ads ? 2 : 1;
+    }
+  }
+  if (contextual_ads) {
+    GeneratePipelinedBid(std::move(contextual_ads), prepared_data,
+                         contextual_ads_bid_requests_);
+  }
+  if (fetch_ads) {
+    auto status = ad_retrieval_async_client_->ExecuteInternal(
+        CreateAdsRetrievalRequest(prepared_data), {},
+        [this, prepared_data](KVLookUpResult ad_retrieval_result) {
+          OnPipelinedAdsRetrievalDone(std::move(ad_retrieval_result),
+                                      prepared_data);
+        },
+        absl::Milliseconds(ad_bids_retrieval_timeout_ms_), cancellation_);
+    if (!status.ok()) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Failed to execute ad retrieval request: " << status;
+      OnPipelinedOperationDone(
+          grpc::Status(grpc::INTERNAL, status.ToString()));
+    }
+  }
+  OnPipelinedOperationDone(grpc::Status::OK);
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::OnPipelinedAdsMetadataDone(
+    KVLookUpResult result) {
+  PS_VLOG(8, log_context_) << __func__;
+  if (!result.ok()) {
+    PS_VLOG(kNoisyWarn, log_context_)
+        << "KV metadata request failed: " << result.status();
+    OnPipelinedOperationDone(
+        grpc::Status(grpc::INTERNAL, result.status().ToString()));
+    return;
+  }
+  if ((*result)->single_partition().string_output().empty()) {
+    PS_VLOG(4, log_context_) << "No contextual ads data returned by the KV "
+                                "service";
+    OnPipelinedOperationDone(grpc::Status::OK);
+    return;
+  }
+
+  absl::optional<std::string> prepared_data;
+  {
+    absl::MutexLock lock(&pipeline_mu_);
+    if (pipeline_status_.ok() && prepared_data_.has_value()) {
+      prepared_data = prepared_data_;
+      ++pending_pipelined_operations_;
+    } else if (pipeline_status_.ok()) {
+      // generateBid is run once the prepared data is available.
+      contextual_ads_ = *std::move(result);
+    }
+  }
+  if (prepared_data.has_value()) {
+    GeneratePipelinedBid(*std::move(result), *prepared_data,
+                         contextual_ads_bid_requests_);
+  }
+  OnPipelinedOperationDone(grpc::Status::OK);
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::OnPipelinedAdsRetrievalDone(
+    KVLookUpResult result, const std::string& prepared_data) {
+  PS_VLOG(8, log_context_) << __func__;
+  if (!result.ok()) {
+    PS_VLOG(kNoisyWarn, log_context_)
+        << "Ad retrieval request failed: " << result.status();
+    OnPipelinedOperationDone(
+        grpc::Status(grpc::INTERNAL, result.status().ToString()));
+    return;
+  }
+  if ((*result)->single_partition().string_output().empty()) {
+    PS_VLOG(4, log_context_) << "No ads data returned by the ad retrieval "
+                                "service";
+    OnPipelinedOperationDone(grpc::Status::OK);
+    return;
+  }
+  {
+    absl::MutexLock lock(&pipeline_mu_);
+    ++pending_pipelined_operations_;
+  }
+  GeneratePipelinedBid(*std::move(result), prepared_data,
+                       retrieved_ads_bid_requests_);
+  OnPipelinedOperationDone(grpc::Status::OK);
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::GeneratePipelinedBid(
+    std::unique_ptr<kv_server::v2::GetValuesResponse> ads,
+    const std::string& prepared_data, std::vector<DispatchRequest>& requests) {
+  PS_VLOG(8, log_context_) << __func__;
+  requests.emplace_back(
+      CreateGenerateBidsRequest(std::move(ads), prepared_data));
+  ExecuteRomaRequests<ProtectedAppSignalsAdWithBid>(
+      requests, kDispatchHandlerFunctionNameWithCodeWrapper,
+      [this](const std::string& response) {
+        return ParseProtectedSignalsGenerateBidsResponse(response);
+      },
+      [this](const ProtectedAppSignalsAdWithBid& bid) {
+        {
+          absl::MutexLock lock(&pipeline_mu_);
+          AddBid(bid);
+        }
+        OnPipelinedOperationDone(grpc::Status::OK);
+      },
+      [this](grpc::Status status) {
+        OnPipelinedOperationDone(std::move(status));
+      });
+}
+
+void ProtectedAppSignalsGenerateBidsReactor::OnPipelinedOperationDone(
+    grpc::Status status) {
+  grpc::Status pipeline_status;
+  {
+    absl::MutexLock lock(&pipeline_mu_);
+    if (!status.ok() && pipeline_status_.ok()) {
+      pipeline_status_ = std::move(status);
+    }
+    if (--pending_pipelined_operations_ > 0) {
+      return;
+    }
+    pipeline_status = pipeline_status_;
+  }
+  EncryptResponseAndFinish(std::move(pipeline_status));
+}
+
 void ProtectedAppSignalsGenerateBidsReactor::Execute() {
   PS_VLOG(8, log_context_) << __func__;
   PS_VLOG(kEncrypted, log_context_) << "GenerateBidsRequest:\n"
@@ -416,7 +688,9 @@ void ProtectedAppSignalsGenerateBidsReactor::Execute() {
   PS_VLOG(kPlain, log_context_) << "GenerateBidsRawRequest:\n"
                                 << raw_request_.ShortDebugString();
 
-  if (IsContextualRetrievalRequest()) {
+  if (IsPipelinedRetrievalRequest()) {
+    StartPipelinedAdsRetrieval();
+  } else if (IsContextualRetrievalRequest()) {
     StartContextualAdsRetrieval();
   } else {
     // Trigger the request processing workflow to:
@@ -430,8 +704,6 @@ void ProtectedAppSignalsGenerateBidsReactor::Execute() {
 
 void ProtectedAppSignalsGenerateBidsReactor::OnDone() { delete this; }
 
-void ProtectedAppSignalsGenerateBidsReactor::OnCancel() {}
-
 void ProtectedAppSignalsGenerateBidsReactor::EncryptResponseAndFinish(
     grpc::Status status) {
   PS_VLOG(8, log_context_) << __func__;
@@ -440,6 +712,7 @@ void ProtectedAppSignalsGenerateBidsReactor::EncryptResponseAndFinish(
         << "Failed to encrypt the generate app signals bids response.";
     status = grpc::Status(grpc::INTERNAL, kInternalServerError);
   }
+  trace_.End(status);
   Finish(status);
 }
 
@@ -22,12 +22,18 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
 #include "public/query/v2/get_values_v2.pb.h"
 #include "services/bidding_service/base_generate_bids_reactor.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/data/runtime_config.h"
+#include "services/bidding_service/utils/ads_metadata_cache.h"
+#include "services/bidding_service/utils/prepared_data_cache.h"
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
 #include "services/common/clients/kv_server/kv_async_client.h"
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -63,14 +69,41 @@ class ProtectedAppSignalsGenerateBidsReactor
 
  private:
   void OnDone() override;
-  void OnCancel() override;
 
   DispatchRequest CreatePrepareDataForAdsRetrievalRequest();
+  // Runs prepareDataForAdsRetrieval and calls `on_done` with its output, or
+  // `on_failure` (by default, finishing the RPC) if it fails. The output of
+  // a deterministic UDF is reused from the cache for the same inputs.
+  void PrepareDataForAdsRetrieval(
+      std::function<void(const std::string&)> on_done,
+      std::function<void(grpc::Status)> on_failure = nullptr);
 
   bool IsContextualRetrievalRequest();
   void StartContextualAdsRetrieval();
   void StartNonContextualAdsRetrieval();
 
+  // Returns true if the request has both contextual ads and ads to fetch from
+  // the retrieval service, and the pipelined retrieval is enabled.
+  bool IsPipelinedRetrievalRequest();
+  // Looks up the contextual ads metadata while prepareDataForAdsRetrieval
+  // runs, then fetches the retrieved ads and runs generateBid on each set of
+  // ads as soon as both it and the prepared data are available. The RPC is
+  // finished once every pipelined operation is done.
+  void StartPipelinedAdsRetrieval();
+  void OnPipelinedPrepareDataDone(const std::string& prepared_data);
+  void OnPipelinedAdsMetadataDone(
+      absl::StatusOr<std::unique_ptr<kv_server::v2::GetValuesResponse>>
+          result);
+  void OnPipelinedAdsRetrievalDone(
+      absl::StatusOr<std::unique_ptr<kv_server::v2::GetValuesResponse>> result,
+      const std::string& prepared_data);
+  void GeneratePipelinedBid(
+      std::unique_ptr<kv_server::v2::GetValuesResponse> ads,
+      const std::string& prepared_data, std::vector<DispatchRequest>& requests);
+  // Records the end of a pipelined operation, failing the RPC with `status`
+  // if not OK, and finishes the RPC after the last operation.
+  void OnPipelinedOperationDone(grpc::Status status);
+
   using AdRenderIds = google::protobuf::RepeatedPtrField<std::string>;
   std::unique_ptr<kv_server::v2::GetValuesRequest> CreateAdsRetrievalRequest(
       const std::string& prepare_data_for_ads_retrieval_response,
@@ -79,6 +112,11 @@ class ProtectedAppSignalsGenerateBidsReactor
   std::unique_ptr<kv_server::v2::GetValuesRequest> CreateKVLookupRequest(
       const AdRenderIds& ad_render_ids);
 
+  // Returns a copy of the cached metadata of the contextual ads, if any.
+  std::unique_ptr<kv_server::v2::GetValuesResponse> GetCachedAdsMetadata();
+  // Caches the metadata of the contextual ads for later requests.
+  void CacheAdsMetadata(const kv_server::v2::GetValuesResponse& response);
+
   void FetchAds(const std::string& prepare_data_for_ads_retrieval_response);
   void FetchAdsMetadata(
       const std::string& prepare_data_for_ads_retrieval_response);
@@ -91,6 +129,9 @@ class ProtectedAppSignalsGenerateBidsReactor
       std::unique_ptr<kv_server::v2::GetValuesResponse> result,
       const std::string& prepare_data_for_ads_retrieval_response);
 
+  // Adds the bid to the response unless it is invalid.
+  void AddBid(const ProtectedAppSignalsAdWithBid& bid);
+
   void EncryptResponseAndFinish(grpc::Status status);
 
   absl::Status ValidateRomaResponse(
@@ -104,18 +145,39 @@ class ProtectedAppSignalsGenerateBidsReactor
       std::vector<DispatchRequest>& requests,
       absl::string_view roma_entry_function,
       std::function<absl::StatusOr<T>(const std::string&)> parse_response,
-      std::function<void(const T&)> on_successful_response) {
+      std::function<void(const T&)> on_successful_response,
+      std::function<void(grpc::Status)> on_failure = nullptr) {
     PS_VLOG(8, log_context_) << __func__;
+    if (on_failure == nullptr) {
+      on_failure = [this](grpc::Status status) {
+        EncryptResponseAndFinish(std::move(status));
+      };
+    }
+    // Nothing runs once the client has given up on or cancelled the call.
+    absl::StatusOr<std::string> roma_timeout_ms =
+        RomaTimeoutMs(roma_timeout_ms_);
+    if (!roma_timeout_ms.ok()) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "Skipping UDF: " << roma_entry_function
+          << ". Error: " << roma_timeout_ms.status();
+      on_failure(server_common::FromAbslStatus(roma_timeout_ms.status()));
+      return;
+    }
+    SetRomaDeadline(*roma_timeout_ms);
+    for (DispatchRequest& request : requests) {
+      request.tags[kTimeoutMs] = *roma_timeout_ms;
+    }
     auto status = dispatcher_.BatchExecute(
         requests,
         [this, roma_entry_function, parse_response = std::move(parse_response),
-         on_successful_response = std::move(on_successful_response), requests](
+         on_successful_response = std::move(on_successful_response),
+         on_failure, requests](
             const std::vector<absl::StatusOr<DispatchResponse>>& result) {
           if (auto status = ValidateRomaResponse(result); !status.ok()) {
             PS_VLOG(kNoisyWarn, log_context_)
                 << "Failed to run UDF: " << roma_entry_function
                 << ". Error: " << status;
-            EncryptResponseAndFinish(
+            on_failure(
                 grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
             return;
           }
@@ -128,9 +190,8 @@ class ProtectedAppSignalsGenerateBidsReactor
             PS_VLOG(kNoisyWarn, log_context_)
                 << "Failed to parse the response from: " << roma_entry_function
                 << ". Error: " << parsed_response.status();
-            EncryptResponseAndFinish(
-                grpc::Status(grpc::StatusCode::INTERNAL,
-                             parsed_response.status().ToString()));
+            on_failure(grpc::Status(grpc::StatusCode::INTERNAL,
+                                    parsed_response.status().ToString()));
             return;
           }
 
@@ -144,7 +205,7 @@ class ProtectedAppSignalsGenerateBidsReactor
       PS_VLOG(kNoisyWarn, log_context_)
           << "Failed to execute " << roma_entry_function
           << " in Roma. Error: " << status.ToString();
-      EncryptResponseAndFinish(
+      on_failure(
           grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
     }
   }
@@ -155,6 +216,25 @@ class ProtectedAppSignalsGenerateBidsReactor
   RequestMetadata metadata_;
   std::vector<DispatchRequest> embeddings_requests_;
   absl::optional<bool> is_contextual_retrieval_request_;
+  const bool enable_pipelined_ads_retrieval_;
+  std::shared_ptr<AdsMetadataCache> ads_metadata_cache_;
+  std::shared_ptr<PreparedDataCache> prepared_data_cache_;
+
+  // State of the pipelined retrieval.
+  absl::Mutex pipeline_mu_;
+  // Number of pipelined operations started and not done yet.
+  int pending_pipelined_operations_ ABSL_GUARDED_BY(pipeline_mu_) = 0;
+  // First error of the pipelined operations, if any.
+  grpc::Status pipeline_status_ ABSL_GUARDED_BY(pipeline_mu_);
+  // Output of prepareDataForAdsRetrieval, once it has run.
+  absl::optional<std::string> prepared_data_ ABSL_GUARDED_BY(pipeline_mu_);
+  // Contextual ads metadata fetched before the prepared data was available.
+  std::unique_ptr<kv_server::v2::GetValuesResponse> contextual_ads_
+      ABSL_GUARDED_BY(pipeline_mu_);
+  // Roma requests of the generateBid calls for the contextual and the
+  // retrieved ads.
+  std::vector<DispatchRequest> contextual_ads_bid_requests_;
+  std::vector<DispatchRequest> retrieved_ads_bid_requests_;
 
   // UDF versions to use for this request.
   const std::string& protected_app_signals_generate_bid_version_;
@@ -30,6 +30,7 @@
 #include "services/bidding_service/base_generate_bids_reactor.h"
 #include "services/bidding_service/constants.h"
 #include "services/bidding_service/generate_bids_reactor_test_utils.h"
+#include "services/bidding_service/utils/prepared_data_cache.h"
 #include "services/common/clients/kv_server/kv_async_client.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/key_fetcher_factory.h"
@@ -545,6 +546,139 @@ TEST_F(GenerateBidsReactorTest, ContextualAdsMeansKVServiceInvoked) {
   EXPECT_EQ(generated_bid.render(), kTestRenderUrl);
 }
 
+TEST_F(GenerateBidsReactorTest,
+       PipelinedRetrievalGeneratesBidsForContextualAndRetrievedAds) {
+  int num_roma_dispatches = 0;
+  SetupProtectedAppSignalsRomaExpectations(dispatcher_, num_roma_dispatches);
+  auto on_lookup = [](std::unique_ptr<GetValuesRequest> raw_request,
+                      const RequestMetadata& metadata,
+                      absl::AnyInvocable<void(
+                          absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                          on_done,
+                      absl::Duration timeout) {
+    auto response = CreateAdsRetrievalOrKvLookupResponse();
+    EXPECT_TRUE(response.ok()) << response.status();
+    std::move(on_done)(
+        std::make_unique<GetValuesResponse>(*std::move(response)));
+    return absl::OkStatus();
+  };
+  // The contextual ads metadata is looked up before the prepared data for
+  // retrieval is available.
+  EXPECT_CALL(kv_async_client_, ExecuteInternal)
+      .WillOnce([&num_roma_dispatches, &on_lookup](
+                    std::unique_ptr<GetValuesRequest> raw_request,
+                    const RequestMetadata& metadata,
+                    absl::AnyInvocable<void(
+                        absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                        on_done,
+                    absl::Duration timeout) {
+        EXPECT_EQ(num_roma_dispatches, 0);
+        return on_lookup(std::move(raw_request), metadata, std::move(on_done),
+                         timeout);
+      });
+  EXPECT_CALL(ad_retrieval_client_, ExecuteInternal).WillOnce(on_lookup);
+  ContextualProtectedAppSignalsData contextual_pas_data;
+  *contextual_pas_data.mutable_ad_render_ids()->Add() = kTestAdRenderId;
+  contextual_pas_data.set_fetch_ads_from_retrieval_service(true);
+  auto raw_request = CreateRawProtectedAppSignalsRequest(
+      kTestAuctionSignals, kTestBuyerSignals,
+      CreateProtectedAppSignals(kTestAppInstallSignals, kTestEncodingVersion),
+      kSeller, kPublisherName, std::move(contextual_pas_data));
+  auto raw_response = RunReactorWithRequest(
+      raw_request, BiddingServiceRuntimeConfig({
+                       .enable_buyer_debug_url_generation = false,
+                       .enable_adtech_code_logging = false,
+                       .enable_pipelined_ads_retrieval = true,
+                   }));
+
+  // One dispatch to `preparedDataForAdRetrieval` and one to `generateBids` for
+  // each of the contextual and the retrieved ads are expected.
+  ASSERT_EQ(num_roma_dispatches, 3);
+  ASSERT_EQ(raw_response.bids().size(), 2);
+  for (const auto& generated_bid : raw_response.bids()) {
+    EXPECT_EQ(generated_bid.bid(), kTestWinningBid);
+    EXPECT_EQ(generated_bid.render(), kTestRenderUrl);
+  }
+}
+
+TEST_F(GenerateBidsReactorTest, CachedAdsMetadataIsReused) {
+  int num_roma_dispatches = 0;
+  SetupContextualProtectedAppSignalsRomaExpectations(dispatcher_,
+                                                     num_roma_dispatches);
+  EXPECT_CALL(kv_async_client_, ExecuteInternal)
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        auto response = CreateAdsRetrievalOrKvLookupResponse();
+        EXPECT_TRUE(response.ok()) << response.status();
+        std::move(on_done)(
+            std::make_unique<GetValuesResponse>(*std::move(response)));
+        return absl::OkStatus();
+      });
+  ContextualProtectedAppSignalsData contextual_pas_data;
+  *contextual_pas_data.mutable_ad_render_ids()->Add() = kTestAdRenderId;
+  auto raw_request = CreateRawProtectedAppSignalsRequest(
+      kTestAuctionSignals, kTestBuyerSignals,
+      CreateProtectedAppSignals(kTestAppInstallSignals, kTestEncodingVersion),
+      kSeller, kPublisherName, std::move(contextual_pas_data));
+  BiddingServiceRuntimeConfig runtime_config = {
+      .enable_buyer_debug_url_generation = false,
+      .enable_adtech_code_logging = false,
+      .ads_metadata_cache =
+          CreateAdsMetadataCache(/*max_bytes=*/1 << 20, absl::Minutes(1)),
+  };
+
+  // The metadata looked up by the first request is used by the second one.
+  RunReactorWithRequest(raw_request, runtime_config);
+  auto raw_response = RunReactorWithRequest(raw_request, runtime_config);
+
+  ASSERT_EQ(num_roma_dispatches, 2);
+  ASSERT_EQ(raw_response.bids().size(), 1);
+  EXPECT_EQ(raw_response.bids()[0].bid(), kTestWinningBid);
+}
+
+TEST_F(GenerateBidsReactorTest, CachedPreparedDataIsReused) {
+  int num_roma_dispatches = 0;
+  SetupProtectedAppSignalsRomaExpectations(dispatcher_, num_roma_dispatches);
+  EXPECT_CALL(ad_retrieval_client_, ExecuteInternal)
+      .Times(2)
+      .WillRepeatedly(
+          [](std::unique_ptr<GetValuesRequest> raw_request,
+             const RequestMetadata& metadata,
+             absl::AnyInvocable<void(
+                 absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                 on_done,
+             absl::Duration timeout) {
+            auto response = CreateAdsRetrievalOrKvLookupResponse();
+            EXPECT_TRUE(response.ok()) << response.status();
+            std::move(on_done)(
+                std::make_unique<GetValuesResponse>(*std::move(response)));
+            return absl::OkStatus();
+          });
+  auto raw_request = CreateRawProtectedAppSignalsRequest(
+      kTestAuctionSignals, kTestBuyerSignals,
+      CreateProtectedAppSignals(kTestAppInstallSignals, kTestEncodingVersion),
+      kSeller, kPublisherName);
+  BiddingServiceRuntimeConfig runtime_config = {
+      .enable_buyer_debug_url_generation = false,
+      .enable_adtech_code_logging = false,
+      .prepared_data_cache =
+          CreatePreparedDataCache(/*max_bytes=*/1 << 20, absl::Minutes(1)),
+  };
+
+  // The data prepared for the first request is used by the second one, which
+  // only dispatches to `generateBid`.
+  RunReactorWithRequest(raw_request, runtime_config);
+  auto raw_response = RunReactorWithRequest(raw_request, runtime_config);
+
+  ASSERT_EQ(num_roma_dispatches, 3);
+  ASSERT_EQ(raw_response.bids().size(), 1);
+  EXPECT_EQ(raw_response.bids()[0].bid(), kTestWinningBid);
+}
+
 TEST_F(GenerateBidsReactorTest, KvInputIsCorrect) {
   int num_roma_dispatches = 0;
   SetupContextualProtectedAppSignalsRomaExpectations(dispatcher_,
@@ -49,7 +49,17 @@ inline constexpr absl::string_view
     BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES =
         "BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES";
 
-inline constexpr int kNumRuntimeFlags = 13;
+inline constexpr absl::string_view ENABLE_ROMA_ADMISSION_CONTROL =
+    "ENABLE_ROMA_ADMISSION_CONTROL";
+inline constexpr absl::string_view ENABLE_PIPELINED_ADS_RETRIEVAL =
+    "ENABLE_PIPELINED_ADS_RETRIEVAL";
+inline constexpr absl::string_view ADS_METADATA_CACHE_TTL_MS =
+    "ADS_METADATA_CACHE_TTL_MS";
+inline constexpr absl::string_view PREPARED_DATA_CACHE_TTL_MS =
+    "PREPARED_DATA_CACHE_TTL_MS";
+inline constexpr absl::string_view ROMA_MAX_BATCH_SIZE = "ROMA_MAX_BATCH_SIZE";
+
+inline constexpr int kNumRuntimeFlags = 18;
 inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     PORT,
     HEALTHCHECK_PORT,
@@ -64,6 +74,11 @@ inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     AD_RETRIEVAL_TIMEOUT_MS,
     BIDDING_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND,
     BIDDING_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES,
+    ENABLE_ROMA_ADMISSION_CONTROL,
+    ENABLE_PIPELINED_ADS_RETRIEVAL,
+    ADS_METADATA_CACHE_TTL_MS,
+    PREPARED_DATA_CACHE_TTL_MS,
+    ROMA_MAX_BATCH_SIZE,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
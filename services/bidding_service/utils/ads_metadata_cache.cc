@@ -0,0 +1,47 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/ads_metadata_cache.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::shared_ptr<AdsMetadataCache> CreateAdsMetadataCache(int64_t max_bytes,
+                                                         absl::Duration ttl) {
+  AdsMetadataCache::Options options;
+  options.max_weight = max_bytes;
+  options.ttl = ttl;
+  options.weigher = [](const std::string& key,
+                       const kv_server::v2::GetValuesResponse& response) {
+    return static_cast<int64_t>(key.size() + response.ByteSizeLong());
+  };
+  return std::make_shared<AdsMetadataCache>(std::move(options));
+}
+
+std::string GetAdsMetadataCacheKey(
+    const google::protobuf::RepeatedPtrField<std::string>& ad_render_ids) {
+  // Length-prefixed, so that distinct lists of ids never share a key.
+  std::string key;
+  for (const std::string& ad_render_id : ad_render_ids) {
+    absl::StrAppend(&key, ad_render_id.size(), ":", ad_render_id);
+  }
+  return key;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_ADS_METADATA_CACHE_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_ADS_METADATA_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "google/protobuf/repeated_field.h"
+#include "public/query/v2/get_values_v2.pb.h"
+#include "services/common/concurrent/sharded_local_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Cache of the KV server responses to protected app signals ads metadata
+// lookups, shared across GenerateProtectedAppSignalsBids requests. Popular
+// contextual ads are sent with the same ad render ids by many requests, so
+// their metadata is looked up once per time to live.
+using AdsMetadataCache =
+    ShardedLocalCache<std::string, const kv_server::v2::GetValuesResponse>;
+
+// Creates a cache holding up to `max_bytes` of responses, each returned for
+// `ttl` after it is cached.
+std::shared_ptr<AdsMetadataCache> CreateAdsMetadataCache(int64_t max_bytes,
+                                                         absl::Duration ttl);
+
+// Returns the key of the ads metadata of the ad render ids, in the order of
+// the lookup request.
+std::string GetAdsMetadataCacheKey(
+    const google::protobuf::RepeatedPtrField<std::string>& ad_render_ids);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_ADS_METADATA_CACHE_H_
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/ads_metadata_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+google::protobuf::RepeatedPtrField<std::string> AdRenderIds(
+    std::initializer_list<std::string> ids) {
+  return google::protobuf::RepeatedPtrField<std::string>(ids.begin(),
+                                                         ids.end());
+}
+
+TEST(AdsMetadataCacheTest, KeysDistinguishIdLists) {
+  EXPECT_EQ(GetAdsMetadataCacheKey(AdRenderIds({"ab", "c"})),
+            GetAdsMetadataCacheKey(AdRenderIds({"ab", "c"})));
+  EXPECT_NE(GetAdsMetadataCacheKey(AdRenderIds({"ab", "c"})),
+            GetAdsMetadataCacheKey(AdRenderIds({"a", "bc"})));
+  EXPECT_NE(GetAdsMetadataCacheKey(AdRenderIds({"ab", "c"})),
+            GetAdsMetadataCacheKey(AdRenderIds({"c", "ab"})));
+}
+
+TEST(AdsMetadataCacheTest, ReturnsCachedResponse) {
+  std::shared_ptr<AdsMetadataCache> cache =
+      CreateAdsMetadataCache(/*max_bytes=*/1 << 20, absl::Minutes(1));
+  auto response = std::make_shared<kv_server::v2::GetValuesResponse>();
+  response->mutable_single_partition()->set_string_output("metadata");
+  const std::string key = GetAdsMetadataCacheKey(AdRenderIds({"ad"}));
+  cache->Insert(key, response);
+
+  auto cached = cache->LookUp(key);
+  ASSERT_NE(cached, nullptr);
+  EXPECT_EQ(cached->single_partition().string_output(), "metadata");
+  EXPECT_EQ(cache->LookUp(GetAdsMetadataCacheKey(AdRenderIds({"other"}))),
+            nullptr);
+}
+
+TEST(AdsMetadataCacheTest, DoesNotCacheResponsesOverMaxBytes) {
+  std::shared_ptr<AdsMetadataCache> cache =
+      CreateAdsMetadataCache(/*max_bytes=*/16, absl::Minutes(1));
+  auto response = std::make_shared<kv_server::v2::GetValuesResponse>();
+  response->mutable_single_partition()->set_string_output(
+      std::string(64, 'x'));
+  cache->Insert("key", response);
+  EXPECT_EQ(cache->LookUp("key"), nullptr);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
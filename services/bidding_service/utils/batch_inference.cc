@@ -0,0 +1,100 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/batch_inference.h"
+
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kRequest[] = "request";
+constexpr char kResponse[] = "response";
+
+}  // namespace
+
+MergedInferenceRequest MergeInferenceRequests(
+    const std::vector<std::string>& inference_inputs) {
+  MergedInferenceRequest merged;
+  merged.num_model_requests.reserve(inference_inputs.size());
+  rapidjson::Document request(rapidjson::kObjectType);
+  rapidjson::Document::AllocatorType& allocator = request.GetAllocator();
+  rapidjson::Value model_requests(rapidjson::kArrayType);
+  for (const std::string& inference_input : inference_inputs) {
+    rapidjson::Document input(&allocator);
+    if (input.Parse(inference_input.c_str()).HasParseError() ||
+        !input.IsArray()) {
+      merged.num_model_requests.push_back(0);
+      continue;
+    }
+    merged.num_model_requests.push_back(input.Size());
+    for (rapidjson::Value& model_request : input.GetArray()) {
+      model_requests.PushBack(model_request, allocator);
+    }
+  }
+  request.AddMember(kRequest, model_requests, allocator);
+  if (absl::StatusOr<std::string> serialized = SerializeJsonDoc(request);
+      serialized.ok()) {
+    merged.request = *std::move(serialized);
+  }
+  return merged;
+}
+
+absl::StatusOr<std::vector<std::optional<std::string>>> SplitInferenceResponse(
+    const std::string& response, const std::vector<int>& num_model_requests) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  if (!document.IsObject() || !document.HasMember(kResponse) ||
+      !document[kResponse].IsArray()) {
+    return absl::InvalidArgumentError(
+        "Inference response has no response array");
+  }
+  rapidjson::Value& model_outputs = document[kResponse];
+  const int num_requests = std::accumulate(num_model_requests.begin(),
+                                           num_model_requests.end(), 0);
+  if (model_outputs.Size() != num_requests) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Inference response has ", model_outputs.Size(),
+                     " model outputs for ", num_requests, " model requests"));
+  }
+  std::vector<std::optional<std::string>> outputs;
+  outputs.reserve(num_model_requests.size());
+  rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+  int next_output = 0;
+  for (int num_outputs : num_model_requests) {
+    if (num_outputs == 0) {
+      outputs.push_back(std::nullopt);
+      continue;
+    }
+    rapidjson::Value ig_outputs(rapidjson::kArrayType);
+    for (int i = 0; i < num_outputs; ++i) {
+      ig_outputs.PushBack(model_outputs[next_output++], allocator);
+    }
+    PS_ASSIGN_OR_RETURN(std::string serialized, SerializeJsonDoc(ig_outputs));
+    outputs.push_back(std::move(serialized));
+  }
+  return outputs;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_BATCH_INFERENCE_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_BATCH_INFERENCE_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Inference requests of the interest groups of a GenerateBids request, merged
+// into a single request to the inference sidecar.
+struct MergedInferenceRequest {
+  // Request in the JSON format of the inference sidecar: {"request":[...]}.
+  std::string request;
+  // Number of model requests of each interest group, in order.
+  std::vector<int> num_model_requests;
+};
+
+// Merges the inference inputs of each interest group, as returned by the
+// prepareInferenceInputs UDF: a JSON array of model requests such as
+// [{"model_path":"my_model","tensors":[...]}]. Interest groups whose inputs
+// are not such an array get no model request.
+MergedInferenceRequest MergeInferenceRequests(
+    const std::vector<std::string>& inference_inputs);
+
+// Splits the response of the sidecar to a merged request back into the
+// outputs of each interest group, as JSON arrays of model outputs. Interest
+// groups without model requests get no outputs.
+absl::StatusOr<std::vector<std::optional<std::string>>> SplitInferenceResponse(
+    const std::string& response, const std::vector<int>& num_model_requests);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_BATCH_INFERENCE_H_
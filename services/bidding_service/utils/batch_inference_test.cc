@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/batch_inference.h"
+
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Optional;
+
+TEST(MergeInferenceRequestsTest, ConcatenatesModelRequestsInOrder) {
+  MergedInferenceRequest merged = MergeInferenceRequests(
+      {R"([{"model_path":"a"},{"model_path":"b"}])", "[]",
+       R"([{"model_path":"c"}])"});
+
+  EXPECT_EQ(merged.request,
+            R"({"request":[{"model_path":"a"},{"model_path":"b"},)"
+            R"({"model_path":"c"}]})");
+  EXPECT_THAT(merged.num_model_requests, ElementsAre(2, 0, 1));
+}
+
+TEST(MergeInferenceRequestsTest, SkipsInvalidInputs) {
+  MergedInferenceRequest merged = MergeInferenceRequests(
+      {"not json", R"({"model_path":"a"})", R"([{"model_path":"b"}])"});
+
+  EXPECT_EQ(merged.request, R"({"request":[{"model_path":"b"}]})");
+  EXPECT_THAT(merged.num_model_requests, ElementsAre(0, 0, 1));
+}
+
+TEST(SplitInferenceResponseTest, SplitsModelOutputsByInterestGroup) {
+  auto outputs = SplitInferenceResponse(
+      R"({"response":[{"model_path":"a"},{"model_path":"b"},)"
+      R"({"model_path":"c"}]})",
+      {2, 0, 1});
+
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  EXPECT_THAT(*outputs,
+              ElementsAre(
+                  Optional(Eq(R"([{"model_path":"a"},{"model_path":"b"}])")),
+                  Eq(std::nullopt), Optional(Eq(R"([{"model_path":"c"}])"))));
+}
+
+TEST(SplitInferenceResponseTest, RejectsMismatchedResponses) {
+  EXPECT_FALSE(SplitInferenceResponse(R"({"response":[{}]})", {1, 1}).ok());
+  EXPECT_FALSE(SplitInferenceResponse(R"({"error":{}})", {1}).ok());
+  EXPECT_FALSE(SplitInferenceResponse("not json", {1}).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
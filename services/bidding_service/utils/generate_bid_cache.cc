@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/generate_bid_cache.h"
+
+#include <utility>
+
+#include "absl/hash/hash.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+size_t HashOf(const GenerateBidInputs& inputs) {
+  return absl::HashOf(*inputs.shared, inputs.interest_group);
+}
+
+bool SameInputs(const GenerateBidInputs& a, const GenerateBidInputs& b) {
+  return *a.shared == *b.shared && a.interest_group == b.interest_group;
+}
+
+}  // namespace
+
+GenerateBidCache::GenerateBidCache(int capacity, absl::Duration ttl)
+    : capacity_(capacity), ttl_(ttl) {}
+
+std::optional<std::string> GenerateBidCache::Get(
+    const GenerateBidInputs& inputs, absl::Time now) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(HashOf(inputs));
+  if (it == index_.end() || !SameInputs(it->second->inputs, inputs)) {
+    return std::nullopt;
+  }
+  if (it->second->expiry <= now) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    return std::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->output;
+}
+
+void GenerateBidCache::Put(GenerateBidInputs inputs, std::string output,
+                           absl::Time now) {
+  if (capacity_ <= 0) {
+    return;
+  }
+  const size_t hash = HashOf(inputs);
+  absl::MutexLock lock(&mu_);
+  if (auto it = index_.find(hash); it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front({.hash = hash,
+                       .inputs = std::move(inputs),
+                       .output = std::move(output),
+                       .expiry = now + ttl_});
+  index_[hash] = entries_.begin();
+  if (entries_.size() > static_cast<size_t>(capacity_)) {
+    index_.erase(entries_.back().hash);
+    entries_.pop_back();
+  }
+}
+
+int GenerateBidCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_CACHE_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_CACHE_H_
+
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Serialized inputs of a generateBid call.
+struct GenerateBidInputs {
+  // Inputs shared by all the calls of a batch, held once per batch.
+  std::shared_ptr<const std::string> shared;
+  // Inputs specific to the interest group.
+  std::string interest_group;
+};
+
+// Thread-safe cache of generateBid outputs shared across GenerateBids
+// requests, for buyers declaring their generateBid function deterministic.
+// Entries are keyed by a hash of all the inputs of the call and expire after
+// a short time to live, so that bids follow updates of the code and of the
+// signals served by the buyer. Hash collisions are detected by comparing the
+// inputs and treated as misses. Beyond `capacity` entries, the least recently
+// used ones are evicted.
+class GenerateBidCache {
+ public:
+  GenerateBidCache(int capacity, absl::Duration ttl);
+
+  // Returns the cached generateBid output for the inputs, if any and not
+  // expired.
+  std::optional<std::string> Get(const GenerateBidInputs& inputs,
+                                 absl::Time now = absl::Now())
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Caches the generateBid output for the inputs.
+  void Put(GenerateBidInputs inputs, std::string output,
+           absl::Time now = absl::Now()) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of outputs currently cached, including expired ones
+  // not evicted yet.
+  int size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    size_t hash;
+    GenerateBidInputs inputs;
+    std::string output;
+    absl::Time expiry;
+  };
+
+  const int capacity_;
+  const absl::Duration ttl_;
+  mutable absl::Mutex mu_;
+  // Most recently used entries first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<size_t, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_CACHE_H_
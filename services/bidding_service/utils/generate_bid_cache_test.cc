@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/generate_bid_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::Duration kTtl = absl::Seconds(10);
+
+GenerateBidInputs Inputs(absl::string_view interest_group,
+                         absl::string_view shared = "shared") {
+  return {.shared = std::make_shared<const std::string>(shared),
+          .interest_group = std::string(interest_group)};
+}
+
+TEST(GenerateBidCacheTest, ReturnsCachedOutputsUntilExpired) {
+  GenerateBidCache cache(/*capacity=*/10, kTtl);
+  const absl::Time now = absl::Now();
+  EXPECT_EQ(cache.Get(Inputs("ig_1"), now), std::nullopt);
+
+  cache.Put(Inputs("ig_1"), "bid_1", now);
+  EXPECT_EQ(cache.Get(Inputs("ig_1"), now + kTtl / 2), "bid_1");
+  EXPECT_EQ(cache.Get(Inputs("ig_2"), now), std::nullopt);
+  EXPECT_EQ(cache.Get(Inputs("ig_1", "other_shared"), now), std::nullopt);
+
+  EXPECT_EQ(cache.Get(Inputs("ig_1"), now + kTtl), std::nullopt);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(GenerateBidCacheTest, EvictsLeastRecentlyUsedOutputs) {
+  GenerateBidCache cache(/*capacity=*/2, kTtl);
+  const absl::Time now = absl::Now();
+  cache.Put(Inputs("ig_1"), "bid_1", now);
+  cache.Put(Inputs("ig_2"), "bid_2", now);
+  ASSERT_EQ(cache.Get(Inputs("ig_1"), now), "bid_1");
+
+  cache.Put(Inputs("ig_3"), "bid_3", now);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Get(Inputs("ig_1"), now), "bid_1");
+  EXPECT_EQ(cache.Get(Inputs("ig_2"), now), std::nullopt);
+  EXPECT_EQ(cache.Get(Inputs("ig_3"), now), "bid_3");
+
+  // Outputs put again replace the previous ones.
+  cache.Put(Inputs("ig_3"), "new_bid_3", now);
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.Get(Inputs("ig_3"), now), "new_bid_3");
+}
+
+TEST(GenerateBidCacheTest, CachesNothingWithoutCapacity) {
+  GenerateBidCache cache(/*capacity=*/0, kTtl);
+  cache.Put(Inputs("ig_1"), "bid_1");
+  EXPECT_EQ(cache.Get(Inputs("ig_1")), std::nullopt);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
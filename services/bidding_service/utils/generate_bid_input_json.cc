@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/generate_bid_input_json.h"
+
+#include <cstdint>
+
+#include "services/common/util/json_writer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using IGForBidding =
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
+
+constexpr JsonKey kName("name");
+constexpr JsonKey kTrustedBiddingSignalsKeys("trustedBiddingSignalsKeys");
+constexpr JsonKey kAdRenderIds("adRenderIds");
+constexpr JsonKey kAdComponentRenderIds("adComponentRenderIds");
+constexpr JsonKey kUserBiddingSignals("userBiddingSignals");
+constexpr JsonKey kTopWindowHostname("topWindowHostname");
+constexpr JsonKey kSeller("seller");
+constexpr JsonKey kTopLevelSeller("topLevelSeller");
+constexpr JsonKey kJoinCount("joinCount");
+constexpr JsonKey kBidCount("bidCount");
+constexpr JsonKey kRecency("recency");
+constexpr JsonKey kPrevWins("prevWins");
+
+}  // namespace
+
+std::string InterestGroupToJson(const IGForBidding& interest_group) {
+  return WriteJsonObject([&interest_group](auto& writer) {
+    writer.String(kName, interest_group.name());
+    if (!interest_group.trusted_bidding_signals_keys().empty()) {
+      writer.StringArray(kTrustedBiddingSignalsKeys,
+                         interest_group.trusted_bidding_signals_keys());
+    }
+    if (!interest_group.ad_render_ids().empty()) {
+      writer.StringArray(kAdRenderIds, interest_group.ad_render_ids());
+    }
+    if (!interest_group.ad_component_render_ids().empty()) {
+      writer.StringArray(kAdComponentRenderIds,
+                         interest_group.ad_component_render_ids());
+    }
+    if (!interest_group.user_bidding_signals().empty()) {
+      writer.Raw(kUserBiddingSignals, interest_group.user_bidding_signals());
+    }
+  });
+}
+
+std::string BrowserSignalsToJson(absl::string_view publisher_name,
+                                 absl::string_view seller,
+                                 absl::string_view top_level_seller,
+                                 const BrowserSignals& browser_signals) {
+  // Recency is expected to be in milliseconds.
+  const int64_t recency_ms = browser_signals.has_recency_ms()
+                                 ? browser_signals.recency_ms()
+                                 : browser_signals.recency() * 1000;
+  return WriteJsonObject([&](auto& writer) {
+    writer.String(kTopWindowHostname, publisher_name);
+    writer.String(kSeller, seller);
+    if (!top_level_seller.empty()) {
+      writer.String(kTopLevelSeller, top_level_seller);
+    }
+    writer.Int(kJoinCount, browser_signals.join_count());
+    writer.Int(kBidCount, browser_signals.bid_count());
+    writer.Int(kRecency, recency_ms);
+    writer.Raw(kPrevWins, browser_signals.prev_wins().empty()
+                              ? absl::string_view("\"\"")
+                              : absl::string_view(browser_signals.prev_wins()));
+  });
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_INPUT_JSON_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_INPUT_JSON_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Writers of the JSON inputs of generateBid built from the request protos.
+// They write each object with WriteJsonObject, into a single allocation of its
+// exact size, instead of going through proto reflection or intermediate JSON
+// documents.
+
+// Serializes the interest group as passed to generateBid. Empty fields are
+// not included at all in the serialized JSON, and no default, null or dummy
+// values are filled in. Device signals are not serialized since they are
+// passed to generateBid() in a different parameter. User bidding signals are
+// already JSON and are written as is.
+std::string InterestGroupToJson(
+    const GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding&
+        interest_group);
+
+// Serializes the browser signals passed to generateBid as device signals.
+// Previous wins are already JSON and are written as is.
+std::string BrowserSignalsToJson(absl::string_view publisher_name,
+                                 absl::string_view seller,
+                                 absl::string_view top_level_seller,
+                                 const BrowserSignals& browser_signals);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BID_INPUT_JSON_H_
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/generate_bid_input_json.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using IGForBidding =
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
+
+TEST(InterestGroupToJsonTest, SerializesOnlyTheSetFields) {
+  IGForBidding interest_group;
+  interest_group.set_name("ig_name");
+  EXPECT_EQ(InterestGroupToJson(interest_group),
+            R"JSON({"name":"ig_name"})JSON");
+
+  interest_group.add_trusted_bidding_signals_keys("key_1");
+  interest_group.add_trusted_bidding_signals_keys("key_2");
+  interest_group.add_ad_render_ids("1689");
+  interest_group.add_ad_component_render_ids("1776");
+  interest_group.set_user_bidding_signals(R"JSON({"signal":123})JSON");
+  EXPECT_EQ(InterestGroupToJson(interest_group),
+            R"JSON({"name":"ig_name",)JSON"
+            R"JSON("trustedBiddingSignalsKeys":["key_1","key_2"],)JSON"
+            R"JSON("adRenderIds":["1689"],"adComponentRenderIds":["1776"],)JSON"
+            R"JSON("userBiddingSignals":{"signal":123}})JSON");
+}
+
+TEST(InterestGroupToJsonTest, EscapesStrings) {
+  IGForBidding interest_group;
+  interest_group.set_name("ig \"name\"\\");
+  interest_group.add_ad_render_ids("line\nbreak\x01");
+  EXPECT_EQ(InterestGroupToJson(interest_group),
+            R"JSON({"name":"ig \"name\"\\",)JSON"
+            R"JSON("adRenderIds":["line\nbreak\u0001"]})JSON");
+}
+
+TEST(BrowserSignalsToJsonTest, SerializesBrowserSignals) {
+  BrowserSignals browser_signals;
+  browser_signals.set_join_count(5);
+  browser_signals.set_bid_count(25);
+  browser_signals.set_recency(2);
+  browser_signals.set_prev_wins(R"JSON([[1,"1689"]])JSON");
+  EXPECT_EQ(BrowserSignalsToJson("publisher.com", "seller.com",
+                                 /*top_level_seller=*/"", browser_signals),
+            R"JSON({"topWindowHostname":"publisher.com",)JSON"
+            R"JSON("seller":"seller.com","joinCount":5,"bidCount":25,)JSON"
+            R"JSON("recency":2000,"prevWins":[[1,"1689"]]})JSON");
+
+  browser_signals.set_recency_ms(1500);
+  browser_signals.clear_prev_wins();
+  EXPECT_EQ(BrowserSignalsToJson("publisher.com", "seller.com",
+                                 "top-seller.com", browser_signals),
+            R"JSON({"topWindowHostname":"publisher.com",)JSON"
+            R"JSON("seller":"seller.com",)JSON"
+            R"JSON("topLevelSeller":"top-seller.com",)JSON"
+            R"JSON("joinCount":5,"bidCount":25,"recency":1500,)JSON"
+            R"JSON("prevWins":""})JSON");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
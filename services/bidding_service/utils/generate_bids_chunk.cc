@@ -0,0 +1,99 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "services/bidding_service/utils/generate_bids_chunk.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+const std::string* GetInput(const DispatchRequest& request, int index) {
+  return static_cast<size_t>(index) < request.input.size()
+             ? request.input[index].get()
+             : nullptr;
+}
+
+}  // namespace
+
+DispatchRequest BuildGenerateBidsChunkRequest(
+    absl::Span<const DispatchRequest> requests,
+    absl::Span<const int> per_ig_args) {
+  DispatchRequest chunk_request;
+  chunk_request.id = requests.front().id;
+  chunk_request.version_string = requests.front().version_string;
+  chunk_request.handler_name = kGenerateBidsBatchEntryFunctionName;
+  chunk_request.input = requests.front().input;
+  for (int index : per_ig_args) {
+    size_t size = requests.size() + 1;
+    bool any_input = false;
+    for (const DispatchRequest& request : requests) {
+      const std::string* input = GetInput(request, index);
+      any_input |= input != nullptr;
+      size += input != nullptr ? input->size() : 4;
+    }
+    if (!any_input) {
+      if (static_cast<size_t>(index) < chunk_request.input.size()) {
+        chunk_request.input[index] = nullptr;
+      }
+      continue;
+    }
+    auto values = std::make_shared<std::string>();
+    values->reserve(size);
+    values->push_back('[');
+    for (const DispatchRequest& request : requests) {
+      if (&request != &requests.front()) {
+        values->push_back(',');
+      }
+      const std::string* input = GetInput(request, index);
+      values->append(input != nullptr ? *input : "null");
+    }
+    values->push_back(']');
+    if (static_cast<size_t>(index) >= chunk_request.input.size()) {
+      chunk_request.input.resize(index + 1);
+    }
+    chunk_request.input[index] = std::move(values);
+  }
+  return chunk_request;
+}
+
+absl::StatusOr<std::vector<std::string>> SplitGenerateBidsChunkResponse(
+    absl::string_view response, int num_interest_groups) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  if (!document.IsArray() || document.Size() != num_interest_groups) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected the outputs of ", num_interest_groups,
+                     " interest groups from generateBid batch"));
+  }
+  std::vector<std::string> outputs;
+  outputs.reserve(num_interest_groups);
+  for (const rapidjson::Value& output : document.GetArray()) {
+    PS_ASSIGN_OR_RETURN(std::string output_json, SerializeJsonDoc(output));
+    outputs.push_back(std::move(output_json));
+  }
+  return outputs;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
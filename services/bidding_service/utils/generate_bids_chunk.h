@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BIDS_CHUNK_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BIDS_CHUNK_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kGenerateBidsBatchEntryFunctionName[] =
+    "generateBidsBatchEntryFunction";
+
+// Builds the request running generateBid for a chunk of interest groups in a
+// single invocation of the batch entry function of the wrapper. The inputs at
+// `per_ig_args` become JSON arrays of the inputs of each interest group, with
+// null for an interest group missing one; they are left out if all interest
+// groups miss them. The other inputs are taken from the first request, so that
+// the inputs shared by the batch are still bound once per chunk. The chunk
+// has the id of its first interest group.
+DispatchRequest BuildGenerateBidsChunkRequest(
+    absl::Span<const DispatchRequest> requests,
+    absl::Span<const int> per_ig_args);
+
+// Splits the output of a chunk, a JSON array, into the generateBid outputs of
+// its interest groups, as returned by the entry function for one of them.
+// Fails if the array does not have an output per interest group.
+absl::StatusOr<std::vector<std::string>> SplitGenerateBidsChunkResponse(
+    absl::string_view response, int num_interest_groups);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_GENERATE_BIDS_CHUNK_H_
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/generate_bids_chunk.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+DispatchRequest MakeRequest(absl::string_view id, absl::string_view signals) {
+  DispatchRequest request;
+  request.id = id;
+  request.version_string = "v1";
+  request.input = {
+      std::make_shared<std::string>(absl::StrCat(R"({"name":")", id, R"("})")),
+      nullptr, std::make_shared<std::string>(signals)};
+  return request;
+}
+
+TEST(BuildGenerateBidsChunkRequestTest, BuildsArraysOfPerIgInputs) {
+  std::vector<DispatchRequest> requests = {MakeRequest("ig_1", "1"),
+                                           MakeRequest("ig_2", "2")};
+  requests[1].input.push_back(std::make_shared<std::string>("[3]"));
+
+  DispatchRequest chunk =
+      BuildGenerateBidsChunkRequest(requests, /*per_ig_args=*/{0, 2, 3});
+
+  EXPECT_EQ(chunk.id, "ig_1");
+  EXPECT_EQ(chunk.version_string, "v1");
+  EXPECT_EQ(chunk.handler_name, kGenerateBidsBatchEntryFunctionName);
+  ASSERT_EQ(chunk.input.size(), 4);
+  EXPECT_EQ(*chunk.input[0], R"([{"name":"ig_1"},{"name":"ig_2"}])");
+  // The shared input is left to be bound to the chunk.
+  EXPECT_EQ(chunk.input[1], nullptr);
+  EXPECT_EQ(*chunk.input[2], "[1,2]");
+  EXPECT_EQ(*chunk.input[3], "[null,[3]]");
+}
+
+TEST(BuildGenerateBidsChunkRequestTest, LeavesOutInputsMissingForAllIgs) {
+  std::vector<DispatchRequest> requests = {MakeRequest("ig_1", "1")};
+
+  DispatchRequest chunk =
+      BuildGenerateBidsChunkRequest(requests, /*per_ig_args=*/{0, 2, 3});
+
+  EXPECT_EQ(chunk.input.size(), 3);
+}
+
+TEST(SplitGenerateBidsChunkResponseTest, SplitsOutputsByInterestGroup) {
+  auto outputs = SplitGenerateBidsChunkResponse(
+      R"([{"response":{"bid":1},"logs":[]},{"bid":2}])", 2);
+
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  EXPECT_THAT(*outputs, ElementsAre(R"({"response":{"bid":1},"logs":[]})",
+                                    R"({"bid":2})"));
+}
+
+TEST(SplitGenerateBidsChunkResponseTest, FailsOnMissingOutputs) {
+  EXPECT_FALSE(SplitGenerateBidsChunkResponse(R"([{"bid":1}])", 2).ok());
+  EXPECT_FALSE(SplitGenerateBidsChunkResponse(R"({"bid":1})", 1).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
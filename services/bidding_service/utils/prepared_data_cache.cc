@@ -0,0 +1,52 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/prepared_data_cache.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "openssl/sha.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::shared_ptr<PreparedDataCache> CreatePreparedDataCache(int64_t max_bytes,
+                                                           absl::Duration ttl) {
+  PreparedDataCache::Options options;
+  options.max_weight = max_bytes;
+  options.ttl = ttl;
+  options.weigher = [](const std::string& key,
+                       const std::string& prepared_data) {
+    return static_cast<int64_t>(key.size() + prepared_data.size());
+  };
+  return std::make_shared<PreparedDataCache>(std::move(options));
+}
+
+std::string GetPreparedDataCacheKey(
+    absl::string_view code_version,
+    const std::vector<std::shared_ptr<std::string>>& input) {
+  // Length-prefixed, so that distinct inputs never share a digest input.
+  std::string content = absl::StrCat(code_version.size(), ":", code_version);
+  for (const std::shared_ptr<std::string>& arg : input) {
+    absl::StrAppend(&content, arg->size(), ":", *arg);
+  }
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(content.data()), content.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return digest;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_PREPARED_DATA_CACHE_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_PREPARED_DATA_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "services/common/concurrent/sharded_local_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Cache of the outputs of prepareDataForAdsRetrieval, shared across
+// GenerateProtectedAppSignalsBids requests, for buyers whose UDF is
+// deterministic. The encoded signals of a device rarely change between its
+// requests, so the UDF runs once per time to live for the same inputs.
+using PreparedDataCache = ShardedLocalCache<std::string, const std::string>;
+
+// Creates a cache holding up to `max_bytes` of outputs, each returned for
+// `ttl` after it is cached.
+std::shared_ptr<PreparedDataCache> CreatePreparedDataCache(int64_t max_bytes,
+                                                           absl::Duration ttl);
+
+// Returns the key of the output of the `code_version` of the UDF for the
+// `input` of its Roma request: a SHA-256 digest of both, so that large
+// encoded signals are not kept in the cache.
+std::string GetPreparedDataCacheKey(
+    absl::string_view code_version,
+    const std::vector<std::shared_ptr<std::string>>& input);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_PREPARED_DATA_CACHE_H_
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/bidding_service/utils/prepared_data_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::vector<std::shared_ptr<std::string>> Input(
+    std::initializer_list<std::string> args) {
+  std::vector<std::shared_ptr<std::string>> input;
+  for (const std::string& arg : args) {
+    input.push_back(std::make_shared<std::string>(arg));
+  }
+  return input;
+}
+
+TEST(PreparedDataCacheTest, KeysDistinguishVersionsAndInputs) {
+  EXPECT_EQ(GetPreparedDataCacheKey("v1", Input({"ab", "c"})),
+            GetPreparedDataCacheKey("v1", Input({"ab", "c"})));
+  EXPECT_NE(GetPreparedDataCacheKey("v1", Input({"ab", "c"})),
+            GetPreparedDataCacheKey("v2", Input({"ab", "c"})));
+  EXPECT_NE(GetPreparedDataCacheKey("v1", Input({"ab", "c"})),
+            GetPreparedDataCacheKey("v1", Input({"a", "bc"})));
+  EXPECT_NE(GetPreparedDataCacheKey("v1", Input({"ab", "c"})),
+            GetPreparedDataCacheKey("v1", Input({"c", "ab"})));
+}
+
+TEST(PreparedDataCacheTest, ReturnsCachedOutput) {
+  std::shared_ptr<PreparedDataCache> cache =
+      CreatePreparedDataCache(/*max_bytes=*/1 << 20, absl::Minutes(1));
+  const std::string key = GetPreparedDataCacheKey("v1", Input({"signals"}));
+  cache->Insert(key, std::make_shared<const std::string>("prepared"));
+
+  std::shared_ptr<const std::string> cached = cache->LookUp(key);
+  ASSERT_NE(cached, nullptr);
+  EXPECT_EQ(*cached, "prepared");
+  EXPECT_EQ(
+      cache->LookUp(GetPreparedDataCacheKey("v1", Input({"other signals"}))),
+      nullptr);
+}
+
+TEST(PreparedDataCacheTest, DoesNotCacheOutputsOverMaxBytes) {
+  std::shared_ptr<PreparedDataCache> cache =
+      CreatePreparedDataCache(/*max_bytes=*/16, absl::Minutes(1));
+  cache->Insert("key", std::make_shared<const std::string>(64, 'x'));
+  EXPECT_EQ(cache->LookUp("key"), nullptr);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,169 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/utils/trusted_bidding_signals_util.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "services/common/util/json_span_util.h"
+#include "services/common/util/json_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using IGForBidding =
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding;
+
+inline constexpr char kKeys[] = "keys";
+inline constexpr char kMissingKeysError[] =
+    "Malformed trusted bidding signals (Missing property \"keys\")";
+
+// Creates a json of trusted bidding signals for a single IG. Queries the
+// bidding signals for -
+// 1. IG Name and moves the bidding signal values to the new json document.
+// 2. Bidding signal keys in the IG and copies them to the new json document.
+absl::StatusOr<ParsedTrustedBiddingSignals> GetSignalsForIG(
+    const IGForBidding& ig, rapidjson::Value* bidding_signals_obj,
+    long avg_signal_str_size) {
+  // Insert bidding signal values for this Interest Group.
+  ParsedTrustedBiddingSignals parsed_trusted_bidding_signals;
+  rapidjson::Document ig_signals;
+  ig_signals.SetObject();
+  // If no bidding signals passed, return empty document.
+  if (bidding_signals_obj == nullptr) {
+    return parsed_trusted_bidding_signals;
+  }
+
+  // Copy bidding signals with key name in bidding signal keys.
+  for (const auto& key : ig.trusted_bidding_signals_keys()) {
+    if (parsed_trusted_bidding_signals.keys.contains(key)) {
+      // Do not process duplicate keys.
+      continue;
+    }
+    rapidjson::Value::ConstMemberIterator trusted_bidding_signals_key_itr =
+        bidding_signals_obj->FindMember(key.c_str());
+    if (trusted_bidding_signals_key_itr != bidding_signals_obj->MemberEnd()) {
+      rapidjson::Value json_key;
+      // Keep string reference. Assumes safe lifecycle.
+      json_key.SetString(rapidjson::StringRef(key.c_str()));
+      rapidjson::Value json_value;
+      // Copy instead of move, could be referenced by multiple IGs.
+      json_value.CopyFrom(trusted_bidding_signals_key_itr->value,
+                          ig_signals.GetAllocator());
+      // AddMember moves Values, do not reference them anymore.
+      ig_signals.AddMember(json_key, json_value, ig_signals.GetAllocator());
+      parsed_trusted_bidding_signals.keys.emplace(key);
+    }
+  }
+  if (ig_signals.MemberCount() > 0) {
+    absl::StatusOr<std::shared_ptr<std::string>> ig_signals_str =
+        SerializeJsonDoc(ig_signals, avg_signal_str_size);
+    PS_ASSIGN_OR_RETURN(parsed_trusted_bidding_signals.json, ig_signals_str);
+  }
+  return parsed_trusted_bidding_signals;
+}
+
+}  // namespace
+
+absl::StatusOr<TrustedBiddingSignalsByIg> SerializeTrustedBiddingSignalsPerIG(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request) {
+  // Parse into JSON.
+  PS_ASSIGN_OR_RETURN((rapidjson::Document parsed_signals),
+                      ParseJsonString(raw_request.bidding_signals()));
+
+  // Select root key.
+  if (!parsed_signals.IsObject() || !parsed_signals.HasMember(kKeys)) {
+    return absl::InvalidArgumentError(kMissingKeysError);
+  }
+  rapidjson::Value& bidding_signals_obj = parsed_signals[kKeys];
+
+  // Create IG -> TrustedBiddingSignals Map.
+  TrustedBiddingSignalsByIg per_ig_signals_map;
+  if (raw_request.interest_group_for_bidding().empty()) {
+    return per_ig_signals_map;
+  }
+  long avg_signal_size_per_ig = raw_request.bidding_signals().size() /
+                                raw_request.interest_group_for_bidding_size();
+  for (const auto& ig : raw_request.interest_group_for_bidding()) {
+    per_ig_signals_map.try_emplace(
+        ig.name(), GetSignalsForIG(ig,
+                                   bidding_signals_obj.IsObject()
+                                       ? &bidding_signals_obj
+                                       : nullptr,
+                                   avg_signal_size_per_ig));
+  }
+  return per_ig_signals_map;
+}
+
+absl::StatusOr<TrustedBiddingSignalsByIg> ProjectTrustedBiddingSignalsPerIG(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request) {
+  // Index of all keys requested by any IG -> span of the value in the KV
+  // response. Spans stay null until the key is found.
+  JsonObjectSpans keys_spans;
+  for (const auto& ig : raw_request.interest_group_for_bidding()) {
+    for (const auto& key : ig.trusted_bidding_signals_keys()) {
+      keys_spans.members.try_emplace(key);
+    }
+  }
+
+  PS_RETURN_IF_ERROR(FindJsonMemberSpans(raw_request.bidding_signals(),
+                                         {{kKeys, &keys_spans}}));
+  if (!keys_spans.found) {
+    return absl::InvalidArgumentError(kMissingKeysError);
+  }
+  const auto& spans = keys_spans.members;
+
+  TrustedBiddingSignalsByIg per_ig_signals_map;
+  per_ig_signals_map.reserve(raw_request.interest_group_for_bidding_size());
+  std::vector<std::pair<absl::string_view, absl::string_view>> ig_members;
+  for (const auto& ig : raw_request.interest_group_for_bidding()) {
+    ParsedTrustedBiddingSignals parsed_trusted_bidding_signals;
+    ig_members.clear();
+    // Size of the output, assuming that the keys need no escaping.
+    size_t json_size = 1;  // '{'
+    for (const auto& key : ig.trusted_bidding_signals_keys()) {
+      absl::string_view value = spans.find(key)->second;
+      if (value.data() == nullptr ||
+          !parsed_trusted_bidding_signals.keys.emplace(key).second) {
+        continue;
+      }
+      ig_members.emplace_back(key, value);
+      // '"' key '":' value ','
+      json_size += key.size() + value.size() + 4;
+    }
+    if (!ig_members.empty()) {
+      std::string& json = *parsed_trusted_bidding_signals.json;
+      json.reserve(json_size);
+      json.push_back('{');
+      for (const auto& [key, value] : ig_members) {
+        if (json.size() > 1) {
+          json.push_back(',');
+        }
+        AppendJsonString(key, json);
+        json.push_back(':');
+        json.append(value);
+      }
+      json.push_back('}');
+    }
+    per_ig_signals_map.try_emplace(ig.name(),
+                                   std::move(parsed_trusted_bidding_signals));
+  }
+  return per_ig_signals_map;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BIDDING_SERVICE_UTILS_TRUSTED_BIDDING_SIGNALS_UTIL_H_
+#define SERVICES_BIDDING_SERVICE_UTILS_TRUSTED_BIDDING_SIGNALS_UTIL_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Trusted bidding signals selected for a single interest group.
+struct ParsedTrustedBiddingSignals {
+  // JSON object with the signals for the keys found in the KV response.
+  std::shared_ptr<std::string> json = std::make_shared<std::string>();
+  // Keys of the interest group that were found in the KV response.
+  absl::flat_hash_set<std::string> keys;
+};
+
+// Interest group name -> trusted bidding signals for the interest group.
+using TrustedBiddingSignalsByIg =
+    absl::flat_hash_map<std::string,
+                        absl::StatusOr<ParsedTrustedBiddingSignals>>;
+
+// Creates a map of Interest Group names -> trusted bidding signals json
+// strings by parsing the trusted bidding signals into a rapidjson::Document
+// and copying the values of each IG's keys into a per-IG document.
+absl::StatusOr<TrustedBiddingSignalsByIg> SerializeTrustedBiddingSignalsPerIG(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+// Produces the same result as SerializeTrustedBiddingSignalsPerIG in a single
+// pass over the trusted bidding signals, without building a DOM. The union of
+// all IG keys is indexed up front, a SAX scan over the "keys" object records
+// the raw byte span of each requested value and every IG's JSON is then
+// assembled from those spans into an exactly pre-sized buffer.
+//
+// Values are copied verbatim from the KV response, so numbers and string
+// escapes keep the representation sent by the KV server.
+absl::StatusOr<TrustedBiddingSignalsByIg> ProjectTrustedBiddingSignalsPerIG(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_UTILS_TRUSTED_BIDDING_SIGNALS_UTIL_H_
@@ -0,0 +1,116 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/utils/trusted_bidding_signals_util.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+using RawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+
+RawRequest MakeRawRequest(
+    absl::string_view bidding_signals,
+    const std::vector<std::pair<std::string, std::vector<std::string>>>&
+        ig_keys) {
+  RawRequest raw_request;
+  raw_request.set_bidding_signals(bidding_signals);
+  for (const auto& [name, keys] : ig_keys) {
+    auto* ig = raw_request.add_interest_group_for_bidding();
+    ig->set_name(name);
+    for (const auto& key : keys) {
+      ig->add_trusted_bidding_signals_keys(key);
+    }
+  }
+  return raw_request;
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, ProjectsRequestedKeysPerIG) {
+  RawRequest raw_request = MakeRawRequest(
+      R"JSON({"keys": {"a": 1, "b": {"nested": [1, 2, {"c": "d"}]},
+                       "c": "str"}, "perInterestGroupData": {"a": 2}})JSON",
+      {{"ig_1", {"a", "b"}}, {"ig_2", {"c", "missing", "c"}}});
+
+  auto result = ProjectTrustedBiddingSignalsPerIG(raw_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  ASSERT_TRUE(result->at("ig_1").ok());
+  EXPECT_EQ(*result->at("ig_1")->json,
+            R"JSON({"a":1,"b":{"nested": [1, 2, {"c": "d"}]}})JSON");
+  EXPECT_THAT(result->at("ig_1")->keys, UnorderedElementsAre("a", "b"));
+  ASSERT_TRUE(result->at("ig_2").ok());
+  EXPECT_EQ(*result->at("ig_2")->json, R"JSON({"c":"str"})JSON");
+  EXPECT_THAT(result->at("ig_2")->keys, UnorderedElementsAre("c"));
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, MatchesDomImplementation) {
+  RawRequest raw_request = MakeRawRequest(
+      R"JSON({"keys":{"k1":"v1","k2":[true,false,null],"k3":{"x":"y"}}})JSON",
+      {{"ig_1", {"k3", "k1"}}, {"ig_2", {"k2"}}, {"ig_3", {"none"}}});
+
+  auto projected = ProjectTrustedBiddingSignalsPerIG(raw_request);
+  auto serialized = SerializeTrustedBiddingSignalsPerIG(raw_request);
+  ASSERT_TRUE(projected.ok()) << projected.status();
+  ASSERT_TRUE(serialized.ok()) << serialized.status();
+  ASSERT_EQ(projected->size(), serialized->size());
+  for (const auto& [ig_name, signals] : *serialized) {
+    ASSERT_TRUE(signals.ok());
+    ASSERT_TRUE(projected->at(ig_name).ok());
+    EXPECT_EQ(*projected->at(ig_name)->json, *signals->json) << ig_name;
+    EXPECT_EQ(projected->at(ig_name)->keys, signals->keys) << ig_name;
+  }
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, IgnoresKeysOutsideKeysObject) {
+  RawRequest raw_request = MakeRawRequest(
+      R"JSON({"other": {"a": 1}, "keys": {"b": {"a": 2}}})JSON",
+      {{"ig_1", {"a"}}});
+
+  auto result = ProjectTrustedBiddingSignalsPerIG(raw_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_TRUE(result->at("ig_1")->json->empty());
+  EXPECT_TRUE(result->at("ig_1")->keys.empty());
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, UsesFirstOccurrenceOfDuplicateKey) {
+  RawRequest raw_request = MakeRawRequest(
+      R"JSON({"keys": {"a": 1, "a": 2}})JSON", {{"ig_1", {"a"}}});
+
+  auto result = ProjectTrustedBiddingSignalsPerIG(raw_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(*result->at("ig_1")->json, R"JSON({"a":1})JSON");
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, FailsWithoutKeysProperty) {
+  RawRequest raw_request =
+      MakeRawRequest(R"JSON({"values": {"a": 1}})JSON", {{"ig_1", {"a"}}});
+
+  EXPECT_FALSE(ProjectTrustedBiddingSignalsPerIG(raw_request).ok());
+}
+
+TEST(ProjectTrustedBiddingSignalsPerIGTest, FailsOnMalformedJson) {
+  RawRequest raw_request =
+      MakeRawRequest(R"JSON({"keys": {"a": 1)JSON", {{"ig_1", {"a"}}});
+
+  EXPECT_FALSE(ProjectTrustedBiddingSignalsPerIG(raw_request).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <aws/core/Aws.h>
 
@@ -23,6 +24,7 @@
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "grpcpp/ext/proto_server_reflection_plugin.h"
@@ -30,16 +32,35 @@
 #include "grpcpp/health_check_service_interface.h"
 #include "services/buyer_frontend_service/buyer_frontend_service.h"
 #include "services/buyer_frontend_service/providers/http_bidding_signals_async_provider.h"
+#include "services/buyer_frontend_service/providers/kv_bidding_signals_async_provider.h"
 #include "services/buyer_frontend_service/runtime_flags.h"
+#include "services/buyer_frontend_service/util/proto_factory.h"
+#include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "services/common/clients/bidding_server/bidding_async_client.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
+#include "services/common/clients/http/connection_warmer.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/clients/http/sharded_http_fetcher_async.h"
 #include "services/common/clients/http_kv_server/buyer/buyer_key_value_async_http_client.h"
+#include "services/common/clients/http_kv_server/buyer/coalescing_buyer_key_value_async_client.h"
 #include "services/common/clients/http_kv_server/buyer/fake_buyer_key_value_async_http_client.h"
+#include "services/common/clients/kv_server/kv_async_client.h"
+#include "services/common/concurrent/work_stealing_executor.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/cpu_placement.h"
+#include "services/common/util/fair_admission_controller.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/large_buffer_pool.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/request_capture.h"
+#include "services/common/util/request_phase_tracer.h"
+#include "services/common/util/server_drain.h"
 #include "services/common/util/tcmalloc_utils.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
@@ -56,7 +77,14 @@ ABSL_FLAG(std::optional<uint16_t>, healthcheck_port, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, bidding_server_addr, std::nullopt,
           "Bidding Server Address");
 ABSL_FLAG(std::optional<std::string>, buyer_kv_server_addr, std::nullopt,
-          "Buyer KV Server Address");
+          "Buyer KV Server Address. Replicas of the server may be listed "
+          "separated by commas, for the lookups to be spread across them.");
+ABSL_FLAG(std::optional<std::string>, buyer_tee_kv_server_addr, "",
+          "Address of a TEE buyer KV server. If set, the trusted bidding "
+          "signals are fetched from it with the KV v2 gRPC API instead of "
+          "from buyer_kv_server_addr.");
+ABSL_FLAG(std::optional<bool>, buyer_tee_kv_server_egress_tls, true,
+          "If true, the gRPC client of the TEE buyer KV server uses TLS.");
 // Added for performance/benchmark testing of both types of http clients.
 ABSL_FLAG(std::optional<int>, generate_bid_timeout_ms, std::nullopt,
           "Max time to wait for generate bid request to finish.");
@@ -93,6 +121,110 @@ ABSL_FLAG(std::optional<int64_t>, bfe_tcmalloc_max_total_thread_cache_bytes,
           std::nullopt,
           "Maximum amount of cached memory in bytes across all threads (or "
           "logical CPUs)");
+ABSL_FLAG(std::optional<int>, bfe_http_fetcher_num_shards, 1,
+          "Number of independent curl multi handle and event loop shards used "
+          "for KV fetches. 1 keeps a single unsharded fetcher, 0 or less uses "
+          "one shard per hardware thread.");
+ABSL_FLAG(std::optional<int>, buyer_kv_min_warm_connections, 1,
+          "Number of connections to the buyer KV server that are opened on "
+          "startup and on every re-warm.");
+ABSL_FLAG(std::optional<int>, buyer_kv_rewarm_interval_ms, 0,
+          "Interval at which connections to the buyer KV server are "
+          "re-warmed, e.g. to reach new replicas. Disabled if 0.");
+ABSL_FLAG(std::optional<bool>, enable_buyer_kv_request_coalescing, false,
+          "Share a single buyer KV fetch between identical concurrent "
+          "lookups.");
+ABSL_FLAG(std::optional<int>, buyer_kv_cache_ttl_ms, 0,
+          "How long coalesced buyer KV lookups are cached. Only in-flight "
+          "lookups are shared if 0.");
+ABSL_FLAG(std::optional<int64_t>, buyer_kv_cache_max_bytes, 64 * 1024 * 1024,
+          "Upper bound of the buyer KV lookup cache in bytes.");
+ABSL_FLAG(std::optional<int>, buyer_kv_batch_window_us, 0,
+          "How long, in microseconds and up to 2000, a TEE KV lookup waits "
+          "for concurrent lookups to share a KV request with. Lookups are "
+          "not batched if 0.");
+ABSL_FLAG(std::optional<int>, buyer_kv_hedge_percentile, 0,
+          "If set, e.g. to 95, and buyer_kv_server_addr lists several "
+          "replicas, a buyer KV lookup with no response by this percentile "
+          "of the recent lookup latencies is sent to another replica as "
+          "well. Lookups are not hedged if 0.");
+ABSL_FLAG(std::optional<int>, bidding_grpc_num_channels, 1,
+          "Number of gRPC channels, each with its own connection, to the "
+          "bidding server. RPCs go to the channel with the fewest in flight.");
+ABSL_FLAG(std::optional<int>, bidding_grpc_keepalive_ms, 0,
+          "Interval of the keepalive pings on the gRPC channels to the "
+          "bidding server. Disabled if 0.");
+ABSL_FLAG(std::optional<int>, bidding_grpc_stream_window_bytes, 0,
+          "Initial HTTP/2 stream window of the gRPC channels to the bidding "
+          "server. The gRPC default if 0.");
+ABSL_FLAG(std::optional<int>, bidding_grpc_min_compressed_request_bytes, 0,
+          "Requests to the bidding server with a smaller payload are sent "
+          "uncompressed even if compression is enabled.");
+ABSL_FLAG(std::optional<std::string>, bidding_server_zonal_addrs, "",
+          "Addresses of the bidding servers of each zone, as "
+          "zone=address,... If set, RPCs stay in the zone of this server "
+          "while its bidding servers are not busier than the others. "
+          "bidding_server_addr is used if empty.");
+ABSL_FLAG(std::optional<int>, bidding_zone_spillover_rpcs, 0,
+          "Number of RPCs in flight the bidding servers of this zone may "
+          "have beyond those of another zone before RPCs spill over to it. "
+          "RPCs never leave the zone if negative.");
+ABSL_FLAG(std::optional<int>, bidding_load_report_wait_per_rpc_ms, 0,
+          "Roma wait reported by a bidding server that weighs as much as one "
+          "more RPC in flight to it when picking the channel of an RPC. The "
+          "load reports are ignored if 0.");
+ABSL_FLAG(std::optional<int>, max_interest_groups_per_generate_bids_request,
+          0,
+          "Max number of interest groups sent in a single GenerateBids "
+          "request. The interest groups are split into parallel requests "
+          "above it. No limit if 0.");
+ABSL_FLAG(std::optional<bool>, prune_trusted_bidding_signals, false,
+          "Send only the trusted bidding signals of the keys and interest "
+          "groups of a GenerateBids request to the bidding server.");
+ABSL_FLAG(std::optional<bool>, send_interest_group_columns, false,
+          "Send the interest groups of GenerateBids requests in columns, "
+          "which hold the strings repeated across interest groups once. The "
+          "bidding servers must all support them before this is enabled.");
+ABSL_FLAG(std::optional<int>, max_bids_per_get_bids_response, 0,
+          "Max number of Protected Audience bids, and of Protected App "
+          "Signals bids, in a GetBids response. Only the highest bids are "
+          "kept above it. No limit if 0.");
+ABSL_FLAG(std::optional<int>, max_interest_groups_per_get_bids_request, 0,
+          "Max number of interest groups of a GetBids request that bids are "
+          "generated for. The interest groups of the lowest priority are "
+          "dropped above it, before their bidding signals are fetched. No "
+          "limit if 0.");
+ABSL_FLAG(std::optional<std::string>, interest_group_priority, "",
+          "Priority of the interest groups kept within "
+          "max_interest_groups_per_get_bids_request: request_order (the "
+          "default), recency, join_count or bid_count, from the browser "
+          "signals of the interest groups.");
+ABSL_FLAG(std::optional<int>, bfe_max_get_bids_in_flight, 0,
+          "Max number of GetBids requests in flight, shared between sellers "
+          "by weight. Requests past it are rejected. No limit if 0.");
+ABSL_FLAG(std::optional<int>, bfe_get_bids_per_seller_qps, 0,
+          "GetBids requests each seller may start per second. Requests past "
+          "it are rejected. No limit if 0.");
+ABSL_FLAG(std::optional<std::string>, bfe_seller_admission_weights, "",
+          "Weights of the sellers in their shares of the GetBids requests in "
+          "flight, as seller=weight,... Sellers not listed have weight 1.");
+ABSL_FLAG(std::optional<int>, bfe_min_get_bids_time_left_ms, 0,
+          "Time a GetBids request needs at least before its deadline. "
+          "Requests with less time left are rejected. No minimum if 0.");
+ABSL_FLAG(std::optional<int>, bfe_backend_preconnect_timeout_ms, 0,
+          "Time in milliseconds given to each round of connections to the "
+          "Bidding Service at startup, during which the health check reports "
+          "the server as not serving. The Bidding Service is connected on "
+          "the first request if 0.");
+ABSL_FLAG(std::optional<int>, bfe_backend_ready_percent, 0,
+          "Percent of the channels to the Bidding Service that must be "
+          "connected at startup before the health check reports the server "
+          "as serving.");
+ABSL_FLAG(std::optional<std::string>, bfe_request_capture_path,
+          std::nullopt,
+          "File to which the plaintext of the consented GetBids requests is "
+          "appended, for request_replayer to replay them. Only allowed in "
+          "test mode. Nothing is captured if empty.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -109,6 +241,10 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_healthcheck_port, HEALTHCHECK_PORT);
   config_client.SetFlag(FLAGS_bidding_server_addr, BIDDING_SERVER_ADDR);
   config_client.SetFlag(FLAGS_buyer_kv_server_addr, BUYER_KV_SERVER_ADDR);
+  config_client.SetFlag(FLAGS_buyer_tee_kv_server_addr,
+                        BUYER_TEE_KV_SERVER_ADDR);
+  config_client.SetFlag(FLAGS_buyer_tee_kv_server_egress_tls,
+                        BUYER_TEE_KV_SERVER_EGRESS_TLS);
   config_client.SetFlag(FLAGS_generate_bid_timeout_ms, GENERATE_BID_TIMEOUT_MS);
   config_client.SetFlag(FLAGS_protected_app_signals_generate_bid_timeout_ms,
                         PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS);
@@ -158,11 +294,101 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_enable_protected_audience,
                         ENABLE_PROTECTED_AUDIENCE);
   config_client.SetFlag(FLAGS_ps_verbosity, PS_VERBOSITY);
+  config_client.SetFlag(FLAGS_request_phase_tracing_per_mille,
+                        REQUEST_PHASE_TRACING_PER_MILLE);
+  config_client.SetFlag(FLAGS_trace_sampling_per_mille,
+                        TRACE_SAMPLING_PER_MILLE);
+  config_client.SetFlag(FLAGS_enable_profiling, ENABLE_PROFILING);
+  config_client.SetFlag(FLAGS_profiling_interval_ms, PROFILING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_memory_admission_heap_limit_mb,
+                        MEMORY_ADMISSION_HEAP_LIMIT_MB);
+  config_client.SetFlag(FLAGS_memory_admission_request_size_factor,
+                        MEMORY_ADMISSION_REQUEST_SIZE_FACTOR);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_server_max_pollers, GRPC_SERVER_MAX_POLLERS);
+  config_client.SetFlag(FLAGS_grpc_server_max_memory_mb,
+                        GRPC_SERVER_MAX_MEMORY_MB);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads, GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_cpu_placement, CPU_PLACEMENT);
+  config_client.SetFlag(FLAGS_drain_health_check_grace_ms,
+                        DRAIN_HEALTH_CHECK_GRACE_MS);
+  config_client.SetFlag(FLAGS_drain_deadline_ms, DRAIN_DEADLINE_MS);
+  config_client.SetFlag(FLAGS_key_warm_up_timeout_ms, KEY_WARM_UP_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_work_stealing_executor_workers,
+                        WORK_STEALING_EXECUTOR_WORKERS);
+  config_client.SetFlag(FLAGS_large_buffer_pool_mb, LARGE_BUFFER_POOL_MB);
+  config_client.SetFlag(FLAGS_large_buffer_huge_pages,
+                        LARGE_BUFFER_HUGE_PAGES);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_interval_ms,
+                        TCMALLOC_TUNING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_thread_cache_mb,
+                        TCMALLOC_TUNING_MIN_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_thread_cache_mb,
+                        TCMALLOC_TUNING_MAX_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_release_mb_per_second,
+                        TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_release_mb_per_second,
+                        TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND);
   config_client.SetFlag(
       FLAGS_bfe_tcmalloc_background_release_rate_bytes_per_second,
       BFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND);
   config_client.SetFlag(FLAGS_bfe_tcmalloc_max_total_thread_cache_bytes,
                         BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES);
+  config_client.SetFlag(FLAGS_bfe_http_fetcher_num_shards,
+                        BFE_HTTP_FETCHER_NUM_SHARDS);
+  config_client.SetFlag(FLAGS_buyer_kv_min_warm_connections,
+                        BUYER_KV_MIN_WARM_CONNECTIONS);
+  config_client.SetFlag(FLAGS_buyer_kv_rewarm_interval_ms,
+                        BUYER_KV_REWARM_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_enable_buyer_kv_request_coalescing,
+                        ENABLE_BUYER_KV_REQUEST_COALESCING);
+  config_client.SetFlag(FLAGS_buyer_kv_cache_ttl_ms, BUYER_KV_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_buyer_kv_cache_max_bytes,
+                        BUYER_KV_CACHE_MAX_BYTES);
+  config_client.SetFlag(FLAGS_buyer_kv_batch_window_us,
+                        BUYER_KV_BATCH_WINDOW_US);
+  config_client.SetFlag(FLAGS_buyer_kv_hedge_percentile,
+                        BUYER_KV_HEDGE_PERCENTILE);
+  config_client.SetFlag(FLAGS_bidding_grpc_num_channels,
+                        BIDDING_GRPC_NUM_CHANNELS);
+  config_client.SetFlag(FLAGS_bidding_grpc_keepalive_ms,
+                        BIDDING_GRPC_KEEPALIVE_MS);
+  config_client.SetFlag(FLAGS_bidding_grpc_stream_window_bytes,
+                        BIDDING_GRPC_STREAM_WINDOW_BYTES);
+  config_client.SetFlag(FLAGS_bidding_grpc_min_compressed_request_bytes,
+                        BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES);
+  config_client.SetFlag(FLAGS_bidding_server_zonal_addrs,
+                        BIDDING_SERVER_ZONAL_ADDRS);
+  config_client.SetFlag(FLAGS_bidding_zone_spillover_rpcs,
+                        BIDDING_ZONE_SPILLOVER_RPCS);
+  config_client.SetFlag(FLAGS_bidding_load_report_wait_per_rpc_ms,
+                        BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS);
+  config_client.SetFlag(FLAGS_max_interest_groups_per_generate_bids_request,
+                        MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST);
+  config_client.SetFlag(FLAGS_prune_trusted_bidding_signals,
+                        PRUNE_TRUSTED_BIDDING_SIGNALS);
+  config_client.SetFlag(FLAGS_send_interest_group_columns,
+                        SEND_INTEREST_GROUP_COLUMNS);
+  config_client.SetFlag(FLAGS_max_bids_per_get_bids_response,
+                        MAX_BIDS_PER_GET_BIDS_RESPONSE);
+  config_client.SetFlag(FLAGS_max_interest_groups_per_get_bids_request,
+                        MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST);
+  config_client.SetFlag(FLAGS_interest_group_priority,
+                        INTEREST_GROUP_PRIORITY);
+  config_client.SetFlag(FLAGS_bfe_max_get_bids_in_flight,
+                        BFE_MAX_GET_BIDS_IN_FLIGHT);
+  config_client.SetFlag(FLAGS_bfe_get_bids_per_seller_qps,
+                        BFE_GET_BIDS_PER_SELLER_QPS);
+  config_client.SetFlag(FLAGS_bfe_seller_admission_weights,
+                        BFE_SELLER_ADMISSION_WEIGHTS);
+  config_client.SetFlag(FLAGS_bfe_min_get_bids_time_left_ms,
+                        BFE_MIN_GET_BIDS_TIME_LEFT_MS);
+  config_client.SetFlag(FLAGS_bfe_backend_preconnect_timeout_ms,
+                        BFE_BACKEND_PRECONNECT_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_bfe_backend_ready_percent,
+                        BFE_BACKEND_READY_PERCENT);
+  config_client.SetFlag(FLAGS_bfe_request_capture_path,
+                        BFE_REQUEST_CAPTURE_PATH);
 
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
@@ -171,6 +397,21 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   // Set verbosity
   server_common::log::PS_VLOG_IS_ON(
       0, config_client.GetIntParameter(PS_VERBOSITY));
+  RequestPhaseTracer::SetSamplingPerMille(
+      config_client.GetIntParameter(REQUEST_PHASE_TRACING_PER_MILLE));
+  RequestTrace::SetSamplingPerMille(
+      config_client.GetIntParameter(TRACE_SAMPLING_PER_MILLE));
+  MemoryAdmissionController::Get().Configure(
+      {.heap_limit_bytes =
+           config_client.GetInt64Parameter(MEMORY_ADMISSION_HEAP_LIMIT_MB) *
+           1024 * 1024,
+       .request_size_factor = config_client.GetIntParameter(
+           MEMORY_ADMISSION_REQUEST_SIZE_FACTOR)});
+  if (config_client.HasParameter(BFE_REQUEST_CAPTURE_PATH)) {
+    PS_RETURN_IF_ERROR(RequestCapture::Get().Configure(
+        config_client.GetStringParameter(BFE_REQUEST_CAPTURE_PATH),
+        config_client.GetBooleanParameter(TEST_MODE)));
+  }
 
   const bool enable_protected_app_signals =
       config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS);
@@ -194,68 +435,213 @@ absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_ASSIGN_OR_RETURN(
+      const CpuPlacement cpu_placement,
+      ParseCpuPlacement(config_client.GetStringParameter(CPU_PLACEMENT)));
+  PS_ASSIGN_OR_RETURN(
+      const InterestGroupPriority interest_group_priority,
+      ParseInterestGroupPriority(
+          config_client.GetStringParameter(INTEREST_GROUP_PRIORITY)));
+  PS_ASSIGN_OR_RETURN(auto seller_admission_weights,
+                      ParseCallerWeights(config_client.GetStringParameter(
+                          BFE_SELLER_ADMISSION_WEIGHTS)));
+  FairAdmissionController::Get().Configure(
+      {.max_in_flight =
+           config_client.GetIntParameter(BFE_MAX_GET_BIDS_IN_FLIGHT),
+       .caller_requests_per_second = static_cast<double>(
+           config_client.GetIntParameter(BFE_GET_BIDS_PER_SELLER_QPS)),
+       .caller_weights = std::move(seller_admission_weights),
+       .min_time_to_deadline = absl::Milliseconds(
+           config_client.GetIntParameter(BFE_MIN_GET_BIDS_TIME_LEFT_MS))});
 
   MaySetBackgroundReleaseRate(config_client.GetInt64Parameter(
       BFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND));
   MaySetMaxTotalThreadCacheBytes(config_client.GetInt64Parameter(
       BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES));
+  PS_ASSIGN_OR_RETURN(const HugePages large_buffer_huge_pages,
+                      ParseHugePages(config_client.GetStringParameter(
+                          LARGE_BUFFER_HUGE_PAGES)));
+  LargeBufferPool::Configure(
+      {.huge_pages = large_buffer_huge_pages,
+       .max_pooled_bytes = static_cast<size_t>(config_client.GetInt64Parameter(
+                               LARGE_BUFFER_POOL_MB)) *
+                           1024 * 1024});
 
   int port = config_client.GetIntParameter(PORT);
   std::string bidding_server_addr =
       std::string(config_client.GetStringParameter(BIDDING_SERVER_ADDR));
   std::string buyer_kv_server_addr =
       std::string(config_client.GetStringParameter(BUYER_KV_SERVER_ADDR));
+  std::string buyer_tee_kv_server_addr =
+      std::string(config_client.GetStringParameter(BUYER_TEE_KV_SERVER_ADDR));
   bool enable_buyer_frontend_benchmarking =
       config_client.GetBooleanParameter(ENABLE_BUYER_FRONTEND_BENCHMARKING);
   bool enable_bidding_compression =
       config_client.GetBooleanParameter(ENABLE_BIDDING_COMPRESSION);
 
-  if (bidding_server_addr.empty()) {
+  absl::StatusOr<std::vector<ZonalAddress>> bidding_zonal_addresses =
+      ParseZonalAddresses(
+          config_client.GetStringParameter(BIDDING_SERVER_ZONAL_ADDRS));
+  PS_RETURN_IF_ERROR(bidding_zonal_addresses.status());
+  if (bidding_server_addr.empty() && bidding_zonal_addresses->empty()) {
     return absl::InvalidArgumentError("Missing: Bidding server address");
   }
-  if (buyer_kv_server_addr.empty()) {
+  if (buyer_kv_server_addr.empty() && buyer_tee_kv_server_addr.empty()) {
     return absl::InvalidArgumentError("Missing: Buyer KV server address");
   }
 
   server_common::GrpcInit gprc_init;
-  auto executor = std::make_unique<server_common::EventEngineExecutor>(
-      config_client.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
-          ? grpc_event_engine::experimental::CreateEventEngine()
-          : grpc_event_engine::experimental::GetDefaultEventEngine());
-  std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput>>
-      buyer_kv_async_http_client;
-  if (buyer_kv_server_addr == "E2E_TEST_MODE") {
-    buyer_kv_async_http_client =
-        std::make_unique<FakeBuyerKeyValueAsyncHttpClient>(
-            buyer_kv_server_addr);
+  std::unique_ptr<server_common::Executor> executor;
+  {
+    // A new event engine starts its thread pool, which runs the I/O loops and
+    // their callbacks, as do the workers of a work-stealing executor.
+    ScopedCpuPlacement io_placement("I/O loops", cpu_placement.io_cpus);
+    if (const int work_stealing_executor_workers =
+            config_client.GetIntParameter(WORK_STEALING_EXECUTOR_WORKERS);
+        work_stealing_executor_workers > 0) {
+      executor = std::make_unique<WorkStealingExecutor>(
+          WorkStealingExecutorOptions{.num_workers =
+                                          work_stealing_executor_workers});
+    } else {
+      executor = std::make_unique<server_common::EventEngineExecutor>(
+          config_client.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
+              ? grpc_event_engine::experimental::CreateEventEngine()
+              : grpc_event_engine::experimental::GetDefaultEventEngine());
+    }
+  }
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      key_fetcher_manager = CreateKeyFetcherManager(
+          config_client, CreatePublicKeyFetcher(config_client));
+  std::unique_ptr<BiddingSignalsAsyncProvider> bidding_signals_async_provider;
+  if (!buyer_tee_kv_server_addr.empty()) {
+    // Fetches the signals with the KV v2 API over gRPC.
+    bidding_signals_async_provider =
+        std::make_unique<KVBiddingSignalsAsyncProvider>(
+            std::make_unique<KVAsyncGrpcClient>(
+                key_fetcher_manager.get(),
+                kv_server::v2::KeyValueService::NewStub(CreateChannel(
+                    buyer_tee_kv_server_addr, /*compression=*/true,
+                    /*secure=*/config_client.GetBooleanParameter(
+                        BUYER_TEE_KV_SERVER_EGRESS_TLS)))),
+            KVBatchingOptions{
+                .executor = executor.get(),
+                .window = absl::Microseconds(config_client.GetIntParameter(
+                    BUYER_KV_BATCH_WINDOW_US))});
   } else {
-    buyer_kv_async_http_client = std::make_unique<BuyerKeyValueAsyncHttpClient>(
-        buyer_kv_server_addr,
-        std::make_unique<MultiCurlHttpFetcherAsync>(executor.get()), true);
+    std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput>>
+        buyer_kv_async_http_client;
+    if (buyer_kv_server_addr == "E2E_TEST_MODE") {
+      buyer_kv_async_http_client =
+          std::make_unique<FakeBuyerKeyValueAsyncHttpClient>(
+              buyer_kv_server_addr);
+    } else {
+      std::unique_ptr<HttpFetcherAsync> fetcher;
+      if (int num_shards =
+              config_client.GetIntParameter(BFE_HTTP_FETCHER_NUM_SHARDS);
+          num_shards == 1) {
+        fetcher = std::make_unique<MultiCurlHttpFetcherAsync>(executor.get());
+      } else {
+        auto sharded_fetcher = std::make_unique<ShardedHttpFetcherAsync>(
+            executor.get(), num_shards);
+        PS_LOG(INFO) << "Using " << sharded_fetcher->NumShards()
+                     << " HTTP fetcher shards for buyer KV fetches";
+        fetcher = std::move(sharded_fetcher);
+      }
+      buyer_kv_async_http_client =
+          std::make_unique<BuyerKeyValueAsyncHttpClient>(
+              buyer_kv_server_addr, std::move(fetcher), true,
+              ConnectionWarmingOptions{
+                  .executor = executor.get(),
+                  .min_warm_connections = config_client.GetIntParameter(
+                      BUYER_KV_MIN_WARM_CONNECTIONS),
+                  .rewarm_interval =
+                      absl::Milliseconds(config_client.GetIntParameter(
+                          BUYER_KV_REWARM_INTERVAL_MS))},
+              KvEndpointOptions{
+                  .executor = executor.get(),
+                  .hedge_percentile = config_client.GetIntParameter(
+                      BUYER_KV_HEDGE_PERCENTILE)});
+    }
+    if (config_client.GetBooleanParameter(ENABLE_BUYER_KV_REQUEST_COALESCING)) {
+      buyer_kv_async_http_client =
+          std::make_unique<CoalescingBuyerKeyValueAsyncClient>(
+              std::move(buyer_kv_async_http_client),
+              KvCoalescingOptions{
+                  .cache_ttl = absl::Milliseconds(
+                      config_client.GetIntParameter(BUYER_KV_CACHE_TTL_MS)),
+                  .cache_max_bytes = config_client.GetInt64Parameter(
+                      BUYER_KV_CACHE_MAX_BYTES)});
+    }
+    bidding_signals_async_provider =
+        std::make_unique<HttpBiddingSignalsAsyncProvider>(
+            std::move(buyer_kv_async_http_client));
   }
 
   InitTelemetry<GetBidsRequest>(config_util, config_client, metric::kBfe);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kHttpFetcherShardQueueDepth,
+      ShardedHttpFetcherAsync::GetQueueDepthByShard);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kHttpFetcherShardLoopLagMs,
+      ShardedHttpFetcherAsync::GetLoopLagMsByShard);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kHttpFetcherShardLoopStallMs,
+      ShardedHttpFetcherAsync::GetLoopStallMsByShard);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kHttpFetcherReuseRatio,
+      MultiCurlHttpFetcherAsync::GetReuseRatios);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kGrpcRequestCompressionShare, GetGrpcRequestCompressionShares);
+  metric::BfeContextMap()->AddObserverable(
+      metric::kBfeKVLookupRatio,
+      CoalescingBuyerKeyValueAsyncClient::GetLookupRatios);
+  std::unique_ptr<ProfilingService> profiling_service =
+      MayStartProfiling(config_client);
+  std::unique_ptr<TcmallocTuner> tcmalloc_tuner =
+      MayStartTcmallocTuning(config_client);
 
   BuyerFrontEndService buyer_frontend_service(
-      std::make_unique<HttpBiddingSignalsAsyncProvider>(
-          std::move(buyer_kv_async_http_client)),
+      std::move(bidding_signals_async_provider),
       BiddingServiceClientConfig{
           .server_addr = bidding_server_addr,
           .compression = enable_bidding_compression,
+          .compression_policy =
+              {.min_compressed_bytes = config_client.GetIntParameter(
+                   BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES)},
           .secure_client =
               config_client.GetBooleanParameter(BIDDING_EGRESS_TLS),
           .is_pas_enabled =
-              config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS)},
-      CreateKeyFetcherManager(config_client,
-                              CreatePublicKeyFetcher(config_client)),
-      CreateCryptoClient(),
+              config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS),
+          .channel_pool =
+              {.num_channels =
+                   config_client.GetIntParameter(BIDDING_GRPC_NUM_CHANNELS),
+               .keepalive_time = absl::Milliseconds(
+                   config_client.GetIntParameter(BIDDING_GRPC_KEEPALIVE_MS)),
+               .http2_stream_window_bytes = config_client.GetIntParameter(
+                   BIDDING_GRPC_STREAM_WINDOW_BYTES),
+               .zonal_addresses = *std::move(bidding_zonal_addresses),
+               .local_zone = std::string(config_util.GetZone()),
+               .zone_spillover_rpcs = config_client.GetIntParameter(
+                   BIDDING_ZONE_SPILLOVER_RPCS),
+               .load_report_wait_per_rpc =
+                   absl::Milliseconds(config_client.GetIntParameter(
+                       BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS))}},
+      std::move(key_fetcher_manager), CreateCryptoClient(),
       GetBidsConfig{
           config_client.GetIntParameter(GENERATE_BID_TIMEOUT_MS),
           config_client.GetIntParameter(BIDDING_SIGNALS_LOAD_TIMEOUT_MS),
           config_client.GetIntParameter(
               PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS),
           config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS),
-          config_client.GetBooleanParameter(ENABLE_PROTECTED_AUDIENCE)},
+          config_client.GetBooleanParameter(ENABLE_PROTECTED_AUDIENCE),
+          config_client.GetIntParameter(
+              MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST),
+          config_client.GetBooleanParameter(PRUNE_TRUSTED_BIDDING_SIGNALS),
+          config_client.GetIntParameter(MAX_BIDS_PER_GET_BIDS_RESPONSE),
+          config_client.GetIntParameter(
+              MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST),
+          interest_group_priority,
+          config_client.GetBooleanParameter(SEND_INTEREST_GROUP_COLUMNS)},
       enable_buyer_frontend_benchmarking);
 
   grpc::EnableDefaultHealthCheckService(true);
@@ -298,17 +684,47 @@ absl::Status RunServer() {
   // Set max message size to 256 MB.
   builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
                              256L * 1024L * 1024L);
+  ApplyGrpcServerOptions(
+      {.num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_pollers = config_client.GetIntParameter(GRPC_SERVER_MAX_POLLERS),
+       .max_memory_bytes =
+           config_client.GetInt64Parameter(GRPC_SERVER_MAX_MEMORY_MB) * 1024 *
+           1024,
+       .max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS)},
+      builder);
+  // GetBids is served over its raw messages, which are on an arena of each
+  // call, see RawCiphertextCall.
   builder.RegisterService(&buyer_frontend_service);
 
-  std::unique_ptr<Server> server(builder.BuildAndStart());
+  std::unique_ptr<Server> server;
+  {
+    // The threads serving the completion queues start with the server.
+    ScopedCpuPlacement grpc_placement("gRPC threads", cpu_placement.grpc_cpus);
+    server = builder.BuildAndStart();
+  }
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
   PS_LOG(INFO) << "Server listening on " << server_address;
+  PreconnectBackends(
+      {.timeout = absl::Milliseconds(config_client.GetIntParameter(
+           BFE_BACKEND_PRECONNECT_TIMEOUT_MS)),
+       .ready_percent =
+           config_client.GetIntParameter(BFE_BACKEND_READY_PERCENT)},
+      [&buyer_frontend_service](absl::Time deadline) {
+        return buyer_frontend_service.ConnectBackends(deadline)
+            .ConnectedPercent();
+      },
+      *server);
 
-  // Wait for the server to shut down. Note that some other thread must be
-  // responsible for shutting down the server for this call to ever return.
-  server->Wait();
+  // Drains the server on SIGTERM.
+  ServerDrain drain(
+      {.health_check_grace = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_HEALTH_CHECK_GRACE_MS)),
+       .deadline = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_DEADLINE_MS))});
+  drain.AddStep("telemetry", FlushTelemetry);
+  drain.Wait(*server);
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -20,9 +20,13 @@
 #include <grpcpp/grpcpp.h>
 
 #include "api/bidding_auction_servers.pb.h"
+#include "services/buyer_frontend_service/get_bids_batch_reactor.h"
+#include "services/buyer_frontend_service/get_bids_stream_reactor.h"
 #include "services/buyer_frontend_service/get_bids_unary_reactor.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/util/memory_admission_controller.h"
 #include "src/telemetry/telemetry.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -39,17 +43,17 @@ BuyerFrontEndService::BuyerFrontEndService(
       enable_benchmarking_(enable_benchmarking),
       key_fetcher_manager_(std::move(key_fetcher_manager)),
       crypto_client_(std::move(crypto_client)),
-      stub_(Bidding::NewStub(CreateChannel(client_config.server_addr,
-                                           client_config.compression,
-                                           client_config.secure_client))),
+      stub_pool_(GrpcStubPool<Bidding::Stub>::Create<Bidding>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool)),
       bidding_async_client_(std::make_unique<BiddingAsyncGrpcClient>(
           key_fetcher_manager_.get(), crypto_client_.get(), client_config,
-          stub_.get())) {
+          stub_pool_.get())) {
   if (config_.is_protected_app_signals_enabled) {
     protected_app_signals_bidding_async_client_ =
         std::make_unique<ProtectedAppSignalsBiddingAsyncGrpcClient>(
             key_fetcher_manager_.get(), crypto_client_.get(), client_config,
-            stub_.get());
+            stub_pool_.get());
   }
 }
 
@@ -66,10 +70,49 @@ BuyerFrontEndService::BuyerFrontEndService(ClientRegistry client_registry,
       protected_app_signals_bidding_async_client_(std::move(
           client_registry.protected_app_signals_bidding_async_client)) {}
 
+ChannelConnectivity BuyerFrontEndService::ConnectBackends(
+    absl::Time deadline) const {
+  if (stub_pool_ == nullptr) {
+    return {};
+  }
+  return ConnectChannels(stub_pool_->channels(), deadline);
+}
+
 grpc::ServerUnaryReactor* BuyerFrontEndService::GetBids(
     grpc::CallbackServerContext* context, const GetBidsRequest* request,
     GetBidsResponse* response) {
-  LogCommonMetric(request, response);
+  return ServeGetBids(context, request, response, /*raw_call=*/nullptr);
+}
+
+grpc::ServerUnaryReactor* BuyerFrontEndService::GetBids(
+    grpc::CallbackServerContext* context, const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+  absl::StatusOr<
+      std::shared_ptr<RawCiphertextCall<GetBidsRequest, GetBidsResponse>>>
+      raw_call = RawCiphertextCall<GetBidsRequest, GetBidsResponse>::Read(
+          *request, response);
+  if (!raw_call.ok()) {
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(raw_call.status()));
+    return reactor;
+  }
+  return ServeGetBids(context, (*raw_call)->request(), (*raw_call)->response(),
+                      *std::move(raw_call));
+}
+
+grpc::ServerUnaryReactor* BuyerFrontEndService::ServeGetBids(
+    grpc::CallbackServerContext* context, const GetBidsRequest* request,
+    GetBidsResponse* response,
+    std::shared_ptr<RawCiphertextCall<GetBidsRequest, GetBidsResponse>>
+        raw_call) {
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    LogRejectedRequestMetric(request, response, memory_reservation.status());
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
 
   // Will be deleted in onDone
   auto reactor = std::make_unique<GetBidsUnaryReactor>(
@@ -77,6 +120,50 @@ grpc::ServerUnaryReactor* BuyerFrontEndService::GetBids(
       *bidding_async_client_, config_,
       protected_app_signals_bidding_async_client_.get(),
       key_fetcher_manager_.get(), crypto_client_.get(), enable_benchmarking_);
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
+  if (raw_call != nullptr) {
+    reactor->ServeRawCall(std::move(raw_call));
+  }
+  reactor->Execute();
+  return reactor.release();
+}
+
+grpc::ServerUnaryReactor* BuyerFrontEndService::GetBidsBatch(
+    grpc::CallbackServerContext* context, const GetBidsBatchRequest* request,
+    GetBidsBatchResponse* response) {
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
+
+  // Will be deleted in onDone
+  auto reactor = std::make_unique<GetBidsBatchReactor>(
+      *request, *response,
+      [this, context](const GetBidsRequest& get_bids_request,
+                      GetBidsResponse& get_bids_response) {
+        return std::make_unique<GetBidsUnaryReactor>(
+            *context, get_bids_request, get_bids_response,
+            *bidding_signals_async_provider_, *bidding_async_client_, config_,
+            protected_app_signals_bidding_async_client_.get(),
+            key_fetcher_manager_.get(), crypto_client_.get(),
+            enable_benchmarking_);
+      });
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
+  reactor->Execute();
+  return reactor.release();
+}
+
+grpc::ServerReadReactor<GetBidsStreamChunk>*
+BuyerFrontEndService::GetBidsStream(grpc::CallbackServerContext* context,
+                                    GetBidsResponse* response) {
+  // Will be deleted in onDone
+  auto reactor = std::make_unique<GetBidsStreamReactor>(
+      *context, *response, *bidding_signals_async_provider_,
+      *bidding_async_client_, config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
   reactor->Execute();
   return reactor.release();
 }
@@ -19,10 +19,13 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/buyer_frontend_service/data/get_bids_config.h"
 #include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
 #include "services/common/clients/bidding_server/bidding_async_client.h"
+#include "services/common/util/raw_ciphertext_call.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -44,7 +47,10 @@ struct ClientRegistry {
 // during an Ad auction. The server looks up realtime buyer's signals and calls
 // Bidding Service to execute AdTech's code in a secure privacy sandbox inside a
 // secure Virtual Machine for generating the bids for the auction.
-class BuyerFrontEndService final : public BuyerFrontEnd::CallbackService {
+// GetBids is served over its raw messages, see RawCiphertextCall.
+class BuyerFrontEndService final
+    : public BuyerFrontEnd::WithRawCallbackMethod_GetBids<
+          BuyerFrontEnd::CallbackService> {
  public:
   explicit BuyerFrontEndService(
       std::unique_ptr<BiddingSignalsAsyncProvider>
@@ -75,7 +81,35 @@ class BuyerFrontEndService final : public BuyerFrontEnd::CallbackService {
                                     const GetBidsRequest* request,
                                     GetBidsResponse* response) override;
 
+  // Serves GetBids over its raw messages, as above.
+  grpc::ServerUnaryReactor* GetBids(grpc::CallbackServerContext* context,
+                                    const grpc::ByteBuffer* request,
+                                    grpc::ByteBuffer* response) override;
+
+  // Returns the bids of several buyers hosted on this service, in the order
+  // of their requests. Each request is served as by GetBids, in parallel.
+  grpc::ServerUnaryReactor* GetBidsBatch(
+      grpc::CallbackServerContext* context, const GetBidsBatchRequest* request,
+      GetBidsBatchResponse* response) override;
+
+  // Serves GetBids over a stream of the request followed by chunks of its
+  // interest groups, which are bid on as they arrive.
+  grpc::ServerReadReactor<GetBidsStreamChunk>* GetBidsStream(
+      grpc::CallbackServerContext* context,
+      GetBidsResponse* response) override;
+
+  // Connects the channels to the Bidding Service ahead of the first GetBids
+  // calls, waiting until they are connected or until `deadline`.
+  ChannelConnectivity ConnectBackends(absl::Time deadline) const;
+
  private:
+  // Serves a GetBids call, over the raw messages of `raw_call` if not null.
+  grpc::ServerUnaryReactor* ServeGetBids(
+      grpc::CallbackServerContext* context, const GetBidsRequest* request,
+      GetBidsResponse* response,
+      std::shared_ptr<RawCiphertextCall<GetBidsRequest, GetBidsResponse>>
+          raw_call);
+
   // The Bidding signals provider is used to fetch signals required for bidding
   // from external sources, such as a KeyValue server or an HTTP server.
   std::unique_ptr<BiddingSignalsAsyncProvider> bidding_signals_async_provider_;
@@ -85,8 +119,8 @@ class BuyerFrontEndService final : public BuyerFrontEnd::CallbackService {
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
-  // Stub to make GRPC calls to the bidding service.
-  std::unique_ptr<Bidding::Stub> stub_;
+  // Stubs to make GRPC calls to the bidding service, shared by the clients.
+  std::unique_ptr<GrpcStubPool<Bidding::Stub>> stub_pool_;
   // The BiddingAsyncClient is used to call Bidding Service to execute
   // AdTech's code in a secure privacy sandbox and generate the bids.
   // The bids received in response from the BiddingAsyncClient are returned
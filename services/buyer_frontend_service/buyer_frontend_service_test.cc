@@ -118,6 +118,18 @@ std::unique_ptr<MockCryptoClientWrapper> CreateCryptoClient() {
             *aead_encrypt_response.mutable_encrypted_data() = std::move(data);
             return aead_encrypt_response;
           });
+
+  // Mock the AeadDecrypt() call on the crypto_client. This is used to decrypt
+  // the interest groups streamed to the service.
+  EXPECT_CALL(*crypto_client, AeadDecrypt)
+      .Times(AnyNumber())
+      .WillRepeatedly(
+          [](const std::string& ciphertext, const std::string& secret) {
+            google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse
+                aead_decrypt_response;
+            *aead_decrypt_response.mutable_payload() = ciphertext;
+            return aead_decrypt_response;
+          });
   return crypto_client;
 }
 
@@ -149,8 +161,7 @@ class BuyerFrontEndServiceTest : public ::testing::Test {
     server_common::telemetry::TelemetryConfig config_proto;
     config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
     metric::MetricContextMap<GetBidsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request_);
+        server_common::telemetry::BuildDependentConfig(config_proto));
   }
 
   BiddingServiceClientConfig bidding_service_client_config_;
@@ -711,5 +722,139 @@ TEST_F(BuyerFrontEndServiceTest,
   EXPECT_THAT(status.error_message(), HasSubstr(kMissingInputs));
 }
 
+TEST_F(BuyerFrontEndServiceTest, GetBidsBatchReturnsTheResultOfEachRequest) {
+  auto bidding_signals_async_provider = SetupBiddingProviderMock(
+      /*bidding_signals_value=*/valid_bidding_signals,
+      /*repeated_get_allowed=*/false,
+      /*server_error_to_return=*/std::nullopt);
+  auto bidding_async_client = GetValidBiddingAsyncClientMock();
+  auto protected_app_signals_bidding_async_client =
+      GetProtectedAppSignalsBiddingClientMockThatWillNotBeCalled();
+
+  BuyerFrontEndService buyer_frontend_service(
+      CreateClientRegistry(
+          std::move(bidding_signals_async_provider),
+          std::move(bidding_async_client),
+          std::move(protected_app_signals_bidding_async_client)),
+      CreateGetBidsConfig());
+  GetBidsBatchRequest batch_request;
+  *batch_request.add_requests() =
+      CreateGetBidsRequest(/*add_protected_signals_input=*/false,
+                           /*add_protected_audience_input=*/true);
+  *batch_request.add_requests() =
+      CreateGetBidsRequest(/*add_protected_signals_input=*/false,
+                           /*add_protected_audience_input=*/false);
+  auto start_bfe_result = StartLocalService(&buyer_frontend_service);
+  auto stub = CreateServiceStub<BuyerFrontEnd>(start_bfe_result.port);
+  GetBidsBatchResponse batch_response;
+  grpc::Status status =
+      stub->GetBidsBatch(&client_context_, batch_request, &batch_response);
+
+  ASSERT_TRUE(status.ok()) << server_common::ToAbslStatus(status);
+  ASSERT_EQ(batch_response.results_size(), 2);
+  ASSERT_EQ(batch_response.results(0).status_code(), grpc::StatusCode::OK);
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  raw_response.ParseFromString(
+      batch_response.results(0).response().response_ciphertext());
+  EXPECT_EQ(raw_response.bids_size(), 1);
+  EXPECT_NE(batch_response.results(1).status_code(), grpc::StatusCode::OK);
+  EXPECT_THAT(batch_response.results(1).status_message(),
+              HasSubstr(kMissingInputs));
+}
+
+TEST_F(BuyerFrontEndServiceTest, GetBidsStreamBidsOnEachChunk) {
+  auto bidding_signals_async_provider = SetupBiddingProviderMock(
+      /*bidding_signals_value=*/valid_bidding_signals,
+      /*repeated_get_allowed=*/true,
+      /*server_error_to_return=*/std::nullopt);
+  auto bidding_async_client = std::make_unique<BiddingAsyncClientMock>();
+  EXPECT_CALL(
+      *bidding_async_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                         GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(2)
+      .WillRepeatedly(
+          [](std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                 raw_request,
+             const RequestMetadata& metadata, auto on_done,
+             absl::Duration timeout) {
+            EXPECT_EQ(raw_request->interest_group_for_bidding_size(), 1);
+            auto raw_response = std::make_unique<GenerateBidsRawResponse>();
+            *raw_response->mutable_bids()->Add() = CreateAdWithBid();
+            std::move(on_done)(std::move(raw_response));
+            return absl::OkStatus();
+          });
+  auto protected_app_signals_bidding_async_client =
+      GetProtectedAppSignalsBiddingClientMockThatWillNotBeCalled();
+
+  BuyerFrontEndService buyer_frontend_service(
+      CreateClientRegistry(
+          std::move(bidding_signals_async_provider),
+          std::move(bidding_async_client),
+          std::move(protected_app_signals_bidding_async_client)),
+      CreateGetBidsConfig());
+  // The request is sent without its interest groups, which follow in chunks
+  // of one.
+  GetBidsRequest::GetBidsRawRequest raw_request =
+      CreateGetBidsRawRequest(/*add_protected_signals_input=*/false,
+                              /*add_protected_audience_input=*/true);
+  ASSERT_EQ(raw_request.buyer_input().interest_groups_size(), 1);
+  BuyerInput chunk;
+  *chunk.add_interest_groups() = raw_request.buyer_input().interest_groups(0);
+  raw_request.mutable_buyer_input()->clear_interest_groups();
+  GetBidsStreamChunk request_message;
+  request_message.mutable_request()->set_request_ciphertext(
+      raw_request.SerializeAsString());
+  request_message.mutable_request()->set_key_id(kTestKeyId);
+  GetBidsStreamChunk chunk_message;
+  chunk_message.set_interest_groups_ciphertext(chunk.SerializeAsString());
+
+  auto start_bfe_result = StartLocalService(&buyer_frontend_service);
+  auto stub = CreateServiceStub<BuyerFrontEnd>(start_bfe_result.port);
+  std::unique_ptr<grpc::ClientWriter<GetBidsStreamChunk>> writer =
+      stub->GetBidsStream(&client_context_, &response_);
+  ASSERT_TRUE(writer->Write(request_message));
+  ASSERT_TRUE(writer->Write(chunk_message));
+  ASSERT_TRUE(writer->Write(chunk_message));
+  ASSERT_TRUE(writer->WritesDone());
+  grpc::Status status = writer->Finish();
+
+  ASSERT_TRUE(status.ok()) << server_common::ToAbslStatus(status);
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  raw_response.ParseFromString(response_.response_ciphertext());
+  EXPECT_EQ(raw_response.bids_size(), 2);
+}
+
+TEST_F(BuyerFrontEndServiceTest, GetBidsStreamFailsWithoutInterestGroups) {
+  auto bidding_signals_async_provider = std::make_unique<
+      MockAsyncProvider<BiddingSignalsRequest, BiddingSignals>>();
+  EXPECT_CALL(*bidding_signals_async_provider, Get).Times(0);
+  BuyerFrontEndService buyer_frontend_service(
+      CreateClientRegistry(
+          std::move(bidding_signals_async_provider),
+          GetValidBiddingAsyncClientMockNotCalled(),
+          GetProtectedAppSignalsBiddingClientMockThatWillNotBeCalled()),
+      CreateGetBidsConfig());
+  GetBidsStreamChunk request_message;
+  *request_message.mutable_request() =
+      CreateGetBidsRequest(/*add_protected_signals_input=*/false,
+                           /*add_protected_audience_input=*/false);
+
+  auto start_bfe_result = StartLocalService(&buyer_frontend_service);
+  auto stub = CreateServiceStub<BuyerFrontEnd>(start_bfe_result.port);
+  std::unique_ptr<grpc::ClientWriter<GetBidsStreamChunk>> writer =
+      stub->GetBidsStream(&client_context_, &response_);
+  writer->Write(request_message);
+  writer->WritesDone();
+  grpc::Status status = writer->Finish();
+
+  ASSERT_FALSE(status.ok());
+  EXPECT_THAT(status.error_message(), HasSubstr(kMissingInputs));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -19,6 +19,19 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Order in which the interest groups of a request are kept when there are
+// more of them than bids are generated for.
+enum class InterestGroupPriority {
+  // The first interest groups of the request.
+  kRequestOrder,
+  // The interest groups joined most recently.
+  kRecency,
+  // The interest groups joined the most times.
+  kJoinCount,
+  // The interest groups which bid the most times.
+  kBidCount,
+};
+
 struct GetBidsConfig {
   // The max time to wait for generate bid request to finish.
   int generate_bid_timeout_ms;
@@ -31,6 +44,25 @@ struct GetBidsConfig {
   bool is_protected_app_signals_enabled;
   // Indicates whether Protected Audience support is enabled or not.
   bool is_protected_audience_enabled;
+  // Max number of interest groups sent in a single generate bids request. The
+  // interest groups are split into parallel requests above it. No limit if 0.
+  int max_interest_groups_per_generate_bids_request = 0;
+  // Indicates whether the trusted bidding signals sent to the bidding service
+  // are pruned to the keys and interest groups of the request.
+  bool prune_trusted_bidding_signals = false;
+  // Max number of bids of each kind, Protected Audience and Protected App
+  // Signals, in a GetBids response. Only the highest bids are kept above it.
+  // No limit if 0.
+  int max_bids_per_get_bids_response = 0;
+  // Max number of interest groups of a GetBids request that bids are
+  // generated for. The interest groups of the lowest priority are dropped
+  // above it, before their bidding signals are fetched. No limit if 0.
+  int max_interest_groups_per_get_bids_request = 0;
+  InterestGroupPriority interest_group_priority =
+      InterestGroupPriority::kRequestOrder;
+  // Indicates whether the interest groups of generate bids requests are sent
+  // in columns, which hold the strings repeated across interest groups once.
+  bool send_interest_group_columns = false;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
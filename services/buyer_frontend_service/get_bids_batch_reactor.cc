@@ -0,0 +1,88 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/buyer_frontend_service/get_bids_batch_reactor.h"
+
+#include <utility>
+#include <vector>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+GetBidsBatchReactor::GetBidsBatchReactor(const GetBidsBatchRequest& request,
+                                         GetBidsBatchResponse& response,
+                                         ReactorFactory reactor_factory)
+    : request_(&request),
+      response_(&response),
+      reactor_factory_(std::move(reactor_factory)) {}
+
+void GetBidsBatchReactor::Execute() {
+  const int num_requests = request_->requests_size();
+  if (num_requests == 0) {
+    Finish(grpc::Status::OK);
+    return;
+  }
+  // Every reactor is created before any is started, so that the reactors are
+  // left untouched while the requests run.
+  response_->mutable_results()->Reserve(num_requests);
+  reactors_.reserve(num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    GetBidsBatchResponse::Result* result = response_->add_results();
+    std::unique_ptr<GetBidsUnaryReactor> reactor =
+        reactor_factory_(request_->requests(i), *result->mutable_response());
+    reactor->SetOnFinish([this, i](const grpc::Status& status) {
+      OnRequestFinished(i, status);
+    });
+    reactors_.push_back(std::move(reactor));
+  }
+  num_pending_.store(num_requests, std::memory_order_relaxed);
+  // The batch may be done, and the current instance gone, as soon as the last
+  // request is started, so the reactors are not reached through it.
+  std::vector<GetBidsUnaryReactor*> reactors;
+  reactors.reserve(num_requests);
+  for (std::unique_ptr<GetBidsUnaryReactor>& reactor : reactors_) {
+    reactors.push_back(reactor.get());
+  }
+  for (GetBidsUnaryReactor* reactor : reactors) {
+    reactor->Execute();
+  }
+}
+
+void GetBidsBatchReactor::OnRequestFinished(int index,
+                                            const grpc::Status& status) {
+  GetBidsBatchResponse::Result& result = *response_->mutable_results(index);
+  result.set_status_code(status.error_code());
+  if (!status.ok()) {
+    result.set_status_message(status.error_message());
+    result.clear_response();
+  }
+  if (num_pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Finish(grpc::Status::OK);
+  }
+}
+
+void GetBidsBatchReactor::OnCancel() {
+  for (std::unique_ptr<GetBidsUnaryReactor>& reactor : reactors_) {
+    reactor->OnCancel();
+  }
+}
+
+void GetBidsBatchReactor::OnDone() {
+  for (std::unique_ptr<GetBidsUnaryReactor>& reactor : reactors_) {
+    // Deletes the reactor.
+    reactor.release()->OnDone();
+  }
+  delete this;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
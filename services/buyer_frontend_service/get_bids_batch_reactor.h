@@ -0,0 +1,77 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_BATCH_REACTOR_H_
+#define SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_BATCH_REACTOR_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/functional/any_invocable.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "services/buyer_frontend_service/get_bids_unary_reactor.h"
+#include "services/common/util/memory_admission_controller.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// gRPC server reactor serving a GetBidsBatchRequest, i.e. the GetBidsRequests
+// of several buyers hosted on this service. Each request is served by its own
+// GetBidsUnaryReactor, all of them in parallel, and the RPC finishes once all
+// of them are done, with the result of each in the response.
+class GetBidsBatchReactor : public grpc::ServerUnaryReactor {
+ public:
+  // Creates the reactor serving a request of the batch into `response`.
+  using ReactorFactory =
+      absl::AnyInvocable<std::unique_ptr<GetBidsUnaryReactor>(
+          const GetBidsRequest& request, GetBidsResponse& response)>;
+
+  GetBidsBatchReactor(const GetBidsBatchRequest& request,
+                      GetBidsBatchResponse& response,
+                      ReactorFactory reactor_factory);
+
+  // GetBidsBatchReactor is neither copyable nor movable.
+  GetBidsBatchReactor(const GetBidsBatchReactor&) = delete;
+  GetBidsBatchReactor& operator=(const GetBidsBatchReactor&) = delete;
+
+  // Starts the execution of the requests of the batch.
+  void Execute();
+  // Holds the memory reserved for the batch until the reactor is done.
+  void HoldMemoryReservation(MemoryReservation memory_reservation) {
+    memory_reservation_ = std::move(memory_reservation);
+  }
+  // Deletes the reactors of the requests, then the current instance.
+  void OnDone() override;
+  // Cancels the requests of the batch.
+  void OnCancel() override;
+
+ private:
+  // Records the status of the request at `index`, and finishes the RPC once
+  // every request is done.
+  void OnRequestFinished(int index, const grpc::Status& status);
+
+  const GetBidsBatchRequest* request_;
+  GetBidsBatchResponse* response_;
+  ReactorFactory reactor_factory_;
+  std::vector<std::unique_ptr<GetBidsUnaryReactor>> reactors_;
+  std::atomic<int> num_pending_ = 0;
+  MemoryReservation memory_reservation_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_BATCH_REACTOR_H_
@@ -0,0 +1,410 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/buyer_frontend_service/get_bids_stream_reactor.h"
+
+#include <utility>
+
+#include "absl/strings/str_join.h"
+#include "services/buyer_frontend_service/get_bids_unary_reactor.h"
+#include "services/buyer_frontend_service/util/proto_factory.h"
+#include "services/common/constants/user_error_strings.h"
+#include "services/common/util/bid_budget.h"
+#include "services/common/util/error_categories.h"
+#include "services/common/util/interest_group_columns.h"
+#include "services/common/util/request_response_constants.h"
+#include "src/util/status_macro/status_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+
+inline constexpr char kUnsupportedStreamInput[] =
+    "Only the interest groups of protected audience can be streamed.";
+
+}  // namespace
+
+GetBidsStreamReactor::GetBidsStreamReactor(
+    grpc::CallbackServerContext& context, GetBidsResponse& get_bids_response,
+    const BiddingSignalsAsyncProvider& bidding_signals_async_provider,
+    const BiddingAsyncClient& bidding_async_client, const GetBidsConfig& config,
+    server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+    CryptoClientWrapperInterface* crypto_client)
+    : context_(&context),
+      get_bids_response_(&get_bids_response),
+      bidding_signals_async_provider_(&bidding_signals_async_provider),
+      bidding_async_client_(&bidding_async_client),
+      config_(config),
+      key_fetcher_manager_(key_fetcher_manager),
+      crypto_client_(crypto_client),
+      kv_metadata_(GrpcMetadataToRequestMetadata(context.client_metadata(),
+                                                 kBuyerKVMetadata)),
+      bidding_metadata_(GrpcMetadataToRequestMetadata(context.client_metadata(),
+                                                      kBiddingMetadata)) {}
+
+void GetBidsStreamReactor::Execute() { StartRead(&chunk_); }
+
+void GetBidsStreamReactor::OnReadDone(bool ok) {
+  if (!ok) {
+    // The client closed the stream, or the call was cancelled.
+    if (is_first_message_) {
+      FailStream(grpc::Status(grpc::INVALID_ARGUMENT, kMissingInputs));
+      return;
+    }
+    bool is_last_task;
+    {
+      absl::MutexLock lock(&mu_);
+      reads_done_ = true;
+      is_last_task = IsLastTask();
+    }
+    if (is_last_task) {
+      FinishRequest();
+    }
+    return;
+  }
+
+  if (is_first_message_) {
+    is_first_message_ = false;
+    if (!StartRequest()) {
+      return;
+    }
+  } else {
+    if (!chunk_.has_interest_groups_ciphertext()) {
+      FailStream(grpc::Status(grpc::INVALID_ARGUMENT, kMalformedCiphertext));
+      return;
+    }
+    absl::StatusOr<BuyerInput> buyer_input =
+        DecryptInterestGroups(chunk_.interest_groups_ciphertext());
+    if (!buyer_input.ok()) {
+      PS_LOG(ERROR, *log_context_)
+          << "Decrypting the interest groups failed: " << buyer_input.status();
+      FailStream(grpc::Status(grpc::INVALID_ARGUMENT, kMalformedCiphertext));
+      return;
+    }
+    BidOnInterestGroups(*std::move(buyer_input));
+  }
+  StartRead(&chunk_);
+}
+
+bool GetBidsStreamReactor::StartRequest() {
+  if (!chunk_.has_request()) {
+    FailStream(grpc::Status(grpc::INVALID_ARGUMENT, kMissingInputs));
+    return false;
+  }
+  const grpc::Status decrypt_status = DecryptRequest(chunk_.request());
+  log_context_.emplace(GetLoggingContext(),
+                       raw_request_.consented_debug_config(),
+                       [this]() { return raw_response_.mutable_debug_info(); });
+  if (!decrypt_status.ok()) {
+    PS_LOG(ERROR, *log_context_)
+        << "Decrypting the request failed:"
+        << server_common::ToAbslStatus(decrypt_status);
+    FailStream(decrypt_status);
+    return false;
+  }
+  if (!config_.is_protected_audience_enabled ||
+      raw_request_.has_protected_app_signals_buyer_input()) {
+    PS_LOG(ERROR, *log_context_) << kUnsupportedStreamInput;
+    FailStream(grpc::Status(grpc::INVALID_ARGUMENT, kUnsupportedStreamInput));
+    return false;
+  }
+
+  // Sheds the streams of sellers past their share of the server before any
+  // chunk is read, as GetBids does.
+  absl::StatusOr<AdmissionTicket> admission_ticket =
+      FairAdmissionController::Get().Admit(
+          raw_request_.seller(), absl::FromChrono(context_->deadline()));
+  if (!admission_ticket.ok()) {
+    PS_VLOG(kNoisyWarn, *log_context_)
+        << "Request rejected by admission control: "
+        << admission_ticket.status();
+    FailStream(server_common::FromAbslStatus(admission_ticket.status()));
+    return false;
+  }
+  admission_ticket_ = *std::move(admission_ticket);
+
+  // The request may carry the first of the interest groups itself.
+  if (raw_request_.buyer_input().interest_groups_size() > 0) {
+    BuyerInput buyer_input;
+    buyer_input.mutable_interest_groups()->Swap(
+        raw_request_.mutable_buyer_input()->mutable_interest_groups());
+    BidOnInterestGroups(std::move(buyer_input));
+  }
+  return true;
+}
+
+grpc::Status GetBidsStreamReactor::DecryptRequest(
+    const GetBidsRequest& request) {
+  if (request.key_id().empty()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, kEmptyKeyIdError};
+  }
+  if (request.request_ciphertext().empty()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, kEmptyCiphertextError};
+  }
+  std::optional<server_common::PrivateKey> private_key =
+      key_fetcher_manager_->GetPrivateKey(request.key_id());
+  if (!private_key.has_value()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, kInvalidKeyIdError};
+  }
+  absl::StatusOr<HpkeDecryptResponse> decrypt_response =
+      crypto_client_->HpkeDecrypt(*private_key, request.request_ciphertext());
+  if (!decrypt_response.ok()) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, kMalformedCiphertext};
+  }
+  hpke_secret_ = std::move(*decrypt_response->mutable_secret());
+  if (!raw_request_.ParseFromString(decrypt_response->payload())) {
+    return {grpc::StatusCode::INVALID_ARGUMENT, kMalformedCiphertext};
+  }
+  return grpc::Status::OK;
+}
+
+absl::StatusOr<BuyerInput> GetBidsStreamReactor::DecryptInterestGroups(
+    const std::string& ciphertext) {
+  PS_ASSIGN_OR_RETURN(AeadDecryptResponse decrypt_response,
+                      crypto_client_->AeadDecrypt(ciphertext, hpke_secret_));
+  BuyerInput buyer_input;
+  if (!buyer_input.ParseFromString(decrypt_response.payload())) {
+    return absl::InvalidArgumentError(kMalformedCiphertext);
+  }
+  return buyer_input;
+}
+
+void GetBidsStreamReactor::BidOnInterestGroups(BuyerInput buyer_input) {
+  // The interest groups over the max are dropped as they arrive: the ones of
+  // the lowest priority within the chunk that crosses it, and then all of the
+  // next chunks.
+  if (const int max_interest_groups =
+          config_.max_interest_groups_per_get_bids_request;
+      max_interest_groups > 0) {
+    int num_dropped = buyer_input.interest_groups_size();
+    if (num_interest_groups_ < max_interest_groups) {
+      num_dropped = SelectInterestGroups(
+          max_interest_groups - num_interest_groups_,
+          config_.interest_group_priority, buyer_input);
+    } else {
+      buyer_input.clear_interest_groups();
+    }
+    if (num_dropped > 0) {
+      PS_VLOG(kNoisyInfo, *log_context_)
+          << "Dropped " << num_dropped << " interest groups over the max of "
+          << max_interest_groups;
+    }
+  }
+  if (buyer_input.interest_groups().empty()) {
+    return;
+  }
+  num_interest_groups_ += buyer_input.interest_groups_size();
+
+  // Each chunk is looked up as a request of its own, which holds its interest
+  // groups until they are moved to the bidding requests.
+  auto chunk_request =
+      std::make_shared<GetBidsRequest::GetBidsRawRequest>(raw_request_);
+  chunk_request->mutable_buyer_input()->mutable_interest_groups()->Swap(
+      buyer_input.mutable_interest_groups());
+  {
+    absl::MutexLock lock(&mu_);
+    ++num_pending_tasks_;
+  }
+  BiddingSignalsRequest bidding_signals_request(*chunk_request, kv_metadata_);
+  bidding_signals_request.cancellation_ = cancellation_;
+  bidding_signals_async_provider_->Get(
+      bidding_signals_request,
+      [this, chunk_request](
+          absl::StatusOr<std::unique_ptr<BiddingSignals>> response,
+          GetByteSize get_byte_size) mutable {
+        if (!response.ok()) {
+          PS_LOG(ERROR, *log_context_)
+              << "GetBiddingSignals request failed with status:"
+              << response.status();
+          OnTaskDone(response.status());
+          return;
+        }
+        GenerateBids(std::move(chunk_request), *std::move(response));
+      },
+      absl::Milliseconds(config_.bidding_signals_load_timeout_ms));
+}
+
+void GetBidsStreamReactor::GenerateBids(
+    std::shared_ptr<GetBidsRequest::GetBidsRawRequest> chunk_request,
+    std::unique_ptr<BiddingSignals> bidding_signals) {
+  if (!bidding_signals || !bidding_signals->trusted_signals ||
+      bidding_signals->trusted_signals->empty()) {
+    PS_LOG(ERROR, *log_context_)
+        << "GetBiddingSignals request succeeded but was empty.";
+    OnTaskDone(
+        std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>());
+    return;
+  }
+  std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+      raw_bidding_inputs = SplitGenerateBidsRawRequest(
+          CreateGenerateBidsRawRequest(
+              *chunk_request,
+              std::move(*chunk_request->mutable_buyer_input()),
+              std::move(bidding_signals), chunk_request->log_context()),
+          config_.max_interest_groups_per_generate_bids_request);
+  {
+    // The task of the lookup carries over to the first of the bidding calls.
+    absl::MutexLock lock(&mu_);
+    num_pending_tasks_ += static_cast<int>(raw_bidding_inputs.size()) - 1;
+  }
+  for (auto& raw_bidding_input : raw_bidding_inputs) {
+    // Split requests only hold the signals of their interest groups already.
+    if (config_.prune_trusted_bidding_signals &&
+        raw_bidding_inputs.size() == 1) {
+      if (absl::Status status = PruneBiddingSignals(*raw_bidding_input);
+          !status.ok()) {
+        PS_LOG(ERROR, *log_context_)
+            << "Failed to prune trusted bidding signals: " << status;
+      }
+    }
+    if (config_.send_interest_group_columns) {
+      EncodeInterestGroupColumns(*raw_bidding_input);
+    }
+    absl::Status execute_result = bidding_async_client_->ExecuteInternal(
+        std::move(raw_bidding_input), bidding_metadata_,
+        [this](absl::StatusOr<std::unique_ptr<
+                   GenerateBidsResponse::GenerateBidsRawResponse>>
+                   raw_response) {
+          if (!raw_response.ok()) {
+            PS_LOG(ERROR, *log_context_)
+                << "Execution of GenerateBids request failed with status: "
+                << raw_response.status();
+          }
+          OnTaskDone(std::move(raw_response));
+        },
+        absl::Milliseconds(config_.generate_bid_timeout_ms), cancellation_);
+    if (!execute_result.ok()) {
+      PS_LOG(ERROR, *log_context_)
+          << "Failed to make async GenerateBids call: (error: "
+          << execute_result.ToString() << ")";
+      OnTaskDone(std::move(execute_result));
+    }
+  }
+}
+
+void GetBidsStreamReactor::OnTaskDone(
+    absl::StatusOr<
+        std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+        result) {
+  bool is_last_task;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!result.ok()) {
+      bid_errors_.push_back(result.status().ToString());
+    } else if (*result != nullptr) {
+      GenerateBidsResponse::GenerateBidsRawResponse& response = **result;
+      if (response.has_debug_info()) {
+        server_common::DebugInfo& downstream_debug_info =
+            *raw_response_.mutable_debug_info()->add_downstream_servers();
+        downstream_debug_info = std::move(*response.mutable_debug_info());
+        downstream_debug_info.set_server_name("bidding");
+      }
+      for (AdWithBid& bid : *response.mutable_bids()) {
+        *raw_response_.add_bids() = std::move(bid);
+        any_successful_bids_ = true;
+      }
+    }
+    --num_pending_tasks_;
+    is_last_task = IsLastTask();
+  }
+  if (is_last_task) {
+    FinishRequest();
+  }
+}
+
+void GetBidsStreamReactor::FailStream(grpc::Status status) {
+  bool is_last_task;
+  {
+    absl::MutexLock lock(&mu_);
+    if (stream_status_.ok()) {
+      stream_status_ = std::move(status);
+    }
+    reads_done_ = true;
+    is_last_task = IsLastTask();
+  }
+  // The outstanding work of the chunks read so far is of no use anymore.
+  cancellation_->Cancel();
+  if (is_last_task) {
+    FinishRequest();
+  }
+}
+
+bool GetBidsStreamReactor::IsLastTask() {
+  if (!reads_done_ || num_pending_tasks_ > 0 || finishing_) {
+    return false;
+  }
+  finishing_ = true;
+  return true;
+}
+
+void GetBidsStreamReactor::FinishRequest() {
+  grpc::Status status;
+  {
+    absl::MutexLock lock(&mu_);
+    status = CompleteResponse();
+  }
+  Finish(status);
+}
+
+grpc::Status GetBidsStreamReactor::CompleteResponse() {
+  if (!stream_status_.ok()) {
+    return stream_status_;
+  }
+  if (context_->IsCancelled()) {
+    return grpc::Status(grpc::ABORTED, kRequestCancelled);
+  }
+  if (num_interest_groups_ == 0) {
+    PS_LOG(ERROR, *log_context_) << "No interest groups found in the stream";
+    return grpc::Status(grpc::INVALID_ARGUMENT, kMissingInputs);
+  }
+  if (!any_successful_bids_ && !bid_errors_.empty()) {
+    PS_LOG(WARNING, *log_context_)
+        << "Finishing the GetBidsStream RPC with an error, since there are "
+           "no successful bids returned by the bidding service";
+    return grpc::Status(grpc::INTERNAL, absl::StrJoin(bid_errors_, "; "));
+  }
+
+  if (const int num_truncated_bids =
+          KeepTopBids(config_.max_bids_per_get_bids_response,
+                      *raw_response_.mutable_bids());
+      num_truncated_bids > 0) {
+    PS_VLOG(kNoisyWarn, *log_context_)
+        << "Dropped " << num_truncated_bids
+        << " bids exceeding the bid budget of the response";
+  }
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
+      aead_encrypt = crypto_client_->AeadEncrypt(
+          raw_response_.SerializeAsString(), hpke_secret_);
+  if (!aead_encrypt.ok()) {
+    PS_LOG(ERROR, *log_context_) << "Failed to encrypt the response";
+    return grpc::Status(grpc::StatusCode::INTERNAL,
+                        aead_encrypt.status().ToString());
+  }
+  get_bids_response_->set_response_ciphertext(std::move(
+      *aead_encrypt->mutable_encrypted_data()->mutable_ciphertext()));
+  return grpc::Status::OK;
+}
+
+absl::btree_map<std::string, std::string>
+GetBidsStreamReactor::GetLoggingContext() {
+  const auto& log_context = raw_request_.log_context();
+  return {{kGenerationId, log_context.generation_id()},
+          {kBuyerDebugId, log_context.adtech_debug_id()}};
+}
+
+void GetBidsStreamReactor::OnDone() { delete this; }
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,150 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_STREAM_REACTOR_H_
+#define SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_STREAM_REACTOR_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/synchronization/mutex.h"
+#include "api/bidding_auction_servers.grpc.pb.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "services/buyer_frontend_service/data/get_bids_config.h"
+#include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/common/clients/bidding_server/bidding_async_client.h"
+#include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/util/fair_admission_controller.h"
+#include "services/common/util/request_cancellation.h"
+#include "services/common/util/request_metadata.h"
+#include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
+#include "src/logger/request_context_impl.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Serves a GetBidsStream call: the first message of the stream is the
+// GetBidsRequest, and each of the next ones carries a chunk of the interest
+// groups, encrypted under the HPKE context of the request. The bidding
+// signals of a chunk are looked up, and its bids generated, as soon as the
+// chunk is read, so that the transfer and decryption of the next chunks
+// overlap with the processing of the previous ones. The bids of all chunks
+// are returned in a single response once the stream is closed and the last
+// chunk is done.
+//
+// Only the interest groups of the request are streamed: the request is
+// rejected if it has protected app signals, which SFE sends over GetBids.
+class GetBidsStreamReactor
+    : public grpc::ServerReadReactor<GetBidsStreamChunk> {
+ public:
+  GetBidsStreamReactor(
+      grpc::CallbackServerContext& context, GetBidsResponse& get_bids_response,
+      const BiddingSignalsAsyncProvider& bidding_signals_async_provider,
+      const BiddingAsyncClient& bidding_async_client,
+      const GetBidsConfig& config,
+      server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+      CryptoClientWrapperInterface* crypto_client);
+
+  // GetBidsStreamReactor is neither copyable nor movable.
+  GetBidsStreamReactor(const GetBidsStreamReactor&) = delete;
+  GetBidsStreamReactor& operator=(const GetBidsStreamReactor&) = delete;
+
+  // Starts reading the stream.
+  void Execute();
+
+  void OnReadDone(bool ok) override;
+  // Cancels the outstanding KV lookups and bidding calls, which then complete
+  // with errors, so that the reactor finishes without waiting on them.
+  void OnCancel() override { cancellation_->Cancel(); }
+  // Deletes the reactor once the call is done.
+  void OnDone() override;
+
+ private:
+  // Decrypts the request of the first message into raw_request_.
+  grpc::Status DecryptRequest(const GetBidsRequest& request);
+  // Decrypts the interest groups of a chunk.
+  absl::StatusOr<BuyerInput> DecryptInterestGroups(
+      const std::string& ciphertext);
+  // Handles the first message of the stream. Returns false if the call is
+  // to be finished without reading the chunks.
+  bool StartRequest();
+  // Looks up the bidding signals of the interest groups of a chunk, and
+  // then generates their bids.
+  void BidOnInterestGroups(BuyerInput buyer_input);
+  void GenerateBids(
+      std::shared_ptr<GetBidsRequest::GetBidsRawRequest> chunk_request,
+      std::unique_ptr<BiddingSignals> bidding_signals);
+  // Called once each KV lookup or bidding call is done, with its bids or
+  // error, if any.
+  void OnTaskDone(
+      absl::StatusOr<
+          std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+          result) ABSL_LOCKS_EXCLUDED(mu_);
+  // Stops reading the stream, and finishes the call with `status` once the
+  // outstanding work is done.
+  void FailStream(grpc::Status status) ABSL_LOCKS_EXCLUDED(mu_);
+  // Whether the stream is read and all of its chunks are done, the first
+  // time it is.
+  bool IsLastTask() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FinishRequest() ABSL_LOCKS_EXCLUDED(mu_);
+  // Encrypts the bids of all chunks into the response, and returns the status
+  // to finish the call with.
+  grpc::Status CompleteResponse() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  absl::btree_map<std::string, std::string> GetLoggingContext();
+
+  grpc::CallbackServerContext* context_;
+  GetBidsResponse* get_bids_response_;
+  const BiddingSignalsAsyncProvider* bidding_signals_async_provider_;
+  const BiddingAsyncClient* bidding_async_client_;
+  const GetBidsConfig& config_;
+  server_common::KeyFetcherManagerInterface* key_fetcher_manager_;
+  CryptoClientWrapperInterface* crypto_client_;
+  RequestMetadata kv_metadata_;
+  RequestMetadata bidding_metadata_;
+  std::shared_ptr<RequestCancellation> cancellation_ =
+      std::make_shared<RequestCancellation>();
+
+  // Message being read.
+  GetBidsStreamChunk chunk_;
+  bool is_first_message_ = true;
+  // The request, without its interest groups once they are bid on. Set by
+  // the first message, and then only read.
+  GetBidsRequest::GetBidsRawRequest raw_request_;
+  std::string hpke_secret_;
+  std::optional<server_common::log::ContextImpl> log_context_;
+  AdmissionTicket admission_ticket_;
+  // Interest groups bid on so far, capped by
+  // max_interest_groups_per_get_bids_request.
+  int num_interest_groups_ = 0;
+
+  absl::Mutex mu_;
+  // KV lookups and bidding calls not done yet.
+  int num_pending_tasks_ ABSL_GUARDED_BY(mu_) = 0;
+  bool reads_done_ ABSL_GUARDED_BY(mu_) = false;
+  bool finishing_ ABSL_GUARDED_BY(mu_) = false;
+  grpc::Status stream_status_ ABSL_GUARDED_BY(mu_);
+  bool any_successful_bids_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::string> bid_errors_ ABSL_GUARDED_BY(mu_);
+  // Written under mu_ as the bidding calls are done, and read once all are.
+  GetBidsResponse::GetBidsRawResponse raw_response_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_STREAM_REACTOR_H_
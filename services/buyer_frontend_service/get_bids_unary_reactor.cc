@@ -14,6 +14,10 @@
 
 #include "services/buyer_frontend_service/get_bids_unary_reactor.h"
 
+#include <algorithm>
+
+#include <google/protobuf/util/json_util.h>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
@@ -21,8 +25,12 @@
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/loggers/build_input_process_response_benchmarking_logger.h"
 #include "services/common/loggers/no_ops_logger.h"
+#include "services/common/util/bid_budget.h"
+#include "services/common/util/interest_group_columns.h"
+#include "services/common/util/request_capture.h"
 #include "services/common/util/request_metadata.h"
 #include "services/common/util/request_response_constants.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -75,6 +83,19 @@ void HandleSingleBidCompletion(
   std::move(on_successful_response)(std::move(response));
 }
 
+// Moves the debug info of the downstream servers from `from` to `to`.
+void MoveDownstreamDebugInfo(GetBidsResponse::GetBidsRawResponse& from,
+                             GetBidsResponse::GetBidsRawResponse& to) {
+  if (!from.has_debug_info()) {
+    return;
+  }
+  for (server_common::DebugInfo& downstream_debug_info :
+       *from.mutable_debug_info()->mutable_downstream_servers()) {
+    *to.mutable_debug_info()->add_downstream_servers() =
+        std::move(downstream_debug_info);
+  }
+}
+
 }  // namespace
 
 GetBidsUnaryReactor::GetBidsUnaryReactor(
@@ -87,6 +108,8 @@ GetBidsUnaryReactor::GetBidsUnaryReactor(
     CryptoClientWrapperInterface* crypto_client, bool enable_benchmarking)
     : context_(&context),
       request_(&get_bids_request),
+      raw_request_(CreateMessageOnArenaOf<GetBidsRequest::GetBidsRawRequest>(
+          get_bids_request, owned_raw_request_)),
       get_bids_response_(&get_bids_response),
       get_bids_raw_response_(
           std::make_unique<GetBidsResponse::GetBidsRawResponse>()),
@@ -107,10 +130,16 @@ GetBidsUnaryReactor::GetBidsUnaryReactor(
             GetLoggingContext(), raw_request_.consented_debug_config(),
             [this]() { return get_bids_raw_response_->mutable_debug_info(); });
       }()),
+      debug_log_(log_context_, raw_request_.consented_debug_config()
+                                   .is_debug_info_in_response()),
       async_task_tracker_(kNumDefaultOutboundBiddingCalls, log_context_,
                           [this](bool any_successful_bid) {
                             OnAllBidsDone(any_successful_bid);
-                          }) {
+                          }),
+      parallel_bids_tracker_(kNumDefaultOutboundBiddingCalls, log_context_,
+                             [this](bool any_successful_bid) {
+                               OnAllParallelBidsDone(any_successful_bid);
+                             }) {
   if (enable_benchmarking) {
     std::string request_id = FormatTime(absl::Now());
     benchmarking_logger_ =
@@ -119,14 +148,11 @@ GetBidsUnaryReactor::GetBidsUnaryReactor(
   } else {
     benchmarking_logger_ = std::make_unique<NoOpsLogger>();
   }
-  CHECK_OK([this]() {
-    PS_ASSIGN_OR_RETURN(metric_context_,
-                        metric::BfeContextMap()->Remove(request_));
-    if (log_context_.is_consented()) {
-      metric_context_->SetConsented(raw_request_.log_context().generation_id());
-    }
-    return absl::OkStatus();
-  }()) << "BfeContextMap()->Get(request) should have been called";
+  metric_context_ = metric::CreateMetricContext<GetBidsRequest>();
+  LogCommonMetric(request_, get_bids_response_, *metric_context_);
+  if (log_context_.is_consented()) {
+    metric_context_->SetConsented(raw_request_.log_context().generation_id());
+  }
 
   DCHECK(!config_.is_protected_app_signals_enabled ||
          protected_app_signals_bidding_async_client_ != nullptr)
@@ -153,8 +179,9 @@ void GetBidsUnaryReactor::OnAllBidsDone(bool any_successful_bids) {
     return;
   }
 
-  PS_VLOG(kPlain, log_context_) << "GetBidsRawResponse:\n"
-                                << get_bids_raw_response_->ShortDebugString();
+  KeepTopBidsWithinBudget();
+  debug_log_.AddMessage(kPlain, "GetBidsRawResponse:\n",
+                        *get_bids_raw_response_);
 
   if (auto encryption_status = EncryptResponse(); !encryption_status.ok()) {
     PS_LOG(ERROR, log_context_) << "Failed to encrypt the response";
@@ -164,8 +191,8 @@ void GetBidsUnaryReactor::OnAllBidsDone(bool any_successful_bids) {
     return;
   }
 
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted GetBidsResponse:\n"
-                                    << get_bids_response_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted GetBidsResponse:\n",
+                        *get_bids_response_);
 
   if (!any_successful_bids) {
     PS_LOG(WARNING, log_context_)
@@ -182,6 +209,7 @@ void GetBidsUnaryReactor::OnAllBidsDone(bool any_successful_bids) {
 }
 
 grpc::Status GetBidsUnaryReactor::DecryptRequest() {
+  ScopedRequestPhase decrypt_phase(phase_tracer_, RequestPhase::kDecrypt);
   if (request_->key_id().empty()) {
     return {grpc::StatusCode::INVALID_ARGUMENT, kEmptyKeyIdError};
   }
@@ -222,8 +250,7 @@ int GetBidsUnaryReactor::GetNumberOfBiddingCalls() {
 
 void GetBidsUnaryReactor::Execute() {
   benchmarking_logger_->Begin();
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted GetBidsRequest:\n"
-                                    << request_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted GetBidsRequest:\n", *request_);
   PS_VLOG(kPlain, log_context_)
       << "Headers:\n"
       << absl::StrJoin(context_->client_metadata(), "\n",
@@ -237,8 +264,38 @@ void GetBidsUnaryReactor::Execute() {
     return;
   }
   PS_VLOG(5, log_context_) << "Successfully decrypted the request";
-  PS_VLOG(kPlain, log_context_) << "GetBidsRawRequest:\n"
-                                << raw_request_.ShortDebugString();
+  debug_log_.AddMessage(kPlain, "GetBidsRawRequest:\n", raw_request_);
+  if (log_context_.is_consented() && RequestCapture::Get().enabled()) {
+    std::string capture_json;
+    if (auto status = google::protobuf::util::MessageToJsonString(
+            raw_request_, &capture_json);
+        status.ok()) {
+      RequestCapture::Get().Capture(kGetBidsCaptureKind, capture_json);
+    } else {
+      PS_LOG(ERROR, log_context_)
+          << "Failed to capture the request: " << status;
+    }
+  }
+  trace_.Start("GetBids", raw_request_.log_context().generation_id(),
+               RequestTrace::GetTraceParent(context_->client_metadata()));
+  phase_tracer_.set_listener(&trace_);
+  trace_.Inject(bidding_metadata_);
+
+  // Sheds the requests of sellers past their share of the server, or without
+  // enough time left, before any work is started for them. SFE counts the
+  // buyer as having no bids.
+  absl::StatusOr<AdmissionTicket> admission_ticket =
+      FairAdmissionController::Get().Admit(
+          raw_request_.seller(), absl::FromChrono(context_->deadline()));
+  if (!admission_ticket.ok()) {
+    PS_VLOG(kNoisyWarn, log_context_)
+        << "Request rejected by admission control: "
+        << admission_ticket.status();
+    benchmarking_logger_->End();
+    FinishWithStatus(server_common::FromAbslStatus(admission_ticket.status()));
+    return;
+  }
+  admission_ticket_ = *std::move(admission_ticket);
 
   const int num_bidding_calls = GetNumberOfBiddingCalls();
   if (num_bidding_calls == 0) {
@@ -333,7 +390,8 @@ void GetBidsUnaryReactor::MayGetProtectedSignalsBids() {
                 *get_bids_raw_response_);
           },
           absl::Milliseconds(
-              config_.protected_app_signals_generate_bid_timeout_ms));
+              config_.protected_app_signals_generate_bid_timeout_ms),
+          cancellation_);
   if (!execute_result.ok()) {
     LogIfError(
         metric_context_->AccumulateMetric<metric::kBfeErrorCountByErrorCode>(
@@ -361,16 +419,31 @@ void GetBidsUnaryReactor::MayGetProtectedAudienceBids() {
     return;
   }
 
+  // Drops the interest groups of the lowest priority before any of their
+  // bidding signals are fetched, or their bids generated.
+  if (const int num_dropped = SelectInterestGroups(
+          config_.max_interest_groups_per_get_bids_request,
+          config_.interest_group_priority, *raw_request_.mutable_buyer_input());
+      num_dropped > 0) {
+    PS_VLOG(kNoisyInfo, log_context_)
+        << "Dropped " << num_dropped << " interest groups over the max of "
+        << config_.max_interest_groups_per_get_bids_request;
+  }
+
   BiddingSignalsRequest bidding_signals_request(raw_request_, kv_metadata_);
+  bidding_signals_request.cancellation_ = cancellation_;
   auto kv_request =
       metric::MakeInitiatedRequest(metric::kKv, metric_context_.get());
 
   // Get Bidding Signals.
+  phase_tracer_.Start(RequestPhase::kKvLookup);
+  trace_.Inject(RequestPhase::kKvLookup, kv_metadata_);
   bidding_signals_async_provider_->Get(
       bidding_signals_request,
       [this, kv_request = std::move(kv_request)](
           absl::StatusOr<std::unique_ptr<BiddingSignals>> response,
           GetByteSize get_byte_size) mutable {
+        phase_tracer_.End(RequestPhase::kKvLookup);
         {
           // Only logs KV request and response sizes if fetching signals
           // succeeds.
@@ -414,22 +487,57 @@ void GetBidsUnaryReactor::PrepareAndGenerateProtectedAudienceBid(
     return;
   }
   const auto& log_context = raw_request_.log_context();
+  // The interest groups are not read again once in the bidding request.
   std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
-      raw_bidding_input =
-          CreateGenerateBidsRawRequest(raw_request_, raw_request_.buyer_input(),
-                                       std::move(bidding_signals), log_context);
-
-  PS_VLOG(kOriginated, log_context_) << "GenerateBidsRequest:\n"
-                                     << raw_bidding_input->ShortDebugString();
+      raw_bidding_input = CreateGenerateBidsRawRequest(
+          raw_request_, std::move(*raw_request_.mutable_buyer_input()),
+          std::move(bidding_signals), log_context);
+
+  debug_log_.AddMessage(kOriginated, "GenerateBidsRequest:\n",
+                        *raw_bidding_input);
+  // The number of requests is bounded by the tasks the tracker can track,
+  // whatever the number of interest groups in the request.
+  int max_interest_groups_per_request =
+      config_.max_interest_groups_per_generate_bids_request;
+  if (max_interest_groups_per_request > 0) {
+    const int num_interest_groups =
+        raw_bidding_input->interest_group_for_bidding_size();
+    max_interest_groups_per_request = std::max(
+        max_interest_groups_per_request,
+        (num_interest_groups + AsyncTaskTracker::kMaxTasksToTrack - 1) /
+            AsyncTaskTracker::kMaxTasksToTrack);
+  }
+  std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+      raw_bidding_inputs = SplitGenerateBidsRawRequest(
+          std::move(raw_bidding_input), max_interest_groups_per_request);
+  if (raw_bidding_inputs.size() > 1) {
+    GenerateProtectedAudienceBidsInParallel(std::move(raw_bidding_inputs));
+    return;
+  }
+  raw_bidding_input = std::move(raw_bidding_inputs[0]);
+  if (config_.prune_trusted_bidding_signals) {
+    if (absl::Status status = PruneBiddingSignals(*raw_bidding_input);
+        !status.ok()) {
+      PS_LOG(ERROR, log_context_)
+          << "Failed to prune trusted bidding signals: " << status;
+    }
+  }
+  if (config_.send_interest_group_columns) {
+    EncodeInterestGroupColumns(*raw_bidding_input);
+  }
   auto bidding_request =
       metric::MakeInitiatedRequest(metric::kBs, metric_context_.get());
   bidding_request->SetRequestSize((int)raw_bidding_input->ByteSizeLong());
+  phase_tracer_.Start(RequestPhase::kFanOut);
+  RequestMetadata bidding_metadata;
+  trace_.Inject(RequestPhase::kFanOut, bidding_metadata);
   absl::Status execute_result = bidding_async_client_->ExecuteInternal(
-      std::move(raw_bidding_input), {},
+      std::move(raw_bidding_input), bidding_metadata,
       [this, bidding_request = std::move(bidding_request)](
           absl::StatusOr<
               std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
               raw_response) mutable {
+        phase_tracer_.End(RequestPhase::kFanOut);
         {
           int response_size =
               raw_response.ok() ? (int)raw_response->get()->ByteSizeLong() : 0;
@@ -470,7 +578,7 @@ void GetBidsUnaryReactor::PrepareAndGenerateProtectedAudienceBid(
             },
             *get_bids_raw_response_);
       },
-      absl::Milliseconds(config_.generate_bid_timeout_ms));
+      absl::Milliseconds(config_.generate_bid_timeout_ms), cancellation_);
   if (!execute_result.ok()) {
     LogIfError(
         metric_context_->AccumulateMetric<metric::kBfeErrorCountByErrorCode>(
@@ -485,13 +593,138 @@ void GetBidsUnaryReactor::PrepareAndGenerateProtectedAudienceBid(
   }
 }
 
+void GetBidsUnaryReactor::GenerateProtectedAudienceBidsInParallel(
+    std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+        raw_bidding_inputs) {
+  PS_VLOG(kStats, log_context_)
+      << "Splitting interest groups into " << raw_bidding_inputs.size()
+      << " GenerateBids requests";
+  parallel_bids_tracker_.SetNumTasksToTrack(raw_bidding_inputs.size());
+  // The fan-out ends once the last of the requests is done.
+  phase_tracer_.Start(RequestPhase::kFanOut);
+  RequestMetadata bidding_metadata;
+  trace_.Inject(RequestPhase::kFanOut, bidding_metadata);
+  for (auto& raw_bidding_input : raw_bidding_inputs) {
+    if (config_.send_interest_group_columns) {
+      EncodeInterestGroupColumns(*raw_bidding_input);
+    }
+    auto bidding_request =
+        metric::MakeInitiatedRequest(metric::kBs, metric_context_.get());
+    bidding_request->SetRequestSize((int)raw_bidding_input->ByteSizeLong());
+    absl::Status execute_result = bidding_async_client_->ExecuteInternal(
+        std::move(raw_bidding_input), bidding_metadata,
+        [this, bidding_request = std::move(bidding_request)](
+            absl::StatusOr<
+                std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+                raw_response) mutable {
+          {
+            int response_size =
+                raw_response.ok() ? (int)raw_response->get()->ByteSizeLong()
+                                  : 0;
+            bidding_request->SetResponseSize(response_size);
+            // destruct bidding_request, destructor measures request time
+            auto not_used = std::move(bidding_request);
+          }
+          // Collects the debug info of this request, which is merged with the
+          // others by parallel_bids_tracker_.
+          GetBidsResponse::GetBidsRawResponse single_response;
+          HandleSingleBidCompletion<
+              GenerateBidsResponse::GenerateBidsRawResponse>(
+              std::move(raw_response),
+              // Error response handler
+              [this](const absl::Status& status) {
+                LogIfError(
+                    metric_context_
+                        ->AccumulateMetric<metric::kBfeErrorCountByErrorCode>(
+                            1, metric::kBfeGenerateBidsResponseError));
+                LogInitiatedRequestErrorMetrics(metric::kBs, status);
+                PS_LOG(ERROR, log_context_)
+                    << "Execution of GenerateBids request failed with status: "
+                    << status;
+                parallel_bids_tracker_.TaskCompleted(
+                    TaskStatus::ERROR, [this, &status]() {
+                      parallel_bid_errors_.push_back(status.ToString());
+                    });
+              },
+              // Empty response handler
+              [this, &single_response]() {
+                parallel_bids_tracker_.TaskCompleted(
+                    TaskStatus::EMPTY_RESPONSE, [this, &single_response]() {
+                      MoveDownstreamDebugInfo(single_response,
+                                              parallel_bids_response_);
+                    });
+              },
+              // Successful response handler
+              [this, &single_response](auto response) {
+                parallel_bids_tracker_.TaskCompleted(
+                    TaskStatus::SUCCESS,
+                    [this, &single_response, response = std::move(response)]() {
+                      for (AdWithBid& bid : *response->mutable_bids()) {
+                        *parallel_bids_response_.add_bids() = std::move(bid);
+                      }
+                      MoveDownstreamDebugInfo(single_response,
+                                              parallel_bids_response_);
+                    });
+              },
+              single_response);
+        },
+        absl::Milliseconds(config_.generate_bid_timeout_ms), cancellation_);
+    if (!execute_result.ok()) {
+      LogIfError(
+          metric_context_->AccumulateMetric<metric::kBfeErrorCountByErrorCode>(
+              1, metric::kBfeGenerateBidsFailedToCall));
+      PS_LOG(ERROR, log_context_)
+          << "Failed to make async GenerateBids call: (error: "
+          << execute_result.ToString() << ")";
+      parallel_bids_tracker_.TaskCompleted(
+          TaskStatus::ERROR, [this, &execute_result]() {
+            parallel_bid_errors_.push_back(execute_result.ToString());
+          });
+    }
+  }
+}
+
+void GetBidsUnaryReactor::OnAllParallelBidsDone(bool any_successful_bids) {
+  phase_tracer_.End(RequestPhase::kFanOut);
+  async_task_tracker_.TaskCompleted(
+      any_successful_bids ? TaskStatus::SUCCESS : TaskStatus::ERROR, [this]() {
+        get_bids_raw_response_->mutable_bids()->Swap(
+            parallel_bids_response_.mutable_bids());
+        MoveDownstreamDebugInfo(parallel_bids_response_,
+                                *get_bids_raw_response_);
+        for (std::string& error : parallel_bid_errors_) {
+          bid_errors_.push_back(std::move(error));
+        }
+      });
+}
+
+void GetBidsUnaryReactor::KeepTopBidsWithinBudget() {
+  const int max_bids = config_.max_bids_per_get_bids_response;
+  GetBidsResponse::GetBidsRawResponse& raw_response = *get_bids_raw_response_;
+  const int num_truncated_bids =
+      KeepTopBids(max_bids, *raw_response.mutable_bids()) +
+      KeepTopBids(max_bids, *raw_response.mutable_protected_app_signals_bids());
+  if (num_truncated_bids > 0) {
+    PS_VLOG(kNoisyWarn, log_context_)
+        << "Dropped " << num_truncated_bids
+        << " bids exceeding the bid budget of the response";
+    LogIfError(
+        metric_context_->LogUpDownCounter<metric::kBfeTruncatedBidsCount>(
+            num_truncated_bids));
+  }
+}
+
 absl::Status GetBidsUnaryReactor::EncryptResponse() {
+  ScopedRequestPhase encrypt_phase(phase_tracer_, RequestPhase::kEncrypt);
   std::string payload = get_bids_raw_response_->SerializeAsString();
   PS_ASSIGN_OR_RETURN(auto aead_encrypt,
                       crypto_client_->AeadEncrypt(payload, hpke_secret_));
 
   get_bids_response_->set_response_ciphertext(
-      aead_encrypt.encrypted_data().ciphertext());
+      std::move(*aead_encrypt.mutable_encrypted_data()->mutable_ciphertext()));
+  if (raw_call_ != nullptr) {
+    raw_call_->SetResponse();
+  }
   return absl::OkStatus();
 }
 
@@ -506,11 +739,20 @@ void GetBidsUnaryReactor::FinishWithStatus(const grpc::Status& status) {
   if (status.error_code() != grpc::StatusCode::OK) {
     metric_context_->SetRequestResult(server_common::ToAbslStatus(status));
   }
+  metric::LogRequestPhases(phase_tracer_, *metric_context_);
+  trace_.End(status);
 
+  if (on_finish_) {
+    std::move(on_finish_)(status);
+    return;
+  }
   Finish(status);
 }
 
 // Deletes all data related to this object.
-void GetBidsUnaryReactor::OnDone() { delete this; }
+void GetBidsUnaryReactor::OnDone() {
+  debug_log_.Flush();
+  delete this;
+}
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -35,8 +35,16 @@
 #include "services/common/clients/bidding_server/bidding_async_client.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 #include "services/common/loggers/benchmarking_logger.h"
+#include "services/common/loggers/deferred_debug_log.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/arena_message_allocator.h"
 #include "services/common/util/async_task_tracker.h"
+#include "services/common/util/fair_admission_controller.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/raw_ciphertext_call.h"
+#include "services/common/util/request_cancellation.h"
+#include "services/common/util/request_phase_tracer.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 #include "src/logger/request_context_impl.h"
 
@@ -87,12 +95,31 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
 
   // Starts the execution the request.
   void Execute();
+  // Holds the memory reserved for the request until the reactor is done.
+  void HoldMemoryReservation(MemoryReservation memory_reservation) {
+    memory_reservation_ = std::move(memory_reservation);
+  }
+  // Serves the call over the raw messages of `raw_call`, which the reactor
+  // was created with the request and the response of, so that the response
+  // ciphertext is sent without being copied.
+  void ServeRawCall(
+      std::shared_ptr<RawCiphertextCall<GetBidsRequest, GetBidsResponse>>
+          raw_call) {
+    raw_call_ = std::move(raw_call);
+  }
+  // Serves the request as one of the requests of a GetBidsBatch call:
+  // `on_finish` gets the status of the request, instead of it finishing the
+  // RPC, and the owner of the reactor calls OnDone once the RPC is done.
+  void SetOnFinish(
+      absl::AnyInvocable<void(const grpc::Status&) &&> on_finish) {
+    on_finish_ = std::move(on_finish);
+  }
   // Runs once the request has finished execution and deletes current instance.
   void OnDone() override;
-  // Runs if the request is cancelled in the middle of execution.
-  void OnCancel() override {
-    // TODO(b/249183477): Figure out how to cancel request
-  }
+  // Runs if the request is cancelled in the middle of execution. Cancels the
+  // outstanding KV lookups and bidding calls, which then complete with
+  // errors, so that the reactor finishes without waiting on them.
+  void OnCancel() override { cancellation_->Cancel(); }
 
  private:
   // Process Outputs from Actions to prepare bidding request.
@@ -100,10 +127,25 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   void PrepareAndGenerateProtectedAudienceBid(
       std::unique_ptr<BiddingSignals> bidding_signals);
 
+  // Sends the generate bids requests that the interest groups were split into
+  // in parallel, completing a single task of async_task_tracker_ once all of
+  // them are done.
+  void GenerateProtectedAudienceBidsInParallel(
+      std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+          raw_bidding_inputs);
+
+  // Merges the results of the parallel generate bids requests into the
+  // response once all of them are done.
+  void OnAllParallelBidsDone(bool any_successful_bids);
+
   // Decrypts the request ciphertext in and returns whether decryption was
   // successful. If successful, the result is written into 'raw_request_'.
   grpc::Status DecryptRequest();
 
+  // Drops the lowest bids of the response above the bid budget, before it is
+  // serialized.
+  void KeepTopBidsWithinBudget();
+
   // Encrypts `raw_response` and sets the result on the 'response_ciphertext'
   // field in the response. Returns ok status if encryption succeeded.
   absl::Status EncryptResponse();
@@ -123,7 +165,10 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   // https://github.com/grpc/grpc/blob/dbc45208e2bfe14f01b1cbb06d0cd7c01077debb/include/grpcpp/server_context.h#L604
   grpc::CallbackServerContext* context_;
   const GetBidsRequest* request_;
-  GetBidsRequest::GetBidsRawRequest raw_request_;
+  // Storage of the raw request if the client request is not on an arena.
+  // Otherwise it is on its arena and freed along with it.
+  std::unique_ptr<GetBidsRequest::GetBidsRawRequest> owned_raw_request_;
+  GetBidsRequest::GetBidsRawRequest& raw_request_;
 
   // Should be released by gRPC after call is finished
   GetBidsResponse* get_bids_response_;
@@ -135,6 +180,11 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   // Metadata to be sent to bidding service.
   RequestMetadata bidding_metadata_;
 
+  // Cancellation of the request by the client, shared with the outbound
+  // calls made for it.
+  std::shared_ptr<RequestCancellation> cancellation_ =
+      std::make_shared<RequestCancellation>();
+
   // Helper classes for performing preload actions.
   // These are not owned by this class.
   const BiddingSignalsAsyncProvider* bidding_signals_async_provider_;
@@ -149,8 +199,25 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   std::unique_ptr<BenchmarkingLogger> benchmarking_logger_;
   std::string hpke_secret_;
 
+  // Distributed trace of a sampled share of the requests. Initialized before
+  // the request is decrypted, so that it covers the decryption.
+  RequestTrace trace_;
+  // Times the phases of a sampled share of the requests. Initialized before
+  // the request is decrypted by the log context.
+  RequestPhaseTracer phase_tracer_;
+
   grpc::Status decrypt_status_;
   server_common::log::ContextImpl log_context_;
+  // Dumps of the protos of the request, formatted off the request thread.
+  DeferredDebugLog debug_log_;
+  MemoryReservation memory_reservation_;
+  // Slot of the request among the requests of its seller in flight.
+  AdmissionTicket admission_ticket_;
+  // Set if the request is part of a GetBidsBatch call.
+  absl::AnyInvocable<void(const grpc::Status&) &&> on_finish_;
+  // Set if the call is served over its raw messages, see ServeRawCall.
+  std::shared_ptr<RawCiphertextCall<GetBidsRequest, GetBidsResponse>>
+      raw_call_;
 
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::BfeContext> metric_context_;
@@ -163,6 +230,13 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   // Signals bid generation.
   std::vector<std::string> bid_errors_;
 
+  // Keeps track of the parallel generate bids requests of the interest groups.
+  AsyncTaskTracker parallel_bids_tracker_;
+  // Bids, debug info and errors of the parallel generate bids requests,
+  // updated when parallel_bids_tracker_ updates the state of pending requests.
+  GetBidsResponse::GetBidsRawResponse parallel_bids_response_;
+  std::vector<std::string> parallel_bid_errors_;
+
   // Logs GetBidsRawRequest if the consented debugging is enabled.
   void MayLogRawRequest();
 
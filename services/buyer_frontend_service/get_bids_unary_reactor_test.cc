@@ -14,10 +14,12 @@
 
 #include "services/buyer_frontend_service/get_bids_unary_reactor.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/notification.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
@@ -47,6 +49,7 @@ using ::testing::Eq;
 using ::testing::Pointee;
 using ::testing::Property;
 using ::testing::Return;
+using ::testing::UnorderedElementsAre;
 using GenerateProtectedAppSignalsBidsRawRequest =
     GenerateProtectedAppSignalsBidsRequest::
         GenerateProtectedAppSignalsBidsRawRequest;
@@ -128,8 +131,7 @@ class GetBidUnaryReactorTest : public ::testing::Test {
     server_common::telemetry::TelemetryConfig config_proto;
     config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
     metric::MetricContextMap<GetBidsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request_);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     get_bids_config_.is_protected_app_signals_enabled = false;
     get_bids_config_.is_protected_audience_enabled = true;
 
@@ -240,6 +242,34 @@ TEST_F(GetBidUnaryReactorTest,
   EXPECT_FALSE(response_.response_ciphertext().empty());
 }
 
+TEST_F(GetBidUnaryReactorTest, CancelsBiddingSignalsLookupOnCancel) {
+  std::shared_ptr<RequestCancellation> cancellation;
+  absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>,
+                          GetByteSize) &&>
+      on_bidding_signals;
+  EXPECT_CALL(bidding_signals_provider_, Get)
+      .WillOnce([&cancellation, &on_bidding_signals](
+                    const BiddingSignalsRequest& bidding_signals_request,
+                    auto on_done, absl::Duration timeout) {
+        cancellation = bidding_signals_request.cancellation_;
+        on_bidding_signals = std::move(on_done);
+      });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+  ASSERT_NE(cancellation, nullptr);
+  EXPECT_FALSE(cancellation->IsCancelled());
+
+  class_under_test.OnCancel();
+
+  EXPECT_TRUE(cancellation->IsCancelled());
+  std::move(on_bidding_signals)(absl::CancelledError(kRequestCancelledError),
+                                GetByteSize());
+}
+
 auto EqLogContext(const server_common::LogContext& log_context) {
   return AllOf(Property(&server_common::LogContext::generation_id,
                         Eq(log_context.generation_id())),
@@ -285,14 +315,144 @@ TEST_F(GetBidUnaryReactorTest, VerifyLogContextPropagates) {
   get_bids_unary_reactor.Execute();
 }
 
+TEST_F(GetBidUnaryReactorTest, SplitsInterestGroupsIntoParallelBiddingCalls) {
+  constexpr int kNumInterestGroups = 3;
+  raw_request_.mutable_buyer_input()->clear_interest_groups();
+  for (int i = 0; i < kNumInterestGroups; ++i) {
+    auto* interest_group =
+        raw_request_.mutable_buyer_input()->add_interest_groups();
+    interest_group->set_name(absl::StrCat("ig_name_", i));
+    interest_group->add_bidding_signals_keys("ig_name");
+  }
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+  get_bids_config_.max_interest_groups_per_generate_bids_request = 1;
+
+  SetupBiddingProviderMock(
+      /*provider=*/bidding_signals_provider_,
+      /*bidding_signals_value=*/bidding_signals_to_be_returned,
+      /*repeated_get_allowed=*/false,
+      /*server_error_to_return=*/std::nullopt);
+
+  absl::Notification notification;
+  int num_calls = 0;
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(kNumInterestGroups)
+      .WillRepeatedly(
+          [&notification, &num_calls](
+              std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                  raw_request,
+              const RequestMetadata& metadata, auto on_done,
+              absl::Duration timeout) {
+            EXPECT_EQ(raw_request->interest_group_for_bidding_size(), 1);
+            EXPECT_EQ(raw_request->bidding_signals(),
+                      R"JSON({"keys":{"ig_name":[123,456]}})JSON");
+            auto raw_response = std::make_unique<
+                GenerateBidsResponse::GenerateBidsRawResponse>();
+            raw_response->add_bids()->set_interest_group_name(
+                raw_request->interest_group_for_bidding(0).name());
+            std::move(on_done)(std::move(raw_response));
+            if (++num_calls == kNumInterestGroups) {
+              notification.Notify();
+            }
+            return absl::OkStatus();
+          });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+  notification.WaitForNotification();
+
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response_.response_ciphertext()));
+  EXPECT_EQ(raw_response.bids_size(), kNumInterestGroups);
+}
+
+TEST_F(GetBidUnaryReactorTest, KeepsHighestBidsWithinBudget) {
+  constexpr int kNumInterestGroups = 3;
+  raw_request_.mutable_buyer_input()->clear_interest_groups();
+  for (int i = 0; i < kNumInterestGroups; ++i) {
+    auto* interest_group =
+        raw_request_.mutable_buyer_input()->add_interest_groups();
+    interest_group->set_name(absl::StrCat("ig_name_", i));
+    interest_group->add_bidding_signals_keys("ig_name");
+  }
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+  get_bids_config_.max_interest_groups_per_generate_bids_request = 1;
+  get_bids_config_.max_bids_per_get_bids_response = 2;
+
+  SetupBiddingProviderMock(
+      /*provider=*/bidding_signals_provider_,
+      /*bidding_signals_value=*/bidding_signals_to_be_returned,
+      /*repeated_get_allowed=*/false,
+      /*server_error_to_return=*/std::nullopt);
+
+  absl::Notification notification;
+  int num_calls = 0;
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(kNumInterestGroups)
+      .WillRepeatedly(
+          [&notification, &num_calls](
+              std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                  raw_request,
+              const RequestMetadata& metadata, auto on_done,
+              absl::Duration timeout) {
+            auto raw_response = std::make_unique<
+                GenerateBidsResponse::GenerateBidsRawResponse>();
+            // Bids 1, 2 and 3 for the interest groups in order.
+            const std::string& name =
+                raw_request->interest_group_for_bidding(0).name();
+            AdWithBid* bid = raw_response->add_bids();
+            bid->set_interest_group_name(name);
+            bid->set_bid(name.back() - '0' + 1);
+            std::move(on_done)(std::move(raw_response));
+            if (++num_calls == kNumInterestGroups) {
+              notification.Notify();
+            }
+            return absl::OkStatus();
+          });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+  notification.WaitForNotification();
+
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response_.response_ciphertext()));
+  std::vector<std::string> interest_group_names;
+  for (const AdWithBid& bid : raw_response.bids()) {
+    interest_group_names.push_back(bid.interest_group_name());
+  }
+  EXPECT_THAT(interest_group_names,
+              UnorderedElementsAre("ig_name_1", "ig_name_2"));
+}
+
 class GetProtectedAppSignalsTest : public ::testing::Test {
  protected:
   void SetUp() override {
     server_common::telemetry::TelemetryConfig config_proto;
     config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
     metric::MetricContextMap<GetBidsRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request_);
+        server_common::telemetry::BuildDependentConfig(config_proto));
 
     get_bids_config_.is_protected_app_signals_enabled = true;
     get_bids_config_.is_protected_audience_enabled = true;
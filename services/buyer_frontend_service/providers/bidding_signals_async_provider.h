@@ -15,10 +15,12 @@
 #ifndef SERVICES_BFE_SERVICE_PROVIDERS_BIDDING_SIGNALS_ASYNC_CLIENT_H_
 #define SERVICES_BFE_SERVICE_PROVIDERS_BIDDING_SIGNALS_ASYNC_CLIENT_H_
 
+#include <memory>
 #include <string>
 
 #include "services/buyer_frontend_service/data/bidding_signals.h"
 #include "services/common/providers/async_provider.h"
+#include "services/common/util/request_cancellation.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -36,6 +38,8 @@ struct BiddingSignalsRequest {
   // method.
   const GetBidsRequest::GetBidsRawRequest& get_bids_raw_request_;
   const absl::flat_hash_map<std::string, std::string>& filtering_metadata_;
+  // Cancellation of the GetBids request, which also cancels the lookup.
+  std::shared_ptr<RequestCancellation> cancellation_;
 };
 
 // The classes implementing this interface provide the external signals
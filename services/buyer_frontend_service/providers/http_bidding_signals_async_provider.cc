@@ -38,16 +38,26 @@ void HttpBiddingSignalsAsyncProvider::Get(
         absl::StrCat(bidding_signals_request.get_bids_raw_request_
                          .buyer_kv_experiment_group_id());
   }
+  request->cancellation = bidding_signals_request.cancellation_;
   absl::StatusOr<std::unique_ptr<BiddingSignals>> output =
       std::make_unique<BiddingSignals>();
 
-  for (const auto& interest_group :
-       bidding_signals_request.get_bids_raw_request_.buyer_input()
-           .interest_groups()) {
+  const auto& interest_groups =
+      bidding_signals_request.get_bids_raw_request_.buyer_input()
+          .interest_groups();
+  int num_keys = 0;
+  for (const auto& interest_group : interest_groups) {
+    num_keys += interest_group.bidding_signals_keys_size();
+  }
+  // Interest groups often share keys; the keys are deduplicated as they are
+  // inserted, and sorted once.
+  request->keys.Reserve(num_keys);
+  for (const auto& interest_group : interest_groups) {
     request->interest_group_names.emplace(interest_group.name());
-    request->keys.insert(interest_group.bidding_signals_keys().begin(),
+    request->keys.Insert(interest_group.bidding_signals_keys().begin(),
                          interest_group.bidding_signals_keys().end());
   }
+  request->keys.Finalize();
 
   auto status = http_buyer_kv_async_client_->Execute(
       std::move(request), bidding_signals_request.filtering_metadata_,
@@ -57,8 +67,8 @@ void HttpBiddingSignalsAsyncProvider::Get(
         GetByteSize get_byte_size;
         if (buyer_kv_output.ok()) {
           // TODO(b/258281777): Add ads and buyer signals from KV.
-          res.value()->trusted_signals =
-              std::make_unique<std::string>(buyer_kv_output.value()->result);
+          res.value()->trusted_signals = std::make_unique<std::string>(
+              std::move(buyer_kv_output.value()->result));
           get_byte_size.request = buyer_kv_output.value()->request_size;
           get_byte_size.response = buyer_kv_output.value()->response_size;
         } else {
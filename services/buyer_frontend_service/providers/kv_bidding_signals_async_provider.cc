@@ -0,0 +1,316 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/buyer_frontend_service/providers/kv_bidding_signals_async_provider.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+#include "services/common/util/log_throttle.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using GetBidsRawRequest = GetBidsRequest::GetBidsRawRequest;
+
+// Minimum interval between the logs of each KV failure site. While the KV
+// server is unavailable, every request fails.
+constexpr int kKvFailureLogIntervalSec = 1;
+
+std::unique_ptr<GetValuesRequest> CreateRequest(
+    const GetBidsRawRequest& get_bids_raw_request) {
+  auto request = std::make_unique<GetValuesRequest>();
+  auto& metadata = *request->mutable_metadata()->mutable_fields();
+  metadata[std::string(kKVV2HostnameMetadata)].set_string_value(
+      get_bids_raw_request.publisher_name());
+  if (get_bids_raw_request.has_buyer_kv_experiment_group_id()) {
+    metadata[std::string(kKVV2ExperimentGroupIdMetadata)].set_string_value(
+        absl::StrCat(get_bids_raw_request.buyer_kv_experiment_group_id()));
+  }
+  if (get_bids_raw_request.has_consented_debug_config()) {
+    *request->mutable_consented_debug_config() =
+        get_bids_raw_request.consented_debug_config();
+  }
+  request->add_partitions();
+  return request;
+}
+
+// Adds the interest group names and the key group of every interest group of
+// the request to `partition`, leaving out the names and keys in `sent_names`
+// and `sent_keys`.
+void AddKeyGroups(const GetBidsRawRequest& get_bids_raw_request,
+                  const absl::flat_hash_set<std::string>& sent_names,
+                  const absl::flat_hash_set<std::string>& sent_keys,
+                  kv_server::v2::RequestPartition& partition) {
+  const auto& interest_groups =
+      get_bids_raw_request.buyer_input().interest_groups();
+  std::vector<absl::string_view> interest_group_names;
+  interest_group_names.reserve(interest_groups.size());
+  for (const auto& interest_group : interest_groups) {
+    if (!sent_names.contains(interest_group.name())) {
+      interest_group_names.push_back(interest_group.name());
+    }
+  }
+  if (!interest_group_names.empty() || sent_names.empty()) {
+    AddKVV2KeyGroup({kKVV2InterestGroupNamesTag}, interest_group_names,
+                    partition);
+  }
+  std::vector<absl::string_view> keys;
+  for (const auto& interest_group : interest_groups) {
+    keys.clear();
+    for (const std::string& key : interest_group.bidding_signals_keys()) {
+      if (!sent_keys.contains(key)) {
+        keys.push_back(key);
+      }
+    }
+    if (!keys.empty()) {
+      AddKVV2KeyGroup({kKVV2CustomTag, kKVV2KeysTag}, keys, partition);
+    }
+  }
+}
+
+// Lookups are only batched with those sent to the KV server with the same
+// request metadata and filtering metadata.
+std::string GetBatchKey(const GetBidsRawRequest& get_bids_raw_request,
+                        const RequestMetadata& filtering_metadata) {
+  std::string batch_key = get_bids_raw_request.publisher_name();
+  if (get_bids_raw_request.has_buyer_kv_experiment_group_id()) {
+    absl::StrAppend(&batch_key, "\n",
+                    get_bids_raw_request.buyer_kv_experiment_group_id());
+  }
+  std::vector<std::pair<std::string, std::string>> sorted_metadata(
+      filtering_metadata.begin(), filtering_metadata.end());
+  std::sort(sorted_metadata.begin(), sorted_metadata.end());
+  for (const auto& [key, value] : sorted_metadata) {
+    absl::StrAppend(&batch_key, "\n", key, "=", value);
+  }
+  return batch_key;
+}
+
+// Returns the signals of `keys` out of `signals`, the values of the trusted
+// signals of a whole batch, in the format of a v1 response.
+std::string SelectSignals(const rapidjson::Value& signals,
+                          const std::vector<std::string>& keys) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key(kKVV2KeysTag.data(), kKVV2KeysTag.size());
+  writer.StartObject();
+  for (const std::string& key : keys) {
+    auto it = signals.FindMember(
+        rapidjson::StringRef(key.data(), key.size()));
+    if (it != signals.MemberEnd()) {
+      writer.Key(key.data(), key.size());
+      it->value.Accept(writer);
+    }
+  }
+  writer.EndObject();
+  writer.EndObject();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}  // namespace
+
+KVBiddingSignalsAsyncProvider::KVBiddingSignalsAsyncProvider(
+    std::unique_ptr<KVAsyncClient> kv_async_client,
+    const KVBatchingOptions& batching)
+    : kv_async_client_(std::move(kv_async_client)),
+      batching_({.executor = batching.executor,
+                 .window = std::min(batching.window, kMaxKVBatchWindow)}) {}
+
+KVBiddingSignalsAsyncProvider::~KVBiddingSignalsAsyncProvider() {
+  absl::flat_hash_map<std::string, std::unique_ptr<Batch>> batches;
+  {
+    absl::MutexLock lock(&mu_);
+    batches.swap(batches_);
+    for (auto& [batch_key, batch] : batches) {
+      // A timer that could not be cancelled finds no batch when it runs.
+      if (batching_.executor->Cancel(batch->timer_task_id)) {
+        --pending_timers_;
+      }
+    }
+    mu_.Await(absl::Condition(
+        +[](int* pending_timers) { return *pending_timers == 0; },
+        &pending_timers_));
+  }
+  for (auto& [batch_key, batch] : batches) {
+    SendBatch(std::move(batch));
+  }
+}
+
+void KVBiddingSignalsAsyncProvider::Get(
+    const BiddingSignalsRequest& bidding_signals_request,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>,
+                            GetByteSize) &&>
+        on_done,
+    absl::Duration timeout) const {
+  const GetBidsRawRequest& get_bids_raw_request =
+      bidding_signals_request.get_bids_raw_request_;
+  if (batching_.executor != nullptr &&
+      batching_.window > absl::ZeroDuration() &&
+      !get_bids_raw_request.has_consented_debug_config()) {
+    AddToBatch(bidding_signals_request, std::move(on_done), timeout);
+    return;
+  }
+
+  std::unique_ptr<GetValuesRequest> request =
+      CreateRequest(get_bids_raw_request);
+  AddKeyGroups(get_bids_raw_request, /*sent_names=*/{}, /*sent_keys=*/{},
+               *request->mutable_partitions(0));
+  const size_t request_size = request->ByteSizeLong();
+  auto status = kv_async_client_->ExecuteInternal(
+      std::move(request), bidding_signals_request.filtering_metadata_,
+      [request_size, on_done = std::move(on_done)](
+          absl::StatusOr<std::unique_ptr<GetValuesResponse>>
+              response) mutable {
+        GetByteSize get_byte_size = {.request = request_size, .response = 0};
+        if (!response.ok()) {
+          std::move(on_done)(response.status(), get_byte_size);
+          return;
+        }
+        get_byte_size.response = (*response)->ByteSizeLong();
+        absl::StatusOr<std::string> trusted_signals =
+            ToKVV1Signals(**response, {kKVV2KeysTag});
+        if (!trusted_signals.ok()) {
+          std::move(on_done)(trusted_signals.status(), get_byte_size);
+          return;
+        }
+        auto signals = std::make_unique<BiddingSignals>();
+        signals->trusted_signals =
+            std::make_unique<std::string>(*std::move(trusted_signals));
+        std::move(on_done)(std::move(signals), get_byte_size);
+      },
+      timeout, bidding_signals_request.cancellation_);
+  if (!status.ok()) {
+    PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+        << "Unable to fetch bidding signals: " << status;
+  }
+}
+
+void KVBiddingSignalsAsyncProvider::AddToBatch(
+    const BiddingSignalsRequest& bidding_signals_request, OnDone on_done,
+    absl::Duration timeout) const {
+  const GetBidsRawRequest& get_bids_raw_request =
+      bidding_signals_request.get_bids_raw_request_;
+  Lookup lookup = {.on_done = std::move(on_done)};
+  absl::flat_hash_set<absl::string_view> lookup_keys;
+  for (const auto& interest_group :
+       get_bids_raw_request.buyer_input().interest_groups()) {
+    for (const std::string& key : interest_group.bidding_signals_keys()) {
+      if (lookup_keys.insert(key).second) {
+        lookup.keys.push_back(key);
+      }
+    }
+  }
+
+  std::string batch_key = GetBatchKey(
+      get_bids_raw_request, bidding_signals_request.filtering_metadata_);
+  absl::MutexLock lock(&mu_);
+  std::unique_ptr<Batch>& batch = batches_[batch_key];
+  if (batch == nullptr) {
+    batch = std::make_unique<Batch>();
+    batch->request = CreateRequest(get_bids_raw_request);
+    batch->filtering_metadata = bidding_signals_request.filtering_metadata_;
+    batch->timeout = timeout;
+    ++pending_timers_;
+    batch->timer_task_id = batching_.executor->RunAfter(
+        batching_.window,
+        [this, batch_key]() { OnBatchTimer(batch_key); });
+  }
+  batch->timeout = std::min(batch->timeout, timeout);
+  AddKeyGroups(get_bids_raw_request, batch->sent_names, batch->sent_keys,
+               *batch->request->mutable_partitions(0));
+  for (const auto& interest_group :
+       get_bids_raw_request.buyer_input().interest_groups()) {
+    batch->sent_names.insert(interest_group.name());
+  }
+  batch->sent_keys.insert(lookup.keys.begin(), lookup.keys.end());
+  batch->lookups.push_back(std::move(lookup));
+}
+
+void KVBiddingSignalsAsyncProvider::OnBatchTimer(
+    const std::string& batch_key) const {
+  std::unique_ptr<Batch> batch;
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = batches_.find(batch_key); it != batches_.end()) {
+      batch = std::move(it->second);
+      batches_.erase(it);
+    }
+  }
+  if (batch != nullptr) {
+    SendBatch(std::move(batch));
+  }
+  absl::MutexLock lock(&mu_);
+  --pending_timers_;
+}
+
+void KVBiddingSignalsAsyncProvider::SendBatch(
+    std::unique_ptr<Batch> batch) const {
+  PS_VLOG(6) << "Sending a batch of " << batch->lookups.size()
+             << " bidding signals lookups";
+  // The bytes of the request and the response are shared by the lookups.
+  const size_t num_lookups = batch->lookups.size();
+  const size_t request_size = batch->request->ByteSizeLong() / num_lookups;
+  std::vector<Lookup> lookups = std::move(batch->lookups);
+  auto status = kv_async_client_->ExecuteInternal(
+      std::move(batch->request), batch->filtering_metadata,
+      [request_size, num_lookups, lookups = std::move(lookups)](
+          absl::StatusOr<std::unique_ptr<GetValuesResponse>>
+              response) mutable {
+        GetByteSize get_byte_size = {.request = request_size, .response = 0};
+        if (response.ok()) {
+          get_byte_size.response = (*response)->ByteSizeLong() / num_lookups;
+        }
+        absl::StatusOr<std::string> trusted_signals =
+            response.ok() ? ToKVV1Signals(**response, {kKVV2KeysTag})
+                          : absl::StatusOr<std::string>(response.status());
+        if (!trusted_signals.ok()) {
+          for (Lookup& lookup : lookups) {
+            std::move(lookup.on_done)(trusted_signals.status(),
+                                      get_byte_size);
+          }
+          return;
+        }
+        // The signals converted by ToKVV1Signals are valid JSON, with an
+        // object of the signals of all the keys.
+        rapidjson::Document document;
+        document.Parse<rapidjson::kParseFullPrecisionFlag>(
+            trusted_signals->data(), trusted_signals->size());
+        const rapidjson::Value& batch_signals = document[rapidjson::StringRef(
+            kKVV2KeysTag.data(), kKVV2KeysTag.size())];
+        for (Lookup& lookup : lookups) {
+          auto signals = std::make_unique<BiddingSignals>();
+          signals->trusted_signals = std::make_unique<std::string>(
+              SelectSignals(batch_signals, lookup.keys));
+          std::move(lookup.on_done)(std::move(signals), get_byte_size);
+        }
+      },
+      batch->timeout);
+  if (!status.ok()) {
+    PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+        << "Unable to fetch a batch of bidding signals: " << status;
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BFE_SERVICE_PROVIDERS_KV_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
+#define SERVICES_BFE_SERVICE_PROVIDERS_KV_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/common/clients/kv_server/kv_async_client.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Longest window of the batching of KV lookups.
+inline constexpr absl::Duration kMaxKVBatchWindow = absl::Milliseconds(2);
+
+// Options for merging the KV lookups of concurrent GetBids requests into a
+// single KV request.
+struct KVBatchingOptions {
+  // Executor running the timers that send the batches. Lookups are not
+  // batched if not set.
+  server_common::Executor* executor = nullptr;
+  // How long the first lookup of a batch waits for concurrent lookups to be
+  // sent with it, up to kMaxKVBatchWindow. Lookups are not batched if zero.
+  absl::Duration window = absl::ZeroDuration();
+};
+
+// Fetches the trusted bidding signals from a TEE KV server with the v2
+// GetValues API, over gRPC with protobuf bodies. The keys of each interest
+// group are sent as a key group of their own, so that there is no limit on
+// their number as with the URL of a v1 request. The signals are returned in
+// the format of a v1 response.
+//
+// With batching, the lookups of the same hostname, experiment group and
+// metadata made within the batching window share a KV request, whose single
+// partition holds the key groups of all of them, each key once. Every lookup
+// gets the signals of its own keys from the response. Lookups with a
+// consented debug config are never batched.
+class KVBiddingSignalsAsyncProvider final : public BiddingSignalsAsyncProvider {
+ public:
+  // options.executor must outlive the instance.
+  explicit KVBiddingSignalsAsyncProvider(
+      std::unique_ptr<KVAsyncClient> kv_async_client,
+      const KVBatchingOptions& batching = {});
+
+  // Sends the pending batches. Blocks until a running batch timer finishes.
+  ~KVBiddingSignalsAsyncProvider() override;
+
+  // KVBiddingSignalsAsyncProvider is neither copyable nor movable.
+  KVBiddingSignalsAsyncProvider(const KVBiddingSignalsAsyncProvider&) = delete;
+  KVBiddingSignalsAsyncProvider& operator=(
+      const KVBiddingSignalsAsyncProvider&) = delete;
+
+  void Get(const BiddingSignalsRequest& bidding_signals_request,
+           absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                       BiddingSignals>>,
+                                   GetByteSize) &&>
+               on_done,
+           absl::Duration timeout) const override;
+
+ private:
+  using OnDone = absl::AnyInvocable<
+      void(absl::StatusOr<std::unique_ptr<BiddingSignals>>, GetByteSize) &&>;
+
+  // A lookup waiting for its batch to be sent.
+  struct Lookup {
+    // The keys of the lookup, each once.
+    std::vector<std::string> keys;
+    OnDone on_done;
+  };
+
+  // Lookups sharing a KV request.
+  struct Batch {
+    std::unique_ptr<GetValuesRequest> request;
+    RequestMetadata filtering_metadata;
+    absl::Duration timeout;
+    std::vector<Lookup> lookups;
+    // The interest group names and keys in the request so far.
+    absl::flat_hash_set<std::string> sent_names;
+    absl::flat_hash_set<std::string> sent_keys;
+    server_common::TaskId timer_task_id;
+  };
+
+  void AddToBatch(const BiddingSignalsRequest& bidding_signals_request,
+                  OnDone on_done, absl::Duration timeout) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sends the batch of `batch_key` once its window has passed.
+  void OnBatchTimer(const std::string& batch_key) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  void SendBatch(std::unique_ptr<Batch> batch) const;
+
+  std::unique_ptr<KVAsyncClient> kv_async_client_;
+  const KVBatchingOptions batching_;
+
+  mutable absl::Mutex mu_;
+  mutable absl::flat_hash_map<std::string, std::unique_ptr<Batch>> batches_
+      ABSL_GUARDED_BY(mu_);
+  // Number of batch timers scheduled and not yet done.
+  mutable int pending_timers_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BFE_SERVICE_PROVIDERS_KV_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
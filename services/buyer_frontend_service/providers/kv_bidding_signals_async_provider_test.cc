@@ -0,0 +1,209 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/buyer_frontend_service/providers/kv_bidding_signals_async_provider.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+using ::testing::An;
+
+constexpr int kEgId = 1689;
+
+GetBidsRequest::GetBidsRawRequest GetRequest() {
+  GetBidsRequest::GetBidsRawRequest request;
+  request.set_publisher_name("publisher.com");
+  request.set_buyer_kv_experiment_group_id(kEgId);
+  auto* first = request.mutable_buyer_input()->add_interest_groups();
+  first->set_name("ig_1");
+  first->add_bidding_signals_keys("key_1");
+  first->add_bidding_signals_keys("key_2");
+  auto* second = request.mutable_buyer_input()->add_interest_groups();
+  second->set_name("ig_2");
+  second->add_bidding_signals_keys("key_2");
+  return request;
+}
+
+TEST(KVBiddingSignalsAsyncProviderTest, SendsKeyGroupPerInterestGroup) {
+  auto mock_client = std::make_unique<KVAsyncClientMock>();
+  auto request = GetRequest();
+  EXPECT_CALL(
+      *mock_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GetValuesRequest>>(), An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        const auto& fields = raw_request->metadata().fields();
+        EXPECT_EQ(fields.at(std::string(kKVV2HostnameMetadata)).string_value(),
+                  "publisher.com");
+        EXPECT_EQ(fields.at(std::string(kKVV2ExperimentGroupIdMetadata))
+                      .string_value(),
+                  absl::StrCat(kEgId));
+        EXPECT_EQ(raw_request->partitions_size(), 1);
+        const auto& arguments = raw_request->partitions(0).arguments();
+        EXPECT_EQ(arguments.size(), 3);
+        EXPECT_EQ(arguments[0].tags().values(0).string_value(),
+                  kKVV2InterestGroupNamesTag);
+        EXPECT_EQ(arguments[0].data().list_value().values_size(), 2);
+        EXPECT_EQ(arguments[1].tags().values(1).string_value(), kKVV2KeysTag);
+        EXPECT_EQ(arguments[1].data().list_value().values_size(), 2);
+        EXPECT_EQ(arguments[2].data().list_value().values(0).string_value(),
+                  "key_2");
+        return absl::OkStatus();
+      });
+
+  KVBiddingSignalsAsyncProvider class_under_test(std::move(mock_client));
+  class_under_test.Get(
+      BiddingSignalsRequest(request, {}),
+      [](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals,
+         GetByteSize get_byte_size) {},
+      absl::Milliseconds(100));
+}
+
+TEST(KVBiddingSignalsAsyncProviderTest, ReturnsSignalsInV1Format) {
+  auto mock_client = std::make_unique<KVAsyncClientMock>();
+  auto request = GetRequest();
+  EXPECT_CALL(
+      *mock_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GetValuesRequest>>(), An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        auto response = std::make_unique<GetValuesResponse>();
+        response->mutable_single_partition()->set_string_output(
+            R"JSON({"keyGroupOutputs": [{"tags": ["custom", "keys"],
+                "keyValues": {"key_1": {"value": [1]}}}]})JSON");
+        std::move(on_done)(std::move(response));
+        return absl::OkStatus();
+      });
+
+  KVBiddingSignalsAsyncProvider class_under_test(std::move(mock_client));
+  absl::Notification notification;
+  class_under_test.Get(
+      BiddingSignalsRequest(request, {}),
+      [&notification](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals,
+                      GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        EXPECT_EQ(*(*signals)->trusted_signals, R"({"keys":{"key_1":[1]}})");
+        EXPECT_GT(get_byte_size.request, 0);
+        EXPECT_GT(get_byte_size.response, 0);
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
+TEST(KVBiddingSignalsAsyncProviderTest, SendsConcurrentLookupsInOneRequest) {
+  auto mock_client = std::make_unique<KVAsyncClientMock>();
+  MockExecutor executor;
+  auto first_request = GetRequest();
+  auto second_request = GetRequest();
+  auto* interest_group =
+      second_request.mutable_buyer_input()->mutable_interest_groups(1);
+  interest_group->set_name("ig_3");
+  interest_group->add_bidding_signals_keys("key_3");
+  absl::AnyInvocable<void()> send_batch;
+  EXPECT_CALL(executor, RunAfter(absl::Milliseconds(1), _))
+      .WillOnce(
+          [&send_batch](absl::Duration, absl::AnyInvocable<void()> closure) {
+            send_batch = std::move(closure);
+            return server_common::TaskId();
+          });
+  EXPECT_CALL(
+      *mock_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GetValuesRequest>>(), An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        EXPECT_EQ(timeout, absl::Milliseconds(50));
+        EXPECT_EQ(raw_request->partitions_size(), 1);
+        const auto& arguments = raw_request->partitions(0).arguments();
+        // The names and keys of the first lookup, then the ones of the
+        // second lookup not sent yet.
+        EXPECT_EQ(arguments.size(), 5);
+        EXPECT_EQ(arguments[3].data().list_value().values_size(), 1);
+        EXPECT_EQ(arguments[3].data().list_value().values(0).string_value(),
+                  "ig_3");
+        EXPECT_EQ(arguments[4].data().list_value().values(0).string_value(),
+                  "key_3");
+        auto response = std::make_unique<GetValuesResponse>();
+        response->mutable_single_partition()->set_string_output(
+            R"JSON({"keyGroupOutputs": [{"tags": ["custom", "keys"],
+                "keyValues": {"key_1": {"value": 1}, "key_2": {"value": 2},
+                              "key_3": {"value": 3}}}]})JSON");
+        std::move(on_done)(std::move(response));
+        return absl::OkStatus();
+      });
+
+  KVBiddingSignalsAsyncProvider class_under_test(
+      std::move(mock_client),
+      {.executor = &executor, .window = absl::Milliseconds(1)});
+  std::string first_signals;
+  std::string second_signals;
+  class_under_test.Get(
+      BiddingSignalsRequest(first_request, {}),
+      [&first_signals](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals,
+                       GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        first_signals = *(*signals)->trusted_signals;
+      },
+      absl::Milliseconds(100));
+  class_under_test.Get(
+      BiddingSignalsRequest(second_request, {}),
+      [&second_signals](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals,
+                        GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        second_signals = *(*signals)->trusted_signals;
+      },
+      absl::Milliseconds(50));
+  send_batch();
+
+  EXPECT_EQ(first_signals, R"({"keys":{"key_1":1,"key_2":2}})");
+  EXPECT_EQ(second_signals, R"({"keys":{"key_1":1,"key_2":2,"key_3":3}})");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
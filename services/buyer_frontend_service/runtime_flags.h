@@ -29,6 +29,10 @@ inline constexpr absl::string_view HEALTHCHECK_PORT =
 inline constexpr absl::string_view BIDDING_SERVER_ADDR = "BIDDING_SERVER_ADDR";
 inline constexpr absl::string_view BUYER_KV_SERVER_ADDR =
     "BUYER_KV_SERVER_ADDR";
+inline constexpr absl::string_view BUYER_TEE_KV_SERVER_ADDR =
+    "BUYER_TEE_KV_SERVER_ADDR";
+inline constexpr absl::string_view BUYER_TEE_KV_SERVER_EGRESS_TLS =
+    "BUYER_TEE_KV_SERVER_EGRESS_TLS";
 inline constexpr absl::string_view GENERATE_BID_TIMEOUT_MS =
     "GENERATE_BID_TIMEOUT_MS";
 inline constexpr absl::string_view
@@ -51,13 +55,72 @@ inline constexpr absl::string_view
         "BFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND";
 inline constexpr absl::string_view BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES =
     "BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES";
+inline constexpr absl::string_view BFE_HTTP_FETCHER_NUM_SHARDS =
+    "BFE_HTTP_FETCHER_NUM_SHARDS";
+inline constexpr absl::string_view BUYER_KV_MIN_WARM_CONNECTIONS =
+    "BUYER_KV_MIN_WARM_CONNECTIONS";
+inline constexpr absl::string_view BUYER_KV_REWARM_INTERVAL_MS =
+    "BUYER_KV_REWARM_INTERVAL_MS";
+inline constexpr absl::string_view ENABLE_BUYER_KV_REQUEST_COALESCING =
+    "ENABLE_BUYER_KV_REQUEST_COALESCING";
+inline constexpr absl::string_view BUYER_KV_CACHE_TTL_MS =
+    "BUYER_KV_CACHE_TTL_MS";
+inline constexpr absl::string_view BUYER_KV_CACHE_MAX_BYTES =
+    "BUYER_KV_CACHE_MAX_BYTES";
+inline constexpr absl::string_view BUYER_KV_BATCH_WINDOW_US =
+    "BUYER_KV_BATCH_WINDOW_US";
+inline constexpr absl::string_view BUYER_KV_HEDGE_PERCENTILE =
+    "BUYER_KV_HEDGE_PERCENTILE";
+inline constexpr absl::string_view BIDDING_GRPC_NUM_CHANNELS =
+    "BIDDING_GRPC_NUM_CHANNELS";
+inline constexpr absl::string_view BIDDING_GRPC_KEEPALIVE_MS =
+    "BIDDING_GRPC_KEEPALIVE_MS";
+inline constexpr absl::string_view BIDDING_GRPC_STREAM_WINDOW_BYTES =
+    "BIDDING_GRPC_STREAM_WINDOW_BYTES";
+inline constexpr absl::string_view BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES =
+    "BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES";
+inline constexpr absl::string_view BIDDING_SERVER_ZONAL_ADDRS =
+    "BIDDING_SERVER_ZONAL_ADDRS";
+inline constexpr absl::string_view BIDDING_ZONE_SPILLOVER_RPCS =
+    "BIDDING_ZONE_SPILLOVER_RPCS";
+inline constexpr absl::string_view BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS =
+    "BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS";
+inline constexpr absl::string_view
+    MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST =
+        "MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST";
+inline constexpr absl::string_view PRUNE_TRUSTED_BIDDING_SIGNALS =
+    "PRUNE_TRUSTED_BIDDING_SIGNALS";
+inline constexpr absl::string_view SEND_INTEREST_GROUP_COLUMNS =
+    "SEND_INTEREST_GROUP_COLUMNS";
+inline constexpr absl::string_view MAX_BIDS_PER_GET_BIDS_RESPONSE =
+    "MAX_BIDS_PER_GET_BIDS_RESPONSE";
+inline constexpr absl::string_view MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST =
+    "MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST";
+inline constexpr absl::string_view INTEREST_GROUP_PRIORITY =
+    "INTEREST_GROUP_PRIORITY";
+inline constexpr absl::string_view BFE_MAX_GET_BIDS_IN_FLIGHT =
+    "BFE_MAX_GET_BIDS_IN_FLIGHT";
+inline constexpr absl::string_view BFE_GET_BIDS_PER_SELLER_QPS =
+    "BFE_GET_BIDS_PER_SELLER_QPS";
+inline constexpr absl::string_view BFE_SELLER_ADMISSION_WEIGHTS =
+    "BFE_SELLER_ADMISSION_WEIGHTS";
+inline constexpr absl::string_view BFE_MIN_GET_BIDS_TIME_LEFT_MS =
+    "BFE_MIN_GET_BIDS_TIME_LEFT_MS";
+inline constexpr absl::string_view BFE_BACKEND_PRECONNECT_TIMEOUT_MS =
+    "BFE_BACKEND_PRECONNECT_TIMEOUT_MS";
+inline constexpr absl::string_view BFE_BACKEND_READY_PERCENT =
+    "BFE_BACKEND_READY_PERCENT";
+inline constexpr absl::string_view BFE_REQUEST_CAPTURE_PATH =
+    "BFE_REQUEST_CAPTURE_PATH";
 
-inline constexpr int kNumRuntimeFlags = 16;
+inline constexpr int kNumRuntimeFlags = 46;
 inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     PORT,
     HEALTHCHECK_PORT,
     BIDDING_SERVER_ADDR,
     BUYER_KV_SERVER_ADDR,
+    BUYER_TEE_KV_SERVER_ADDR,
+    BUYER_TEE_KV_SERVER_EGRESS_TLS,
     GENERATE_BID_TIMEOUT_MS,
     PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS,
     BIDDING_SIGNALS_LOAD_TIMEOUT_MS,
@@ -70,6 +133,34 @@ inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     BIDDING_EGRESS_TLS,
     BFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND,
     BFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES,
+    BFE_HTTP_FETCHER_NUM_SHARDS,
+    BUYER_KV_MIN_WARM_CONNECTIONS,
+    BUYER_KV_REWARM_INTERVAL_MS,
+    ENABLE_BUYER_KV_REQUEST_COALESCING,
+    BUYER_KV_CACHE_TTL_MS,
+    BUYER_KV_CACHE_MAX_BYTES,
+    BUYER_KV_BATCH_WINDOW_US,
+    BUYER_KV_HEDGE_PERCENTILE,
+    BIDDING_GRPC_NUM_CHANNELS,
+    BIDDING_GRPC_KEEPALIVE_MS,
+    BIDDING_GRPC_STREAM_WINDOW_BYTES,
+    BIDDING_GRPC_MIN_COMPRESSED_REQUEST_BYTES,
+    BIDDING_SERVER_ZONAL_ADDRS,
+    BIDDING_ZONE_SPILLOVER_RPCS,
+    BIDDING_LOAD_REPORT_WAIT_PER_RPC_MS,
+    MAX_INTEREST_GROUPS_PER_GENERATE_BIDS_REQUEST,
+    PRUNE_TRUSTED_BIDDING_SIGNALS,
+    SEND_INTEREST_GROUP_COLUMNS,
+    MAX_BIDS_PER_GET_BIDS_RESPONSE,
+    MAX_INTEREST_GROUPS_PER_GET_BIDS_REQUEST,
+    INTEREST_GROUP_PRIORITY,
+    BFE_MAX_GET_BIDS_IN_FLIGHT,
+    BFE_GET_BIDS_PER_SELLER_QPS,
+    BFE_SELLER_ADMISSION_WEIGHTS,
+    BFE_MIN_GET_BIDS_TIME_LEFT_MS,
+    BFE_BACKEND_PRECONNECT_TIMEOUT_MS,
+    BFE_BACKEND_READY_PERCENT,
+    BFE_REQUEST_CAPTURE_PATH,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
@@ -14,6 +14,14 @@
 
 #include "services/buyer_frontend_service/util/proto_factory.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "services/common/util/json_span_util.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 using GetBidsRawRequest = GetBidsRequest::GetBidsRawRequest;
 using GetBidsRawResponse = GetBidsResponse::GetBidsRawResponse;
@@ -22,6 +30,96 @@ using GenerateProtectedAppSignalsBidsRawRequest =
     GenerateProtectedAppSignalsBidsRequest::
         GenerateProtectedAppSignalsBidsRawRequest;
 
+namespace {
+
+inline constexpr char kKeys[] = "keys";
+inline constexpr char kPerInterestGroupData[] = "perInterestGroupData";
+
+// Appends the members of `spans` listed in `names` as a JSON object property,
+// skipping duplicate and absent members.
+void AppendJsonObjectProperty(absl::string_view property,
+                              const std::vector<absl::string_view>& names,
+                              const JsonObjectSpans& spans,
+                              absl::flat_hash_set<absl::string_view>& seen,
+                              std::string& json) {
+  AppendJsonString(property, json);
+  json.append(":{");
+  bool first = true;
+  seen.clear();
+  for (absl::string_view name : names) {
+    auto it = spans.members.find(name);
+    if (it == spans.members.end() || it->second.data() == nullptr ||
+        !seen.insert(name).second) {
+      continue;
+    }
+    if (!first) {
+      json.push_back(',');
+    }
+    first = false;
+    AppendJsonString(name, json);
+    json.push_back(':');
+    json.append(it->second.data(), it->second.size());
+  }
+  json.push_back('}');
+}
+
+// Spans of the trusted bidding signals requested by the interest groups of a
+// request, pointing into the signals and the interest groups.
+struct BiddingSignalsSpans {
+  JsonObjectSpans keys;
+  JsonObjectSpans per_ig_data;
+};
+
+absl::Status FindBiddingSignalsSpans(const GenerateBidsRawRequest& raw_request,
+                                     BiddingSignalsSpans& spans) {
+  for (const auto& ig : raw_request.interest_group_for_bidding()) {
+    for (const auto& key : ig.trusted_bidding_signals_keys()) {
+      spans.keys.members.try_emplace(key);
+    }
+    spans.per_ig_data.members.try_emplace(ig.name());
+  }
+  if (absl::Status status = FindJsonMemberSpans(
+          raw_request.bidding_signals(),
+          {{kKeys, &spans.keys}, {kPerInterestGroupData, &spans.per_ig_data}});
+      !status.ok()) {
+    return status;
+  }
+  if (!spans.keys.found) {
+    return absl::InvalidArgumentError(
+        "Malformed trusted bidding signals (Missing property \"keys\")");
+  }
+  return absl::OkStatus();
+}
+
+// Returns the trusted bidding signals of the interest groups in [begin, end)
+// of the request.
+std::string SliceBiddingSignals(const GenerateBidsRawRequest& raw_request,
+                                int begin, int end,
+                                const BiddingSignalsSpans& spans) {
+  std::vector<absl::string_view> keys;
+  std::vector<absl::string_view> names;
+  names.reserve(end - begin);
+  for (int i = begin; i < end; ++i) {
+    const auto& ig = raw_request.interest_group_for_bidding(i);
+    keys.insert(keys.end(), ig.trusted_bidding_signals_keys().begin(),
+                ig.trusted_bidding_signals_keys().end());
+    names.push_back(ig.name());
+  }
+  absl::flat_hash_set<absl::string_view> seen;
+  std::string json;
+  json.push_back('{');
+  AppendJsonObjectProperty(kKeys, keys, spans.keys, seen, json);
+  if (spans.per_ig_data.found) {
+    json.push_back(',');
+    AppendJsonObjectProperty(kPerInterestGroupData, names, spans.per_ig_data,
+                             seen, json);
+  }
+  json.push_back('}');
+  return json;
+}
+
+}  // namespace
+
 std::unique_ptr<GetBidsRawResponse> CreateGetBidsRawResponse(
     std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>
         raw_response) {
@@ -74,74 +172,293 @@ void CopyIGFromDeviceToIGForBidding(
   }
 }
 
-std::unique_ptr<GenerateBidsRawRequest> CreateGenerateBidsRawRequest(
-    const GetBidsRawRequest& get_bids_raw_request,
-    const BuyerInput& buyer_input,
-    std::unique_ptr<BiddingSignals> bidding_signals,
-    const server_common::LogContext& log_context) {
-  auto generate_bids_raw_request = std::make_unique<GenerateBidsRawRequest>();
+namespace {
 
-  // 1. Set Interest Group for bidding
-  for (int i = 0; i < buyer_input.interest_groups_size(); i++) {
-    const auto& interest_group_from_device = buyer_input.interest_groups(i);
-    // IG must have a name.
-    if (interest_group_from_device.name().empty()) {
-      continue;
-    }
-    // Add InterestGroupForBidding.
-    auto mutable_interest_group_for_bidding =
-        generate_bids_raw_request->mutable_interest_group_for_bidding()->Add();
+// Moves properties from IG from device to IG for Bidding. The user bidding
+// signals, ad render ids and keys are moved rather than copied, since they
+// make most of the IG and the device IG is not read again.
+void MoveIGFromDeviceToIGForBidding(
+    BuyerInput::InterestGroup& ig_from_device,
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding*
+        mutable_ig_for_bidding) {
+  mutable_ig_for_bidding->set_name(std::move(*ig_from_device.mutable_name()));
 
-    // Copy from IG from device.
-    CopyIGFromDeviceToIGForBidding(interest_group_from_device,
-                                   mutable_interest_group_for_bidding);
+  if (!ig_from_device.user_bidding_signals().empty()) {
+    mutable_ig_for_bidding->set_user_bidding_signals(
+        std::move(*ig_from_device.mutable_user_bidding_signals()));
   }
 
+  mutable_ig_for_bidding->mutable_ad_render_ids()->Reserve(
+      ig_from_device.ad_render_ids_size());
+  for (std::string& ad_render_id : *ig_from_device.mutable_ad_render_ids()) {
+    mutable_ig_for_bidding->add_ad_render_ids(std::move(ad_render_id));
+  }
+  mutable_ig_for_bidding->mutable_ad_component_render_ids()->Reserve(
+      ig_from_device.component_ads_size());
+  for (std::string& component_ad : *ig_from_device.mutable_component_ads()) {
+    mutable_ig_for_bidding->add_ad_component_render_ids(
+        std::move(component_ad));
+  }
+  mutable_ig_for_bidding->mutable_trusted_bidding_signals_keys()->Reserve(
+      ig_from_device.bidding_signals_keys_size());
+  for (std::string& key : *ig_from_device.mutable_bidding_signals_keys()) {
+    mutable_ig_for_bidding->add_trusted_bidding_signals_keys(std::move(key));
+  }
+
+  // Set Device Signals.
+  if (ig_from_device.has_browser_signals() &&
+      ig_from_device.browser_signals().IsInitialized()) {
+    *mutable_ig_for_bidding->mutable_browser_signals() =
+        std::move(*ig_from_device.mutable_browser_signals());
+  } else if (ig_from_device.has_android_signals()) {
+    *mutable_ig_for_bidding->mutable_android_signals() =
+        std::move(*ig_from_device.mutable_android_signals());
+  }
+}
+
+// Sets the fields of the bidding request other than the interest groups.
+void SetGenerateBidsRawRequestSignals(
+    const GetBidsRawRequest& get_bids_raw_request,
+    std::unique_ptr<BiddingSignals> bidding_signals,
+    const server_common::LogContext& log_context,
+    GenerateBidsRawRequest& generate_bids_raw_request) {
   // 2. Set Auction Signals.
-  generate_bids_raw_request->set_auction_signals(
+  generate_bids_raw_request.set_auction_signals(
       get_bids_raw_request.auction_signals());
 
   // 3. Set Buyer Signals.
   if (!get_bids_raw_request.buyer_signals().empty()) {
-    generate_bids_raw_request->set_buyer_signals(
+    generate_bids_raw_request.set_buyer_signals(
         get_bids_raw_request.buyer_signals());
   } else {
-    generate_bids_raw_request->set_buyer_signals("");
+    generate_bids_raw_request.set_buyer_signals("");
   }
 
   // 4. Set Bidding Signals
-  generate_bids_raw_request->set_allocated_bidding_signals(
+  generate_bids_raw_request.set_allocated_bidding_signals(
       bidding_signals->trusted_signals.release());
 
   // 5. Set Debug Reporting Flag
-  generate_bids_raw_request->set_enable_debug_reporting(
+  generate_bids_raw_request.set_enable_debug_reporting(
       get_bids_raw_request.enable_debug_reporting());
 
-  generate_bids_raw_request->set_publisher_name(
+  generate_bids_raw_request.set_publisher_name(
       get_bids_raw_request.publisher_name());
-  generate_bids_raw_request->set_seller(get_bids_raw_request.seller());
-  generate_bids_raw_request->set_top_level_seller(
+  generate_bids_raw_request.set_seller(get_bids_raw_request.seller());
+  generate_bids_raw_request.set_top_level_seller(
       get_bids_raw_request.top_level_seller());
 
   // 6. Set logging context.
   if (!log_context.adtech_debug_id().empty()) {
-    generate_bids_raw_request->mutable_log_context()->set_adtech_debug_id(
+    generate_bids_raw_request.mutable_log_context()->set_adtech_debug_id(
         log_context.adtech_debug_id());
   }
   if (!log_context.generation_id().empty()) {
-    generate_bids_raw_request->mutable_log_context()->set_generation_id(
+    generate_bids_raw_request.mutable_log_context()->set_generation_id(
         log_context.generation_id());
   }
 
   // 7. Set consented debug config.
   if (get_bids_raw_request.has_consented_debug_config()) {
-    *generate_bids_raw_request->mutable_consented_debug_config() =
+    *generate_bids_raw_request.mutable_consented_debug_config() =
         get_bids_raw_request.consented_debug_config();
   }
+}
+
+}  // namespace
 
+std::unique_ptr<GenerateBidsRawRequest> CreateGenerateBidsRawRequest(
+    const GetBidsRawRequest& get_bids_raw_request,
+    const BuyerInput& buyer_input,
+    std::unique_ptr<BiddingSignals> bidding_signals,
+    const server_common::LogContext& log_context) {
+  auto generate_bids_raw_request = std::make_unique<GenerateBidsRawRequest>();
+
+  // 1. Set Interest Group for bidding
+  for (int i = 0; i < buyer_input.interest_groups_size(); i++) {
+    const auto& interest_group_from_device = buyer_input.interest_groups(i);
+    // IG must have a name.
+    if (interest_group_from_device.name().empty()) {
+      continue;
+    }
+    // Add InterestGroupForBidding.
+    auto mutable_interest_group_for_bidding =
+        generate_bids_raw_request->mutable_interest_group_for_bidding()->Add();
+
+    // Copy from IG from device.
+    CopyIGFromDeviceToIGForBidding(interest_group_from_device,
+                                   mutable_interest_group_for_bidding);
+  }
+
+  SetGenerateBidsRawRequestSignals(get_bids_raw_request,
+                                   std::move(bidding_signals), log_context,
+                                   *generate_bids_raw_request);
+  return generate_bids_raw_request;
+}
+
+std::unique_ptr<GenerateBidsRawRequest> CreateGenerateBidsRawRequest(
+    const GetBidsRawRequest& get_bids_raw_request, BuyerInput&& buyer_input,
+    std::unique_ptr<BiddingSignals> bidding_signals,
+    const server_common::LogContext& log_context) {
+  auto generate_bids_raw_request = std::make_unique<GenerateBidsRawRequest>();
+  generate_bids_raw_request->mutable_interest_group_for_bidding()->Reserve(
+      buyer_input.interest_groups_size());
+  for (BuyerInput::InterestGroup& interest_group_from_device :
+       *buyer_input.mutable_interest_groups()) {
+    // IG must have a name.
+    if (interest_group_from_device.name().empty()) {
+      continue;
+    }
+    MoveIGFromDeviceToIGForBidding(
+        interest_group_from_device,
+        generate_bids_raw_request->add_interest_group_for_bidding());
+  }
+
+  SetGenerateBidsRawRequestSignals(get_bids_raw_request,
+                                   std::move(bidding_signals), log_context,
+                                   *generate_bids_raw_request);
   return generate_bids_raw_request;
 }
 
+std::vector<std::unique_ptr<GenerateBidsRawRequest>>
+SplitGenerateBidsRawRequest(std::unique_ptr<GenerateBidsRawRequest> raw_request,
+                            int max_interest_groups_per_request) {
+  std::vector<std::unique_ptr<GenerateBidsRawRequest>> requests;
+  const int num_igs = raw_request->interest_group_for_bidding_size();
+  if (max_interest_groups_per_request <= 0 ||
+      num_igs <= max_interest_groups_per_request) {
+    requests.push_back(std::move(raw_request));
+    return requests;
+  }
+
+  BiddingSignalsSpans spans;
+  if (!FindBiddingSignalsSpans(*raw_request, spans).ok()) {
+    requests.push_back(std::move(raw_request));
+    return requests;
+  }
+
+  // Spreads the interest groups evenly, in order.
+  const int num_requests =
+      (num_igs + max_interest_groups_per_request - 1) /
+      max_interest_groups_per_request;
+  std::vector<int> ends;
+  ends.reserve(num_requests);
+  for (int i = 0, end = 0; i < num_requests; ++i) {
+    end += num_igs / num_requests + (i < num_igs % num_requests ? 1 : 0);
+    ends.push_back(end);
+  }
+
+  // The spans point into the interest groups, which must not be moved until
+  // the signals of every request are sliced.
+  std::vector<std::string> signals;
+  signals.reserve(num_requests);
+  for (int i = 0, begin = 0; i < num_requests; begin = ends[i++]) {
+    signals.push_back(SliceBiddingSignals(*raw_request, begin, ends[i], spans));
+  }
+
+  // Copies the other fields to every request, and moves the interest groups.
+  auto igs = std::move(*raw_request->mutable_interest_group_for_bidding());
+  raw_request->clear_interest_group_for_bidding();
+  raw_request->clear_bidding_signals();
+  requests.reserve(num_requests);
+  for (int i = 0, begin = 0; i < num_requests; begin = ends[i++]) {
+    auto request = std::make_unique<GenerateBidsRawRequest>(*raw_request);
+    request->mutable_interest_group_for_bidding()->Reserve(ends[i] - begin);
+    for (int j = begin; j < ends[i]; ++j) {
+      *request->add_interest_group_for_bidding() = std::move(igs[j]);
+    }
+    request->set_bidding_signals(std::move(signals[i]));
+    requests.push_back(std::move(request));
+  }
+  return requests;
+}
+
+absl::Status PruneBiddingSignals(GenerateBidsRawRequest& raw_request) {
+  BiddingSignalsSpans spans;
+  if (absl::Status status = FindBiddingSignalsSpans(raw_request, spans);
+      !status.ok()) {
+    return status;
+  }
+  raw_request.set_bidding_signals(SliceBiddingSignals(
+      raw_request, 0, raw_request.interest_group_for_bidding_size(), spans));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterestGroupPriority> ParseInterestGroupPriority(
+    absl::string_view priority) {
+  if (priority.empty() || priority == "request_order") {
+    return InterestGroupPriority::kRequestOrder;
+  }
+  if (priority == "recency") {
+    return InterestGroupPriority::kRecency;
+  }
+  if (priority == "join_count") {
+    return InterestGroupPriority::kJoinCount;
+  }
+  if (priority == "bid_count") {
+    return InterestGroupPriority::kBidCount;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown interest group priority: ", priority));
+}
+
+int SelectInterestGroups(int max_interest_groups,
+                         InterestGroupPriority priority,
+                         BuyerInput& buyer_input) {
+  auto& interest_groups = *buyer_input.mutable_interest_groups();
+  const int num_dropped = interest_groups.size() - max_interest_groups;
+  if (max_interest_groups <= 0 || num_dropped <= 0) {
+    return 0;
+  }
+  if (priority == InterestGroupPriority::kRequestOrder) {
+    interest_groups.DeleteSubrange(max_interest_groups, num_dropped);
+    return num_dropped;
+  }
+
+  std::vector<int64_t> ranks;
+  ranks.reserve(interest_groups.size());
+  for (const BuyerInput::InterestGroup& interest_group : interest_groups) {
+    if (!interest_group.has_browser_signals()) {
+      ranks.push_back(std::numeric_limits<int64_t>::min());
+      continue;
+    }
+    const BrowserSignals& signals = interest_group.browser_signals();
+    switch (priority) {
+      case InterestGroupPriority::kRecency:
+        // Joined the fewest milliseconds ago ranks the highest.
+        ranks.push_back(-(signals.has_recency_ms() ? signals.recency_ms()
+                                                   : signals.recency() * 1000));
+        break;
+      case InterestGroupPriority::kJoinCount:
+        ranks.push_back(signals.join_count());
+        break;
+      default:
+        ranks.push_back(signals.bid_count());
+        break;
+    }
+  }
+  std::vector<int> order(interest_groups.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&ranks](int a, int b) { return ranks[a] > ranks[b]; });
+  std::vector<bool> kept(interest_groups.size());
+  for (int i = 0; i < max_interest_groups; ++i) {
+    kept[order[i]] = true;
+  }
+  // Moves the interest groups kept to the front, in their order.
+  int num_kept = 0;
+  for (int i = 0; i < interest_groups.size(); ++i) {
+    if (kept[i]) {
+      if (i != num_kept) {
+        interest_groups.SwapElements(i, num_kept);
+      }
+      ++num_kept;
+    }
+  }
+  interest_groups.DeleteSubrange(num_kept, num_dropped);
+  return num_dropped;
+}
+
 std::unique_ptr<GenerateProtectedAppSignalsBidsRawRequest>
 CreateGenerateProtectedAppSignalsBidsRawRequest(
     const GetBidsRawRequest& raw_request) {
@@ -20,9 +20,12 @@
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/buyer_frontend_service/data/bidding_signals.h"
+#include "services/buyer_frontend_service/data/get_bids_config.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -40,6 +43,46 @@ CreateGenerateBidsRawRequest(
     std::unique_ptr<BiddingSignals> bidding_signals,
     const server_common::LogContext& log_context);
 
+// Same as above, but moves the interest groups out of `buyer_input` instead of
+// copying them, so that the user bidding signals and ad render ids of large
+// requests are not copied on the way to the bidding server.
+std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+CreateGenerateBidsRawRequest(
+    const GetBidsRequest::GetBidsRawRequest& get_bid_raw_request,
+    BuyerInput&& buyer_input, std::unique_ptr<BiddingSignals> bidding_signals,
+    const server_common::LogContext& log_context);
+
+// Splits a bidding request into requests of at most
+// `max_interest_groups_per_request` interest groups each, so that they can be
+// sent to different bidding servers in parallel. The requests keep the other
+// fields of `raw_request`, and only the trusted bidding signals of the keys
+// and interest groups they hold. Returns `raw_request` unsplit if it is small
+// enough, if the max is not positive or if the signals cannot be parsed.
+std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+SplitGenerateBidsRawRequest(
+    std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest> raw_request,
+    int max_interest_groups_per_request);
+
+// Replaces the trusted bidding signals of the request with only the signals of
+// the keys and interest groups it holds. Returns an error, leaving the signals
+// unchanged, if they cannot be parsed.
+absl::Status PruneBiddingSignals(
+    GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+// Parses an InterestGroupPriority: "request_order" (or ""), "recency",
+// "join_count" or "bid_count".
+absl::StatusOr<InterestGroupPriority> ParseInterestGroupPriority(
+    absl::string_view priority);
+
+// Keeps the `max_interest_groups` interest groups of `buyer_input` with the
+// highest `priority`, in their order in the request, and drops the others.
+// Ties are broken by the order in the request. Interest groups without
+// browser signals rank last by any priority but kRequestOrder. Returns the
+// number of interest groups dropped, none if the max is not positive.
+int SelectInterestGroups(int max_interest_groups,
+                         InterestGroupPriority priority,
+                         BuyerInput& buyer_input);
+
 // Creates a request to generate bid for protected app signals.
 std::unique_ptr<GenerateProtectedAppSignalsBidsRequest::
                     GenerateProtectedAppSignalsBidsRawRequest>
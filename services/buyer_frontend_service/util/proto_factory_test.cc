@@ -14,7 +14,11 @@
 
 #include "services/buyer_frontend_service/util/proto_factory.h"
 
+#include <string>
+#include <vector>
+
 #include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
@@ -235,6 +239,33 @@ TEST(CreateGenerateBidsRequestTest, SetsTopLevelSellerForComponentAuction) {
   EXPECT_EQ(input.top_level_seller(), raw_output->top_level_seller());
 }
 
+TEST(CreateGenerateBidsRequestTest, MovingBuyerInputMatchesCopyingIt) {
+  GetBidsRequest::GetBidsRawRequest input;
+  input.set_auction_signals(MakeARandomString());
+  auto* igs = input.mutable_buyer_input()->mutable_interest_groups();
+  igs->AddAllocated(MakeARandomInterestGroupFromBrowser().release());
+  igs->AddAllocated(MakeARandomInterestGroupFromAndroid().release());
+  const std::string bidding_signals = MakeARandomString();
+  auto make_bidding_signals = [&bidding_signals]() {
+    auto signals = std::make_unique<BiddingSignals>();
+    signals->trusted_signals = std::make_unique<std::string>(bidding_signals);
+    return signals;
+  };
+
+  auto copied = CreateGenerateBidsRawRequest(input, input.buyer_input(),
+                                             make_bidding_signals(),
+                                             server_common::LogContext{});
+  auto moved = CreateGenerateBidsRawRequest(
+      input, std::move(*input.mutable_buyer_input()), make_bidding_signals(),
+      server_common::LogContext{});
+
+  std::string difference;
+  MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&difference);
+  EXPECT_TRUE(differencer.Compare(*copied, *moved)) << difference;
+  ASSERT_EQ(moved->interest_group_for_bidding_size(), 2);
+}
+
 TEST(CreateGenerateBidsRequestTest, SetsEmptyBiddingSignalKeysForBrowserIG) {
   GetBidsRequest::GetBidsRawRequest input;
 
@@ -481,5 +512,189 @@ TEST(CreateGenerateProtectedAppSignalsBidsRawRequestTest,
       kTestContextualPasAdRenderId);
 }
 
+GenBidsRawReq MakeGenerateBidsRawRequestWithIgs(int num_igs) {
+  GenBidsRawReq raw_request;
+  raw_request.set_auction_signals("auction_signals");
+  raw_request.set_seller(kTestSeller);
+  std::string keys;
+  std::string per_ig_data;
+  for (int i = 0; i < num_igs; ++i) {
+    auto* ig = raw_request.add_interest_group_for_bidding();
+    ig->set_name(absl::StrCat("ig_", i));
+    ig->add_trusted_bidding_signals_keys(absl::StrCat("key_", i));
+    ig->add_trusted_bidding_signals_keys("shared_key");
+    absl::StrAppend(&keys, "\"key_", i, "\":", i, ",");
+    absl::StrAppend(&per_ig_data, i > 0 ? "," : "", "\"ig_", i,
+                    "\":{\"priorityVector\":{\"x\":", i, "}}");
+  }
+  raw_request.set_bidding_signals(
+      absl::StrCat("{\"keys\":{", keys, "\"shared_key\":[1,2]},",
+                   "\"perInterestGroupData\":{", per_ig_data, "}}"));
+  return raw_request;
+}
+
+TEST(SplitGenerateBidsRawRequestTest, DoesNotSplitSmallRequests) {
+  auto raw_request = std::make_unique<GenBidsRawReq>(
+      MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/3));
+  const std::string bidding_signals = raw_request->bidding_signals();
+
+  auto requests = SplitGenerateBidsRawRequest(
+      std::move(raw_request), /*max_interest_groups_per_request=*/3);
+
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0]->interest_group_for_bidding_size(), 3);
+  EXPECT_EQ(requests[0]->bidding_signals(), bidding_signals);
+}
+
+TEST(SplitGenerateBidsRawRequestTest, DoesNotSplitWithoutMax) {
+  auto requests = SplitGenerateBidsRawRequest(
+      std::make_unique<GenBidsRawReq>(
+          MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/3)),
+      /*max_interest_groups_per_request=*/0);
+
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0]->interest_group_for_bidding_size(), 3);
+}
+
+TEST(SplitGenerateBidsRawRequestTest, SplitsIgsEvenlyWithTheirSignals) {
+  auto requests = SplitGenerateBidsRawRequest(
+      std::make_unique<GenBidsRawReq>(
+          MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/5)),
+      /*max_interest_groups_per_request=*/2);
+
+  ASSERT_EQ(requests.size(), 3);
+  EXPECT_EQ(requests[0]->interest_group_for_bidding_size(), 2);
+  EXPECT_EQ(requests[1]->interest_group_for_bidding_size(), 2);
+  EXPECT_EQ(requests[2]->interest_group_for_bidding_size(), 1);
+  EXPECT_EQ(requests[1]->interest_group_for_bidding(0).name(), "ig_2");
+  EXPECT_EQ(requests[1]->bidding_signals(),
+            R"({"keys":{"key_2":2,"shared_key":[1,2],"key_3":3},)"
+            R"("perInterestGroupData":{"ig_2":{"priorityVector":{"x":2}},)"
+            R"("ig_3":{"priorityVector":{"x":3}}}})");
+  for (const auto& request : requests) {
+    EXPECT_EQ(request->auction_signals(), "auction_signals");
+    EXPECT_EQ(request->seller(), kTestSeller);
+  }
+}
+
+TEST(SplitGenerateBidsRawRequestTest, DoesNotSplitMalformedSignals) {
+  auto raw_request = std::make_unique<GenBidsRawReq>(
+      MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/3));
+  raw_request->set_bidding_signals("{\"keys\":");
+
+  auto requests = SplitGenerateBidsRawRequest(
+      std::move(raw_request), /*max_interest_groups_per_request=*/1);
+
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0]->bidding_signals(), "{\"keys\":");
+}
+
+TEST(PruneBiddingSignalsTest, KeepsOnlySignalsOfInterestGroups) {
+  GenBidsRawReq raw_request = MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/2);
+  raw_request.set_bidding_signals(
+      R"({"keys":{"unused":1,"key_1":{"a":1},"shared_key":2,"key_0":0},)"
+      R"("perInterestGroupData":{"ig_1":{},"other_ig":{}}})");
+
+  ASSERT_TRUE(PruneBiddingSignals(raw_request).ok());
+
+  EXPECT_EQ(raw_request.bidding_signals(),
+            R"({"keys":{"key_0":0,"shared_key":2,"key_1":{"a":1}},)"
+            R"("perInterestGroupData":{"ig_1":{}}})");
+}
+
+TEST(PruneBiddingSignalsTest, FailsOnMissingKeys) {
+  GenBidsRawReq raw_request = MakeGenerateBidsRawRequestWithIgs(/*num_igs=*/1);
+  raw_request.set_bidding_signals(R"({"perInterestGroupData":{}})");
+
+  EXPECT_FALSE(PruneBiddingSignals(raw_request).ok());
+  EXPECT_EQ(raw_request.bidding_signals(), R"({"perInterestGroupData":{}})");
+}
+
+// Buyer input with interest groups "ig_<i>" joined `join_counts[i]` times,
+// without browser signals for negative counts.
+BuyerInput MakeBuyerInputWithJoinCounts(const std::vector<int>& join_counts) {
+  BuyerInput buyer_input;
+  for (size_t i = 0; i < join_counts.size(); ++i) {
+    auto* interest_group = buyer_input.add_interest_groups();
+    interest_group->set_name(absl::StrCat("ig_", i));
+    if (join_counts[i] >= 0) {
+      interest_group->mutable_browser_signals()->set_join_count(
+          join_counts[i]);
+    }
+  }
+  return buyer_input;
+}
+
+std::vector<std::string> InterestGroupNames(const BuyerInput& buyer_input) {
+  std::vector<std::string> names;
+  for (const auto& interest_group : buyer_input.interest_groups()) {
+    names.push_back(interest_group.name());
+  }
+  return names;
+}
+
+TEST(SelectInterestGroupsTest, KeepsHighestPriorityInRequestOrder) {
+  BuyerInput buyer_input = MakeBuyerInputWithJoinCounts({1, 5, -1, 5, 9, 2});
+
+  EXPECT_EQ(SelectInterestGroups(/*max_interest_groups=*/3,
+                                 InterestGroupPriority::kJoinCount,
+                                 buyer_input),
+            3);
+
+  EXPECT_EQ(InterestGroupNames(buyer_input),
+            (std::vector<std::string>{"ig_1", "ig_3", "ig_4"}));
+}
+
+TEST(SelectInterestGroupsTest, KeepsFirstInterestGroupsInRequestOrder) {
+  BuyerInput buyer_input = MakeBuyerInputWithJoinCounts({1, 5, 9});
+
+  EXPECT_EQ(SelectInterestGroups(/*max_interest_groups=*/2,
+                                 InterestGroupPriority::kRequestOrder,
+                                 buyer_input),
+            1);
+
+  EXPECT_EQ(InterestGroupNames(buyer_input),
+            (std::vector<std::string>{"ig_0", "ig_1"}));
+}
+
+TEST(SelectInterestGroupsTest, RanksMostRecentlyJoinedFirst) {
+  BuyerInput buyer_input = MakeBuyerInputWithJoinCounts({0, 0, 0});
+  auto& interest_groups = *buyer_input.mutable_interest_groups();
+  interest_groups[0].mutable_browser_signals()->set_recency(2);
+  interest_groups[1].mutable_browser_signals()->set_recency_ms(1500);
+  interest_groups[2].mutable_browser_signals()->set_recency(1);
+
+  SelectInterestGroups(/*max_interest_groups=*/1,
+                       InterestGroupPriority::kRecency, buyer_input);
+
+  EXPECT_EQ(InterestGroupNames(buyer_input),
+            (std::vector<std::string>{"ig_2"}));
+}
+
+TEST(SelectInterestGroupsTest, KeepsAllWithinMaxOrWithoutMax) {
+  BuyerInput buyer_input = MakeBuyerInputWithJoinCounts({1, 5});
+  EXPECT_EQ(SelectInterestGroups(/*max_interest_groups=*/2,
+                                 InterestGroupPriority::kJoinCount,
+                                 buyer_input),
+            0);
+  EXPECT_EQ(SelectInterestGroups(/*max_interest_groups=*/0,
+                                 InterestGroupPriority::kJoinCount,
+                                 buyer_input),
+            0);
+  EXPECT_EQ(buyer_input.interest_groups_size(), 2);
+}
+
+TEST(ParseInterestGroupPriorityTest, ParsesKnownPriorities) {
+  EXPECT_EQ(*ParseInterestGroupPriority(""),
+            InterestGroupPriority::kRequestOrder);
+  EXPECT_EQ(*ParseInterestGroupPriority("recency"),
+            InterestGroupPriority::kRecency);
+  EXPECT_EQ(*ParseInterestGroupPriority("join_count"),
+            InterestGroupPriority::kJoinCount);
+  EXPECT_EQ(*ParseInterestGroupPriority("bid_count"),
+            InterestGroupPriority::kBidCount);
+  EXPECT_FALSE(ParseInterestGroupPriority("priority").ok());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
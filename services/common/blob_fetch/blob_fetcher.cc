@@ -14,12 +14,18 @@
 
 #include "services/common/blob_fetch/blob_fetcher.h"
 
+#include <algorithm>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/synchronization/notification.h"
 #include "src/core/interface/async_context.h"
 #include "src/core/interface/errors.h"
@@ -39,13 +45,14 @@ using ::google::scp::core::errors::GetErrorMessage;
 using ::google::scp::cpio::BlobStorageClientInterface;
 
 namespace privacy_sandbox::bidding_auction_servers {
-
 BlobFetcher::BlobFetcher(
     absl::string_view bucket_name, server_common::Executor* executor,
-    std::unique_ptr<BlobStorageClientInterface> blob_storage_client)
+    std::unique_ptr<BlobStorageClientInterface> blob_storage_client,
+    BlobFetchOptions options)
     : bucket_name_(bucket_name),
       executor_(executor),
-      blob_storage_client_(std::move(blob_storage_client)) {
+      blob_storage_client_(std::move(blob_storage_client)),
+      options_(std::move(options)) {
   absl::Status status = blob_storage_client_->Init();
   CHECK(status.ok()) << "Failed to init BlobStorageClient: " << status;
   status = blob_storage_client_->Run();
@@ -105,44 +112,122 @@ absl::Status BlobFetcher::InternalFetch() {
   // Checks the error from the callback.
   PS_RETURN_IF_ERROR(status);
 
-  std::vector<Blob> new_file_snapshot;
+  // Sorts the blobs by path, so that the blobs under a path are adjacent in
+  // the snapshot.
+  std::sort(blob_names.begin(), blob_names.end());
+  if (!options_.included_prefixes.empty()) {
+    blob_names.erase(
+        std::remove_if(blob_names.begin(), blob_names.end(),
+                       [this](const std::string& blob_name) {
+                         return std::none_of(
+                             options_.included_prefixes.begin(),
+                             options_.included_prefixes.end(),
+                             [&blob_name](const std::string& prefix) {
+                               return absl::StartsWith(blob_name, prefix);
+                             });
+                       }),
+        blob_names.end());
+  }
+
+  // Blobs of the previous snapshot are kept as is in the only_new_blobs mode,
+  // by index in the snapshot.
+  std::vector<std::optional<size_t>> kept(blob_names.size());
+  if (options_.only_new_blobs) {
+    for (size_t i = 0; i < blob_names.size(); ++i) {
+      auto it = std::lower_bound(
+          snapshot_.begin(), snapshot_.end(), blob_names[i],
+          [](const Blob& blob, const std::string& path) {
+            return blob.path < path;
+          });
+      if (it != snapshot_.end() && it->path == blob_names[i]) {
+        kept[i] = it - snapshot_.begin();
+      }
+    }
+  }
 
-  // Fetches all the blobs in the bucket.
-  // TODO(b/329674737): Fetch blobs in parallel.
-  for (const std::string& blob_name : blob_names) {
-    absl::Notification per_blob_notification;
+  // Fetches the other blobs, with up to max_concurrent_fetches of them in
+  // flight at a time.
+  std::vector<std::string> blob_bytes(blob_names.size());
+  absl::Mutex mu;
+  int in_flight = 0;
+  std::vector<bool> done(blob_names.size(), false);
+  absl::Status fetch_status;
+  const int max_in_flight = std::max(options_.max_concurrent_fetches, 1);
+  auto can_issue = [&]() {
+    return in_flight < max_in_flight || !fetch_status.ok();
+  };
+  auto all_done = [&]() { return in_flight == 0; };
+  for (size_t i = 0; i < blob_names.size(); ++i) {
+    if (kept[i].has_value()) {
+      continue;
+    }
+    {
+      absl::MutexLock lock(&mu);
+      mu.Await(absl::Condition(&can_issue));
+      // We stop issuing fetches once one of them failed.
+      if (!fetch_status.ok()) {
+        break;
+      }
+      ++in_flight;
+    }
     auto get_blob_request = std::make_shared<GetBlobRequest>();
     get_blob_request->mutable_blob_metadata()->set_bucket_name(bucket_name_);
-    get_blob_request->mutable_blob_metadata()->set_blob_name(blob_name);
-
+    get_blob_request->mutable_blob_metadata()->set_blob_name(blob_names[i]);
+
+    // Marks the fetch of the blob done, once.
+    auto finish = [&mu, &in_flight, &done, &fetch_status, i](
+                      absl::Status status) {
+      absl::MutexLock lock(&mu);
+      if (!done[i]) {
+        done[i] = true;
+        --in_flight;
+        fetch_status.Update(std::move(status));
+      }
+    };
+    std::string& bytes = blob_bytes[i];
     AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
-        get_blob_request,
-        [&status, &new_file_snapshot, &per_blob_notification](auto& context) {
+        get_blob_request, [&bytes, finish](auto& context) {
           if (!context.result.Successful()) {
             PS_LOG(ERROR) << "Failed to fetch blobs: "
                           << GetErrorMessage(context.result.status_code);
-            status = absl::InternalError("Failed to fetch blobs");
-          } else {
-            // Should not log blob().data(), which can be very large bytes.
-            PS_VLOG(10) << "BlobStorageClient GetBlob() Response: "
-                        << context.response->blob().metadata().DebugString();
-
-            const std::string& path =
-                context.response->blob().metadata().blob_name();
-            const std::string& bytes = context.response->blob().data();
-            new_file_snapshot.emplace_back(path, bytes);
+            finish(absl::InternalError("Failed to fetch blobs"));
+            return;
           }
-          // TODO(b/316960066): Inspect the BlobStorageClient code and fix bugs.
-          per_blob_notification.Notify();
+          // Should not log blob().data(), which can be very large bytes.
+          PS_VLOG(10) << "BlobStorageClient GetBlob() Response: "
+                      << context.response->blob().metadata().DebugString();
+          // Takes the bytes from the response without copying them.
+          bytes = std::move(*context.response->mutable_blob()->mutable_data());
+          // TODO(b/316960066): Inspect the BlobStorageClient code and fix
+          // bugs.
+          finish(absl::OkStatus());
         });
 
-    // If GetBlob fails fast, we return the error early. We update the file
-    // snapshot only when all the file fetching is successfully done.
-    PS_RETURN_IF_ERROR(blob_storage_client_->GetBlob(get_blob_context));
-    per_blob_notification.WaitForNotification();
+    // If GetBlob fails fast, its callback may not be called.
+    if (absl::Status get_blob_status =
+            blob_storage_client_->GetBlob(get_blob_context);
+        !get_blob_status.ok()) {
+      finish(std::move(get_blob_status));
+    }
+  }
+  {
+    // Waits for the fetches in flight, whose callbacks refer to this frame.
+    absl::MutexLock lock(&mu);
+    mu.Await(absl::Condition(&all_done));
+    // We update the file snapshot only when all the file fetching is
+    // successfully done.
+    PS_RETURN_IF_ERROR(fetch_status);
+  }
 
-    // Checks the error from the callback.
-    PS_RETURN_IF_ERROR(status);
+  std::vector<Blob> new_file_snapshot;
+  new_file_snapshot.reserve(blob_names.size());
+  for (size_t i = 0; i < blob_names.size(); ++i) {
+    if (kept[i].has_value()) {
+      new_file_snapshot.push_back(std::move(snapshot_[*kept[i]]));
+    } else {
+      new_file_snapshot.emplace_back(std::move(blob_names[i]),
+                                     std::move(blob_bytes[i]));
+    }
   }
 
   // All the blobs are successfully fetched.
@@ -28,6 +28,18 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+struct BlobFetchOptions {
+  // Only fetches the blobs whose path starts with one of the prefixes, or all
+  // the blobs if empty.
+  std::vector<std::string> included_prefixes;
+  // Only fetches the blobs missing from the last snapshot, and keeps the
+  // others as is. For buckets whose blobs are never overwritten, such as
+  // versioned code or model paths, so that refreshes skip unchanged blobs.
+  bool only_new_blobs = false;
+  // Maximum number of blobs fetched at a time.
+  int max_concurrent_fetches = 16;
+};
+
 // Blob fetching system to read AdTech's files from the cloud storage buckets.
 // TODO(b/316960066): Support periodic fetching.
 // TODO(b/316960066): Write the common lib with PeriodicBucketFetcher
@@ -38,20 +50,22 @@ class BlobFetcher {
     std::string path;
     std::string bytes;
 
-    Blob(const std::string& path, const std::string& bytes)
-        : path(path), bytes(bytes) {}
+    Blob(std::string path, std::string bytes)
+        : path(std::move(path)), bytes(std::move(bytes)) {}
   };
 
   // Constructs a new BlobFetcher.
   // `bucket_name`: The cloud storage bucket name to read from.
   BlobFetcher(absl::string_view bucket_name, server_common::Executor* executor,
               std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
-                  blob_storage_client);
+                  blob_storage_client,
+              BlobFetchOptions options = {});
 
   // Not copyable or movable.
   BlobFetcher(const BlobFetcher&) = delete;
   BlobFetcher& operator=(const BlobFetcher&) = delete;
 
+  // Returns the blobs of the last fetch, sorted by path.
   const std::vector<Blob>& snapshot() const { return snapshot_; }
 
   // Fetches the bucket synchronously.
@@ -66,7 +80,8 @@ class BlobFetcher {
   server_common::Executor* executor_;  // not owned
   std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
       blob_storage_client_;
-  // Keeps the latest snapshot of the storage bucket.
+  const BlobFetchOptions options_;
+  // Keeps the latest snapshot of the storage bucket, sorted by path.
   std::vector<Blob> snapshot_;
 };
 
@@ -15,8 +15,11 @@
 #include "services/common/blob_fetch/blob_fetcher.h"
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
@@ -96,6 +99,125 @@ TEST(BlobFetcherTest, FetchBucket) {
   EXPECT_TRUE(bucket_fetcher.FetchSync().ok());
 }
 
+TEST(BlobFetcherTest, FetchBucket_SnapshotSortedByPath) {
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+
+  EXPECT_CALL(*blob_storage_client, Run).WillOnce([]() {
+    return absl::OkStatus();
+  });
+
+  EXPECT_CALL(*executor, Run).WillOnce([](absl::AnyInvocable<void()> closure) {
+    closure();
+  });
+
+  EXPECT_CALL(*blob_storage_client, ListBlobsMetadata)
+      .WillOnce(
+          [](AsyncContext<ListBlobsMetadataRequest, ListBlobsMetadataResponse>
+                 async_context) {
+            async_context.response =
+                std::make_shared<ListBlobsMetadataResponse>();
+            for (const char* blob_name : {"c", "a", "b"}) {
+              async_context.response->add_blob_metadatas()->set_blob_name(
+                  blob_name);
+            }
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+
+            return absl::OkStatus();
+          });
+
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .Times(3)
+      .WillRepeatedly(
+          [](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+            async_context.response = std::make_shared<GetBlobResponse>();
+            async_context.response->mutable_blob()->set_data(
+                absl::StrCat(async_context.request->blob_metadata().blob_name(),
+                             kSampleData));
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+
+            return absl::OkStatus();
+          });
+
+  BlobFetcher bucket_fetcher(kSampleBucketName, executor.get(),
+                             std::move(blob_storage_client));
+  ASSERT_TRUE(bucket_fetcher.FetchSync().ok());
+  const std::vector<BlobFetcher::Blob>& snapshot = bucket_fetcher.snapshot();
+  ASSERT_EQ(snapshot.size(), 3);
+  EXPECT_EQ(snapshot[0].path, "a");
+  EXPECT_EQ(snapshot[0].bytes, "atest");
+  EXPECT_EQ(snapshot[1].path, "b");
+  EXPECT_EQ(snapshot[1].bytes, "btest");
+  EXPECT_EQ(snapshot[2].path, "c");
+  EXPECT_EQ(snapshot[2].bytes, "ctest");
+}
+
+TEST(BlobFetcherTest, FetchBucket_OnlyNewBlobsUnderPrefixes) {
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+
+  EXPECT_CALL(*blob_storage_client, Run).WillOnce([]() {
+    return absl::OkStatus();
+  });
+
+  EXPECT_CALL(*executor, Run)
+      .Times(2)
+      .WillRepeatedly(
+          [](absl::AnyInvocable<void()> closure) { closure(); });
+
+  std::vector<std::string> blob_names = {"models/1", "other"};
+  EXPECT_CALL(*blob_storage_client, ListBlobsMetadata)
+      .Times(2)
+      .WillRepeatedly(
+          [&blob_names](AsyncContext<ListBlobsMetadataRequest,
+                                     ListBlobsMetadataResponse>
+                            async_context) {
+            async_context.response =
+                std::make_shared<ListBlobsMetadataResponse>();
+            for (const std::string& blob_name : blob_names) {
+              async_context.response->add_blob_metadatas()->set_blob_name(
+                  blob_name);
+            }
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+
+            return absl::OkStatus();
+          });
+
+  std::vector<std::string> fetched;
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .Times(2)
+      .WillRepeatedly(
+          [&fetched](
+              AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+            fetched.push_back(
+                async_context.request->blob_metadata().blob_name());
+            async_context.response = std::make_shared<GetBlobResponse>();
+            async_context.response->mutable_blob()->set_data(kSampleData);
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+
+            return absl::OkStatus();
+          });
+
+  BlobFetcher bucket_fetcher(
+      kSampleBucketName, executor.get(), std::move(blob_storage_client),
+      {.included_prefixes = {"models/"}, .only_new_blobs = true});
+  ASSERT_TRUE(bucket_fetcher.FetchSync().ok());
+  ASSERT_EQ(bucket_fetcher.snapshot().size(), 1);
+
+  blob_names = {"models/1", "models/2", "other"};
+  ASSERT_TRUE(bucket_fetcher.FetchSync().ok());
+  EXPECT_EQ(fetched, (std::vector<std::string>{"models/1", "models/2"}));
+  const std::vector<BlobFetcher::Blob>& snapshot = bucket_fetcher.snapshot();
+  ASSERT_EQ(snapshot.size(), 2);
+  EXPECT_EQ(snapshot[0].path, "models/1");
+  EXPECT_EQ(snapshot[0].bytes, kSampleData);
+  EXPECT_EQ(snapshot[1].path, "models/2");
+}
+
 TEST(BlobFetcherTest, FetchBucket_Failure) {
   auto executor = std::make_unique<MockExecutor>();
   auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
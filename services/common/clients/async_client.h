@@ -17,11 +17,13 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "services/common/util/request_cancellation.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -59,6 +61,18 @@ class AsyncClient {
       absl::Duration timeout) const {
     return absl::NotFoundError("Method not implemented.");
   }
+
+  // Same as above, but the request is cancelled once `cancellation` is, if
+  // the client supports it. Otherwise it runs to completion.
+  virtual absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout,
+      std::shared_ptr<RequestCancellation> cancellation) const {
+    return ExecuteInternal(std::move(request), metadata, std::move(on_done),
+                           timeout);
+  }
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
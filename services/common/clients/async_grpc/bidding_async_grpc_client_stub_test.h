@@ -148,11 +148,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithRequest) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, /* public_key_fetcher= */ nullptr);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
 
   auto status = class_under_test.ExecuteInternal(
@@ -205,11 +206,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithMetadata) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, /* public_key_fetcher= */ nullptr);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
   auto status = class_under_test.ExecuteInternal(
       std::make_unique<RawRequest>(), sent_metadata,
@@ -257,11 +259,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, PassesStatusToCallback) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, CreatePublicKeyFetcher(this->config_client_));
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
 
   auto status = class_under_test.ExecuteInternal(
@@ -317,11 +320,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithTimeout) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, CreatePublicKeyFetcher(this->config_client_));
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   auto status = class_under_test.ExecuteInternal(
       std::move(input_request_ptr), {},
       [&notification](
@@ -366,11 +370,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, PassesResponseToCallback) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, CreatePublicKeyFetcher(this->config_client_));
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
@@ -415,11 +420,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, DoesNotExecuteCallbackOnSyncError) {
   SetupMockCryptoClientError(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, CreatePublicKeyFetcher(this->config_client_));
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
@@ -465,11 +471,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, ExecutesCallbackOnTimeout) {
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(
       this->config_client_, CreatePublicKeyFetcher(this->config_client_));
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  auto stub_pool =
+      GrpcStubPool<typename ServiceType::Stub>::template Create<ServiceType>(
+          client_config.server_addr, client_config.compression,
+          client_config.secure_client, client_config.channel_pool);
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, stub_pool.get());
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
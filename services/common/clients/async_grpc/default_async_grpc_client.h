@@ -17,12 +17,15 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "absl/log/check.h"
 #include "services/common/clients/async_client.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
 #include "services/common/clients/async_grpc/grpc_client_utils.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "services/common/clients/client_params.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 #include "services/common/util/error_categories.h"
@@ -70,11 +73,27 @@ class DefaultAsyncGrpcClient
   DefaultAsyncGrpcClient(const DefaultAsyncGrpcClient&) = delete;
   DefaultAsyncGrpcClient& operator=(const DefaultAsyncGrpcClient&) = delete;
 
+  // Picks the compression of every request by the size of its payload
+  // instead of using that of the channel.
+  void SetCompressionPolicy(const GrpcCompressionPolicy& compression_policy) {
+    compression_policy_ = compression_policy;
+  }
+
   absl::Status ExecuteInternal(
       std::unique_ptr<RawRequest> raw_request, const RequestMetadata& metadata,
       absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
           on_done,
       absl::Duration timeout = max_timeout) const override {
+    return ExecuteInternal(std::move(raw_request), metadata, std::move(on_done),
+                           timeout, /*cancellation=*/nullptr);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> raw_request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout,
+      std::shared_ptr<RequestCancellation> cancellation) const override {
     PS_VLOG(6) << "Raw request:\n" << raw_request->DebugString();
     PS_VLOG(5) << "Encrypting request ...";
     auto secret_request = EncryptRequestWithHpke<RawRequest, Request>(
@@ -88,10 +107,16 @@ class DefaultAsyncGrpcClient
     auto& [hpke_secret, request] = *secret_request;
     PS_VLOG(5) << "Encryption completed ...";
 
+    const int64_t payload_bytes = request->request_ciphertext().size();
     auto params =
         std::make_unique<RawClientParams<Request, Response, RawResponse>>(
             std::move(request), std::move(on_done), metadata);
     params->SetDeadline(std::min(max_timeout, timeout));
+    if (compression_policy_.has_value()) {
+      params->SetCompressionAlgorithm(
+          ChooseGrpcCompression(*compression_policy_, payload_bytes));
+    }
+    params->SetCancellation(std::move(cancellation));
     PS_VLOG(5) << "Sending RPC ...";
     SendRpc(hpke_secret, params.release());
     return absl::OkStatus();
@@ -126,8 +151,13 @@ class DefaultAsyncGrpcClient
       return absl::InternalError(error);
     }
 
+    // The response stays alive until the caller is done with the decrypted
+    // one, so its ciphertext, as large as the payload, is freed right away.
+    std::string().swap(*response->mutable_response_ciphertext());
+
+    const std::string& payload = decrypt_response->payload();
     std::unique_ptr<RawResponse> raw_response = std::make_unique<RawResponse>();
-    if (!raw_response->ParseFromString(decrypt_response->payload())) {
+    if (!raw_response->ParseFromArray(payload.data(), payload.size())) {
       const std::string error_msg =
           "Failed to parse proto from decrypted response";
       return absl::InvalidArgumentError(error_msg);
@@ -142,6 +172,7 @@ class DefaultAsyncGrpcClient
   CryptoClientWrapperInterface* crypto_client_;
 
   server_common::CloudPlatform cloud_platform_;
+  std::optional<GrpcCompressionPolicy> compression_policy_;
 };
 
 // Creates a shared grpc channel from a given server URL. This channel
@@ -155,18 +186,7 @@ inline std::shared_ptr<grpc::Channel> CreateChannel(
     // to argument for grpc::CreateChannel.
     absl::string_view server_addr, bool compression = false,
     bool secure = true) {
-  std::shared_ptr<grpc::ChannelCredentials> creds =
-      secure ? grpc::SslCredentials(grpc::SslCredentialsOptions())
-             : grpc::InsecureChannelCredentials();
-  grpc::ChannelArguments args;
-  // Set max message size to 256 MB.
-  args.SetMaxSendMessageSize(256L * 1024L * 1024L);
-  args.SetMaxReceiveMessageSize(256L * 1024L * 1024L);
-  if (compression) {
-    // Set the default compression algorithm for the channel.
-    args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
-  }
-  return grpc::CreateCustomChannel(server_addr.data(), creds, args);
+  return CreateChannels(server_addr, compression, secure, {}).front();
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
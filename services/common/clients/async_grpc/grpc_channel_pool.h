@@ -0,0 +1,391 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_CHANNEL_POOL_H_
+#define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_CHANNEL_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "services/common/util/backend_load.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// How the pool picks the channel for the next RPC.
+enum class ChannelPickPolicy {
+  // Cycles through the channels.
+  kRoundRobin,
+  // Picks the channel with the fewest RPCs in flight, so that a connection
+  // slowed down by a few large responses does not hold up the others.
+  kLeastOutstanding,
+};
+
+// Address of the backend within one of its zones, e.g. of a zonal load
+// balancer.
+struct ZonalAddress {
+  std::string zone;
+  std::string address;
+};
+
+struct GrpcChannelPoolConfig {
+  // Number of channels, each with its own HTTP/2 connection to the backend.
+  // A single connection caps the number of concurrent streams and serializes
+  // all the RPCs on one TCP flow.
+  int num_channels = 1;
+  ChannelPickPolicy pick_policy = ChannelPickPolicy::kLeastOutstanding;
+  // Interval of the HTTP/2 keepalive pings, which keep idle connections warm
+  // through load balancers. Disabled if zero.
+  absl::Duration keepalive_time = absl::ZeroDuration();
+  absl::Duration keepalive_timeout = absl::Seconds(20);
+  // Initial HTTP/2 stream window. The gRPC default if zero.
+  int http2_stream_window_bytes = 0;
+  // Addresses of the backend in each of its zones, which the pool connects to
+  // instead of the server address if set. Each address gets num_channels
+  // channels.
+  std::vector<ZonalAddress> zonal_addresses;
+  // Zone of this server. RPCs go to the channels of the backend in this zone
+  // first, to save the latency and the egress cost of cross-zone hops.
+  std::string local_zone;
+  // Affinity of the RPCs to the local zone: an RPC spills over to another
+  // zone once the local channel picked has this many more RPCs in flight than
+  // the channel picked among the other zones. 0 balances the load across the
+  // zones, preferring the local one on ties. Negative keeps every RPC in the
+  // local zone.
+  int zone_spillover_rpcs = 0;
+  // Roma wait, as reported by the backend in the kBackendLoadMetadataKey of
+  // its responses, that weighs as much as one more RPC in flight on its
+  // channel. Lets kLeastOutstanding keep RPCs away from backends pinned on
+  // slow scripts. Load reports are ignored if zero.
+  absl::Duration load_report_wait_per_rpc = absl::ZeroDuration();
+  // Age past which a load report is ignored, so that a backend which stopped
+  // getting RPCs because it was busy is tried again.
+  absl::Duration load_report_ttl = absl::Seconds(1);
+};
+
+// Parses zonal addresses listed as `zone=address,...`, e.g.
+// "us-central1-a=bidding-a.internal:443,us-central1-b=bidding-b.internal:443".
+inline absl::StatusOr<std::vector<ZonalAddress>> ParseZonalAddresses(
+    absl::string_view zonal_addresses) {
+  std::vector<ZonalAddress> parsed;
+  for (absl::string_view entry :
+       absl::StrSplit(zonal_addresses, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> zone_address =
+        absl::StrSplit(entry, absl::MaxSplits('=', 1));
+    absl::string_view zone = absl::StripAsciiWhitespace(zone_address.first);
+    absl::string_view address =
+        absl::StripAsciiWhitespace(zone_address.second);
+    if (zone.empty() || address.empty()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid zonal address: ", entry));
+    }
+    parsed.push_back({.zone = std::string(zone),
+                      .address = std::string(address)});
+  }
+  return parsed;
+}
+
+// Creates the channels of a pool to the given server. See CreateChannel for
+// the other arguments.
+inline std::vector<std::shared_ptr<grpc::Channel>> CreateChannels(
+    absl::string_view server_addr, bool compression, bool secure,
+    const GrpcChannelPoolConfig& pool_config) {
+  std::shared_ptr<grpc::ChannelCredentials> creds =
+      secure ? grpc::SslCredentials(grpc::SslCredentialsOptions())
+             : grpc::InsecureChannelCredentials();
+  grpc::ChannelArguments args;
+  // Set max message size to 256 MB.
+  args.SetMaxSendMessageSize(256L * 1024L * 1024L);
+  args.SetMaxReceiveMessageSize(256L * 1024L * 1024L);
+  if (compression) {
+    // Set the default compression algorithm for the channel.
+    args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
+  }
+  if (pool_config.num_channels > 1) {
+    // Channels created with the same arguments share their subchannels, and
+    // so their connection, unless each gets a pool of its own.
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  }
+  if (pool_config.keepalive_time > absl::ZeroDuration()) {
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS,
+                absl::ToInt64Milliseconds(pool_config.keepalive_time));
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS,
+                absl::ToInt64Milliseconds(pool_config.keepalive_timeout));
+    args.SetInt(GRPC_ARG_KEEPALIVE_PERMIT_WITHOUT_CALLS, 1);
+  }
+  if (pool_config.http2_stream_window_bytes > 0) {
+    args.SetInt(GRPC_ARG_HTTP2_STREAM_LOOKAHEAD_BYTES,
+                pool_config.http2_stream_window_bytes);
+  }
+
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  const int num_channels = std::max(pool_config.num_channels, 1);
+  channels.reserve(num_channels);
+  for (int i = 0; i < num_channels; ++i) {
+    channels.push_back(
+        grpc::CreateCustomChannel(server_addr.data(), creds, args));
+  }
+  return channels;
+}
+
+// Channels connected to their backend, out of a number of channels.
+struct ChannelConnectivity {
+  int num_connected = 0;
+  int num_channels = 0;
+
+  // Percent of the channels connected, 100 if there are none.
+  int ConnectedPercent() const {
+    return num_channels == 0 ? 100 : num_connected * 100 / num_channels;
+  }
+};
+
+// Connects the channels, all at once, and waits until they are connected or
+// until `deadline`. A channel is connected once it has a ready subchannel,
+// i.e. once name resolution, the TCP connection and the TLS handshake are
+// done, so the first RPCs on it do not pay for them.
+inline ChannelConnectivity ConnectChannels(
+    const std::vector<std::shared_ptr<grpc::Channel>>& channels,
+    absl::Time deadline) {
+  for (const auto& channel : channels) {
+    channel->GetState(/*try_to_connect=*/true);
+  }
+  ChannelConnectivity connectivity{.num_channels =
+                                       static_cast<int>(channels.size())};
+  for (const auto& channel : channels) {
+    if (channel->WaitForConnected(absl::ToChronoTime(deadline))) {
+      ++connectivity.num_connected;
+    }
+  }
+  return connectivity;
+}
+
+// Stubs over a pool of channels to the same backend. An RPC acquires a stub
+// before it starts and releases it once done, which keeps count of the RPCs
+// in flight on each channel. Thread-safe.
+template <typename StubT>
+class GrpcStubPool {
+ public:
+  // `in_local_zone` flags the stubs whose channel goes to the backend in the
+  // zone of this server, and is empty if all of them do. See
+  // GrpcChannelPoolConfig::zone_spillover_rpcs.
+  GrpcStubPool(std::vector<std::unique_ptr<StubT>> stubs,
+               ChannelPickPolicy pick_policy,
+               const std::vector<bool>& in_local_zone = {},
+               int zone_spillover_rpcs = 0)
+      : stubs_(std::move(stubs)),
+        outstanding_(stubs_.size()),
+        reported_rpcs_(stubs_.size()),
+        reported_at_ns_(stubs_.size()),
+        pick_policy_(pick_policy),
+        zone_spillover_rpcs_(zone_spillover_rpcs) {
+    CHECK(!stubs_.empty());
+    CHECK(in_local_zone.empty() || in_local_zone.size() == stubs_.size());
+    for (size_t i = 0; i < stubs_.size(); ++i) {
+      if (in_local_zone.empty() || in_local_zone[i]) {
+        local_.push_back(i);
+      } else {
+        remote_.push_back(i);
+      }
+    }
+  }
+
+  // Creates a stub for each of the channels with Service::NewStub.
+  template <typename Service>
+  static std::unique_ptr<GrpcStubPool> Create(
+      absl::string_view server_addr, bool compression, bool secure,
+      const GrpcChannelPoolConfig& pool_config) {
+    std::vector<std::unique_ptr<StubT>> stubs;
+    std::vector<std::shared_ptr<grpc::Channel>> channels;
+    if (pool_config.zonal_addresses.empty()) {
+      for (auto& channel :
+           CreateChannels(server_addr, compression, secure, pool_config)) {
+        stubs.push_back(Service::NewStub(channel));
+        channels.push_back(std::move(channel));
+      }
+      auto pool = std::make_unique<GrpcStubPool>(std::move(stubs),
+                                                 pool_config.pick_policy);
+      pool->WeighLoadReports(pool_config.load_report_wait_per_rpc,
+                             pool_config.load_report_ttl);
+      pool->channels_ = std::move(channels);
+      return pool;
+    }
+    std::vector<bool> in_local_zone;
+    for (const ZonalAddress& zonal : pool_config.zonal_addresses) {
+      for (auto& channel : CreateChannels(zonal.address, compression, secure,
+                                          pool_config)) {
+        stubs.push_back(Service::NewStub(channel));
+        channels.push_back(std::move(channel));
+        in_local_zone.push_back(zonal.zone == pool_config.local_zone);
+      }
+    }
+    auto pool = std::make_unique<GrpcStubPool>(
+        std::move(stubs), pool_config.pick_policy, in_local_zone,
+        pool_config.zone_spillover_rpcs);
+    pool->WeighLoadReports(pool_config.load_report_wait_per_rpc,
+                           pool_config.load_report_ttl);
+    pool->channels_ = std::move(channels);
+    return pool;
+  }
+
+  GrpcStubPool(const GrpcStubPool&) = delete;
+  GrpcStubPool& operator=(const GrpcStubPool&) = delete;
+
+  // Counts the load the backends report in the picks, see
+  // GrpcChannelPoolConfig::load_report_wait_per_rpc. To be called before the
+  // pool is used.
+  void WeighLoadReports(absl::Duration wait_per_rpc, absl::Duration ttl) {
+    load_report_wait_per_rpc_ = wait_per_rpc;
+    load_report_ttl_ = ttl;
+  }
+
+  // Picks the stub for an RPC and returns its index, to be passed to Get and
+  // to Release once the RPC is done.
+  size_t Acquire() {
+    const size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    const int64_t now_ns = load_report_wait_per_rpc_ > absl::ZeroDuration()
+                               ? absl::ToUnixNanos(absl::Now())
+                               : 0;
+    size_t picked;
+    if (local_.empty()) {
+      picked = Pick(remote_, start, now_ns);
+    } else {
+      picked = Pick(local_, start, now_ns);
+      if (!remote_.empty() && zone_spillover_rpcs_ >= 0) {
+        const size_t remote = Pick(remote_, start, now_ns);
+        if (Load(picked, now_ns) >
+            Load(remote, now_ns) + zone_spillover_rpcs_) {
+          picked = remote;
+        }
+      }
+    }
+    outstanding_[picked].fetch_add(1, std::memory_order_relaxed);
+    return picked;
+  }
+
+  StubT* Get(size_t index) const { return stubs_[index].get(); }
+
+  void Release(size_t index) {
+    outstanding_[index].fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Number of RPCs in flight on the channel.
+  int64_t Outstanding(size_t index) const {
+    return outstanding_[index].load(std::memory_order_relaxed);
+  }
+
+  // Records the load the backend of the channel reported in the initial
+  // metadata of a response, once its RPC is done.
+  void ReportLoad(size_t index, const grpc::ClientContext& context) {
+    if (load_report_wait_per_rpc_ <= absl::ZeroDuration()) {
+      return;
+    }
+    const auto& metadata = context.GetServerInitialMetadata();
+    auto it = metadata.find(kBackendLoadMetadataKey);
+    if (it == metadata.end()) {
+      return;
+    }
+    absl::StatusOr<BackendLoadReport> report = ParseBackendLoadReport(
+        absl::string_view(it->second.data(), it->second.size()));
+    if (report.ok()) {
+      RecordLoad(index, *report, absl::Now());
+    }
+  }
+
+  // Records a load report of the backend of the channel received at `now`.
+  void RecordLoad(size_t index, const BackendLoadReport& report,
+                  absl::Time now) {
+    if (load_report_wait_per_rpc_ <= absl::ZeroDuration()) {
+      return;
+    }
+    reported_rpcs_[index].store(
+        report.PredictedWait() / load_report_wait_per_rpc_,
+        std::memory_order_relaxed);
+    reported_at_ns_[index].store(absl::ToUnixNanos(now),
+                                 std::memory_order_relaxed);
+  }
+
+  size_t size() const { return stubs_.size(); }
+
+  // Channels of the stubs if the pool was made by Create, to be connected
+  // ahead of the first RPCs with ConnectChannels. Empty otherwise.
+  const std::vector<std::shared_ptr<grpc::Channel>>& channels() const {
+    return channels_;
+  }
+
+ private:
+  // Load of the channel at `now_ns`: its RPCs in flight, plus as many as the
+  // Roma wait its backend last reported weighs, unless the report is stale.
+  int64_t Load(size_t index, int64_t now_ns) const {
+    int64_t load = Outstanding(index);
+    if (now_ns - reported_at_ns_[index].load(std::memory_order_relaxed) <=
+        absl::ToInt64Nanoseconds(load_report_ttl_)) {
+      load += reported_rpcs_[index].load(std::memory_order_relaxed);
+    }
+    return load;
+  }
+
+  // Picks among the stubs at `indices` by the pick policy.
+  size_t Pick(const std::vector<size_t>& indices, size_t start,
+              int64_t now_ns) const {
+    start %= indices.size();
+    size_t picked = indices[start];
+    if (pick_policy_ == ChannelPickPolicy::kLeastOutstanding) {
+      // The scan starts at the round-robin pick so that ties are spread.
+      int64_t fewest = std::numeric_limits<int64_t>::max();
+      for (size_t i = 0; i < indices.size(); ++i) {
+        const size_t index = indices[(start + i) % indices.size()];
+        const int64_t load = Load(index, now_ns);
+        if (load < fewest) {
+          fewest = load;
+          picked = index;
+        }
+      }
+    }
+    return picked;
+  }
+
+  std::vector<std::unique_ptr<StubT>> stubs_;
+  std::vector<std::shared_ptr<grpc::Channel>> channels_;
+  std::vector<std::atomic<int64_t>> outstanding_;
+  // Load last reported by the backend of each channel, in RPCs, and the
+  // Unix time it was received at, in nanoseconds.
+  std::vector<std::atomic<int64_t>> reported_rpcs_;
+  std::vector<std::atomic<int64_t>> reported_at_ns_;
+  absl::Duration load_report_wait_per_rpc_ = absl::ZeroDuration();
+  absl::Duration load_report_ttl_ = absl::ZeroDuration();
+  std::atomic<size_t> next_ = 0;
+  const ChannelPickPolicy pick_policy_;
+  // Indices of the stubs to the backend in the local zone and in the others.
+  std::vector<size_t> local_;
+  std::vector<size_t> remote_;
+  const int zone_spillover_rpcs_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_CHANNEL_POOL_H_
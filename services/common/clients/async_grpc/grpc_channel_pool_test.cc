@@ -0,0 +1,232 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/server_builder.h>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+#include "services/common/util/backend_load.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+struct FakeStub {
+  int id;
+};
+
+GrpcStubPool<FakeStub> MakePool(int num_stubs, ChannelPickPolicy policy) {
+  std::vector<std::unique_ptr<FakeStub>> stubs;
+  for (int i = 0; i < num_stubs; ++i) {
+    stubs.push_back(std::make_unique<FakeStub>(FakeStub{i}));
+  }
+  return GrpcStubPool<FakeStub>(std::move(stubs), policy);
+}
+
+TEST(GrpcStubPoolTest, RoundRobinCyclesThroughStubs) {
+  auto pool = MakePool(3, ChannelPickPolicy::kRoundRobin);
+  std::vector<int> picked;
+  for (int i = 0; i < 6; ++i) {
+    size_t index = pool.Acquire();
+    picked.push_back(pool.Get(index)->id);
+  }
+  EXPECT_EQ(picked, (std::vector<int>{0, 1, 2, 0, 1, 2}));
+  EXPECT_EQ(pool.Outstanding(0), 2);
+}
+
+TEST(GrpcStubPoolTest, LeastOutstandingAvoidsBusyStubs) {
+  auto pool = MakePool(3, ChannelPickPolicy::kLeastOutstanding);
+  const size_t first = pool.Acquire();
+  const size_t second = pool.Acquire();
+  const size_t third = pool.Acquire();
+  EXPECT_NE(first, second);
+  EXPECT_NE(second, third);
+  EXPECT_NE(first, third);
+
+  // Only the second stub is free, wherever the scan starts.
+  pool.Release(second);
+  for (int i = 0; i < 3; ++i) {
+    const size_t index = pool.Acquire();
+    EXPECT_EQ(index, second);
+    pool.Release(index);
+  }
+  EXPECT_EQ(pool.Outstanding(first), 1);
+  EXPECT_EQ(pool.Outstanding(second), 0);
+  EXPECT_EQ(pool.Outstanding(third), 1);
+}
+
+TEST(GrpcStubPoolTest, SingleStubTakesAllRpcs) {
+  auto pool = MakePool(1, ChannelPickPolicy::kLeastOutstanding);
+  EXPECT_EQ(pool.Acquire(), 0);
+  EXPECT_EQ(pool.Acquire(), 0);
+  EXPECT_EQ(pool.Outstanding(0), 2);
+}
+
+// Pool of two stubs in the local zone, 0 and 1, and two in another, 2 and 3.
+GrpcStubPool<FakeStub> MakeZonalPool(int zone_spillover_rpcs) {
+  std::vector<std::unique_ptr<FakeStub>> stubs;
+  for (int i = 0; i < 4; ++i) {
+    stubs.push_back(std::make_unique<FakeStub>(FakeStub{i}));
+  }
+  return GrpcStubPool<FakeStub>(
+      std::move(stubs), ChannelPickPolicy::kLeastOutstanding,
+      {true, true, false, false}, zone_spillover_rpcs);
+}
+
+TEST(GrpcStubPoolTest, PrefersLocalZoneUntilSpillover) {
+  auto pool = MakeZonalPool(/*zone_spillover_rpcs=*/2);
+  // The local stubs take 3 RPCs each before the other zone gets any, as they
+  // then have 3 more in flight than the remote ones.
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_LT(pool.Acquire(), 2);
+  }
+  EXPECT_GE(pool.Acquire(), 2);
+  EXPECT_EQ(pool.Outstanding(0) + pool.Outstanding(1), 6);
+}
+
+TEST(GrpcStubPoolTest, BalancesAcrossZonesWithoutAffinity) {
+  auto pool = MakeZonalPool(/*zone_spillover_rpcs=*/0);
+  for (int i = 0; i < 8; ++i) {
+    pool.Acquire();
+  }
+  for (size_t i = 0; i < pool.size(); ++i) {
+    EXPECT_EQ(pool.Outstanding(i), 2);
+  }
+}
+
+TEST(GrpcStubPoolTest, KeepsRpcsInLocalZoneWithStrictAffinity) {
+  auto pool = MakeZonalPool(/*zone_spillover_rpcs=*/-1);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_LT(pool.Acquire(), 2);
+  }
+}
+
+TEST(GrpcStubPoolTest, UsesOtherZonesWithoutLocalStubs) {
+  std::vector<std::unique_ptr<FakeStub>> stubs;
+  stubs.push_back(std::make_unique<FakeStub>(FakeStub{0}));
+  GrpcStubPool<FakeStub> pool(std::move(stubs),
+                              ChannelPickPolicy::kLeastOutstanding, {false},
+                              /*zone_spillover_rpcs=*/-1);
+  EXPECT_EQ(pool.Acquire(), 0);
+}
+
+TEST(GrpcStubPoolTest, AvoidsBackendsReportingLongRomaWaits) {
+  auto pool = MakePool(2, ChannelPickPolicy::kLeastOutstanding);
+  pool.WeighLoadReports(/*wait_per_rpc=*/absl::Milliseconds(10),
+                        /*ttl=*/absl::Hours(1));
+  // 8 requests in Roma on 4 workers taking 10ms each make a 20ms wait, which
+  // weighs as 2 RPCs.
+  pool.RecordLoad(0,
+                  {.queue_depth = 8,
+                   .num_workers = 4,
+                   .request_time = absl::Milliseconds(10)},
+                  absl::Now());
+  EXPECT_EQ(pool.Acquire(), 1);
+  EXPECT_EQ(pool.Acquire(), 1);
+  EXPECT_EQ(pool.Outstanding(0), 0);
+  pool.Acquire();
+  pool.Acquire();
+  EXPECT_EQ(pool.Outstanding(0), 1);
+}
+
+TEST(GrpcStubPoolTest, IgnoresStaleOrUnweighedLoadReports) {
+  const BackendLoadReport busy = {.queue_depth = 100,
+                                  .num_workers = 1,
+                                  .request_time = absl::Seconds(1)};
+  auto stale = MakePool(2, ChannelPickPolicy::kLeastOutstanding);
+  stale.WeighLoadReports(absl::Milliseconds(10), absl::Seconds(1));
+  stale.RecordLoad(0, busy, absl::Now() - absl::Minutes(1));
+  auto unweighed = MakePool(2, ChannelPickPolicy::kLeastOutstanding);
+  unweighed.RecordLoad(0, busy, absl::Now());
+  for (auto* pool : {&stale, &unweighed}) {
+    pool->Acquire();
+    pool->Acquire();
+    EXPECT_EQ(pool->Outstanding(0), 1);
+    EXPECT_EQ(pool->Outstanding(1), 1);
+  }
+}
+
+TEST(ParseZonalAddressesTest, ParsesZoneAddressPairs) {
+  absl::StatusOr<std::vector<ZonalAddress>> parsed =
+      ParseZonalAddresses(" us-a=bidding-a:443, us-b = bidding-b:443");
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  ASSERT_EQ(parsed->size(), 2);
+  EXPECT_EQ((*parsed)[0].zone, "us-a");
+  EXPECT_EQ((*parsed)[0].address, "bidding-a:443");
+  EXPECT_EQ((*parsed)[1].zone, "us-b");
+  EXPECT_EQ((*parsed)[1].address, "bidding-b:443");
+  EXPECT_TRUE(ParseZonalAddresses("")->empty());
+  EXPECT_FALSE(ParseZonalAddresses("us-a").ok());
+  EXPECT_FALSE(ParseZonalAddresses("=bidding-a:443").ok());
+}
+
+TEST(CreateChannelsTest, CreatesTheConfiguredNumberOfChannels) {
+  EXPECT_EQ(CreateChannels("localhost:50051", /*compression=*/true,
+                           /*secure=*/false,
+                           {.num_channels = 4,
+                            .keepalive_time = absl::Seconds(30),
+                            .http2_stream_window_bytes = 1 << 20})
+                .size(),
+            4);
+  EXPECT_EQ(CreateChannels("localhost:50051", /*compression=*/false,
+                           /*secure=*/false, {.num_channels = 0})
+                .size(),
+            1);
+}
+
+TEST(ConnectChannelsTest, ConnectsChannelsToRunningServer) {
+  grpc::ServerBuilder builder;
+  // A server is only started with a service.
+  grpc::CallbackGenericService service;
+  builder.RegisterCallbackGenericService(&service);
+  int port = 0;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+  ASSERT_NE(server, nullptr);
+
+  const ChannelConnectivity connectivity = ConnectChannels(
+      CreateChannels(absl::StrCat("localhost:", port), /*compression=*/false,
+                     /*secure=*/false, {.num_channels = 3}),
+      absl::Now() + absl::Seconds(10));
+
+  EXPECT_EQ(connectivity.num_connected, 3);
+  EXPECT_EQ(connectivity.num_channels, 3);
+  EXPECT_EQ(connectivity.ConnectedPercent(), 100);
+  server->Shutdown();
+}
+
+TEST(ConnectChannelsTest, StopsWaitingAtDeadline) {
+  // Nothing listens on the port.
+  const ChannelConnectivity connectivity = ConnectChannels(
+      CreateChannels("localhost:1", /*compression=*/false,
+                     /*secure=*/false, {.num_channels = 2}),
+      absl::Now() + absl::Milliseconds(100));
+
+  EXPECT_EQ(connectivity.num_connected, 0);
+  EXPECT_EQ(connectivity.num_channels, 2);
+  EXPECT_EQ(connectivity.ConnectedPercent(), 0);
+  EXPECT_EQ(ChannelConnectivity{}.ConnectedPercent(), 100);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
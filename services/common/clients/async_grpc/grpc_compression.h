@@ -0,0 +1,97 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_COMPRESSION_H_
+#define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_COMPRESSION_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <grpc/compression.h>
+#include <grpcpp/grpcpp.h>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Per-call choice of the compression of the requests of a gRPC client. The
+// payloads of the requests are mostly ciphertext, which does not compress, so
+// only the larger requests are worth the CPU.
+struct GrpcCompressionPolicy {
+  // Requests with a smaller payload are sent uncompressed. All requests are
+  // compressed if zero.
+  int64_t min_compressed_bytes = 0;
+  // Compression of the other requests, e.g. GRPC_COMPRESS_DEFLATE, which
+  // skips the gzip framing, within a VPC and GRPC_COMPRESS_GZIP across
+  // regions.
+  grpc_compression_algorithm algorithm = GRPC_COMPRESS_GZIP;
+};
+
+namespace grpc_compression_internal {
+
+// Bytes of the request payloads sent with each compression algorithm.
+inline std::array<std::atomic<int64_t>, GRPC_COMPRESS_ALGORITHMS_COUNT>&
+BytesByAlgorithm() {
+  static auto* bytes =
+      new std::array<std::atomic<int64_t>, GRPC_COMPRESS_ALGORITHMS_COUNT>();
+  return *bytes;
+}
+
+}  // namespace grpc_compression_internal
+
+// Returns the compression of a request with a payload of `payload_bytes`, and
+// records it for GetGrpcRequestCompressionShares.
+inline grpc_compression_algorithm ChooseGrpcCompression(
+    const GrpcCompressionPolicy& policy, int64_t payload_bytes) {
+  grpc_compression_algorithm algorithm =
+      payload_bytes < policy.min_compressed_bytes ? GRPC_COMPRESS_NONE
+                                                  : policy.algorithm;
+  grpc_compression_internal::BytesByAlgorithm()[algorithm].fetch_add(
+      payload_bytes, std::memory_order_relaxed);
+  return algorithm;
+}
+
+// Observable callback exporting the share of the bytes of the request
+// payloads sent with each compression algorithm since the previous call,
+// keyed by algorithm name. gRPC does not report the compressed sizes, so the
+// share shows how much of the traffic pays for compression.
+inline absl::flat_hash_map<std::string, double>
+GetGrpcRequestCompressionShares() {
+  std::array<int64_t, GRPC_COMPRESS_ALGORITHMS_COUNT> bytes;
+  int64_t total_bytes = 0;
+  for (int i = 0; i < GRPC_COMPRESS_ALGORITHMS_COUNT; ++i) {
+    bytes[i] = grpc_compression_internal::BytesByAlgorithm()[i].exchange(
+        0, std::memory_order_relaxed);
+    total_bytes += bytes[i];
+  }
+  absl::flat_hash_map<std::string, double> shares;
+  if (total_bytes == 0) {
+    return shares;
+  }
+  for (int i = 0; i < GRPC_COMPRESS_ALGORITHMS_COUNT; ++i) {
+    const char* name = nullptr;
+    if (bytes[i] > 0 && grpc_compression_algorithm_name(
+                            static_cast<grpc_compression_algorithm>(i),
+                            &name) != 0) {
+      shares[name] = static_cast<double>(bytes[i]) / total_bytes;
+    }
+  }
+  return shares;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_ASYNC_GRPC_GRPC_COMPRESSION_H_
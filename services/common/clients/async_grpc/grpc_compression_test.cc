@@ -0,0 +1,51 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/async_grpc/grpc_compression.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(GrpcCompressionTest, CompressesOnlyLargeRequests) {
+  GrpcCompressionPolicy policy = {.min_compressed_bytes = 1024,
+                                  .algorithm = GRPC_COMPRESS_DEFLATE};
+
+  EXPECT_EQ(ChooseGrpcCompression(policy, 100), GRPC_COMPRESS_NONE);
+  EXPECT_EQ(ChooseGrpcCompression(policy, 1024), GRPC_COMPRESS_DEFLATE);
+  EXPECT_EQ(ChooseGrpcCompression({}, 0), GRPC_COMPRESS_GZIP);
+}
+
+TEST(GrpcCompressionTest, ExportsSharesOfBytesByAlgorithm) {
+  GetGrpcRequestCompressionShares();
+  GrpcCompressionPolicy policy = {.min_compressed_bytes = 1000};
+  ChooseGrpcCompression(policy, 250);
+  ChooseGrpcCompression(policy, 750);
+  ChooseGrpcCompression(policy, 3000);
+
+  EXPECT_THAT(GetGrpcRequestCompressionShares(),
+              UnorderedElementsAre(Pair("identity", DoubleEq(0.25)),
+                                   Pair("gzip", DoubleEq(0.75))));
+  EXPECT_THAT(GetGrpcRequestCompressionShares(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
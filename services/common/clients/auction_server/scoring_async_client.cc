@@ -26,9 +26,12 @@ ScoringAsyncGrpcClient::ScoringAsyncGrpcClient(
     CryptoClientWrapperInterface* crypto_client,
     const AuctionServiceClientConfig& client_config)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client) {
-  stub_ = Auction::NewStub(CreateChannel(client_config.server_addr,
-                                         client_config.compression,
-                                         client_config.secure_client));
+  stub_pool_ = GrpcStubPool<Auction::Stub>::Create<Auction>(
+      client_config.server_addr, client_config.compression,
+      client_config.secure_client, client_config.channel_pool);
+  if (client_config.compression) {
+    SetCompressionPolicy(client_config.compression_policy);
+  }
 }
 
 void ScoringAsyncGrpcClient::SendRpc(
@@ -36,9 +39,12 @@ void ScoringAsyncGrpcClient::SendRpc(
     RawClientParams<ScoreAdsRequest, ScoreAdsResponse,
                     ScoreAdsResponse::ScoreAdsRawResponse>* params) const {
   PS_VLOG(5) << "ScoringAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->ScoreAds(
+  const size_t stub_index = stub_pool_->Acquire();
+  stub_pool_->Get(stub_index)->async()->ScoreAds(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](const grpc::Status& status) {
+      [this, params, hpke_secret, stub_index](const grpc::Status& status) {
+        stub_pool_->Release(stub_index);
+        stub_pool_->ReportLoad(stub_index, *params->ContextRef());
         if (!status.ok()) {
           PS_LOG(ERROR) << "SendRPC completion status not ok: "
                         << server_common::ToAbslStatus(status);
@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
@@ -26,6 +27,8 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -36,7 +39,10 @@ using ScoringAsyncClient = AsyncClient<ScoreAdsRequest, ScoreAdsResponse,
 struct AuctionServiceClientConfig {
   std::string server_addr;
   bool compression = false;
+  // Per-request compression, if compression is enabled.
+  GrpcCompressionPolicy compression_policy;
   bool secure_client = true;
+  GrpcChannelPoolConfig channel_pool;
 };
 
 // This class is an async grpc client for the Fledge Auction (Scoring) Service.
@@ -50,6 +56,11 @@ class ScoringAsyncGrpcClient
       CryptoClientWrapperInterface* crypto_client,
       const AuctionServiceClientConfig& client_config);
 
+  // Channels to the Auction Service, see GrpcStubPool::channels.
+  const std::vector<std::shared_ptr<grpc::Channel>>& channels() const {
+    return stub_pool_->channels();
+  }
+
  protected:
   // Sends an asynchronous request via grpc to the Scoring Service.
   //
@@ -60,7 +71,7 @@ class ScoringAsyncGrpcClient
                                ScoreAdsResponse::ScoreAdsRawResponse>* params)
       const override;
 
-  std::unique_ptr<Auction::Stub> stub_;
+  std::unique_ptr<GrpcStubPool<Auction::Stub>> stub_pool_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
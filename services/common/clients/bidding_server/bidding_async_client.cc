@@ -56,8 +56,14 @@ void OnRpcDone(
 BiddingAsyncGrpcClient::BiddingAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
-    const BiddingServiceClientConfig& client_config, Bidding::Stub* stub)
-    : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client), stub_(stub) {}
+    const BiddingServiceClientConfig& client_config,
+    GrpcStubPool<Bidding::Stub>* stub_pool)
+    : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client),
+      stub_pool_(stub_pool) {
+  if (client_config.compression) {
+    SetCompressionPolicy(client_config.compression_policy);
+  }
+}
 
 void BiddingAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
@@ -65,9 +71,12 @@ void BiddingAsyncGrpcClient::SendRpc(
                     GenerateBidsResponse::GenerateBidsRawResponse>* params)
     const {
   PS_VLOG(5) << "BiddingAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GenerateBids(
+  const size_t stub_index = stub_pool_->Acquire();
+  stub_pool_->Get(stub_index)->async()->GenerateBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](const grpc::Status& status) {
+      [this, params, hpke_secret, stub_index](const grpc::Status& status) {
+        stub_pool_->Release(stub_index);
+        stub_pool_->ReportLoad(stub_index, *params->ContextRef());
         OnRpcDone<GenerateBidsRequest, GenerateBidsResponse,
                   GenerateBidsResponse::GenerateBidsRawResponse>(
             status, params,
@@ -81,8 +90,14 @@ ProtectedAppSignalsBiddingAsyncGrpcClient::
     ProtectedAppSignalsBiddingAsyncGrpcClient(
         server_common::KeyFetcherManagerInterface* key_fetcher_manager,
         CryptoClientWrapperInterface* crypto_client,
-        const BiddingServiceClientConfig& client_config, Bidding::Stub* stub)
-    : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client), stub_(stub) {}
+        const BiddingServiceClientConfig& client_config,
+        GrpcStubPool<Bidding::Stub>* stub_pool)
+    : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client),
+      stub_pool_(stub_pool) {
+  if (client_config.compression) {
+    SetCompressionPolicy(client_config.compression_policy);
+  }
+}
 
 void ProtectedAppSignalsBiddingAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
@@ -90,9 +105,12 @@ void ProtectedAppSignalsBiddingAsyncGrpcClient::SendRpc(
                     GenerateProtectedAppSignalsBidsResponse,
                     GenerateProtectedAppSignalsBidsRawResponse>* params) const {
   PS_VLOG(5) << "ProtectedAppSignalsBiddingAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GenerateProtectedAppSignalsBids(
+  const size_t stub_index = stub_pool_->Acquire();
+  stub_pool_->Get(stub_index)->async()->GenerateProtectedAppSignalsBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](const grpc::Status& status) {
+      [this, params, hpke_secret, stub_index](const grpc::Status& status) {
+        stub_pool_->Release(stub_index);
+        stub_pool_->ReportLoad(stub_index, *params->ContextRef());
         OnRpcDone<GenerateProtectedAppSignalsBidsRequest,
                   GenerateProtectedAppSignalsBidsResponse,
                   GenerateProtectedAppSignalsBidsRawResponse>(
@@ -26,6 +26,8 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 using BiddingAsyncClient =
@@ -44,8 +46,11 @@ using ProtectedAppSignalsBiddingAsyncClient =
 struct BiddingServiceClientConfig {
   std::string server_addr;
   bool compression = false;
+  // Per-request compression, if compression is enabled.
+  GrpcCompressionPolicy compression_policy;
   bool secure_client = true;
   bool is_pas_enabled = false;
+  GrpcChannelPoolConfig channel_pool;
 };
 
 // This class is an async grpc client for the Fledge Bidding Service.
@@ -58,7 +63,8 @@ class BiddingAsyncGrpcClient
   BiddingAsyncGrpcClient(
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      const BiddingServiceClientConfig& client_config, Bidding::Stub* stub);
+      const BiddingServiceClientConfig& client_config,
+      GrpcStubPool<Bidding::Stub>* stub_pool);
 
  protected:
   // Sends an asynchronous request via grpc to the Bidding Service.
@@ -70,7 +76,7 @@ class BiddingAsyncGrpcClient
                                GenerateBidsResponse::GenerateBidsRawResponse>*
                    params) const override;
 
-  Bidding::Stub* stub_;
+  GrpcStubPool<Bidding::Stub>* stub_pool_;
 };
 
 class ProtectedAppSignalsBiddingAsyncGrpcClient
@@ -85,7 +91,8 @@ class ProtectedAppSignalsBiddingAsyncGrpcClient
   ProtectedAppSignalsBiddingAsyncGrpcClient(
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      const BiddingServiceClientConfig& client_config, Bidding::Stub* stub);
+      const BiddingServiceClientConfig& client_config,
+      GrpcStubPool<Bidding::Stub>* stub_pool);
 
  protected:
   // Sends an asynchronous request via grpc to the Bidding Service.
@@ -99,7 +106,7 @@ class ProtectedAppSignalsBiddingAsyncGrpcClient
                                    GenerateProtectedAppSignalsBidsRawResponse>*
                    params) const override;
 
-  Bidding::Stub* stub_;
+  GrpcStubPool<Bidding::Stub>* stub_pool_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
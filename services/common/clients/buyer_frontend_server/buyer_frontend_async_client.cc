@@ -14,12 +14,55 @@
 
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
 
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "services/common/clients/async_grpc/grpc_client_utils.h"
+#include "services/common/util/error_categories.h"
 #include "src/public/cpio/interface/crypto_client/crypto_client_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
 using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
 
+namespace {
+
+thread_local GetBidsBatchScope* current_get_bids_batch_scope = nullptr;
+
+}  // namespace
+
+GetBidsBatchScope::GetBidsBatchScope()
+    : outer_(current_get_bids_batch_scope) {
+  current_get_bids_batch_scope = this;
+}
+
+GetBidsBatchScope::~GetBidsBatchScope() {
+  current_get_bids_batch_scope = outer_;
+  for (const std::string& server_addr : server_addrs_) {
+    std::vector<Call>& calls = calls_by_server_addr_[server_addr];
+    if (calls.size() == 1) {
+      calls[0].client->SendGetBids(calls[0].hpke_secret, calls[0].params);
+    } else {
+      const BuyerFrontEndAsyncGrpcClient* client = calls[0].client;
+      client->SendGetBidsBatch(std::move(calls));
+    }
+  }
+}
+
+GetBidsBatchScope* GetBidsBatchScope::Current() {
+  return current_get_bids_batch_scope;
+}
+
+void GetBidsBatchScope::Add(absl::string_view server_addr, Call call) {
+  auto [it, inserted] = calls_by_server_addr_.try_emplace(server_addr);
+  if (inserted) {
+    server_addrs_.emplace_back(server_addr);
+  }
+  it->second.push_back(std::move(call));
+}
+
 BuyerFrontEndAsyncGrpcClient::BuyerFrontEndAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
@@ -27,22 +70,205 @@ BuyerFrontEndAsyncGrpcClient::BuyerFrontEndAsyncGrpcClient(
     std::unique_ptr<BuyerFrontEnd::StubInterface> stub)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
                              client_config.cloud_platform),
-      stub_(std::move(stub)) {
-  if (!stub_) {
-    stub_ = BuyerFrontEnd::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+      server_addr_(client_config.server_addr),
+      stream_interest_groups_per_chunk_(
+          client_config.stream_interest_groups_per_chunk) {
+  if (stub) {
+    std::vector<std::unique_ptr<BuyerFrontEnd::StubInterface>> stubs;
+    stubs.push_back(std::move(stub));
+    stub_pool_ = std::make_unique<GrpcStubPool<BuyerFrontEnd::StubInterface>>(
+        std::move(stubs), client_config.channel_pool.pick_policy);
+  } else {
+    stub_pool_ =
+        GrpcStubPool<BuyerFrontEnd::StubInterface>::Create<BuyerFrontEnd>(
+            client_config.server_addr, client_config.compression,
+            client_config.secure_client, client_config.channel_pool);
+  }
+  if (client_config.compression) {
+    SetCompressionPolicy(client_config.compression_policy);
   }
 }
 
-void BuyerFrontEndAsyncGrpcClient::SendRpc(
-    const std::string& hpke_secret,
-    RawClientParams<GetBidsRequest, GetBidsResponse,
-                    GetBidsResponse::GetBidsRawResponse>* params) const {
+// Writes the request of a GetBidsStream call, and then its chunks of interest
+// groups, each encrypted right before it is written so that the encryption of
+// a chunk overlaps with the transfer of the previous one.
+class BuyerFrontEndAsyncGrpcClient::GetBidsStreamCall
+    : public grpc::ClientWriteReactor<GetBidsStreamChunk> {
+ public:
+  GetBidsStreamCall(const BuyerFrontEndAsyncGrpcClient* client,
+                    std::string hpke_secret, std::vector<BuyerInput> chunks,
+                    GetBidsClientParams* params)
+      : client_(client),
+        hpke_secret_(std::move(hpke_secret)),
+        chunks_(std::move(chunks)),
+        params_(params),
+        stub_index_(client->stub_pool_->Acquire()) {}
+
+  void Start() {
+    client_->stub_pool_->Get(stub_index_)
+        ->async()
+        ->GetBidsStream(params_->ContextRef(), params_->ResponseRef(), this);
+    message_.mutable_request()->Swap(params_->RequestRef());
+    StartWrite(&message_);
+    StartCall();
+  }
+
+  void OnWriteDone(bool ok) override {
+    if (!ok) {
+      // The call failed, and OnDone gets its status.
+      return;
+    }
+    if (next_chunk_ == chunks_.size()) {
+      StartWritesDone();
+      return;
+    }
+    BuyerInput chunk = std::move(chunks_[next_chunk_++]);
+    absl::StatusOr<AeadEncryptResponse> encrypt_response =
+        client_->crypto_client_->AeadEncrypt(chunk.SerializeAsString(),
+                                             hpke_secret_);
+    if (!encrypt_response.ok()) {
+      PS_LOG(ERROR) << "Failed to encrypt the interest groups: "
+                    << encrypt_response.status();
+      encryption_failed_ = true;
+      params_->ContextRef()->TryCancel();
+      return;
+    }
+    message_.set_interest_groups_ciphertext(std::move(
+        *encrypt_response->mutable_encrypted_data()->mutable_ciphertext()));
+    StartWrite(&message_);
+  }
+
+  void OnDone(const grpc::Status& status) override {
+    std::unique_ptr<GetBidsStreamCall> owned_call(this);
+    client_->stub_pool_->Release(stub_index_);
+    if (encryption_failed_) {
+      params_->OnDone(grpc::Status(grpc::StatusCode::INTERNAL,
+                                   kEncryptionFailed));
+      return;
+    }
+    if (!status.ok()) {
+      PS_LOG(ERROR) << "GetBidsStream completion status not ok: "
+                    << server_common::ToAbslStatus(status);
+      params_->OnDone(status);
+      return;
+    }
+    auto decrypted_response =
+        client_->DecryptResponse(hpke_secret_, params_->ResponseRef());
+    if (!decrypted_response.ok()) {
+      PS_LOG(ERROR)
+          << "BuyerFrontEndAsyncGrpcClient Failed to decrypt response";
+      params_->OnDone(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                   decrypted_response.status().ToString()));
+      return;
+    }
+    params_->SetRawResponse(*std::move(decrypted_response));
+    params_->OnDone(status);
+  }
+
+ private:
+  const BuyerFrontEndAsyncGrpcClient* client_;
+  const std::string hpke_secret_;
+  std::vector<BuyerInput> chunks_;
+  size_t next_chunk_ = 0;
+  GetBidsClientParams* params_;
+  const size_t stub_index_;
+  // Message being written.
+  GetBidsStreamChunk message_;
+  bool encryption_failed_ = false;
+};
+
+absl::Status BuyerFrontEndAsyncGrpcClient::ExecuteInternal(
+    std::unique_ptr<GetBidsRequest::GetBidsRawRequest> raw_request,
+    const RequestMetadata& metadata,
+    absl::AnyInvocable<
+        void(absl::StatusOr<
+             std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>) &&>
+        on_done,
+    absl::Duration timeout,
+    std::shared_ptr<RequestCancellation> cancellation) const {
+  // Protected app signals are only sent over GetBids.
+  if (stream_interest_groups_per_chunk_ <= 0 ||
+      raw_request->buyer_input().interest_groups_size() <=
+          stream_interest_groups_per_chunk_ ||
+      raw_request->has_protected_app_signals_buyer_input()) {
+    return DefaultAsyncGrpcClient::ExecuteInternal(
+        std::move(raw_request), metadata, std::move(on_done), timeout,
+        std::move(cancellation));
+  }
+
+  // The interest groups are moved into the chunks, in their order in the
+  // request, and the request is encrypted without them.
+  auto& interest_groups =
+      *raw_request->mutable_buyer_input()->mutable_interest_groups();
+  const int chunk_size = stream_interest_groups_per_chunk_;
+  std::vector<BuyerInput> chunks;
+  chunks.reserve((interest_groups.size() + chunk_size - 1) / chunk_size);
+  int64_t payload_bytes = 0;
+  for (int i = 0; i < interest_groups.size(); i += chunk_size) {
+    BuyerInput& chunk = chunks.emplace_back();
+    const int end = std::min(interest_groups.size(), i + chunk_size);
+    for (int j = i; j < end; ++j) {
+      *chunk.add_interest_groups() = std::move(interest_groups[j]);
+    }
+    payload_bytes += chunk.ByteSizeLong();
+  }
+  interest_groups.Clear();
+
+  auto secret_request =
+      EncryptRequestWithHpke<GetBidsRequest::GetBidsRawRequest,
+                             GetBidsRequest>(std::move(raw_request),
+                                             *crypto_client_,
+                                             *key_fetcher_manager_,
+                                             cloud_platform_);
+  if (!secret_request.ok()) {
+    PS_LOG(ERROR) << "Failed to encrypt the request: "
+                  << secret_request.status();
+    return absl::InternalError(kEncryptionFailed);
+  }
+  auto& [hpke_secret, request] = *secret_request;
+  payload_bytes += request->request_ciphertext().size();
+
+  auto params = std::make_unique<GetBidsClientParams>(
+      std::move(request), std::move(on_done), metadata);
+  params->SetDeadline(std::min(max_timeout, timeout));
+  if (compression_policy_.has_value()) {
+    params->SetCompressionAlgorithm(
+        ChooseGrpcCompression(*compression_policy_, payload_bytes));
+  }
+  params->SetCancellation(std::move(cancellation));
+  PS_VLOG(5) << "Streaming " << chunks.size() << " chunks of interest groups";
+  SendGetBidsStream(hpke_secret, std::move(chunks), params.release());
+  return absl::OkStatus();
+}
+
+void BuyerFrontEndAsyncGrpcClient::SendGetBidsStream(
+    const std::string& hpke_secret, std::vector<BuyerInput> chunks,
+    GetBidsClientParams* params) const {
+  // Deleted once the call is done.
+  auto* call = new GetBidsStreamCall(this, hpke_secret, std::move(chunks),
+                                     params);
+  call->Start();
+}
+
+void BuyerFrontEndAsyncGrpcClient::SendRpc(const std::string& hpke_secret,
+                                           GetBidsClientParams* params) const {
   PS_VLOG(5) << "BuyerFrontEndAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GetBids(
+  // Calls are grouped by address, so clients without one are not batched.
+  if (GetBidsBatchScope* scope = GetBidsBatchScope::Current();
+      scope != nullptr && !server_addr_.empty()) {
+    scope->Add(server_addr_, {this, hpke_secret, params});
+    return;
+  }
+  SendGetBids(hpke_secret, params);
+}
+
+void BuyerFrontEndAsyncGrpcClient::SendGetBids(
+    const std::string& hpke_secret, GetBidsClientParams* params) const {
+  const size_t stub_index = stub_pool_->Acquire();
+  stub_pool_->Get(stub_index)->async()->GetBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](const grpc::Status& status) {
+      [this, params, hpke_secret, stub_index](const grpc::Status& status) {
+        stub_pool_->Release(stub_index);
         if (!status.ok()) {
           PS_LOG(ERROR) << "SendRPC completion status not ok: "
                         << server_common::ToAbslStatus(status);
@@ -67,4 +293,71 @@ void BuyerFrontEndAsyncGrpcClient::SendRpc(
       });
 }
 
+void BuyerFrontEndAsyncGrpcClient::SendGetBidsBatch(
+    std::vector<GetBidsBatchScope::Call> calls) const {
+  PS_VLOG(5) << "Sending " << calls.size() << " GetBids calls in a batch";
+  struct BatchState {
+    std::vector<GetBidsBatchScope::Call> calls;
+    GetBidsBatchRequest request;
+    GetBidsBatchResponse response;
+  };
+  auto* state = new BatchState{std::move(calls)};
+  for (GetBidsBatchScope::Call& call : state->calls) {
+    state->request.add_requests()->Swap(call.params->RequestRef());
+  }
+  // The calls come from the same request, so the context of the first one
+  // carries the deadline, metadata and cancellation of all of them.
+  GetBidsClientParams* first_params = state->calls[0].params;
+  const size_t stub_index = stub_pool_->Acquire();
+  stub_pool_->Get(stub_index)->async()->GetBidsBatch(
+      first_params->ContextRef(), &state->request, &state->response,
+      [this, state, stub_index](const grpc::Status& status) {
+        stub_pool_->Release(stub_index);
+        std::unique_ptr<BatchState> owned_state(state);
+        if (!status.ok()) {
+          PS_LOG(ERROR) << "GetBidsBatch completion status not ok: "
+                        << server_common::ToAbslStatus(status);
+        } else if (state->response.results_size() !=
+                   static_cast<int>(state->calls.size())) {
+          PS_LOG(ERROR) << "GetBidsBatch returned "
+                        << state->response.results_size() << " results for "
+                        << state->calls.size() << " requests";
+        }
+        // The first call owns the context, so it is done last.
+        for (int i = static_cast<int>(state->calls.size()) - 1; i >= 0; --i) {
+          const GetBidsBatchScope::Call& call = state->calls[i];
+          if (!status.ok()) {
+            call.params->OnDone(status);
+            continue;
+          }
+          if (i >= state->response.results_size()) {
+            call.params->OnDone(grpc::Status(grpc::StatusCode::INTERNAL,
+                                             "Missing GetBidsBatch result"));
+            continue;
+          }
+          GetBidsBatchResponse::Result& result =
+              *state->response.mutable_results(i);
+          if (result.status_code() != grpc::StatusCode::OK) {
+            call.params->OnDone(grpc::Status(
+                static_cast<grpc::StatusCode>(result.status_code()),
+                result.status_message()));
+            continue;
+          }
+          call.params->ResponseRef()->Swap(result.mutable_response());
+          auto decrypted_response = call.client->DecryptResponse(
+              call.hpke_secret, call.params->ResponseRef());
+          if (!decrypted_response.ok()) {
+            PS_LOG(ERROR)
+                << "BuyerFrontEndAsyncGrpcClient Failed to decrypt response";
+            call.params->OnDone(
+                grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                             decrypted_response.status().ToString()));
+            continue;
+          }
+          call.params->SetRawResponse(*std::move(decrypted_response));
+          call.params->OnDone(status);
+        }
+      });
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
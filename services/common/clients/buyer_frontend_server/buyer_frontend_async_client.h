@@ -18,13 +18,18 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -36,12 +41,59 @@ using BuyerFrontEndAsyncClient =
 struct BuyerServiceClientConfig {
   std::string server_addr;
   bool compression = false;
+  // Per-request compression, if compression is enabled.
+  GrpcCompressionPolicy compression_policy;
   bool secure_client = true;
   server_common::CloudPlatform cloud_platform;
+  GrpcChannelPoolConfig channel_pool;
+  // Interest groups per chunk of a GetBidsStream call, for the requests with
+  // more of them. Requests are sent over GetBids if 0.
+  int stream_interest_groups_per_chunk = 0;
 };
 
 // This class is an async grpc client for Fledge Buyer FrontEnd Service.
 // Compression is disabled by default.
+using GetBidsClientParams =
+    RawClientParams<GetBidsRequest, GetBidsResponse,
+                    GetBidsResponse::GetBidsRawResponse>;
+
+class BuyerFrontEndAsyncGrpcClient;
+
+// While a GetBidsBatchScope is alive on a thread, the GetBids calls sent by
+// BuyerFrontEndAsyncGrpcClients on the thread are held back. Once it is
+// destroyed, the calls to the same BuyerFrontEnd address are sent together in
+// a single GetBidsBatch call, each still encrypted for its own buyer, and the
+// other calls are sent as is. Scopes are meant to span the fan out of the
+// GetBids calls of a single request, whose calls share their metadata.
+class GetBidsBatchScope {
+ public:
+  GetBidsBatchScope();
+  ~GetBidsBatchScope();
+
+  // GetBidsBatchScope is neither copyable nor movable.
+  GetBidsBatchScope(const GetBidsBatchScope&) = delete;
+  GetBidsBatchScope& operator=(const GetBidsBatchScope&) = delete;
+
+  // Innermost scope alive on the current thread, if any.
+  static GetBidsBatchScope* Current();
+
+ private:
+  friend class BuyerFrontEndAsyncGrpcClient;
+
+  struct Call {
+    const BuyerFrontEndAsyncGrpcClient* client;
+    std::string hpke_secret;
+    GetBidsClientParams* params;
+  };
+
+  void Add(absl::string_view server_addr, Call call);
+
+  GetBidsBatchScope* const outer_;
+  // Addresses in the order of their first call, and the calls to each.
+  std::vector<std::string> server_addrs_;
+  absl::flat_hash_map<std::string, std::vector<Call>> calls_by_server_addr_;
+};
+
 class BuyerFrontEndAsyncGrpcClient
     : public DefaultAsyncGrpcClient<GetBidsRequest, GetBidsResponse,
                                     GetBidsRequest::GetBidsRawRequest,
@@ -53,17 +105,57 @@ class BuyerFrontEndAsyncGrpcClient
       const BuyerServiceClientConfig& client_config,
       std::unique_ptr<BuyerFrontEnd::StubInterface> stub = nullptr);
 
+  using DefaultAsyncGrpcClient::ExecuteInternal;
+
+  // Streams the interest groups of the requests with more than
+  // stream_interest_groups_per_chunk of them over GetBidsStream, so that the
+  // BuyerFrontEnd starts bidding on the first chunks while the next ones are
+  // sent. The other requests are sent as by DefaultAsyncGrpcClient.
+  absl::Status ExecuteInternal(
+      std::unique_ptr<GetBidsRequest::GetBidsRawRequest> raw_request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<
+               std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>) &&>
+          on_done,
+      absl::Duration timeout,
+      std::shared_ptr<RequestCancellation> cancellation) const override;
+
+  // Channels to the BuyerFrontEnd, see GrpcStubPool::channels.
+  const std::vector<std::shared_ptr<grpc::Channel>>& channels() const {
+    return stub_pool_->channels();
+  }
+
  protected:
   // Sends an asynchronous request via grpc to the Buyer FrontEnd Service.
   //
   // params: a pointer to the RawClientParams object which carries data used
   // by the grpc stub.
+  // Holds the call back if a GetBidsBatchScope is alive on the thread.
   void SendRpc(const std::string& hpke_secret,
-               RawClientParams<GetBidsRequest, GetBidsResponse,
-                               GetBidsResponse::GetBidsRawResponse>* params)
-      const override;
+               GetBidsClientParams* params) const override;
+
+ private:
+  friend class GetBidsBatchScope;
+  class GetBidsStreamCall;
+
+  // Sends a GetBids call.
+  void SendGetBids(const std::string& hpke_secret,
+                   GetBidsClientParams* params) const;
+
+  // Sends `calls`, made by clients of the same address, in a single
+  // GetBidsBatch call, with the context of the first call.
+  void SendGetBidsBatch(std::vector<GetBidsBatchScope::Call> calls) const;
+
+  // Sends a GetBidsStream call of the request of `params`, followed by
+  // `chunks` of its interest groups. Streams are not batched.
+  void SendGetBidsStream(const std::string& hpke_secret,
+                         std::vector<BuyerInput> chunks,
+                         GetBidsClientParams* params) const;
 
-  std::unique_ptr<BuyerFrontEnd::StubInterface> stub_;
+  const std::string server_addr_;
+  const int stream_interest_groups_per_chunk_;
+  std::unique_ptr<GrpcStubPool<BuyerFrontEnd::StubInterface>> stub_pool_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
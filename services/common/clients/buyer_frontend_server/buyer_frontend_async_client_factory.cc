@@ -15,6 +15,7 @@
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client_factory.h"
 
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
@@ -53,6 +54,7 @@ BuyerFrontEndAsyncClientFactory::BuyerFrontEndAsyncClientFactory(
               key_fetcher_manager, crypto_client,
               std::move(client_config_copy));
       bfe_addr_client_map.insert({bfe_endpoint.endpoint, bfe_client_ptr});
+      grpc_clients_.push_back(bfe_client_ptr);
       static_client_map->try_emplace(ig_owner, bfe_client_ptr);
     }
   }
@@ -67,4 +69,14 @@ BuyerFrontEndAsyncClientFactory::Get(absl::string_view ig_owner) const {
   return client_cache_->LookUp(ig_owner_str);
 }
 
+std::vector<std::shared_ptr<grpc::Channel>>
+BuyerFrontEndAsyncClientFactory::channels() const {
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  for (const auto& client : grpc_clients_) {
+    channels.insert(channels.end(), client->channels().begin(),
+                    client->channels().end());
+  }
+  return channels;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -19,6 +19,8 @@
 #include <string>
 #include <vector>
 
+#include <grpcpp/grpcpp.h>
+
 #include "absl/container/flat_hash_map.h"
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
 #include "services/common/clients/client_factory.h"
@@ -60,7 +62,13 @@ class BuyerFrontEndAsyncClientFactory
   std::shared_ptr<const BuyerFrontEndAsyncClient> Get(
       absl::string_view ig_owner) const override;
 
+  // Channels of the clients to all the BuyerFrontEnds.
+  std::vector<std::shared_ptr<grpc::Channel>> channels() const;
+
  private:
+  // Clients of each BuyerFrontEnd address, shared by the buyers hosted on it.
+  std::vector<std::shared_ptr<const BuyerFrontEndAsyncGrpcClient>>
+      grpc_clients_;
   std::unique_ptr<
       LocalCache<std::string, std::shared_ptr<const BuyerFrontEndAsyncClient>>>
       client_cache_;
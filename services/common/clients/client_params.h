@@ -15,6 +15,7 @@
 #ifndef FLEDGE_SERVICES_COMMON_CLIENTS_CLIENT_PARAMS_H_
 #define FLEDGE_SERVICES_COMMON_CLIENTS_CLIENT_PARAMS_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,6 +26,7 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "services/common/util/request_cancellation.h"
 #include "src/logger/request_context_logger.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -120,7 +122,7 @@ class RawClientParams {
     raw_callback_ = std::move(callback);
     response_ = std::make_unique<Response>();
     for (const auto& it : metadata) {
-      context_.AddMetadata(it.first, it.second);
+      context_->AddMetadata(it.first, it.second);
     }
   }
 
@@ -132,19 +134,40 @@ class RawClientParams {
   Request* RequestRef() { return request_.get(); }
 
   // Allows access to context param by gRPC
-  grpc::ClientContext* ContextRef() { return &context_; }
+  grpc::ClientContext* ContextRef() { return context_.get(); }
 
   // Allows access to response param by gRPC
   Response* ResponseRef() { return response_.get(); }
 
   // Sets a deadline for the gRPC request.
   void SetDeadline(absl::Duration timeout) {
-    context_.set_deadline(
+    context_->set_deadline(
         std::chrono::system_clock::now() +
         std::chrono::milliseconds(ToInt64Milliseconds(timeout)));
   }
 
+  // Sets the compression of the gRPC request, overriding that of the
+  // channel.
+  void SetCompressionAlgorithm(grpc_compression_algorithm algorithm) {
+    context_->set_compression_algorithm(algorithm);
+  }
+
+  // Cancels the gRPC request once `cancellation` is, including before it
+  // starts. No-op if `cancellation` is null.
+  void SetCancellation(std::shared_ptr<RequestCancellation> cancellation) {
+    if (cancellation == nullptr) {
+      return;
+    }
+    cancellation_ = std::move(cancellation);
+    // The context is shared since the cancellation may race with OnDone.
+    cancellation_id_ = cancellation_->Register(
+        [context = context_]() { context->TryCancel(); });
+  }
+
   void OnDone(const grpc::Status& status) {
+    if (cancellation_ != nullptr) {
+      cancellation_->Unregister(cancellation_id_);
+    }
     if (status.ok()) {
       std::move(raw_callback_)(std::move(raw_response_));
     } else {
@@ -162,7 +185,8 @@ class RawClientParams {
  private:
   // Parameters will be accessed by the gRPC code.
   // Destructed automatically after OnDone
-  grpc::ClientContext context_;
+  std::shared_ptr<grpc::ClientContext> context_ =
+      std::make_shared<grpc::ClientContext>();
   std::unique_ptr<Request> request_;
 
   std::unique_ptr<Response> response_;
@@ -172,6 +196,9 @@ class RawClientParams {
   // callback will only run once for a single gRPC call
   absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
       raw_callback_ = nullptr;
+
+  std::shared_ptr<RequestCancellation> cancellation_;
+  int64_t cancellation_id_ = 0;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,12 +14,126 @@
 
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 
+#include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// State of a streamed batch, shared by the callbacks of its requests and its
+// deadline, which may outlive the caller once the batch is over.
+struct BatchStream {
+  absl::Mutex mu;
+  int num_pending ABSL_GUARDED_BY(mu);
+  bool done ABSL_GUARDED_BY(mu) = false;
+  DispatchResponseCallback response_callback ABSL_GUARDED_BY(mu);
+  BatchStreamDoneCallback done_callback ABSL_GUARDED_BY(mu);
+  std::optional<server_common::TaskId> deadline_task ABSL_GUARDED_BY(mu);
+
+  void Finish(bool deadline_exceeded) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    done = true;
+    BatchStreamDoneCallback callback = std::move(done_callback);
+    // Releases the captures of the caller, which may be gone after the
+    // callback.
+    response_callback = nullptr;
+    callback(deadline_exceeded);
+  }
+
+  // Hands out the response, then ends the batch after the last one.
+  void OnResponse(int index, absl::StatusOr<DispatchResponse> response,
+                  server_common::Executor* executor) ABSL_LOCKS_EXCLUDED(mu) {
+    absl::MutexLock lock(&mu);
+    if (done) {
+      return;
+    }
+    response_callback(index, std::move(response));
+    if (--num_pending > 0) {
+      return;
+    }
+    if (deadline_task.has_value()) {
+      executor->Cancel(*deadline_task);
+    }
+    Finish(/*deadline_exceeded=*/false);
+  }
+};
+
+}  // namespace
+
 absl::Status CodeDispatchClient::BatchExecute(
     std::vector<DispatchRequest>& batch,
     BatchDispatchDoneCallback batch_callback) {
   return dispatcher_.BatchExecute(batch, std::move(batch_callback));
 }
+
+absl::Status CodeDispatchClient::BatchExecute(
+    std::vector<DispatchRequest>& batch, const BatchSharedInput& shared_input,
+    BatchDispatchDoneCallback batch_callback) {
+  // Dispatches through the virtual overload above, rather than through
+  // V8Dispatcher's, so that subclasses see the bound batch.
+  PS_RETURN_IF_ERROR(shared_input.BindTo(batch));
+  return BatchExecute(batch, std::move(batch_callback));
+}
+
+absl::Status CodeDispatchClient::BatchExecuteStreaming(
+    std::vector<DispatchRequest>& batch,
+    DispatchResponseCallback response_callback,
+    BatchStreamDoneCallback done_callback, absl::Duration deadline) {
+  // The batch belongs to the caller, which may be gone as soon as the last
+  // response or the deadline ends the stream, so it is copied up front.
+  std::vector<std::unique_ptr<DispatchRequest>> requests;
+  requests.reserve(batch.size());
+  for (const DispatchRequest& request : batch) {
+    requests.push_back(std::make_unique<DispatchRequest>(request));
+  }
+  auto stream = std::make_shared<BatchStream>();
+  {
+    absl::MutexLock lock(&stream->mu);
+    stream->num_pending = batch.size();
+    stream->response_callback = std::move(response_callback);
+    stream->done_callback = std::move(done_callback);
+    if (batch.empty()) {
+      stream->Finish(/*deadline_exceeded=*/false);
+      return absl::OkStatus();
+    }
+  }
+  if (executor_ != nullptr && deadline != absl::InfiniteDuration()) {
+    server_common::TaskId deadline_task =
+        executor_->RunAfter(deadline, [stream]() {
+          absl::MutexLock lock(&stream->mu);
+          if (!stream->done) {
+            stream->Finish(/*deadline_exceeded=*/true);
+          }
+        });
+    absl::MutexLock lock(&stream->mu);
+    stream->deadline_task = deadline_task;
+  }
+  for (int i = 0; i < requests.size(); ++i) {
+    if (absl::Status status = dispatcher_.Execute(
+            std::move(requests[i]),
+            [stream, i, executor = executor_](
+                absl::StatusOr<DispatchResponse> response) {
+              stream->OnResponse(i, std::move(response), executor);
+            });
+        !status.ok()) {
+      stream->OnResponse(i, std::move(status), executor_);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CodeDispatchClient::BatchExecuteStreaming(
+    std::vector<DispatchRequest>& batch, const BatchSharedInput& shared_input,
+    DispatchResponseCallback response_callback,
+    BatchStreamDoneCallback done_callback, absl::Duration deadline) {
+  PS_RETURN_IF_ERROR(shared_input.BindTo(batch));
+  return BatchExecuteStreaming(batch, std::move(response_callback),
+                               std::move(done_callback), deadline);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -20,17 +20,36 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "src/concurrent/executor.h"
 #include "src/roma/interface/roma.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Called with the response of each request of a streamed batch as soon as it
+// finishes, along with the index of the request in the batch.
+using DispatchResponseCallback = absl::AnyInvocable<void(
+    int index, absl::StatusOr<DispatchResponse> response)>;
+// Called once a streamed batch is over. deadline_exceeded is true if the
+// batch deadline was reached first, in which case the responses of the
+// requests still running are dropped.
+using BatchStreamDoneCallback =
+    absl::AnyInvocable<void(bool deadline_exceeded)>;
+
 // This class acts as a client for dispatching javascript + wasm to be
 // executed in a different process sandbox.
 class CodeDispatchClient {
  public:
-  explicit CodeDispatchClient(V8Dispatcher& dispatcher)
-      : dispatcher_(dispatcher) {}
+  // executor: schedules the deadlines of streamed batches, which have none
+  // without it. Must outlive the client.
+  explicit CodeDispatchClient(V8Dispatcher& dispatcher,
+                              server_common::Executor* executor = nullptr)
+      : dispatcher_(dispatcher), executor_(executor) {}
+
+  // Executor of the server, on which callers may also spread the building of
+  // their batches. Null if the client has none.
+  server_common::Executor* executor() const { return executor_; }
 
   // Execute a batch of requests asynchronously via the code dispatcher library.
   // There are no guarantees on request order processing.
@@ -43,8 +62,42 @@ class CodeDispatchClient {
   virtual absl::Status BatchExecute(std::vector<DispatchRequest>& batch,
                                     BatchDispatchDoneCallback batch_callback);
 
+  // Binds `shared_input` into every request of the batch and then dispatches
+  // the batch as above. Arguments common to all requests (e.g. buyer signals)
+  // are thereby built and held once per batch instead of once per request.
+  absl::Status BatchExecute(std::vector<DispatchRequest>& batch,
+                            const BatchSharedInput& shared_input,
+                            BatchDispatchDoneCallback batch_callback);
+
+  // Executes a batch of requests asynchronously, like BatchExecute, but hands
+  // out each response as soon as its request finishes, so that callers can
+  // fold the responses in while the slower requests still run.
+  //
+  // response_callback: called once per request of the batch, or not at all
+  // for the requests still running at the deadline. Calls are serialized.
+  // done_callback: called after the last response_callback call, once all
+  // requests finished or once the deadline is reached.
+  // deadline: time after which the batch is over, keeping the responses
+  // received by then.
+  // return: a status indicating if the batch was properly scheduled. Requests
+  // which fail to be scheduled get their error as a response.
+  virtual absl::Status BatchExecuteStreaming(
+      std::vector<DispatchRequest>& batch,
+      DispatchResponseCallback response_callback,
+      BatchStreamDoneCallback done_callback,
+      absl::Duration deadline = absl::InfiniteDuration());
+
+  // Binds `shared_input` into every request of the batch and then streams the
+  // batch as above.
+  absl::Status BatchExecuteStreaming(
+      std::vector<DispatchRequest>& batch, const BatchSharedInput& shared_input,
+      DispatchResponseCallback response_callback,
+      BatchStreamDoneCallback done_callback,
+      absl::Duration deadline = absl::InfiniteDuration());
+
  private:
   V8Dispatcher& dispatcher_;
+  server_common::Executor* executor_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -14,9 +14,14 @@
 
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/time/time.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
 
@@ -47,5 +52,170 @@ TEST(CodeDispatchClient, DelegatesToCodeDispatchLibrary) {
   done.Wait();
 }
 
+TEST(CodeDispatchClient, BindsSharedInputIntoEveryRequest) {
+  MockCodeDispatchClient client;
+  DispatchRequest foo{"foo"};
+  foo.input = {std::make_shared<std::string>("foo_ig"), nullptr};
+  DispatchRequest bar{"bar"};
+  bar.input = {std::make_shared<std::string>("bar_ig")};
+  std::vector<DispatchRequest> requests{foo, bar};
+
+  BatchSharedInput shared_input;
+  auto shared_signals = std::make_shared<std::string>("shared_signals");
+  shared_input.Set(1, shared_signals);
+
+  EXPECT_CALL(client, BatchExecute)
+      .WillOnce([&shared_signals](std::vector<DispatchRequest>& batch,
+                                  BatchDispatchDoneCallback batch_callback) {
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.input.size(), 2);
+          // The same buffer is referenced by every request.
+          EXPECT_EQ(request.input[1], shared_signals);
+        }
+        EXPECT_EQ(*batch.at(0).input[0], "foo_ig");
+        EXPECT_EQ(*batch.at(1).input[0], "bar_ig");
+        return absl::OkStatus();
+      });
+  CodeDispatchClient& base_client = client;
+  EXPECT_TRUE(base_client
+                  .BatchExecute(requests, shared_input,
+                                [](const std::vector<
+                                    absl::StatusOr<DispatchResponse>>&) {})
+                  .ok());
+}
+
+TEST(CodeDispatchClient, BindsSharedTagsIntoEveryRequest) {
+  MockCodeDispatchClient client;
+  DispatchRequest foo{"foo"};
+  foo.tags["own_tag"] = "foo";
+  std::vector<DispatchRequest> requests{foo, {"bar"}};
+
+  BatchSharedInput shared_input;
+  shared_input.SetTag("timeout_ms", "50");
+  shared_input.SetTag("timeout_ms", "100");
+
+  EXPECT_CALL(client, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.tags.at("timeout_ms"), "100");
+        }
+        EXPECT_EQ(batch.at(0).tags.at("own_tag"), "foo");
+        EXPECT_EQ(batch.at(1).tags.size(), 1);
+        return absl::OkStatus();
+      });
+  CodeDispatchClient& base_client = client;
+  EXPECT_TRUE(base_client
+                  .BatchExecute(requests, shared_input,
+                                [](const std::vector<
+                                    absl::StatusOr<DispatchResponse>>&) {})
+                  .ok());
+}
+
+TEST(CodeDispatchClient, RejectsRequestOverridingSharedInput) {
+  MockCodeDispatchClient client;
+  DispatchRequest foo{"foo"};
+  foo.input = {std::make_shared<std::string>("foo_ig"),
+               std::make_shared<std::string>("own_signals")};
+  std::vector<DispatchRequest> requests{foo};
+
+  BatchSharedInput shared_input;
+  shared_input.Set(1, std::make_shared<std::string>("shared_signals"));
+
+  EXPECT_CALL(client, BatchExecute).Times(0);
+  CodeDispatchClient& base_client = client;
+  EXPECT_FALSE(base_client
+                   .BatchExecute(requests, shared_input,
+                                 [](const std::vector<
+                                     absl::StatusOr<DispatchResponse>>&) {})
+                   .ok());
+}
+
+TEST(CodeDispatchClient, StreamsResponsesAsRequestsFinish) {
+  MockV8Dispatcher dispatcher;
+  std::vector<DispatchRequest> requests{{"foo"}, {"bar"}};
+  std::vector<DispatchDoneCallback> callbacks;
+  EXPECT_CALL(dispatcher, Execute)
+      .Times(2)
+      .WillRepeatedly([&callbacks](std::unique_ptr<DispatchRequest> request,
+                                   DispatchDoneCallback done_callback) {
+        callbacks.push_back(std::move(done_callback));
+        return absl::OkStatus();
+      });
+
+  std::vector<int> indexes;
+  bool done = false;
+  CodeDispatchClient client(dispatcher);
+  ASSERT_TRUE(client
+                  .BatchExecuteStreaming(
+                      requests,
+                      [&indexes](int index,
+                                 absl::StatusOr<DispatchResponse> response) {
+                        EXPECT_TRUE(response.ok());
+                        indexes.push_back(index);
+                      },
+                      [&done](bool deadline_exceeded) {
+                        EXPECT_FALSE(deadline_exceeded);
+                        done = true;
+                      })
+                  .ok());
+  ASSERT_EQ(callbacks.size(), 2);
+  callbacks[1](DispatchResponse{.id = "bar"});
+  EXPECT_EQ(indexes, std::vector<int>{1});
+  EXPECT_FALSE(done);
+  callbacks[0](DispatchResponse{.id = "foo"});
+  EXPECT_EQ(indexes, (std::vector<int>{1, 0}));
+  EXPECT_TRUE(done);
+}
+
+TEST(CodeDispatchClient, EndsStreamedBatchesAtTheDeadline) {
+  MockV8Dispatcher dispatcher;
+  MockExecutor executor;
+  std::vector<DispatchRequest> requests{{"foo"}, {"bar"}, {"baz"}};
+  std::vector<DispatchDoneCallback> callbacks;
+  EXPECT_CALL(dispatcher, Execute)
+      .Times(3)
+      .WillOnce([](std::unique_ptr<DispatchRequest> request,
+                   DispatchDoneCallback done_callback) {
+        return absl::UnavailableError("Queue full");
+      })
+      .WillRepeatedly([&callbacks](std::unique_ptr<DispatchRequest> request,
+                                   DispatchDoneCallback done_callback) {
+        callbacks.push_back(std::move(done_callback));
+        return absl::OkStatus();
+      });
+  absl::AnyInvocable<void()> deadline;
+  EXPECT_CALL(executor, RunAfter(absl::Milliseconds(50), testing::_))
+      .WillOnce([&deadline](absl::Duration duration,
+                            absl::AnyInvocable<void()> closure) {
+        deadline = std::move(closure);
+        return server_common::TaskId();
+      });
+
+  std::vector<absl::StatusCode> codes;
+  bool deadline_exceeded = false;
+  CodeDispatchClient client(dispatcher, &executor);
+  ASSERT_TRUE(client
+                  .BatchExecuteStreaming(
+                      requests,
+                      [&codes](int index,
+                               absl::StatusOr<DispatchResponse> response) {
+                        codes.push_back(response.status().code());
+                      },
+                      [&deadline_exceeded](bool exceeded) {
+                        deadline_exceeded = exceeded;
+                      },
+                      absl::Milliseconds(50))
+                  .ok());
+  ASSERT_EQ(callbacks.size(), 2);
+  callbacks[0](DispatchResponse{.id = "bar"});
+  deadline();
+  EXPECT_TRUE(deadline_exceeded);
+  // Responses after the deadline are dropped.
+  callbacks[1](DispatchResponse{.id = "baz"});
+  EXPECT_EQ(codes, (std::vector<absl::StatusCode>{
+                       absl::StatusCode::kUnavailable, absl::StatusCode::kOk}));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,6 +14,8 @@
 
 #include "services/common/clients/code_dispatcher/request_context.h"
 
+#include <limits>
+
 namespace privacy_sandbox::bidding_auction_servers {
 
 RomaRequestContext::RomaRequestContext(
@@ -27,6 +29,23 @@ RomaRequestContext::GetLogContext() const {
   return request_logging_context_;
 }
 
+absl::Time RomaRequestContext::GetDeadline() const {
+  const int64_t deadline_unix_nanos =
+      deadline_unix_nanos_.load(std::memory_order_relaxed);
+  if (deadline_unix_nanos == std::numeric_limits<int64_t>::max()) {
+    return absl::InfiniteFuture();
+  }
+  return absl::FromUnixNanos(deadline_unix_nanos);
+}
+
+void RomaRequestContext::SetDeadline(absl::Time deadline) {
+  deadline_unix_nanos_.store(
+      deadline == absl::InfiniteFuture()
+          ? std::numeric_limits<int64_t>::max()
+          : absl::ToUnixNanos(deadline),
+      std::memory_order_relaxed);
+}
+
 RomaRequestSharedContext::RomaRequestSharedContext(
     const std::shared_ptr<RomaRequestContext>& roma_request_context)
     : roma_request_context_(roma_request_context) {}
@@ -54,4 +73,8 @@ RomaRequestSharedContext RomaRequestContextFactory::Create() {
   return RomaRequestSharedContext(roma_request_context_);
 }
 
+void RomaRequestContextFactory::SetDeadline(absl::Time deadline) {
+  roma_request_context_->SetDeadline(deadline);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
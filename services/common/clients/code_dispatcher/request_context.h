@@ -17,12 +17,16 @@
 #ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_REQUEST_CONTEXT_H_
 #define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_REQUEST_CONTEXT_H_
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "src/logger/request_context_impl.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -38,8 +42,17 @@ class RomaRequestContext {
 
   const privacy_sandbox::server_common::log::ContextImpl& GetLogContext() const;
 
+  // Time past which Roma kills the executions of the request, which bounds
+  // the calls they make out of Roma, e.g. to the inference sidecar. The
+  // infinite future until set.
+  absl::Time GetDeadline() const;
+  void SetDeadline(absl::Time deadline);
+
  private:
   privacy_sandbox::server_common::log::ContextImpl request_logging_context_;
+  // Set while executions of the request may read it.
+  std::atomic<int64_t> deadline_unix_nanos_ =
+      std::numeric_limits<int64_t>::max();
 };
 
 class RomaRequestContextFactory;
@@ -72,6 +85,10 @@ class RomaRequestContextFactory {
           debug_config);
   RomaRequestSharedContext Create();
 
+  // Sets the deadline of the executions dispatched from now on, see
+  // RomaRequestContext::GetDeadline.
+  void SetDeadline(absl::Time deadline);
+
   RomaRequestContextFactory(RomaRequestContextFactory&& other) = delete;
   RomaRequestContextFactory& operator=(RomaRequestContextFactory&& other) =
       delete;
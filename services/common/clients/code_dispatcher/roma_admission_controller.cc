@@ -0,0 +1,136 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr absl::string_view kProtectedAudienceTag = "pa";
+inline constexpr absl::string_view kProtectedAppSignalsTag = "pas";
+inline constexpr absl::string_view kReportingTag = "reporting";
+
+int Index(DispatchTenant tenant) { return static_cast<int>(tenant); }
+
+// Number of waves needed to run num_requests on num_workers.
+int64_t NumWaves(int64_t num_requests, int num_workers) {
+  return (num_requests + num_workers - 1) / num_workers;
+}
+
+}  // namespace
+
+absl::string_view DispatchTenantTagValue(DispatchTenant tenant) {
+  switch (tenant) {
+    case DispatchTenant::kProtectedAppSignals:
+      return kProtectedAppSignalsTag;
+    case DispatchTenant::kReporting:
+      return kReportingTag;
+    case DispatchTenant::kProtectedAudience:
+    default:
+      return kProtectedAudienceTag;
+  }
+}
+
+DispatchTenant ParseDispatchTenant(absl::string_view tag_value) {
+  if (tag_value == kProtectedAppSignalsTag) {
+    return DispatchTenant::kProtectedAppSignals;
+  }
+  if (tag_value == kReportingTag) {
+    return DispatchTenant::kReporting;
+  }
+  return DispatchTenant::kProtectedAudience;
+}
+
+RomaAdmissionController::RomaAdmissionController(
+    const RomaAdmissionConfig& config)
+    : num_workers_(std::max(config.num_workers, 1)),
+      capacity_(std::max(config.capacity, 1)),
+      latency_smoothing_(config.latency_smoothing) {
+  for (int i = 0; i < kNumDispatchTenants; ++i) {
+    reserved_[i] = static_cast<int>(
+        std::ceil(std::clamp(config.reserved_shares[i], 0.0, 1.0) * capacity_));
+  }
+}
+
+absl::StatusOr<int> RomaAdmissionController::Admit(DispatchTenant tenant,
+                                                   int num_requests,
+                                                   absl::Duration budget) {
+  absl::MutexLock lock(&mu_);
+  // Capacity left, less what the other tenants hold back and do not use.
+  int available = capacity_ - total_in_flight_;
+  for (int i = 0; i < kNumDispatchTenants; ++i) {
+    if (i != Index(tenant)) {
+      available -= std::max(reserved_[i] - in_flight_[i], 0);
+    }
+  }
+  int64_t num_admitted = std::min(num_requests, available);
+
+  if (request_time_ > absl::ZeroDuration() &&
+      budget != absl::InfiniteDuration()) {
+    // The requests in flight go first, only the waves left in the budget
+    // after theirs can be used.
+    const int64_t num_waves = absl::IDivDuration(budget, request_time_, &budget);
+    num_admitted = std::min(
+        num_admitted, num_waves * num_workers_ - int64_t{total_in_flight_});
+  }
+
+  if (num_admitted <= 0) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "No capacity left in Roma for the ", DispatchTenantTagValue(tenant),
+        " batch of ", num_requests, " requests, ", total_in_flight_,
+        " requests are in flight"));
+  }
+  in_flight_[Index(tenant)] += num_admitted;
+  total_in_flight_ += num_admitted;
+  return static_cast<int>(num_admitted);
+}
+
+void RomaAdmissionController::Release(DispatchTenant tenant, int num_requests,
+                                      absl::Duration latency) {
+  absl::MutexLock lock(&mu_);
+  in_flight_[Index(tenant)] -= num_requests;
+  total_in_flight_ -= num_requests;
+  if (latency == absl::InfiniteDuration() || num_requests <= 0) {
+    return;
+  }
+  // The latency includes the wait in the queue, which makes the estimate err
+  // on the side of shedding under load.
+  const absl::Duration request_time =
+      latency / NumWaves(num_requests, num_workers_);
+  if (request_time_ == absl::ZeroDuration()) {
+    request_time_ = request_time;
+  } else {
+    request_time_ = latency_smoothing_ * request_time +
+                    (1 - latency_smoothing_) * request_time_;
+  }
+}
+
+int RomaAdmissionController::InFlight(DispatchTenant tenant) const {
+  absl::MutexLock lock(&mu_);
+  return in_flight_[Index(tenant)];
+}
+
+absl::Duration RomaAdmissionController::RequestTime() const {
+  absl::MutexLock lock(&mu_);
+  return request_time_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
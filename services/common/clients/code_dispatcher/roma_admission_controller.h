@@ -0,0 +1,112 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_ADMISSION_CONTROLLER_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_ADMISSION_CONTROLLER_H_
+
+#include <array>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Workloads sharing the Roma workers of a server.
+enum class DispatchTenant {
+  // Bids generated and ads scored for protected audience auctions.
+  kProtectedAudience = 0,
+  // UDFs run for protected app signals.
+  kProtectedAppSignals = 1,
+  // Reporting UDFs run once the auction is over.
+  kReporting = 2,
+};
+inline constexpr int kNumDispatchTenants = 3;
+
+// Tag of dispatch requests naming their tenant, read from the first request of
+// a batch. Requests without it belong to kProtectedAudience.
+inline constexpr char kDispatchTenantTag[] = "DispatchTenant";
+
+// Value of kDispatchTenantTag for the tenant.
+absl::string_view DispatchTenantTagValue(DispatchTenant tenant);
+
+// Tenant with the given value of kDispatchTenantTag, kProtectedAudience for
+// unknown values.
+DispatchTenant ParseDispatchTenant(absl::string_view tag_value);
+
+struct RomaAdmissionConfig {
+  int num_workers = 1;
+  // Number of requests that can be in Roma at once, executing or queued.
+  int capacity = 1;
+  // Share of the capacity held back for each tenant. The other tenants cannot
+  // take it, however busy they are, so that none of them starves the others.
+  std::array<double, kNumDispatchTenants> reserved_shares = {};
+  // Weight of the latest batch in the moving average of the time taken by a
+  // request.
+  double latency_smoothing = 0.2;
+};
+
+// Decides which requests are handed to Roma, instead of letting Roma reject
+// them once its queue is full. A batch is admitted in part, its first
+// requests only, if the tenant is short of capacity or if the whole batch is
+// not predicted to be done within its budget. Thread-safe.
+//
+// The wait is predicted from the requests already in Roma, which are run in
+// waves of num_workers, and from the average time a request takes.
+class RomaAdmissionController {
+ public:
+  explicit RomaAdmissionController(const RomaAdmissionConfig& config);
+
+  RomaAdmissionController(const RomaAdmissionController&) = delete;
+  RomaAdmissionController& operator=(const RomaAdmissionController&) = delete;
+
+  // Returns how many of the num_requests of a batch of the tenant can be
+  // dispatched, to be released with Release once done. Fails with
+  // ResourceExhausted if not even one can.
+  //
+  // budget: time left for the batch to run, InfiniteDuration if unbounded.
+  absl::StatusOr<int> Admit(DispatchTenant tenant, int num_requests,
+                            absl::Duration budget) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Releases the admitted requests of a batch. The latency of the batch, if
+  // it was run, updates the average time taken by a request.
+  void Release(DispatchTenant tenant, int num_requests,
+               absl::Duration latency = absl::InfiniteDuration())
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Number of requests of the tenant in Roma.
+  int InFlight(DispatchTenant tenant) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Average time taken by a request, zero until a batch was run.
+  absl::Duration RequestTime() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int num_workers_;
+  const int capacity_;
+  std::array<int, kNumDispatchTenants> reserved_;
+  const double latency_smoothing_;
+
+  mutable absl::Mutex mu_;
+  std::array<int, kNumDispatchTenants> in_flight_ ABSL_GUARDED_BY(mu_) = {};
+  int total_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::Duration request_time_ ABSL_GUARDED_BY(mu_) = absl::ZeroDuration();
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_ADMISSION_CONTROLLER_H_
@@ -0,0 +1,123 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::Duration kNoBudget = absl::InfiniteDuration();
+
+TEST(RomaAdmissionControllerTest, AdmitsUpToCapacity) {
+  RomaAdmissionController controller({.num_workers = 2, .capacity = 10});
+  auto admitted =
+      controller.Admit(DispatchTenant::kProtectedAudience, 6, kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 6);
+
+  // The second batch is truncated to what is left.
+  admitted = controller.Admit(DispatchTenant::kProtectedAudience, 6, kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 4);
+  EXPECT_EQ(controller.InFlight(DispatchTenant::kProtectedAudience), 10);
+
+  EXPECT_EQ(
+      controller.Admit(DispatchTenant::kProtectedAudience, 1, kNoBudget)
+          .status()
+          .code(),
+      absl::StatusCode::kResourceExhausted);
+
+  controller.Release(DispatchTenant::kProtectedAudience, 4);
+  admitted = controller.Admit(DispatchTenant::kProtectedAudience, 1, kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 1);
+}
+
+TEST(RomaAdmissionControllerTest, HoldsBackReservedShares) {
+  RomaAdmissionController controller(
+      {.num_workers = 2, .capacity = 10, .reserved_shares = {0, 0.2, 0.3}});
+  // Protected audience cannot take what is held back for the others.
+  auto admitted =
+      controller.Admit(DispatchTenant::kProtectedAudience, 10, kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 5);
+
+  admitted = controller.Admit(DispatchTenant::kReporting, 10, kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 3);
+  admitted = controller.Admit(DispatchTenant::kProtectedAppSignals, 10,
+                              kNoBudget);
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 2);
+
+  // Unused reserved capacity of a tenant goes to the tenant only.
+  controller.Release(DispatchTenant::kReporting, 3);
+  EXPECT_FALSE(
+      controller.Admit(DispatchTenant::kProtectedAudience, 1, kNoBudget).ok());
+  EXPECT_TRUE(controller.Admit(DispatchTenant::kReporting, 1, kNoBudget).ok());
+}
+
+TEST(RomaAdmissionControllerTest, TruncatesBatchesToTheBudget) {
+  RomaAdmissionController controller({.num_workers = 2, .capacity = 100});
+  // A batch of 4 requests on 2 workers runs in 2 waves of 10ms.
+  ASSERT_TRUE(
+      controller.Admit(DispatchTenant::kProtectedAudience, 4, kNoBudget).ok());
+  controller.Release(DispatchTenant::kProtectedAudience, 4,
+                     absl::Milliseconds(20));
+  EXPECT_EQ(controller.RequestTime(), absl::Milliseconds(10));
+
+  // 3 waves fit in 35ms.
+  auto admitted = controller.Admit(DispatchTenant::kProtectedAudience, 10,
+                                   absl::Milliseconds(35));
+  ASSERT_TRUE(admitted.ok()) << admitted.status();
+  EXPECT_EQ(*admitted, 6);
+
+  // The requests in flight already take the 3 waves.
+  EXPECT_EQ(controller
+                .Admit(DispatchTenant::kProtectedAppSignals, 1,
+                       absl::Milliseconds(35))
+                .status()
+                .code(),
+            absl::StatusCode::kResourceExhausted);
+  // Budgets shorter than a request are shed.
+  controller.Release(DispatchTenant::kProtectedAudience, 6);
+  EXPECT_FALSE(controller
+                   .Admit(DispatchTenant::kProtectedAudience, 1,
+                          absl::Milliseconds(5))
+                   .ok());
+}
+
+TEST(RomaAdmissionControllerTest, SmoothsRequestTime) {
+  RomaAdmissionController controller(
+      {.num_workers = 1, .capacity = 10, .latency_smoothing = 0.5});
+  ASSERT_TRUE(controller.Admit(DispatchTenant::kReporting, 1, kNoBudget).ok());
+  controller.Release(DispatchTenant::kReporting, 1, absl::Milliseconds(10));
+  ASSERT_TRUE(controller.Admit(DispatchTenant::kReporting, 1, kNoBudget).ok());
+  controller.Release(DispatchTenant::kReporting, 1, absl::Milliseconds(30));
+  EXPECT_EQ(controller.RequestTime(), absl::Milliseconds(20));
+}
+
+TEST(RomaAdmissionControllerTest, ParsesTenantTags) {
+  for (DispatchTenant tenant :
+       {DispatchTenant::kProtectedAudience, DispatchTenant::kProtectedAppSignals,
+        DispatchTenant::kReporting}) {
+    EXPECT_EQ(ParseDispatchTenant(DispatchTenantTagValue(tenant)), tenant);
+  }
+  EXPECT_EQ(ParseDispatchTenant(""), DispatchTenant::kProtectedAudience);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,174 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_BATCH_SCHEDULER_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_BATCH_SCHEDULER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct RomaBatchPartitionConfig {
+  // Requests per sub-batch. Batches no larger than this are dispatched whole.
+  // Batches are never split if 0.
+  int max_batch_size = 0;
+  // Sub-batches of all the batches split handed to Roma at once.
+  int max_batches_in_flight = 1;
+};
+
+// Splits the batches larger than max_batch_size into sub-batches, and hands
+// the sub-batches of all such batches to Roma in turns, a few at a time. A
+// batch of hundreds of requests then no longer takes all the workers until
+// it is done, while the batches dispatched after it wait in the Roma queue:
+// they get their share of the workers as soon as a sub-batch is done.
+//
+// The callback of a split batch is called once with the responses of all its
+// sub-batches, in the order of its requests, as if the batch was not split.
+//
+// `Submit` hands a sub-batch to Roma, with the same contract as
+// RomaService::BatchExecute. Thread-safe.
+template <typename Request, typename Response>
+class RomaBatchScheduler {
+ public:
+  using Results = std::vector<absl::StatusOr<Response>>;
+  using Callback = absl::AnyInvocable<void(const Results&)>;
+  using Submit =
+      absl::AnyInvocable<absl::Status(std::vector<Request>&, Callback)>;
+
+  RomaBatchScheduler(RomaBatchPartitionConfig config, Submit submit)
+      : config_(config), submit_(std::move(submit)) {
+    config_.max_batches_in_flight =
+        std::max(config_.max_batches_in_flight, 1);
+  }
+
+  RomaBatchScheduler(const RomaBatchScheduler&) = delete;
+  RomaBatchScheduler& operator=(const RomaBatchScheduler&) = delete;
+
+  // Whether a batch of `batch_size` requests is split.
+  bool ShouldSplit(size_t batch_size) const {
+    return config_.max_batch_size > 0 &&
+           batch_size > static_cast<size_t>(config_.max_batch_size);
+  }
+
+  // Queues the sub-batches of `batch`. A sub-batch Roma fails to take is
+  // answered with the error, so `callback` is always called.
+  void Schedule(std::vector<Request> batch, Callback callback) {
+    auto job = std::make_shared<Job>();
+    job->results.resize(batch.size());
+    job->num_pending = batch.size();
+    job->requests = std::move(batch);
+    job->callback = std::move(callback);
+    {
+      absl::MutexLock lock(&mu_);
+      ready_.push_back(std::move(job));
+    }
+    Pump();
+  }
+
+  // Sub-batches handed to Roma and not done yet.
+  int BatchesInFlight() const {
+    absl::MutexLock lock(&mu_);
+    return in_flight_;
+  }
+
+ private:
+  struct Job {
+    std::vector<Request> requests;
+    Results results;
+    // Next request to hand to Roma.
+    size_t next = 0;
+    // Requests not done yet.
+    size_t num_pending = 0;
+    Callback callback;
+  };
+
+  // Hands sub-batches to Roma, one per batch in turn, while fewer than
+  // max_batches_in_flight are.
+  void Pump() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      size_t offset;
+      std::vector<Request> sub_batch;
+      {
+        absl::MutexLock lock(&mu_);
+        if (in_flight_ >= config_.max_batches_in_flight || ready_.empty()) {
+          return;
+        }
+        job = std::move(ready_.front());
+        ready_.pop_front();
+        offset = job->next;
+        job->next = std::min(offset + config_.max_batch_size,
+                             job->requests.size());
+        sub_batch.assign(
+            std::make_move_iterator(job->requests.begin() + offset),
+            std::make_move_iterator(job->requests.begin() + job->next));
+        if (job->next < job->requests.size()) {
+          ready_.push_back(job);
+        }
+        ++in_flight_;
+      }
+      const size_t size = sub_batch.size();
+      if (absl::Status status = submit_(
+              sub_batch,
+              [this, job, offset, size](const Results& results) {
+                OnDone(*job, offset, size, results);
+                Pump();
+              });
+          !status.ok()) {
+        OnDone(*job, offset, size, Results(size, status));
+      }
+    }
+  }
+
+  // Records the results of the `size` requests at `offset`, and calls back
+  // once all the sub-batches of the job are done.
+  void OnDone(Job& job, size_t offset, size_t size, const Results& results) {
+    bool job_done;
+    {
+      absl::MutexLock lock(&mu_);
+      std::copy(results.begin(),
+                results.begin() + std::min(size, results.size()),
+                job.results.begin() + offset);
+      job.num_pending -= size;
+      job_done = job.num_pending == 0;
+      --in_flight_;
+    }
+    if (job_done) {
+      job.callback(job.results);
+    }
+  }
+
+  RomaBatchPartitionConfig config_;
+  Submit submit_;
+  mutable absl::Mutex mu_;
+  // Batches with sub-batches left to hand to Roma, in turn.
+  std::deque<std::shared_ptr<Job>> ready_ ABSL_GUARDED_BY(mu_);
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_BATCH_SCHEDULER_H_
@@ -0,0 +1,131 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_batch_scheduler.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using Scheduler = RomaBatchScheduler<int, int>;
+
+// Roma stand-in holding the sub-batches handed to it until they are run.
+struct FakeRoma {
+  std::vector<std::pair<std::vector<int>, Scheduler::Callback>> pending;
+  absl::Status status = absl::OkStatus();
+
+  Scheduler::Submit Submit() {
+    return [this](std::vector<int>& batch, Scheduler::Callback callback) {
+      if (!status.ok()) {
+        return status;
+      }
+      pending.emplace_back(batch, std::move(callback));
+      return absl::OkStatus();
+    };
+  }
+
+  // Runs the oldest sub-batch, answering each request with its negation.
+  std::vector<int> RunNext() {
+    auto [batch, callback] = std::move(pending.front());
+    pending.erase(pending.begin());
+    Scheduler::Results results;
+    for (int request : batch) {
+      results.push_back(-request);
+    }
+    callback(results);
+    return batch;
+  }
+};
+
+std::vector<int> Iota(int from, int size) {
+  std::vector<int> batch;
+  for (int i = 0; i < size; ++i) {
+    batch.push_back(from + i);
+  }
+  return batch;
+}
+
+TEST(RomaBatchSchedulerTest, SplitsOnlyBatchesLargerThanTheMaxSize) {
+  FakeRoma roma;
+  Scheduler disabled({.max_batch_size = 0}, roma.Submit());
+  EXPECT_FALSE(disabled.ShouldSplit(1000));
+  Scheduler scheduler({.max_batch_size = 4}, roma.Submit());
+  EXPECT_FALSE(scheduler.ShouldSplit(4));
+  EXPECT_TRUE(scheduler.ShouldSplit(5));
+}
+
+TEST(RomaBatchSchedulerTest, AnswersSplitBatchInRequestOrder) {
+  FakeRoma roma;
+  Scheduler scheduler({.max_batch_size = 2, .max_batches_in_flight = 2},
+                      roma.Submit());
+  std::vector<int> responses;
+  scheduler.Schedule(Iota(1, 5), [&responses](const auto& results) {
+    for (const absl::StatusOr<int>& result : results) {
+      responses.push_back(*result);
+    }
+  });
+  ASSERT_EQ(roma.pending.size(), 2);
+  EXPECT_EQ(scheduler.BatchesInFlight(), 2);
+  // The second sub-batch is done first.
+  std::swap(roma.pending[0], roma.pending[1]);
+  while (!roma.pending.empty()) {
+    roma.RunNext();
+  }
+  EXPECT_EQ(responses, (std::vector<int>{-1, -2, -3, -4, -5}));
+  EXPECT_EQ(scheduler.BatchesInFlight(), 0);
+}
+
+TEST(RomaBatchSchedulerTest, InterleavesSubBatchesOfConcurrentBatches) {
+  FakeRoma roma;
+  Scheduler scheduler({.max_batch_size = 2, .max_batches_in_flight = 1},
+                      roma.Submit());
+  int num_done = 0;
+  scheduler.Schedule(Iota(0, 6), [&num_done](const auto&) { ++num_done; });
+  scheduler.Schedule(Iota(100, 2), [&num_done](const auto&) { ++num_done; });
+  // The large batch had its turn before the small one was queued, the small
+  // one then takes the next turn rather than wait for the rest of it.
+  EXPECT_EQ(roma.RunNext(), (std::vector<int>{0, 1}));
+  EXPECT_EQ(roma.RunNext(), (std::vector<int>{2, 3}));
+  EXPECT_EQ(roma.RunNext(), (std::vector<int>{100, 101}));
+  EXPECT_EQ(num_done, 1);
+  EXPECT_EQ(roma.RunNext(), (std::vector<int>{4, 5}));
+  EXPECT_EQ(num_done, 2);
+}
+
+TEST(RomaBatchSchedulerTest, AnswersSubBatchesRomaRejectsWithTheError) {
+  FakeRoma roma;
+  roma.status = absl::ResourceExhaustedError("queue full");
+  Scheduler scheduler({.max_batch_size = 2, .max_batches_in_flight = 1},
+                      roma.Submit());
+  std::vector<absl::Status> statuses;
+  scheduler.Schedule(Iota(0, 3), [&statuses](const auto& results) {
+    for (const absl::StatusOr<int>& result : results) {
+      statuses.push_back(result.status());
+    }
+  });
+  ASSERT_EQ(statuses.size(), 3);
+  for (const absl::Status& status : statuses) {
+    EXPECT_EQ(status.code(), absl::StatusCode::kResourceExhausted);
+  }
+  EXPECT_EQ(scheduler.BatchesInFlight(), 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
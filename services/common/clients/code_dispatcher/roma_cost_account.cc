@@ -0,0 +1,28 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_cost_account.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void RomaCostAccount::Add(absl::string_view owner, absl::Duration cost) {
+  costs_[owner] += cost;
+}
+
+bool RomaCostAccount::IsOverBudget(absl::string_view owner) const {
+  auto it = costs_.find(owner);
+  return it != costs_.end() && it->second > budget_per_owner_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,57 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_COST_ACCOUNT_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_COST_ACCOUNT_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Attributes the time Roma spent running the UDF invocations of a request to
+// the interest group owners they were run for, so that the owners whose ads
+// are the most expensive to run can be told apart, and optionally be held to
+// a budget.
+//
+// Not thread-safe, calls must be serialized by the caller.
+class RomaCostAccount {
+ public:
+  // An owner is over budget once the time attributed to it exceeds
+  // `budget_per_owner`.
+  explicit RomaCostAccount(
+      absl::Duration budget_per_owner = absl::InfiniteDuration())
+      : budget_per_owner_(budget_per_owner) {}
+
+  // Attributes `cost` to `owner`.
+  void Add(absl::string_view owner, absl::Duration cost);
+
+  bool IsOverBudget(absl::string_view owner) const;
+
+  // Time attributed to each owner.
+  const absl::flat_hash_map<std::string, absl::Duration>& costs() const {
+    return costs_;
+  }
+
+ private:
+  const absl::Duration budget_per_owner_;
+  absl::flat_hash_map<std::string, absl::Duration> costs_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_COST_ACCOUNT_H_
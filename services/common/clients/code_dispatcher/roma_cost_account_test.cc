@@ -0,0 +1,52 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_cost_account.h"
+
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(RomaCostAccountTest, SumsCostsPerOwner) {
+  RomaCostAccount account;
+  account.Add("https://buyer-a.com", absl::Milliseconds(2));
+  account.Add("https://buyer-b.com", absl::Milliseconds(5));
+  account.Add("https://buyer-a.com", absl::Milliseconds(3));
+
+  EXPECT_THAT(account.costs(),
+              UnorderedElementsAre(
+                  Pair("https://buyer-a.com", absl::Milliseconds(5)),
+                  Pair("https://buyer-b.com", absl::Milliseconds(5))));
+  EXPECT_FALSE(account.IsOverBudget("https://buyer-a.com"));
+}
+
+TEST(RomaCostAccountTest, HoldsOwnersToBudget) {
+  RomaCostAccount account(absl::Milliseconds(4));
+  account.Add("https://buyer-a.com", absl::Milliseconds(4));
+  account.Add("https://buyer-b.com", absl::Milliseconds(3));
+  account.Add("https://buyer-b.com", absl::Milliseconds(2));
+
+  EXPECT_FALSE(account.IsOverBudget("https://buyer-a.com"));
+  EXPECT_TRUE(account.IsOverBudget("https://buyer-b.com"));
+  EXPECT_FALSE(account.IsOverBudget("https://buyer-c.com"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,73 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_execution_timer.h"
+
+#include <algorithm>
+#include <string>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::optional<absl::Duration> GetRomaExecutionDuration(
+    const absl::StatusOr<DispatchResponse>& response) {
+  if (!response.ok()) {
+    return std::nullopt;
+  }
+  auto it = response->metrics.find(std::string(kRomaExecutionDurationMetric));
+  if (it == response->metrics.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void RomaExecutionTimer::AddResponse(
+    const absl::StatusOr<DispatchResponse>& response, absl::Time receive_time) {
+  std::optional<absl::Duration> execution = GetRomaExecutionDuration(response);
+  if (!execution.has_value()) {
+    return;
+  }
+  executions_.push_back(*execution);
+  queue_waits_.push_back(std::max(
+      receive_time - dispatch_time_ - *execution, absl::ZeroDuration()));
+}
+
+void RomaExecutionTimer::AddBatch(
+    const std::vector<absl::StatusOr<DispatchResponse>>& responses,
+    absl::Time receive_time) {
+  std::optional<absl::Duration> slowest;
+  for (const absl::StatusOr<DispatchResponse>& response : responses) {
+    std::optional<absl::Duration> execution =
+        GetRomaExecutionDuration(response);
+    if (!execution.has_value()) {
+      continue;
+    }
+    executions_.push_back(*execution);
+    slowest = std::max(slowest.value_or(absl::ZeroDuration()), *execution);
+  }
+  if (slowest.has_value()) {
+    queue_waits_.push_back(std::max(receive_time - dispatch_time_ - *slowest,
+                                    absl::ZeroDuration()));
+  }
+}
+
+std::optional<absl::Duration> RomaExecutionTimer::GetSkew() const {
+  if (executions_.size() < 2) {
+    return std::nullopt;
+  }
+  auto [fastest, slowest] =
+      std::minmax_element(executions_.begin(), executions_.end());
+  return *slowest - *fastest;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,83 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_EXECUTION_TIMER_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_EXECUTION_TIMER_H_
+
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Metric set by Roma on each response with the time spent running the UDF in
+// the sandbox, which excludes the time the request waited for a worker.
+inline constexpr absl::string_view kRomaExecutionDurationMetric =
+    "roma.metric.sandboxed_code_run_duration";
+
+// Splits the time taken by a batch of Roma requests into the time the requests
+// waited in the worker queue and the time they spent executing, so that a
+// slow batch can be told apart from a busy dispatcher.
+//
+// The execution time of a request is reported by Roma with its response. Its
+// queue wait is the rest of the time from the dispatch of the batch until its
+// response was received. Responses of a batch received all at once only
+// record the wait of the slowest request, since the others also wait for it.
+// Responses without the execution metric, e.g. errors, are not timed.
+//
+// Not thread-safe, calls must be serialized by the caller.
+class RomaExecutionTimer {
+ public:
+  // `dispatch_time` is the time at which the batch was handed to Roma.
+  explicit RomaExecutionTimer(absl::Time dispatch_time = absl::Now())
+      : dispatch_time_(dispatch_time) {}
+
+  // Times a response received on its own at `receive_time`.
+  void AddResponse(const absl::StatusOr<DispatchResponse>& response,
+                   absl::Time receive_time = absl::Now());
+
+  // Times the responses of a whole batch, received at `receive_time`.
+  void AddBatch(const std::vector<absl::StatusOr<DispatchResponse>>& responses,
+                absl::Time receive_time = absl::Now());
+
+  // Time waited by the timed requests before their execution started.
+  const std::vector<absl::Duration>& queue_waits() const {
+    return queue_waits_;
+  }
+
+  // Time spent by the timed requests executing.
+  const std::vector<absl::Duration>& executions() const { return executions_; }
+
+  // Execution time of the slowest minus the fastest timed request, if at
+  // least two were timed.
+  std::optional<absl::Duration> GetSkew() const;
+
+ private:
+  const absl::Time dispatch_time_;
+  std::vector<absl::Duration> queue_waits_;
+  std::vector<absl::Duration> executions_;
+};
+
+// Returns the execution time reported by Roma with the response, if any.
+std::optional<absl::Duration> GetRomaExecutionDuration(
+    const absl::StatusOr<DispatchResponse>& response);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_EXECUTION_TIMER_H_
@@ -0,0 +1,79 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_execution_timer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr absl::Time kDispatchTime = absl::UnixEpoch();
+
+DispatchResponse ResponseExecutedFor(absl::Duration execution) {
+  DispatchResponse response;
+  response.metrics[std::string(kRomaExecutionDurationMetric)] = execution;
+  return response;
+}
+
+TEST(RomaExecutionTimerTest, SplitsStreamedResponses) {
+  RomaExecutionTimer timer(kDispatchTime);
+  timer.AddResponse(ResponseExecutedFor(absl::Milliseconds(3)),
+                    kDispatchTime + absl::Milliseconds(5));
+  timer.AddResponse(ResponseExecutedFor(absl::Milliseconds(4)),
+                    kDispatchTime + absl::Milliseconds(10));
+
+  EXPECT_THAT(timer.executions(),
+              ElementsAre(absl::Milliseconds(3), absl::Milliseconds(4)));
+  EXPECT_THAT(timer.queue_waits(),
+              ElementsAre(absl::Milliseconds(2), absl::Milliseconds(6)));
+  EXPECT_EQ(timer.GetSkew(), absl::Milliseconds(1));
+}
+
+TEST(RomaExecutionTimerTest, RecordsWaitOfSlowestRequestOfBatch) {
+  RomaExecutionTimer timer(kDispatchTime);
+  timer.AddBatch({ResponseExecutedFor(absl::Milliseconds(2)),
+                  ResponseExecutedFor(absl::Milliseconds(7)),
+                  absl::InternalError("failed")},
+                 kDispatchTime + absl::Milliseconds(10));
+
+  EXPECT_THAT(timer.executions(),
+              ElementsAre(absl::Milliseconds(2), absl::Milliseconds(7)));
+  EXPECT_THAT(timer.queue_waits(), ElementsAre(absl::Milliseconds(3)));
+  EXPECT_EQ(timer.GetSkew(), absl::Milliseconds(5));
+}
+
+TEST(RomaExecutionTimerTest, IgnoresResponsesWithoutExecutionMetric) {
+  RomaExecutionTimer timer(kDispatchTime);
+  timer.AddResponse(DispatchResponse{.id = "foo"},
+                    kDispatchTime + absl::Milliseconds(5));
+  timer.AddBatch({DispatchResponse{.id = "bar"}},
+                 kDispatchTime + absl::Milliseconds(5));
+
+  EXPECT_THAT(timer.executions(), IsEmpty());
+  EXPECT_THAT(timer.queue_waits(), IsEmpty());
+  EXPECT_EQ(timer.GetSkew(), std::nullopt);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
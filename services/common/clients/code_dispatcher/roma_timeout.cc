@@ -0,0 +1,49 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::StatusOr<std::string> GetRomaTimeoutMs(absl::string_view roma_timeout_ms,
+                                             absl::Time deadline,
+                                             absl::Time now,
+                                             absl::Duration margin) {
+  if (deadline == absl::InfiniteFuture()) {
+    return std::string(roma_timeout_ms);
+  }
+  const int64_t remaining_ms =
+      absl::ToInt64Milliseconds(deadline - now - margin);
+  if (remaining_ms <= 0) {
+    return absl::DeadlineExceededError(
+        absl::StrCat("No time left to execute the request in Roma, deadline: ",
+                     absl::FormatTime(deadline)));
+  }
+  // A timeout of the service that is not a number is left to Roma as is,
+  // unless the call has a deadline.
+  int64_t timeout_ms;
+  if (absl::SimpleAtoi(roma_timeout_ms, &timeout_ms) &&
+      timeout_ms <= remaining_ms) {
+    return std::string(roma_timeout_ms);
+  }
+  return absl::StrCat(remaining_ms);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
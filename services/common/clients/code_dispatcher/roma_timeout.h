@@ -0,0 +1,42 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_TIMEOUT_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_TIMEOUT_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Time kept out of the deadline of a call for its response to make it back to
+// the client once the Roma executions of the call are done.
+inline constexpr absl::Duration kRomaDeadlineMargin = absl::Milliseconds(10);
+
+// Returns the timeout in milliseconds of the Roma executions of a call, as set
+// in their kTimeoutMs tag: the smaller of `roma_timeout_ms`, the timeout of
+// the service, and what is left at `now` of the `deadline` of the call minus
+// `margin`. Returns DEADLINE_EXCEEDED if no time is left to execute anything,
+// since the client would give up on the call before the executions are done.
+absl::StatusOr<std::string> GetRomaTimeoutMs(
+    absl::string_view roma_timeout_ms, absl::Time deadline,
+    absl::Time now = absl::Now(), absl::Duration margin = kRomaDeadlineMargin);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_ROMA_TIMEOUT_H_
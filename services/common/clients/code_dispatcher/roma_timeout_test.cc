@@ -0,0 +1,72 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::Time kNow = absl::UnixEpoch();
+
+TEST(GetRomaTimeoutMsTest, KeepsTimeoutWithoutDeadline) {
+  absl::StatusOr<std::string> timeout_ms =
+      GetRomaTimeoutMs("10000", absl::InfiniteFuture(), kNow);
+
+  ASSERT_TRUE(timeout_ms.ok()) << timeout_ms.status();
+  EXPECT_EQ(*timeout_ms, "10000");
+}
+
+TEST(GetRomaTimeoutMsTest, KeepsTimeoutWithinRemainingDeadline) {
+  absl::StatusOr<std::string> timeout_ms = GetRomaTimeoutMs(
+      "100", kNow + absl::Seconds(1), kNow, absl::Milliseconds(10));
+
+  ASSERT_TRUE(timeout_ms.ok()) << timeout_ms.status();
+  EXPECT_EQ(*timeout_ms, "100");
+}
+
+TEST(GetRomaTimeoutMsTest, CapsTimeoutToRemainingDeadlineMinusMargin) {
+  absl::StatusOr<std::string> timeout_ms = GetRomaTimeoutMs(
+      "10000", kNow + absl::Milliseconds(250), kNow, absl::Milliseconds(10));
+
+  ASSERT_TRUE(timeout_ms.ok()) << timeout_ms.status();
+  EXPECT_EQ(*timeout_ms, "240");
+}
+
+TEST(GetRomaTimeoutMsTest, CapsInvalidTimeoutToRemainingDeadline) {
+  absl::StatusOr<std::string> timeout_ms = GetRomaTimeoutMs(
+      "", kNow + absl::Milliseconds(250), kNow, absl::Milliseconds(10));
+
+  ASSERT_TRUE(timeout_ms.ok()) << timeout_ms.status();
+  EXPECT_EQ(*timeout_ms, "240");
+}
+
+TEST(GetRomaTimeoutMsTest, FailsOnceDeadlineIsWithinMargin) {
+  EXPECT_EQ(GetRomaTimeoutMs("10000", kNow + absl::Milliseconds(10), kNow,
+                             absl::Milliseconds(10))
+                .status()
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(GetRomaTimeoutMs("10000", kNow - absl::Seconds(1), kNow,
+                             absl::Milliseconds(10))
+                .status()
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
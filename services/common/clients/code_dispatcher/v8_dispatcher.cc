@@ -14,15 +14,27 @@
 
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "google/protobuf/util/json_util.h"
+#include "services/common/util/backend_load.h"
+#include "services/common/util/request_response_constants.h"
 #include "src/logger/request_context_logger.h"
 #include "src/roma/interface/roma.h"
+#include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -30,19 +42,195 @@ using LoadRequest = ::google::scp::roma::CodeObject;
 using LoadResponse = ::google::scp::roma::ResponseObject;
 using LoadDoneCallback = ::google::scp::roma::Callback;
 
-V8Dispatcher::V8Dispatcher(DispatchConfig&& config)
-    : roma_service_(std::move(config)) {}
+namespace {
 
-V8Dispatcher::~V8Dispatcher() {
+DispatchTenant GetTenant(const DispatchRequest& request) {
+  auto it = request.tags.find(kDispatchTenantTag);
+  return it == request.tags.end() ? DispatchTenant::kProtectedAudience
+                                  : ParseDispatchTenant(it->second);
+}
+
+// Time left to run the request, as set by its timeout tag.
+absl::Duration GetBudget(const DispatchRequest& request) {
+  int timeout_ms;
+  if (auto it = request.tags.find(kTimeoutMs);
+      it != request.tags.end() && absl::SimpleAtoi(it->second, &timeout_ms)) {
+    return absl::Milliseconds(timeout_ms);
+  }
+  return absl::InfiniteDuration();
+}
+
+// Number of times the workers of all dispatchers were recycled.
+std::atomic<int64_t>& NumWorkerRecycles() {
+  static std::atomic<int64_t> num_worker_recycles = 0;
+  return num_worker_recycles;
+}
+
+// Latency of the first and last round of the latest warm-up, in
+// microseconds.
+std::atomic<int64_t>& FirstWarmUpRoundMicros() {
+  static std::atomic<int64_t> micros = 0;
+  return micros;
+}
+
+std::atomic<int64_t>& LastWarmUpRoundMicros() {
+  static std::atomic<int64_t> micros = 0;
+  return micros;
+}
+
+// Upper bounds of the payload size buckets, in KiB: powers of two up to
+// 64 MiB. The last bucket has no upper bound.
+inline constexpr int kNumPayloadSizeBuckets = 17;
+
+// Requests of all dispatchers since the last GetPayloadSizeBytes call, per
+// bucket of the size of their input.
+std::array<std::atomic<int64_t>, kNumPayloadSizeBuckets + 1>&
+PayloadSizeBuckets() {
+  static std::array<std::atomic<int64_t>, kNumPayloadSizeBuckets + 1> buckets;
+  return buckets;
+}
+
+// Counts the size of the input of `request`, which Roma copies to its
+// workers.
+void RecordPayloadSize(const DispatchRequest& request) {
+  size_t size = 0;
+  for (const auto& input : request.input) {
+    if (input != nullptr) {
+      size += input->size();
+    }
+  }
+  int bucket = 0;
+  while (bucket < kNumPayloadSizeBuckets && size > (size_t{1024} << bucket)) {
+    ++bucket;
+  }
+  PayloadSizeBuckets()[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+void BatchSharedInput::Set(int index, std::shared_ptr<std::string> value) {
+  for (auto& [arg_index, arg] : args_) {
+    if (arg_index == index) {
+      arg = std::move(value);
+      return;
+    }
+  }
+  args_.emplace_back(index, std::move(value));
+}
+
+std::shared_ptr<std::string> BatchSharedInput::Get(int index) const {
+  for (const auto& [arg_index, arg] : args_) {
+    if (arg_index == index) {
+      return arg;
+    }
+  }
+  return nullptr;
+}
+
+void BatchSharedInput::SetTag(std::string key, std::string value) {
+  for (auto& [tag_key, tag_value] : tags_) {
+    if (tag_key == key) {
+      tag_value = std::move(value);
+      return;
+    }
+  }
+  tags_.emplace_back(std::move(key), std::move(value));
+}
+
+void BatchSharedInput::SetMetadata(RomaRequestSharedContext metadata) {
+  metadata_ = std::move(metadata);
+}
+
+absl::Status BatchSharedInput::BindTo(DispatchRequest& request) const {
+  for (const auto& [index, arg] : args_) {
+    if (request.input.size() <= static_cast<size_t>(index)) {
+      request.input.resize(index + 1);
+    }
+    std::shared_ptr<std::string>& slot = request.input[index];
+    if (slot != nullptr && slot != arg) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Request ", request.id, " overrides shared input at index ", index));
+    }
+    slot = arg;
+  }
+  for (const auto& [key, value] : tags_) {
+    request.tags[key] = value;
+  }
+  if (metadata_.has_value()) {
+    request.metadata = *metadata_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BatchSharedInput::BindTo(
+    std::vector<DispatchRequest>& batch) const {
+  for (DispatchRequest& request : batch) {
+    PS_RETURN_IF_ERROR(BindTo(request));
+  }
+  return absl::OkStatus();
+}
+
+V8Dispatcher::V8Dispatcher(DispatchConfig&& config,
+                           std::optional<RomaAdmissionConfig> admission_config)
+    : num_workers_(static_cast<int>(config.number_of_workers > 0
+                                        ? config.number_of_workers
+                                        : std::thread::hardware_concurrency())),
+      roma_service_(std::move(config)) {
+  BackendLoadTracker::Get().AddWorkers(num_workers_);
+  if (admission_config.has_value()) {
+    admission_controller_ =
+        std::make_unique<RomaAdmissionController>(*admission_config);
+  }
+}
+
+V8Dispatcher::~V8Dispatcher() { Stop().IgnoreError(); }
+
+absl::Status V8Dispatcher::Stop() {
+  if (stopped_.exchange(true)) {
+    return absl::OkStatus();
+  }
   PS_LOG(ERROR) << "Stopping roma service...";
   absl::Status stop_status = roma_service_.Stop();
   PS_LOG(ERROR) << "Roma service stop status: " << stop_status;
+  BackendLoadTracker::Get().AddWorkers(-num_workers_);
+  return stop_status;
 }
 
 absl::Status V8Dispatcher::Init() { return roma_service_.Init(); }
 
+void V8Dispatcher::RecycleWorkersEvery(int64_t num_executions) {
+  recycle_after_executions_ = num_executions;
+}
+
+void V8Dispatcher::SplitBatchesOver(int max_batch_size) {
+  if (max_batch_size <= 0) {
+    batch_scheduler_ = nullptr;
+    return;
+  }
+  batch_scheduler_ = std::make_unique<
+      RomaBatchScheduler<DispatchRequest, DispatchResponse>>(
+      RomaBatchPartitionConfig{
+          .max_batch_size = max_batch_size,
+          .max_batches_in_flight =
+              (2 * num_workers_ + max_batch_size - 1) / max_batch_size},
+      [this](std::vector<DispatchRequest>& sub_batch,
+             BatchDispatchDoneCallback callback) {
+        return roma_service_.BatchExecute(sub_batch, std::move(callback));
+      });
+}
+
+void V8Dispatcher::WarmUpAfterLoads(std::vector<DispatchRequest> samples,
+                                    int num_rounds) {
+  warm_up_samples_ = std::move(samples);
+  warm_up_rounds_ = num_rounds;
+}
+
 absl::Status V8Dispatcher::LoadSync(absl::string_view version,
                                     absl::string_view js) {
+  if (recycle_after_executions_ > 0) {
+    absl::MutexLock lock(&code_mu_);
+    code_by_version_[version] = js;
+  }
   auto request = std::make_unique<LoadRequest>(LoadRequest{
       .version_string = std::string(version),
       .js = std::string(js),
@@ -63,17 +251,311 @@ absl::Status V8Dispatcher::LoadSync(absl::string_view version,
     return try_load;
   }
   load_finished.WaitForNotification();
+  if (load_status.ok()) {
+    WarmUp(version, js);
+  }
   return load_status;
 }
 
+void V8Dispatcher::WarmUp(absl::string_view version, absl::string_view js) {
+  if (warm_up_rounds_ <= 0) {
+    return;
+  }
+  std::vector<const DispatchRequest*> samples;
+  for (const DispatchRequest& sample : warm_up_samples_) {
+    if (absl::StrContains(
+            js, absl::StrCat("function ", sample.handler_name, "("))) {
+      samples.push_back(&sample);
+    }
+  }
+  if (samples.empty()) {
+    return;
+  }
+  for (int round = 0; round < warm_up_rounds_; ++round) {
+    std::vector<DispatchRequest> batch;
+    batch.reserve(num_workers_ * samples.size());
+    for (int worker = 0; worker < num_workers_; ++worker) {
+      for (const DispatchRequest* sample : samples) {
+        DispatchRequest& request = batch.emplace_back(*sample);
+        request.id = absl::StrCat("warm-up-", round, "-", batch.size());
+        request.version_string = std::string(version);
+      }
+    }
+    absl::Notification round_finished;
+    int num_failed = 0;
+    const absl::Time start = absl::Now();
+    if (absl::Status status = roma_service_.BatchExecute(
+            batch,
+            [&round_finished, &num_failed](
+                const std::vector<absl::StatusOr<DispatchResponse>>& results) {
+              for (const auto& result : results) {
+                if (!result.ok()) {
+                  ++num_failed;
+                }
+              }
+              round_finished.Notify();
+            });
+        !status.ok()) {
+      PS_LOG(ERROR) << "Warming up code version " << version
+                    << " failed: " << status;
+      return;
+    }
+    round_finished.WaitForNotification();
+    const int64_t latency_micros =
+        absl::ToInt64Microseconds(absl::Now() - start);
+    if (round == 0) {
+      FirstWarmUpRoundMicros().store(latency_micros, std::memory_order_relaxed);
+    }
+    LastWarmUpRoundMicros().store(latency_micros, std::memory_order_relaxed);
+    if (num_failed > 0) {
+      PS_LOG(WARNING) << num_failed << " of the " << batch.size()
+                      << " warm-up executions of code version " << version
+                      << " failed in round " << round;
+    }
+  }
+  PS_VLOG(5) << "Warmed up code version " << version << " in "
+             << warm_up_rounds_ << " rounds, from "
+             << FirstWarmUpRoundMicros().load(std::memory_order_relaxed)
+             << "us to "
+             << LastWarmUpRoundMicros().load(std::memory_order_relaxed)
+             << "us per round";
+}
+
 absl::Status V8Dispatcher::Execute(std::unique_ptr<DispatchRequest> request,
                                    DispatchDoneCallback done_callback) {
-  return roma_service_.Execute(std::move(request), std::move(done_callback));
+  RecordPayloadSize(*request);
+  if (!admission_controller_) {
+    BackendLoadTracker::Get().OnDispatched(1);
+    absl::Status status = roma_service_.Execute(
+        std::move(request),
+        [start = absl::Now(), done_callback = std::move(done_callback)](
+            absl::StatusOr<DispatchResponse> response) mutable {
+          BackendLoadTracker::Get().OnDone(1, absl::Now() - start);
+          done_callback(std::move(response));
+        });
+    if (!status.ok()) {
+      BackendLoadTracker::Get().OnDone(1);
+    } else {
+      MaybeRecycleWorkers(1);
+    }
+    return status;
+  }
+  const DispatchTenant tenant = GetTenant(*request);
+  PS_ASSIGN_OR_RETURN(
+      int num_admitted,
+      admission_controller_->Admit(tenant, 1, GetBudget(*request)));
+  BackendLoadTracker::Get().OnDispatched(1);
+  absl::Status status = roma_service_.Execute(
+      std::move(request),
+      [this, tenant, num_admitted, start = absl::Now(),
+       done_callback = std::move(done_callback)](
+          absl::StatusOr<DispatchResponse> response) mutable {
+        const absl::Duration latency = absl::Now() - start;
+        BackendLoadTracker::Get().OnDone(1, latency);
+        admission_controller_->Release(tenant, num_admitted, latency);
+        done_callback(std::move(response));
+      });
+  if (!status.ok()) {
+    BackendLoadTracker::Get().OnDone(1);
+    admission_controller_->Release(tenant, num_admitted);
+  } else {
+    MaybeRecycleWorkers(1);
+  }
+  return status;
 }
 
 absl::Status V8Dispatcher::BatchExecute(
     std::vector<DispatchRequest>& batch,
     BatchDispatchDoneCallback batch_callback) {
-  return roma_service_.BatchExecute(batch, std::move(batch_callback));
+  if (batch.empty()) {
+    return roma_service_.BatchExecute(batch, std::move(batch_callback));
+  }
+  for (const DispatchRequest& request : batch) {
+    RecordPayloadSize(request);
+  }
+  if (!admission_controller_) {
+    const int64_t num_requests = batch.size();
+    BackendLoadTracker::Get().OnDispatched(num_requests);
+    absl::Status status = DispatchBatch(
+        batch, [num_requests, start = absl::Now(),
+                batch_callback = std::move(batch_callback)](
+                   const std::vector<absl::StatusOr<DispatchResponse>>&
+                       result) mutable {
+          BackendLoadTracker::Get().OnDone(num_requests, absl::Now() - start);
+          batch_callback(result);
+        });
+    if (!status.ok()) {
+      BackendLoadTracker::Get().OnDone(num_requests);
+    } else {
+      MaybeRecycleWorkers(num_requests);
+    }
+    return status;
+  }
+  // Batches hold requests of a single tenant with the same timeout.
+  const DispatchTenant tenant = GetTenant(batch.front());
+  PS_ASSIGN_OR_RETURN(int num_admitted,
+                      admission_controller_->Admit(tenant, batch.size(),
+                                                   GetBudget(batch.front())));
+  if (num_admitted < batch.size()) {
+    PS_VLOG(5) << "Truncating the " << DispatchTenantTagValue(tenant)
+               << " batch of " << batch.size() << " requests to "
+               << num_admitted;
+    batch.erase(batch.begin() + num_admitted, batch.end());
+  }
+  BackendLoadTracker::Get().OnDispatched(num_admitted);
+  absl::Status status = DispatchBatch(
+      batch, [this, tenant, num_admitted, start = absl::Now(),
+              batch_callback = std::move(batch_callback)](
+                 const std::vector<absl::StatusOr<DispatchResponse>>&
+                     result) mutable {
+        const absl::Duration latency = absl::Now() - start;
+        BackendLoadTracker::Get().OnDone(num_admitted, latency);
+        admission_controller_->Release(tenant, num_admitted, latency);
+        batch_callback(result);
+      });
+  if (!status.ok()) {
+    BackendLoadTracker::Get().OnDone(num_admitted);
+    admission_controller_->Release(tenant, num_admitted);
+  } else {
+    MaybeRecycleWorkers(num_admitted);
+  }
+  return status;
+}
+
+absl::Status V8Dispatcher::BatchExecute(
+    std::vector<DispatchRequest>& batch, const BatchSharedInput& shared_input,
+    BatchDispatchDoneCallback batch_callback) {
+  PS_RETURN_IF_ERROR(shared_input.BindTo(batch));
+  return BatchExecute(batch, std::move(batch_callback));
+}
+
+absl::Status V8Dispatcher::DispatchBatch(
+    std::vector<DispatchRequest>& batch,
+    BatchDispatchDoneCallback batch_callback) {
+  if (batch_scheduler_ == nullptr ||
+      !batch_scheduler_->ShouldSplit(batch.size())) {
+    return roma_service_.BatchExecute(batch, std::move(batch_callback));
+  }
+  PS_VLOG(5) << "Splitting a batch of " << batch.size() << " requests";
+  // The scheduler runs a copy, as callers read the batch once it is handed
+  // over.
+  batch_scheduler_->Schedule(batch, std::move(batch_callback));
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<std::string, double> V8Dispatcher::GetQueueDepth() {
+  return {{"roma",
+           static_cast<double>(BackendLoadTracker::Get().QueueDepth())}};
+}
+
+absl::flat_hash_map<std::string, double> V8Dispatcher::GetWorkerRecycles() {
+  return {{"roma", static_cast<double>(NumWorkerRecycles().load(
+                       std::memory_order_relaxed))}};
+}
+
+absl::flat_hash_map<std::string, double> V8Dispatcher::GetWarmUpLatency() {
+  return {{"first_round",
+           FirstWarmUpRoundMicros().load(std::memory_order_relaxed) / 1000.0},
+          {"last_round",
+           LastWarmUpRoundMicros().load(std::memory_order_relaxed) / 1000.0}};
+}
+
+absl::flat_hash_map<std::string, double> V8Dispatcher::GetPayloadSizeBytes() {
+  std::array<int64_t, kNumPayloadSizeBuckets + 1> counts;
+  int64_t total = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    counts[i] = PayloadSizeBuckets()[i].exchange(0, std::memory_order_relaxed);
+    total += counts[i];
+  }
+  absl::flat_hash_map<std::string, double> percentiles;
+  if (total == 0) {
+    return percentiles;
+  }
+  int64_t cumulative = 0;
+  int bucket = 0;
+  for (const auto& [label, percentile] :
+       {std::pair{"p50", 0.5}, std::pair{"p90", 0.9}, std::pair{"p99", 0.99}}) {
+    while (cumulative + counts[bucket] < percentile * total) {
+      cumulative += counts[bucket];
+      ++bucket;
+    }
+    // The last bucket is reported with the bound of the one before.
+    percentiles[label] = static_cast<double>(
+        size_t{1024} << std::min(bucket, kNumPayloadSizeBuckets - 1));
+  }
+  return percentiles;
+}
+
+void V8Dispatcher::MaybeRecycleWorkers(int64_t num_executions) {
+  if (recycle_after_executions_ <= 0 ||
+      executions_since_recycle_.fetch_add(num_executions,
+                                          std::memory_order_relaxed) +
+              num_executions <
+          recycle_after_executions_ ||
+      recycling_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  executions_since_recycle_.store(0, std::memory_order_relaxed);
+  std::vector<std::unique_ptr<LoadRequest>> requests;
+  {
+    absl::MutexLock lock(&code_mu_);
+    for (const auto& [version, js] : code_by_version_) {
+      requests.push_back(std::make_unique<LoadRequest>(
+          LoadRequest{.version_string = version, .js = js}));
+    }
+  }
+  if (requests.empty()) {
+    recycling_.store(false, std::memory_order_release);
+    return;
+  }
+  PS_VLOG(5) << "Recycling the Roma workers of " << requests.size()
+             << " code versions";
+  // Recycling is done once every version is reloaded, or failed to.
+  auto num_pending = std::make_shared<std::atomic<int>>(requests.size());
+  auto on_reloaded = [this, num_pending]() {
+    if (num_pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      NumWorkerRecycles().fetch_add(1, std::memory_order_relaxed);
+      recycling_.store(false, std::memory_order_release);
+    }
+  };
+  for (std::unique_ptr<LoadRequest>& request : requests) {
+    std::string version = request->version_string;
+    if (absl::Status status = roma_service_.LoadCodeObj(
+            std::move(request),
+            [version, on_reloaded](absl::StatusOr<LoadResponse> response) {
+              if (!response.ok()) {
+                PS_LOG(ERROR) << "Reloading code version " << version
+                              << " to recycle the Roma workers failed: "
+                              << response.status();
+              }
+              on_reloaded();
+            });
+        !status.ok()) {
+      PS_LOG(ERROR) << "Reloading code version " << version
+                    << " to recycle the Roma workers failed: " << status;
+      on_reloaded();
+    }
+  }
+}
+
+absl::StatusOr<std::vector<DispatchRequest>> BuildWarmUpSamples(
+    absl::string_view handler_name,
+    const google::protobuf::RepeatedPtrField<google::protobuf::ListValue>&
+        sample_args) {
+  std::vector<DispatchRequest> samples;
+  samples.reserve(sample_args.size());
+  for (const google::protobuf::ListValue& args : sample_args) {
+    DispatchRequest& sample = samples.emplace_back();
+    sample.handler_name = std::string(handler_name);
+    for (const google::protobuf::Value& arg : args.values()) {
+      auto json = std::make_shared<std::string>();
+      PS_RETURN_IF_ERROR(
+          google::protobuf::util::MessageToJsonString(arg, json.get()))
+          .SetPrepend()
+          << "Invalid warm-up sample of " << handler_name << ": ";
+      sample.input.push_back(std::move(json));
+    }
+  }
+  return samples;
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,12 +15,24 @@
 #ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_V8_DISPATCHER_H_
 #define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_V8_DISPATCHER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/repeated_ptr_field.h"
+#include "google/protobuf/struct.pb.h"
 #include "services/common/clients/code_dispatcher/request_context.h"
+#include "services/common/clients/code_dispatcher/roma_admission_controller.h"
+#include "services/common/clients/code_dispatcher/roma_batch_scheduler.h"
 #include "src/roma/interface/roma.h"
 #include "src/roma/roma_service/roma_service.h"
 
@@ -42,11 +54,62 @@ using BatchDispatchDoneCallback = google::scp::roma::BatchCallback;
 // these values as necessary.
 using DispatchConfig = DispatchService::Config;
 
+// Arguments that are identical for every request in a batch (e.g. auction and
+// buyer signals for all interest groups of a GenerateBids request). Callers
+// build each shared argument once per batch and leave the corresponding input
+// slots of the individual requests empty; the dispatcher then binds the same
+// buffer into every request so that no per-request copies are made.
+class BatchSharedInput {
+ public:
+  BatchSharedInput() = default;
+
+  // Sets the argument at input position `index` for all requests in a batch.
+  void Set(int index, std::shared_ptr<std::string> value);
+
+  // Returns the shared argument at `index` or nullptr if none is set.
+  std::shared_ptr<std::string> Get(int index) const;
+
+  // Sets a tag (e.g. kTimeoutMs) for all requests in a batch.
+  void SetTag(std::string key, std::string value);
+
+  // Sets the Roma metadata of all requests in a batch, so that the request
+  // context is created once per batch.
+  void SetMetadata(RomaRequestSharedContext metadata);
+
+  bool empty() const {
+    return args_.empty() && tags_.empty() && !metadata_.has_value();
+  }
+
+  // Binds the shared arguments into the input of `request`, growing the input
+  // if needed, and sets the shared tags and metadata. Fails if the request
+  // already carries a different argument at one of the shared positions.
+  absl::Status BindTo(DispatchRequest& request) const;
+
+  // Binds the shared arguments into every request of `batch` as above.
+  absl::Status BindTo(std::vector<DispatchRequest>& batch) const;
+
+ private:
+  std::vector<std::pair<int, std::shared_ptr<std::string>>> args_;
+  std::vector<std::pair<std::string, std::string>> tags_;
+  std::optional<RomaRequestSharedContext> metadata_;
+};
+
 // This class is a wrapper around Roma, a library which provides an interface
 // for multi-process javascript and wasm execution in V8.
+//
+// With an admission config, requests go through a RomaAdmissionController
+// before they reach Roma. Batches are then truncated, or rejected with
+// ResourceExhausted, when their tenant is out of capacity or when they are
+// not predicted to run within the timeout in their kTimeoutMs tag.
+//
+// Batches larger than the size set by SplitBatchesOver are run as sub-batches
+// taking turns with those of the other batches, so that a large batch does not
+// hold all the workers while the batches behind it wait.
 class V8Dispatcher {
  public:
-  explicit V8Dispatcher(DispatchConfig&& config = DispatchConfig());
+  explicit V8Dispatcher(
+      DispatchConfig&& config = DispatchConfig(),
+      std::optional<RomaAdmissionConfig> admission_config = std::nullopt);
 
   virtual ~V8Dispatcher();
 
@@ -59,6 +122,32 @@ class V8Dispatcher {
   // fails, a client may retry.
   absl::Status Init();
 
+  // Stops the Roma workers, e.g. once the server drained, so that they stop
+  // before the other parts of the server do. Done by the destructor if not
+  // called before. Executions fail once stopped.
+  absl::Status Stop();
+
+  // Recycles the V8 isolates of the workers after every `num_executions`
+  // executions, by reloading the code of every version loaded, so that the
+  // memory the UDFs leaked or bloated is given back. The reload runs in the
+  // background, while the executions go on with the isolates being replaced.
+  // Never if 0, the default. Must be called before any code is loaded.
+  void RecycleWorkersEvery(int64_t num_executions);
+
+  // Splits the batches of more than `max_batch_size` requests into
+  // sub-batches of that size, and keeps enough of them in Roma to fill twice
+  // the workers. Never if 0, the default. Must be called before any batch is
+  // executed.
+  void SplitBatchesOver(int max_batch_size);
+
+  // Runs the `samples` through the workers `num_rounds` times after every
+  // successful LoadSync of a code version defining their handler, before
+  // LoadSync returns, so that V8 compiles the hot functions of the UDF
+  // before the version serves requests. Each round runs every sample once
+  // per worker. Failed samples are logged but do not fail the load. Never if
+  // `num_rounds` is 0, the default. Must be called before any code is loaded.
+  void WarmUpAfterLoads(std::vector<DispatchRequest> samples, int num_rounds);
+
   // Load new execution code synchronously. This is a blocking wrapper around
   // the google::scp::roma::LoadCodeObj method.
   //
@@ -83,7 +172,8 @@ class V8Dispatcher {
   // Execute a batch of requests asynchronously. There are no guarantees
   // on the order of request processing.
   //
-  // batch: a vector of requests, each executed independently and in parallel
+  // batch: a vector of requests, each executed independently and in parallel.
+  // It is truncated to the requests admitted, if not all of them are.
   // batch_callback: called when all requests in the batch are finished.
   // return: a status indicating if the execution request was properly
   // scheduled. This should not be confused with the output of the execution
@@ -91,9 +181,69 @@ class V8Dispatcher {
   virtual absl::Status BatchExecute(std::vector<DispatchRequest>& batch,
                                     BatchDispatchDoneCallback batch_callback);
 
+  // Same as above, but first binds `shared_input` into every request of the
+  // batch so that arguments common to the whole batch are held only once.
+  absl::Status BatchExecute(std::vector<DispatchRequest>& batch,
+                            const BatchSharedInput& shared_input,
+                            BatchDispatchDoneCallback batch_callback);
+
+  // Observable callback exporting the number of requests handed to Roma by
+  // all dispatchers which did not finish yet, whether queued or running.
+  static absl::flat_hash_map<std::string, double> GetQueueDepth();
+
+  // Observable callback exporting the number of times the workers of all
+  // dispatchers were recycled.
+  static absl::flat_hash_map<std::string, double> GetWorkerRecycles();
+
+  // Observable callback exporting the latency of the first and last round of
+  // the latest warm-up, whose gap is the speedup of the compiled UDF.
+  static absl::flat_hash_map<std::string, double> GetWarmUpLatency();
+
+  // Observable callback exporting percentiles of the size of the inputs of
+  // the requests of all dispatchers since the last call, in bytes, reported
+  // as upper bounds of power of two buckets. Roma copies the inputs to its
+  // workers, so the p99 is the size its request buffers should be given.
+  static absl::flat_hash_map<std::string, double> GetPayloadSizeBytes();
+
  private:
+  // Runs the warm-up samples defined by `js` against `version`.
+  void WarmUp(absl::string_view version, absl::string_view js);
+
+  // Counts `num_executions` more executions, and recycles the workers if
+  // they are due.
+  void MaybeRecycleWorkers(int64_t num_executions);
+
+  // Hands the batch to Roma, through the batch scheduler if it is split.
+  absl::Status DispatchBatch(std::vector<DispatchRequest>& batch,
+                             BatchDispatchDoneCallback batch_callback);
+
+  // Number of Roma workers, counted in the load of the server.
+  const int num_workers_;
   DispatchService roma_service_;
+  std::atomic<bool> stopped_ = false;
+  std::unique_ptr<RomaAdmissionController> admission_controller_;
+  std::unique_ptr<RomaBatchScheduler<DispatchRequest, DispatchResponse>>
+      batch_scheduler_;
+
+  int64_t recycle_after_executions_ = 0;
+  std::atomic<int64_t> executions_since_recycle_ = 0;
+  std::atomic<bool> recycling_ = false;
+  absl::Mutex code_mu_;
+  // Code of each version loaded, reloaded to recycle the workers. Only kept
+  // if the workers are recycled.
+  absl::flat_hash_map<std::string, std::string> code_by_version_
+      ABSL_GUARDED_BY(code_mu_);
+
+  std::vector<DispatchRequest> warm_up_samples_;
+  int warm_up_rounds_ = 0;
 };
+
+// Builds warm-up samples of the handler, from lists of the JSON arguments it
+// is called with.
+absl::StatusOr<std::vector<DispatchRequest>> BuildWarmUpSamples(
+    absl::string_view handler_name,
+    const google::protobuf::RepeatedPtrField<google::protobuf::ListValue>&
+        sample_args);
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_V8_DISPATCHER_H_
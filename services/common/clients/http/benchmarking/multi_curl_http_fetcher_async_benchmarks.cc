@@ -0,0 +1,327 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Drives MultiCurlHttpFetcherAsync against an HTTP/1.1 server running in the
+// process on a loopback port, at increasing numbers of concurrent requests,
+// response or upload sizes, and latencies injected by the server. Besides
+// the requests and bytes per second, each benchmark reports:
+// * `p50_ms` & `p99_ms`: Percentiles of the latency of the requests, from
+//   the call to the fetcher to the callback.
+// * `loop_lag_ms`: Highest lag of the timer of the event loop of the
+//   fetcher, sampled after every iteration.
+// * `loop_stall_ms`: Longest time a single event held the event loop thread.
+// * `connection_reuse` & `easy_handle_reuse`: Share of the requests made
+//   over an open connection and with a pooled easy handle.
+//
+// To run:
+//   bazel run -c opt \
+//     //services/common/clients/http/benchmarking:multi_curl_http_fetcher_async_benchmarks
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <event2/buffer.h>
+#include <event2/event.h>
+#include <event2/http.h>
+#include <event2/thread.h>
+
+#include "absl/log/check.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "grpc/event_engine/event_engine.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "src/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int64_t kMaxResponseBytes = 1 << 20;
+constexpr int kTimeoutMs = 30000;
+
+// Serves HTTP/1.1 on a loopback port from an event loop of its own. The
+// size of the response and the latency before it is sent are read from the
+// path, e.g. "/1024/5000" for 1 KB after 5 ms, so that one server serves
+// every benchmark. Uploaded bodies are dropped.
+class LoopbackHttpServer {
+ public:
+  LoopbackHttpServer() : body_(kMaxResponseBytes, 'b') {
+    evthread_use_pthreads();
+    base_ = event_base_new();
+    http_ = evhttp_new(base_);
+    evhttp_set_allowed_methods(http_, EVHTTP_REQ_GET | EVHTTP_REQ_PUT |
+                                          EVHTTP_REQ_POST);
+    evhttp_set_gencb(http_, &LoopbackHttpServer::HandleRequest, this);
+    evhttp_bound_socket* socket =
+        evhttp_bind_socket_with_handle(http_, "127.0.0.1", /*port=*/0);
+    CHECK(socket != nullptr) << "Unable to listen on a loopback port";
+    sockaddr_in address = {};
+    socklen_t address_size = sizeof(address);
+    CHECK_EQ(getsockname(evhttp_bound_socket_get_fd(socket),
+                         reinterpret_cast<sockaddr*>(&address),
+                         &address_size),
+             0);
+    port_ = ntohs(address.sin_port);
+    thread_ = std::thread([base = base_]() { event_base_dispatch(base); });
+  }
+
+  ~LoopbackHttpServer() {
+    event_base_loopbreak(base_);
+    thread_.join();
+    evhttp_free(http_);
+    event_base_free(base_);
+  }
+
+  // URL of a response of `response_bytes` sent after `latency`.
+  std::string Url(int64_t response_bytes, absl::Duration latency) const {
+    CHECK_LE(response_bytes, kMaxResponseBytes);
+    return absl::StrCat("http://127.0.0.1:", port_, "/", response_bytes, "/",
+                        absl::ToInt64Microseconds(latency));
+  }
+
+ private:
+  struct Reply {
+    LoopbackHttpServer* server;
+    evhttp_request* request;
+    int64_t response_bytes;
+  };
+
+  static void HandleRequest(evhttp_request* request, void* arg) {
+    auto* server = static_cast<LoopbackHttpServer*>(arg);
+    const char* path =
+        evhttp_uri_get_path(evhttp_request_get_evhttp_uri(request));
+    std::vector<absl::string_view> parts =
+        absl::StrSplit(path == nullptr ? "" : path, '/', absl::SkipEmpty());
+    int64_t response_bytes = 0;
+    int64_t latency_us = 0;
+    if (parts.size() != 2 || !absl::SimpleAtoi(parts[0], &response_bytes) ||
+        !absl::SimpleAtoi(parts[1], &latency_us) ||
+        response_bytes > kMaxResponseBytes) {
+      evhttp_send_error(request, HTTP_BADREQUEST, /*reason=*/nullptr);
+      return;
+    }
+    auto* reply = new Reply{server, request, response_bytes};
+    if (latency_us <= 0) {
+      SendReply(/*fd=*/-1, /*events=*/0, reply);
+      return;
+    }
+    const timeval delay = {.tv_sec = latency_us / 1'000'000,
+                           .tv_usec = latency_us % 1'000'000};
+    event_base_once(server->base_, /*fd=*/-1, EV_TIMEOUT,
+                    &LoopbackHttpServer::SendReply, reply, &delay);
+  }
+
+  static void SendReply(int, short, void* arg) {
+    std::unique_ptr<Reply> reply(static_cast<Reply*>(arg));
+    evbuffer* buffer = evbuffer_new();
+    // The body is shared by all the responses rather than copied.
+    evbuffer_add_reference(buffer, reply->server->body_.data(),
+                           reply->response_bytes, /*cleanupfn=*/nullptr,
+                           /*cleanupfn_arg=*/nullptr);
+    evhttp_send_reply(reply->request, HTTP_OK, /*reason=*/nullptr, buffer);
+    evbuffer_free(buffer);
+  }
+
+  const std::string body_;
+  event_base* base_ = nullptr;
+  evhttp* http_ = nullptr;
+  int port_ = 0;
+  std::thread thread_;
+};
+
+LoopbackHttpServer& GetServer() {
+  static auto* server = new LoopbackHttpServer();
+  return *server;
+}
+
+server_common::Executor& GetExecutor() {
+  [[maybe_unused]] static auto* grpc_init = new server_common::GrpcInit();
+  static auto* executor = new server_common::EventEngineExecutor(
+      grpc_event_engine::experimental::CreateEventEngine());
+  return *executor;
+}
+
+// Returns the `percentile` of the sorted `latencies`.
+double Percentile(const std::vector<double>& latencies, double percentile) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  const size_t index = std::min(
+      latencies.size() - 1, static_cast<size_t>(latencies.size() * percentile));
+  return latencies[index];
+}
+
+// Records the latencies of the requests, and the state of the event loop of
+// the fetcher, over a run of a benchmark.
+class FetchRecorder {
+ public:
+  explicit FetchRecorder(MultiCurlHttpFetcherAsync& fetcher)
+      : fetcher_(fetcher) {
+    // Drops what was recorded by the previous runs.
+    fetcher_.TakeEventLoopStall();
+    MultiCurlHttpFetcherAsync::GetReuseRatios();
+  }
+
+  void RecordLatency(absl::Duration latency) {
+    absl::MutexLock lock(&mu_);
+    latencies_ms_.push_back(absl::ToDoubleMilliseconds(latency));
+  }
+
+  // Called after every iteration.
+  void SampleEventLoop() {
+    max_loop_lag_ = std::max(max_loop_lag_, fetcher_.EventLoopLag());
+  }
+
+  void Report(benchmark::State& state, int64_t requests_per_iteration,
+              int64_t bytes_per_request) {
+    state.SetItemsProcessed(state.iterations() * requests_per_iteration);
+    state.SetBytesProcessed(state.iterations() * requests_per_iteration *
+                            bytes_per_request);
+    absl::MutexLock lock(&mu_);
+    std::sort(latencies_ms_.begin(), latencies_ms_.end());
+    state.counters["p50_ms"] = Percentile(latencies_ms_, 0.5);
+    state.counters["p99_ms"] = Percentile(latencies_ms_, 0.99);
+    state.counters["loop_lag_ms"] = absl::ToDoubleMilliseconds(max_loop_lag_);
+    state.counters["loop_stall_ms"] =
+        absl::ToDoubleMilliseconds(fetcher_.TakeEventLoopStall());
+    for (const auto& [name, ratio] :
+         MultiCurlHttpFetcherAsync::GetReuseRatios()) {
+      state.counters[absl::StrCat(name, "_reuse")] = ratio;
+    }
+  }
+
+ private:
+  MultiCurlHttpFetcherAsync& fetcher_;
+  absl::Duration max_loop_lag_ = absl::ZeroDuration();
+  absl::Mutex mu_;
+  std::vector<double> latencies_ms_ ABSL_GUARDED_BY(mu_);
+};
+
+// Args: bytes of the responses, concurrent requests, latency of the server
+// in milliseconds.
+static void BM_FetchUrl(benchmark::State& state) {
+  const int64_t response_bytes = state.range(0);
+  const int concurrency = state.range(1);
+  const std::string url =
+      GetServer().Url(response_bytes, absl::Milliseconds(state.range(2)));
+  MultiCurlHttpFetcherAsync fetcher(&GetExecutor());
+  FetchRecorder recorder(fetcher);
+  for (auto _ : state) {
+    absl::BlockingCounter done(concurrency);
+    for (int i = 0; i < concurrency; ++i) {
+      fetcher.FetchUrl(
+          {.url = url}, kTimeoutMs,
+          [&recorder, &done, response_bytes, start = absl::Now()](
+              absl::StatusOr<std::string> response) {
+            CHECK_OK(response);
+            CHECK_EQ(static_cast<int64_t>(response->size()), response_bytes);
+            recorder.RecordLatency(absl::Now() - start);
+            done.DecrementCount();
+          });
+    }
+    done.Wait();
+    recorder.SampleEventLoop();
+  }
+  recorder.Report(state, concurrency, response_bytes);
+}
+
+// Args: bytes of the responses, requests of each FetchUrls call, latency of
+// the server in milliseconds. The latency recorded is that of the call.
+static void BM_FetchUrls(benchmark::State& state) {
+  const int64_t response_bytes = state.range(0);
+  const int num_requests = state.range(1);
+  const std::vector<HTTPRequest> requests(
+      num_requests,
+      {.url = GetServer().Url(response_bytes,
+                              absl::Milliseconds(state.range(2)))});
+  MultiCurlHttpFetcherAsync fetcher(&GetExecutor());
+  FetchRecorder recorder(fetcher);
+  for (auto _ : state) {
+    absl::BlockingCounter done(1);
+    fetcher.FetchUrls(
+        requests, absl::Milliseconds(kTimeoutMs),
+        [&recorder, &done, response_bytes, start = absl::Now()](
+            std::vector<absl::StatusOr<std::string>> responses) {
+          for (const absl::StatusOr<std::string>& response : responses) {
+            CHECK_OK(response);
+            CHECK_EQ(static_cast<int64_t>(response->size()), response_bytes);
+          }
+          recorder.RecordLatency(absl::Now() - start);
+          done.DecrementCount();
+        });
+    done.Wait();
+    recorder.SampleEventLoop();
+  }
+  recorder.Report(state, num_requests, response_bytes);
+}
+
+// Args: bytes of the uploaded bodies, concurrent requests, latency of the
+// server in milliseconds.
+static void BM_PutUrl(benchmark::State& state) {
+  const int64_t body_bytes = state.range(0);
+  const int concurrency = state.range(1);
+  const HTTPRequest request = {
+      .url = GetServer().Url(/*response_bytes=*/0,
+                             absl::Milliseconds(state.range(2))),
+      .body = std::string(body_bytes, 'p')};
+  MultiCurlHttpFetcherAsync fetcher(&GetExecutor());
+  FetchRecorder recorder(fetcher);
+  for (auto _ : state) {
+    absl::BlockingCounter done(concurrency);
+    for (int i = 0; i < concurrency; ++i) {
+      fetcher.PutUrl(request, kTimeoutMs,
+                     [&recorder, &done, start = absl::Now()](
+                         absl::StatusOr<std::string> response) {
+                       CHECK_OK(response);
+                       recorder.RecordLatency(absl::Now() - start);
+                       done.DecrementCount();
+                     });
+    }
+    done.Wait();
+    recorder.SampleEventLoop();
+  }
+  recorder.Report(state, concurrency, body_bytes);
+}
+
+void SizesConcurrencyAndLatencies(benchmark::internal::Benchmark* benchmark) {
+  benchmark
+      ->ArgsProduct({{1 << 10, 64 << 10, 1 << 20}, {1, 8, 64, 256}, {0, 5}})
+      ->Unit(benchmark::kMillisecond)
+      ->UseRealTime();
+}
+
+BENCHMARK(BM_FetchUrl)
+    ->ArgNames({"response_bytes", "concurrency", "latency_ms"})
+    ->Apply(SizesConcurrencyAndLatencies);
+BENCHMARK(BM_FetchUrls)
+    ->ArgNames({"response_bytes", "requests", "latency_ms"})
+    ->Apply(SizesConcurrencyAndLatencies);
+BENCHMARK(BM_PutUrl)
+    ->ArgNames({"body_bytes", "concurrency", "latency_ms"})
+    ->Apply(SizesConcurrencyAndLatencies);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
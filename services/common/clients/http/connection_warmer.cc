@@ -0,0 +1,86 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http/connection_warmer.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "src/logger/request_context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+ConnectionWarmer::ConnectionWarmer(HttpFetcherAsync* http_fetcher_async,
+                                   HTTPRequest warm_request,
+                                   const ConnectionWarmingOptions& options)
+    : http_fetcher_async_(http_fetcher_async),
+      warm_request_(std::move(warm_request)),
+      options_(options) {}
+
+ConnectionWarmer::~ConnectionWarmer() {
+  absl::MutexLock lock(&mu_);
+  stopped_ = true;
+  if (rewarm_scheduled_ && options_.executor->Cancel(rewarm_task_id_)) {
+    rewarm_scheduled_ = false;
+  }
+  mu_.Await(absl::Condition(
+      +[](bool* rewarm_scheduled) { return !*rewarm_scheduled; },
+      &rewarm_scheduled_));
+}
+
+void ConnectionWarmer::Start() {
+  WarmUp();
+  absl::MutexLock lock(&mu_);
+  ScheduleRewarm();
+}
+
+void ConnectionWarmer::WarmUp() {
+  // Without periodic re-warming a single request is enough to resolve the host
+  // and perform the handshake, as before.
+  const bool open_fresh_connections = options_.executor != nullptr;
+  const int num_connections =
+      open_fresh_connections ? std::max(1, options_.min_warm_connections) : 1;
+  HTTPRequest request = warm_request_;
+  request.fresh_connection = open_fresh_connections;
+  PS_VLOG(5) << "Warming " << num_connections << " connections to "
+             << request.url;
+  for (int i = 0; i < num_connections; ++i) {
+    http_fetcher_async_->FetchUrl(
+        request, kWarmUpRequestTimeoutMs,
+        [url = request.url](absl::StatusOr<std::string> response) {
+          if (!response.ok()) {
+            PS_LOG(ERROR) << "Warm-up request to " << url
+                          << " returned status: " << response.status();
+          }
+        });
+  }
+}
+
+void ConnectionWarmer::ScheduleRewarm() {
+  if (stopped_ || options_.executor == nullptr ||
+      options_.rewarm_interval <= absl::ZeroDuration()) {
+    return;
+  }
+  rewarm_scheduled_ = true;
+  rewarm_task_id_ =
+      options_.executor->RunAfter(options_.rewarm_interval, [this]() {
+        WarmUp();
+        absl::MutexLock lock(&mu_);
+        rewarm_scheduled_ = false;
+        ScheduleRewarm();
+      });
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
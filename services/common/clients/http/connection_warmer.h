@@ -0,0 +1,82 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_CONNECTION_WARMER_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_CONNECTION_WARMER_H_
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Timeout of the warm-up requests, which pay for DNS resolution and the TLS
+// handshake.
+inline constexpr int kWarmUpRequestTimeoutMs = 60000;
+
+// Options for keeping connections to an HTTP server warm.
+struct ConnectionWarmingOptions {
+  // Executor used to schedule the periodic re-warming. Warming is done once,
+  // over a single connection, if not set.
+  server_common::Executor* executor = nullptr;
+  // Number of connections opened on every warm-up.
+  int min_warm_connections = 1;
+  // Interval at which fresh connections are opened again, so that new server
+  // replicas (after scale events or DNS changes) get warm connections too.
+  // Connections are warmed only once if zero.
+  absl::Duration rewarm_interval = absl::ZeroDuration();
+};
+
+// ConnectionWarmer keeps a minimum number of connections to the host of
+// warm_request in the connection pool of an HttpFetcherAsync by sending
+// warm_request over min_warm_connections fresh connections, and repeats that
+// every rewarm_interval. Warm-up failures are only logged.
+class ConnectionWarmer {
+ public:
+  // http_fetcher_async and options.executor must outlive the instance.
+  ConnectionWarmer(HttpFetcherAsync* http_fetcher_async,
+                   HTTPRequest warm_request,
+                   const ConnectionWarmingOptions& options);
+
+  // Stops re-warming. Blocks until a running re-warm task finishes.
+  ~ConnectionWarmer();
+
+  // Not copyable or movable.
+  ConnectionWarmer(const ConnectionWarmer&) = delete;
+  ConnectionWarmer& operator=(const ConnectionWarmer&) = delete;
+
+  // Warms the connections and schedules the re-warming.
+  void Start() ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void WarmUp();
+
+  void ScheduleRewarm() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  HttpFetcherAsync* http_fetcher_async_;
+  const HTTPRequest warm_request_;
+  const ConnectionWarmingOptions options_;
+
+  absl::Mutex mu_;
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+  bool rewarm_scheduled_ ABSL_GUARDED_BY(mu_) = false;
+  server_common::TaskId rewarm_task_id_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_CONNECTION_WARMER_H_
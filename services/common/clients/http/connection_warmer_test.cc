@@ -0,0 +1,92 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http/connection_warmer.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+constexpr char kUrl[] = "https://kv.example.com/v1";
+constexpr absl::Duration kRewarmInterval = absl::Seconds(30);
+
+TEST(ConnectionWarmerTest, SendsSingleRequestWithoutExecutor) {
+  MockHttpFetcherAsync fetcher;
+  EXPECT_CALL(fetcher, FetchUrl)
+      .WillOnce([](const HTTPRequest& request, int timeout_ms,
+                   OnDoneFetchUrl done_callback) {
+        EXPECT_EQ(request.url, kUrl);
+        EXPECT_FALSE(request.fresh_connection);
+        EXPECT_EQ(timeout_ms, kWarmUpRequestTimeoutMs);
+        std::move(done_callback)("");
+      });
+
+  ConnectionWarmer warmer(&fetcher, {kUrl}, {.min_warm_connections = 4});
+  warmer.Start();
+}
+
+TEST(ConnectionWarmerTest, OpensFreshConnectionsAndRewarmsPeriodically) {
+  MockHttpFetcherAsync fetcher;
+  MockExecutor executor;
+  EXPECT_CALL(fetcher, FetchUrl)
+      .Times(6)
+      .WillRepeatedly([](const HTTPRequest& request, int timeout_ms,
+                         OnDoneFetchUrl done_callback) {
+        EXPECT_TRUE(request.fresh_connection);
+        std::move(done_callback)(absl::UnavailableError("unreachable"));
+      });
+  absl::AnyInvocable<void()> rewarm;
+  EXPECT_CALL(executor, RunAfter(kRewarmInterval, _))
+      .Times(2)
+      .WillRepeatedly(
+          [&rewarm](absl::Duration, absl::AnyInvocable<void()> closure) {
+            rewarm = std::move(closure);
+            return server_common::TaskId();
+          });
+  EXPECT_CALL(executor, Cancel).WillOnce(Return(true));
+
+  ConnectionWarmer warmer(&fetcher, {kUrl},
+                          {.executor = &executor,
+                           .min_warm_connections = 3,
+                           .rewarm_interval = kRewarmInterval});
+  warmer.Start();
+  // Runs the scheduled re-warm, which schedules the next one.
+  std::move(rewarm)();
+}
+
+TEST(ConnectionWarmerTest, DoesNotRewarmWithoutInterval) {
+  MockHttpFetcherAsync fetcher;
+  MockExecutor executor;
+  EXPECT_CALL(fetcher, FetchUrl).Times(2);
+  EXPECT_CALL(executor, RunAfter).Times(0);
+  EXPECT_CALL(executor, Cancel).Times(0);
+
+  ConnectionWarmer warmer(&fetcher, {kUrl},
+                          {.executor = &executor, .min_warm_connections = 2});
+  warmer.Start();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
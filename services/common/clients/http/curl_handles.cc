@@ -0,0 +1,107 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http/curl_handles.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+// Handles handed out by the pools of all fetchers since the last TakeCounts.
+std::atomic<int64_t> num_acquired = 0;
+std::atomic<int64_t> num_reused = 0;
+
+}  // namespace
+
+CurlShare& CurlShare::Get() {
+  static CurlShare* share = new CurlShare;
+  return *share;
+}
+
+CurlShare::CurlShare() {
+  curl_global_init(CURL_GLOBAL_ALL);
+  share_ = curl_share_init();
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, Lock);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, Unlock);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+void CurlShare::Attach(CURL* handle) {
+  curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+}
+
+void CurlShare::Lock(CURL* handle, curl_lock_data data,
+                     curl_lock_access access, void* user_ptr)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  static_cast<CurlShare*>(user_ptr)->mu_[data].Lock();
+}
+
+void CurlShare::Unlock(CURL* handle, curl_lock_data data, void* user_ptr)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  static_cast<CurlShare*>(user_ptr)->mu_[data].Unlock();
+}
+
+CurlEasyHandlePool::CurlEasyHandlePool(int max_idle_handles)
+    : max_idle_handles_(max_idle_handles) {}
+
+CurlEasyHandlePool::~CurlEasyHandlePool() {
+  absl::MutexLock lock(&mu_);
+  for (CURL* handle : idle_handles_) {
+    curl_easy_cleanup(handle);
+  }
+}
+
+CURL* CurlEasyHandlePool::Acquire() {
+  num_acquired.fetch_add(1, std::memory_order_relaxed);
+  CURL* handle = nullptr;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!idle_handles_.empty()) {
+      handle = idle_handles_.back();
+      idle_handles_.pop_back();
+    }
+  }
+  if (handle != nullptr) {
+    num_reused.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+  }
+  handle = curl_easy_init();
+  CurlShare::Get().Attach(handle);
+  return handle;
+}
+
+void CurlEasyHandlePool::Release(CURL* handle) {
+  if (handle == nullptr) {
+    return;
+  }
+  // Resets the options set for the transfer, keeping the share object.
+  curl_easy_reset(handle);
+  {
+    absl::MutexLock lock(&mu_);
+    if (static_cast<int>(idle_handles_.size()) < max_idle_handles_) {
+      idle_handles_.push_back(handle);
+      return;
+    }
+  }
+  curl_easy_cleanup(handle);
+}
+
+CurlEasyHandlePool::Counts CurlEasyHandlePool::TakeCounts() {
+  return {.acquired = num_acquired.exchange(0, std::memory_order_relaxed),
+          .reused = num_reused.exchange(0, std::memory_order_relaxed)};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,98 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLES_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLES_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Curl share object of the process, through which the easy handles of every
+// HTTP fetcher share the DNS cache and the TLS session ids, so that a host
+// resolved or a TLS session negotiated by one fetcher is reused by the others.
+// Connections stay in the connection cache of the multi handle of each
+// fetcher, since a connection is driven by the event loop of its fetcher.
+// More info: https://curl.se/libcurl/c/libcurl-share.html
+class CurlShare {
+ public:
+  // Share object of the process, never destroyed.
+  static CurlShare& Get();
+
+  // CurlShare is neither copyable nor movable.
+  CurlShare(const CurlShare&) = delete;
+  CurlShare& operator=(const CurlShare&) = delete;
+
+  // Makes `handle` use the share object. Kept through curl_easy_reset.
+  void Attach(CURL* handle);
+
+ private:
+  CurlShare();
+
+  // Locking callbacks of the share object, with the CurlShare as `user_ptr`.
+  static void Lock(CURL* handle, curl_lock_data data, curl_lock_access access,
+                   void* user_ptr);
+  static void Unlock(CURL* handle, curl_lock_data data, void* user_ptr);
+
+  CURLSH* share_;
+  // One lock per kind of shared data, so that DNS lookups do not wait on TLS
+  // session lookups.
+  std::array<absl::Mutex, CURL_LOCK_DATA_LAST> mu_;
+};
+
+// Idle easy handles of a fetcher, reset and handed out again instead of being
+// cleaned up, which keeps their internal buffers and caches. Thread-safe.
+class CurlEasyHandlePool {
+ public:
+  // Keeps up to `max_idle_handles` idle handles, cleaning up the others.
+  explicit CurlEasyHandlePool(int max_idle_handles = 256);
+  ~CurlEasyHandlePool() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // CurlEasyHandlePool is neither copyable nor movable.
+  CurlEasyHandlePool(const CurlEasyHandlePool&) = delete;
+  CurlEasyHandlePool& operator=(const CurlEasyHandlePool&) = delete;
+
+  // Returns an idle handle with its options reset to their defaults, or a new
+  // handle if none is idle. The handle uses the share object of the process.
+  CURL* Acquire() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Gives `handle` back to the pool once its transfer is done and it was
+  // removed from its multi handle.
+  void Release(CURL* handle) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Number of handles handed out since the last call, and how many of them
+  // were reused.
+  struct Counts {
+    int64_t acquired = 0;
+    int64_t reused = 0;
+  };
+  static Counts TakeCounts();
+
+ private:
+  const int max_idle_handles_;
+  absl::Mutex mu_;
+  std::vector<CURL*> idle_handles_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLES_H_
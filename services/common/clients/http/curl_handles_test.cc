@@ -0,0 +1,70 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http/curl_handles.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(CurlEasyHandlePoolTest, ReusesReleasedHandles) {
+  CurlEasyHandlePool::TakeCounts();
+  CurlEasyHandlePool pool;
+  CURL* first = pool.Acquire();
+  ASSERT_NE(first, nullptr);
+  pool.Release(first);
+
+  CURL* second = pool.Acquire();
+
+  EXPECT_EQ(second, first);
+  pool.Release(second);
+  CurlEasyHandlePool::Counts counts = CurlEasyHandlePool::TakeCounts();
+  EXPECT_EQ(counts.acquired, 2);
+  EXPECT_EQ(counts.reused, 1);
+  counts = CurlEasyHandlePool::TakeCounts();
+  EXPECT_EQ(counts.acquired, 0);
+}
+
+TEST(CurlEasyHandlePoolTest, ResetsReleasedHandles) {
+  CurlEasyHandlePool pool;
+  CURL* handle = pool.Acquire();
+  int data = 0;
+  curl_easy_setopt(handle, CURLOPT_PRIVATE, &data);
+  pool.Release(handle);
+
+  handle = pool.Acquire();
+
+  void* private_data = &data;
+  curl_easy_getinfo(handle, CURLINFO_PRIVATE, &private_data);
+  EXPECT_EQ(private_data, nullptr);
+  pool.Release(handle);
+}
+
+TEST(CurlEasyHandlePoolTest, CleansUpHandlesPastTheIdleLimit) {
+  CurlEasyHandlePool pool(/*max_idle_handles=*/1);
+  CURL* first = pool.Acquire();
+  CURL* second = pool.Acquire();
+  pool.Release(first);
+  pool.Release(second);
+
+  EXPECT_EQ(pool.Acquire(), first);
+  CURL* third = pool.Acquire();
+  EXPECT_NE(third, first);
+  pool.Release(first);
+  pool.Release(third);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
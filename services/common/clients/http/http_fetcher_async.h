@@ -15,23 +15,51 @@
 #ifndef SERVICES_COMMON_CLIENTS_HTTP_FETCHER_ASYNC_H_
 #define SERVICES_COMMON_CLIENTS_HTTP_FETCHER_ASYNC_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "services/common/util/request_cancellation.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Consumer of the body of a response as it streams in, e.g. to parse it while
+// the rest of it is still on the wire.
+class HttpBodyConsumer {
+ public:
+  virtual ~HttpBodyConsumer() = default;
+
+  // Called with each chunk of the body, in order, on the event loop of the
+  // fetcher, so it must not block.
+  virtual void OnBodyChunk(absl::string_view chunk) = 0;
+};
+
 struct HTTPRequest {
   std::string url;
   // Optional
   std::vector<std::string> headers = {};
   // Optional
   std::string body = "";
+  // Optional. Opens a new connection for this request instead of reusing or
+  // multiplexing over a pooled one. The new connection is pooled afterwards.
+  bool fresh_connection = false;
+  // Optional. Cancellation of the request this fetch is made for. The fetch is
+  // dropped with a CANCELLED error once it is cancelled, if the fetcher
+  // supports it.
+  std::shared_ptr<RequestCancellation> cancellation;
+  // Optional. Fed the body of the response as it streams in, if the fetcher
+  // supports it. The whole body is still passed to the done callback.
+  std::shared_ptr<HttpBodyConsumer> body_consumer;
 };
 
+// Priority class of the requests of a fetcher. Low priority fetchers, e.g. of
+// reporting pings, are throttled first when the process is overloaded.
+enum class HttpFetcherPriority { kHigh, kLow };
+
 using OnDoneFetchUrl = absl::AnyInvocable<void(absl::StatusOr<std::string>) &&>;
 using OnDoneFetchUrls =
     absl::AnyInvocable<void(std::vector<absl::StatusOr<std::string>>) &&>;
@@ -65,6 +93,17 @@ class HttpFetcherAsync {
   virtual void PutUrl(const HTTPRequest& http_request, int timeout_ms,
                       OnDoneFetchUrl done_callback) = 0;
 
+  // POSTs data to the specified url.
+  //
+  // http_request: The URL, headers, body for the HTTP POST request.
+  // timeout_ms: The request timeout
+  // done_callback: Output param. Invoked either on error or after finished
+  // receiving a response. Please note that done_callback will run in a
+  // threadpool and is not guaranteed to be the FetchUrl client's thread.
+  // Clients can expect done_callback to be called exactly once.
+  virtual void PostUrl(const HTTPRequest& http_request, int timeout_ms,
+                       OnDoneFetchUrl done_callback) = 0;
+
   // Fetches the specified urls.
   //
   // requests: The URL and headers for the HTTP GET request.
@@ -15,6 +15,9 @@
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -33,6 +36,33 @@ using ::grpc_event_engine::experimental::EventEngine;
 namespace {
 
 constexpr int log_level = 2;
+
+// Most bytes reserved up front for the output of a request, whatever its
+// Content-Length claims.
+constexpr curl_off_t kMaxOutputReserveBytes = 64 << 20;
+
+// Requests pending in the high priority fetchers of the process. Low priority
+// fetchers are throttled while this is above their threshold.
+std::atomic<int64_t> high_priority_pending_requests{0};
+
+// Transfers of all fetchers completed since the last GetReuseRatios call, and
+// how many of them were made over a connection that was already open.
+std::atomic<int64_t> num_transfers{0};
+std::atomic<int64_t> num_reused_connections{0};
+
+// Counts whether the transfer of `handle` reused a connection.
+void RecordConnectionReuse(CURL* handle) {
+  long new_connections = 0;
+  if (curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &new_connections) !=
+      CURLE_OK) {
+    return;
+  }
+  num_transfers.fetch_add(1, std::memory_order_relaxed);
+  if (new_connections == 0) {
+    num_reused_connections.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
 struct CurlTimeStats {
   double time_namelookup = -1;
   double time_connect = -1;
@@ -144,9 +174,16 @@ static struct timeval OneSecond = {1, 0};
 MultiCurlHttpFetcherAsync::MultiCurlHttpFetcherAsync(
     server_common::Executor* executor, int64_t keepalive_interval_sec,
     int64_t keepalive_idle_sec)
+    : MultiCurlHttpFetcherAsync(executor, HttpFetcherLaneOptions(),
+                                keepalive_interval_sec, keepalive_idle_sec) {}
+
+MultiCurlHttpFetcherAsync::MultiCurlHttpFetcherAsync(
+    server_common::Executor* executor, HttpFetcherLaneOptions lane,
+    int64_t keepalive_interval_sec, int64_t keepalive_idle_sec)
     : executor_(executor),
       keepalive_idle_sec_(keepalive_idle_sec),
       keepalive_interval_sec_(keepalive_interval_sec),
+      lane_(lane),
       // Shutdown timer event is persistent because we don't want to remove
       // it from the event loop the first time it fires. With this timer, we
       // periodically check for fetcher shutdown and terminate the event loop
@@ -161,8 +198,13 @@ MultiCurlHttpFetcherAsync::MultiCurlHttpFetcherAsync(
           event_base_.get(), /*fd=*/-1, /*event_type=*/0,
           /*event_callback=*/multi_curl_request_manager_.MultiTimerCallback,
           /*arg=*/&multi_curl_request_manager_)) {
+  if (lane_.max_connections > 0 || lane_.max_host_connections > 0) {
+    multi_curl_request_manager_.SetConnectionLimits(
+        lane_.max_connections, lane_.max_host_connections);
+  }
   multi_curl_request_manager_.Configure([this]() { PerformCurlUpdate(); },
                                         multi_timer_event_.get());
+  last_loop_tick_ = absl::Now();
   // Start execution loop.
   executor_->Run([this]() {
     PS_VLOG(5) << "libevent scheduled the event loop";
@@ -173,7 +215,17 @@ MultiCurlHttpFetcherAsync::MultiCurlHttpFetcherAsync(
 void MultiCurlHttpFetcherAsync::ShutdownEventLoop(int fd, short event_type,
                                                   void* arg) {
   auto* self = reinterpret_cast<MultiCurlHttpFetcherAsync*>(arg);
+  absl::Time now = absl::Now();
+  absl::Duration lag = std::max(
+      now - self->last_loop_tick_ - absl::DurationFromTimeval(OneSecond),
+      absl::ZeroDuration());
+  self->event_loop_lag_us_.store(absl::ToInt64Microseconds(lag),
+                                 std::memory_order_relaxed);
+  self->last_loop_tick_ = now;
   if (!self->shutdown_requested_.HasBeenNotified()) {
+    // Held back requests are otherwise only released as requests complete,
+    // so also release them once the high priority fetchers have caught up.
+    self->AddThrottledRequests();
     return;
   }
 
@@ -183,10 +235,19 @@ void MultiCurlHttpFetcherAsync::ShutdownEventLoop(int fd, short event_type,
 }
 
 MultiCurlHttpFetcherAsync::~MultiCurlHttpFetcherAsync()
-    ABSL_LOCKS_EXCLUDED(in_loop_mu_, curl_handle_set_lock_) {
+    ABSL_LOCKS_EXCLUDED(in_loop_mu_, curl_handle_set_lock_,
+                        throttled_requests_mu_) {
   // Notify other threads about shutdown.
   shutdown_requested_.Notify();
   shutdown_complete_.WaitForNotification();
+  {
+    absl::MutexLock lock(&throttled_requests_mu_);
+    for (auto& request : throttled_requests_) {
+      std::move(request->done_callback)(
+          absl::InternalError("Request cancelled due to server shutdown."));
+    }
+    throttled_requests_.clear();
+  }
   // We ensure that no other thread will lock callback_map_lock_ and in_loop_mu_
   // here since no new requests are being accepted, or processed through
   // the execution loop.
@@ -216,11 +277,31 @@ MultiCurlHttpFetcherAsync::~MultiCurlHttpFetcherAsync()
 // data: A pointer to the data that was delivered over the wire.
 // size: (legacy) size is always 1. Represents 1 byte.
 // number_elements: the number of elements (each of size 1 byte) to write
-// output: a libcurl-client-provided pointer of where to save the data
+// request_data: the CurlRequestData of the request, holding the output
 // return: number of bytes actually written to output
-static size_t WriteCallback(char* data, size_t size, size_t number_elements,
-                            std::string* output) {
-  output->append(reinterpret_cast<char*>(data), size * number_elements);
+size_t MultiCurlHttpFetcherAsync::WriteCallback(char* data, size_t size,
+                                                size_t number_elements,
+                                                void* request_data) {
+  auto* request = static_cast<CurlRequestData*>(request_data);
+  std::string& output = *request->output;
+  if (output.empty()) {
+    // Headers are in by the first chunk of the body, so the output is sized
+    // once from the Content-Length, when sent, rather than growing chunk by
+    // chunk. The length is that of the encoded body, so a lower bound.
+    curl_off_t content_length = -1;
+    if (curl_easy_getinfo(request->req_handle,
+                          CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                          &content_length) == CURLE_OK &&
+        content_length > 0) {
+      output.reserve(static_cast<size_t>(
+          std::min<curl_off_t>(content_length, kMaxOutputReserveBytes)));
+    }
+  }
+  output.append(data, size * number_elements);
+  if (request->body_consumer != nullptr) {
+    request->body_consumer->OnBodyChunk(
+        absl::string_view(data, size * number_elements));
+  }
   return size * number_elements;
 }
 
@@ -294,12 +375,15 @@ MultiCurlHttpFetcherAsync::CreateCurlRequest(const HTTPRequest& request,
                                              int64_t keepalive_interval_sec,
                                              OnDoneFetchUrl done_callback) {
   auto curl_request_data = std::make_unique<CurlRequestData>(
-      request.headers, std::move(done_callback));
+      handle_pool_, request.headers, std::move(done_callback));
+  curl_request_data->id =
+      next_request_id_.fetch_add(1, std::memory_order_relaxed);
+  curl_request_data->cancellation = request.cancellation;
+  curl_request_data->body_consumer = request.body_consumer;
   CURL* req_handle = curl_request_data->req_handle;
   curl_easy_setopt(req_handle, CURLOPT_WRITEFUNCTION, WriteCallback);
   curl_easy_setopt(req_handle, CURLOPT_URL, request.url.begin());
-  curl_easy_setopt(req_handle, CURLOPT_WRITEDATA,
-                   curl_request_data->output.get());
+  curl_easy_setopt(req_handle, CURLOPT_WRITEDATA, curl_request_data.get());
   curl_easy_setopt(req_handle, CURLOPT_PRIVATE, curl_request_data.get());
   curl_easy_setopt(req_handle, CURLOPT_FOLLOWLOCATION, 1);
   curl_easy_setopt(req_handle, CURLOPT_TIMEOUT_MS, timeout_ms);
@@ -314,6 +398,14 @@ MultiCurlHttpFetcherAsync::CreateCurlRequest(const HTTPRequest& request,
   // Set CURLOPT_ACCEPT_ENCODING to an empty string to pass all supported
   // encodings. See https://curl.se/libcurl/c/CURLOPT_ACCEPT_ENCODING.html.
   curl_easy_setopt(req_handle, CURLOPT_ACCEPT_ENCODING, "");
+  // Negotiate HTTP/2 over TLS (falling back to HTTP/1.1) and prefer waiting
+  // for a connection that can be multiplexed over opening a new one.
+  curl_easy_setopt(req_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  if (request.fresh_connection) {
+    curl_easy_setopt(req_handle, CURLOPT_FRESH_CONNECT, 1L);
+  } else {
+    curl_easy_setopt(req_handle, CURLOPT_PIPEWAIT, 1L);
+  }
 
   // Set HTTP headers.
   if (!request.headers.empty()) {
@@ -331,6 +423,116 @@ void MultiCurlHttpFetcherAsync::ExecuteCurlRequest(
         absl::InternalError("Client is shutting down."));
     return;
   }
+  if (!RegisterCancellation(*request)) {
+    return;
+  }
+  if (lane_.priority == HttpFetcherPriority::kLow) {
+    absl::MutexLock lock(&throttled_requests_mu_);
+    // Requests already held back go first to preserve the order.
+    if (!throttled_requests_.empty() || !CanAddLowPriorityRequest()) {
+      PS_VLOG(8) << "Holding back low priority request, "
+                 << throttled_requests_.size() << " already held back";
+      throttled_requests_.push_back(std::move(request));
+      return;
+    }
+  }
+  AddCurlRequest(std::move(request));
+}
+
+bool MultiCurlHttpFetcherAsync::CanAddLowPriorityRequest() const {
+  const int64_t pending = NumPendingRequests();
+  if (lane_.max_pending_requests > 0 &&
+      pending >= lane_.max_pending_requests) {
+    return false;
+  }
+  // Under overload only keep a single low priority request in flight.
+  if (lane_.throttle_above_high_priority_pending > 0 && pending > 0 &&
+      high_priority_pending_requests.load(std::memory_order_relaxed) >
+          lane_.throttle_above_high_priority_pending) {
+    return false;
+  }
+  return true;
+}
+
+bool MultiCurlHttpFetcherAsync::RegisterCancellation(
+    CurlRequestData& request) {
+  if (request.cancellation == nullptr) {
+    return true;
+  }
+  if (request.cancellation->IsCancelled()) {
+    std::move(request.done_callback)(
+        absl::CancelledError(kRequestCancelledError));
+    return false;
+  }
+  request.cancellation_id = request.cancellation->Register(
+      [this, req_handle = request.req_handle, request_id = request.id]() {
+        struct timeval now = {0, 0};
+        event_base_once(event_base_.get(), /*fd=*/-1, EV_TIMEOUT, CancelFetch,
+                        new CancelFetchArgs{this, req_handle, request_id},
+                        &now);
+      });
+  return true;
+}
+
+void MultiCurlHttpFetcherAsync::CancelFetch(int fd, short event_type,
+                                            void* arg) {
+  std::unique_ptr<CancelFetchArgs> args(static_cast<CancelFetchArgs*>(arg));
+  args->fetcher->CancelPendingRequest(args->req_handle, args->request_id);
+}
+
+void MultiCurlHttpFetcherAsync::CancelPendingRequest(CURL* req_handle,
+                                                     int64_t request_id) {
+  std::unique_ptr<CurlRequestData> request;
+  {
+    absl::MutexLock lock(&curl_handle_set_lock_);
+    CurlRequestData* pending = nullptr;
+    if (curl_handle_set_.contains(req_handle)) {
+      curl_easy_getinfo(req_handle, CURLINFO_PRIVATE, &pending);
+    }
+    if (pending != nullptr && pending->id == request_id) {
+      request.reset(pending);
+    }
+  }
+  if (request != nullptr) {
+    PS_VLOG(8) << "Removing the curl handle of a cancelled request";
+    multi_curl_request_manager_.Remove(req_handle);
+    Remove(req_handle);
+  } else {
+    // The request is either done or still held back.
+    absl::MutexLock lock(&throttled_requests_mu_);
+    auto it = std::find_if(throttled_requests_.begin(),
+                           throttled_requests_.end(),
+                           [request_id](const auto& throttled) {
+                             return throttled->id == request_id;
+                           });
+    if (it == throttled_requests_.end()) {
+      return;
+    }
+    request = std::move(*it);
+    throttled_requests_.erase(it);
+  }
+  executor_->Run([request = std::move(request)]() mutable {
+    std::move(request->done_callback)(
+        absl::CancelledError(kRequestCancelledError));
+  });
+  AddThrottledRequests();
+}
+
+void MultiCurlHttpFetcherAsync::AddThrottledRequests() {
+  if (lane_.priority != HttpFetcherPriority::kLow) {
+    return;
+  }
+  absl::MutexLock lock(&throttled_requests_mu_);
+  while (!throttled_requests_.empty() && CanAddLowPriorityRequest()) {
+    std::unique_ptr<CurlRequestData> request =
+        std::move(throttled_requests_.front());
+    throttled_requests_.pop_front();
+    AddCurlRequest(std::move(request));
+  }
+}
+
+void MultiCurlHttpFetcherAsync::AddCurlRequest(
+    std::unique_ptr<CurlRequestData> request) {
   // Check for errors from multi handle here and execute callback immediately.
   auto* req_handle = request->req_handle;
   CURLMcode mc = multi_curl_request_manager_.Add(req_handle);
@@ -391,6 +593,24 @@ void MultiCurlHttpFetcherAsync::PutUrl(const HTTPRequest& http_request,
   ExecuteCurlRequest(std::move(request));
 }
 
+void MultiCurlHttpFetcherAsync::PostUrl(const HTTPRequest& http_request,
+                                        int timeout_ms,
+                                        OnDoneFetchUrl done_callback) {
+  auto request =
+      CreateCurlRequest(http_request, timeout_ms, keepalive_idle_sec_,
+                        keepalive_interval_sec_, std::move(done_callback));
+
+  request->body =
+      std::make_unique<DataToUpload>(DataToUpload{http_request.body});
+  curl_easy_setopt(request->req_handle, CURLOPT_POST, 1L);
+  curl_easy_setopt(request->req_handle, CURLOPT_POSTFIELDSIZE_LARGE,
+                   static_cast<curl_off_t>(http_request.body.size()));
+  curl_easy_setopt(request->req_handle, CURLOPT_READDATA, request->body.get());
+  curl_easy_setopt(request->req_handle, CURLOPT_READFUNCTION, ReadCallback);
+
+  ExecuteCurlRequest(std::move(request));
+}
+
 std::pair<absl::Status, void*> MultiCurlHttpFetcherAsync::GetResultFromMsg(
     CURLMsg* msg) {
   void* output;
@@ -436,66 +656,148 @@ void MultiCurlHttpFetcherAsync::PerformCurlUpdate()
     ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_) {
   // Check for updates (provide computation for Libcurl to perform I/O).
   int msgs_left = -1;
+  std::vector<Completion> completions;
   while (CURLMsg* msg = multi_curl_request_manager_.GetUpdate(&msgs_left)) {
     PS_VLOG(10) << __func__ << ": A curl handle completed transfer";
     // Get data for completed message.
     auto [status, data_ptr] = GetResultFromMsg(msg);
+    if (msg->msg == CURLMSG_DONE && msg->data.result == CURLE_OK) {
+      RecordConnectionReuse(msg->easy_handle);
+    }
     multi_curl_request_manager_.Remove(msg->easy_handle);
     // Must be called before the handle has been cleaned up.
     // The cleanup happens at the end of the lambda in the next block when the
     // std::unique_ptr<CurlRequestData> object goes out of scope.
     Remove(msg->easy_handle);
-    // Execute callback in another thread.
-    executor_->Run([req_handle = msg->easy_handle, status = status,
-                    data_ptr = data_ptr]() mutable {
-      // If this happens, then we've effectively lost the reactor that made
-      // this call and this memory has leaked.
-      if (data_ptr == nullptr) {
-        ABSL_LOG(ERROR) << "Curl Error: Pointer to Curl data lost with status: "
-                        << status.message()
-                        << ". Memory for this call has leaked.";
-        return;
-      }
-      std::unique_ptr<CurlRequestData> curl_request_data_ptr(
-          static_cast<CurlRequestData*>(data_ptr));
-      // invoke callback for handle.
-      if (status.ok()) {
-        PS_VLOG(10) << "Invoking callback for successful curl operation";
-        std::move(curl_request_data_ptr->done_callback)(
-            *curl_request_data_ptr->output);
-      } else {
-        std::move(curl_request_data_ptr->done_callback)(status);
+    completions.push_back({.req_handle = msg->easy_handle,
+                           .status = std::move(status),
+                           .data = data_ptr});
+  }
+  // The callbacks run on the executor, so that the loop thread only does
+  // I/O.
+  DispatchCompletions(std::move(completions));
+  AddThrottledRequests();
+}
+
+void MultiCurlHttpFetcherAsync::RunCompletion(Completion& completion) {
+  // If this happens, then we've effectively lost the reactor that made
+  // this call and this memory has leaked.
+  if (completion.data == nullptr) {
+    ABSL_LOG(ERROR) << "Curl Error: Pointer to Curl data lost with status: "
+                    << completion.status.message()
+                    << ". Memory for this call has leaked.";
+    return;
+  }
+  std::unique_ptr<CurlRequestData> curl_request_data_ptr(
+      static_cast<CurlRequestData*>(completion.data));
+  // invoke callback for handle.
+  if (completion.status.ok()) {
+    PS_VLOG(10) << "Invoking callback for successful curl operation";
+    // The output is handed over, not copied.
+    std::move(curl_request_data_ptr->done_callback)(
+        std::move(*curl_request_data_ptr->output));
+  } else {
+    std::move(curl_request_data_ptr->done_callback)(completion.status);
+  }
+  // perform cleanup for handle.
+  GetTraceFromCurl(completion.req_handle);
+}
+
+void MultiCurlHttpFetcherAsync::DispatchCompletions(
+    std::vector<Completion> completions) {
+  const size_t per_task = std::max(lane_.completions_per_task, 1);
+  if (per_task == 1 || completions.size() == 1) {
+    for (Completion& completion : completions) {
+      executor_->Run([completion = std::move(completion)]() mutable {
+        RunCompletion(completion);
+      });
+    }
+    return;
+  }
+  for (size_t begin = 0; begin < completions.size(); begin += per_task) {
+    const size_t end = std::min(begin + per_task, completions.size());
+    std::vector<Completion> task(
+        std::make_move_iterator(completions.begin() + begin),
+        std::make_move_iterator(completions.begin() + end));
+    executor_->Run([task = std::move(task)]() mutable {
+      for (Completion& completion : task) {
+        RunCompletion(completion);
       }
-      // perform cleanup for handle.
-      GetTraceFromCurl(req_handle);
     });
   }
 }
+
 void MultiCurlHttpFetcherAsync::Add(CURL* handle) {
   // Add request handle to set if required for cleanup.
   absl::MutexLock lock(&curl_handle_set_lock_);
   curl_handle_set_.emplace(handle);
+  num_pending_requests_.fetch_add(1, std::memory_order_relaxed);
+  if (lane_.priority == HttpFetcherPriority::kHigh) {
+    high_priority_pending_requests.fetch_add(1, std::memory_order_relaxed);
+  }
 }
-void MultiCurlHttpFetcherAsync::Remove(CURL* handle) {
+bool MultiCurlHttpFetcherAsync::Remove(CURL* handle) {
   absl::MutexLock lock(&curl_handle_set_lock_);
-  curl_handle_set_.erase(handle);
+  if (curl_handle_set_.erase(handle) == 0) {
+    return false;
+  }
+  num_pending_requests_.fetch_sub(1, std::memory_order_relaxed);
+  if (lane_.priority == HttpFetcherPriority::kHigh) {
+    high_priority_pending_requests.fetch_sub(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+int64_t MultiCurlHttpFetcherAsync::NumPendingRequests() const {
+  return num_pending_requests_.load(std::memory_order_relaxed);
+}
+
+absl::Duration MultiCurlHttpFetcherAsync::TakeEventLoopStall() {
+  return multi_curl_request_manager_.TakeMaxEventDuration();
+}
+
+absl::Duration MultiCurlHttpFetcherAsync::EventLoopLag() const {
+  return absl::Microseconds(event_loop_lag_us_.load(std::memory_order_relaxed));
+}
+
+absl::flat_hash_map<std::string, double>
+MultiCurlHttpFetcherAsync::GetReuseRatios() {
+  absl::flat_hash_map<std::string, double> ratios;
+  const CurlEasyHandlePool::Counts handles = CurlEasyHandlePool::TakeCounts();
+  if (handles.acquired > 0) {
+    ratios["easy_handle"] =
+        static_cast<double>(handles.reused) / handles.acquired;
+  }
+  const int64_t transfers =
+      num_transfers.exchange(0, std::memory_order_relaxed);
+  const int64_t reused_connections =
+      num_reused_connections.exchange(0, std::memory_order_relaxed);
+  if (transfers > 0) {
+    ratios["connection"] = static_cast<double>(reused_connections) / transfers;
+  }
+  return ratios;
 }
 
 MultiCurlHttpFetcherAsync::CurlRequestData::CurlRequestData(
-    const std::vector<std::string>& headers, OnDoneFetchUrl on_done) {
+    std::shared_ptr<CurlEasyHandlePool> pool,
+    const std::vector<std::string>& headers, OnDoneFetchUrl on_done)
+    : handle_pool(std::move(pool)) {
   // Space for the fetch output must be heap allocated.
   // It can (potentially) be multiple megabytes in size, and many simultaneous
   // requests can be in flight due to the async nature of FetchUrl.
   // See CurlStateCleanup for all cleanup.
   output = std::make_unique<std::string>();
-  req_handle = curl_easy_init();
+  req_handle = handle_pool->Acquire();
   done_callback = std::move(on_done);
   for (const auto& header : headers) {
     headers_list_ptr = curl_slist_append(headers_list_ptr, header.c_str());
   }
 }
 MultiCurlHttpFetcherAsync::CurlRequestData::~CurlRequestData() {
+  if (cancellation != nullptr) {
+    cancellation->Unregister(cancellation_id);
+  }
   curl_slist_free_all(headers_list_ptr);
-  curl_easy_cleanup(req_handle);
+  handle_pool->Release(req_handle);
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
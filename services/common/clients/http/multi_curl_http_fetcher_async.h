@@ -15,6 +15,8 @@
 #ifndef SERVICES_COMMON_CLIENTS_MULTI_CURL_HTTP_FETCHER_ASYNC_H_
 #define SERVICES_COMMON_CLIENTS_MULTI_CURL_HTTP_FETCHER_ASYNC_H_
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,11 +26,15 @@
 #include <event2/event.h>
 #include <grpc/event_engine/event_engine.h>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "services/common/clients/http/curl_handles.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 #include "services/common/clients/http/multi_curl_request_manager.h"
+#include "services/common/util/request_cancellation.h"
 #include "src/concurrent/event_engine_executor.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -46,6 +52,28 @@ struct DataToUpload {
 // here for future use if we have to configure a low priority event.
 inline constexpr int kNumEventPriorities = 3;
 
+// Limits of the requests of a fetcher, by priority class.
+struct HttpFetcherLaneOptions {
+  HttpFetcherPriority priority = HttpFetcherPriority::kHigh;
+  // Connections curl may open in total, and to a single host. Further
+  // requests wait for a connection inside curl. Unlimited if 0.
+  int max_connections = 0;
+  int max_host_connections = 0;
+  // Low priority only: requests handed to curl at once, the others wait in
+  // order. Unlimited if 0.
+  int max_pending_requests = 0;
+  // Low priority only: while the high priority fetchers of the process have
+  // more pending requests than this, requests are handed to curl one at a
+  // time. Never throttled if 0.
+  int64_t throttle_above_high_priority_pending = 0;
+  // Requests completed by the same event loop update whose callbacks are run
+  // by a single executor task, so that bursts of completions cost the loop
+  // thread fewer tasks to schedule. The callbacks of a task run one after the
+  // other, so this is meant for light callbacks. One task per request if 1 or
+  // less.
+  int completions_per_task = 1;
+};
+
 // Wrapper for the libevent structure to hold information and state for a
 // libevent dispatch loop.
 class EventBase {
@@ -103,13 +131,19 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   explicit MultiCurlHttpFetcherAsync(server_common::Executor* executor,
                                      int64_t keepalive_interval_sec = 2,
                                      int64_t keepalive_idle_sec = 2);
+  // Same as above, with the limits of the priority class of the requests.
+  MultiCurlHttpFetcherAsync(server_common::Executor* executor,
+                            HttpFetcherLaneOptions lane,
+                            int64_t keepalive_interval_sec = 2,
+                            int64_t keepalive_idle_sec = 2);
 
   // Cleans up all sessions and errors out any pending open HTTP calls.
   // Please note: Any class using this must ensure that the instance is only
   // destructed when they can ensure that the instance will no longer be invoked
   // from any threads.
   ~MultiCurlHttpFetcherAsync() override
-      ABSL_LOCKS_EXCLUDED(in_loop_mu_, curl_handle_set_lock_);
+      ABSL_LOCKS_EXCLUDED(in_loop_mu_, curl_handle_set_lock_,
+                          throttled_requests_mu_);
 
   // Not copyable or movable.
   MultiCurlHttpFetcherAsync(const MultiCurlHttpFetcherAsync&) = delete;
@@ -141,6 +175,18 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
               OnDoneFetchUrl done_callback) override
       ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
 
+  // POSTs data to the specified url.
+  //
+  // http_request: The URL, headers, body for the HTTP POST request.
+  // timeout_ms: The request timeout
+  // done_callback: Output param. Invoked either on error or after finished
+  // receiving a response. Please note that done_callback will run in a
+  // threadpool and is not guaranteed to be the FetchUrl client's thread.
+  // Clients can expect done_callback to be called exactly once.
+  void PostUrl(const HTTPRequest& http_request, int timeout_ms,
+               OnDoneFetchUrl done_callback) override
+      ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
+
   // Fetches provided urls with libcurl.
   //
   // requests: The URL and headers for the HTTP GET requests.
@@ -155,15 +201,34 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
                  absl::Duration timeout, OnDoneFetchUrls done_callback) override
       ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
 
+  // Number of requests that have been handed to curl and have not completed
+  // yet.
+  int64_t NumPendingRequests() const;
+
+  // How much later than scheduled the periodic timer of the event loop fired
+  // last time. Grows when the loop thread is saturated.
+  absl::Duration EventLoopLag() const;
+
+  // Longest time a single event held the event loop thread since the
+  // previous call. The callbacks of the requests run on the executor, so
+  // this is the time spent on I/O, in curl and in the body consumers.
+  absl::Duration TakeEventLoopStall();
+
+  // Observable callback exporting the share of the requests of all fetchers
+  // since the previous call that reused an idle easy handle ("easy_handle")
+  // and an open connection ("connection").
+  static absl::flat_hash_map<std::string, double> GetReuseRatios();
+
  private:
   // This struct maintains the data related to a Curl request, some of which
   // has to stay valid throughout the life of the request. The code maintains a
   // reference in curl_data_map_ till the request is completed. The destructor
   // is then to free the resources in this class after the request completes.
   struct CurlRequestData {
-    // The easy handle provided by libcurl, registered to
-    // multi_curl_request_manager_.
+    // The easy handle taken from handle_pool, registered to
+    // multi_curl_request_manager_, and given back once the request is done.
     CURL* req_handle;
+    std::shared_ptr<CurlEasyHandlePool> handle_pool;
 
     // The pointer to the linked list of the request HTTP headers.
     struct curl_slist* headers_list_ptr = nullptr;
@@ -178,11 +243,51 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
     // The pointer that is used by the req_handle to write the request output.
     std::unique_ptr<std::string> output;
 
-    CurlRequestData(const std::vector<std::string>& headers,
+    // Unique among the requests of the fetcher, unlike the easy handle whose
+    // address may be reused once the request is done.
+    int64_t id = 0;
+
+    // Cancellation of the request the fetch is made for, if any, with the id
+    // of the callback that cancels the fetch.
+    std::shared_ptr<RequestCancellation> cancellation;
+    int64_t cancellation_id = 0;
+
+    // Fed the body of the response as it streams in, if set.
+    std::shared_ptr<HttpBodyConsumer> body_consumer;
+
+    CurlRequestData(std::shared_ptr<CurlEasyHandlePool> pool,
+                    const std::vector<std::string>& headers,
                     OnDoneFetchUrl on_done);
     ~CurlRequestData();
   };
 
+  // A request completed by curl, whose callback is yet to run.
+  struct Completion {
+    CURL* req_handle;
+    absl::Status status;
+    // The CurlRequestData of the request.
+    void* data;
+  };
+
+  // Runs the callback of the completed request, and frees its data.
+  static void RunCompletion(Completion& completion);
+
+  // Hands the completions to the executor, in tasks of
+  // lane_.completions_per_task completions.
+  void DispatchCompletions(std::vector<Completion> completions);
+
+  // Write callback of curl, appending the body of the response to the output
+  // of the CurlRequestData in `request_data` and feeding it to its consumer.
+  static size_t WriteCallback(char* data, size_t size, size_t number_elements,
+                              void* request_data);
+
+  // Arguments of the event that cancels a fetch on the event loop.
+  struct CancelFetchArgs {
+    MultiCurlHttpFetcherAsync* fetcher;
+    CURL* req_handle;
+    int64_t request_id;
+  };
+
   // This method adds the curl handle to a set to keep track of pending handles.
   // Must be called after the handle has been initialized.
   // Only a single thread can execute this function at a time since it requires
@@ -190,10 +295,26 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   void Add(CURL* handle) ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
 
   // This method removes the curl handle if the call has finished or abandoned.
-  // Must be called before the handle has been cleaned up.
+  // Must be called before the handle has been cleaned up. Returns whether the
+  // handle was pending, i.e. whether the caller completes its request.
   // Only a single thread can execute this function at a time since it requires
   // the acquisition of the curl_handle_set_lock_ mutex.
-  void Remove(CURL* handle) ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
+  bool Remove(CURL* handle) ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
+
+  // Registers the callback that cancels the fetch of `request` once its
+  // cancellation is cancelled. Returns false, after calling back with a
+  // CANCELLED error, if it already is.
+  bool RegisterCancellation(CurlRequestData& request);
+
+  // Event callback of the cancellation of a fetch, with CancelFetchArgs. Runs
+  // on the event loop, like the completion of the fetches, so that the two
+  // never race.
+  static void CancelFetch(int fd, short event_type, void* arg);
+
+  // Removes the easy handle of the request with `request_id` from curl and
+  // calls back with a CANCELLED error, unless the request is already done.
+  void CancelPendingRequest(CURL* req_handle, int64_t request_id)
+      ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
 
   // This method executes PerformCurlUpdate on a loop in the executor_. It
   // will schedule itself as a new task to perform curl check again.
@@ -206,7 +327,8 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   // available, it schedules the callback on the executor_.
   // Only a single thread can execute this function at a time since it requires
   // the acquisition of the in_loop_mu_ mutex.
-  void PerformCurlUpdate() ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
+  void PerformCurlUpdate()
+      ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_, throttled_requests_mu_);
 
   // Shuts down the event loop. This is a callback registered with an event
   // that fires every second to see if the event loop should be shutdown.
@@ -220,11 +342,23 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
       const HTTPRequest& request, int timeout_ms, int64_t keepalive_idle_sec,
       int64_t keepalive_interval_sec, OnDoneFetchUrl done_callback);
 
+  // Adds the request to curl multi request manager, or holds it back if the
+  // fetcher is throttled.
+  void ExecuteCurlRequest(std::unique_ptr<CurlRequestData> request)
+      ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_, throttled_requests_mu_);
+
   // Adds the request to curl multi request manager. If the addition fails, the
   // executes the callback else stores the request handle in curl data map.
-  void ExecuteCurlRequest(std::unique_ptr<CurlRequestData> request)
+  void AddCurlRequest(std::unique_ptr<CurlRequestData> request)
       ABSL_LOCKS_EXCLUDED(curl_handle_set_lock_);
 
+  // Returns true if a low priority request may be handed to curl.
+  bool CanAddLowPriorityRequest() const;
+
+  // Hands the held back requests to curl, in order, while the fetcher is not
+  // throttled. Called from the event loop as requests complete.
+  void AddThrottledRequests() ABSL_LOCKS_EXCLUDED(throttled_requests_mu_);
+
   // The executor_ will receive tasks from PerformCurlUpdate. The tasks will
   // schedule future ExecuteLoop calls and schedule executions for
   // client callbacks. The executor is not owned by this class instance but is
@@ -237,6 +371,13 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   // Interval time between keep-alive probes in case of no response.
   int64_t keepalive_interval_sec_;
 
+  const HttpFetcherLaneOptions lane_;
+
+  // Idle easy handles of the fetcher. Shared with the requests, which may be
+  // destroyed on the executor after the fetcher.
+  std::shared_ptr<CurlEasyHandlePool> handle_pool_ =
+      std::make_shared<CurlEasyHandlePool>();
+
   // All events in the loop are associated with this event base. Note: There can
   // be a single event base for a single thread.
   // Documentation: https://libevent.org/libevent-book/Ref2_eventbase.html
@@ -257,10 +398,24 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   absl::Notification shutdown_requested_;
   absl::Notification shutdown_complete_;
 
+  // Time at which the shutdown timer last fired. Only accessed from the event
+  // loop.
+  absl::Time last_loop_tick_;
+
+  // Exported through NumPendingRequests and EventLoopLag.
+  std::atomic<int64_t> num_pending_requests_ = 0;
+  std::atomic<int64_t> next_request_id_ = 0;
+  std::atomic<int64_t> event_loop_lag_us_ = 0;
+
   // A map of curl easy handles to curl data for easy tracking.
   absl::Mutex curl_handle_set_lock_;
   absl::flat_hash_set<CURL*> curl_handle_set_
       ABSL_GUARDED_BY(curl_handle_set_lock_);
+
+  // Low priority requests held back while the fetcher is throttled.
+  absl::Mutex throttled_requests_mu_;
+  std::deque<std::unique_ptr<CurlRequestData>> throttled_requests_
+      ABSL_GUARDED_BY(throttled_requests_mu_);
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
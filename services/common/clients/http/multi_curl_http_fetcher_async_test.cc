@@ -14,6 +14,7 @@
 
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
 
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -66,6 +67,36 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, FetchesUrlSuccessfully) {
   done.Wait();
 }
 
+class BodyRecorder : public HttpBodyConsumer {
+ public:
+  void OnBodyChunk(absl::string_view chunk) override {
+    body_.append(chunk.data(), chunk.size());
+  }
+
+  const std::string& body() const { return body_; }
+
+ private:
+  std::string body_;
+};
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, FeedsBodyConsumerTheWholeBody) {
+  auto recorder = std::make_shared<BodyRecorder>();
+  std::string output;
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done, &output](absl::StatusOr<std::string> result) {
+    if (result.ok()) {
+      output = *std::move(result);
+    }
+    done.DecrementCount();
+  };
+  fetcher_->FetchUrl({.url = kUrlA.begin(), .body_consumer = recorder},
+                     kNormalTimeoutMs, done_cb);
+
+  done.Wait();
+  EXPECT_GT(output.length(), 0);
+  EXPECT_EQ(recorder->body(), output);
+}
+
 TEST_F(MultiCurlHttpFetcherAsyncTest, FetchesUrlWithHeaders) {
   std::string msg;
   absl::BlockingCounter done(1);
@@ -120,6 +151,37 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, HandlesTimeoutByReturningError) {
   done.Wait();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest, DropsFetchOfCancelledRequest) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kCancelled);
+  };
+  auto cancellation = std::make_shared<RequestCancellation>();
+  HTTPRequest request = {kUrlA.begin(), {}};
+  request.cancellation = cancellation;
+  fetcher_->FetchUrl(request, kNormalTimeoutMs, done_cb);
+  cancellation->Cancel();
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, SkipsFetchOfAlreadyCancelledRequest) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kCancelled);
+  };
+  auto cancellation = std::make_shared<RequestCancellation>();
+  cancellation->Cancel();
+  HTTPRequest request = {kUrlA.begin(), {}};
+  request.cancellation = cancellation;
+  fetcher_->FetchUrl(request, kNormalTimeoutMs, done_cb);
+  EXPECT_EQ(fetcher_->NumPendingRequests(), 0);
+  done.Wait();
+}
+
 TEST_F(MultiCurlHttpFetcherAsyncTest, HandlesMalformattedUrlByReturningError) {
   std::string msg;
   absl::BlockingCounter done(1);
@@ -189,6 +251,21 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, PutsUrlSuccessfully) {
   notification.WaitForNotification();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest, PostsUrlSuccessfully) {
+  absl::Notification notification;
+  auto done_cb = [&notification](absl::StatusOr<std::string> result) {
+    EXPECT_TRUE(result.ok()) << result.status();
+    EXPECT_THAT(result.value(), HasSubstr("\"key\": \"value\""));
+    notification.Notify();
+  };
+  fetcher_->PostUrl({"http://httpbin.org/post",
+                     {"Content-Type: application/json"},
+                     R"({"key": "value"})"},
+                    kNormalTimeoutMs, done_cb);
+
+  notification.WaitForNotification();
+}
+
 TEST_F(MultiCurlHttpFetcherAsyncTest, PutsUrlFails) {
   std::string msg;
   absl::Notification notification;
@@ -204,5 +281,55 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, PutsUrlFails) {
   notification.WaitForNotification();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest,
+       LowPriorityFetcherCompletesRequestsHeldBack) {
+  MultiCurlHttpFetcherAsync low_priority_fetcher(
+      executor_.get(),
+      HttpFetcherLaneOptions{.priority = HttpFetcherPriority::kLow,
+                             .max_connections = 1,
+                             .max_pending_requests = 1});
+  absl::BlockingCounter done(1);
+  std::vector<HTTPRequest> test_requests = {
+      {kUrlA.begin(), {}}, {kUrlB.begin(), {}}, {kUrlC.begin(), {}}};
+  auto done_cb = [&done, &test_requests](
+                     const std::vector<absl::StatusOr<std::string>>& results) {
+    EXPECT_EQ(results.size(), test_requests.size());
+    for (const auto& result : results) {
+      ASSERT_TRUE(result.ok()) << result.status();
+    }
+    done.DecrementCount();
+  };
+
+  low_priority_fetcher.FetchUrls(test_requests,
+                                 absl::Milliseconds(kNormalTimeoutMs),
+                                 std::move(done_cb));
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, RunsCompletionsInBatches) {
+  MultiCurlHttpFetcherAsync batching_fetcher(
+      executor_.get(), HttpFetcherLaneOptions{.completions_per_task = 4});
+  absl::BlockingCounter done(1);
+  std::vector<HTTPRequest> test_requests = {
+      {kUrlA.begin(), {}}, {kUrlB.begin(), {}}, {kUrlC.begin(), {}}};
+  auto done_cb = [&done, &test_requests](
+                     const std::vector<absl::StatusOr<std::string>>& results) {
+    EXPECT_EQ(results.size(), test_requests.size());
+    for (const auto& result : results) {
+      ASSERT_TRUE(result.ok()) << result.status();
+    }
+    done.DecrementCount();
+  };
+
+  batching_fetcher.FetchUrls(test_requests,
+                             absl::Milliseconds(kNormalTimeoutMs),
+                             std::move(done_cb));
+  done.Wait();
+  EXPECT_GE(batching_fetcher.TakeEventLoopStall(), absl::ZeroDuration());
+}
+
+  done.Wait();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -23,6 +23,7 @@
 #include <event2/util.h>
 
 #include "absl/log/check.h"
+#include "absl/time/clock.h"
 #include "src/logger/request_context_logger.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -58,12 +59,27 @@ void MultiCurlRequestManager::OnLibeventSocketActivity(int fd, short kind,
                ((kind & EV_WRITE) ? CURL_CSELECT_OUT : 0);
 
   auto* self = reinterpret_cast<MultiCurlRequestManager*>(data);
+  self->HandleEvent(fd, action);
+}
+
+void MultiCurlRequestManager::HandleEvent(curl_socket_t fd, int action) {
+  const absl::Time start = absl::Now();
   {
-    absl::MutexLock l(&self->request_manager_mu_);
-    curl_multi_socket_action(self->request_manager_, fd, action,
-                             &self->running_handles_);
+    absl::MutexLock l(&request_manager_mu_);
+    curl_multi_socket_action(request_manager_, fd, action, &running_handles_);
+  }
+  update_easy_handles_callback_();
+  const int64_t duration_us = absl::ToInt64Microseconds(absl::Now() - start);
+  int64_t max_us = max_event_duration_us_.load(std::memory_order_relaxed);
+  while (duration_us > max_us &&
+         !max_event_duration_us_.compare_exchange_weak(
+             max_us, duration_us, std::memory_order_relaxed)) {
   }
-  self->update_easy_handles_callback_();
+}
+
+absl::Duration MultiCurlRequestManager::TakeMaxEventDuration() {
+  return absl::Microseconds(
+      max_event_duration_us_.exchange(0, std::memory_order_relaxed));
 }
 
 void MultiCurlRequestManager::UpsertSocketInLibevent(curl_socket_t sock_fd,
@@ -143,6 +159,8 @@ MultiCurlRequestManager::MultiCurlRequestManager(struct event_base* event_base)
   curl_multi_setopt(request_manager_, CURLMOPT_SOCKETDATA, this);
   curl_multi_setopt(request_manager_, CURLMOPT_SOCKETFUNCTION,
                     OnLibcurlSocketUpdate);
+  // Multiplex concurrent requests to the same host over HTTP/2 connections.
+  curl_multi_setopt(request_manager_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
 }
 
 MultiCurlRequestManager::~MultiCurlRequestManager() {
@@ -156,13 +174,7 @@ void MultiCurlRequestManager::MultiTimerCallback(int fd, short what,
                                                  void* arg) {
   PS_VLOG(9) << "Multi timeout event callback called";
   auto* self = reinterpret_cast<MultiCurlRequestManager*>(arg);
-  {
-    absl::MutexLock l(&self->request_manager_mu_);
-    curl_multi_socket_action(self->request_manager_, CURL_SOCKET_TIMEOUT, 0,
-                             &self->running_handles_);
-  }
-  PS_VLOG(9) << "Updating easy handles callback to be called";
-  self->update_easy_handles_callback_();
+  self->HandleEvent(CURL_SOCKET_TIMEOUT, 0);
 }
 
 void MultiCurlRequestManager::Configure(
@@ -195,4 +207,14 @@ CURLMcode MultiCurlRequestManager::Remove(CURL* curl_handle)
   return curl_multi_remove_handle(request_manager_, curl_handle);
 }
 
+void MultiCurlRequestManager::SetConnectionLimits(int max_connections,
+                                                  int max_host_connections)
+    ABSL_LOCKS_EXCLUDED(request_manager_mu_) {
+  absl::MutexLock l(&request_manager_mu_);
+  curl_multi_setopt(request_manager_, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                    static_cast<long>(max_connections));
+  curl_multi_setopt(request_manager_, CURLMOPT_MAX_HOST_CONNECTIONS,
+                    static_cast<long>(max_host_connections));
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
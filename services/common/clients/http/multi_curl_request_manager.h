@@ -18,8 +18,12 @@
 #include <event2/event.h>
 #include <event2/event_struct.h>
 
+#include <atomic>
+#include <cstdint>
+
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "curl/multi.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -80,6 +84,16 @@ class MultiCurlRequestManager final {
   // curl_multi_remove_handle.
   CURLMcode Remove(CURL* curl_handle) ABSL_LOCKS_EXCLUDED(request_manager_mu_);
 
+  // Limits the connections the multi session opens in total and to a single
+  // host. Transfers over the limits wait in curl for a connection. Unlimited
+  // if 0.
+  void SetConnectionLimits(int max_connections, int max_host_connections)
+      ABSL_LOCKS_EXCLUDED(request_manager_mu_);
+
+  // Returns the longest time a single socket or timer event held the event
+  // loop thread, in curl and in the update callback, since the previous call.
+  absl::Duration TakeMaxEventDuration();
+
   // MultiCurlRequestManager is neither copyable nor movable.
   MultiCurlRequestManager(const MultiCurlRequestManager&) = delete;
   MultiCurlRequestManager& operator=(const MultiCurlRequestManager&) = delete;
@@ -98,6 +112,10 @@ class MultiCurlRequestManager final {
   CURLM* request_manager_;
   absl::AnyInvocable<void()> update_easy_handles_callback_;
   struct event_base* event_base_ = nullptr;
+  // Handles the socket or timer event for which curl_multi_socket_action
+  // was called with `fd` and `action`, and records how long it took.
+  void HandleEvent(curl_socket_t fd, int action);
+  std::atomic<int64_t> max_event_duration_us_ = 0;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,206 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http/sharded_http_fetcher_async.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr absl::string_view kSchemeSeparator = "://";
+inline constexpr char kShardLabelPrefix[] = "shard_";
+
+// Live instances, for the observable metric callbacks.
+struct Registry {
+  absl::Mutex mu;
+  absl::flat_hash_set<const ShardedHttpFetcherAsync*> fetchers
+      ABSL_GUARDED_BY(mu);
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+// Results of a FetchUrls call, shared by the callbacks of its fetches.
+struct FetchUrlsState {
+  absl::Mutex mu;
+  std::vector<absl::StatusOr<std::string>> results ABSL_GUARDED_BY(mu);
+  int pending ABSL_GUARDED_BY(mu);
+  OnDoneFetchUrls done_callback;
+};
+
+}  // namespace
+
+absl::string_view GetUrlHost(absl::string_view url) {
+  if (size_t scheme_end = url.find(kSchemeSeparator);
+      scheme_end != absl::string_view::npos) {
+    url.remove_prefix(scheme_end + kSchemeSeparator.size());
+  }
+  url = url.substr(0, url.find_first_of("/?#"));
+  if (size_t at = url.rfind('@'); at != absl::string_view::npos) {
+    url.remove_prefix(at + 1);
+  }
+  // Bracketed IPv6 literals contain ':' themselves.
+  if (!url.empty() && url.front() == '[') {
+    return url.substr(0, url.find(']') + 1);
+  }
+  return url.substr(0, url.find(':'));
+}
+
+ShardedHttpFetcherAsync::ShardedHttpFetcherAsync(
+    server_common::Executor* executor, int num_shards,
+    int64_t keepalive_interval_sec, int64_t keepalive_idle_sec) {
+  if (num_shards <= 0) {
+    num_shards = std::max(1u, std::thread::hardware_concurrency());
+  }
+  shards_.reserve(num_shards);
+  for (int i = 0; i < num_shards; ++i) {
+    shards_.push_back(std::make_unique<MultiCurlHttpFetcherAsync>(
+        executor, keepalive_interval_sec, keepalive_idle_sec));
+  }
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mu);
+  registry.fetchers.insert(this);
+}
+
+ShardedHttpFetcherAsync::~ShardedHttpFetcherAsync() {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mu);
+  registry.fetchers.erase(this);
+}
+
+int ShardedHttpFetcherAsync::NextShardIndex() {
+  const int num_shards = shards_.size();
+  const int first =
+      next_shard_.fetch_add(1, std::memory_order_relaxed) % num_shards;
+  int index = first;
+  int64_t min_pending = shards_[first]->NumPendingRequests();
+  for (int i = 1; i < num_shards && min_pending > 0; ++i) {
+    const int shard = (first + i) % num_shards;
+    if (int64_t pending = shards_[shard]->NumPendingRequests();
+        pending < min_pending) {
+      index = shard;
+      min_pending = pending;
+    }
+  }
+  return index;
+}
+
+MultiCurlHttpFetcherAsync& ShardedHttpFetcherAsync::NextShard() {
+  return *shards_[NextShardIndex()];
+}
+
+void ShardedHttpFetcherAsync::FetchUrl(const HTTPRequest& request,
+                                       int timeout_ms,
+                                       OnDoneFetchUrl done_callback) {
+  NextShard().FetchUrl(request, timeout_ms, std::move(done_callback));
+}
+
+void ShardedHttpFetcherAsync::PutUrl(const HTTPRequest& http_request,
+                                     int timeout_ms,
+                                     OnDoneFetchUrl done_callback) {
+  NextShard().PutUrl(http_request, timeout_ms, std::move(done_callback));
+}
+
+void ShardedHttpFetcherAsync::PostUrl(const HTTPRequest& http_request,
+                                      int timeout_ms,
+                                      OnDoneFetchUrl done_callback) {
+  NextShard().PostUrl(http_request, timeout_ms, std::move(done_callback));
+}
+
+void ShardedHttpFetcherAsync::FetchUrls(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrls done_callback) {
+  if (requests.empty()) {
+    std::move(done_callback)({});
+    return;
+  }
+  auto state = std::make_shared<FetchUrlsState>();
+  {
+    absl::MutexLock lock(&state->mu);
+    state->results.resize(requests.size());
+    state->pending = requests.size();
+  }
+  state->done_callback = std::move(done_callback);
+  const int timeout_ms = absl::ToInt64Milliseconds(timeout);
+  for (int i = 0; i < requests.size(); ++i) {
+    FetchUrl(requests[i], timeout_ms,
+             [i, state](absl::StatusOr<std::string> result) {
+               std::vector<absl::StatusOr<std::string>> results;
+               {
+                 absl::MutexLock lock(&state->mu);
+                 state->results[i] = std::move(result);
+                 if (--state->pending > 0) {
+                   return;
+                 }
+                 results = std::move(state->results);
+               }
+               std::move(state->done_callback)(std::move(results));
+             });
+  }
+}
+
+absl::flat_hash_map<std::string, double>
+ShardedHttpFetcherAsync::GetQueueDepthByShard() {
+  absl::flat_hash_map<std::string, double> queue_depth;
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mu);
+  for (const auto* fetcher : registry.fetchers) {
+    for (int i = 0; i < fetcher->shards_.size(); ++i) {
+      queue_depth[absl::StrCat(kShardLabelPrefix, i)] +=
+          fetcher->shards_[i]->NumPendingRequests();
+    }
+  }
+  return queue_depth;
+}
+
+absl::flat_hash_map<std::string, double>
+ShardedHttpFetcherAsync::GetLoopLagMsByShard() {
+  absl::flat_hash_map<std::string, double> loop_lag;
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mu);
+  for (const auto* fetcher : registry.fetchers) {
+    for (int i = 0; i < fetcher->shards_.size(); ++i) {
+      double& lag = loop_lag[absl::StrCat(kShardLabelPrefix, i)];
+      lag = std::max(lag, absl::ToDoubleMilliseconds(
+                              fetcher->shards_[i]->EventLoopLag()));
+    }
+  }
+  return loop_lag;
+}
+
+absl::flat_hash_map<std::string, double>
+ShardedHttpFetcherAsync::GetLoopStallMsByShard() {
+  absl::flat_hash_map<std::string, double> loop_stall;
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mu);
+  for (const auto* fetcher : registry.fetchers) {
+    for (int i = 0; i < fetcher->shards_.size(); ++i) {
+      double& stall = loop_stall[absl::StrCat(kShardLabelPrefix, i)];
+      stall = std::max(stall, absl::ToDoubleMilliseconds(
+                                  fetcher->shards_[i]->TakeEventLoopStall()));
+    }
+  }
+  return loop_stall;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
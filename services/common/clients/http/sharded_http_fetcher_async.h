@@ -0,0 +1,108 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_SHARDED_HTTP_FETCHER_ASYNC_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_SHARDED_HTTP_FETCHER_ASYNC_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Returns the host (without port and credentials) of the provided URL. The
+// scheme is optional, e.g. "https://a.com:443/b" and "a.com/b" both return
+// "a.com".
+absl::string_view GetUrlHost(absl::string_view url);
+
+// ShardedHttpFetcherAsync spreads HTTP calls over several independent
+// MultiCurlHttpFetcherAsync shards, each with its own curl multi handle,
+// libevent loop and locks. Every request goes to the shard with the fewest
+// pending requests, starting the search from the next shard in round-robin
+// order, so that requests to a single host (e.g. the buyer KV server) are
+// spread over all the shards. Each shard reuses its own connections to the
+// host.
+//
+// Each shard occupies an executor thread for its event loop for the lifetime
+// of the instance.
+class ShardedHttpFetcherAsync final : public HttpFetcherAsync {
+ public:
+  // Creates num_shards shards. If num_shards is not positive, one shard per
+  // hardware thread is created.
+  explicit ShardedHttpFetcherAsync(server_common::Executor* executor,
+                                   int num_shards,
+                                   int64_t keepalive_interval_sec = 2,
+                                   int64_t keepalive_idle_sec = 2);
+
+  ~ShardedHttpFetcherAsync() override;
+
+  // Not copyable or movable.
+  ShardedHttpFetcherAsync(const ShardedHttpFetcherAsync&) = delete;
+  ShardedHttpFetcherAsync& operator=(const ShardedHttpFetcherAsync&) = delete;
+
+  // Fetches the url on the least loaded shard.
+  void FetchUrl(const HTTPRequest& request, int timeout_ms,
+                OnDoneFetchUrl done_callback) override;
+
+  // PUTs data to the url on the least loaded shard.
+  void PutUrl(const HTTPRequest& http_request, int timeout_ms,
+              OnDoneFetchUrl done_callback) override;
+
+  // POSTs data to the url on the least loaded shard.
+  void PostUrl(const HTTPRequest& http_request, int timeout_ms,
+               OnDoneFetchUrl done_callback) override;
+
+  // Fetches each url on the least loaded shard. done_callback is invoked once
+  // all the fetches complete, with results in the order of requests.
+  void FetchUrls(const std::vector<HTTPRequest>& requests,
+                 absl::Duration timeout,
+                 OnDoneFetchUrls done_callback) override;
+
+  // Returns the index of the shard to serve the next request: the shard with
+  // the fewest pending requests, ties going to the next one in round-robin
+  // order.
+  int NextShardIndex();
+
+  int NumShards() const { return shards_.size(); }
+
+  // Observable callbacks exporting the number of pending requests and the
+  // event loop lag (in milliseconds) of every shard of all live instances,
+  // keyed by shard label.
+  static absl::flat_hash_map<std::string, double> GetQueueDepthByShard();
+  static absl::flat_hash_map<std::string, double> GetLoopLagMsByShard();
+  // Exports the longest time an event held the loop thread of every shard
+  // since the previous export, in milliseconds.
+  static absl::flat_hash_map<std::string, double> GetLoopStallMsByShard();
+
+ private:
+  MultiCurlHttpFetcherAsync& NextShard();
+
+  std::vector<std::unique_ptr<MultiCurlHttpFetcherAsync>> shards_;
+  // Shard the search of the next shard starts from.
+  std::atomic<uint32_t> next_shard_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_SHARDED_HTTP_FETCHER_ASYNC_H_
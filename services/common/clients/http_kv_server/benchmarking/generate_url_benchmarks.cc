@@ -0,0 +1,187 @@
+//   Copyright 2024 Google LLC
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+// Compares building the KV lookup URL of a request with many render URL keys
+// with the table-driven percent-encoding, with the previous curl_easy_escape
+// based one, and with a cache of the encoded keys. Also compares collecting
+// the bidding signals keys of the interest groups of a request into a
+// UrlKeysSet and into UrlKeys.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "benchmark/benchmark.h"
+#include "services/common/clients/http_kv_server/util/generate_url.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kHost[] = "https://kv.seller.com/v1/getvalues";
+constexpr char kBuyerHost[] = "https://kv.buyer.com/v1/getvalues";
+
+// Returns render URLs like the ones of the ads of an auction.
+std::vector<std::string> MakeRenderUrls(int num_keys) {
+  std::vector<std::string> render_urls;
+  render_urls.reserve(num_keys);
+  for (int i = 0; i < num_keys; ++i) {
+    render_urls.push_back(absl::StrCat(
+        "https://ads.adtech.com/creatives/ad.html?campaign=spring-sale&id=", i,
+        "&size=300x250"));
+  }
+  return render_urls;
+}
+
+// Returns the bidding signals keys of each of `num_igs` interest groups. Each
+// interest group shares half of its keys with the next one, like groups
+// joined on the same sites do.
+std::vector<std::vector<std::string>> MakeInterestGroupKeys(int num_igs,
+                                                            int keys_per_ig) {
+  std::vector<std::vector<std::string>> ig_keys(num_igs);
+  for (int ig = 0; ig < num_igs; ++ig) {
+    ig_keys[ig].reserve(keys_per_ig);
+    for (int i = 0; i < keys_per_ig; ++i) {
+      // Scrambles the ids, since keys are not inserted in order.
+      const uint64_t id = (ig * keys_per_ig / 2 + i) * 0x9E3779B97F4A7C15;
+      ig_keys[ig].push_back(absl::StrCat("campaign-", id >> 32));
+    }
+  }
+  return ig_keys;
+}
+
+// The previous encoding, through curl_easy_escape and absl::StrJoin.
+void AddListItemsWithCurlEscape(std::string* url, absl::string_view key,
+                                const UrlKeysSet& values) {
+  AddAmpersandIfNotFirstQueryParam(url);
+  absl::StrAppend(url, key, "=");
+  std::vector<std::string> encoded_values;
+  encoded_values.reserve(values.size());
+  for (absl::string_view value : values) {
+    char* encoded = curl_easy_escape(nullptr, value.data(), value.size());
+    encoded_values.emplace_back(encoded);
+    curl_free(encoded);
+  }
+  absl::StrAppend(url, absl::StrJoin(encoded_values, ","));
+}
+
+static void BM_AddListItems_CurlEscape(benchmark::State& state) {
+  const std::vector<std::string> render_urls = MakeRenderUrls(state.range(0));
+  const UrlKeysSet keys(render_urls.begin(), render_urls.end());
+  for (auto _ : state) {
+    std::string url;
+    ClearAndMakeStartOfUrl(kHost, &url);
+    AddListItemsWithCurlEscape(&url, "renderUrls", keys);
+    benchmark::DoNotOptimize(url);
+  }
+}
+BENCHMARK(BM_AddListItems_CurlEscape)->Arg(100)->Arg(1000);
+
+static void BM_AddListItems(benchmark::State& state) {
+  const std::vector<std::string> render_urls = MakeRenderUrls(state.range(0));
+  const UrlKeysSet keys(render_urls.begin(), render_urls.end());
+  for (auto _ : state) {
+    std::string url;
+    ClearAndMakeStartOfUrl(kHost, &url);
+    AddListItemsAsQueryParamsToUrl(&url, "renderUrls", keys,
+                                   /*encode_params=*/true);
+    benchmark::DoNotOptimize(url);
+  }
+}
+BENCHMARK(BM_AddListItems)->Arg(100)->Arg(1000);
+
+// Looks up every key in a warm cache of encoded keys instead of encoding it.
+static void BM_AddListItems_EncodedKeyCache(benchmark::State& state) {
+  const std::vector<std::string> render_urls = MakeRenderUrls(state.range(0));
+  const UrlKeysSet keys(render_urls.begin(), render_urls.end());
+  absl::flat_hash_map<std::string, std::string> encoded_keys;
+  for (absl::string_view key : keys) {
+    AppendEncodedQueryParam(key, &encoded_keys[key]);
+  }
+  for (auto _ : state) {
+    std::string url;
+    url.reserve(sizeof(kHost) +
+                ListItemsQueryParamsLength("renderUrls", keys,
+                                           /*encode_params=*/true));
+    ClearAndMakeStartOfUrl(kHost, &url);
+    url.append("renderUrls=");
+    bool first = true;
+    for (absl::string_view key : keys) {
+      if (!first) {
+        url.push_back(',');
+      }
+      first = false;
+      url.append(encoded_keys.find(key)->second);
+    }
+    benchmark::DoNotOptimize(url);
+  }
+}
+BENCHMARK(BM_AddListItems_EncodedKeyCache)->Arg(100)->Arg(1000);
+
+// Collects the keys of the interest groups like the buyer KV lookup did, and
+// builds the keys param of its URL.
+static void BM_CollectKeys_UrlKeysSet(benchmark::State& state) {
+  const std::vector<std::vector<std::string>> ig_keys =
+      MakeInterestGroupKeys(state.range(0), state.range(1));
+  for (auto _ : state) {
+    UrlKeysSet keys;
+    for (const std::vector<std::string>& ig : ig_keys) {
+      keys.insert(ig.begin(), ig.end());
+    }
+    std::string url;
+    url.reserve(sizeof(kBuyerHost) +
+                ListItemsQueryParamsLength("keys", keys,
+                                           /*encode_params=*/true));
+    ClearAndMakeStartOfUrl(kBuyerHost, &url);
+    AddListItemsAsQueryParamsToUrl(&url, "keys", keys,
+                                   /*encode_params=*/true);
+    benchmark::DoNotOptimize(url);
+  }
+}
+BENCHMARK(BM_CollectKeys_UrlKeysSet)
+    ->Args({50, 10})
+    ->Args({200, 20})
+    ->Args({500, 40});
+
+static void BM_CollectKeys_UrlKeys(benchmark::State& state) {
+  const std::vector<std::vector<std::string>> ig_keys =
+      MakeInterestGroupKeys(state.range(0), state.range(1));
+  for (auto _ : state) {
+    UrlKeys keys;
+    keys.Reserve(state.range(0) * state.range(1));
+    for (const std::vector<std::string>& ig : ig_keys) {
+      keys.Insert(ig.begin(), ig.end());
+    }
+    keys.Finalize();
+    std::string url;
+    url.reserve(sizeof(kBuyerHost) +
+                ListItemsQueryParamsLength("keys", keys,
+                                           /*encode_params=*/true));
+    ClearAndMakeStartOfUrl(kBuyerHost, &url);
+    AddListItemsAsQueryParamsToUrl(&url, "keys", keys,
+                                   /*encode_params=*/true);
+    benchmark::DoNotOptimize(url);
+  }
+}
+BENCHMARK(BM_CollectKeys_UrlKeys)
+    ->Args({50, 10})
+    ->Args({200, 20})
+    ->Args({500, 40});
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -24,6 +24,9 @@ namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 constexpr auto kEnableEncodeParams = true;
+// Upper bound of the characters the params other than the keys take on top of
+// their values.
+constexpr int kMaxShortParamsOverhead = 64;
 
 }  // namespace
 
@@ -31,6 +34,17 @@ HTTPRequest BuyerKeyValueAsyncHttpClient::BuildBuyerKeyValueRequest(
     absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
     std::unique_ptr<GetBuyerValuesInput> client_input) {
   HTTPRequest request;
+  // Reserves the url once for all of its params, with room to spare for the
+  // names and separators of the short ones.
+  request.url.reserve(
+      kv_server_host_domain.size() + client_input->hostname.size() +
+      client_input->buyer_kv_experiment_group_id.size() +
+      kMaxShortParamsOverhead +
+      ListItemsQueryParamsLength("keys", client_input->keys,
+                                 kEnableEncodeParams) +
+      ListItemsQueryParamsLength("interestGroupNames",
+                                 client_input->interest_group_names,
+                                 kEnableEncodeParams));
   ClearAndMakeStartOfUrl(kv_server_host_domain, &request.url);
 
   // In the future, we will expose the client type param for
@@ -61,6 +75,7 @@ HTTPRequest BuyerKeyValueAsyncHttpClient::BuildBuyerKeyValueRequest(
   }
 
   request.headers = RequestMetadataToHttpHeaders(metadata, kMandatoryHeaders);
+  request.cancellation = std::move(client_input->cancellation);
 
   return request;
 }
@@ -71,7 +86,7 @@ absl::Status BuyerKeyValueAsyncHttpClient::Execute(
         void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
         on_done,
     absl::Duration timeout) const {
-  HTTPRequest request = BuildBuyerKeyValueRequest(kv_server_base_address_,
+  HTTPRequest request = BuildBuyerKeyValueRequest(endpoints_->addresses()[0],
                                                   metadata, std::move(keys));
 
   size_t request_size = 0;
@@ -80,7 +95,8 @@ absl::Status BuyerKeyValueAsyncHttpClient::Execute(
   }
   request_size += request.url.size();
   auto done_callback = [on_done = std::move(on_done), request_size](
-                           absl::StatusOr<std::string> resultStr) mutable {
+                           absl::StatusOr<std::string> resultStr,
+                           int /*attempt*/) mutable {
     if (resultStr.ok()) {
       PS_VLOG(kKVLog) << "BuyerKeyValueAsyncHttpClient Success Response:\n"
                       << resultStr.value();
@@ -99,35 +115,36 @@ absl::Status BuyerKeyValueAsyncHttpClient::Execute(
   for (const auto& header : request.headers) {
     PS_VLOG(kKVLog) << header;
   }
-  http_fetcher_async_->FetchUrl(
-      request, static_cast<int>(absl::ToInt64Milliseconds(timeout)),
+  endpoints_->Fetch(
+      std::move(request), timeout,
+      [fetcher = http_fetcher_async_.get()](const HTTPRequest& request,
+                                            absl::Duration timeout,
+                                            OnDoneFetchUrl done_callback) {
+        fetcher->FetchUrl(
+            request, static_cast<int>(absl::ToInt64Milliseconds(timeout)),
+            std::move(done_callback));
+      },
       std::move(done_callback));
   return absl::OkStatus();
 }
 
 BuyerKeyValueAsyncHttpClient::BuyerKeyValueAsyncHttpClient(
     absl::string_view kv_server_base_address,
-    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm)
-    : http_fetcher_async_(std::move(http_fetcher_async)),
-      kv_server_base_address_(kv_server_base_address) {
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm,
+    const ConnectionWarmingOptions& warming_options,
+    KvEndpointOptions endpoint_options)
+    : endpoints_(std::make_unique<KvEndpointPool>(kv_server_base_address,
+                                                  std::move(endpoint_options))),
+      http_fetcher_async_(std::move(http_fetcher_async)) {
   if (pre_warm) {
-    auto request = std::make_unique<GetBuyerValuesInput>();
-    auto status =
-        Execute(
-            std::move(request), {},
-            [](absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>
-                   buyer_kv_output) mutable {
-              if (!buyer_kv_output.ok()) {
-                PS_LOG(ERROR)
-                    << "BuyerKeyValueAsyncHttpClient pre-warm returned status:"
-                    << buyer_kv_output.status().message();
-              }
-            },
-            // Longer timeout for first request
-            absl::Milliseconds(60000));
-    if (!status.ok()) {
-      PS_LOG(ERROR) << "BuyerKeyValueAsyncHttpClient pre-warming failed: "
-                    << status;
+    // Each endpoint gets its own pool of warm connections.
+    for (const std::string& address : endpoints_->addresses()) {
+      connection_warmers_.push_back(std::make_unique<ConnectionWarmer>(
+          http_fetcher_async_.get(),
+          BuildBuyerKeyValueRequest(address, {},
+                                    std::make_unique<GetBuyerValuesInput>()),
+          warming_options));
+      connection_warmers_.back()->Start();
     }
   }
 }
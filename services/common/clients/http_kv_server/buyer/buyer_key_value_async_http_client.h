@@ -26,8 +26,11 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/client_params.h"
+#include "services/common/clients/http/connection_warmer.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 #include "services/common/clients/http_kv_server/util/generate_url.h"
+#include "services/common/clients/http_kv_server/util/kv_endpoint_pool.h"
+#include "services/common/util/request_cancellation.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -37,7 +40,7 @@ inline constexpr std::array<absl::string_view, 1> kMandatoryHeaders{
 // The data used to build the Buyer KV look url suffix
 struct GetBuyerValuesInput {
   // [DSP] List of keys to query values for, under the namespace keys.
-  UrlKeysSet keys;
+  UrlKeys keys;
 
   // [DSP] List of interest group names for which to query values.
   UrlKeysSet interest_group_names;
@@ -52,6 +55,9 @@ struct GetBuyerValuesInput {
   // [DSP] Optional ID for experiments conducted by buyer. By spec, valid values
   // are [0, 65535].
   std::string buyer_kv_experiment_group_id;
+
+  // Cancellation of the request the values are looked up for, if any.
+  std::shared_ptr<RequestCancellation> cancellation;
 };
 
 // Response from Buyer Key Value server.
@@ -77,11 +83,16 @@ class BuyerKeyValueAsyncHttpClient
   // This class uses the http client to fetch KV values in real time.
   // If pre_warm is true, it will send an empty request to the
   // KV client to establish connection and cache connection data with the
-  // underlying HTTP server. It's false by default.
+  // underlying HTTP server. It's false by default. warming_options control
+  // how many connections are pre-warmed and whether they are re-warmed
+  // periodically. kv_server_base_address may list replicas separated by
+  // commas, which the requests are spread across as endpoint_options set.
   explicit BuyerKeyValueAsyncHttpClient(
       absl::string_view kv_server_base_address,
       std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
-      bool pre_warm = false);
+      bool pre_warm = false,
+      const ConnectionWarmingOptions& warming_options = {},
+      KvEndpointOptions endpoint_options = {});
 
   // Executes the http request to a Key-Value Server asynchronously.
   //
@@ -97,8 +108,11 @@ class BuyerKeyValueAsyncHttpClient
       absl::Duration timeout) const override;
 
  private:
+  // Declared first, so that it outlives the fetches in flight.
+  std::unique_ptr<KvEndpointPool> endpoints_;
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
-  const std::string kv_server_base_address_;
+  // Declared last, so that they stop before the fetcher is destroyed.
+  std::vector<std::unique_ptr<ConnectionWarmer>> connection_warmers_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -501,6 +501,55 @@ TEST_F(KeyValueAsyncHttpClientTest, PrewarmsHTTPClient) {
   absl::SleepFor(absl::Milliseconds(500));
 }
 
+TEST_F(KeyValueAsyncHttpClientTest, PrewarmsEachReplica) {
+  absl::flat_hash_set<std::string> warmed_urls;
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrl)
+      .Times(2)
+      .WillRepeatedly([&warmed_urls](const HTTPRequest& request, int,
+                                     OnDoneFetchUrl done_callback) {
+        warmed_urls.insert(request.url);
+        std::move(done_callback)("");
+      });
+  BuyerKeyValueAsyncHttpClient kvHttpClient(
+      "https://kv-a,https://kv-b", std::move(mock_http_fetcher_async_), true);
+  absl::SleepFor(absl::Milliseconds(500));
+  EXPECT_EQ(warmed_urls, (absl::flat_hash_set<std::string>{"https://kv-a?",
+                                                           "https://kv-b?"}));
+}
+
+TEST_F(KeyValueAsyncHttpClientTest, FailsOverToAnotherReplica) {
+  std::vector<std::string> urls;
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrl)
+      .Times(2)
+      .WillRepeatedly(
+          [&urls](const HTTPRequest& request, int,
+                  OnDoneFetchUrl done_callback) {
+            urls.push_back(request.url);
+            std::move(done_callback)(
+                urls.size() == 1
+                    ? absl::StatusOr<std::string>(absl::UnavailableError(""))
+                    : absl::StatusOr<std::string>("{}"));
+          });
+  BuyerKeyValueAsyncHttpClient kvHttpClient(
+      "https://kv-a,https://kv-b", std::move(mock_http_fetcher_async_));
+  auto input = std::make_unique<GetBuyerValuesInput>(
+      GetBuyerValuesInput{.keys = {"key"}});
+  absl::Notification done;
+  CHECK_OK(kvHttpClient.Execute(
+      std::move(input), {},
+      [&done](absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) {
+        ASSERT_TRUE(output.ok()) << output.status();
+        EXPECT_EQ((*output)->result, "{}");
+        done.Notify();
+      },
+      absl::Milliseconds(5000)));
+  done.WaitForNotification();
+  ASSERT_EQ(urls.size(), 2);
+  EXPECT_EQ(absl::flat_hash_set<std::string>(urls.begin(), urls.end()),
+            (absl::flat_hash_set<std::string>{"https://kv-a?keys=key",
+                                              "https://kv-b?keys=key"}));
+}
+
 TEST_F(KeyValueAsyncHttpClientTest, SpacesInKeysGetEncoded) {
   // Our client will be given this input object.
   const GetBuyerValuesInput getValuesClientInput = {
@@ -0,0 +1,195 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/buyer/coalescing_buyer_key_value_async_client.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr char kHit[] = "hit";
+inline constexpr char kMiss[] = "miss";
+inline constexpr char kCoalesced[] = "coalesced";
+
+// Lookup outcomes of all instances since the last GetLookupRatios call.
+std::atomic<int64_t> num_hits = 0;
+std::atomic<int64_t> num_misses = 0;
+std::atomic<int64_t> num_coalesced = 0;
+
+// Appends the length before the value, so that distinct inputs can't produce
+// the same key.
+void AppendKeyPart(absl::string_view value, std::string& key) {
+  absl::StrAppend(&key, value.size(), ":", value);
+}
+
+std::string GetLookupKey(const GetBuyerValuesInput& input) {
+  std::string key;
+  AppendKeyPart(input.hostname, key);
+  AppendKeyPart(absl::StrCat(input.client_type), key);
+  AppendKeyPart(input.buyer_kv_experiment_group_id, key);
+  absl::StrAppend(&key, input.keys.size(), "#");
+  for (absl::string_view k : input.keys) {
+    AppendKeyPart(k, key);
+  }
+  absl::StrAppend(&key, input.interest_group_names.size(), "#");
+  for (absl::string_view name : input.interest_group_names) {
+    AppendKeyPart(name, key);
+  }
+  return key;
+}
+
+}  // namespace
+
+CoalescingBuyerKeyValueAsyncClient::CoalescingBuyerKeyValueAsyncClient(
+    std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput>>
+        client,
+    const KvCoalescingOptions& options)
+    : client_(std::move(client)),
+      options_{.cache_ttl = options.cache_ttl,
+               .cache_max_bytes = options.cache_max_bytes,
+               .num_shards = std::max(1, options.num_shards)},
+      max_bytes_per_shard_(options_.cache_max_bytes / options_.num_shards),
+      shards_(std::make_unique<Shard[]>(options_.num_shards)) {}
+
+CoalescingBuyerKeyValueAsyncClient::Shard&
+CoalescingBuyerKeyValueAsyncClient::GetShard(const std::string& key) const {
+  return shards_[absl::HashOf(key) % options_.num_shards];
+}
+
+absl::Status CoalescingBuyerKeyValueAsyncClient::Execute(
+    std::unique_ptr<GetBuyerValuesInput> keys, const RequestMetadata& metadata,
+    OnDone on_done, absl::Duration timeout) const {
+  std::string key = GetLookupKey(*keys);
+  Shard& shard = GetShard(key);
+  std::shared_ptr<const GetBuyerValuesOutput> cached_output;
+  {
+    absl::MutexLock lock(&shard.mu);
+    if (auto it = shard.cache.find(key); it != shard.cache.end()) {
+      if (it->second.expiry > absl::Now()) {
+        cached_output = it->second.output;
+      } else {
+        shard.cache_bytes -= it->second.bytes;
+        shard.cache.erase(it);
+      }
+    }
+    if (cached_output == nullptr) {
+      auto [it, inserted] = shard.in_flight.try_emplace(key);
+      it->second.push_back(std::move(on_done));
+      if (!inserted) {
+        num_coalesced.fetch_add(1, std::memory_order_relaxed);
+        return absl::OkStatus();
+      }
+    }
+  }
+  if (cached_output != nullptr) {
+    num_hits.fetch_add(1, std::memory_order_relaxed);
+    std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(*cached_output));
+    return absl::OkStatus();
+  }
+
+  num_misses.fetch_add(1, std::memory_order_relaxed);
+  // The fetch is shared with the requests coalesced into it, so it outlives
+  // the cancellation of the request that started it.
+  keys->cancellation = nullptr;
+  absl::Status status = client_->Execute(
+      std::move(keys), metadata,
+      [this, &shard, key](
+          absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) {
+        OnFetchDone(shard, key, std::move(output));
+      },
+      timeout);
+  if (!status.ok()) {
+    OnFetchDone(shard, key, status);
+  }
+  return absl::OkStatus();
+}
+
+void CoalescingBuyerKeyValueAsyncClient::OnFetchDone(
+    Shard& shard, const std::string& key,
+    absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) const {
+  std::shared_ptr<const GetBuyerValuesOutput> shared_output;
+  if (output.ok()) {
+    shared_output = *std::move(output);
+  }
+  std::vector<OnDone> waiting;
+  {
+    absl::MutexLock lock(&shard.mu);
+    if (auto it = shard.in_flight.find(key); it != shard.in_flight.end()) {
+      waiting = std::move(it->second);
+      shard.in_flight.erase(it);
+    }
+    const int64_t bytes =
+        shared_output ? key.size() + shared_output->result.size() : 0;
+    if (shared_output && options_.cache_ttl > absl::ZeroDuration() &&
+        bytes <= max_bytes_per_shard_) {
+      absl::Time now = absl::Now();
+      EvictLocked(shard, now, bytes);
+      absl::Time expiry = now + options_.cache_ttl;
+      if (auto [it, inserted] = shard.cache.try_emplace(
+              key, CacheEntry{shared_output, expiry, bytes});
+          !inserted) {
+        shard.cache_bytes -= it->second.bytes;
+        it->second = CacheEntry{shared_output, expiry, bytes};
+      }
+      shard.cache_bytes += bytes;
+      shard.cache_order.emplace_back(key, expiry);
+    }
+  }
+  for (auto& callback : waiting) {
+    if (shared_output) {
+      std::move(callback)(
+          std::make_unique<GetBuyerValuesOutput>(*shared_output));
+    } else {
+      std::move(callback)(output.status());
+    }
+  }
+}
+
+void CoalescingBuyerKeyValueAsyncClient::EvictLocked(
+    Shard& shard, absl::Time now, int64_t bytes_to_add) const {
+  while (!shard.cache_order.empty()) {
+    const auto& [key, expiry] = shard.cache_order.front();
+    if (expiry > now &&
+        shard.cache_bytes + bytes_to_add <= max_bytes_per_shard_) {
+      break;
+    }
+    if (auto it = shard.cache.find(key);
+        it != shard.cache.end() && it->second.expiry == expiry) {
+      shard.cache_bytes -= it->second.bytes;
+      shard.cache.erase(it);
+    }
+    shard.cache_order.pop_front();
+  }
+}
+
+absl::flat_hash_map<std::string, double>
+CoalescingBuyerKeyValueAsyncClient::GetLookupRatios() {
+  const double hits = num_hits.exchange(0, std::memory_order_relaxed);
+  const double misses = num_misses.exchange(0, std::memory_order_relaxed);
+  const double coalesced = num_coalesced.exchange(0, std::memory_order_relaxed);
+  const double total = hits + misses + coalesced;
+  if (total == 0) {
+    return {};
+  }
+  return {{kHit, hits / total},
+          {kMiss, misses / total},
+          {kCoalesced, coalesced / total}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_BUYER_COALESCING_BUYER_KEY_VALUE_ASYNC_CLIENT_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_BUYER_COALESCING_BUYER_KEY_VALUE_ASYNC_CLIENT_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/clients/async_client.h"
+#include "services/common/clients/http_kv_server/buyer/buyer_key_value_async_http_client.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct KvCoalescingOptions {
+  // How long successful lookups are served from the cache. Only in-flight
+  // lookups are shared if zero.
+  absl::Duration cache_ttl = absl::ZeroDuration();
+  // Upper bound of the keys and responses held in the cache, in bytes.
+  int64_t cache_max_bytes = 64 * 1024 * 1024;
+  // Number of independently locked shards of the in-flight lookups and cache.
+  int num_shards = 16;
+};
+
+// Decorates a buyer KV client so that identical lookups (same keys, interest
+// group names, hostname, client type and experiment group) share a single
+// upstream fetch while one is in flight, and are served from a small TTL cache
+// afterwards. Failed lookups are not cached.
+//
+// Shared lookups use the metadata and timeout of the lookup that started the
+// fetch. Lookups served from the cache complete synchronously, on the calling
+// thread. Errors are always reported through on_done.
+class CoalescingBuyerKeyValueAsyncClient
+    : public AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput> {
+ public:
+  explicit CoalescingBuyerKeyValueAsyncClient(
+      std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput>>
+          client,
+      const KvCoalescingOptions& options = {});
+
+  absl::Status Execute(
+      std::unique_ptr<GetBuyerValuesInput> keys,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
+          on_done,
+      absl::Duration timeout) const override;
+
+  // Observable callback exporting the share of lookups of all instances that
+  // were cache hits, misses and coalesced with an in-flight lookup since the
+  // previous call.
+  static absl::flat_hash_map<std::string, double> GetLookupRatios();
+
+ private:
+  using OnDone = absl::AnyInvocable<
+      void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>;
+
+  struct CacheEntry {
+    std::shared_ptr<const GetBuyerValuesOutput> output;
+    absl::Time expiry;
+    int64_t bytes;
+  };
+
+  struct Shard {
+    absl::Mutex mu;
+    // Callbacks of the lookups waiting for an in-flight fetch, by lookup key.
+    absl::flat_hash_map<std::string, std::vector<OnDone>> in_flight
+        ABSL_GUARDED_BY(mu);
+    absl::flat_hash_map<std::string, CacheEntry> cache ABSL_GUARDED_BY(mu);
+    // Cached keys with their expiry, in insertion order. Since the TTL is
+    // fixed this is also expiry order. May refer to entries already replaced
+    // or evicted, which are skipped by comparing the expiry.
+    std::deque<std::pair<std::string, absl::Time>> cache_order
+        ABSL_GUARDED_BY(mu);
+    int64_t cache_bytes ABSL_GUARDED_BY(mu) = 0;
+  };
+
+  Shard& GetShard(const std::string& key) const;
+
+  // Completes all the lookups waiting for key and caches the output.
+  void OnFetchDone(
+      Shard& shard, const std::string& key,
+      absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) const;
+
+  // Drops expired entries and, if needed, the oldest entries until
+  // bytes_to_add fit into the shard.
+  void EvictLocked(Shard& shard, absl::Time now, int64_t bytes_to_add) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu);
+
+  std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput>>
+      client_;
+  const KvCoalescingOptions options_;
+  const int64_t max_bytes_per_shard_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_BUYER_COALESCING_BUYER_KEY_VALUE_ASYNC_CLIENT_H_
@@ -0,0 +1,227 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/buyer/coalescing_buyer_key_value_async_client.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+using KvClientMock = AsyncClientMock<GetBuyerValuesInput, GetBuyerValuesOutput>;
+using KvOnDone = absl::AnyInvocable<
+    void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>;
+
+constexpr char kResult[] = R"JSON({"keys": {"a": 1}})JSON";
+constexpr absl::Duration kTimeout = absl::Milliseconds(100);
+
+std::unique_ptr<GetBuyerValuesInput> MakeInput(absl::string_view key) {
+  auto input = std::make_unique<GetBuyerValuesInput>();
+  input->keys = {key};
+  input->interest_group_names = {"ig"};
+  input->hostname = "publisher.com";
+  return input;
+}
+
+std::unique_ptr<GetBuyerValuesOutput> MakeOutput() {
+  return std::make_unique<GetBuyerValuesOutput>(
+      GetBuyerValuesOutput{kResult, 10, sizeof(kResult)});
+}
+
+class CoalescingBuyerKeyValueAsyncClientTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Resets the counters shared by all instances.
+    CoalescingBuyerKeyValueAsyncClient::GetLookupRatios();
+  }
+
+  std::unique_ptr<CoalescingBuyerKeyValueAsyncClient> MakeClient(
+      const KvCoalescingOptions& options) {
+    auto kv_client = std::make_unique<KvClientMock>();
+    kv_client_ = kv_client.get();
+    return std::make_unique<CoalescingBuyerKeyValueAsyncClient>(
+        std::move(kv_client), options);
+  }
+
+  // Saves the callbacks of upstream fetches, to be answered by the test.
+  void CaptureFetches() {
+    EXPECT_CALL(*kv_client_, Execute)
+        .WillRepeatedly([this](std::unique_ptr<GetBuyerValuesInput> input,
+                               const RequestMetadata& metadata,
+                               KvOnDone on_done, absl::Duration timeout) {
+          upstream_callbacks_.push_back(std::move(on_done));
+          return absl::OkStatus();
+        });
+  }
+
+  KvClientMock* kv_client_;
+  std::vector<KvOnDone> upstream_callbacks_;
+};
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, SharesInFlightFetch) {
+  auto client = MakeClient({});
+  CaptureFetches();
+
+  int num_done = 0;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(client
+                    ->Execute(
+                        MakeInput("a"), {},
+                        [&num_done](absl::StatusOr<
+                                    std::unique_ptr<GetBuyerValuesOutput>>
+                                        output) {
+                          ASSERT_TRUE(output.ok()) << output.status();
+                          EXPECT_EQ((*output)->result, kResult);
+                          ++num_done;
+                        },
+                        kTimeout)
+                    .ok());
+  }
+  ASSERT_EQ(upstream_callbacks_.size(), 1);
+  EXPECT_EQ(num_done, 0);
+
+  std::move(upstream_callbacks_[0])(MakeOutput());
+  EXPECT_EQ(num_done, 3);
+  EXPECT_THAT(CoalescingBuyerKeyValueAsyncClient::GetLookupRatios(),
+              UnorderedElementsAre(Pair("hit", DoubleEq(0)),
+                                   Pair("miss", DoubleEq(1.0 / 3)),
+                                   Pair("coalesced", DoubleEq(2.0 / 3))));
+}
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, ServesCachedLookupsWithinTtl) {
+  auto client = MakeClient({.cache_ttl = absl::Minutes(1)});
+  CaptureFetches();
+
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  ASSERT_EQ(upstream_callbacks_.size(), 1);
+  std::move(upstream_callbacks_[0])(MakeOutput());
+
+  bool done = false;
+  client
+      ->Execute(
+          MakeInput("a"), {},
+          [&done](absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>
+                      output) {
+            ASSERT_TRUE(output.ok()) << output.status();
+            EXPECT_EQ((*output)->result, kResult);
+            done = true;
+          },
+          kTimeout)
+      .IgnoreError();
+  EXPECT_TRUE(done);
+  EXPECT_EQ(upstream_callbacks_.size(), 1);
+
+  // A different lookup is fetched.
+  client->Execute(MakeInput("b"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  EXPECT_EQ(upstream_callbacks_.size(), 2);
+}
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, FetchesAgainAfterTtl) {
+  auto client = MakeClient({.cache_ttl = absl::Milliseconds(1)});
+  CaptureFetches();
+
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  std::move(upstream_callbacks_[0])(MakeOutput());
+  absl::SleepFor(absl::Milliseconds(5));
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  EXPECT_EQ(upstream_callbacks_.size(), 2);
+}
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, DoesNotCacheErrors) {
+  auto client = MakeClient({.cache_ttl = absl::Minutes(1)});
+  CaptureFetches();
+
+  int num_errors = 0;
+  auto expect_error =
+      [&num_errors](
+          absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) {
+        EXPECT_FALSE(output.ok());
+        ++num_errors;
+      };
+  client->Execute(MakeInput("a"), {}, expect_error, kTimeout).IgnoreError();
+  client->Execute(MakeInput("a"), {}, expect_error, kTimeout).IgnoreError();
+  ASSERT_EQ(upstream_callbacks_.size(), 1);
+  std::move(upstream_callbacks_[0])(absl::UnavailableError("KV down"));
+  EXPECT_EQ(num_errors, 2);
+
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  EXPECT_EQ(upstream_callbacks_.size(), 2);
+}
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, ReportsUpstreamExecuteFailure) {
+  auto client = MakeClient({});
+  EXPECT_CALL(*kv_client_, Execute)
+      .WillOnce([](std::unique_ptr<GetBuyerValuesInput> input,
+                   const RequestMetadata& metadata, KvOnDone on_done,
+                   absl::Duration timeout) {
+        return absl::InternalError("failed");
+      });
+
+  bool done = false;
+  EXPECT_TRUE(
+      client
+          ->Execute(
+              MakeInput("a"), {},
+              [&done](absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>
+                          output) {
+                EXPECT_EQ(output.status().code(), absl::StatusCode::kInternal);
+                done = true;
+              },
+              kTimeout)
+          .ok());
+  EXPECT_TRUE(done);
+}
+
+TEST_F(CoalescingBuyerKeyValueAsyncClientTest, EvictsOldestEntriesOverBytes) {
+  // Each shard fits a single entry.
+  auto client = MakeClient({.cache_ttl = absl::Minutes(1),
+                            .cache_max_bytes = sizeof(kResult) + 64,
+                            .num_shards = 1});
+  CaptureFetches();
+
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  std::move(upstream_callbacks_[0])(MakeOutput());
+  client->Execute(MakeInput("b"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  std::move(upstream_callbacks_[1])(MakeOutput());
+
+  // "b" is cached, "a" was evicted for it.
+  client->Execute(MakeInput("b"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  EXPECT_EQ(upstream_callbacks_.size(), 2);
+  client->Execute(MakeInput("a"), {}, [](auto output) {}, kTimeout)
+      .IgnoreError();
+  EXPECT_EQ(upstream_callbacks_.size(), 3);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,33 +15,109 @@
 
 #include "services/common/clients/http_kv_server/seller/seller_key_value_async_http_client.h"
 
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/common/clients/http_kv_server/util/generate_url.h"
+#include "services/common/util/json_span_util.h"
+#include "services/common/util/json_stream_scanner.h"
 #include "services/common/util/request_metadata.h"
 #include "services/common/util/request_response_constants.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
 
-// Builds Seller KV Value lookup https request url.
-HTTPRequest SellerKeyValueAsyncHttpClient::BuildSellerKeyValueRequest(
-    absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
-    std::unique_ptr<GetSellerValuesInput> client_input) {
-  HTTPRequest request;
-  ClearAndMakeStartOfUrl(kv_server_host_domain, &request.url);
+// Upper bound of the characters the params other than the keys take on top of
+// their values.
+constexpr int kMaxShortParamsOverhead = 64;
+
+// Locates the requested properties of a response as it streams in.
+class ResponseScanner : public HttpBodyConsumer {
+ public:
+  explicit ResponseScanner(std::vector<std::string> properties)
+      : scanner_(std::move(properties)) {}
 
+  void OnBodyChunk(absl::string_view chunk) override {
+    scanner_.Consume(chunk);
+  }
+
+  // Offsets of the properties once the whole response was consumed, if it is
+  // valid JSON.
+  std::optional<JsonPropertyOffsets> Finish() {
+    absl::StatusOr<JsonPropertyOffsets> offsets = scanner_.Finish();
+    if (!offsets.ok()) {
+      PS_VLOG(kNoisyWarn) << "Seller KV response not scanned: "
+                          << offsets.status();
+      return std::nullopt;
+    }
+    return *std::move(offsets);
+  }
+
+ private:
+  JsonPropertyStreamScanner scanner_;
+};
+
+// Appends the client type and experiment group id query params to the url.
+void AddNonKeyQueryParams(const GetSellerValuesInput& client_input,
+                          std::string& url) {
   // In the future, we will expose the client type param for
   // all client types, but for now we will limit it to android for
   // ease of Key/Value service interoperability with the on-device api.
-  if (client_input->client_type == CLIENT_TYPE_ANDROID) {
-    AddAmpersandIfNotFirstQueryParam(&request.url);
-    absl::StrAppend(&request.url, "client_type=", client_input->client_type);
+  if (client_input.client_type == CLIENT_TYPE_ANDROID) {
+    AddAmpersandIfNotFirstQueryParam(&url);
+    absl::StrAppend(&url, "client_type=", client_input.client_type);
+  }
+
+  if (!client_input.seller_kv_experiment_group_id.empty()) {
+    AddAmpersandIfNotFirstQueryParam(&url);
+    absl::StrAppend(&url, "experimentGroupId=",
+                    client_input.seller_kv_experiment_group_id);
   }
+}
 
-  if (!client_input->seller_kv_experiment_group_id.empty()) {
-    AddAmpersandIfNotFirstQueryParam(&request.url);
-    absl::StrAppend(&request.url, "experimentGroupId=",
-                    client_input->seller_kv_experiment_group_id);
+// Appends "key":["value1",...] to the JSON object being built in body.
+void AppendJsonStringArray(absl::string_view key, const UrlKeysSet& values,
+                           std::string& body) {
+  if (body.size() > 1) {
+    body.push_back(',');
+  }
+  AppendJsonString(key, body);
+  body.append(":[");
+  bool first = true;
+  for (absl::string_view value : values) {
+    if (!first) {
+      body.push_back(',');
+    }
+    first = false;
+    AppendJsonString(value, body);
   }
+  body.push_back(']');
+}
+
+}  // namespace
+
+// Builds Seller KV Value lookup https request url.
+HTTPRequest SellerKeyValueAsyncHttpClient::BuildSellerKeyValueRequest(
+    absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
+    std::unique_ptr<GetSellerValuesInput> client_input) {
+  HTTPRequest request;
+  // Reserves the url once for all of its params, with room to spare for the
+  // names and separators of the short ones.
+  request.url.reserve(
+      kv_server_host_domain.size() +
+      client_input->seller_kv_experiment_group_id.size() +
+      kMaxShortParamsOverhead +
+      ListItemsQueryParamsLength("renderUrls", client_input->render_urls,
+                                 /*encode_params=*/true) +
+      ListItemsQueryParamsLength("adComponentRenderUrls",
+                                 client_input->ad_component_render_urls,
+                                 /*encode_params=*/true));
+  ClearAndMakeStartOfUrl(kv_server_host_domain, &request.url);
+  AddNonKeyQueryParams(*client_input, request.url);
 
   if (!client_input->render_urls.empty()) {
     AddListItemsAsQueryParamsToUrl(&request.url, "renderUrls",
@@ -56,14 +132,48 @@ HTTPRequest SellerKeyValueAsyncHttpClient::BuildSellerKeyValueRequest(
   return request;
 }
 
+HTTPRequest SellerKeyValueAsyncHttpClient::BuildSellerKeyValuePostRequest(
+    absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
+    std::unique_ptr<GetSellerValuesInput> client_input) {
+  HTTPRequest request;
+  ClearAndMakeStartOfUrl(kv_server_host_domain, &request.url);
+  AddNonKeyQueryParams(*client_input, request.url);
+
+  request.body.push_back('{');
+  if (!client_input->render_urls.empty()) {
+    AppendJsonStringArray("renderUrls", client_input->render_urls,
+                          request.body);
+  }
+  if (!client_input->ad_component_render_urls.empty()) {
+    AppendJsonStringArray("adComponentRenderUrls",
+                          client_input->ad_component_render_urls,
+                          request.body);
+  }
+  request.body.push_back('}');
+  request.headers = RequestMetadataToHttpHeaders(metadata);
+  request.headers.emplace_back("Content-Type: application/json");
+  // Sends the body right away instead of waiting for a 100 Continue, which
+  // libcurl otherwise expects before uploading bodies over 1 KB.
+  request.headers.emplace_back("Expect:");
+  return request;
+}
+
 absl::Status SellerKeyValueAsyncHttpClient::Execute(
     std::unique_ptr<GetSellerValuesInput> keys, const RequestMetadata& metadata,
     absl::AnyInvocable<
         void(absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>) &&>
         on_done,
     absl::Duration timeout) const {
-  HTTPRequest request = BuildSellerKeyValueRequest(kv_server_base_address_,
-                                                   metadata, std::move(keys));
+  std::shared_ptr<ResponseScanner> scanner;
+  if (!keys->scan_properties.empty()) {
+    scanner = std::make_shared<ResponseScanner>(
+        std::move(keys->scan_properties));
+  }
+  const std::string& address = endpoints_->addresses()[0];
+  HTTPRequest request =
+      post_keys_
+          ? BuildSellerKeyValuePostRequest(address, metadata, std::move(keys))
+          : BuildSellerKeyValueRequest(address, metadata, std::move(keys));
   PS_VLOG(kKVLog) << "SellerKeyValueAsyncHttpClient Request: " << request.url;
   PS_VLOG(kKVLog) << "\nSellerKeyValueAsyncHttpClient Headers:\n";
   for (const auto& header : request.headers) {
@@ -73,9 +183,12 @@ absl::Status SellerKeyValueAsyncHttpClient::Execute(
   for (std::string& header : request.headers) {
     request_size += header.size();
   }
-  request_size += request.url.size();
-  auto done_callback = [on_done = std::move(on_done), request_size](
-                           absl::StatusOr<std::string> resultStr) mutable {
+  request_size += request.url.size() + request.body.size();
+  request.body_consumer = scanner;
+  auto done_callback = [on_done = std::move(on_done), request_size,
+                        scanner = std::move(scanner)](
+                           absl::StatusOr<std::string> resultStr,
+                           int attempt) mutable {
     if (resultStr.ok()) {
       PS_VLOG(kKVLog) << "SellerKeyValueAsyncHttpClient Response: "
                       << resultStr.value();
@@ -83,6 +196,10 @@ absl::Status SellerKeyValueAsyncHttpClient::Execute(
       std::unique_ptr<GetSellerValuesOutput> resultUPtr =
           std::make_unique<GetSellerValuesOutput>(GetSellerValuesOutput(
               {std::move(resultStr.value()), request_size, response_size}));
+      // Only the first attempt was scanned.
+      if (scanner != nullptr && attempt == 0) {
+        resultUPtr->property_offsets = scanner->Finish();
+      }
       std::move(on_done)(std::move(resultUPtr));
     } else {
       PS_VLOG(kNoisyWarn) << "SellerKeyValueAsyncHttpClients Response fail: "
@@ -90,35 +207,41 @@ absl::Status SellerKeyValueAsyncHttpClient::Execute(
       std::move(on_done)(resultStr.status());
     }
   };
-  http_fetcher_async_->FetchUrl(
-      request, static_cast<int>(absl::ToInt64Milliseconds(timeout)),
+  endpoints_->Fetch(
+      std::move(request), timeout,
+      [fetcher = http_fetcher_async_.get(), post_keys = post_keys_](
+          const HTTPRequest& request, absl::Duration timeout,
+          OnDoneFetchUrl done_callback) {
+        const int timeout_ms =
+            static_cast<int>(absl::ToInt64Milliseconds(timeout));
+        if (post_keys) {
+          fetcher->PostUrl(request, timeout_ms, std::move(done_callback));
+        } else {
+          fetcher->FetchUrl(request, timeout_ms, std::move(done_callback));
+        }
+      },
       std::move(done_callback));
   return absl::OkStatus();
 }
 
 SellerKeyValueAsyncHttpClient::SellerKeyValueAsyncHttpClient(
     absl::string_view kv_server_base_address,
-    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm)
-    : http_fetcher_async_(std::move(http_fetcher_async)),
-      kv_server_base_address_(kv_server_base_address) {
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm,
+    const ConnectionWarmingOptions& warming_options, bool post_keys,
+    KvEndpointOptions endpoint_options)
+    : endpoints_(std::make_unique<KvEndpointPool>(kv_server_base_address,
+                                                  std::move(endpoint_options))),
+      http_fetcher_async_(std::move(http_fetcher_async)),
+      post_keys_(post_keys) {
   if (pre_warm) {
-    auto request = std::make_unique<GetSellerValuesInput>();
-    auto status =
-        Execute(
-            std::move(request), {},
-            [](absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>
-                   seller_kv_output) mutable {
-              if (!seller_kv_output.ok()) {
-                PS_LOG(ERROR)
-                    << "SellerKeyValueAsyncHttpClient pre-warm returned status:"
-                    << seller_kv_output.status().message();
-              }
-            },
-            // Longer timeout for first request
-            absl::Milliseconds(60000));
-    if (!status.ok()) {
-      PS_LOG(ERROR) << "SellerKeyValueAsyncHttpClient pre-warming failed:"
-                    << status;
+    // Each endpoint gets its own pool of warm connections.
+    for (const std::string& address : endpoints_->addresses()) {
+      connection_warmers_.push_back(std::make_unique<ConnectionWarmer>(
+          http_fetcher_async_.get(),
+          BuildSellerKeyValueRequest(address, {},
+                                     std::make_unique<GetSellerValuesInput>()),
+          warming_options));
+      connection_warmers_.back()->Start();
     }
   }
 }
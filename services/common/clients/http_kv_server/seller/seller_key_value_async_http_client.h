@@ -17,6 +17,7 @@
 #define SERVICES_COMMON_CLIENTS_SELLER_KEY_VALUE_ASYNC_HTTP_CLIENT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,8 +26,11 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/client_params.h"
+#include "services/common/clients/http/connection_warmer.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 #include "services/common/clients/http_kv_server/util/generate_url.h"
+#include "services/common/clients/http_kv_server/util/kv_endpoint_pool.h"
+#include "services/common/util/json_stream_scanner.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -46,6 +50,11 @@ struct GetSellerValuesInput {
   // [DSP] Optional ID for experiments conducted by buyer. By spec, valid values
   // are in the range: [0, 65535].
   std::string seller_kv_experiment_group_id;
+
+  // Top level properties of the response whose values are located while the
+  // response streams in, into GetSellerValuesOutput::property_offsets, so that
+  // the response need not be scanned again to extract them.
+  std::vector<std::string> scan_properties;
 };
 
 // Response from Seller Key Value server.
@@ -55,6 +64,9 @@ struct GetSellerValuesOutput {
   // Used for instrumentation purposes in upper layers.
   size_t request_size;
   size_t response_size;
+  // Offsets in `result` of the values of the requested scan_properties found,
+  // set if the response is valid JSON and was scanned as it streamed in.
+  std::optional<JsonPropertyOffsets> property_offsets;
 };
 
 // This class fetches Key/Value pairs from a Seller Key/Value Server instance
@@ -67,15 +79,31 @@ class SellerKeyValueAsyncHttpClient
       absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
       std::unique_ptr<GetSellerValuesInput> client_input);
 
+  // Builds Seller KV Value lookup https POST request. The render URL and ad
+  // component render URL keys are sent as JSON string arrays in the body, e.g.
+  // {"renderUrls":["url1"],"adComponentRenderUrls":["url2"]}, so that the
+  // URL stays short for large key sets. The other params stay in the URL.
+  static HTTPRequest BuildSellerKeyValuePostRequest(
+      absl::string_view kv_server_host_domain, const RequestMetadata& metadata,
+      std::unique_ptr<GetSellerValuesInput> client_input);
+
   // HttpFetcherAsync argument must outlive instance.
   // This class uses the http client to fetch KV values in real time.
   // If pre_warm is true, it will send an empty request to the
   // KV client to establish connection and cache connection data with the
-  // underlying HTTP server. It's false by default.
+  // underlying HTTP server. It's false by default. warming_options control
+  // how many connections are pre-warmed and whether they are re-warmed
+  // periodically. If post_keys is true, the keys are POSTed in the request
+  // body instead of being listed in the URL, which requires a seller KV server
+  // that accepts such requests. kv_server_base_address may list replicas
+  // separated by commas, which the requests are spread across as
+  // endpoint_options set.
   explicit SellerKeyValueAsyncHttpClient(
       absl::string_view kv_server_base_address,
       std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
-      bool pre_warm = false);
+      bool pre_warm = false,
+      const ConnectionWarmingOptions& warming_options = {},
+      bool post_keys = false, KvEndpointOptions endpoint_options = {});
 
   // Executes the http request to a Key-Value Server asynchronously.
   //
@@ -91,8 +119,12 @@ class SellerKeyValueAsyncHttpClient
       absl::Duration timeout) const override;
 
  private:
+  // Declared first, so that it outlives the fetches in flight.
+  std::unique_ptr<KvEndpointPool> endpoints_;
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
-  const std::string kv_server_base_address_;
+  const bool post_keys_;
+  // Declared last, so that they stop before the fetcher is destroyed.
+  std::vector<std::unique_ptr<ConnectionWarmer>> connection_warmers_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -500,6 +500,42 @@ TEST_F(KeyValueAsyncHttpClientTest, AddsMetadataToHeaders) {
                                       std::move(no_check_callback));
 }
 
+TEST_F(KeyValueAsyncHttpClientTest, PostsKeysInBody) {
+  auto input = std::make_unique<GetSellerValuesInput>(GetSellerValuesInput{
+      {"https://a.com/ad?id=1", "url2"},
+      {"url\"3"},
+      ClientType::CLIENT_TYPE_ANDROID});
+  absl::Notification notification;
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrl).Times(0);
+  EXPECT_CALL(*mock_http_fetcher_async_, PostUrl)
+      .WillOnce([](const HTTPRequest& request, int timeout_ms,
+                   absl::AnyInvocable<void(absl::StatusOr<std::string>)&&>
+                       done_callback) {
+        EXPECT_EQ(request.url, absl::StrCat(hostname_, "?client_type=1"));
+        EXPECT_EQ(request.body,
+                  R"({"renderUrls":["https://a.com/ad?id=1","url2"],)"
+                  R"("adComponentRenderUrls":["url\"3"]})");
+        EXPECT_THAT(request.headers,
+                    testing::Contains("Content-Type: application/json"));
+        std::move(done_callback)(R"({"renderUrls":{"url2":1}})");
+      });
+
+  SellerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      /*warming_options=*/{}, /*post_keys=*/true);
+  CHECK_OK(client.Execute(
+      std::move(input), {},
+      [&notification](
+          absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>> output) {
+        ASSERT_TRUE(output.ok()) << output.status();
+        EXPECT_EQ((*output)->result, R"({"renderUrls":{"url2":1}})");
+        EXPECT_GT((*output)->request_size, 0);
+        notification.Notify();
+      },
+      absl::Milliseconds(5000)));
+  notification.WaitForNotification();
+}
+
 TEST_F(KeyValueAsyncHttpClientTest, PrewarmsHTTPClient) {
   const std::string expectedUrl = absl::StrCat(hostname_, "?");
   EXPECT_CALL(*mock_http_fetcher_async_, FetchUrl).Times(1);
@@ -16,50 +16,158 @@
 #include "services/common/clients/http_kv_server/util/generate_url.h"
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 
-#include <curl/curl.h>
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
 
-#include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
+// Whether each byte is left as is by the percent-encoding.
+constexpr std::array<bool, 256> kUnreservedBytes = [] {
+  std::array<bool, 256> unreserved = {};
+  for (int c = '0'; c <= '9'; ++c) {
+    unreserved[c] = true;
+  }
+  for (int c = 'a'; c <= 'z'; ++c) {
+    unreserved[c] = true;
+    unreserved[c - 'a' + 'A'] = true;
+  }
+  unreserved['-'] = true;
+  unreserved['.'] = true;
+  unreserved['_'] = true;
+  unreserved['~'] = true;
+  return unreserved;
+}();
 
-namespace {
-std::string EncodeParam(absl::string_view param) {
-  char* encoded_chars = curl_easy_escape(NULL, param.data(), param.length());
-  // Create copy to free up CURL allocated memory.
-  std::string encoded_str(encoded_chars);
-  curl_free(encoded_chars);
-  return encoded_str;
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+size_t EncodedQueryParamLength(absl::string_view value) {
+  size_t length = value.size();
+  for (char c : value) {
+    // Every reserved byte takes two more characters once encoded.
+    length += 2 * !kUnreservedBytes[static_cast<uint8_t>(c)];
+  }
+  return length;
+}
+
+// Writes the percent-encoded value to out, which must have room for
+// EncodedQueryParamLength(value) characters. Returns the end of the written
+// characters.
+char* EncodeQueryParam(absl::string_view value, char* out) {
+  for (char c : value) {
+    const auto byte = static_cast<uint8_t>(c);
+    if (kUnreservedBytes[byte]) {
+      *out++ = c;
+    } else {
+      out[0] = '%';
+      out[1] = kHexDigits[byte >> 4];
+      out[2] = kHexDigits[byte & 0xF];
+      out += 3;
+    }
+  }
+  return out;
 }
+
+// The key, "=" and the commas between the values.
+size_t ListItemsOverhead(absl::string_view key, size_t num_values) {
+  return key.size() + 1 + (num_values == 0 ? 0 : num_values - 1);
+}
+
+// Appends the params of the key and its values, which take `length`
+// characters, to the url. Sizes the url once, and writes the params in place.
+template <typename Values>
+void AppendListItems(std::string* url, absl::string_view key,
+                     const Values& values, size_t length, bool encode_params) {
+  AddAmpersandIfNotFirstQueryParam(url);
+  const size_t offset = url->size();
+  url->resize(offset + length);
+  char* out = url->data() + offset;
+  out = std::copy(key.begin(), key.end(), out);
+  *out++ = '=';
+  bool first = true;
+  for (absl::string_view value : values) {
+    if (!first) {
+      *out++ = ',';
+    }
+    first = false;
+    out = encode_params ? EncodeQueryParam(value, out)
+                        : std::copy(value.begin(), value.end(), out);
+  }
+}
+
 }  // namespace
 
-namespace privacy_sandbox::bidding_auction_servers {
+UrlKeys::UrlKeys(std::initializer_list<absl::string_view> values) {
+  Reserve(values.size());
+  Insert(values.begin(), values.end());
+  Finalize();
+}
+
+void UrlKeys::Reserve(size_t num_values) {
+  inserted_.reserve(num_values);
+  values_.reserve(num_values);
+}
+
+void UrlKeys::Insert(absl::string_view value) {
+  if (!inserted_.insert(value).second) {
+    return;
+  }
+  values_.push_back(value);
+  length_ += value.size();
+  encoded_length_ += EncodedQueryParamLength(value);
+}
+
+void UrlKeys::Finalize() { std::sort(values_.begin(), values_.end()); }
 
 void AddAmpersandIfNotFirstQueryParam(std::string* url) {
   if ((url->at(url->size() - 1) != '?') && url->at(url->size() - 1) != '&') {
-    absl::StrAppend(url, "&");
+    url->push_back('&');
   }
 }
 
+size_t ListItemsQueryParamsLength(absl::string_view key,
+                                  const UrlKeysSet& values,
+                                  bool encode_params) {
+  size_t length = ListItemsOverhead(key, values.size());
+  for (absl::string_view value : values) {
+    length += encode_params ? EncodedQueryParamLength(value) : value.size();
+  }
+  return length;
+}
+
+size_t ListItemsQueryParamsLength(absl::string_view key, const UrlKeys& values,
+                                  bool encode_params) {
+  return ListItemsOverhead(key, values.size()) +
+         (encode_params ? values.encoded_length() : values.length());
+}
+
+void AppendEncodedQueryParam(absl::string_view value, std::string* url) {
+  const size_t offset = url->size();
+  url->resize(offset + EncodedQueryParamLength(value));
+  EncodeQueryParam(value, url->data() + offset);
+}
+
 void AddListItemsAsQueryParamsToUrl(std::string* url, absl::string_view key,
                                     const UrlKeysSet& values,
                                     bool encode_params) {
-  AddAmpersandIfNotFirstQueryParam(url);
-  absl::StrAppend(url, key, "=");
-  if (encode_params) {
-    std::vector<std::string> encoded_values(values.size());
-    std::transform(values.cbegin(), values.cend(), encoded_values.begin(),
-                   [](absl::string_view str) { return EncodeParam(str); });
-    absl::StrAppend(url, absl::StrJoin(encoded_values, ","));
-  } else {
-    absl::StrAppend(url, absl::StrJoin(values, ","));
-  }
+  AppendListItems(url, key, values,
+                  ListItemsQueryParamsLength(key, values, encode_params),
+                  encode_params);
+}
+
+void AddListItemsAsQueryParamsToUrl(std::string* url, absl::string_view key,
+                                    const UrlKeys& values,
+                                    bool encode_params) {
+  AppendListItems(url, key, values,
+                  ListItemsQueryParamsLength(key, values, encode_params),
+                  encode_params);
 }
 
 void ClearAndMakeStartOfUrl(absl::string_view kv_server_host_domain,
                             std::string* url) {
-  *url = "";
-  absl::StrAppend(url, kv_server_host_domain);
-  absl::StrAppend(url, "?");
+  // Keeps the capacity of the url, which callers may have reserved.
+  url->assign(kv_server_host_domain.data(), kv_server_host_domain.size());
+  url->push_back('?');
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -16,10 +16,12 @@
 #ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_GENERATE_URL_H_
 #define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_GENERATE_URL_H_
 
+#include <initializer_list>
 #include <string>
 #include <vector>
 
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 
 // Helper methods for building URLs with query params.
@@ -27,6 +29,55 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 using UrlKeysSet = absl::btree_set<absl::string_view>;
 
+/**
+ * Values of a list query param, in the canonical order of a UrlKeysSet
+ * (sorted, without duplicates), so that identical lookups build identical
+ * urls. Cheaper to build than a UrlKeysSet from many overlapping lists, e.g.
+ * the bidding signals keys of all the interest groups of a request: values
+ * are deduplicated with a hash set as they are inserted, and sorted once by
+ * Finalize(). Their lengths, plain and percent-encoded, are summed as they
+ * are inserted, so that the url can be sized without another pass over them.
+ * The values are views, and what they point to must outlive the UrlKeys.
+ */
+class UrlKeys {
+ public:
+  using const_iterator = std::vector<absl::string_view>::const_iterator;
+
+  UrlKeys() = default;
+  UrlKeys(std::initializer_list<absl::string_view> values);
+
+  void Reserve(size_t num_values);
+
+  // Inserts the value unless it was already inserted.
+  void Insert(absl::string_view value);
+  template <typename Iterator>
+  void Insert(Iterator first, Iterator last) {
+    for (; first != last; ++first) {
+      Insert(*first);
+    }
+  }
+
+  // Sorts the values. Must be called once all the values are inserted, and
+  // before they are read.
+  void Finalize();
+
+  const_iterator begin() const { return values_.begin(); }
+  const_iterator end() const { return values_.end(); }
+  size_t size() const { return values_.size(); }
+  bool empty() const { return values_.empty(); }
+
+  // Sum of the lengths of the values.
+  size_t length() const { return length_; }
+  // Sum of the lengths of the percent-encoded values.
+  size_t encoded_length() const { return encoded_length_; }
+
+ private:
+  absl::flat_hash_set<absl::string_view> inserted_;
+  std::vector<absl::string_view> values_;
+  size_t length_ = 0;
+  size_t encoded_length_ = 0;
+};
+
 /**
  * Adds an ampersand if one is needed, and does nothing if one is not needed.
  * @param url the url being built
@@ -47,6 +98,29 @@ void AddAmpersandIfNotFirstQueryParam(std::string* url);
 void AddListItemsAsQueryParamsToUrl(std::string* url, absl::string_view key,
                                     const UrlKeysSet& values,
                                     bool encode_params = false);
+void AddListItemsAsQueryParamsToUrl(std::string* url, absl::string_view key,
+                                    const UrlKeys& values,
+                                    bool encode_params = false);
+
+/**
+ * Returns the number of characters AddListItemsAsQueryParamsToUrl appends to
+ * a url for the key and its values, not counting a leading ampersand. Used to
+ * reserve the url once before it is built. Constant time for UrlKeys.
+ */
+size_t ListItemsQueryParamsLength(absl::string_view key,
+                                  const UrlKeysSet& values,
+                                  bool encode_params = false);
+size_t ListItemsQueryParamsLength(absl::string_view key, const UrlKeys& values,
+                                  bool encode_params = false);
+
+/**
+ * Appends the percent-encoded value to the url. Like curl_easy_escape, every
+ * byte but the unreserved characters of RFC 3986 (ALPHA, DIGIT, "-", ".", "_"
+ * and "~") is encoded as %XX.
+ * @param value the value to encode, e.g. "https://a.com"
+ * @param url the url being built, "https%3A%2F%2Fa.com" is appended to it
+ */
+void AppendEncodedQueryParam(absl::string_view value, std::string* url);
 
 /**
  * Clears the string when creating a new url, adds the host domain, and adds
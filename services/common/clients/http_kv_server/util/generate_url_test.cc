@@ -0,0 +1,92 @@
+//   Copyright 2024 Google LLC
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/generate_url.h"
+
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string CurlEscape(absl::string_view value) {
+  char* escaped = curl_easy_escape(nullptr, value.data(), value.size());
+  std::string result(escaped);
+  curl_free(escaped);
+  return result;
+}
+
+TEST(AppendEncodedQueryParamTest, EncodesEveryByteLikeCurl) {
+  for (int byte = 1; byte < 256; ++byte) {
+    const std::string value = {'a', static_cast<char>(byte), 'b'};
+    std::string encoded;
+    AppendEncodedQueryParam(value, &encoded);
+    EXPECT_EQ(encoded, CurlEscape(value)) << "byte: " << byte;
+  }
+}
+
+TEST(AppendEncodedQueryParamTest, EncodesUrl) {
+  std::string url = "a.com?";
+  AppendEncodedQueryParam("https://b.com/ad?id=1&x=y z~", &url);
+  EXPECT_EQ(url, "a.com?https%3A%2F%2Fb.com%2Fad%3Fid%3D1%26x%3Dy%20z~");
+}
+
+TEST(AddListItemsAsQueryParamsToUrlTest, AppendsEncodedValues) {
+  std::string url;
+  ClearAndMakeStartOfUrl("https://kv.com", &url);
+  AddListItemsAsQueryParamsToUrl(&url, "keys", UrlKeysSet{"a b", "c/d"},
+                                 /*encode_params=*/true);
+  AddListItemsAsQueryParamsToUrl(&url, "names", UrlKeysSet{"e,f"});
+  EXPECT_EQ(url, "https://kv.com?keys=a%20b,c%2Fd&names=e,f");
+}
+
+TEST(ListItemsQueryParamsLengthTest, MatchesAppendedLength) {
+  const UrlKeysSet values = {"https://a.com/ad?id=1", "b", ""};
+  for (bool encode_params : {false, true}) {
+    std::string url = "?";
+    AddListItemsAsQueryParamsToUrl(&url, "keys", values, encode_params);
+    EXPECT_EQ(ListItemsQueryParamsLength("keys", values, encode_params),
+              url.size() - 1);
+  }
+}
+
+TEST(UrlKeysTest, DeduplicatesAndSortsLikeUrlKeysSet) {
+  const std::vector<std::string> first = {"c", "a b", "c"};
+  const std::vector<std::string> second = {"b", "a b", "https://a.com/?x"};
+  UrlKeys keys;
+  keys.Insert(first.begin(), first.end());
+  keys.Insert(second.begin(), second.end());
+  keys.Finalize();
+  UrlKeysSet set(first.begin(), first.end());
+  set.insert(second.begin(), second.end());
+  EXPECT_EQ(std::vector<absl::string_view>(keys.begin(), keys.end()),
+            std::vector<absl::string_view>(set.begin(), set.end()));
+
+  for (bool encode_params : {false, true}) {
+    std::string url = "?";
+    std::string set_url = "?";
+    AddListItemsAsQueryParamsToUrl(&url, "keys", keys, encode_params);
+    AddListItemsAsQueryParamsToUrl(&set_url, "keys", set, encode_params);
+    EXPECT_EQ(url, set_url);
+    EXPECT_EQ(ListItemsQueryParamsLength("keys", keys, encode_params),
+              url.size() - 1);
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,316 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/kv_endpoint_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "services/common/util/request_response_constants.h"
+#include "src/logger/request_context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Latencies the hedge delay is computed from.
+constexpr int kNumRecentLatencies = 512;
+// Latencies recorded between two computations of the hedge delay, and before
+// the first one.
+constexpr int kHedgeDelayRefreshInterval = 64;
+
+std::vector<std::string> SplitAddresses(absl::string_view addresses) {
+  std::vector<std::string> split;
+  for (absl::string_view address : absl::StrSplit(addresses, ',')) {
+    address = absl::StripAsciiWhitespace(address);
+    if (!address.empty()) {
+      split.emplace_back(address);
+    }
+  }
+  if (split.empty()) {
+    split.emplace_back(addresses);
+  }
+  return split;
+}
+
+}  // namespace
+
+struct KvEndpointPool::FetchState {
+  HTTPRequest request;
+  KvSend send;
+  absl::Time deadline;
+
+  absl::Mutex mu;
+  bool done ABSL_GUARDED_BY(mu) = false;
+  KvAttemptDone on_done ABSL_GUARDED_BY(mu);
+  int num_attempts ABSL_GUARDED_BY(mu) = 0;
+  int num_in_flight ABSL_GUARDED_BY(mu) = 0;
+  int first_endpoint ABSL_GUARDED_BY(mu) = 0;
+  std::optional<server_common::TaskId> hedge_task_id ABSL_GUARDED_BY(mu);
+};
+
+KvEndpointPool::KvEndpointPool(absl::string_view addresses,
+                               KvEndpointOptions options)
+    : addresses_(SplitAddresses(addresses)),
+      options_(std::move(options)),
+      max_ejected_(static_cast<int>(addresses_.size()) *
+                   options_.max_ejected_percent / 100),
+      endpoints_(addresses_.size()) {
+  recent_latencies_ms_.reserve(kNumRecentLatencies);
+}
+
+void KvEndpointPool::Fetch(HTTPRequest request, absl::Duration timeout,
+                           KvSend send, KvAttemptDone on_done) {
+  if (addresses_.size() == 1) {
+    send(request, timeout,
+         [on_done = std::move(on_done)](
+             absl::StatusOr<std::string> result) mutable {
+           std::move(on_done)(std::move(result), /*attempt=*/0);
+         });
+    return;
+  }
+
+  auto state = std::make_shared<FetchState>();
+  state->request = std::move(request);
+  state->send = std::move(send);
+  state->deadline = absl::Now() + timeout;
+  const int endpoint = Pick();
+  {
+    absl::MutexLock lock(&state->mu);
+    state->on_done = std::move(on_done);
+    state->first_endpoint = endpoint;
+    ++state->num_attempts;
+    ++state->num_in_flight;
+  }
+  if (std::optional<absl::Duration> hedge_delay = HedgeDelay();
+      hedge_delay.has_value() && *hedge_delay < timeout) {
+    server_common::TaskId hedge_task_id =
+        options_.executor->RunAfter(*hedge_delay, [this, state]() {
+          int first_endpoint;
+          {
+            absl::MutexLock lock(&state->mu);
+            state->hedge_task_id.reset();
+            if (state->done || state->num_attempts > 1) {
+              return;
+            }
+            first_endpoint = state->first_endpoint;
+            ++state->num_attempts;
+            ++state->num_in_flight;
+          }
+          SendAttempt(state, Pick(first_endpoint), /*attempt=*/1);
+        });
+    absl::MutexLock lock(&state->mu);
+    state->hedge_task_id = hedge_task_id;
+  }
+  SendAttempt(std::move(state), endpoint, /*attempt=*/0);
+}
+
+void KvEndpointPool::SendAttempt(std::shared_ptr<FetchState> state,
+                                 int endpoint, int attempt) {
+  const absl::Time start = absl::Now();
+  auto done_callback = [this, state, endpoint, attempt,
+                        start](absl::StatusOr<std::string> result) mutable {
+    const bool cancelled =
+        !result.ok() && absl::IsCancelled(result.status());
+    if (result.ok()) {
+      RecordSuccess(endpoint, absl::Now() - start);
+    } else if (!cancelled) {
+      RecordFailure(endpoint);
+    }
+    KvAttemptDone on_done;
+    std::optional<server_common::TaskId> hedge_task_id;
+    bool fail_over = false;
+    {
+      absl::MutexLock lock(&state->mu);
+      --state->num_in_flight;
+      if (state->done) {
+        return;
+      }
+      if (!result.ok() && state->num_in_flight > 0) {
+        // The other attempt may still succeed.
+        return;
+      }
+      hedge_task_id = std::move(state->hedge_task_id);
+      state->hedge_task_id.reset();
+      if (!result.ok() && !cancelled && state->num_attempts < 2 &&
+          absl::Now() < state->deadline) {
+        fail_over = true;
+        ++state->num_attempts;
+        ++state->num_in_flight;
+      } else {
+        state->done = true;
+        on_done = std::move(state->on_done);
+      }
+    }
+    if (hedge_task_id.has_value()) {
+      options_.executor->Cancel(*hedge_task_id);
+    }
+    if (fail_over) {
+      SendAttempt(std::move(state), Pick(endpoint), /*attempt=*/1);
+      return;
+    }
+    std::move(on_done)(std::move(result), attempt);
+  };
+
+  const absl::Duration timeout =
+      std::max(state->deadline - start, absl::Milliseconds(1));
+  if (endpoint == 0 && attempt == 0) {
+    state->send(state->request, timeout, std::move(done_callback));
+    return;
+  }
+  HTTPRequest request = state->request;
+  request.url.replace(0, addresses_[0].size(), addresses_[endpoint]);
+  if (attempt > 0) {
+    request.body_consumer = nullptr;
+  }
+  state->send(request, timeout, std::move(done_callback));
+}
+
+int KvEndpointPool::Pick(int excluded) {
+  absl::MutexLock lock(&mu_);
+  const absl::Time now = absl::Now();
+  absl::InlinedVector<int, 8> candidates;
+  for (int i = 0; i < endpoints_.size(); ++i) {
+    if (i != excluded && endpoints_[i].ejected_until <= now) {
+      candidates.push_back(i);
+    }
+  }
+  if (candidates.empty()) {
+    // Every other endpoint is ejected, so the ejections are ignored.
+    for (int i = 0; i < endpoints_.size(); ++i) {
+      if (i != excluded) {
+        candidates.push_back(i);
+      }
+    }
+  }
+  if (candidates.empty()) {
+    return excluded;
+  }
+  if (candidates.size() == 1) {
+    return candidates[0];
+  }
+  const int a = absl::Uniform<int>(bitgen_, 0, candidates.size());
+  int b = absl::Uniform<int>(bitgen_, 0, candidates.size() - 1);
+  if (b >= a) {
+    ++b;
+  }
+  // Endpoints without a latency yet are tried first, to measure them.
+  const double latency_a =
+      endpoints_[candidates[a]].latency_ewma_ms.value_or(0);
+  const double latency_b =
+      endpoints_[candidates[b]].latency_ewma_ms.value_or(0);
+  return latency_a <= latency_b ? candidates[a] : candidates[b];
+}
+
+void KvEndpointPool::RecordSuccess(int endpoint, absl::Duration latency) {
+  const double latency_ms = absl::ToDoubleMilliseconds(latency);
+  absl::MutexLock lock(&mu_);
+  Endpoint& recorded = endpoints_[endpoint];
+  recorded.consecutive_failures = 0;
+  if (recorded.latency_ewma_ms.has_value()) {
+    *recorded.latency_ewma_ms +=
+        options_.latency_ewma_weight * (latency_ms - *recorded.latency_ewma_ms);
+  } else {
+    recorded.latency_ewma_ms = latency_ms;
+  }
+  AddRecentLatencyLocked(latency_ms);
+  MaybeEjectOutlierLocked(endpoint, absl::Now());
+}
+
+void KvEndpointPool::RecordFailure(int endpoint) {
+  absl::MutexLock lock(&mu_);
+  if (++endpoints_[endpoint].consecutive_failures >=
+      options_.max_consecutive_failures) {
+    EjectLocked(endpoint, absl::Now());
+  }
+}
+
+bool KvEndpointPool::IsEjected(int endpoint) {
+  absl::MutexLock lock(&mu_);
+  return endpoints_[endpoint].ejected_until > absl::Now();
+}
+
+std::optional<absl::Duration> KvEndpointPool::HedgeDelay() const {
+  const int64_t hedge_delay_us = hedge_delay_us_.load();
+  if (hedge_delay_us < 0) {
+    return std::nullopt;
+  }
+  return absl::Microseconds(hedge_delay_us);
+}
+
+void KvEndpointPool::EjectLocked(int endpoint, absl::Time now) {
+  Endpoint& ejected = endpoints_[endpoint];
+  if (ejected.ejected_until > now) {
+    return;
+  }
+  int num_ejected = 0;
+  for (const Endpoint& other : endpoints_) {
+    num_ejected += other.ejected_until > now;
+  }
+  if (num_ejected >= max_ejected_) {
+    return;
+  }
+  PS_VLOG(kNoisyWarn) << "Ejecting KV endpoint " << addresses_[endpoint]
+                      << " for " << options_.ejection_duration;
+  ejected.ejected_until = now + options_.ejection_duration;
+  ejected.consecutive_failures = 0;
+  ejected.latency_ewma_ms.reset();
+}
+
+void KvEndpointPool::MaybeEjectOutlierLocked(int endpoint, absl::Time now) {
+  absl::InlinedVector<double, 8> others;
+  for (int i = 0; i < endpoints_.size(); ++i) {
+    if (i != endpoint && endpoints_[i].ejected_until <= now &&
+        endpoints_[i].latency_ewma_ms.has_value()) {
+      others.push_back(*endpoints_[i].latency_ewma_ms);
+    }
+  }
+  if (others.empty()) {
+    return;
+  }
+  auto median = others.begin() + others.size() / 2;
+  std::nth_element(others.begin(), median, others.end());
+  const double latency_ms = *endpoints_[endpoint].latency_ewma_ms;
+  if (latency_ms > options_.outlier_latency_ratio * *median &&
+      latency_ms - *median >
+          absl::ToDoubleMilliseconds(options_.min_outlier_latency)) {
+    EjectLocked(endpoint, now);
+  }
+}
+
+void KvEndpointPool::AddRecentLatencyLocked(double latency_ms) {
+  if (options_.executor == nullptr || options_.hedge_percentile <= 0) {
+    return;
+  }
+  if (recent_latencies_ms_.size() < kNumRecentLatencies) {
+    recent_latencies_ms_.push_back(latency_ms);
+  } else {
+    recent_latencies_ms_[num_latencies_ % kNumRecentLatencies] = latency_ms;
+  }
+  if (++num_latencies_ % kHedgeDelayRefreshInterval != 0) {
+    return;
+  }
+  std::vector<double> sorted = recent_latencies_ms_;
+  auto percentile =
+      sorted.begin() +
+      std::min<int64_t>(sorted.size() * options_.hedge_percentile / 100,
+                        sorted.size() - 1);
+  std::nth_element(sorted.begin(), percentile, sorted.end());
+  hedge_delay_us_ = static_cast<int64_t>(*percentile * 1000);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,147 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KV_ENDPOINT_POOL_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KV_ENDPOINT_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/random/random.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct KvEndpointOptions {
+  // Used to send the hedged attempts. Never hedged if not set.
+  server_common::Executor* executor = nullptr;
+  // Percentile of the recent latencies of all the endpoints after which a
+  // second attempt is sent to another endpoint, e.g. 95. Never hedged if 0.
+  int hedge_percentile = 0;
+  // Weight of the latest latency in the moving average of an endpoint.
+  double latency_ewma_weight = 0.1;
+  // An endpoint whose average latency is over this multiple of the median
+  // average of the others, and over it by at least min_outlier_latency, is
+  // ejected.
+  double outlier_latency_ratio = 3;
+  absl::Duration min_outlier_latency = absl::Milliseconds(10);
+  // Failures in a row after which an endpoint is ejected.
+  int max_consecutive_failures = 5;
+  // Time an endpoint is ejected for, after which it takes requests again with
+  // its latency measured anew.
+  absl::Duration ejection_duration = absl::Seconds(10);
+  // Share of the endpoints that may be ejected at once.
+  int max_ejected_percent = 50;
+};
+
+// Called once with the first successful response, or the last failure, and
+// the attempt it came from, 0 for the first one.
+using KvAttemptDone = absl::AnyInvocable<void(
+    absl::StatusOr<std::string> result, int attempt) &&>;
+// Sends an attempt of a request, e.g. with HttpFetcherAsync::FetchUrl. May be
+// called concurrently.
+using KvSend = absl::AnyInvocable<void(const HTTPRequest& request,
+                                       absl::Duration timeout,
+                                       OnDoneFetchUrl done_callback) const>;
+
+// Replicas of a KV server the KV HTTP clients spread their requests across,
+// so that a slow or failing replica does not hold the requests until their
+// timeout. Tracks a moving average of the latency of each endpoint, and
+// ejects for a while the endpoints that fail repeatedly or whose latency is
+// an outlier. A request fails over to another endpoint if its first attempt
+// fails, and is hedged to another one if no response came by the hedge
+// percentile of the recent latencies. With a single endpoint, requests are
+// sent as is. Thread-safe, and must outlive the fetches it sends.
+class KvEndpointPool {
+ public:
+  // addresses: base addresses of the replicas, separated by commas.
+  explicit KvEndpointPool(absl::string_view addresses,
+                          KvEndpointOptions options = {});
+
+  KvEndpointPool(const KvEndpointPool&) = delete;
+  KvEndpointPool& operator=(const KvEndpointPool&) = delete;
+
+  const std::vector<std::string>& addresses() const { return addresses_; }
+
+  // Sends `request`, whose url starts with the first address, to the endpoint
+  // picked, then to another endpoint on failure or at the hedge delay. The
+  // body consumer of the request only gets the body of the first attempt.
+  void Fetch(HTTPRequest request, absl::Duration timeout, KvSend send,
+             KvAttemptDone on_done);
+
+  // Returns the endpoint for the next attempt: of two endpoints drawn at
+  // random among those not ejected, the one with the lower average latency.
+  // Leaves out `excluded` if there is another endpoint.
+  int Pick(int excluded = -1) ABSL_LOCKS_EXCLUDED(mu_);
+
+  void RecordSuccess(int endpoint, absl::Duration latency)
+      ABSL_LOCKS_EXCLUDED(mu_);
+  void RecordFailure(int endpoint) ABSL_LOCKS_EXCLUDED(mu_);
+  bool IsEjected(int endpoint) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Delay after which a request is hedged, unset until enough latencies were
+  // recorded or if requests are never hedged.
+  std::optional<absl::Duration> HedgeDelay() const;
+
+ private:
+  struct Endpoint {
+    // Unset until a latency is recorded, and once ejected.
+    std::optional<double> latency_ewma_ms;
+    int consecutive_failures = 0;
+    absl::Time ejected_until = absl::InfinitePast();
+  };
+  struct FetchState;
+
+  // Sends the attempt, counted in the state by the caller.
+  void SendAttempt(std::shared_ptr<FetchState> state, int endpoint,
+                   int attempt);
+
+  void EjectLocked(int endpoint, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Ejects the endpoint if its average latency is an outlier.
+  void MaybeEjectOutlierLocked(int endpoint, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Adds the latency to the recent ones, refreshing the hedge delay now and
+  // then.
+  void AddRecentLatencyLocked(double latency_ms)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::vector<std::string> addresses_;
+  const KvEndpointOptions options_;
+  const int max_ejected_;
+
+  absl::Mutex mu_;
+  std::vector<Endpoint> endpoints_ ABSL_GUARDED_BY(mu_);
+  absl::BitGen bitgen_ ABSL_GUARDED_BY(mu_);
+  // Ring of the latest latencies of all the endpoints.
+  std::vector<double> recent_latencies_ms_ ABSL_GUARDED_BY(mu_);
+  int64_t num_latencies_ ABSL_GUARDED_BY(mu_) = 0;
+  // Negative until computed.
+  std::atomic<int64_t> hedge_delay_us_ = -1;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KV_ENDPOINT_POOL_H_
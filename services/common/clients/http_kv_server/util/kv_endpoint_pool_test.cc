@@ -0,0 +1,157 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/kv_endpoint_pool.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+
+constexpr absl::string_view kAddresses = "https://kv-a, https://kv-b";
+
+struct SentAttempt {
+  std::string url;
+  OnDoneFetchUrl done_callback;
+};
+
+// Keeps the attempts sent, for the test to complete them.
+KvSend SendTo(std::vector<SentAttempt>& sent) {
+  return [&sent](const HTTPRequest& request, absl::Duration timeout,
+                 OnDoneFetchUrl done_callback) {
+    sent.push_back({request.url, std::move(done_callback)});
+  };
+}
+
+HTTPRequest RequestFor(absl::string_view key) {
+  return {.url = absl::StrCat("https://kv-a?keys=", key)};
+}
+
+TEST(KvEndpointPoolTest, SendsAsIsWithSingleEndpoint) {
+  KvEndpointPool pool("https://kv-a");
+  std::vector<SentAttempt> sent;
+  absl::StatusOr<std::string> result;
+  pool.Fetch(RequestFor("k"), absl::Seconds(1), SendTo(sent),
+             [&result](absl::StatusOr<std::string> response, int attempt) {
+               EXPECT_EQ(attempt, 0);
+               result = std::move(response);
+             });
+  ASSERT_EQ(sent.size(), 1);
+  EXPECT_EQ(sent[0].url, "https://kv-a?keys=k");
+  std::move(sent[0].done_callback)(absl::UnavailableError("down"));
+  EXPECT_TRUE(absl::IsUnavailable(result.status()));
+}
+
+TEST(KvEndpointPoolTest, FailsOverToAnotherEndpoint) {
+  KvEndpointPool pool(kAddresses);
+  ASSERT_EQ(pool.addresses(),
+            (std::vector<std::string>{"https://kv-a", "https://kv-b"}));
+  std::vector<SentAttempt> sent;
+  absl::StatusOr<std::string> result;
+  int result_attempt = -1;
+  pool.Fetch(RequestFor("k"), absl::Seconds(10), SendTo(sent),
+             [&](absl::StatusOr<std::string> response, int attempt) {
+               result = std::move(response);
+               result_attempt = attempt;
+             });
+  ASSERT_EQ(sent.size(), 1);
+  std::move(sent[0].done_callback)(absl::UnavailableError("down"));
+
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_NE(sent[0].url, sent[1].url);
+  EXPECT_TRUE(sent[1].url == "https://kv-a?keys=k" ||
+              sent[1].url == "https://kv-b?keys=k");
+  std::move(sent[1].done_callback)("value");
+  EXPECT_EQ(result_attempt, 1);
+  EXPECT_EQ(*result, "value");
+}
+
+TEST(KvEndpointPoolTest, EjectsEndpointFailingRepeatedly) {
+  KvEndpointPool pool(kAddresses, {.max_consecutive_failures = 3});
+  pool.RecordFailure(1);
+  pool.RecordFailure(1);
+  EXPECT_FALSE(pool.IsEjected(1));
+  pool.RecordFailure(1);
+  EXPECT_TRUE(pool.IsEjected(1));
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(pool.Pick(), 0);
+  }
+  // No more than half the endpoints are ejected.
+  for (int i = 0; i < 3; ++i) {
+    pool.RecordFailure(0);
+  }
+  EXPECT_FALSE(pool.IsEjected(0));
+}
+
+TEST(KvEndpointPoolTest, EjectsLatencyOutlier) {
+  KvEndpointPool pool("https://kv-a,https://kv-b,https://kv-c,https://kv-d");
+  pool.RecordSuccess(0, absl::Milliseconds(10));
+  pool.RecordSuccess(1, absl::Milliseconds(12));
+  pool.RecordSuccess(2, absl::Milliseconds(11));
+  pool.RecordSuccess(3, absl::Milliseconds(25));
+  EXPECT_FALSE(pool.IsEjected(3));
+  pool.RecordSuccess(3, absl::Seconds(1));
+  EXPECT_TRUE(pool.IsEjected(3));
+  EXPECT_FALSE(pool.IsEjected(0));
+}
+
+TEST(KvEndpointPoolTest, HedgesSlowRequest) {
+  MockExecutor executor;
+  KvEndpointPool pool(kAddresses,
+                      {.executor = &executor, .hedge_percentile = 90});
+  EXPECT_FALSE(pool.HedgeDelay().has_value());
+  for (int i = 0; i < 100; ++i) {
+    pool.RecordSuccess(i % 2, absl::Milliseconds(i));
+  }
+  ASSERT_TRUE(pool.HedgeDelay().has_value());
+  EXPECT_GT(*pool.HedgeDelay(), absl::ZeroDuration());
+
+  absl::AnyInvocable<void()> hedge;
+  EXPECT_CALL(executor, RunAfter(*pool.HedgeDelay(), _))
+      .WillOnce([&hedge](absl::Duration, absl::AnyInvocable<void()> closure) {
+        hedge = std::move(closure);
+        return server_common::TaskId();
+      });
+  std::vector<SentAttempt> sent;
+  absl::Notification done;
+  int result_attempt = -1;
+  pool.Fetch(RequestFor("k"), absl::Seconds(10), SendTo(sent),
+             [&](absl::StatusOr<std::string> response, int attempt) {
+               EXPECT_EQ(*response, "hedged");
+               result_attempt = attempt;
+               done.Notify();
+             });
+  ASSERT_EQ(sent.size(), 1);
+  std::move(hedge)();
+  ASSERT_EQ(sent.size(), 2);
+  EXPECT_NE(sent[0].url, sent[1].url);
+
+  std::move(sent[1].done_callback)("hedged");
+  ASSERT_TRUE(done.HasBeenNotified());
+  EXPECT_EQ(result_attempt, 1);
+  // The slower attempt is dropped.
+  std::move(sent[0].done_callback)(absl::CancelledError());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
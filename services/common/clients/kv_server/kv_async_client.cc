@@ -18,6 +18,7 @@
 
 #include "include/grpcpp/support/status_code_enum.h"
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/util/log_throttle.h"
 #include "src/public/cpio/interface/crypto_client/crypto_client_interface.h"
 #include "src/public/cpio/proto/public_key_service/v1/public_key_service.pb.h"
 
@@ -25,6 +26,14 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
 
+namespace {
+
+// Minimum interval between the logs of each KV failure site. While the KV
+// server is unavailable, every request fails.
+constexpr int kKvFailureLogIntervalSec = 1;
+
+}  // namespace
+
 KVAsyncGrpcClient::KVAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     std::unique_ptr<kv_server::v2::KeyValueService::Stub> stub)
@@ -53,8 +62,9 @@ void KVAsyncGrpcClient::SendRpc(
         auto oblivious_http_request_uptr =
             ObliviousHttpRequestUptr(captured_oblivious_http_context);
         if (!status.ok()) {
-          PS_LOG(ERROR) << "SendRPC completion status not ok: "
-                        << server_common::ToAbslStatus(status);
+          PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+              << "SendRPC completion status not ok: "
+              << server_common::ToAbslStatus(status);
           params->OnDone(status);
           return;
         }
@@ -64,7 +74,7 @@ void KVAsyncGrpcClient::SendRpc(
             FromObliviousHTTPResponse(*params->ResponseRef()->mutable_data(),
                                       *captured_oblivious_http_context);
         if (!plain_text_binary_http_response.ok()) {
-          PS_LOG(ERROR)
+          PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
               << "KVAsyncGrpcClient failed to get binary HTTP response";
           params->OnDone(grpc::Status(
               grpc::StatusCode::INVALID_ARGUMENT,
@@ -72,11 +82,21 @@ void KVAsyncGrpcClient::SendRpc(
           return;
         }
 
-        auto response = FromBinaryHTTP<GetValuesResponse>(
-            *plain_text_binary_http_response, /*from_json=*/false);
+        auto response = std::make_unique<GetValuesResponse>();
+        if (absl::Status parse_status =
+                FromBinaryHTTP(*plain_text_binary_http_response, *response,
+                               /*from_json=*/false);
+            !parse_status.ok()) {
+          PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+              << "KVAsyncGrpcClient failed to parse the response: "
+              << parse_status;
+          params->OnDone(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                      parse_status.ToString()));
+          return;
+        }
         PS_VLOG(7) << "Retrieved proto response: " << response->DebugString();
         if (!response->has_single_partition()) {
-          PS_LOG(ERROR)
+          PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
               << "KVAsyncGrpcClient expected a single partition response, got: "
               << response->DebugString();
           params->OnDone(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
@@ -84,8 +104,7 @@ void KVAsyncGrpcClient::SendRpc(
           return;
         }
 
-        params->SetRawResponse(
-            std::make_unique<GetValuesResponse>(*std::move(response)));
+        params->SetRawResponse(std::move(response));
         PS_VLOG(6) << "Returning the decrypted response via callback";
         params->OnDone(status);
       });
@@ -98,6 +117,18 @@ absl::Status KVAsyncGrpcClient::ExecuteInternal(
         void(absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>
         on_done,
     absl::Duration timeout) const {
+  return ExecuteInternal(std::move(raw_request), metadata, std::move(on_done),
+                         timeout, /*cancellation=*/nullptr);
+}
+
+absl::Status KVAsyncGrpcClient::ExecuteInternal(
+    std::unique_ptr<GetValuesRequest> raw_request,
+    const RequestMetadata& metadata,
+    absl::AnyInvocable<
+        void(absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>
+        on_done,
+    absl::Duration timeout,
+    std::shared_ptr<RequestCancellation> cancellation) const {
   PS_VLOG(6) << "Raw request:\n" << raw_request->DebugString();
   PS_ASSIGN_OR_RETURN(std::string binary_http_msg,
                       ToBinaryHTTP(*raw_request, /*to_json=*/false));
@@ -131,6 +162,7 @@ absl::Status KVAsyncGrpcClient::ExecuteInternal(
       ObliviousGetValuesRequest, google::api::HttpBody, GetValuesResponse>>(
       std::move(request), std::move(on_done), metadata);
   params->SetDeadline(std::min(timeout, kMaxTimeout));
+  params->SetCancellation(std::move(cancellation));
   PS_VLOG(5) << "Sending RPC ...";
   SendRpc(std::make_unique<quiche::ObliviousHttpRequest::Context>(
               std::move(oblivious_http_request).ReleaseContext()),
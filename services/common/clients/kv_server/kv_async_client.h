@@ -78,6 +78,15 @@ class KVAsyncGrpcClient
           on_done,
       absl::Duration timeout = kMaxTimeout) const override;
 
+  absl::Status ExecuteInternal(
+      std::unique_ptr<GetValuesRequest> raw_request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>
+          on_done,
+      absl::Duration timeout,
+      std::shared_ptr<RequestCancellation> cancellation) const override;
+
  protected:
   void SendRpc(ObliviousHttpRequestUptr oblivious_http_context,
                RawClientParams<ObliviousGetValuesRequest, google::api::HttpBody,
@@ -0,0 +1,120 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr char kKeyGroupOutputs[] = "keyGroupOutputs";
+inline constexpr char kTags[] = "tags";
+inline constexpr char kKeyValues[] = "keyValues";
+inline constexpr char kValue[] = "value";
+
+bool HasTag(const rapidjson::Value& key_group_output, absl::string_view tag) {
+  auto tags = key_group_output.FindMember(kTags);
+  if (tags == key_group_output.MemberEnd() || !tags->value.IsArray()) {
+    return false;
+  }
+  for (const rapidjson::Value& key_group_tag : tags->value.GetArray()) {
+    if (key_group_tag.IsString() &&
+        absl::string_view(key_group_tag.GetString(),
+                          key_group_tag.GetStringLength()) == tag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> ToKVV1Signals(
+    const kv_server::v2::GetValuesResponse& response,
+    absl::Span<const absl::string_view> tags) {
+  const kv_server::v2::ResponsePartition& partition =
+      response.single_partition();
+  if (partition.has_status()) {
+    return absl::InternalError(absl::StrCat("KV partition failed: ",
+                                            partition.status().message()));
+  }
+  const std::string& output = partition.string_output();
+  rapidjson::Document document;
+  rapidjson::ParseResult parse_result =
+      document.Parse<rapidjson::kParseFullPrecisionFlag>(output.data(),
+                                                         output.size());
+  if (parse_result.IsError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("JSON Parse Error: ",
+                     rapidjson::GetParseError_En(parse_result.Code())));
+  }
+  // The key group outputs are either in an object or the whole output.
+  const rapidjson::Value* key_group_outputs = &document;
+  if (document.IsObject()) {
+    auto it = document.FindMember(kKeyGroupOutputs);
+    if (it == document.MemberEnd()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Missing ", kKeyGroupOutputs, " in the KV output"));
+    }
+    key_group_outputs = &it->value;
+  }
+  if (!key_group_outputs->IsArray()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(kKeyGroupOutputs, " of the KV output is not an array"));
+  }
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  for (absl::string_view tag : tags) {
+    writer.Key(tag.data(), tag.size());
+    writer.StartObject();
+    absl::flat_hash_set<absl::string_view> keys;
+    for (const rapidjson::Value& key_group_output :
+         key_group_outputs->GetArray()) {
+      if (!key_group_output.IsObject() || !HasTag(key_group_output, tag)) {
+        continue;
+      }
+      auto key_values = key_group_output.FindMember(kKeyValues);
+      if (key_values == key_group_output.MemberEnd() ||
+          !key_values->value.IsObject()) {
+        continue;
+      }
+      for (const auto& [key, value] : key_values->value.GetObject()) {
+        if (!keys.emplace(key.GetString(), key.GetStringLength()).second) {
+          continue;
+        }
+        writer.Key(key.GetString(), key.GetStringLength());
+        const rapidjson::Value* signal = &value;
+        if (value.IsObject()) {
+          if (auto it = value.FindMember(kValue); it != value.MemberEnd()) {
+            signal = &it->value;
+          }
+        }
+        signal->Accept(writer);
+      }
+    }
+    writer.EndObject();
+  }
+  writer.EndObject();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_KV_SERVER_KV_V2_SIGNALS_H_
+#define SERVICES_COMMON_CLIENTS_KV_SERVER_KV_V2_SIGNALS_H_
+
+#include <initializer_list>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "public/query/v2/get_values_v2.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Tags of the key groups of the KV v2 requests for trusted signals.
+inline constexpr absl::string_view kKVV2CustomTag = "custom";
+inline constexpr absl::string_view kKVV2KeysTag = "keys";
+inline constexpr absl::string_view kKVV2InterestGroupNamesTag =
+    "interestGroupNames";
+inline constexpr absl::string_view kKVV2RenderUrlsTag = "renderUrls";
+inline constexpr absl::string_view kKVV2AdComponentRenderUrlsTag =
+    "adComponentRenderUrls";
+
+// Request metadata of the KV v2 requests for trusted signals.
+inline constexpr absl::string_view kKVV2HostnameMetadata = "hostname";
+inline constexpr absl::string_view kKVV2ExperimentGroupIdMetadata =
+    "experimentGroupId";
+
+// Adds a key group with `tags` and `keys` as its list of string values to the
+// arguments of `partition`.
+template <typename Keys>
+void AddKVV2KeyGroup(std::initializer_list<absl::string_view> tags,
+                     const Keys& keys,
+                     kv_server::v2::RequestPartition& partition) {
+  kv_server::v2::UDFArgument& argument = *partition.add_arguments();
+  for (absl::string_view tag : tags) {
+    argument.mutable_tags()->add_values()->set_string_value(std::string(tag));
+  }
+  google::protobuf::ListValue& values =
+      *argument.mutable_data()->mutable_list_value();
+  for (absl::string_view key : keys) {
+    values.add_values()->set_string_value(std::string(key));
+  }
+}
+
+// Converts the single partition output of a KV v2 response to the trusted
+// signals of a KV v1 response: an object with, for each of `tags`, the values
+// of the keys of the key groups with the tag, e.g.
+//   {"keyGroupOutputs": [{"tags": ["custom", "keys"],
+//                         "keyValues": {"key": {"value": "signal"}}}]}
+// becomes {"keys": {"key": "signal"}} for the "keys" tag. Values are copied
+// as is. The first value of a key wins if several key groups have the key.
+absl::StatusOr<std::string> ToKVV1Signals(
+    const kv_server::v2::GetValuesResponse& response,
+    absl::Span<const absl::string_view> tags);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_KV_SERVER_KV_V2_SIGNALS_H_
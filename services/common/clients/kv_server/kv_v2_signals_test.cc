@@ -0,0 +1,93 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using kv_server::v2::GetValuesResponse;
+using kv_server::v2::RequestPartition;
+
+GetValuesResponse MakeResponse(absl::string_view output) {
+  GetValuesResponse response;
+  response.mutable_single_partition()->set_string_output(output);
+  return response;
+}
+
+TEST(AddKVV2KeyGroupTest, AddsTaggedListOfKeys) {
+  RequestPartition partition;
+
+  AddKVV2KeyGroup({kKVV2CustomTag, kKVV2KeysTag},
+                  std::vector<std::string>{"a", "b"}, partition);
+
+  ASSERT_EQ(partition.arguments_size(), 1);
+  const auto& argument = partition.arguments(0);
+  ASSERT_EQ(argument.tags().values_size(), 2);
+  EXPECT_EQ(argument.tags().values(0).string_value(), kKVV2CustomTag);
+  EXPECT_EQ(argument.tags().values(1).string_value(), kKVV2KeysTag);
+  ASSERT_EQ(argument.data().list_value().values_size(), 2);
+  EXPECT_EQ(argument.data().list_value().values(0).string_value(), "a");
+  EXPECT_EQ(argument.data().list_value().values(1).string_value(), "b");
+}
+
+TEST(ToKVV1SignalsTest, MergesKeyGroupsOfEachTag) {
+  GetValuesResponse response = MakeResponse(R"JSON(
+    {"keyGroupOutputs": [
+      {"tags": ["custom", "keys"],
+       "keyValues": {"a": {"value": "1"}, "b": {"value": [2]}}},
+      {"tags": ["custom", "keys"],
+       "keyValues": {"b": {"value": "ignored"}, "c": {"value": {"x": 3}}}},
+      {"tags": ["custom", "renderUrls"],
+       "keyValues": {"https://ad": {"value": "4"}}}
+    ]})JSON");
+
+  absl::StatusOr<std::string> signals =
+      ToKVV1Signals(response, {kKVV2KeysTag});
+
+  ASSERT_TRUE(signals.ok()) << signals.status();
+  EXPECT_EQ(*signals, R"JSON({"keys":{"a":"1","b":[2],"c":{"x":3}}})JSON");
+}
+
+TEST(ToKVV1SignalsTest, WritesEmptyObjectsOfMissingTags) {
+  GetValuesResponse response = MakeResponse(
+      R"JSON([{"tags": ["custom", "renderUrls"],
+               "keyValues": {"https://ad": {"value": "4"}}}])JSON");
+
+  absl::StatusOr<std::string> signals = ToKVV1Signals(
+      response, {kKVV2RenderUrlsTag, kKVV2AdComponentRenderUrlsTag});
+
+  ASSERT_TRUE(signals.ok()) << signals.status();
+  EXPECT_EQ(*signals,
+            R"JSON({"renderUrls":{"https://ad":"4"},)JSON"
+            R"JSON("adComponentRenderUrls":{}})JSON");
+}
+
+TEST(ToKVV1SignalsTest, FailsOnInvalidOutput) {
+  EXPECT_FALSE(ToKVV1Signals(MakeResponse("{"), {kKVV2KeysTag}).ok());
+  EXPECT_FALSE(ToKVV1Signals(MakeResponse("{}"), {kKVV2KeysTag}).ok());
+
+  GetValuesResponse failed;
+  failed.mutable_single_partition()->mutable_status()->set_message("failed");
+  EXPECT_FALSE(ToKVV1Signals(failed, {kKVV2KeysTag}).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -32,6 +32,7 @@ SellerFrontEndGrpcClient::SellerFrontEndGrpcClient(
   if (client_config.compression) {
     // Set the default compression algorithm for the channel.
     args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
+    compression_policy_ = client_config.compression_policy;
   }
   stub_ = SellerFrontEnd::NewStub(grpc::CreateCustomChannel(
       absl::StrCat(client_config.server_addr), creds, args));
@@ -49,6 +50,10 @@ absl::Status SellerFrontEndGrpcClient::Execute(
       std::make_unique<ClientParams<SelectAdRequest, SelectAdResponse>>(
           std::move(request), std::move(on_done), metadata);
   params->SetDeadline(std::min(sfe_client_max_timeout, timeout));
+  if (compression_policy_.has_value()) {
+    params->ContextRef()->set_compression_algorithm(ChooseGrpcCompression(
+        *compression_policy_, params->RequestRef()->ByteSizeLong()));
+  }
   absl::MutexLock l(&active_calls_mutex_);
   ++active_calls_count_;
   stub_->async()->SelectAd(
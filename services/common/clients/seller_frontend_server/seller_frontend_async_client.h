@@ -16,6 +16,7 @@
 #define FLEDGE_SERVICES_COMMON_CLIENTS_SELLER_FRONTEND_ASYNC_CLIENT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -28,6 +29,7 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/async_client.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "services/common/clients/client_params.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -38,6 +40,8 @@ inline constexpr absl::Duration sfe_client_max_timeout =
 struct SellerFrontEndServiceClientConfig {
   std::string server_addr;
   bool compression = false;
+  // Per-request compression, if compression is enabled.
+  GrpcCompressionPolicy compression_policy;
   bool secure_client = true;
 };
 
@@ -57,6 +61,7 @@ class SellerFrontEndGrpcClient {
 
  private:
   std::unique_ptr<SellerFrontEnd::Stub> stub_;
+  std::optional<GrpcCompressionPolicy> compression_policy_;
   absl::Mutex active_calls_mutex_;
   int active_calls_count_ ABSL_GUARDED_BY(active_calls_mutex_);
 };
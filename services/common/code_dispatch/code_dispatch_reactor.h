@@ -24,10 +24,19 @@
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/roma_timeout.h"
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/arena_message_allocator.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/raw_ciphertext_call.h"
+#include "services/common/util/request_cancellation.h"
+#include "services/common/util/request_phase_tracer.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 #include "src/logger/request_context_logger.h"
 
@@ -48,7 +57,11 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
       CryptoClientWrapperInterface* crypto_client)
       : dispatcher_(dispatcher),
         request_(request),
+        raw_request_(
+            CreateMessageOnArenaOf<RawRequest>(*request, owned_raw_request_)),
         response_(response),
+        raw_response_(
+            CreateMessageOnArenaOf<RawResponse>(*request, owned_raw_response_)),
         key_fetcher_manager_(key_fetcher_manager),
         crypto_client_(crypto_client) {
     PS_VLOG(5) << "Encryption is enabled, decrypting request now";
@@ -68,19 +81,56 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
   // call Finish(grpc::Status).
   virtual void Execute() = 0;
 
+  // Holds the memory reserved for the request until the reactor is done.
+  void HoldMemoryReservation(MemoryReservation memory_reservation) {
+    memory_reservation_ = std::move(memory_reservation);
+  }
+
+  // Serves the call over the raw messages of `raw_call`, which the reactor
+  // was created with the request and the response of, so that the response
+  // ciphertext is sent without being copied.
+  void ServeRawCall(
+      std::shared_ptr<RawCiphertextCall<Request, Response>> raw_call) {
+    raw_call_ = std::move(raw_call);
+  }
+
+  // Sets the deadline of the call, after which the client gives up on it. The
+  // Roma executions of the request do not run past it.
+  void SetDeadline(absl::Time deadline) { deadline_ = deadline; }
+
+  // Continues the distributed trace of the call, named `name`, if the request
+  // is sampled, see RequestTrace. `trace_parent` is the trace context sent by
+  // the client, if any.
+  void StartTrace(absl::string_view name, absl::string_view trace_parent) {
+    trace_.Start(name, raw_request_.log_context().generation_id(),
+                 trace_parent);
+    phase_tracer_.set_listener(&trace_);
+  }
+
  protected:
   // Cleans up all state associated with the CodeDispatchReactor.
   // Called only after the grpc request is finalized and finished.
   void OnDone() override { delete this; };
 
-  // Handles early-cancellation by the client.
-  void OnCancel() override {
-    // TODO(b/245982466): error handling design
-  };
+  // Handles early-cancellation by the client. The Roma executions already
+  // handed to Roma run to completion, since Roma has no way to drop them, but
+  // nothing more is dispatched for the request, see RomaTimeoutMs.
+  void OnCancel() override { cancellation_->Cancel(); };
+
+  // Timeout of the Roma executions dispatched now, see GetRomaTimeoutMs, or a
+  // CANCELLED error once the client has cancelled the call.
+  absl::StatusOr<std::string> RomaTimeoutMs(
+      absl::string_view roma_timeout_ms) const {
+    if (cancellation_->IsCancelled()) {
+      return absl::CancelledError(kRequestCancelledError);
+    }
+    return GetRomaTimeoutMs(roma_timeout_ms, deadline_);
+  }
 
   // Decrypts the request ciphertext in and returns whether decryption was
   // successful. If successful, the result is written into 'raw_request_'.
   bool DecryptRequest() {
+    ScopedRequestPhase decrypt_phase(phase_tracer_, RequestPhase::kDecrypt);
     if (request_->key_id().empty()) {
       PS_LOG(ERROR) << "No key ID found in the request";
       Finish(
@@ -121,6 +171,7 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
   // Encrypts `raw_response` and sets the result on the 'response_ciphertext'
   // field in the response. Returns whether encryption was successful.
   bool EncryptResponse() {
+    ScopedRequestPhase encrypt_phase(phase_tracer_, RequestPhase::kEncrypt);
     std::string payload = raw_response_.SerializeAsString();
     absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
         aead_encrypt = crypto_client_->AeadEncrypt(payload, hpke_secret_);
@@ -131,8 +182,11 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
       return false;
     }
 
-    response_->set_response_ciphertext(
-        aead_encrypt->encrypted_data().ciphertext());
+    response_->set_response_ciphertext(std::move(
+        *aead_encrypt->mutable_encrypted_data()->mutable_ciphertext()));
+    if (raw_call_ != nullptr) {
+      raw_call_->SetResponse();
+    }
     return true;
   }
 
@@ -143,14 +197,32 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
 
   // The client request, lifecycle managed by gRPC.
   const Request* request_;
-  RawRequest raw_request_;
+  // Storage of the raw request and response if the client request is not on
+  // an arena. Otherwise they are on its arena and freed along with it.
+  std::unique_ptr<RawRequest> owned_raw_request_;
+  std::unique_ptr<RawResponse> owned_raw_response_;
+  RawRequest& raw_request_;
   // The client response, lifecycle managed by gRPC.
   Response* response_;
-  RawResponse raw_response_;
+  RawResponse& raw_response_;
 
   server_common::KeyFetcherManagerInterface* key_fetcher_manager_;
   CryptoClientWrapperInterface* crypto_client_;
   std::string hpke_secret_;
+  // Distributed trace of a sampled share of the requests. Started when the
+  // reactor is, so that it covers the decryption of the request.
+  RequestTrace trace_;
+  // Times the phases of a sampled share of the requests.
+  RequestPhaseTracer phase_tracer_;
+  MemoryReservation memory_reservation_;
+  // Messages of the call if served over its raw messages, see ServeRawCall.
+  std::shared_ptr<RawCiphertextCall<Request, Response>> raw_call_;
+  // Deadline of the call, see GetRomaTimeoutMs.
+  absl::Time deadline_ = absl::InfiniteFuture();
+  // Cancellation of the call by the client, shared with the outbound calls
+  // made for it.
+  std::shared_ptr<RequestCancellation> cancellation_ =
+      std::make_shared<RequestCancellation>();
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/code_fetch/code_load_tracker.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "openssl/sha.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Counts of all the trackers, reset by every GetCodeLoadCounts call.
+std::atomic<int64_t> num_loads_performed = 0;
+std::atomic<int64_t> num_loads_skipped = 0;
+
+std::string Digest(absl::string_view code) {
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(code.data()), code.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return digest;
+}
+
+}  // namespace
+
+bool CodeLoadTracker::IsLoaded(absl::string_view version,
+                               absl::string_view code) {
+  std::string digest = Digest(code);
+  absl::MutexLock lock(&mu_);
+  auto it = digests_.find(version);
+  if (it == digests_.end() || it->second != digest) {
+    return false;
+  }
+  num_loads_skipped.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void CodeLoadTracker::RecordLoad(absl::string_view version,
+                                 absl::string_view code) {
+  std::string digest = Digest(code);
+  num_loads_performed.fetch_add(1, std::memory_order_relaxed);
+  absl::MutexLock lock(&mu_);
+  digests_[version] = std::move(digest);
+}
+
+absl::flat_hash_map<std::string, double> CodeLoadTracker::GetCodeLoadCounts() {
+  return {{kCodeLoadPerformed,
+           num_loads_performed.exchange(0, std::memory_order_relaxed)},
+          {kCodeLoadSkipped,
+           num_loads_skipped.exchange(0, std::memory_order_relaxed)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CODE_FETCH_CODE_LOAD_TRACKER_H_
+#define SERVICES_COMMON_CODE_FETCH_CODE_LOAD_TRACKER_H_
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Labels of the outcomes returned by GetCodeLoadCounts.
+inline constexpr char kCodeLoadPerformed[] = "performed";
+inline constexpr char kCodeLoadSkipped[] = "skipped";
+
+// Keeps a digest of the code last loaded into Roma per version, so that code
+// fetchers skip the loads of unchanged code, which compile it in every Roma
+// worker. Thread-safe.
+class CodeLoadTracker {
+ public:
+  // Returns true if the code was the last one loaded for the version, and
+  // counts the load as skipped.
+  bool IsLoaded(absl::string_view version, absl::string_view code)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records the load of the code for the version, once successful.
+  void RecordLoad(absl::string_view version, absl::string_view code)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of loads performed and skipped by all the trackers
+  // since the last call.
+  static absl::flat_hash_map<std::string, double> GetCodeLoadCounts();
+
+ private:
+  absl::Mutex mu_;
+  // SHA-256 digest of the code last loaded, by version.
+  absl::flat_hash_map<std::string, std::string> digests_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CODE_FETCH_CODE_LOAD_TRACKER_H_
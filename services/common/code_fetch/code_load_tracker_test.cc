@@ -0,0 +1,42 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/code_fetch/code_load_tracker.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(CodeLoadTrackerTest, SkipsOnlyUnchangedCodePerVersion) {
+  CodeLoadTracker::GetCodeLoadCounts();
+  CodeLoadTracker tracker;
+  EXPECT_FALSE(tracker.IsLoaded("v1", "code"));
+  tracker.RecordLoad("v1", "code");
+  EXPECT_TRUE(tracker.IsLoaded("v1", "code"));
+  EXPECT_FALSE(tracker.IsLoaded("v1", "new code"));
+  EXPECT_FALSE(tracker.IsLoaded("v2", "code"));
+
+  auto counts = CodeLoadTracker::GetCodeLoadCounts();
+  EXPECT_EQ(counts[kCodeLoadPerformed], 1);
+  EXPECT_EQ(counts[kCodeLoadSkipped], 1);
+  counts = CodeLoadTracker::GetCodeLoadCounts();
+  EXPECT_EQ(counts[kCodeLoadPerformed], 0);
+  EXPECT_EQ(counts[kCodeLoadSkipped], 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
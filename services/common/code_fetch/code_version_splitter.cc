@@ -0,0 +1,213 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/code_fetch/code_version_splitter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/const_init.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kNumHashBuckets = 100;
+
+// Execution stats of a version since the last read of the gauges.
+struct ExecutionStats {
+  int64_t duration_ms = 0;
+  int64_t num_batches = 0;
+  int64_t num_executions = 0;
+  int64_t num_errors = 0;
+};
+
+ABSL_CONST_INIT absl::Mutex stats_mu(absl::kConstInit);
+
+// Only holds the versions of the splits, which are configured at startup.
+absl::flat_hash_map<std::string, ExecutionStats>& StatsByVersion()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(stats_mu) {
+  static auto* stats = new absl::flat_hash_map<std::string, ExecutionStats>();
+  return *stats;
+}
+
+// FNV-1a, since absl::Hash is seeded per process and replicas must agree on
+// the version of a key.
+uint64_t StableHash(absl::string_view key) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : key) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<CodeVersionSplitter>>
+CodeVersionSplitter::Create(std::string default_version,
+                            std::vector<CanaryCodeVersion> canaries,
+                            int64_t max_resident_bytes) {
+  std::vector<Slot> slots;
+  slots.reserve(canaries.size() + 1);
+  slots.push_back(
+      {.version = std::move(default_version), .cumulative_percent = 0});
+  // Views into `slots`, which is not reallocated once reserved.
+  absl::flat_hash_set<absl::string_view> versions;
+  versions.insert(slots[0].version);
+  int cumulative_percent = 0;
+  for (CanaryCodeVersion& canary : canaries) {
+    if (canary.traffic_percent < 0 || canary.traffic_percent > 100) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Traffic percent of version ", canary.version,
+                       " out of range: ", canary.traffic_percent));
+    }
+    cumulative_percent += canary.traffic_percent;
+    if (cumulative_percent > kNumHashBuckets) {
+      return absl::InvalidArgumentError(
+          "Traffic percents of the canary versions add up to more than 100");
+    }
+    slots.push_back({.version = std::move(canary.version),
+                     .cumulative_percent = cumulative_percent});
+    if (!versions.insert(slots.back().version).second) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Version listed twice: ", slots.back().version));
+    }
+  }
+  return std::unique_ptr<CodeVersionSplitter>(
+      new CodeVersionSplitter(std::move(slots), max_resident_bytes));
+}
+
+bool CodeVersionSplitter::HasVersion(absl::string_view version) const {
+  // The versions of the slots never change: no lock is needed to look them
+  // up.
+  for (const Slot& slot : slots_) {
+    if (slot.version == version) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const std::string& CodeVersionSplitter::PickVersion(
+    absl::string_view request_key) const {
+  const int bucket = StableHash(request_key) % kNumHashBuckets;
+  for (size_t i = 1; i < slots_.size(); ++i) {
+    if (bucket < slots_[i].cumulative_percent) {
+      absl::ReaderMutexLock lock(&mu_);
+      return slots_[i].resident ? slots_[i].version : slots_[0].version;
+    }
+  }
+  return slots_[0].version;
+}
+
+CodeVersionSplitter::Slot* CodeVersionSplitter::FindSlot(
+    absl::string_view version) {
+  for (Slot& slot : slots_) {
+    if (slot.version == version) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+bool CodeVersionSplitter::ReserveLoad(absl::string_view version,
+                                      int64_t code_bytes) {
+  absl::MutexLock lock(&mu_);
+  Slot* slot = FindSlot(version);
+  if (slot == nullptr) {
+    return false;
+  }
+  const int64_t resident_bytes = resident_bytes_ - slot->bytes + code_bytes;
+  if (slot != &slots_[0] && max_resident_bytes_ > 0 &&
+      resident_bytes > max_resident_bytes_) {
+    return false;
+  }
+  resident_bytes_ = resident_bytes;
+  slot->previous_bytes = slot->bytes;
+  slot->bytes = code_bytes;
+  return true;
+}
+
+void CodeVersionSplitter::FinishLoad(absl::string_view version, bool loaded) {
+  absl::MutexLock lock(&mu_);
+  Slot* slot = FindSlot(version);
+  if (slot == nullptr) {
+    return;
+  }
+  if (loaded) {
+    slot->resident = true;
+    return;
+  }
+  resident_bytes_ += slot->previous_bytes - slot->bytes;
+  slot->bytes = slot->previous_bytes;
+}
+
+void CodeVersionSplitter::RecordExecutions(absl::string_view version,
+                                           int duration_ms, int num_executions,
+                                           int num_errors) const {
+  if (!HasVersion(version)) {
+    return;
+  }
+  absl::MutexLock lock(&stats_mu);
+  ExecutionStats& stats = StatsByVersion()[version];
+  stats.duration_ms += duration_ms;
+  ++stats.num_batches;
+  stats.num_executions += num_executions;
+  stats.num_errors += num_errors;
+}
+
+int64_t CodeVersionSplitter::resident_bytes() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return resident_bytes_;
+}
+
+absl::flat_hash_map<std::string, double>
+CodeVersionSplitter::GetExecutionDurationsMs() {
+  absl::flat_hash_map<std::string, double> durations;
+  absl::MutexLock lock(&stats_mu);
+  for (auto& [version, stats] : StatsByVersion()) {
+    if (stats.num_batches > 0) {
+      durations[version] =
+          static_cast<double>(stats.duration_ms) / stats.num_batches;
+    }
+    stats.duration_ms = 0;
+    stats.num_batches = 0;
+  }
+  return durations;
+}
+
+absl::flat_hash_map<std::string, double>
+CodeVersionSplitter::GetExecutionErrorRates() {
+  absl::flat_hash_map<std::string, double> error_rates;
+  absl::MutexLock lock(&stats_mu);
+  for (auto& [version, stats] : StatsByVersion()) {
+    if (stats.num_executions > 0) {
+      error_rates[version] =
+          static_cast<double>(stats.num_errors) / stats.num_executions;
+    }
+    stats.num_executions = 0;
+    stats.num_errors = 0;
+  }
+  return error_rates;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
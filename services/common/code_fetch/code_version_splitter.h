@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CODE_FETCH_CODE_VERSION_SPLITTER_H_
+#define SERVICES_COMMON_CODE_FETCH_CODE_VERSION_SPLITTER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// A version of a UDF which gets a share of the traffic next to the default
+// version.
+struct CanaryCodeVersion {
+  std::string version;
+  // Percent of the requests sent to this version, in [0, 100].
+  int traffic_percent = 0;
+};
+
+// Splits the traffic of a UDF between its default version and canary versions
+// loaded into Roma next to it.
+//
+// Requests are assigned to a version by a stable hash of their key, so that
+// the same key gets the same version on every replica. Canary versions which
+// are not loaded yet get no traffic: their share goes to the default version.
+//
+// Roma cannot unload code, so the resident versions are bounded when they are
+// loaded: code fetchers only load the versions of the split, and a canary
+// version whose code does not fit the memory budget next to the other
+// resident versions is not loaded. Thread-safe.
+class CodeVersionSplitter {
+ public:
+  // Fails if a percent is out of range, if the percents add up to more than
+  // 100 or if a version is listed twice. No budget if max_resident_bytes is 0.
+  static absl::StatusOr<std::unique_ptr<CodeVersionSplitter>> Create(
+      std::string default_version, std::vector<CanaryCodeVersion> canaries,
+      int64_t max_resident_bytes = 0);
+
+  // Not copyable or movable.
+  CodeVersionSplitter(const CodeVersionSplitter&) = delete;
+  CodeVersionSplitter& operator=(const CodeVersionSplitter&) = delete;
+
+  // Returns true if the version is the default or a canary version.
+  bool HasVersion(absl::string_view version) const;
+
+  // Returns the version to execute for the request key.
+  const std::string& PickVersion(absl::string_view request_key) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns true and reserves the bytes of the code if the version is part of
+  // the split and fits the budget. The default version always fits. Every
+  // reservation must be followed by a FinishLoad call.
+  bool ReserveLoad(absl::string_view version, int64_t code_bytes)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Makes the version resident once loaded, or releases its reservation if
+  // the load failed, in which case Roma keeps its previous code.
+  void FinishLoad(absl::string_view version, bool loaded)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records the JS executions of a batch run on a version of the split.
+  void RecordExecutions(absl::string_view version, int duration_ms,
+                        int num_executions, int num_errors) const;
+
+  // Returns the bytes of code reserved by the resident versions.
+  int64_t resident_bytes() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Return the mean batch duration, and the ratio of failed executions, by
+  // version since the last call.
+  static absl::flat_hash_map<std::string, double> GetExecutionDurationsMs();
+  static absl::flat_hash_map<std::string, double> GetExecutionErrorRates();
+
+ private:
+  struct Slot {
+    std::string version;
+    // Upper bound of the hash buckets of the version, out of 100.
+    int cumulative_percent;
+    // Bytes of the code of the version counted in the budget, and their
+    // count before the load in progress.
+    int64_t bytes = 0;
+    int64_t previous_bytes = 0;
+    bool resident = false;
+  };
+
+  CodeVersionSplitter(std::vector<Slot> slots, int64_t max_resident_bytes)
+      : slots_(std::move(slots)), max_resident_bytes_(max_resident_bytes) {}
+
+  Slot* FindSlot(absl::string_view version) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // The default version comes first. Only the load state changes once built.
+  std::vector<Slot> slots_;
+  const int64_t max_resident_bytes_;
+
+  mutable absl::Mutex mu_;
+  int64_t resident_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CODE_FETCH_CODE_VERSION_SPLITTER_H_
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/code_fetch/code_version_splitter.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kDefaultVersion[] = "v1";
+constexpr char kCanaryVersion[] = "v2";
+constexpr int kNumKeys = 10'000;
+
+std::unique_ptr<CodeVersionSplitter> CreateSplitter(
+    int traffic_percent, int64_t max_resident_bytes = 0) {
+  auto splitter = CodeVersionSplitter::Create(
+      kDefaultVersion, {{kCanaryVersion, traffic_percent}}, max_resident_bytes);
+  EXPECT_TRUE(splitter.ok()) << splitter.status();
+  return *std::move(splitter);
+}
+
+void Load(CodeVersionSplitter& splitter, absl::string_view version,
+          int64_t code_bytes) {
+  ASSERT_TRUE(splitter.ReserveLoad(version, code_bytes));
+  splitter.FinishLoad(version, /*loaded=*/true);
+}
+
+TEST(CodeVersionSplitterTest, RejectsInvalidSplits) {
+  EXPECT_EQ(CodeVersionSplitter::Create(kDefaultVersion, {{"v2", 101}})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(CodeVersionSplitter::Create(kDefaultVersion,
+                                        {{"v2", 60}, {"v3", 50}})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(CodeVersionSplitter::Create(kDefaultVersion, {{"v1", 10}})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(CodeVersionSplitterTest, SplitsResidentVersionsByKey) {
+  std::unique_ptr<CodeVersionSplitter> splitter =
+      CreateSplitter(/*traffic_percent=*/20);
+  // Canary versions get no traffic until loaded.
+  for (int i = 0; i < kNumKeys; ++i) {
+    EXPECT_EQ(splitter->PickVersion(absl::StrCat(i)), kDefaultVersion);
+  }
+
+  Load(*splitter, kCanaryVersion, 10);
+  int num_canary_picks = 0;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const std::string& version = splitter->PickVersion(absl::StrCat(i));
+    EXPECT_EQ(splitter->PickVersion(absl::StrCat(i)), version);
+    num_canary_picks += version == kCanaryVersion;
+  }
+  EXPECT_NEAR(num_canary_picks, kNumKeys / 5, kNumKeys / 50);
+}
+
+TEST(CodeVersionSplitterTest, LoadsCanaryVersionsWithinBudget) {
+  std::unique_ptr<CodeVersionSplitter> splitter =
+      CreateSplitter(/*traffic_percent=*/50, /*max_resident_bytes=*/25);
+  EXPECT_FALSE(splitter->ReserveLoad("unknown", 1));
+
+  // The default version always loads.
+  Load(*splitter, kDefaultVersion, 20);
+  EXPECT_FALSE(splitter->ReserveLoad(kCanaryVersion, 10));
+  Load(*splitter, kCanaryVersion, 5);
+  EXPECT_EQ(splitter->resident_bytes(), 25);
+
+  // Reloads replace the bytes of the version, and failed ones keep the
+  // bytes of the previous code.
+  ASSERT_TRUE(splitter->ReserveLoad(kDefaultVersion, 10));
+  splitter->FinishLoad(kDefaultVersion, /*loaded=*/false);
+  EXPECT_EQ(splitter->resident_bytes(), 25);
+  Load(*splitter, kDefaultVersion, 10);
+  EXPECT_EQ(splitter->resident_bytes(), 15);
+  Load(*splitter, kCanaryVersion, 15);
+  EXPECT_EQ(splitter->resident_bytes(), 25);
+}
+
+TEST(CodeVersionSplitterTest, ReportsExecutionStatsByVersion) {
+  std::unique_ptr<CodeVersionSplitter> splitter =
+      CreateSplitter(/*traffic_percent=*/50);
+  CodeVersionSplitter::GetExecutionDurationsMs();
+  CodeVersionSplitter::GetExecutionErrorRates();
+
+  splitter->RecordExecutions(kDefaultVersion, /*duration_ms=*/10,
+                             /*num_executions=*/4, /*num_errors=*/0);
+  splitter->RecordExecutions(kDefaultVersion, /*duration_ms=*/30,
+                             /*num_executions=*/4, /*num_errors=*/2);
+  splitter->RecordExecutions(kCanaryVersion, /*duration_ms=*/5,
+                             /*num_executions=*/2, /*num_errors=*/2);
+  splitter->RecordExecutions("unknown", /*duration_ms=*/5,
+                             /*num_executions=*/2, /*num_errors=*/2);
+
+  absl::flat_hash_map<std::string, double> durations =
+      CodeVersionSplitter::GetExecutionDurationsMs();
+  ASSERT_EQ(durations.size(), 2);
+  EXPECT_EQ(durations[kDefaultVersion], 20);
+  EXPECT_EQ(durations[kCanaryVersion], 5);
+  absl::flat_hash_map<std::string, double> error_rates =
+      CodeVersionSplitter::GetExecutionErrorRates();
+  ASSERT_EQ(error_rates.size(), 2);
+  EXPECT_EQ(error_rates[kDefaultVersion], 0.25);
+  EXPECT_EQ(error_rates[kCanaryVersion], 1);
+
+  EXPECT_TRUE(CodeVersionSplitter::GetExecutionDurationsMs().empty());
+  EXPECT_TRUE(CodeVersionSplitter::GetExecutionErrorRates().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
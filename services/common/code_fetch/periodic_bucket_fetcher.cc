@@ -29,6 +29,7 @@
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/time/time.h"
 #include "services/common/code_fetch/code_fetcher_interface.h"
+#include "services/common/code_fetch/code_load_tracker.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/core/interface/async_context.h"
 #include "src/core/interface/errors.h"
@@ -55,13 +56,15 @@ PeriodicBucketFetcher::PeriodicBucketFetcher(
     absl::string_view bucket_name, absl::Duration fetch_period_ms,
     V8Dispatcher* dispatcher, server_common::Executor* executor,
     WrapCodeForDispatch wrap_code,
-    BlobStorageClientInterface* blob_storage_client)
+    BlobStorageClientInterface* blob_storage_client,
+    CodeVersionSplitter* version_splitter)
     : bucket_name_(bucket_name),
       wrap_code_(std::move(wrap_code)),
       fetch_period_ms_(fetch_period_ms),
       dispatcher_(*dispatcher),
       executor_(*executor),
-      blob_storage_client_(*blob_storage_client) {}
+      blob_storage_client_(*blob_storage_client),
+      version_splitter_(version_splitter) {}
 
 absl::Status PeriodicBucketFetcher::Start() {
   PeriodicBucketFetchSync();
@@ -129,7 +132,21 @@ void PeriodicBucketFetcher::HandleBlobFetchResult(
   }
   auto result_value = {context.response->blob().data()};
   std::string wrapped_code = wrap_code_(result_value);
+  if (load_tracker_.IsLoaded(version, wrapped_code)) {
+    PS_VLOG(kSuccess) << "Code unchanged for version " << version
+                      << ", skipping the Roma load.";
+    return;
+  }
+  if (version_splitter_ != nullptr &&
+      !version_splitter_->ReserveLoad(version, wrapped_code.size())) {
+    PS_LOG(ERROR) << "Version " << version
+                  << " does not fit the memory budget, skipping the Roma load.";
+    return;
+  }
   absl::Status roma_result = dispatcher_.LoadSync(version, wrapped_code);
+  if (version_splitter_ != nullptr) {
+    version_splitter_->FinishLoad(version, roma_result.ok());
+  }
   if (!roma_result.ok()) {
     PS_LOG(ERROR) << "Roma failed to load blob: " << roma_result;
     return;
@@ -137,6 +154,7 @@ void PeriodicBucketFetcher::HandleBlobFetchResult(
   PS_VLOG(kSuccess) << "Current code loaded into Roma for version " << version
                     << ":\n"
                     << wrapped_code;
+  load_tracker_.RecordLoad(version, wrapped_code);
   absl::MutexLock lock(&some_load_success_mu_);
   some_load_success_ = true;
 }
@@ -153,11 +171,19 @@ void PeriodicBucketFetcher::PeriodicBucketFetchSync() {
   }
 
   // TODO: We must evict any versions in Roma but not in the bucket. We
-  // should also only fetch blobs if their metadata indicates a change.
+  // should also only fetch blobs if their metadata indicates a change; the
+  // listed metadata has no generation or checksum yet, so unchanged blobs are
+  // only skipped at load time.
 
   absl::BlockingCounter blobs_remaining(blob_list->blob_metadatas_size());
 
   for (const BlobMetadata& md : blob_list->blob_metadatas()) {
+    // Only the versions of the split are kept resident in Roma.
+    if (version_splitter_ != nullptr &&
+        !version_splitter_->HasVersion(md.blob_name())) {
+      blobs_remaining.DecrementCount();
+      continue;
+    }
     auto get_blob_request = std::make_shared<GetBlobRequest>();
     get_blob_request->mutable_blob_metadata()->set_bucket_name(
         md.bucket_name());
@@ -27,6 +27,8 @@
 #include "absl/time/time.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
 #include "services/common/code_fetch/code_fetcher_interface.h"
+#include "services/common/code_fetch/code_load_tracker.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 #include "src/concurrent/executor.h"
 #include "src/public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
 
@@ -35,11 +37,15 @@ namespace privacy_sandbox::bidding_auction_servers {
 class PeriodicBucketFetcher : public CodeFetcherInterface {
  public:
   // Constructs a new PeriodicBucketFether.
+  //
+  // version_splitter: if set, only the blobs of its versions are loaded, and
+  // only while they fit its memory budget. Must outlive the fetcher.
   explicit PeriodicBucketFetcher(
       absl::string_view bucket_name, absl::Duration fetch_period_ms,
       V8Dispatcher* dispatcher, server_common::Executor* executor,
       WrapCodeForDispatch wrap_code,
-      google::scp::cpio::BlobStorageClientInterface* blob_storage_client);
+      google::scp::cpio::BlobStorageClientInterface* blob_storage_client,
+      CodeVersionSplitter* version_splitter = nullptr);
 
   ~PeriodicBucketFetcher() { End(); }
 
@@ -78,10 +84,15 @@ class PeriodicBucketFetcher : public CodeFetcherInterface {
   V8Dispatcher& dispatcher_;
   server_common::Executor& executor_;
   google::scp::cpio::BlobStorageClientInterface& blob_storage_client_;
+  CodeVersionSplitter* version_splitter_;
 
   // Keeps track of the next task to be performed on the executor.
   absl::optional<server_common::TaskId> task_id_;
 
+  // Keeps track of the code loaded per blob, so that unchanged blobs are not
+  // loaded again.
+  CodeLoadTracker load_tracker_;
+
   // Represents a lock on some_load_success_.
   absl::Mutex some_load_success_mu_;
   // Notified when 1 blob is successfully loaded.
@@ -25,6 +25,7 @@
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
 #include "gtest/gtest.h"
+#include "services/common/code_fetch/code_version_splitter.h"
 #include "services/common/test/mocks.h"
 #include "src/core/interface/async_context.h"
 #include "src/public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
@@ -214,6 +215,138 @@ TEST(PeriodicBucketFetcherTest, LoadsAllBlobsInBucket) {
   bucket_fetcher.End();
 }
 
+TEST(PeriodicBucketFetcherTest, SkipsLoadsOfUnchangedBlobs) {
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+  auto wrapper = [](const std::vector<std::string>& blobs) {
+    return blobs.at(0);
+  };
+
+  EXPECT_CALL(*blob_storage_client, ListBlobsMetadata)
+      .Times(2)
+      .WillRepeatedly(
+          [](AsyncContext<ListBlobsMetadataRequest, ListBlobsMetadataResponse>
+                 async_context) {
+            BlobMetadata md;
+            md.set_bucket_name(kSampleBucketName);
+            md.set_blob_name(kSampleBlobName);
+            async_context.response =
+                std::make_shared<ListBlobsMetadataResponse>();
+            async_context.response->mutable_blob_metadatas()->Add(
+                std::move(md));
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+            return absl::OkStatus();
+          });
+
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .Times(2)
+      .WillRepeatedly(
+          [](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+            async_context.response = std::make_shared<GetBlobResponse>();
+            async_context.response->mutable_blob()->set_data(kSampleData);
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+            return absl::OkStatus();
+          });
+
+  // Runs the second fetch right away, which schedules the third one.
+  EXPECT_CALL(*executor, RunAfter)
+      .Times(2)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            closure();
+            return server_common::TaskId();
+          })
+      .WillOnce([](absl::Duration duration, absl::AnyInvocable<void()>) {
+        return server_common::TaskId();
+      });
+
+  EXPECT_CALL(dispatcher, LoadSync(kSampleBlobName, kSampleData))
+      .WillOnce([](std::string_view version, absl::string_view blob_data) {
+        return absl::OkStatus();
+      });
+
+  PeriodicBucketFetcher bucket_fetcher(
+      kSampleBucketName, kFetchPeriod, &dispatcher, executor.get(),
+      std::move(wrapper), blob_storage_client.get());
+  auto status = bucket_fetcher.Start();
+  ASSERT_TRUE(status.ok()) << status;
+  bucket_fetcher.End();
+}
+
+TEST(PeriodicBucketFetcherTest, LoadsOnlyTheVersionsOfTheSplit) {
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+  auto wrapper = [](const std::vector<std::string>& blobs) {
+    return blobs.at(0);
+  };
+  absl::StatusOr<std::unique_ptr<CodeVersionSplitter>> splitter =
+      CodeVersionSplitter::Create(kSampleBlobName, {{kSampleBlobName2, 10}},
+                                  /*max_resident_bytes=*/10);
+  ASSERT_TRUE(splitter.ok()) << splitter.status();
+
+  EXPECT_CALL(*blob_storage_client, ListBlobsMetadata)
+      .WillOnce(
+          [](AsyncContext<ListBlobsMetadataRequest, ListBlobsMetadataResponse>
+                 async_context) {
+            async_context.response =
+                std::make_shared<ListBlobsMetadataResponse>();
+            for (const char* blob_name :
+                 {kSampleBlobName, kSampleBlobName2, kSampleBlobName3}) {
+              BlobMetadata* md =
+                  async_context.response->mutable_blob_metadatas()->Add();
+              md->set_bucket_name(kSampleBucketName);
+              md->set_blob_name(blob_name);
+            }
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+            return absl::OkStatus();
+          });
+
+  // The blob of the version outside the split is not fetched.
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .Times(2)
+      .WillRepeatedly(
+          [](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+            EXPECT_NE(async_context.request->blob_metadata().blob_name(),
+                      kSampleBlobName3);
+            async_context.response = std::make_shared<GetBlobResponse>();
+            async_context.response->mutable_blob()->set_data(
+                async_context.request->blob_metadata().blob_name() ==
+                        kSampleBlobName
+                    ? kSampleData
+                    : kSampleData2);
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+            return absl::OkStatus();
+          });
+
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce([](absl::Duration duration, absl::AnyInvocable<void()>) {
+        return server_common::TaskId();
+      });
+
+  EXPECT_CALL(dispatcher, LoadSync(kSampleBlobName, kSampleData))
+      .WillOnce([](std::string_view version, absl::string_view blob_data) {
+        return absl::OkStatus();
+      });
+  EXPECT_CALL(dispatcher, LoadSync(kSampleBlobName2, kSampleData2))
+      .WillOnce([](std::string_view version, absl::string_view blob_data) {
+        return absl::OkStatus();
+      });
+
+  PeriodicBucketFetcher bucket_fetcher(
+      kSampleBucketName, kFetchPeriod, &dispatcher, executor.get(),
+      std::move(wrapper), blob_storage_client.get(), splitter->get());
+  auto status = bucket_fetcher.Start();
+  ASSERT_TRUE(status.ok()) << status;
+  EXPECT_EQ((*splitter)->resident_bytes(), 10);
+  bucket_fetcher.End();
+}
+
 TEST(PeriodicBucketFetcherTest, ReturnsSuccessIfAtLeastOneBlobLoads) {
   MockV8Dispatcher dispatcher;
   auto executor = std::make_unique<MockExecutor>();
@@ -23,6 +23,8 @@
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/logger/request_context_logger.h"
@@ -32,6 +34,12 @@ namespace privacy_sandbox::bidding_auction_servers {
 // Minimal duration to wait before trying to fetch code blobs again.
 constexpr absl::Duration kMinCodeFetchDuration = absl::Minutes(1);
 
+// Subtracted from the time of the last fetch in If-Modified-Since headers, so
+// that code modified right before it is not missed if the clock of the
+// endpoint is behind. Such code is fetched again until the margin passes,
+// but not loaded again.
+constexpr absl::Duration kIfModifiedSinceClockSkew = absl::Minutes(5);
+
 PeriodicCodeFetcher::PeriodicCodeFetcher(
     std::vector<std::string> url_endpoints, absl::Duration fetch_period_ms,
     HttpFetcherAsync* curl_http_fetcher, V8Dispatcher* dispatcher,
@@ -68,19 +76,25 @@ void PeriodicCodeFetcher::End() {
 }
 
 void PeriodicCodeFetcher::PeriodicCodeFetchSync() {
+  const absl::Time fetch_time = absl::Now();
   absl::Notification notification;
   auto done_callback =
-      [&notification,
+      [&notification, fetch_time,
        this](const std::vector<absl::StatusOr<std::string>>& results) mutable {
         bool all_status_ok = true;
         std::vector<std::string> results_value;
 
-        for (const auto& result : results) {
+        for (size_t i = 0; i < results.size(); ++i) {
+          const absl::StatusOr<std::string>& result = results[i];
           if (!result.ok()) {
             PS_LOG(ERROR) << "MultiCurlHttpFetcher Failure Response: "
                           << result.status();
             all_status_ok = false;
             break;
+          } else if (result->empty() && i < last_blobs_.size()) {
+            // A 304 to the conditional request, the code did not change.
+            PS_VLOG(kSuccess) << "Code not modified at " << url_endpoints_[i];
+            results_value.push_back(last_blobs_[i]);
           } else {
             PS_VLOG(kSuccess)
                 << "MultiCurlHttpFetcher Success Response: " << result.status();
@@ -89,16 +103,19 @@ void PeriodicCodeFetcher::PeriodicCodeFetchSync() {
         }
 
         if (all_status_ok) {
-          // Vector comparison to only load a new code blob into Roma
-          if (cb_results_value_ != results_value) {
-            cb_results_value_ = results_value;
-
-            std::string wrapped_code = wrap_code_(cb_results_value_);
+          last_blobs_ = results_value;
+          last_fetch_time_ = fetch_time;
+          // Only loads a new code blob into Roma.
+          std::string wrapped_code = wrap_code_(results_value);
+          if (load_tracker_.IsLoaded(version_string_, wrapped_code)) {
+            PS_VLOG(kSuccess) << "Code unchanged, skipping the Roma load.";
+          } else {
             absl::Status syncResult =
                 dispatcher_.LoadSync(version_string_, wrapped_code);
             if (syncResult.ok()) {
               PS_VLOG(kSuccess) << "Current code loaded into Roma:\n"
                                 << wrapped_code;
+              load_tracker_.RecordLoad(version_string_, wrapped_code);
               absl::MutexLock lock(&some_load_success_mu_);
               some_load_success_ = true;
             } else {
@@ -113,8 +130,16 @@ void PeriodicCodeFetcher::PeriodicCodeFetchSync() {
   std::vector<HTTPRequest> requests;
   for (const std::string& endpoint : url_endpoints_) {
     PS_VLOG(5) << "Requesting UDF from: " << endpoint;
-    requests.push_back(
-        {.url = endpoint, .headers = {"Cache-Control: no-cache"}});
+    HTTPRequest request = {.url = endpoint,
+                           .headers = {"Cache-Control: no-cache"}};
+    if (!last_blobs_.empty()) {
+      request.headers.push_back(absl::StrCat(
+          "If-Modified-Since: ",
+          absl::FormatTime("%a, %d %b %Y %H:%M:%S GMT",
+                           last_fetch_time_ - kIfModifiedSinceClockSkew,
+                           absl::UTCTimeZone())));
+    }
+    requests.push_back(std::move(request));
   }
 
   curl_http_fetcher_.FetchUrls(requests, time_out_ms_,
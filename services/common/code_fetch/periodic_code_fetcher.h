@@ -27,6 +27,7 @@
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 #include "services/common/code_fetch/code_fetcher_interface.h"
+#include "services/common/code_fetch/code_load_tracker.h"
 #include "src/concurrent/executor.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -34,6 +35,10 @@ namespace privacy_sandbox::bidding_auction_servers {
 // AdTech Code Blob fetching system to update Adtech's GenerateBid(), ScoreAd(),
 // ReportWin() and ReportResult() code through a periodic pull mechanism with an
 // arbitrary endpoint.
+//
+// Once the code is fetched, the next fetches are conditional requests, with an
+// If-Modified-Since header, so that an endpoint whose code did not change
+// answers with a 304 and no body, and the code it sent last is reused.
 class PeriodicCodeFetcher : public CodeFetcherInterface {
  public:
   // url_endpoint: a vector of arbitrary endpoints to fetch code blobs from.
@@ -94,9 +99,16 @@ class PeriodicCodeFetcher : public CodeFetcherInterface {
 
   // Keeps track of the next task to be performed on the executor.
   absl::optional<server_common::TaskId> task_id_;
-  // Keeps track of the last result.value() returned by FetchUrl and callback
-  // function.
-  std::vector<std::string> cb_results_value_;
+  // Keeps track of the last code loaded, so that unchanged code is not loaded
+  // again. Code failing to load is loaded again on the next fetch.
+  CodeLoadTracker load_tracker_;
+  // Code of each endpoint at the last fetch that succeeded for all of them,
+  // reused for the endpoints answering the next fetches with a 304. Empty
+  // until then.
+  std::vector<std::string> last_blobs_;
+  // Start time of that fetch, the endpoints are asked for the code modified
+  // since.
+  absl::Time last_fetch_time_;
 
   // Represents a lock on some_load_success_.
   absl::Mutex some_load_success_mu_;
@@ -16,10 +16,12 @@
 
 #include "services/common/code_fetch/periodic_code_fetcher.h"
 
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
@@ -176,6 +178,118 @@ TEST(PeriodicCodeFetcherTest, LoadsOnlyDifferentHttpFetcherResult) {
   code_fetcher.End();
 }
 
+TEST(PeriodicCodeFetcherTest, LoadsUnchangedCodeAgainAfterFailedLoad) {
+  auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto wrap_code = [](const std::vector<std::string>& adtech_code_blobs) {
+    return "test";
+  };
+
+  EXPECT_CALL(*curl_http_fetcher, FetchUrls)
+      .Times(2)
+      .WillRepeatedly([](const std::vector<HTTPRequest>& requests,
+                         absl::Duration timeout,
+                         absl::AnyInvocable<void(
+                             std::vector<absl::StatusOr<std::string>>)&&>
+                             done_callback) {
+        std::move(done_callback)({"function test(){}"});
+      });
+
+  EXPECT_CALL(*executor, RunAfter)
+      .Times(2)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            closure();
+            return server_common::TaskId();
+          })
+      .WillOnce([](absl::Duration duration, absl::AnyInvocable<void()>) {
+        return server_common::TaskId();
+      });
+
+  EXPECT_CALL(dispatcher, LoadSync)
+      .WillOnce([](std::string_view version, absl::string_view js) {
+        return absl::UnavailableError("Roma is busy");
+      })
+      .WillOnce([](std::string_view version, absl::string_view js) {
+        return absl::OkStatus();
+      });
+
+  PeriodicCodeFetcher code_fetcher(
+      {"code.com"}, absl::Minutes(2), curl_http_fetcher.get(), &dispatcher,
+      executor.get(), absl::Milliseconds(100), wrap_code, kDefaultVerison);
+  auto status = code_fetcher.Start();
+  ASSERT_TRUE(status.ok()) << status;
+  code_fetcher.End();
+}
+
+TEST(PeriodicCodeFetcherTest, ReusesTheLastCodeOnNotModifiedResponses) {
+  auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto wrap_code = [](const std::vector<std::string>& adtech_code_blobs) {
+    return adtech_code_blobs.at(0) + adtech_code_blobs.at(1);
+  };
+
+  auto has_if_modified_since = [](const HTTPRequest& request) {
+    for (const std::string& header : request.headers) {
+      if (absl::StartsWith(header, "If-Modified-Since: ")) {
+        return true;
+      }
+    }
+    return false;
+  };
+  EXPECT_CALL(*curl_http_fetcher, FetchUrls)
+      .WillOnce([&has_if_modified_since](
+                    const std::vector<HTTPRequest>& requests,
+                    absl::Duration timeout,
+                    absl::AnyInvocable<void(
+                        std::vector<absl::StatusOr<std::string>>)&&>
+                        done_callback) {
+        EXPECT_FALSE(has_if_modified_since(requests.at(0)));
+        std::move(done_callback)({"js", "wasm"});
+      })
+      .WillOnce([&has_if_modified_since](
+                    const std::vector<HTTPRequest>& requests,
+                    absl::Duration timeout,
+                    absl::AnyInvocable<void(
+                        std::vector<absl::StatusOr<std::string>>)&&>
+                        done_callback) {
+        EXPECT_TRUE(has_if_modified_since(requests.at(0)));
+        EXPECT_TRUE(has_if_modified_since(requests.at(1)));
+        // The js did not change, the wasm did.
+        std::move(done_callback)({"", "new_wasm"});
+      });
+
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            closure();
+            return server_common::TaskId();
+          })
+      .WillOnce([](absl::Duration duration, absl::AnyInvocable<void()>) {
+        return server_common::TaskId();
+      });
+
+  std::vector<std::string> loaded_code;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .Times(2)
+      .WillRepeatedly(
+          [&loaded_code](std::string_view version, absl::string_view js) {
+            loaded_code.push_back(std::string(js));
+            return absl::OkStatus();
+          });
+
+  PeriodicCodeFetcher code_fetcher(
+      {"js.com", "wasm.com"}, absl::Minutes(2), curl_http_fetcher.get(),
+      &dispatcher, executor.get(), absl::Milliseconds(100), wrap_code,
+      kDefaultVerison);
+  auto status = code_fetcher.Start();
+  ASSERT_TRUE(status.ok()) << status;
+  code_fetcher.End();
+  EXPECT_EQ(loaded_code, (std::vector<std::string>{"jswasm", "jsnew_wasm"}));
+}
+
 TEST(PeriodicCodeFetcherTest, LoadsCodeWithTheCorrectVersion) {
   auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
   MockV8Dispatcher dispatcher;
@@ -0,0 +1,84 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "absl/log/check.h"
+#include "benchmark/benchmark.h"
+#include "services/common/compression/compression_codec.h"
+#include "services/common/test/random.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns a serialized BuyerInput with the given number of interest groups,
+// as sent from the BFE to the bidding service.
+std::string MakeBuyerInputPayload(int num_interest_groups) {
+  BuyerInput buyer_input;
+  for (int i = 0; i < num_interest_groups; ++i) {
+    buyer_input.mutable_interest_groups()->AddAllocated(
+        MakeARandomInterestGroupFromBrowser().release());
+  }
+  return buyer_input.SerializeAsString();
+}
+
+const CompressionCodec& GetCodec(absl::string_view name) {
+  absl::StatusOr<const CompressionCodec*> codec = GetCompressionCodec(name);
+  CHECK_OK(codec);
+  return **codec;
+}
+
+static void BM_Compress(benchmark::State& state, absl::string_view codec_name) {
+  const CompressionCodec& codec = GetCodec(codec_name);
+  const std::string payload = MakeBuyerInputPayload(state.range(0));
+  std::string compressed;
+  for (auto _ : state) {
+    compressed.clear();
+    CHECK_OK(codec.Compress(payload, compressed));
+    benchmark::DoNotOptimize(compressed);
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+  state.counters["ratio"] =
+      static_cast<double>(payload.size()) / compressed.size();
+}
+BENCHMARK_CAPTURE(BM_Compress, gzip, kGzipCodec)->Arg(10)->Arg(100)->Arg(500);
+BENCHMARK_CAPTURE(BM_Compress, deflate, kDeflateCodec)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(500);
+
+static void BM_Decompress(benchmark::State& state,
+                          absl::string_view codec_name) {
+  const CompressionCodec& codec = GetCodec(codec_name);
+  const std::string payload = MakeBuyerInputPayload(state.range(0));
+  std::string compressed;
+  CHECK_OK(codec.Compress(payload, compressed));
+  std::string decompressed;
+  for (auto _ : state) {
+    decompressed.clear();
+    CHECK_OK(codec.Decompress(compressed, decompressed));
+    benchmark::DoNotOptimize(decompressed);
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+BENCHMARK_CAPTURE(BM_Decompress, gzip, kGzipCodec)->Arg(10)->Arg(100)->Arg(500);
+BENCHMARK_CAPTURE(BM_Decompress, deflate, kDeflateCodec)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(500);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
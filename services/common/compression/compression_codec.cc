@@ -0,0 +1,132 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/compression/compression_codec.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/compression/gzip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+class IdentityCodec : public CompressionCodec {
+ public:
+  absl::Status Compress(absl::string_view input,
+                        std::string& output) const override {
+    absl::StrAppend(&output, input);
+    return absl::OkStatus();
+  }
+
+  absl::Status Decompress(absl::string_view input,
+                          std::string& output) const override {
+    absl::StrAppend(&output, input);
+    return absl::OkStatus();
+  }
+};
+
+class GzipCodec : public CompressionCodec {
+ public:
+  absl::Status Compress(absl::string_view input,
+                        std::string& output) const override {
+    return GzipCompress(input, output);
+  }
+
+  absl::Status Decompress(absl::string_view input,
+                          std::string& output) const override {
+    return GzipDecompress(input, output);
+  }
+};
+
+class DeflateCodec : public CompressionCodec {
+ public:
+  explicit DeflateCodec(std::string dictionary)
+      : dictionary_(std::move(dictionary)) {}
+
+  absl::Status Compress(absl::string_view input,
+                        std::string& output) const override {
+    return ZlibCompress(input, dictionary_, output);
+  }
+
+  absl::Status Decompress(absl::string_view input,
+                          std::string& output) const override {
+    return ZlibDecompress(input, dictionary_, output);
+  }
+
+ private:
+  const std::string dictionary_;
+};
+
+class CodecRegistry {
+ public:
+  CodecRegistry() {
+    codecs_.emplace(kIdentityCodec, std::make_unique<IdentityCodec>());
+    codecs_.emplace(kGzipCodec, std::make_unique<GzipCodec>());
+    codecs_.emplace(kDeflateCodec, CreateDeflateCodec(/*dictionary=*/""));
+  }
+
+  absl::Status Register(absl::string_view name,
+                        std::unique_ptr<CompressionCodec> codec)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    if (!codecs_.try_emplace(name, std::move(codec)).second) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Compression codec already registered: ", name));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<const CompressionCodec*> Get(absl::string_view name) const
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::ReaderMutexLock lock(&mu_);
+    auto it = codecs_.find(name);
+    if (it == codecs_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Unknown compression codec: ", name));
+    }
+    return it->second.get();
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  // Codecs are never removed, so pointers to them stay valid.
+  absl::flat_hash_map<std::string, std::unique_ptr<CompressionCodec>> codecs_
+      ABSL_GUARDED_BY(mu_);
+};
+
+CodecRegistry& GetCodecRegistry() {
+  static CodecRegistry* registry = new CodecRegistry();
+  return *registry;
+}
+
+}  // namespace
+
+std::unique_ptr<CompressionCodec> CreateDeflateCodec(std::string dictionary) {
+  return std::make_unique<DeflateCodec>(std::move(dictionary));
+}
+
+absl::Status RegisterCompressionCodec(absl::string_view name,
+                                      std::unique_ptr<CompressionCodec> codec) {
+  return GetCodecRegistry().Register(name, std::move(codec));
+}
+
+absl::StatusOr<const CompressionCodec*> GetCompressionCodec(
+    absl::string_view name) {
+  return GetCodecRegistry().Get(name);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
+#define SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Names of the codecs that are always registered.
+inline constexpr absl::string_view kIdentityCodec = "identity";
+inline constexpr absl::string_view kGzipCodec = "gzip";
+inline constexpr absl::string_view kDeflateCodec = "deflate";
+
+// Compresses and decompresses payloads. Implementations must be thread-safe.
+class CompressionCodec {
+ public:
+  virtual ~CompressionCodec() = default;
+
+  // Appends the compressed input to output. Output is left as it was on
+  // errors.
+  virtual absl::Status Compress(absl::string_view input,
+                                std::string& output) const = 0;
+
+  // Appends the decompressed input to output. Output is left as it was on
+  // errors.
+  virtual absl::Status Decompress(absl::string_view input,
+                                  std::string& output) const = 0;
+};
+
+// Returns a codec compressing with the zlib wrapper and the given preset
+// dictionary, e.g. one trained on samples of the payloads.
+std::unique_ptr<CompressionCodec> CreateDeflateCodec(std::string dictionary);
+
+// Registers codec under name, so that the payloads exchanged between the
+// servers can be compressed with it. The buyer inputs of clients are gzip
+// compressed, unless the client signals the buyer input dictionary codec of
+// the SFE. Fails if a codec is already registered under name.
+absl::Status RegisterCompressionCodec(absl::string_view name,
+                                      std::unique_ptr<CompressionCodec> codec);
+
+// Returns the codec registered under name. kIdentityCodec, kGzipCodec and
+// kDeflateCodec (without a dictionary) are always registered. The codecs live
+// as long as the process.
+absl::StatusOr<const CompressionCodec*> GetCompressionCodec(
+    absl::string_view name);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
@@ -0,0 +1,81 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/compression/compression_codec.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "services/common/compression/gzip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kPayload = "hello hello hello";
+
+TEST(CompressionCodecTest, BuiltInCodecsRoundTrip) {
+  for (absl::string_view name : {kIdentityCodec, kGzipCodec, kDeflateCodec}) {
+    absl::StatusOr<const CompressionCodec*> codec = GetCompressionCodec(name);
+    ASSERT_TRUE(codec.ok()) << codec.status();
+
+    std::string compressed;
+    ASSERT_TRUE((*codec)->Compress(kPayload, compressed).ok()) << name;
+    std::string decompressed;
+    ASSERT_TRUE((*codec)->Decompress(compressed, decompressed).ok()) << name;
+    EXPECT_EQ(decompressed, kPayload) << name;
+  }
+}
+
+TEST(CompressionCodecTest, GzipCodecMatchesClientFacingGzip) {
+  absl::StatusOr<const CompressionCodec*> codec =
+      GetCompressionCodec(kGzipCodec);
+  ASSERT_TRUE(codec.ok()) << codec.status();
+  std::string compressed;
+  ASSERT_TRUE((*codec)->Compress(kPayload, compressed).ok());
+
+  absl::StatusOr<std::string> decompressed = GzipDecompress(compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, kPayload);
+}
+
+TEST(CompressionCodecTest, RegistersCodecs) {
+  ASSERT_TRUE(RegisterCompressionCodec("deflate-dictionary",
+                                       CreateDeflateCodec("hello"))
+                  .ok());
+  absl::StatusOr<const CompressionCodec*> codec =
+      GetCompressionCodec("deflate-dictionary");
+  ASSERT_TRUE(codec.ok()) << codec.status();
+  std::string compressed;
+  ASSERT_TRUE((*codec)->Compress(kPayload, compressed).ok());
+  std::string decompressed;
+  ASSERT_TRUE((*codec)->Decompress(compressed, decompressed).ok());
+  EXPECT_EQ(decompressed, kPayload);
+
+  EXPECT_EQ(RegisterCompressionCodec("deflate-dictionary",
+                                     CreateDeflateCodec("other"))
+                .code(),
+            absl::StatusCode::kAlreadyExists);
+  EXPECT_EQ(
+      RegisterCompressionCodec(kGzipCodec, CreateDeflateCodec("")).code(),
+      absl::StatusCode::kAlreadyExists);
+}
+
+TEST(CompressionCodecTest, FailsOnUnknownCodec) {
+  EXPECT_EQ(GetCompressionCodec("unknown").status().code(),
+            absl::StatusCode::kNotFound);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
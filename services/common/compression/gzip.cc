@@ -16,102 +16,277 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "absl/functional/function_ref.h"
 #include "absl/strings/str_format.h"
+#include "services/common/util/large_buffer_pool.h"
+#include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
 
-absl::StatusOr<std::string> GzipCompress(absl::string_view uncompressed) {
-  z_stream zs;
-  zs.zalloc = Z_NULL;
-  zs.zfree = Z_NULL;
-  zs.opaque = Z_NULL;
-  zs.avail_in = (uInt)uncompressed.size();
-  zs.next_in = (Bytef*)uncompressed.data();
-
-  int deflate_init_status =
-      deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kGzipWindowBits | 16,
-                   kDefaultMemLevel, Z_DEFAULT_STRATEGY);
-  if (deflate_init_status != Z_OK) {
-    return absl::InternalError(
-        absl::StrFormat("Error initializing data for gzip compression (deflate "
-                        "init status: %d)",
-                        deflate_init_status));
+// Size by which the outputs are grown while (de)compressing.
+inline constexpr size_t kOutputChunkSize = 32 * 1024;  // 32 KiB.
+
+// Largest part of the input or output handed to zlib at once, as its sizes
+// are uInt.
+inline constexpr size_t kMaxChunkSize = std::numeric_limits<uInt>::max();
+
+// Compressed inputs from which the decompressed output is written to a buffer
+// of the large buffer pool, if enabled, rather than grown in place.
+inline constexpr size_t kMinLargeBufferInputSize = 256 * 1024;  // 256 KiB.
+
+// Ratio of the first buffer to the compressed input when decompressing into a
+// buffer of the large buffer pool.
+inline constexpr size_t kExpectedCompressionRatio = 4;
+
+// z_stream to deflate with, initialized once per thread and reset for every
+// input instead of allocating and freeing the zlib state on every call.
+template <int kWindowBits>
+class DeflateStream {
+ public:
+  // Returns the stream of the calling thread, ready for a new input.
+  static absl::StatusOr<z_stream*> Get() {
+    thread_local DeflateStream stream;
+    if (stream.init_status_ != Z_OK) {
+      return absl::InternalError(absl::StrFormat(
+          "Error initializing data for gzip compression (deflate init status: "
+          "%d)",
+          stream.init_status_));
+    }
+    if (const int reset_status = deflateReset(&stream.zs_);
+        reset_status != Z_OK) {
+      return absl::InternalError(absl::StrFormat(
+          "Error resetting compression data stream (deflate reset status: %d)",
+          reset_status));
+    }
+    return &stream.zs_;
   }
 
-  // Determine the upper bound on the size of the compressed data.
-  // TODO(b/279967613): Investigate if deflate() should be done in chunks like
-  //  inflate(). Would help avoid this cpplint warning.
-  const int kPartitionSizeBound = deflateBound(&zs, uncompressed.size());
-  char partition_output_buffer[kPartitionSizeBound];
+  ~DeflateStream() {
+    if (init_status_ == Z_OK) {
+      deflateEnd(&zs_);
+    }
+  }
 
-  zs.avail_out = (uInt)kPartitionSizeBound;
-  // We'll manually write the size of the compressed data manually after
-  // compressing the data.
-  zs.next_out = (Bytef*)&partition_output_buffer;
+ private:
+  DeflateStream()
+      : init_status_(deflateInit2(&zs_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                  kWindowBits, kDefaultMemLevel,
+                                  Z_DEFAULT_STRATEGY)) {}
 
-  const int deflate_status = deflate(&zs, Z_FINISH);
-  if (deflate_status != Z_STREAM_END) {
-    deflateEnd(&zs);
-    return absl::InternalError(absl::StrFormat(
-        "Error compressing data using gzip (deflate status: %d)",
-        deflate_status));
+  z_stream zs_ = {};
+  const int init_status_;
+};
+
+// As DeflateStream, to inflate with.
+template <int kWindowBits>
+class InflateStream {
+ public:
+  static absl::StatusOr<z_stream*> Get() {
+    thread_local InflateStream stream;
+    if (stream.init_status_ != Z_OK) {
+      return absl::InternalError(
+          absl::StrFormat("Error during gzip decompression initialization: "
+                          "(inflate init status: %d)",
+                          stream.init_status_));
+    }
+    if (const int reset_status = inflateReset(&stream.zs_);
+        reset_status != Z_OK) {
+      return absl::InternalError(absl::StrFormat(
+          "Error resetting compression data stream (inflate reset status: %d)",
+          reset_status));
+    }
+    return &stream.zs_;
   }
 
-  // Free all memory held by the z_stream object.
-  const int deflate_end_status = deflateEnd(&zs);
-  if (deflate_end_status != Z_OK) {
-    return absl::InternalError(absl::StrFormat(
-        "Error closing compression data stream (deflate end status: %d)",
-        deflate_end_status));
+  ~InflateStream() {
+    if (init_status_ == Z_OK) {
+      inflateEnd(&zs_);
+    }
   }
 
-  return std::string{partition_output_buffer, zs.total_out};
-}
+ private:
+  InflateStream() : init_status_(inflateInit2(&zs_, kWindowBits)) {}
 
-absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed) {
-  z_stream zs;
-  memset(&zs, 0, sizeof(zs));
-  zs.next_in = (Bytef*)compressed.data();
-  zs.avail_in = compressed.size();
-
-  const int inflate_init_status = inflateInit2(&zs, kGzipWindowBits | 16);
-  if (inflate_init_status != Z_OK) {
-    return absl::InternalError(
-        absl::StrFormat("Error during gzip decompression initialization: "
-                        "(inflate init status: %d)",
-                        inflate_init_status));
+  z_stream zs_ = {};
+  const int init_status_;
+};
+
+// Hands zs the next chunk of input once it consumed the previous one.
+void FeedInput(z_stream& zs, absl::string_view& input) {
+  if (zs.avail_in == 0 && !input.empty()) {
+    const size_t input_chunk_size = std::min(input.size(), kMaxChunkSize);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    zs.avail_in = static_cast<uInt>(input_chunk_size);
+    input.remove_prefix(input_chunk_size);
   }
+}
 
-  char output_buffer[32768];  // 32 KiB chunks.
-  std::string decompressed;
+// Points the output of zs at the unwritten part of buffer.
+void SetOutput(z_stream& zs, const LargeBuffer& buffer, size_t written) {
+  zs.next_out = reinterpret_cast<Bytef*>(buffer.data() + written);
+  zs.avail_out =
+      static_cast<uInt>(std::min(buffer.size() - written, kMaxChunkSize));
+}
 
-  int inflate_status;
+// Feeds input to zs and appends what comes out of it to output, growing output
+// a chunk at a time, for as long as process returns Z_OK. process is passed
+// whether the whole input was fed. Returns the last status of process. Output
+// is left as it was unless the stream ended.
+int RunStream(z_stream& zs, absl::string_view input, std::string& output,
+              absl::FunctionRef<int(z_stream&, bool)> process) {
+  const size_t initial_size = output.size();
+  zs.avail_in = 0;
+  zs.avail_out = 0;
+  int status;
   do {
-    zs.next_out = reinterpret_cast<Bytef*>(output_buffer);
-    zs.avail_out = sizeof(output_buffer);
+    FeedInput(zs, input);
+    if (zs.avail_out == 0) {
+      const size_t size = output.size();
+      output.resize(size + kOutputChunkSize);
+      zs.next_out = reinterpret_cast<Bytef*>(&output[size]);
+      zs.avail_out = kOutputChunkSize;
+    }
+    status = process(zs, input.empty());
+  } while (status == Z_OK);
 
-    inflate_status = inflate(&zs, Z_NO_FLUSH);
-    // Copy the decompressed output from the buffer to our result string.
-    if (decompressed.size() < zs.total_out) {
-      decompressed.append(output_buffer, zs.total_out - decompressed.size());
+  if (status == Z_STREAM_END) {
+    // Drops what is left of the last chunk.
+    output.resize(output.size() - zs.avail_out);
+  } else {
+    output.resize(initial_size);
+  }
+  return status;
+}
+
+// As RunStream, but writes to a buffer of the large buffer pool, moved to one
+// twice as large when full, and appends it to output once the stream ended,
+// so that outputs of MBs are neither regrown nor faulted in chunk by chunk.
+// Returns Z_MEM_ERROR if no buffer could be acquired.
+int RunStreamInLargeBuffer(z_stream& zs, absl::string_view input,
+                           std::string& output,
+                           absl::FunctionRef<int(z_stream&, bool)> process) {
+  LargeBufferPool& pool = LargeBufferPool::Get();
+  absl::StatusOr<LargeBuffer> buffer =
+      pool.Acquire(input.size() * kExpectedCompressionRatio);
+  if (!buffer.ok()) {
+    return Z_MEM_ERROR;
+  }
+  zs.avail_in = 0;
+  size_t written = 0;
+  SetOutput(zs, *buffer, written);
+  int status;
+  do {
+    FeedInput(zs, input);
+    written = reinterpret_cast<char*>(zs.next_out) - buffer->data();
+    if (zs.avail_out == 0) {
+      if (written == buffer->size()) {
+        absl::StatusOr<LargeBuffer> larger = pool.Acquire(2 * buffer->size());
+        if (!larger.ok()) {
+          return Z_MEM_ERROR;
+        }
+        std::memcpy(larger->data(), buffer->data(), written);
+        *buffer = *std::move(larger);
+      }
+      SetOutput(zs, *buffer, written);
     }
-  } while (inflate_status == Z_OK);
+    status = process(zs, input.empty());
+  } while (status == Z_OK);
+
+  if (status == Z_STREAM_END) {
+    written = reinterpret_cast<char*>(zs.next_out) - buffer->data();
+    output.append(buffer->data(), written);
+  }
+  return status;
+}
 
+absl::Status Compress(z_stream& zs, absl::string_view uncompressed,
+                      std::string& output) {
+  const int deflate_status =
+      RunStream(zs, uncompressed, output, [](z_stream& zs, bool fed_all) {
+        return deflate(&zs, fed_all ? Z_FINISH : Z_NO_FLUSH);
+      });
+  if (deflate_status != Z_STREAM_END) {
+    return absl::InternalError(absl::StrFormat(
+        "Error compressing data using gzip (deflate status: %d)",
+        deflate_status));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Decompress(z_stream& zs, absl::string_view compressed,
+                        absl::string_view dictionary, std::string& output) {
+  auto process = [dictionary](z_stream& zs, bool fed_all) {
+    const int status = inflate(&zs, Z_NO_FLUSH);
+    if (status == Z_NEED_DICT && !dictionary.empty()) {
+      return inflateSetDictionary(
+          &zs, reinterpret_cast<const Bytef*>(dictionary.data()),
+          static_cast<uInt>(dictionary.size()));
+    }
+    return status;
+  };
+  const int inflate_status =
+      compressed.size() >= kMinLargeBufferInputSize &&
+              LargeBufferPool::Get().enabled()
+          ? RunStreamInLargeBuffer(zs, compressed, output, process)
+          : RunStream(zs, compressed, output, process);
   if (inflate_status != Z_STREAM_END) {
-    inflateEnd(&zs);
     return absl::DataLossError(absl::StrFormat(
         "Exception during gzip decompression: (inflate status: %d)",
         inflate_status));
   }
+  return absl::OkStatus();
+}
 
-  const int inflate_end_status = inflateEnd(&zs);
-  if (inflate_end_status != Z_OK) {
-    return absl::InternalError(absl::StrFormat(
-        "Error closing compression data stream (inflate end status: %d(",
-        inflate_end_status));
-  }
+}  // namespace
 
+absl::Status GzipCompress(absl::string_view uncompressed, std::string& output) {
+  PS_ASSIGN_OR_RETURN(z_stream * zs, DeflateStream<kGzipWindowBits>::Get());
+  return Compress(*zs, uncompressed, output);
+}
+
+absl::Status GzipDecompress(absl::string_view compressed, std::string& output) {
+  PS_ASSIGN_OR_RETURN(z_stream * zs, InflateStream<kGzipWindowBits>::Get());
+  return Decompress(*zs, compressed, /*dictionary=*/"", output);
+}
+
+absl::StatusOr<std::string> GzipCompress(absl::string_view uncompressed) {
+  std::string compressed;
+  PS_RETURN_IF_ERROR(GzipCompress(uncompressed, compressed));
+  return compressed;
+}
+
+absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed) {
+  std::string decompressed;
+  PS_RETURN_IF_ERROR(GzipDecompress(compressed, decompressed));
   return decompressed;
 }
 
+absl::Status ZlibCompress(absl::string_view uncompressed,
+                          absl::string_view dictionary, std::string& output) {
+  PS_ASSIGN_OR_RETURN(z_stream * zs, DeflateStream<kZlibWindowBits>::Get());
+  if (!dictionary.empty()) {
+    if (const int dictionary_status = deflateSetDictionary(
+            zs, reinterpret_cast<const Bytef*>(dictionary.data()),
+            static_cast<uInt>(dictionary.size()));
+        dictionary_status != Z_OK) {
+      return absl::InternalError(absl::StrFormat(
+          "Error setting the compression dictionary (deflate dictionary "
+          "status: %d)",
+          dictionary_status));
+    }
+  }
+  return Compress(*zs, uncompressed, output);
+}
+
+absl::Status ZlibDecompress(absl::string_view compressed,
+                            absl::string_view dictionary, std::string& output) {
+  PS_ASSIGN_OR_RETURN(z_stream * zs, InflateStream<kZlibWindowBits>::Get());
+  return Decompress(*zs, compressed, dictionary, output);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -19,6 +19,7 @@
 
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 
@@ -31,12 +32,30 @@ inline constexpr int kGzipWindowBits = 15 | 16;
 // Default to 8 as per zlib.h's documentation.
 inline constexpr int kDefaultMemLevel = 8;
 
+// Window bits of the zlib wrapper, used between the servers.
+inline constexpr int kZlibWindowBits = 15;
+
 // Compresses a string using gzip.
 absl::StatusOr<std::string> GzipCompress(absl::string_view decompressed);
 
 // Decompresses a gzip compressed string.
 absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed);
 
+// As above, but appends to output, so that callers can reuse a buffer. The
+// output is grown in chunks as the (de)compression goes, and is left as it was
+// on errors. The zlib state is kept per thread and reused between calls.
+absl::Status GzipCompress(absl::string_view decompressed, std::string& output);
+absl::Status GzipDecompress(absl::string_view compressed, std::string& output);
+
+// Compresses with the zlib wrapper (RFC 1950) and the given preset dictionary,
+// which can be empty. Payloads made of similar strings (e.g. protos of
+// interest groups) compress better with a dictionary of these strings. The
+// same dictionary must be used to decompress.
+absl::Status ZlibCompress(absl::string_view decompressed,
+                          absl::string_view dictionary, std::string& output);
+absl::Status ZlibDecompress(absl::string_view compressed,
+                            absl::string_view dictionary, std::string& output);
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_CLIENTS_COMPRESSION_GZIP_H_
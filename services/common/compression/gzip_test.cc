@@ -15,6 +15,7 @@
 #include "services/common/compression/gzip.h"
 
 #include <algorithm>
+#include <random>
 #include <string>
 #include <string_view>
 
@@ -22,7 +23,10 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
+#include "services/common/util/large_buffer_pool.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
@@ -90,5 +94,86 @@ TEST(GzipCompressionTests, DecompressWithBoost) {
   ASSERT_EQ(payload, boost_decompress);
 }
 
+TEST(GzipCompressionTests, CompressDecompress_LargerThanAnOutputChunk) {
+  std::string payload;
+  for (int i = 0; payload.size() < 1 << 20; ++i) {
+    absl::StrAppend(&payload, i, ",");
+  }
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  absl::StatusOr<std::string> decompressed = GzipDecompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(payload, *decompressed);
+  EXPECT_EQ(payload, BoostDecompress(*compressed));
+}
+
+TEST(GzipCompressionTests, DecompressesLargeInputsIntoPooledBuffers) {
+  // Hardly compressible bytes, for a compressed input large enough to use the
+  // pool, followed by zeros, for an output outgrowing the first buffer.
+  std::string payload(300 * 1024, '\0');
+  std::mt19937 random;
+  std::generate(payload.begin(), payload.end(), [&random]() {
+    return static_cast<char>(random());
+  });
+  payload.resize(20 * 1024 * 1024);
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  LargeBufferPool::Configure({.max_pooled_bytes = 64 * 1024 * 1024});
+  for (int i = 0; i < 2; ++i) {
+    std::string decompressed = "prefix";
+    ASSERT_TRUE(GzipDecompress(*compressed, decompressed).ok());
+    EXPECT_EQ(decompressed, absl::StrCat("prefix", payload));
+  }
+  EXPECT_GT(LargeBufferPool::Get().pooled_bytes(), 0);
+  LargeBufferPool::Configure({});
+}
+
+TEST(GzipCompressionTests, AppendsToOutput) {
+  std::string output = "prefix";
+  ASSERT_TRUE(GzipCompress("hello", output).ok());
+  ASSERT_TRUE(absl::StartsWith(output, "prefix"));
+
+  std::string decompressed = "prefix";
+  ASSERT_TRUE(GzipDecompress(output.substr(6), decompressed).ok());
+  EXPECT_EQ(decompressed, "prefixhello");
+}
+
+TEST(GzipCompressionTests, ReusesStreamAfterError) {
+  absl::StatusOr<std::string> compressed = GzipCompress("hello");
+  ASSERT_TRUE(compressed.ok());
+
+  std::string output = "prefix";
+  absl::Status status =
+      GzipDecompress(compressed->substr(0, compressed->size() / 2), output);
+  EXPECT_EQ(status.code(), absl::StatusCode::kDataLoss);
+  EXPECT_EQ(output, "prefix");
+
+  absl::StatusOr<std::string> decompressed = GzipDecompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, "hello");
+}
+
+TEST(ZlibCompressionTests, CompressDecompressWithDictionary) {
+  constexpr absl::string_view kDictionary = "interestGroupNames biddingSignals";
+  constexpr absl::string_view kPayload =
+      "interestGroupNames biddingSignals interestGroupNames";
+  std::string compressed;
+  ASSERT_TRUE(ZlibCompress(kPayload, kDictionary, compressed).ok());
+  std::string compressed_without_dictionary;
+  ASSERT_TRUE(ZlibCompress(kPayload, "", compressed_without_dictionary).ok());
+  EXPECT_LT(compressed.size(), compressed_without_dictionary.size());
+
+  std::string decompressed;
+  ASSERT_TRUE(ZlibDecompress(compressed, kDictionary, decompressed).ok());
+  EXPECT_EQ(decompressed, kPayload);
+
+  std::string output;
+  EXPECT_FALSE(ZlibDecompress(compressed, "", output).ok());
+  EXPECT_FALSE(ZlibDecompress(compressed, "wrong dictionary", output).ok());
+  EXPECT_TRUE(output.empty());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
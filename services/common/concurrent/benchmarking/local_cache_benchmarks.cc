@@ -0,0 +1,94 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the contention of ShardedLocalCache look-ups and inserts from
+// concurrent threads, with a single shard (i.e. a single lock) and with the
+// default number of shards.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "services/common/concurrent/sharded_local_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using Cache = ShardedLocalCache<std::string, std::string>;
+
+constexpr int kNumKeys = 4096;
+
+const std::vector<std::string>& Keys() {
+  static const std::vector<std::string>* keys = [] {
+    auto* keys = new std::vector<std::string>();
+    keys->reserve(kNumKeys);
+    for (int i = 0; i < kNumKeys; ++i) {
+      keys->push_back(absl::StrCat("https://ad.example/render/", i));
+    }
+    return keys;
+  }();
+  return *keys;
+}
+
+// Returns a cache holding half of the keys, shared by the benchmark threads.
+Cache& GetCache(int num_shards) {
+  auto make_cache = [](int num_shards) {
+    Cache::Options options;
+    options.num_shards = num_shards;
+    options.max_weight = kNumKeys;
+    auto* cache = new Cache(std::move(options));
+    for (int i = 0; i < kNumKeys; i += 2) {
+      cache->Insert(Keys()[i], std::make_shared<std::string>(Keys()[i]));
+    }
+    return cache;
+  };
+  static Cache* single_shard_cache = make_cache(1);
+  static Cache* sharded_cache = make_cache(16);
+  return num_shards == 1 ? *single_shard_cache : *sharded_cache;
+}
+
+static void BM_LookUp(benchmark::State& state) {
+  Cache& cache = GetCache(state.range(0));
+  int i = state.thread_index() * 997;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache.LookUp(Keys()[i % kNumKeys]));
+    ++i;
+  }
+}
+BENCHMARK(BM_LookUp)->Arg(1)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+
+// One insert for every 8 look-ups.
+static void BM_LookUpAndInsert(benchmark::State& state) {
+  Cache& cache = GetCache(state.range(0));
+  int i = state.thread_index() * 997;
+  for (auto _ : state) {
+    const std::string& key = Keys()[i % kNumKeys];
+    if (i % 8 == 0) {
+      cache.Insert(key, std::make_shared<std::string>(key));
+    } else {
+      benchmark::DoNotOptimize(cache.LookUp(key));
+    }
+    ++i;
+  }
+}
+BENCHMARK(BM_LookUpAndInsert)
+    ->Arg(1)
+    ->Arg(16)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
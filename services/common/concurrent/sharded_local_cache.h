@@ -0,0 +1,289 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_COMMON_CONCURRENT_SHARDED_LOCAL_CACHE_H_
+#define SERVICES_COMMON_CONCURRENT_SHARDED_LOCAL_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/hash/hash.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/concurrent/local_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Called with the loaded value, or the error of the load.
+template <class Value>
+using LocalCacheLoadCallback =
+    absl::AnyInvocable<void(absl::StatusOr<std::shared_ptr<Value>>) &&>;
+
+template <class Key, class Value>
+struct ShardedLocalCacheOptions {
+  // Number of independently locked shards. More shards reduce contention
+  // between threads accessing different keys.
+  int num_shards = 16;
+  // Max total weight of the cached values, split evenly across the shards.
+  int64_t max_weight = 1024;
+  // Time after insertion after which a value is no longer returned.
+  absl::Duration ttl = absl::InfiniteDuration();
+  // Returns the weight of a value, e.g. its size in bytes. Every value
+  // weighs 1 if not set.
+  absl::AnyInvocable<int64_t(const Key&, const Value&) const> weigher;
+  // Loads the value of a key missing from the cache and calls the callback
+  // with it, possibly asynchronously. Required by GetOrLoad.
+  absl::AnyInvocable<void(const Key&, LocalCacheLoadCallback<Value>) const>
+      loader;
+  // Returns the current time. Overridable for tests.
+  absl::AnyInvocable<absl::Time() const> now = [] { return absl::Now(); };
+};
+
+// This class provides a local (in-memory), thread-safe cache that can be
+// updated after construction. Keys are spread over shards, each guarded by
+// its own reader-writer lock, so look-ups only share a lock with writes to
+// the same shard. Each shard evicts with the CLOCK algorithm: a look-up marks
+// its entry as referenced, and an insertion over capacity sweeps the entries,
+// clearing the marks and evicting the first unreferenced entry, until the new
+// value fits.
+//
+// Concurrent GetOrLoad calls for a key missing from the cache share a single
+// call to the loader. Load errors are not cached.
+template <class Key, class Value>
+class ShardedLocalCache : public LocalCache<Key, std::shared_ptr<Value>> {
+ public:
+  using Options = ShardedLocalCacheOptions<Key, Value>;
+
+  explicit ShardedLocalCache(Options options)
+      : options_(std::move(options)),
+        max_shard_weight_(options_.max_weight /
+                          std::max(options_.num_shards, 1)),
+        shards_(std::max(options_.num_shards, 1)) {}
+  virtual ~ShardedLocalCache() = default;
+
+  // ShardedLocalCache is neither copyable nor movable.
+  ShardedLocalCache(const ShardedLocalCache&) = delete;
+  ShardedLocalCache& operator=(const ShardedLocalCache&) = delete;
+
+  // Looks up and returns a shared_ptr to the Value if it is cached and not
+  // expired, otherwise returns an empty shared_ptr.
+  std::shared_ptr<Value> LookUp(Key key) override {
+    Shard& shard = GetShard(key);
+    const absl::Time now = options_.now();
+    absl::ReaderMutexLock lock(&shard.mu);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      return nullptr;
+    }
+    Slot& slot = shard.slots[it->second];
+    if (slot.expiry <= now) {
+      return nullptr;
+    }
+    slot.referenced.store(true, std::memory_order_relaxed);
+    return slot.value;
+  }
+
+  // Caches the value of the key, replacing any previous value. Values heavier
+  // than a shard are not cached.
+  void Insert(const Key& key, std::shared_ptr<Value> value) {
+    Shard& shard = GetShard(key);
+    const int64_t weight = Weigh(key, *value);
+    const absl::Time expiry = options_.now() + options_.ttl;
+    absl::MutexLock lock(&shard.mu);
+    InsertLocked(shard, key, std::move(value), weight, expiry);
+  }
+
+  // Removes the key from the cache.
+  void Erase(const Key& key) {
+    Shard& shard = GetShard(key);
+    absl::MutexLock lock(&shard.mu);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+      EvictLocked(shard, it->second);
+    }
+  }
+
+  // Calls `on_done` with the cached value of the key, or loads the value with
+  // the loader of the options and caches it. `on_done` is called inline on
+  // a hit, and by the thread completing the load otherwise.
+  void GetOrLoad(const Key& key, LocalCacheLoadCallback<Value> on_done) {
+    if (std::shared_ptr<Value> value = LookUp(key)) {
+      std::move(on_done)(std::move(value));
+      return;
+    }
+    Shard& shard = GetShard(key);
+    {
+      absl::MutexLock lock(&shard.mu);
+      auto [it, inserted] = shard.pending_loads.try_emplace(key);
+      it->second.push_back(std::move(on_done));
+      if (!inserted) {
+        return;
+      }
+    }
+    options_.loader(key, [this, key](absl::StatusOr<std::shared_ptr<Value>>
+                                         value) mutable {
+      OnLoadDone(key, std::move(value));
+    });
+  }
+
+  // Returns the number of cached values, including expired ones not evicted
+  // yet.
+  int size() const {
+    int size = 0;
+    for (const Shard& shard : shards_) {
+      absl::ReaderMutexLock lock(&shard.mu);
+      size += shard.index.size();
+    }
+    return size;
+  }
+
+  // Returns the total weight of the cached values.
+  int64_t weight() const {
+    int64_t weight = 0;
+    for (const Shard& shard : shards_) {
+      absl::ReaderMutexLock lock(&shard.mu);
+      weight += shard.weight;
+    }
+    return weight;
+  }
+
+ private:
+  struct Slot {
+    Key key;
+    std::shared_ptr<Value> value;
+    int64_t weight = 0;
+    absl::Time expiry;
+    // Set by look-ups under a reader lock, cleared by the clock hand.
+    std::atomic<bool> referenced = false;
+    bool occupied = false;
+  };
+
+  struct Shard {
+    mutable absl::Mutex mu;
+    // Slots are never removed, so that indices stay valid, and are reused
+    // through the free list.
+    std::deque<Slot> slots ABSL_GUARDED_BY(mu);
+    std::vector<int> free_slots ABSL_GUARDED_BY(mu);
+    absl::flat_hash_map<Key, int> index ABSL_GUARDED_BY(mu);
+    int hand ABSL_GUARDED_BY(mu) = 0;
+    int64_t weight ABSL_GUARDED_BY(mu) = 0;
+    absl::flat_hash_map<Key, std::vector<LocalCacheLoadCallback<Value>>>
+        pending_loads ABSL_GUARDED_BY(mu);
+  };
+
+  Shard& GetShard(const Key& key) {
+    // Uses the high bits of the hash, since the maps of the shards index
+    // with the low bits.
+    const uint64_t hash = absl::Hash<Key>{}(key);
+    return shards_[(hash >> 32) % shards_.size()];
+  }
+
+  int64_t Weigh(const Key& key, const Value& value) const {
+    return options_.weigher ? options_.weigher(key, value) : 1;
+  }
+
+  void InsertLocked(Shard& shard, const Key& key, std::shared_ptr<Value> value,
+                    int64_t weight, absl::Time expiry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+      EvictLocked(shard, it->second);
+    }
+    if (weight > max_shard_weight_) {
+      return;
+    }
+    while (shard.weight + weight > max_shard_weight_) {
+      AdvanceHandLocked(shard);
+    }
+    int index;
+    if (shard.free_slots.empty()) {
+      index = shard.slots.size();
+      shard.slots.emplace_back();
+    } else {
+      index = shard.free_slots.back();
+      shard.free_slots.pop_back();
+    }
+    Slot& slot = shard.slots[index];
+    slot.key = key;
+    slot.value = std::move(value);
+    slot.weight = weight;
+    slot.expiry = expiry;
+    slot.referenced.store(false, std::memory_order_relaxed);
+    slot.occupied = true;
+    shard.weight += weight;
+    shard.index.emplace(key, index);
+  }
+
+  // Moves the clock hand by one slot, evicting the slot if it is expired or
+  // was not referenced since the last sweep.
+  void AdvanceHandLocked(Shard& shard) ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    Slot& slot = shard.slots[shard.hand];
+    if (slot.occupied &&
+        (!slot.referenced.exchange(false, std::memory_order_relaxed) ||
+         slot.expiry <= options_.now())) {
+      EvictLocked(shard, shard.hand);
+    }
+    shard.hand = (shard.hand + 1) % shard.slots.size();
+  }
+
+  void EvictLocked(Shard& shard, int index)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    Slot& slot = shard.slots[index];
+    shard.index.erase(slot.key);
+    shard.weight -= slot.weight;
+    slot.value.reset();
+    slot.occupied = false;
+    shard.free_slots.push_back(index);
+  }
+
+  void OnLoadDone(const Key& key, absl::StatusOr<std::shared_ptr<Value>> value) {
+    Shard& shard = GetShard(key);
+    int64_t weight = 0;
+    absl::Time expiry;
+    if (value.ok() && *value != nullptr) {
+      weight = Weigh(key, **value);
+      expiry = options_.now() + options_.ttl;
+    }
+    std::vector<LocalCacheLoadCallback<Value>> callbacks;
+    {
+      absl::MutexLock lock(&shard.mu);
+      if (value.ok() && *value != nullptr) {
+        InsertLocked(shard, key, *value, weight, expiry);
+      }
+      if (auto it = shard.pending_loads.find(key);
+          it != shard.pending_loads.end()) {
+        callbacks = std::move(it->second);
+        shard.pending_loads.erase(it);
+      }
+    }
+    for (LocalCacheLoadCallback<Value>& callback : callbacks) {
+      std::move(callback)(value);
+    }
+  }
+
+  const Options options_;
+  const int64_t max_shard_weight_;
+  std::vector<Shard> shards_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CONCURRENT_SHARDED_LOCAL_CACHE_H_
@@ -0,0 +1,222 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/concurrent/sharded_local_cache.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using Cache = ShardedLocalCache<std::string, std::string>;
+
+Cache::Options SingleShardOptions(int64_t max_weight) {
+  Cache::Options options;
+  options.num_shards = 1;
+  options.max_weight = max_weight;
+  return options;
+}
+
+TEST(ShardedLocalCacheTest, LookUpReturnsNullPtrIfKeyNotFound) {
+  Cache cache(Cache::Options{});
+
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+}
+
+TEST(ShardedLocalCacheTest, LookUpReturnsInsertedValue) {
+  Cache cache(Cache::Options{});
+  auto value = std::make_shared<std::string>("value");
+
+  cache.Insert("key", value);
+
+  EXPECT_EQ(cache.LookUp("key"), value);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(ShardedLocalCacheTest, InsertReplacesValue) {
+  Cache cache(Cache::Options{});
+  auto value = std::make_shared<std::string>("new");
+
+  cache.Insert("key", std::make_shared<std::string>("old"));
+  cache.Insert("key", value);
+
+  EXPECT_EQ(cache.LookUp("key"), value);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(ShardedLocalCacheTest, EraseRemovesValue) {
+  Cache cache(Cache::Options{});
+
+  cache.Insert("key", std::make_shared<std::string>("value"));
+  cache.Erase("key");
+
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ShardedLocalCacheTest, ExpiresValuesAfterTtl) {
+  absl::Time now = absl::Now();
+  Cache::Options options;
+  options.ttl = absl::Minutes(1);
+  options.now = [&now] { return now; };
+  Cache cache(std::move(options));
+
+  cache.Insert("key", std::make_shared<std::string>("value"));
+  now += absl::Seconds(59);
+  EXPECT_NE(cache.LookUp("key"), nullptr);
+  now += absl::Seconds(1);
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+}
+
+TEST(ShardedLocalCacheTest, EvictsUnreferencedValuesFirst) {
+  Cache cache(SingleShardOptions(/*max_weight=*/2));
+
+  cache.Insert("a", std::make_shared<std::string>("a"));
+  cache.Insert("b", std::make_shared<std::string>("b"));
+  cache.LookUp("a");
+  cache.Insert("c", std::make_shared<std::string>("c"));
+
+  EXPECT_NE(cache.LookUp("a"), nullptr);
+  EXPECT_EQ(cache.LookUp("b"), nullptr);
+  EXPECT_NE(cache.LookUp("c"), nullptr);
+}
+
+TEST(ShardedLocalCacheTest, BoundsTotalWeight) {
+  Cache::Options options = SingleShardOptions(/*max_weight=*/10);
+  options.weigher = [](const std::string& key, const std::string& value) {
+    return static_cast<int64_t>(value.size());
+  };
+  Cache cache(std::move(options));
+
+  for (int i = 0; i < 10; ++i) {
+    cache.Insert(std::to_string(i), std::make_shared<std::string>("abc"));
+    EXPECT_LE(cache.weight(), 10);
+  }
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_EQ(cache.weight(), 9);
+}
+
+TEST(ShardedLocalCacheTest, DoesNotCacheValuesHeavierThanShard) {
+  Cache::Options options = SingleShardOptions(/*max_weight=*/2);
+  options.weigher = [](const std::string& key, const std::string& value) {
+    return static_cast<int64_t>(value.size());
+  };
+  Cache cache(std::move(options));
+
+  cache.Insert("key", std::make_shared<std::string>("abc"));
+
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+  EXPECT_EQ(cache.weight(), 0);
+}
+
+TEST(ShardedLocalCacheTest, GetOrLoadCoalescesConcurrentLoads) {
+  std::vector<LocalCacheLoadCallback<std::string>> pending_loads;
+  Cache::Options options;
+  options.loader = [&pending_loads](
+                       const std::string& key,
+                       LocalCacheLoadCallback<std::string> on_done) {
+    pending_loads.push_back(std::move(on_done));
+  };
+  Cache cache(std::move(options));
+
+  int num_done = 0;
+  for (int i = 0; i < 3; ++i) {
+    cache.GetOrLoad(
+        "key", [&num_done](absl::StatusOr<std::shared_ptr<std::string>> value) {
+          ASSERT_TRUE(value.ok());
+          EXPECT_EQ(**value, "value");
+          ++num_done;
+        });
+  }
+  ASSERT_EQ(pending_loads.size(), 1);
+  std::move(pending_loads[0])(std::make_shared<std::string>("value"));
+
+  EXPECT_EQ(num_done, 3);
+  EXPECT_EQ(*cache.LookUp("key"), "value");
+}
+
+TEST(ShardedLocalCacheTest, GetOrLoadReturnsCachedValue) {
+  Cache::Options options;
+  options.loader = [](const std::string& key,
+                      LocalCacheLoadCallback<std::string> on_done) {
+    FAIL() << "Unexpected load";
+  };
+  Cache cache(std::move(options));
+  cache.Insert("key", std::make_shared<std::string>("value"));
+
+  bool done = false;
+  cache.GetOrLoad(
+      "key", [&done](absl::StatusOr<std::shared_ptr<std::string>> value) {
+        ASSERT_TRUE(value.ok());
+        EXPECT_EQ(**value, "value");
+        done = true;
+      });
+
+  EXPECT_TRUE(done);
+}
+
+TEST(ShardedLocalCacheTest, GetOrLoadDoesNotCacheErrors) {
+  int num_loads = 0;
+  Cache::Options options;
+  options.loader = [&num_loads](const std::string& key,
+                                LocalCacheLoadCallback<std::string> on_done) {
+    ++num_loads;
+    std::move(on_done)(absl::UnavailableError("unavailable"));
+  };
+  Cache cache(std::move(options));
+
+  for (int i = 0; i < 2; ++i) {
+    cache.GetOrLoad("key",
+                    [](absl::StatusOr<std::shared_ptr<std::string>> value) {
+                      EXPECT_FALSE(value.ok());
+                    });
+  }
+
+  EXPECT_EQ(num_loads, 2);
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(ShardedLocalCacheTest, SupportsConcurrentInsertsAndLookUps) {
+  Cache::Options options;
+  options.max_weight = 64;
+  Cache cache(std::move(options));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t]() {
+      for (int i = 0; i < 1000; ++i) {
+        const std::string key = std::to_string((t * 1000 + i) % 128);
+        if (std::shared_ptr<std::string> value = cache.LookUp(key)) {
+          EXPECT_EQ(*value, key);
+        } else {
+          cache.Insert(key, std::make_shared<std::string>(key));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_LE(cache.weight(), 64);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
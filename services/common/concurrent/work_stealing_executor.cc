@@ -0,0 +1,317 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/concurrent/work_stealing_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Upper bounds of the latency buckets, in microseconds. The last bucket has
+// no upper bound.
+inline constexpr std::array<int64_t, 14> kLatencyBucketBoundsUs = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 50000};
+
+inline constexpr const char* kPriorityLabels[] = {"high", "normal", "low"};
+
+// Tasks of all instances started since the last GetTaskQueueLatencyMs call,
+// per priority class and bucket.
+std::array<std::array<std::atomic<int64_t>, kLatencyBucketBoundsUs.size() + 1>,
+           std::size(kPriorityLabels)>
+    latency_buckets = {};
+
+// The worker running on this thread, if any, to tell tasks scheduled by tasks
+// apart.
+thread_local const void* current_executor = nullptr;
+thread_local void* current_worker = nullptr;
+
+void RecordLatency(TaskPriority priority, absl::Duration latency) {
+  const int64_t latency_us = absl::ToInt64Microseconds(latency);
+  size_t bucket = 0;
+  while (bucket < kLatencyBucketBoundsUs.size() &&
+         latency_us > kLatencyBucketBoundsUs[bucket]) {
+    ++bucket;
+  }
+  latency_buckets[static_cast<int>(priority)][bucket].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(WorkStealingExecutorOptions options)
+    : options_(std::move(options)) {
+  int num_workers = options_.num_workers;
+  if (num_workers <= 0) {
+    num_workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Workers steal from each other, so all of them exist before any starts.
+  for (auto& worker : workers_) {
+    worker->thread = std::thread([this, &worker = *worker]() {
+      current_executor = this;
+      current_worker = &worker;
+      WorkerLoop(worker);
+    });
+  }
+  timer_thread_ = std::thread([this]() { TimerLoop(); });
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  {
+    absl::MutexLock lock(&timer_mu_);
+    timers_stopped_ = true;
+    timers_changed_ = true;
+  }
+  timer_thread_.join();
+  {
+    absl::MutexLock lock(&idle_mu_);
+    stopping_ = true;
+    idle_cv_.SignalAll();
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void WorkStealingExecutor::Run(absl::AnyInvocable<void()> closure) {
+  Run(std::move(closure), TaskPriority::kNormal);
+}
+
+void WorkStealingExecutor::Run(absl::AnyInvocable<void()> closure,
+                               TaskPriority priority) {
+  Task task = {std::move(closure), priority, absl::Now()};
+  if (current_executor == this) {
+    Worker& worker = *static_cast<Worker*>(current_worker);
+    absl::MutexLock lock(&worker.mu);
+    if (priority == TaskPriority::kLow) {
+      worker.deques[static_cast<int>(priority)].push_back(std::move(task));
+    } else {
+      if (worker.lifo_slot.has_value()) {
+        worker.deques[static_cast<int>(worker.lifo_slot->priority)].push_back(
+            *std::move(worker.lifo_slot));
+      }
+      worker.lifo_slot = std::move(task);
+    }
+  } else {
+    Worker& worker = *workers_[next_worker_.fetch_add(
+                                   1, std::memory_order_relaxed) %
+                               workers_.size()];
+    absl::MutexLock lock(&worker.mu);
+    worker.deques[static_cast<int>(priority)].push_back(std::move(task));
+  }
+  NotifyTaskQueued();
+}
+
+void WorkStealingExecutor::NotifyTaskQueued() {
+  // Paired with WaitForTasks: either the worker going to sleep sees the
+  // task, or this sees the worker and wakes it up.
+  num_pending_tasks_.fetch_add(1);
+  if (num_idle_workers_.load() > 0) {
+    absl::MutexLock lock(&idle_mu_);
+    idle_cv_.Signal();
+  }
+}
+
+bool WorkStealingExecutor::WaitForTasks() {
+  absl::MutexLock lock(&idle_mu_);
+  num_idle_workers_.fetch_add(1);
+  while (num_pending_tasks_.load() <= 0 && !stopping_) {
+    idle_cv_.Wait(&idle_mu_);
+  }
+  num_idle_workers_.fetch_sub(1);
+  return num_pending_tasks_.load() > 0 || !stopping_;
+}
+
+void WorkStealingExecutor::WorkerLoop(Worker& worker) {
+  int lifo_slot_runs = 0;
+  while (true) {
+    std::optional<Task> task = TakeOwnTask(worker, lifo_slot_runs);
+    if (!task.has_value()) {
+      lifo_slot_runs = 0;
+      task = StealTask(worker);
+    }
+    if (!task.has_value()) {
+      if (!WaitForTasks()) {
+        return;
+      }
+      continue;
+    }
+    num_pending_tasks_.fetch_sub(1);
+    RecordLatency(task->priority, absl::Now() - task->enqueue_time);
+    std::move(task->closure)();
+  }
+}
+
+std::optional<WorkStealingExecutor::Task> WorkStealingExecutor::TakeOwnTask(
+    Worker& worker, int& lifo_slot_runs) {
+  absl::MutexLock lock(&worker.mu);
+  if (worker.lifo_slot.has_value() &&
+      lifo_slot_runs >= options_.max_lifo_slot_runs) {
+    worker.deques[static_cast<int>(worker.lifo_slot->priority)].push_back(
+        *std::move(worker.lifo_slot));
+    worker.lifo_slot.reset();
+  }
+  for (int priority = 0; priority < kNumPriorities; ++priority) {
+    if (worker.lifo_slot.has_value() &&
+        static_cast<int>(worker.lifo_slot->priority) == priority) {
+      ++lifo_slot_runs;
+      std::optional<Task> task = std::move(worker.lifo_slot);
+      worker.lifo_slot.reset();
+      return task;
+    }
+    std::deque<Task>& deque = worker.deques[priority];
+    if (!deque.empty()) {
+      lifo_slot_runs = 0;
+      Task task = std::move(deque.front());
+      deque.pop_front();
+      return task;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<WorkStealingExecutor::Task> WorkStealingExecutor::StealTask(
+    Worker& worker) {
+  const size_t num_workers = workers_.size();
+  // Starts from a different victim each time to spread the steals.
+  const size_t first =
+      next_worker_.fetch_add(1, std::memory_order_relaxed) % num_workers;
+  for (int priority = 0; priority < kNumPriorities; ++priority) {
+    for (size_t i = 0; i < num_workers; ++i) {
+      Worker& victim = *workers_[(first + i) % num_workers];
+      if (&victim == &worker) {
+        continue;
+      }
+      std::vector<Task> stolen;
+      {
+        absl::MutexLock lock(&victim.mu);
+        std::deque<Task>& deque = victim.deques[priority];
+        // Half of the deque, rounded up, oldest first.
+        const size_t num_stolen = (deque.size() + 1) / 2;
+        stolen.reserve(num_stolen);
+        for (size_t j = 0; j < num_stolen; ++j) {
+          stolen.push_back(std::move(deque.front()));
+          deque.pop_front();
+        }
+        if (stolen.empty() && victim.lifo_slot.has_value() &&
+            static_cast<int>(victim.lifo_slot->priority) == priority) {
+          stolen.push_back(*std::move(victim.lifo_slot));
+          victim.lifo_slot.reset();
+        }
+      }
+      if (stolen.empty()) {
+        continue;
+      }
+      if (stolen.size() > 1) {
+        absl::MutexLock lock(&worker.mu);
+        std::move(stolen.begin() + 1, stolen.end(),
+                  std::back_inserter(worker.deques[priority]));
+      }
+      return std::move(stolen.front());
+    }
+  }
+  return std::nullopt;
+}
+
+server_common::TaskId WorkStealingExecutor::RunAfter(
+    absl::Duration duration, absl::AnyInvocable<void()> closure) {
+  const absl::Time due_time = absl::Now() + duration;
+  absl::MutexLock lock(&timer_mu_);
+  const int64_t id = next_timer_id_++;
+  if (timers_.empty() || due_time < timers_.begin()->first.first) {
+    timers_changed_ = true;
+  }
+  timers_.emplace(std::pair{due_time, id}, std::move(closure));
+  timer_due_times_.emplace(id, due_time);
+  server_common::TaskId task_id;
+  task_id.keys[0] = id;
+  task_id.keys[1] = 0;
+  return task_id;
+}
+
+bool WorkStealingExecutor::Cancel(server_common::TaskId task_id) {
+  absl::MutexLock lock(&timer_mu_);
+  auto it = timer_due_times_.find(task_id.keys[0]);
+  if (it == timer_due_times_.end()) {
+    // Already run, or cancelled.
+    return false;
+  }
+  timers_.erase(std::pair{it->second, it->first});
+  timer_due_times_.erase(it);
+  return true;
+}
+
+void WorkStealingExecutor::TimerLoop() {
+  absl::MutexLock lock(&timer_mu_);
+  while (!timers_stopped_) {
+    if (!timers_.empty() && timers_.begin()->first.first <= absl::Now()) {
+      auto node = timers_.extract(timers_.begin());
+      timer_due_times_.erase(node.key().second);
+      timer_mu_.Unlock();
+      Run(std::move(node.mapped()));
+      timer_mu_.Lock();
+      continue;
+    }
+    timers_changed_ = false;
+    timer_mu_.AwaitWithDeadline(
+        absl::Condition(&timers_changed_),
+        timers_.empty() ? absl::InfiniteFuture()
+                        : timers_.begin()->first.first);
+  }
+}
+
+absl::flat_hash_map<std::string, double>
+WorkStealingExecutor::GetTaskQueueLatencyMs() {
+  absl::flat_hash_map<std::string, double> percentiles;
+  for (size_t priority = 0; priority < std::size(kPriorityLabels);
+       ++priority) {
+    auto& buckets = latency_buckets[priority];
+    std::array<int64_t, kLatencyBucketBoundsUs.size() + 1> counts;
+    int64_t total = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      counts[i] = buckets[i].exchange(0, std::memory_order_relaxed);
+      total += counts[i];
+    }
+    if (total == 0) {
+      continue;
+    }
+    int64_t cumulative = 0;
+    size_t bucket = 0;
+    for (const auto& [label, percentile] :
+         {std::pair{"p50", 0.5}, std::pair{"p90", 0.9},
+          std::pair{"p99", 0.99}}) {
+      while (cumulative + counts[bucket] < percentile * total) {
+        cumulative += counts[bucket];
+        ++bucket;
+      }
+      // The last bucket is reported with the bound of the one before.
+      const int64_t bound_us = kLatencyBucketBoundsUs[std::min(
+          bucket, kLatencyBucketBoundsUs.size() - 1)];
+      percentiles[absl::StrCat(kPriorityLabels[priority], "_", label)] =
+          bound_us / 1000.0;
+    }
+  }
+  return percentiles;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,155 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_COMMON_CONCURRENT_WORK_STEALING_EXECUTOR_H_
+#define SERVICES_COMMON_CONCURRENT_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Priority classes of the tasks of a WorkStealingExecutor. A worker runs the
+// tasks of a higher class first, whether its own or stolen.
+enum class TaskPriority {
+  // E.g. the continuations of requests.
+  kHigh = 0,
+  // Tasks run with Executor::Run and RunAfter.
+  kNormal = 1,
+  // Background work, e.g. code and blob fetches. Never put in a LIFO slot.
+  kLow = 2,
+};
+
+struct WorkStealingExecutorOptions {
+  // Worker threads. The number of CPUs if 0.
+  int num_workers = 0;
+  // Tasks a worker runs in a row from its LIFO slot before running the
+  // oldest task of its deque, so that tasks scheduling each other do not
+  // starve the others.
+  int max_lifo_slot_runs = 8;
+};
+
+// Executor running its tasks on a fixed set of workers, each with deques of
+// its own, one per priority class, rather than on a single shared queue:
+//
+// - A task scheduled from outside the executor is pushed to the deque of a
+//   worker picked round-robin, so that submitting threads do not contend on
+//   a single lock.
+// - A task scheduled by a task goes to the LIFO slot of its worker, which
+//   runs it next, while the data it was handed is still in cache. The task
+//   that was in the slot goes to the back of the deque.
+// - A worker without tasks of its own steals half of the deque of another
+//   worker, or the task in its LIFO slot, before going to sleep.
+//
+// Tasks run with RunAfter are held by a timer thread until they are due. The
+// time tasks wait before running is reported by GetTaskQueueLatencyMs.
+class WorkStealingExecutor : public server_common::Executor {
+ public:
+  explicit WorkStealingExecutor(WorkStealingExecutorOptions options = {});
+  // Drops the tasks run with RunAfter that are not due yet, runs the queued
+  // tasks, and joins the workers.
+  ~WorkStealingExecutor() override;
+
+  // WorkStealingExecutor is neither copyable nor movable.
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+  void Run(absl::AnyInvocable<void()> closure) override;
+  void Run(absl::AnyInvocable<void()> closure, TaskPriority priority);
+
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override
+      ABSL_LOCKS_EXCLUDED(timer_mu_);
+
+  bool Cancel(server_common::TaskId task_id) override
+      ABSL_LOCKS_EXCLUDED(timer_mu_);
+
+  int num_workers() const { return workers_.size(); }
+
+  // Percentiles of the time the tasks of all instances waited to run since
+  // the last call, in milliseconds, per priority class, e.g. "high_p99".
+  // Reported as upper bounds of fixed buckets.
+  static absl::flat_hash_map<std::string, double> GetTaskQueueLatencyMs();
+
+ private:
+  static constexpr int kNumPriorities = 3;
+
+  struct Task {
+    absl::AnyInvocable<void()> closure;
+    TaskPriority priority;
+    absl::Time enqueue_time;
+  };
+
+  struct Worker {
+    absl::Mutex mu;
+    std::deque<Task> deques[kNumPriorities] ABSL_GUARDED_BY(mu);
+    std::optional<Task> lifo_slot ABSL_GUARDED_BY(mu);
+    std::thread thread;
+  };
+
+  void WorkerLoop(Worker& worker);
+  // Takes the next task of `worker`, from its LIFO slot or its deques.
+  std::optional<Task> TakeOwnTask(Worker& worker, int& lifo_slot_runs);
+  // Steals tasks of the other workers, keeping all but one in `worker`.
+  std::optional<Task> StealTask(Worker& worker);
+  // Blocks until tasks are pending. Returns false once the executor stops
+  // and no task is left.
+  bool WaitForTasks() ABSL_LOCKS_EXCLUDED(idle_mu_);
+  // Counts a task in and wakes up a sleeping worker to steal it.
+  void NotifyTaskQueued() ABSL_LOCKS_EXCLUDED(idle_mu_);
+
+  void TimerLoop() ABSL_LOCKS_EXCLUDED(timer_mu_);
+
+  const WorkStealingExecutorOptions options_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<uint64_t> next_worker_ = 0;
+
+  // Tasks queued but not taken by a worker yet.
+  std::atomic<int64_t> num_pending_tasks_ = 0;
+  std::atomic<int> num_idle_workers_ = 0;
+  absl::Mutex idle_mu_;
+  absl::CondVar idle_cv_;
+  bool stopping_ ABSL_GUARDED_BY(idle_mu_) = false;
+
+  absl::Mutex timer_mu_;
+  // Tasks run with RunAfter, by due time and id.
+  std::map<std::pair<absl::Time, int64_t>, absl::AnyInvocable<void()>> timers_
+      ABSL_GUARDED_BY(timer_mu_);
+  absl::flat_hash_map<int64_t, absl::Time> timer_due_times_
+      ABSL_GUARDED_BY(timer_mu_);
+  int64_t next_timer_id_ ABSL_GUARDED_BY(timer_mu_) = 1;
+  // Set when the timer thread has to recompute when it wakes up.
+  bool timers_changed_ ABSL_GUARDED_BY(timer_mu_) = false;
+  bool timers_stopped_ ABSL_GUARDED_BY(timer_mu_) = false;
+  std::thread timer_thread_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CONCURRENT_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,166 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/concurrent/work_stealing_executor.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+  constexpr int kNumTasks = 1000;
+  WorkStealingExecutor executor({.num_workers = 4});
+  std::atomic<int> num_runs = 0;
+  absl::BlockingCounter done(2 * kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    executor.Run([&executor, &num_runs, &done]() {
+      ++num_runs;
+      done.DecrementCount();
+      // Scheduled from a worker.
+      executor.Run([&num_runs, &done]() {
+        ++num_runs;
+        done.DecrementCount();
+      });
+    });
+  }
+  done.Wait();
+  EXPECT_EQ(num_runs, 2 * kNumTasks);
+}
+
+TEST(WorkStealingExecutorTest, RunsHigherPriorityTasksFirst) {
+  WorkStealingExecutor executor({.num_workers = 1});
+  absl::Notification blocked;
+  absl::Notification release;
+  executor.Run([&blocked, &release]() {
+    blocked.Notify();
+    release.WaitForNotification();
+  });
+  blocked.WaitForNotification();
+
+  absl::Mutex mu;
+  std::vector<std::string> order;
+  absl::BlockingCounter done(3);
+  auto record = [&mu, &order, &done](std::string name) {
+    return [&mu, &order, &done, name = std::move(name)]() {
+      absl::MutexLock lock(&mu);
+      order.push_back(name);
+      done.DecrementCount();
+    };
+  };
+  executor.Run(record("low"), TaskPriority::kLow);
+  executor.Run(record("normal"), TaskPriority::kNormal);
+  executor.Run(record("high"), TaskPriority::kHigh);
+  release.Notify();
+  done.Wait();
+  absl::MutexLock lock(&mu);
+  EXPECT_EQ(order, (std::vector<std::string>{"high", "normal", "low"}));
+}
+
+TEST(WorkStealingExecutorTest, RunsLastScheduledTaskOfAWorkerNext) {
+  WorkStealingExecutor executor({.num_workers = 1});
+  absl::Mutex mu;
+  std::vector<std::string> order;
+  absl::BlockingCounter done(2);
+  executor.Run([&]() {
+    for (const char* name : {"first", "second"}) {
+      executor.Run([&mu, &order, &done, name]() {
+        absl::MutexLock lock(&mu);
+        order.push_back(name);
+        done.DecrementCount();
+      });
+    }
+  });
+  done.Wait();
+  absl::MutexLock lock(&mu);
+  EXPECT_EQ(order, (std::vector<std::string>{"second", "first"}));
+}
+
+TEST(WorkStealingExecutorTest, StealsTasksOfBusyWorkers) {
+  WorkStealingExecutor executor({.num_workers = 2});
+  absl::Notification stolen;
+  executor.Run([&executor, &stolen]() {
+    // Goes to the LIFO slot of this worker, which only another worker can
+    // run while this one waits.
+    executor.Run([&stolen]() { stolen.Notify(); });
+    EXPECT_TRUE(stolen.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  });
+  EXPECT_TRUE(stolen.WaitForNotificationWithTimeout(absl::Seconds(10)));
+}
+
+TEST(WorkStealingExecutorTest, RunsTasksAfterTheirDelay) {
+  WorkStealingExecutor executor({.num_workers = 2});
+  absl::Notification done;
+  const absl::Time start = absl::Now();
+  absl::Time run_time;
+  executor.RunAfter(absl::Milliseconds(50), [&done, &run_time]() {
+    run_time = absl::Now();
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_GE(run_time - start, absl::Milliseconds(50));
+}
+
+TEST(WorkStealingExecutorTest, CancelsTasksNotRunYet) {
+  WorkStealingExecutor executor({.num_workers = 1});
+  bool run = false;
+  server_common::TaskId task_id =
+      executor.RunAfter(absl::Hours(1), [&run]() { run = true; });
+  EXPECT_TRUE(executor.Cancel(task_id));
+  EXPECT_FALSE(executor.Cancel(task_id));
+
+  absl::Notification done;
+  task_id = executor.RunAfter(absl::ZeroDuration(), [&done]() {
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_FALSE(executor.Cancel(task_id));
+  EXPECT_FALSE(run);
+}
+
+TEST(WorkStealingExecutorTest, RunsQueuedTasksOnDestruction) {
+  std::atomic<int> num_runs = 0;
+  {
+    WorkStealingExecutor executor({.num_workers = 2});
+    for (int i = 0; i < 100; ++i) {
+      executor.Run([&num_runs]() { ++num_runs; });
+    }
+  }
+  EXPECT_EQ(num_runs, 100);
+}
+
+TEST(WorkStealingExecutorTest, ReportsQueueLatencyPerPriority) {
+  WorkStealingExecutor::GetTaskQueueLatencyMs();
+  {
+    WorkStealingExecutor executor({.num_workers = 1});
+    executor.Run([]() {}, TaskPriority::kHigh);
+    executor.Run([]() {}, TaskPriority::kLow);
+  }
+  auto latencies = WorkStealingExecutor::GetTaskQueueLatencyMs();
+  EXPECT_EQ(latencies.size(), 6);
+  EXPECT_LE(latencies["high_p50"], latencies["high_p99"]);
+  EXPECT_TRUE(latencies.contains("low_p90"));
+  EXPECT_TRUE(WorkStealingExecutor::GetTaskQueueLatencyMs().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -69,6 +69,10 @@ ABSL_FLAG(
     telemetry_config, std::nullopt, "configure telemetry.");
 ABSL_FLAG(std::optional<std::string>, roma_timeout_ms, std::nullopt,
           "The timeout used by Roma for dispatch requests");
+ABSL_FLAG(std::optional<int>, roma_batch_deadline_ms, 0,
+          "If positive, ends the generateBid and scoreAd batches after this "
+          "many milliseconds with the responses received by then, and handles "
+          "the responses as they arrive.");
 ABSL_FLAG(std::optional<std::string>, collector_endpoint, std::nullopt,
           "The endpoint of the OpenTelemetry Collector");
 ABSL_FLAG(std::optional<std::string>, consented_debug_token, std::nullopt,
@@ -90,3 +94,82 @@ ABSL_FLAG(std::optional<int>, max_allowed_size_debug_url_bytes, 1,
 ABSL_FLAG(std::optional<int>, max_allowed_size_all_debug_urls_kb, 1,
           "Max allowed size of all debug win or loss URLs summed together in "
           "kilobytes");
+ABSL_FLAG(std::optional<int>, request_phase_tracing_per_mille, 0,
+          "Share of the requests, in thousandths, for which the time spent in "
+          "each phase (decryption, KV lookups, Roma...) is exported as "
+          "metrics. Not traced if 0.");
+ABSL_FLAG(std::optional<int>, trace_sampling_per_mille, 0,
+          "Share of the requests, in thousandths, exported as distributed "
+          "traces spanning the four services. Picked from the generation ID, "
+          "so every service traces the same requests. Not traced if 0.");
+ABSL_FLAG(std::optional<bool>, enable_profiling, false,
+          "Periodically profiles the heap, allocations and CPU of the server "
+          "and exports the profiles through the consented logger. Requires "
+          "consented debugging to be enabled.");
+ABSL_FLAG(std::optional<int64_t>, profiling_interval_ms, 600000,
+          "Time between two profiling rounds, in milliseconds.");
+ABSL_FLAG(std::optional<int64_t>, memory_admission_heap_limit_mb, 0,
+          "Heap size, in MB, above which incoming requests are rejected with "
+          "RESOURCE_EXHAUSTED. Every request is admitted if 0.");
+ABSL_FLAG(std::optional<int>, memory_admission_request_size_factor, 10,
+          "Memory a request is expected to take once decrypted, decompressed "
+          "and parsed, as a multiple of its size on the wire. Reserved against "
+          "the heap limit while the request is handled.");
+ABSL_FLAG(std::optional<int>, grpc_server_num_cqs, 0,
+          "Completion queues polled by the gRPC server. gRPC default if 0.");
+ABSL_FLAG(std::optional<int>, grpc_server_max_pollers, 0,
+          "Maximum number of threads polling each completion queue of the "
+          "gRPC server. gRPC default if 0.");
+ABSL_FLAG(std::optional<int64_t>, grpc_server_max_memory_mb, 0,
+          "Memory, in MB, the gRPC server may use for its connections and "
+          "requests. Unlimited if 0.");
+ABSL_FLAG(std::optional<int>, grpc_server_max_threads, 0,
+          "Maximum number of threads of the gRPC server. Unlimited if 0.");
+ABSL_FLAG(std::optional<std::string>, cpu_placement, "",
+          "CPUs of the Roma workers, the inference sidecars, the gRPC threads "
+          "and the I/O loops of the server, such as "
+          "\"roma=0-15;inference=16-23;grpc=24-27;io=28-31\". Each part is "
+          "also bound to the memory of the NUMA nodes of its CPUs. Parts "
+          "without CPUs are not placed.");
+ABSL_FLAG(std::optional<int64_t>, drain_health_check_grace_ms, 0,
+          "Time, in ms, the health check reports the server as not serving "
+          "on SIGTERM before the server stops taking calls, for the load "
+          "balancers to stop sending any.");
+ABSL_FLAG(std::optional<int64_t>, drain_deadline_ms, 30'000,
+          "Time, in ms, the calls in flight have to finish once the server "
+          "stops taking calls on SIGTERM. The reporters and the telemetry are "
+          "flushed within the same deadline.");
+ABSL_FLAG(std::optional<int64_t>, key_warm_up_timeout_ms, 30'000,
+          "Time, in ms, the server waits on startup for its first keys to be "
+          "fetched before serving. The server serves anyway once it is "
+          "exceeded, fetching the keys on the first requests.");
+ABSL_FLAG(std::optional<int>, work_stealing_executor_workers, 0,
+          "Workers of the work-stealing executor running the async work of "
+          "the server, such as the callbacks of its clients and its periodic "
+          "fetches. The executor of the gRPC event engine is used if 0.");
+ABSL_FLAG(std::optional<int64_t>, large_buffer_pool_mb, 0,
+          "Memory, in MB, of the released large buffers, e.g. of the "
+          "decompressed request payloads, kept for reuse by the next requests "
+          "rather than returned to the OS. The payloads are decompressed on "
+          "the heap if 0.");
+ABSL_FLAG(std::optional<std::string>, large_buffer_huge_pages, "",
+          "Huge pages backing the large buffers: \"thp\" for transparent huge "
+          "pages, \"hugetlbfs\" for the huge pages reserved on the host, "
+          "falling back to transparent ones, or empty for regular pages.");
+ABSL_FLAG(std::optional<int64_t>, tcmalloc_tuning_interval_ms, 0,
+          "Time, in ms, between two adjustments of the max total thread "
+          "cache bytes and the background release rate of TCMalloc to the "
+          "load and memory headroom of the server. The settings of TCMalloc "
+          "are not tuned if 0.");
+ABSL_FLAG(std::optional<int64_t>, tcmalloc_tuning_min_thread_cache_mb, 16,
+          "Lower bound, in MB, of the tuned max total thread cache bytes.");
+ABSL_FLAG(std::optional<int64_t>, tcmalloc_tuning_max_thread_cache_mb, 256,
+          "Upper bound, in MB, of the tuned max total thread cache bytes.");
+ABSL_FLAG(std::optional<int64_t>, tcmalloc_tuning_min_release_mb_per_second,
+          1,
+          "Lower bound, in MB per second, of the tuned background release "
+          "rate.");
+ABSL_FLAG(std::optional<int64_t>, tcmalloc_tuning_max_release_mb_per_second,
+          64,
+          "Upper bound, in MB per second, of the tuned background release "
+          "rate.");
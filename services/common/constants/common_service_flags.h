@@ -50,6 +50,7 @@ ABSL_DECLARE_FLAG(
     std::optional<privacy_sandbox::server_common::telemetry::TelemetryFlag>,
     telemetry_config);
 ABSL_DECLARE_FLAG(std::optional<std::string>, roma_timeout_ms);
+ABSL_DECLARE_FLAG(std::optional<int>, roma_batch_deadline_ms);
 ABSL_DECLARE_FLAG(std::optional<std::string>, collector_endpoint);
 ABSL_DECLARE_FLAG(std::optional<std::string>, consented_debug_token);
 ABSL_DECLARE_FLAG(std::optional<bool>, enable_otel_based_logging);
@@ -58,6 +59,30 @@ ABSL_DECLARE_FLAG(std::optional<bool>, enable_protected_audience);
 ABSL_DECLARE_FLAG(std::optional<int>, ps_verbosity);
 ABSL_DECLARE_FLAG(std::optional<int>, max_allowed_size_debug_url_bytes);
 ABSL_DECLARE_FLAG(std::optional<int>, max_allowed_size_all_debug_urls_kb);
+ABSL_DECLARE_FLAG(std::optional<int>, request_phase_tracing_per_mille);
+ABSL_DECLARE_FLAG(std::optional<int>, trace_sampling_per_mille);
+ABSL_DECLARE_FLAG(std::optional<bool>, enable_profiling);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, profiling_interval_ms);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, memory_admission_heap_limit_mb);
+ABSL_DECLARE_FLAG(std::optional<int>, memory_admission_request_size_factor);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_num_cqs);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_max_pollers);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, grpc_server_max_memory_mb);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_max_threads);
+ABSL_DECLARE_FLAG(std::optional<std::string>, cpu_placement);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, drain_health_check_grace_ms);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, drain_deadline_ms);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, key_warm_up_timeout_ms);
+ABSL_DECLARE_FLAG(std::optional<int>, work_stealing_executor_workers);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, large_buffer_pool_mb);
+ABSL_DECLARE_FLAG(std::optional<std::string>, large_buffer_huge_pages);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, tcmalloc_tuning_interval_ms);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, tcmalloc_tuning_min_thread_cache_mb);
+ABSL_DECLARE_FLAG(std::optional<int64_t>, tcmalloc_tuning_max_thread_cache_mb);
+ABSL_DECLARE_FLAG(std::optional<int64_t>,
+                  tcmalloc_tuning_min_release_mb_per_second);
+ABSL_DECLARE_FLAG(std::optional<int64_t>,
+                  tcmalloc_tuning_max_release_mb_per_second);
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -89,6 +114,7 @@ inline constexpr char KEY_REFRESH_FLOW_RUN_FREQUENCY_SECONDS[] =
 inline constexpr char TELEMETRY_CONFIG[] = "TELEMETRY_CONFIG";
 inline constexpr char TEST_MODE[] = "TEST_MODE";
 inline constexpr char ROMA_TIMEOUT_MS[] = "ROMA_TIMEOUT_MS";
+inline constexpr char ROMA_BATCH_DEADLINE_MS[] = "ROMA_BATCH_DEADLINE_MS";
 inline constexpr char COLLECTOR_ENDPOINT[] = "COLLECTOR_ENDPOINT";
 inline constexpr char CONSENTED_DEBUG_TOKEN[] = "CONSENTED_DEBUG_TOKEN";
 inline constexpr char ENABLE_OTEL_BASED_LOGGING[] = "ENABLE_OTEL_BASED_LOGGING";
@@ -100,6 +126,38 @@ inline constexpr char MAX_ALLOWED_SIZE_DEBUG_URL_BYTES[] =
     "MAX_ALLOWED_SIZE_DEBUG_URL_BYTES";
 inline constexpr char MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB[] =
     "MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB";
+inline constexpr char REQUEST_PHASE_TRACING_PER_MILLE[] =
+    "REQUEST_PHASE_TRACING_PER_MILLE";
+inline constexpr char TRACE_SAMPLING_PER_MILLE[] = "TRACE_SAMPLING_PER_MILLE";
+inline constexpr char ENABLE_PROFILING[] = "ENABLE_PROFILING";
+inline constexpr char PROFILING_INTERVAL_MS[] = "PROFILING_INTERVAL_MS";
+inline constexpr char MEMORY_ADMISSION_HEAP_LIMIT_MB[] =
+    "MEMORY_ADMISSION_HEAP_LIMIT_MB";
+inline constexpr char MEMORY_ADMISSION_REQUEST_SIZE_FACTOR[] =
+    "MEMORY_ADMISSION_REQUEST_SIZE_FACTOR";
+inline constexpr char GRPC_SERVER_NUM_CQS[] = "GRPC_SERVER_NUM_CQS";
+inline constexpr char GRPC_SERVER_MAX_POLLERS[] = "GRPC_SERVER_MAX_POLLERS";
+inline constexpr char GRPC_SERVER_MAX_MEMORY_MB[] = "GRPC_SERVER_MAX_MEMORY_MB";
+inline constexpr char GRPC_SERVER_MAX_THREADS[] = "GRPC_SERVER_MAX_THREADS";
+inline constexpr char CPU_PLACEMENT[] = "CPU_PLACEMENT";
+inline constexpr char DRAIN_HEALTH_CHECK_GRACE_MS[] =
+    "DRAIN_HEALTH_CHECK_GRACE_MS";
+inline constexpr char DRAIN_DEADLINE_MS[] = "DRAIN_DEADLINE_MS";
+inline constexpr char KEY_WARM_UP_TIMEOUT_MS[] = "KEY_WARM_UP_TIMEOUT_MS";
+inline constexpr char WORK_STEALING_EXECUTOR_WORKERS[] =
+    "WORK_STEALING_EXECUTOR_WORKERS";
+inline constexpr char LARGE_BUFFER_POOL_MB[] = "LARGE_BUFFER_POOL_MB";
+inline constexpr char LARGE_BUFFER_HUGE_PAGES[] = "LARGE_BUFFER_HUGE_PAGES";
+inline constexpr char TCMALLOC_TUNING_INTERVAL_MS[] =
+    "TCMALLOC_TUNING_INTERVAL_MS";
+inline constexpr char TCMALLOC_TUNING_MIN_THREAD_CACHE_MB[] =
+    "TCMALLOC_TUNING_MIN_THREAD_CACHE_MB";
+inline constexpr char TCMALLOC_TUNING_MAX_THREAD_CACHE_MB[] =
+    "TCMALLOC_TUNING_MAX_THREAD_CACHE_MB";
+inline constexpr char TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND[] =
+    "TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND";
+inline constexpr char TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND[] =
+    "TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND";
 
 inline constexpr absl::string_view kCommonServiceFlags[] = {
     PUBLIC_KEY_ENDPOINT,
@@ -118,6 +176,7 @@ inline constexpr absl::string_view kCommonServiceFlags[] = {
     TEST_MODE,
     TELEMETRY_CONFIG,
     ROMA_TIMEOUT_MS,
+    ROMA_BATCH_DEADLINE_MS,
     COLLECTOR_ENDPOINT,
     CONSENTED_DEBUG_TOKEN,
     ENABLE_OTEL_BASED_LOGGING,
@@ -125,7 +184,29 @@ inline constexpr absl::string_view kCommonServiceFlags[] = {
     ENABLE_PROTECTED_AUDIENCE,
     PS_VERBOSITY,
     MAX_ALLOWED_SIZE_DEBUG_URL_BYTES,
-    MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB};
+    MAX_ALLOWED_SIZE_ALL_DEBUG_URLS_KB,
+    REQUEST_PHASE_TRACING_PER_MILLE,
+    TRACE_SAMPLING_PER_MILLE,
+    ENABLE_PROFILING,
+    PROFILING_INTERVAL_MS,
+    MEMORY_ADMISSION_HEAP_LIMIT_MB,
+    MEMORY_ADMISSION_REQUEST_SIZE_FACTOR,
+    GRPC_SERVER_NUM_CQS,
+    GRPC_SERVER_MAX_POLLERS,
+    GRPC_SERVER_MAX_MEMORY_MB,
+    GRPC_SERVER_MAX_THREADS,
+    CPU_PLACEMENT,
+    DRAIN_HEALTH_CHECK_GRACE_MS,
+    DRAIN_DEADLINE_MS,
+    KEY_WARM_UP_TIMEOUT_MS,
+    WORK_STEALING_EXECUTOR_WORKERS,
+    LARGE_BUFFER_POOL_MB,
+    LARGE_BUFFER_HUGE_PAGES,
+    TCMALLOC_TUNING_INTERVAL_MS,
+    TCMALLOC_TUNING_MIN_THREAD_CACHE_MB,
+    TCMALLOC_TUNING_MAX_THREAD_CACHE_MB,
+    TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND,
+    TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND};
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
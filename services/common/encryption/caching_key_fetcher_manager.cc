@@ -0,0 +1,320 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/encryption/caching_key_fetcher_manager.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+
+// Upper bounds of the latency buckets, in microseconds. The last bucket has
+// no upper bound.
+inline constexpr std::array<int64_t, 12> kLatencyBucketBoundsUs = {
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+// How often WaitUntilWarm checks the wrapped manager for keys.
+inline constexpr absl::Duration kWarmUpPollInterval = absl::Milliseconds(100);
+
+// Public key selections of all instances since the last
+// GetPublicKeySelectionLatencyMs call, per bucket.
+std::array<std::atomic<int64_t>, kLatencyBucketBoundsUs.size() + 1>
+    latency_buckets = {};
+
+// Private key lookups of all instances since the last
+// GetPrivateKeyLookupRatios call.
+std::atomic<int64_t> num_snapshot_hits = 0;
+std::atomic<int64_t> num_key_store_hits = 0;
+std::atomic<int64_t> num_unknown_key_ids = 0;
+
+void RecordLatency(absl::Duration latency) {
+  const int64_t latency_us = absl::ToInt64Microseconds(latency);
+  size_t bucket = 0;
+  while (bucket < kLatencyBucketBoundsUs.size() &&
+         latency_us > kLatencyBucketBoundsUs[bucket]) {
+    ++bucket;
+  }
+  latency_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+CachingKeyFetcherManager::CachingKeyFetcherManager(
+    std::unique_ptr<server_common::KeyFetcherManagerInterface>
+        key_fetcher_manager,
+    absl::Duration public_key_ttl, absl::Duration private_key_ttl)
+    : key_fetcher_manager_(std::move(key_fetcher_manager)),
+      public_key_ttl_(public_key_ttl),
+      private_key_ttl_(private_key_ttl),
+      private_keys_(std::make_shared<const PrivateKeySnapshot>()) {}
+
+CachingKeyFetcherManager::~CachingKeyFetcherManager() {
+  absl::MutexLock lock(&refresh_mu_);
+  stopped_ = true;
+  if (refresh_scheduled_ && executor_->Cancel(refresh_task_id_)) {
+    refresh_scheduled_ = false;
+  }
+  refresh_mu_.Await(absl::Condition(
+      +[](bool* refresh_scheduled) { return !*refresh_scheduled; },
+      &refresh_scheduled_));
+}
+
+absl::StatusOr<PublicKey> CachingKeyFetcherManager::GetPublicKey(
+    server_common::CloudPlatform cloud_platform) noexcept {
+  const absl::Time start = absl::Now();
+  absl::StatusOr<PublicKey> key = SelectPublicKey(cloud_platform);
+  RecordLatency(absl::Now() - start);
+  return key;
+}
+
+absl::StatusOr<PublicKey> CachingKeyFetcherManager::SelectPublicKey(
+    server_common::CloudPlatform cloud_platform) {
+  const absl::Time now = absl::Now();
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    auto it = public_keys_.find(cloud_platform);
+    if (it != public_keys_.end() && it->second.expiry > now) {
+      return it->second.key;
+    }
+  }
+
+  absl::StatusOr<PublicKey> key =
+      key_fetcher_manager_->GetPublicKey(cloud_platform);
+  if (!key.ok()) {
+    // Errors are not cached, the next call tries again.
+    return key;
+  }
+  absl::MutexLock lock(&mu_);
+  public_keys_.insert_or_assign(
+      cloud_platform, CachedPublicKey{*key, now + public_key_ttl_});
+  return key;
+}
+
+std::optional<server_common::PrivateKey>
+CachingKeyFetcherManager::GetPrivateKey(
+    const google::scp::cpio::PublicPrivateKeyPairId& key_id) noexcept {
+  const absl::Time now = absl::Now();
+  std::shared_ptr<const PrivateKeySnapshot> snapshot =
+      std::atomic_load(&private_keys_);
+  if (auto it = snapshot->find(key_id);
+      it != snapshot->end() && it->second.expiry > now) {
+    num_snapshot_hits.fetch_add(1, std::memory_order_relaxed);
+    return it->second.key;
+  }
+
+  std::optional<server_common::PrivateKey> key =
+      key_fetcher_manager_->GetPrivateKey(key_id);
+  if (!key.has_value()) {
+    num_unknown_key_ids.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+  num_key_store_hits.fetch_add(1, std::memory_order_relaxed);
+  AddToSnapshot(*key, now);
+  return key;
+}
+
+void CachingKeyFetcherManager::AddToSnapshot(server_common::PrivateKey key,
+                                             absl::Time now) {
+  absl::MutexLock lock(&snapshot_mu_);
+  auto snapshot = std::make_shared<PrivateKeySnapshot>();
+  for (const auto& [key_id, cached_key] : *std::atomic_load(&private_keys_)) {
+    if (cached_key.expiry > now) {
+      snapshot->emplace(key_id, cached_key);
+    }
+  }
+  std::string key_id = key.key_id;
+  snapshot->insert_or_assign(
+      std::move(key_id),
+      CachedPrivateKey{std::move(key), now + private_key_ttl_});
+  std::atomic_store(&private_keys_, std::shared_ptr<const PrivateKeySnapshot>(
+                                        std::move(snapshot)));
+}
+
+void CachingKeyFetcherManager::Start() noexcept {
+  key_fetcher_manager_->Start();
+}
+
+void CachingKeyFetcherManager::InvalidatePublicKeys() {
+  absl::MutexLock lock(&mu_);
+  public_keys_.clear();
+}
+
+absl::Status CachingKeyFetcherManager::WaitUntilWarm(
+    server_common::CloudPlatform cloud_platform, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  while (true) {
+    const absl::Time now = absl::Now();
+    absl::StatusOr<PublicKey> public_key =
+        key_fetcher_manager_->GetPublicKey(cloud_platform);
+    absl::Status status = public_key.status();
+    if (public_key.ok()) {
+      std::optional<server_common::PrivateKey> private_key =
+          key_fetcher_manager_->GetPrivateKey(public_key->key_id());
+      if (private_key.has_value()) {
+        {
+          absl::MutexLock lock(&mu_);
+          public_keys_.insert_or_assign(
+              cloud_platform,
+              CachedPublicKey{*std::move(public_key), now + public_key_ttl_});
+        }
+        AddToSnapshot(*std::move(private_key), now);
+        return absl::OkStatus();
+      }
+      status = absl::NotFoundError(absl::StrCat(
+          "No private key for public key ", public_key->key_id()));
+    }
+    if (now >= deadline) {
+      return absl::DeadlineExceededError(absl::StrCat(
+          "Keys not fetched within ", absl::FormatDuration(timeout), ": ",
+          status.message()));
+    }
+    absl::SleepFor(std::min(kWarmUpPollInterval, deadline - now));
+  }
+}
+
+void CachingKeyFetcherManager::StartWarmRefresh(
+    absl::Duration period, std::unique_ptr<server_common::Executor> executor) {
+  absl::MutexLock lock(&refresh_mu_);
+  if (executor_ != nullptr) {
+    return;
+  }
+  refresh_period_ = period;
+  executor_ = std::move(executor);
+  ScheduleRefresh();
+}
+
+void CachingKeyFetcherManager::ScheduleRefresh() {
+  if (stopped_ || executor_ == nullptr ||
+      refresh_period_ <= absl::ZeroDuration()) {
+    return;
+  }
+  refresh_scheduled_ = true;
+  refresh_task_id_ = executor_->RunAfter(refresh_period_, [this]() {
+    RefreshKeys();
+    absl::MutexLock lock(&refresh_mu_);
+    refresh_scheduled_ = false;
+    ScheduleRefresh();
+  });
+}
+
+void CachingKeyFetcherManager::RefreshKeys() {
+  const absl::Time now = absl::Now();
+  std::vector<server_common::CloudPlatform> cloud_platforms;
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    for (const auto& [cloud_platform, unused] : public_keys_) {
+      cloud_platforms.push_back(cloud_platform);
+    }
+  }
+  std::vector<std::string> key_ids;
+  for (server_common::CloudPlatform cloud_platform : cloud_platforms) {
+    absl::StatusOr<PublicKey> key =
+        key_fetcher_manager_->GetPublicKey(cloud_platform);
+    if (!key.ok()) {
+      // The selected key is kept until it expires, as on the request path.
+      continue;
+    }
+    key_ids.push_back(key->key_id());
+    absl::MutexLock lock(&mu_);
+    public_keys_.insert_or_assign(
+        cloud_platform,
+        CachedPublicKey{*std::move(key), now + public_key_ttl_});
+  }
+  for (const auto& [key_id, unused] : *std::atomic_load(&private_keys_)) {
+    key_ids.push_back(key_id);
+  }
+
+  // The wrapped manager is looked up without holding snapshot_mu_, so that
+  // requests adding keys to the snapshot meanwhile are not blocked.
+  const absl::flat_hash_set<std::string> looked_up_key_ids(key_ids.begin(),
+                                                           key_ids.end());
+  auto snapshot = std::make_shared<PrivateKeySnapshot>();
+  for (const std::string& key_id : looked_up_key_ids) {
+    std::optional<server_common::PrivateKey> key =
+        key_fetcher_manager_->GetPrivateKey(key_id);
+    if (key.has_value()) {
+      snapshot->insert_or_assign(
+          key_id, CachedPrivateKey{*std::move(key), now + private_key_ttl_});
+    }
+  }
+  absl::MutexLock lock(&snapshot_mu_);
+  for (const auto& [key_id, cached_key] : *std::atomic_load(&private_keys_)) {
+    if (!looked_up_key_ids.contains(key_id) && cached_key.expiry > now) {
+      snapshot->emplace(key_id, cached_key);
+    }
+  }
+  std::atomic_store(&private_keys_, std::shared_ptr<const PrivateKeySnapshot>(
+                                        std::move(snapshot)));
+}
+
+absl::flat_hash_map<std::string, double>
+CachingKeyFetcherManager::GetPrivateKeyLookupRatios() {
+  const double snapshot_hits =
+      num_snapshot_hits.exchange(0, std::memory_order_relaxed);
+  const double key_store_hits =
+      num_key_store_hits.exchange(0, std::memory_order_relaxed);
+  const double unknown_key_ids =
+      num_unknown_key_ids.exchange(0, std::memory_order_relaxed);
+  const double total = snapshot_hits + key_store_hits + unknown_key_ids;
+  if (total == 0) {
+    return {};
+  }
+  return {{kSnapshotHit, snapshot_hits / total},
+          {kKeyStoreHit, key_store_hits / total},
+          {kUnknownKeyId, unknown_key_ids / total}};
+}
+
+absl::flat_hash_map<std::string, double>
+CachingKeyFetcherManager::GetPublicKeySelectionLatencyMs() {
+  std::array<int64_t, latency_buckets.size()> counts;
+  int64_t total = 0;
+  for (size_t i = 0; i < latency_buckets.size(); ++i) {
+    counts[i] = latency_buckets[i].exchange(0, std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return {};
+  }
+
+  absl::flat_hash_map<std::string, double> percentiles;
+  int64_t cumulative = 0;
+  size_t bucket = 0;
+  for (const auto& [label, percentile] :
+       {std::pair{kP50, 0.5}, std::pair{kP90, 0.9}, std::pair{kP99, 0.99}}) {
+    while (cumulative + counts[bucket] < percentile * total) {
+      cumulative += counts[bucket];
+      ++bucket;
+    }
+    // The last bucket is reported with the bound of the one before.
+    const int64_t bound_us =
+        kLatencyBucketBoundsUs[std::min(bucket, kLatencyBucketBoundsUs.size() -
+                                                    1)];
+    percentiles[label] = bound_us / 1000.0;
+  }
+  return percentiles;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
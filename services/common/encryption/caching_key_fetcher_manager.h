@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_CACHING_KEY_FETCHER_MANAGER_H_
+#define SERVICES_COMMON_ENCRYPTION_CACHING_KEY_FETCHER_MANAGER_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "src/concurrent/executor.h"
+#include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Labels of the percentiles returned by GetPublicKeySelectionLatencyMs.
+inline constexpr char kP50[] = "p50";
+inline constexpr char kP90[] = "p90";
+inline constexpr char kP99[] = "p99";
+
+// Labels of the outcomes returned by GetPrivateKeyLookupRatios.
+inline constexpr char kSnapshotHit[] = "snapshot_hit";
+inline constexpr char kKeyStoreHit[] = "key_store_hit";
+inline constexpr char kUnknownKeyId[] = "unknown_key_id";
+
+// Wraps a key fetcher manager to keep the public key selected per cloud
+// platform, so that encrypting an outbound request does not go through the
+// key store of the wrapped manager. Keys are reselected after public_key_ttl,
+// which should not exceed the key refresh period of the wrapped manager so
+// that rotated keys are picked up, or after InvalidatePublicKeys.
+//
+// Private keys found in the wrapped manager are kept in an immutable snapshot
+// for private_key_ttl. Request threads read the snapshot without taking a
+// lock; a key missing from it is looked up in the wrapped manager and a new
+// snapshot with the key is swapped in.
+//
+// With StartWarmRefresh, the keys are refreshed in the background rather than
+// on expiry on the request path, so that requests find them warm.
+class CachingKeyFetcherManager
+    : public server_common::KeyFetcherManagerInterface {
+ public:
+  CachingKeyFetcherManager(
+      std::unique_ptr<server_common::KeyFetcherManagerInterface>
+          key_fetcher_manager,
+      absl::Duration public_key_ttl, absl::Duration private_key_ttl);
+  // Stops the warm refresh, waiting for a refresh in progress.
+  ~CachingKeyFetcherManager() override;
+
+  // CachingKeyFetcherManager is neither copyable nor movable.
+  CachingKeyFetcherManager(const CachingKeyFetcherManager&) = delete;
+  CachingKeyFetcherManager& operator=(const CachingKeyFetcherManager&) =
+      delete;
+
+  absl::StatusOr<google::cmrt::sdk::public_key_service::v1::PublicKey>
+  GetPublicKey(server_common::CloudPlatform cloud_platform) noexcept override;
+
+  std::optional<server_common::PrivateKey> GetPrivateKey(
+      const google::scp::cpio::PublicPrivateKeyPairId& key_id) noexcept
+      override;
+
+  void Start() noexcept override;
+
+  // Drops the selected public keys, e.g. when keys are known to have rotated.
+  void InvalidatePublicKeys() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Waits until the wrapped manager has a public key for `cloud_platform` and
+  // the private key of the same id, i.e. until its first key fetch is done,
+  // and caches both. Lets a server only start serving once it can encrypt
+  // and decrypt. Fails if the keys are not fetched within `timeout`.
+  absl::Status WaitUntilWarm(server_common::CloudPlatform cloud_platform,
+                             absl::Duration timeout)
+      ABSL_LOCKS_EXCLUDED(mu_, snapshot_mu_);
+
+  // Runs RefreshKeys every `period` on `executor` until destruction.
+  void StartWarmRefresh(absl::Duration period,
+                        std::unique_ptr<server_common::Executor> executor)
+      ABSL_LOCKS_EXCLUDED(refresh_mu_);
+
+  // Reselects the public keys of the cloud platforms selected so far, and
+  // looks up the private keys of the new public keys and those of the
+  // snapshot, whose expiry is extended. The private key of a rotated public
+  // key is thus in the snapshot before the first request encrypted with it,
+  // and keys no longer in the wrapped manager are dropped.
+  void RefreshKeys() ABSL_LOCKS_EXCLUDED(mu_, snapshot_mu_);
+
+  // Percentiles of the time taken by GetPublicKey across all instances since
+  // the last call, in milliseconds. Reported as upper bounds of fixed buckets.
+  static absl::flat_hash_map<std::string, double>
+  GetPublicKeySelectionLatencyMs();
+
+  // Shares of the private key lookups of all instances since the last call
+  // served from the snapshot, from the wrapped manager, or for unknown key
+  // ids. Unknown key ids are usually clients with stale public keys, as
+  // opposed to ciphertexts that fail to decrypt.
+  static absl::flat_hash_map<std::string, double> GetPrivateKeyLookupRatios();
+
+ private:
+  struct CachedPublicKey {
+    google::cmrt::sdk::public_key_service::v1::PublicKey key;
+    absl::Time expiry;
+  };
+
+  struct CachedPrivateKey {
+    server_common::PrivateKey key;
+    absl::Time expiry;
+  };
+  using PrivateKeySnapshot = absl::flat_hash_map<std::string, CachedPrivateKey>;
+
+  // Swaps in a snapshot with key added and the expired keys dropped.
+  void AddToSnapshot(server_common::PrivateKey key, absl::Time now)
+      ABSL_LOCKS_EXCLUDED(snapshot_mu_);
+
+  absl::StatusOr<google::cmrt::sdk::public_key_service::v1::PublicKey>
+  SelectPublicKey(server_common::CloudPlatform cloud_platform)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  void ScheduleRefresh() ABSL_EXCLUSIVE_LOCKS_REQUIRED(refresh_mu_);
+
+  const std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      key_fetcher_manager_;
+  const absl::Duration public_key_ttl_;
+  const absl::Duration private_key_ttl_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<server_common::CloudPlatform, CachedPublicKey>
+      public_keys_ ABSL_GUARDED_BY(mu_);
+
+  // Only read and written with std::atomic_load and std::atomic_store.
+  std::shared_ptr<const PrivateKeySnapshot> private_keys_;
+  // Serializes the snapshot updates, reads don't take it.
+  absl::Mutex snapshot_mu_;
+
+  absl::Mutex refresh_mu_;
+  absl::Duration refresh_period_ ABSL_GUARDED_BY(refresh_mu_);
+  std::unique_ptr<server_common::Executor> executor_
+      ABSL_GUARDED_BY(refresh_mu_);
+  bool stopped_ ABSL_GUARDED_BY(refresh_mu_) = false;
+  bool refresh_scheduled_ ABSL_GUARDED_BY(refresh_mu_) = false;
+  server_common::TaskId refresh_task_id_ ABSL_GUARDED_BY(refresh_mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_CACHING_KEY_FETCHER_MANAGER_H_
@@ -0,0 +1,264 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/encryption/caching_key_fetcher_manager.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+#include "src/encryption/key_fetcher/mock/mock_key_fetcher_manager.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+using ::testing::_;
+using ::testing::Return;
+
+PublicKey MakePublicKey(absl::string_view key_id) {
+  PublicKey key;
+  key.set_key_id(key_id);
+  key.set_public_key("publickey");
+  return key;
+}
+
+class CachingKeyFetcherManagerTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<CachingKeyFetcherManager> MakeManager(
+      absl::Duration ttl, absl::Duration private_key_ttl = absl::Minutes(1)) {
+    auto key_fetcher_manager =
+        std::make_unique<server_common::MockKeyFetcherManager>();
+    key_fetcher_manager_ = key_fetcher_manager.get();
+    return std::make_unique<CachingKeyFetcherManager>(
+        std::move(key_fetcher_manager), ttl, private_key_ttl);
+  }
+
+  server_common::MockKeyFetcherManager* key_fetcher_manager_;
+};
+
+TEST_F(CachingKeyFetcherManagerTest, ReusesPublicKeyPerCloudPlatform) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_,
+              GetPublicKey(server_common::CloudPlatform::kGcp))
+      .WillOnce(Return(MakePublicKey("gcp")));
+  EXPECT_CALL(*key_fetcher_manager_,
+              GetPublicKey(server_common::CloudPlatform::kAws))
+      .WillOnce(Return(MakePublicKey("aws")));
+
+  for (int i = 0; i < 3; ++i) {
+    auto gcp_key = manager->GetPublicKey(server_common::CloudPlatform::kGcp);
+    ASSERT_TRUE(gcp_key.ok());
+    EXPECT_EQ(gcp_key->key_id(), "gcp");
+    auto aws_key = manager->GetPublicKey(server_common::CloudPlatform::kAws);
+    ASSERT_TRUE(aws_key.ok());
+    EXPECT_EQ(aws_key->key_id(), "aws");
+  }
+}
+
+TEST_F(CachingKeyFetcherManagerTest, ReselectsPublicKeyAfterTtl) {
+  auto manager = MakeManager(absl::Milliseconds(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(MakePublicKey("old")))
+      .WillOnce(Return(MakePublicKey("new")));
+
+  ASSERT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  absl::SleepFor(absl::Milliseconds(5));
+  auto key = manager->GetPublicKey(server_common::CloudPlatform::kGcp);
+  ASSERT_TRUE(key.ok());
+  EXPECT_EQ(key->key_id(), "new");
+}
+
+TEST_F(CachingKeyFetcherManagerTest, ReselectsPublicKeyAfterInvalidation) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(MakePublicKey("old")))
+      .WillOnce(Return(MakePublicKey("new")));
+
+  ASSERT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  manager->InvalidatePublicKeys();
+  auto key = manager->GetPublicKey(server_common::CloudPlatform::kGcp);
+  ASSERT_TRUE(key.ok());
+  EXPECT_EQ(key->key_id(), "new");
+}
+
+TEST_F(CachingKeyFetcherManagerTest, DoesNotCacheErrors) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(absl::InternalError("no key")))
+      .WillOnce(Return(MakePublicKey("key")));
+
+  EXPECT_FALSE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  EXPECT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+}
+
+TEST_F(CachingKeyFetcherManagerTest, ReportsSelectionLatency) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(MakePublicKey("key")));
+  CachingKeyFetcherManager::GetPublicKeySelectionLatencyMs();
+
+  ASSERT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  auto latencies = CachingKeyFetcherManager::GetPublicKeySelectionLatencyMs();
+  EXPECT_EQ(latencies.size(), 3);
+  EXPECT_LE(latencies[kP50], latencies[kP99]);
+  EXPECT_TRUE(CachingKeyFetcherManager::GetPublicKeySelectionLatencyMs()
+                  .empty());
+}
+
+server_common::PrivateKey MakePrivateKey(absl::string_view key_id) {
+  server_common::PrivateKey key;
+  key.key_id = key_id;
+  key.private_key = "privatekey";
+  return key;
+}
+
+TEST_F(CachingKeyFetcherManagerTest, ServesPrivateKeysFromSnapshot) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .WillOnce(Return(MakePrivateKey("a")));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("b"))
+      .WillOnce(Return(MakePrivateKey("b")));
+  CachingKeyFetcherManager::GetPrivateKeyLookupRatios();
+
+  for (int i = 0; i < 2; ++i) {
+    auto a = manager->GetPrivateKey("a");
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(a->key_id, "a");
+    auto b = manager->GetPrivateKey("b");
+    ASSERT_TRUE(b.has_value());
+    EXPECT_EQ(b->key_id, "b");
+  }
+  auto ratios = CachingKeyFetcherManager::GetPrivateKeyLookupRatios();
+  EXPECT_DOUBLE_EQ(ratios[kSnapshotHit], 0.5);
+  EXPECT_DOUBLE_EQ(ratios[kKeyStoreHit], 0.5);
+  EXPECT_DOUBLE_EQ(ratios[kUnknownKeyId], 0);
+}
+
+TEST_F(CachingKeyFetcherManagerTest, LooksUpExpiredPrivateKeysAgain) {
+  auto manager = MakeManager(absl::Minutes(1), absl::Milliseconds(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .Times(2)
+      .WillRepeatedly(Return(MakePrivateKey("a")));
+
+  ASSERT_TRUE(manager->GetPrivateKey("a").has_value());
+  absl::SleepFor(absl::Milliseconds(5));
+  ASSERT_TRUE(manager->GetPrivateKey("a").has_value());
+}
+
+TEST_F(CachingKeyFetcherManagerTest, CountsUnknownKeyIds) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("stale"))
+      .Times(2)
+      .WillRepeatedly(Return(std::nullopt));
+  CachingKeyFetcherManager::GetPrivateKeyLookupRatios();
+
+  EXPECT_FALSE(manager->GetPrivateKey("stale").has_value());
+  EXPECT_FALSE(manager->GetPrivateKey("stale").has_value());
+  auto ratios = CachingKeyFetcherManager::GetPrivateKeyLookupRatios();
+  EXPECT_DOUBLE_EQ(ratios[kUnknownKeyId], 1);
+}
+
+TEST_F(CachingKeyFetcherManagerTest, WaitsUntilWarmAndCachesTheKeys) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(absl::UnavailableError("not fetched yet")))
+      .WillOnce(Return(MakePublicKey("a")));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .WillOnce(Return(MakePrivateKey("a")));
+
+  ASSERT_TRUE(manager
+                  ->WaitUntilWarm(server_common::CloudPlatform::kGcp,
+                                  absl::Seconds(10))
+                  .ok());
+  auto public_key = manager->GetPublicKey(server_common::CloudPlatform::kGcp);
+  ASSERT_TRUE(public_key.ok());
+  EXPECT_EQ(public_key->key_id(), "a");
+  EXPECT_TRUE(manager->GetPrivateKey("a").has_value());
+}
+
+TEST_F(CachingKeyFetcherManagerTest, FailsToWarmUpWithoutPrivateKey) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillRepeatedly(Return(MakePublicKey("a")));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .WillRepeatedly(Return(std::nullopt));
+
+  EXPECT_EQ(manager
+                ->WaitUntilWarm(server_common::CloudPlatform::kGcp,
+                                absl::Milliseconds(150))
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+}
+
+TEST_F(CachingKeyFetcherManagerTest, RefreshWarmsPrivateKeyOfNewPublicKey) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .WillOnce(Return(MakePublicKey("old")))
+      .WillOnce(Return(MakePublicKey("new")));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("new"))
+      .WillOnce(Return(MakePrivateKey("new")));
+
+  ASSERT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  manager->RefreshKeys();
+  auto public_key = manager->GetPublicKey(server_common::CloudPlatform::kGcp);
+  ASSERT_TRUE(public_key.ok());
+  EXPECT_EQ(public_key->key_id(), "new");
+  CachingKeyFetcherManager::GetPrivateKeyLookupRatios();
+  EXPECT_TRUE(manager->GetPrivateKey("new").has_value());
+  EXPECT_DOUBLE_EQ(
+      CachingKeyFetcherManager::GetPrivateKeyLookupRatios()[kSnapshotHit], 1);
+}
+
+TEST_F(CachingKeyFetcherManagerTest, RefreshDropsPrivateKeysNoLongerFetched) {
+  auto manager = MakeManager(absl::Minutes(1));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .WillOnce(Return(MakePrivateKey("a")))
+      .WillRepeatedly(Return(std::nullopt));
+
+  ASSERT_TRUE(manager->GetPrivateKey("a").has_value());
+  manager->RefreshKeys();
+  EXPECT_FALSE(manager->GetPrivateKey("a").has_value());
+}
+
+TEST_F(CachingKeyFetcherManagerTest, RefreshesPeriodicallyUntilDestroyed) {
+  constexpr absl::Duration kPeriod = absl::Seconds(30);
+  auto manager = MakeManager(absl::Minutes(1));
+  auto executor = std::make_unique<MockExecutor>();
+  absl::AnyInvocable<void()> refresh;
+  EXPECT_CALL(*executor, RunAfter(kPeriod, _))
+      .Times(2)
+      .WillRepeatedly(
+          [&refresh](absl::Duration, absl::AnyInvocable<void()> closure) {
+            refresh = std::move(closure);
+            return server_common::TaskId();
+          });
+  EXPECT_CALL(*executor, Cancel).WillOnce(Return(true));
+  EXPECT_CALL(*key_fetcher_manager_, GetPublicKey)
+      .Times(2)
+      .WillRepeatedly(Return(MakePublicKey("a")));
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey("a"))
+      .WillOnce(Return(MakePrivateKey("a")));
+
+  ASSERT_TRUE(manager->GetPublicKey(server_common::CloudPlatform::kGcp).ok());
+  manager->StartWarmRefresh(kPeriod, std::move(executor));
+  // Runs the scheduled refresh, which schedules the next one.
+  std::move(refresh)();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
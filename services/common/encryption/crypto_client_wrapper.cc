@@ -29,7 +29,6 @@
 namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::cmrt::sdk::crypto_service::v1::HpkeAead;
-using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptedData;
 using ::google::cmrt::sdk::crypto_service::v1::HpkeKdf;
 using ::google::cmrt::sdk::crypto_service::v1::HpkeKem;
 using ::google::cmrt::sdk::crypto_service::v1::HpkeParams;
@@ -82,14 +81,45 @@ CryptoClientWrapper::~CryptoClientWrapper() {
   crypto_client_->Stop().IgnoreError();
 }
 
+std::string CryptoClientWrapper::EncodePrivateKey(
+    const server_common::PrivateKey& private_key) {
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = encoded_private_keys_.find(private_key.key_id);
+    if (it != encoded_private_keys_.end() &&
+        it->second.first == private_key.private_key) {
+      return it->second.second;
+    }
+  }
+
+  google::crypto::tink::HpkePrivateKey hpke_private_key;
+  hpke_private_key.set_private_key(private_key.private_key);
+
+  const int unused_key_id = 0;
+  google::crypto::tink::Keyset keyset;
+  keyset.set_primary_key_id(unused_key_id);
+  keyset.add_key();
+  keyset.mutable_key(0)->set_key_id(unused_key_id);
+  keyset.mutable_key(0)->mutable_key_data()->set_value(
+      hpke_private_key.SerializeAsString());
+  std::string encoded_private_key =
+      absl::Base64Escape(keyset.SerializeAsString());
+
+  absl::MutexLock lock(&mu_);
+  if (encoded_private_keys_.size() >= kMaxCachedPrivateKeys) {
+    encoded_private_keys_.clear();
+  }
+  encoded_private_keys_.insert_or_assign(
+      private_key.key_id,
+      std::pair{private_key.private_key, encoded_private_key});
+  return encoded_private_key;
+}
+
 absl::StatusOr<HpkeEncryptResponse> CryptoClientWrapper::HpkeEncrypt(
     const PublicKey& key, const std::string& plaintext_payload) noexcept {
-  google::cmrt::sdk::public_key_service::v1::PublicKey public_key;
-  public_key.set_key_id(key.key_id());
-  public_key.set_public_key(key.public_key());
-
   HpkeEncryptRequest request;
-  *request.mutable_public_key() = std::move(public_key);
+  request.mutable_public_key()->set_key_id(key.key_id());
+  request.mutable_public_key()->set_public_key(key.public_key());
   request.set_payload(plaintext_payload);
   request.set_shared_info(kSharedInfo);
   request.set_is_bidirectional(true);
@@ -152,29 +182,12 @@ absl::StatusOr<AeadEncryptResponse> CryptoClientWrapper::AeadEncrypt(
 absl::StatusOr<HpkeDecryptResponse> CryptoClientWrapper::HpkeDecrypt(
     const server_common::PrivateKey& private_key,
     const std::string& ciphertext) noexcept {
-  google::crypto::tink::HpkePrivateKey hpke_private_key;
-  hpke_private_key.set_private_key(private_key.private_key);
-
-  const int unused_key_id = 0;
-  google::crypto::tink::Keyset keyset;
-  keyset.set_primary_key_id(unused_key_id);
-  keyset.add_key();
-  keyset.mutable_key(0)->set_key_id(unused_key_id);
-  keyset.mutable_key(0)->mutable_key_data()->set_value(
-      hpke_private_key.SerializeAsString());
-
+  HpkeDecryptRequest request;
   // Only the private_key field needs to be set for decryption.
-  google::cmrt::sdk::private_key_service::v1::PrivateKey key;
-  key.set_key_id(private_key.key_id);
-  key.set_private_key(absl::Base64Escape(keyset.SerializeAsString()));
-
+  request.mutable_private_key()->set_key_id(private_key.key_id);
+  request.mutable_private_key()->set_private_key(EncodePrivateKey(private_key));
   // Only the ciphertext field needs to be set for decryption.
-  HpkeEncryptedData encrypted_data;
-  encrypted_data.set_ciphertext(ciphertext);
-
-  HpkeDecryptRequest request;
-  *request.mutable_private_key() = std::move(key);
-  *request.mutable_encrypted_data() = std::move(encrypted_data);
+  request.mutable_encrypted_data()->set_ciphertext(ciphertext);
   request.set_shared_info(kSharedInfo);
   request.set_is_bidirectional(true);
   request.set_secret_length(
@@ -21,8 +21,11 @@
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 #include "src/encryption/key_fetcher/interface/private_key_fetcher_interface.h"
 #include "src/public/cpio/interface/crypto_client/crypto_client_interface.h"
@@ -41,6 +44,10 @@ inline constexpr char kAeadDecrypt[] = "AeadDecrypt";
 inline constexpr char kCryptoOperationFailureError[] =
     "Failure during %s: (error: %s)";
 
+// Number of encoded private keys kept by a CryptoClientWrapper. Keys rotate
+// rarely, so only a handful are in use at any time.
+inline constexpr int kMaxCachedPrivateKeys = 16;
+
 class CryptoClientWrapper : public CryptoClientWrapperInterface {
  public:
   CryptoClientWrapper() = default;
@@ -73,7 +80,18 @@ class CryptoClientWrapper : public CryptoClientWrapperInterface {
               const std::string& secret) noexcept override;
 
  private:
+  // Returns the private key wrapped in a Tink keyset, serialized and base64
+  // encoded, as expected by the crypto client. Encoded keys are cached since
+  // every request of a server is decrypted with one of a few keys.
+  std::string EncodePrivateKey(const server_common::PrivateKey& private_key)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   std::unique_ptr<google::scp::cpio::CryptoClientInterface> crypto_client_;
+
+  absl::Mutex mu_;
+  // Raw and encoded private keys by key id.
+  absl::flat_hash_map<std::string, std::pair<std::string, std::string>>
+      encoded_private_keys_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
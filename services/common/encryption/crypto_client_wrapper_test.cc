@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <google/protobuf/util/message_differencer.h>
 #include <include/gmock/gmock-actions.h>
@@ -201,6 +202,45 @@ TEST(CryptoClientWrapperTest, HpkeDecrypt_Success) {
       *actual_response, mock_response));
 }
 
+TEST(CryptoClientWrapperTest, HpkeDecrypt_EncodesRotatedPrivateKey) {
+  server_common::PrivateKey private_key;
+  private_key.key_id = "keyid";
+  private_key.private_key = "privatekey";
+
+  std::vector<std::string> encoded_private_keys;
+  std::unique_ptr<MockCryptoClientProvider> mock_crypto_client =
+      std::make_unique<MockCryptoClientProvider>();
+  EXPECT_CALL(*mock_crypto_client, HpkeDecrypt)
+      .Times(3)
+      .WillRepeatedly([&encoded_private_keys](
+                          const HpkeDecryptRequest& request,
+                          const Callback<HpkeDecryptResponse>& callback) {
+        encoded_private_keys.push_back(request.private_key().private_key());
+        callback(SuccessExecutionResult(), HpkeDecryptResponse());
+        return absl::OkStatus();
+      });
+  CryptoClientWrapper crypto_client(std::move(mock_crypto_client));
+
+  ASSERT_TRUE(crypto_client.HpkeDecrypt(private_key, kCiphertext).ok());
+  ASSERT_TRUE(crypto_client.HpkeDecrypt(private_key, kCiphertext).ok());
+  // Same key id, different key.
+  private_key.private_key = "otherprivatekey";
+  ASSERT_TRUE(crypto_client.HpkeDecrypt(private_key, kCiphertext).ok());
+
+  ASSERT_EQ(encoded_private_keys.size(), 3);
+  EXPECT_EQ(encoded_private_keys[0], encoded_private_keys[1]);
+  EXPECT_NE(encoded_private_keys[0], encoded_private_keys[2]);
+
+  std::string keyset;
+  ASSERT_TRUE(absl::Base64Unescape(encoded_private_keys[2], &keyset));
+  google::crypto::tink::Keyset decoded_keyset;
+  ASSERT_TRUE(decoded_keyset.ParseFromString(keyset));
+  google::crypto::tink::HpkePrivateKey hpke_private_key;
+  ASSERT_TRUE(hpke_private_key.ParseFromString(
+      decoded_keyset.key(0).key_data().value()));
+  EXPECT_EQ(hpke_private_key.private_key(), "otherprivatekey");
+}
+
 TEST(CryptoClientWrapperTest, AeadEncrypt_Success) {
   const std::string secret = "secret";
 
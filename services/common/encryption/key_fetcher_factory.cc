@@ -14,6 +14,7 @@
 
 #include "services/common/encryption/key_fetcher_factory.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -26,6 +27,7 @@
 
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/caching_key_fetcher_manager.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
@@ -53,6 +55,16 @@ bool IsEncryptionDisabled(
   return config_client.GetBooleanParameter(TEST_MODE);
 }
 
+server_common::CloudPlatform GetCloudPlatform() {
+#if defined(CLOUD_PLATFORM_AWS)
+  return server_common::CloudPlatform::kAws;
+#elif defined(CLOUD_PLATFORM_GCP)
+  return server_common::CloudPlatform::kGcp;
+#else
+  return server_common::CloudPlatform::kLocal;
+#endif
+}
+
 }  // namespace
 
 std::unique_ptr<server_common::PublicKeyFetcherInterface>
@@ -65,16 +77,8 @@ CreatePublicKeyFetcher(TrustedServersConfigClient& config_client) {
       config_client.GetStringParameter(PUBLIC_KEY_ENDPOINT);
   std::vector<std::string> endpoints = {public_key_endpoint.data()};
 
-  server_common::CloudPlatform cloud_platform =
-      server_common::CloudPlatform::kLocal;
-#if defined(CLOUD_PLATFORM_AWS)
-  cloud_platform = server_common::CloudPlatform::kAws;
-#elif defined(CLOUD_PLATFORM_GCP)
-  cloud_platform = server_common::CloudPlatform::kGcp;
-#endif
-
   PlatformToPublicKeyServiceEndpointMap per_platform_endpoints = {
-      {cloud_platform, endpoints}};
+      {GetCloudPlatform(), endpoints}};
   return PublicKeyFetcherFactory::Create(per_platform_endpoints);
 }
 
@@ -129,11 +133,36 @@ std::unique_ptr<KeyFetcherManagerInterface> CreateKeyFetcherManager(
       config_client.GetIntParameter(KEY_REFRESH_FLOW_RUN_FREQUENCY_SECONDS));
   auto event_engine = std::make_unique<server_common::EventEngineExecutor>(
       grpc_event_engine::experimental::GetDefaultEventEngine());
-  std::unique_ptr<server_common::KeyFetcherManagerInterface> manager =
+  // Servers without a public key fetcher, e.g. those only decrypting, have no
+  // public key to wait for.
+  const bool has_public_keys = public_key_fetcher != nullptr;
+  // Keys are reselected at the refresh frequency, so that rotated keys are
+  // picked up within a refresh.
+  auto manager = std::make_unique<CachingKeyFetcherManager>(
       KeyFetcherManagerFactory::Create(
           key_refresh_flow_run_freq, std::move(public_key_fetcher),
-          std::move(private_key_fetcher), std::move(event_engine));
+          std::move(private_key_fetcher), std::move(event_engine)),
+      /*public_key_ttl=*/key_refresh_flow_run_freq,
+      /*private_key_ttl=*/std::min(key_refresh_flow_run_freq, private_key_ttl));
   manager->Start();
+  // Refreshes the cached keys along with the wrapped manager, so that the
+  // keys of a rotation are warm before requests use them.
+  manager->StartWarmRefresh(
+      key_refresh_flow_run_freq,
+      std::make_unique<server_common::EventEngineExecutor>(
+          grpc_event_engine::experimental::GetDefaultEventEngine()));
+  if (has_public_keys) {
+    // Requests failing for want of keys would otherwise be served until the
+    // first fetch is done. The server still serves if the fetch takes longer,
+    // as it would without waiting.
+    if (absl::Status status = manager->WaitUntilWarm(
+            GetCloudPlatform(),
+            absl::Milliseconds(
+                config_client.GetInt64Parameter(KEY_WARM_UP_TIMEOUT_MS)));
+        !status.ok()) {
+      PS_LOG(WARNING) << "Serving before the keys are warm: " << status;
+    }
+  }
 
   return manager;
 }
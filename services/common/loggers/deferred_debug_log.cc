@@ -0,0 +1,210 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/loggers/deferred_debug_log.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Logs of all requests waiting to be formatted, beyond which logs are dropped.
+constexpr int kMaxQueuedLogs = 10'000;
+
+constexpr char kTruncated[] = "...";
+
+// Runs the formatting of the debug logs of all requests on one thread.
+class DebugLogFormatter {
+ public:
+  static DebugLogFormatter& Get() {
+    // Never destroyed, so that logs may be queued until the process exits.
+    static DebugLogFormatter* formatter = new DebugLogFormatter();
+    return *formatter;
+  }
+
+  // Queues `format`. Returns false if the queue is full.
+  bool Enqueue(absl::AnyInvocable<void() &&> format) {
+    absl::MutexLock lock(&mu_);
+    if (queued_.size() >= kMaxQueuedLogs) {
+      return false;
+    }
+    queued_.push_back(std::move(format));
+    return true;
+  }
+
+ private:
+  DebugLogFormatter() : worker_([this]() { Run(); }) {}
+
+  void Run() {
+    while (true) {
+      absl::AnyInvocable<void() &&> format;
+      {
+        absl::MutexLock lock(&mu_);
+        mu_.Await(absl::Condition(
+            +[](std::deque<absl::AnyInvocable<void() &&>>* queued) {
+              return !queued->empty();
+            },
+            &queued_));
+        format = std::move(queued_.front());
+        queued_.pop_front();
+      }
+      std::move(format)();
+    }
+  }
+
+  absl::Mutex mu_;
+  std::deque<absl::AnyInvocable<void() &&>> queued_ ABSL_GUARDED_BY(mu_);
+  std::thread worker_;
+};
+
+}  // namespace
+
+struct DeferredDebugLog::State {
+  struct Log {
+    int verbosity;
+    std::string text;
+    bool dropped = false;
+  };
+
+  explicit State(int64_t max_bytes) : max_bytes(max_bytes) {}
+
+  bool NonePending() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    return num_pending == 0;
+  }
+
+  const int64_t max_bytes;
+  absl::Mutex mu;
+  // Bytes charged up front, from the estimated sizes of the logs.
+  int64_t charged_bytes ABSL_GUARDED_BY(mu) = 0;
+  // Bytes of the formatted logs, which are truncated to the budget.
+  int64_t formatted_bytes ABSL_GUARDED_BY(mu) = 0;
+  std::vector<Log> logs ABSL_GUARDED_BY(mu);
+  int num_pending ABSL_GUARDED_BY(mu) = 0;
+  int num_dropped ABSL_GUARDED_BY(mu) = 0;
+  // Lowest verbosity of the dropped logs, at which their count is emitted.
+  int dropped_verbosity ABSL_GUARDED_BY(mu) = std::numeric_limits<int>::max();
+
+  void Drop(int verbosity) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    ++num_dropped;
+    dropped_verbosity = std::min(dropped_verbosity, verbosity);
+  }
+};
+
+DeferredDebugLog::DeferredDebugLog(server_common::log::ContextImpl& log_context,
+                                   bool emit_inline, int64_t max_bytes)
+    : log_context_(log_context),
+      emit_inline_(emit_inline),
+      state_(std::make_shared<State>(max_bytes)) {}
+
+bool DeferredDebugLog::IsOn(int verbosity) const {
+  return log_context_.is_consented() ||
+         server_common::log::PS_VLOG_IS_ON(verbosity);
+}
+
+void DeferredDebugLog::Add(int verbosity, int64_t estimated_bytes,
+                           absl::AnyInvocable<std::string() &&> format) {
+  if (!IsOn(verbosity)) {
+    return;
+  }
+  if (emit_inline_) {
+    PS_VLOG(verbosity, log_context_) << std::move(format)();
+    return;
+  }
+  if (!Charge(verbosity, estimated_bytes)) {
+    return;
+  }
+  Enqueue(verbosity, std::move(format));
+}
+
+bool DeferredDebugLog::Charge(int verbosity, int64_t bytes) {
+  absl::MutexLock lock(&state_->mu);
+  if (state_->charged_bytes + bytes > state_->max_bytes) {
+    state_->Drop(verbosity);
+    return false;
+  }
+  state_->charged_bytes += bytes;
+  return true;
+}
+
+void DeferredDebugLog::Enqueue(int verbosity,
+                               absl::AnyInvocable<std::string() &&> format) {
+  int index;
+  {
+    absl::MutexLock lock(&state_->mu);
+    index = state_->logs.size();
+    state_->logs.push_back({.verbosity = verbosity});
+    ++state_->num_pending;
+  }
+  const bool queued = DebugLogFormatter::Get().Enqueue(
+      [state = state_, index, format = std::move(format)]() mutable {
+        std::string text = std::move(format)();
+        absl::MutexLock lock(&state->mu);
+        const int64_t remaining_bytes =
+            std::max<int64_t>(state->max_bytes - state->formatted_bytes, 0);
+        if (static_cast<int64_t>(text.size()) > remaining_bytes) {
+          text.resize(remaining_bytes);
+          text.append(kTruncated);
+        }
+        state->formatted_bytes += text.size();
+        state->logs[index].text = std::move(text);
+        --state->num_pending;
+      });
+  if (!queued) {
+    absl::MutexLock lock(&state_->mu);
+    state_->logs[index].dropped = true;
+    state_->Drop(verbosity);
+    --state_->num_pending;
+  }
+}
+
+void DeferredDebugLog::Flush() {
+  Flush([this](int verbosity, absl::string_view log) {
+    PS_VLOG(verbosity, log_context_) << log;
+  });
+}
+
+void DeferredDebugLog::Flush(
+    absl::FunctionRef<void(int verbosity, absl::string_view log)> emit) {
+  std::vector<State::Log> logs;
+  int num_dropped;
+  int dropped_verbosity;
+  {
+    absl::MutexLock lock(&state_->mu);
+    state_->mu.Await(absl::Condition(state_.get(), &State::NonePending));
+    logs.swap(state_->logs);
+    num_dropped = std::exchange(state_->num_dropped, 0);
+    dropped_verbosity = std::exchange(state_->dropped_verbosity,
+                                      std::numeric_limits<int>::max());
+  }
+  for (const State::Log& log : logs) {
+    if (!log.dropped) {
+      emit(log.verbosity, log.text);
+    }
+  }
+  if (num_dropped > 0) {
+    emit(dropped_verbosity,
+         absl::StrCat("Dropped ", num_dropped,
+                      " debug logs over the log budget of the request"));
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
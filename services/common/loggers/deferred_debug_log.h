@@ -0,0 +1,128 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_LOGGERS_DEFERRED_DEBUG_LOG_H_
+#define SERVICES_COMMON_LOGGERS_DEFERRED_DEBUG_LOG_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "src/logger/request_context_impl.h"
+#include "src/logger/request_context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Default budget of the formatted debug logs of a single request.
+inline constexpr int64_t kDefaultDebugLogMaxBytes = 1 << 20;
+
+// Debug logs of a request, such as dumps of its protos, whose formatting runs
+// on a shared background thread instead of the thread of the request. Each log
+// captures an immutable snapshot of what it prints, so the request may go on
+// changing its protos. The logs are only emitted by Flush, in order, through
+// the log context of the request, typically once its response is sent.
+//
+// A request has a budget of bytes of logs. Logs that do not fit in it, or that
+// find the queue of the background thread full, are dropped, and the number of
+// dropped logs is emitted instead. Nothing is captured unless the log would be
+// emitted, i.e. the request is consented or the verbosity is on. Requests that
+// ask for the debug info in their response format and emit each log right
+// away instead, so that the log makes it into the response.
+//
+//   debug_log_.AddMessage(kPlain, "GetBidsRawRequest:\n", raw_request_);
+//   ...
+//   void OnDone() override {
+//     debug_log_.Flush();
+//     delete this;
+//   }
+class DeferredDebugLog {
+ public:
+  // `log_context` must outlive the calls to Flush.
+  explicit DeferredDebugLog(server_common::log::ContextImpl& log_context,
+                            bool emit_inline = false,
+                            int64_t max_bytes = kDefaultDebugLogMaxBytes);
+
+  // DeferredDebugLog is neither copyable nor movable.
+  DeferredDebugLog(const DeferredDebugLog&) = delete;
+  DeferredDebugLog& operator=(const DeferredDebugLog&) = delete;
+
+  // Sets whether logs are formatted and emitted right away, for requests whose
+  // consented debug config is only known once they are decrypted. Must be
+  // called before any log is added.
+  void set_emit_inline(bool emit_inline) { emit_inline_ = emit_inline; }
+
+  // Whether logs of `verbosity` are emitted for the request.
+  bool IsOn(int verbosity) const;
+
+  // Queues `format`, which returns the log, to run on the background thread.
+  // `format` must own whatever it reads. `estimated_bytes` are charged to the
+  // budget of the request right away, before the log is formatted.
+  void Add(int verbosity, int64_t estimated_bytes,
+           absl::AnyInvocable<std::string() &&> format);
+
+  // Logs the text format of a copy of `message`, after `title`.
+  template <typename Message>
+  void AddMessage(int verbosity, absl::string_view title,
+                  const Message& message) {
+    if (!IsOn(verbosity)) {
+      return;
+    }
+    if (emit_inline_) {
+      PS_VLOG(verbosity, log_context_) << title << message.ShortDebugString();
+      return;
+    }
+    // Checks the budget before copying the message.
+    if (!Charge(verbosity, title.size() + message.ByteSizeLong())) {
+      return;
+    }
+    Enqueue(verbosity, [title = std::string(title),
+                        snapshot = std::make_unique<Message>(message)]() {
+      return absl::StrCat(title, snapshot->ShortDebugString());
+    });
+  }
+
+  // Waits for the queued logs to be formatted and emits them in order through
+  // the log context.
+  void Flush();
+
+  // Same as above, but emits the logs to `emit`.
+  void Flush(
+      absl::FunctionRef<void(int verbosity, absl::string_view log)> emit);
+
+ private:
+  struct State;
+
+  // Charges `bytes` to the budget if they fit in it, otherwise counts a
+  // dropped log of `verbosity`. Returns whether they fit.
+  bool Charge(int verbosity, int64_t bytes);
+
+  // Queues `format` on the background thread, or drops the log if the queue
+  // is full.
+  void Enqueue(int verbosity, absl::AnyInvocable<std::string() &&> format);
+
+  server_common::log::ContextImpl& log_context_;
+  bool emit_inline_;
+  // Shared with the background thread, which may still format logs of the
+  // request after it is gone.
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_LOGGERS_DEFERRED_DEBUG_LOG_H_
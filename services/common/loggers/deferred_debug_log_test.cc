@@ -0,0 +1,92 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/loggers/deferred_debug_log.h"
+
+#include <string>
+#include <vector>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+constexpr int kVerbosity = 1;
+
+class DeferredDebugLogTest : public ::testing::Test {
+ protected:
+  void SetUp() override { server_common::log::PS_VLOG_IS_ON(0, 10); }
+
+  std::vector<std::pair<int, std::string>> Flush(DeferredDebugLog& debug_log) {
+    std::vector<std::pair<int, std::string>> logs;
+    debug_log.Flush([&logs](int verbosity, absl::string_view log) {
+      logs.emplace_back(verbosity, log);
+    });
+    return logs;
+  }
+
+  server_common::log::ContextImpl log_context_{
+      absl::btree_map<std::string, std::string>{},
+      server_common::ConsentedDebugConfiguration()};
+};
+
+TEST_F(DeferredDebugLogTest, EmitsSnapshotsOfMessagesInOrder) {
+  DeferredDebugLog debug_log(log_context_);
+  AdWithBid ad_with_bid;
+  ad_with_bid.set_render("first");
+
+  debug_log.AddMessage(kVerbosity, "AdWithBid: ", ad_with_bid);
+  ad_with_bid.set_render("second");
+  debug_log.Add(kVerbosity + 1, /*estimated_bytes=*/4,
+                []() { return std::string("text"); });
+
+  EXPECT_THAT(Flush(debug_log),
+              ElementsAre(Pair(kVerbosity, R"(AdWithBid: render: "first")"),
+                          Pair(kVerbosity + 1, "text")));
+  EXPECT_THAT(Flush(debug_log), IsEmpty());
+}
+
+TEST_F(DeferredDebugLogTest, DropsLogsOverBudget) {
+  DeferredDebugLog debug_log(log_context_, /*emit_inline=*/false,
+                             /*max_bytes=*/6);
+
+  debug_log.Add(kVerbosity, /*estimated_bytes=*/4,
+                []() { return std::string("kept"); });
+  debug_log.Add(kVerbosity, /*estimated_bytes=*/4,
+                []() { return std::string("dropped"); });
+
+  EXPECT_THAT(Flush(debug_log),
+              ElementsAre(Pair(kVerbosity, "kept"),
+                          Pair(kVerbosity, HasSubstr("Dropped 1 debug logs"))));
+}
+
+TEST_F(DeferredDebugLogTest, TruncatesLogsLongerThanEstimated) {
+  DeferredDebugLog debug_log(log_context_, /*emit_inline=*/false,
+                             /*max_bytes=*/4);
+
+  debug_log.Add(kVerbosity, /*estimated_bytes=*/1,
+                []() { return std::string("truncated"); });
+
+  EXPECT_THAT(Flush(debug_log), ElementsAre(Pair(kVerbosity, "trun...")));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
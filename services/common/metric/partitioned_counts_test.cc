@@ -0,0 +1,66 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/metric/partitioned_counts.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::metric {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+inline constexpr int kTestCounter = 0;
+inline constexpr absl::string_view kTestPartitions[] = {"a", "b", "c"};
+
+static_assert(PartitionIndex(kTestPartitions, "b") == 1);
+static_assert(PartitionIndex(kTestPartitions, "d") == -1);
+
+// Records the metrics accumulated, like a metric context.
+struct FakeMetricContext {
+  template <const auto& definition>
+  absl::Status AccumulateMetric(int value, absl::string_view partition) {
+    accumulated.emplace_back(std::string(partition), value);
+    return absl::OkStatus();
+  }
+
+  std::vector<std::pair<std::string, int>> accumulated;
+};
+
+TEST(PartitionedCountsTest, LogsNonZeroCountsOnce) {
+  PartitionedCounts<kTestCounter, kTestPartitions> counts;
+  counts.Add(PartitionIndex(kTestPartitions, "c"));
+  counts.Add("a", 2);
+  counts.Add("c");
+  // Not a partition of the counter.
+  counts.Add("d");
+
+  FakeMetricContext context;
+  ASSERT_TRUE(counts.LogTo(context).ok());
+  EXPECT_THAT(context.accumulated, ElementsAre(Pair("a", 2), Pair("c", 2)));
+
+  FakeMetricContext next_context;
+  ASSERT_TRUE(counts.LogTo(next_context).ok());
+  EXPECT_THAT(next_context.accumulated, IsEmpty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::metric
@@ -16,13 +16,24 @@
 #define SERVICES_COMMON_METRIC_SERVER_DEFINITION_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
+#include "services/common/code_fetch/code_load_tracker.h"
+#include "services/common/code_fetch/code_version_splitter.h"
+#include "services/common/concurrent/work_stealing_executor.h"
+#include "services/common/encryption/caching_key_fetcher_manager.h"
 #include "services/common/metric/error_code.h"
+#include "services/common/util/large_buffer_pool.h"
 #include "services/common/util/read_system.h"
 #include "services/common/util/reporting_util.h"
+#include "services/common/util/request_phase_tracer.h"
+#include "services/common/util/server_drain.h"
+#include "services/common/util/tcmalloc_tuner.h"
+#include "services/common/util/tcmalloc_utils.h"
 #include "src/metric/context_map.h"
 #include "src/metric/definition.h"
 #include "src/metric/key_fetch.h"
@@ -49,6 +60,16 @@ inline constexpr absl::string_view kServerName[]{
 
 constexpr int kMaxBuyersSolicited = 2;
 
+// Stages of a SelectAd request on its critical path, as named by
+// AuctionCriticalPath.
+inline constexpr absl::string_view kCriticalPathStage[] = {
+    "decode", "get_bids", "scoring_signals", "score_ads", "reporting",
+};
+
+inline constexpr double kRequestPhaseHistogram[] = {
+    50,     100,    250,     500,     1'000,   2'500,  5'000,
+    10'000, 25'000, 50'000, 100'000, 250'000, 500'000};
+
 // Metric Definitions that are specific to bidding & auction servers.
 
 inline constexpr server_common::metrics::Definition<
@@ -72,6 +93,58 @@ inline constexpr server_common::metrics::Definition<
                          "Time taken to execute the JS dispatcher",
                          server_common::metrics::kTimeHistogram, 300, 10);
 
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kJSExecutionQueueWait("js_execution.queue_wait_ms",
+                          "Time the JS dispatcher requests waited for a Roma "
+                          "worker before running",
+                          server_common::metrics::kTimeHistogram, 300, 10);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kJSExecutionRunDuration("js_execution.run_duration_ms",
+                            "Time the JS dispatcher requests spent running "
+                            "in a Roma worker",
+                            server_common::metrics::kTimeHistogram, 300, 10);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kJSExecutionBatchSkew("js_execution.batch_skew_ms",
+                          "Run time of the slowest minus the fastest request "
+                          "of a JS dispatcher batch",
+                          server_common::metrics::kTimeHistogram, 300, 10);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kJSExecutionDurationByOwner(
+        /*name*/ "js_execution.duration_by_owner_ms",
+        /*description*/
+        "Time the JS dispatcher requests spent running in a Roma worker for "
+        "the ads of each interest group owner",
+        /*partition_type*/ "buyer",
+        /*max_partitions_contributed*/ kMaxBuyersSolicited,
+        /*public_partitions*/ server_common::metrics::kEmptyPublicPartition,
+        /*upper_bound*/ 1'000,
+        /*lower_bound*/ 0);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kAuctionBidOverBudgetCountByOwner(
+        /*name*/ "auction.business_logic.bid_over_budget_count",
+        /*description*/
+        "Number of bids not considered by the auction service because the "
+        "scoring time of their interest group owner exceeded its budget",
+        /*partition_type*/ "buyer",
+        /*max_partitions_contributed*/ kMaxBuyersSolicited,
+        /*public_partitions*/ server_common::metrics::kEmptyPublicPartition,
+        /*upper_bound*/ 100,
+        /*lower_bound*/ 0);
+
 inline constexpr server_common::metrics::Definition<
     int, server_common::metrics::Privacy::kImpacting,
     server_common::metrics::Instrument::kUpDownCounter>
@@ -232,6 +305,201 @@ inline constexpr server_common::metrics::Definition<
     server_common::metrics::Instrument::kGauge>
     kThreadCount("system.thread.count", "Thread Count");
 
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kMallocBytes("system.memory.tcmalloc_bytes",
+                 "Bytes allocated, held as heap, held free, cached per thread "
+                 "or CPU, and lost to fragmentation, as reported by TCMalloc");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kMallocTuning("system.memory.tcmalloc_tuning",
+                  "Max total thread cache bytes and background release rate "
+                  "TCMalloc is tuned to, memory headroom of the container, "
+                  "and tuning steps by decision");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kHttpFetcherShardQueueDepth(
+        "system.http_fetcher.shard.queue_depth",
+        "Number of pending HTTP requests per HTTP fetcher shard");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kRomaQueueDepth("system.roma.queue_depth",
+                    "Number of requests handed to Roma which did not finish "
+                    "yet, queued or running");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kRomaWorkerRecycles("system.roma.worker_recycles",
+                        "Number of times the V8 isolates of the Roma workers "
+                        "were recycled to give back the memory of the UDFs");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kRomaWarmUpLatency("system.roma.warm_up_latency_ms",
+                       "Latency of the first and last round of warm-up "
+                       "executions run after the latest code load");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kRomaPayloadSize("system.roma.payload_bytes",
+                     "Percentiles of the size of the inputs of the requests "
+                     "handed to Roma, in bytes");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kInferenceCacheLookupRatio(
+        "bidding.inference.cache_lookup_ratio",
+        "Share of model requests served from the cache of model outputs or "
+        "sent to the inference sidecar");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kInferenceModelLatency(
+        "bidding.inference.model.latency_ms",
+        "Mean time the inference sidecar spent on the inference of each model, "
+        "by model path");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kInferenceModelQueueTime(
+        "bidding.inference.model.queue_time_ms",
+        "Mean time the inference of each model waited for a worker thread of "
+        "the inference sidecar, by model path");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kInferenceModelBatchSize("bidding.inference.model.batch_size",
+                             "Mean batch size of the inferences of each "
+                             "model, by model path");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kInferenceModelErrorCount("bidding.inference.model.error_count",
+                              "Number of failed inferences of each model, by "
+                              "model path");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kHttpFetcherShardLoopLagMs(
+        "system.http_fetcher.shard.loop_lag_ms",
+        "Delay of the periodic event loop timer per HTTP fetcher shard in "
+        "milliseconds");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kHttpFetcherShardLoopStallMs(
+        "system.http_fetcher.shard.loop_stall_ms",
+        "Longest time a single socket or timer event held the event loop of "
+        "an HTTP fetcher shard in milliseconds");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kGrpcRequestCompressionShare(
+        "system.grpc.request_compression_share",
+        "Share of the bytes of the gRPC requests to the backends sent with "
+        "each compression algorithm");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kHttpFetcherReuseRatio(
+        "system.http_fetcher.reuse_ratio",
+        "Share of HTTP requests that reused an idle curl easy handle or an "
+        "open connection");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kBfeKVLookupRatio(
+        "bfe.kv.lookup_ratio",
+        "Share of KV lookups that were cache hits, misses or coalesced with an "
+        "in-flight lookup");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kSfeDebugReportingCount(
+        "sfe.debug_reporting.report_count",
+        "Number of debug reporting pings sent, sampled out or dropped on a "
+        "full queue");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kPrivateKeyLookupRatio(
+        "system.key_fetcher.private_key_lookup_ratio",
+        "Share of private key lookups served from the key snapshot, from the "
+        "key store or for unknown key ids");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kCodeLoadCount("system.code_fetcher.load_count",
+                   "Number of fetched UDF code loads into Roma performed, or "
+                   "skipped because the code was unchanged");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kDrainDuration("system.drain.duration_ms",
+                   "Time taken by each phase of the drain of the server on "
+                   "SIGTERM, exported by the last telemetry flush");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kCodeVersionExecutionDuration(
+        "system.code_version.js_execution.duration_ms",
+        "Mean time taken to execute a JS batch, by split UDF version");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kCodeVersionExecutionErrorRate(
+        "system.code_version.js_execution.error_rate",
+        "Share of JS executions returning status != OK, by split UDF version");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kPublicKeySelectionLatencyMs(
+        "system.key_fetcher.public_key_selection_ms",
+        "Percentiles of the time taken to select the public key of outbound "
+        "requests in milliseconds");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kExecutorTaskQueueLatencyMs(
+        "system.executor.task_queue_ms",
+        "Percentiles of the time the tasks of the work-stealing executor wait "
+        "to run in milliseconds, by priority class");
+
+inline constexpr server_common::metrics::Definition<
+    double, server_common::metrics::Privacy::kNonImpacting,
+    server_common::metrics::Instrument::kGauge>
+    kLargeBufferPool("system.large_buffer_pool",
+                     "Bytes mapped by the large buffer pool, and the share of "
+                     "its acquisitions served with a pooled buffer");
+
 inline constexpr server_common::metrics::Definition<
     int, server_common::metrics::Privacy::kImpacting,
     server_common::metrics::Instrument::kUpDownCounter>
@@ -242,6 +510,28 @@ inline constexpr server_common::metrics::Definition<
         /*upper_bound*/ 100,
         /*lower_bound*/ 0);
 
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kUpDownCounter>
+    kBfeTruncatedBidsCount(
+        /*name*/ "bfe.business_logic.truncated_bids_count",
+        /*description*/
+        "Total number of bids dropped by BFE for exceeding the bid budget of "
+        "a GetBids response",
+        /*upper_bound*/ 100,
+        /*lower_bound*/ 0);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kUpDownCounter>
+    kSfeTruncatedBidsCount(
+        /*name*/ "sfe.business_logic.truncated_bids_count",
+        /*description*/
+        "Total number of bids dropped by SFE for exceeding the bid budget of "
+        "a buyer or of the auction",
+        /*upper_bound*/ 100,
+        /*lower_bound*/ 0);
+
 inline constexpr server_common::metrics::Definition<
     int, server_common::metrics::Privacy::kImpacting,
     server_common::metrics::Instrument::kUpDownCounter>
@@ -330,6 +620,33 @@ inline constexpr server_common::metrics::Definition<
         /*upper_bound*/ 1,
         /*lower_bound*/ 0);
 
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kSfeInitiatedRequestHedgedCountByBuyer(
+        /*name*/ "sfe.initiated_request.to_bfe.hedged_count_by_buyer",
+        /*description*/
+        "Total number of hedged requests initiated per buyer",
+        /*partition_type*/ "buyer",
+        /*max_partitions_contributed*/ kMaxBuyersSolicited,
+        /*public_partitions*/ server_common::metrics::kEmptyPublicPartition,
+        /*upper_bound*/ 1,
+        /*lower_bound*/ 0);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kSfeInitiatedRequestCancelledCountByBuyer(
+        /*name*/ "sfe.initiated_request.to_bfe.cancelled_count_by_buyer",
+        /*description*/
+        "Total number of requests per buyer that were skipped or cut short to "
+        "meet the deadline of the SelectAd request",
+        /*partition_type*/ "buyer",
+        /*max_partitions_contributed*/ kMaxBuyersSolicited,
+        /*public_partitions*/ server_common::metrics::kEmptyPublicPartition,
+        /*upper_bound*/ 1,
+        /*lower_bound*/ 0);
+
 inline constexpr server_common::metrics::Definition<
     int, server_common::metrics::Privacy::kImpacting,
     server_common::metrics::Instrument::kPartitionedCounter>
@@ -447,6 +764,96 @@ inline constexpr server_common::metrics::Definition<
         /*upper_bound*/ 1,
         /*lower_bound*/ 0);
 
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseDecryptDuration(
+        /*name*/ "request_phase.decrypt.duration_us",
+        /*description*/
+        "Time spent decrypting the request, for traced requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseDecodeDuration(
+        /*name*/ "request_phase.decode.duration_us",
+        /*description*/
+        "Time spent decoding the client input of the request, for traced "
+        "requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseFanOutDuration(
+        /*name*/ "request_phase.fan_out.duration_us",
+        /*description*/
+        "Time spent waiting for the requests sent to the buyers or to the "
+        "bidding server, for traced requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseKvDuration(
+        /*name*/ "request_phase.kv.duration_us",
+        /*description*/
+        "Time spent waiting for the KV server, for traced requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseRomaDuration(
+        /*name*/ "request_phase.roma.duration_us",
+        /*description*/
+        "Time spent waiting for Roma to run the UDFs, including queueing, "
+        "for traced requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseWinnerSelectionDuration(
+        /*name*/ "request_phase.winner_selection.duration_us",
+        /*description*/
+        "Time spent waiting for the auction server to score the ads, for "
+        "traced requests",
+        kRequestPhaseHistogram, 500'000, 0);
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kHistogram>
+    kRequestPhaseEncryptDuration(
+        /*name*/ "request_phase.encrypt.duration_us",
+        /*description*/
+        "Time spent serializing and encrypting the response, for traced "
+        "requests",
+        kRequestPhaseHistogram, 500'000, 0);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kSfeCriticalPathStageDuration(
+        /*name*/ "sfe.critical_path.stage_duration_us",
+        /*description*/
+        "Time the critical path of traced SelectAd requests spent in each "
+        "stage",
+        /*partition_type*/ "stage",
+        /*max_partitions_contributed*/ 5,
+        /*public_partitions*/ kCriticalPathStage,
+        /*upper_bound*/ 500'000,
+        /*lower_bound*/ 0);
+
+inline constexpr server_common::metrics::Definition<
+    int, server_common::metrics::Privacy::kImpacting,
+    server_common::metrics::Instrument::kPartitionedCounter>
+    kSfeCriticalPathBuyerDuration(
+        /*name*/ "sfe.critical_path.buyer_duration_us",
+        /*description*/
+        "Time the critical path of traced SelectAd requests spent waiting for "
+        "the buyer whose bids were ready last",
+        /*partition_type*/ "buyer",
+        /*max_partitions_contributed*/ 1,
+        /*public_partitions*/ server_common::metrics::kEmptyPublicPartition,
+        /*upper_bound*/ 500'000,
+        /*lower_bound*/ 0);
+
 template <typename RequestT>
 struct RequestMetric;
 
@@ -462,6 +869,18 @@ inline auto* MetricContextMap(
       kServerTotalBudget);
 }
 
+// Creates a metric context owned by the caller, typically the reactor of the
+// request, rather than by the context map. Unlike
+// MetricContextMap<RequestT>()->Get/Remove, it takes no lock shared by every
+// request. The context logs through the router of the context map, so the
+// privacy budget and noise of the metrics are the same.
+template <typename RequestT>
+inline std::unique_ptr<typename RequestMetric<RequestT>::ContextType>
+CreateMetricContext() {
+  return RequestMetric<RequestT>::ContextType::GetContext(
+      MetricContextMap<RequestT>()->metric_router());
+}
+
 // API to get `Context` for bidding server to log metric
 inline constexpr const server_common::metrics::DefinitionName*
     kBiddingMetricList[] = {
@@ -474,8 +893,14 @@ inline constexpr const server_common::metrics::DefinitionName*
         &kBiddingZeroBidCount,
         &kBiddingZeroBidPercent,
         &kJSExecutionDuration,
+        &kJSExecutionQueueWait,
+        &kJSExecutionRunDuration,
+        &kJSExecutionBatchSkew,
         &kJSExecutionErrorCount,
         &kBiddingErrorCountByErrorCode,
+        &kRequestPhaseDecryptDuration,
+        &kRequestPhaseRomaDuration,
+        &kRequestPhaseEncryptDuration,
 };
 
 template <>
@@ -508,6 +933,11 @@ inline constexpr const server_common::metrics::DefinitionName*
         &kBfeInitiatedResponseKVSize,
         &kInitiatedResponseBiddingSize,
         &kBfeErrorCountByErrorCode,
+        &kBfeTruncatedBidsCount,
+        &kRequestPhaseDecryptDuration,
+        &kRequestPhaseKvDuration,
+        &kRequestPhaseFanOutDuration,
+        &kRequestPhaseEncryptDuration,
 };
 
 template <>
@@ -532,6 +962,8 @@ inline constexpr const server_common::metrics::DefinitionName*
         &kInitiatedRequestBfeErrorCountByStatus,
         &kRequestFailedCountByStatus,
         &kSfeInitiatedRequestErrorsCountByBuyer,
+        &kSfeInitiatedRequestHedgedCountByBuyer,
+        &kSfeInitiatedRequestCancelledCountByBuyer,
         &kSfeInitiatedRequestDurationByBuyer,
         &kSfeInitiatedRequestCountByBuyer,
         &kSfeInitiatedResponseSizeByBuyer,
@@ -549,6 +981,15 @@ inline constexpr const server_common::metrics::DefinitionName*
         &kProtectedCiphertextSize,
         &kAuctionConfigSize,
         &kAuctionBidRejectedCount,
+        &kSfeTruncatedBidsCount,
+        &kRequestPhaseDecryptDuration,
+        &kRequestPhaseDecodeDuration,
+        &kRequestPhaseFanOutDuration,
+        &kRequestPhaseKvDuration,
+        &kRequestPhaseWinnerSelectionDuration,
+        &kRequestPhaseEncryptDuration,
+        &kSfeCriticalPathStageDuration,
+        &kSfeCriticalPathBuyerDuration,
 };
 
 template <>
@@ -573,8 +1014,16 @@ inline constexpr const server_common::metrics::DefinitionName*
         &kAuctionBidRejectedCount,
         &kAuctionBidRejectedPercent,
         &kJSExecutionDuration,
+        &kJSExecutionQueueWait,
+        &kJSExecutionRunDuration,
+        &kJSExecutionBatchSkew,
+        &kJSExecutionDurationByOwner,
+        &kAuctionBidOverBudgetCountByOwner,
         &kJSExecutionErrorCount,
         &kAuctionErrorCountByErrorCode,
+        &kRequestPhaseDecryptDuration,
+        &kRequestPhaseRomaDuration,
+        &kRequestPhaseEncryptDuration,
 };
 
 template <>
@@ -704,6 +1153,67 @@ std::unique_ptr<InitiatedRequest<ContextT>> MakeInitiatedRequest(
   return InitiatedRequest<ContextT>::Get(request_destination, context);
 }
 
+// Logs how the time taken by Roma to run the UDFs of a request splits between
+// waiting for a worker and running.
+template <typename ContextT>
+void LogJSExecutionSplit(absl::Span<const absl::Duration> queue_waits,
+                         absl::Span<const absl::Duration> executions,
+                         std::optional<absl::Duration> skew,
+                         ContextT& context) {
+  for (absl::Duration queue_wait : queue_waits) {
+    LogIfError(context.template LogHistogram<kJSExecutionQueueWait>(
+        static_cast<int>(queue_wait / absl::Milliseconds(1))));
+  }
+  for (absl::Duration execution : executions) {
+    LogIfError(context.template LogHistogram<kJSExecutionRunDuration>(
+        static_cast<int>(execution / absl::Milliseconds(1))));
+  }
+  if (skew.has_value()) {
+    LogIfError(context.template LogHistogram<kJSExecutionBatchSkew>(
+        static_cast<int>(*skew / absl::Milliseconds(1))));
+  }
+}
+
+template <const auto& DurationMetric, typename ContextT>
+void LogRequestPhase(const RequestPhaseTracer& tracer, RequestPhase phase,
+                     ContextT& context) {
+  if (std::optional<absl::Duration> duration = tracer.GetDuration(phase)) {
+    LogIfError(context.template LogHistogram<DurationMetric>(
+        static_cast<int>(*duration / absl::Microseconds(1))));
+  }
+}
+
+// Logs the phases traced for a request to the metric context of its server.
+// Phases a server does not go through are not logged.
+template <typename ContextT>
+void LogRequestPhases(const RequestPhaseTracer& tracer, ContextT& context) {
+  if (!tracer.enabled()) {
+    return;
+  }
+  LogRequestPhase<kRequestPhaseDecryptDuration>(tracer, RequestPhase::kDecrypt,
+                                                context);
+  LogRequestPhase<kRequestPhaseEncryptDuration>(tracer, RequestPhase::kEncrypt,
+                                                context);
+  if constexpr (std::is_same_v<ContextT, BiddingContext> ||
+                std::is_same_v<ContextT, AuctionContext>) {
+    LogRequestPhase<kRequestPhaseRomaDuration>(
+        tracer, RequestPhase::kRomaDispatch, context);
+  }
+  if constexpr (std::is_same_v<ContextT, BfeContext> ||
+                std::is_same_v<ContextT, SfeContext>) {
+    LogRequestPhase<kRequestPhaseKvDuration>(tracer, RequestPhase::kKvLookup,
+                                             context);
+    LogRequestPhase<kRequestPhaseFanOutDuration>(
+        tracer, RequestPhase::kFanOut, context);
+  }
+  if constexpr (std::is_same_v<ContextT, SfeContext>) {
+    LogRequestPhase<kRequestPhaseDecodeDuration>(
+        tracer, RequestPhase::kDecode, context);
+    LogRequestPhase<kRequestPhaseWinnerSelectionDuration>(
+        tracer, RequestPhase::kWinnerSelection, context);
+  }
+}
+
 }  // namespace metric
 
 template <typename T>
@@ -713,6 +1223,9 @@ inline void AddSystemMetric(T* context_map) {
   context_map->AddObserverable(server_common::metrics::kMemoryKB,
                                server_common::GetMemory);
   context_map->AddObserverable(metric::kThreadCount, server_common::GetThread);
+  context_map->AddObserverable(metric::kMallocBytes, GetMallocStats);
+  context_map->AddObserverable(metric::kMallocTuning,
+                               TcmallocTuner::GetStats);
   context_map->AddObserverable(
       server_common::metrics::kKeyFetchFailureCount,
       server_common::KeyFetchResultCounter::GetKeyFetchFailureCount);
@@ -722,6 +1235,24 @@ inline void AddSystemMetric(T* context_map) {
   context_map->AddObserverable(
       server_common::metrics::kNumKeysCached,
       server_common::KeyFetchResultCounter::GetNumKeysCached);
+  context_map->AddObserverable(
+      metric::kPublicKeySelectionLatencyMs,
+      CachingKeyFetcherManager::GetPublicKeySelectionLatencyMs);
+  context_map->AddObserverable(
+      metric::kPrivateKeyLookupRatio,
+      CachingKeyFetcherManager::GetPrivateKeyLookupRatios);
+  context_map->AddObserverable(metric::kExecutorTaskQueueLatencyMs,
+                               WorkStealingExecutor::GetTaskQueueLatencyMs);
+  context_map->AddObserverable(metric::kLargeBufferPool,
+                               LargeBufferPool::GetStats);
+  context_map->AddObserverable(metric::kCodeLoadCount,
+                               CodeLoadTracker::GetCodeLoadCounts);
+  context_map->AddObserverable(metric::kDrainDuration,
+                               ServerDrain::GetDrainDurationsMs);
+  context_map->AddObserverable(metric::kCodeVersionExecutionDuration,
+                               CodeVersionSplitter::GetExecutionDurationsMs);
+  context_map->AddObserverable(metric::kCodeVersionExecutionErrorRate,
+                               CodeVersionSplitter::GetExecutionErrorRates);
 }
 
 inline void AddBuyerPartition(
@@ -731,6 +1262,10 @@ inline void AddBuyerPartition(
                                                    buyer_list.end()};
   telemetry_config.SetPartition(
       metric::kSfeInitiatedRequestErrorsCountByBuyer.name_, buyer_list_view);
+  telemetry_config.SetPartition(
+      metric::kSfeInitiatedRequestHedgedCountByBuyer.name_, buyer_list_view);
+  telemetry_config.SetPartition(
+      metric::kSfeInitiatedRequestCancelledCountByBuyer.name_, buyer_list_view);
   telemetry_config.SetPartition(metric::kSfeInitiatedRequestCountByBuyer.name_,
                                 buyer_list_view);
   telemetry_config.SetPartition(
@@ -777,9 +1312,10 @@ inline void AddErrorTypePartition(
   }
 }
 
-template <typename RequestT, typename ResponseT>
-void LogCommonMetric(const RequestT* request, const ResponseT* response) {
-  auto& metric_context = metric::MetricContextMap<RequestT>()->Get(request);
+// Logs the metrics common to every request in `metric_context`.
+template <typename RequestT, typename ResponseT, typename ContextT>
+void LogCommonMetric(const RequestT* request, const ResponseT* response,
+                     ContextT& metric_context) {
   LogIfError(metric_context.template LogUpDownCounterDeferred<
              server_common::metrics::kTotalRequestCount>(
       []() -> int { return 1; }));
@@ -807,6 +1343,25 @@ void LogCommonMetric(const RequestT* request, const ResponseT* response) {
       }));
 }
 
+// Logs the metrics common to every request in the context of the request in
+// the context map, to be removed from it by the reactor of the request.
+template <typename RequestT, typename ResponseT>
+void LogCommonMetric(const RequestT* request, const ResponseT* response) {
+  LogCommonMetric(request, response,
+                  metric::MetricContextMap<RequestT>()->Get(request));
+}
+
+// Logs the metrics common to every request for a request rejected before a
+// reactor was created for it, e.g. by admission control.
+template <typename RequestT, typename ResponseT>
+void LogRejectedRequestMetric(const RequestT* request,
+                              const ResponseT* response,
+                              const absl::Status& status) {
+  auto metric_context = metric::CreateMetricContext<RequestT>();
+  LogCommonMetric(request, response, *metric_context);
+  metric_context->SetRequestResult(status);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_METRIC_SERVER_DEFINITION_H_
@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -48,7 +49,12 @@ class AsyncReporter {
       absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
           done_callback) const;
 
- private:
+  // Waits until the reports made so far are sent, or until `deadline`, e.g.
+  // while the server drains. Returns false if some are left. Reports are
+  // sent as they are made, so there is nothing to wait for by default.
+  virtual bool Flush(absl::Time deadline) { return true; }
+
+ protected:
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
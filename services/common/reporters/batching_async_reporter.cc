@@ -0,0 +1,204 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/reporters/batching_async_reporter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr char kSent[] = "sent";
+inline constexpr char kSampledOut[] = "sampled_out";
+inline constexpr char kDropped[] = "dropped";
+
+// Report outcomes of all instances since the last GetReportCounts call.
+std::atomic<int64_t> num_sent = 0;
+std::atomic<int64_t> num_sampled_out = 0;
+std::atomic<int64_t> num_dropped = 0;
+
+// Returns the host, and port if any, of the URL.
+absl::string_view GetUrlHost(absl::string_view url) {
+  if (size_t scheme_end = url.find("://"); scheme_end != url.npos) {
+    url.remove_prefix(scheme_end + 3);
+  }
+  return url.substr(0, url.find_first_of("/?#"));
+}
+
+bool IsSampledOut(int sampling_percent) {
+  if (sampling_percent >= 100) {
+    return false;
+  }
+  thread_local absl::BitGen bit_gen;
+  return absl::Uniform(bit_gen, 0, 100) >= sampling_percent;
+}
+
+}  // namespace
+
+BatchingAsyncReporter::BatchingAsyncReporter(
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+    BatchingReporterOptions options)
+    : AsyncReporter(std::move(http_fetcher_async)),
+      options_(std::move(options)),
+      worker_([this]() { Run(); }) {}
+
+BatchingAsyncReporter::~BatchingAsyncReporter() {
+  std::vector<Report> dropped;
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+    for (auto& [host, reports] : reports_by_host_) {
+      for (Report& report : reports.queued) {
+        dropped.push_back(std::move(report));
+      }
+      reports.queued.clear();
+    }
+    num_queued_ = 0;
+  }
+  worker_.join();
+  for (Report& report : dropped) {
+    std::move(report.done_callback)(
+        absl::CancelledError("Reporter destroyed before sending the report"));
+  }
+  // The callbacks of the reports in flight still use the reporter.
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(this, &BatchingAsyncReporter::HasNoneInFlight));
+}
+
+void BatchingAsyncReporter::DoReport(
+    const HTTPRequest& reporting_request,
+    absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
+        done_callback) const {
+  if (IsSampledOut(options_.sampling_percent)) {
+    ++num_sampled_out;
+    std::move(done_callback)(absl::CancelledError("Report sampled out"));
+    return;
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    if (!stopping_ && num_queued_ < options_.max_queued_reports) {
+      reports_by_host_[GetUrlHost(reporting_request.url)].queued.push_back(
+          {.request = reporting_request,
+           .done_callback = std::move(done_callback)});
+      ++num_queued_;
+      has_reports_to_send_ = true;
+      return;
+    }
+  }
+  ++num_dropped;
+  std::move(done_callback)(
+      absl::ResourceExhaustedError("Reporting queue is full"));
+}
+
+bool BatchingAsyncReporter::Flush(absl::Time deadline) {
+  absl::MutexLock lock(&mu_);
+  return mu_.AwaitWithDeadline(
+      absl::Condition(this, &BatchingAsyncReporter::HasNoReports), deadline);
+}
+
+void BatchingAsyncReporter::Run() {
+  while (true) {
+    std::vector<std::pair<std::string, std::vector<Report>>> batches;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &BatchingAsyncReporter::HasWork));
+      if (stopping_) {
+        return;
+      }
+      has_reports_to_send_ = false;
+      for (auto& [host, reports] : reports_by_host_) {
+        while (!reports.queued.empty() &&
+               reports.num_in_flight < options_.max_in_flight_per_host) {
+          const int batch_size = std::min<int>(
+              {options_.max_batch_size,
+               options_.max_in_flight_per_host - reports.num_in_flight,
+               static_cast<int>(reports.queued.size())});
+          std::vector<Report> batch;
+          batch.reserve(batch_size);
+          for (int i = 0; i < batch_size; ++i) {
+            batch.push_back(std::move(reports.queued.front()));
+            reports.queued.pop_front();
+          }
+          reports.num_in_flight += batch_size;
+          num_in_flight_ += batch_size;
+          num_queued_ -= batch_size;
+          batches.emplace_back(host, std::move(batch));
+        }
+      }
+    }
+    // The fetches are started without the lock, so that DoReport calls do
+    // not wait for them.
+    for (auto& [host, batch] : batches) {
+      SendBatch(std::move(host), std::move(batch));
+    }
+  }
+}
+
+bool BatchingAsyncReporter::HasWork() const {
+  return stopping_ || has_reports_to_send_;
+}
+
+bool BatchingAsyncReporter::HasNoneInFlight() const {
+  return num_in_flight_ == 0;
+}
+
+bool BatchingAsyncReporter::HasNoReports() const {
+  return num_queued_ == 0 && num_in_flight_ == 0;
+}
+
+void BatchingAsyncReporter::SendBatch(std::string host,
+                                      std::vector<Report> batch) {
+  std::vector<HTTPRequest> requests;
+  requests.reserve(batch.size());
+  for (Report& report : batch) {
+    requests.push_back(std::move(report.request));
+  }
+  http_fetcher_async_->FetchUrls(
+      requests, options_.timeout,
+      [this, host = std::move(host), batch = std::move(batch)](
+          std::vector<absl::StatusOr<std::string>> results) mutable {
+        for (int i = 0; i < batch.size(); ++i) {
+          if (results[i].ok()) {
+            std::move(batch[i].done_callback)(absl::string_view(*results[i]));
+          } else {
+            std::move(batch[i].done_callback)(results[i].status());
+          }
+        }
+        num_sent += batch.size();
+        absl::MutexLock lock(&mu_);
+        auto it = reports_by_host_.find(host);
+        it->second.num_in_flight -= batch.size();
+        num_in_flight_ -= batch.size();
+        if (!it->second.queued.empty()) {
+          has_reports_to_send_ = true;
+        } else if (it->second.num_in_flight == 0) {
+          reports_by_host_.erase(it);
+        }
+      });
+}
+
+absl::flat_hash_map<std::string, double>
+BatchingAsyncReporter::GetReportCounts() {
+  return {{kSent, num_sent.exchange(0)},
+          {kSampledOut, num_sampled_out.exchange(0)},
+          {kDropped, num_dropped.exchange(0)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
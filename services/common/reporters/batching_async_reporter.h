@@ -0,0 +1,110 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_REPORTERS_BATCHING_ASYNC_REPORTER_H_
+#define SERVICES_COMMON_REPORTERS_BATCHING_ASYNC_REPORTER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/reporters/async_reporter.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct BatchingReporterOptions {
+  // Reports waiting to be sent, beyond which new reports are dropped.
+  int max_queued_reports = 10'000;
+  // Reports in flight to a single host, so that a slow reporting endpoint
+  // does not hold the connections of the fetcher.
+  int max_in_flight_per_host = 16;
+  // Reports sent to a host in a single fetch.
+  int max_batch_size = 32;
+  // Share of the reports that are sent, in [0, 100].
+  int sampling_percent = 100;
+  absl::Duration timeout = absl::Seconds(5);
+};
+
+// Sends reports from a background thread instead of the thread of the
+// request. DoReport only samples the report and queues it by destination
+// host, then the worker sends the queued reports of each host in batches,
+// within the in-flight cap of the host. Reports that are sampled out, or
+// find the queue full, are dropped and their callback gets an error.
+class BatchingAsyncReporter : public AsyncReporter {
+ public:
+  explicit BatchingAsyncReporter(
+      std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+      BatchingReporterOptions options = {});
+
+  // Drops the queued reports and waits for the ones in flight.
+  ~BatchingAsyncReporter() override;
+
+  void DoReport(const HTTPRequest& reporting_request,
+                absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
+                    done_callback) const override;
+
+  // Waits for the queued reports and the ones in flight.
+  bool Flush(absl::Time deadline) override ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of reports of all instances that were sent, sampled
+  // out or dropped on a full queue since the last call.
+  static absl::flat_hash_map<std::string, double> GetReportCounts();
+
+ private:
+  struct Report {
+    HTTPRequest request;
+    absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
+        done_callback;
+  };
+
+  struct HostReports {
+    std::deque<Report> queued;
+    int num_in_flight = 0;
+  };
+
+  // Sends the queued reports until the reporter is destroyed.
+  void Run() ABSL_LOCKS_EXCLUDED(mu_);
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool HasNoneInFlight() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool HasNoReports() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Sends a batch of reports to the host, and releases their share of the
+  // in-flight cap of the host once done.
+  void SendBatch(std::string host, std::vector<Report> batch);
+
+  const BatchingReporterOptions options_;
+
+  mutable absl::Mutex mu_;
+  // Reports by destination host. Hosts are removed once they have nothing
+  // queued or in flight.
+  mutable absl::flat_hash_map<std::string, HostReports> reports_by_host_
+      ABSL_GUARDED_BY(mu_);
+  mutable int num_queued_ ABSL_GUARDED_BY(mu_) = 0;
+  mutable int num_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  // Set when reports may be sent, cleared by the worker once it sent them.
+  mutable bool has_reports_to_send_ ABSL_GUARDED_BY(mu_) = false;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread worker_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_REPORTERS_BATCHING_ASYNC_REPORTER_H_
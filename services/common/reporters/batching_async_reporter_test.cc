@@ -0,0 +1,206 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/reporters/batching_async_reporter.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::Duration kWaitTimeout = absl::Seconds(10);
+
+// Holds the batches until the test completes them.
+class FakeHttpFetcherAsync : public HttpFetcherAsync {
+ public:
+  void FetchUrl(const HTTPRequest& http_request, int timeout_ms,
+                OnDoneFetchUrl done_callback) override {}
+  void PutUrl(const HTTPRequest& http_request, int timeout_ms,
+              OnDoneFetchUrl done_callback) override {}
+  void PostUrl(const HTTPRequest& http_request, int timeout_ms,
+               OnDoneFetchUrl done_callback) override {}
+  void FetchUrls(const std::vector<HTTPRequest>& requests,
+                 absl::Duration timeout,
+                 OnDoneFetchUrls done_callback) override {
+    absl::MutexLock lock(&mu_);
+    batches_.push_back({requests, std::move(done_callback)});
+  }
+
+  // Waits for the reports in flight to the host to reach `num_reports`.
+  bool WaitForReports(absl::string_view host, int num_reports) {
+    absl::MutexLock lock(&mu_);
+    auto reached = [this, host, num_reports]() {
+      mu_.AssertHeld();
+      return NumReportsLocked(host) == num_reports;
+    };
+    return mu_.AwaitWithTimeout(absl::Condition(&reached), kWaitTimeout);
+  }
+
+  // Completes the batches sent to the host.
+  void Complete(absl::string_view host) {
+    std::vector<Batch> done;
+    {
+      absl::MutexLock lock(&mu_);
+      for (auto it = batches_.begin(); it != batches_.end();) {
+        if (absl::StrContains(it->requests[0].url, host)) {
+          done.push_back(std::move(*it));
+          it = batches_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    for (Batch& batch : done) {
+      std::move(batch.done_callback)(std::vector<absl::StatusOr<std::string>>(
+          batch.requests.size(), std::string("ok")));
+    }
+  }
+
+ private:
+  struct Batch {
+    std::vector<HTTPRequest> requests;
+    OnDoneFetchUrls done_callback;
+  };
+
+  int NumReportsLocked(absl::string_view host)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    int num_reports = 0;
+    for (const Batch& batch : batches_) {
+      for (const HTTPRequest& request : batch.requests) {
+        num_reports += absl::StrContains(request.url, host);
+      }
+    }
+    return num_reports;
+  }
+
+  absl::Mutex mu_;
+  std::vector<Batch> batches_ ABSL_GUARDED_BY(mu_);
+};
+
+class BatchingAsyncReporterTest : public ::testing::Test {
+ protected:
+  void SetUp() override { BatchingAsyncReporter::GetReportCounts(); }
+
+  std::unique_ptr<BatchingAsyncReporter> CreateReporter(
+      BatchingReporterOptions options) {
+    auto fetcher = std::make_unique<FakeHttpFetcherAsync>();
+    fetcher_ = fetcher.get();
+    return std::make_unique<BatchingAsyncReporter>(std::move(fetcher),
+                                                   std::move(options));
+  }
+
+  // Reports to the URL, capturing the status of the report.
+  void Report(const AsyncReporter& reporter, std::string url) {
+    reporter.DoReport(
+        {.url = std::move(url)},
+        [this](absl::StatusOr<absl::string_view> result) {  // NOLINT
+          absl::MutexLock lock(&mu_);
+          statuses_.push_back(result.status());
+        });
+  }
+
+  std::vector<absl::Status> Statuses() {
+    absl::MutexLock lock(&mu_);
+    return statuses_;
+  }
+
+  FakeHttpFetcherAsync* fetcher_ = nullptr;
+  absl::Mutex mu_;
+  std::vector<absl::Status> statuses_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST_F(BatchingAsyncReporterTest, SendsReportsWithinTheInFlightCapOfTheHost) {
+  std::unique_ptr<BatchingAsyncReporter> reporter =
+      CreateReporter({.max_in_flight_per_host = 2, .max_batch_size = 2});
+  for (int i = 0; i < 3; ++i) {
+    Report(*reporter, absl::StrCat("https://a.com/loss?ig=", i));
+  }
+  Report(*reporter, "https://b.com/win");
+
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 2));
+  ASSERT_TRUE(fetcher_->WaitForReports("b.com", 1));
+  fetcher_->Complete("a.com");
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 1));
+  fetcher_->Complete("a.com");
+  fetcher_->Complete("b.com");
+
+  reporter.reset();
+  std::vector<absl::Status> statuses = Statuses();
+  ASSERT_EQ(statuses.size(), 4);
+  for (const absl::Status& status : statuses) {
+    EXPECT_TRUE(status.ok()) << status;
+  }
+  EXPECT_EQ(BatchingAsyncReporter::GetReportCounts()["sent"], 4);
+}
+
+TEST_F(BatchingAsyncReporterTest, DropsReportsBeyondTheQueueCapacity) {
+  std::unique_ptr<BatchingAsyncReporter> reporter = CreateReporter(
+      {.max_queued_reports = 1, .max_in_flight_per_host = 1});
+  Report(*reporter, "https://a.com/1");
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 1));
+  // Waits for the cap of the host, then finds the queue full.
+  Report(*reporter, "https://a.com/2");
+  Report(*reporter, "https://a.com/3");
+  std::vector<absl::Status> statuses = Statuses();
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_EQ(statuses[0].code(), absl::StatusCode::kResourceExhausted);
+
+  fetcher_->Complete("a.com");
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 1));
+  fetcher_->Complete("a.com");
+  reporter.reset();
+  EXPECT_EQ(Statuses().size(), 3);
+  absl::flat_hash_map<std::string, double> counts =
+      BatchingAsyncReporter::GetReportCounts();
+  EXPECT_EQ(counts["sent"], 2);
+  EXPECT_EQ(counts["dropped"], 1);
+}
+
+TEST_F(BatchingAsyncReporterTest, FlushesQueuedReports) {
+  std::unique_ptr<BatchingAsyncReporter> reporter =
+      CreateReporter({.max_in_flight_per_host = 1});
+  Report(*reporter, "https://a.com/1");
+  Report(*reporter, "https://a.com/2");
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 1));
+  EXPECT_FALSE(reporter->Flush(absl::Now() + absl::Milliseconds(10)));
+
+  fetcher_->Complete("a.com");
+  ASSERT_TRUE(fetcher_->WaitForReports("a.com", 1));
+  fetcher_->Complete("a.com");
+  EXPECT_TRUE(reporter->Flush(absl::Now() + kWaitTimeout));
+  EXPECT_EQ(Statuses().size(), 2);
+}
+
+TEST_F(BatchingAsyncReporterTest, SamplesReports) {
+  std::unique_ptr<BatchingAsyncReporter> reporter =
+      CreateReporter({.sampling_percent = 0});
+  Report(*reporter, "https://a.com/1");
+  reporter.reset();
+  std::vector<absl::Status> statuses = Statuses();
+  ASSERT_EQ(statuses.size(), 1);
+  EXPECT_EQ(statuses[0].code(), absl::StatusCode::kCancelled);
+  EXPECT_EQ(BatchingAsyncReporter::GetReportCounts()["sampled_out"], 1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
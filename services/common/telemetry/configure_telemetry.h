@@ -17,19 +17,30 @@
 #ifndef CONFIGURE_TELEMETRY_H_
 #define CONFIGURE_TELEMETRY_H_
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "opentelemetry/metrics/provider.h"
+#include "opentelemetry/sdk/metrics/meter_provider.h"
 #include "opentelemetry/sdk/resource/resource.h"
 #include "opentelemetry/sdk/resource/semantic_conventions.h"
+#include "opentelemetry/sdk/trace/tracer_provider.h"
+#include "opentelemetry/trace/provider.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/util/build_info.h"
+#include "services/common/util/profiling_service.h"
+#include "services/common/util/tcmalloc_tuner.h"
 #include "src/logger/request_context_impl.h"
 #include "src/telemetry/flag/telemetry_flag.h"
 #include "src/telemetry/telemetry.h"
@@ -113,6 +124,90 @@ void InitTelemetry(const TrustedServerConfigUtil& config_util,
   AddErrorTypePartition(context_map->metric_config(), server);
 }
 
+// Starts profiling the server if enabled, once InitTelemetry has configured
+// the consented logger through which the profiles are exported. Since
+// profiles reveal the internals of the server, profiling also requires
+// consented debugging to be enabled. Returns nullptr if not profiling.
+inline std::unique_ptr<ProfilingService> MayStartProfiling(
+    const TrustedServersConfigClient& config_client) {
+  if (!config_client.GetBooleanParameter(ENABLE_PROFILING)) {
+    return nullptr;
+  }
+  server_common::telemetry::BuildDependentConfig telemetry_config(
+      config_client
+          .GetCustomParameter<server_common::telemetry::TelemetryFlag>(
+              TELEMETRY_CONFIG)
+          .server_config);
+  if (!telemetry_config.LogsAllowed() ||
+      !config_client.GetBooleanParameter(ENABLE_OTEL_BASED_LOGGING) ||
+      config_client.GetStringParameter(CONSENTED_DEBUG_TOKEN).empty()) {
+    PS_LOG(WARNING) << "Profiling is enabled but consented debugging is not, "
+                       "the server will not be profiled.";
+    return nullptr;
+  }
+  ProfilingOptions options = {.interval = absl::Milliseconds(
+      config_client.GetInt64Parameter(PROFILING_INTERVAL_MS))};
+  return std::make_unique<ProfilingService>(
+      std::move(options), [](ProfileType type, std::string profile) {
+        // Profiles are binary, so they are base64 encoded in the log body.
+        const std::string record = absl::StrCat(
+            "profile.", GetProfileTypeName(type), ": ",
+            absl::Base64Escape(profile));
+        server_common::log::logger_private->EmitLogRecord(record);
+      });
+}
+
+// Starts tuning TCMalloc to the load and memory headroom of the server if
+// enabled. Returns nullptr if not tuning.
+inline std::unique_ptr<TcmallocTuner> MayStartTcmallocTuning(
+    const TrustedServersConfigClient& config_client) {
+  const int64_t interval_ms =
+      config_client.GetInt64Parameter(TCMALLOC_TUNING_INTERVAL_MS);
+  if (interval_ms <= 0) {
+    return nullptr;
+  }
+  constexpr int64_t kMb = 1024 * 1024;
+  return std::make_unique<TcmallocTuner>(TcmallocTuningOptions{
+      .interval = absl::Milliseconds(interval_ms),
+      .min_thread_cache_bytes =
+          config_client.GetInt64Parameter(TCMALLOC_TUNING_MIN_THREAD_CACHE_MB) *
+          kMb,
+      .max_thread_cache_bytes =
+          config_client.GetInt64Parameter(TCMALLOC_TUNING_MAX_THREAD_CACHE_MB) *
+          kMb,
+      .min_release_rate_bytes_per_second =
+          config_client.GetInt64Parameter(
+              TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND) *
+          kMb,
+      .max_release_rate_bytes_per_second =
+          config_client.GetInt64Parameter(
+              TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND) *
+          kMb,
+  });
+}
+
+// Exports the spans and metrics recorded so far, waiting for them until
+// `deadline`, e.g. as the last step of the drain of the server so that the
+// last export before it exits has the drain durations.
+inline void FlushTelemetry(absl::Time deadline) {
+  const auto timeout = std::chrono::microseconds(absl::ToInt64Microseconds(
+      std::max(deadline - absl::Now(), absl::ZeroDuration())));
+  auto tracer_provider = opentelemetry::trace::Provider::GetTracerProvider();
+  if (auto* provider =
+          dynamic_cast<opentelemetry::sdk::trace::TracerProvider*>(
+              tracer_provider.get());
+      provider != nullptr && !provider->ForceFlush(timeout)) {
+    PS_LOG(WARNING) << "Could not flush the spans before the deadline";
+  }
+  auto meter_provider = opentelemetry::metrics::Provider::GetMeterProvider();
+  if (auto* provider =
+          dynamic_cast<opentelemetry::sdk::metrics::MeterProvider*>(
+              meter_provider.get());
+      provider != nullptr && !provider->ForceFlush(timeout)) {
+    PS_LOG(WARNING) << "Could not flush the metrics before the deadline";
+  }
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // CONFIGURE_TELEMETRY_H_
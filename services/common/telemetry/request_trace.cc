@@ -0,0 +1,290 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/request_trace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "opentelemetry/context/context.h"
+#include "opentelemetry/context/propagation/text_map_propagator.h"
+#include "opentelemetry/trace/context.h"
+#include "opentelemetry/trace/propagation/http_trace_context.h"
+#include "opentelemetry/trace/provider.h"
+#include "opentelemetry/trace/span_context.h"
+#include "opentelemetry/trace/span_startoptions.h"
+#include "opentelemetry/trace/tracer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+namespace context = ::opentelemetry::context;
+namespace nostd = ::opentelemetry::nostd;
+namespace trace = ::opentelemetry::trace;
+
+constexpr int kPerMille = 1000;
+constexpr absl::string_view kTracerName = "bidding_auction_servers";
+
+std::atomic<int> sampling_per_mille = 0;
+
+// FNV-1a, which unlike absl::Hash is the same in every process, so that the
+// servers agree on the requests sampled.
+uint64_t StableHash(absl::string_view value) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : value) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// Carries the trace context of an incoming call.
+class TraceParentCarrier : public context::propagation::TextMapCarrier {
+ public:
+  explicit TraceParentCarrier(absl::string_view trace_parent)
+      : trace_parent_(trace_parent) {}
+
+  nostd::string_view Get(nostd::string_view key) const noexcept override {
+    if (absl::string_view(key.data(), key.size()) != kTraceParentKey) {
+      return "";
+    }
+    return nostd::string_view(trace_parent_.data(), trace_parent_.size());
+  }
+
+  void Set(nostd::string_view key, nostd::string_view value) noexcept override {
+  }
+
+ private:
+  const absl::string_view trace_parent_;
+};
+
+// Carries the trace context of an outgoing call.
+class RequestMetadataCarrier : public context::propagation::TextMapCarrier {
+ public:
+  explicit RequestMetadataCarrier(RequestMetadata& metadata)
+      : metadata_(metadata) {}
+
+  nostd::string_view Get(nostd::string_view key) const noexcept override {
+    auto it = metadata_.find(absl::string_view(key.data(), key.size()));
+    if (it == metadata_.end()) {
+      return "";
+    }
+    return nostd::string_view(it->second.data(), it->second.size());
+  }
+
+  void Set(nostd::string_view key, nostd::string_view value) noexcept override {
+    metadata_.insert_or_assign(std::string(key.data(), key.size()),
+                               std::string(value.data(), value.size()));
+  }
+
+ private:
+  RequestMetadata& metadata_;
+};
+
+trace::SpanContext ParseTraceParent(absl::string_view trace_parent) {
+  if (trace_parent.empty()) {
+    return trace::SpanContext::GetInvalid();
+  }
+  TraceParentCarrier carrier(trace_parent);
+  context::Context empty_context;
+  context::Context extracted =
+      trace::propagation::HttpTraceContext().Extract(carrier, empty_context);
+  return trace::GetSpan(extracted)->GetContext();
+}
+
+bool IsSampled(absl::string_view generation_id,
+               const trace::SpanContext& parent) {
+  if (parent.IsValid()) {
+    return parent.IsSampled();
+  }
+  const int per_mille = sampling_per_mille.load(std::memory_order_relaxed);
+  if (per_mille <= 0) {
+    return false;
+  }
+  if (per_mille >= kPerMille) {
+    return true;
+  }
+  return StableHash(generation_id) % kPerMille <
+         static_cast<uint64_t>(per_mille);
+}
+
+nostd::shared_ptr<trace::Tracer> GetTracer() {
+  // The tracer provider is set once, by ConfigureTracer, before the server
+  // starts handling requests.
+  static auto* const tracer = new nostd::shared_ptr<trace::Tracer>(
+      trace::Provider::GetTracerProvider()->GetTracer(
+          nostd::string_view(kTracerName.data(), kTracerName.size())));
+  return *tracer;
+}
+
+nostd::shared_ptr<trace::Span> StartChildSpan(
+    const nostd::shared_ptr<trace::Span>& parent, absl::string_view name) {
+  trace::StartSpanOptions options;
+  options.parent = parent->GetContext();
+  return GetTracer()->StartSpan(nostd::string_view(name.data(), name.size()),
+                                options);
+}
+
+void InjectSpan(const nostd::shared_ptr<trace::Span>& span,
+                RequestMetadata& metadata) {
+  RequestMetadataCarrier carrier(metadata);
+  context::Context empty_context;
+  trace::propagation::HttpTraceContext().Inject(
+      carrier, trace::SetSpan(empty_context, span));
+}
+
+void EndSpan(trace::Span& span, const grpc::Status& status) {
+  if (!status.ok()) {
+    span.SetStatus(trace::StatusCode::kError, status.error_message());
+  }
+  span.End();
+}
+
+}  // namespace
+
+void RequestSpan::SetAttribute(absl::string_view key,
+                               absl::string_view value) {
+  if (span_ != nullptr) {
+    span_->SetAttribute(nostd::string_view(key.data(), key.size()),
+                        nostd::string_view(value.data(), value.size()));
+  }
+}
+
+void RequestSpan::Inject(RequestMetadata& metadata) const {
+  if (span_ != nullptr) {
+    InjectSpan(span_, metadata);
+  }
+}
+
+void RequestSpan::End(const grpc::Status& status) {
+  if (span_ != nullptr) {
+    EndSpan(*span_, status);
+    span_ = nullptr;
+  }
+}
+
+void RequestTrace::SetSamplingPerMille(int per_mille) {
+  sampling_per_mille.store(per_mille, std::memory_order_relaxed);
+}
+
+bool RequestTrace::IsSampled(absl::string_view generation_id,
+                             absl::string_view trace_parent) {
+  return bidding_auction_servers::IsSampled(generation_id,
+                                            ParseTraceParent(trace_parent));
+}
+
+absl::string_view RequestTrace::GetTraceParent(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& client_metadata) {
+  auto it = client_metadata.find(
+      grpc::string_ref(kTraceParentKey.data(), kTraceParentKey.size()));
+  if (it == client_metadata.end()) {
+    return "";
+  }
+  return absl::string_view(it->second.data(), it->second.size());
+}
+
+RequestTrace::RequestTrace()
+    : start_system_time_(std::chrono::system_clock::now()),
+      start_steady_time_(std::chrono::steady_clock::now()) {}
+
+RequestTrace::~RequestTrace() {
+  for (auto& phase_span : phase_spans_) {
+    if (phase_span != nullptr) {
+      phase_span->End();
+    }
+  }
+  End(grpc::Status::OK);
+}
+
+void RequestTrace::Start(absl::string_view name,
+                         absl::string_view generation_id,
+                         absl::string_view trace_parent,
+                         absl::string_view setup_span_name) {
+  const trace::SpanContext parent = ParseTraceParent(trace_parent);
+  if (root_ != nullptr ||
+      !bidding_auction_servers::IsSampled(generation_id, parent)) {
+    return;
+  }
+  trace::StartSpanOptions options;
+  options.kind = trace::SpanKind::kServer;
+  options.start_system_time =
+      opentelemetry::common::SystemTimestamp(start_system_time_);
+  options.start_steady_time =
+      opentelemetry::common::SteadyTimestamp(start_steady_time_);
+  if (parent.IsValid()) {
+    options.parent = parent;
+  }
+  root_ = GetTracer()->StartSpan(nostd::string_view(name.data(), name.size()),
+                                 options);
+
+  options.kind = trace::SpanKind::kInternal;
+  options.parent = root_->GetContext();
+  GetTracer()
+      ->StartSpan(nostd::string_view(setup_span_name.data(),
+                                     setup_span_name.size()),
+                  options)
+      ->End();
+}
+
+RequestSpan RequestTrace::StartSpan(absl::string_view name) const {
+  if (root_ == nullptr) {
+    return RequestSpan();
+  }
+  return RequestSpan(StartChildSpan(root_, name));
+}
+
+void RequestTrace::Inject(RequestMetadata& metadata) const {
+  if (root_ != nullptr) {
+    InjectSpan(root_, metadata);
+  }
+}
+
+void RequestTrace::Inject(RequestPhase phase, RequestMetadata& metadata) const {
+  if (root_ == nullptr) {
+    return;
+  }
+  const auto& phase_span = phase_spans_[static_cast<int>(phase)];
+  InjectSpan(phase_span != nullptr ? phase_span : root_, metadata);
+}
+
+void RequestTrace::End(const grpc::Status& status) {
+  if (root_ != nullptr && !ended_) {
+    EndSpan(*root_, status);
+    ended_ = true;
+  }
+}
+
+void RequestTrace::OnPhaseStart(RequestPhase phase) {
+  if (root_ != nullptr) {
+    phase_spans_[static_cast<int>(phase)] =
+        StartChildSpan(root_, GetRequestPhaseName(phase));
+  }
+}
+
+void RequestTrace::OnPhaseEnd(RequestPhase phase) {
+  if (root_ == nullptr) {
+    return;
+  }
+  auto& phase_span = phase_spans_[static_cast<int>(phase)];
+  if (phase_span != nullptr) {
+    phase_span->End();
+    phase_span = nullptr;
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
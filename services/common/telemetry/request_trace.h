@@ -0,0 +1,149 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TELEMETRY_REQUEST_TRACE_H_
+#define SERVICES_COMMON_TELEMETRY_REQUEST_TRACE_H_
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/strings/string_view.h"
+#include "opentelemetry/nostd/shared_ptr.h"
+#include "opentelemetry/trace/span.h"
+#include "services/common/clients/async_client.h"
+#include "services/common/util/request_phase_tracer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Metadata key carrying the W3C trace context of a call between two of the
+// servers.
+inline constexpr absl::string_view kTraceParentKey = "traceparent";
+
+// A span of a traced request, ended when it goes out of scope if not before.
+// Does nothing if the request is not traced.
+class RequestSpan {
+ public:
+  RequestSpan() = default;
+  explicit RequestSpan(
+      opentelemetry::nostd::shared_ptr<opentelemetry::trace::Span> span)
+      : span_(std::move(span)) {}
+  ~RequestSpan() { End(); }
+
+  RequestSpan(RequestSpan&& other) = default;
+  RequestSpan& operator=(RequestSpan&& other) {
+    End();
+    span_ = std::move(other.span_);
+    return *this;
+  }
+
+  void SetAttribute(absl::string_view key, absl::string_view value);
+
+  // Adds the trace context of the span to the metadata of an outgoing call,
+  // so that the server called continues the trace under this span.
+  void Inject(RequestMetadata& metadata) const;
+
+  // Ends the span, as failed if `status` is not OK.
+  void End(const grpc::Status& status = grpc::Status::OK);
+
+ private:
+  opentelemetry::nostd::shared_ptr<opentelemetry::trace::Span> span_;
+};
+
+// Distributed trace of a request through the servers. Each server starts a
+// trace once it has decrypted the request, which is then exported if the
+// request is sampled: the sampling is decided from the generation ID of the
+// request, unless the caller propagated its decision in the `traceparent`
+// metadata, so that every server traces the same requests. The phases of the
+// request, see RequestPhaseTracer, become child spans, and the trace context
+// is forwarded to the servers called.
+//
+// Nothing is recorded for the requests not sampled, so that tracing costs a
+// couple of branches and the clock read at construction for them. The spans
+// recorded are handed to the exporter configured by ConfigureTracer, which
+// exports them in batches off the request path.
+class RequestTrace : public RequestPhaseListener {
+ public:
+  // Sets the share of the requests traced, in thousandths of the requests.
+  // No request is traced if 0, every request if 1000 or more.
+  static void SetSamplingPerMille(int sampling_per_mille);
+
+  // Returns whether the request is traced, from the trace context propagated
+  // by the caller, if any, or else from its generation ID. The same on every
+  // server for a given request, as long as they sample the same share.
+  static bool IsSampled(absl::string_view generation_id,
+                        absl::string_view trace_parent);
+
+  // Returns the `traceparent` entry of the metadata of an incoming call, or
+  // an empty string if there is none.
+  static absl::string_view GetTraceParent(
+      const std::multimap<grpc::string_ref, grpc::string_ref>&
+          client_metadata);
+
+  // The request is deemed started when the trace is constructed.
+  RequestTrace();
+  ~RequestTrace() override;
+
+  // RequestTrace is neither copyable nor movable.
+  RequestTrace(const RequestTrace&) = delete;
+  RequestTrace& operator=(const RequestTrace&) = delete;
+
+  // Starts the trace of the request, named `name`, if it is sampled, see
+  // IsSampled. The time since the construction of the trace, i.e. taken to
+  // decrypt the request and find its generation ID, is recorded as a span
+  // named `setup_span_name`.
+  void Start(absl::string_view name, absl::string_view generation_id,
+             absl::string_view trace_parent,
+             absl::string_view setup_span_name = "decrypt");
+
+  // Returns true if the request is traced.
+  bool enabled() const { return root_ != nullptr; }
+
+  // Starts a child span of the request, e.g. for a call to another server.
+  RequestSpan StartSpan(absl::string_view name) const;
+
+  // Adds the trace context of the request to the metadata of an outgoing
+  // call, under the span of `phase` if it is running.
+  void Inject(RequestMetadata& metadata) const;
+  void Inject(RequestPhase phase, RequestMetadata& metadata) const;
+
+  // Ends the trace of the request, as failed if `status` is not OK. Ended
+  // with an OK status on destruction if not before.
+  void End(const grpc::Status& status);
+
+  // Times the phases of the traced requests as child spans.
+  void OnPhaseStart(RequestPhase phase) override;
+  void OnPhaseEnd(RequestPhase phase) override;
+
+ private:
+  static constexpr int kNumPhases = static_cast<int>(RequestPhase::kNumPhases);
+
+  const std::chrono::system_clock::time_point start_system_time_;
+  const std::chrono::steady_clock::time_point start_steady_time_;
+  opentelemetry::nostd::shared_ptr<opentelemetry::trace::Span> root_;
+  bool ended_ = false;
+  // Spans of the phases running, by RequestPhase.
+  std::array<opentelemetry::nostd::shared_ptr<opentelemetry::trace::Span>,
+             kNumPhases>
+      phase_spans_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TELEMETRY_REQUEST_TRACE_H_
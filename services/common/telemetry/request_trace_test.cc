@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/request_trace.h"
+
+#include <map>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kSampledTraceParent =
+    "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+constexpr absl::string_view kNotSampledTraceParent =
+    "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-00";
+
+TEST(RequestTraceTest, SamplesShareOfGenerationIds) {
+  RequestTrace::SetSamplingPerMille(0);
+  EXPECT_FALSE(RequestTrace::IsSampled("generation-id", ""));
+  RequestTrace::SetSamplingPerMille(1000);
+  EXPECT_TRUE(RequestTrace::IsSampled("generation-id", ""));
+
+  RequestTrace::SetSamplingPerMille(100);
+  int num_sampled = 0;
+  for (int i = 0; i < 10'000; ++i) {
+    const std::string generation_id = absl::StrCat("generation-", i);
+    const bool sampled = RequestTrace::IsSampled(generation_id, "");
+    // Every server makes the same decision for a request.
+    EXPECT_EQ(RequestTrace::IsSampled(generation_id, ""), sampled);
+    num_sampled += sampled;
+  }
+  EXPECT_GT(num_sampled, 800);
+  EXPECT_LT(num_sampled, 1'200);
+  RequestTrace::SetSamplingPerMille(0);
+}
+
+TEST(RequestTraceTest, FollowsSamplingDecisionOfCaller) {
+  RequestTrace::SetSamplingPerMille(0);
+  EXPECT_TRUE(RequestTrace::IsSampled("generation-id", kSampledTraceParent));
+  RequestTrace::SetSamplingPerMille(1000);
+  EXPECT_FALSE(
+      RequestTrace::IsSampled("generation-id", kNotSampledTraceParent));
+  // A malformed trace context is ignored.
+  EXPECT_TRUE(RequestTrace::IsSampled("generation-id", "malformed"));
+  RequestTrace::SetSamplingPerMille(0);
+}
+
+TEST(RequestTraceTest, RecordsNothingIfNotSampled) {
+  RequestTrace::SetSamplingPerMille(0);
+  RequestTrace trace;
+  trace.Start("request", "generation-id", "");
+  EXPECT_FALSE(trace.enabled());
+
+  RequestPhaseTracer tracer(/*enabled=*/false);
+  tracer.set_listener(&trace);
+  ScopedRequestPhase phase(tracer, RequestPhase::kKvLookup);
+  RequestMetadata metadata;
+  trace.Inject(RequestPhase::kKvLookup, metadata);
+  trace.StartSpan("call").Inject(metadata);
+  EXPECT_TRUE(metadata.empty());
+}
+
+TEST(RequestTraceTest, GetsTraceParentOfIncomingCall) {
+  std::multimap<grpc::string_ref, grpc::string_ref> client_metadata;
+  EXPECT_EQ(RequestTrace::GetTraceParent(client_metadata), "");
+  client_metadata.emplace("x-other", "value");
+  client_metadata.emplace(
+      "traceparent",
+      grpc::string_ref(kSampledTraceParent.data(), kSampledTraceParent.size()));
+  EXPECT_EQ(RequestTrace::GetTraceParent(client_metadata),
+            kSampledTraceParent);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
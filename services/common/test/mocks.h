@@ -136,6 +136,10 @@ class AsyncClientMock
            on_done,
        absl::Duration timeout),
       (const, override));
+
+  // Requests with a cancellation are forwarded to the mock above.
+  using AsyncClient<Request, Response, RawRequest,
+                    RawResponse>::ExecuteInternal;
 };
 
 using BuyerFrontEndAsyncClientMock =
@@ -173,6 +177,10 @@ class MockHttpFetcherAsync : public HttpFetcherAsync {
               (const HTTPRequest& http_request, int timeout_ms,
                OnDoneFetchUrl done_callback),
               (override));
+  MOCK_METHOD(void, PostUrl,
+              (const HTTPRequest& http_request, int timeout_ms,
+               OnDoneFetchUrl done_callback),
+              (override));
   MOCK_METHOD(void, FetchUrls,
               (const std::vector<HTTPRequest>& requests, absl::Duration timeout,
                OnDoneFetchUrls done_callback),
@@ -353,6 +361,10 @@ class MockCodeDispatchClient : public CodeDispatchClient {
   MOCK_METHOD(absl::Status, BatchExecute,
               (std::vector<DispatchRequest> & batch,
                BatchDispatchDoneCallback batch_callback));
+  MOCK_METHOD(absl::Status, BatchExecuteStreaming,
+              (std::vector<DispatchRequest> & batch,
+               DispatchResponseCallback response_callback,
+               BatchStreamDoneCallback done_callback, absl::Duration deadline));
 
  private:
   MockV8Dispatcher dispatcher_;
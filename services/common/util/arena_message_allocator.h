@@ -0,0 +1,100 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_ARENA_MESSAGE_ALLOCATOR_H_
+#define SERVICES_COMMON_UTIL_ARENA_MESSAGE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory>
+
+#include <grpcpp/support/message_allocator.h>
+
+#include "google/protobuf/arena.h"
+#include "google/protobuf/message_lite.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Allocates the request and the response of every call of a callback gRPC
+// method on a protobuf arena of the call, so that the messages of a call are
+// freed at once when gRPC releases them instead of field by field. Reactors
+// allocate the messages they derive from the request, such as the decrypted
+// raw request, on the same arena with CreateMessageOnArenaOf.
+//
+//   ArenaMessageAllocator<SelectAdRequest, SelectAdResponse> allocator;
+//   service.SetMessageAllocatorFor_SelectAd(&allocator);
+template <typename Request, typename Response>
+class ArenaMessageAllocator : public grpc::MessageAllocator<Request, Response> {
+ public:
+  // Size of the first block of each arena, which should hold most requests
+  // without further allocations.
+  static constexpr size_t kDefaultInitialBlockSize = 64 * 1024;
+
+  explicit ArenaMessageAllocator(
+      size_t initial_block_size = kDefaultInitialBlockSize) {
+    options_.start_block_size = initial_block_size;
+  }
+
+  grpc::MessageHolder<Request, Response>* AllocateMessages() override {
+    return new ArenaMessageHolder(options_);
+  }
+
+ private:
+  // Owns the arena of a call and the messages on it. Deleted by Release.
+  class ArenaMessageHolder : public grpc::MessageHolder<Request, Response> {
+   public:
+    explicit ArenaMessageHolder(const google::protobuf::ArenaOptions& options)
+        : arena_(options) {
+      this->set_request(
+          google::protobuf::Arena::CreateMessage<Request>(&arena_));
+      this->set_response(
+          google::protobuf::Arena::CreateMessage<Response>(&arena_));
+    }
+
+    void Release() override { delete this; }
+
+   private:
+    google::protobuf::Arena arena_;
+  };
+
+  google::protobuf::ArenaOptions options_;
+};
+
+// Deletes a message unless it is on an arena, so that a std::unique_ptr can
+// hold the messages released from a field with UnsafeArenaReleaseLast
+// without copying them out of the arena. The arena must outlive the pointer.
+struct ArenaAwareDelete {
+  void operator()(google::protobuf::MessageLite* message) const {
+    if (message != nullptr && message->GetArena() == nullptr) {
+      delete message;
+    }
+  }
+};
+
+template <typename T>
+using ArenaAwarePtr = std::unique_ptr<T, ArenaAwareDelete>;
+
+// Creates a message on the arena of `message`. If `message` is not on an
+// arena, as in tests, the created message is on the heap and owned by `owned`.
+template <typename T, typename Message>
+T& CreateMessageOnArenaOf(const Message& message, std::unique_ptr<T>& owned) {
+  if (google::protobuf::Arena* arena = message.GetArena(); arena != nullptr) {
+    return *google::protobuf::Arena::CreateMessage<T>(arena);
+  }
+  owned = std::make_unique<T>();
+  return *owned;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_ARENA_MESSAGE_ALLOCATOR_H_
@@ -0,0 +1,72 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/arena_message_allocator.h"
+
+#include <memory>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ArenaMessageAllocatorTest, AllocatesMessagesOfCallOnSameArena) {
+  ArenaMessageAllocator<ScoreAdsRequest, ScoreAdsResponse> allocator;
+
+  grpc::MessageHolder<ScoreAdsRequest, ScoreAdsResponse>* holder =
+      allocator.AllocateMessages();
+
+  ASSERT_NE(holder->request()->GetArena(), nullptr);
+  EXPECT_EQ(holder->request()->GetArena(), holder->response()->GetArena());
+  holder->Release();
+}
+
+TEST(ArenaMessageAllocatorTest, AllocatesMessagesOfCallsOnDistinctArenas) {
+  ArenaMessageAllocator<ScoreAdsRequest, ScoreAdsResponse> allocator;
+
+  auto* first = allocator.AllocateMessages();
+  auto* second = allocator.AllocateMessages();
+
+  EXPECT_NE(first->request()->GetArena(), second->request()->GetArena());
+  first->Release();
+  second->Release();
+}
+
+TEST(CreateMessageOnArenaOfTest, CreatesMessageOnArenaOfMessage) {
+  ArenaMessageAllocator<ScoreAdsRequest, ScoreAdsResponse> allocator;
+  auto* holder = allocator.AllocateMessages();
+  std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> owned;
+
+  ScoreAdsRequest::ScoreAdsRawRequest& raw_request =
+      CreateMessageOnArenaOf(*holder->request(), owned);
+
+  EXPECT_EQ(raw_request.GetArena(), holder->request()->GetArena());
+  EXPECT_EQ(owned, nullptr);
+  holder->Release();
+}
+
+TEST(CreateMessageOnArenaOfTest, OwnsMessageWithoutArena) {
+  ScoreAdsRequest request;
+  std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> owned;
+
+  ScoreAdsRequest::ScoreAdsRawRequest& raw_request =
+      CreateMessageOnArenaOf(request, owned);
+
+  EXPECT_EQ(raw_request.GetArena(), nullptr);
+  EXPECT_EQ(&raw_request, owned.get());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,6 +14,7 @@
 
 #include "services/common/util/async_task_tracker.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "absl/log/check.h"
@@ -24,15 +25,17 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 AsyncTaskTracker::AsyncTaskTracker(
     int num_tasks_to_track, server_common::log::ContextImpl& log_context,
-    absl::AnyInvocable<void(bool) &&> on_all_tasks_done)
+    absl::AnyInvocable<void(bool) &&> on_all_tasks_done,
+    bool record_completion_times)
     : num_tasks_to_track_(num_tasks_to_track),
-      pending_tasks_count_(num_tasks_to_track),
-      successful_tasks_count_(0),
-      empty_tasks_count_(0),
-      skipped_tasks_count_(0),
-      error_tasks_count_(0),
+      counts_(static_cast<uint64_t>(num_tasks_to_track) << kPendingShift),
       on_all_tasks_done_(std::move(on_all_tasks_done)),
-      log_context_(log_context) {}
+      log_context_(log_context),
+      record_completion_times_(record_completion_times),
+      completion_times_(record_completion_times ? num_tasks_to_track : 0) {
+  CHECK(num_tasks_to_track >= 0 && num_tasks_to_track <= kMaxTasksToTrack)
+      << "Unsupported number of tasks to track: " << num_tasks_to_track;
+}
 
 void AsyncTaskTracker::TaskCompleted(TaskStatus task_status) {
   TaskCompleted(task_status, std::nullopt);
@@ -41,84 +44,124 @@ void AsyncTaskTracker::TaskCompleted(TaskStatus task_status) {
 void AsyncTaskTracker::TaskCompleted(
     TaskStatus task_status,
     std::optional<absl::AnyInvocable<void()>> on_single_task_done) {
-  bool is_last_response = false;
-  bool any_successful_tasks = false;
-
-  {
+  if (on_single_task_done.has_value()) {
     absl::MutexLock lock(&mu_);
-    DCHECK(pending_tasks_count_ > 0)
-        << "Unexpected call (indicates either a bug in the initialization or "
-           "the usage)";
-
-    if (on_single_task_done.has_value()) {
-      (*on_single_task_done)();
-    }
-
-    --pending_tasks_count_;
-    switch (task_status) {
-      case TaskStatus::ERROR:
-        ++error_tasks_count_;
-        break;
-      case TaskStatus::EMPTY_RESPONSE:
-        ++empty_tasks_count_;
-        break;
-      case TaskStatus::SKIPPED:
-        ++skipped_tasks_count_;
-        break;
-      case TaskStatus::SUCCESS:
-        ++successful_tasks_count_;
-        break;
-      default:
-        PS_LOG(ERROR, log_context_)
-            << "Unexpected task status : " << absl::StrCat(task_status);
-        break;
-    }
-    PS_VLOG(5, log_context_) << "Updated pending tasks state: " << ToString();
-    if (pending_tasks_count_ == 0) {
-      is_last_response = true;
-      // Accounts for chaffs.
-      any_successful_tasks = AnyTaskSuccessfullyCompleted();
-    }
+    (*on_single_task_done)();
+  }
+  if (record_completion_times_) {
+    RecordCompletionTime();
   }
 
-  // Since on_all_tasks_done_ can delete AsyncTaskTracker itself all resources
-  // must be released before calling on_all_tasks_done_.
-  if (is_last_response) {
-    std::move(on_all_tasks_done_)(any_successful_tasks);
+  // Increments the count of the status and decrements the pending count in a
+  // single update. The pending count is positive, so the decrement does not
+  // borrow from the other counts.
+  uint64_t delta;
+  switch (task_status) {
+    case TaskStatus::ERROR:
+      delta = uint64_t{1} << kErrorShift;
+      break;
+    case TaskStatus::EMPTY_RESPONSE:
+      delta = uint64_t{1} << kEmptyShift;
+      break;
+    case TaskStatus::SKIPPED:
+      delta = uint64_t{1} << kSkippedShift;
+      break;
+    case TaskStatus::SUCCESS:
+      delta = uint64_t{1} << kSuccessfulShift;
+      break;
+    default:
+      PS_LOG(ERROR, log_context_)
+          << "Unexpected task status : " << absl::StrCat(task_status);
+      delta = 0;
+      break;
+  }
+  delta -= uint64_t{1} << kPendingShift;
+  // Releases the writes of this task (including `on_single_task_done`) to the
+  // last task, which acquires the writes of all tasks.
+  const uint64_t previous_counts =
+      counts_.fetch_add(delta, std::memory_order_acq_rel);
+  DCHECK(Count(previous_counts, kPendingShift) > 0)
+      << "Unexpected call (indicates either a bug in the initialization or "
+         "the usage)";
+  const uint64_t counts = previous_counts + delta;
+  PS_VLOG(5, log_context_) << "Updated pending tasks state: "
+                           << ToString(counts);
+  if (Count(counts, kPendingShift) != 0) {
+    return;
+  }
+
+  if (record_completion_times_ && !completion_times_.empty()) {
+    // Completions are recorded in the order of their slots, which may differ
+    // from the order of their times.
+    std::vector<absl::Time> completion_times = TaskCompletionTimes();
+    const auto [first, last] =
+        std::minmax_element(completion_times.begin(), completion_times.end());
+    PS_VLOG(kStats, log_context_) << "Task completion skew: " << *last - *first;
   }
+  // Since on_all_tasks_done_ can delete AsyncTaskTracker itself all resources
+  // must be released before calling on_all_tasks_done_. Accounts for chaffs.
+  std::move(on_all_tasks_done_)(AnyTaskSuccessfullyCompleted(counts));
 }
 
 void AsyncTaskTracker::SetNumTasksToTrack(int num_tasks_to_track) {
-  absl::MutexLock lock(&mu_);
+  CHECK(num_tasks_to_track >= 0 && num_tasks_to_track <= kMaxTasksToTrack)
+      << "Unsupported number of tasks to track: " << num_tasks_to_track;
   num_tasks_to_track_ = num_tasks_to_track;
-  pending_tasks_count_ = num_tasks_to_track;
-  successful_tasks_count_ = 0;
-  empty_tasks_count_ = 0;
-  skipped_tasks_count_ = 0;
-  error_tasks_count_ = 0;
+  counts_.store(static_cast<uint64_t>(num_tasks_to_track) << kPendingShift,
+                std::memory_order_relaxed);
+  if (record_completion_times_) {
+    completion_times_ = std::vector<std::atomic<int64_t>>(num_tasks_to_track);
+    num_completion_times_.store(0, std::memory_order_relaxed);
+  }
   PS_VLOG(kStats, log_context_)
       << "Reset of task tracker to track: " << num_tasks_to_track
-      << " number of tasks done. New tracker: " << ToString();
+      << " number of tasks done. New tracker: "
+      << ToString(counts_.load(std::memory_order_relaxed));
 }
 
-bool AsyncTaskTracker::AnyTaskSuccessfullyCompleted() {
-  const int sum_tasks_count = skipped_tasks_count_ + successful_tasks_count_ +
-                              error_tasks_count_ + empty_tasks_count_ +
-                              pending_tasks_count_;
-  DCHECK_EQ(num_tasks_to_track_, sum_tasks_count);
+std::vector<absl::Time> AsyncTaskTracker::TaskCompletionTimes() const {
+  const int num_completion_times = std::min<int>(
+      num_completion_times_.load(std::memory_order_acquire),
+      completion_times_.size());
+  std::vector<absl::Time> completion_times;
+  completion_times.reserve(num_completion_times);
+  for (int i = 0; i < num_completion_times; ++i) {
+    completion_times.push_back(absl::FromUnixNanos(
+        completion_times_[i].load(std::memory_order_relaxed)));
+  }
+  return completion_times;
+}
+
+void AsyncTaskTracker::RecordCompletionTime() {
+  const int slot = num_completion_times_.fetch_add(1, std::memory_order_relaxed);
+  if (slot < static_cast<int>(completion_times_.size())) {
+    completion_times_[slot].store(absl::ToUnixNanos(absl::Now()),
+                                  std::memory_order_relaxed);
+  }
+}
 
-  const bool possible_chaff =
-      empty_tasks_count_ > 0 || skipped_tasks_count_ > 0;
-  return successful_tasks_count_ > 0 || possible_chaff ||
-         error_tasks_count_ == 0;
+bool AsyncTaskTracker::AnyTaskSuccessfullyCompleted(uint64_t counts) const {
+  const int successful_tasks_count = Count(counts, kSuccessfulShift);
+  const int empty_tasks_count = Count(counts, kEmptyShift);
+  const int skipped_tasks_count = Count(counts, kSkippedShift);
+  const int error_tasks_count = Count(counts, kErrorShift);
+  const int pending_tasks_count = Count(counts, kPendingShift);
+  // Tasks with an unexpected status are only counted as no longer pending.
+  DCHECK_GE(num_tasks_to_track_,
+            skipped_tasks_count + successful_tasks_count + error_tasks_count +
+                empty_tasks_count + pending_tasks_count);
+
+  const bool possible_chaff = empty_tasks_count > 0 || skipped_tasks_count > 0;
+  return successful_tasks_count > 0 || possible_chaff || error_tasks_count == 0;
 }
 
-std::string AsyncTaskTracker::ToString() {
-  return absl::StrCat("Async Task Stats: succeeded=", successful_tasks_count_,
-                      ", errored=", error_tasks_count_,
-                      ", skipped=", skipped_tasks_count_,
-                      ", returned empty=", empty_tasks_count_,
-                      ", pending=", pending_tasks_count_,
+std::string AsyncTaskTracker::ToString(uint64_t counts) const {
+  return absl::StrCat("Async Task Stats: succeeded=",
+                      Count(counts, kSuccessfulShift),
+                      ", errored=", Count(counts, kErrorShift),
+                      ", skipped=", Count(counts, kSkippedShift),
+                      ", returned empty=", Count(counts, kEmptyShift),
+                      ", pending=", Count(counts, kPendingShift),
                       ", initial count=", num_tasks_to_track_);
 }
 
@@ -17,12 +17,16 @@
 #ifndef SERVICES_COMMON_UTIL_ASYNC_TASK_TRACKER_H_
 #define SERVICES_COMMON_UTIL_ASYNC_TASK_TRACKER_H_
 
+#include <atomic>
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "src/logger/request_context_impl.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -49,44 +53,76 @@ enum class TaskStatus {
 // a thread safe manner). Once all the tasks have been completed, this module
 // callbacks the initially registered `on_all_tasks_done` callback. This final
 // callback is called without holding any locks.
+//
+// The task counts are packed into a single atomic word, so completions only
+// contend on a lock when they provide an `on_single_task_done` closure. At most
+// kMaxTasksToTrack tasks can be tracked: callers tracking tasks derived from
+// request input must reject or bound larger counts beforehand.
 class AsyncTaskTracker {
  public:
+  static constexpr int kMaxTasksToTrack = 4095;
+
+  // If `record_completion_times` is true, the completion time of every task
+  // is recorded and can be read with TaskCompletionTimes().
   explicit AsyncTaskTracker(
       int num_tasks_to_track, server_common::log::ContextImpl& log_context,
-      absl::AnyInvocable<void(bool) &&> on_all_tasks_done);
+      absl::AnyInvocable<void(bool) &&> on_all_tasks_done,
+      bool record_completion_times = false);
 
   // Updates the stats. If all bids have been completed, then the registered
   // callback is called.
-  void TaskCompleted(TaskStatus task_status) ABSL_LOCKS_EXCLUDED(mu_);
+  void TaskCompleted(TaskStatus task_status);
 
   // Updates the stats. If all bids have been completed, then the registered
   // callback is called. `on_single_task_done`, if provided, will be called with
-  // a lock.
+  // a lock, and before the registered callback.
   void TaskCompleted(
       TaskStatus task_status,
       std::optional<absl::AnyInvocable<void()>> on_single_task_done)
       ABSL_LOCKS_EXCLUDED(mu_);
 
-  // Sets the number of tasks to track.
+  // Sets the number of tasks to track. Must not be called concurrently with
+  // TaskCompleted.
   void SetNumTasksToTrack(int num_tasks_to_track);
 
+  // Returns the completion times of the tasks completed so far, or an empty
+  // vector if completion times are not recorded. The times are not sorted:
+  // concurrent completions may be recorded out of order. Only complete once
+  // all the tasks are done, e.g. in `on_all_tasks_done`.
+  std::vector<absl::Time> TaskCompletionTimes() const;
+
  private:
+  // Bit offsets of the counts in the packed word, each 12 bits wide.
+  static constexpr int kPendingShift = 0;
+  static constexpr int kSuccessfulShift = 12;
+  static constexpr int kEmptyShift = 24;
+  static constexpr int kSkippedShift = 36;
+  static constexpr int kErrorShift = 48;
+
+  static int Count(uint64_t counts, int shift) {
+    return static_cast<int>((counts >> shift) & kMaxTasksToTrack);
+  }
+
   // Indicates whether any bid was successful or if no buyer returned an empty
   // bid so that we should send a chaff back. This should be called after all
   // the get bid calls to buyer frontend have returned.
-  bool AnyTaskSuccessfullyCompleted() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool AnyTaskSuccessfullyCompleted(uint64_t counts) const;
+
+  std::string ToString(uint64_t counts) const;
 
-  std::string ToString() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Records the completion time of a task, before it is counted as done.
+  void RecordCompletionTime();
 
   int num_tasks_to_track_;
+  // Serializes the `on_single_task_done` closures.
   absl::Mutex mu_;
-  int pending_tasks_count_ ABSL_GUARDED_BY(mu_);
-  int successful_tasks_count_ ABSL_GUARDED_BY(mu_);
-  int empty_tasks_count_ ABSL_GUARDED_BY(mu_);
-  int skipped_tasks_count_ ABSL_GUARDED_BY(mu_);
-  int error_tasks_count_ ABSL_GUARDED_BY(mu_);
+  std::atomic<uint64_t> counts_;
   absl::AnyInvocable<void(bool) &&> on_all_tasks_done_;
   server_common::log::ContextImpl& log_context_;
+  const bool record_completion_times_;
+  // Completion times in nanoseconds since the epoch, one slot per task.
+  std::vector<std::atomic<int64_t>> completion_times_;
+  std::atomic<int> num_completion_times_ = 0;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -22,6 +22,7 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "include/gtest/gtest.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -29,6 +30,7 @@ namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 constexpr int kNumMaxThreads = 10;
+constexpr int kNumManyTasks = 1000;
 
 class AsyncTasksTrackerTest : public testing::Test {
  protected:
@@ -187,6 +189,101 @@ TEST_F(AsyncTasksTrackerTest, OnSingleTaskDoneCalledWithLock) {
   }
 }
 
+TEST_F(AsyncTasksTrackerTest, OnSingleTaskDoneVisibleToFinalCallback) {
+  std::vector<int> done_tasks;
+  AsyncTaskTracker task_tracker(kNumManyTasks, log_context_,
+                                [this, &done_tasks](bool any_successful) {
+                                  EXPECT_EQ(done_tasks.size(), kNumManyTasks);
+                                  notification_.Notify();
+                                });
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumMaxThreads);
+  for (int i = 0; i < kNumMaxThreads; ++i) {
+    threads.emplace_back([&task_tracker, &done_tasks, i]() {
+      for (int j = 0; j < kNumManyTasks / kNumMaxThreads; ++j) {
+        task_tracker.TaskCompleted(TaskStatus::SUCCESS, [&done_tasks, i]() {
+          done_tasks.push_back(i);
+        });
+      }
+    });
+  }
+
+  notification_.WaitForNotification();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+TEST_F(AsyncTasksTrackerTest, CountsEveryStatusUpToMaxTasks) {
+  constexpr int kNumTasks = AsyncTaskTracker::kMaxTasksToTrack;
+  AsyncTaskTracker task_tracker(kNumTasks, log_context_,
+                                [this](bool any_successful) {
+                                  // Only errors => failed overall.
+                                  EXPECT_FALSE(any_successful);
+                                  notification_.Notify();
+                                });
+
+  for (int i = 0; i < kNumTasks; ++i) {
+    task_tracker.TaskCompleted(TaskStatus::ERROR);
+  }
+
+  EXPECT_TRUE(notification_.HasBeenNotified());
+}
+
+TEST_F(AsyncTasksTrackerTest, ResetsCountsOnSetNumTasksToTrack) {
+  AsyncTaskTracker task_tracker(1, log_context_, [this](bool any_successful) {
+    EXPECT_FALSE(any_successful);
+    notification_.Notify();
+  });
+  task_tracker.SetNumTasksToTrack(2);
+
+  task_tracker.TaskCompleted(TaskStatus::ERROR);
+  EXPECT_FALSE(notification_.HasBeenNotified());
+  task_tracker.TaskCompleted(TaskStatus::ERROR);
+  EXPECT_TRUE(notification_.HasBeenNotified());
+}
+
+TEST_F(AsyncTasksTrackerTest, RecordsTaskCompletionTimes) {
+  std::vector<absl::Time> completion_times;
+  AsyncTaskTracker* tracker = nullptr;
+  const absl::Time start = absl::Now();
+  AsyncTaskTracker task_tracker(
+      kNumMaxThreads, log_context_,
+      [this, &tracker, &completion_times](bool any_successful) {
+        completion_times = tracker->TaskCompletionTimes();
+        notification_.Notify();
+      },
+      /*record_completion_times=*/true);
+  tracker = &task_tracker;
+
+  std::vector<std::thread> threads;
+  threads.reserve(kNumMaxThreads);
+  for (int i = 0; i < kNumMaxThreads; ++i) {
+    threads.emplace_back(
+        [&task_tracker]() { task_tracker.TaskCompleted(TaskStatus::SUCCESS); });
+  }
+
+  notification_.WaitForNotification();
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(completion_times.size(), kNumMaxThreads);
+  for (absl::Time completion_time : completion_times) {
+    EXPECT_GE(completion_time, start);
+    EXPECT_LE(completion_time, absl::Now());
+  }
+}
+
+TEST_F(AsyncTasksTrackerTest, DoesNotRecordTaskCompletionTimesByDefault) {
+  AsyncTaskTracker task_tracker(1, log_context_, [this](bool any_successful) {
+    notification_.Notify();
+  });
+
+  task_tracker.TaskCompleted(TaskStatus::SUCCESS);
+  EXPECT_TRUE(task_tracker.TaskCompletionTimes().empty());
+}
+
 }  // namespace
 
 }  // namespace privacy_sandbox::bidding_auction_servers
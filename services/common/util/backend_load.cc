@@ -0,0 +1,101 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/backend_load.h"
+
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::Duration BackendLoadReport::PredictedWait() const {
+  if (num_workers <= 0) {
+    return absl::ZeroDuration();
+  }
+  return (queue_depth / num_workers) * request_time;
+}
+
+std::string SerializeBackendLoadReport(const BackendLoadReport& report) {
+  return absl::StrCat("queue=", report.queue_depth,
+                      ",workers=", report.num_workers, ",request_us=",
+                      absl::ToInt64Microseconds(report.request_time));
+}
+
+absl::StatusOr<BackendLoadReport> ParseBackendLoadReport(
+    absl::string_view value) {
+  BackendLoadReport report;
+  for (absl::string_view field : absl::StrSplit(value, ',')) {
+    std::pair<absl::string_view, absl::string_view> name_value =
+        absl::StrSplit(field, absl::MaxSplits('=', 1));
+    int64_t number;
+    if (!absl::SimpleAtoi(name_value.second, &number) || number < 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid backend load field: ", field));
+    }
+    if (name_value.first == "queue") {
+      report.queue_depth = number;
+    } else if (name_value.first == "workers") {
+      report.num_workers = number;
+    } else if (name_value.first == "request_us") {
+      report.request_time = absl::Microseconds(number);
+    }
+  }
+  return report;
+}
+
+BackendLoadTracker& BackendLoadTracker::Get() {
+  static auto* tracker = new BackendLoadTracker();
+  return *tracker;
+}
+
+void BackendLoadTracker::AddWorkers(int64_t num_workers) {
+  num_workers_.fetch_add(num_workers, std::memory_order_relaxed);
+}
+
+void BackendLoadTracker::OnDispatched(int64_t num_requests) {
+  queue_depth_.fetch_add(num_requests, std::memory_order_relaxed);
+}
+
+void BackendLoadTracker::OnDone(int64_t num_requests, absl::Duration latency) {
+  queue_depth_.fetch_sub(num_requests, std::memory_order_relaxed);
+  if (latency == absl::InfiniteDuration()) {
+    return;
+  }
+  const int64_t latency_ns = absl::ToInt64Nanoseconds(latency);
+  int64_t average = request_time_ns_.load(std::memory_order_relaxed);
+  int64_t updated;
+  do {
+    updated = average == 0 ? latency_ns
+                           : static_cast<int64_t>(
+                                 latency_smoothing_ * latency_ns +
+                                 (1 - latency_smoothing_) * average);
+  } while (!request_time_ns_.compare_exchange_weak(
+      average, updated, std::memory_order_relaxed));
+}
+
+int64_t BackendLoadTracker::QueueDepth() const {
+  return queue_depth_.load(std::memory_order_relaxed);
+}
+
+BackendLoadReport BackendLoadTracker::Report() const {
+  return {.queue_depth = QueueDepth(),
+          .num_workers = num_workers_.load(std::memory_order_relaxed),
+          .request_time = absl::Nanoseconds(
+              request_time_ns_.load(std::memory_order_relaxed))};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
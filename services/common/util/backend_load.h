@@ -0,0 +1,94 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_BACKEND_LOAD_H_
+#define SERVICES_COMMON_UTIL_BACKEND_LOAD_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Metadata of the responses of the bidding and auction servers carrying the
+// load of their Roma workers.
+inline constexpr char kBackendLoadMetadataKey[] = "x-bna-backend-load";
+
+// Load of the Roma workers of a backend, which is what bounds its latency
+// rather than the RPCs in flight.
+struct BackendLoadReport {
+  // Requests in Roma, executing or queued.
+  int64_t queue_depth = 0;
+  int64_t num_workers = 0;
+  // Moving average of the time taken by a request.
+  absl::Duration request_time = absl::ZeroDuration();
+
+  // Time a new request is predicted to wait for a worker: the requests in
+  // Roma run in waves of num_workers.
+  absl::Duration PredictedWait() const;
+};
+
+// Formats the report as the value of kBackendLoadMetadataKey, e.g.
+// "queue=12,workers=8,request_us=3500".
+std::string SerializeBackendLoadReport(const BackendLoadReport& report);
+
+// Parses a value of kBackendLoadMetadataKey. Unknown fields are ignored.
+absl::StatusOr<BackendLoadReport> ParseBackendLoadReport(
+    absl::string_view value);
+
+// Keeps track of the load of the Roma workers of the server, as the
+// dispatchers hand requests to Roma and get them back. Thread-safe.
+class BackendLoadTracker {
+ public:
+  // Tracker of the server, fed by the V8 dispatchers.
+  static BackendLoadTracker& Get();
+
+  // latency_smoothing: weight of the latest batch in the moving average of
+  // the time taken by a request.
+  explicit BackendLoadTracker(double latency_smoothing = 0.2)
+      : latency_smoothing_(latency_smoothing) {}
+
+  BackendLoadTracker(const BackendLoadTracker&) = delete;
+  BackendLoadTracker& operator=(const BackendLoadTracker&) = delete;
+
+  // Counts the workers of a dispatcher, removed with a negative count.
+  void AddWorkers(int64_t num_workers);
+
+  // Counts `num_requests` handed to Roma.
+  void OnDispatched(int64_t num_requests);
+  // Counts `num_requests` done. The latency of the batch they ran in, if they
+  // did, updates the average time taken by a request.
+  void OnDone(int64_t num_requests,
+              absl::Duration latency = absl::InfiniteDuration());
+
+  // Requests in Roma, executing or queued.
+  int64_t QueueDepth() const;
+
+  BackendLoadReport Report() const;
+
+ private:
+  const double latency_smoothing_;
+  std::atomic<int64_t> queue_depth_ = 0;
+  std::atomic<int64_t> num_workers_ = 0;
+  // Moving average of the time taken by a request, in nanoseconds.
+  std::atomic<int64_t> request_time_ns_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_BACKEND_LOAD_H_
@@ -0,0 +1,76 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/backend_load.h"
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(BackendLoadReportTest, PredictsWaitFromWavesOfWorkers) {
+  BackendLoadReport report = {.queue_depth = 7,
+                              .num_workers = 4,
+                              .request_time = absl::Milliseconds(10)};
+  EXPECT_EQ(report.PredictedWait(), absl::Milliseconds(10));
+  report.queue_depth = 3;
+  EXPECT_EQ(report.PredictedWait(), absl::ZeroDuration());
+  report.num_workers = 0;
+  EXPECT_EQ(report.PredictedWait(), absl::ZeroDuration());
+}
+
+TEST(BackendLoadReportTest, RoundTripsThroughMetadata) {
+  const std::string value =
+      SerializeBackendLoadReport({.queue_depth = 12,
+                                  .num_workers = 8,
+                                  .request_time = absl::Microseconds(3500)});
+  EXPECT_EQ(value, "queue=12,workers=8,request_us=3500");
+  absl::StatusOr<BackendLoadReport> report = ParseBackendLoadReport(value);
+  ASSERT_TRUE(report.ok()) << report.status();
+  EXPECT_EQ(report->queue_depth, 12);
+  EXPECT_EQ(report->num_workers, 8);
+  EXPECT_EQ(report->request_time, absl::Microseconds(3500));
+}
+
+TEST(BackendLoadReportTest, IgnoresUnknownFieldsAndRejectsMalformedOnes) {
+  absl::StatusOr<BackendLoadReport> report =
+      ParseBackendLoadReport("queue=3,cpu=80");
+  ASSERT_TRUE(report.ok()) << report.status();
+  EXPECT_EQ(report->queue_depth, 3);
+  EXPECT_FALSE(ParseBackendLoadReport("queue=-1").ok());
+  EXPECT_FALSE(ParseBackendLoadReport("queue").ok());
+}
+
+TEST(BackendLoadTrackerTest, TracksQueueDepthAndAverageRequestTime) {
+  BackendLoadTracker tracker(/*latency_smoothing=*/0.5);
+  tracker.AddWorkers(2);
+  tracker.OnDispatched(3);
+  EXPECT_EQ(tracker.QueueDepth(), 3);
+  tracker.OnDone(2, absl::Milliseconds(10));
+  tracker.OnDone(1, absl::Milliseconds(20));
+  tracker.OnDispatched(1);
+  tracker.OnDone(1);
+
+  BackendLoadReport report = tracker.Report();
+  EXPECT_EQ(report.queue_depth, 0);
+  EXPECT_EQ(report.num_workers, 2);
+  EXPECT_EQ(report.request_time, absl::Milliseconds(15));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
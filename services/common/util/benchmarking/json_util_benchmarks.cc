@@ -0,0 +1,135 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the rapidjson document parse with the SAX span extraction on the
+// read-only paths, which only extract members of Roma and KV responses.
+
+#include <string>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "services/common/util/json_span_util.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns the output of a generateBid call bidding with the given number of
+// ad components, as returned by the wrapper of the bidding code.
+std::string MakeGenerateBidOutput(int num_ad_components) {
+  std::string components;
+  for (int i = 0; i < num_ad_components; ++i) {
+    absl::StrAppend(&components, i == 0 ? "" : ",",
+                    "\"https://components.adtech.com/ad-", i, ".html\"");
+  }
+  return absl::StrCat(
+      R"({"response":{"render":"https://ads.adtech.com/ad.html?id=12345",)",
+      R"("ad":{"arbitraryMetadataKey":2,"campaign":"spring-sale"},)",
+      R"("bid":1.2345678,"bidCurrency":"USD","allowComponentAuction":false,)",
+      R"("adComponents":[)", components, "],",
+      R"("debug_report_urls":{"auction_debug_loss_url":)",
+      R"("https://debug.adtech.com/loss?bid=${winningBid}"}},)",
+      R"("logs":[],"errors":[],"warnings":[]})");
+}
+
+// Returns a KV response with the given number of keys.
+std::string MakeKvResponse(int num_keys) {
+  std::string keys;
+  for (int i = 0; i < num_keys; ++i) {
+    absl::StrAppend(&keys, i == 0 ? "" : ",", "\"key-", i,
+                    R"(":{"value":[1,2,3],"ttl":3600,"tag":"bidding-signal"})");
+  }
+  return absl::StrCat(R"({"keys":{)", keys, R"(},"perInterestGroupData":{}})");
+}
+
+static void BM_GetResponse_Document(benchmark::State& state) {
+  const std::string output = MakeGenerateBidOutput(state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<rapidjson::Document> document = ParseJsonString(output);
+    CHECK_OK(document);
+    absl::StatusOr<std::string> response =
+        SerializeJsonDoc((*document)["response"]);
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(BM_GetResponse_Document)->Arg(0)->Arg(10)->Arg(100);
+
+static void BM_GetResponse_ArenaDocument(benchmark::State& state) {
+  const std::string output = MakeGenerateBidOutput(state.range(0));
+  JsonArena arena;
+  for (auto _ : state) {
+    absl::StatusOr<std::string> response;
+    {
+      absl::StatusOr<rapidjson::Document> document =
+          ParseJsonString(output, arena);
+      CHECK_OK(document);
+      response = SerializeJsonDoc((*document)["response"]);
+    }
+    arena.Clear();
+    CHECK_OK(response);
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(BM_GetResponse_ArenaDocument)->Arg(0)->Arg(10)->Arg(100);
+
+static void BM_GetResponse_Spans(benchmark::State& state) {
+  const std::string output = MakeGenerateBidOutput(state.range(0));
+  for (auto _ : state) {
+    JsonPropertySpans spans = {{"response", {}}};
+    CHECK_OK(FindJsonPropertySpans(output, spans));
+    std::string response;
+    response.reserve(spans["response"].size());
+    AppendMinifiedJson(spans["response"], response);
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetBytesProcessed(state.iterations() * output.size());
+}
+BENCHMARK(BM_GetResponse_Spans)->Arg(0)->Arg(10)->Arg(100);
+
+static void BM_GetKvValues_Document(benchmark::State& state) {
+  const std::string response = MakeKvResponse(state.range(0));
+  const std::string key = absl::StrCat("key-", state.range(0) / 2);
+  for (auto _ : state) {
+    absl::StatusOr<rapidjson::Document> document = ParseJsonString(response);
+    CHECK_OK(document);
+    absl::StatusOr<std::string> value =
+        SerializeJsonDoc((*document)["keys"][key.c_str()]);
+    CHECK_OK(value);
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_GetKvValues_Document)->Arg(10)->Arg(100)->Arg(1000);
+
+static void BM_GetKvValues_Spans(benchmark::State& state) {
+  const std::string response = MakeKvResponse(state.range(0));
+  const std::string key = absl::StrCat("key-", state.range(0) / 2);
+  for (auto _ : state) {
+    JsonObjectSpans keys;
+    keys.members[key] = {};
+    CHECK_OK(FindJsonMemberSpans(response, {{"keys", &keys}}));
+    std::string value;
+    AppendMinifiedJson(keys.members[key], value);
+    benchmark::DoNotOptimize(value);
+  }
+  state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_GetKvValues_Spans)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
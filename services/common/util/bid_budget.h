@@ -0,0 +1,79 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_BID_BUDGET_H_
+#define SERVICES_COMMON_UTIL_BID_BUDGET_H_
+
+#include <algorithm>
+
+#include "google/protobuf/repeated_field.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Keeps the `max_bids` highest bids of `ads_with_bids` and deletes the others,
+// without copying any bid. The order of the kept bids is not preserved. No
+// limit if `max_bids` is 0. Returns the number of deleted bids.
+template <typename T>
+int KeepTopBids(int max_bids,
+                google::protobuf::RepeatedPtrField<T>& ads_with_bids) {
+  if (max_bids <= 0 || ads_with_bids.size() <= max_bids) {
+    return 0;
+  }
+  // Only the element pointers are moved.
+  std::nth_element(ads_with_bids.pointer_begin(),
+                   ads_with_bids.pointer_begin() + max_bids,
+                   ads_with_bids.pointer_end(), [](const T* a, const T* b) {
+                     return a->bid() > b->bid();
+                   });
+  const int num_deleted = ads_with_bids.size() - max_bids;
+  ads_with_bids.DeleteSubrange(max_bids, num_deleted);
+  return num_deleted;
+}
+
+// Keeps the bids of `ads_with_bids` above `min_bid`, and bids equal to it
+// while `num_min_bids` allows, which is decremented for each such bid kept.
+// Deletes the other bids and keeps the order of the kept ones. Lets a budget
+// spanning several lists of bids, e.g. the bids of all the buyers of an
+// auction, be enforced once its lowest kept bid is known. Returns the number
+// of deleted bids.
+template <typename T>
+int KeepBidsAbove(float min_bid, int& num_min_bids,
+                  google::protobuf::RepeatedPtrField<T>& ads_with_bids) {
+  int num_kept = 0;
+  for (int i = 0; i < ads_with_bids.size(); ++i) {
+    const float bid = ads_with_bids[i].bid();
+    if (bid < min_bid) {
+      continue;
+    }
+    if (bid == min_bid) {
+      if (num_min_bids <= 0) {
+        continue;
+      }
+      --num_min_bids;
+    }
+    if (i != num_kept) {
+      ads_with_bids.SwapElements(i, num_kept);
+    }
+    ++num_kept;
+  }
+  const int num_deleted = ads_with_bids.size() - num_kept;
+  if (num_deleted > 0) {
+    ads_with_bids.DeleteSubrange(num_kept, num_deleted);
+  }
+  return num_deleted;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_BID_BUDGET_H_
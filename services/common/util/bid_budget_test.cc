@@ -0,0 +1,78 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/bid_budget.h"
+
+#include <vector>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+google::protobuf::RepeatedPtrField<AdWithBid> MakeBids(
+    const std::vector<float>& bids) {
+  google::protobuf::RepeatedPtrField<AdWithBid> ads_with_bids;
+  for (float bid : bids) {
+    ads_with_bids.Add()->set_bid(bid);
+  }
+  return ads_with_bids;
+}
+
+std::vector<float> GetBids(
+    const google::protobuf::RepeatedPtrField<AdWithBid>& ads_with_bids) {
+  std::vector<float> bids;
+  for (const AdWithBid& ad_with_bid : ads_with_bids) {
+    bids.push_back(ad_with_bid.bid());
+  }
+  return bids;
+}
+
+TEST(KeepTopBidsTest, KeepsHighestBids) {
+  auto ads_with_bids = MakeBids({1, 5, 3, 4, 2});
+
+  EXPECT_EQ(KeepTopBids(3, ads_with_bids), 2);
+
+  EXPECT_THAT(GetBids(ads_with_bids), UnorderedElementsAre(5, 4, 3));
+}
+
+TEST(KeepTopBidsTest, KeepsAllBidsWithinBudget) {
+  auto ads_with_bids = MakeBids({1, 5, 3});
+
+  EXPECT_EQ(KeepTopBids(3, ads_with_bids), 0);
+  EXPECT_EQ(KeepTopBids(0, ads_with_bids), 0);
+
+  EXPECT_THAT(GetBids(ads_with_bids), ElementsAre(1, 5, 3));
+}
+
+TEST(KeepBidsAboveTest, KeepsBidsAtMinBidWithinBudget) {
+  auto first = MakeBids({1, 3, 2, 2});
+  auto second = MakeBids({2, 4});
+  int num_min_bids = 2;
+
+  EXPECT_EQ(KeepBidsAbove(2, num_min_bids, first), 1);
+  EXPECT_EQ(KeepBidsAbove(2, num_min_bids, second), 1);
+
+  EXPECT_THAT(GetBids(first), ElementsAre(3, 2, 2));
+  EXPECT_THAT(GetBids(second), ElementsAre(4));
+  EXPECT_EQ(num_min_bids, 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
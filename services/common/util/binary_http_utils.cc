@@ -0,0 +1,167 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/binary_http_utils.h"
+
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Framing indicators of known-length messages (RFC 9292 section 3.3).
+inline constexpr uint64_t kKnownLengthRequest = 0;
+inline constexpr uint64_t kKnownLengthResponse = 1;
+// Binary HTTP field names are lowercase.
+inline constexpr absl::string_view kContentTypeField = "content-type";
+
+// Length of `value` as a QUIC variable-length integer (RFC 9000 section 16).
+size_t VarIntLength(uint64_t value) {
+  if (value < (uint64_t{1} << 6)) {
+    return 1;
+  }
+  if (value < (uint64_t{1} << 14)) {
+    return 2;
+  }
+  if (value < (uint64_t{1} << 30)) {
+    return 4;
+  }
+  return 8;
+}
+
+char* WriteVarInt(uint64_t value, char* out) {
+  const size_t length = VarIntLength(value);
+  // The two most significant bits encode the log2 of the length.
+  const uint64_t prefix = length == 1   ? 0
+                          : length == 2 ? 1
+                          : length == 4 ? 2
+                                        : 3;
+  value |= prefix << (8 * length - 2);
+  for (size_t i = length; i > 0; --i) {
+    out[i - 1] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+  return out + length;
+}
+
+char* WriteLengthPrefixed(absl::string_view value, char* out) {
+  out = WriteVarInt(value.size(), out);
+  std::memcpy(out, value.data(), value.size());
+  return out + value.size();
+}
+
+// Reads a QUIC variable-length integer off the front of `in`.
+bool ReadVarInt(absl::string_view& in, uint64_t& value) {
+  if (in.empty()) {
+    return false;
+  }
+  const size_t length = size_t{1} << (static_cast<uint8_t>(in[0]) >> 6);
+  if (in.size() < length) {
+    return false;
+  }
+  value = static_cast<uint8_t>(in[0]) & 0x3f;
+  for (size_t i = 1; i < length; ++i) {
+    value = (value << 8) | static_cast<uint8_t>(in[i]);
+  }
+  in.remove_prefix(length);
+  return true;
+}
+
+// Reads a length-prefixed byte string off the front of `in`.
+bool ReadLengthPrefixed(absl::string_view& in, absl::string_view& value) {
+  uint64_t length;
+  if (!ReadVarInt(in, length) || in.size() < length) {
+    return false;
+  }
+  value = in.substr(0, length);
+  in.remove_prefix(length);
+  return true;
+}
+
+// Returns the content of a known-length Binary HTTP response, skipping the
+// informational responses, the header and the trailer sections.
+absl::StatusOr<absl::string_view> KnownLengthResponseContent(
+    absl::string_view binary_http_response) {
+  absl::string_view in = binary_http_response;
+  uint64_t framing_indicator;
+  if (!ReadVarInt(in, framing_indicator) ||
+      framing_indicator != kKnownLengthResponse) {
+    return absl::InvalidArgumentError(
+        "Not a known-length Binary HTTP response");
+  }
+  uint64_t status_code;
+  absl::string_view field_section;
+  do {
+    if (!ReadVarInt(in, status_code) ||
+        !ReadLengthPrefixed(in, field_section)) {
+      return absl::InvalidArgumentError(
+          "Truncated header of the Binary HTTP response");
+    }
+  } while (status_code >= 100 && status_code < 200);
+  // The content may be truncated away when empty.
+  absl::string_view content;
+  if (!in.empty() && !ReadLengthPrefixed(in, content)) {
+    return absl::InvalidArgumentError(
+        "Truncated content of the Binary HTTP response");
+  }
+  return content;
+}
+
+}  // namespace
+
+namespace binary_http_internal {
+
+char* FrameKnownLengthRequest(absl::string_view content_type, size_t body_size,
+                              std::string& binary_http_request) {
+  const size_t field_section_size = VarIntLength(kContentTypeField.size()) +
+                                    kContentTypeField.size() +
+                                    VarIntLength(content_type.size()) +
+                                    content_type.size();
+  // Framing indicator and the empty method, scheme, authority and path.
+  constexpr size_t kControlDataSize = 5;
+  binary_http_request.resize(
+      kControlDataSize + VarIntLength(field_section_size) +
+      field_section_size + VarIntLength(body_size) + body_size);
+  char* out = binary_http_request.data();
+  out = WriteVarInt(kKnownLengthRequest, out);
+  for (int i = 0; i < 4; ++i) {
+    out = WriteVarInt(0, out);
+  }
+  out = WriteVarInt(field_section_size, out);
+  out = WriteLengthPrefixed(kContentTypeField, out);
+  out = WriteLengthPrefixed(content_type, out);
+  return WriteVarInt(body_size, out);
+}
+
+}  // namespace binary_http_internal
+
+absl::Status FromBinaryHTTP(absl::string_view binary_http_response,
+                            google::protobuf::Message& response_proto,
+                            bool from_json) {
+  PS_ASSIGN_OR_RETURN(absl::string_view content,
+                      KnownLengthResponseContent(binary_http_response));
+  PS_VLOG(5) << "Converting the binary HTTP response to proto";
+  if (from_json) {
+    PS_RETURN_IF_ERROR(JsonStringToMessage(content, &response_proto));
+  } else {
+    if (!response_proto.ParseFromArray(content.data(), content.size())) {
+      return absl::InvalidArgumentError(
+          "Unable to convert the Binary HTTP response to proto");
+    }
+    PS_VLOG(kNoisyInfo) << "Converted the http request to proto: "
+                        << response_proto.DebugString();
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -17,12 +17,15 @@
 #ifndef SERVICES_COMMON_UTIL_BINARY_HTTP_UTILS_H_
 #define SERVICES_COMMON_UTIL_BINARY_HTTP_UTILS_H_
 
+#include <cstring>
 #include <string>
-#include <utility>
+#include <type_traits>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "google/protobuf/message.h"
 #include "google/protobuf/util/json_util.h"
-#include "quiche/binary_http/binary_http_message.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/logger/request_context_logger.h"
 #include "src/util/status_macro/status_macros.h"
@@ -36,10 +39,22 @@ inline constexpr char kContentType[] = "Content-Type";
 inline constexpr char kJsonContentType[] = "application/json";
 inline constexpr char kProtoContentType[] = "application/protobuf";
 
+namespace binary_http_internal {
+
+// Resizes `binary_http_request` to a known-length Binary HTTP request
+// (RFC 9292) with empty control data, a single Content-Type header of
+// `content_type` and `body_size` bytes of content, writes all but the content
+// and returns where the content starts.
+char* FrameKnownLengthRequest(absl::string_view content_type, size_t body_size,
+                              std::string& binary_http_request);
+
+}  // namespace binary_http_internal
+
 // Converts the incoming proto to Binary HTTP request.
 // If to_json is set, the proto will be serialized to a JSON before encoding
 // as binary HTTP, otherwise the proto is directly serialized into bytes string
-// before binary HTTP encoding.
+// before binary HTTP encoding. Either way, the framing and the payload are
+// written into a single buffer sized up front.
 template <typename ProtoMessageType>
 absl::StatusOr<std::string> ToBinaryHTTP(const ProtoMessageType& request_proto,
                                          bool to_json = true) {
@@ -47,47 +62,45 @@ absl::StatusOr<std::string> ToBinaryHTTP(const ProtoMessageType& request_proto,
       std::is_base_of<google::protobuf::Message, ProtoMessageType>::value,
       "Request should be a google::protobuf::Message.");
   PS_VLOG(5) << "Converting request to binary HTTP ...";
-  quiche::BinaryHttpRequest binary_http_request({});
-  std::string serialized_request;
+  std::string binary_http_request;
   if (to_json) {
+    std::string serialized_request;
     PS_RETURN_IF_ERROR(MessageToJsonString(request_proto, &serialized_request));
     PS_VLOG(6) << "JSON request: " << serialized_request;
-    binary_http_request.AddHeaderField({kContentType, kJsonContentType});
+    char* body = binary_http_internal::FrameKnownLengthRequest(
+        kJsonContentType, serialized_request.size(), binary_http_request);
+    std::memcpy(body, serialized_request.data(), serialized_request.size());
   } else {
-    serialized_request = request_proto.SerializeAsString();
-    binary_http_request.AddHeaderField({kContentType, kProtoContentType});
+    const size_t body_size = request_proto.ByteSizeLong();
+    char* body = binary_http_internal::FrameKnownLengthRequest(
+        kProtoContentType, body_size, binary_http_request);
+    if (!request_proto.SerializeToArray(body, body_size)) {
+      return absl::InternalError("Unable to serialize the request proto");
+    }
   }
-  binary_http_request.set_body(std::move(serialized_request));
-  return binary_http_request.Serialize();
+  return binary_http_request;
 }
 
-// Converts the incoming Binary HTTP response to the given proto type.
+// Parses the incoming Binary HTTP response into `response_proto`, straight
+// from the content of the response.
 // If from_json is set, the data embedded in Binary HTTP response is expected
 // to be a JSON, otherwise the encapsulated data is assumed to be bytes array
 // representation of the proto.
+absl::Status FromBinaryHTTP(absl::string_view binary_http_response,
+                            google::protobuf::Message& response_proto,
+                            bool from_json = true);
+
+// Converts the incoming Binary HTTP response to the given proto type.
+// See above.
 template <typename ProtoMessageType>
 absl::StatusOr<ProtoMessageType> FromBinaryHTTP(
     absl::string_view binary_http_response, bool from_json = true) {
   static_assert(
       std::is_base_of<google::protobuf::Message, ProtoMessageType>::value,
       "Response type should be a google::protobuf::Message.");
-  PS_ASSIGN_OR_RETURN(auto retrieved_binary_http_response,
-                      quiche::BinaryHttpResponse::Create(binary_http_response));
-  std::string retrieved_binary_http_response_body;
-  retrieved_binary_http_response.swap_body(retrieved_binary_http_response_body);
   ProtoMessageType response_proto;
-  PS_VLOG(5) << "Converting the binary HTTP response to proto";
-  if (from_json) {
-    PS_RETURN_IF_ERROR(JsonStringToMessage(retrieved_binary_http_response_body,
-                                           &response_proto));
-  } else {
-    if (!response_proto.ParseFromString(retrieved_binary_http_response_body)) {
-      return absl::InvalidArgumentError(
-          "Unable to convert the Binary HTTP response to proto");
-    }
-    PS_VLOG(kNoisyInfo) << "Converted the http request to proto: "
-                        << response_proto.DebugString();
-  }
+  PS_RETURN_IF_ERROR(
+      FromBinaryHTTP(binary_http_response, response_proto, from_json));
   return response_proto;
 }
 
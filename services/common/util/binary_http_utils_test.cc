@@ -17,6 +17,8 @@
 #include <google/protobuf/struct.pb.h>
 
 #include "absl/log/check.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "google/protobuf/text_format.h"
 #include "include/gtest/gtest.h"
@@ -80,6 +82,62 @@ TEST(BinaryHttpResponse, RetrievesResponseFromJsonPayload) {
   ASSERT_TRUE(get_values_response->single_partition().has_string_output());
 }
 
+std::string TestBinaryHttpResponse(absl::string_view header_hex,
+                                   absl::string_view content) {
+  CHECK_LT(content.size(), 64) << "Content length must fit in one byte";
+  return absl::StrCat(absl::HexStringToBytes(header_hex),
+                      std::string(1, static_cast<char>(content.size())),
+                      content);
+}
+
+TEST(BinaryHttpResponse, RetrievesResponseFromProtoPayload) {
+  GetValuesResponse expected;
+  expected.mutable_single_partition()->set_string_output("output");
+
+  GetValuesResponse get_values_response;
+  CHECK_OK(FromBinaryHTTP(
+      TestBinaryHttpResponse("0140c800", expected.SerializeAsString()),
+      get_values_response, /*from_json=*/false));
+
+  EXPECT_EQ(get_values_response.single_partition().string_output(), "output");
+}
+
+TEST(BinaryHttpResponse, SkipsInformationalResponses) {
+  GetValuesResponse expected;
+  expected.mutable_single_partition()->set_string_output("output");
+
+  // A 100 response with no header precedes the final 200 response.
+  auto get_values_response = FromBinaryHTTP<GetValuesResponse>(
+      TestBinaryHttpResponse("01406400" "40c800", expected.SerializeAsString()),
+      /*from_json=*/false);
+  CHECK_OK(get_values_response);
+
+  EXPECT_EQ(get_values_response->single_partition().string_output(), "output");
+}
+
+TEST(BinaryHttpResponse, RetrievesEmptyResponseFromTruncatedContent) {
+  auto get_values_response = FromBinaryHTTP<GetValuesResponse>(
+      absl::HexStringToBytes("0140c800"), /*from_json=*/false);
+  CHECK_OK(get_values_response);
+
+  EXPECT_FALSE(get_values_response->has_single_partition());
+}
+
+TEST(BinaryHttpResponse, FailsOnMalformedResponse) {
+  // Known-length request instead of response.
+  EXPECT_FALSE(FromBinaryHTTP<GetValuesResponse>(
+                   absl::HexStringToBytes("0000000000"), /*from_json=*/false)
+                   .ok());
+  // Header section longer than the response.
+  EXPECT_FALSE(FromBinaryHTTP<GetValuesResponse>(
+                   absl::HexStringToBytes("0140c805"), /*from_json=*/false)
+                   .ok());
+  // Content longer than the response.
+  EXPECT_FALSE(FromBinaryHTTP<GetValuesResponse>(
+                   absl::HexStringToBytes("0140c8000501"), /*from_json=*/false)
+                   .ok());
+}
+
 }  // namespace
 
 }  // namespace privacy_sandbox::bidding_auction_servers
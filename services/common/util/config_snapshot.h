@@ -0,0 +1,62 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_CONFIG_SNAPSHOT_H_
+#define SERVICES_COMMON_UTIL_CONFIG_SNAPSHOT_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Holds an immutable, pre-parsed config that can be swapped at runtime in a
+// read-copy-update fashion. Readers take a reference to the current config
+// once, e.g. when a request starts, and read its fields without any lookups.
+// Updates publish a new config, and the previous one is released once the
+// last reader holding it is done.
+template <typename Config>
+class ConfigSnapshot {
+ public:
+  explicit ConfigSnapshot(Config config)
+      : current_(std::make_shared<const Config>(std::move(config))) {}
+
+  // ConfigSnapshot is neither copyable nor movable.
+  ConfigSnapshot(const ConfigSnapshot&) = delete;
+  ConfigSnapshot& operator=(const ConfigSnapshot&) = delete;
+
+  // Returns the current config, which stays valid and unchanged for as long
+  // as the caller holds it.
+  std::shared_ptr<const Config> Get() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::ReaderMutexLock lock(&mu_);
+    return current_;
+  }
+
+  // Publishes a new config to the subsequent Get calls.
+  void Update(Config config) ABSL_LOCKS_EXCLUDED(mu_) {
+    auto next = std::make_shared<const Config>(std::move(config));
+    absl::MutexLock lock(&mu_);
+    // The previous config is released by `next` outside of the lock.
+    current_.swap(next);
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  std::shared_ptr<const Config> current_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CONFIG_SNAPSHOT_H_
@@ -0,0 +1,71 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/config_snapshot.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+struct TestConfig {
+  int timeout_ms = 0;
+  std::string domain;
+};
+
+TEST(ConfigSnapshotTest, ReturnsConfig) {
+  ConfigSnapshot<TestConfig> snapshot({.timeout_ms = 10, .domain = "a.com"});
+  std::shared_ptr<const TestConfig> config = snapshot.Get();
+  EXPECT_EQ(config->timeout_ms, 10);
+  EXPECT_EQ(config->domain, "a.com");
+}
+
+TEST(ConfigSnapshotTest, UpdateKeepsConfigsHeldByReaders) {
+  ConfigSnapshot<TestConfig> snapshot({.timeout_ms = 10});
+  std::shared_ptr<const TestConfig> before = snapshot.Get();
+  snapshot.Update({.timeout_ms = 20});
+  EXPECT_EQ(before->timeout_ms, 10);
+  EXPECT_EQ(snapshot.Get()->timeout_ms, 20);
+}
+
+TEST(ConfigSnapshotTest, ReadersSeeWholeConfigsDuringUpdates) {
+  ConfigSnapshot<TestConfig> snapshot({.timeout_ms = 0, .domain = "0"});
+  std::thread writer([&snapshot]() {
+    for (int i = 1; i <= 1000; ++i) {
+      snapshot.Update({.timeout_ms = i, .domain = std::to_string(i)});
+    }
+  });
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.emplace_back([&snapshot]() {
+      for (int j = 0; j < 1000; ++j) {
+        std::shared_ptr<const TestConfig> config = snapshot.Get();
+        EXPECT_EQ(config->domain, std::to_string(config->timeout_ms));
+      }
+    });
+  }
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(snapshot.Get()->timeout_ms, 1000);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,177 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cpu_placement.h"
+
+#include <errno.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view list) {
+  std::vector<int> cpus;
+  for (absl::string_view range :
+       absl::StrSplit(list, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> bounds =
+        absl::StrSplit(absl::StripAsciiWhitespace(range), '-');
+    int first = 0;
+    int last = 0;
+    if (!absl::SimpleAtoi(bounds.first, &first) ||
+        !absl::SimpleAtoi(bounds.second.empty() ? bounds.first : bounds.second,
+                          &last) ||
+        first < 0 || first > last || last >= CPU_SETSIZE) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU range: ", range));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+absl::StatusOr<CpuPlacement> ParseCpuPlacement(absl::string_view placement) {
+  CpuPlacement parsed;
+  for (absl::string_view part :
+       absl::StrSplit(placement, ';', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> name_and_cpus =
+        absl::StrSplit(part, absl::MaxSplits('=', 1));
+    const absl::string_view name =
+        absl::StripAsciiWhitespace(name_and_cpus.first);
+    std::vector<int>* cpus = nullptr;
+    if (name == "roma") {
+      cpus = &parsed.roma_cpus;
+    } else if (name == "inference") {
+      cpus = &parsed.inference_cpus;
+    } else if (name == "grpc") {
+      cpus = &parsed.grpc_cpus;
+    } else if (name == "io") {
+      cpus = &parsed.io_cpus;
+    } else {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown CPU placement part: ", name));
+    }
+    absl::StatusOr<std::vector<int>> part_cpus =
+        ParseCpuList(name_and_cpus.second);
+    if (!part_cpus.ok()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Invalid CPUs of ", name, ": ", part_cpus.status().message()));
+    }
+    *cpus = *std::move(part_cpus);
+  }
+  return parsed;
+}
+
+std::vector<int> NumaNodesOfCpus(const std::vector<int>& cpus) {
+  std::vector<int> nodes;
+  for (int cpu : cpus) {
+    // The directory of each CPU links to the directory of its node.
+    const std::filesystem::path cpu_dir =
+        absl::StrCat("/sys/devices/system/cpu/cpu", cpu);
+    std::error_code error;
+    for (const auto& entry :
+         std::filesystem::directory_iterator(cpu_dir, error)) {
+      const std::string name = entry.path().filename().string();
+      int node = 0;
+      if (absl::string_view suffix = name;
+          absl::ConsumePrefix(&suffix, "node") &&
+          absl::SimpleAtoi(suffix, &node)) {
+        nodes.push_back(node);
+      }
+    }
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  return nodes;
+}
+
+ScopedCpuPlacement::ScopedCpuPlacement(absl::string_view part,
+                                       const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return;
+  }
+  absl::Cleanup log_error = [this, part]() {
+    if (!status_.ok()) {
+      ABSL_LOG(WARNING) << "Could not place " << part << ": " << status_;
+    }
+  };
+  // A pid of 0 stands for the calling thread.
+  if (sched_getaffinity(0, sizeof(previous_cpus_), &previous_cpus_) == 0) {
+    cpu_set_t placed_cpus;
+    CPU_ZERO(&placed_cpus);
+    for (int cpu : cpus) {
+      CPU_SET(cpu, &placed_cpus);
+    }
+    if (sched_setaffinity(0, sizeof(placed_cpus), &placed_cpus) == 0) {
+      restore_cpus_ = true;
+    } else {
+      status_ = absl::ErrnoToStatus(errno, "sched_setaffinity() failed");
+    }
+  } else {
+    status_ = absl::ErrnoToStatus(errno, "sched_getaffinity() failed");
+  }
+
+  const std::vector<int> nodes = NumaNodesOfCpus(cpus);
+  if (nodes.empty()) {
+    return;
+  }
+  if (syscall(SYS_get_mempolicy, &previous_memory_mode_,
+              previous_memory_nodes_, kMaxNumaNodes, nullptr, 0) != 0) {
+    status_.Update(absl::ErrnoToStatus(errno, "get_mempolicy() failed"));
+    return;
+  }
+  unsigned long placed_nodes[kMaxNumaNodes / kBitsPerWord] = {};
+  for (int node : nodes) {
+    if (node < kMaxNumaNodes) {
+      placed_nodes[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    }
+  }
+  if (syscall(SYS_set_mempolicy, MPOL_BIND, placed_nodes, kMaxNumaNodes) !=
+      0) {
+    status_.Update(absl::ErrnoToStatus(errno, "set_mempolicy() failed"));
+    return;
+  }
+  restore_memory_ = true;
+}
+
+ScopedCpuPlacement::~ScopedCpuPlacement() {
+  if (restore_memory_) {
+    syscall(SYS_set_mempolicy, previous_memory_mode_,
+            previous_memory_mode_ == MPOL_DEFAULT ? nullptr
+                                                  : previous_memory_nodes_,
+            previous_memory_mode_ == MPOL_DEFAULT ? 0 : kMaxNumaNodes);
+  }
+  if (restore_cpus_) {
+    sched_setaffinity(0, sizeof(previous_cpus_), &previous_cpus_);
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,82 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
+#define SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
+
+#include <sched.h>
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// CPUs each part of a server runs on, so that the Roma workers, the inference
+// sidecars, the gRPC threads and the I/O loops do not compete for the same
+// cores. A part without CPUs floats freely.
+struct CpuPlacement {
+  std::vector<int> roma_cpus;
+  std::vector<int> inference_cpus;
+  std::vector<int> grpc_cpus;
+  std::vector<int> io_cpus;
+};
+
+// Parses a placement such as "roma=0-15;inference=16-23;grpc=24-27;io=28-31".
+// Every part is optional, the empty string places nothing.
+absl::StatusOr<CpuPlacement> ParseCpuPlacement(absl::string_view placement);
+
+// Parses a list of CPUs in the cpuset format, such as "0-3,8,10-11".
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view list);
+
+// Returns the NUMA nodes of `cpus`, read from sysfs. Empty if the machine does
+// not expose its NUMA topology.
+std::vector<int> NumaNodesOfCpus(const std::vector<int>& cpus);
+
+// Pins the calling thread to `cpus` and binds its memory allocations to their
+// NUMA nodes for the lifetime of the object, then restores the previous
+// placement of the thread. The threads and processes it creates meanwhile
+// keep the placement, which is how Roma workers, sidecars and thread pools
+// are placed: they are created within the scope. No-op if `cpus` is empty.
+// Failures are logged with the name of the placed `part`.
+class ScopedCpuPlacement {
+ public:
+  ScopedCpuPlacement(absl::string_view part, const std::vector<int>& cpus);
+  ~ScopedCpuPlacement();
+
+  // ScopedCpuPlacement is neither copyable nor movable.
+  ScopedCpuPlacement(const ScopedCpuPlacement&) = delete;
+  ScopedCpuPlacement& operator=(const ScopedCpuPlacement&) = delete;
+
+  // Error of the pinning or of the memory binding, if either failed. The
+  // other one still applies.
+  const absl::Status& status() const { return status_; }
+
+ private:
+  static constexpr int kMaxNumaNodes = 1024;
+  static constexpr int kBitsPerWord = 8 * sizeof(unsigned long);
+
+  bool restore_cpus_ = false;
+  cpu_set_t previous_cpus_;
+  bool restore_memory_ = false;
+  int previous_memory_mode_ = 0;
+  unsigned long previous_memory_nodes_[kMaxNumaNodes / kBitsPerWord] = {};
+  absl::Status status_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
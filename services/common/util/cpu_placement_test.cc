@@ -0,0 +1,101 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cpu_placement.h"
+
+#include <sched.h>
+
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::vector<int> CurrentThreadCpus() {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  sched_getaffinity(0, sizeof(cpus), &cpus);
+  std::vector<int> cpu_list;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &cpus)) {
+      cpu_list.push_back(cpu);
+    }
+  }
+  return cpu_list;
+}
+
+TEST(ParseCpuListTest, ParsesRangesAndSingleCpus) {
+  auto cpus = ParseCpuList("4-6, 0,5,9");
+  ASSERT_TRUE(cpus.ok()) << cpus.status();
+  EXPECT_THAT(*cpus, ElementsAre(0, 4, 5, 6, 9));
+}
+
+TEST(ParseCpuListTest, RejectsInvalidRanges) {
+  EXPECT_FALSE(ParseCpuList("3-1").ok());
+  EXPECT_FALSE(ParseCpuList("a").ok());
+  EXPECT_FALSE(ParseCpuList("-1").ok());
+  EXPECT_FALSE(ParseCpuList("0-100000").ok());
+}
+
+TEST(ParseCpuPlacementTest, ParsesParts) {
+  auto placement = ParseCpuPlacement("roma=0-2; grpc=3;io=4,5");
+  ASSERT_TRUE(placement.ok()) << placement.status();
+  EXPECT_THAT(placement->roma_cpus, ElementsAre(0, 1, 2));
+  EXPECT_THAT(placement->grpc_cpus, ElementsAre(3));
+  EXPECT_THAT(placement->io_cpus, ElementsAre(4, 5));
+  EXPECT_THAT(placement->inference_cpus, IsEmpty());
+}
+
+TEST(ParseCpuPlacementTest, EmptyPlacementPlacesNothing) {
+  auto placement = ParseCpuPlacement("");
+  ASSERT_TRUE(placement.ok()) << placement.status();
+  EXPECT_THAT(placement->roma_cpus, IsEmpty());
+  EXPECT_THAT(placement->grpc_cpus, IsEmpty());
+}
+
+TEST(ParseCpuPlacementTest, RejectsUnknownParts) {
+  EXPECT_FALSE(ParseCpuPlacement("gpu=0").ok());
+  EXPECT_FALSE(ParseCpuPlacement("roma=x").ok());
+}
+
+TEST(ScopedCpuPlacementTest, PinsThreadsCreatedInScopeAndRestores) {
+  const std::vector<int> initial_cpus = CurrentThreadCpus();
+  ASSERT_FALSE(initial_cpus.empty());
+  const std::vector<int> placed_cpus = {initial_cpus.front()};
+  std::vector<int> thread_cpus;
+  {
+    ScopedCpuPlacement placement("test", placed_cpus);
+    EXPECT_EQ(CurrentThreadCpus(), placed_cpus);
+    std::thread([&thread_cpus]() { thread_cpus = CurrentThreadCpus(); })
+        .join();
+  }
+  EXPECT_EQ(thread_cpus, placed_cpus);
+  EXPECT_EQ(CurrentThreadCpus(), initial_cpus);
+}
+
+TEST(ScopedCpuPlacementTest, EmptyCpusPlaceNothing) {
+  const std::vector<int> initial_cpus = CurrentThreadCpus();
+  ScopedCpuPlacement placement("test", {});
+  EXPECT_TRUE(placement.status().ok());
+  EXPECT_EQ(CurrentThreadCpus(), initial_cpus);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
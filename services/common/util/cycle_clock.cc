@@ -0,0 +1,57 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cycle_clock.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+#if defined(__x86_64__)
+// How long the ticks are counted against steady_clock for the calibration.
+constexpr std::chrono::milliseconds kCalibrationTime(2);
+#endif
+
+double CalibrateNanosecondsPerTick() {
+#if defined(__x86_64__)
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  const int64_t start_ticks = CycleClock::Now();
+  Clock::time_point end;
+  do {
+    end = Clock::now();
+  } while (end - start < kCalibrationTime);
+  const int64_t ticks = CycleClock::Now() - start_ticks;
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         static_cast<double>(ticks);
+#elif defined(__aarch64__)
+  // The frequency of the virtual counter is known.
+  int64_t ticks_per_second;
+  asm volatile("mrs %0, cntfrq_el0" : "=r"(ticks_per_second));
+  return 1e9 / static_cast<double>(ticks_per_second);
+#else
+  return 1.0;
+#endif
+}
+
+}  // namespace
+
+double CycleClock::NanosecondsPerTick() {
+  static const double nanoseconds_per_tick = CalibrateNanosecondsPerTick();
+  return nanoseconds_per_tick;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,77 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_CYCLE_CLOCK_H_
+#define SERVICES_COMMON_UTIL_CYCLE_CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Monotonic clock for timing hot paths, cheap enough to be left on for every
+// request: reading it costs a few nanoseconds. It reads the time stamp
+// counter on x86-64 and the virtual counter on AArch64, and falls back to
+// steady_clock elsewhere. The time stamp counter of the server CPUs ticks at
+// a constant rate, synchronized across cores.
+//
+// Only differences of ticks are meaningful. They are converted to durations
+// at a rate calibrated against steady_clock on the first conversion.
+class CycleClock {
+ public:
+  static int64_t Now() {
+#if defined(__x86_64__)
+    return static_cast<int64_t>(__rdtsc());
+#elif defined(__aarch64__)
+    int64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  // Converts a difference of ticks to a duration.
+  static absl::Duration ToDuration(int64_t ticks) {
+    return absl::Nanoseconds(static_cast<double>(ticks) * NanosecondsPerTick());
+  }
+
+ private:
+  static double NanosecondsPerTick();
+};
+
+// Measures the time elapsed since its construction.
+class CycleTimer {
+ public:
+  CycleTimer() : start_(CycleClock::Now()) {}
+
+  absl::Duration Elapsed() const {
+    return CycleClock::ToDuration(CycleClock::Now() - start_);
+  }
+
+ private:
+  int64_t start_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CYCLE_CLOCK_H_
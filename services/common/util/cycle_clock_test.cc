@@ -0,0 +1,39 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cycle_clock.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(CycleClockTest, IsMonotonic) {
+  const int64_t first = CycleClock::Now();
+  EXPECT_GE(CycleClock::Now(), first);
+}
+
+TEST(CycleClockTest, MeasuresElapsedTime) {
+  CycleTimer timer;
+  absl::SleepFor(absl::Milliseconds(20));
+  const absl::Duration elapsed = timer.Elapsed();
+
+  EXPECT_GE(elapsed, absl::Milliseconds(19));
+  EXPECT_LT(elapsed, absl::Seconds(1));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
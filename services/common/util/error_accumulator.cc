@@ -54,6 +54,15 @@ const ErrorAccumulator::ErrorMap& ErrorAccumulator::GetErrors(
 
 bool ErrorAccumulator::HasErrors() const { return !dst_error_map_.empty(); }
 
+void ErrorAccumulator::MergeFrom(const ErrorAccumulator& other) {
+  for (const auto& [error_visibility, error_map] : other.dst_error_map_) {
+    for (const auto& [error_code, errors] : error_map) {
+      dst_error_map_[error_visibility][error_code].insert(errors.begin(),
+                                                          errors.end());
+    }
+  }
+}
+
 std::string ErrorAccumulator::GetAccumulatedErrorString(
     ErrorVisibility error_visibility) {
   const ErrorAccumulator::ErrorMap& error_map = GetErrors(error_visibility);
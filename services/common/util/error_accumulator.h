@@ -66,6 +66,10 @@ class ErrorAccumulator : public ErrorReporter {
   // Gets a string of all errors concatenated by visibility.
   std::string GetAccumulatedErrorString(ErrorVisibility error_visibility);
 
+  // Adds all the errors known to other, e.g. when work reporting to separate
+  // accumulators is done in parallel. The errors are not logged again.
+  void MergeFrom(const ErrorAccumulator& other);
+
  private:
   // Mapping from error visibility => { Error Code => List of Errors }.
   absl::flat_hash_map<ErrorVisibility, ErrorMap> dst_error_map_;
@@ -93,4 +93,26 @@ TEST(ErrorAccumulatorTest, ReturnsConcatenatedErrorString) {
             server_visible_error_str);
 }
 
+TEST(ErrorAccumulatorTest, MergesErrors) {
+  ErrorAccumulator error_accumulator;
+  error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, "first",
+                                ErrorCode::CLIENT_SIDE);
+  ErrorAccumulator other;
+  other.ReportError(ErrorVisibility::CLIENT_VISIBLE, "second",
+                    ErrorCode::CLIENT_SIDE);
+  other.ReportError(ErrorVisibility::AD_SERVER_VISIBLE, "third",
+                    ErrorCode::SERVER_SIDE);
+
+  error_accumulator.MergeFrom(other);
+
+  ErrorAccumulator::ErrorMap expected_client_errors = {
+      {ErrorCode::CLIENT_SIDE, {"first", "second"}}};
+  EXPECT_EQ(error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE),
+            expected_client_errors);
+  ErrorAccumulator::ErrorMap expected_ad_server_errors = {
+      {ErrorCode::SERVER_SIDE, {"third"}}};
+  EXPECT_EQ(error_accumulator.GetErrors(ErrorVisibility::AD_SERVER_VISIBLE),
+            expected_ad_server_errors);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -88,6 +88,8 @@ inline constexpr char kEmptySellerSignals[] =
 inline constexpr char kEmptyAuctionSignals[] =
     "Auction signals missing in auction config";
 inline constexpr char kEmptyBuyerList[] = "No buyers specified";
+inline constexpr char kTooManyBuyers[] =
+    "Too many buyers specified: %d, at most %d are supported";
 inline constexpr char kEmptySeller[] =
     "Seller origin missing in auction config";
 inline constexpr char kEmptyBuyerSignals[] =
@@ -0,0 +1,203 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/fair_admission_controller.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Tokens a caller may save up, i.e. its burst.
+double MaxTokens(const FairAdmissionConfig& config) {
+  return std::max(1.0, config.caller_requests_per_second);
+}
+
+int WeightOf(const FairAdmissionConfig& config, absl::string_view caller) {
+  auto it = config.caller_weights.find(caller);
+  return it == config.caller_weights.end() ? 1 : std::max(1, it->second);
+}
+
+}  // namespace
+
+AdmissionTicket::AdmissionTicket(AdmissionTicket&& other)
+    : controller_(std::exchange(other.controller_, nullptr)),
+      caller_(std::move(other.caller_)) {}
+
+AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) {
+  if (this != &other) {
+    if (controller_ != nullptr) {
+      controller_->Release(caller_);
+    }
+    controller_ = std::exchange(other.controller_, nullptr);
+    caller_ = std::move(other.caller_);
+  }
+  return *this;
+}
+
+AdmissionTicket::~AdmissionTicket() {
+  if (controller_ != nullptr) {
+    controller_->Release(caller_);
+  }
+}
+
+FairAdmissionController& FairAdmissionController::Get() {
+  static FairAdmissionController* controller = new FairAdmissionController;
+  return *controller;
+}
+
+FairAdmissionController::FairAdmissionController(Clock clock)
+    : clock_(std::move(clock)) {}
+
+void FairAdmissionController::Configure(FairAdmissionConfig config) {
+  absl::MutexLock lock(&mu_);
+  config_ = std::move(config);
+}
+
+absl::StatusOr<AdmissionTicket> FairAdmissionController::Admit(
+    absl::string_view caller, absl::Time deadline) {
+  absl::MutexLock lock(&mu_);
+  const absl::Time now = clock_();
+  if (config_.min_time_to_deadline > absl::ZeroDuration() &&
+      deadline - now < config_.min_time_to_deadline) {
+    return absl::DeadlineExceededError(absl::StrCat(
+        "Only ", absl::FormatDuration(deadline - now),
+        " left to serve the request, less than the minimum of ",
+        absl::FormatDuration(config_.min_time_to_deadline)));
+  }
+  const bool rate_limited = config_.caller_requests_per_second > 0;
+  if (!rate_limited && config_.max_in_flight <= 0) {
+    return AdmissionTicket();
+  }
+
+  auto [it, inserted] = callers_.try_emplace(caller);
+  CallerState& state = it->second;
+  if (inserted) {
+    state.tokens = MaxTokens(config_);
+    state.refill_time = now;
+  }
+  if (rate_limited) {
+    Refill(state, now);
+    if (state.tokens < 1) {
+      return absl::ResourceExhaustedError(absl::StrCat(
+          "Caller ", caller, " is past its rate of ",
+          config_.caller_requests_per_second, " requests per second"));
+    }
+  }
+  if (config_.max_in_flight > 0) {
+    const int weight =
+        state.in_flight > 0 ? state.weight : WeightOf(config_, caller);
+    const int active_weight =
+        active_weight_ + (state.in_flight > 0 ? 0 : weight);
+    const double fair_share =
+        static_cast<double>(config_.max_in_flight) * weight / active_weight;
+    const double limit =
+        state.in_flight < fair_share
+            ? config_.max_in_flight
+            : config_.max_in_flight * (1 - config_.fair_share_headroom);
+    if (in_flight_ >= limit) {
+      MaybeForget(caller, now);
+      return absl::ResourceExhaustedError(absl::StrCat(
+          "Server is at capacity for caller ", caller, ": ", in_flight_,
+          " requests in flight, out of ", config_.max_in_flight));
+    }
+  }
+
+  if (rate_limited) {
+    state.tokens -= 1;
+  }
+  if (state.in_flight++ == 0) {
+    state.weight = WeightOf(config_, caller);
+    active_weight_ += state.weight;
+  }
+  ++in_flight_;
+  return AdmissionTicket(this, std::string(caller));
+}
+
+int FairAdmissionController::in_flight() const {
+  absl::MutexLock lock(&mu_);
+  return in_flight_;
+}
+
+int FairAdmissionController::in_flight(absl::string_view caller) const {
+  absl::MutexLock lock(&mu_);
+  auto it = callers_.find(caller);
+  return it == callers_.end() ? 0 : it->second.in_flight;
+}
+
+void FairAdmissionController::Release(absl::string_view caller) {
+  absl::MutexLock lock(&mu_);
+  auto it = callers_.find(caller);
+  if (it == callers_.end()) {
+    return;
+  }
+  --in_flight_;
+  if (--it->second.in_flight == 0) {
+    active_weight_ -= it->second.weight;
+    it->second.weight = 0;
+  }
+  MaybeForget(caller, clock_());
+}
+
+void FairAdmissionController::Refill(CallerState& state,
+                                     absl::Time now) const {
+  if (config_.caller_requests_per_second <= 0) {
+    return;
+  }
+  state.tokens = std::min(
+      MaxTokens(config_),
+      state.tokens + absl::ToDoubleSeconds(now - state.refill_time) *
+                         config_.caller_requests_per_second);
+  state.refill_time = now;
+}
+
+void FairAdmissionController::MaybeForget(absl::string_view caller,
+                                          absl::Time now) {
+  auto it = callers_.find(caller);
+  if (it == callers_.end() || it->second.in_flight > 0) {
+    return;
+  }
+  // A caller with a full bucket is as good as a new one.
+  Refill(it->second, now);
+  if (it->second.tokens >= MaxTokens(config_)) {
+    callers_.erase(it);
+  }
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, int>> ParseCallerWeights(
+    absl::string_view weights) {
+  absl::flat_hash_map<std::string, int> parsed;
+  for (absl::string_view part :
+       absl::StrSplit(weights, ',', absl::SkipWhitespace())) {
+    const size_t separator = part.rfind('=');
+    int weight = 0;
+    if (separator == absl::string_view::npos ||
+        !absl::SimpleAtoi(part.substr(separator + 1), &weight) ||
+        weight <= 0) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid caller weight: ", part));
+    }
+    parsed[absl::StripAsciiWhitespace(part.substr(0, separator))] = weight;
+  }
+  return parsed;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,150 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_FAIR_ADMISSION_CONTROLLER_H_
+#define SERVICES_COMMON_UTIL_FAIR_ADMISSION_CONTROLLER_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+class FairAdmissionController;
+
+// Slot of an admitted request among the requests in flight, given back when
+// destroyed.
+class AdmissionTicket {
+ public:
+  AdmissionTicket() = default;
+  AdmissionTicket(AdmissionTicket&& other);
+  AdmissionTicket& operator=(AdmissionTicket&& other);
+  ~AdmissionTicket();
+
+  // AdmissionTicket is movable but not copyable.
+  AdmissionTicket(const AdmissionTicket&) = delete;
+  AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+ private:
+  friend class FairAdmissionController;
+
+  AdmissionTicket(FairAdmissionController* controller, std::string caller)
+      : controller_(controller), caller_(std::move(caller)) {}
+
+  FairAdmissionController* controller_ = nullptr;
+  std::string caller_;
+};
+
+struct FairAdmissionConfig {
+  // Max number of requests in flight, across callers. No limit if 0.
+  int max_in_flight = 0;
+  // Share of `max_in_flight` that callers past their fair share may not take,
+  // so that it is left to the callers below theirs.
+  double fair_share_headroom = 0.1;
+  // Requests each caller may start per second, with bursts of up to a
+  // second's worth of requests. No limit if 0.
+  double caller_requests_per_second = 0;
+  // Weights of the callers in their shares of `max_in_flight`, 1 for the
+  // callers not listed. A caller with weight 2 gets twice the share of a
+  // caller with weight 1.
+  absl::flat_hash_map<std::string, int> caller_weights;
+  // Time a request needs at least to be served. Requests with less time left
+  // before their deadline are rejected right away. No minimum if 0.
+  absl::Duration min_time_to_deadline = absl::ZeroDuration();
+};
+
+// Admits requests so that no caller can take the capacity of the server from
+// the others, and rejects fast the requests which could not be served in
+// time, instead of letting them wait out their deadline. Thread-safe.
+//
+// Each caller is rate limited by a token bucket. Capacity, i.e. the requests
+// in flight, is shared by weighted max-min fairness: the callers with
+// requests in flight split `max_in_flight` by weight, a caller below its
+// share is admitted as long as the server has room, and a caller past its
+// share only while the server has more than `fair_share_headroom` of room
+// left. The headroom thus goes to the callers below their share, e.g. a
+// caller which just showed up while another one fills the server.
+class FairAdmissionController {
+ public:
+  using Clock = absl::AnyInvocable<absl::Time() const>;
+
+  // Controller used by the services, admitting every request until it is
+  // configured.
+  static FairAdmissionController& Get();
+
+  explicit FairAdmissionController(Clock clock = absl::Now);
+
+  FairAdmissionController(const FairAdmissionController&) = delete;
+  FairAdmissionController& operator=(const FairAdmissionController&) = delete;
+
+  void Configure(FairAdmissionConfig config) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Admits a request of `caller` which must be served by `deadline`, taking
+  // a slot to be held until the request is done. Fails with DeadlineExceeded
+  // if the request has not enough time left, and with ResourceExhausted if
+  // the caller is past its rate or its share of the server.
+  absl::StatusOr<AdmissionTicket> Admit(absl::string_view caller,
+                                        absl::Time deadline)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Requests in flight, of every caller and of `caller`.
+  int in_flight() const ABSL_LOCKS_EXCLUDED(mu_);
+  int in_flight(absl::string_view caller) const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  friend class AdmissionTicket;
+
+  struct CallerState {
+    int in_flight = 0;
+    // Weight of the caller while it has requests in flight.
+    int weight = 0;
+    double tokens = 0;
+    absl::Time refill_time = absl::InfinitePast();
+  };
+
+  void Release(absl::string_view caller) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Adds the tokens `state` earned since it was last refilled.
+  void Refill(CallerState& state, absl::Time now) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Drops the state of `caller` if it has nothing left to remember.
+  void MaybeForget(absl::string_view caller, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Clock clock_;
+
+  mutable absl::Mutex mu_;
+  FairAdmissionConfig config_ ABSL_GUARDED_BY(mu_);
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  // Sum of the weights of the callers with requests in flight.
+  int active_weight_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<std::string, CallerState> callers_ ABSL_GUARDED_BY(mu_);
+};
+
+// Parses the weights of callers listed as `caller=weight,...`, e.g.
+// "https://seller-a.com=2,https://seller-b.com=1".
+absl::StatusOr<absl::flat_hash_map<std::string, int>> ParseCallerWeights(
+    absl::string_view weights);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_FAIR_ADMISSION_CONTROLLER_H_
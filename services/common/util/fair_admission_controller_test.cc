@@ -0,0 +1,139 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/fair_admission_controller.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+const absl::Time kNow = absl::FromUnixSeconds(1000);
+const absl::Time kDeadline = kNow + absl::Seconds(1);
+
+TEST(FairAdmissionControllerTest, AdmitsEveryRequestUntilConfigured) {
+  FairAdmissionController controller([]() { return kNow; });
+
+  absl::StatusOr<AdmissionTicket> ticket = controller.Admit("a", kNow);
+
+  ASSERT_TRUE(ticket.ok()) << ticket.status();
+  EXPECT_EQ(controller.in_flight(), 0);
+}
+
+TEST(FairAdmissionControllerTest, RejectsRequestsWithoutTimeLeft) {
+  FairAdmissionController controller([]() { return kNow; });
+  controller.Configure({.min_time_to_deadline = absl::Milliseconds(100)});
+
+  EXPECT_TRUE(controller.Admit("a", kNow + absl::Milliseconds(100)).ok());
+  EXPECT_EQ(controller.Admit("a", kNow + absl::Milliseconds(99))
+                .status()
+                .code(),
+            absl::StatusCode::kDeadlineExceeded);
+}
+
+TEST(FairAdmissionControllerTest, HoldsSlotUntilTicketIsDestroyed) {
+  FairAdmissionController controller([]() { return kNow; });
+  controller.Configure({.max_in_flight = 1});
+
+  {
+    absl::StatusOr<AdmissionTicket> ticket = controller.Admit("a", kDeadline);
+    ASSERT_TRUE(ticket.ok()) << ticket.status();
+    AdmissionTicket moved = *std::move(ticket);
+    EXPECT_EQ(controller.in_flight(), 1);
+    EXPECT_EQ(controller.Admit("a", kDeadline).status().code(),
+              absl::StatusCode::kResourceExhausted);
+  }
+  EXPECT_EQ(controller.in_flight(), 0);
+  EXPECT_TRUE(controller.Admit("a", kDeadline).ok());
+}
+
+TEST(FairAdmissionControllerTest, KeepsHeadroomForCallersBelowTheirShare) {
+  FairAdmissionController controller([]() { return kNow; });
+  controller.Configure({.max_in_flight = 10, .fair_share_headroom = 0.2});
+
+  std::vector<AdmissionTicket> tickets;
+  for (int i = 0; i < 8; ++i) {
+    absl::StatusOr<AdmissionTicket> ticket = controller.Admit("a", kDeadline);
+    ASSERT_TRUE(ticket.ok()) << ticket.status();
+    tickets.push_back(*std::move(ticket));
+  }
+  absl::StatusOr<AdmissionTicket> b1 = controller.Admit("b", kDeadline);
+  ASSERT_TRUE(b1.ok()) << b1.status();
+
+  // "a" is past its share of 5, so it may not take the last 2 slots, which
+  // "b", below its share, still gets.
+  EXPECT_EQ(controller.Admit("a", kDeadline).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  absl::StatusOr<AdmissionTicket> b2 = controller.Admit("b", kDeadline);
+  EXPECT_TRUE(b2.ok()) << b2.status();
+  EXPECT_EQ(controller.Admit("b", kDeadline).status().code(),
+            absl::StatusCode::kResourceExhausted);
+}
+
+TEST(FairAdmissionControllerTest, SharesCapacityByWeight) {
+  FairAdmissionController controller([]() { return kNow; });
+  controller.Configure({.max_in_flight = 9,
+                        .fair_share_headroom = 0.5,
+                        .caller_weights = {{"a", 2}}});
+
+  std::vector<AdmissionTicket> tickets;
+  absl::StatusOr<AdmissionTicket> b = controller.Admit("b", kDeadline);
+  ASSERT_TRUE(b.ok()) << b.status();
+  // With "b" active, the share of "a" is 6 of 9, and past it "a" may not
+  // take the server past 4.5 requests in flight.
+  absl::StatusOr<AdmissionTicket> ticket;
+  while ((ticket = controller.Admit("a", kDeadline)).ok()) {
+    tickets.push_back(*std::move(ticket));
+  }
+  EXPECT_EQ(controller.in_flight("a"), 6);
+  EXPECT_EQ(controller.in_flight("b"), 1);
+}
+
+TEST(FairAdmissionControllerTest, RateLimitsEachCaller) {
+  absl::Time now = kNow;
+  FairAdmissionController controller([&now]() { return now; });
+  controller.Configure({.caller_requests_per_second = 2});
+
+  EXPECT_TRUE(controller.Admit("a", kDeadline).ok());
+  EXPECT_TRUE(controller.Admit("a", kDeadline).ok());
+  EXPECT_EQ(controller.Admit("a", kDeadline).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_TRUE(controller.Admit("b", kDeadline).ok());
+
+  now += absl::Milliseconds(500);
+  EXPECT_TRUE(controller.Admit("a", kDeadline).ok());
+  EXPECT_FALSE(controller.Admit("a", kDeadline).ok());
+}
+
+TEST(ParseCallerWeightsTest, ParsesWeightsOfCallers) {
+  absl::StatusOr<absl::flat_hash_map<std::string, int>> weights =
+      ParseCallerWeights("https://a.com=2, https://b.com = 3");
+
+  ASSERT_TRUE(weights.ok()) << weights.status();
+  EXPECT_EQ(*weights, (absl::flat_hash_map<std::string, int>{
+                          {"https://a.com", 2}, {"https://b.com", 3}}));
+  EXPECT_TRUE(ParseCallerWeights("")->empty());
+  EXPECT_FALSE(ParseCallerWeights("https://a.com").ok());
+  EXPECT_FALSE(ParseCallerWeights("https://a.com=0").ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,75 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/grpc_server_options.h"
+
+#include <grpcpp/health_check_service_interface.h>
+#include <grpcpp/resource_quota.h>
+
+#include "absl/log/absl_log.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void ApplyGrpcServerOptions(const GrpcServerOptions& options,
+                            grpc::ServerBuilder& builder) {
+  if (options.num_cqs > 0) {
+    builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS,
+                                options.num_cqs);
+  }
+  if (options.max_pollers > 0) {
+    builder.SetSyncServerOption(
+        grpc::ServerBuilder::SyncServerOption::MAX_POLLERS,
+        options.max_pollers);
+  }
+  if (options.max_memory_bytes <= 0 && options.max_threads <= 0) {
+    return;
+  }
+  grpc::ResourceQuota resource_quota("grpc_server");
+  if (options.max_memory_bytes > 0) {
+    resource_quota.Resize(options.max_memory_bytes);
+  }
+  if (options.max_threads > 0) {
+    resource_quota.SetMaxThreads(options.max_threads);
+  }
+  builder.SetResourceQuota(resource_quota);
+}
+
+void PreconnectBackends(const BackendPreconnectOptions& options,
+                        absl::FunctionRef<int(absl::Time)> connect,
+                        grpc::Server& server) {
+  if (options.timeout <= absl::ZeroDuration()) {
+    return;
+  }
+  grpc::HealthCheckServiceInterface* health_check_service =
+      server.GetHealthCheckService();
+  if (health_check_service != nullptr) {
+    health_check_service->SetServingStatus(false);
+  }
+  while (true) {
+    const int connected_percent = connect(absl::Now() + options.timeout);
+    if (connected_percent >= options.ready_percent) {
+      ABSL_LOG(INFO) << connected_percent
+                     << "% of the backend channels connected";
+      break;
+    }
+    ABSL_LOG(WARNING) << "Only " << connected_percent
+                      << "% of the backend channels connected, waiting for "
+                      << options.ready_percent << "% to serve";
+  }
+  if (health_check_service != nullptr) {
+    health_check_service->SetServingStatus(true);
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,73 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
+#define SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
+
+#include <cstdint>
+
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include "absl/functional/function_ref.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Threading and resource limits of the gRPC server of a service, so that its
+// request handling concurrency can be tuned per machine shape. Zero keeps the
+// gRPC default.
+struct GrpcServerOptions {
+  // Completion queues polled by the server.
+  int num_cqs = 0;
+  // Maximum number of threads polling each completion queue.
+  int max_pollers = 0;
+  // Memory the server may use for its connections and requests.
+  int64_t max_memory_bytes = 0;
+  // Maximum number of threads of the server.
+  int max_threads = 0;
+};
+
+// Applies `options` to a server being built. The polling threads and the
+// thread quota apply to the synchronous services of the server, such as the
+// health check service, while the memory quota bounds all the services.
+void ApplyGrpcServerOptions(const GrpcServerOptions& options,
+                            grpc::ServerBuilder& builder);
+
+// Connection of a service to its backends at startup. The channels to the
+// backends connect lazily otherwise, so the first RPCs to each backend after
+// the server starts, e.g. on a scale up, pay for name resolution, the TCP
+// connection and the TLS handshake.
+struct BackendPreconnectOptions {
+  // Time given to each round of connections. No connection at startup if
+  // zero.
+  absl::Duration timeout = absl::ZeroDuration();
+  // Percent of the backend channels to be connected before the health check
+  // of the server reports it as serving. Rounds of connections are repeated
+  // until they are.
+  int ready_percent = 0;
+};
+
+// Connects the backends of a started server with `connect`, which connects
+// the backend channels by the given deadline and returns the percent of them
+// that are connected. Meanwhile, the health check of the server reports it as
+// not serving, so that traffic goes to other servers. Returns once
+// options.ready_percent of the channels are connected.
+void PreconnectBackends(const BackendPreconnectOptions& options,
+                        absl::FunctionRef<int(absl::Time)> connect,
+                        grpc::Server& server);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
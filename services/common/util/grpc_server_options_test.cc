@@ -0,0 +1,99 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/grpc_server_options.h"
+
+#include <memory>
+
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/health_check_service_interface.h>
+#include <grpcpp/server.h>
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(GrpcServerOptionsTest, StartsServerWithDefaults) {
+  grpc::ServerBuilder builder;
+  ApplyGrpcServerOptions({}, builder);
+
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+
+  ASSERT_NE(server, nullptr);
+  server->Shutdown();
+}
+
+TEST(GrpcServerOptionsTest, StartsServerWithLimits) {
+  grpc::ServerBuilder builder;
+  ApplyGrpcServerOptions({.num_cqs = 2,
+                          .max_pollers = 2,
+                          .max_memory_bytes = 64 * 1024 * 1024,
+                          .max_threads = 8},
+                         builder);
+
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+
+  ASSERT_NE(server, nullptr);
+  server->Shutdown();
+}
+
+std::unique_ptr<grpc::Server> StartServerWithHealthCheck(
+    grpc::CallbackGenericService& service) {
+  grpc::EnableDefaultHealthCheckService(true);
+  grpc::ServerBuilder builder;
+  builder.RegisterCallbackGenericService(&service);
+  return builder.BuildAndStart();
+}
+
+TEST(PreconnectBackendsTest, RepeatsConnectionsUntilReady) {
+  grpc::CallbackGenericService service;
+  std::unique_ptr<grpc::Server> server = StartServerWithHealthCheck(service);
+  ASSERT_NE(server, nullptr);
+  int num_rounds = 0;
+  const absl::Time start = absl::Now();
+
+  PreconnectBackends(
+      {.timeout = absl::Seconds(5), .ready_percent = 50},
+      [&num_rounds, start](absl::Time deadline) {
+        EXPECT_GE(deadline, start + absl::Seconds(5));
+        return ++num_rounds * 20;
+      },
+      *server);
+
+  EXPECT_EQ(num_rounds, 3);
+  server->Shutdown();
+}
+
+TEST(PreconnectBackendsTest, DoesNothingWithoutTimeout) {
+  grpc::CallbackGenericService service;
+  std::unique_ptr<grpc::Server> server = StartServerWithHealthCheck(service);
+  ASSERT_NE(server, nullptr);
+  int num_rounds = 0;
+
+  PreconnectBackends(
+      {.ready_percent = 100},
+      [&num_rounds](absl::Time deadline) {
+        ++num_rounds;
+        return 0;
+      },
+      *server);
+
+  EXPECT_EQ(num_rounds, 0);
+  server->Shutdown();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,11 +18,14 @@
 
 #include <utility>
 
+#include "src/util/status_macro/status_macros.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
-absl::StatusOr<HpkeMessage> HpkeEncrypt(
-    const std::string& plaintext, CryptoClientWrapperInterface& crypto_client,
-    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
-    const server_common::CloudPlatform& cloud_platform) {
+namespace {
+
+absl::StatusOr<google::cmrt::sdk::public_key_service::v1::PublicKey>
+GetPublicKey(server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+             const server_common::CloudPlatform& cloud_platform) {
   auto key = key_fetcher_manager.GetPublicKey(cloud_platform);
   if (!key.ok()) {
     std::string error =
@@ -31,8 +34,14 @@ absl::StatusOr<HpkeMessage> HpkeEncrypt(
     ABSL_LOG(ERROR) << error;
     return absl::InternalError(std::move(error));
   }
+  return key;
+}
 
-  auto encrypt_response = crypto_client.HpkeEncrypt(key.value(), plaintext);
+absl::StatusOr<HpkeMessage> HpkeEncryptWithKey(
+    const std::string& plaintext,
+    const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+    CryptoClientWrapperInterface& crypto_client) {
+  auto encrypt_response = crypto_client.HpkeEncrypt(key, plaintext);
 
   if (!encrypt_response.ok()) {
     std::string error = absl::StrCat("Failed encrypting request: ",
@@ -43,11 +52,39 @@ absl::StatusOr<HpkeMessage> HpkeEncrypt(
   HpkeMessage output;
   output.ciphertext = std::move(
       *encrypt_response->mutable_encrypted_data()->mutable_ciphertext());
-  output.key_id = std::move(*key->mutable_key_id());
+  output.key_id = key.key_id();
   output.secret = std::move(*encrypt_response->mutable_secret());
   return output;
 }
 
+}  // namespace
+
+absl::StatusOr<HpkeMessage> HpkeEncrypt(
+    const std::string& plaintext, CryptoClientWrapperInterface& crypto_client,
+    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+    const server_common::CloudPlatform& cloud_platform) {
+  PS_ASSIGN_OR_RETURN(auto key,
+                      GetPublicKey(key_fetcher_manager, cloud_platform));
+  return HpkeEncryptWithKey(plaintext, key, crypto_client);
+}
+
+absl::StatusOr<std::vector<HpkeMessage>> HpkeEncryptBatch(
+    absl::Span<const std::string> plaintexts,
+    CryptoClientWrapperInterface& crypto_client,
+    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+    const server_common::CloudPlatform& cloud_platform) {
+  PS_ASSIGN_OR_RETURN(auto key,
+                      GetPublicKey(key_fetcher_manager, cloud_platform));
+  std::vector<HpkeMessage> messages;
+  messages.reserve(plaintexts.size());
+  for (const std::string& plaintext : plaintexts) {
+    PS_ASSIGN_OR_RETURN(HpkeMessage message,
+                        HpkeEncryptWithKey(plaintext, key, crypto_client));
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
 absl::StatusOr<std::string> HpkeDecrypt(
     // HPKE client requires const string reference.
     const std::string& ciphertext, absl::string_view key_id,
@@ -18,8 +18,10 @@
 #define SERVICES_COMMON_UTIL_HPKE_UTILS_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
@@ -50,6 +52,15 @@ absl::StatusOr<HpkeMessage> HpkeEncrypt(
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
     const server_common::CloudPlatform& cloud_platform);
 
+// Used to encrypt several payloads with HPKE, e.g. the requests fanned out to
+// several servers. The public key is looked up once and used for all the
+// payloads. Fails if any payload fails to encrypt.
+absl::StatusOr<std::vector<HpkeMessage>> HpkeEncryptBatch(
+    absl::Span<const std::string> plaintexts,
+    CryptoClientWrapperInterface& crypto_client,
+    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+    const server_common::CloudPlatform& cloud_platform);
+
 // Used to decrypt a payload with HPKE.
 absl::StatusOr<std::string> HpkeDecrypt(
     // HPKE client requires const string reference.
@@ -16,7 +16,10 @@
 #include "services/common/util/hpke_utils.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 #include "services/common/encryption/mock_crypto_client_wrapper.h"
 #include "src/encryption/key_fetcher/mock/mock_key_fetcher_manager.h"
@@ -222,6 +225,46 @@ TEST(HpkeEncryptTest, ReturnsErrorFromCryptoClient) {
   ASSERT_FALSE(output.ok());
 }
 
+TEST(HpkeEncryptBatchTest, LooksUpPublicKeyOnce) {
+  auto crypto_client = std::make_unique<MockCryptoClientWrapper>();
+  EXPECT_CALL(*crypto_client, HpkeEncrypt)
+      .Times(2)
+      .WillRepeatedly(
+          [](const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+             const std::string& plaintext_payload) {
+            EXPECT_EQ(key.key_id(), kKeyId);
+            google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse
+                hpke_encrypt_response;
+            hpke_encrypt_response.set_secret(
+                absl::StrCat(kSecret, plaintext_payload));
+            hpke_encrypt_response.mutable_encrypted_data()->set_ciphertext(
+                absl::StrCat(kCiphertext, plaintext_payload));
+            return hpke_encrypt_response;
+          });
+  auto key_fetcher_manager =
+      MockKeyFetcherReturningPublicKey(server_common::CloudPlatform::kGcp);
+  const std::vector<std::string> plaintexts = {"a", "b"};
+  absl::StatusOr<std::vector<HpkeMessage>> output =
+      HpkeEncryptBatch(plaintexts, *crypto_client, *key_fetcher_manager,
+                       server_common::CloudPlatform::kGcp);
+  ASSERT_TRUE(output.ok()) << output.status();
+  ASSERT_EQ(output->size(), 2);
+  EXPECT_EQ((*output)[0].ciphertext, absl::StrCat(kCiphertext, "a"));
+  EXPECT_EQ((*output)[0].secret, absl::StrCat(kSecret, "a"));
+  EXPECT_EQ((*output)[1].ciphertext, absl::StrCat(kCiphertext, "b"));
+  EXPECT_EQ((*output)[1].key_id, kKeyId);
+}
+
+TEST(HpkeEncryptBatchTest, ReturnsErrorFromKeyFetcher) {
+  auto crypto_client = MockCryptoClientWithNoHpkeEncryptCall();
+  auto key_fetcher_manager = MockKeyFetcherReturningEmptyPublicKey();
+  const std::vector<std::string> plaintexts = {kPlaintext};
+  EXPECT_FALSE(HpkeEncryptBatch(plaintexts, *crypto_client,
+                                *key_fetcher_manager,
+                                server_common::CloudPlatform::kGcp)
+                   .ok());
+}
+
 TEST(HpkeDecryptTest, CallsCryptoClientAndKeyFetcherManager) {
   auto crypto_client = MockCryptoClientWithHpkeDecrypt(kCiphertext);
   auto key_fetcher_manager = MockKeyFetcherReturningPrivateKey(kKeyId);
@@ -0,0 +1,239 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/interest_group_columns.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using GenerateBidsRawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+using InterestGroupColumns = GenerateBidsRawRequest::InterestGroupColumns;
+using InterestGroupForBidding = GenerateBidsRawRequest::InterestGroupForBidding;
+using google::protobuf::RepeatedField;
+using google::protobuf::RepeatedPtrField;
+
+// Adds each distinct string to the strings of the columns once.
+class StringDictionary {
+ public:
+  explicit StringDictionary(RepeatedPtrField<std::string>& strings)
+      : strings_(strings) {}
+
+  // Returns the index of `value`, which is moved into the dictionary if it is
+  // not in it yet.
+  int32_t Add(std::string& value) {
+    if (auto it = indices_.find(value); it != indices_.end()) {
+      return it->second;
+    }
+    const int32_t index = strings_.size();
+    std::string* added = strings_.Add();
+    *added = std::move(value);
+    // The strings are not moved in memory as more are added.
+    indices_.emplace(*added, index);
+    return index;
+  }
+
+  void AddList(RepeatedPtrField<std::string>& values,
+               RepeatedField<int32_t>& num_values,
+               RepeatedField<int32_t>& indices) {
+    num_values.Add(values.size());
+    for (std::string& value : values) {
+      indices.Add(Add(value));
+    }
+  }
+
+ private:
+  RepeatedPtrField<std::string>& strings_;
+  absl::flat_hash_map<absl::string_view, int32_t> indices_;
+};
+
+// Reads the strings of the columns, counting how many times each is used so
+// that the strings used once are moved out of the columns instead of copied.
+class StringReader {
+ public:
+  explicit StringReader(RepeatedPtrField<std::string>& strings)
+      : strings_(strings), uses_(strings.size(), 0) {}
+
+  bool Use(int32_t index) {
+    if (index < 0 || index >= strings_.size()) {
+      return false;
+    }
+    ++uses_[index];
+    return true;
+  }
+
+  // Checks that the lists of a column use all its indices, and that those are
+  // in range.
+  bool UseList(const RepeatedField<int32_t>& num_values,
+               const RepeatedField<int32_t>& indices) {
+    int64_t total = 0;
+    for (int32_t num : num_values) {
+      if (num < 0) {
+        return false;
+      }
+      total += num;
+    }
+    if (total != indices.size()) {
+      return false;
+    }
+    for (int32_t index : indices) {
+      if (!Use(index)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the string at a valid index.
+  std::string Read(int32_t index) {
+    if (uses_[index] == 1) {
+      return std::move(strings_[index]);
+    }
+    return strings_[index];
+  }
+
+  // Reads the next list of a column, from index `next` of the column.
+  void ReadList(int32_t num_values, const RepeatedField<int32_t>& indices,
+                int& next, RepeatedPtrField<std::string>& values) {
+    values.Reserve(num_values);
+    for (int32_t i = 0; i < num_values; ++i) {
+      *values.Add() = Read(indices[next++]);
+    }
+  }
+
+ private:
+  RepeatedPtrField<std::string>& strings_;
+  std::vector<int> uses_;
+};
+
+}  // namespace
+
+bool EncodeInterestGroupColumns(GenerateBidsRawRequest& raw_request) {
+  if (raw_request.has_interest_group_columns()) {
+    return false;
+  }
+  for (const InterestGroupForBidding& interest_group :
+       raw_request.interest_group_for_bidding()) {
+    if (interest_group.has_android_signals()) {
+      return false;
+    }
+  }
+
+  InterestGroupColumns& columns = *raw_request.mutable_interest_group_columns();
+  StringDictionary dictionary(*columns.mutable_strings());
+  absl::flat_hash_map<std::string, int32_t> browser_signals_indices;
+  for (InterestGroupForBidding& interest_group :
+       *raw_request.mutable_interest_group_for_bidding()) {
+    columns.add_names(dictionary.Add(*interest_group.mutable_name()));
+    columns.add_user_bidding_signals(
+        dictionary.Add(*interest_group.mutable_user_bidding_signals()));
+    dictionary.AddList(*interest_group.mutable_trusted_bidding_signals_keys(),
+                       *columns.mutable_num_trusted_bidding_signals_keys(),
+                       *columns.mutable_trusted_bidding_signals_keys());
+    dictionary.AddList(*interest_group.mutable_ad_render_ids(),
+                       *columns.mutable_num_ad_render_ids(),
+                       *columns.mutable_ad_render_ids());
+    dictionary.AddList(*interest_group.mutable_ad_component_render_ids(),
+                       *columns.mutable_num_ad_component_render_ids(),
+                       *columns.mutable_ad_component_render_ids());
+    if (!interest_group.has_browser_signals()) {
+      columns.add_browser_signals_indices(-1);
+      continue;
+    }
+    auto [it, inserted] = browser_signals_indices.try_emplace(
+        interest_group.browser_signals().SerializeAsString(),
+        columns.browser_signals_size());
+    if (inserted) {
+      *columns.add_browser_signals() =
+          std::move(*interest_group.mutable_browser_signals());
+    }
+    columns.add_browser_signals_indices(it->second);
+  }
+  raw_request.clear_interest_group_for_bidding();
+  return true;
+}
+
+absl::Status DecodeInterestGroupColumns(GenerateBidsRawRequest& raw_request) {
+  if (!raw_request.has_interest_group_columns()) {
+    return absl::OkStatus();
+  }
+  InterestGroupColumns& columns = *raw_request.mutable_interest_group_columns();
+  const int num_interest_groups = columns.names_size();
+  if (columns.user_bidding_signals_size() != num_interest_groups ||
+      columns.num_trusted_bidding_signals_keys_size() != num_interest_groups ||
+      columns.num_ad_render_ids_size() != num_interest_groups ||
+      columns.num_ad_component_render_ids_size() != num_interest_groups ||
+      columns.browser_signals_indices_size() != num_interest_groups) {
+    return absl::InvalidArgumentError(
+        "Interest group columns have different sizes");
+  }
+  StringReader reader(*columns.mutable_strings());
+  for (int i = 0; i < num_interest_groups; ++i) {
+    if (!reader.Use(columns.names(i)) ||
+        !reader.Use(columns.user_bidding_signals(i))) {
+      return absl::InvalidArgumentError(
+          "Interest group columns refer to missing strings");
+    }
+    const int32_t browser_signals_index = columns.browser_signals_indices(i);
+    if (browser_signals_index < -1 ||
+        browser_signals_index >= columns.browser_signals_size()) {
+      return absl::InvalidArgumentError(
+          "Interest group columns refer to missing browser signals");
+    }
+  }
+  if (!reader.UseList(columns.num_trusted_bidding_signals_keys(),
+                      columns.trusted_bidding_signals_keys()) ||
+      !reader.UseList(columns.num_ad_render_ids(), columns.ad_render_ids()) ||
+      !reader.UseList(columns.num_ad_component_render_ids(),
+                      columns.ad_component_render_ids())) {
+    return absl::InvalidArgumentError(
+        "Interest group columns have inconsistent lists");
+  }
+
+  auto& interest_groups = *raw_request.mutable_interest_group_for_bidding();
+  interest_groups.Reserve(interest_groups.size() + num_interest_groups);
+  int next_key = 0;
+  int next_ad_render_id = 0;
+  int next_ad_component_render_id = 0;
+  for (int i = 0; i < num_interest_groups; ++i) {
+    InterestGroupForBidding& interest_group = *interest_groups.Add();
+    interest_group.set_name(reader.Read(columns.names(i)));
+    interest_group.set_user_bidding_signals(
+        reader.Read(columns.user_bidding_signals(i)));
+    reader.ReadList(columns.num_trusted_bidding_signals_keys(i),
+                    columns.trusted_bidding_signals_keys(), next_key,
+                    *interest_group.mutable_trusted_bidding_signals_keys());
+    reader.ReadList(columns.num_ad_render_ids(i), columns.ad_render_ids(),
+                    next_ad_render_id, *interest_group.mutable_ad_render_ids());
+    reader.ReadList(columns.num_ad_component_render_ids(i),
+                    columns.ad_component_render_ids(),
+                    next_ad_component_render_id,
+                    *interest_group.mutable_ad_component_render_ids());
+    if (const int32_t index = columns.browser_signals_indices(i); index >= 0) {
+      *interest_group.mutable_browser_signals() =
+          columns.browser_signals(index);
+    }
+  }
+  raw_request.clear_interest_group_columns();
+  return absl::OkStatus();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,40 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_INTEREST_GROUP_COLUMNS_H_
+#define SERVICES_COMMON_UTIL_INTEREST_GROUP_COLUMNS_H_
+
+#include "absl/status/status.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Moves the interest groups of the request into its interest group columns,
+// which hold a single copy of the strings and browser signals repeated across
+// interest groups. Returns false, leaving the request as is, if it already
+// has columns or if an interest group has Android signals, which columns do
+// not hold.
+bool EncodeInterestGroupColumns(
+    GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+// Moves the interest groups of the columns of the request back into its
+// interest_group_for_bidding, in order. Does nothing if the request has no
+// columns. Fails if the columns are inconsistent, e.g. if an index is out of
+// range, in which case the request is left as is.
+absl::Status DecodeInterestGroupColumns(
+    GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_INTEREST_GROUP_COLUMNS_H_
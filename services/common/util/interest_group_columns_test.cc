@@ -0,0 +1,97 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/interest_group_columns.h"
+
+#include <string>
+
+#include "google/protobuf/util/message_differencer.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::protobuf::util::MessageDifferencer;
+using GenerateBidsRawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+
+GenerateBidsRawRequest MakeRequest() {
+  GenerateBidsRawRequest raw_request;
+  raw_request.set_seller("https://seller.com");
+  for (int i = 0; i < 3; ++i) {
+    auto* interest_group = raw_request.add_interest_group_for_bidding();
+    interest_group->set_name("ig-" + std::to_string(i));
+    interest_group->add_trusted_bidding_signals_keys("shared-key");
+    interest_group->add_trusted_bidding_signals_keys(
+        "key-" + std::to_string(i));
+    interest_group->add_ad_render_ids("shared-ad");
+    if (i != 1) {
+      interest_group->set_user_bidding_signals(R"({"segment":1})");
+      interest_group->mutable_browser_signals()->set_join_count(3);
+    }
+  }
+  raw_request.mutable_interest_group_for_bidding(2)
+      ->add_ad_component_render_ids("component");
+  return raw_request;
+}
+
+TEST(InterestGroupColumnsTest, RoundTripsInterestGroups) {
+  const GenerateBidsRawRequest original = MakeRequest();
+  GenerateBidsRawRequest raw_request = original;
+
+  ASSERT_TRUE(EncodeInterestGroupColumns(raw_request));
+  EXPECT_TRUE(raw_request.interest_group_for_bidding().empty());
+  ASSERT_TRUE(DecodeInterestGroupColumns(raw_request).ok());
+
+  std::string difference;
+  MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&difference);
+  EXPECT_TRUE(differencer.Compare(original, raw_request)) << difference;
+}
+
+TEST(InterestGroupColumnsTest, HoldsRepeatedValuesOnce) {
+  GenerateBidsRawRequest raw_request = MakeRequest();
+
+  ASSERT_TRUE(EncodeInterestGroupColumns(raw_request));
+  const auto& columns = raw_request.interest_group_columns();
+  // 3 names, 2 user bidding signals with the empty one, 4 keys, 1 ad and 1
+  // component.
+  EXPECT_EQ(columns.strings_size(), 11);
+  EXPECT_EQ(columns.browser_signals_size(), 1);
+  EXPECT_EQ(columns.browser_signals_indices(1), -1);
+  EXPECT_LT(raw_request.ByteSizeLong(), MakeRequest().ByteSizeLong());
+}
+
+TEST(InterestGroupColumnsTest, LeavesInterestGroupsWithAndroidSignals) {
+  GenerateBidsRawRequest raw_request = MakeRequest();
+  raw_request.add_interest_group_for_bidding()->mutable_android_signals();
+
+  EXPECT_FALSE(EncodeInterestGroupColumns(raw_request));
+  EXPECT_EQ(raw_request.interest_group_for_bidding_size(), 4);
+  EXPECT_FALSE(raw_request.has_interest_group_columns());
+}
+
+TEST(InterestGroupColumnsTest, RejectsInconsistentColumns) {
+  GenerateBidsRawRequest out_of_range = MakeRequest();
+  ASSERT_TRUE(EncodeInterestGroupColumns(out_of_range));
+  GenerateBidsRawRequest missing_list = out_of_range;
+  out_of_range.mutable_interest_group_columns()->set_names(0, 100);
+  missing_list.mutable_interest_group_columns()->set_num_ad_render_ids(0, 2);
+
+  EXPECT_FALSE(DecodeInterestGroupColumns(out_of_range).ok());
+  EXPECT_FALSE(DecodeInterestGroupColumns(missing_list).ok());
+  EXPECT_TRUE(out_of_range.interest_group_for_bidding().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,408 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_span_util.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/reader.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns the span of the value of a member that was consumed from
+// `stream` starting right after the closing quote of the member name.
+absl::string_view MemberValueSpan(const rapidjson::StringStream& stream,
+                                  size_t start) {
+  // The span still contains the name separator and surrounding whitespace.
+  absl::string_view raw(stream.head_ + start, stream.Tell() - start);
+  raw = absl::StripLeadingAsciiWhitespace(raw);
+  raw.remove_prefix(1);  // ':'
+  return absl::StripLeadingAsciiWhitespace(raw);
+}
+
+// SAX handler that records the raw byte span of the values of the requested
+// members of the requested top level properties. Everything else is only
+// validated.
+class MemberSpansHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          MemberSpansHandler> {
+ public:
+  MemberSpansHandler(const rapidjson::StringStream& stream,
+                     const JsonSpansByProperty& spans_by_property)
+      : stream_(stream), spans_by_property_(spans_by_property) {}
+
+  bool Default() { return ValueDone(); }
+  bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return ValueDone();
+  }
+  bool String(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return ValueDone();
+  }
+
+  bool StartObject() {
+    if (depth_ == kTopLevelDepth && pending_property_ != nullptr) {
+      current_property_ = pending_property_;
+      pending_property_ = nullptr;
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool Key(const Ch* str, rapidjson::SizeType length, bool copy) {
+    absl::string_view key(str, length);
+    if (depth_ == kTopLevelDepth) {
+      auto it = spans_by_property_.find(key);
+      if (it != spans_by_property_.end() && !it->second->found) {
+        it->second->found = true;
+        pending_property_ = it->second;
+      }
+    } else if (depth_ == kMemberDepth && current_property_ != nullptr) {
+      auto it = current_property_->members.find(key);
+      if (it != current_property_->members.end() &&
+          it->second.data() == nullptr) {
+        capture_ = &it->second;
+        capture_start_ = stream_.Tell();
+      }
+    }
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType member_count) {
+    --depth_;
+    if (depth_ == kTopLevelDepth) {
+      current_property_ = nullptr;
+    }
+    return ValueDone();
+  }
+
+  bool StartArray() {
+    if (depth_ == kTopLevelDepth) {
+      pending_property_ = nullptr;
+    }
+    ++depth_;
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType element_count) {
+    --depth_;
+    return ValueDone();
+  }
+
+ private:
+  // Depth after entering the top level object.
+  static constexpr int kTopLevelDepth = 1;
+  // Depth after entering the object of a top level property.
+  static constexpr int kMemberDepth = 2;
+
+  // Called whenever a complete value was consumed from the stream.
+  bool ValueDone() {
+    if (depth_ == kTopLevelDepth) {
+      pending_property_ = nullptr;
+    }
+    if (capture_ != nullptr && depth_ == kMemberDepth) {
+      *capture_ = MemberValueSpan(stream_, capture_start_);
+      capture_ = nullptr;
+    }
+    return true;
+  }
+
+  const rapidjson::StringStream& stream_;
+  const JsonSpansByProperty& spans_by_property_;
+  int depth_ = 0;
+  JsonObjectSpans* pending_property_ = nullptr;
+  JsonObjectSpans* current_property_ = nullptr;
+  absl::string_view* capture_ = nullptr;
+  size_t capture_start_ = 0;
+};
+
+// SAX handler that records the raw byte span of the values of the requested
+// top level properties. Everything else is only validated.
+class PropertySpansHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          PropertySpansHandler> {
+ public:
+  PropertySpansHandler(const rapidjson::StringStream& stream,
+                       JsonPropertySpans& property_spans)
+      : stream_(stream), property_spans_(property_spans) {}
+
+  bool Default() { return ValueDone(); }
+  bool RawNumber(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return ValueDone();
+  }
+  bool String(const Ch* str, rapidjson::SizeType length, bool copy) {
+    return ValueDone();
+  }
+
+  bool StartObject() {
+    ++depth_;
+    return true;
+  }
+
+  bool Key(const Ch* str, rapidjson::SizeType length, bool copy) {
+    if (depth_ == kTopLevelDepth) {
+      auto it = property_spans_.find(absl::string_view(str, length));
+      if (it != property_spans_.end() && it->second.data() == nullptr) {
+        capture_ = &it->second;
+        capture_start_ = stream_.Tell();
+      }
+    }
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType member_count) {
+    --depth_;
+    return ValueDone();
+  }
+
+  bool StartArray() {
+    ++depth_;
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType element_count) {
+    --depth_;
+    return ValueDone();
+  }
+
+ private:
+  // Depth after entering the top level object.
+  static constexpr int kTopLevelDepth = 1;
+
+  // Called whenever a complete value was consumed from the stream.
+  bool ValueDone() {
+    if (capture_ != nullptr && depth_ == kTopLevelDepth) {
+      *capture_ = MemberValueSpan(stream_, capture_start_);
+      capture_ = nullptr;
+    }
+    return true;
+  }
+
+  const rapidjson::StringStream& stream_;
+  JsonPropertySpans& property_spans_;
+  int depth_ = 0;
+  absl::string_view* capture_ = nullptr;
+  size_t capture_start_ = 0;
+};
+
+// Parses `stream` with `handler` and converts parse errors to a status.
+template <typename Handler>
+absl::Status ParseWithHandler(rapidjson::StringStream& stream,
+                              Handler& handler) {
+  rapidjson::Reader reader;
+  rapidjson::ParseResult parse_result =
+      reader.Parse<rapidjson::kParseNumbersAsStringsFlag>(stream, handler);
+  if (parse_result.IsError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("JSON Parse Error: ",
+                     rapidjson::GetParseError_En(parse_result.Code())));
+  }
+  return absl::OkStatus();
+}
+
+bool NeedsJsonEscape(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+// Returns whether one of the 8 bytes of `word` needs escaping, checking all of
+// them at once: the high bit of a byte of `x - 0x01` that was not set in `x`
+// is set only if the byte was zero, or below the subtracted value.
+bool WordNeedsJsonEscape(uint64_t word) {
+  constexpr uint64_t kOnes = 0x0101010101010101;
+  constexpr uint64_t kHighBits = 0x8080808080808080;
+  const uint64_t quotes = word ^ (kOnes * '"');
+  const uint64_t backslashes = word ^ (kOnes * '\\');
+  return (((word - kOnes * 0x20) & ~word) | ((quotes - kOnes) & ~quotes) |
+          ((backslashes - kOnes) & ~backslashes)) &
+         kHighBits;
+}
+
+// Returns the position of the first character of `str` from `pos` that needs
+// escaping, or the size of `str` if none does. The characters are scanned 8
+// at a time up to the word holding that character.
+size_t FindJsonEscape(absl::string_view str, size_t pos) {
+  for (; pos + sizeof(uint64_t) <= str.size(); pos += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, str.data() + pos, sizeof(word));
+    if (WordNeedsJsonEscape(word)) {
+      break;
+    }
+  }
+  for (; pos < str.size(); ++pos) {
+    if (NeedsJsonEscape(str[pos])) {
+      return pos;
+    }
+  }
+  return str.size();
+}
+
+}  // namespace
+
+absl::Status FindJsonMemberSpans(const std::string& json,
+                                 const JsonSpansByProperty& spans_by_property) {
+  rapidjson::StringStream stream(json.c_str());
+  MemberSpansHandler handler(stream, spans_by_property);
+  return ParseWithHandler(stream, handler);
+}
+
+absl::Status FindJsonPropertySpans(const std::string& json,
+                                   JsonPropertySpans& property_spans) {
+  rapidjson::StringStream stream(json.c_str());
+  PropertySpansHandler handler(stream, property_spans);
+  return ParseWithHandler(stream, handler);
+}
+
+size_t JsonStringSize(absl::string_view str) {
+  size_t size = str.size() + 2;
+  for (size_t pos = FindJsonEscape(str, 0); pos < str.size();
+       pos = FindJsonEscape(str, pos + 1)) {
+    switch (str[pos]) {
+      case '"':
+      case '\\':
+      case '\b':
+      case '\f':
+      case '\n':
+      case '\r':
+      case '\t':
+        size += 1;
+        break;
+      default:
+        // \u00XX
+        size += 5;
+    }
+  }
+  return size;
+}
+
+char* WriteJsonString(absl::string_view str, char* out) {
+  *out++ = '"';
+  size_t run_begin = 0;
+  for (size_t pos = FindJsonEscape(str, 0); pos < str.size();
+       pos = FindJsonEscape(str, pos + 1)) {
+    std::memcpy(out, str.data() + run_begin, pos - run_begin);
+    out += pos - run_begin;
+    run_begin = pos + 1;
+    const char c = str[pos];
+    *out++ = '\\';
+    switch (c) {
+      case '"':
+      case '\\':
+        *out++ = c;
+        break;
+      case '\b':
+        *out++ = 'b';
+        break;
+      case '\f':
+        *out++ = 'f';
+        break;
+      case '\n':
+        *out++ = 'n';
+        break;
+      case '\r':
+        *out++ = 'r';
+        break;
+      case '\t':
+        *out++ = 't';
+        break;
+      default: {
+        constexpr char kHex[] = "0123456789ABCDEF";
+        std::memcpy(out, "u00", 3);
+        out[3] = kHex[(c >> 4) & 0xF];
+        out[4] = kHex[c & 0xF];
+        out += 5;
+      }
+    }
+  }
+  std::memcpy(out, str.data() + run_begin, str.size() - run_begin);
+  out += str.size() - run_begin;
+  *out++ = '"';
+  return out;
+}
+
+void AppendJsonString(absl::string_view str, std::string& out) {
+  out.push_back('"');
+  // The runs of characters that need no escaping are appended at once.
+  size_t run_begin = 0;
+  for (size_t pos = FindJsonEscape(str, 0); pos < str.size();
+       pos = FindJsonEscape(str, pos + 1)) {
+    out.append(str.data() + run_begin, pos - run_begin);
+    run_begin = pos + 1;
+    const char c = str[pos];
+    switch (c) {
+      case '"':
+        out.append("\\\"");
+        break;
+      case '\\':
+        out.append("\\\\");
+        break;
+      case '\b':
+        out.append("\\b");
+        break;
+      case '\f':
+        out.append("\\f");
+        break;
+      case '\n':
+        out.append("\\n");
+        break;
+      case '\r':
+        out.append("\\r");
+        break;
+      case '\t':
+        out.append("\\t");
+        break;
+      default: {
+        constexpr char kHex[] = "0123456789ABCDEF";
+        out.append("\\u00");
+        out.push_back(kHex[(c >> 4) & 0xF]);
+        out.push_back(kHex[c & 0xF]);
+      }
+    }
+  }
+  out.append(str.data() + run_begin, str.size() - run_begin);
+  out.push_back('"');
+}
+
+void AppendMinifiedJson(absl::string_view json, std::string& out) {
+  bool in_string = false;
+  for (size_t i = 0; i < json.size(); ++i) {
+    const char c = json[i];
+    if (in_string) {
+      out.push_back(c);
+      if (c == '\\' && i + 1 < json.size()) {
+        out.push_back(json[++i]);
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+    switch (c) {
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        break;
+      case '"':
+        in_string = true;
+        [[fallthrough]];
+      default:
+        out.push_back(c);
+    }
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
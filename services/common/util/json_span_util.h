@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_JSON_SPAN_UTIL_H_
+#define SERVICES_COMMON_UTIL_JSON_SPAN_UTIL_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Raw spans of the members of a JSON object property.
+struct JsonObjectSpans {
+  // Set if the property is present, regardless of the type of its value.
+  bool found = false;
+  // Member name -> raw JSON of the member's value. Only the members that are
+  // already present in the map are looked up, their spans stay null if the
+  // member is absent.
+  absl::flat_hash_map<absl::string_view, absl::string_view> members;
+};
+
+// Top level property name -> spans of the members of the property.
+using JsonSpansByProperty =
+    absl::flat_hash_map<absl::string_view, JsonObjectSpans*>;
+
+// Scans `json` in a single SAX pass without building a DOM, and records
+// the raw byte spans (pointing into `json`) of the values of the requested
+// members of the requested top level object properties. Only the first
+// occurrence of a property or member is used, matching
+// rapidjson::Value::FindMember. Returns an error if `json` is malformed.
+absl::Status FindJsonMemberSpans(const std::string& json,
+                                 const JsonSpansByProperty& spans_by_property);
+
+// Top level property name -> raw JSON of the property's value. Only the
+// properties that are already present in the map are looked up, their spans
+// stay null if the property is absent.
+using JsonPropertySpans =
+    absl::flat_hash_map<absl::string_view, absl::string_view>;
+
+// Same as FindJsonMemberSpans but records the raw byte spans of the values of
+// the requested top level properties themselves.
+absl::Status FindJsonPropertySpans(const std::string& json,
+                                   JsonPropertySpans& property_spans);
+
+// Appends `str` to `out` as a quoted and escaped JSON string.
+void AppendJsonString(absl::string_view str, std::string& out);
+
+// Returns the bytes of `str` appended by AppendJsonString.
+size_t JsonStringSize(absl::string_view str);
+
+// Same as AppendJsonString but writes to `out`, which has room for
+// JsonStringSize(str) bytes. Returns the end of the string written.
+char* WriteJsonString(absl::string_view str, char* out);
+
+// Appends the valid JSON value `json` to `out` without the insignificant
+// whitespace, i.e. as rapidjson::Writer would have written it.
+void AppendMinifiedJson(absl::string_view json, std::string& out);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_JSON_SPAN_UTIL_H_
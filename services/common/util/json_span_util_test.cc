@@ -0,0 +1,130 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_span_util.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(FindJsonMemberSpansTest, RecordsRequestedMembersOfRequestedProperties) {
+  std::string json =
+      R"JSON({"a": {"x": 1, "y": {"z": [1, "2"]}, "w": null},
+              "b": {"x": "str"}, "c": {"x": true}})JSON";
+  JsonObjectSpans a;
+  a.members = {{"x", {}}, {"y", {}}, {"missing", {}}};
+  JsonObjectSpans b;
+  b.members = {{"x", {}}};
+
+  ASSERT_TRUE(FindJsonMemberSpans(json, {{"a", &a}, {"b", &b}}).ok());
+  EXPECT_TRUE(a.found);
+  EXPECT_EQ(a.members["x"], "1");
+  EXPECT_EQ(a.members["y"], R"JSON({"z": [1, "2"]})JSON");
+  EXPECT_EQ(a.members["missing"].data(), nullptr);
+  EXPECT_TRUE(b.found);
+  EXPECT_EQ(b.members["x"], R"JSON("str")JSON");
+}
+
+TEST(FindJsonMemberSpansTest, IgnoresNestedProperties) {
+  std::string json = R"JSON({"other": {"a": {"x": 1}}, "a": {"y": 2}})JSON";
+  JsonObjectSpans a;
+  a.members = {{"x", {}}};
+
+  ASSERT_TRUE(FindJsonMemberSpans(json, {{"a", &a}}).ok());
+  EXPECT_TRUE(a.found);
+  EXPECT_EQ(a.members["x"].data(), nullptr);
+}
+
+TEST(FindJsonMemberSpansTest, UsesFirstOccurrence) {
+  std::string json =
+      R"JSON({"a": {"x": 1, "x": 2}, "a": {"x": 3, "y": 4}})JSON";
+  JsonObjectSpans a;
+  a.members = {{"x", {}}, {"y", {}}};
+
+  ASSERT_TRUE(FindJsonMemberSpans(json, {{"a", &a}}).ok());
+  EXPECT_EQ(a.members["x"], "1");
+  EXPECT_EQ(a.members["y"].data(), nullptr);
+}
+
+TEST(FindJsonMemberSpansTest, MarksNonObjectPropertyAsFound) {
+  std::string json = R"JSON({"a": [{"x": 1}]})JSON";
+  JsonObjectSpans a;
+  a.members = {{"x", {}}};
+  JsonObjectSpans b;
+
+  ASSERT_TRUE(FindJsonMemberSpans(json, {{"a", &a}, {"b", &b}}).ok());
+  EXPECT_TRUE(a.found);
+  EXPECT_EQ(a.members["x"].data(), nullptr);
+  EXPECT_FALSE(b.found);
+}
+
+TEST(FindJsonMemberSpansTest, FailsOnMalformedJson) {
+  std::string json = R"JSON({"a": {"x": 1)JSON";
+  JsonObjectSpans a;
+  a.members = {{"x", {}}};
+
+  EXPECT_FALSE(FindJsonMemberSpans(json, {{"a", &a}}).ok());
+}
+
+TEST(FindJsonPropertySpansTest, RecordsFirstOccurrenceOfTopLevelProperties) {
+  std::string json =
+      R"JSON({"a": {"b": 1}, "nested": {"b": 2}, "b" : [true], "a": 3})JSON";
+  JsonPropertySpans spans = {{"a", {}}, {"b", {}}, {"missing", {}}};
+
+  ASSERT_TRUE(FindJsonPropertySpans(json, spans).ok());
+  EXPECT_EQ(spans["a"], R"JSON({"b": 1})JSON");
+  EXPECT_EQ(spans["b"], "[true]");
+  EXPECT_EQ(spans["missing"].data(), nullptr);
+}
+
+TEST(FindJsonPropertySpansTest, FailsOnMalformedJson) {
+  JsonPropertySpans spans = {{"a", {}}};
+
+  EXPECT_FALSE(FindJsonPropertySpans(R"JSON({"a": [1})JSON", spans).ok());
+}
+
+TEST(AppendJsonStringTest, EscapesSpecialCharacters) {
+  std::string out;
+  AppendJsonString("a\"b\\c\nd\x01", out);
+  EXPECT_EQ(out, R"JSON("a\"b\\c\nd\u0001")JSON");
+}
+
+TEST(AppendJsonStringTest, EscapesCharactersAtAnyPosition) {
+  // Longer than a word, with the escaped characters at word boundaries.
+  const std::string str = "0123456\"89abcde\\ghijklm\tnopqrs\x1f";
+  const std::string expected =
+      R"JSON("0123456\"89abcde\\ghijklm\tnopqrs\u001F")JSON";
+  std::string out;
+  AppendJsonString(str, out);
+  EXPECT_EQ(out, expected);
+  EXPECT_EQ(JsonStringSize(str), expected.size());
+  std::string written(expected.size(), ' ');
+  EXPECT_EQ(WriteJsonString(str, written.data()),
+            written.data() + written.size());
+  EXPECT_EQ(written, expected);
+}
+
+TEST(AppendMinifiedJsonTest, DropsWhitespaceOutsideStrings) {
+  std::string out;
+  AppendMinifiedJson(R"JSON({ "a b" : [ 1,
+      "c\" d" ] ,"e":"\\" })JSON",
+                     out);
+  EXPECT_EQ(out, R"JSON({"a b":[1,"c\" d"],"e":"\\"})JSON");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,329 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_stream_scanner.h"
+
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+bool IsWhitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+}  // namespace
+
+JsonPropertyStreamScanner::JsonPropertyStreamScanner(
+    std::vector<std::string> properties)
+    : properties_(std::make_move_iterator(properties.begin()),
+                  std::make_move_iterator(properties.end())) {}
+
+bool JsonPropertyStreamScanner::Consume(absl::string_view chunk) {
+  if (!error_.empty()) {
+    return false;
+  }
+  for (size_t i = 0; i < chunk.size(); ++i) {
+    // Fast path through the bytes of a string, which make most of a document.
+    if (token_ == Token::kString) {
+      size_t end = i;
+      while (end < chunk.size() && chunk[end] != '"' && chunk[end] != '\\' &&
+             static_cast<unsigned char>(chunk[end]) >= 0x20) {
+        ++end;
+      }
+      if (in_key_ && containers_.size() == 1) {
+        key_.append(chunk.data() + i, end - i);
+      }
+      i = end;
+      if (i == chunk.size()) {
+        break;
+      }
+    }
+    if (!Scan(chunk[i], offset_ + i)) {
+      return false;
+    }
+  }
+  offset_ += chunk.size();
+  return true;
+}
+
+absl::StatusOr<JsonPropertyOffsets> JsonPropertyStreamScanner::Finish() {
+  if (error_.empty() && token_ == Token::kNumber) {
+    if (IsNumberComplete()) {
+      token_ = Token::kNone;
+      EndValue(offset_);
+    } else {
+      Fail("Truncated number");
+    }
+  }
+  if (error_.empty() &&
+      (token_ != Token::kNone || expect_ != Expect::kEndOfDocument)) {
+    Fail("Truncated document");
+  }
+  if (!error_.empty()) {
+    return absl::InvalidArgumentError(error_);
+  }
+  if (escaped_key_) {
+    return absl::UnimplementedError("Top level property name with escapes");
+  }
+  return std::move(offsets_);
+}
+
+bool JsonPropertyStreamScanner::Scan(char c, size_t offset) {
+  switch (token_) {
+    case Token::kNone:
+      return ScanStructural(c, offset);
+    case Token::kString:
+      if (c == '"') {
+        token_ = Token::kNone;
+        if (in_key_) {
+          EndKey();
+        } else {
+          EndValue(offset + 1);
+        }
+      } else if (c == '\\') {
+        token_ = Token::kStringEscape;
+        if (in_key_ && containers_.size() == 1) {
+          escaped_key_ = true;
+        }
+      } else {
+        return Fail("Control character in string");
+      }
+      return true;
+    case Token::kStringEscape:
+      if (c == 'u') {
+        token_ = Token::kStringUnicode;
+        unicode_digits_ = 0;
+        return true;
+      }
+      if (c != '"' && c != '\\' && c != '/' && c != 'b' && c != 'f' &&
+          c != 'n' && c != 'r' && c != 't') {
+        return Fail("Invalid escape");
+      }
+      token_ = Token::kString;
+      return true;
+    case Token::kStringUnicode:
+      if (!absl::ascii_isxdigit(static_cast<unsigned char>(c))) {
+        return Fail("Invalid unicode escape");
+      }
+      if (++unicode_digits_ == 4) {
+        token_ = Token::kString;
+      }
+      return true;
+    case Token::kNumber:
+      if (ScanNumber(c)) {
+        return true;
+      }
+      if (!IsNumberComplete()) {
+        return Fail("Invalid number");
+      }
+      token_ = Token::kNone;
+      EndValue(offset);
+      return ScanStructural(c, offset);
+    case Token::kLiteral:
+      if (c != literal_[literal_pos_]) {
+        return Fail("Invalid literal");
+      }
+      if (++literal_pos_ == literal_.size()) {
+        token_ = Token::kNone;
+        EndValue(offset + 1);
+      }
+      return true;
+  }
+  return true;
+}
+
+bool JsonPropertyStreamScanner::ScanStructural(char c, size_t offset) {
+  if (IsWhitespace(c)) {
+    return true;
+  }
+  switch (expect_) {
+    case Expect::kValueOrArrayEnd:
+      if (c == ']') {
+        containers_.pop_back();
+        EndValue(offset + 1);
+        return true;
+      }
+      [[fallthrough]];
+    case Expect::kValue:
+      BeginValue(offset);
+      switch (c) {
+        case '{':
+          containers_.push_back(true);
+          expect_ = Expect::kKeyOrObjectEnd;
+          return true;
+        case '[':
+          containers_.push_back(false);
+          expect_ = Expect::kValueOrArrayEnd;
+          return true;
+        case '"':
+          token_ = Token::kString;
+          in_key_ = false;
+          return true;
+        case 't':
+          literal_ = "true";
+          break;
+        case 'f':
+          literal_ = "false";
+          break;
+        case 'n':
+          literal_ = "null";
+          break;
+        default:
+          if (c != '-' && !IsDigit(c)) {
+            return Fail(absl::StrCat("Unexpected character at ", offset));
+          }
+          token_ = Token::kNumber;
+          number_ = Number::kMinus;
+          ScanNumber(c);
+          return true;
+      }
+      token_ = Token::kLiteral;
+      literal_pos_ = 1;
+      return true;
+    case Expect::kKeyOrObjectEnd:
+      if (c == '}') {
+        containers_.pop_back();
+        EndValue(offset + 1);
+        return true;
+      }
+      [[fallthrough]];
+    case Expect::kKey:
+      if (c != '"') {
+        return Fail(absl::StrCat("Expected a property name at ", offset));
+      }
+      token_ = Token::kString;
+      in_key_ = true;
+      key_.clear();
+      return true;
+    case Expect::kColon:
+      if (c != ':') {
+        return Fail(absl::StrCat("Expected ':' at ", offset));
+      }
+      expect_ = Expect::kValue;
+      return true;
+    case Expect::kCommaOrEnd:
+      if (c == ',') {
+        expect_ = containers_.back() ? Expect::kKey : Expect::kValue;
+        return true;
+      }
+      if (c != (containers_.back() ? '}' : ']')) {
+        return Fail(absl::StrCat("Unexpected character at ", offset));
+      }
+      containers_.pop_back();
+      EndValue(offset + 1);
+      return true;
+    case Expect::kEndOfDocument:
+      return Fail(absl::StrCat("Trailing characters at ", offset));
+  }
+  return true;
+}
+
+bool JsonPropertyStreamScanner::ScanNumber(char c) {
+  switch (number_) {
+    case Number::kMinus:
+      if (c == '0') {
+        number_ = Number::kZero;
+      } else if (IsDigit(c)) {
+        number_ = Number::kInteger;
+      } else {
+        return false;
+      }
+      return true;
+    case Number::kZero:
+    case Number::kInteger:
+      if (IsDigit(c) && number_ == Number::kInteger) {
+        return true;
+      }
+      if (c == '.') {
+        number_ = Number::kFractionStart;
+      } else if (c == 'e' || c == 'E') {
+        number_ = Number::kExponentStart;
+      } else {
+        return false;
+      }
+      return true;
+    case Number::kFractionStart:
+    case Number::kFraction:
+      if (IsDigit(c)) {
+        number_ = Number::kFraction;
+        return true;
+      }
+      if (number_ == Number::kFraction && (c == 'e' || c == 'E')) {
+        number_ = Number::kExponentStart;
+        return true;
+      }
+      return false;
+    case Number::kExponentStart:
+      if (c == '+' || c == '-') {
+        number_ = Number::kExponentSign;
+        return true;
+      }
+      [[fallthrough]];
+    case Number::kExponentSign:
+    case Number::kExponent:
+      if (IsDigit(c)) {
+        number_ = Number::kExponent;
+        return true;
+      }
+      return false;
+  }
+  return false;
+}
+
+bool JsonPropertyStreamScanner::IsNumberComplete() const {
+  return number_ == Number::kZero || number_ == Number::kInteger ||
+         number_ == Number::kFraction || number_ == Number::kExponent;
+}
+
+void JsonPropertyStreamScanner::BeginValue(size_t offset) {
+  if (containers_.size() == 1 && containers_.front() && !key_.empty() &&
+      !offsets_.contains(key_) && properties_.contains(key_)) {
+    capture_ = key_;
+    capture_begin_ = offset;
+    capturing_ = true;
+  }
+}
+
+void JsonPropertyStreamScanner::EndValue(size_t end_offset) {
+  if (capturing_ && containers_.size() == 1) {
+    offsets_[capture_] = {.begin = capture_begin_, .end = end_offset};
+    capturing_ = false;
+  }
+  expect_ = containers_.empty() ? Expect::kEndOfDocument : Expect::kCommaOrEnd;
+}
+
+void JsonPropertyStreamScanner::EndKey() {
+  in_key_ = false;
+  if (containers_.size() != 1) {
+    // Only the names of top level properties are needed.
+    key_.clear();
+  }
+  expect_ = Expect::kColon;
+}
+
+bool JsonPropertyStreamScanner::Fail(absl::string_view error) {
+  if (error_.empty()) {
+    error_ = std::string(error);
+  }
+  return false;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,134 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_JSON_STREAM_SCANNER_H_
+#define SERVICES_COMMON_UTIL_JSON_STREAM_SCANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Byte offsets [begin, end) of a value within a JSON document.
+struct JsonValueOffsets {
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+// Top level property name -> offsets of the property's value.
+using JsonPropertyOffsets = absl::flat_hash_map<std::string, JsonValueOffsets>;
+
+// Validates a JSON document fed in chunks, e.g. as it streams in over the
+// network, and records the offsets of the values of the requested top level
+// properties, so that the document does not have to be scanned again once it
+// is complete. The offsets are those of the spans FindJsonPropertySpans
+// returns: only the first occurrence of a property is used.
+//
+//   JsonPropertyStreamScanner scanner({"renderUrls"});
+//   for (absl::string_view chunk : chunks) scanner.Consume(chunk);
+//   absl::StatusOr<JsonPropertyOffsets> offsets = scanner.Finish();
+class JsonPropertyStreamScanner {
+ public:
+  explicit JsonPropertyStreamScanner(std::vector<std::string> properties);
+
+  // Scans the next chunk of the document. Returns false once the document is
+  // known to be malformed, after which further chunks are ignored.
+  bool Consume(absl::string_view chunk);
+
+  // Returns the offsets of the properties found once the whole document was
+  // consumed. Fails if the document is malformed or truncated, or if a top
+  // level property name has escapes, which the scanner does not decode.
+  absl::StatusOr<JsonPropertyOffsets> Finish();
+
+ private:
+  enum class Expect : uint8_t {
+    kValue,
+    kValueOrArrayEnd,
+    kKeyOrObjectEnd,
+    kKey,
+    kColon,
+    kCommaOrEnd,
+    kEndOfDocument,
+  };
+  enum class Token : uint8_t {
+    kNone,
+    kString,
+    kStringEscape,
+    kStringUnicode,
+    kNumber,
+    kLiteral,
+  };
+  enum class Number : uint8_t {
+    kMinus,
+    kZero,
+    kInteger,
+    kFractionStart,
+    kFraction,
+    kExponentStart,
+    kExponentSign,
+    kExponent,
+  };
+
+  // Scans `c`, found at `offset` in the document.
+  bool Scan(char c, size_t offset);
+  // Scans `c` outside of any token.
+  bool ScanStructural(char c, size_t offset);
+  // Scans `c` within a number. Returns false if `c` is not part of it.
+  bool ScanNumber(char c);
+  bool IsNumberComplete() const;
+
+  void BeginValue(size_t offset);
+  // Called with the offset right past a complete value.
+  void EndValue(size_t end_offset);
+  void EndKey();
+
+  bool Fail(absl::string_view error);
+
+  const absl::flat_hash_set<std::string> properties_;
+  JsonPropertyOffsets offsets_;
+
+  // Offset of the next chunk in the document.
+  size_t offset_ = 0;
+  std::string error_;
+  // Set once a top level property name with escapes was seen.
+  bool escaped_key_ = false;
+
+  // Containers the scanner is in, true for objects.
+  std::vector<bool> containers_;
+  Expect expect_ = Expect::kValue;
+  Token token_ = Token::kNone;
+  Number number_ = Number::kMinus;
+  bool in_key_ = false;
+  int unicode_digits_ = 0;
+  absl::string_view literal_;
+  size_t literal_pos_ = 0;
+
+  // Name of the top level property being read, and of the property whose
+  // value is being recorded.
+  std::string key_;
+  std::string capture_;
+  size_t capture_begin_ = 0;
+  bool capturing_ = false;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_JSON_STREAM_SCANNER_H_
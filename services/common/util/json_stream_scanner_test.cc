@@ -0,0 +1,94 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_stream_scanner.h"
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kJson =
+    R"json({"renderUrls": {"https://ad.com?a=\"}\"": [1, -2.5e+3, true]},)json"
+    R"json( "other": {"renderUrls": null}, "adComponentRenderUrls": {},)json"
+    R"json( "renderUrls": "duplicate"})json";
+
+// Feeds `json` to a scanner in chunks of `chunk_size` bytes.
+absl::StatusOr<JsonPropertyOffsets> Scan(absl::string_view json,
+                                         size_t chunk_size) {
+  JsonPropertyStreamScanner scanner({"renderUrls", "adComponentRenderUrls"});
+  for (size_t i = 0; i < json.size(); i += chunk_size) {
+    scanner.Consume(json.substr(i, chunk_size));
+  }
+  return scanner.Finish();
+}
+
+absl::string_view Span(absl::string_view json, const JsonValueOffsets& span) {
+  return json.substr(span.begin, span.end - span.begin);
+}
+
+TEST(JsonPropertyStreamScannerTest, FindsFirstTopLevelPropertiesInAnyChunks) {
+  for (size_t chunk_size = 1; chunk_size <= kJson.size(); ++chunk_size) {
+    absl::StatusOr<JsonPropertyOffsets> offsets = Scan(kJson, chunk_size);
+    ASSERT_TRUE(offsets.ok()) << offsets.status();
+    ASSERT_EQ(offsets->size(), 2);
+    EXPECT_EQ(Span(kJson, offsets->at("renderUrls")),
+              R"json({"https://ad.com?a=\"}\"": [1, -2.5e+3, true]})json");
+    EXPECT_EQ(Span(kJson, offsets->at("adComponentRenderUrls")), "{}");
+  }
+}
+
+TEST(JsonPropertyStreamScannerTest, SpansScalarValues) {
+  constexpr absl::string_view kScalars =
+      R"json({"renderUrls":-0.5 ,"adComponentRenderUrls":false})json";
+  absl::StatusOr<JsonPropertyOffsets> offsets = Scan(kScalars, 3);
+  ASSERT_TRUE(offsets.ok()) << offsets.status();
+  EXPECT_EQ(Span(kScalars, offsets->at("renderUrls")), "-0.5");
+  EXPECT_EQ(Span(kScalars, offsets->at("adComponentRenderUrls")), "false");
+}
+
+TEST(JsonPropertyStreamScannerTest, SkipsMissingProperties) {
+  absl::StatusOr<JsonPropertyOffsets> offsets = Scan(R"({"a": [{}, []]})", 2);
+  ASSERT_TRUE(offsets.ok()) << offsets.status();
+  EXPECT_TRUE(offsets->empty());
+}
+
+TEST(JsonPropertyStreamScannerTest, RejectsMalformedDocuments) {
+  for (absl::string_view json :
+       {"", "{", R"({"a": 1,})", R"({"a" 1})", R"({"a": 01})", R"({"a": 1.})",
+        R"({"a": -})", R"({"a": tru})", R"({"a": "\x"})", R"({"a": "\u12"})",
+        R"({"a": [1}})", R"({"a": 1} {})", R"({"a": 1e})", "{\"a\": \"\n\"}"}) {
+    EXPECT_FALSE(Scan(json, 1).ok()) << json;
+    EXPECT_FALSE(Scan(json, 64).ok()) << json;
+  }
+}
+
+TEST(JsonPropertyStreamScannerTest, AcceptsNonObjectDocuments) {
+  EXPECT_TRUE(Scan(R"([1, {"renderUrls": 2}])", 4).ok());
+  absl::StatusOr<JsonPropertyOffsets> offsets = Scan(" 12 ", 1);
+  ASSERT_TRUE(offsets.ok()) << offsets.status();
+  EXPECT_TRUE(offsets->empty());
+}
+
+TEST(JsonPropertyStreamScannerTest, FailsOnEscapedTopLevelPropertyNames) {
+  EXPECT_FALSE(Scan(R"({"render\u0055rls": 1})", 4).ok());
+  EXPECT_TRUE(Scan(R"({"a": {"render\u0055rls": 1}})", 4).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
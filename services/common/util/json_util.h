@@ -23,9 +23,11 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "rapidjson/allocators.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "rapidjson/pointer.h"
+#include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -72,6 +74,61 @@ class SharedStringHolder {
   std::shared_ptr<std::string> shared_string_;
 };
 
+// Request-scoped memory for the rapidjson documents of a request. Documents
+// created from the arena share its MemoryPoolAllocator, which hands out memory
+// from a first chunk allocated with the arena and reused after Clear(), so the
+// JSON work of a request costs a handful of large allocations instead of a
+// pool per document. Documents must not outlive the arena, nor be used after
+// Clear(). Not thread-safe: threads parsing concurrently need their own arena.
+class JsonArena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit JsonArena(size_t chunk_size = kDefaultChunkSize)
+      : first_chunk_(new char[chunk_size]),
+        allocator_(first_chunk_.get(), chunk_size, chunk_size) {}
+
+  // Not copyable or movable, the documents point to the allocator.
+  JsonArena(const JsonArena&) = delete;
+  JsonArena& operator=(const JsonArena&) = delete;
+
+  // Returns an empty document allocating from the arena.
+  rapidjson::Document NewDocument() { return rapidjson::Document(&allocator_); }
+
+  rapidjson::MemoryPoolAllocator<>& allocator() { return allocator_; }
+
+  // Bytes used by the documents since the last Clear().
+  size_t Size() const { return allocator_.Size(); }
+
+  // Releases the memory of all the documents, keeping the first chunk for
+  // the next ones.
+  void Clear() { allocator_.Clear(); }
+
+ private:
+  std::unique_ptr<char[]> first_chunk_;
+  rapidjson::MemoryPoolAllocator<> allocator_;
+};
+
+// Scratch buffer reused by the serializations of a thread. Buffers grown past
+// kMaxScratchBufferSize are released after use, so a single large document
+// does not pin its memory for the lifetime of the thread.
+inline constexpr size_t kMaxScratchBufferSize = 1024 * 1024;
+
+inline rapidjson::StringBuffer& ScratchStringBuffer() {
+  thread_local rapidjson::StringBuffer buffer;
+  buffer.Clear();
+  return buffer;
+}
+
+inline std::string TakeScratchString(rapidjson::StringBuffer& buffer) {
+  std::string str(buffer.GetString(), buffer.GetSize());
+  if (buffer.GetSize() > kMaxScratchBufferSize) {
+    buffer.Clear();
+    buffer.ShrinkToFit();
+  }
+  return str;
+}
+
 // Parse string into a rapidjson::Document. Returns error status or document.
 inline absl::StatusOr<rapidjson::Document> ParseJsonString(
     absl::string_view str) {
@@ -87,6 +144,21 @@ inline absl::StatusOr<rapidjson::Document> ParseJsonString(
   return doc;
 }
 
+// Same as above, with the document allocated from `arena`; the document must
+// not outlive the arena.
+inline absl::StatusOr<rapidjson::Document> ParseJsonString(
+    absl::string_view str, JsonArena& arena) {
+  rapidjson::Document doc = arena.NewDocument();
+  rapidjson::ParseResult parse_result =
+      doc.Parse<rapidjson::kParseFullPrecisionFlag>(str.data(), str.size());
+  if (parse_result.IsError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("JSON Parse Error: ",
+                     rapidjson::GetParseError_En(parse_result.Code())));
+  }
+  return doc;
+}
+
 // Converts rapidjson::Document to a shared string. This provides a
 // shared string to prevent copying large string parameters required
 // by the ROMA engine interface. The reserve_string_len argument helps
@@ -101,24 +173,26 @@ inline absl::StatusOr<std::shared_ptr<std::string>> SerializeJsonDoc(
   return absl::InternalError("Unknown JSON to string serialization error");
 }
 
-// Converts rapidjson::Value& to a string
+// Converts rapidjson::Value& to a string, written in the scratch buffer of
+// the thread.
 inline absl::StatusOr<std::string> SerializeJsonDoc(
     const rapidjson::Value& document) {
-  rapidjson::StringBuffer string_buffer;
+  rapidjson::StringBuffer& string_buffer = ScratchStringBuffer();
   rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
   if (document.Accept(writer)) {
-    return std::string(string_buffer.GetString());
+    return TakeScratchString(string_buffer);
   }
   return absl::InternalError("Error converting inner Json to String.");
 }
 
-// Converts rapidjson::Document to a string.
+// Converts rapidjson::Document to a string, written in the scratch buffer of
+// the thread.
 inline absl::StatusOr<std::string> SerializeJsonDoc(
     const rapidjson::Document& document) {
-  rapidjson::StringBuffer string_buffer;
+  rapidjson::StringBuffer& string_buffer = ScratchStringBuffer();
   rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
   if (document.Accept(writer)) {
-    return std::string(string_buffer.GetString());
+    return TakeScratchString(string_buffer);
   }
   return absl::InternalError("Unknown JSON to string serialization error");
 }
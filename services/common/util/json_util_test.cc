@@ -38,6 +38,41 @@ TEST(ParseJsonString, ReturnsInvalidArgumentForInvalidJsonString) {
   EXPECT_EQ(output.status().code(), absl::StatusCode::kInvalidArgument);
 }
 
+TEST(ParseJsonString, ParsesDocumentsFromTheArena) {
+  JsonArena arena(/*chunk_size=*/1024);
+  absl::StatusOr<rapidjson::Document> first =
+      ParseJsonString(R"JSON({"key":"value"})JSON", arena);
+  ASSERT_TRUE(first.ok()) << first.status();
+  absl::StatusOr<rapidjson::Document> second =
+      ParseJsonString(R"JSON([1,2,3])JSON", arena);
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_EQ(&first->GetAllocator(), &arena.allocator());
+  EXPECT_EQ(&second->GetAllocator(), &arena.allocator());
+  EXPECT_STREQ((*first)["key"].GetString(), "value");
+  EXPECT_EQ(second->Size(), 3);
+  EXPECT_GT(arena.Size(), 0);
+
+  arena.Clear();
+  EXPECT_EQ(arena.Size(), 0);
+  EXPECT_FALSE(ParseJsonString("{", arena).ok());
+}
+
+TEST(SerializeJsonDoc, ReusesTheScratchBufferOfTheThread) {
+  rapidjson::Document large_document;
+  large_document.SetString(std::string(2 * kMaxScratchBufferSize, 'x').c_str(),
+                           large_document.GetAllocator());
+  absl::StatusOr<std::string> large_output = SerializeJsonDoc(large_document);
+  ASSERT_TRUE(large_output.ok()) << large_output.status();
+  EXPECT_EQ(large_output->size(), 2 * kMaxScratchBufferSize + 2);
+
+  rapidjson::Document document;
+  document.SetArray();
+  document.PushBack(1, document.GetAllocator());
+  absl::StatusOr<std::string> output = SerializeJsonDoc(document);
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output, "[1]");
+}
+
 TEST(SerializeJsonDoc, WorksForValidDocWithSize) {
   std::string key = MakeARandomString();
   std::string value = MakeARandomString();
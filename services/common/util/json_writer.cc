@@ -0,0 +1,49 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/json_writer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+size_t JsonIntSize(int64_t value) {
+  size_t size = 1;
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) {
+    size += 1;
+    magnitude = 0 - magnitude;
+  }
+  for (; magnitude >= 10; magnitude /= 10) {
+    ++size;
+  }
+  return size;
+}
+
+char* WriteJsonInt(int64_t value, char* out) {
+  char* const end = out + JsonIntSize(value);
+  uint64_t magnitude = static_cast<uint64_t>(value);
+  if (value < 0) {
+    *out = '-';
+    magnitude = 0 - magnitude;
+  }
+  char* digit = end;
+  do {
+    *--digit = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+  return end;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_JSON_WRITER_H_
+#define SERVICES_COMMON_UTIL_JSON_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "services/common/util/json_span_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Name of a field of a JSON object, declared as a constant, e.g.
+// `constexpr JsonKey kSeller("seller");`. Names are written as is and must not
+// need escaping.
+class JsonKey {
+ public:
+  constexpr explicit JsonKey(absl::string_view name) : name_(name) {}
+
+  constexpr absl::string_view name() const { return name_; }
+
+  // Bytes of `"name":`.
+  constexpr size_t size() const { return name_.size() + 3; }
+
+ private:
+  absl::string_view name_;
+};
+
+// Returns the bytes of `value` written in decimal.
+size_t JsonIntSize(int64_t value);
+
+// Writes `value` in decimal to `out`, which has room for JsonIntSize(value)
+// bytes. Returns the end of the number written.
+char* WriteJsonInt(int64_t value, char* out);
+
+// Writers of the fields of a JSON object. A function writing the fields is
+// run twice by WriteJsonObject, over a JsonObjectSizer to compute the exact
+// size of the object, then over a JsonObjectBufferWriter to write it into a
+// buffer of that size, so both writers have the same methods. Strings are
+// quoted and escaped as by AppendJsonString.
+
+// Computes the size of the object written by its fields.
+class JsonObjectSizer {
+ public:
+  void String(JsonKey key, absl::string_view value) {
+    Field(key, JsonStringSize(value));
+  }
+
+  // Adds a value that is already JSON.
+  void Raw(JsonKey key, absl::string_view json) { Field(key, json.size()); }
+
+  void Int(JsonKey key, int64_t value) { Field(key, JsonIntSize(value)); }
+
+  template <typename Strings>
+  void StringArray(JsonKey key, const Strings& values) {
+    size_t size = 2;
+    for (const auto& value : values) {
+      size += JsonStringSize(value) + 1;
+    }
+    Field(key, values.empty() ? size : size - 1);
+  }
+
+  // Bytes of the object, with its braces.
+  size_t size() const { return size_ + 2; }
+
+ private:
+  void Field(JsonKey key, size_t value_size) {
+    size_ += (size_ > 0 ? 1 : 0) + key.size() + value_size;
+  }
+
+  size_t size_ = 0;
+};
+
+// Writes the object into a buffer of the size computed by JsonObjectSizer for
+// the same fields, without checking for room.
+class JsonObjectBufferWriter {
+ public:
+  // Writes the opening brace of the object at `out`.
+  explicit JsonObjectBufferWriter(char* out) : out_(out) { *out_++ = '{'; }
+
+  void String(JsonKey key, absl::string_view value) {
+    Key(key);
+    out_ = WriteJsonString(value, out_);
+  }
+
+  void Raw(JsonKey key, absl::string_view json) {
+    Key(key);
+    Copy(json);
+  }
+
+  void Int(JsonKey key, int64_t value) {
+    Key(key);
+    out_ = WriteJsonInt(value, out_);
+  }
+
+  template <typename Strings>
+  void StringArray(JsonKey key, const Strings& values) {
+    Key(key);
+    *out_++ = '[';
+    bool first_value = true;
+    for (const auto& value : values) {
+      if (!first_value) {
+        *out_++ = ',';
+      }
+      first_value = false;
+      out_ = WriteJsonString(value, out_);
+    }
+    *out_++ = ']';
+  }
+
+  // Writes the closing brace of the object and returns its end.
+  char* Close() {
+    *out_++ = '}';
+    return out_;
+  }
+
+ private:
+  void Key(JsonKey key) {
+    if (!first_field_) {
+      *out_++ = ',';
+    }
+    first_field_ = false;
+    *out_++ = '"';
+    Copy(key.name());
+    *out_++ = '"';
+    *out_++ = ':';
+  }
+
+  void Copy(absl::string_view value) {
+    std::memcpy(out_, value.data(), value.size());
+    out_ += value.size();
+  }
+
+  char* out_;
+  bool first_field_ = true;
+};
+
+// Returns the JSON object whose fields are written by `write_fields`, a
+// callable taking either writer, e.g. a generic lambda:
+//   WriteJsonObject([&](auto& writer) { writer.String(kSeller, seller); });
+// The object is written into a single allocation of its exact size.
+template <typename WriteFields>
+std::string WriteJsonObject(const WriteFields& write_fields) {
+  JsonObjectSizer sizer;
+  write_fields(sizer);
+  std::string json(sizer.size(), '\0');
+  JsonObjectBufferWriter writer(json.data());
+  write_fields(writer);
+  writer.Close();
+  return json;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_JSON_WRITER_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/json_writer.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr JsonKey kName("name");
+constexpr JsonKey kCount("count");
+constexpr JsonKey kSignals("signals");
+constexpr JsonKey kUrls("urls");
+
+TEST(JsonWriterTest, WritesFieldsInOrder) {
+  const std::vector<std::string> urls = {"a.com", "b.com"};
+  auto write_fields = [&](auto& writer) {
+    writer.String(kName, "ig");
+    writer.Int(kCount, -12);
+    writer.Raw(kSignals, R"JSON({"a":[1]})JSON");
+    writer.StringArray(kUrls, urls);
+  };
+  std::string json = WriteJsonObject(write_fields);
+  EXPECT_EQ(json,
+            R"JSON({"name":"ig","count":-12,"signals":{"a":[1]},)JSON"
+            R"JSON("urls":["a.com","b.com"]})JSON");
+  JsonObjectSizer sizer;
+  write_fields(sizer);
+  EXPECT_EQ(sizer.size(), json.size());
+}
+
+TEST(JsonWriterTest, WritesEmptyValues) {
+  const std::vector<std::string> urls;
+  EXPECT_EQ(WriteJsonObject([](auto& writer) {}), "{}");
+  EXPECT_EQ(WriteJsonObject([&](auto& writer) {
+              writer.String(kName, "");
+              writer.StringArray(kUrls, urls);
+            }),
+            R"JSON({"name":"","urls":[]})JSON");
+}
+
+TEST(JsonWriterTest, EscapesStrings) {
+  const std::string value = "\"quoted\\\" \n\t\x01";
+  const std::string json = WriteJsonObject(
+      [&value](auto& writer) { writer.String(kName, value); });
+  EXPECT_EQ(json, R"JSON({"name":"\"quoted\\\" \n\t\u0001"})JSON");
+}
+
+TEST(JsonWriterTest, WritesInts) {
+  for (int64_t value : {int64_t{0}, int64_t{9}, int64_t{10}, int64_t{-1},
+                        int64_t{-10}, std::numeric_limits<int64_t>::max(),
+                        std::numeric_limits<int64_t>::min()}) {
+    std::string written(JsonIntSize(value), ' ');
+    EXPECT_EQ(WriteJsonInt(value, written.data()),
+              written.data() + written.size());
+    EXPECT_EQ(written, std::to_string(value));
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
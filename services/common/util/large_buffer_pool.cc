@@ -0,0 +1,201 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/large_buffer_pool.h"
+
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Acquisitions of all pools since the last GetStats call.
+std::atomic<int64_t> num_pooled_acquisitions = 0;
+std::atomic<int64_t> num_mapped_acquisitions = 0;
+// Bytes mapped by all pools, pooled or in use.
+std::atomic<int64_t> mapped_bytes = 0;
+
+size_t RoundUpToPowerOfTwo(size_t size) {
+  size_t rounded = kHugePageSize;
+  while (rounded < size) {
+    rounded *= 2;
+  }
+  return rounded;
+}
+
+void* MapAnonymous(size_t size, int extra_flags) {
+  void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+  return data == MAP_FAILED ? nullptr : data;
+}
+
+absl::StatusOr<char*> Map(size_t size, HugePages huge_pages) {
+  void* data = nullptr;
+  if (huge_pages == HugePages::kHugetlbfs) {
+    data = MapAnonymous(size, MAP_HUGETLB);
+  }
+  if (data == nullptr) {
+    data = MapAnonymous(size, 0);
+    if (data == nullptr) {
+      return absl::ResourceExhaustedError(
+          absl::StrCat("Could not map a buffer of ", size,
+                       " bytes: ", std::strerror(errno)));
+    }
+    // Sizes are multiples of the huge page size, but the mapping may not be
+    // aligned on one, in which case only its aligned part gets huge pages.
+    if (huge_pages != HugePages::kNone &&
+        madvise(data, size, MADV_HUGEPAGE) != 0) {
+      ABSL_LOG_FIRST_N(WARNING, 1)
+          << "Could not back buffers with transparent huge pages: "
+          << std::strerror(errno);
+    }
+  }
+  mapped_bytes.fetch_add(size, std::memory_order_relaxed);
+  return static_cast<char*>(data);
+}
+
+void Unmap(char* data, size_t size) {
+  munmap(data, size);
+  mapped_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+absl::StatusOr<HugePages> ParseHugePages(absl::string_view huge_pages) {
+  if (huge_pages.empty() || huge_pages == "none") {
+    return HugePages::kNone;
+  }
+  if (huge_pages == "thp") {
+    return HugePages::kTransparent;
+  }
+  if (huge_pages == "hugetlbfs") {
+    return HugePages::kHugetlbfs;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown huge pages: ", huge_pages));
+}
+
+LargeBuffer::~LargeBuffer() {
+  if (pool_ != nullptr) {
+    pool_->Release(data_, size_);
+  }
+}
+
+LargeBuffer::LargeBuffer(LargeBuffer&& other)
+    : pool_(std::exchange(other.pool_, nullptr)),
+      data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+LargeBuffer& LargeBuffer::operator=(LargeBuffer&& other) {
+  if (this != &other) {
+    if (pool_ != nullptr) {
+      pool_->Release(data_, size_);
+    }
+    pool_ = std::exchange(other.pool_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+LargeBufferPool::LargeBufferPool(LargeBufferPoolOptions options)
+    : options_(std::move(options)) {}
+
+LargeBufferPool::~LargeBufferPool() {
+  absl::MutexLock lock(&mu_);
+  for (auto& [size, buffers] : free_buffers_) {
+    for (char* data : buffers) {
+      Unmap(data, size);
+    }
+  }
+}
+
+LargeBufferPool& LargeBufferPool::Get() {
+  static auto* const pool = new LargeBufferPool();
+  return *pool;
+}
+
+void LargeBufferPool::Configure(LargeBufferPoolOptions options) {
+  LargeBufferPool& pool = Get();
+  absl::MutexLock lock(&pool.mu_);
+  pool.options_ = std::move(options);
+}
+
+absl::StatusOr<LargeBuffer> LargeBufferPool::Acquire(size_t min_size) {
+  const size_t size = RoundUpToPowerOfTwo(min_size);
+  HugePages huge_pages;
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = free_buffers_.find(size);
+        it != free_buffers_.end() && !it->second.empty()) {
+      char* data = it->second.back();
+      it->second.pop_back();
+      pooled_bytes_ -= size;
+      num_pooled_acquisitions.fetch_add(1, std::memory_order_relaxed);
+      return LargeBuffer(this, data, size);
+    }
+    huge_pages = options_.huge_pages;
+  }
+  absl::StatusOr<char*> data = Map(size, huge_pages);
+  if (!data.ok()) {
+    return data.status();
+  }
+  num_mapped_acquisitions.fetch_add(1, std::memory_order_relaxed);
+  return LargeBuffer(this, *data, size);
+}
+
+void LargeBufferPool::Release(char* data, size_t size) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (pooled_bytes_ + size <= options_.max_pooled_bytes) {
+      free_buffers_[size].push_back(data);
+      pooled_bytes_ += size;
+      return;
+    }
+  }
+  Unmap(data, size);
+}
+
+bool LargeBufferPool::enabled() const {
+  absl::MutexLock lock(&mu_);
+  return options_.max_pooled_bytes > 0;
+}
+
+size_t LargeBufferPool::pooled_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return pooled_bytes_;
+}
+
+absl::flat_hash_map<std::string, double> LargeBufferPool::GetStats() {
+  absl::flat_hash_map<std::string, double> stats = {
+      {"mapped_bytes", mapped_bytes.load(std::memory_order_relaxed)}};
+  const double pooled =
+      num_pooled_acquisitions.exchange(0, std::memory_order_relaxed);
+  const double mapped =
+      num_mapped_acquisitions.exchange(0, std::memory_order_relaxed);
+  if (pooled + mapped > 0) {
+    stats["pool_hit_ratio"] = pooled / (pooled + mapped);
+  }
+  return stats;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,134 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_LARGE_BUFFER_POOL_H_
+#define SERVICES_COMMON_UTIL_LARGE_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Size of the huge pages backing the buffers, and of the smallest buffer.
+inline constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+enum class HugePages {
+  // Regular pages.
+  kNone,
+  // Transparent huge pages, requested with madvise, for hosts whose THP mode
+  // is "madvise".
+  kTransparent,
+  // Huge pages reserved in hugetlbfs, mapped with MAP_HUGETLB. Buffers fall
+  // back to transparent huge pages once the reserved pages run out.
+  kHugetlbfs,
+};
+
+// Parses "", "none", "thp" or "hugetlbfs".
+absl::StatusOr<HugePages> ParseHugePages(absl::string_view huge_pages);
+
+struct LargeBufferPoolOptions {
+  HugePages huge_pages = HugePages::kNone;
+  // Bytes of the released buffers kept for reuse, beyond which they are
+  // unmapped. The pool is disabled if 0, for callers to use the heap.
+  size_t max_pooled_bytes = 0;
+};
+
+class LargeBufferPool;
+
+// A buffer of at least kHugePageSize bytes, mapped outside of the heap and
+// returned to its pool on destruction.
+class LargeBuffer {
+ public:
+  LargeBuffer() = default;
+  ~LargeBuffer();
+
+  LargeBuffer(LargeBuffer&& other);
+  LargeBuffer& operator=(LargeBuffer&& other);
+
+  char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  friend class LargeBufferPool;
+
+  LargeBuffer(LargeBufferPool* pool, char* data, size_t size)
+      : pool_(pool), data_(data), size_(size) {}
+
+  LargeBufferPool* pool_ = nullptr;
+  char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Pool of buffers for the payloads of tens of MB going through the server,
+// e.g. while decompressing, so that they neither churn through the heap nor
+// fault their pages in again on every request. The buffers are backed by huge
+// pages if configured, for fewer TLB misses while the payloads are scanned.
+// Buffers are sized in powers of two, and a released buffer is kept for the
+// next acquisition of its size.
+class LargeBufferPool {
+ public:
+  explicit LargeBufferPool(LargeBufferPoolOptions options = {});
+  ~LargeBufferPool();
+
+  // LargeBufferPool is neither copyable nor movable.
+  LargeBufferPool(const LargeBufferPool&) = delete;
+  LargeBufferPool& operator=(const LargeBufferPool&) = delete;
+
+  // Pool of the server, configured by Configure.
+  static LargeBufferPool& Get();
+
+  // Configures the pool of the server. Called once on startup, before any
+  // buffer is acquired.
+  static void Configure(LargeBufferPoolOptions options);
+
+  // Returns a buffer of at least `min_size` bytes. Fails if the memory could
+  // not be mapped.
+  absl::StatusOr<LargeBuffer> Acquire(size_t min_size)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Whether callers should acquire their large buffers from the pool.
+  bool enabled() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Bytes of the released buffers kept for reuse.
+  size_t pooled_bytes() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Observable callback exporting the share of the acquisitions of all pools
+  // since the last call served with a pooled buffer, and the bytes currently
+  // mapped by all pools.
+  static absl::flat_hash_map<std::string, double> GetStats();
+
+ private:
+  friend class LargeBuffer;
+
+  void Release(char* data, size_t size) ABSL_LOCKS_EXCLUDED(mu_);
+
+  mutable absl::Mutex mu_;
+  LargeBufferPoolOptions options_ ABSL_GUARDED_BY(mu_);
+  // Released buffers, by size.
+  absl::flat_hash_map<size_t, std::vector<char*>> free_buffers_
+      ABSL_GUARDED_BY(mu_);
+  size_t pooled_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_LARGE_BUFFER_POOL_H_
@@ -0,0 +1,118 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/large_buffer_pool.h"
+
+#include <cstring>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ParseHugePagesTest, ParsesKnownValues) {
+  EXPECT_EQ(*ParseHugePages(""), HugePages::kNone);
+  EXPECT_EQ(*ParseHugePages("none"), HugePages::kNone);
+  EXPECT_EQ(*ParseHugePages("thp"), HugePages::kTransparent);
+  EXPECT_EQ(*ParseHugePages("hugetlbfs"), HugePages::kHugetlbfs);
+  EXPECT_FALSE(ParseHugePages("1g").ok());
+}
+
+TEST(LargeBufferPoolTest, RoundsSizesUpToPowersOfTwo) {
+  LargeBufferPool pool;
+  absl::StatusOr<LargeBuffer> small = pool.Acquire(1);
+  ASSERT_TRUE(small.ok()) << small.status();
+  EXPECT_EQ(small->size(), kHugePageSize);
+
+  absl::StatusOr<LargeBuffer> large = pool.Acquire(3 * kHugePageSize);
+  ASSERT_TRUE(large.ok()) << large.status();
+  EXPECT_EQ(large->size(), 4 * kHugePageSize);
+  // Writable throughout.
+  std::memset(large->data(), 1, large->size());
+}
+
+TEST(LargeBufferPoolTest, ReusesReleasedBuffers) {
+  LargeBufferPool pool({.max_pooled_bytes = 4 * kHugePageSize});
+  char* data;
+  {
+    absl::StatusOr<LargeBuffer> buffer = pool.Acquire(kHugePageSize);
+    ASSERT_TRUE(buffer.ok()) << buffer.status();
+    data = buffer->data();
+  }
+  EXPECT_EQ(pool.pooled_bytes(), kHugePageSize);
+
+  absl::StatusOr<LargeBuffer> buffer = pool.Acquire(kHugePageSize);
+  ASSERT_TRUE(buffer.ok()) << buffer.status();
+  EXPECT_EQ(buffer->data(), data);
+  EXPECT_EQ(pool.pooled_bytes(), 0);
+}
+
+TEST(LargeBufferPoolTest, UnmapsBuffersBeyondTheCap) {
+  LargeBufferPool pool({.max_pooled_bytes = 3 * kHugePageSize});
+  {
+    absl::StatusOr<LargeBuffer> first = pool.Acquire(kHugePageSize);
+    absl::StatusOr<LargeBuffer> second = pool.Acquire(2 * kHugePageSize);
+    absl::StatusOr<LargeBuffer> third = pool.Acquire(kHugePageSize);
+    ASSERT_TRUE(first.ok() && second.ok() && third.ok());
+  }
+  EXPECT_EQ(pool.pooled_bytes(), 3 * kHugePageSize);
+}
+
+TEST(LargeBufferPoolTest, DisabledPoolKeepsNoBuffers) {
+  LargeBufferPool pool;
+  EXPECT_FALSE(pool.enabled());
+  {
+    absl::StatusOr<LargeBuffer> buffer = pool.Acquire(kHugePageSize);
+    ASSERT_TRUE(buffer.ok()) << buffer.status();
+  }
+  EXPECT_EQ(pool.pooled_bytes(), 0);
+}
+
+TEST(LargeBufferPoolTest, MovesBuffers) {
+  LargeBufferPool pool({.max_pooled_bytes = 4 * kHugePageSize});
+  absl::StatusOr<LargeBuffer> buffer = pool.Acquire(kHugePageSize);
+  ASSERT_TRUE(buffer.ok()) << buffer.status();
+  char* data = buffer->data();
+
+  LargeBuffer moved = *std::move(buffer);
+  EXPECT_EQ(moved.data(), data);
+  EXPECT_EQ(buffer->data(), nullptr);
+  EXPECT_EQ(pool.pooled_bytes(), 0);
+
+  moved = LargeBuffer();
+  EXPECT_EQ(pool.pooled_bytes(), kHugePageSize);
+}
+
+TEST(LargeBufferPoolTest, BacksBuffersWithHugePagesIfAvailable) {
+  // Falls back to regular pages on hosts without huge pages.
+  LargeBufferPool pool({.huge_pages = HugePages::kHugetlbfs});
+  absl::StatusOr<LargeBuffer> buffer = pool.Acquire(kHugePageSize);
+  ASSERT_TRUE(buffer.ok()) << buffer.status();
+  std::memset(buffer->data(), 1, buffer->size());
+}
+
+TEST(LargeBufferPoolTest, ReportsStats) {
+  LargeBufferPool::GetStats();
+  LargeBufferPool pool({.max_pooled_bytes = kHugePageSize});
+  // Released right away, then reused.
+  ASSERT_TRUE(pool.Acquire(kHugePageSize).ok());
+  ASSERT_TRUE(pool.Acquire(kHugePageSize).ok());
+  auto stats = LargeBufferPool::GetStats();
+  EXPECT_EQ(stats["pool_hit_ratio"], 0.5);
+  EXPECT_EQ(stats["mapped_bytes"], kHugePageSize);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,55 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/log_throttle.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int64_t> total_suppressed = 0;
+
+}  // namespace
+
+bool LogThrottle::ShouldLog(int64_t now_ns) {
+  bool log = count_.fetch_add(1, std::memory_order_relaxed) % every_n_ == 0;
+  if (log && min_interval_ns_ > 0) {
+    int64_t next_log_ns = next_log_ns_.load(std::memory_order_relaxed);
+    // Of concurrent messages past the interval, only one gets logged.
+    log = now_ns >= next_log_ns &&
+          next_log_ns_.compare_exchange_strong(next_log_ns,
+                                               now_ns + min_interval_ns_,
+                                               std::memory_order_relaxed);
+  }
+  if (!log) {
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    total_suppressed.fetch_add(1, std::memory_order_relaxed);
+  }
+  return log;
+}
+
+std::string LogThrottle::TakeSuppressedNote() {
+  const int64_t suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+  if (suppressed == 0) {
+    return "";
+  }
+  return absl::StrCat("(", suppressed, " similar messages suppressed) ");
+}
+
+int64_t LogThrottle::TotalSuppressed() {
+  return total_suppressed.load(std::memory_order_relaxed);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,93 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_LOG_THROTTLE_H_
+#define SERVICES_COMMON_UTIL_LOG_THROTTLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/logger/request_context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Decides which messages of a logging call site are logged, for the sites on
+// hot paths that may log for every item of every request, e.g. for each
+// invalid output of a broken ad tech script. Thread-safe and lock-free.
+//
+// A message is logged if it is one of every `every_n` messages of the site
+// and at least `min_interval` passed since the last message logged. The
+// others are counted as suppressed, and the count is reported with the next
+// message logged.
+class LogThrottle {
+ public:
+  LogThrottle(int64_t every_n, absl::Duration min_interval)
+      : every_n_(every_n > 1 ? every_n : 1),
+        min_interval_ns_(absl::ToInt64Nanoseconds(min_interval)) {}
+
+  LogThrottle(const LogThrottle&) = delete;
+  LogThrottle& operator=(const LogThrottle&) = delete;
+
+  bool ShouldLog() { return ShouldLog(absl::GetCurrentTimeNanos()); }
+  bool ShouldLog(int64_t now_ns);
+
+  // Returns a note of the messages suppressed since the last one logged, if
+  // any, to prefix the next message logged with, and resets their count.
+  std::string TakeSuppressedNote();
+
+  // Messages suppressed by all the throttles of the process.
+  static int64_t TotalSuppressed();
+
+ private:
+  const int64_t every_n_;
+  const int64_t min_interval_ns_;
+  std::atomic<int64_t> count_ = 0;
+  std::atomic<int64_t> next_log_ns_ = 0;
+  std::atomic<int64_t> suppressed_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+// PS_LOG for hot paths, throttled per call site. The arguments after the
+// throttling ones are those of PS_LOG, e.g.
+//   PS_LOG_EVERY_N_SEC(10, WARNING, log_context_) << "Bad response";
+// logs one message of the call site every 10 seconds at most.
+#define PS_LOG_EVERY_N(n, ...) \
+  PS_LOG_THROTTLED_IMPL_((n), ::absl::ZeroDuration(), __VA_ARGS__)
+#define PS_LOG_EVERY_N_SEC(seconds, ...) \
+  PS_LOG_THROTTLED_IMPL_(1, ::absl::Seconds(seconds), __VA_ARGS__)
+
+// The throttle of the call site is a static of a lambda unique to it. The
+// switch keeps the else from binding to an if around the macro.
+#define PS_LOG_THROTTLED_IMPL_(every_n, min_interval, ...)                  \
+  switch (0)                                                                \
+  case 0:                                                                   \
+  default:                                                                  \
+    if (::privacy_sandbox::bidding_auction_servers::LogThrottle&            \
+            ps_log_throttle =                                               \
+                []() -> ::privacy_sandbox::bidding_auction_servers::        \
+                         LogThrottle& {                                     \
+                           static ::privacy_sandbox::                       \
+                               bidding_auction_servers::LogThrottle         \
+                                   throttle((every_n), (min_interval));     \
+                           return throttle;                                 \
+                         }();                                               \
+        !ps_log_throttle.ShouldLog()) {                                     \
+    } else                                                                  \
+      PS_LOG(__VA_ARGS__) << ps_log_throttle.TakeSuppressedNote()
+
+#endif  // SERVICES_COMMON_UTIL_LOG_THROTTLE_H_
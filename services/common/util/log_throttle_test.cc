@@ -0,0 +1,68 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/log_throttle.h"
+
+#include <vector>
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int64_t kSecondNs = 1'000'000'000;
+
+TEST(LogThrottleTest, LogsEveryNthMessage) {
+  LogThrottle throttle(3, absl::ZeroDuration());
+  std::vector<bool> logged;
+  for (int i = 0; i < 7; ++i) {
+    logged.push_back(throttle.ShouldLog(0));
+  }
+  EXPECT_EQ(logged, (std::vector<bool>{true, false, false, true, false, false,
+                                       true}));
+}
+
+TEST(LogThrottleTest, LogsOneMessagePerInterval) {
+  LogThrottle throttle(1, absl::Seconds(1));
+  EXPECT_TRUE(throttle.ShouldLog(10 * kSecondNs));
+  EXPECT_FALSE(throttle.ShouldLog(10 * kSecondNs));
+  EXPECT_FALSE(throttle.ShouldLog(11 * kSecondNs - 1));
+  EXPECT_TRUE(throttle.ShouldLog(11 * kSecondNs));
+}
+
+TEST(LogThrottleTest, CountsSuppressedMessages) {
+  const int64_t total_suppressed = LogThrottle::TotalSuppressed();
+  LogThrottle throttle(2, absl::ZeroDuration());
+  EXPECT_TRUE(throttle.ShouldLog(0));
+  EXPECT_EQ(throttle.TakeSuppressedNote(), "");
+  for (int i = 0; i < 3; ++i) {
+    throttle.ShouldLog(0);
+  }
+  EXPECT_EQ(throttle.TakeSuppressedNote(), "(2 similar messages suppressed) ");
+  EXPECT_EQ(throttle.TakeSuppressedNote(), "");
+  EXPECT_EQ(LogThrottle::TotalSuppressed() - total_suppressed, 2);
+}
+
+TEST(LogThrottleTest, ThrottlesEachCallSite) {
+  const int64_t total_suppressed = LogThrottle::TotalSuppressed();
+  for (int i = 0; i < 10; ++i) {
+    PS_LOG_EVERY_N(5, INFO) << "first";
+    PS_LOG_EVERY_N(2, INFO) << "second";
+  }
+  EXPECT_EQ(LogThrottle::TotalSuppressed() - total_suppressed, 8 + 5);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,101 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/memory_admission_controller.h"
+
+#include <optional>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "tcmalloc/malloc_extension.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+MemoryReservation::MemoryReservation(MemoryReservation&& other)
+    : controller_(std::exchange(other.controller_, nullptr)),
+      bytes_(std::exchange(other.bytes_, 0)) {}
+
+MemoryReservation& MemoryReservation::operator=(MemoryReservation&& other) {
+  if (this != &other) {
+    if (controller_ != nullptr) {
+      controller_->Release(bytes_);
+    }
+    controller_ = std::exchange(other.controller_, nullptr);
+    bytes_ = std::exchange(other.bytes_, 0);
+  }
+  return *this;
+}
+
+MemoryReservation::~MemoryReservation() {
+  if (controller_ != nullptr) {
+    controller_->Release(bytes_);
+  }
+}
+
+MemoryAdmissionController& MemoryAdmissionController::Get() {
+  static MemoryAdmissionController* controller = new MemoryAdmissionController;
+  return *controller;
+}
+
+MemoryAdmissionController::MemoryAdmissionController(
+    HeapSizeGetter heap_size_getter, absl::Duration heap_refresh_interval)
+    : heap_size_getter_(std::move(heap_size_getter)),
+      heap_refresh_interval_(heap_refresh_interval) {}
+
+void MemoryAdmissionController::Configure(const MemoryAdmissionConfig& config) {
+  absl::MutexLock lock(&mu_);
+  config_ = config;
+}
+
+absl::StatusOr<MemoryReservation> MemoryAdmissionController::Admit(
+    int64_t request_size) {
+  absl::MutexLock lock(&mu_);
+  if (config_.heap_limit_bytes <= 0) {
+    return MemoryReservation();
+  }
+  const absl::Time now = absl::Now();
+  if (now - heap_read_time_ >= heap_refresh_interval_) {
+    heap_bytes_ = heap_size_getter_();
+    heap_read_time_ = now;
+  }
+  const int64_t request_bytes = request_size * config_.request_size_factor;
+  if (heap_bytes_ + reserved_bytes_ + request_bytes >
+      config_.heap_limit_bytes) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Not enough memory left for a request of ", request_size,
+        " bytes: ", heap_bytes_, " bytes are allocated and ", reserved_bytes_,
+        " are reserved, out of ", config_.heap_limit_bytes));
+  }
+  reserved_bytes_ += request_bytes;
+  return MemoryReservation(this, request_bytes);
+}
+
+int64_t MemoryAdmissionController::reserved_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return reserved_bytes_;
+}
+
+int64_t MemoryAdmissionController::GetAllocatedHeapBytes() {
+  std::optional<size_t> bytes = tcmalloc::MallocExtension::GetNumericProperty(
+      "generic.current_allocated_bytes");
+  return bytes.has_value() ? static_cast<int64_t>(*bytes) : 0;
+}
+
+void MemoryAdmissionController::Release(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  reserved_bytes_ -= bytes;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,121 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_MEMORY_ADMISSION_CONTROLLER_H_
+#define SERVICES_COMMON_UTIL_MEMORY_ADMISSION_CONTROLLER_H_
+
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+class MemoryAdmissionController;
+
+// Memory set aside for an admitted request, given back when destroyed.
+class MemoryReservation {
+ public:
+  MemoryReservation() = default;
+  MemoryReservation(MemoryReservation&& other);
+  MemoryReservation& operator=(MemoryReservation&& other);
+  ~MemoryReservation();
+
+  // MemoryReservation is movable but not copyable.
+  MemoryReservation(const MemoryReservation&) = delete;
+  MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  friend class MemoryAdmissionController;
+
+  MemoryReservation(MemoryAdmissionController* controller, int64_t bytes)
+      : controller_(controller), bytes_(bytes) {}
+
+  MemoryAdmissionController* controller_ = nullptr;
+  int64_t bytes_ = 0;
+};
+
+struct MemoryAdmissionConfig {
+  // Heap size above which requests are rejected, in bytes. Every request is
+  // admitted if 0.
+  int64_t heap_limit_bytes = 0;
+  // Memory a request is expected to take, once decrypted, decompressed and
+  // parsed, as a multiple of its size on the wire.
+  int request_size_factor = 10;
+};
+
+// Rejects requests which would take the heap past its limit, before they
+// are decrypted, so that a few huge requests landing together are shed
+// instead of running the server out of memory. Thread-safe.
+//
+// A request is admitted if the heap, the memory reserved for the requests in
+// flight and its own estimated memory fit within the limit. Memory the
+// requests in flight have already allocated is counted twice, in the heap
+// and in their reservations, which errs on the side of shedding.
+class MemoryAdmissionController {
+ public:
+  using HeapSizeGetter = absl::AnyInvocable<int64_t()>;
+
+  // Controller used by the services, admitting every request until it is
+  // configured.
+  static MemoryAdmissionController& Get();
+
+  // heap_size_getter: returns the bytes currently allocated on the heap,
+  // read from tcmalloc by default. Called at most every
+  // `heap_refresh_interval`, since reading it takes allocator locks.
+  explicit MemoryAdmissionController(
+      HeapSizeGetter heap_size_getter = GetAllocatedHeapBytes,
+      absl::Duration heap_refresh_interval = absl::Milliseconds(10));
+
+  MemoryAdmissionController(const MemoryAdmissionController&) = delete;
+  MemoryAdmissionController& operator=(const MemoryAdmissionController&) =
+      delete;
+
+  void Configure(const MemoryAdmissionConfig& config) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Reserves the estimated memory of a request of `request_size` bytes, to
+  // be held until the request is done. Fails with ResourceExhausted if the
+  // heap has not enough headroom left for the request.
+  absl::StatusOr<MemoryReservation> Admit(int64_t request_size)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Bytes reserved for the requests in flight.
+  int64_t reserved_bytes() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Bytes allocated on the heap, as reported by tcmalloc.
+  static int64_t GetAllocatedHeapBytes();
+
+ private:
+  friend class MemoryReservation;
+
+  void Release(int64_t bytes) ABSL_LOCKS_EXCLUDED(mu_);
+
+  HeapSizeGetter heap_size_getter_;
+  const absl::Duration heap_refresh_interval_;
+
+  mutable absl::Mutex mu_;
+  MemoryAdmissionConfig config_ ABSL_GUARDED_BY(mu_);
+  int64_t reserved_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t heap_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::Time heap_read_time_ ABSL_GUARDED_BY(mu_) = absl::InfinitePast();
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_MEMORY_ADMISSION_CONTROLLER_H_
@@ -0,0 +1,86 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/memory_admission_controller.h"
+
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr MemoryAdmissionConfig kConfig = {.heap_limit_bytes = 1000,
+                                           .request_size_factor = 10};
+
+TEST(MemoryAdmissionControllerTest, AdmitsEveryRequestUntilConfigured) {
+  MemoryAdmissionController controller([]() { return 5000; });
+
+  absl::StatusOr<MemoryReservation> reservation = controller.Admit(100);
+
+  ASSERT_TRUE(reservation.ok()) << reservation.status();
+  EXPECT_EQ(controller.reserved_bytes(), 0);
+}
+
+TEST(MemoryAdmissionControllerTest, ReservesUntilReservationIsDestroyed) {
+  MemoryAdmissionController controller([]() { return 200; });
+  controller.Configure(kConfig);
+
+  {
+    absl::StatusOr<MemoryReservation> reservation = controller.Admit(50);
+    ASSERT_TRUE(reservation.ok()) << reservation.status();
+    EXPECT_EQ(reservation->bytes(), 500);
+    EXPECT_EQ(controller.reserved_bytes(), 500);
+
+    MemoryReservation moved = *std::move(reservation);
+    EXPECT_EQ(controller.reserved_bytes(), 500);
+  }
+  EXPECT_EQ(controller.reserved_bytes(), 0);
+}
+
+TEST(MemoryAdmissionControllerTest, RejectsRequestsPastHeapLimit) {
+  MemoryAdmissionController controller([]() { return 200; });
+  controller.Configure(kConfig);
+
+  absl::StatusOr<MemoryReservation> first = controller.Admit(50);
+  ASSERT_TRUE(first.ok()) << first.status();
+  // 200 allocated + 500 reserved + 400 estimated > 1000.
+  absl::StatusOr<MemoryReservation> second = controller.Admit(40);
+  EXPECT_EQ(second.status().code(), absl::StatusCode::kResourceExhausted);
+  // Fits once the first request is done.
+  *first = MemoryReservation();
+  EXPECT_TRUE(controller.Admit(40).ok());
+}
+
+TEST(MemoryAdmissionControllerTest, ReusesHeapSizeWithinRefreshInterval) {
+  int64_t heap_bytes = 0;
+  int num_reads = 0;
+  MemoryAdmissionController controller(
+      [&]() {
+        ++num_reads;
+        return heap_bytes;
+      },
+      absl::InfiniteDuration());
+  controller.Configure(kConfig);
+
+  EXPECT_TRUE(controller.Admit(10).ok());
+  heap_bytes = 2000;
+  EXPECT_TRUE(controller.Admit(10).ok());
+  EXPECT_EQ(num_reads, 1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
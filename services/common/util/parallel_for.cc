@@ -0,0 +1,90 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/parallel_for.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Shared by the calling thread and the tasks. Tasks may only run after the
+// loop is done, so they own it too.
+struct LoopState {
+  explicit LoopState(int n, absl::FunctionRef<void(int)> fn) : n(n), fn(fn) {}
+
+  absl::Mutex mu;
+  const int n;
+  int next ABSL_GUARDED_BY(mu) = 0;
+  // Number of calls to fn in progress.
+  int in_progress ABSL_GUARDED_BY(mu) = 0;
+  // Only called while the loop is not done, i.e. while the caller is still in
+  // ParallelFor.
+  absl::FunctionRef<void(int)> fn;
+};
+
+// Makes calls to fn until none are left.
+void RunCalls(LoopState& state) {
+  while (true) {
+    int i;
+    {
+      absl::MutexLock lock(&state.mu);
+      if (state.next >= state.n) {
+        return;
+      }
+      i = state.next++;
+      ++state.in_progress;
+    }
+    state.fn(i);
+    absl::MutexLock lock(&state.mu);
+    --state.in_progress;
+  }
+}
+
+}  // namespace
+
+void ParallelFor(server_common::Executor* executor, int n,
+                 absl::FunctionRef<void(int)> fn) {
+  if (n <= 0) {
+    return;
+  }
+  auto state = std::make_shared<LoopState>(n, fn);
+  if (executor != nullptr) {
+    for (int i = 1; i < n; ++i) {
+      executor->Run([state]() { RunCalls(*state); });
+    }
+  }
+  RunCalls(*state);
+  absl::MutexLock lock(&state->mu);
+  state->mu.Await(absl::Condition(
+      +[](int* in_progress) { return *in_progress == 0; },
+      &state->in_progress));
+}
+
+void ParallelForChunks(server_common::Executor* executor, int n,
+                       int chunk_size, absl::FunctionRef<void(int, int)> fn) {
+  if (chunk_size <= 0) {
+    chunk_size = n;
+  }
+  const int num_chunks = n <= 0 ? 0 : (n + chunk_size - 1) / chunk_size;
+  ParallelFor(executor, num_chunks, [n, chunk_size, fn](int chunk) {
+    const int begin = chunk * chunk_size;
+    fn(begin, std::min(n, begin + chunk_size));
+  });
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
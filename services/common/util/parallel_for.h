@@ -0,0 +1,40 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_PARALLEL_FOR_H_
+#define SERVICES_COMMON_UTIL_PARALLEL_FOR_H_
+
+#include "absl/functional/function_ref.h"
+#include "src/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Calls fn(i) for every i in [0, n) and returns once all the calls are done.
+// The calls are spread over up to n - 1 tasks on the executor and the calling
+// thread. The calling thread keeps taking calls until none are left, so the
+// loop completes even if no executor thread is free, or if executor is null.
+void ParallelFor(server_common::Executor* executor, int n,
+                 absl::FunctionRef<void(int)> fn);
+
+// Calls fn(begin, end) for consecutive chunks [begin, end) of up to
+// chunk_size indices covering [0, n), spread over the executor as above. A
+// range of at most chunk_size indices runs on the calling thread alone.
+void ParallelForChunks(server_common::Executor* executor, int n,
+                       int chunk_size, absl::FunctionRef<void(int, int)> fn);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_PARALLEL_FOR_H_
@@ -0,0 +1,106 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/parallel_for.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Each;
+
+constexpr int kNumCalls = 8;
+
+TEST(ParallelForTest, CallsEachIndexOnceWithoutExecutor) {
+  std::vector<int> num_calls(kNumCalls, 0);
+  ParallelFor(nullptr, kNumCalls, [&num_calls](int i) { ++num_calls[i]; });
+  EXPECT_THAT(num_calls, Each(1));
+}
+
+TEST(ParallelForTest, CompletesWhenExecutorTasksDoNotRun) {
+  MockExecutor executor;
+  std::vector<absl::AnyInvocable<void()>> tasks;
+  EXPECT_CALL(executor, Run)
+      .Times(kNumCalls - 1)
+      .WillRepeatedly([&tasks](absl::AnyInvocable<void()> closure) {
+        tasks.push_back(std::move(closure));
+      });
+
+  std::vector<int> num_calls(kNumCalls, 0);
+  ParallelFor(&executor, kNumCalls, [&num_calls](int i) { ++num_calls[i]; });
+  EXPECT_THAT(num_calls, Each(1));
+
+  // Tasks running after the loop is done have nothing left to do.
+  for (auto& task : tasks) {
+    std::move(task)();
+  }
+  EXPECT_THAT(num_calls, Each(1));
+}
+
+TEST(ParallelForTest, CallsEachIndexOnceOnExecutorThreads) {
+  MockExecutor executor;
+  std::vector<std::thread> threads;
+  EXPECT_CALL(executor, Run)
+      .WillRepeatedly([&threads](absl::AnyInvocable<void()> closure) {
+        threads.emplace_back(std::move(closure));
+      });
+
+  std::vector<std::atomic<int>> num_calls(kNumCalls);
+  ParallelFor(&executor, kNumCalls, [&num_calls](int i) { ++num_calls[i]; });
+  for (const auto& count : num_calls) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(ParallelForTest, CoversTheRangeInChunks) {
+  MockExecutor executor;
+  std::vector<std::thread> threads;
+  EXPECT_CALL(executor, Run)
+      .Times(2)
+      .WillRepeatedly([&threads](absl::AnyInvocable<void()> closure) {
+        threads.emplace_back(std::move(closure));
+      });
+
+  std::vector<std::atomic<int>> num_calls(kNumCalls + 1);
+  std::atomic<int> num_chunks = 0;
+  ParallelForChunks(&executor, kNumCalls + 1, /*chunk_size=*/4,
+                    [&num_calls, &num_chunks](int begin, int end) {
+                      EXPECT_LE(end - begin, 4);
+                      ++num_chunks;
+                      for (int i = begin; i < end; ++i) {
+                        ++num_calls[i];
+                      }
+                    });
+  EXPECT_EQ(num_chunks.load(), 3);
+  for (const auto& count : num_calls) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
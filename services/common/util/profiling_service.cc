@@ -0,0 +1,246 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/profiling_service.h"
+
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <utility>
+
+#include "absl/debugging/stacktrace.h"
+#include "absl/status/statusor.h"
+#include "services/common/util/file_util.h"
+#include "src/logger/request_context_logger.h"
+#include "tcmalloc/malloc_extension.h"
+#include "tcmalloc/profile_marshaler.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kMaxStackDepth = 64;
+// Bounds the samples of a round, e.g. 10 seconds at 10 samples per second
+// on 40 busy cores.
+constexpr int kMaxCpuSamples = 4096;
+
+struct CpuSample {
+  // Set by the signal handler once the stack is written.
+  std::atomic<bool> ready = false;
+  int depth = 0;
+  void* stack[kMaxStackDepth];
+};
+
+// Written by the SIGPROF handler, which must not allocate or lock.
+CpuSample cpu_sample_buffer[kMaxCpuSamples];
+std::atomic<int> num_cpu_samples = 0;
+std::atomic<bool> cpu_sampling = false;
+
+void OnSigprof(int) {
+  if (!cpu_sampling.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const int index = num_cpu_samples.fetch_add(1, std::memory_order_relaxed);
+  if (index >= kMaxCpuSamples) {
+    return;
+  }
+  CpuSample& sample = cpu_sample_buffer[index];
+  // Skips the frame of the handler.
+  sample.depth = absl::GetStackTrace(sample.stack, kMaxStackDepth,
+                                     /*skip_count=*/1);
+  sample.ready.store(true, std::memory_order_release);
+}
+
+bool SetCpuTimer(absl::Duration period) {
+  itimerval timer = {};
+  timer.it_interval = absl::ToTimeval(period);
+  timer.it_value = timer.it_interval;
+  return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+bool StartCpuSampling(absl::Duration period) {
+  for (CpuSample& sample : cpu_sample_buffer) {
+    sample.ready.store(false, std::memory_order_relaxed);
+  }
+  num_cpu_samples.store(0, std::memory_order_relaxed);
+  struct sigaction action = {};
+  action.sa_handler = OnSigprof;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    return false;
+  }
+  cpu_sampling.store(true, std::memory_order_relaxed);
+  return SetCpuTimer(period);
+}
+
+// Returns the number of samples by call stack.
+absl::flat_hash_map<std::vector<uintptr_t>, int64_t> StopCpuSampling() {
+  SetCpuTimer(absl::ZeroDuration());
+  cpu_sampling.store(false, std::memory_order_relaxed);
+  absl::flat_hash_map<std::vector<uintptr_t>, int64_t> samples;
+  const int num_samples = std::min(
+      num_cpu_samples.load(std::memory_order_relaxed), kMaxCpuSamples);
+  for (int i = 0; i < num_samples; ++i) {
+    // Handlers still running on other threads are skipped.
+    const CpuSample& sample = cpu_sample_buffer[i];
+    if (!sample.ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    std::vector<uintptr_t> stack(sample.depth);
+    for (int j = 0; j < sample.depth; ++j) {
+      stack[j] = reinterpret_cast<uintptr_t>(sample.stack[j]);
+    }
+    ++samples[std::move(stack)];
+  }
+  return samples;
+}
+
+void AppendWord(uintptr_t word, std::string& out) {
+  out.append(reinterpret_cast<const char*>(&word), sizeof(word));
+}
+
+std::optional<std::string> MarshalProfile(tcmalloc::Profile profile) {
+  absl::StatusOr<std::string> marshaled = tcmalloc::Marshal(profile);
+  if (!marshaled.ok()) {
+    PS_LOG(ERROR) << "Failed to marshal the profile: " << marshaled.status();
+    return std::nullopt;
+  }
+  return *std::move(marshaled);
+}
+
+}  // namespace
+
+absl::string_view GetProfileTypeName(ProfileType type) {
+  switch (type) {
+    case ProfileType::kHeap:
+      return "heap";
+    case ProfileType::kAllocations:
+      return "allocations";
+    case ProfileType::kCpu:
+      return "cpu";
+  }
+  return "unknown";
+}
+
+std::string SerializeCpuProfile(
+    const absl::flat_hash_map<std::vector<uintptr_t>, int64_t>& samples,
+    absl::Duration sampling_period, absl::string_view memory_mappings) {
+  std::string profile;
+  // Header: header words, version, sampling period and padding.
+  AppendWord(0, profile);
+  AppendWord(3, profile);
+  AppendWord(0, profile);
+  AppendWord(absl::ToInt64Microseconds(sampling_period), profile);
+  AppendWord(0, profile);
+  for (const auto& [stack, count] : samples) {
+    AppendWord(count, profile);
+    AppendWord(stack.size(), profile);
+    for (uintptr_t pc : stack) {
+      AppendWord(pc, profile);
+    }
+  }
+  // Trailer, as a record of a single empty stack.
+  AppendWord(0, profile);
+  AppendWord(1, profile);
+  AppendWord(0, profile);
+  profile.append(memory_mappings.data(), memory_mappings.size());
+  return profile;
+}
+
+ProfilingService::ProfilingService(ProfilingOptions options,
+                                   ProfileExporter exporter)
+    : options_(std::move(options)),
+      exporter_(std::move(exporter)),
+      worker_([this]() { Run(); }) {}
+
+ProfilingService::~ProfilingService() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  worker_.join();
+}
+
+bool ProfilingService::Wait(absl::Duration duration) {
+  absl::MutexLock lock(&mu_);
+  mu_.AwaitWithTimeout(absl::Condition(&stopping_), duration);
+  return !stopping_;
+}
+
+void ProfilingService::Run() {
+  while (Wait(options_.interval - options_.sampling_duration)) {
+    RunRound();
+  }
+}
+
+void ProfilingService::RunRound() {
+  if (options_.heap) {
+    if (std::optional<std::string> profile =
+            MarshalProfile(tcmalloc::MallocExtension::SnapshotCurrent(
+                tcmalloc::ProfileType::kHeap))) {
+      exporter_(ProfileType::kHeap, *std::move(profile));
+    }
+  }
+
+  std::optional<tcmalloc::MallocExtension::AllocationProfilingToken>
+      allocations;
+  if (options_.allocations) {
+    allocations = tcmalloc::MallocExtension::StartAllocationProfiling();
+  }
+  const absl::Duration cpu_sampling_period =
+      absl::Seconds(1) / std::max(options_.cpu_samples_per_second, 1);
+  bool sampling_cpu = false;
+  if (options_.cpu) {
+    sampling_cpu = StartCpuSampling(cpu_sampling_period);
+    if (!sampling_cpu) {
+      PS_LOG(ERROR) << "Failed to start sampling CPU";
+    }
+  }
+  const bool completed = Wait(options_.sampling_duration);
+
+  std::optional<tcmalloc::Profile> allocation_profile;
+  if (allocations.has_value()) {
+    allocation_profile = std::move(*allocations).Stop();
+  }
+  absl::flat_hash_map<std::vector<uintptr_t>, int64_t> cpu_samples;
+  if (sampling_cpu) {
+    cpu_samples = StopCpuSampling();
+  }
+  if (!completed) {
+    return;
+  }
+  if (allocation_profile.has_value()) {
+    if (std::optional<std::string> profile =
+            MarshalProfile(*std::move(allocation_profile))) {
+      exporter_(ProfileType::kAllocations, *std::move(profile));
+    }
+  }
+  if (sampling_cpu) {
+    absl::StatusOr<std::string> memory_mappings =
+        GetFileContent("/proc/self/maps");
+    if (!memory_mappings.ok()) {
+      PS_LOG(ERROR) << "Failed to read the memory mappings: "
+                    << memory_mappings.status();
+      return;
+    }
+    exporter_(ProfileType::kCpu,
+              SerializeCpuProfile(cpu_samples, cpu_sampling_period,
+                                  *memory_mappings));
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,102 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_PROFILING_SERVICE_H_
+#define SERVICES_COMMON_UTIL_PROFILING_SERVICE_H_
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+enum class ProfileType {
+  // Live heap sampled by tcmalloc at the start of a round.
+  kHeap,
+  // Allocations sampled by tcmalloc during a round.
+  kAllocations,
+  // CPU samples taken during a round.
+  kCpu,
+};
+
+// Returns the name of the profile type, e.g. "heap".
+absl::string_view GetProfileTypeName(ProfileType type);
+
+// Called with each profile taken, serialized in a format read by pprof.
+using ProfileExporter =
+    absl::AnyInvocable<void(ProfileType type, std::string profile)>;
+
+struct ProfilingOptions {
+  // Time between the starts of two profiling rounds.
+  absl::Duration interval = absl::Minutes(10);
+  // Time during which allocations and CPU are sampled in a round.
+  absl::Duration sampling_duration = absl::Seconds(10);
+  // Frequency of the CPU samples, kept low to bound the overhead.
+  int cpu_samples_per_second = 10;
+  bool heap = true;
+  bool allocations = true;
+  bool cpu = true;
+};
+
+// Periodically profiles the process from a background thread and hands the
+// profiles to an exporter. Heap and allocation profiles are taken from
+// tcmalloc and marshaled as gzipped pprof protos. CPU samples are taken on
+// SIGPROF, and serialized in the legacy CPU profile format read by pprof.
+//
+// Only one instance may sample CPU at a time, since SIGPROF is process-wide.
+class ProfilingService {
+ public:
+  ProfilingService(ProfilingOptions options, ProfileExporter exporter);
+
+  // Stops profiling, dropping the profiles of the round in progress.
+  ~ProfilingService();
+
+  // ProfilingService is neither copyable nor movable.
+  ProfilingService(const ProfilingService&) = delete;
+  ProfilingService& operator=(const ProfilingService&) = delete;
+
+ private:
+  // Runs profiling rounds until the service is destroyed.
+  void Run() ABSL_LOCKS_EXCLUDED(mu_);
+  // Waits for `duration` and returns false if the service is stopping.
+  bool Wait(absl::Duration duration) ABSL_LOCKS_EXCLUDED(mu_);
+  void RunRound() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const ProfilingOptions options_;
+  ProfileExporter exporter_;
+
+  absl::Mutex mu_;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread worker_;
+};
+
+// Serializes CPU samples, given as counts by call stack, in the legacy CPU
+// profile format read by pprof, followed by the memory mappings of the
+// process to symbolize the addresses.
+std::string SerializeCpuProfile(
+    const absl::flat_hash_map<std::vector<uintptr_t>, int64_t>& samples,
+    absl::Duration sampling_period, absl::string_view memory_mappings);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_PROFILING_SERVICE_H_
@@ -0,0 +1,91 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/profiling_service.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::EndsWith;
+using ::testing::UnorderedElementsAre;
+
+std::vector<uintptr_t> ToWords(absl::string_view profile, int num_words) {
+  std::vector<uintptr_t> words(num_words);
+  std::memcpy(words.data(), profile.data(), num_words * sizeof(uintptr_t));
+  return words;
+}
+
+TEST(SerializeCpuProfileTest, WritesLegacyCpuProfile) {
+  const std::string profile = SerializeCpuProfile(
+      {{{0x10, 0x20}, 3}}, absl::Milliseconds(100), "mappings");
+
+  EXPECT_THAT(ToWords(profile, 12),
+              ElementsAre(0, 3, 0, 100'000, 0, 3, 2, 0x10, 0x20, 0, 1, 0));
+  EXPECT_EQ(profile.size(), 12 * sizeof(uintptr_t) + strlen("mappings"));
+  EXPECT_THAT(profile, EndsWith("mappings"));
+}
+
+TEST(ProfilingServiceTest, ExportsProfilesOfEachRound) {
+  absl::Mutex mu;
+  std::vector<ProfileType> types;
+  absl::Notification round_done;
+  ProfilingService service(
+      {.interval = absl::Milliseconds(50),
+       .sampling_duration = absl::Milliseconds(20)},
+      [&](ProfileType type, std::string profile) {
+        absl::MutexLock lock(&mu);
+        types.push_back(type);
+        if (types.size() == 3) {
+          round_done.Notify();
+        }
+      });
+
+  ASSERT_TRUE(round_done.WaitForNotificationWithTimeout(absl::Seconds(10)));
+  absl::MutexLock lock(&mu);
+  EXPECT_THAT(std::vector<ProfileType>(types.begin(), types.begin() + 3),
+              UnorderedElementsAre(ProfileType::kHeap,
+                                   ProfileType::kAllocations,
+                                   ProfileType::kCpu));
+}
+
+TEST(ProfilingServiceTest, ExportsOnlyEnabledProfiles) {
+  absl::Notification exported;
+  ProfilingService service(
+      {.interval = absl::Milliseconds(50),
+       .sampling_duration = absl::Milliseconds(20),
+       .heap = false,
+       .allocations = false},
+      [&](ProfileType type, std::string profile) {
+        EXPECT_EQ(type, ProfileType::kCpu);
+        if (!exported.HasBeenNotified()) {
+          exported.Notify();
+        }
+      });
+
+  EXPECT_TRUE(exported.WaitForNotificationWithTimeout(absl::Seconds(10)));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,229 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/raw_ciphertext_call.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <grpcpp/support/slice.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kRequestCiphertextField = 1;
+constexpr int kKeyIdField = 2;
+constexpr int kResponseCiphertextField = 1;
+
+constexpr int kVarintWireType = 0;
+constexpr int kFixed64WireType = 1;
+constexpr int kLengthDelimitedWireType = 2;
+constexpr int kFixed32WireType = 5;
+
+// Longest varint, of a 64-bit value.
+constexpr int kMaxVarintSize = 10;
+
+absl::Status MalformedRequestError(absl::string_view reason) {
+  return absl::InvalidArgumentError(
+      absl::StrCat("Malformed ciphertext request: ", reason));
+}
+
+// Reads the wire format of a message across the chunks it is split into.
+class ChunkReader {
+ public:
+  explicit ChunkReader(absl::Span<const absl::string_view> chunks)
+      : chunks_(chunks) {
+    for (absl::string_view chunk : chunks_) {
+      remaining_ += chunk.size();
+    }
+    SkipEmptyChunks();
+  }
+
+  bool AtEnd() const { return chunk_ == chunks_.size(); }
+
+  bool ReadVarint(uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < kMaxVarintSize && !AtEnd(); ++i) {
+      const auto byte = static_cast<uint8_t>(chunks_[chunk_][offset_]);
+      Advance(1);
+      value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Appends the next `size` bytes to `out`, or skips them if `out` is null.
+  bool Read(uint64_t size, std::string* out) {
+    if (size > remaining_) {
+      return false;
+    }
+    if (out != nullptr) {
+      out->reserve(out->size() + size);
+    }
+    while (size > 0) {
+      const absl::string_view chunk = chunks_[chunk_].substr(offset_, size);
+      if (out != nullptr) {
+        out->append(chunk.data(), chunk.size());
+      }
+      size -= chunk.size();
+      Advance(chunk.size());
+    }
+    return true;
+  }
+
+ private:
+  void Advance(size_t size) {
+    remaining_ -= size;
+    offset_ += size;
+    if (offset_ == chunks_[chunk_].size()) {
+      ++chunk_;
+      offset_ = 0;
+      SkipEmptyChunks();
+    }
+  }
+
+  void SkipEmptyChunks() {
+    while (chunk_ < chunks_.size() && chunks_[chunk_].empty()) {
+      ++chunk_;
+    }
+  }
+
+  const absl::Span<const absl::string_view> chunks_;
+  size_t chunk_ = 0;
+  size_t offset_ = 0;
+  // Bytes left to read, so that a corrupt length does not get reserved.
+  uint64_t remaining_ = 0;
+};
+
+// Writes the tag and the length of a length-delimited field to `out` and
+// returns their size.
+size_t WriteLengthDelimitedHeader(int field, uint64_t length, char* out) {
+  size_t size = 0;
+  uint64_t value = (field << 3) | kLengthDelimitedWireType;
+  for (int i = 0; i < 2; ++i) {
+    while (value >= 0x80) {
+      out[size++] = static_cast<char>((value & 0x7F) | 0x80);
+      value >>= 7;
+    }
+    out[size++] = static_cast<char>(value);
+    value = length;
+  }
+  return size;
+}
+
+}  // namespace
+
+absl::Status ReadCiphertextRequest(absl::Span<const absl::string_view> chunks,
+                                   std::string& request_ciphertext,
+                                   std::string& key_id) {
+  ChunkReader reader(chunks);
+  while (!reader.AtEnd()) {
+    uint64_t tag;
+    if (!reader.ReadVarint(tag)) {
+      return MalformedRequestError("truncated tag");
+    }
+    const uint64_t field = tag >> 3;
+    const int wire_type = tag & 0x7;
+    uint64_t value;
+    switch (wire_type) {
+      case kVarintWireType:
+        if (!reader.ReadVarint(value)) {
+          return MalformedRequestError("truncated varint");
+        }
+        break;
+      case kFixed64WireType:
+        if (!reader.Read(sizeof(uint64_t), nullptr)) {
+          return MalformedRequestError("truncated fixed64");
+        }
+        break;
+      case kFixed32WireType:
+        if (!reader.Read(sizeof(uint32_t), nullptr)) {
+          return MalformedRequestError("truncated fixed32");
+        }
+        break;
+      case kLengthDelimitedWireType: {
+        if (!reader.ReadVarint(value)) {
+          return MalformedRequestError("truncated length");
+        }
+        // As with proto3, the last occurrence of a field wins.
+        std::string* out = nullptr;
+        if (field == kRequestCiphertextField) {
+          out = &request_ciphertext;
+        } else if (field == kKeyIdField) {
+          out = &key_id;
+        }
+        if (out != nullptr) {
+          out->clear();
+        }
+        if (!reader.Read(value, out)) {
+          return MalformedRequestError(
+              absl::StrCat("truncated field ", field));
+        }
+        break;
+      }
+      default:
+        return MalformedRequestError(
+            absl::StrCat("unsupported wire type ", wire_type));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadCiphertextRequest(const grpc::ByteBuffer& buffer,
+                                   std::string& request_ciphertext,
+                                   std::string& key_id) {
+  std::vector<grpc::Slice> slices;
+  if (grpc::Status status = buffer.Dump(&slices); !status.ok()) {
+    return absl::InvalidArgumentError(status.error_message());
+  }
+  std::vector<absl::string_view> chunks;
+  chunks.reserve(slices.size());
+  for (const grpc::Slice& slice : slices) {
+    chunks.emplace_back(reinterpret_cast<const char*>(slice.begin()),
+                        slice.size());
+  }
+  return ReadCiphertextRequest(chunks, request_ciphertext, key_id);
+}
+
+grpc::ByteBuffer GetCiphertextResponseByteBuffer(
+    absl::string_view response_ciphertext, std::shared_ptr<const void> owner) {
+  // Empty fields are not serialized in proto3. The buffer is still valid, as
+  // gRPC only sends valid ones.
+  if (response_ciphertext.empty()) {
+    return grpc::ByteBuffer(nullptr, 0);
+  }
+  char header[2 * kMaxVarintSize];
+  const size_t header_size = WriteLengthDelimitedHeader(
+      kResponseCiphertextField, response_ciphertext.size(), header);
+  const grpc::Slice slices[] = {
+      grpc::Slice(header, header_size),
+      // gRPC does not write to the slices it sends.
+      grpc::Slice(const_cast<char*>(response_ciphertext.data()),
+                  response_ciphertext.size(),
+                  [](void* user_data) {
+                    delete static_cast<std::shared_ptr<const void>*>(
+                        user_data);
+                  },
+                  new std::shared_ptr<const void>(std::move(owner)))};
+  return grpc::ByteBuffer(slices, std::size(slices));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
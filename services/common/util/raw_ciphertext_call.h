@@ -0,0 +1,128 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_RAW_CIPHERTEXT_CALL_H_
+#define SERVICES_COMMON_UTIL_RAW_CIPHERTEXT_CALL_H_
+
+#include <memory>
+#include <string>
+
+#include <grpcpp/support/byte_buffer.h>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "google/protobuf/arena.h"
+#include "services/common/util/arena_message_allocator.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// The messages of the ciphertext methods, GetBids, GenerateBids and ScoreAds,
+// only hold the ciphertext and the key id:
+//
+//   message Request { bytes request_ciphertext = 1; string key_id = 2; }
+//   message Response { bytes response_ciphertext = 1; }
+//
+// so that their services can read and write their wire format themselves,
+// straight from and to the slices of gRPC.
+
+// Reads a request of a ciphertext method from the `chunks` of its wire
+// format, appending its ciphertext straight to `request_ciphertext`.
+absl::Status ReadCiphertextRequest(absl::Span<const absl::string_view> chunks,
+                                   std::string& request_ciphertext,
+                                   std::string& key_id);
+
+// Reads a request of a ciphertext method from the slices of `buffer`.
+absl::Status ReadCiphertextRequest(const grpc::ByteBuffer& buffer,
+                                   std::string& request_ciphertext,
+                                   std::string& key_id);
+
+// Returns the wire format of a response of a ciphertext method, in slices
+// that refer to `response_ciphertext` rather than copy it. `owner` keeps the
+// ciphertext alive until gRPC is done with the slices.
+grpc::ByteBuffer GetCiphertextResponseByteBuffer(
+    absl::string_view response_ciphertext, std::shared_ptr<const void> owner);
+
+// A call of a ciphertext method served over its raw ByteBuffers, with the
+// messages of the call on an arena of its own, as ArenaMessageAllocator does
+// for the calls of the generated methods. The request is read straight from
+// the slices of gRPC, and the ciphertext of the response is sent from the
+// response without being copied into slices:
+//
+//   absl::StatusOr<std::shared_ptr<RawCiphertextCall<Request, Response>>>
+//       call = RawCiphertextCall<Request, Response>::Read(*request_buffer,
+//                                                         response_buffer);
+//   ... the reactor serves (*call)->request() into (*call)->response() ...
+//   (*call)->SetResponse();  // Once the response is encrypted.
+//   reactor->Finish(grpc::Status::OK);
+template <typename Request, typename Response>
+class RawCiphertextCall : public std::enable_shared_from_this<
+                              RawCiphertextCall<Request, Response>> {
+ public:
+  // Reads the request of a call. `response_buffer` is the response of the
+  // call, owned by gRPC, which is empty unless SetResponse is called.
+  static absl::StatusOr<std::shared_ptr<RawCiphertextCall>> Read(
+      const grpc::ByteBuffer& request_buffer,
+      grpc::ByteBuffer* response_buffer) {
+    *response_buffer = grpc::ByteBuffer(nullptr, 0);
+    std::shared_ptr<RawCiphertextCall> call(
+        new RawCiphertextCall(response_buffer));
+    if (absl::Status status = ReadCiphertextRequest(
+            request_buffer, *call->request_->mutable_request_ciphertext(),
+            *call->request_->mutable_key_id());
+        !status.ok()) {
+      return status;
+    }
+    return call;
+  }
+
+  // RawCiphertextCall is neither copyable nor movable.
+  RawCiphertextCall(const RawCiphertextCall&) = delete;
+  RawCiphertextCall& operator=(const RawCiphertextCall&) = delete;
+
+  const Request* request() const { return request_; }
+  Response* response() { return response_; }
+
+  // Sets the response sent by gRPC to the response of the call. Called once
+  // the response is final, before the call is finished with an OK status.
+  // The call stays alive until gRPC has sent the response.
+  void SetResponse() {
+    *response_buffer_ = GetCiphertextResponseByteBuffer(
+        response_->response_ciphertext(), this->shared_from_this());
+  }
+
+ private:
+  explicit RawCiphertextCall(grpc::ByteBuffer* response_buffer)
+      : arena_(GetArenaOptions()),
+        request_(google::protobuf::Arena::CreateMessage<Request>(&arena_)),
+        response_(google::protobuf::Arena::CreateMessage<Response>(&arena_)),
+        response_buffer_(response_buffer) {}
+
+  static google::protobuf::ArenaOptions GetArenaOptions() {
+    google::protobuf::ArenaOptions options;
+    options.start_block_size =
+        ArenaMessageAllocator<Request, Response>::kDefaultInitialBlockSize;
+    return options;
+  }
+
+  google::protobuf::Arena arena_;
+  Request* request_;
+  Response* response_;
+  grpc::ByteBuffer* response_buffer_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_RAW_CIPHERTEXT_CALL_H_
@@ -0,0 +1,174 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/raw_ciphertext_call.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <grpcpp/support/slice.h>
+
+#include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string ToString(const grpc::ByteBuffer& buffer) {
+  std::vector<grpc::Slice> slices;
+  EXPECT_TRUE(buffer.Dump(&slices).ok());
+  std::string out;
+  for (const grpc::Slice& slice : slices) {
+    out.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+  }
+  return out;
+}
+
+// Splits `value` in chunks of `chunk_size` bytes.
+std::vector<absl::string_view> Split(absl::string_view value,
+                                     size_t chunk_size) {
+  std::vector<absl::string_view> chunks;
+  for (size_t i = 0; i < value.size(); i += chunk_size) {
+    chunks.push_back(value.substr(i, chunk_size));
+  }
+  return chunks;
+}
+
+GenerateBidsRequest MakeRequest() {
+  GenerateBidsRequest request;
+  request.set_request_ciphertext(std::string(1000, 'c'));
+  request.set_key_id("key");
+  return request;
+}
+
+TEST(ReadCiphertextRequestTest, ReadsTheFieldsAcrossChunks) {
+  const std::string wire = MakeRequest().SerializeAsString();
+  for (size_t chunk_size : {1, 3, 100, 10000}) {
+    std::string ciphertext;
+    std::string key_id;
+    ASSERT_TRUE(
+        ReadCiphertextRequest(Split(wire, chunk_size), ciphertext, key_id)
+            .ok());
+    EXPECT_EQ(ciphertext, std::string(1000, 'c')) << chunk_size;
+    EXPECT_EQ(key_id, "key") << chunk_size;
+  }
+}
+
+TEST(ReadCiphertextRequestTest, SkipsUnknownFields) {
+  // Fields of other numbers or wire types than those of the request.
+  ScoreAdsResponse::AdScore other;
+  other.set_desirability(1.5);
+  other.set_interest_group_name("ig");
+  other.set_allow_component_auction(true);
+  const std::string wire =
+      MakeRequest().SerializeAsString() + other.SerializeAsString();
+  std::string ciphertext;
+  std::string key_id;
+  ASSERT_TRUE(ReadCiphertextRequest({wire}, ciphertext, key_id).ok());
+  EXPECT_EQ(ciphertext, std::string(1000, 'c'));
+  EXPECT_EQ(key_id, "key");
+}
+
+TEST(ReadCiphertextRequestTest, RejectsTruncatedRequests) {
+  const std::string wire = MakeRequest().SerializeAsString();
+  std::string ciphertext;
+  std::string key_id;
+  EXPECT_FALSE(
+      ReadCiphertextRequest({absl::string_view(wire).substr(0, 500)},
+                            ciphertext, key_id)
+          .ok());
+}
+
+TEST(ReadCiphertextRequestTest, RejectsLengthsPastTheEnd) {
+  // Field 1 claiming 2^62 bytes.
+  const std::string wire = "\x0a\x80\x80\x80\x80\x80\x80\x80\x80\x40";
+  std::string ciphertext;
+  std::string key_id;
+  EXPECT_FALSE(ReadCiphertextRequest({wire}, ciphertext, key_id).ok());
+}
+
+TEST(ReadCiphertextRequestTest, ReadsByteBuffers) {
+  const std::string wire = MakeRequest().SerializeAsString();
+  const grpc::Slice slices[] = {grpc::Slice(wire.substr(0, 10)),
+                                grpc::Slice(wire.substr(10))};
+  grpc::ByteBuffer buffer(slices, 2);
+  std::string ciphertext;
+  std::string key_id;
+  ASSERT_TRUE(ReadCiphertextRequest(buffer, ciphertext, key_id).ok());
+  EXPECT_EQ(ciphertext, std::string(1000, 'c'));
+  EXPECT_EQ(key_id, "key");
+}
+
+TEST(GetCiphertextResponseByteBufferTest, SerializesTheResponse) {
+  for (size_t size : {0, 1, 127, 128, 100000}) {
+    auto ciphertext = std::make_shared<std::string>(size, 'r');
+    GenerateBidsResponse response;
+    ASSERT_TRUE(response.ParseFromString(ToString(
+        GetCiphertextResponseByteBuffer(*ciphertext, ciphertext))));
+    EXPECT_EQ(response.response_ciphertext(), *ciphertext) << size;
+  }
+}
+
+TEST(GetCiphertextResponseByteBufferTest, KeepsTheOwnerAliveWithTheBuffer) {
+  auto ciphertext = std::make_shared<std::string>(1000, 'r');
+  std::weak_ptr<std::string> weak_ciphertext = ciphertext;
+  auto buffer = std::make_unique<grpc::ByteBuffer>(
+      GetCiphertextResponseByteBuffer(*ciphertext, ciphertext));
+  ciphertext.reset();
+  EXPECT_FALSE(weak_ciphertext.expired());
+  buffer.reset();
+  EXPECT_TRUE(weak_ciphertext.expired());
+}
+
+TEST(RawCiphertextCallTest, ReadsTheRequestAndSetsTheResponse) {
+  const std::string wire = MakeRequest().SerializeAsString();
+  grpc::Slice slice(wire);
+  grpc::ByteBuffer request_buffer(&slice, 1);
+  grpc::ByteBuffer response_buffer;
+  std::weak_ptr<RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>>
+      weak_call;
+  {
+    auto call =
+        RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>::Read(
+            request_buffer, &response_buffer);
+    ASSERT_TRUE(call.ok());
+    weak_call = *call;
+    EXPECT_EQ((*call)->request()->key_id(), "key");
+    EXPECT_NE((*call)->request()->GetArena(), nullptr);
+    (*call)->response()->set_response_ciphertext("response");
+    (*call)->SetResponse();
+  }
+  // The response is sent from the call.
+  EXPECT_FALSE(weak_call.expired());
+  GenerateBidsResponse response;
+  ASSERT_TRUE(response.ParseFromString(ToString(response_buffer)));
+  EXPECT_EQ(response.response_ciphertext(), "response");
+  response_buffer.Clear();
+  EXPECT_TRUE(weak_call.expired());
+}
+
+TEST(RawCiphertextCallTest, RejectsMalformedRequests) {
+  grpc::Slice slice(std::string("\x0a\x05"));
+  grpc::ByteBuffer request_buffer(&slice, 1);
+  grpc::ByteBuffer response_buffer;
+  EXPECT_FALSE(
+      (RawCiphertextCall<GenerateBidsRequest, GenerateBidsResponse>::Read(
+           request_buffer, &response_buffer))
+          .ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,6 +14,7 @@
 
 #include "services/common/util/reporting_util.h"
 
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -21,9 +22,11 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_replace.h"
+#include "absl/strings/str_format.h"
+#include "services/common/util/json_span_util.h"
 #include "services/common/util/json_util.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/url_template.h"
 #include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -33,11 +36,21 @@ namespace {
 inline constexpr char kLogs[] = "logs";
 inline constexpr char kWarnings[] = "warnings";
 inline constexpr char kErrors[] = "errors";
-inline constexpr int kNumDebugReportingReplacements = 5;
-inline constexpr int kNumAdditionalWinReportingReplacements = 2;
+inline constexpr char kProfile[] = "profile";
+inline constexpr char kResponse[] = "response";
+// Distinct debug reporting URLs whose parsed templates are kept across
+// auctions.
+inline constexpr int kDebugReportingUrlTemplateCacheSize = 4096;
 inline constexpr absl::string_view kFeatureDisabled = "false";
 inline constexpr absl::string_view kFeatureEnabled = "true";
 
+UrlTemplateCache& GetDebugReportingUrlTemplateCache() {
+  static UrlTemplateCache* cache = new UrlTemplateCache(
+      kDebugReportingUrlTemplateCacheSize,
+      {kDebugReportingPlaceholders.begin(), kDebugReportingPlaceholders.end()});
+  return *cache;
+}
+
 void MayVlogAdTechCodeLogs(const rapidjson::Document& document,
 
                            const std::string& log_type,
@@ -150,34 +163,36 @@ PostAuctionSignals GeneratePostAuctionSignals(
 HTTPRequest CreateDebugReportingHttpRequest(
     absl::string_view url, const DebugReportingPlaceholder& placeholder_data,
     bool is_win_debug_url) {
-  std::vector<std::pair<absl::string_view, std::string>> replacements;
-  replacements.reserve(
-      kNumDebugReportingReplacements +
-      (is_win_debug_url ? kNumAdditionalWinReportingReplacements : 0));
-  replacements.push_back(
-      {kWinningBidPlaceholder,
-       absl::StrFormat("%.2f", placeholder_data.winning_bid)});
-  replacements.push_back(
-      {kMadeWinningBidPlaceholder,
-       placeholder_data.made_winning_bid ? "true" : "false"});
-  replacements.push_back(
-      {kRejectReasonPlaceholder, std::string(ToSellerRejectionReasonString(
-                                     placeholder_data.rejection_reason))});
-  replacements.push_back(
-      {kHighestScoringOtherBidPlaceholder, kDefaultHighestScoringOtherBid});
-  replacements.push_back({kMadeHighestScoringOtherBidPlaceholder,
-                          kDefaultHasHighestScoringOtherBid});
+  std::shared_ptr<const UrlTemplate> url_template =
+      GetDebugReportingUrlTemplateCache().GetOrParse(url);
+  // Values are in the order of kDebugReportingPlaceholders. Bids are only
+  // formatted if the URL uses them.
+  std::string winning_bid;
+  if (url_template->HasPlaceholder(0)) {
+    winning_bid = absl::StrFormat("%.2f", placeholder_data.winning_bid);
+  }
   // Only pass the second highest scored bid information to the winner.
+  std::string highest_scoring_other_bid = kDefaultHighestScoringOtherBid;
+  absl::string_view made_highest_scoring_other_bid =
+      kDefaultHasHighestScoringOtherBid;
   if (is_win_debug_url) {
-    replacements.push_back(
-        {kHighestScoringOtherBidPlaceholder,
-         absl::StrFormat("%.2f", placeholder_data.highest_scoring_other_bid)});
-    replacements.push_back(
-        {kMadeHighestScoringOtherBidPlaceholder,
-         placeholder_data.made_highest_scoring_other_bid ? "true" : "false"});
+    if (url_template->HasPlaceholder(2)) {
+      highest_scoring_other_bid =
+          absl::StrFormat("%.2f", placeholder_data.highest_scoring_other_bid);
+    }
+    made_highest_scoring_other_bid =
+        placeholder_data.made_highest_scoring_other_bid ? "true" : "false";
   }
+  const absl::string_view values[] = {
+      winning_bid,
+      placeholder_data.made_winning_bid ? "true" : "false",
+      highest_scoring_other_bid,
+      made_highest_scoring_other_bid,
+      ToSellerRejectionReasonString(placeholder_data.rejection_reason)};
+  static_assert(std::size(values) == kDebugReportingPlaceholders.size());
+
   HTTPRequest http_request;
-  http_request.url = absl::StrReplaceAll(url, replacements);
+  http_request.url = url_template->Render(values);
   http_request.headers = {};
   return http_request;
 }
@@ -278,23 +293,54 @@ void MayVlogAdTechCodeLogs(bool enable_ad_tech_code_logging,
   MayVlogAdTechCodeLogs(document, kLogs, log_context);
   MayVlogAdTechCodeLogs(document, kWarnings, log_context);
   MayVlogAdTechCodeLogs(document, kErrors, log_context);
+  if (auto profile_it = document.FindMember(kProfile);
+      profile_it != document.MemberEnd()) {
+    if (absl::StatusOr<std::string> profile =
+            SerializeJsonDoc(profile_it->value);
+        profile.ok()) {
+      PS_VLOG(kUdfLog, log_context) << kProfile << ": " << *profile;
+    }
+  }
 }
 
 absl::StatusOr<std::string> ParseAndGetResponseJson(
     bool enable_ad_tech_code_logging, const std::string& response,
-    server_common::log::ContextImpl& log_context) {
-  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+    server_common::log::ContextImpl& log_context, JsonArena* arena) {
+  if (!enable_ad_tech_code_logging) {
+    // Only the response is read: its raw JSON is extracted in a SAX pass
+    // without building a document, then minified as the writer would have.
+    JsonPropertySpans spans = {{kResponse, {}}};
+    PS_RETURN_IF_ERROR(FindJsonPropertySpans(response, spans));
+    if (spans[kResponse].data() == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat(kMissingMember, kResponse));
+    }
+    std::string response_json;
+    response_json.reserve(spans[kResponse].size());
+    AppendMinifiedJson(spans[kResponse], response_json);
+    return response_json;
+  }
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document,
+                      arena == nullptr ? ParseJsonString(response)
+                                       : ParseJsonString(response, *arena));
   MayVlogAdTechCodeLogs(enable_ad_tech_code_logging, document, log_context);
-  return SerializeJsonDoc(document["response"]);
+  return SerializeJsonDoc(document[kResponse]);
 }
 
 std::string GetFeatureFlagJson(bool enable_logging,
-                               bool enable_debug_url_generation) {
+                               bool enable_debug_url_generation,
+                               bool enable_udf_profiling) {
   std::string feature_flags = "{";
   AppendFeatureFlagValue(feature_flags, kFeatureLogging, enable_logging);
   feature_flags.append(",");
   AppendFeatureFlagValue(feature_flags, kFeatureDebugUrlGeneration,
                          enable_debug_url_generation);
+  // Left out unless set, as the wrappers read a missing flag as false.
+  if (enable_udf_profiling) {
+    feature_flags.append(",");
+    AppendFeatureFlagValue(feature_flags, kFeatureUdfProfiling,
+                           enable_udf_profiling);
+  }
   feature_flags.append("}");
   return feature_flags;
 }
@@ -15,6 +15,7 @@
 #ifndef SERVICES_COMMON_UTIL_REPORTING_UTIL_H
 #define SERVICES_COMMON_UTIL_REPORTING_UTIL_H
 
+#include <array>
 #include <memory>
 #include <string>
 
@@ -23,6 +24,7 @@
 #include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/util/json_util.h"
 #include "services/common/util/post_auction_signals.h"
 #include "src/logger/request_context_impl.h"
 
@@ -35,6 +37,11 @@ constexpr absl::string_view kHighestScoringOtherBidPlaceholder =
 constexpr absl::string_view kMadeHighestScoringOtherBidPlaceholder =
     "${madeHighestScoringOtherBid}";
 constexpr absl::string_view kRejectReasonPlaceholder = "${rejectReason}";
+// Placeholders of the debug reporting URLs.
+inline constexpr std::array<absl::string_view, 5> kDebugReportingPlaceholders =
+    {kWinningBidPlaceholder, kMadeWinningBidPlaceholder,
+     kHighestScoringOtherBidPlaceholder, kMadeHighestScoringOtherBidPlaceholder,
+     kRejectReasonPlaceholder};
 
 // Update server_definition.h  - kSellerRejectReasons[] if any change is made to
 // SellerRejectionReason Enum.
@@ -69,6 +76,68 @@ inline constexpr char kDefaultHasHighestScoringOtherBid[] = "false";
 inline constexpr char kFeatureLogging[] = "enable_logging";
 inline constexpr char kFeatureDebugUrlGeneration[] =
     "enable_debug_url_generation";
+inline constexpr char kFeatureUdfProfiling[] = "enable_udf_profiling";
+
+// Javascript prepended to the wrapped UDFs of the ad techs. psRunProfiled
+// calls `fn`, and returns its output with, if featureFlags.enable_udf_profiling
+// is set, the profile of the global functions of the ad tech that ran: their
+// number of calls and their total and self milliseconds, by name. The
+// functions are wrapped with timers for the call, and restored after it.
+inline constexpr absl::string_view kUdfProfilingFunction = R"JS_CODE(
+    function psRunProfiled(featureFlags, fn) {
+      if (!featureFlags.enable_udf_profiling) {
+        return [fn(), undefined];
+      }
+      const psNow = typeof performance !== 'undefined' ?
+          () => performance.now() : () => Date.now();
+      const profile = {};
+      const originals = [];
+      const frames = [];
+      for (const name of Object.getOwnPropertyNames(globalThis)) {
+        const descriptor = Object.getOwnPropertyDescriptor(globalThis, name);
+        const original = descriptor.value;
+        if (typeof original !== 'function' || !descriptor.writable ||
+            name.startsWith('ps') || name.endsWith('EntryFunction') ||
+            Function.prototype.toString.call(original)
+                .includes('[native code]')) {
+          continue;
+        }
+        const stats = {calls: 0, total_ms: 0, self_ms: 0};
+        let depth = 0;
+        globalThis[name] = function(...args) {
+          const frame = {start: psNow(), children_ms: 0};
+          frames.push(frame);
+          depth++;
+          try {
+            return new.target ? Reflect.construct(original, args, new.target)
+                              : original.apply(this, args);
+          } finally {
+            const elapsed = psNow() - frame.start;
+            frames.pop();
+            depth--;
+            stats.calls++;
+            // Recursive calls are counted in the total of the outermost one.
+            if (depth === 0) {
+              stats.total_ms += elapsed;
+            }
+            stats.self_ms += elapsed - frame.children_ms;
+            if (frames.length) {
+              frames[frames.length - 1].children_ms += elapsed;
+            }
+            profile[name] = stats;
+          }
+        };
+        originals.push([name, original]);
+      }
+      try {
+        return [fn(), profile];
+      } finally {
+        for (const [name, original] of originals) {
+          globalThis[name] = original;
+        }
+      }
+    }
+)JS_CODE";
 
 // Captures placeholder data for debug reporting.
 struct DebugReportingPlaceholder {
@@ -122,13 +191,18 @@ void MayVlogAdTechCodeLogs(bool enable_ad_tech_code_logging,
 
 // Parses the JSON string, conditionally prints the logs from the response and
 // returns a serialized response string retrieved from the underlying UDF.
+// The document is parsed in `arena` if set. Without logging, no document is
+// built and the raw JSON of the response is returned minified.
 absl::StatusOr<std::string> ParseAndGetResponseJson(
     bool enable_ad_tech_code_logging, const std::string& response,
-    server_common::log::ContextImpl& log_context);
+    server_common::log::ContextImpl& log_context, JsonArena* arena = nullptr);
 
 // Returns a JSON string for feature flags to be used by the wrapper script.
+// UDF profiling, see kUdfProfilingFunction, is only meant for consented
+// requests, whose ad tech code logs hold the profiles.
 std::string GetFeatureFlagJson(bool enable_logging,
-                               bool enable_debug_url_generation);
+                               bool enable_debug_url_generation,
+                               bool enable_udf_profiling = false);
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 #endif  // SERVICES_COMMON_UTIL_REPORTING_UTIL_H
@@ -512,5 +512,53 @@ TEST(SellerRejectionReasonTest, ToSellerRejectionReasonStringSuccess) {
       SellerRejectionReason::BID_FROM_SCORE_AD_FAILED_CURRENCY_CHECK,
       "bid-from-score-ad-failed-currency-check");
 }
+
+TEST(ParseAndGetResponseJsonTest, ReturnsTheResponseOfTheUdf) {
+  server_common::log::ContextImpl log_context(
+      {}, server_common::ConsentedDebugConfiguration());
+  const std::string udf_output =
+      R"({"response": {"bid": 1.5, "render": "https://ad"}, "logs": ["log"]})";
+  for (bool enable_logging : {false, true}) {
+    absl::StatusOr<std::string> response =
+        ParseAndGetResponseJson(enable_logging, udf_output, log_context);
+    ASSERT_TRUE(response.ok()) << response.status();
+    EXPECT_EQ(*response, R"({"bid":1.5,"render":"https://ad"})")
+        << enable_logging;
+  }
+}
+
+TEST(ParseAndGetResponseJsonTest, FailsWithoutAValidResponse) {
+  server_common::log::ContextImpl log_context(
+      {}, server_common::ConsentedDebugConfiguration());
+  EXPECT_FALSE(ParseAndGetResponseJson(/*enable_ad_tech_code_logging=*/false,
+                                       R"({"logs": []})", log_context)
+                   .ok());
+  EXPECT_FALSE(ParseAndGetResponseJson(/*enable_ad_tech_code_logging=*/false,
+                                       R"({"response": {)", log_context)
+                   .ok());
+}
+
+TEST(ParseAndGetResponseJsonTest, ReturnsTheResponseOfAProfiledUdf) {
+  server_common::log::ContextImpl log_context(
+      {}, server_common::ConsentedDebugConfiguration());
+  absl::StatusOr<std::string> response = ParseAndGetResponseJson(
+      /*enable_ad_tech_code_logging=*/true,
+      R"({"response": {"bid": 1.5}, "logs": [],
+          "profile": {"helper": {"calls": 2, "total_ms": 1, "self_ms": 1}}})",
+      log_context);
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_EQ(*response, R"({"bid":1.5})");
+}
+
+TEST(GetFeatureFlagJsonTest, SetsUdfProfilingOnlyIfEnabled) {
+  EXPECT_EQ(GetFeatureFlagJson(/*enable_logging=*/true,
+                               /*enable_debug_url_generation=*/false),
+            R"({"enable_logging": true,"enable_debug_url_generation": false})");
+  EXPECT_EQ(GetFeatureFlagJson(/*enable_logging=*/true,
+                               /*enable_debug_url_generation=*/false,
+                               /*enable_udf_profiling=*/true),
+            R"({"enable_logging": true,"enable_debug_url_generation": false,)"
+            R"("enable_udf_profiling": true})");
+}
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
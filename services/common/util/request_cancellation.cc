@@ -0,0 +1,53 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_cancellation.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void RequestCancellation::Cancel() {
+  absl::flat_hash_map<int64_t, Callback> callbacks;
+  {
+    absl::MutexLock lock(&mu_);
+    if (cancelled_.exchange(true, std::memory_order_acq_rel)) {
+      return;
+    }
+    callbacks.swap(callbacks_);
+  }
+  for (auto& [id, callback] : callbacks) {
+    std::move(callback)();
+  }
+}
+
+int64_t RequestCancellation::Register(Callback on_cancel) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!IsCancelled()) {
+      const int64_t id = next_id_++;
+      callbacks_.emplace(id, std::move(on_cancel));
+      return id;
+    }
+  }
+  std::move(on_cancel)();
+  return -1;
+}
+
+void RequestCancellation::Unregister(int64_t id) {
+  absl::MutexLock lock(&mu_);
+  callbacks_.erase(id);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
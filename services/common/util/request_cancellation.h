@@ -0,0 +1,78 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_CANCELLATION_H_
+#define SERVICES_COMMON_UTIL_REQUEST_CANCELLATION_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Error message of the work given up on because its request was cancelled.
+inline constexpr char kRequestCancelledError[] = "Request was cancelled";
+
+// Cancellation of a request by its client, shared by the request and the
+// outbound work it fans out, e.g. RPCs and HTTP fetches, which register to be
+// told about it. Thread-safe.
+//
+//   auto cancellation = std::make_shared<RequestCancellation>();
+//   int64_t id = cancellation->Register([context]() { context->TryCancel(); });
+//   ...
+//   cancellation->Unregister(id);  // Once the RPC is done.
+//
+//   void OnCancel() override { cancellation->Cancel(); }
+class RequestCancellation {
+ public:
+  using Callback = absl::AnyInvocable<void() &&>;
+
+  RequestCancellation() = default;
+
+  // RequestCancellation is neither copyable nor movable.
+  RequestCancellation(const RequestCancellation&) = delete;
+  RequestCancellation& operator=(const RequestCancellation&) = delete;
+
+  // Cancels the request and runs the registered callbacks, only the first
+  // time it is called. The callbacks run on the calling thread, without any
+  // lock held, so they may register or unregister callbacks.
+  void Cancel() ABSL_LOCKS_EXCLUDED(mu_);
+
+  bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_acquire);
+  }
+
+  // Registers `on_cancel` to run once the request is cancelled, or runs it
+  // right away if it already is. Returns an id for Unregister.
+  int64_t Register(Callback on_cancel) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Drops the callback registered with `id` if it has not run yet. The
+  // callback may still be running on the thread of Cancel when this returns,
+  // so whatever it uses must outlive the request, e.g. by shared ownership.
+  void Unregister(int64_t id) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  std::atomic<bool> cancelled_ = false;
+  absl::Mutex mu_;
+  int64_t next_id_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<int64_t, Callback> callbacks_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_CANCELLATION_H_
@@ -0,0 +1,72 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_cancellation.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestCancellationTest, RunsRegisteredCallbacksOnce) {
+  RequestCancellation cancellation;
+  int num_calls = 0;
+  cancellation.Register([&num_calls]() { ++num_calls; });
+  cancellation.Register([&num_calls]() { ++num_calls; });
+  EXPECT_FALSE(cancellation.IsCancelled());
+  EXPECT_EQ(num_calls, 0);
+
+  cancellation.Cancel();
+  cancellation.Cancel();
+
+  EXPECT_TRUE(cancellation.IsCancelled());
+  EXPECT_EQ(num_calls, 2);
+}
+
+TEST(RequestCancellationTest, SkipsUnregisteredCallbacks) {
+  RequestCancellation cancellation;
+  bool called = false;
+  int64_t id = cancellation.Register([&called]() { called = true; });
+
+  cancellation.Unregister(id);
+  cancellation.Cancel();
+
+  EXPECT_FALSE(called);
+}
+
+TEST(RequestCancellationTest, RunsCallbacksRightAwayOnceCancelled) {
+  RequestCancellation cancellation;
+  cancellation.Cancel();
+  bool called = false;
+
+  cancellation.Register([&called]() { called = true; });
+
+  EXPECT_TRUE(called);
+}
+
+TEST(RequestCancellationTest, CallbacksMayUnregister) {
+  RequestCancellation cancellation;
+  int64_t id = 0;
+  id = cancellation.Register(
+      [&cancellation, &id]() { cancellation.Unregister(id); });
+
+  cancellation.Cancel();
+
+  EXPECT_TRUE(cancellation.IsCancelled());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,87 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_capture.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::string FormatCapturedRequest(const CapturedRequest& request) {
+  return absl::StrCat(absl::ToInt64Microseconds(request.offset), "\t",
+                      request.kind, "\t", request.json);
+}
+
+absl::StatusOr<CapturedRequest> ParseCapturedRequest(absl::string_view line) {
+  std::vector<absl::string_view> fields =
+      absl::StrSplit(line, absl::MaxSplits('\t', 2));
+  int64_t offset_us;
+  if (fields.size() != 3 || !absl::SimpleAtoi(fields[0], &offset_us) ||
+      fields[1].empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed captured request: ", line.substr(0, 64)));
+  }
+  return CapturedRequest{.offset = absl::Microseconds(offset_us),
+                         .kind = std::string(fields[1]),
+                         .json = std::string(fields[2])};
+}
+
+RequestCapture& RequestCapture::Get() {
+  static auto* const capture = new RequestCapture();
+  return *capture;
+}
+
+absl::Status RequestCapture::Configure(absl::string_view corpus_path,
+                                       bool test_mode) {
+  if (corpus_path.empty()) {
+    return absl::OkStatus();
+  }
+  if (!test_mode) {
+    return absl::FailedPreconditionError(
+        "Requests can only be captured in test mode");
+  }
+  absl::MutexLock lock(&mu_);
+  corpus_.open(std::string(corpus_path), std::ios::out | std::ios::app);
+  if (!corpus_.is_open()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unable to open the capture corpus ", corpus_path));
+  }
+  enabled_ = true;
+  return absl::OkStatus();
+}
+
+void RequestCapture::Capture(absl::string_view kind, absl::string_view json) {
+  if (!enabled()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  const absl::Time now = absl::Now();
+  if (!start_.has_value()) {
+    start_ = now;
+  }
+  // Flushed right away so that the corpus is complete whenever the server
+  // stops.
+  corpus_ << FormatCapturedRequest(
+                 {.offset = now - *start_,
+                  .kind = std::string(kind),
+                  .json = std::string(json)})
+          << std::endl;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,92 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_CAPTURE_H_
+#define SERVICES_COMMON_UTIL_REQUEST_CAPTURE_H_
+
+#include <atomic>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Kinds of the requests in a capture corpus.
+inline constexpr absl::string_view kSelectAdCaptureKind = "SelectAd";
+inline constexpr absl::string_view kGetBidsCaptureKind = "GetBids";
+
+// A plaintext request captured by a server.
+struct CapturedRequest {
+  // Time the request arrived at, since the first request of the corpus.
+  absl::Duration offset;
+  std::string kind;
+  // The request in JSON, as the secure_invoke tool takes it.
+  std::string json;
+};
+
+// Formats a request as a line of a corpus, without the newline:
+//
+//   <offset in microseconds> TAB <kind> TAB <JSON on a single line>
+std::string FormatCapturedRequest(const CapturedRequest& request);
+
+// Parses a line of a corpus.
+absl::StatusOr<CapturedRequest> ParseCapturedRequest(absl::string_view line);
+
+// Appends the plaintext of the requests received by the server to a corpus
+// file, for tools/load_testing/request_replayer to reproduce the traffic
+// later. Since the corpus holds the plaintext, only servers in test mode
+// capture requests, and the reactors only capture those of consented
+// debugging. Thread-safe.
+class RequestCapture {
+ public:
+  // Capture used by the services, disabled until configured.
+  static RequestCapture& Get();
+
+  RequestCapture() = default;
+
+  // RequestCapture is neither copyable nor movable.
+  RequestCapture(const RequestCapture&) = delete;
+  RequestCapture& operator=(const RequestCapture&) = delete;
+
+  // Appends the requests captured to the corpus at `corpus_path`. Nothing is
+  // captured if the path is empty. Fails if the server is not in test mode
+  // or the corpus can't be opened.
+  absl::Status Configure(absl::string_view corpus_path, bool test_mode);
+
+  // Returns true if requests are captured, for the callers to skip building
+  // their JSON otherwise.
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Appends a request, of one of the kinds above, to the corpus. `json` must
+  // be on a single line.
+  void Capture(absl::string_view kind, absl::string_view json);
+
+ private:
+  std::atomic<bool> enabled_ = false;
+  absl::Mutex mu_;
+  std::ofstream corpus_ ABSL_GUARDED_BY(mu_);
+  // Time the first request was captured at.
+  std::optional<absl::Time> start_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_CAPTURE_H_
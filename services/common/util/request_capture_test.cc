@@ -0,0 +1,85 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_capture.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::vector<std::string> ReadLines(const std::string& path) {
+  std::ifstream file(path);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(file, line);) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+TEST(RequestCaptureTest, FormatsAndParsesRequest) {
+  const std::string line = FormatCapturedRequest(
+      {.offset = absl::Milliseconds(5),
+       .kind = std::string(kGetBidsCaptureKind),
+       .json = R"({"seller":"a\tb"})"});
+  EXPECT_EQ(line, "5000\tGetBids\t{\"seller\":\"a\\tb\"}");
+
+  absl::StatusOr<CapturedRequest> parsed = ParseCapturedRequest(line);
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_EQ(parsed->offset, absl::Milliseconds(5));
+  EXPECT_EQ(parsed->kind, kGetBidsCaptureKind);
+  EXPECT_EQ(parsed->json, R"({"seller":"a\tb"})");
+
+  EXPECT_FALSE(ParseCapturedRequest("not a captured request").ok());
+  EXPECT_FALSE(ParseCapturedRequest("x\tGetBids\t{}").ok());
+}
+
+TEST(RequestCaptureTest, CapturesOnlyInTestMode) {
+  const std::string path = absl::StrCat(testing::TempDir(), "/corpus_prod");
+  RequestCapture capture;
+  EXPECT_TRUE(capture.Configure("", /*test_mode=*/false).ok());
+  EXPECT_FALSE(capture.enabled());
+  EXPECT_FALSE(capture.Configure(path, /*test_mode=*/false).ok());
+  EXPECT_FALSE(capture.enabled());
+  capture.Capture(kGetBidsCaptureKind, "{}");
+  EXPECT_TRUE(ReadLines(path).empty());
+}
+
+TEST(RequestCaptureTest, AppendsRequestsToCorpus) {
+  const std::string path = absl::StrCat(testing::TempDir(), "/corpus");
+  std::remove(path.c_str());
+  RequestCapture capture;
+  ASSERT_TRUE(capture.Configure(path, /*test_mode=*/true).ok());
+  ASSERT_TRUE(capture.enabled());
+  capture.Capture(kSelectAdCaptureKind, R"({"auction_config":{}})");
+  capture.Capture(kGetBidsCaptureKind, R"({"seller":"s"})");
+
+  std::vector<std::string> lines = ReadLines(path);
+  ASSERT_EQ(lines.size(), 2);
+  absl::StatusOr<CapturedRequest> first = ParseCapturedRequest(lines[0]);
+  absl::StatusOr<CapturedRequest> second = ParseCapturedRequest(lines[1]);
+  ASSERT_TRUE(first.ok() && second.ok());
+  EXPECT_EQ(first->offset, absl::ZeroDuration());
+  EXPECT_EQ(first->kind, kSelectAdCaptureKind);
+  EXPECT_GE(second->offset, first->offset);
+  EXPECT_EQ(second->json, R"({"seller":"s"})");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
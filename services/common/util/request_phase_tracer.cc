@@ -0,0 +1,82 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_phase_tracer.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kPerMille = 1000;
+
+std::atomic<int> sampling_per_mille = 0;
+// Counts the requests, so that every kPerMille consecutive requests trace
+// exactly `sampling_per_mille` of them.
+std::atomic<uint32_t> num_requests = 0;
+
+bool ShouldSample() {
+  const int per_mille = sampling_per_mille.load(std::memory_order_relaxed);
+  if (per_mille <= 0) {
+    return false;
+  }
+  if (per_mille >= kPerMille) {
+    return true;
+  }
+  return num_requests.fetch_add(1, std::memory_order_relaxed) % kPerMille <
+         static_cast<uint32_t>(per_mille);
+}
+
+}  // namespace
+
+absl::string_view GetRequestPhaseName(RequestPhase phase) {
+  switch (phase) {
+    case RequestPhase::kDecrypt:
+      return "decrypt";
+    case RequestPhase::kDecode:
+      return "decode";
+    case RequestPhase::kFanOut:
+      return "fan_out";
+    case RequestPhase::kKvLookup:
+      return "kv_lookup";
+    case RequestPhase::kRomaDispatch:
+      return "roma_dispatch";
+    case RequestPhase::kWinnerSelection:
+      return "winner_selection";
+    case RequestPhase::kEncrypt:
+      return "encrypt";
+    default:
+      return "unknown";
+  }
+}
+
+void RequestPhaseTracer::SetSamplingPerMille(int per_mille) {
+  sampling_per_mille.store(per_mille, std::memory_order_relaxed);
+}
+
+RequestPhaseTracer::RequestPhaseTracer() : enabled_(ShouldSample()) {}
+
+RequestPhaseTracer::RequestPhaseTracer(bool enabled) : enabled_(enabled) {}
+
+std::optional<absl::Duration> RequestPhaseTracer::GetDuration(
+    RequestPhase phase) const {
+  const int index = Index(phase);
+  if (!enabled_ || !ended_[index]) {
+    return std::nullopt;
+  }
+  return CycleClock::ToDuration(durations_[index]);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,138 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_PHASE_TRACER_H_
+#define SERVICES_COMMON_UTIL_REQUEST_PHASE_TRACER_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "services/common/util/cycle_clock.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Phases of the handling of a request timed by RequestPhaseTracer. Not every
+// server goes through every phase.
+enum class RequestPhase : int {
+  kDecrypt = 0,
+  kDecode,
+  kFanOut,
+  kKvLookup,
+  kRomaDispatch,
+  kWinnerSelection,
+  kEncrypt,
+  kNumPhases,
+};
+
+// Name of a phase, e.g. for the span timing it in a trace.
+absl::string_view GetRequestPhaseName(RequestPhase phase);
+
+// Notified of the phases of a request as they start and end, e.g. to time
+// them in a distributed trace. Called on the thread starting or ending the
+// phase.
+class RequestPhaseListener {
+ public:
+  virtual ~RequestPhaseListener() = default;
+
+  virtual void OnPhaseStart(RequestPhase phase) = 0;
+  virtual void OnPhaseEnd(RequestPhase phase) = 0;
+};
+
+// Records the time spent by a request in each of its phases, using the
+// CycleClock. Only a sampled share of the requests is traced, and Start/End
+// are a single branch for the others.
+//
+// Different phases may be started and ended concurrently, e.g. a KV lookup
+// running alongside a fan-out, but a phase must not be started or ended on
+// two threads at once. A phase started several times accumulates its
+// durations.
+class RequestPhaseTracer {
+ public:
+  // Sets the share of the requests traced by new tracers, in thousandths of
+  // the requests. No request is traced if 0, every request if 1000 or more.
+  static void SetSamplingPerMille(int sampling_per_mille);
+
+  // Traces the request if it is sampled.
+  RequestPhaseTracer();
+  // Traces the request if `enabled`.
+  explicit RequestPhaseTracer(bool enabled);
+
+  void Start(RequestPhase phase) {
+    if (enabled_) {
+      starts_[Index(phase)] = CycleClock::Now();
+    }
+    if (listener_ != nullptr) {
+      listener_->OnPhaseStart(phase);
+    }
+  }
+
+  void End(RequestPhase phase) {
+    if (enabled_) {
+      const int index = Index(phase);
+      durations_[index] += CycleClock::Now() - starts_[index];
+      ended_[index] = true;
+    }
+    if (listener_ != nullptr) {
+      listener_->OnPhaseEnd(phase);
+    }
+  }
+
+  // Returns true if the request is traced.
+  bool enabled() const { return enabled_; }
+
+  // Notifies `listener` of the phases started and ended from now on, whether
+  // or not the request is traced. The listener must outlive the tracer.
+  void set_listener(RequestPhaseListener* listener) { listener_ = listener; }
+
+  // Returns the total time spent in the phase, if the request is traced and
+  // the phase ended at least once.
+  std::optional<absl::Duration> GetDuration(RequestPhase phase) const;
+
+ private:
+  static constexpr int kNumPhases = static_cast<int>(RequestPhase::kNumPhases);
+
+  static int Index(RequestPhase phase) { return static_cast<int>(phase); }
+
+  const bool enabled_;
+  // In ticks of the CycleClock.
+  std::array<int64_t, kNumPhases> starts_ = {};
+  std::array<int64_t, kNumPhases> durations_ = {};
+  std::array<bool, kNumPhases> ended_ = {};
+  RequestPhaseListener* listener_ = nullptr;
+};
+
+// Times a phase for the lifetime of the object.
+class ScopedRequestPhase {
+ public:
+  ScopedRequestPhase(RequestPhaseTracer& tracer, RequestPhase phase)
+      : tracer_(tracer), phase_(phase) {
+    tracer_.Start(phase_);
+  }
+  ~ScopedRequestPhase() { tracer_.End(phase_); }
+
+  // ScopedRequestPhase is neither copyable nor movable.
+  ScopedRequestPhase(const ScopedRequestPhase&) = delete;
+  ScopedRequestPhase& operator=(const ScopedRequestPhase&) = delete;
+
+ private:
+  RequestPhaseTracer& tracer_;
+  const RequestPhase phase_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_PHASE_TRACER_H_
@@ -0,0 +1,102 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_phase_tracer.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestPhaseTracerTest, RecordsEndedPhases) {
+  RequestPhaseTracer tracer(/*enabled=*/true);
+  tracer.Start(RequestPhase::kDecrypt);
+  absl::SleepFor(absl::Milliseconds(2));
+  tracer.End(RequestPhase::kDecrypt);
+  tracer.Start(RequestPhase::kEncrypt);
+
+  ASSERT_TRUE(tracer.GetDuration(RequestPhase::kDecrypt).has_value());
+  EXPECT_GE(*tracer.GetDuration(RequestPhase::kDecrypt),
+            absl::Milliseconds(2));
+  EXPECT_FALSE(tracer.GetDuration(RequestPhase::kEncrypt).has_value());
+  EXPECT_FALSE(tracer.GetDuration(RequestPhase::kKvLookup).has_value());
+}
+
+TEST(RequestPhaseTracerTest, AccumulatesRepeatedPhases) {
+  RequestPhaseTracer tracer(/*enabled=*/true);
+  for (int i = 0; i < 2; ++i) {
+    ScopedRequestPhase phase(tracer, RequestPhase::kRomaDispatch);
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_GE(*tracer.GetDuration(RequestPhase::kRomaDispatch),
+            absl::Milliseconds(2));
+}
+
+TEST(RequestPhaseTracerTest, DisabledTracerRecordsNothing) {
+  RequestPhaseTracer tracer(/*enabled=*/false);
+  tracer.Start(RequestPhase::kDecrypt);
+  tracer.End(RequestPhase::kDecrypt);
+  EXPECT_FALSE(tracer.enabled());
+  EXPECT_FALSE(tracer.GetDuration(RequestPhase::kDecrypt).has_value());
+}
+
+class RecordingListener : public RequestPhaseListener {
+ public:
+  void OnPhaseStart(RequestPhase phase) override {
+    events.push_back(absl::StrCat("start ", GetRequestPhaseName(phase)));
+  }
+  void OnPhaseEnd(RequestPhase phase) override {
+    events.push_back(absl::StrCat("end ", GetRequestPhaseName(phase)));
+  }
+
+  std::vector<std::string> events;
+};
+
+TEST(RequestPhaseTracerTest, NotifiesListenerEvenIfDisabled) {
+  RequestPhaseTracer tracer(/*enabled=*/false);
+  tracer.Start(RequestPhase::kDecrypt);
+  tracer.End(RequestPhase::kDecrypt);
+  RecordingListener listener;
+  tracer.set_listener(&listener);
+  {
+    ScopedRequestPhase phase(tracer, RequestPhase::kKvLookup);
+  }
+  EXPECT_EQ(listener.events, (std::vector<std::string>{"start kv_lookup",
+                                                        "end kv_lookup"}));
+}
+
+TEST(RequestPhaseTracerTest, SamplesShareOfRequests) {
+  RequestPhaseTracer::SetSamplingPerMille(0);
+  EXPECT_FALSE(RequestPhaseTracer().enabled());
+
+  RequestPhaseTracer::SetSamplingPerMille(1000);
+  EXPECT_TRUE(RequestPhaseTracer().enabled());
+
+  RequestPhaseTracer::SetSamplingPerMille(100);
+  int num_enabled = 0;
+  for (int i = 0; i < 10'000; ++i) {
+    num_enabled += RequestPhaseTracer().enabled();
+  }
+  EXPECT_EQ(num_enabled, 1'000);
+  RequestPhaseTracer::SetSamplingPerMille(0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,94 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_VALIDATOR_H_
+#define SERVICES_COMMON_UTIL_REQUEST_VALIDATOR_H_
+
+#include <type_traits>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "services/common/loggers/source_location_context.h"
+#include "services/common/util/error_categories.h"
+#include "services/common/util/error_reporter.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Returns whether `code` is a currency code: three upper-case ASCII letters,
+// as matched by ^[A-Z]{3}$.
+constexpr bool IsValidCurrencyCode(absl::string_view code) {
+  if (code.size() != 3) {
+    return false;
+  }
+  for (char c : code) {
+    if (c < 'A' || c > 'Z') {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks the fields of a request and reports the failed checks to an error
+// reporter, with a given visibility and error code. Error messages are either
+// constants or callables returning the message, which are only called for
+// failed checks, so that validating a well-formed request allocates nothing.
+//
+//   RequestValidator validator(error_accumulator,
+//                              ErrorVisibility::AD_SERVER_VISIBLE);
+//   validator.Check(!config.seller().empty(), kEmptySeller);
+//   validator.Check(IsValidCurrencyCode(currency), [&currency] {
+//     return absl::StrFormat(kInvalidCurrency, currency);
+//   });
+//   return validator.valid();
+class RequestValidator {
+ public:
+  RequestValidator(ErrorReporter& error_reporter,
+                   ErrorVisibility error_visibility,
+                   ErrorCode error_code = ErrorCode::CLIENT_SIDE)
+      : error_reporter_(error_reporter),
+        error_visibility_(error_visibility),
+        error_code_(error_code) {}
+
+  // Reports `message` unless `ok`, from the source location of the caller.
+  // Returns `ok`.
+  template <typename Message>
+  bool Check(log::ParamWithSourceLoc<bool> ok, Message&& message) {
+    if (ok.mandatory_param) {
+      return true;
+    }
+    valid_ = false;
+    if constexpr (std::is_invocable_v<Message>) {
+      error_reporter_.ReportError(ok.location, error_visibility_,
+                                  std::forward<Message>(message)(),
+                                  error_code_);
+    } else {
+      error_reporter_.ReportError(ok.location, error_visibility_,
+                                  absl::string_view(message), error_code_);
+    }
+    return false;
+  }
+
+  // Whether all the checks so far passed.
+  bool valid() const { return valid_; }
+
+ private:
+  ErrorReporter& error_reporter_;
+  const ErrorVisibility error_visibility_;
+  const ErrorCode error_code_;
+  bool valid_ = true;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_VALIDATOR_H_
@@ -0,0 +1,83 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_validator.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/util/error_accumulator.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+static_assert(IsValidCurrencyCode("USD"));
+static_assert(!IsValidCurrencyCode("usd"));
+static_assert(!IsValidCurrencyCode("US"));
+static_assert(!IsValidCurrencyCode("USDX"));
+static_assert(!IsValidCurrencyCode("U$D"));
+static_assert(!IsValidCurrencyCode(""));
+
+TEST(RequestValidatorTest, ReportsFailedChecks) {
+  ErrorAccumulator error_accumulator;
+  RequestValidator validator(error_accumulator,
+                             ErrorVisibility::AD_SERVER_VISIBLE);
+
+  EXPECT_TRUE(validator.Check(true, "not reported"));
+  EXPECT_FALSE(validator.Check(false, "reported"));
+
+  EXPECT_FALSE(validator.valid());
+  EXPECT_THAT(error_accumulator.GetErrors(ErrorVisibility::AD_SERVER_VISIBLE),
+              ElementsAre(
+                  Pair(ErrorCode::CLIENT_SIDE, ElementsAre("reported"))));
+  EXPECT_THAT(error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE),
+              IsEmpty());
+}
+
+TEST(RequestValidatorTest, BuildsMessagesOfFailedChecksOnly) {
+  ErrorAccumulator error_accumulator;
+  RequestValidator validator(error_accumulator, ErrorVisibility::CLIENT_VISIBLE,
+                             ErrorCode::SERVER_SIDE);
+  int num_built = 0;
+  auto message = [&num_built]() {
+    ++num_built;
+    return std::string("built");
+  };
+
+  validator.Check(true, message);
+  validator.Check(false, message);
+
+  EXPECT_EQ(num_built, 1);
+  EXPECT_THAT(error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE),
+              ElementsAre(Pair(ErrorCode::SERVER_SIDE, ElementsAre("built"))));
+}
+
+TEST(RequestValidatorTest, IsValidWithoutFailedChecks) {
+  ErrorAccumulator error_accumulator;
+  RequestValidator validator(error_accumulator,
+                             ErrorVisibility::AD_SERVER_VISIBLE);
+
+  validator.Check(IsValidCurrencyCode("EUR"), "Invalid currency");
+
+  EXPECT_TRUE(validator.valid());
+  EXPECT_FALSE(error_accumulator.HasErrors());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,133 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/server_drain.h"
+
+#include <semaphore.h>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Posted by the SIGTERM handler, which may only make async-signal-safe calls.
+sem_t drain_signal;
+std::atomic<bool> draining = false;
+
+absl::Mutex& DurationsMutex() {
+  static absl::Mutex* mu = new absl::Mutex();
+  return *mu;
+}
+
+absl::flat_hash_map<std::string, double>& Durations()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(DurationsMutex()) {
+  static auto* durations = new absl::flat_hash_map<std::string, double>();
+  return *durations;
+}
+
+void OnTerminate(int) { ServerDrain::Start(); }
+
+void SetDuration(absl::string_view phase, absl::Duration duration) {
+  absl::MutexLock lock(&DurationsMutex());
+  Durations()[phase] = absl::ToDoubleMilliseconds(duration);
+}
+
+}  // namespace
+
+ServerDrain::ServerDrain(DrainOptions options) : options_(std::move(options)) {
+  sem_init(&drain_signal, /*pshared=*/0, /*value=*/0);
+  draining = false;
+  struct sigaction action = {};
+  action.sa_handler = OnTerminate;
+  sigemptyset(&action.sa_mask);
+  // The handler is reset once called, so that a second SIGTERM terminates the
+  // process while it drains.
+  action.sa_flags = SA_RESETHAND;
+  sigaction(SIGTERM, &action, nullptr);
+}
+
+ServerDrain::~ServerDrain() {
+  std::signal(SIGTERM, SIG_DFL);
+  sem_destroy(&drain_signal);
+}
+
+void ServerDrain::AddStep(
+    absl::string_view name,
+    absl::AnyInvocable<void(absl::Time deadline) &&> step) {
+  steps_.push_back({.name = std::string(name), .run = std::move(step)});
+}
+
+void ServerDrain::Wait(grpc::Server& server) {
+  while (sem_wait(&drain_signal) != 0 && errno == EINTR) {
+  }
+  const absl::Time start = absl::Now();
+  ABSL_LOG(INFO) << "Draining the server";
+  {
+    absl::MutexLock lock(&DurationsMutex());
+    Durations().clear();
+  }
+
+  if (grpc::HealthCheckServiceInterface* health_check_service =
+          server.GetHealthCheckService();
+      health_check_service != nullptr) {
+    health_check_service->SetServingStatus(false);
+  }
+  absl::SleepFor(options_.health_check_grace);
+  const absl::Time shutdown_start = absl::Now();
+  SetDuration(kDrainHealthCheckGrace, shutdown_start - start);
+
+  // Stops taking calls, and cancels the ones still in flight at the deadline.
+  const absl::Time deadline = shutdown_start + options_.deadline;
+  server.Shutdown(absl::ToChronoTime(deadline));
+  server.Wait();
+  const absl::Time cleanup_start = absl::Now();
+  ABSL_LOG(INFO) << "Calls in flight done in "
+                 << cleanup_start - shutdown_start;
+  SetDuration(kDrainInFlightCalls, cleanup_start - shutdown_start);
+  SetDuration(kDrainTotal, cleanup_start - start);
+
+  // The durations are updated after every step, so that a step flushing the
+  // telemetry exports those of the steps before it.
+  for (Step& step : steps_) {
+    const absl::Time step_start = absl::Now();
+    std::move(step.run)(deadline);
+    const absl::Time step_end = absl::Now();
+    ABSL_LOG(INFO) << "Drain step " << step.name << " took "
+                   << step_end - step_start;
+    SetDuration(kDrainCleanup, step_end - cleanup_start);
+    SetDuration(kDrainTotal, step_end - start);
+  }
+  steps_.clear();
+  ABSL_LOG(INFO) << "Server drained in " << absl::Now() - start;
+}
+
+void ServerDrain::Start() {
+  draining = true;
+  sem_post(&drain_signal);
+}
+
+bool ServerDrain::Draining() { return draining; }
+
+absl::flat_hash_map<std::string, double> ServerDrain::GetDrainDurationsMs() {
+  absl::MutexLock lock(&DurationsMutex());
+  return Durations();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
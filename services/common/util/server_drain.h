@@ -0,0 +1,107 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_SERVER_DRAIN_H_
+#define SERVICES_COMMON_UTIL_SERVER_DRAIN_H_
+
+#include <string>
+#include <vector>
+
+#include <grpcpp/server.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Labels of the phases returned by ServerDrain::GetDrainDurationsMs.
+inline constexpr absl::string_view kDrainHealthCheckGrace =
+    "health_check_grace";
+inline constexpr absl::string_view kDrainInFlightCalls = "in_flight_calls";
+inline constexpr absl::string_view kDrainCleanup = "cleanup";
+inline constexpr absl::string_view kDrainTotal = "total";
+
+struct DrainOptions {
+  // Time the health check reports the server as not serving before the
+  // server stops taking calls, for the load balancers to stop sending any.
+  absl::Duration health_check_grace = absl::ZeroDuration();
+  // Time the calls in flight have to finish once the server stops taking
+  // calls, after which they are cancelled. The cleanup steps get what is left
+  // of it.
+  absl::Duration deadline = absl::Seconds(30);
+};
+
+// Drains the server when the process gets SIGTERM, so that a rolling deploy
+// does not fail the calls in flight:
+//   1. the health check reports the server as not serving,
+//   2. after the health check grace, the server stops taking calls and waits
+//      for the ones in flight, up to the deadline,
+//   3. the cleanup steps run in the order they were added, e.g. flushing the
+//      reporters, stopping Roma then the inference sidecars, and flushing the
+//      telemetry last so that it exports the drain durations.
+// Logs how long each phase took.
+//
+//   ServerDrain drain(options);
+//   drain.AddStep("reporters", [&](absl::Time deadline) {
+//     reporter.Flush(deadline);
+//   });
+//   drain.Wait(*server);  // Instead of server->Wait().
+//
+// A second SIGTERM while draining terminates the process at once. Only one
+// ServerDrain may exist at a time.
+class ServerDrain {
+ public:
+  // Installs the SIGTERM handler.
+  explicit ServerDrain(DrainOptions options);
+  // Restores the default SIGTERM handler.
+  ~ServerDrain();
+
+  // ServerDrain is neither copyable nor movable.
+  ServerDrain(const ServerDrain&) = delete;
+  ServerDrain& operator=(const ServerDrain&) = delete;
+
+  // Adds a cleanup step, run once the server has shut down with the deadline
+  // of the drain.
+  void AddStep(absl::string_view name,
+               absl::AnyInvocable<void(absl::Time deadline) &&> step);
+
+  // Blocks until SIGTERM, or a call to Start, then drains `server` and runs
+  // the cleanup steps.
+  void Wait(grpc::Server& server);
+
+  // Starts the drain as SIGTERM does.
+  static void Start();
+
+  // Returns true once the drain started, e.g. for readiness listeners not to
+  // report the server as serving again.
+  static bool Draining();
+
+  // Returns the durations of the phases of the last drain that are done.
+  static absl::flat_hash_map<std::string, double> GetDrainDurationsMs();
+
+ private:
+  struct Step {
+    std::string name;
+    absl::AnyInvocable<void(absl::Time deadline) &&> run;
+  };
+
+  const DrainOptions options_;
+  std::vector<Step> steps_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_SERVER_DRAIN_H_
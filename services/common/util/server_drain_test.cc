@@ -0,0 +1,84 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/server_drain.h"
+
+#include <csignal>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpcpp/generic/async_generic_service.h>
+#include <grpcpp/server.h>
+#include <grpcpp/server_builder.h>
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::unique_ptr<grpc::Server> StartServer(
+    grpc::CallbackGenericService& service) {
+  grpc::EnableDefaultHealthCheckService(true);
+  grpc::ServerBuilder builder;
+  builder.RegisterCallbackGenericService(&service);
+  return builder.BuildAndStart();
+}
+
+TEST(ServerDrainTest, RunsStepsInOrderOnceDrained) {
+  grpc::CallbackGenericService service;
+  std::unique_ptr<grpc::Server> server = StartServer(service);
+  ASSERT_NE(server, nullptr);
+  ServerDrain drain({.deadline = absl::Seconds(10)});
+  std::vector<std::string> steps;
+  const absl::Time start = absl::Now();
+  drain.AddStep("reporters", [&steps, start](absl::Time deadline) {
+    EXPECT_GE(deadline, start + absl::Seconds(10));
+    steps.push_back("reporters");
+  });
+  drain.AddStep("roma", [&steps](absl::Time) { steps.push_back("roma"); });
+  EXPECT_FALSE(ServerDrain::Draining());
+
+  std::thread starter([]() { ServerDrain::Start(); });
+  drain.Wait(*server);
+  starter.join();
+
+  EXPECT_TRUE(ServerDrain::Draining());
+  EXPECT_EQ(steps, (std::vector<std::string>{"reporters", "roma"}));
+  auto durations = ServerDrain::GetDrainDurationsMs();
+  EXPECT_TRUE(durations.contains(kDrainHealthCheckGrace));
+  EXPECT_TRUE(durations.contains(kDrainInFlightCalls));
+  EXPECT_TRUE(durations.contains(kDrainCleanup));
+  EXPECT_GE(durations[kDrainTotal], durations[kDrainCleanup]);
+}
+
+TEST(ServerDrainTest, DrainsOnSigterm) {
+  grpc::CallbackGenericService service;
+  std::unique_ptr<grpc::Server> server = StartServer(service);
+  ASSERT_NE(server, nullptr);
+  ServerDrain drain({.health_check_grace = absl::Milliseconds(50)});
+  bool cleaned_up = false;
+  drain.AddStep("cleanup", [&cleaned_up](absl::Time) { cleaned_up = true; });
+
+  std::raise(SIGTERM);
+  drain.Wait(*server);
+
+  EXPECT_TRUE(cleaned_up);
+  EXPECT_GE(ServerDrain::GetDrainDurationsMs()[kDrainHealthCheckGrace], 50);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
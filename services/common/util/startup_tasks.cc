@@ -0,0 +1,91 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/startup_tasks.h"
+
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+StartupTasks::StartupTasks() : start_(absl::Now()) {}
+
+StartupTasks::~StartupTasks() { Wait().IgnoreError(); }
+
+void StartupTasks::Run(absl::string_view name,
+                       const std::vector<absl::string_view>& dependencies,
+                       absl::AnyInvocable<absl::Status() &&> task) {
+  std::vector<Task*> waited;
+  waited.reserve(dependencies.size());
+  for (absl::string_view dependency : dependencies) {
+    Task* found = nullptr;
+    for (const auto& other : tasks_) {
+      if (other->name == dependency) {
+        found = other.get();
+      }
+    }
+    CHECK(found != nullptr)
+        << "Startup task " << name << " depends on " << dependency
+        << ", which was not run before it";
+    waited.push_back(found);
+  }
+
+  auto& run = *tasks_.emplace_back(std::make_unique<Task>());
+  run.name = std::string(name);
+  run.thread = std::thread([this, &run, waited = std::move(waited),
+                            task = std::move(task)]() mutable {
+    for (Task* dependency : waited) {
+      dependency->done.WaitForNotification();
+      if (!dependency->status.ok()) {
+        run.status = absl::AbortedError(absl::StrCat(
+            "Skipped as ", dependency->name, " failed: ",
+            dependency->status.message()));
+        run.done.Notify();
+        return;
+      }
+    }
+    const absl::Time task_start = absl::Now();
+    run.status = std::move(task)();
+    const absl::Time end = absl::Now();
+    ABSL_LOG(INFO) << "Startup task " << run.name << " took "
+                   << end - task_start << ", done " << end - start_
+                   << " into the startup: " << run.status;
+    run.done.Notify();
+  });
+}
+
+absl::Status StartupTasks::Wait() {
+  absl::Status status;
+  bool joined = false;
+  for (const auto& task : tasks_) {
+    if (task->thread.joinable()) {
+      task->thread.join();
+      joined = true;
+    }
+    if (status.ok() && !task->status.ok()) {
+      status = absl::Status(task->status.code(),
+                            absl::StrCat(task->name, ": ",
+                                         task->status.message()));
+    }
+  }
+  if (joined) {
+    ABSL_LOG(INFO) << "Startup tasks done in " << absl::Now() - start_;
+  }
+  return status;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,77 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_STARTUP_TASKS_H_
+#define SERVICES_COMMON_UTIL_STARTUP_TASKS_H_
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Runs the steps of the startup of a server as a graph of tasks, each task on
+// its own thread as soon as the tasks it depends on are done, so that e.g.
+// the Roma workers start while the inference sidecars do. Logs how long each
+// task took, and when it finished relative to the start of the startup.
+//
+//   StartupTasks startup;
+//   startup.Run("Roma", {}, [&]() { return dispatcher.Init(); });
+//   startup.Run("UDF fetch", {"Roma"}, [&]() { return udf_fetcher.Init(); });
+//   PS_RETURN_IF_ERROR(startup.Wait());
+//
+// Not thread-safe: tasks are run and waited for from a single thread.
+class StartupTasks {
+ public:
+  StartupTasks();
+  // Waits for the tasks still running.
+  ~StartupTasks();
+
+  // StartupTasks is neither copyable nor movable.
+  StartupTasks(const StartupTasks&) = delete;
+  StartupTasks& operator=(const StartupTasks&) = delete;
+
+  // Runs `task` once the tasks named in `dependencies`, which must have been
+  // run before, succeeded. The task is skipped if any of them failed.
+  void Run(absl::string_view name,
+           const std::vector<absl::string_view>& dependencies,
+           absl::AnyInvocable<absl::Status() &&> task);
+
+  // Waits for all the tasks run, and returns the error of the first of them
+  // that failed, if any.
+  absl::Status Wait();
+
+ private:
+  struct Task {
+    std::string name;
+    absl::Notification done;
+    // Set before `done` is notified.
+    absl::Status status;
+    std::thread thread;
+  };
+
+  const absl::Time start_;
+  std::vector<std::unique_ptr<Task>> tasks_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_STARTUP_TASKS_H_
@@ -0,0 +1,83 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/startup_tasks.h"
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(StartupTasksTest, RunsIndependentTasksConcurrently) {
+  absl::Notification a_started;
+  absl::Notification b_started;
+  StartupTasks startup;
+  // Each task waits for the other one to start, so that they only both
+  // finish if they run concurrently.
+  startup.Run("a", {}, [&]() {
+    a_started.Notify();
+    b_started.WaitForNotification();
+    return absl::OkStatus();
+  });
+  startup.Run("b", {}, [&]() {
+    b_started.Notify();
+    a_started.WaitForNotification();
+    return absl::OkStatus();
+  });
+
+  EXPECT_TRUE(startup.Wait().ok());
+}
+
+TEST(StartupTasksTest, RunsTasksAfterTheirDependencies) {
+  bool a_done = false;
+  bool a_done_before_b = false;
+  StartupTasks startup;
+  startup.Run("a", {}, [&]() {
+    a_done = true;
+    return absl::OkStatus();
+  });
+  startup.Run("b", {"a"}, [&]() {
+    a_done_before_b = a_done;
+    return absl::OkStatus();
+  });
+
+  EXPECT_TRUE(startup.Wait().ok());
+  EXPECT_TRUE(a_done_before_b);
+}
+
+TEST(StartupTasksTest, SkipsDependentsOfFailedTasks) {
+  bool b_ran = false;
+  bool c_ran = false;
+  StartupTasks startup;
+  startup.Run("a", {}, []() { return absl::InternalError("no workers"); });
+  startup.Run("b", {"a"}, [&]() {
+    b_ran = true;
+    return absl::OkStatus();
+  });
+  startup.Run("c", {}, [&]() {
+    c_ran = true;
+    return absl::OkStatus();
+  });
+
+  absl::Status status = startup.Wait();
+  EXPECT_EQ(status.code(), absl::StatusCode::kInternal);
+  EXPECT_EQ(status.message(), "a: no workers");
+  EXPECT_FALSE(b_ran);
+  EXPECT_TRUE(c_ran);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,53 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/string_interner.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::string_view StringInterner::Intern(absl::string_view value) {
+  if (auto it = interned_.find(value); it != interned_.end()) {
+    return *it;
+  }
+  absl::string_view copy = Copy(value);
+  interned_.insert(copy);
+  return copy;
+}
+
+absl::string_view StringInterner::Find(absl::string_view value) const {
+  auto it = interned_.find(value);
+  return it == interned_.end() ? absl::string_view() : *it;
+}
+
+absl::string_view StringInterner::Copy(absl::string_view value) {
+  if (value.empty()) {
+    return "";
+  }
+  if (value.size() > free_size_) {
+    const size_t size = std::max(block_size_, value.size());
+    blocks_.push_back(std::make_unique<char[]>(size));
+    free_ = blocks_.back().get();
+    free_size_ = size;
+  }
+  std::memcpy(free_, value.data(), value.size());
+  absl::string_view copy(free_, value.size());
+  free_ += value.size();
+  free_size_ -= value.size();
+  return copy;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
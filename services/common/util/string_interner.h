@@ -0,0 +1,68 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_STRING_INTERNER_H_
+#define SERVICES_COMMON_UTIL_STRING_INTERNER_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Holds a single copy of each distinct string interned, for the lifetime of
+// a request. Strings repeated across a request, such as the interest group
+// owners, interest group names, render URLs and dispatch ids of its ads, are
+// then held once however many maps key on them: the maps key on the views
+// returned instead of on copies.
+//
+// The views stay valid until the interner is destroyed. Two strings interned
+// are equal iff their views point to the same characters. Not thread-safe.
+class StringInterner {
+ public:
+  // block_size: bytes allocated at once to hold the strings. Strings longer
+  // than that get a block of their own.
+  explicit StringInterner(size_t block_size = 4096) : block_size_(block_size) {}
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  // Returns the copy of `value` held by the interner, made on the first call.
+  absl::string_view Intern(absl::string_view value);
+
+  // Returns the copy of `value` held by the interner, or an empty view if it
+  // was never interned.
+  absl::string_view Find(absl::string_view value) const;
+
+  // Number of distinct strings interned.
+  size_t size() const { return interned_.size(); }
+
+ private:
+  // Copies `value` to the arena.
+  absl::string_view Copy(absl::string_view value);
+
+  const size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  // Bytes left at the end of the last block.
+  char* free_ = nullptr;
+  size_t free_size_ = 0;
+  absl::flat_hash_set<absl::string_view> interned_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_STRING_INTERNER_H_
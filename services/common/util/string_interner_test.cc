@@ -0,0 +1,61 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/string_interner.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(StringInternerTest, HoldsOneCopyOfEachString) {
+  StringInterner interner;
+  std::string owner = "https://buyer.com";
+  absl::string_view first = interner.Intern(owner);
+  owner[8] = 'X';
+  EXPECT_EQ(first, "https://buyer.com");
+  absl::string_view second = interner.Intern("https://buyer.com");
+  EXPECT_EQ(first.data(), second.data());
+  EXPECT_NE(interner.Intern(owner).data(), first.data());
+  EXPECT_EQ(interner.size(), 2);
+}
+
+TEST(StringInternerTest, FindsOnlyInternedStrings) {
+  StringInterner interner;
+  absl::string_view interned = interner.Intern("ig_name");
+  EXPECT_EQ(interner.Find("ig_name").data(), interned.data());
+  EXPECT_TRUE(interner.Find("other").empty());
+}
+
+TEST(StringInternerTest, KeepsViewsValidAcrossBlocks) {
+  StringInterner interner(/*block_size=*/16);
+  std::vector<absl::string_view> interned;
+  for (int i = 0; i < 100; ++i) {
+    interned.push_back(interner.Intern(absl::StrCat("render_url_", i)));
+  }
+  interned.push_back(interner.Intern(std::string(64, 'a')));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(interned[i], absl::StrCat("render_url_", i));
+  }
+  EXPECT_EQ(interned.back(), std::string(64, 'a'));
+  EXPECT_EQ(interner.Intern("").size(), 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/tcmalloc_tuner.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "services/common/util/file_util.h"
+#include "src/logger/request_context_logger.h"
+#include "tcmalloc/malloc_extension.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Shares of the max total thread cache bytes above which the thread caches
+// are full, and below which they are mostly empty.
+constexpr double kFullThreadCacheShare = 0.9;
+constexpr double kIdleThreadCacheShare = 0.25;
+
+// cgroup v1 reports a limit close to the max int64 for unlimited memory.
+constexpr int64_t kUnlimitedCgroupMemory = int64_t{1} << 62;
+
+constexpr char kCgroupV2MemoryLimitPath[] = "/sys/fs/cgroup/memory.max";
+constexpr char kCgroupV1MemoryLimitPath[] =
+    "/sys/fs/cgroup/memory/memory.limit_in_bytes";
+
+// Settings and decisions of the tuner of the process, for the metrics.
+std::atomic<bool> tuning = false;
+std::atomic<int64_t> tuned_thread_cache_bytes = 0;
+std::atomic<int64_t> tuned_release_rate = 0;
+std::atomic<double> memory_headroom = -1;
+// Steps that changed the settings since the last GetStats call.
+std::atomic<int64_t> num_reclaims = 0;
+std::atomic<int64_t> num_cache_grows = 0;
+std::atomic<int64_t> num_cache_shrinks = 0;
+
+int64_t Clamp(int64_t value, int64_t min, int64_t max) {
+  return std::min(std::max(value, min), max);
+}
+
+int64_t Grow(int64_t value, int64_t min, int64_t max) {
+  return Clamp(std::max<int64_t>(value * 2, 1), min, max);
+}
+
+int64_t Shrink(int64_t value, int64_t min, int64_t max) {
+  return Clamp(value / 2, min, max);
+}
+
+int64_t GetNumericProperty(absl::string_view property) {
+  return tcmalloc::MallocExtension::GetNumericProperty(property).value_or(0);
+}
+
+int64_t ReadCgroupMemoryLimit() {
+  for (const char* path :
+       {kCgroupV2MemoryLimitPath, kCgroupV1MemoryLimitPath}) {
+    if (absl::StatusOr<std::string> content = GetFileContent(path);
+        content.ok()) {
+      return ParseCgroupMemoryLimit(*content);
+    }
+  }
+  return 0;
+}
+
+TcmallocSample ReadSample(int64_t memory_limit_bytes) {
+  return {
+      .physical_memory_bytes =
+          GetNumericProperty("generic.physical_memory_used"),
+      .memory_limit_bytes = memory_limit_bytes,
+      .page_heap_free_bytes =
+          GetNumericProperty("tcmalloc.pageheap_free_bytes"),
+      .thread_cache_bytes =
+          GetNumericProperty("tcmalloc.current_total_thread_cache_bytes"),
+  };
+}
+
+void Apply(const TcmallocSettings& settings) {
+  tcmalloc::MallocExtension::SetMaxTotalThreadCacheBytes(
+      settings.max_thread_cache_bytes);
+  tcmalloc::MallocExtension::SetBackgroundReleaseRate(
+      static_cast<tcmalloc::MallocExtension::BytesPerSecond>(
+          settings.release_rate_bytes_per_second));
+  tuned_thread_cache_bytes.store(settings.max_thread_cache_bytes,
+                                 std::memory_order_relaxed);
+  tuned_release_rate.store(settings.release_rate_bytes_per_second,
+                           std::memory_order_relaxed);
+}
+
+}  // namespace
+
+TcmallocTuningStep TuneTcmalloc(const TcmallocTuningOptions& options,
+                                const TcmallocSettings& current,
+                                const TcmallocSample& sample) {
+  const int64_t cache = current.max_thread_cache_bytes;
+  const int64_t release = current.release_rate_bytes_per_second;
+  const auto grow_cache = [&]() {
+    return Grow(cache, options.min_thread_cache_bytes,
+                options.max_thread_cache_bytes);
+  };
+  const auto shrink_cache = [&]() {
+    return Shrink(cache, options.min_thread_cache_bytes,
+                  options.max_thread_cache_bytes);
+  };
+  const auto faster_release = [&]() {
+    return Grow(release, options.min_release_rate_bytes_per_second,
+                options.max_release_rate_bytes_per_second);
+  };
+  const auto slower_release = [&]() {
+    return Shrink(release, options.min_release_rate_bytes_per_second,
+                  options.max_release_rate_bytes_per_second);
+  };
+
+  if (sample.memory_limit_bytes > 0 &&
+      sample.memory_limit_bytes - sample.physical_memory_bytes <
+          options.min_memory_headroom * sample.memory_limit_bytes) {
+    return {TcmallocTuningDecision::kReclaim,
+            {shrink_cache(), faster_release()}};
+  }
+  if (sample.thread_cache_bytes >= kFullThreadCacheShare * cache) {
+    return {TcmallocTuningDecision::kGrowCaches,
+            {grow_cache(), slower_release()}};
+  }
+  if (sample.thread_cache_bytes < kIdleThreadCacheShare * cache) {
+    return {TcmallocTuningDecision::kShrinkCaches,
+            {shrink_cache(), faster_release()}};
+  }
+  return {TcmallocTuningDecision::kHold, current};
+}
+
+int64_t ParseCgroupMemoryLimit(absl::string_view content) {
+  int64_t limit = 0;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(content), &limit) ||
+      limit <= 0 || limit >= kUnlimitedCgroupMemory) {
+    // "max" for cgroup v2.
+    return 0;
+  }
+  return limit;
+}
+
+TcmallocTuner::TcmallocTuner(const TcmallocTuningOptions& options)
+    : options_(options) {
+  // Starts from the settings of TCMalloc, brought within the bounds.
+  settings_ = {
+      .max_thread_cache_bytes =
+          Clamp(tcmalloc::MallocExtension::GetMaxTotalThreadCacheBytes(),
+                options_.min_thread_cache_bytes,
+                options_.max_thread_cache_bytes),
+      .release_rate_bytes_per_second =
+          Clamp(static_cast<int64_t>(
+                    tcmalloc::MallocExtension::GetBackgroundReleaseRate()),
+                options_.min_release_rate_bytes_per_second,
+                options_.max_release_rate_bytes_per_second),
+  };
+  Apply(settings_);
+  tuning.store(true, std::memory_order_relaxed);
+  worker_ = std::thread([this]() { Run(); });
+}
+
+TcmallocTuner::~TcmallocTuner() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  worker_.join();
+}
+
+bool TcmallocTuner::Wait(absl::Duration duration) {
+  absl::MutexLock lock(&mu_);
+  mu_.AwaitWithTimeout(absl::Condition(&stopping_), duration);
+  return !stopping_;
+}
+
+void TcmallocTuner::Run() {
+  const int64_t memory_limit_bytes = options_.memory_limit_bytes > 0
+                                         ? options_.memory_limit_bytes
+                                         : ReadCgroupMemoryLimit();
+  PS_LOG(INFO) << "Tuning TCMalloc every " << options_.interval
+               << " with a memory limit of " << memory_limit_bytes
+               << " bytes";
+  while (Wait(options_.interval)) {
+    Tune(memory_limit_bytes);
+  }
+}
+
+void TcmallocTuner::Tune(int64_t memory_limit_bytes) {
+  const TcmallocSample sample = ReadSample(memory_limit_bytes);
+  if (sample.memory_limit_bytes > 0) {
+    memory_headroom.store(
+        std::max(1.0 - static_cast<double>(sample.physical_memory_bytes) /
+                           sample.memory_limit_bytes,
+                 0.0),
+        std::memory_order_relaxed);
+  }
+  const TcmallocTuningStep step = TuneTcmalloc(options_, settings_, sample);
+  if (step.decision == TcmallocTuningDecision::kReclaim &&
+      sample.page_heap_free_bytes > 0) {
+    tcmalloc::MallocExtension::ReleaseMemoryToSystem(
+        sample.page_heap_free_bytes);
+  }
+  if (step.settings.max_thread_cache_bytes ==
+          settings_.max_thread_cache_bytes &&
+      step.settings.release_rate_bytes_per_second ==
+          settings_.release_rate_bytes_per_second) {
+    return;
+  }
+  PS_VLOG(4) << "Tuned TCMalloc to a max total thread cache of "
+             << step.settings.max_thread_cache_bytes
+             << " bytes and a release rate of "
+             << step.settings.release_rate_bytes_per_second
+             << " bytes per second";
+  settings_ = step.settings;
+  Apply(settings_);
+  switch (step.decision) {
+    case TcmallocTuningDecision::kReclaim:
+      num_reclaims.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case TcmallocTuningDecision::kGrowCaches:
+      num_cache_grows.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case TcmallocTuningDecision::kShrinkCaches:
+      num_cache_shrinks.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case TcmallocTuningDecision::kHold:
+      break;
+  }
+}
+
+absl::flat_hash_map<std::string, double> TcmallocTuner::GetStats() {
+  if (!tuning.load(std::memory_order_relaxed)) {
+    return {};
+  }
+  absl::flat_hash_map<std::string, double> stats = {
+      {"max_thread_cache_bytes",
+       tuned_thread_cache_bytes.load(std::memory_order_relaxed)},
+      {"release_rate_bytes_per_second",
+       tuned_release_rate.load(std::memory_order_relaxed)},
+      {"reclaim_steps", num_reclaims.exchange(0, std::memory_order_relaxed)},
+      {"cache_grow_steps",
+       num_cache_grows.exchange(0, std::memory_order_relaxed)},
+      {"cache_shrink_steps",
+       num_cache_shrinks.exchange(0, std::memory_order_relaxed)},
+  };
+  if (const double headroom = memory_headroom.load(std::memory_order_relaxed);
+      headroom >= 0) {
+    stats["memory_headroom"] = headroom;
+  }
+  return stats;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_TCMALLOC_TUNER_H_
+#define SERVICES_COMMON_UTIL_TCMALLOC_TUNER_H_
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct TcmallocTuningOptions {
+  // Time between two tuning steps.
+  absl::Duration interval = absl::Seconds(10);
+  // Bounds of the max total thread cache bytes of TCMalloc.
+  int64_t min_thread_cache_bytes = 16 << 20;
+  int64_t max_thread_cache_bytes = 256 << 20;
+  // Bounds of the background release rate of TCMalloc, in bytes per second.
+  int64_t min_release_rate_bytes_per_second = 1 << 20;
+  int64_t max_release_rate_bytes_per_second = 64 << 20;
+  // Memory limit of the container, read from its cgroup if 0. The memory
+  // headroom is not tuned for if the limit is unknown.
+  int64_t memory_limit_bytes = 0;
+  // Share of the memory limit under which memory is reclaimed.
+  double min_memory_headroom = 0.2;
+};
+
+// Readings of the allocator and of the container a tuning step is decided on.
+struct TcmallocSample {
+  // Memory of the process backed by physical pages, as counted against the
+  // memory limit of the container.
+  int64_t physical_memory_bytes = 0;
+  // Memory limit of the container, or 0 if unknown.
+  int64_t memory_limit_bytes = 0;
+  // Free memory of the page heap, not yet released to the OS.
+  int64_t page_heap_free_bytes = 0;
+  // Memory held by the thread caches.
+  int64_t thread_cache_bytes = 0;
+};
+
+struct TcmallocSettings {
+  int64_t max_thread_cache_bytes = 0;
+  int64_t release_rate_bytes_per_second = 0;
+};
+
+enum class TcmallocTuningDecision {
+  kHold,
+  // The memory headroom is low: the caches shrink and memory is released
+  // faster, including the free memory of the page heap right away.
+  kReclaim,
+  // The thread caches are full, so allocations and frees take the slow path
+  // to the central free lists: the caches grow and memory is released
+  // slower.
+  kGrowCaches,
+  // The thread caches are mostly empty: they shrink and memory is released
+  // faster, so that idle servers give memory back.
+  kShrinkCaches,
+};
+
+struct TcmallocTuningStep {
+  TcmallocTuningDecision decision = TcmallocTuningDecision::kHold;
+  TcmallocSettings settings;
+};
+
+// Decides the settings of the next interval from the current ones and the
+// latest sample. Settings are doubled or halved in a step, within the bounds
+// of the options.
+TcmallocTuningStep TuneTcmalloc(const TcmallocTuningOptions& options,
+                                const TcmallocSettings& current,
+                                const TcmallocSample& sample);
+
+// Parses the memory limit of a cgroup, e.g. the content of memory.max.
+// Returns 0 if the memory is not limited.
+int64_t ParseCgroupMemoryLimit(absl::string_view content);
+
+// Periodically samples TCMalloc and the memory of the container from a
+// background thread, and adjusts the max total thread cache bytes and the
+// background release rate of TCMalloc, starting from the current ones.
+class TcmallocTuner {
+ public:
+  explicit TcmallocTuner(const TcmallocTuningOptions& options);
+
+  // Stops tuning. The settings are left as last tuned.
+  ~TcmallocTuner();
+
+  // TcmallocTuner is neither copyable nor movable.
+  TcmallocTuner(const TcmallocTuner&) = delete;
+  TcmallocTuner& operator=(const TcmallocTuner&) = delete;
+
+  // Returns the settings of the tuner and the memory headroom last sampled,
+  // and the number of steps of each decision that changed the settings since
+  // the last call. Empty if no tuner ran.
+  static absl::flat_hash_map<std::string, double> GetStats();
+
+ private:
+  // Tunes every interval until the tuner is destroyed.
+  void Run() ABSL_LOCKS_EXCLUDED(mu_);
+  // Waits for `duration` and returns false if the tuner is stopping.
+  bool Wait(absl::Duration duration) ABSL_LOCKS_EXCLUDED(mu_);
+  // Samples, and applies the settings decided on if they changed.
+  void Tune(int64_t memory_limit_bytes);
+
+  const TcmallocTuningOptions options_;
+  TcmallocSettings settings_;
+
+  absl::Mutex mu_;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread worker_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_TCMALLOC_TUNER_H_
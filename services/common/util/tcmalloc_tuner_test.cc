@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/tcmalloc_tuner.h"
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int64_t kMb = 1 << 20;
+
+TcmallocTuningOptions Options() {
+  return {.min_thread_cache_bytes = 16 * kMb,
+          .max_thread_cache_bytes = 128 * kMb,
+          .min_release_rate_bytes_per_second = 1 * kMb,
+          .max_release_rate_bytes_per_second = 32 * kMb,
+          .min_memory_headroom = 0.2};
+}
+
+constexpr TcmallocSettings kSettings = {
+    .max_thread_cache_bytes = 64 * kMb,
+    .release_rate_bytes_per_second = 8 * kMb};
+
+TEST(TuneTcmallocTest, ReclaimsMemoryWhenHeadroomIsLow) {
+  const TcmallocTuningStep step =
+      TuneTcmalloc(Options(), kSettings,
+                   {.physical_memory_bytes = 900 * kMb,
+                    .memory_limit_bytes = 1000 * kMb,
+                    // Full caches do not matter under memory pressure.
+                    .thread_cache_bytes = 64 * kMb});
+  EXPECT_EQ(step.decision, TcmallocTuningDecision::kReclaim);
+  EXPECT_EQ(step.settings.max_thread_cache_bytes, 32 * kMb);
+  EXPECT_EQ(step.settings.release_rate_bytes_per_second, 16 * kMb);
+}
+
+TEST(TuneTcmallocTest, GrowsFullCaches) {
+  const TcmallocTuningStep step =
+      TuneTcmalloc(Options(), kSettings,
+                   {.physical_memory_bytes = 500 * kMb,
+                    .memory_limit_bytes = 1000 * kMb,
+                    .thread_cache_bytes = 60 * kMb});
+  EXPECT_EQ(step.decision, TcmallocTuningDecision::kGrowCaches);
+  EXPECT_EQ(step.settings.max_thread_cache_bytes, 128 * kMb);
+  EXPECT_EQ(step.settings.release_rate_bytes_per_second, 4 * kMb);
+}
+
+TEST(TuneTcmallocTest, ShrinksIdleCaches) {
+  const TcmallocTuningStep step = TuneTcmalloc(
+      Options(), kSettings,
+      {.physical_memory_bytes = 100 * kMb, .thread_cache_bytes = 1 * kMb});
+  EXPECT_EQ(step.decision, TcmallocTuningDecision::kShrinkCaches);
+  EXPECT_EQ(step.settings.max_thread_cache_bytes, 32 * kMb);
+  EXPECT_EQ(step.settings.release_rate_bytes_per_second, 16 * kMb);
+}
+
+TEST(TuneTcmallocTest, HoldsBusyCaches) {
+  const TcmallocTuningStep step = TuneTcmalloc(
+      Options(), kSettings,
+      {.physical_memory_bytes = 100 * kMb, .thread_cache_bytes = 32 * kMb});
+  EXPECT_EQ(step.decision, TcmallocTuningDecision::kHold);
+  EXPECT_EQ(step.settings.max_thread_cache_bytes, 64 * kMb);
+  EXPECT_EQ(step.settings.release_rate_bytes_per_second, 8 * kMb);
+}
+
+TEST(TuneTcmallocTest, StaysWithinBounds) {
+  TcmallocSettings settings = kSettings;
+  for (int i = 0; i < 10; ++i) {
+    settings = TuneTcmalloc(Options(), settings,
+                            {.thread_cache_bytes = 1024 * kMb})
+                   .settings;
+  }
+  EXPECT_EQ(settings.max_thread_cache_bytes, 128 * kMb);
+  EXPECT_EQ(settings.release_rate_bytes_per_second, 1 * kMb);
+  for (int i = 0; i < 10; ++i) {
+    settings = TuneTcmalloc(Options(), settings, {}).settings;
+  }
+  EXPECT_EQ(settings.max_thread_cache_bytes, 16 * kMb);
+  EXPECT_EQ(settings.release_rate_bytes_per_second, 32 * kMb);
+}
+
+TEST(ParseCgroupMemoryLimitTest, ParsesLimits) {
+  EXPECT_EQ(ParseCgroupMemoryLimit("1073741824\n"), 1073741824);
+  EXPECT_EQ(ParseCgroupMemoryLimit("max\n"), 0);
+  EXPECT_EQ(ParseCgroupMemoryLimit("9223372036854771712\n"), 0);
+  EXPECT_EQ(ParseCgroupMemoryLimit(""), 0);
+}
+
+TEST(TcmallocTunerTest, ExportsItsSettings) {
+  {
+    TcmallocTuner tuner(
+        {.interval = absl::Milliseconds(1), .memory_limit_bytes = 1 << 30});
+    absl::SleepFor(absl::Milliseconds(20));
+  }
+  const absl::flat_hash_map<std::string, double> stats =
+      TcmallocTuner::GetStats();
+  EXPECT_GE(stats.at("max_thread_cache_bytes"), 16 << 20);
+  EXPECT_LE(stats.at("max_thread_cache_bytes"), 256 << 20);
+  EXPECT_GE(stats.at("release_rate_bytes_per_second"), 1 << 20);
+  EXPECT_TRUE(stats.contains("memory_headroom"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
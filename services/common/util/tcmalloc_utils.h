@@ -19,6 +19,10 @@
 
 #include <cstdint>
 #include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
 
 #include "src/logger/request_context_logger.h"
 #include "tcmalloc/malloc_extension.h"
@@ -54,6 +58,30 @@ inline void MaySetMaxTotalThreadCacheBytes(
       *max_total_thread_cache_bytes);
 }
 
+// Returns the heap metrics of TCMalloc in bytes, by attribute.
+inline absl::flat_hash_map<std::string, double> GetMallocStats() {
+  static constexpr std::pair<const char*, const char*> kProperties[] = {
+      {"allocated", "generic.current_allocated_bytes"},
+      {"heap", "generic.heap_size"},
+      {"page_heap_free", "tcmalloc.pageheap_free_bytes"},
+      {"page_heap_unmapped", "tcmalloc.pageheap_unmapped_bytes"},
+      {"thread_cache", "tcmalloc.current_total_thread_cache_bytes"},
+      {"cpu_cache", "tcmalloc.cpu_free"},
+  };
+  absl::flat_hash_map<std::string, double> stats;
+  for (const auto& [attribute, property] : kProperties) {
+    if (std::optional<size_t> value =
+            tcmalloc::MallocExtension::GetNumericProperty(property)) {
+      stats[attribute] = *value;
+    }
+  }
+  // Memory held by TCMalloc but not allocated by the server.
+  if (stats.contains("heap") && stats.contains("allocated")) {
+    stats["fragmentation"] = stats["heap"] - stats["allocated"];
+  }
+  return stats;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_UTIL_TCMALLOC_UTILS_H_
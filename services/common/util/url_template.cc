@@ -0,0 +1,132 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/url_template.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+UrlTemplate::UrlTemplate(absl::string_view url,
+                         absl::Span<const absl::string_view> placeholders)
+    : url_(url) {
+  const absl::string_view view = url_;
+  size_t literal_start = 0;
+  size_t pos = 0;
+  while (pos < view.size()) {
+    // Find the leftmost occurrence of any placeholder, preferring the first
+    // listed placeholder on ties.
+    size_t match_pos = absl::string_view::npos;
+    int match = -1;
+    for (int i = 0; i < placeholders.size(); ++i) {
+      if (placeholders[i].empty()) {
+        continue;
+      }
+      size_t found = view.find(placeholders[i], pos);
+      if (found < match_pos) {
+        match_pos = found;
+        match = i;
+      }
+    }
+    if (match < 0) {
+      break;
+    }
+    if (match_pos > literal_start) {
+      segments_.push_back({.placeholder = -1,
+                           .offset = literal_start,
+                           .length = match_pos - literal_start});
+      literal_length_ += match_pos - literal_start;
+    }
+    segments_.push_back({.placeholder = match, .offset = 0, .length = 0});
+    pos = match_pos + placeholders[match].size();
+    literal_start = pos;
+  }
+  if (literal_start < view.size()) {
+    segments_.push_back({.placeholder = -1,
+                         .offset = literal_start,
+                         .length = view.size() - literal_start});
+    literal_length_ += view.size() - literal_start;
+  }
+}
+
+std::string UrlTemplate::Render(
+    absl::Span<const absl::string_view> values) const {
+  size_t length = literal_length_;
+  for (const Segment& segment : segments_) {
+    if (segment.placeholder >= 0) {
+      length += values[segment.placeholder].size();
+    }
+  }
+  std::string rendered;
+  rendered.reserve(length);
+  for (const Segment& segment : segments_) {
+    if (segment.placeholder >= 0) {
+      const absl::string_view value = values[segment.placeholder];
+      rendered.append(value.data(), value.size());
+    } else {
+      rendered.append(url_, segment.offset, segment.length);
+    }
+  }
+  return rendered;
+}
+
+bool UrlTemplate::HasPlaceholder(int index) const {
+  for (const Segment& segment : segments_) {
+    if (segment.placeholder == index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+UrlTemplateCache::UrlTemplateCache(int capacity,
+                                   std::vector<absl::string_view> placeholders)
+    : capacity_(capacity), placeholders_(std::move(placeholders)) {}
+
+std::shared_ptr<const UrlTemplate> UrlTemplateCache::GetOrParse(
+    absl::string_view url) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = index_.find(url); it != index_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return it->second->url_template;
+    }
+  }
+
+  // Parse outside of the lock, concurrent misses for the same URL are rare
+  // and only result in redundant work.
+  auto url_template = std::make_shared<const UrlTemplate>(url, placeholders_);
+  if (capacity_ <= 0) {
+    return url_template;
+  }
+  absl::MutexLock lock(&mu_);
+  if (auto it = index_.find(url); it != index_.end()) {
+    return it->second->url_template;
+  }
+  entries_.push_front({.url = std::string(url), .url_template = url_template});
+  // Keyed by the URL owned by the entry, which list nodes keep in place.
+  index_[entries_.front().url] = entries_.begin();
+  if (entries_.size() > static_cast<size_t>(capacity_)) {
+    index_.erase(entries_.back().url);
+    entries_.pop_back();
+  }
+  return url_template;
+}
+
+int UrlTemplateCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
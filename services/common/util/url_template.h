@@ -0,0 +1,93 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_URL_TEMPLATE_H_
+#define SERVICES_COMMON_UTIL_URL_TEMPLATE_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// A URL parsed once into literal and placeholder segments, so that it can be
+// rendered with different placeholder values without scanning the URL again.
+// Like absl::StrReplaceAll, placeholders are matched left to right and the
+// rendered values are not scanned for placeholders.
+class UrlTemplate {
+ public:
+  // Parses `url` for occurrences of `placeholders`, e.g. "${winningBid}".
+  UrlTemplate(absl::string_view url,
+              absl::Span<const absl::string_view> placeholders);
+
+  // Returns the URL with every placeholder replaced by the value at its index
+  // in `values`, which must have one value per placeholder of the template.
+  std::string Render(absl::Span<const absl::string_view> values) const;
+
+  // Returns true if the URL contains the placeholder at `index`.
+  bool HasPlaceholder(int index) const;
+
+ private:
+  struct Segment {
+    // Index of the placeholder, or -1 for a literal.
+    int placeholder;
+    // Offset and length of the literal in url_.
+    size_t offset;
+    size_t length;
+  };
+
+  std::string url_;
+  std::vector<Segment> segments_;
+  // Total length of the literal segments.
+  size_t literal_length_ = 0;
+};
+
+// Thread-safe LRU cache of URL templates shared across auctions, since many
+// interest groups of a buyer use the same reporting URLs.
+class UrlTemplateCache {
+ public:
+  // `capacity` is the max number of templates held by the cache. The
+  // placeholders must outlive the cache.
+  UrlTemplateCache(int capacity, std::vector<absl::string_view> placeholders);
+
+  // Returns the template for the URL, parsed on a cache miss.
+  std::shared_ptr<const UrlTemplate> GetOrParse(absl::string_view url);
+
+  // Returns the number of templates currently cached.
+  int size() const;
+
+ private:
+  struct Entry {
+    std::string url;
+    std::shared_ptr<const UrlTemplate> url_template;
+  };
+
+  const int capacity_;
+  const std::vector<absl::string_view> placeholders_;
+  mutable absl::Mutex mu_;
+  // Most recently used entries first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_URL_TEMPLATE_H_
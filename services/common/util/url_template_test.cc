@@ -0,0 +1,82 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/url_template.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kPlaceholders[] = {"${a}", "${bc}"};
+
+TEST(UrlTemplateTest, RendersPlaceholders) {
+  UrlTemplate url_template("https://a.com?x=${a}&y=${bc}&z=${a}",
+                           kPlaceholders);
+  const absl::string_view values[] = {"1", "22"};
+  EXPECT_EQ(url_template.Render(values), "https://a.com?x=1&y=22&z=1");
+  EXPECT_TRUE(url_template.HasPlaceholder(0));
+  EXPECT_TRUE(url_template.HasPlaceholder(1));
+}
+
+TEST(UrlTemplateTest, RendersUrlWithoutPlaceholders) {
+  UrlTemplate url_template("https://a.com?x=${unknown}", kPlaceholders);
+  const absl::string_view values[] = {"1", "22"};
+  EXPECT_EQ(url_template.Render(values), "https://a.com?x=${unknown}");
+  EXPECT_FALSE(url_template.HasPlaceholder(0));
+}
+
+TEST(UrlTemplateTest, RendersAdjacentPlaceholders) {
+  UrlTemplate url_template("${bc}${a}", kPlaceholders);
+  const absl::string_view values[] = {"1", ""};
+  EXPECT_EQ(url_template.Render(values), "1");
+}
+
+TEST(UrlTemplateTest, DoesNotRescanRenderedValues) {
+  UrlTemplate url_template("x=${a}", kPlaceholders);
+  const absl::string_view values[] = {"${bc}", "22"};
+  EXPECT_EQ(url_template.Render(values), "x=${bc}");
+}
+
+TEST(UrlTemplateCacheTest, ReturnsCachedTemplate) {
+  UrlTemplateCache cache(/*capacity=*/2, {"${a}"});
+  std::shared_ptr<const UrlTemplate> first = cache.GetOrParse("x=${a}");
+  EXPECT_EQ(cache.GetOrParse("x=${a}"), first);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(UrlTemplateCacheTest, EvictsLeastRecentlyUsedTemplate) {
+  UrlTemplateCache cache(/*capacity=*/2, {"${a}"});
+  std::shared_ptr<const UrlTemplate> first = cache.GetOrParse("1=${a}");
+  std::shared_ptr<const UrlTemplate> second = cache.GetOrParse("2=${a}");
+  cache.GetOrParse("1=${a}");
+  cache.GetOrParse("3=${a}");
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_EQ(cache.GetOrParse("1=${a}"), first);
+  EXPECT_NE(cache.GetOrParse("2=${a}"), second);
+}
+
+TEST(UrlTemplateCacheTest, DoesNotCacheWithoutCapacity) {
+  UrlTemplateCache cache(/*capacity=*/0, {"${a}"});
+  const absl::string_view values[] = {"1"};
+  EXPECT_EQ(cache.GetOrParse("x=${a}")->Render(values), "x=1");
+  EXPECT_EQ(cache.size(), 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -34,16 +34,20 @@
 // * `Latency`: Average time spent per Iteration.
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "benchmark/benchmark.h"
 #include "benchmark/request_utils.h"
 #include "modules/module_interface.h"
 #include "proto/inference_sidecar.pb.h"
 #include "utils/file_util.h"
+#include "utils/request_parser.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
@@ -136,6 +140,28 @@ BENCHMARK_DEFINE_F(ModuleFixture, BM_Register)(benchmark::State& state) {
   ExportMetrics(state);
 }
 
+// Measures the parsing of a JSON request with a FLOAT tensor of
+// `state.range(0)` values into the raw values handed to the module.
+static void BM_ParseTensorContent(benchmark::State& state) {
+  std::vector<std::string> values;
+  values.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); ++i) {
+    values.push_back(absl::StrCat("\"", i % 1000 * 0.001, "\""));
+  }
+  const std::string input = absl::StrCat(
+      R"({"request": [{"model_path": "test_model", "tensors": [{)",
+      R"("data_type": "FLOAT", "tensor_shape": [)", state.range(0),
+      R"(], "tensor_content": [)", absl::StrJoin(values, ","), "]}]}]}");
+  for (auto _ : state) {
+    absl::StatusOr<std::vector<InferenceRequest>> requests =
+        ParseJsonInferenceRequest(input);
+    CHECK(requests.ok()) << requests.status().message();
+    benchmark::DoNotOptimize(requests);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
 // Registers the functions to the benchmark.
 BENCHMARK_REGISTER_F(ModuleFixture, BM_Register)
     ->ThreadRange(1, kRegisterMaxThreads)
@@ -145,6 +171,7 @@ BENCHMARK_REGISTER_F(ModuleFixture, BM_Predict)
     ->ThreadRange(1, kMaxThreads)
     ->MeasureProcessCPUTime()
     ->UseRealTime();
+BENCHMARK(BM_ParseTensorContent)->RangeMultiplier(10)->Range(1000, 1000000);
 
 // Runs the benchmark.
 BENCHMARK_MAIN();
@@ -25,6 +25,9 @@
 // Benchmark name:
 // * `BM_Multiworker_*`: Triggers multiple sandbox workers. The default
 //   benchmarks always use a single sandbox worker.
+// * `*_GRPC`: Sends Predict calls over gRPC on the IPC socket.
+// * `*_SharedMemory`: Sends Predict calls over the shared memory rings set up
+//   by the sandbox executor. Models are still registered over gRPC.
 // * `process_time/real_time`: Measures the wall time for latency and CPU time
 //   of all threads not just limited to the main thread.
 // * `threads:8`: The number of threads concurrently executing the benchmark.
@@ -37,8 +40,20 @@
 // * `Latency`: Average time spent per Iteration.
 // * `NumWorkers`: The number of sandbox workers (or, inference sidecars)
 //   running.
-
+// * `P50Ms` & `P99Ms`: Percentiles of the latency of the Predict calls in
+//   milliseconds, averaged over the threads.
+//
+// BM_Predict_Scaling_GRPC sweeps the runtime config of the sidecar against
+// the load, one sidecar per configuration cell. Its name reads
+// `BM_Predict_Scaling_GRPC/<interop>/<intraop>/<batch>/threads:<callers>`:
+// the num_interop_threads and num_intraop_threads of the runtime config, the
+// number of model requests of each Predict call, and the number of threads
+// calling Predict concurrently.
+
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 #include <grpcpp/server_context.h>
@@ -47,14 +62,18 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "benchmark/benchmark.h"
 #include "benchmark/request_utils.h"
 #include "proto/inference_sidecar.grpc.pb.h"
 #include "proto/inference_sidecar.pb.h"
 #include "sandbox/sandbox_executor.h"
 #include "utils/file_util.h"
+#include "utils/shared_memory_transport.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
@@ -79,8 +98,25 @@ constexpr char kJsonString[] = R"json({
   ]
 }]
     })json";
+constexpr char kSharedMemoryRuntimeConfig[] =
+    R"json({"shared_memory_transport": true})json";
+constexpr char kModelRequest[] = R"json({
+    "model_path" : "test_model",
+    "tensors" : [
+    {
+      "tensor_name": "serving_default_double1:0",
+      "data_type": "DOUBLE",
+      "tensor_shape": [
+        1,
+        1
+      ],
+      "tensor_content": ["3.14"]
+    }
+  ]
+})json";
 constexpr char kNumWorkers[] = "NumWorkers";
 constexpr int kMaxThreads = 32;
+constexpr int kMaxScalingThreads = 16;
 
 static void ExportMetrics(benchmark::State& state) {
   state.SetItemsProcessed(state.iterations());
@@ -187,6 +223,93 @@ static void BM_Predict_GRPC(benchmark::State& state) {
   ExportMetrics(state);
 }
 
+// Registers the test model over gRPC.
+static void RegisterTestModel(const SandboxExecutor& executor) {
+  std::shared_ptr<grpc::Channel> client_channel =
+      grpc::CreateInsecureChannelFromFd("GrpcChannel",
+                                        executor.FileDescriptor());
+  std::unique_ptr<InferenceService::StubInterface> stub =
+      InferenceService::NewStub(client_channel);
+
+  RegisterModelRequest register_model_request;
+  RegisterModelResponse register_model_response;
+  CHECK(PopulateRegisterModelRequest(kTestModelPath, register_model_request)
+            .ok());
+  grpc::ClientContext context;
+  grpc::Status status = stub->RegisterModel(&context, register_model_request,
+                                            &register_model_response);
+  CHECK(status.ok()) << status.error_message();
+}
+
+static void BM_Multiworker_Predict_SharedMemory(benchmark::State& state) {
+  SandboxExecutor executor(kGrpcInferenceSidecarBinary,
+                           {kSharedMemoryRuntimeConfig});
+  CHECK_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
+  RegisterTestModel(executor);
+  auto client = std::make_unique<SharedMemoryPredictClient>(
+      *executor.RequestRing(), *executor.ResponseRing());
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::string input = StringFormat(kJsonString);
+    state.ResumeTiming();
+
+    PredictRequest predict_request;
+    predict_request.set_input(input);
+    absl::StatusOr<PredictResponse> predict_response =
+        client->Predict(predict_request);
+    CHECK(predict_response.ok()) << predict_response.status();
+  }
+
+  client.reset();
+  absl::StatusOr<sandbox2::Result> result = executor.StopSandboxee();
+  CHECK(result.ok());
+  CHECK_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+  CHECK_EQ(result->reason_code(), 0);
+
+  state.counters[kNumWorkers] = 1;
+  ExportMetrics(state);
+}
+
+static void BM_Predict_SharedMemory(benchmark::State& state) {
+  static std::unique_ptr<SandboxExecutor> executor = nullptr;
+  static std::unique_ptr<SharedMemoryPredictClient> client = nullptr;
+
+  if (state.thread_index() == 0) {
+    const std::vector<std::string> arg = {kSharedMemoryRuntimeConfig};
+    executor =
+        std::make_unique<SandboxExecutor>(kGrpcInferenceSidecarBinary, arg);
+    CHECK_EQ(executor->StartSandboxee().code(), absl::StatusCode::kOk);
+    RegisterTestModel(*executor);
+    client = std::make_unique<SharedMemoryPredictClient>(
+        *executor->RequestRing(), *executor->ResponseRing());
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::string input = StringFormat(kJsonString);
+    state.ResumeTiming();
+
+    PredictRequest predict_request;
+    predict_request.set_input(input);
+    absl::StatusOr<PredictResponse> predict_response =
+        client->Predict(predict_request);
+    CHECK(predict_response.ok()) << predict_response.status();
+  }
+
+  if (state.thread_index() == 0) {
+    client.reset();
+    absl::StatusOr<sandbox2::Result> result = executor->StopSandboxee();
+    CHECK(result.ok());
+    CHECK_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+    CHECK_EQ(result->reason_code(), 0);
+
+    state.counters[kNumWorkers] = 1;
+  }
+
+  ExportMetrics(state);
+}
+
 static void BM_Multiworker_Predict_IPC(benchmark::State& state) {
   SandboxExecutor executor(kIpcInferenceSidecarBinary, {"{}"});
   CHECK_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
@@ -277,6 +400,71 @@ static void BM_Predict_IPC(benchmark::State& state) {
   ExportMetrics(state);
 }
 
+// Returns the `percentile` of the sorted `latencies`.
+static double Percentile(const std::vector<double>& latencies,
+                         double percentile) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  const size_t index = std::min(
+      latencies.size() - 1, static_cast<size_t>(latencies.size() * percentile));
+  return latencies[index];
+}
+
+static void BM_Predict_Scaling_GRPC(benchmark::State& state) {
+  static std::unique_ptr<SandboxExecutor> executor = nullptr;
+  static std::unique_ptr<InferenceService::StubInterface> stub = nullptr;
+
+  if (state.thread_index() == 0) {
+    const std::vector<std::string> arg = {absl::StrCat(
+        R"json({"num_interop_threads": )json", state.range(0),
+        R"json(, "num_intraop_threads": )json", state.range(1), "}")};
+    executor =
+        std::make_unique<SandboxExecutor>(kGrpcInferenceSidecarBinary, arg);
+    CHECK_EQ(executor->StartSandboxee().code(), absl::StatusCode::kOk);
+    RegisterTestModel(*executor);
+    stub = InferenceService::NewStub(grpc::CreateInsecureChannelFromFd(
+        "GrpcChannel", executor->FileDescriptor()));
+  }
+
+  const std::string input = absl::StrCat(
+      R"json({"request": [)json",
+      absl::StrJoin(std::vector<absl::string_view>(state.range(2),
+                                                   kModelRequest),
+                    ","),
+      "]}");
+  std::vector<double> latencies_ms;
+  for (auto _ : state) {
+    PredictRequest predict_request;
+    predict_request.set_input(input);
+
+    const absl::Time start = absl::Now();
+    PredictResponse predict_response;
+    grpc::ClientContext context;
+    grpc::Status status =
+        stub->Predict(&context, predict_request, &predict_response);
+    latencies_ms.push_back(absl::ToDoubleMilliseconds(absl::Now() - start));
+    CHECK(status.ok()) << status.error_message();
+  }
+
+  if (state.thread_index() == 0) {
+    stub.reset();
+    absl::StatusOr<sandbox2::Result> result = executor->StopSandboxee();
+    CHECK(result.ok());
+    CHECK_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+    CHECK_EQ(result->reason_code(), 0);
+
+    state.counters[kNumWorkers] = 1;
+  }
+
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  state.counters["P50Ms"] = benchmark::Counter(
+      Percentile(latencies_ms, 0.5), benchmark::Counter::kAvgThreads);
+  state.counters["P99Ms"] = benchmark::Counter(
+      Percentile(latencies_ms, 0.99), benchmark::Counter::kAvgThreads);
+  ExportMetrics(state);
+}
+
 // BM_Register_IPC is not implemented. It's too slow to run the microbenchmark
 // because it requires a new sandbox worker per model registration.
 static void BM_Register_GRPC(benchmark::State& state) {
@@ -339,6 +527,24 @@ BENCHMARK(BM_Multiworker_Predict_GRPC)
     ->MeasureProcessCPUTime()
     ->UseRealTime();
 
+// One sidecar per cell of interop threads x intraop threads x model requests
+// per call x calling threads.
+BENCHMARK(BM_Predict_Scaling_GRPC)
+    ->ArgsProduct({{1, 2, 4}, {1, 2, 4}, {1, 8, 32}})
+    ->ThreadRange(1, kMaxScalingThreads)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
+// The same Predict calls over shared memory, to compare with gRPC.
+BENCHMARK(BM_Predict_SharedMemory)
+    ->ThreadRange(1, kMaxThreads)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+BENCHMARK(BM_Multiworker_Predict_SharedMemory)
+    ->ThreadRange(1, kMaxThreads)
+    ->MeasureProcessCPUTime()
+    ->UseRealTime();
+
 // Run the benchmark
 BENCHMARK_MAIN();
 
@@ -36,21 +36,50 @@
 #include "proto/inference_sidecar.pb.h"
 #include "sandbox/sandbox_worker.h"
 #include "sandboxed_api/sandbox2/comms.h"
+#include "src/util/status_macro/status_macros.h"
 #include "src/util/status_macro/status_util.h"
 #include "utils/cpu.h"
+#include "utils/model_executor.h"
+#include "utils/predict_stream.h"
+#include "utils/register_model_chunks.h"
+#include "utils/shared_memory_transport.h"
+#include "utils/shared_model_store.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
 
+// Runs the request with the module, unless the host stopped waiting for its
+// response while it was queued.
+absl::StatusOr<PredictResponse> PredictUnlessExpired(
+    ModuleInterface& module, const PredictRequest& request) {
+  if (absl::Now() >= PredictDeadline(request)) {
+    return absl::DeadlineExceededError(
+        "Predict request expired before it could run");
+  }
+  return module.Predict(request);
+}
+
 // Inference service implementation.
 class InferenceServiceImpl final : public InferenceService::Service {
  public:
-  InferenceServiceImpl(std::unique_ptr<ModuleInterface> inference_module)
-      : inference_module_(std::move(inference_module)) {}
+  // model_store: shared model store of the sidecar, null if not mapped.
+  InferenceServiceImpl(std::unique_ptr<ModuleInterface> inference_module,
+                       const SharedModelStore* model_store)
+      : inference_module_(std::move(inference_module)),
+        model_store_(model_store) {}
 
   grpc::Status RegisterModel(grpc::ServerContext* context,
                              const RegisterModelRequest* request,
                              RegisterModelResponse* response) override {
+    if (!request->shared_model_files().empty()) {
+      RegisterModelRequest request_with_files = *request;
+      if (absl::Status status =
+              ReadModelFilesFromStore(model_store_, request_with_files);
+          !status.ok()) {
+        return server_common::FromAbslStatus(status);
+      }
+      return RegisterModel(context, &request_with_files, response);
+    }
     absl::StatusOr<RegisterModelResponse> register_model_response =
         inference_module_->RegisterModel(*request);
     if (!register_model_response.ok()) {
@@ -60,11 +89,23 @@ class InferenceServiceImpl final : public InferenceService::Service {
     return grpc::Status::OK;
   }
 
+  grpc::Status RegisterModelStream(
+      grpc::ServerContext* context,
+      grpc::ServerReader<RegisterModelChunk>* reader,
+      RegisterModelResponse* response) override {
+    RegisterModelRequest request;
+    RegisterModelChunk chunk;
+    while (reader->Read(&chunk)) {
+      AppendRegisterModelChunk(chunk, request);
+    }
+    return RegisterModel(context, &request, response);
+  }
+
   grpc::Status Predict(grpc::ServerContext* context,
                        const PredictRequest* request,
                        PredictResponse* response) override {
     absl::StatusOr<PredictResponse> predict_response =
-        inference_module_->Predict(*request);
+        PredictUnlessExpired(*inference_module_, *request);
     if (!predict_response.ok()) {
       return server_common::FromAbslStatus(predict_response.status());
     }
@@ -72,8 +113,18 @@ class InferenceServiceImpl final : public InferenceService::Service {
     return grpc::Status::OK;
   }
 
+  grpc::Status PredictStream(
+      grpc::ServerContext* context,
+      grpc::ServerReaderWriter<PredictStreamResponse, PredictStreamRequest>*
+          stream) override {
+    return ServePredictStream(*stream, [this](const PredictRequest& request) {
+      return PredictUnlessExpired(*inference_module_, request);
+    });
+  }
+
  private:
   std::unique_ptr<ModuleInterface> inference_module_;
+  const SharedModelStore* model_store_;
 };
 
 }  // namespace
@@ -98,8 +149,19 @@ absl::Status Run(const InferenceSidecarRuntimeConfig& config) {
         absl::StrCat("Expected inference module: ", config.module_name(),
                      ", but got : ", ModuleInterface::GetModuleVersion()));
   }
-  auto server_impl =
-      std::make_unique<InferenceServiceImpl>(ModuleInterface::Create(config));
+  // Models may be registered with their files in the shared model store.
+  // Without it, e.g. if the host could not create it, they are registered
+  // with their files in the request.
+  if (config.shared_model_store_mb() > 0) {
+    if (absl::Status status = worker.MapSharedModelStore(); !status.ok()) {
+      ABSL_LOG(ERROR) << "Cannot map the shared model store: " << status;
+    }
+  }
+  std::unique_ptr<ModuleInterface> inference_module =
+      ModuleInterface::Create(config);
+  ModuleInterface* module = inference_module.get();
+  auto server_impl = std::make_unique<InferenceServiceImpl>(
+      std::move(inference_module), worker.ModelStore());
   builder.RegisterService(server_impl.get());
   std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
   if (server == nullptr) {
@@ -107,6 +169,18 @@ absl::Status Run(const InferenceSidecarRuntimeConfig& config) {
     return absl::UnavailableError("Cannot start the gRPC sidecar");
   }
 
+  // Serves Predict calls over shared memory as well, if enabled. Models are
+  // still registered over gRPC.
+  std::unique_ptr<SharedMemoryPredictServer> shared_memory_server;
+  if (config.shared_memory_transport()) {
+    PS_RETURN_IF_ERROR(worker.MapSharedMemoryRings());
+    shared_memory_server = std::make_unique<SharedMemoryPredictServer>(
+        *worker.RequestRing(), *worker.ResponseRing(),
+        [module](const PredictRequest& request) {
+          return PredictUnlessExpired(*module, request);
+        });
+  }
+
   // Starts up gRPC over IPC.
   grpc::AddInsecureChannelFromFd(server.get(), worker.FileDescriptor());
   server->Wait();
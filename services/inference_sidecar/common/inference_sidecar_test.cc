@@ -16,6 +16,8 @@
 #include <grpcpp/server_context.h>
 #include <grpcpp/server_posix.h>
 
+#include <google/protobuf/util/json_util.h>
+
 #include "absl/flags/flag.h"
 #include "absl/flags/reflection.h"
 #include "absl/status/status.h"
@@ -26,6 +28,8 @@
 #include "proto/inference_sidecar.pb.h"
 #include "sandbox/sandbox_executor.h"
 #include "utils/file_util.h"
+#include "utils/predict_stream.h"
+#include "utils/shared_memory_transport.h"
 
 #include "test_constants.h"
 
@@ -106,5 +110,123 @@ TEST(InferenceSidecarTest, RegisterModelAndRunInference_Grpc) {
   ASSERT_EQ(result->reason_code(), 0);
 }
 
+TEST(InferenceSidecarTest, RegisterModelAndRunInference_PredictStream) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_testonly_allow_policies_for_bazel, true);
+
+  SandboxExecutor executor(kInferenceSidecarBinary,
+                           {std::string(kRuntimeConfig)});
+  ASSERT_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
+
+  std::unique_ptr<InferenceService::StubInterface> stub =
+      InferenceService::NewStub(grpc::CreateInsecureChannelFromFd(
+          "GrpcChannel", executor.FileDescriptor()));
+
+  RegisterModelRequest register_model_request;
+  RegisterModelResponse register_model_response;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_model_request)
+          .ok());
+  {
+    grpc::ClientContext context;
+    grpc::Status status = stub->RegisterModel(&context, register_model_request,
+                                              &register_model_response);
+    EXPECT_TRUE(status.ok()) << status.error_message();
+  }
+
+  {
+    PredictStreamClient client(*stub);
+    const int kNumThreads = 100;
+    const int kNumIterations = 5;
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (int i = 0; i < kNumThreads; i++) {
+      threads.push_back(std::thread([&client]() {
+        PredictRequest predict_request;
+        predict_request.set_input(kJsonString);
+        for (int j = 0; j < kNumIterations; j++) {
+          absl::StatusOr<PredictResponse> response =
+              client.Predict(predict_request);
+          ASSERT_TRUE(response.ok()) << response.status();
+          // Placeholder output of the test module.
+          EXPECT_EQ(response->output(), "0.57721");
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  absl::StatusOr<sandbox2::Result> result = executor.StopSandboxee();
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+  ASSERT_EQ(result->reason_code(), 0);
+}
+
+TEST(InferenceSidecarTest, RegisterModelAndRunInference_SharedMemory) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_testonly_allow_policies_for_bazel, true);
+
+  InferenceSidecarRuntimeConfig config;
+  ASSERT_TRUE(
+      google::protobuf::util::JsonStringToMessage(kRuntimeConfig, &config)
+          .ok());
+  config.set_shared_memory_transport(true);
+  std::string config_json;
+  ASSERT_TRUE(
+      google::protobuf::util::MessageToJsonString(config, &config_json).ok());
+  SandboxExecutor executor(kInferenceSidecarBinary, {config_json});
+  ASSERT_NE(executor.RequestRing(), nullptr);
+  ASSERT_NE(executor.ResponseRing(), nullptr);
+  ASSERT_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
+
+  // Models are registered over gRPC.
+  std::shared_ptr<grpc::Channel> client_channel =
+      grpc::CreateInsecureChannelFromFd("GrpcChannel",
+                                        executor.FileDescriptor());
+  std::unique_ptr<InferenceService::StubInterface> stub =
+      InferenceService::NewStub(client_channel);
+  RegisterModelRequest register_model_request;
+  RegisterModelResponse register_model_response;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kTestModelPath, register_model_request)
+          .ok());
+  {
+    grpc::ClientContext context;
+    grpc::Status status = stub->RegisterModel(&context, register_model_request,
+                                              &register_model_response);
+    EXPECT_TRUE(status.ok()) << status.error_message();
+  }
+
+  {
+    SharedMemoryPredictClient client(*executor.RequestRing(),
+                                     *executor.ResponseRing());
+    const int kNumThreads = 100;
+    const int kNumIterations = 5;
+    std::vector<std::thread> threads;
+    threads.reserve(kNumThreads);
+    for (int i = 0; i < kNumThreads; i++) {
+      threads.push_back(std::thread([&client]() {
+        PredictRequest predict_request;
+        predict_request.set_input(kJsonString);
+        for (int j = 0; j < kNumIterations; j++) {
+          absl::StatusOr<PredictResponse> predict_response =
+              client.Predict(predict_request, absl::Seconds(10));
+          EXPECT_TRUE(predict_response.ok()) << predict_response.status();
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  absl::StatusOr<sandbox2::Result> result = executor.StopSandboxee();
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
+  ASSERT_EQ(result->reason_code(), 0);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -16,6 +16,7 @@
 
 #include <fcntl.h>
 #include <syscall.h>
+#include <unistd.h>
 
 #include <string>
 #include <utility>
@@ -35,6 +36,7 @@
 #include "sandboxed_api/sandbox2/sandbox2.h"
 #include "sandboxed_api/sandbox2/util/bpf_helper.h"
 #include "sandboxed_api/util/runfiles.h"
+#include "utils/shared_memory_ring.h"
 
 ABSL_FLAG(bool, testonly_disable_sandbox, false,
           "Disable sandbox restricted policies for testing purposes.");
@@ -171,6 +173,22 @@ std::unique_ptr<sandbox2::Policy> MakePolicy() {
   return builder.BuildOrDie();
 }
 
+// Creates a shared memory ring and maps it to `remote_fd` in the sandboxee.
+// Returns null if it fails, in which case the sandboxee can only use gRPC.
+std::unique_ptr<SharedMemoryRing> MapSharedMemoryRing(sandbox2::IPC& ipc,
+                                                      int remote_fd) {
+  absl::StatusOr<std::unique_ptr<SharedMemoryRing>> ring =
+      SharedMemoryRing::Create(kSharedMemoryRingCapacity);
+  if (!ring.ok()) {
+    ABSL_LOG(ERROR) << "SandboxExecutor: Failed to create a shared memory ring: "
+                    << ring.status();
+    return nullptr;
+  }
+  // The IPC takes ownership of the descriptor it maps.
+  ipc.MapFd(dup((*ring)->FileDescriptor()), remote_fd);
+  return *std::move(ring);
+}
+
 }  // namespace
 
 std::string SandboxeeStateToString(SandboxeeState sandboxee_state) {
@@ -194,7 +212,8 @@ std::string GetFilePath(absl::string_view relative_binary_path) {
 }
 
 SandboxExecutor::SandboxExecutor(absl::string_view binary_path,
-                                 const std::vector<std::string>& args) {
+                                 const std::vector<std::string>& args,
+                                 int model_store_file_descriptor) {
   auto executor = std::make_unique<sandbox2::Executor>(binary_path, args);
   executor->limits()
       ->set_rlimit_cpu(RLIM64_INFINITY)
@@ -209,6 +228,14 @@ SandboxExecutor::SandboxExecutor(absl::string_view binary_path,
 
   // The executor receives a file descriptor of the sandboxee FD.
   file_descriptor_ = executor->ipc()->ReceiveFd(kFileDescriptorName);
+  request_ring_ =
+      MapSharedMemoryRing(*executor->ipc(), kRequestRingFileDescriptor);
+  response_ring_ =
+      MapSharedMemoryRing(*executor->ipc(), kResponseRingFileDescriptor);
+  if (model_store_file_descriptor >= 0) {
+    executor->ipc()->MapFd(dup(model_store_file_descriptor),
+                           kModelStoreFileDescriptor);
+  }
   sandbox_ =
       std::make_unique<sandbox2::Sandbox2>(std::move(executor), MakePolicy());
 }
@@ -278,4 +305,20 @@ absl::StatusOr<sandbox2::Result> SandboxExecutor::StopSandboxee() {
   }
 }
 
+bool SandboxExecutor::IsSandboxeeRunning() {
+  if (sandboxee_state_ != SandboxeeState::kRunning) {
+    return false;
+  }
+  absl::StatusOr<sandbox2::Result> result =
+      sandbox_->AwaitResultWithTimeout(absl::ZeroDuration());
+  if (!result.ok()) {
+    return true;
+  }
+  ABSL_LOG(ERROR) << "SandboxExecutor: Sandboxee stopped on their own: "
+                  << result->ToString();
+  sandboxee_state_ = SandboxeeState::kStopped;
+  run_result_ = *std::move(result);
+  return false;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "sandboxed_api/sandbox2/sandbox2.h"
+#include "utils/shared_memory_ring.h"
 
 ABSL_DECLARE_FLAG(bool, testonly_disable_sandbox);
 ABSL_DECLARE_FLAG(bool, testonly_allow_policies_for_bazel);
@@ -50,12 +51,16 @@ std::string SandboxeeStateToString(SandboxeeState sandboxee_state);
 std::string GetFilePath(absl::string_view relative_binary_path);
 
 // SandboxExecutor runs a given binary as a child process under Sandbox2.
-// It also sets up the IPC communication with `SandboxWorker`.
+// It also sets up the IPC communication with `SandboxWorker`, and the shared
+// memory rings the sandboxee may serve Predict calls over.
 // Not thread safe.
 class SandboxExecutor {
  public:
+  // model_store_file_descriptor: descriptor of the shared model store mapped
+  // in the sandboxee, if not negative. It is not taken ownership of.
   SandboxExecutor(absl::string_view binary_path,
-                  const std::vector<std::string>& args);
+                  const std::vector<std::string>& args,
+                  int model_store_file_descriptor = -1);
   ~SandboxExecutor();
 
   SandboxExecutor(const SandboxExecutor&) = delete;
@@ -72,13 +77,24 @@ class SandboxExecutor {
   // `StartSandboxee` after this call.
   absl::StatusOr<sandbox2::Result> StopSandboxee();
 
+  // Returns true if the sandboxee has started and neither stopped on its own,
+  // e.g. crashed, nor been stopped.
+  bool IsSandboxeeRunning();
+
   // Returns opened file descriptor to communicate with the sandboxee via IPC.
   int FileDescriptor() const { return file_descriptor_; }
 
+  // Returns the shared memory rings carrying Predict requests to the sandboxee
+  // and responses back, or null if they could not be set up.
+  SharedMemoryRing* RequestRing() const { return request_ring_.get(); }
+  SharedMemoryRing* ResponseRing() const { return response_ring_.get(); }
+
  private:
   std::unique_ptr<sandbox2::Sandbox2> sandbox_;
   // File descriptor used for IPC.
   int file_descriptor_;
+  std::unique_ptr<SharedMemoryRing> request_ring_;
+  std::unique_ptr<SharedMemoryRing> response_ring_;
   SandboxeeState sandboxee_state_ = SandboxeeState::kNotStarted;
   // Populated on the first successful attempt of the sandboxee stop.
   sandbox2::Result run_result_;
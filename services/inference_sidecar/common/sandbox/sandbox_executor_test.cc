@@ -103,6 +103,24 @@ TEST_F(SandboxExecutorTest, Kill) {
   ASSERT_EQ(result->final_status(), sandbox2::Result::EXTERNAL_KILL);
 }
 
+TEST_F(SandboxExecutorTest, IsSandboxeeRunning) {
+  SandboxExecutor executor(GetFilePath(kIpcBinary), {""});
+  EXPECT_FALSE(executor.IsSandboxeeRunning());
+  ASSERT_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
+  EXPECT_TRUE(executor.IsSandboxeeRunning());
+  ASSERT_TRUE(executor.StopSandboxee().ok());
+  EXPECT_FALSE(executor.IsSandboxeeRunning());
+
+  SandboxExecutor exiting_executor(GetFilePath(kExitBinary), {""});
+  ASSERT_EQ(exiting_executor.StartSandboxee().code(), absl::StatusCode::kOk);
+  // Wait for sandboxee to stop on its own.
+  absl::SleepFor(absl::Seconds(1));
+  EXPECT_FALSE(exiting_executor.IsSandboxeeRunning());
+  absl::StatusOr<sandbox2::Result> result = exiting_executor.StopSandboxee();
+  ASSERT_TRUE(result.ok());
+  ASSERT_EQ(result->final_status(), sandbox2::Result::OK);
+}
+
 TEST_F(SandboxExecutorTest, DoubleStart) {
   SandboxExecutor executor(GetFilePath(kIpcBinary), {""});
   ASSERT_EQ(executor.StartSandboxee().code(), absl::StatusCode::kOk);
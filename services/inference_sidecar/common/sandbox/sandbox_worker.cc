@@ -20,6 +20,8 @@
 #include "absl/status/status.h"
 #include "sandboxed_api/sandbox2/client.h"
 #include "sandboxed_api/sandbox2/comms.h"
+#include "src/util/status_macro/status_macros.h"
+#include "utils/shared_memory_ring.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
@@ -48,4 +50,18 @@ SandboxWorker::SandboxWorker()
       << " non-blocking. It prevents communication via gRPC";
 }
 
+absl::Status SandboxWorker::MapSharedMemoryRings() {
+  PS_ASSIGN_OR_RETURN(request_ring_,
+                      SharedMemoryRing::Map(kRequestRingFileDescriptor));
+  PS_ASSIGN_OR_RETURN(response_ring_,
+                      SharedMemoryRing::Map(kResponseRingFileDescriptor));
+  return absl::OkStatus();
+}
+
+absl::Status SandboxWorker::MapSharedModelStore() {
+  PS_ASSIGN_OR_RETURN(model_store_,
+                      SharedModelStore::Map(kModelStoreFileDescriptor));
+  return absl::OkStatus();
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -15,10 +15,15 @@
 #ifndef SANDBOX_SANDBOX_WORKER_H_
 #define SANDBOX_SANDBOX_WORKER_H_
 
+#include <cstddef>
+#include <memory>
 #include <utility>
 
+#include "absl/status/status.h"
 #include "sandboxed_api/sandbox2/client.h"
 #include "sandboxed_api/sandbox2/comms.h"
+#include "utils/shared_memory_ring.h"
+#include "utils/shared_model_store.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 
@@ -26,6 +31,15 @@ namespace privacy_sandbox::bidding_auction_servers::inference {
 // A host sends a request to a sandboxee via this `file_descriptor`.
 inline constexpr char kFileDescriptorName[] = "CommFD";
 
+// File descriptors of the shared memory rings carrying Predict requests and
+// responses, as mapped in the sandboxee.
+inline constexpr int kRequestRingFileDescriptor = 1000;
+inline constexpr int kResponseRingFileDescriptor = 1001;
+// File descriptor of the shared model store, as mapped in the sandboxee.
+inline constexpr int kModelStoreFileDescriptor = 1002;
+// Number of bytes each shared memory ring holds.
+inline constexpr size_t kSharedMemoryRingCapacity = 4 << 20;
+
 // Sandbox worker.
 // It's attached to the sandboxee, and provides communication channel between
 // the host and the sandboxee.
@@ -37,11 +51,29 @@ class SandboxWorker {
 
   int FileDescriptor() { return file_descriptor_; }
 
+  // Maps the shared memory rings set up by `SandboxExecutor`. Should be called
+  // once, by sandboxees serving Predict calls over shared memory.
+  absl::Status MapSharedMemoryRings();
+
+  // The shared memory rings, null until mapped.
+  SharedMemoryRing* RequestRing() { return request_ring_.get(); }
+  SharedMemoryRing* ResponseRing() { return response_ring_.get(); }
+
+  // Maps the shared model store passed by `SandboxExecutor`. Should be called
+  // once, by sandboxees configured with a store.
+  absl::Status MapSharedModelStore();
+
+  // The shared model store, null until mapped.
+  const SharedModelStore* ModelStore() { return model_store_.get(); }
+
  private:
   sandbox2::Comms comms_;
   sandbox2::Client sandbox2_client_;
   // File descriptor used for IPC.
   int file_descriptor_;
+  std::unique_ptr<SharedMemoryRing> request_ring_;
+  std::unique_ptr<SharedMemoryRing> response_ring_;
+  std::unique_ptr<SharedModelStore> model_store_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
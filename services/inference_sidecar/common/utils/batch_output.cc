@@ -0,0 +1,81 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/batch_output.h"
+
+#include <string>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "utils/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr absl::string_view kResponsePrefix = R"({"response":[)";
+constexpr absl::string_view kResponseSuffix = "]}";
+
+}  // namespace
+
+std::string ConcatModelOutputsToJson(
+    const std::vector<std::string>& model_outputs) {
+  size_t size = kResponsePrefix.size() + kResponseSuffix.size();
+  for (const std::string& model_output : model_outputs) {
+    size += model_output.size() + 1;
+  }
+  std::string output;
+  output.reserve(size);
+  output.append(kResponsePrefix.data(), kResponsePrefix.size());
+  for (size_t i = 0; i < model_outputs.size(); ++i) {
+    if (i > 0) {
+      output.push_back(',');
+    }
+    output.append(model_outputs[i]);
+  }
+  output.append(kResponseSuffix.data(), kResponseSuffix.size());
+  return output;
+}
+
+absl::StatusOr<std::string> ModelErrorToJson(absl::string_view model_path,
+                                             const absl::Status& status) {
+  rapidjson::Document document;
+  document.SetObject();
+  rapidjson::MemoryPoolAllocator<>& allocator = document.GetAllocator();
+
+  rapidjson::Value model_path_value;
+  model_path_value.SetString(model_path.data(), model_path.size(), allocator);
+  document.AddMember("model_path", model_path_value, allocator);
+
+  rapidjson::Value error(rapidjson::kObjectType);
+  error.AddMember("code", static_cast<int>(status.code()), allocator);
+  rapidjson::Value message;
+  message.SetString(status.message().data(), status.message().size(),
+                    allocator);
+  error.AddMember("message", message, allocator);
+  document.AddMember("error", error, allocator);
+
+  return SerializeJsonDoc(document);
+}
+
+ModelTensors ModelErrorToBinary(absl::string_view model_path,
+                                const absl::Status& status) {
+  ModelTensors model_tensors;
+  model_tensors.set_model_path(model_path.data(), model_path.size());
+  model_tensors.mutable_error()->set_code(static_cast<int>(status.code()));
+  model_tensors.mutable_error()->set_message(status.message().data(),
+                                             status.message().size());
+  return model_tensors;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,48 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_BATCH_OUTPUT_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_BATCH_OUTPUT_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Builds the JSON output of a batch inference request from the outputs of
+// each model, serialized on the worker threads as JSON objects such as
+// {"model_path":"my_model","tensors":[...]}. The outputs are copied once,
+// as is.
+std::string ConcatModelOutputsToJson(
+    const std::vector<std::string>& model_outputs);
+
+// Converts the inference error of a model to its JSON output, in place of the
+// tensors, for requests allowing partial results:
+// {"model_path":"my_model","error":{"code":3,"message":"..."}}
+absl::StatusOr<std::string> ModelErrorToJson(absl::string_view model_path,
+                                             const absl::Status& status);
+
+// Converts the inference error of a model to its binary output, in place of
+// the tensors, for requests allowing partial results.
+ModelTensors ModelErrorToBinary(absl::string_view model_path,
+                                const absl::Status& status);
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_BATCH_OUTPUT_H_
@@ -0,0 +1,54 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/batch_output.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+TEST(BatchOutputTest, ConcatsModelOutputs) {
+  EXPECT_EQ(ConcatModelOutputsToJson({}), R"({"response":[]})");
+  EXPECT_EQ(ConcatModelOutputsToJson({R"({"model_path":"a","tensors":[]})",
+                                      R"({"model_path":"b","tensors":[]})"}),
+            R"({"response":[{"model_path":"a","tensors":[]},)"
+            R"({"model_path":"b","tensors":[]}]})");
+}
+
+TEST(BatchOutputTest, ConvertsModelErrorToJson) {
+  absl::StatusOr<std::string> output =
+      ModelErrorToJson("my_model", absl::InvalidArgumentError("bad \"input\""));
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output,
+            R"({"model_path":"my_model","error":{"code":3,)"
+            R"("message":"bad \"input\""}})");
+}
+
+TEST(BatchOutputTest, ConvertsModelErrorToBinary) {
+  ModelTensors output =
+      ModelErrorToBinary("my_model", absl::NotFoundError("no model"));
+  EXPECT_EQ(output.model_path(), "my_model");
+  EXPECT_TRUE(output.tensors().empty());
+  EXPECT_EQ(output.error().code(),
+            static_cast<int>(absl::StatusCode::kNotFound));
+  EXPECT_EQ(output.error().message(), "no model");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
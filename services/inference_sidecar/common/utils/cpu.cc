@@ -18,6 +18,13 @@
 #include <sched.h>
 #include <unistd.h>
 
+#if defined(__x86_64__)
+#include <cpuid.h>
+#elif defined(__aarch64__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
 #include <vector>
 
 #include "absl/log/absl_log.h"
@@ -57,4 +64,20 @@ absl::Status SetCpuAffinity(const std::vector<int>& cpus) {
   return absl::OkStatus();
 }
 
+bool CpuSupportsBf16() {
+#if defined(__x86_64__)
+  unsigned int eax, ebx, ecx, edx;
+  // AMX-BF16 is bit 22 of EDX of leaf 7, subleaf 0.
+  if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (edx & (1u << 22))) {
+    return true;
+  }
+  // AVX512-BF16 is bit 5 of EAX of leaf 7, subleaf 1.
+  return __get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx) && (eax & (1u << 5));
+#elif defined(__aarch64__) && defined(HWCAP2_BF16)
+  return (getauxval(AT_HWCAP2) & HWCAP2_BF16) != 0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -24,6 +24,10 @@ namespace privacy_sandbox::bidding_auction_servers::inference {
 // Set the CPU affinity to the current process given a list of CPU IDs.
 absl::Status SetCpuAffinity(const std::vector<int>& cpus);
 
+// Returns whether the CPU has bfloat16 dot product instructions: AVX512-BF16
+// or AMX-BF16 on x86, BF16 on Arm.
+bool CpuSupportsBf16();
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
 
 #endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_CPU_H_
@@ -17,8 +17,13 @@
 #include <sched.h>
 #include <unistd.h>
 
+#include <fstream>
+#include <sstream>
+#include <string>
+
 #include "absl/log/absl_log.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "googletest/include/gtest/gtest.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
@@ -60,5 +65,21 @@ TEST(SetCpuAffinity, SetAllCpus) {
   EXPECT_EQ(status.code(), absl::StatusCode::kOk);
 }
 
+TEST(CpuSupportsBf16, MatchesCpuInfoFlags) {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  ASSERT_TRUE(cpuinfo);
+  std::stringstream contents;
+  contents << cpuinfo.rdbuf();
+#if defined(__x86_64__)
+  const bool has_flag = absl::StrContains(contents.str(), " avx512_bf16") ||
+                        absl::StrContains(contents.str(), " amx_bf16");
+#elif defined(__aarch64__)
+  const bool has_flag = absl::StrContains(contents.str(), " bf16");
+#else
+  const bool has_flag = false;
+#endif
+  EXPECT_EQ(CpuSupportsBf16(), has_flag);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,136 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_DYNAMIC_BATCHER_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_DYNAMIC_BATCHER_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+struct DynamicBatcherConfig {
+  // Maximum number of inputs evaluated together.
+  int max_batch_size = 1;
+  // Maximum time the first input of a batch waits for others to join it.
+  absl::Duration max_queue_delay = absl::ZeroDuration();
+};
+
+// Combines the inputs of concurrent callers sharing the same key, e.g. the
+// same model and input shapes, into batches evaluated with a single call of
+// the batch function, and hands each caller its own output back.
+//
+// There is no thread of its own: the first caller of a batch waits for the
+// others until the batch is full or max_queue_delay is up, then evaluates the
+// batch on its thread. Thread-safe.
+template <typename InputT, typename OutputT>
+class DynamicBatcher {
+ public:
+  // Evaluates a batch of inputs sharing the key. It returns one output per
+  // input, in the same order.
+  using BatchFn = std::function<std::vector<absl::StatusOr<OutputT>>(
+      const std::string& key, std::vector<InputT>& inputs)>;
+
+  DynamicBatcher(const DynamicBatcherConfig& config, BatchFn batch_fn)
+      : max_batch_size_(std::max(config.max_batch_size, 1)),
+        max_queue_delay_(config.max_queue_delay),
+        batch_fn_(std::move(batch_fn)) {}
+
+  DynamicBatcher(const DynamicBatcher&) = delete;
+  DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+
+  // Adds the input to the open batch of the key and blocks until the batch
+  // is evaluated.
+  absl::StatusOr<OutputT> Run(const std::string& key, InputT input)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    mu_.Lock();
+    std::shared_ptr<Batch>& open_batch = open_batches_[key];
+    const bool is_leader = open_batch == nullptr;
+    if (is_leader) {
+      open_batch = std::make_shared<Batch>();
+    }
+    std::shared_ptr<Batch> batch = open_batch;
+    const size_t index = batch->inputs.size();
+    batch->inputs.push_back(std::move(input));
+    if (batch->inputs.size() >= max_batch_size_) {
+      // No more inputs can join, the leader can go ahead.
+      batch->closed = true;
+      open_batches_.erase(key);
+    }
+
+    if (!is_leader) {
+      mu_.Await(absl::Condition(&batch->done));
+      absl::StatusOr<OutputT> output = std::move(batch->outputs[index]);
+      mu_.Unlock();
+      return output;
+    }
+
+    mu_.AwaitWithTimeout(absl::Condition(&batch->closed), max_queue_delay_);
+    if (!batch->closed) {
+      batch->closed = true;
+      open_batches_.erase(key);
+    }
+    // The batch is closed, nobody else touches its inputs until it is done.
+    mu_.Unlock();
+    std::vector<absl::StatusOr<OutputT>> outputs =
+        batch_fn_(key, batch->inputs);
+    if (outputs.size() != batch->inputs.size()) {
+      outputs.assign(batch->inputs.size(),
+                     absl::InternalError(absl::StrCat(
+                         "Batch of ", batch->inputs.size(), " inputs returned ",
+                         outputs.size(), " outputs")));
+    }
+    absl::StatusOr<OutputT> output = std::move(outputs[index]);
+    mu_.Lock();
+    batch->outputs = std::move(outputs);
+    batch->done = true;
+    mu_.Unlock();
+    return output;
+  }
+
+ private:
+  struct Batch {
+    std::vector<InputT> inputs;
+    std::vector<absl::StatusOr<OutputT>> outputs;
+    // Set once the batch stops taking inputs.
+    bool closed = false;
+    // Set once the outputs are ready.
+    bool done = false;
+  };
+
+  const size_t max_batch_size_;
+  const absl::Duration max_queue_delay_;
+  const BatchFn batch_fn_;
+
+  absl::Mutex mu_;
+  // Batches taking inputs, by key.
+  absl::flat_hash_map<std::string, std::shared_ptr<Batch>> open_batches_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_DYNAMIC_BATCHER_H_
@@ -0,0 +1,131 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/dynamic_batcher.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Doubles the inputs and records the size of each batch.
+class DoublingBatchFn {
+ public:
+  std::vector<absl::StatusOr<int>> operator()(const std::string& key,
+                                              std::vector<int>& inputs) {
+    absl::MutexLock lock(&mu_);
+    batch_sizes_.push_back(inputs.size());
+    std::vector<absl::StatusOr<int>> outputs;
+    for (int input : inputs) {
+      outputs.push_back(2 * input);
+    }
+    return outputs;
+  }
+
+  std::vector<size_t> BatchSizes() {
+    absl::MutexLock lock(&mu_);
+    return batch_sizes_;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<size_t> batch_sizes_;
+};
+
+TEST(DynamicBatcherTest, BatchesConcurrentInputs) {
+  DoublingBatchFn batch_fn;
+  DynamicBatcher<int, int> batcher(
+      {.max_batch_size = 4, .max_queue_delay = absl::Seconds(10)},
+      [&batch_fn](const std::string& key, std::vector<int>& inputs) {
+        return batch_fn(key, inputs);
+      });
+
+  std::vector<int> outputs(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&batcher, &outputs, i]() {
+      absl::StatusOr<int> output = batcher.Run("model", i);
+      ASSERT_TRUE(output.ok()) << output.status();
+      outputs[i] = *output;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(outputs[i], 2 * i);
+  }
+  // Full batches do not wait for the delay.
+  EXPECT_EQ(batch_fn.BatchSizes(), (std::vector<size_t>{4, 4}));
+}
+
+TEST(DynamicBatcherTest, RunsPartialBatchesAfterTheDelay) {
+  DoublingBatchFn batch_fn;
+  DynamicBatcher<int, int> batcher(
+      {.max_batch_size = 4, .max_queue_delay = absl::Milliseconds(1)},
+      [&batch_fn](const std::string& key, std::vector<int>& inputs) {
+        return batch_fn(key, inputs);
+      });
+
+  absl::StatusOr<int> output = batcher.Run("model", 3);
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(*output, 6);
+  EXPECT_EQ(batch_fn.BatchSizes(), (std::vector<size_t>{1}));
+}
+
+TEST(DynamicBatcherTest, DoesNotMixKeys) {
+  absl::Mutex mu;
+  std::vector<std::string> batch_keys;
+  DynamicBatcher<int, std::string> batcher(
+      {.max_batch_size = 2, .max_queue_delay = absl::Seconds(10)},
+      [&](const std::string& key, std::vector<int>& inputs) {
+        absl::MutexLock lock(&mu);
+        batch_keys.push_back(key);
+        return std::vector<absl::StatusOr<std::string>>(inputs.size(), key);
+      });
+
+  std::vector<std::thread> threads;
+  for (const std::string key : {"a", "b", "a", "b"}) {
+    threads.emplace_back([&batcher, key]() {
+      absl::StatusOr<std::string> output = batcher.Run(key, 0);
+      ASSERT_TRUE(output.ok()) << output.status();
+      EXPECT_EQ(*output, key);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::sort(batch_keys.begin(), batch_keys.end());
+  EXPECT_EQ(batch_keys, (std::vector<std::string>{"a", "b"}));
+}
+
+TEST(DynamicBatcherTest, FailsAllInputsOnMismatchedOutputs) {
+  DynamicBatcher<int, int> batcher(
+      {.max_batch_size = 1},
+      [](const std::string& key, std::vector<int>& inputs) {
+        return std::vector<absl::StatusOr<int>>();
+      });
+  EXPECT_EQ(batcher.Run("model", 1).status().code(),
+            absl::StatusCode::kInternal);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -72,6 +72,18 @@ absl::Status PopulateRegisterModelRequest(absl::string_view path,
     return bytes.status();
   }
   (*request.mutable_model_files())[path] = std::move(*bytes);
+
+  // The warm-up request of the model, if any, is next to it (see
+  // utils/warm_up.h).
+  const std::string warm_up_path = absl::StrCat(path, ".warm_up_request.json");
+  if (std::filesystem::is_regular_file(warm_up_path)) {
+    absl::StatusOr<std::string> warm_up_bytes = ReadFile(warm_up_path);
+    if (!warm_up_bytes.ok()) {
+      ABSL_LOG_IF(ERROR, log_on_error) << warm_up_bytes.status();
+      return warm_up_bytes.status();
+    }
+    (*request.mutable_model_files())[warm_up_path] = std::move(*warm_up_bytes);
+  }
   return absl::OkStatus();
 }
 
@@ -0,0 +1,131 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/model_executor.h"
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+bool SameResources(const ModelResources& a, const ModelResources& b) {
+  return a.num_threads() == b.num_threads() &&
+         a.max_concurrency() == b.max_concurrency() &&
+         std::vector<int>(a.cpuset().begin(), a.cpuset().end()) ==
+             std::vector<int>(b.cpuset().begin(), b.cpuset().end());
+}
+
+}  // namespace
+
+absl::Status ValidateModelResources(const ModelResources& resources) {
+  if (resources.num_threads() < 0 || resources.max_concurrency() < 0) {
+    return absl::InvalidArgumentError(
+        "The threads and max concurrency of a model cannot be negative");
+  }
+  if (!resources.cpuset().empty() && resources.num_threads() == 0) {
+    return absl::InvalidArgumentError(
+        "The cpuset of a model requires threads of its own");
+  }
+  const int num_cpus = std::thread::hardware_concurrency();
+  for (int cpu : resources.cpuset()) {
+    if (cpu < 0 || (num_cpus > 0 && cpu >= num_cpus)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("CPU ", cpu, " of the cpuset of the model is invalid"));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Time PredictDeadline(const PredictRequest& request) {
+  if (request.deadline_unix_micros() <= 0) {
+    return absl::InfiniteFuture();
+  }
+  return absl::FromUnixMicros(request.deadline_unix_micros());
+}
+
+ModelExecutor::ModelExecutor(const ModelResources& resources,
+                             WorkStealingThreadPool& shared_pool)
+    : resources_(resources),
+      max_concurrency_(resources.max_concurrency()),
+      thread_pool_(&shared_pool) {
+  if (resources.num_threads() > 0) {
+    own_pool_ = std::make_unique<WorkStealingThreadPool>(
+        resources.num_threads(),
+        std::vector<int>(resources.cpuset().begin(), resources.cpuset().end()));
+    thread_pool_ = own_pool_.get();
+  }
+}
+
+ModelExecutors::ModelExecutors(WorkStealingThreadPool& shared_pool)
+    : shared_pool_(shared_pool),
+      default_executor_(ModelResources(), shared_pool) {}
+
+absl::StatusOr<ModelExecutor*> ModelExecutors::Prepare(
+    absl::string_view model_path, const ModelResources& resources) {
+  if (absl::Status status = ValidateModelResources(resources); !status.ok()) {
+    return status;
+  }
+  absl::MutexLock lock(&mu_);
+  ModelExecutor* current = &default_executor_;
+  if (auto it = current_.find(model_path); it != current_.end()) {
+    current = it->second;
+  }
+  if (SameResources(current->resources(), resources)) {
+    return current;
+  }
+  executors_.push_back(
+      std::make_unique<ModelExecutor>(resources, shared_pool_));
+  return executors_.back().get();
+}
+
+void ModelExecutors::Complete(absl::string_view model_path,
+                              ModelExecutor* executor, bool registered) {
+  // Dropped once the lock is released.
+  std::unique_ptr<ModelExecutor> dropped;
+  absl::MutexLock lock(&mu_);
+  auto it = current_.find(model_path);
+  ModelExecutor* current =
+      it != current_.end() ? it->second : &default_executor_;
+  if (executor == current) {
+    return;
+  }
+  if (registered) {
+    current_[model_path] = executor;
+    return;
+  }
+  // Only the warm-up of the failed registration ran on it.
+  for (auto executor_it = executors_.begin(); executor_it != executors_.end();
+       ++executor_it) {
+    if (executor_it->get() == executor) {
+      dropped = std::move(*executor_it);
+      executors_.erase(executor_it);
+      return;
+    }
+  }
+}
+
+ModelExecutor& ModelExecutors::Get(absl::string_view model_path) {
+  absl::ReaderMutexLock lock(&mu_);
+  if (auto it = current_.find(model_path); it != current_.end()) {
+    return *it->second;
+  }
+  return default_executor_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,159 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_EXECUTOR_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_EXECUTOR_H_
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.pb.h"
+#include "utils/model_metrics.h"
+#include "utils/request_parser.h"
+#include "utils/thread_pool.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Returns an error if the resources are not valid.
+absl::Status ValidateModelResources(const ModelResources& resources);
+
+// Returns the deadline of the request, or the infinite future if it has none.
+absl::Time PredictDeadline(const PredictRequest& request);
+
+// Runs the inferences of a model with its ModelResources: on a thread pool of
+// its own if it has threads, otherwise on the pool shared by the models, and
+// with at most `max_concurrency` of them in flight. Thread-safe.
+class ModelExecutor {
+ public:
+  // shared_pool: Runs the inferences if the model has no threads of its own.
+  // It must outlive the executor.
+  ModelExecutor(const ModelResources& resources,
+                WorkStealingThreadPool& shared_pool);
+
+  ModelExecutor(const ModelExecutor&) = delete;
+  ModelExecutor& operator=(const ModelExecutor&) = delete;
+
+  // Runs the task of the inference request, measured by a ModelTimer from the
+  // time it is submitted. If the model is at its max concurrency, the request
+  // is rejected and its future ready with ResourceExhausted. If it is still
+  // queued at the `deadline`, the task is dropped and its output is
+  // DeadlineExceeded, since no one waits for it anymore.
+  template <typename T>
+  std::future<MeasuredOutput<T>> Run(
+      InferenceRequest request,
+      absl::AnyInvocable<absl::StatusOr<T>(const InferenceRequest&) &&> task,
+      absl::Time deadline = absl::InfiniteFuture()) {
+    if (max_concurrency_ > 0 &&
+        in_flight_.fetch_add(1, std::memory_order_relaxed) >=
+            max_concurrency_) {
+      in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      const absl::Status status = absl::ResourceExhaustedError(
+          absl::StrCat("Model ", request.model_path, " has ",
+                       max_concurrency_, " inferences in flight"));
+      ModelTimer timer(request, absl::Now());
+      std::promise<MeasuredOutput<T>> rejected;
+      rejected.set_value(MeasuredOutput<T>{status, timer.Finish(status)});
+      return rejected.get_future();
+    }
+    return thread_pool_->Submit([this, request = std::move(request),
+                                 task = std::move(task), deadline,
+                                 submit_time = absl::Now()]() mutable {
+      ModelTimer timer(request, submit_time);
+      absl::StatusOr<T> output =
+          absl::Now() < deadline
+              ? std::move(task)(request)
+              : absl::DeadlineExceededError(absl::StrCat(
+                    "Inference of model ", request.model_path,
+                    " expired before it could run"));
+      ModelMetrics metrics = timer.Finish(output.status());
+      if (max_concurrency_ > 0) {
+        in_flight_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      return MeasuredOutput<T>{std::move(output), std::move(metrics)};
+    });
+  }
+
+  // Pool the inferences run on, e.g. for the warm-up of the model to set up
+  // the thread-local state of its workers.
+  WorkStealingThreadPool& thread_pool() { return *thread_pool_; }
+
+  const ModelResources& resources() const { return resources_; }
+
+ private:
+  const ModelResources resources_;
+  const int max_concurrency_;
+  // Inferences queued or running, counted if max_concurrency_ is set.
+  std::atomic<int> in_flight_ = 0;
+  // Null if the model has no threads of its own.
+  std::unique_ptr<WorkStealingThreadPool> own_pool_;
+  WorkStealingThreadPool* thread_pool_;
+};
+
+// The executors of the registered models, by model path. A model registered
+// without resources, or not registered, runs on the shared pool.
+//
+// Executors are kept until the module is destroyed, even once replaced, since
+// the tasks of their inferences may still be running. Thread-safe.
+class ModelExecutors {
+ public:
+  // shared_pool: Pool shared by the models. It must outlive the executors.
+  explicit ModelExecutors(WorkStealingThreadPool& shared_pool);
+
+  ModelExecutors(const ModelExecutors&) = delete;
+  ModelExecutors& operator=(const ModelExecutors&) = delete;
+
+  // Returns the executor of a model version being registered with the
+  // resources: the current one of the model if its resources are the same,
+  // otherwise a new one. The version is warmed up on its pool, then Complete
+  // is called with the result of the registration.
+  absl::StatusOr<ModelExecutor*> Prepare(absl::string_view model_path,
+                                         const ModelResources& resources)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Makes the prepared executor current for the model if it got registered,
+  // otherwise drops it unless it is already current.
+  void Complete(absl::string_view model_path, ModelExecutor* executor,
+                bool registered) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the current executor of the model.
+  ModelExecutor& Get(absl::string_view model_path) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  WorkStealingThreadPool& shared_pool_;
+  // Runs the models without an executor of their own.
+  ModelExecutor default_executor_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, ModelExecutor*> current_
+      ABSL_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<ModelExecutor>> executors_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_EXECUTOR_H_
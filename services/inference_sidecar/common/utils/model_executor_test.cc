@@ -0,0 +1,174 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/model_executor.h"
+
+#include <future>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+InferenceRequest Request(absl::string_view model_path) {
+  InferenceRequest request;
+  request.model_path = std::string(model_path);
+  return request;
+}
+
+TEST(ModelExecutorTest, RunsOnItsOwnThreads) {
+  WorkStealingThreadPool shared_pool(1);
+  absl::Notification release;
+  // Keeps the shared pool busy.
+  shared_pool.Schedule([&release]() { release.WaitForNotification(); });
+
+  ModelResources resources;
+  resources.set_num_threads(1);
+  ModelExecutor executor(resources, shared_pool);
+  std::future<MeasuredOutput<int>> result = executor.Run<int>(
+      Request("model"),
+      [](const InferenceRequest& request) -> absl::StatusOr<int> {
+        return request.model_path.size();
+      });
+  MeasuredOutput<int> output = result.get();
+  ASSERT_TRUE(output.output.ok());
+  EXPECT_EQ(*output.output, 5);
+  EXPECT_EQ(output.metrics.model_path(), "model");
+  release.Notify();
+}
+
+TEST(ModelExecutorTest, RejectsInferencesBeyondItsMaxConcurrency) {
+  WorkStealingThreadPool shared_pool(2);
+  ModelResources resources;
+  resources.set_max_concurrency(1);
+  ModelExecutor executor(resources, shared_pool);
+
+  absl::Notification release;
+  std::future<MeasuredOutput<int>> running = executor.Run<int>(
+      Request("model"),
+      [&release](const InferenceRequest&) -> absl::StatusOr<int> {
+        release.WaitForNotification();
+        return 1;
+      });
+  MeasuredOutput<int> rejected =
+      executor
+          .Run<int>(Request("model"),
+                    [](const InferenceRequest&) -> absl::StatusOr<int> {
+                      return 2;
+                    })
+          .get();
+  EXPECT_EQ(rejected.output.status().code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(rejected.metrics.error_code(),
+            static_cast<int>(absl::StatusCode::kResourceExhausted));
+
+  release.Notify();
+  EXPECT_EQ(*running.get().output, 1);
+  MeasuredOutput<int> admitted =
+      executor
+          .Run<int>(Request("model"),
+                    [](const InferenceRequest&) -> absl::StatusOr<int> {
+                      return 3;
+                    })
+          .get();
+  EXPECT_EQ(*admitted.output, 3);
+}
+
+TEST(ModelExecutorTest, DropsInferencesQueuedPastTheirDeadline) {
+  WorkStealingThreadPool shared_pool(1);
+  ModelExecutor executor(ModelResources(), shared_pool);
+  bool ran = false;
+  MeasuredOutput<int> expired =
+      executor
+          .Run<int>(
+              Request("model"),
+              [&ran](const InferenceRequest&) -> absl::StatusOr<int> {
+                ran = true;
+                return 1;
+              },
+              absl::Now() - absl::Seconds(1))
+          .get();
+  EXPECT_FALSE(ran);
+  EXPECT_EQ(expired.output.status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+
+  MeasuredOutput<int> in_time =
+      executor
+          .Run<int>(
+              Request("model"),
+              [](const InferenceRequest&) -> absl::StatusOr<int> { return 2; },
+              absl::Now() + absl::Minutes(1))
+          .get();
+  EXPECT_EQ(*in_time.output, 2);
+}
+
+TEST(ModelExecutorTest, ReadsTheDeadlineOfPredictRequests) {
+  PredictRequest request;
+  EXPECT_EQ(PredictDeadline(request), absl::InfiniteFuture());
+  request.set_deadline_unix_micros(1'000'000);
+  EXPECT_EQ(PredictDeadline(request), absl::FromUnixSeconds(1));
+}
+
+TEST(ModelExecutorTest, RejectsInvalidResources) {
+  ModelResources negative;
+  negative.set_max_concurrency(-1);
+  EXPECT_EQ(ValidateModelResources(negative).code(),
+            absl::StatusCode::kInvalidArgument);
+  ModelResources cpus_without_threads;
+  cpus_without_threads.add_cpuset(0);
+  EXPECT_EQ(ValidateModelResources(cpus_without_threads).code(),
+            absl::StatusCode::kInvalidArgument);
+  ModelResources pinned;
+  pinned.set_num_threads(1);
+  pinned.add_cpuset(0);
+  EXPECT_TRUE(ValidateModelResources(pinned).ok());
+}
+
+TEST(ModelExecutorsTest, SwitchesToTheExecutorOfARegisteredVersion) {
+  WorkStealingThreadPool shared_pool(1);
+  ModelExecutors executors(shared_pool);
+  ModelExecutor* shared_executor = &executors.Get("model");
+
+  // Same resources as the default.
+  absl::StatusOr<ModelExecutor*> executor =
+      executors.Prepare("model", ModelResources());
+  ASSERT_TRUE(executor.ok());
+  EXPECT_EQ(*executor, shared_executor);
+
+  ModelResources resources;
+  resources.set_num_threads(2);
+  executor = executors.Prepare("model", resources);
+  ASSERT_TRUE(executor.ok());
+  EXPECT_NE(*executor, shared_executor);
+  executors.Complete("model", *executor, /*registered=*/false);
+  EXPECT_EQ(&executors.Get("model"), shared_executor);
+
+  executor = executors.Prepare("model", resources);
+  ASSERT_TRUE(executor.ok());
+  executors.Complete("model", *executor, /*registered=*/true);
+  EXPECT_EQ(&executors.Get("model"), *executor);
+  EXPECT_EQ(&executors.Get("other_model"), shared_executor);
+
+  // Later versions with the same resources keep the executor.
+  absl::StatusOr<ModelExecutor*> same = executors.Prepare("model", resources);
+  ASSERT_TRUE(same.ok());
+  EXPECT_EQ(*same, *executor);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,36 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utils/model_metrics.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+ModelTimer::ModelTimer(const InferenceRequest& request, absl::Time submit_time)
+    : start_time_(absl::Now()) {
+  metrics_.set_model_path(request.model_path);
+  if (!request.inputs.empty() && !request.inputs[0].tensor_shape.empty()) {
+    metrics_.set_batch_size(request.inputs[0].tensor_shape[0]);
+  }
+  metrics_.set_queue_time_us(
+      absl::ToInt64Microseconds(start_time_ - submit_time));
+}
+
+ModelMetrics ModelTimer::Finish(const absl::Status& status) {
+  metrics_.set_inference_time_us(
+      absl::ToInt64Microseconds(absl::Now() - start_time_));
+  metrics_.set_error_code(static_cast<int>(status.code()));
+  return metrics_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,51 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_METRICS_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_METRICS_H_
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.pb.h"
+#include "utils/request_parser.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Output of the task of a model together with the metrics of its inference.
+template <typename T>
+struct MeasuredOutput {
+  absl::StatusOr<T> output;
+  ModelMetrics metrics;
+};
+
+// Measures the inference of a model on a worker thread. Created when the task
+// of the model starts running.
+class ModelTimer {
+ public:
+  // `submit_time` is the time the task of the model was handed to the thread
+  // pool.
+  ModelTimer(const InferenceRequest& request, absl::Time submit_time);
+
+  // Returns the metrics of the inference, which ended with `status`.
+  ModelMetrics Finish(const absl::Status& status);
+
+ private:
+  ModelMetrics metrics_;
+  absl::Time start_time_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_METRICS_H_
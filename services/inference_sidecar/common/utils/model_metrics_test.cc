@@ -0,0 +1,53 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "utils/model_metrics.h"
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "googletest/include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+TEST(ModelTimerTest, MeasuresTheInferenceOfTheModel) {
+  InferenceRequest request;
+  request.model_path = "my_model";
+  request.inputs.push_back(Tensor{.tensor_shape = {8, 3}});
+
+  ModelTimer timer(request, absl::Now() - absl::Milliseconds(5));
+  absl::SleepFor(absl::Milliseconds(1));
+  const ModelMetrics metrics = timer.Finish(absl::OkStatus());
+
+  EXPECT_EQ(metrics.model_path(), "my_model");
+  EXPECT_EQ(metrics.batch_size(), 8);
+  EXPECT_GE(metrics.queue_time_us(), 5000);
+  EXPECT_GE(metrics.inference_time_us(), 1000);
+  EXPECT_EQ(metrics.error_code(), 0);
+}
+
+TEST(ModelTimerTest, RecordsTheErrorOfTheModel) {
+  InferenceRequest request;
+  request.model_path = "my_model";
+
+  const ModelMetrics metrics = ModelTimer(request, absl::Now())
+                                   .Finish(absl::InvalidArgumentError("bad"));
+
+  EXPECT_EQ(metrics.batch_size(), 0);
+  EXPECT_EQ(metrics.error_code(),
+            static_cast<int>(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
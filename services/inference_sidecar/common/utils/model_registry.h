@@ -0,0 +1,226 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_REGISTRY_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_REGISTRY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Holds the versions of the registered models, by model path.
+//
+// A new version of a model is loaded next to the current one, without the
+// lock, and replaces it atomically once loaded. Callers own the versions they
+// got, so that their calls in flight finish on the replaced version before it
+// is freed.
+//
+// With a memory budget, replaced versions are kept so that registering one of
+// them again switches back without a reload. The oldest are dropped when a new
+// version needs room, and a version that does not fit is rejected. The size
+// of a version counts until it is freed. Thread-safe.
+template <typename ModelT>
+class ModelRegistry {
+ public:
+  using LoadFn = std::function<absl::StatusOr<std::unique_ptr<ModelT>>()>;
+
+  // No budget if memory_budget_bytes is 0, and replaced versions are dropped.
+  explicit ModelRegistry(int64_t memory_budget_bytes = 0)
+      : memory_budget_bytes_(memory_budget_bytes),
+        live_bytes_(std::make_shared<std::atomic<int64_t>>(0)) {}
+
+  ModelRegistry(const ModelRegistry&) = delete;
+  ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+  // Returns the current version of the model, or nullptr if none.
+  std::shared_ptr<ModelT> Get(absl::string_view model_path) const
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::ReaderMutexLock lock(&mu_);
+    auto it = models_.find(model_path);
+    if (it == models_.end() || !it->second.current.has_value()) {
+      return nullptr;
+    }
+    return it->second.current->model;
+  }
+
+  // Registers the version of the model, whose files take size_bytes, and
+  // makes it current. Returns AlreadyExists if it is already current or being
+  // registered, Unavailable while another version is being registered, and
+  // ResourceExhausted if it does not fit the budget.
+  absl::Status Register(absl::string_view model_path, absl::string_view version,
+                        int64_t size_bytes, const LoadFn& load)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    // Dropped versions are freed once the lock is released.
+    std::vector<Version> dropped;
+    {
+      absl::MutexLock lock(&mu_);
+      Entry& entry = models_[model_path];
+      if (entry.pending_version.has_value()) {
+        if (*entry.pending_version == version) {
+          return AlreadyRegistered(model_path);
+        }
+        return absl::UnavailableError(
+            absl::StrCat("Model '", model_path, "' version '",
+                         *entry.pending_version, "' is being registered"));
+      }
+      if (entry.current.has_value() && entry.current->version == version) {
+        return AlreadyRegistered(model_path);
+      }
+      for (auto it = entry.previous.begin(); it != entry.previous.end();
+           ++it) {
+        if (it->version == version) {
+          Version previous = std::move(*it);
+          entry.previous.erase(it);
+          MakeCurrent(entry, std::move(previous), dropped);
+          return absl::OkStatus();
+        }
+      }
+      if (!Reserve(size_bytes, dropped)) {
+        return absl::ResourceExhaustedError(absl::StrCat(
+            "Model '", model_path, "' version '", version, "' of ",
+            size_bytes, " bytes does not fit the memory budget of ",
+            memory_budget_bytes_, " bytes"));
+      }
+      entry.pending_version = std::string(version);
+    }
+
+    absl::StatusOr<std::unique_ptr<ModelT>> model = load();
+    absl::MutexLock lock(&mu_);
+    Entry& entry = models_[model_path];
+    entry.pending_version.reset();
+    if (!model.ok()) {
+      *live_bytes_ -= size_bytes;
+      return model.status();
+    }
+    // The size of the version counts until its last owner frees it.
+    std::shared_ptr<ModelT> shared_model(
+        model->release(), [live_bytes = live_bytes_, size_bytes](ModelT* m) {
+          delete m;
+          *live_bytes -= size_bytes;
+        });
+    MakeCurrent(entry,
+                Version{.version = std::string(version),
+                        .model = std::move(shared_model),
+                        .size_bytes = size_bytes,
+                        .sequence = next_sequence_++},
+                dropped);
+    return absl::OkStatus();
+  }
+
+  // Returns the bytes of the versions not freed yet, including the versions
+  // being loaded.
+  int64_t live_bytes() const { return *live_bytes_; }
+
+ private:
+  struct Version {
+    std::string version;
+    std::shared_ptr<ModelT> model;
+    int64_t size_bytes;
+    // Order of the loads, to drop the oldest versions first.
+    uint64_t sequence;
+  };
+
+  struct Entry {
+    std::optional<Version> current;
+    // Replaced versions kept under the budget, oldest first.
+    std::deque<Version> previous;
+    std::optional<std::string> pending_version;
+  };
+
+  static absl::Status AlreadyRegistered(absl::string_view model_path) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Model '", model_path, "' already registered"));
+  }
+
+  void MakeCurrent(Entry& entry, Version version,
+                   std::vector<Version>& dropped)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (entry.current.has_value()) {
+      if (memory_budget_bytes_ > 0) {
+        entry.previous.push_back(*std::move(entry.current));
+      } else {
+        dropped.push_back(*std::move(entry.current));
+      }
+    }
+    entry.current = std::move(version);
+  }
+
+  // Counts size_bytes in the live bytes if they fit the budget, dropping the
+  // oldest replaced versions to make room.
+  bool Reserve(int64_t size_bytes, std::vector<Version>& dropped)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (memory_budget_bytes_ <= 0) {
+      *live_bytes_ += size_bytes;
+      return true;
+    }
+    // Replaced versions are not handed out anymore: those owned by the
+    // registry only are freed when dropped.
+    auto freed_when_dropped = [](const Version& version) -> int64_t {
+      return version.model.use_count() == 1 ? version.size_bytes : 0;
+    };
+    int64_t needed_bytes = *live_bytes_ + size_bytes - memory_budget_bytes_;
+    int64_t droppable_bytes = 0;
+    for (const auto& [model_path, entry] : models_) {
+      for (const Version& version : entry.previous) {
+        droppable_bytes += freed_when_dropped(version);
+      }
+    }
+    if (needed_bytes > droppable_bytes) {
+      return false;
+    }
+    while (needed_bytes > 0) {
+      Entry* oldest = nullptr;
+      for (auto& [model_path, entry] : models_) {
+        if (!entry.previous.empty() &&
+            (oldest == nullptr || entry.previous.front().sequence <
+                                      oldest->previous.front().sequence)) {
+          oldest = &entry;
+        }
+      }
+      needed_bytes -= freed_when_dropped(oldest->previous.front());
+      dropped.push_back(std::move(oldest->previous.front()));
+      oldest->previous.pop_front();
+    }
+    *live_bytes_ += size_bytes;
+    return true;
+  }
+
+  const int64_t memory_budget_bytes_;
+  // Shared with the deleters of the versions, which may outlive the registry.
+  const std::shared_ptr<std::atomic<int64_t>> live_bytes_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, Entry> models_ ABSL_GUARDED_BY(mu_);
+  uint64_t next_sequence_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_MODEL_REGISTRY_H_
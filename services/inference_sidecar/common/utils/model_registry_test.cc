@@ -0,0 +1,139 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/model_registry.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+using Registry = ModelRegistry<std::string>;
+
+Registry::LoadFn LoadModel(const std::string& model) {
+  return [model]() { return std::make_unique<std::string>(model); };
+}
+
+absl::StatusOr<std::unique_ptr<std::string>> FailLoad() {
+  return absl::InternalError("Load failed");
+}
+
+TEST(ModelRegistryTest, SwitchesToNewVersions) {
+  Registry registry;
+  EXPECT_EQ(registry.Get("model"), nullptr);
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  EXPECT_EQ(*registry.Get("model"), "v1");
+  EXPECT_EQ(registry.Register("model", "1", 10, LoadModel("v1")).code(),
+            absl::StatusCode::kAlreadyExists);
+
+  ASSERT_TRUE(registry.Register("model", "2", 10, LoadModel("v2")).ok());
+  EXPECT_EQ(*registry.Get("model"), "v2");
+  EXPECT_EQ(registry.live_bytes(), 10);
+}
+
+TEST(ModelRegistryTest, KeepsReplacedVersionsForCallsInFlight) {
+  Registry registry;
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  std::shared_ptr<std::string> in_flight = registry.Get("model");
+
+  ASSERT_TRUE(registry.Register("model", "2", 10, LoadModel("v2")).ok());
+  EXPECT_EQ(*in_flight, "v1");
+  EXPECT_EQ(registry.live_bytes(), 20);
+  in_flight.reset();
+  EXPECT_EQ(registry.live_bytes(), 10);
+}
+
+TEST(ModelRegistryTest, FailedLoadsKeepTheCurrentVersion) {
+  Registry registry;
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  EXPECT_EQ(registry.Register("model", "2", 10, &FailLoad).code(),
+            absl::StatusCode::kInternal);
+  EXPECT_EQ(*registry.Get("model"), "v1");
+  EXPECT_EQ(registry.live_bytes(), 10);
+}
+
+TEST(ModelRegistryTest, RejectsRegistrationsInProgress) {
+  Registry registry;
+  absl::Notification loading;
+  absl::Notification loaded;
+  std::thread registration([&]() {
+    EXPECT_TRUE(registry
+                    .Register("model", "1", 10,
+                              [&]() {
+                                loading.Notify();
+                                loaded.WaitForNotification();
+                                return LoadModel("v1")();
+                              })
+                    .ok());
+  });
+  loading.WaitForNotification();
+  EXPECT_EQ(registry.Get("model"), nullptr);
+  EXPECT_EQ(registry.Register("model", "1", 10, LoadModel("v1")).code(),
+            absl::StatusCode::kAlreadyExists);
+  EXPECT_EQ(registry.Register("model", "2", 10, LoadModel("v2")).code(),
+            absl::StatusCode::kUnavailable);
+  EXPECT_TRUE(registry.Register("other_model", "1", 10, LoadModel("o1")).ok());
+  loaded.Notify();
+  registration.join();
+  EXPECT_EQ(*registry.Get("model"), "v1");
+}
+
+TEST(ModelRegistryTest, SwitchesBackToKeptVersionsWithoutReload) {
+  Registry registry(/*memory_budget_bytes=*/100);
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  ASSERT_TRUE(registry.Register("model", "2", 10, LoadModel("v2")).ok());
+  EXPECT_EQ(registry.live_bytes(), 20);
+
+  ASSERT_TRUE(registry.Register("model", "1", 10, &FailLoad).ok());
+  EXPECT_EQ(*registry.Get("model"), "v1");
+}
+
+TEST(ModelRegistryTest, DropsOldestVersionsOverBudget) {
+  Registry registry(/*memory_budget_bytes=*/25);
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  ASSERT_TRUE(registry.Register("model", "2", 10, LoadModel("v2")).ok());
+  ASSERT_TRUE(registry.Register("model", "3", 10, LoadModel("v3")).ok());
+  EXPECT_EQ(registry.live_bytes(), 20);
+
+  ASSERT_TRUE(registry.Register("model", "2", 10, &FailLoad).ok());
+  EXPECT_EQ(*registry.Get("model"), "v2");
+  // The first version was dropped: it is loaded again.
+  EXPECT_EQ(registry.Register("model", "1", 10, &FailLoad).code(),
+            absl::StatusCode::kInternal);
+}
+
+TEST(ModelRegistryTest, RejectsVersionsOverBudget) {
+  Registry registry(/*memory_budget_bytes=*/25);
+  ASSERT_TRUE(registry.Register("model", "1", 10, LoadModel("v1")).ok());
+  EXPECT_EQ(registry.Register("model", "2", 20, LoadModel("v2")).code(),
+            absl::StatusCode::kResourceExhausted);
+
+  // Versions still in flight count against the budget.
+  ASSERT_TRUE(registry.Register("model", "2", 10, LoadModel("v2")).ok());
+  std::shared_ptr<std::string> in_flight = registry.Get("model");
+  ASSERT_TRUE(registry.Register("model", "3", 10, LoadModel("v3")).ok());
+  EXPECT_EQ(registry.Register("model", "4", 10, LoadModel("v4")).code(),
+            absl::StatusCode::kResourceExhausted);
+  in_flight.reset();
+  EXPECT_TRUE(registry.Register("model", "4", 10, LoadModel("v4")).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
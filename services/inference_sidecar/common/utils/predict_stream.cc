@@ -0,0 +1,153 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/predict_stream.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "utils/thread_pool.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+PredictStreamClient::PredictStreamClient(InferenceService::StubInterface& stub)
+    : stream_(stub.PredictStream(&context_)),
+      reader_(&PredictStreamClient::ReadResponses, this) {}
+
+PredictStreamClient::~PredictStreamClient() {
+  // Ends the reads of the reader, which fails the pending calls.
+  context_.TryCancel();
+  reader_.join();
+}
+
+absl::StatusOr<PredictResponse> PredictStreamClient::Predict(
+    const PredictRequest& request, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  PredictStreamRequest stream_request;
+  *stream_request.mutable_request() = request;
+
+  Call call;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!broken_.ok()) {
+      return broken_;
+    }
+    stream_request.set_id(next_id_++);
+    calls_[stream_request.id()] = &call;
+  }
+  bool written;
+  {
+    absl::MutexLock lock(&write_mu_);
+    written = !finished_ && stream_->Write(stream_request);
+  }
+
+  absl::MutexLock lock(&mu_);
+  if (!written) {
+    // The stream is closed, the reader fails the pending calls with its
+    // status.
+    mu_.Await(absl::Condition(&call.done));
+    return call.response.status();
+  }
+  if (!mu_.AwaitWithDeadline(absl::Condition(&call.done), deadline)) {
+    // The response is dropped if it comes later.
+    calls_.erase(stream_request.id());
+    return absl::DeadlineExceededError("Predict call timed out");
+  }
+  return std::move(call.response);
+}
+
+void PredictStreamClient::Cancel(absl::Status status) {
+  absl::MutexLock lock(&mu_);
+  if (broken_.ok()) {
+    broken_ = std::move(status);
+  }
+  for (auto& [id, call] : calls_) {
+    call->response = broken_;
+    call->done = true;
+  }
+  calls_.clear();
+}
+
+void PredictStreamClient::ReadResponses() {
+  PredictStreamResponse response;
+  while (stream_->Read(&response)) {
+    absl::MutexLock lock(&mu_);
+    auto it = calls_.find(response.id());
+    if (it == calls_.end()) {
+      continue;
+    }
+    if (response.has_error()) {
+      it->second->response =
+          absl::Status(static_cast<absl::StatusCode>(response.error().code()),
+                       response.error().message());
+    } else {
+      it->second->response = std::move(*response.mutable_response());
+    }
+    it->second->done = true;
+    calls_.erase(it);
+  }
+  grpc::Status status;
+  {
+    absl::MutexLock lock(&write_mu_);
+    finished_ = true;
+    status = stream_->Finish();
+  }
+  ABSL_LOG_IF(ERROR, !status.ok() &&
+                         status.error_code() != grpc::StatusCode::CANCELLED)
+      << "PredictStream is closed: " << status.error_message();
+  Cancel(absl::UnavailableError(
+      absl::StrCat("PredictStream is closed: ", status.error_message())));
+}
+
+grpc::Status ServePredictStream(
+    grpc::ServerReaderWriterInterface<PredictStreamResponse,
+                                      PredictStreamRequest>& stream,
+    const PredictStreamHandler& handler, int num_threads) {
+  // Serializes the writes of concurrent responses.
+  absl::Mutex write_mu;
+  {
+    // Destroyed before returning, once the requests read are handled.
+    WorkStealingThreadPool thread_pool(num_threads);
+    PredictStreamRequest request;
+    while (stream.Read(&request)) {
+      thread_pool.Schedule([&stream, &handler, &write_mu,
+                            request = std::move(request)]() {
+        PredictStreamResponse response;
+        response.set_id(request.id());
+        absl::StatusOr<PredictResponse> predict_response =
+            handler(request.request());
+        if (predict_response.ok()) {
+          *response.mutable_response() = *std::move(predict_response);
+        } else {
+          response.mutable_error()->set_code(
+              static_cast<int>(predict_response.status().code()));
+          response.mutable_error()->set_message(
+              std::string(predict_response.status().message()));
+        }
+        absl::MutexLock lock(&write_mu);
+        if (!stream.Write(response)) {
+          ABSL_LOG_FIRST_N(ERROR, 1)
+              << "Cannot send the PredictResponse, the stream is closed";
+        }
+      });
+      request.Clear();
+    }
+  }
+  return grpc::Status::OK;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
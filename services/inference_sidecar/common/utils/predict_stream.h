@@ -0,0 +1,102 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_PREDICT_STREAM_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_PREDICT_STREAM_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.grpc.pb.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Predict calls from the host to the sidecar over a single PredictStream
+// call, in place of a unary Predict call each, which spares every call the
+// setup of its own gRPC call. Concurrent calls are multiplexed by id, with
+// their responses in the order they complete.
+
+// Host end. Thread-safe.
+class PredictStreamClient {
+ public:
+  // Opens the stream. The stub must outlive the client.
+  explicit PredictStreamClient(InferenceService::StubInterface& stub);
+  // Closes the stream. Pending calls fail.
+  ~PredictStreamClient();
+
+  PredictStreamClient(const PredictStreamClient&) = delete;
+  PredictStreamClient& operator=(const PredictStreamClient&) = delete;
+
+  absl::StatusOr<PredictResponse> Predict(
+      const PredictRequest& request,
+      absl::Duration timeout = absl::InfiniteDuration())
+      ABSL_LOCKS_EXCLUDED(mu_, write_mu_);
+
+  // Fails the pending and later calls with the status, e.g. once the sidecar
+  // is gone and no response is coming.
+  void Cancel(absl::Status status) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Call {
+    bool done = false;
+    absl::StatusOr<PredictResponse> response;
+  };
+
+  // Hands each response to its call, until the stream is closed.
+  void ReadResponses() ABSL_LOCKS_EXCLUDED(mu_, write_mu_);
+
+  grpc::ClientContext context_;
+  std::unique_ptr<grpc::ClientReaderWriterInterface<PredictStreamRequest,
+                                                    PredictStreamResponse>>
+      stream_;
+
+  // Serializes the writes of concurrent calls, and their end.
+  absl::Mutex write_mu_;
+  // Set once the stream is finished, after which it is not written to.
+  bool finished_ ABSL_GUARDED_BY(write_mu_) = false;
+
+  absl::Mutex mu_;
+  uint64_t next_id_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<uint64_t, Call*> calls_ ABSL_GUARDED_BY(mu_);
+  // Set once the stream is closed, after which no call goes through.
+  absl::Status broken_ ABSL_GUARDED_BY(mu_);
+
+  std::thread reader_;
+};
+
+using PredictStreamHandler =
+    std::function<absl::StatusOr<PredictResponse>(const PredictRequest&)>;
+
+// Sidecar end. Serves the stream until the host closes it, with its requests
+// handled concurrently on a thread pool of `num_threads`, one per CPU if not
+// positive. Returns once the responses of all requests read are sent.
+grpc::Status ServePredictStream(
+    grpc::ServerReaderWriterInterface<PredictStreamResponse,
+                                      PredictStreamRequest>& stream,
+    const PredictStreamHandler& handler, int num_threads = 0);
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_PREDICT_STREAM_H_
@@ -0,0 +1,69 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/register_model_chunks.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+bool WriteRegisterModelChunks(
+    const RegisterModelRequest& request, size_t chunk_bytes,
+    absl::FunctionRef<bool(const RegisterModelChunk&)> write) {
+  RegisterModelChunk chunk;
+  *chunk.mutable_model_spec() = request.model_spec();
+  *chunk.mutable_shared_model_files() = request.shared_model_files();
+  if (request.model_files().empty()) {
+    return write(chunk);
+  }
+  for (const auto& [file_path, bytes] : request.model_files()) {
+    chunk.set_file_path(file_path);
+    size_t offset = 0;
+    do {
+      size_t size = std::min(chunk_bytes, bytes.size() - offset);
+      chunk.set_data(bytes.data() + offset, size);
+      if (!write(chunk)) {
+        return false;
+      }
+      chunk.clear_model_spec();
+      chunk.clear_shared_model_files();
+      offset += size;
+    } while (offset < bytes.size());
+  }
+  return true;
+}
+
+void AppendRegisterModelChunk(RegisterModelChunk& chunk,
+                              RegisterModelRequest& request) {
+  if (chunk.has_model_spec()) {
+    request.mutable_model_spec()->Swap(chunk.mutable_model_spec());
+  }
+  for (auto& [file_path, file] : *chunk.mutable_shared_model_files()) {
+    (*request.mutable_shared_model_files())[file_path] = std::move(file);
+  }
+  // The only chunk of a request without model files.
+  if (chunk.file_path().empty() && chunk.data().empty()) {
+    return;
+  }
+  std::string& bytes = (*request.mutable_model_files())[chunk.file_path()];
+  if (bytes.empty()) {
+    bytes.swap(*chunk.mutable_data());
+  } else {
+    bytes.append(chunk.data());
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
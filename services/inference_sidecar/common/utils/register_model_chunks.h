@@ -0,0 +1,43 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_REGISTER_MODEL_CHUNKS_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_REGISTER_MODEL_CHUNKS_H_
+
+#include <cstddef>
+
+#include "absl/functional/function_ref.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Size of the chunks of RegisterModelStream, below the default gRPC message
+// size limit.
+inline constexpr size_t kRegisterModelChunkBytes = 1 << 20;
+
+// Splits the request into chunks of up to chunk_bytes of file data and writes
+// them in order. Each file has one chunk at least, even if empty. Returns
+// false once a write fails.
+bool WriteRegisterModelChunks(
+    const RegisterModelRequest& request, size_t chunk_bytes,
+    absl::FunctionRef<bool(const RegisterModelChunk&)> write);
+
+// Adds the chunk to the request it is a part of. The first chunk of a file is
+// taken without a copy.
+void AppendRegisterModelChunk(RegisterModelChunk& chunk,
+                              RegisterModelRequest& request);
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_REGISTER_MODEL_CHUNKS_H_
@@ -0,0 +1,113 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/register_model_chunks.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+std::vector<RegisterModelChunk> WriteChunks(const RegisterModelRequest& request,
+                                            size_t chunk_bytes) {
+  std::vector<RegisterModelChunk> chunks;
+  EXPECT_TRUE(WriteRegisterModelChunks(request, chunk_bytes,
+                                       [&chunks](const RegisterModelChunk& c) {
+                                         chunks.push_back(c);
+                                         return true;
+                                       }));
+  return chunks;
+}
+
+TEST(RegisterModelChunksTest, SplitsFilesIntoChunks) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("model");
+  (*request.mutable_model_files())["model/file"] = "0123456789";
+
+  std::vector<RegisterModelChunk> chunks = WriteChunks(request, 4);
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_EQ(chunks[0].model_spec().model_path(), "model");
+  EXPECT_FALSE(chunks[1].has_model_spec());
+  EXPECT_FALSE(chunks[2].has_model_spec());
+  EXPECT_EQ(chunks[0].data(), "0123");
+  EXPECT_EQ(chunks[1].data(), "4567");
+  EXPECT_EQ(chunks[2].data(), "89");
+  for (const RegisterModelChunk& chunk : chunks) {
+    EXPECT_EQ(chunk.file_path(), "model/file");
+  }
+}
+
+TEST(RegisterModelChunksTest, ReassemblesRequest) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("model");
+  request.mutable_model_spec()->set_version("1");
+  (*request.mutable_model_files())["model/a"] = "0123456789";
+  (*request.mutable_model_files())["model/b"] = "abc";
+  (*request.mutable_model_files())["model/empty"] = "";
+
+  RegisterModelRequest reassembled;
+  for (RegisterModelChunk& chunk : WriteChunks(request, 4)) {
+    AppendRegisterModelChunk(chunk, reassembled);
+  }
+  EXPECT_EQ(reassembled.model_spec().model_path(), "model");
+  EXPECT_EQ(reassembled.model_spec().version(), "1");
+  ASSERT_EQ(reassembled.model_files().size(), 3);
+  EXPECT_EQ(reassembled.model_files().at("model/a"), "0123456789");
+  EXPECT_EQ(reassembled.model_files().at("model/b"), "abc");
+  EXPECT_EQ(reassembled.model_files().at("model/empty"), "");
+}
+
+TEST(RegisterModelChunksTest, SendsModelWithoutFiles) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("model");
+  std::vector<RegisterModelChunk> chunks = WriteChunks(request, 4);
+  ASSERT_EQ(chunks.size(), 1);
+  EXPECT_EQ(chunks[0].model_spec().model_path(), "model");
+}
+
+TEST(RegisterModelChunksTest, SendsSharedModelFilesInFirstChunk) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("model");
+  SharedModelFile file;
+  file.set_offset(8);
+  file.set_size(16);
+  (*request.mutable_shared_model_files())["model/file"] = file;
+
+  std::vector<RegisterModelChunk> chunks = WriteChunks(request, 4);
+  ASSERT_EQ(chunks.size(), 1);
+  RegisterModelRequest reassembled;
+  AppendRegisterModelChunk(chunks[0], reassembled);
+  EXPECT_TRUE(reassembled.model_files().empty());
+  ASSERT_EQ(reassembled.shared_model_files().size(), 1);
+  EXPECT_EQ(reassembled.shared_model_files().at("model/file").offset(), 8);
+  EXPECT_EQ(reassembled.shared_model_files().at("model/file").size(), 16);
+}
+
+TEST(RegisterModelChunksTest, StopsAtFailedWrite) {
+  RegisterModelRequest request;
+  (*request.mutable_model_files())["model/file"] = "0123456789";
+  int writes = 0;
+  EXPECT_FALSE(WriteRegisterModelChunks(request, 4,
+                                        [&writes](const RegisterModelChunk&) {
+                                          return ++writes < 2;
+                                        }));
+  EXPECT_EQ(writes, 2);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
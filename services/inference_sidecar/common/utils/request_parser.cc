@@ -14,14 +14,139 @@
 
 #include "utils/request_parser.h"
 
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <utility>
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "rapidjson/document.h"
 #include "src/util/status_macro/status_macros.h"
 #include "utils/json_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Appends the values held in `bytes` to `result`, separated by commas.
+template <typename T>
+void AppendValues(const std::string& bytes, std::string& result) {
+  for (size_t offset = 0; offset + sizeof(T) <= bytes.size();
+       offset += sizeof(T)) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    if (offset > 0) {
+      absl::StrAppend(&result, ", ");
+    }
+    if constexpr (std::is_integral_v<T>) {
+      absl::StrAppend(&result, static_cast<int64_t>(value));
+    } else {
+      absl::StrAppend(&result, value);
+    }
+  }
+}
+
+void AppendTensorBytes(DataType data_type, const std::string& bytes,
+                       std::string& result) {
+  switch (data_type) {
+    case DataType::kFloat:
+      return AppendValues<float>(bytes, result);
+    case DataType::kDouble:
+      return AppendValues<double>(bytes, result);
+    case DataType::kInt8:
+      return AppendValues<int8_t>(bytes, result);
+    case DataType::kInt16:
+      return AppendValues<int16_t>(bytes, result);
+    case DataType::kInt32:
+      return AppendValues<int32_t>(bytes, result);
+    case DataType::kInt64:
+      return AppendValues<int64_t>(bytes, result);
+  }
+}
+
+bool ParseValue(absl::string_view str, float& value) {
+  return absl::SimpleAtof(str, &value);
+}
+
+bool ParseValue(absl::string_view str, double& value) {
+  return absl::SimpleAtod(str, &value);
+}
+
+bool ParseValue(absl::string_view str, int32_t& value) {
+  return absl::SimpleAtoi(str, &value);
+}
+
+bool ParseValue(absl::string_view str, int64_t& value) {
+  return absl::SimpleAtoi(str, &value);
+}
+
+// Integers narrower than int are parsed as int, then checked for bounds.
+template <typename T>
+bool ParseNarrowValue(absl::string_view str, T& value) {
+  int result;
+  if (!absl::SimpleAtoi(str, &result) ||
+      result < std::numeric_limits<T>::min() ||
+      result > std::numeric_limits<T>::max()) {
+    return false;
+  }
+  value = result;
+  return true;
+}
+
+bool ParseValue(absl::string_view str, int8_t& value) {
+  return ParseNarrowValue(str, value);
+}
+
+bool ParseValue(absl::string_view str, int16_t& value) {
+  return ParseNarrowValue(str, value);
+}
+
+// Parses the quoted numbers of a JSON tensor_content straight into their raw
+// little-endian values, reading each number in place in the JSON document
+// rather than copying it into a string first. Returns nullopt if a value is
+// not a quoted number of the type.
+template <typename T>
+std::optional<std::string> ParseTensorContent(
+    const rapidjson::Value::ConstArray& tensor_content) {
+  std::string bytes(tensor_content.Size() * sizeof(T), '\0');
+  char* out = bytes.data();
+  for (const rapidjson::Value& content_value : tensor_content) {
+    T value;
+    if (!content_value.IsString() ||
+        !ParseValue(absl::string_view(content_value.GetString(),
+                                      content_value.GetStringLength()),
+                    value)) {
+      return std::nullopt;
+    }
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+  }
+  return bytes;
+}
+
+std::optional<std::string> ParseTensorContent(
+    DataType data_type, const rapidjson::Value::ConstArray& tensor_content) {
+  switch (data_type) {
+    case DataType::kFloat:
+      return ParseTensorContent<float>(tensor_content);
+    case DataType::kDouble:
+      return ParseTensorContent<double>(tensor_content);
+    case DataType::kInt8:
+      return ParseTensorContent<int8_t>(tensor_content);
+    case DataType::kInt16:
+      return ParseTensorContent<int16_t>(tensor_content);
+    case DataType::kInt32:
+      return ParseTensorContent<int32_t>(tensor_content);
+    case DataType::kInt64:
+      return ParseTensorContent<int64_t>(tensor_content);
+  }
+  return std::nullopt;
+}
+
+}  // namespace
 
 std::string Tensor::DebugString() const {
   std::string result;
@@ -40,8 +165,14 @@ std::string Tensor::DebugString() const {
   absl::StrAppend(&result, "Tensor shape: [", absl::StrJoin(tensor_shape, ", "),
                   "]\n");
 
-  absl::StrAppend(&result, "Tensor content: [",
-                  absl::StrJoin(tensor_content, ", "), "]\n");
+  if (tensor_bytes.has_value()) {
+    absl::StrAppend(&result, "Tensor content: [");
+    AppendTensorBytes(data_type, *tensor_bytes, result);
+    absl::StrAppend(&result, "]\n");
+  } else {
+    absl::StrAppend(&result, "Tensor content: [",
+                    absl::StrJoin(tensor_content, ", "), "]\n");
+  }
 
   return result;
 }
@@ -104,6 +235,19 @@ absl::StatusOr<Tensor> ParseTensor(const rapidjson::Value& tensor_value) {
       rapidjson::GenericValue<rapidjson::UTF8<>>::ConstArray tensor_content,
       GetArrayMember(tensor_value, "tensor_content"), _.LogError());
 
+  std::size_t num_tensors = tensor_content.Size();
+  if (num_tensors != product_of_dimensions) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Mismatch between the size of tensor_content (%d) and "
+                        "a product of tensor dimensions (%d)",
+                        num_tensors, product_of_dimensions));
+  }
+  tensor.tensor_bytes = ParseTensorContent(tensor.data_type, tensor_content);
+  if (tensor.tensor_bytes.has_value()) {
+    return tensor;
+  }
+  // The values are kept as strings, so that the module reports the values it
+  // cannot convert as an error of the model alone.
   for (const rapidjson::Value& content_value : tensor_content) {
     if (!content_value.IsString()) {
       return absl::InvalidArgumentError(
@@ -111,13 +255,6 @@ absl::StatusOr<Tensor> ParseTensor(const rapidjson::Value& tensor_value) {
     }
     tensor.tensor_content.push_back(content_value.GetString());
   }
-  std::size_t num_tensors = tensor.tensor_content.size();
-  if (num_tensors != product_of_dimensions) {
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Mismatch between the size of tensor_content (%d) and "
-                        "a product of tensor dimensions (%d)",
-                        num_tensors, product_of_dimensions));
-  }
   return tensor;
 }
 
@@ -155,4 +292,82 @@ absl::StatusOr<std::vector<InferenceRequest>> ParseJsonInferenceRequest(
   return parsed_inputs;
 }
 
+size_t DataTypeSize(DataType data_type) {
+  switch (data_type) {
+    case DataType::kFloat:
+      return sizeof(float);
+    case DataType::kDouble:
+      return sizeof(double);
+    case DataType::kInt8:
+      return sizeof(int8_t);
+    case DataType::kInt16:
+      return sizeof(int16_t);
+    case DataType::kInt32:
+      return sizeof(int32_t);
+    case DataType::kInt64:
+      return sizeof(int64_t);
+  }
+  return 0;
+}
+
+absl::StatusOr<Tensor> ParseBinaryTensor(const BinaryTensor& binary_tensor) {
+  Tensor tensor;
+  tensor.tensor_name = binary_tensor.tensor_name();
+  // The enums of the proto and of the struct list the types in the same order.
+  switch (binary_tensor.data_type()) {
+    case BinaryTensor::FLOAT:
+    case BinaryTensor::DOUBLE:
+    case BinaryTensor::INT8:
+    case BinaryTensor::INT16:
+    case BinaryTensor::INT32:
+    case BinaryTensor::INT64:
+      tensor.data_type = static_cast<DataType>(binary_tensor.data_type());
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unsupported data type %d", binary_tensor.data_type()));
+  }
+
+  // Only dense tensors are supported.
+  std::size_t product_of_dimensions = 1;
+  for (int64_t dim : binary_tensor.tensor_shape()) {
+    if (dim < 1) {
+      return absl::InvalidArgumentError(
+          "Invalid tensor dimension: it has to be greater than 0");
+    }
+    product_of_dimensions *= dim;
+    tensor.tensor_shape.push_back(dim);
+  }
+
+  const std::size_t expected_size =
+      product_of_dimensions * DataTypeSize(tensor.data_type);
+  if (binary_tensor.tensor_content().size() != expected_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Mismatch between the size of tensor_content (%d bytes) and a product "
+        "of tensor dimensions (%d bytes)",
+        binary_tensor.tensor_content().size(), expected_size));
+  }
+  tensor.tensor_bytes = binary_tensor.tensor_content();
+  return tensor;
+}
+
+absl::StatusOr<std::vector<InferenceRequest>> ParseBinaryInferenceRequest(
+    const BatchTensors& batch_tensors) {
+  if (batch_tensors.models().empty()) {
+    return absl::InvalidArgumentError("Missing request in the binary input");
+  }
+  std::vector<InferenceRequest> parsed_inputs;
+  parsed_inputs.reserve(batch_tensors.models_size());
+  for (const ModelTensors& model_tensors : batch_tensors.models()) {
+    InferenceRequest model_input;
+    model_input.model_path = model_tensors.model_path();
+    for (const BinaryTensor& binary_tensor : model_tensors.tensors()) {
+      PS_ASSIGN_OR_RETURN(Tensor tensor, ParseBinaryTensor(binary_tensor));
+      model_input.inputs.push_back(std::move(tensor));
+    }
+    parsed_inputs.push_back(std::move(model_input));
+  }
+  return parsed_inputs;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -16,11 +16,13 @@
 #define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_REQUEST_PARSER_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "proto/inference_sidecar.pb.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 
@@ -71,6 +73,11 @@ struct Tensor {
   // (e.g. [1, 2, 7, 4]) and one with a shape [2,3] will expect a 6 element one.
   std::vector<std::string> tensor_content;
 
+  // Raw tensor content, set in place of tensor_content by the request parsers
+  // unless a JSON value does not convert to the data type. It holds the values
+  // in little-endian byte order, in the same layout as tensor_content.
+  std::optional<std::string> tensor_bytes;
+
   std::string DebugString() const;
 };
 
@@ -88,9 +95,19 @@ struct InferenceRequest {
 
 // Validates and parses JSON inference request to an internal data structure.
 // For a practical example, see generateBidRunInference.js.
+// The quoted numbers of the tensors are parsed straight into tensor_bytes,
+// unless one of them does not convert to the data type of its tensor.
 absl::StatusOr<std::vector<InferenceRequest>> ParseJsonInferenceRequest(
     absl::string_view json_string);
 
+// Validates and parses a binary inference request to an internal data
+// structure. The tensor contents are copied as is, without per-value parsing.
+absl::StatusOr<std::vector<InferenceRequest>> ParseBinaryInferenceRequest(
+    const BatchTensors& batch_tensors);
+
+// Size in bytes of a value of the data type.
+size_t DataTypeSize(DataType data_type);
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
 
 #endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_REQUEST_PARSER_H_
@@ -14,7 +14,12 @@
 
 #include "utils/request_parser.h"
 
+#include <string>
+#include <utility>
+
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "googletest/include/gtest/gtest.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
@@ -384,5 +389,86 @@ TEST(Test, UnsupportedFloat16Type) {
             "Invalid JSON format: Unsupported 'data_type' field FLOAT16");
 }
 
+// Returns a request with a single tensor of the given type and content.
+std::string MakeJsonRequest(absl::string_view data_type,
+                            absl::string_view tensor_content) {
+  return absl::StrCat(R"({"request": [{"model_path": "my_bucket/models/1/",)",
+                      R"("tensors": [{"data_type": ")", data_type,
+                      R"(", "tensor_shape": [2], "tensor_content": )",
+                      tensor_content, "}]}]}");
+}
+
+TEST(Test, Success_ParsesTensorContentIntoBytes) {
+  absl::StatusOr<std::vector<InferenceRequest>> output =
+      ParseJsonInferenceRequest(MakeJsonRequest("FLOAT", R"(["1.5", "-2"])"));
+  ASSERT_TRUE(output.ok()) << output.status();
+  const Tensor& tensor = (*output)[0].inputs[0];
+  EXPECT_TRUE(tensor.tensor_content.empty());
+  const float values[] = {1.5, -2};
+  EXPECT_EQ(tensor.tensor_bytes,
+            std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+}
+
+TEST(Test, Success_KeepsTensorContentThatDoesNotConvert) {
+  for (const auto& [data_type, tensor_content] :
+       {std::pair{"INT64", R"(["7", "seven"])"},
+        std::pair{"INT64", R"(["7", "1.2"])"},
+        std::pair{"INT8", R"(["7", "128"])"}}) {
+    absl::StatusOr<std::vector<InferenceRequest>> output =
+        ParseJsonInferenceRequest(MakeJsonRequest(data_type, tensor_content));
+    ASSERT_TRUE(output.ok()) << output.status();
+    const Tensor& tensor = (*output)[0].inputs[0];
+    EXPECT_FALSE(tensor.tensor_bytes.has_value()) << tensor_content;
+    EXPECT_EQ(tensor.tensor_content.size(), 2);
+  }
+}
+
+TEST(Test, Success_BinaryInput) {
+  BatchTensors batch_tensors;
+  ModelTensors* model_tensors = batch_tensors.add_models();
+  model_tensors->set_model_path("my_bucket/models/pcvr/1/");
+  BinaryTensor* binary_tensor = model_tensors->add_tensors();
+  binary_tensor->set_tensor_name("input");
+  binary_tensor->set_data_type(BinaryTensor::FLOAT);
+  binary_tensor->add_tensor_shape(2);
+  binary_tensor->add_tensor_shape(1);
+  const float values[] = {1.5, 2.5};
+  binary_tensor->set_tensor_content(
+      std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+
+  absl::StatusOr<std::vector<InferenceRequest>> output =
+      ParseBinaryInferenceRequest(batch_tensors);
+  ASSERT_TRUE(output.ok()) << output.status();
+  ASSERT_EQ(output->size(), 1);
+  const InferenceRequest& request = (*output)[0];
+  EXPECT_EQ(request.model_path, "my_bucket/models/pcvr/1/");
+  ASSERT_EQ(request.inputs.size(), 1);
+  const Tensor& tensor = request.inputs[0];
+  EXPECT_EQ(tensor.tensor_name, "input");
+  EXPECT_EQ(tensor.data_type, DataType::kFloat);
+  EXPECT_EQ(tensor.tensor_shape, (std::vector<int64_t>{2, 1}));
+  EXPECT_TRUE(tensor.tensor_content.empty());
+  EXPECT_EQ(tensor.tensor_bytes,
+            std::string(reinterpret_cast<const char*>(values), sizeof(values)));
+}
+
+TEST(Test, Failure_BinaryInputSizeMismatch) {
+  BatchTensors batch_tensors;
+  BinaryTensor* binary_tensor = batch_tensors.add_models()->add_tensors();
+  binary_tensor->set_data_type(BinaryTensor::INT64);
+  binary_tensor->add_tensor_shape(2);
+  binary_tensor->set_tensor_content(std::string(sizeof(int64_t), '\0'));
+
+  absl::StatusOr<std::vector<InferenceRequest>> output =
+      ParseBinaryInferenceRequest(batch_tensors);
+  ASSERT_FALSE(output.ok());
+  EXPECT_EQ(output.status().code(), absl::StatusCode::kInvalidArgument);
+}
+
+TEST(Test, Failure_BinaryInputEmpty) {
+  EXPECT_EQ(ParseBinaryInferenceRequest(BatchTensors()).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,244 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_memory_ring.h"
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Start of the shared memory, followed by the bytes of the ring.
+struct SharedMemoryRing::Header {
+  // Bytes written and read since the creation. The ring holds head - tail
+  // bytes, from offset tail % capacity on.
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  // Futex words bumped after each write and read, and the number of threads
+  // waiting on them, so that an end only wakes the other up if it waits.
+  alignas(64) std::atomic<uint32_t> writes;
+  std::atomic<uint32_t> readers_waiting;
+  alignas(64) std::atomic<uint32_t> reads;
+  std::atomic<uint32_t> writers_waiting;
+};
+
+namespace {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Futex words must be 32 bits");
+
+absl::Status ErrnoToStatus(absl::string_view call) {
+  return absl::InternalError(absl::StrCat(call, " failed: ", strerror(errno)));
+}
+
+// Waits until `ready` or the deadline, sleeping on the futex word while it
+// holds the value it had before checking `ready`.
+absl::Status FutexWait(std::atomic<uint32_t>& word,
+                       std::atomic<uint32_t>& waiting,
+                       absl::FunctionRef<bool()> ready, absl::Time deadline) {
+  while (true) {
+    const uint32_t value = word.load();
+    waiting.fetch_add(1);
+    if (ready()) {
+      waiting.fetch_sub(1);
+      return absl::OkStatus();
+    }
+    const absl::Duration timeout = deadline - absl::Now();
+    if (timeout <= absl::ZeroDuration()) {
+      waiting.fetch_sub(1);
+      return absl::DeadlineExceededError(
+          "Timed out waiting on the shared memory ring");
+    }
+    timespec timeout_spec;
+    timespec* timeout_ptr = nullptr;
+    if (deadline != absl::InfiniteFuture()) {
+      timeout_spec = absl::ToTimespec(timeout);
+      timeout_ptr = &timeout_spec;
+    }
+    // Not FUTEX_PRIVATE_FLAG, the other end is another process.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value,
+            timeout_ptr, nullptr, 0);
+    waiting.fetch_sub(1);
+  }
+}
+
+void FutexWake(std::atomic<uint32_t>& word,
+               const std::atomic<uint32_t>& waiting) {
+  word.fetch_add(1);
+  if (waiting.load() > 0) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRing>> SharedMemoryRing::Create(
+    size_t capacity) {
+  if (capacity == 0) {
+    return absl::InvalidArgumentError("Shared memory ring cannot be empty");
+  }
+  const int file_descriptor =
+      syscall(SYS_memfd_create, "inference_ring", MFD_CLOEXEC);
+  if (file_descriptor < 0) {
+    return ErrnoToStatus("memfd_create");
+  }
+  if (ftruncate(file_descriptor, sizeof(Header) + capacity) != 0) {
+    absl::Status status = ErrnoToStatus("ftruncate");
+    close(file_descriptor);
+    return status;
+  }
+  void* memory = mmap(nullptr, sizeof(Header) + capacity,
+                      PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+  if (memory == MAP_FAILED) {
+    absl::Status status = ErrnoToStatus("mmap");
+    close(file_descriptor);
+    return status;
+  }
+  // The pages of a new memfd are zeroed, as the counters should be.
+  new (memory) Header();
+  return std::unique_ptr<SharedMemoryRing>(
+      new SharedMemoryRing(file_descriptor, memory, capacity));
+}
+
+absl::StatusOr<std::unique_ptr<SharedMemoryRing>> SharedMemoryRing::Map(
+    int file_descriptor) {
+  struct stat file_stat;
+  if (fstat(file_descriptor, &file_stat) != 0) {
+    absl::Status status = ErrnoToStatus("fstat");
+    close(file_descriptor);
+    return status;
+  }
+  if (file_stat.st_size <= static_cast<off_t>(sizeof(Header))) {
+    close(file_descriptor);
+    return absl::InvalidArgumentError(
+        absl::StrCat("Shared memory of ", file_stat.st_size,
+                     " bytes is too small for a ring"));
+  }
+  void* memory = mmap(nullptr, file_stat.st_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, file_descriptor, 0);
+  if (memory == MAP_FAILED) {
+    absl::Status status = ErrnoToStatus("mmap");
+    close(file_descriptor);
+    return status;
+  }
+  return std::unique_ptr<SharedMemoryRing>(new SharedMemoryRing(
+      file_descriptor, memory, file_stat.st_size - sizeof(Header)));
+}
+
+SharedMemoryRing::SharedMemoryRing(int file_descriptor, void* memory,
+                                   size_t capacity)
+    : file_descriptor_(file_descriptor),
+      header_(static_cast<Header*>(memory)),
+      data_(static_cast<char*>(memory) + sizeof(Header)),
+      capacity_(capacity),
+      head_(header_->head.load()),
+      tail_(header_->tail.load()) {}
+
+SharedMemoryRing::~SharedMemoryRing() {
+  munmap(header_, sizeof(Header) + capacity_);
+  close(file_descriptor_);
+}
+
+absl::StatusOr<uint64_t> SharedMemoryRing::UsedBytes(uint64_t head,
+                                                     uint64_t tail) const {
+  if (head - tail > capacity_) {
+    return absl::DataLossError("Corrupted shared memory ring");
+  }
+  return head - tail;
+}
+
+absl::Status SharedMemoryRing::Write(absl::string_view data,
+                                     absl::Time deadline) {
+  while (!data.empty()) {
+    absl::StatusOr<uint64_t> used = UsedBytes(head_, header_->tail.load());
+    if (!used.ok()) {
+      return used.status();
+    }
+    if (*used == capacity_) {
+      absl::Status status = FutexWait(
+          header_->reads, header_->writers_waiting,
+          [this]() { return head_ - header_->tail.load() != capacity_; },
+          deadline);
+      if (!status.ok()) {
+        return status;
+      }
+      continue;
+    }
+    const size_t size = std::min<size_t>(capacity_ - *used, data.size());
+    const size_t offset = head_ % capacity_;
+    const size_t first = std::min(size, capacity_ - offset);
+    memcpy(data_ + offset, data.data(), first);
+    memcpy(data_, data.data() + first, size - first);
+    head_ += size;
+    header_->head.store(head_);
+    FutexWake(header_->writes, header_->readers_waiting);
+    data.remove_prefix(size);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SharedMemoryRing::Read(char* data, size_t size,
+                                    absl::Time deadline) {
+  while (size > 0) {
+    absl::StatusOr<uint64_t> used = UsedBytes(header_->head.load(), tail_);
+    if (!used.ok()) {
+      return used.status();
+    }
+    if (*used == 0) {
+      if (absl::Status status = WaitReadable(deadline); !status.ok()) {
+        return status;
+      }
+      continue;
+    }
+    const size_t read_size = std::min<size_t>(*used, size);
+    const size_t offset = tail_ % capacity_;
+    const size_t first = std::min(read_size, capacity_ - offset);
+    memcpy(data, data_ + offset, first);
+    memcpy(data + first, data_, read_size - first);
+    tail_ += read_size;
+    header_->tail.store(tail_);
+    FutexWake(header_->reads, header_->writers_waiting);
+    data += read_size;
+    size -= read_size;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SharedMemoryRing::WaitReadable(absl::Time deadline) {
+  return FutexWait(
+      header_->writes, header_->readers_waiting,
+      [this]() { return header_->head.load() != tail_; }, deadline);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
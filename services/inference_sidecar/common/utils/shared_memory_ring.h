@@ -0,0 +1,91 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_RING_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Byte stream from one process to another through a ring buffer in shared
+// memory, in place of a socket: bytes are copied in and out of the ring with
+// no system call, but for a futex wake-up when the other end waits.
+//
+// One process creates the ring and passes its file descriptor to the other,
+// which maps it. Each end either writes or reads the ring, a single thread at
+// a time. The counters written by the other end are checked before use, so
+// that a compromised sandboxee cannot make the host read or write out of the
+// ring.
+class SharedMemoryRing {
+ public:
+  // Creates a ring holding up to `capacity` bytes in anonymous shared memory.
+  static absl::StatusOr<std::unique_ptr<SharedMemoryRing>> Create(
+      size_t capacity);
+
+  // Maps the ring of the file descriptor. Takes ownership of the descriptor.
+  static absl::StatusOr<std::unique_ptr<SharedMemoryRing>> Map(
+      int file_descriptor);
+
+  ~SharedMemoryRing();
+
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  // Writes all of `data`, waiting for room in the ring as the reader consumes
+  // it, so that data may be larger than the ring. Returns DeadlineExceeded if
+  // the reader does not keep up, in which case only part of it is written.
+  absl::Status Write(absl::string_view data,
+                     absl::Time deadline = absl::InfiniteFuture());
+
+  // Reads exactly `size` bytes into `data`, waiting for the writer. Returns
+  // DeadlineExceeded if the bytes do not come, in which case only part of
+  // them is read.
+  absl::Status Read(char* data, size_t size,
+                    absl::Time deadline = absl::InfiniteFuture());
+
+  // Waits until there are bytes to read.
+  absl::Status WaitReadable(absl::Time deadline);
+
+  int FileDescriptor() const { return file_descriptor_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  struct Header;
+
+  SharedMemoryRing(int file_descriptor, void* memory, size_t capacity);
+
+  // Number of bytes in the ring, as seen from this end.
+  absl::StatusOr<uint64_t> UsedBytes(uint64_t head, uint64_t tail) const;
+
+  const int file_descriptor_;
+  Header* const header_;
+  char* const data_;
+  const size_t capacity_;
+  // Bytes written so far by the writer end, or read so far by the reader end,
+  // kept here rather than trusted from the shared memory.
+  uint64_t head_;
+  uint64_t tail_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_RING_H_
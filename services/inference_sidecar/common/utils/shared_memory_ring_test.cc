@@ -0,0 +1,94 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_memory_ring.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "absl/status/status.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Maps the ring a second time, as the other process would.
+std::unique_ptr<SharedMemoryRing> MapOtherEnd(const SharedMemoryRing& ring) {
+  absl::StatusOr<std::unique_ptr<SharedMemoryRing>> other_end =
+      SharedMemoryRing::Map(dup(ring.FileDescriptor()));
+  EXPECT_TRUE(other_end.ok()) << other_end.status();
+  return *std::move(other_end);
+}
+
+TEST(SharedMemoryRingTest, ReadsWhatIsWritten) {
+  absl::StatusOr<std::unique_ptr<SharedMemoryRing>> writer =
+      SharedMemoryRing::Create(16);
+  ASSERT_TRUE(writer.ok()) << writer.status();
+  std::unique_ptr<SharedMemoryRing> reader = MapOtherEnd(**writer);
+  EXPECT_EQ(reader->capacity(), 16);
+
+  // Wraps around the end of the ring.
+  for (const std::string data : {"0123456789", "abcdefghij", "klmnopqrst"}) {
+    ASSERT_TRUE((*writer)->Write(data).ok());
+    std::string read(data.size(), '\0');
+    ASSERT_TRUE(reader->Read(read.data(), read.size()).ok());
+    EXPECT_EQ(read, data);
+  }
+}
+
+TEST(SharedMemoryRingTest, StreamsDataLargerThanTheRing) {
+  absl::StatusOr<std::unique_ptr<SharedMemoryRing>> writer =
+      SharedMemoryRing::Create(64);
+  ASSERT_TRUE(writer.ok()) << writer.status();
+  std::unique_ptr<SharedMemoryRing> reader = MapOtherEnd(**writer);
+
+  std::string data;
+  for (int i = 0; i < 100000; ++i) {
+    data.push_back('a' + i % 26);
+  }
+  std::thread write_thread([&writer, &data]() {
+    EXPECT_TRUE((*writer)->Write(data).ok());
+  });
+  std::string read(data.size(), '\0');
+  EXPECT_TRUE(reader->Read(read.data(), read.size()).ok());
+  write_thread.join();
+  EXPECT_EQ(read, data);
+}
+
+TEST(SharedMemoryRingTest, TimesOut) {
+  absl::StatusOr<std::unique_ptr<SharedMemoryRing>> writer =
+      SharedMemoryRing::Create(4);
+  ASSERT_TRUE(writer.ok()) << writer.status();
+  std::unique_ptr<SharedMemoryRing> reader = MapOtherEnd(**writer);
+
+  char read;
+  EXPECT_EQ(
+      reader->Read(&read, 1, absl::Now() + absl::Milliseconds(10)).code(),
+      absl::StatusCode::kDeadlineExceeded);
+  // Nobody reads the ring once it is full.
+  EXPECT_EQ(
+      (*writer)->Write("12345", absl::Now() + absl::Milliseconds(10)).code(),
+      absl::StatusCode::kDeadlineExceeded);
+}
+
+TEST(SharedMemoryRingTest, RejectsEmptyRings) {
+  EXPECT_EQ(SharedMemoryRing::Create(0).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
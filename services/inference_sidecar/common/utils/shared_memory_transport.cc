@@ -0,0 +1,313 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_memory_transport.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+struct FrameHeader {
+  uint64_t id;
+  uint32_t size;
+  // absl::StatusCode of a response. The payload is the error message if it
+  // is not OK.
+  int32_t code;
+};
+
+// How often the readers check if they are stopped while the rings are idle.
+constexpr absl::Duration kPollInterval = absl::Milliseconds(100);
+// Once started, a frame is expected to go through within this time, else the
+// other end is considered gone.
+constexpr absl::Duration kFrameTimeout = absl::Seconds(10);
+
+absl::Status FrameTooLargeError(size_t size) {
+  return absl::ResourceExhaustedError(
+      absl::StrCat("Frame of ", size, " bytes exceeds the limit"));
+}
+
+// Writes the frame, within the frame timeout and the deadline. A frame cut
+// short leaves the ring unusable.
+absl::Status WriteFrame(SharedMemoryRing& ring, uint64_t id,
+                        absl::StatusCode code, absl::string_view payload,
+                        uint32_t max_frame_size,
+                        absl::Time deadline = absl::InfiniteFuture()) {
+  if (payload.size() > max_frame_size) {
+    return FrameTooLargeError(payload.size());
+  }
+  const FrameHeader header = {.id = id,
+                              .size = static_cast<uint32_t>(payload.size()),
+                              .code = static_cast<int32_t>(code)};
+  deadline = std::min(deadline, absl::Now() + kFrameTimeout);
+  if (absl::Status status =
+          ring.Write(absl::string_view(reinterpret_cast<const char*>(&header),
+                                       sizeof(header)),
+                     deadline);
+      !status.ok()) {
+    return status;
+  }
+  return ring.Write(payload, deadline);
+}
+
+// Waits for the next frame until the poll interval is up, in which case it
+// returns std::nullopt.
+absl::StatusOr<std::optional<std::pair<FrameHeader, std::string>>> ReadFrame(
+    SharedMemoryRing& ring, uint32_t max_frame_size) {
+  absl::Status status = ring.WaitReadable(absl::Now() + kPollInterval);
+  if (absl::IsDeadlineExceeded(status)) {
+    return std::nullopt;
+  }
+  if (!status.ok()) {
+    return status;
+  }
+  const absl::Time deadline = absl::Now() + kFrameTimeout;
+  FrameHeader header;
+  status = ring.Read(reinterpret_cast<char*>(&header), sizeof(header), deadline);
+  if (!status.ok()) {
+    return status;
+  }
+  if (header.size > max_frame_size) {
+    return absl::DataLossError(
+        absl::StrCat("Frame of ", header.size, " bytes exceeds the limit"));
+  }
+  std::string payload(header.size, '\0');
+  status = ring.Read(payload.data(), payload.size(), deadline);
+  if (!status.ok()) {
+    return status;
+  }
+  return std::make_pair(header, std::move(payload));
+}
+
+}  // namespace
+
+SharedMemoryPredictClient::SharedMemoryPredictClient(
+    SharedMemoryRing& request_ring, SharedMemoryRing& response_ring,
+    uint32_t max_frame_size)
+    : request_ring_(request_ring),
+      response_ring_(response_ring),
+      max_frame_size_(max_frame_size),
+      reader_(&SharedMemoryPredictClient::ReadResponses, this) {}
+
+SharedMemoryPredictClient::~SharedMemoryPredictClient() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  reader_.join();
+}
+
+absl::StatusOr<PredictResponse> SharedMemoryPredictClient::Predict(
+    const PredictRequest& request, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  std::string payload;
+  if (!request.SerializeToString(&payload)) {
+    return absl::InternalError("Cannot serialize the PredictRequest");
+  }
+  if (payload.size() > max_frame_size_) {
+    return FrameTooLargeError(payload.size());
+  }
+
+  Call call;
+  uint64_t id;
+  {
+    absl::MutexLock lock(&mu_);
+    if (!broken_.ok()) {
+      return broken_;
+    }
+    id = next_id_++;
+    calls_[id] = &call;
+  }
+  // Waits for the frames of the concurrent calls until the deadline of this
+  // one only.
+  absl::Status write_status;
+  const bool locked =
+      write_mu_.LockWhenWithDeadline(absl::Condition::kTrue, deadline);
+  if (locked) {
+    write_status = WriteFrame(request_ring_, id, absl::StatusCode::kOk,
+                              payload, max_frame_size_, deadline);
+  }
+  write_mu_.Unlock();
+
+  absl::MutexLock lock(&mu_);
+  if (!locked) {
+    // Nothing was written, the next calls can go through.
+    calls_.erase(id);
+    return absl::DeadlineExceededError("Predict call timed out");
+  }
+  if (!write_status.ok()) {
+    // The frame may be cut short, the next ones would not make sense.
+    calls_.erase(id);
+    if (broken_.ok()) {
+      broken_ = absl::UnavailableError(absl::StrCat(
+          "Shared memory transport is broken: ", write_status.message()));
+    }
+    return write_status;
+  }
+  if (!mu_.AwaitWithDeadline(absl::Condition(&call.done), deadline)) {
+    // The response is dropped if it comes later.
+    calls_.erase(id);
+    return absl::DeadlineExceededError("Predict call timed out");
+  }
+  if (!call.response.ok()) {
+    return call.response.status();
+  }
+  PredictResponse response;
+  if (!response.ParseFromString(*call.response)) {
+    return absl::InternalError("Cannot parse the PredictResponse");
+  }
+  return response;
+}
+
+void SharedMemoryPredictClient::Cancel(absl::Status status) {
+  absl::MutexLock lock(&mu_);
+  if (broken_.ok()) {
+    broken_ = std::move(status);
+  }
+  for (auto& [id, call] : calls_) {
+    call->response = broken_;
+    call->done = true;
+  }
+  calls_.clear();
+}
+
+void SharedMemoryPredictClient::ReadResponses() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (stopping_) {
+        return;
+      }
+    }
+    absl::StatusOr<std::optional<std::pair<FrameHeader, std::string>>> frame =
+        ReadFrame(response_ring_, max_frame_size_);
+    absl::MutexLock lock(&mu_);
+    if (!frame.ok()) {
+      ABSL_LOG(ERROR) << "Shared memory transport is broken: "
+                      << frame.status();
+      broken_ = absl::UnavailableError(absl::StrCat(
+          "Shared memory transport is broken: ", frame.status().message()));
+      for (auto& [id, call] : calls_) {
+        call->response = broken_;
+        call->done = true;
+      }
+      calls_.clear();
+      return;
+    }
+    if (!frame->has_value()) {
+      continue;
+    }
+    auto& [header, payload] = **frame;
+    auto it = calls_.find(header.id);
+    if (it == calls_.end()) {
+      continue;
+    }
+    const absl::StatusCode code = static_cast<absl::StatusCode>(header.code);
+    if (code == absl::StatusCode::kOk) {
+      it->second->response = std::move(payload);
+    } else {
+      it->second->response = absl::Status(code, payload);
+    }
+    it->second->done = true;
+    calls_.erase(it);
+  }
+}
+
+SharedMemoryPredictServer::SharedMemoryPredictServer(
+    SharedMemoryRing& request_ring, SharedMemoryRing& response_ring,
+    Handler handler, int num_threads, uint32_t max_frame_size)
+    : request_ring_(request_ring),
+      response_ring_(response_ring),
+      handler_(std::move(handler)),
+      max_frame_size_(max_frame_size),
+      thread_pool_(std::make_unique<WorkStealingThreadPool>(num_threads)) {
+  reader_ = std::thread(&SharedMemoryPredictServer::ReadRequests, this);
+}
+
+SharedMemoryPredictServer::~SharedMemoryPredictServer() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  reader_.join();
+}
+
+void SharedMemoryPredictServer::ReadRequests() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (stopping_) {
+        return;
+      }
+    }
+    absl::StatusOr<std::optional<std::pair<FrameHeader, std::string>>> frame =
+        ReadFrame(request_ring_, max_frame_size_);
+    if (!frame.ok()) {
+      ABSL_LOG(ERROR) << "Stops serving the shared memory transport: "
+                      << frame.status();
+      return;
+    }
+    if (!frame->has_value()) {
+      continue;
+    }
+    thread_pool_->Schedule([this, id = (*frame)->first.id,
+                            payload = std::move((*frame)->second)]() {
+      PredictRequest request;
+      if (!request.ParseFromString(payload)) {
+        Respond(id, absl::InvalidArgumentError(
+                        "Cannot parse the PredictRequest"));
+        return;
+      }
+      Respond(id, handler_(request));
+    });
+  }
+}
+
+void SharedMemoryPredictServer::Respond(
+    uint64_t id, absl::StatusOr<PredictResponse> response) {
+  std::string payload;
+  absl::StatusCode code = absl::StatusCode::kOk;
+  if (!response.ok()) {
+    code = response.status().code();
+    payload = std::string(response.status().message());
+  } else if (!response->SerializeToString(&payload)) {
+    code = absl::StatusCode::kInternal;
+    payload = "Cannot serialize the PredictResponse";
+  }
+  if (payload.size() > max_frame_size_) {
+    code = absl::StatusCode::kResourceExhausted;
+    payload = std::string(FrameTooLargeError(payload.size()).message());
+  }
+  absl::MutexLock lock(&write_mu_);
+  if (absl::Status status =
+          WriteFrame(response_ring_, id, code, payload, max_frame_size_);
+      !status.ok()) {
+    ABSL_LOG(ERROR) << "Cannot send the PredictResponse: " << status;
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,145 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_TRANSPORT_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_TRANSPORT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "proto/inference_sidecar.pb.h"
+#include "utils/shared_memory_ring.h"
+#include "utils/thread_pool.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Predict calls from the host to the sidecar over a pair of shared memory
+// rings, one for the requests and one for the responses, in place of gRPC
+// over a socket. Model registration stays on gRPC.
+//
+// Each call is a frame made of a small header and the serialized request or
+// response. Concurrent calls are multiplexed by id, with their responses in
+// the order they complete.
+
+// Default bound of the frames, above the PredictRequest and PredictResponse
+// of large batches. Frames are bounded so that a compromised sidecar cannot
+// make the host allocate arbitrary amounts of memory.
+inline constexpr uint32_t kDefaultMaxFrameSize = 64 << 20;
+
+// Host end. Thread-safe.
+class SharedMemoryPredictClient {
+ public:
+  // The rings must outlive the client. max_frame_size: Largest request sent
+  // and response accepted, in bytes.
+  SharedMemoryPredictClient(SharedMemoryRing& request_ring,
+                            SharedMemoryRing& response_ring,
+                            uint32_t max_frame_size = kDefaultMaxFrameSize);
+  ~SharedMemoryPredictClient();
+
+  SharedMemoryPredictClient(const SharedMemoryPredictClient&) = delete;
+  SharedMemoryPredictClient& operator=(const SharedMemoryPredictClient&) =
+      delete;
+
+  // The timeout also bounds the wait for the frames of concurrent calls to
+  // be written. A request cut short by it breaks the transport.
+  absl::StatusOr<PredictResponse> Predict(
+      const PredictRequest& request,
+      absl::Duration timeout = absl::InfiniteDuration())
+      ABSL_LOCKS_EXCLUDED(mu_, write_mu_);
+
+  // Fails the pending and later calls with the status, e.g. once the sidecar
+  // is gone and no response is coming.
+  void Cancel(absl::Status status) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Call {
+    bool done = false;
+    absl::StatusOr<std::string> response;
+  };
+
+  // Hands each response to its call, until the client is stopped or the
+  // rings break.
+  void ReadResponses() ABSL_LOCKS_EXCLUDED(mu_);
+
+  SharedMemoryRing& request_ring_;
+  SharedMemoryRing& response_ring_;
+  const uint32_t max_frame_size_;
+
+  // Serializes the frames of concurrent calls.
+  absl::Mutex write_mu_;
+
+  absl::Mutex mu_;
+  uint64_t next_id_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<uint64_t, Call*> calls_ ABSL_GUARDED_BY(mu_);
+  // Set once a frame is cut short, after which no call goes through.
+  absl::Status broken_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread reader_;
+};
+
+// Sidecar end. Requests are handled concurrently on a thread pool.
+class SharedMemoryPredictServer {
+ public:
+  using Handler =
+      std::function<absl::StatusOr<PredictResponse>(const PredictRequest&)>;
+
+  // The rings must outlive the server. num_threads: Number of requests
+  // handled at the same time, one per CPU if not positive. max_frame_size:
+  // Largest request accepted and response sent, in bytes. Larger responses
+  // are replaced by a ResourceExhausted error.
+  SharedMemoryPredictServer(SharedMemoryRing& request_ring,
+                            SharedMemoryRing& response_ring, Handler handler,
+                            int num_threads = 0,
+                            uint32_t max_frame_size = kDefaultMaxFrameSize);
+  // Stops reading requests, and waits for the ones read.
+  ~SharedMemoryPredictServer();
+
+  SharedMemoryPredictServer(const SharedMemoryPredictServer&) = delete;
+  SharedMemoryPredictServer& operator=(const SharedMemoryPredictServer&) =
+      delete;
+
+ private:
+  void ReadRequests() ABSL_LOCKS_EXCLUDED(mu_);
+  void Respond(uint64_t id, absl::StatusOr<PredictResponse> response)
+      ABSL_LOCKS_EXCLUDED(write_mu_);
+
+  SharedMemoryRing& request_ring_;
+  SharedMemoryRing& response_ring_;
+  const Handler handler_;
+  const uint32_t max_frame_size_;
+
+  // Serializes the frames of concurrent responses.
+  absl::Mutex write_mu_;
+  absl::Mutex mu_;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::thread reader_;
+  // Declared last, so that the requests read are handled before the other
+  // members are destroyed.
+  std::unique_ptr<WorkStealingThreadPool> thread_pool_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MEMORY_TRANSPORT_H_
@@ -0,0 +1,180 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_memory_transport.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Both ends of the rings between the host and the sidecar.
+struct Rings {
+  Rings() {
+    host_request = *SharedMemoryRing::Create(256);
+    host_response = *SharedMemoryRing::Create(256);
+    sidecar_request = *SharedMemoryRing::Map(dup(host_request->FileDescriptor()));
+    sidecar_response =
+        *SharedMemoryRing::Map(dup(host_response->FileDescriptor()));
+  }
+
+  std::unique_ptr<SharedMemoryRing> host_request;
+  std::unique_ptr<SharedMemoryRing> host_response;
+  std::unique_ptr<SharedMemoryRing> sidecar_request;
+  std::unique_ptr<SharedMemoryRing> sidecar_response;
+};
+
+absl::StatusOr<PredictResponse> Echo(const PredictRequest& request) {
+  if (request.input().empty()) {
+    return absl::InvalidArgumentError("Empty input");
+  }
+  PredictResponse response;
+  response.set_output(request.input());
+  return response;
+}
+
+TEST(SharedMemoryTransportTest, MultiplexesConcurrentCalls) {
+  Rings rings;
+  SharedMemoryPredictServer server(*rings.sidecar_request,
+                                   *rings.sidecar_response, &Echo, 4);
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 16; ++i) {
+    threads.emplace_back([&client, i]() {
+      // Larger than the rings.
+      const std::string input(1000 + i, 'a' + i);
+      PredictRequest request;
+      request.set_input(input);
+      absl::StatusOr<PredictResponse> response = client.Predict(request);
+      ASSERT_TRUE(response.ok()) << response.status();
+      EXPECT_EQ(response->output(), input);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+TEST(SharedMemoryTransportTest, ReturnsErrors) {
+  Rings rings;
+  SharedMemoryPredictServer server(*rings.sidecar_request,
+                                   *rings.sidecar_response, &Echo);
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response);
+
+  absl::StatusOr<PredictResponse> response = client.Predict(PredictRequest());
+  EXPECT_EQ(response.status().code(), absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(response.status().message(), "Empty input");
+}
+
+TEST(SharedMemoryTransportTest, TimesOut) {
+  Rings rings;
+  absl::Notification done;
+  SharedMemoryPredictServer server(
+      *rings.sidecar_request, *rings.sidecar_response,
+      [&done](const PredictRequest& request) {
+        done.WaitForNotification();
+        return Echo(request);
+      });
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response);
+
+  PredictRequest request;
+  request.set_input("slow");
+  EXPECT_EQ(client.Predict(request, absl::Milliseconds(10)).status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+  done.Notify();
+  // The late response is dropped, the next call gets its own.
+  request.set_input("fast");
+  absl::StatusOr<PredictResponse> response = client.Predict(request);
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_EQ(response->output(), "fast");
+}
+
+TEST(SharedMemoryTransportTest, BoundsFrames) {
+  Rings rings;
+  SharedMemoryPredictServer server(
+      *rings.sidecar_request, *rings.sidecar_response,
+      [](const PredictRequest& request) {
+        PredictResponse response;
+        response.set_output(std::string(10 * request.input().size(), 'b'));
+        return response;
+      },
+      /*num_threads=*/1, /*max_frame_size=*/100);
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response,
+                                   /*max_frame_size=*/100);
+
+  PredictRequest request;
+  request.set_input(std::string(1000, 'a'));
+  EXPECT_EQ(client.Predict(request).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  // The response is too large, the server replies with an error instead.
+  request.set_input(std::string(10, 'a'));
+  EXPECT_EQ(client.Predict(request).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  request.set_input("a");
+  absl::StatusOr<PredictResponse> response = client.Predict(request);
+  ASSERT_TRUE(response.ok()) << response.status();
+  EXPECT_EQ(response->output(), std::string(10, 'b'));
+}
+
+TEST(SharedMemoryTransportTest, WritesWithinTheTimeout) {
+  // Nothing reads the requests, so that they do not fit in the ring.
+  Rings rings;
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response);
+
+  PredictRequest request;
+  request.set_input(std::string(1000, 'a'));
+  const absl::Time start = absl::Now();
+  EXPECT_EQ(client.Predict(request, absl::Milliseconds(10)).status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+  EXPECT_LT(absl::Now() - start, absl::Seconds(1));
+}
+
+TEST(SharedMemoryTransportTest, CancelsCalls) {
+  Rings rings;
+  absl::Notification done;
+  SharedMemoryPredictServer server(
+      *rings.sidecar_request, *rings.sidecar_response,
+      [&done](const PredictRequest& request) {
+        done.WaitForNotification();
+        return Echo(request);
+      });
+  SharedMemoryPredictClient client(*rings.host_request, *rings.host_response);
+
+  std::thread thread([&client]() {
+    PredictRequest request;
+    request.set_input("pending");
+    EXPECT_EQ(client.Predict(request).status().code(),
+              absl::StatusCode::kUnavailable);
+  });
+  absl::SleepFor(absl::Milliseconds(10));
+  client.Cancel(absl::UnavailableError("Sidecar is gone"));
+  thread.join();
+  done.Notify();
+  EXPECT_EQ(client.Predict(PredictRequest()).status().code(),
+            absl::StatusCode::kUnavailable);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,183 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_model_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+// Older headers lack the seal, which Linux 5.1 added.
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+absl::Status ErrnoToStatus(absl::string_view call) {
+  return absl::InternalError(absl::StrCat(call, " failed: ", strerror(errno)));
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<SharedModelStore>> SharedModelStore::Create(
+    size_t capacity) {
+  if (capacity == 0) {
+    return absl::InvalidArgumentError("Shared model store cannot be empty");
+  }
+  const int file_descriptor = syscall(SYS_memfd_create, "inference_models",
+                                      MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (file_descriptor < 0) {
+    return ErrnoToStatus("memfd_create");
+  }
+  if (ftruncate(file_descriptor, capacity) != 0) {
+    absl::Status status = ErrnoToStatus("ftruncate");
+    close(file_descriptor);
+    return status;
+  }
+  void* memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      file_descriptor, 0);
+  if (memory == MAP_FAILED) {
+    absl::Status status = ErrnoToStatus("mmap");
+    close(file_descriptor);
+    return status;
+  }
+  // The mapping above stays writable, but no other can be made writable.
+  if (fcntl(file_descriptor, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_FUTURE_WRITE | F_SEAL_SEAL) !=
+      0) {
+    absl::Status status = ErrnoToStatus("fcntl(F_ADD_SEALS)");
+    munmap(memory, capacity);
+    close(file_descriptor);
+    return status;
+  }
+  return std::unique_ptr<SharedModelStore>(new SharedModelStore(
+      file_descriptor, static_cast<char*>(memory), capacity));
+}
+
+absl::StatusOr<std::unique_ptr<SharedModelStore>> SharedModelStore::Map(
+    int file_descriptor) {
+  struct stat file_stat;
+  if (fstat(file_descriptor, &file_stat) != 0) {
+    absl::Status status = ErrnoToStatus("fstat");
+    close(file_descriptor);
+    return status;
+  }
+  if (file_stat.st_size <= 0) {
+    close(file_descriptor);
+    return absl::InvalidArgumentError("Shared model store is empty");
+  }
+  void* memory = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED,
+                      file_descriptor, 0);
+  if (memory == MAP_FAILED) {
+    absl::Status status = ErrnoToStatus("mmap");
+    close(file_descriptor);
+    return status;
+  }
+  return std::unique_ptr<SharedModelStore>(new SharedModelStore(
+      file_descriptor, static_cast<char*>(memory), file_stat.st_size));
+}
+
+SharedModelStore::SharedModelStore(int file_descriptor, char* memory,
+                                   size_t capacity)
+    : file_descriptor_(file_descriptor),
+      memory_(memory),
+      capacity_(capacity) {}
+
+SharedModelStore::~SharedModelStore() {
+  munmap(memory_, capacity_);
+  close(file_descriptor_);
+}
+
+absl::StatusOr<SharedModelFile> SharedModelStore::Add(
+    absl::string_view bytes) {
+  size_t offset;
+  {
+    absl::MutexLock lock(&mu_);
+    if (bytes.size() > capacity_ - used_) {
+      return absl::ResourceExhaustedError(
+          absl::StrCat("Shared model store has ", capacity_ - used_,
+                       " bytes left for a file of ", bytes.size()));
+    }
+    offset = used_;
+    used_ += bytes.size();
+  }
+  // The range is reserved, so the copy runs outside of the lock.
+  memcpy(memory_ + offset, bytes.data(), bytes.size());
+  SharedModelFile file;
+  file.set_offset(offset);
+  file.set_size(bytes.size());
+  return file;
+}
+
+absl::StatusOr<absl::string_view> SharedModelStore::Get(
+    const SharedModelFile& file) const {
+  if (file.offset() > capacity_ || file.size() > capacity_ - file.offset()) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Shared model file at ", file.offset(), " of ",
+                     file.size(), " bytes is out of the store of ",
+                     capacity_, " bytes"));
+  }
+  return absl::string_view(memory_ + file.offset(), file.size());
+}
+
+absl::Status MoveModelFilesToStore(SharedModelStore& store,
+                                   RegisterModelRequest& request) {
+  google::protobuf::Map<std::string, SharedModelFile> shared_files;
+  for (const auto& [file_path, bytes] : request.model_files()) {
+    absl::StatusOr<SharedModelFile> file = store.Add(bytes);
+    if (!file.ok()) {
+      return file.status();
+    }
+    shared_files[file_path] = *std::move(file);
+  }
+  request.clear_model_files();
+  for (auto& [file_path, file] : shared_files) {
+    (*request.mutable_shared_model_files())[file_path] = std::move(file);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadModelFilesFromStore(const SharedModelStore* store,
+                                     RegisterModelRequest& request) {
+  if (request.shared_model_files().empty()) {
+    return absl::OkStatus();
+  }
+  if (store == nullptr) {
+    return absl::FailedPreconditionError(
+        "Model files are in a shared model store the sidecar did not map");
+  }
+  for (const auto& [file_path, file] : request.shared_model_files()) {
+    absl::StatusOr<absl::string_view> bytes = store->Get(file);
+    if (!bytes.ok()) {
+      return bytes.status();
+    }
+    (*request.mutable_model_files())[file_path] = std::string(*bytes);
+  }
+  request.clear_shared_model_files();
+  return absl::OkStatus();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
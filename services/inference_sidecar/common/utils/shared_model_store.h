@@ -0,0 +1,93 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MODEL_STORE_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MODEL_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Model files written once by the host into sealed shared memory, which every
+// sidecar maps read-only, so that the sidecar replicas are registered with a
+// model without the host keeping or sending a copy of its files per replica.
+//
+// The host creates the store and passes its file descriptor to the sidecars.
+// The memory is sealed against resizing and against writes through any other
+// mapping than that of the host, so a compromised sandboxee can neither
+// change the files of the other replicas nor make the host fault. Files are
+// appended and never freed: once the store is full, models are registered
+// with their files in the request instead.
+class SharedModelStore {
+ public:
+  // Creates a store of `capacity` bytes, in the host.
+  static absl::StatusOr<std::unique_ptr<SharedModelStore>> Create(
+      size_t capacity);
+
+  // Maps the store of the file descriptor read-only, in a sidecar. Takes
+  // ownership of the descriptor.
+  static absl::StatusOr<std::unique_ptr<SharedModelStore>> Map(
+      int file_descriptor);
+
+  ~SharedModelStore();
+
+  SharedModelStore(const SharedModelStore&) = delete;
+  SharedModelStore& operator=(const SharedModelStore&) = delete;
+
+  // Copies `bytes` into the store of the host. Returns ResourceExhausted if
+  // they do not fit. Thread-safe.
+  absl::StatusOr<SharedModelFile> Add(absl::string_view bytes)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the bytes of the file, which must be within the store.
+  absl::StatusOr<absl::string_view> Get(const SharedModelFile& file) const;
+
+  int FileDescriptor() const { return file_descriptor_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  SharedModelStore(int file_descriptor, char* memory, size_t capacity);
+
+  const int file_descriptor_;
+  char* const memory_;
+  const size_t capacity_;
+  absl::Mutex mu_;
+  size_t used_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Moves the model files of the request into the store, in place of which the
+// request refers to them in `shared_model_files`. Leaves the request as is if
+// they do not all fit, in which case the files added before the first one
+// that does not fit still take room in the store.
+absl::Status MoveModelFilesToStore(SharedModelStore& store,
+                                   RegisterModelRequest& request);
+
+// Copies the shared model files of the request from the store back into its
+// `model_files`, for the inference modules to load. Fails if the request has
+// shared files but there is no store, or if a file is not within it.
+absl::Status ReadModelFilesFromStore(const SharedModelStore* store,
+                                     RegisterModelRequest& request);
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_SHARED_MODEL_STORE_H_
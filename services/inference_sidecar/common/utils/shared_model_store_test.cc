@@ -0,0 +1,97 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/shared_model_store.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "gtest/gtest.h"
+#include "proto/inference_sidecar.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Maps the store a second time, as a sidecar would.
+std::unique_ptr<SharedModelStore> MapInSidecar(const SharedModelStore& store) {
+  absl::StatusOr<std::unique_ptr<SharedModelStore>> mapped =
+      SharedModelStore::Map(dup(store.FileDescriptor()));
+  EXPECT_TRUE(mapped.ok()) << mapped.status();
+  return *std::move(mapped);
+}
+
+TEST(SharedModelStoreTest, SharesModelFilesWithSidecars) {
+  absl::StatusOr<std::unique_ptr<SharedModelStore>> store =
+      SharedModelStore::Create(1024);
+  ASSERT_TRUE(store.ok()) << store.status();
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("model");
+  (*request.mutable_model_files())["model/a"] = "weights";
+  (*request.mutable_model_files())["model/b"] = "graph";
+
+  ASSERT_TRUE(MoveModelFilesToStore(**store, request).ok());
+  EXPECT_TRUE(request.model_files().empty());
+  EXPECT_EQ(request.shared_model_files().size(), 2);
+
+  std::unique_ptr<SharedModelStore> sidecar_store = MapInSidecar(**store);
+  EXPECT_EQ(sidecar_store->capacity(), 1024);
+  ASSERT_TRUE(ReadModelFilesFromStore(sidecar_store.get(), request).ok());
+  EXPECT_TRUE(request.shared_model_files().empty());
+  EXPECT_EQ(request.model_files().at("model/a"), "weights");
+  EXPECT_EQ(request.model_files().at("model/b"), "graph");
+}
+
+TEST(SharedModelStoreTest, LeavesRequestAsIsWhenFull) {
+  absl::StatusOr<std::unique_ptr<SharedModelStore>> store =
+      SharedModelStore::Create(8);
+  ASSERT_TRUE(store.ok()) << store.status();
+  RegisterModelRequest request;
+  (*request.mutable_model_files())["model/file"] = "0123456789";
+
+  EXPECT_EQ(MoveModelFilesToStore(**store, request).code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(request.model_files().at("model/file"), "0123456789");
+  EXPECT_TRUE(request.shared_model_files().empty());
+}
+
+TEST(SharedModelStoreTest, RejectsFilesOutOfTheStore) {
+  absl::StatusOr<std::unique_ptr<SharedModelStore>> store =
+      SharedModelStore::Create(16);
+  ASSERT_TRUE(store.ok()) << store.status();
+  RegisterModelRequest request;
+  SharedModelFile& file = (*request.mutable_shared_model_files())["model"];
+  file.set_offset(8);
+  file.set_size(~uint64_t{0});
+
+  EXPECT_FALSE(ReadModelFilesFromStore(store->get(), request).ok());
+  EXPECT_FALSE(ReadModelFilesFromStore(nullptr, request).ok());
+}
+
+TEST(SharedModelStoreTest, SidecarsCannotWriteTheStore) {
+  absl::StatusOr<std::unique_ptr<SharedModelStore>> store =
+      SharedModelStore::Create(4096);
+  ASSERT_TRUE(store.ok()) << store.status();
+
+  EXPECT_EQ(mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED,
+                 (*store)->FileDescriptor(), 0),
+            MAP_FAILED);
+  EXPECT_NE(ftruncate((*store)->FileDescriptor(), 8192), 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,131 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_log.h"
+#include "absl/status/status.h"
+#include "utils/cpu.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+// Index of the worker running on this thread, -1 off the pool.
+thread_local int current_worker = -1;
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads,
+                                               const std::vector<int>& cpus) {
+  if (num_threads <= 0) {
+    num_threads = cpus.empty()
+                      ? std::max<int>(std::thread::hardware_concurrency(), 1)
+                      : cpus.size();
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    std::optional<int> cpu;
+    if (!cpus.empty()) {
+      cpu = cpus[i % cpus.size()];
+    }
+    workers_[i]->thread =
+        std::thread(&WorkStealingThreadPool::Run, this, i, cpu);
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void WorkStealingThreadPool::Schedule(Task task) {
+  const int index =
+      current_worker >= 0
+          ? current_worker
+          : next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                workers_.size();
+  {
+    absl::MutexLock lock(&workers_[index]->mu);
+    workers_[index]->tasks.push_back(std::move(task));
+  }
+  absl::MutexLock lock(&mu_);
+  ++num_pending_;
+}
+
+std::optional<WorkStealingThreadPool::Task> WorkStealingThreadPool::Take(
+    int index) {
+  {
+    Worker& worker = *workers_[index];
+    absl::MutexLock lock(&worker.mu);
+    if (!worker.tasks.empty()) {
+      Task task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      return task;
+    }
+  }
+  for (size_t i = 1; i < workers_.size(); ++i) {
+    Worker& victim = *workers_[(index + i) % workers_.size()];
+    absl::MutexLock lock(&victim.mu);
+    if (!victim.tasks.empty()) {
+      Task task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      return task;
+    }
+  }
+  return std::nullopt;
+}
+
+void WorkStealingThreadPool::Run(int index, std::optional<int> cpu) {
+  current_worker = index;
+  if (cpu.has_value()) {
+    if (absl::Status status = SetCpuAffinity({*cpu}); !status.ok()) {
+      ABSL_LOG(WARNING) << "Could not pin worker " << index << " to CPU "
+                        << *cpu << ": " << status;
+    }
+  }
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(
+          +[](WorkStealingThreadPool* pool) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+               pool->mu_) { return pool->num_pending_ > 0 || pool->stopping_; },
+          this));
+      if (num_pending_ == 0) {
+        return;
+      }
+      --num_pending_;
+    }
+    // There is a queued task for each pending one taken. A scan can only miss
+    // it if another worker took it meanwhile, leaving its own for this one.
+    std::optional<Task> task;
+    while (!(task = Take(index)).has_value()) {
+      std::this_thread::yield();
+    }
+    std::move(*task)();
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,93 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_THREAD_POOL_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_THREAD_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Fixed set of worker threads running the inference tasks of the modules, in
+// place of a thread per task. Each worker has its own queue, which it runs
+// first in order, and steals from the back of the others once it is empty.
+// Thread-safe.
+class WorkStealingThreadPool {
+ public:
+  using Task = absl::AnyInvocable<void() &&>;
+
+  // num_threads: Number of workers. If not positive, one per CPU of cpus, or
+  // per CPU of the machine if cpus is empty.
+  // cpus: CPUs the workers are pinned to, one each in turn. Not pinned if
+  // empty.
+  explicit WorkStealingThreadPool(int num_threads,
+                                  const std::vector<int>& cpus = {});
+
+  // Runs the tasks left and joins the workers.
+  ~WorkStealingThreadPool();
+
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+  // Queues the task. Tasks scheduled from a worker go to its own queue.
+  void Schedule(Task task) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Queues fn and returns the future of its result, like std::async.
+  template <typename Fn>
+  std::future<std::invoke_result_t<Fn>> Submit(Fn fn) {
+    std::packaged_task<std::invoke_result_t<Fn>()> task(std::move(fn));
+    std::future<std::invoke_result_t<Fn>> result = task.get_future();
+    Schedule([task = std::move(task)]() mutable { task(); });
+    return result;
+  }
+
+  int size() const { return workers_.size(); }
+
+ private:
+  struct Worker {
+    absl::Mutex mu;
+    std::deque<Task> tasks ABSL_GUARDED_BY(mu);
+    std::thread thread;
+  };
+
+  void Run(int index, std::optional<int> cpu) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Takes a task from the worker's queue, or else from another's.
+  std::optional<Task> Take(int index);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<uint32_t> next_worker_ = 0;
+
+  absl::Mutex mu_;
+  // Number of tasks queued and not taken by any worker yet.
+  int64_t num_pending_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_THREAD_POOL_H_
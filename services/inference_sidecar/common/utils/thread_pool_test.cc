@@ -0,0 +1,68 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/thread_pool.h"
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+TEST(WorkStealingThreadPoolTest, SubmitReturnsTheResults) {
+  WorkStealingThreadPool pool(4);
+  EXPECT_EQ(pool.size(), 4);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.Submit([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, RunsTasksScheduledFromWorkers) {
+  WorkStealingThreadPool pool(2);
+  absl::BlockingCounter done(10);
+  pool.Schedule([&pool, &done]() {
+    for (int i = 0; i < 10; ++i) {
+      pool.Schedule([&done]() { done.DecrementCount(); });
+    }
+  });
+  done.Wait();
+}
+
+TEST(WorkStealingThreadPoolTest, RunsTheTasksLeftOnDestruction) {
+  std::atomic<int> num_run = 0;
+  {
+    WorkStealingThreadPool pool(2);
+    for (int i = 0; i < 50; ++i) {
+      pool.Schedule([&num_run]() { ++num_run; });
+    }
+  }
+  EXPECT_EQ(num_run, 50);
+}
+
+TEST(WorkStealingThreadPoolTest, SizesFromTheCpus) {
+  WorkStealingThreadPool pool(/*num_threads=*/0, /*cpus=*/{0});
+  EXPECT_EQ(pool.size(), 1);
+  EXPECT_EQ(pool.Submit([]() { return 1; }).get(), 1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
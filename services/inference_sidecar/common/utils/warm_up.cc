@@ -0,0 +1,95 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/warm_up.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr int kDefaultNumWarmUpRuns = 2;
+
+}  // namespace
+
+bool IsWarmUpRequestFile(absl::string_view model_path,
+                         absl::string_view file_path) {
+  return file_path == absl::StrCat(model_path, "/", kWarmUpRequestFileName) ||
+         file_path == absl::StrCat(model_path, ".", kWarmUpRequestFileName);
+}
+
+absl::StatusOr<std::vector<InferenceRequest>> ParseWarmUpRequest(
+    const RegisterModelRequest& request) {
+  const std::string& model_path = request.model_spec().model_path();
+  for (const auto& [file_path, bytes] : request.model_files()) {
+    if (!IsWarmUpRequestFile(model_path, file_path)) {
+      continue;
+    }
+    absl::StatusOr<std::vector<InferenceRequest>> warm_up_requests =
+        ParseJsonInferenceRequest(bytes);
+    if (!warm_up_requests.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid warm-up request for model ", model_path, ": ",
+                       warm_up_requests.status().message()));
+    }
+    for (const InferenceRequest& warm_up_request : *warm_up_requests) {
+      if (warm_up_request.model_path != model_path) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Warm-up request for model ", model_path, " has inputs for model ",
+            warm_up_request.model_path));
+      }
+    }
+    return warm_up_requests;
+  }
+  return std::vector<InferenceRequest>();
+}
+
+int NumWarmUpRuns(const InferenceSidecarRuntimeConfig& config) {
+  if (config.num_warm_up_runs() == 0) {
+    return kDefaultNumWarmUpRuns;
+  }
+  return std::max(config.num_warm_up_runs(), 0);
+}
+
+absl::Status RunWarmUp(
+    const std::vector<InferenceRequest>& requests, int num_runs,
+    WorkStealingThreadPool& thread_pool,
+    const std::function<absl::Status(const InferenceRequest&)>& run) {
+  std::vector<std::future<absl::Status>> runs;
+  for (int i = 0; i < num_runs; ++i) {
+    for (const InferenceRequest& request : requests) {
+      // Every run is waited for, the references outlive them.
+      runs.push_back(
+          thread_pool.Submit([&run, &request]() { return run(request); }));
+    }
+  }
+  absl::Status status;
+  for (auto& result : runs) {
+    status.Update(result.get());
+  }
+  if (!status.ok()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Warm-up failed: ", status.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -0,0 +1,62 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_WARM_UP_H_
+#define SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_WARM_UP_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "proto/inference_sidecar.pb.h"
+#include "utils/request_parser.h"
+#include "utils/thread_pool.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+
+// Name of the file of a model bundle holding the sample inputs the model runs
+// at registration, in the JSON format of `PredictRequest.input`. It is either
+// `<model path>/warm_up_request.json` in the directory of a model, or
+// `<model path>.warm_up_request.json` next to a single-file model.
+inline constexpr absl::string_view kWarmUpRequestFileName =
+    "warm_up_request.json";
+
+// Returns true if the file of the bundle is its warm-up request rather than a
+// part of the model.
+bool IsWarmUpRequestFile(absl::string_view model_path,
+                         absl::string_view file_path);
+
+// Parses the warm-up request of the bundle, whose inputs must all be for the
+// registered model. Empty if the bundle has none.
+absl::StatusOr<std::vector<InferenceRequest>> ParseWarmUpRequest(
+    const RegisterModelRequest& request);
+
+// Number of warm-up runs of each model. Defaults to 2, which lets the PyTorch
+// profiling executor optimize the graph of a model. None if negative.
+int NumWarmUpRuns(const InferenceSidecarRuntimeConfig& config);
+
+// Runs each warm-up input num_runs times, spread over the worker threads so
+// that their thread-local state is set up as well, and returns the first
+// error.
+absl::Status RunWarmUp(
+    const std::vector<InferenceRequest>& requests, int num_runs,
+    WorkStealingThreadPool& thread_pool,
+    const std::function<absl::Status(const InferenceRequest&)>& run);
+
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
+
+#endif  // SERVICES_INFERENCE_SIDECAR_COMMON_UTILS_WARM_UP_H_
@@ -0,0 +1,110 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "utils/warm_up.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "gtest/gtest.h"
+#include "proto/inference_sidecar.pb.h"
+#include "utils/request_parser.h"
+#include "utils/thread_pool.h"
+
+namespace privacy_sandbox::bidding_auction_servers::inference {
+namespace {
+
+constexpr absl::string_view kWarmUpRequest = R"json({
+  "request" : [{
+    "model_path" : "my_model",
+    "tensors" : [
+    {
+      "data_type": "FLOAT",
+      "tensor_shape": [1, 1],
+      "tensor_content": ["3.14"]
+    }
+  ]
+}]
+})json";
+
+TEST(WarmUpTest, FindsWarmUpRequestFiles) {
+  EXPECT_TRUE(IsWarmUpRequestFile("models/a", "models/a/warm_up_request.json"));
+  EXPECT_TRUE(IsWarmUpRequestFile("models/a.pt",
+                                  "models/a.pt.warm_up_request.json"));
+  EXPECT_FALSE(IsWarmUpRequestFile("models/a", "models/a/saved_model.pb"));
+  EXPECT_FALSE(
+      IsWarmUpRequestFile("models/a", "models/a/b/warm_up_request.json"));
+}
+
+TEST(WarmUpTest, ParsesWarmUpRequest) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("my_model");
+  (*request.mutable_model_files())["my_model/saved_model.pb"] = "";
+  absl::StatusOr<std::vector<InferenceRequest>> warm_up_requests =
+      ParseWarmUpRequest(request);
+  ASSERT_TRUE(warm_up_requests.ok()) << warm_up_requests.status();
+  EXPECT_TRUE(warm_up_requests->empty());
+
+  (*request.mutable_model_files())["my_model/warm_up_request.json"] =
+      std::string(kWarmUpRequest);
+  warm_up_requests = ParseWarmUpRequest(request);
+  ASSERT_TRUE(warm_up_requests.ok()) << warm_up_requests.status();
+  ASSERT_EQ(warm_up_requests->size(), 1);
+  EXPECT_EQ((*warm_up_requests)[0].model_path, "my_model");
+}
+
+TEST(WarmUpTest, RejectsInputsForOtherModels) {
+  RegisterModelRequest request;
+  request.mutable_model_spec()->set_model_path("other_model");
+  (*request.mutable_model_files())["other_model/warm_up_request.json"] =
+      std::string(kWarmUpRequest);
+  EXPECT_EQ(ParseWarmUpRequest(request).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(WarmUpTest, RunsEachRequestNumRunsTimes) {
+  InferenceRequest request = {.model_path = "my_model"};
+  WorkStealingThreadPool thread_pool(2);
+  absl::Mutex mu;
+  int num_runs = 0;
+  EXPECT_TRUE(RunWarmUp({request, request}, 3, thread_pool,
+                        [&](const InferenceRequest& run_request) {
+                          absl::MutexLock lock(&mu);
+                          ++num_runs;
+                          return absl::OkStatus();
+                        })
+                  .ok());
+  EXPECT_EQ(num_runs, 6);
+
+  EXPECT_EQ(RunWarmUp({request}, 1, thread_pool,
+                      [](const InferenceRequest& run_request) {
+                        return absl::InternalError("Model crashed");
+                      })
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(WarmUpTest, DefaultsToTwoRuns) {
+  InferenceSidecarRuntimeConfig config;
+  EXPECT_EQ(NumWarmUpRuns(config), 2);
+  config.set_num_warm_up_runs(-1);
+  EXPECT_EQ(NumWarmUpRuns(config), 0);
+  config.set_num_warm_up_runs(5);
+  EXPECT_EQ(NumWarmUpRuns(config), 5);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -14,52 +14,97 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <future>
 #include <istream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <torch/torch.h>
 
-#include "absl/base/thread_annotations.h"
-#include "absl/container/flat_hash_map.h"
+#include "absl/log/absl_log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
-#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "modules/module_interface.h"
 #include "proto/inference_sidecar.pb.h"
 #include "src/util/status_macro/status_macros.h"
+#include "utils/batch_output.h"
+#include "utils/cpu.h"
+#include "utils/dynamic_batcher.h"
+#include "utils/model_executor.h"
+#include "utils/model_metrics.h"
+#include "utils/model_registry.h"
 #include "utils/request_parser.h"
+#include "utils/thread_pool.h"
+#include "utils/warm_up.h"
 
 #include "pytorch_parser.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
 
-// Called on worker thread to dispatch per request inference task. It returns
-// the inference result for a single request in a batched predict request.
-// The forward method of a torch module is non-const although we disallow
-// mutable models.
-absl::StatusOr<torch::IValue> PredictInternal(torch::jit::script::Module* model,
-                                              const InferenceRequest& request) {
-  absl::string_view model_key = request.model_path;
+// A registered model.
+struct PyTorchModel {
+  torch::jit::script::Module module;
+  // Whether the weights of the module are in bfloat16. Its float32 inputs and
+  // outputs are cast from and to bfloat16 around each forward call.
+  bool bf16 = false;
+};
+
+// Inputs of an inference request, batched with the inputs of concurrent
+// requests to the same model.
+struct BatchInput {
+  PyTorchModel* model;
+  absl::string_view model_key;
   std::vector<torch::jit::IValue> inputs;
-  for (Tensor tensor : request.inputs) {
-    const absl::StatusOr<torch::Tensor> torch_tensor =
-        ConvertFlatArrayToTensor(tensor);
-    if (!torch_tensor.ok()) {
-      return absl::InvalidArgumentError(absl::StrCat(
-          "Model ", model_key, " encounters tensor parsing error: ",
-          torch_tensor.status().message()));
+};
+
+using Batcher = DynamicBatcher<BatchInput, torch::IValue>;
+
+// Casts the tensors of `value` of type `from` to type `to`, including those of
+// tuples.
+torch::IValue CastTensors(const torch::IValue& value, torch::ScalarType from,
+                          torch::ScalarType to) {
+  if (value.isTensor() && value.toTensor().scalar_type() == from) {
+    return value.toTensor().to(to);
+  }
+  if (value.isTuple()) {
+    std::vector<torch::IValue> elements;
+    for (const torch::IValue& element : value.toTuple()->elements()) {
+      elements.push_back(CastTensors(element, from, to));
     }
-    inputs.push_back(*std::move(torch_tensor));
+    return c10::ivalue::Tuple::create(std::move(elements));
   }
-  torch::IValue inference_result;
+  return value;
+}
+
+// The forward method of a torch module is non-const although we disallow
+// mutable models.
+absl::StatusOr<torch::IValue> Forward(
+    PyTorchModel* model, absl::string_view model_key,
+    const std::vector<torch::jit::IValue>& inputs) {
   // Convert PyTorch exception to absl status.
   try {
     // Guard against Autograd.
     c10::InferenceMode guard;
-    return model->forward(inputs);
+    if (!model->bf16) {
+      return model->module.forward(inputs);
+    }
+    std::vector<torch::jit::IValue> bf16_inputs;
+    bf16_inputs.reserve(inputs.size());
+    for (const torch::jit::IValue& input : inputs) {
+      bf16_inputs.push_back(
+          CastTensors(input, torch::kFloat, torch::kBFloat16));
+    }
+    return CastTensors(model->module.forward(bf16_inputs), torch::kBFloat16,
+                       torch::kFloat);
   } catch (const std::exception& e) {
     return absl::InternalError(absl::StrCat(
         "Model ", model_key,
@@ -71,6 +116,239 @@ absl::StatusOr<torch::IValue> PredictInternal(torch::jit::script::Module* model,
   }
 }
 
+// Returns the key of the batches the inputs can join, or nullopt if they
+// cannot be batched along their first dimension. Inputs are batched with
+// inputs of the same model version, types and shapes but for the first
+// dimension.
+std::optional<std::string> BatchKey(
+    const PyTorchModel* model, absl::string_view model_key,
+    const std::vector<torch::jit::IValue>& inputs) {
+  if (inputs.empty()) {
+    return std::nullopt;
+  }
+  std::string key = absl::StrCat(
+      model_key, "@", absl::Hex(reinterpret_cast<uintptr_t>(model)));
+  const int64_t num_rows = inputs.front().toTensor().dim() > 0
+                               ? inputs.front().toTensor().size(0)
+                               : 0;
+  for (const torch::jit::IValue& input : inputs) {
+    const torch::Tensor& tensor = input.toTensor();
+    if (tensor.dim() == 0 || tensor.size(0) != num_rows) {
+      return std::nullopt;
+    }
+    absl::StrAppend(&key, "|", c10::toString(tensor.scalar_type()));
+    for (int64_t dim = 1; dim < tensor.dim(); ++dim) {
+      absl::StrAppend(&key, ",", tensor.size(dim));
+    }
+  }
+  return key;
+}
+
+// Splits the output of a batch along its first dimension, back into the
+// outputs of each of the batched requests.
+absl::StatusOr<std::vector<torch::IValue>> SplitOutput(
+    const torch::IValue& output, const std::vector<int64_t>& num_rows) {
+  const int64_t total_rows =
+      std::accumulate(num_rows.begin(), num_rows.end(), int64_t{0});
+  auto split_tensor = [&num_rows, total_rows](const torch::IValue& value)
+      -> absl::StatusOr<std::vector<torch::Tensor>> {
+    if (!value.isTensor() || value.toTensor().dim() == 0 ||
+        value.toTensor().size(0) != total_rows) {
+      return absl::InvalidArgumentError(
+          "The output does not have a row per batched input");
+    }
+    std::vector<torch::Tensor> parts;
+    int64_t offset = 0;
+    for (int64_t rows : num_rows) {
+      parts.push_back(value.toTensor().narrow(0, offset, rows));
+      offset += rows;
+    }
+    return parts;
+  };
+
+  std::vector<torch::IValue> outputs;
+  if (output.isTensor()) {
+    PS_ASSIGN_OR_RETURN(std::vector<torch::Tensor> parts, split_tensor(output));
+    outputs.assign(parts.begin(), parts.end());
+    return outputs;
+  }
+  if (!output.isTuple()) {
+    return absl::InvalidArgumentError("The output cannot be split");
+  }
+  std::vector<std::vector<torch::IValue>> elements(num_rows.size());
+  for (const torch::IValue& element : output.toTuple()->elements()) {
+    PS_ASSIGN_OR_RETURN(std::vector<torch::Tensor> parts,
+                        split_tensor(element));
+    for (size_t i = 0; i < parts.size(); ++i) {
+      elements[i].push_back(std::move(parts[i]));
+    }
+  }
+  for (auto& tuple_elements : elements) {
+    outputs.push_back(c10::ivalue::Tuple::create(std::move(tuple_elements)));
+  }
+  return outputs;
+}
+
+// Evaluates a batch with a single forward call on concatenated inputs. It
+// falls back to evaluating the requests one by one if the output of the model
+// cannot be split by request.
+std::vector<absl::StatusOr<torch::IValue>> ForwardBatch(
+    const std::string& key, std::vector<BatchInput>& batch) {
+  std::vector<absl::StatusOr<torch::IValue>> outputs;
+  if (batch.size() > 1) {
+    std::vector<int64_t> num_rows;
+    for (const BatchInput& input : batch) {
+      num_rows.push_back(input.inputs.front().toTensor().size(0));
+    }
+    std::vector<torch::jit::IValue> batched_inputs;
+    for (size_t i = 0; i < batch.front().inputs.size(); ++i) {
+      std::vector<torch::Tensor> tensors;
+      for (const BatchInput& input : batch) {
+        tensors.push_back(input.inputs[i].toTensor());
+      }
+      c10::InferenceMode guard;
+      batched_inputs.push_back(torch::cat(tensors));
+    }
+    absl::StatusOr<torch::IValue> batched_output = Forward(
+        batch.front().model, batch.front().model_key, batched_inputs);
+    if (!batched_output.ok()) {
+      outputs.assign(batch.size(), batched_output.status());
+      return outputs;
+    }
+    absl::StatusOr<std::vector<torch::IValue>> split_outputs =
+        SplitOutput(*batched_output, num_rows);
+    if (split_outputs.ok()) {
+      outputs.assign(split_outputs->begin(), split_outputs->end());
+      return outputs;
+    }
+    ABSL_LOG_FIRST_N(WARNING, 1)
+        << "Evaluating the batch of " << key
+        << " one by one: " << split_outputs.status();
+  }
+  for (const BatchInput& input : batch) {
+    outputs.push_back(Forward(input.model, input.model_key, input.inputs));
+  }
+  return outputs;
+}
+
+// Called on worker thread to dispatch per request inference task. It returns
+// the inference result for a single request in a batched predict request.
+// With a batcher, the request is evaluated together with concurrent requests
+// to the same model.
+absl::StatusOr<torch::IValue> PredictInternal(PyTorchModel* model,
+                                              const InferenceRequest& request,
+                                              Batcher* batcher) {
+  absl::string_view model_key = request.model_path;
+  std::vector<torch::jit::IValue> inputs;
+  for (Tensor tensor : request.inputs) {
+    const absl::StatusOr<torch::Tensor> torch_tensor =
+        ConvertFlatArrayToTensor(tensor);
+    if (!torch_tensor.ok()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Model ", model_key, " encounters tensor parsing error: ",
+          torch_tensor.status().message()));
+    }
+    inputs.push_back(*std::move(torch_tensor));
+  }
+  if (batcher != nullptr) {
+    if (std::optional<std::string> key = BatchKey(model, model_key, inputs);
+        key) {
+      return batcher->Run(*key, BatchInput{.model = model,
+                                           .model_key = model_key,
+                                           .inputs = std::move(inputs)});
+    }
+  }
+  return Forward(model, model_key, inputs);
+}
+
+// Output of a model converted on its worker thread, either to its part of the
+// JSON output or to its binary tensors.
+struct ConvertedOutput {
+  std::string json;
+  ModelTensors binary;
+};
+
+absl::StatusOr<ConvertedOutput> PredictAndConvert(
+    PyTorchModel* model, const InferenceRequest& request,
+    Batcher* batcher, bool binary_output) {
+  PS_ASSIGN_OR_RETURN(torch::IValue inference_output,
+                      PredictInternal(model, request, batcher));
+  const PerModelOutput output = {.model_path = request.model_path,
+                                 .inference_output =
+                                     std::move(inference_output)};
+  ConvertedOutput converted;
+  if (binary_output) {
+    PS_ASSIGN_OR_RETURN(converted.binary, ConvertModelOutputToBinary(output));
+  } else {
+    PS_ASSIGN_OR_RETURN(converted.json, ConvertModelOutputToJson(output));
+  }
+  return converted;
+}
+
+// Returns the largest absolute difference between the values of the tensors of
+// `output` and those of `reference`.
+absl::StatusOr<double> MaxDeviation(const torch::IValue& output,
+                                    const torch::IValue& reference) {
+  if (output.isTensor() && reference.isTensor()) {
+    const torch::Tensor& tensor = output.toTensor();
+    const torch::Tensor& reference_tensor = reference.toTensor();
+    if (tensor.sizes() != reference_tensor.sizes()) {
+      return absl::InvalidArgumentError("The shapes of the outputs differ");
+    }
+    if (tensor.numel() == 0) {
+      return 0.0;
+    }
+    c10::InferenceMode guard;
+    return (tensor.to(torch::kDouble) - reference_tensor.to(torch::kDouble))
+        .abs()
+        .max()
+        .item<double>();
+  }
+  if (output.isTuple() && reference.isTuple() &&
+      output.toTuple()->elements().size() ==
+          reference.toTuple()->elements().size()) {
+    double deviation = 0;
+    for (size_t i = 0; i < output.toTuple()->elements().size(); ++i) {
+      PS_ASSIGN_OR_RETURN(double element_deviation,
+                          MaxDeviation(output.toTuple()->elements()[i],
+                                       reference.toTuple()->elements()[i]));
+      deviation = std::max(deviation, element_deviation);
+    }
+    return deviation;
+  }
+  return absl::InvalidArgumentError(
+      "Only tensor and tuple of tensor outputs can be validated");
+}
+
+// Checks that the outputs of `model` on the warm-up requests do not deviate
+// from those of `reference` by more than `max_deviation`.
+absl::Status ValidateModel(
+    PyTorchModel& model, PyTorchModel& reference, absl::string_view model_key,
+    const std::vector<InferenceRequest>& warm_up_requests,
+    double max_deviation) {
+  for (const InferenceRequest& warm_up_request : warm_up_requests) {
+    PS_ASSIGN_OR_RETURN(
+        torch::IValue output,
+        PredictInternal(&model, warm_up_request, /*batcher=*/nullptr));
+    PS_ASSIGN_OR_RETURN(
+        torch::IValue reference_output,
+        PredictInternal(&reference, warm_up_request, /*batcher=*/nullptr));
+    absl::StatusOr<double> deviation = MaxDeviation(output, reference_output);
+    if (!deviation.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Model ", model_key, " cannot be validated: ",
+                       deviation.status().message()));
+    }
+    if (*deviation > max_deviation) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Model ", model_key, " deviates by ", *deviation,
+          " from its float32 outputs on its warm-up requests, more than ",
+          max_deviation));
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Initializes PyTorch runtime inter-operations and intra-operations parallelism
 // threading configurations.
 absl::Status InitRuntimeThreadConfig(
@@ -96,68 +374,133 @@ absl::Status InitRuntimeThreadConfig(
 
 class PyTorchModule final : public ModuleInterface {
  public:
-  explicit PyTorchModule(const InferenceSidecarRuntimeConfig& config) {
+  explicit PyTorchModule(const InferenceSidecarRuntimeConfig& config)
+      : optimize_for_inference_(config.optimize_for_inference()),
+        num_warm_up_runs_(NumWarmUpRuns(config)),
+        models_(int64_t{config.model_memory_budget_mb()} * 1024 * 1024),
+        thread_pool_(config.num_worker_threads(),
+                     {config.cpuset().begin(), config.cpuset().end()}),
+        executors_(thread_pool_) {
     absl::Status init_result = InitRuntimeThreadConfig(config);
     CHECK(init_result.ok())
         << "Could not initialize runtime flags: " << init_result;
+    if (config.max_batch_size() > 1) {
+      batcher_ = std::make_unique<Batcher>(
+          DynamicBatcherConfig{
+              .max_batch_size = config.max_batch_size(),
+              .max_queue_delay =
+                  absl::Microseconds(config.max_batch_queue_delay_us())},
+          &ForwardBatch);
+    }
   }
 
   absl::StatusOr<PredictResponse> Predict(
-      const PredictRequest& request) override ABSL_LOCKS_EXCLUDED(mu_);
+      const PredictRequest& request) override;
   absl::StatusOr<RegisterModelResponse> RegisterModel(
-      const RegisterModelRequest& request) override ABSL_LOCKS_EXCLUDED(mu_);
+      const RegisterModelRequest& request) override;
 
  private:
-  // The key to `model map` is the `model_path` field in an inference request.
-  absl::flat_hash_map<std::string, std::unique_ptr<torch::jit::script::Module>>
-      model_map_ ABSL_GUARDED_BY(mu_);
-  absl::Mutex mu_;
+  // Loads the model, applies its execution options, optimizes it if enabled,
+  // and runs its warm-up requests on the pool of the model.
+  absl::StatusOr<std::unique_ptr<PyTorchModel>> LoadModel(
+      const std::string& model_payload, absl::string_view model_key,
+      const ModelExecutionOptions& options,
+      const std::vector<InferenceRequest>& warm_up_requests,
+      WorkStealingThreadPool& thread_pool);
+
+  const bool optimize_for_inference_;
+  const int num_warm_up_runs_;
+  // Versions of the models, by the `model_path` field of inference requests.
+  ModelRegistry<PyTorchModel> models_;
+  // Batches inference requests across concurrent Predict calls, if enabled.
+  std::unique_ptr<Batcher> batcher_;
+  // Runs the inference of each model of the requests, unless the model has
+  // threads of its own.
+  WorkStealingThreadPool thread_pool_;
+  // Runs the inferences of each model with its resources. Destroyed with the
+  // pool first, so that no task outlives the models and the batcher.
+  ModelExecutors executors_;
 };
 
 absl::StatusOr<PredictResponse> PyTorchModule::Predict(
     const PredictRequest& request) {
-  absl::ReaderMutexLock lock(&mu_);
-
   absl::StatusOr<std::vector<InferenceRequest>> parsed_requests =
-      ParseJsonInferenceRequest(request.input());
+      request.has_binary_input()
+          ? ParseBinaryInferenceRequest(request.binary_input())
+          : ParseJsonInferenceRequest(request.input());
   if (!parsed_requests.ok()) {
     return absl::InvalidArgumentError(
         absl::StrCat("Encounters batch inference request parsing error: ",
                      parsed_requests.status().message()));
   }
 
-  std::vector<std::future<absl::StatusOr<torch::IValue>>> tasks;
+  // All the models are looked up before any task starts. The tasks own the
+  // current versions, which a registration may replace meanwhile.
+  std::vector<std::shared_ptr<PyTorchModel>> models;
   for (const InferenceRequest& inference_request : (*parsed_requests)) {
     absl::string_view model_key = inference_request.model_path;
-    auto it = model_map_.find(model_key);
-    if (it == model_map_.end()) {
+    std::shared_ptr<PyTorchModel> model = models_.Get(model_key);
+    if (model == nullptr) {
       return absl::NotFoundError(
           absl::StrCat("Model ", model_key, " has not been registered"));
     }
-    tasks.push_back(std::async(std::launch::async, &PredictInternal,
-                               it->second.get(), inference_request));
+    models.push_back(std::move(model));
+  }
+
+  // Each task converts the output of its model on the worker thread, leaving
+  // only their concatenation to this one.
+  const bool binary_output = request.has_binary_input();
+  const absl::Time deadline = PredictDeadline(request);
+  std::vector<std::future<MeasuredOutput<ConvertedOutput>>> tasks;
+  for (size_t i = 0; i < models.size(); ++i) {
+    // Tasks own a copy of their request, they may outlive this call if an
+    // earlier one fails.
+    ModelExecutor& executor =
+        executors_.Get((*parsed_requests)[i].model_path);
+    tasks.push_back(executor.Run<ConvertedOutput>(
+        (*parsed_requests)[i],
+        [model = models[i], batcher = batcher_.get(),
+         binary_output](const InferenceRequest& inference_request) {
+          return PredictAndConvert(model.get(), inference_request, batcher,
+                                   binary_output);
+        },
+        deadline));
   }
 
-  std::vector<PerModelOutput> batch_result_outputs;
-  for (size_t task_id = 0; task_id < tasks.size(); ++task_id) {
-    tasks[task_id].wait();
-    // TODO(b/329280402): Handle partial results for a batched requests.
-    // Currently, if some inference succeeds fails for some models but fails for
-    // others, the batch result returns the error code of the first failure
-    // task.
-    PS_ASSIGN_OR_RETURN(torch::IValue task_result, tasks[task_id].get());
-    PerModelOutput output;
-    output.model_path = (*parsed_requests)[task_id].model_path;
-    // TOOD(b/330899867): consider changing inference_output from torch::IValue
-    // to a json value so that the conversion is done in the worker threads
-    // instead of the main thread.
-    output.inference_output = task_result;
-    batch_result_outputs.push_back(output);
-  }
-  PS_ASSIGN_OR_RETURN(std::string output_json,
-                      ConvertBatchOutputsToJson(batch_result_outputs));
   PredictResponse response;
-  response.set_output(output_json);
+  std::vector<std::string> json_outputs;
+  json_outputs.reserve(tasks.size());
+  for (size_t task_id = 0; task_id < tasks.size(); ++task_id) {
+    MeasuredOutput<ConvertedOutput> task_result = tasks[task_id].get();
+    *response.add_model_metrics() = std::move(task_result.metrics);
+    if (!task_result.output.ok()) {
+      // Unless partial results are allowed, the batch result returns the
+      // error code of the first failure task.
+      if (!request.allow_partial_results()) {
+        return task_result.output.status();
+      }
+      absl::string_view model_key = (*parsed_requests)[task_id].model_path;
+      const absl::Status& status = task_result.output.status();
+      if (binary_output) {
+        *response.mutable_binary_output()->add_models() =
+            ModelErrorToBinary(model_key, status);
+      } else {
+        PS_ASSIGN_OR_RETURN(std::string json_output,
+                            ModelErrorToJson(model_key, status));
+        json_outputs.push_back(std::move(json_output));
+      }
+      continue;
+    }
+    if (binary_output) {
+      *response.mutable_binary_output()->add_models() =
+          std::move(task_result.output->binary);
+    } else {
+      json_outputs.push_back(std::move(task_result.output->json));
+    }
+  }
+  if (!binary_output) {
+    response.set_output(ConcatModelOutputsToJson(json_outputs));
+  }
   return response;
 }
 
@@ -167,32 +510,106 @@ absl::StatusOr<RegisterModelResponse> PyTorchModule::RegisterModel(
   if (model_key.empty()) {
     return absl::InvalidArgumentError("Empty model key during registration");
   }
-  if (request.model_files().size() != 1) {
+  // The bundle may carry a warm-up request next to the model file.
+  const std::string* model_payload = nullptr;
+  int num_model_files = 0;
+  for (const auto& [file_path, bytes] : request.model_files()) {
+    if (!IsWarmUpRequestFile(model_key, file_path)) {
+      model_payload = &bytes;
+      ++num_model_files;
+    }
+  }
+  if (num_model_files != 1) {
     return absl::InvalidArgumentError(absl::StrCat(
         "The number of model files should be exactly one to match size()=",
-        request.model_files().size()));
+        num_model_files));
   }
+  PS_ASSIGN_OR_RETURN(std::vector<InferenceRequest> warm_up_requests,
+                      ParseWarmUpRequest(request));
 
-  absl::WriterMutexLock lock(&mu_);
-  if (model_map_.find(model_key) != model_map_.end()) {
-    return absl::AlreadyExistsError(
-        absl::StrCat("Model ", model_key, " has already been registered"));
+  PS_ASSIGN_OR_RETURN(
+      ModelExecutor * executor,
+      executors_.Prepare(model_key, request.model_spec().resources()));
+  // Loaded and warmed up next to the current version, if any, which serves
+  // Predict calls meanwhile.
+  absl::Status status = models_.Register(
+      model_key, request.model_spec().version(), model_payload->size(),
+      [&]() {
+        return LoadModel(*model_payload, model_key,
+                         request.model_spec().execution_options(),
+                         warm_up_requests, executor->thread_pool());
+      });
+  executors_.Complete(model_key, executor, status.ok());
+  PS_RETURN_IF_ERROR(status);
+  return RegisterModelResponse();
+}
+
+absl::StatusOr<std::unique_ptr<PyTorchModel>> PyTorchModule::LoadModel(
+    const std::string& model_payload, absl::string_view model_key,
+    const ModelExecutionOptions& options,
+    const std::vector<InferenceRequest>& warm_up_requests,
+    WorkStealingThreadPool& thread_pool) {
+  if (options.xla_jit()) {
+    return absl::InvalidArgumentError(
+        "XLA compilation is only supported by TensorFlow models");
+  }
+  const bool bf16 = options.precision() == ModelExecutionOptions::BF16;
+  if (bf16 && !CpuSupportsBf16()) {
+    return absl::InvalidArgumentError(
+        "bfloat16 execution is not supported by the CPU");
+  }
+  const bool validate = options.max_output_deviation() > 0;
+  if (validate && warm_up_requests.empty()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Model ", model_key, " cannot be validated without warm-up request"));
   }
 
+  auto model = std::make_unique<PyTorchModel>();
+  // Float32 copy of the model to validate its reduced precision against.
+  std::optional<PyTorchModel> reference;
   // Convert PyTorch exception to absl status.
   try {
-    const std::string& model_payload = request.model_files().begin()->second;
     std::istringstream is(model_payload);
-    model_map_[model_key] =
-        std::make_unique<torch::jit::script::Module>(torch::jit::load(is));
+    model->module = torch::jit::load(is);
     // Turn on eval model for layers that behave differently during train and
     // eval times, for example, dropout and batch norm layers.
-    model_map_[model_key]->eval();
+    model->module.eval();
+    if (validate && bf16) {
+      reference.emplace(PyTorchModel{.module = model->module.clone()});
+    }
+    if (bf16) {
+      // Before freezing, which turns the weights into constants of the graph.
+      model->module.to(torch::kBFloat16);
+      model->bf16 = true;
+    }
   } catch (...) {
     return absl::InternalError("Error loading model");
   }
+  if (optimize_for_inference_) {
+    try {
+      // Freezes the parameters and attributes into constants, and fuses
+      // operators such as convolutions and batch norms.
+      model->module = torch::jit::optimize_for_inference(model->module);
+    } catch (const std::exception& e) {
+      return absl::InternalError(absl::StrCat(
+          "Error optimizing model ", model_key, " for inference: ", e.what()));
+    }
+  }
 
-  return RegisterModelResponse();
+  // The first calls would otherwise pay for JIT profiling, allocator growth
+  // and lazy kernel initializations.
+  PS_RETURN_IF_ERROR(RunWarmUp(
+      warm_up_requests, num_warm_up_runs_, thread_pool,
+      [model = model.get()](const InferenceRequest& warm_up_request) {
+        return PredictInternal(model, warm_up_request, /*batcher=*/nullptr)
+            .status();
+      }));
+  if (reference.has_value()) {
+    PS_RETURN_IF_ERROR(ValidateModel(*model, *reference, model_key,
+                                     warm_up_requests,
+                                     options.max_output_deviation()));
+  }
+  return model;
 }
 
 }  // namespace
@@ -16,6 +16,7 @@
 
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <rapidjson/writer.h>
@@ -23,6 +24,7 @@
 
 #include "rapidjson/document.h"
 #include "src/util/status_macro/status_macros.h"
+#include "utils/batch_output.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
 namespace {
@@ -104,6 +106,12 @@ absl::StatusOr<int64_t> Convert<int64_t>(const std::string& str) {
 template <typename T>
 absl::StatusOr<torch::Tensor> ConvertFlatArrayToTensorInternal(
     const Tensor& tensor) {
+  if (tensor.tensor_bytes.has_value()) {
+    // The values are copied as is into a tensor that owns them.
+    return torch::from_blob(const_cast<char*>(tensor.tensor_bytes->data()),
+                            tensor.tensor_shape, torch::dtype<T>())
+        .clone();
+  }
   std::vector<T> data_array;
   for (const std::string& str : tensor.tensor_content) {
     PS_ASSIGN_OR_RETURN(T result, Convert<T>(str));
@@ -181,6 +189,36 @@ absl::StatusOr<rapidjson::Value> TensorToJsonValue(
   return json_tensor;
 }
 
+// Converts a pytorch tensor to a BinaryTensor, copying its values as is.
+absl::StatusOr<BinaryTensor> TensorToBinary(const torch::Tensor& tensor) {
+  BinaryTensor binary_tensor;
+  for (int64_t dim : tensor.sizes()) {
+    binary_tensor.add_tensor_shape(dim);
+  }
+  caffe2::TypeMeta dtype = tensor.dtype();
+  if (dtype == torch::ScalarType::Float) {
+    binary_tensor.set_data_type(BinaryTensor::FLOAT);
+  } else if (dtype == torch::ScalarType::Double) {
+    binary_tensor.set_data_type(BinaryTensor::DOUBLE);
+  } else if (dtype == torch::ScalarType::Char) {
+    binary_tensor.set_data_type(BinaryTensor::INT8);
+  } else if (dtype == torch::ScalarType::Short) {
+    binary_tensor.set_data_type(BinaryTensor::INT16);
+  } else if (dtype == torch::ScalarType::Int) {
+    binary_tensor.set_data_type(BinaryTensor::INT32);
+  } else if (dtype == torch::ScalarType::Long) {
+    binary_tensor.set_data_type(BinaryTensor::INT64);
+  } else {
+    return absl::InternalError(
+        absl::StrCat("Unsupported type ", std::string(dtype.name())));
+  }
+  const torch::Tensor contiguous_tensor = tensor.contiguous();
+  binary_tensor.set_tensor_content(
+      static_cast<const char*>(contiguous_tensor.data_ptr()),
+      contiguous_tensor.nbytes());
+  return binary_tensor;
+}
+
 // Extracts pytorch tensors from inference_result and converts them to
 // rapidjson::Value.
 absl::StatusOr<rapidjson::Value> IValueToJsonValue(
@@ -237,30 +275,67 @@ absl::StatusOr<torch::Tensor> ConvertFlatArrayToTensor(const Tensor& tensor) {
   }
 }
 
-absl::StatusOr<std::string> ConvertBatchOutputsToJson(
-    const std::vector<PerModelOutput>& batch_outputs) {
+absl::StatusOr<std::string> ConvertModelOutputToJson(
+    const PerModelOutput& output) {
   rapidjson::Document document;
   document.SetObject();
   rapidjson::MemoryPoolAllocator<>& allocator = document.GetAllocator();
 
-  rapidjson::Value batch(rapidjson::kArrayType);
-  for (const PerModelOutput& output : batch_outputs) {
-    const std::string model_path = output.model_path;
-    const torch::IValue tensors = output.inference_output;
+  rapidjson::Value model_path_value;
+  model_path_value.SetString(output.model_path.c_str(), allocator);
+  document.AddMember("model_path", model_path_value, allocator);
 
-    rapidjson::Value nested_object(rapidjson::kObjectType);
-    rapidjson::Value model_path_value;
-    model_path_value.SetString(model_path.c_str(), allocator);
-    nested_object.AddMember("model_path", model_path_value, allocator);
+  PS_ASSIGN_OR_RETURN(
+      rapidjson::Value tensors_value,
+      IValueToJsonValue(output.model_path, output.inference_output, allocator));
+  document.AddMember("tensors", tensors_value.Move(), allocator);
 
-    PS_ASSIGN_OR_RETURN(rapidjson::Value tensors_value,
-                        IValueToJsonValue(model_path, tensors, allocator));
+  return SerializeJsonDoc(document);
+}
 
-    nested_object.AddMember("tensors", tensors_value.Move(), allocator);
-    batch.PushBack(nested_object.Move(), allocator);
+absl::StatusOr<std::string> ConvertBatchOutputsToJson(
+    const std::vector<PerModelOutput>& batch_outputs) {
+  std::vector<std::string> model_outputs;
+  model_outputs.reserve(batch_outputs.size());
+  for (const PerModelOutput& output : batch_outputs) {
+    PS_ASSIGN_OR_RETURN(std::string model_output,
+                        ConvertModelOutputToJson(output));
+    model_outputs.push_back(std::move(model_output));
   }
-  document.AddMember("response", batch.Move(), allocator);
+  return ConcatModelOutputsToJson(model_outputs);
+}
 
-  return SerializeJsonDoc(document);
+absl::StatusOr<ModelTensors> ConvertModelOutputToBinary(
+    const PerModelOutput& output) {
+  ModelTensors model_tensors;
+  model_tensors.set_model_path(output.model_path);
+
+  std::vector<torch::Tensor> tensors;
+  if (output.inference_output.isTensor()) {
+    tensors.push_back(output.inference_output.toTensor());
+  } else if (output.inference_output.isTuple()) {
+    for (const torch::IValue& element :
+         output.inference_output.toTuple()->elements()) {
+      tensors.push_back(element.toTensor());
+    }
+  } else {
+    return absl::InternalError(absl::StrCat("Model ", output.model_path,
+                                            " produces a non supported "
+                                            "output type"));
+  }
+  for (const torch::Tensor& tensor : tensors) {
+    PS_ASSIGN_OR_RETURN(*model_tensors.add_tensors(), TensorToBinary(tensor));
+  }
+  return model_tensors;
+}
+
+absl::StatusOr<BatchTensors> ConvertBatchOutputsToBinary(
+    const std::vector<PerModelOutput>& batch_outputs) {
+  BatchTensors batch_tensors;
+  for (const PerModelOutput& output : batch_outputs) {
+    PS_ASSIGN_OR_RETURN(*batch_tensors.add_models(),
+                        ConvertModelOutputToBinary(output));
+  }
+  return batch_tensors;
 }
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -22,6 +22,7 @@
 #include <torch/script.h>
 
 #include "absl/status/statusor.h"
+#include "proto/inference_sidecar.pb.h"
 #include "utils/request_parser.h"
 
 namespace privacy_sandbox::bidding_auction_servers::inference {
@@ -35,10 +36,25 @@ struct PerModelOutput {
 // one-dimensional array) into a PyTorch tensor and the desired tensor shape.
 absl::StatusOr<torch::Tensor> ConvertFlatArrayToTensor(const Tensor& tensor);
 
+// Converts the inference output of a model to a JSON object string, part of
+// the output of the batch. Called on the worker thread of the model.
+absl::StatusOr<std::string> ConvertModelOutputToJson(
+    const PerModelOutput& output);
+
 // Converts inference output corresponding to each model to a JSON string.
 absl::StatusOr<std::string> ConvertBatchOutputsToJson(
     const std::vector<PerModelOutput>& batch_outputs);
 
+// Converts the inference output of a model to binary tensors, without
+// per-value conversion. Called on the worker thread of the model.
+absl::StatusOr<ModelTensors> ConvertModelOutputToBinary(
+    const PerModelOutput& output);
+
+// Converts inference output corresponding to each model to binary tensors,
+// without per-value conversion.
+absl::StatusOr<BatchTensors> ConvertBatchOutputsToBinary(
+    const std::vector<PerModelOutput>& batch_outputs);
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
 
 #endif  // SERVICES_INFERENCE_SIDECAR_MODULES_PYTORCH_V2_1_1_PYTORCH_PARSER_H_
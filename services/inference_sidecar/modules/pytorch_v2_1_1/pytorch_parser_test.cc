@@ -178,6 +178,18 @@ TEST(PyTorchModuleTest, ConvertBatchOutputsToJson_SimpleTest) {
   EXPECT_EQ(result.value(), expected_json);
 }
 
+TEST(PyTorchModuleTest, ConvertModelOutputToJson_SimpleTest) {
+  PerModelOutput output;
+  output.model_path = "/path/to/model";
+  output.inference_output = torch::tensor({1, 2, 3});
+
+  absl::StatusOr<std::string> result = ConvertModelOutputToJson(output);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(
+      result.value(),
+      R"({"model_path":"/path/to/model","tensors":[{"tensor_shape":[3],"data_type":"INT64","tensor_content":[1,2,3]}]})");
+}
+
 TEST(PyTorchModuleTest, ConvertBatchOutputsToJsonTest_FloatDoubleInputTypes) {
   PerModelOutput output;
   output.model_path = "/path/to/model";
@@ -248,5 +260,41 @@ TEST(PyTorchModuleTest, ConvertBatchOutputsToJsonTest_2Models) {
   EXPECT_EQ(result.value(), expected_json);
 }
 
+TEST(PyTorchModuleTest, TestConversion_BinaryContent) {
+  const double values[] = {1.5, -2, 3, 4, 5, 6};
+  Tensor tensor;
+  tensor.data_type = DataType::kDouble;
+  tensor.tensor_bytes =
+      std::string(reinterpret_cast<const char*>(values), sizeof(values));
+  tensor.tensor_shape = {3, 2};
+
+  const absl::StatusOr<torch::Tensor> result = ConvertFlatArrayToTensor(tensor);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->sizes(), (std::vector<int64_t>{3, 2}));
+  EXPECT_EQ(result->dtype(), torch::ScalarType::Double);
+  EXPECT_TRUE(torch::equal(
+      *result, torch::tensor({1.5, -2.0, 3.0, 4.0, 5.0, 6.0}).view({3, 2})));
+}
+
+TEST(PyTorchModuleTest, ConvertBatchOutputsToBinary_SimpleTest) {
+  PerModelOutput output;
+  output.model_path = "/path/to/model";
+  output.inference_output = torch::tensor({1, 2, 3});
+
+  absl::StatusOr<BatchTensors> result = ConvertBatchOutputsToBinary({output});
+  ASSERT_TRUE(result.ok()) << result.status();
+  ASSERT_EQ(result->models_size(), 1);
+  EXPECT_EQ(result->models(0).model_path(), "/path/to/model");
+  ASSERT_EQ(result->models(0).tensors_size(), 1);
+  const BinaryTensor& tensor = result->models(0).tensors(0);
+  EXPECT_EQ(tensor.data_type(), BinaryTensor::INT64);
+  EXPECT_EQ(tensor.tensor_shape_size(), 1);
+  EXPECT_EQ(tensor.tensor_shape(0), 3);
+  const int64_t expected_values[] = {1, 2, 3};
+  EXPECT_EQ(tensor.tensor_content(),
+            std::string(reinterpret_cast<const char*>(expected_values),
+                        sizeof(expected_values)));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
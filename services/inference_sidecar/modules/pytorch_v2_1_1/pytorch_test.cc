@@ -219,6 +219,152 @@ TEST(PyTorchModulePredictTest, PredictSimpleSuccess) {
       "shape\":[1],\"data_type\":\"DOUBLE\",\"tensor_content\":[3.14]}]}]}");
 }
 
+TEST(PyTorchModuleRegisterModelTest, RegisterModelWithWarmUpRequestOk) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  (*register_request.mutable_model_files())[absl::StrCat(
+      kSimpleModel, ".warm_up_request.json")] = kSimpleRequest;
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kSimpleRequest);
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(
+      result->output(),
+      "{\"response\":[{\"model_path\":\"simple_model\",\"tensors\":[{\"tensor_"
+      "shape\":[1],\"data_type\":\"DOUBLE\",\"tensor_content\":[3.14]}]}]}");
+}
+
+TEST(PyTorchModuleRegisterModelTest,
+     RegisterModelWithFailingWarmUpReturnsFailedPrecondition) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  (*register_request.mutable_model_files())[absl::StrCat(
+      kSimpleModel, ".warm_up_request.json")] = kInvalidTensorContentRequest;
+  EXPECT_EQ(torch_module->RegisterModel(register_request).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  // The model is not registered and can be registered again.
+  register_request.mutable_model_files()->erase(
+      absl::StrCat(kSimpleModel, ".warm_up_request.json"));
+  EXPECT_TRUE(torch_module->RegisterModel(register_request).ok());
+}
+
+TEST(PyTorchModuleRegisterModelTest, RegisterModelOptimizedForInferenceOk) {
+  InferenceSidecarRuntimeConfig config;
+  config.set_optimize_for_inference(true);
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kSimpleRequest);
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+}
+
+TEST(PyTorchModuleRegisterModelTest, RegisterModelWithXlaReturnsError) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  register_request.mutable_model_spec()
+      ->mutable_execution_options()
+      ->set_xla_jit(true);
+  EXPECT_EQ(torch_module->RegisterModel(register_request).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(PyTorchModuleRegisterModelTest,
+     RegisterModelValidationWithoutWarmUpRequestReturnsError) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  register_request.mutable_model_spec()
+      ->mutable_execution_options()
+      ->set_max_output_deviation(0.01);
+  EXPECT_EQ(torch_module->RegisterModel(register_request).status().code(),
+            absl::StatusCode::kInvalidArgument);
+
+  (*register_request.mutable_model_files())[absl::StrCat(
+      kSimpleModel, ".warm_up_request.json")] = kSimpleRequest;
+  EXPECT_TRUE(torch_module->RegisterModel(register_request).ok());
+}
+
+TEST(PyTorchModuleRegisterModelTest, RegisterNewModelVersionOk) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  register_request.mutable_model_spec()->set_version("1");
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  register_request.mutable_model_spec()->set_version("2");
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+  EXPECT_EQ(torch_module->RegisterModel(register_request).status().code(),
+            absl::StatusCode::kAlreadyExists);
+
+  PredictRequest predict_request;
+  predict_request.set_input(kSimpleRequest);
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+}
+
+TEST(PyTorchModulePredictTest, PredictBinaryInputReturnsBinaryOutput) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  const double value = 3.14;
+  const std::string content(reinterpret_cast<const char*>(&value),
+                            sizeof(value));
+  PredictRequest predict_request;
+  ModelTensors* model_tensors =
+      predict_request.mutable_binary_input()->add_models();
+  model_tensors->set_model_path(kSimpleModel);
+  BinaryTensor* tensor = model_tensors->add_tensors();
+  tensor->set_data_type(BinaryTensor::DOUBLE);
+  tensor->add_tensor_shape(1);
+  tensor->set_tensor_content(content);
+
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_TRUE(result->output().empty());
+  // The simple model returns its input.
+  ASSERT_EQ(result->binary_output().models_size(), 1);
+  EXPECT_EQ(result->binary_output().models(0).model_path(), kSimpleModel);
+  ASSERT_EQ(result->binary_output().models(0).tensors_size(), 1);
+  EXPECT_EQ(result->binary_output().models(0).tensors(0).tensor_content(),
+            content);
+}
+
 constexpr char kNotRegisteredModelRequest[] = R"json({
   "request" : [{
     "model_path" : "not_registered",
@@ -464,6 +610,57 @@ TEST(PyTorchModulePredictTest,
       "\"data_type\":\"DOUBLE\",\"tensor_content\":[2.718,1.0,1.0]}]}]}");
 }
 
+TEST(PyTorchModulePredictTest,
+     PredictBatchesRequestsToTheSameModelAcrossCalls) {
+  InferenceSidecarRuntimeConfig config;
+  config.set_max_batch_size(2);
+  config.set_max_batch_queue_delay_us(10000000);
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  // The two requests, of 2 and 3 rows, are evaluated as one batch of 5 rows
+  // and get their own rows back.
+  PredictRequest predict_request;
+  predict_request.set_input(kSameModelVariedBatchSizesMultipleRequests);
+
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(
+      result->output(),
+      "{\"response\":[{\"model_path\":\"simple_model\",\"tensors\":[{\"tensor_"
+      "shape\":[2,1],\"data_type\":\"DOUBLE\",\"tensor_content\":[3.14,1.0]}]},"
+      "{\"model_path\":\"simple_model\",\"tensors\":[{\"tensor_shape\":[3,1],"
+      "\"data_type\":\"DOUBLE\",\"tensor_content\":[2.718,1.0,1.0]}]}]}");
+}
+
+TEST(PyTorchModulePredictTest, PredictRunsPartialBatchesAfterTheDelay) {
+  InferenceSidecarRuntimeConfig config;
+  config.set_max_batch_size(8);
+  config.set_max_batch_queue_delay_us(1000);
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kSimpleRequestBatchSize2);
+
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->output(),
+            "{\"response\":[{\"model_path\":\"simple_model\",\"tensors\":[{"
+            "\"tensor_shape\":[2,1],\"data_type\":\"DOUBLE\",\"tensor_"
+            "content\":[3.14,2.718]}]}]}");
+}
+
 constexpr char kRequestsWithMultipleInvalidInputs[] = R"json({
   "request" : [{
     "model_path" : "simple_model",
@@ -556,6 +753,38 @@ TEST(PyTorchModulePredictTest, PredictBothValidAndInvalidInputsReturnsError) {
       absl::StrContains(result.status().message(), "tensor parsing error"));
 }
 
+TEST(PyTorchModulePredictTest,
+     PredictBothValidAndInvalidInputsReturnsPartialResults) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> torch_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(kSimpleModel, register_request).ok());
+  ASSERT_TRUE(torch_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kBothValidAndInvalidInputs);
+  predict_request.set_allow_partial_results(true);
+
+  const absl::StatusOr<PredictResponse> result =
+      torch_module->Predict(predict_request);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_TRUE(absl::StartsWith(
+      result->output(),
+      "{\"response\":[{\"model_path\":\"simple_model\",\"tensors\":[{\"tensor_"
+      "shape\":[1],\"data_type\":\"DOUBLE\",\"tensor_content\":[3.14]}]},{"
+      "\"model_path\":\"simple_model\",\"error\":{\"code\":3,"));
+  EXPECT_TRUE(absl::StrContains(result->output(), "tensor parsing error"));
+  // Each model reports its metrics, along with its error.
+  ASSERT_EQ(result->model_metrics_size(), 2);
+  EXPECT_EQ(result->model_metrics(0).model_path(), "simple_model");
+  EXPECT_EQ(result->model_metrics(0).batch_size(), 1);
+  EXPECT_EQ(result->model_metrics(0).error_code(), 0);
+  EXPECT_EQ(result->model_metrics(1).error_code(),
+            static_cast<int>(absl::StatusCode::kInvalidArgument));
+}
+
 constexpr char kVariedInputsRequestBatchSize1[] = R"json({
   "request" : [{
     "model_path" : "e2e_model1",
@@ -14,21 +14,32 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <future>
 #include <iomanip>
 #include <iostream>
 #include <istream>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/absl_log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "modules/module_interface.h"
 #include "proto/inference_sidecar.pb.h"
 #include "src/util/status_macro/status_macros.h"
@@ -36,11 +47,22 @@
 #include "tensorflow/cc/saved_model/loader.h"
 #include "tensorflow/cc/saved_model/tag_constants.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/file_system.h"
+#include "utils/batch_output.h"
+#include "utils/cpu.h"
+#include "utils/dynamic_batcher.h"
+#include "utils/model_executor.h"
+#include "utils/model_metrics.h"
+#include "utils/model_registry.h"
 #include "utils/request_parser.h"
+#include "utils/thread_pool.h"
+#include "utils/warm_up.h"
 
 #include "tensorflow_parser.h"
 
@@ -61,9 +83,253 @@ absl::Status SaveToRamFileSystem(const RegisterModelRequest& request) {
   return absl::OkStatus();
 }
 
+// A loaded model, with its serving signature resolved at registration.
+// Inference runs through a callable per set of fed inputs, made on first use,
+// so that the session does not look up the feeds and fetches in the graph on
+// every run. Callables can be run concurrently. Thread-safe.
+class TensorflowModel {
+ public:
+  // Fails if the model has no serving_default signature.
+  static absl::StatusOr<std::unique_ptr<TensorflowModel>> Create(
+      std::unique_ptr<tensorflow::SavedModelBundle> bundle,
+      absl::string_view model_key);
+
+  ~TensorflowModel() {
+    absl::MutexLock lock(&mu_);
+    for (const auto& [feeds, handle] : callables_) {
+      bundle_->session->ReleaseCallable(handle).IgnoreError();
+    }
+  }
+
+  // Runs the model on `inputs`, returning the outputs of its signature.
+  absl::StatusOr<std::vector<TensorWithName>> Run(
+      absl::string_view model_key,
+      const std::vector<std::pair<std::string, tensorflow::Tensor>>& inputs)
+      const;
+
+ private:
+  explicit TensorflowModel(std::unique_ptr<tensorflow::SavedModelBundle> bundle)
+      : bundle_(std::move(bundle)) {}
+
+  // Returns the callable feeding the inputs in the order of `inputs`.
+  absl::StatusOr<tensorflow::Session::CallableHandle> GetCallable(
+      absl::string_view model_key,
+      const std::vector<std::pair<std::string, tensorflow::Tensor>>& inputs)
+      const ABSL_LOCKS_EXCLUDED(mu_);
+
+  std::unique_ptr<tensorflow::SavedModelBundle> bundle_;
+  // Tensor names of the outputs of the signature, in the order they are
+  // returned.
+  std::vector<std::string> output_names_;
+  // Types of the inputs of the signature, by tensor name.
+  absl::flat_hash_map<std::string, tensorflow::DataType> input_types_;
+  mutable absl::Mutex mu_;
+  // By the comma separated tensor names of the fed inputs.
+  mutable absl::flat_hash_map<std::string, tensorflow::Session::CallableHandle>
+      callables_ ABSL_GUARDED_BY(mu_);
+};
+
+absl::StatusOr<std::unique_ptr<TensorflowModel>> TensorflowModel::Create(
+    std::unique_ptr<tensorflow::SavedModelBundle> bundle,
+    absl::string_view model_key) {
+  const auto& signature_map = bundle->meta_graph_def.signature_def();
+  const auto signature_it = signature_map.find("serving_default");
+  if (signature_it == signature_map.end()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The 'serving_default' signature was not found for model '",
+        model_key));
+  }
+  auto model = absl::WrapUnique(new TensorflowModel(std::move(bundle)));
+  for (const auto& [alias, output] : signature_it->second.outputs()) {
+    model->output_names_.push_back(output.name());
+  }
+  for (const auto& [alias, input] : signature_it->second.inputs()) {
+    model->input_types_[input.name()] = input.dtype();
+  }
+  return model;
+}
+
+absl::StatusOr<tensorflow::Session::CallableHandle>
+TensorflowModel::GetCallable(
+    absl::string_view model_key,
+    const std::vector<std::pair<std::string, tensorflow::Tensor>>& inputs)
+    const {
+  std::string feeds;
+  for (const auto& [name, tensor] : inputs) {
+    absl::StrAppend(&feeds, feeds.empty() ? "" : ",", name);
+  }
+  absl::MutexLock lock(&mu_);
+  if (auto it = callables_.find(feeds); it != callables_.end()) {
+    return it->second;
+  }
+  tensorflow::CallableOptions options;
+  for (const auto& [name, tensor] : inputs) {
+    options.add_feed(name);
+  }
+  for (const std::string& name : output_names_) {
+    options.add_fetch(name);
+  }
+  tensorflow::Session::CallableHandle handle;
+  tensorflow::Status status = bundle_->session->MakeCallable(options, &handle);
+  if (!status.ok()) {
+    return absl::InternalError(absl::StrCat(
+        "Inference failed for model '", model_key, "': ", status.ToString()));
+  }
+  callables_.emplace(std::move(feeds), handle);
+  return handle;
+}
+
+absl::StatusOr<std::vector<TensorWithName>> TensorflowModel::Run(
+    absl::string_view model_key,
+    const std::vector<std::pair<std::string, tensorflow::Tensor>>& inputs)
+    const {
+  std::vector<tensorflow::Tensor> feed_tensors;
+  feed_tensors.reserve(inputs.size());
+  for (const auto& [name, tensor] : inputs) {
+    if (auto it = input_types_.find(name);
+        it != input_types_.end() && it->second != tensor.dtype()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Input '", name, "' of model '", model_key, "' is of type ",
+          tensorflow::DataTypeString(tensor.dtype()), " instead of ",
+          tensorflow::DataTypeString(it->second)));
+    }
+    feed_tensors.push_back(tensor);
+  }
+  PS_ASSIGN_OR_RETURN(tensorflow::Session::CallableHandle handle,
+                      GetCallable(model_key, inputs));
+
+  std::vector<tensorflow::Tensor> outputs;
+  tensorflow::Status status = bundle_->session->RunCallable(
+      handle, feed_tensors, &outputs, /*run_metadata=*/nullptr);
+  if (!status.ok()) {
+    return absl::InternalError(absl::StrCat(
+        "Inference failed for model '", model_key, "': ", status.ToString()));
+  }
+  if (output_names_.size() != outputs.size()) {
+    return absl::InternalError(
+        "The number of output tensors doesn't match the number of output "
+        "tensor names");
+  }
+  std::vector<TensorWithName> zipped_vector;
+  zipped_vector.reserve(outputs.size());
+  for (size_t i = 0; i < output_names_.size(); ++i) {
+    zipped_vector.push_back(
+        TensorWithName(output_names_[i], std::move(outputs[i])));
+  }
+  return zipped_vector;
+}
+
+// Inputs of an inference request, batched with the inputs of concurrent
+// requests to the same model.
+struct BatchInput {
+  const TensorflowModel* model;
+  absl::string_view model_key;
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+};
+
+using Batcher = DynamicBatcher<BatchInput, std::vector<TensorWithName>>;
+
+// Returns the key of the batches the inputs can join, or nullopt if they
+// cannot be batched along their first dimension. Inputs are batched with
+// inputs of the same model version, names, types and shapes but for the
+// first dimension.
+std::optional<std::string> BatchKey(
+    const TensorflowModel* model, absl::string_view model_key,
+    const std::vector<std::pair<std::string, tensorflow::Tensor>>& inputs) {
+  if (inputs.empty() || inputs.front().second.dims() == 0) {
+    return std::nullopt;
+  }
+  std::string key = absl::StrCat(
+      model_key, "@", absl::Hex(reinterpret_cast<uintptr_t>(model)));
+  const int64_t num_rows = inputs.front().second.dim_size(0);
+  for (const auto& [name, tensor] : inputs) {
+    if (tensor.dims() == 0 || tensor.dim_size(0) != num_rows) {
+      return std::nullopt;
+    }
+    absl::StrAppend(&key, "|", name, ":",
+                    tensorflow::DataTypeString(tensor.dtype()));
+    for (int dim = 1; dim < tensor.dims(); ++dim) {
+      absl::StrAppend(&key, ",", tensor.dim_size(dim));
+    }
+  }
+  return key;
+}
+
+// Evaluates a batch with a single session run on concatenated inputs. It
+// falls back to evaluating the requests one by one if the outputs of the model
+// cannot be split by request.
+std::vector<absl::StatusOr<std::vector<TensorWithName>>> RunBatch(
+    const std::string& key, std::vector<BatchInput>& batch) {
+  std::vector<absl::StatusOr<std::vector<TensorWithName>>> outputs;
+  if (batch.size() > 1) {
+    std::vector<int64_t> num_rows;
+    for (const BatchInput& input : batch) {
+      num_rows.push_back(input.inputs.front().second.dim_size(0));
+    }
+    const int64_t total_rows =
+        std::accumulate(num_rows.begin(), num_rows.end(), int64_t{0});
+
+    std::vector<std::pair<std::string, tensorflow::Tensor>> batched_inputs;
+    absl::Status batch_status;
+    for (size_t i = 0; i < batch.front().inputs.size() && batch_status.ok();
+         ++i) {
+      std::vector<tensorflow::Tensor> tensors;
+      for (const BatchInput& input : batch) {
+        tensors.push_back(input.inputs[i].second);
+      }
+      tensorflow::Tensor batched_tensor;
+      tensorflow::Status status =
+          tensorflow::tensor::Concat(tensors, &batched_tensor);
+      if (!status.ok()) {
+        batch_status = absl::InternalError(status.ToString());
+        break;
+      }
+      batched_inputs.emplace_back(batch.front().inputs[i].first,
+                                  std::move(batched_tensor));
+    }
+
+    if (batch_status.ok()) {
+      absl::StatusOr<std::vector<TensorWithName>> batched_outputs =
+          batch.front().model->Run(batch.front().model_key, batched_inputs);
+      if (!batched_outputs.ok()) {
+        outputs.assign(batch.size(), batched_outputs.status());
+        return outputs;
+      }
+      std::vector<std::vector<TensorWithName>> split_outputs(batch.size());
+      for (const TensorWithName& output : *batched_outputs) {
+        std::vector<tensorflow::Tensor> parts;
+        if (output.tensor.dims() == 0 ||
+            output.tensor.dim_size(0) != total_rows ||
+            !tensorflow::tensor::Split(output.tensor, num_rows, &parts).ok()) {
+          batch_status = absl::InvalidArgumentError(absl::StrCat(
+              "Output ", output.tensor_name, " does not have a row per input"));
+          break;
+        }
+        for (size_t i = 0; i < parts.size(); ++i) {
+          split_outputs[i].emplace_back(output.tensor_name,
+                                        std::move(parts[i]));
+        }
+      }
+      if (batch_status.ok()) {
+        outputs.assign(std::make_move_iterator(split_outputs.begin()),
+                       std::make_move_iterator(split_outputs.end()));
+        return outputs;
+      }
+    }
+    ABSL_LOG_FIRST_N(WARNING, 1) << "Evaluating the batch of " << key
+                                 << " one by one: " << batch_status;
+  }
+  for (const BatchInput& input : batch) {
+    outputs.push_back(input.model->Run(input.model_key, input.inputs));
+  }
+  return outputs;
+}
+
+// With a batcher, the request is evaluated together with concurrent requests
+// to the same model.
 absl::StatusOr<std::pair<std::string, std::vector<TensorWithName>>>
-PredictPerModel(const tensorflow::SavedModelBundle* model,
-                const InferenceRequest& inference_request) {
+PredictPerModel(const TensorflowModel* model,
+                const InferenceRequest& inference_request, Batcher* batcher) {
   std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
   for (const auto& tensor : inference_request.inputs) {
     if (tensor.tensor_name.empty()) {
@@ -78,106 +344,264 @@ PredictPerModel(const tensorflow::SavedModelBundle* model,
   }
 
   absl::string_view model_key = inference_request.model_path;
-  const auto& signature_map = model->meta_graph_def.signature_def();
-  if (signature_map.find("serving_default") == signature_map.end()) {
-    return absl::InvalidArgumentError(absl::StrCat(
-        "The 'serving_default' signature was not found for model '",
-        model_key));
+  if (batcher != nullptr) {
+    if (std::optional<std::string> key = BatchKey(model, model_key, inputs);
+        key) {
+      BatchInput batch_input = {.model = model,
+                                .model_key = model_key,
+                                .inputs = std::move(inputs)};
+      PS_ASSIGN_OR_RETURN(std::vector<TensorWithName> outputs,
+                          batcher->Run(*key, std::move(batch_input)));
+      return std::make_pair(std::string(model_key), std::move(outputs));
+    }
   }
+  PS_ASSIGN_OR_RETURN(std::vector<TensorWithName> outputs,
+                      model->Run(model_key, inputs));
+  return std::make_pair(std::string(model_key), std::move(outputs));
+}
 
-  const auto& signature = signature_map.at("serving_default");
-  std::vector<std::string> output_names;
-  for (const auto& output : signature.outputs()) {
-    output_names.push_back(output.second.name());
+template <typename T>
+double MaxValueDeviation(const tensorflow::Tensor& tensor,
+                         const tensorflow::Tensor& reference) {
+  const auto values = tensor.flat<T>();
+  const auto reference_values = reference.flat<T>();
+  double deviation = 0;
+  for (int64_t i = 0; i < values.size(); ++i) {
+    deviation = std::max(
+        deviation, std::abs(static_cast<double>(values(i)) -
+                            static_cast<double>(reference_values(i))));
   }
+  return deviation;
+}
 
-  std::vector<tensorflow::Tensor> outputs;
-  tensorflow::Status status =
-      model->session->Run(inputs, output_names, {}, &outputs);
-  if (!status.ok()) {
-    return absl::InternalError(absl::StrCat(
-        "Inference failed for model '", model_key, "': ", status.ToString()));
+// Returns the largest absolute difference between the values of `tensor` and
+// those of `reference`. Tensors of non-numeric types deviate infinitely
+// unless equal.
+absl::StatusOr<double> MaxDeviation(const tensorflow::Tensor& tensor,
+                                    const tensorflow::Tensor& reference) {
+  if (tensor.dtype() != reference.dtype() ||
+      tensor.shape() != reference.shape()) {
+    return absl::InvalidArgumentError(
+        "The types or shapes of the outputs differ");
   }
-  std::vector<TensorWithName> zipped_vector;
-  if (output_names.size() != outputs.size()) {
-    return absl::InternalError(
-        "The number of output tensors doesn't match the number of output "
-        "tensor names");
+  switch (tensor.dtype()) {
+    case tensorflow::DT_FLOAT:
+      return MaxValueDeviation<float>(tensor, reference);
+    case tensorflow::DT_DOUBLE:
+      return MaxValueDeviation<double>(tensor, reference);
+    case tensorflow::DT_INT32:
+      return MaxValueDeviation<int32_t>(tensor, reference);
+    case tensorflow::DT_INT64:
+      return MaxValueDeviation<int64_t>(tensor, reference);
+    default:
+      return tensor.tensor_data() == reference.tensor_data()
+                 ? 0
+                 : std::numeric_limits<double>::infinity();
   }
-  for (size_t i = 0; i < output_names.size(); ++i) {
-    zipped_vector.push_back(TensorWithName(output_names[i], outputs[i]));
+}
+
+// Checks that the outputs of `model` on the warm-up requests do not deviate
+// from those of `reference` by more than `max_deviation`.
+absl::Status ValidateModel(
+    const TensorflowModel* model, const TensorflowModel* reference,
+    absl::string_view model_key,
+    const std::vector<InferenceRequest>& warm_up_requests,
+    double max_deviation) {
+  for (const InferenceRequest& warm_up_request : warm_up_requests) {
+    PS_ASSIGN_OR_RETURN(
+        auto output,
+        PredictPerModel(model, warm_up_request, /*batcher=*/nullptr));
+    PS_ASSIGN_OR_RETURN(
+        auto reference_output,
+        PredictPerModel(reference, warm_up_request, /*batcher=*/nullptr));
+    for (size_t i = 0; i < output.second.size(); ++i) {
+      absl::StatusOr<double> deviation =
+          MaxDeviation(output.second[i].tensor,
+                       reference_output.second[i].tensor);
+      if (!deviation.ok()) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Model ", model_key, " cannot be validated: ",
+                         deviation.status().message()));
+      }
+      if (*deviation > max_deviation) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Model ", model_key, " deviates by ", *deviation,
+            " from its outputs without execution options on its warm-up "
+            "requests, more than ",
+            max_deviation));
+      }
+    }
   }
+  return absl::OkStatus();
+}
+
+// Output of a model converted on its worker thread, either to its part of the
+// JSON output or to its binary tensors.
+struct ConvertedOutput {
+  std::string json;
+  ModelTensors binary;
+};
 
-  return std::make_pair(std::string(model_key), zipped_vector);
+absl::StatusOr<ConvertedOutput> PredictAndConvert(
+    const TensorflowModel* model,
+    const InferenceRequest& inference_request, Batcher* batcher,
+    size_t task_id, bool binary_output) {
+  auto output = PredictPerModel(model, inference_request, batcher);
+  if (!output.ok()) {
+    return absl::Status(
+        output.status().code(),
+        absl::StrCat("Error during inference for model '",
+                     inference_request.model_path, "', Task ID: ", task_id,
+                     ". ", output.status().message()));
+  }
+  ConvertedOutput converted;
+  if (binary_output) {
+    auto binary = ConvertModelTensorsToBinary(output->first, output->second);
+    if (!binary.ok()) {
+      return absl::InternalError(
+          "Error during output conversion to binary tensors");
+    }
+    converted.binary = *std::move(binary);
+  } else {
+    auto json = ConvertModelTensorsToJson(output->first, output->second);
+    if (!json.ok()) {
+      return absl::InternalError("Error during output parsing to json");
+    }
+    converted.json = *std::move(json);
+  }
+  return converted;
 }
 
 class TensorflowModule final : public ModuleInterface {
  public:
   explicit TensorflowModule(const InferenceSidecarRuntimeConfig& config)
-      : runtime_config_(config) {}
+      : models_(int64_t{config.model_memory_budget_mb()} * 1024 * 1024),
+        runtime_config_(config),
+        num_warm_up_runs_(NumWarmUpRuns(config)),
+        thread_pool_(config.num_worker_threads(),
+                     {config.cpuset().begin(), config.cpuset().end()}),
+        executors_(thread_pool_) {
+    if (config.max_batch_size() > 1) {
+      batcher_ = std::make_unique<Batcher>(
+          DynamicBatcherConfig{
+              .max_batch_size = config.max_batch_size(),
+              .max_queue_delay =
+                  absl::Microseconds(config.max_batch_queue_delay_us())},
+          &RunBatch);
+    }
+  }
   absl::StatusOr<PredictResponse> Predict(
-      const PredictRequest& request) override ABSL_LOCKS_EXCLUDED(mu_);
+      const PredictRequest& request) override;
   absl::StatusOr<RegisterModelResponse> RegisterModel(
-      const RegisterModelRequest& request) override ABSL_LOCKS_EXCLUDED(mu_);
+      const RegisterModelRequest& request) override;
 
  private:
-  // Maps each `model_path` from an inference request to its corresponding
-  // tensorflow::SavedModelBundle instance.
-  absl::flat_hash_map<std::string,
-                      std::unique_ptr<tensorflow::SavedModelBundle>>
-      model_map_ ABSL_GUARDED_BY(mu_);
+  // Loads the model from the files of the request with its execution options,
+  // runs its warm-up requests on the pool of the model and validates it if
+  // requested.
+  absl::StatusOr<std::unique_ptr<TensorflowModel>> LoadModel(
+      const RegisterModelRequest& request,
+      const tensorflow::SessionOptions& session_options,
+      const std::unordered_set<std::string>& tags,
+      const std::vector<InferenceRequest>& warm_up_requests,
+      WorkStealingThreadPool& thread_pool);
+
+  // Maps each `model_path` from an inference request to the versions of its
+  // TensorflowModel instance.
   // TODO(b/327907675) : Add a test for concurrency
-  absl::Mutex mu_;
+  ModelRegistry<TensorflowModel> models_;
   const InferenceSidecarRuntimeConfig runtime_config_;
+  const int num_warm_up_runs_;
+  // Batches inference requests across concurrent Predict calls, if enabled.
+  std::unique_ptr<Batcher> batcher_;
+  // Runs the inference of each model of the requests, unless the model has
+  // threads of its own.
+  WorkStealingThreadPool thread_pool_;
+  // Runs the inferences of each model with its resources. Destroyed with the
+  // pool first, so that no task outlives the models and the batcher.
+  ModelExecutors executors_;
 };
 
 absl::StatusOr<PredictResponse> TensorflowModule::Predict(
     const PredictRequest& request) {
-  absl::ReaderMutexLock lock(&mu_);
-
   absl::StatusOr<std::vector<InferenceRequest>> parsed_requests =
-      ParseJsonInferenceRequest(request.input());
+      request.has_binary_input()
+          ? ParseBinaryInferenceRequest(request.binary_input())
+          : ParseJsonInferenceRequest(request.input());
   if (!parsed_requests.ok()) {
     return absl::InvalidArgumentError(parsed_requests.status().message());
   }
 
-  std::vector<std::future<
-      absl::StatusOr<std::pair<std::string, std::vector<TensorWithName>>>>>
-      tasks;
-
+  // All the models are looked up before any task starts. The tasks own the
+  // current versions, which a registration may replace meanwhile.
+  std::vector<std::shared_ptr<const TensorflowModel>> models;
   for (const InferenceRequest& inference_request : *parsed_requests) {
     absl::string_view model_key = inference_request.model_path;
-    auto it = model_map_.find(model_key);
-    if (it == model_map_.end()) {
+    std::shared_ptr<const TensorflowModel> model =
+        models_.Get(model_key);
+    if (model == nullptr) {
       return absl::NotFoundError(
           absl::StrCat("Requested model '", model_key, "' is not registered"));
     }
-    tasks.push_back(std::async(std::launch::async, &PredictPerModel,
-                               it->second.get(), inference_request));
+    models.push_back(std::move(model));
   }
 
-  std::vector<std::pair<std::string, std::vector<TensorWithName>>>
-      batch_outputs;
+  // Each task converts the output of its model on the worker thread, leaving
+  // only their concatenation to this one.
+  const bool binary_output = request.has_binary_input();
+  const absl::Time deadline = PredictDeadline(request);
+  std::vector<std::future<MeasuredOutput<ConvertedOutput>>> tasks;
+  for (size_t i = 0; i < models.size(); ++i) {
+    // Tasks own a copy of their request, they may outlive this call if an
+    // earlier one fails.
+    ModelExecutor& executor =
+        executors_.Get((*parsed_requests)[i].model_path);
+    tasks.push_back(executor.Run<ConvertedOutput>(
+        (*parsed_requests)[i],
+        [model = models[i], batcher = batcher_.get(), task_id = i,
+         binary_output](const InferenceRequest& inference_request) {
+          return PredictAndConvert(model.get(), inference_request, batcher,
+                                   task_id, binary_output);
+        },
+        deadline));
+  }
+
+  PredictResponse predict_response;
+  std::vector<std::string> json_outputs;
+  json_outputs.reserve(tasks.size());
   for (size_t task_id = 0; task_id < tasks.size(); ++task_id) {
-    auto result_status_or = tasks[task_id].get();
+    MeasuredOutput<ConvertedOutput> task_result = tasks[task_id].get();
+    *predict_response.add_model_metrics() = std::move(task_result.metrics);
+    absl::StatusOr<ConvertedOutput>& result_status_or = task_result.output;
     if (!result_status_or.ok()) {
+      // Unless partial results are allowed, the batch result returns the
+      // error code of the first failure task.
+      if (!request.allow_partial_results()) {
+        return result_status_or.status();
+      }
       const auto& model_key = (*parsed_requests)[task_id].model_path;
-      return absl::Status(result_status_or.status().code(),
-                          absl::StrCat("Error during inference for model '",
-                                       model_key, "', Task ID: ", task_id, ". ",
-                                       result_status_or.status().message()));
+      const absl::Status& status = result_status_or.status();
+      if (binary_output) {
+        *predict_response.mutable_binary_output()->add_models() =
+            ModelErrorToBinary(model_key, status);
+      } else {
+        PS_ASSIGN_OR_RETURN(std::string json_output,
+                            ModelErrorToJson(model_key, status));
+        json_outputs.push_back(std::move(json_output));
+      }
+      continue;
+    }
+    if (binary_output) {
+      *predict_response.mutable_binary_output()->add_models() =
+          std::move(result_status_or->binary);
+    } else {
+      json_outputs.push_back(std::move(result_status_or->json));
     }
-
-    batch_outputs.push_back(result_status_or.value());
   }
 
-  auto output_json = ConvertTensorsToJson(batch_outputs);
-  if (!output_json.ok()) {
-    return absl::InternalError("Error during output parsing to json");
+  if (!binary_output) {
+    predict_response.set_output(ConcatModelOutputsToJson(json_outputs));
   }
-
-  PredictResponse predict_response;
-  predict_response.set_output(output_json.value());
   return predict_response;
 }
 
@@ -193,6 +617,14 @@ absl::StatusOr<RegisterModelResponse> TensorflowModule::RegisterModel(
     session_options.config.set_inter_op_parallelism_threads(
         runtime_config_.num_interop_threads());
   }
+  // A model with threads of its own gets its own session threads as well,
+  // rather than those of the process shared by the sessions.
+  const ModelResources& resources = request.model_spec().resources();
+  if (resources.num_threads() > 0) {
+    session_options.config.set_use_per_session_threads(true);
+    session_options.config.set_intra_op_parallelism_threads(
+        resources.num_threads());
+  }
 
   const std::unordered_set<std::string> tags = {"serve"};
   const auto& model_path = request.model_spec().model_path();
@@ -201,26 +633,93 @@ absl::StatusOr<RegisterModelResponse> TensorflowModule::RegisterModel(
     return absl::InvalidArgumentError("Model path is empty");
   }
 
-  absl::WriterMutexLock lock(&mu_);
-  auto it = model_map_.find(model_path);
-  if (it != model_map_.end()) {
-    return absl::AlreadyExistsError(
-        absl::StrCat("Model '", model_path, "' already registered"));
+  PS_ASSIGN_OR_RETURN(std::vector<InferenceRequest> warm_up_requests,
+                      ParseWarmUpRequest(request));
+  int64_t size_bytes = 0;
+  for (const auto& [file_path, bytes] : request.model_files()) {
+    size_bytes += bytes.size();
   }
 
-  PS_RETURN_IF_ERROR(SaveToRamFileSystem(request));
+  PS_ASSIGN_OR_RETURN(ModelExecutor * executor,
+                      executors_.Prepare(model_path, resources));
+  // Loaded and warmed up next to the current version, if any, which serves
+  // Predict calls meanwhile.
+  absl::Status status = models_.Register(
+      model_path, request.model_spec().version(), size_bytes, [&]() {
+        return LoadModel(request, session_options, tags, warm_up_requests,
+                         executor->thread_pool());
+      });
+  executors_.Complete(model_path, executor, status.ok());
+  PS_RETURN_IF_ERROR(status);
+  return RegisterModelResponse();
+}
 
-  auto model_bundle = std::make_unique<tensorflow::SavedModelBundle>();
-  auto status = tensorflow::LoadSavedModel(
-      session_options, {}, absl::StrCat(kRamFileSystemScheme, model_path), tags,
-      model_bundle.get());
+absl::StatusOr<std::unique_ptr<TensorflowModel>> TensorflowModule::LoadModel(
+    const RegisterModelRequest& request,
+    const tensorflow::SessionOptions& session_options,
+    const std::unordered_set<std::string>& tags,
+    const std::vector<InferenceRequest>& warm_up_requests,
+    WorkStealingThreadPool& thread_pool) {
+  const auto& model_path = request.model_spec().model_path();
+  const ModelExecutionOptions& options =
+      request.model_spec().execution_options();
+  const bool bf16 = options.precision() == ModelExecutionOptions::BF16;
+  if (bf16 && !CpuSupportsBf16()) {
+    return absl::InvalidArgumentError(
+        "bfloat16 execution is not supported by the CPU");
+  }
+  const bool validate = options.max_output_deviation() > 0;
+  if (validate && warm_up_requests.empty()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Model ", model_path, " cannot be validated without warm-up request"));
+  }
+  PS_RETURN_IF_ERROR(SaveToRamFileSystem(request));
 
-  if (!status.ok()) {
-    return absl::InternalError(
-        absl::StrCat("Error loading model: ", model_path));
+  tensorflow::SessionOptions model_session_options = session_options;
+  tensorflow::GraphOptions* graph_options =
+      model_session_options.config.mutable_graph_options();
+  if (options.xla_jit()) {
+    graph_options->mutable_optimizer_options()->set_global_jit_level(
+        tensorflow::OptimizerOptions::ON_1);
   }
-  model_map_[model_path] = std::move(model_bundle);
-  return RegisterModelResponse();
+  if (bf16) {
+    graph_options->mutable_rewrite_options()
+        ->set_auto_mixed_precision_onednn_bfloat16(
+            tensorflow::RewriterConfig::ON);
+  }
+  auto load = [&](const tensorflow::SessionOptions& load_options)
+      -> absl::StatusOr<std::unique_ptr<TensorflowModel>> {
+    auto model_bundle = std::make_unique<tensorflow::SavedModelBundle>();
+    auto status = tensorflow::LoadSavedModel(
+        load_options, {}, absl::StrCat(kRamFileSystemScheme, model_path),
+        tags, model_bundle.get());
+    if (!status.ok()) {
+      return absl::InternalError(
+          absl::StrCat("Error loading model: ", model_path));
+    }
+    return TensorflowModel::Create(std::move(model_bundle), model_path);
+  };
+  PS_ASSIGN_OR_RETURN(std::unique_ptr<TensorflowModel> model,
+                      load(model_session_options));
+
+  // Grappler optimizes the graph and the kernels are created on the first run
+  // of the signature, which the first calls would otherwise pay for. The
+  // callables of the warm-up inputs are made meanwhile.
+  PS_RETURN_IF_ERROR(RunWarmUp(
+      warm_up_requests, num_warm_up_runs_, thread_pool,
+      [model = model.get()](const InferenceRequest& warm_up_request) {
+        return PredictPerModel(model, warm_up_request, /*batcher=*/nullptr)
+            .status();
+      }));
+  if (validate && (bf16 || options.xla_jit())) {
+    // Loaded without the options only for the comparison.
+    PS_ASSIGN_OR_RETURN(std::unique_ptr<TensorflowModel> reference,
+                        load(session_options));
+    PS_RETURN_IF_ERROR(ValidateModel(model.get(), reference.get(), model_path,
+                                     warm_up_requests,
+                                     options.max_output_deviation()));
+  }
+  return model;
 }
 
 }  // namespace
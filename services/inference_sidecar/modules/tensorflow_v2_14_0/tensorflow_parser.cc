@@ -14,8 +14,10 @@
 #include "tensorflow_parser.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <rapidjson/writer.h>
@@ -23,6 +25,7 @@
 #include "absl/strings/str_format.h"
 #include "rapidjson/document.h"
 #include "src/util/status_macro/status_macros.h"
+#include "utils/batch_output.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "utils/request_parser.h"
@@ -111,6 +114,12 @@ absl::StatusOr<tensorflow::Tensor> ConvertFlatArrayToTensorInternal(
     shape.AddDim(dim);
   }
   tensorflow::Tensor tf_tensor(tensorflow::DataTypeToEnum<T>::v(), shape);
+  if (tensor.tensor_bytes.has_value()) {
+    // The values are copied as is into the tensor buffer.
+    std::memcpy(tf_tensor.data(), tensor.tensor_bytes->data(),
+                tensor.tensor_bytes->size());
+    return tf_tensor;
+  }
 
   std::vector<T> data_array;
   for (const std::string& str : tensor.tensor_content) {
@@ -238,36 +247,93 @@ absl::StatusOr<rapidjson::Value> TensorToJsonValue(
   return json_tensor;
 }
 
-absl::StatusOr<std::string> ConvertTensorsToJson(
-    const std::vector<std::pair<std::string, std::vector<TensorWithName>>>&
-        batch_outputs) {
+absl::StatusOr<std::string> ConvertModelTensorsToJson(
+    const std::string& model_path, const std::vector<TensorWithName>& tensors) {
   rapidjson::Document document;
   document.SetObject();
   rapidjson::MemoryPoolAllocator<>& allocator = document.GetAllocator();
 
-  rapidjson::Value batch(rapidjson::kArrayType);
-  for (const auto& [model_path, tensors] : batch_outputs) {
-    rapidjson::Value nested_object(rapidjson::kObjectType);
-    rapidjson::Value model_path_value;
-    model_path_value.SetString(model_path.c_str(), allocator);
-    nested_object.AddMember("model_path", model_path_value, allocator);
+  rapidjson::Value model_path_value;
+  model_path_value.SetString(model_path.c_str(), allocator);
+  document.AddMember("model_path", model_path_value, allocator);
 
-    rapidjson::Value tensors_value(rapidjson::kArrayType);
-    for (const auto& [tensor_name, tensor] : tensors) {
-      absl::StatusOr<rapidjson::Value> json =
-          TensorToJsonValue(tensor_name, tensor, allocator);
-      if (json.ok()) {
-        tensors_value.PushBack(json.value(), allocator);
-      } else {
-        return json.status();
-      }
+  rapidjson::Value tensors_value(rapidjson::kArrayType);
+  for (const auto& [tensor_name, tensor] : tensors) {
+    absl::StatusOr<rapidjson::Value> json =
+        TensorToJsonValue(tensor_name, tensor, allocator);
+    if (json.ok()) {
+      tensors_value.PushBack(json.value(), allocator);
+    } else {
+      return json.status();
     }
-    nested_object.AddMember("tensors", tensors_value.Move(), allocator);
-    batch.PushBack(nested_object.Move(), allocator);
   }
-  document.AddMember("response", batch.Move(), allocator);
+  document.AddMember("tensors", tensors_value.Move(), allocator);
 
   return SerializeJsonDoc(document);
 }
 
+absl::StatusOr<std::string> ConvertTensorsToJson(
+    const std::vector<std::pair<std::string, std::vector<TensorWithName>>>&
+        batch_outputs) {
+  std::vector<std::string> model_outputs;
+  model_outputs.reserve(batch_outputs.size());
+  for (const auto& [model_path, tensors] : batch_outputs) {
+    PS_ASSIGN_OR_RETURN(std::string model_output,
+                        ConvertModelTensorsToJson(model_path, tensors));
+    model_outputs.push_back(std::move(model_output));
+  }
+  return ConcatModelOutputsToJson(model_outputs);
+}
+
+absl::StatusOr<ModelTensors> ConvertModelTensorsToBinary(
+    const std::string& model_path, const std::vector<TensorWithName>& tensors) {
+  ModelTensors model_tensors;
+  model_tensors.set_model_path(model_path);
+  for (const auto& [tensor_name, tensor] : tensors) {
+    BinaryTensor* binary_tensor = model_tensors.add_tensors();
+    binary_tensor->set_tensor_name(tensor_name);
+    for (int i = 0; i < tensor.dims(); ++i) {
+      binary_tensor->add_tensor_shape(tensor.dim_size(i));
+    }
+    switch (tensor.dtype()) {
+      case tensorflow::DataType::DT_FLOAT:
+        binary_tensor->set_data_type(BinaryTensor::FLOAT);
+        break;
+      case tensorflow::DataType::DT_DOUBLE:
+        binary_tensor->set_data_type(BinaryTensor::DOUBLE);
+        break;
+      case tensorflow::DataType::DT_INT8:
+        binary_tensor->set_data_type(BinaryTensor::INT8);
+        break;
+      case tensorflow::DataType::DT_INT16:
+        binary_tensor->set_data_type(BinaryTensor::INT16);
+        break;
+      case tensorflow::DataType::DT_INT32:
+        binary_tensor->set_data_type(BinaryTensor::INT32);
+        break;
+      case tensorflow::DataType::DT_INT64:
+        binary_tensor->set_data_type(BinaryTensor::INT64);
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Unsupported data type %d", tensor.dtype()));
+    }
+    // The buffer of a dense tensor holds its values in row-major order.
+    const auto tensor_data = tensor.tensor_data();
+    binary_tensor->set_tensor_content(tensor_data.data(), tensor_data.size());
+  }
+  return model_tensors;
+}
+
+absl::StatusOr<BatchTensors> ConvertTensorsToBinary(
+    const std::vector<std::pair<std::string, std::vector<TensorWithName>>>&
+        batch_outputs) {
+  BatchTensors batch_tensors;
+  for (const auto& [model_path, tensors] : batch_outputs) {
+    PS_ASSIGN_OR_RETURN(*batch_tensors.add_models(),
+                        ConvertModelTensorsToBinary(model_path, tensors));
+  }
+  return batch_tensors;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "proto/inference_sidecar.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "utils/request_parser.h"
 
@@ -41,6 +42,11 @@ struct TensorWithName {
 absl::StatusOr<tensorflow::Tensor> ConvertFlatArrayToTensor(
     const Tensor& tensor);
 
+// Converts the inference output of a model to a JSON object string, part of
+// the output of the batch. Called on the worker thread of the model.
+absl::StatusOr<std::string> ConvertModelTensorsToJson(
+    const std::string& model_path, const std::vector<TensorWithName>& tensors);
+
 // Converts inference output (Tensorflow tensors) corresponding to each model to
 // a JSON string.
 // batch_outputs contains a collection of <model_path, inference_output> pairs.
@@ -48,6 +54,17 @@ absl::StatusOr<std::string> ConvertTensorsToJson(
     const std::vector<std::pair<std::string, std::vector<TensorWithName>>>&
         batch_outputs);
 
+// Converts the inference output of a model to binary tensors, without
+// per-value conversion. Called on the worker thread of the model.
+absl::StatusOr<ModelTensors> ConvertModelTensorsToBinary(
+    const std::string& model_path, const std::vector<TensorWithName>& tensors);
+
+// Converts inference output (Tensorflow tensors) corresponding to each model to
+// binary tensors, without per-value conversion.
+absl::StatusOr<BatchTensors> ConvertTensorsToBinary(
+    const std::vector<std::pair<std::string, std::vector<TensorWithName>>>&
+        batch_outputs);
+
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
 
 #endif  // SERVICES_INFERENCE_SIDECAR_MODULES_TENSORFLOW_V2_14_0_TENSORFLOW_PARSER_H_
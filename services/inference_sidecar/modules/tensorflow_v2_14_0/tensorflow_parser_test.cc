@@ -157,6 +157,20 @@ TEST(TensorflowParserTest, ConvertTensorsToJson) {
       R"({"response":[{"model_path":"my_bucket/models/pcvr_models/1/","tensors":[{"tensor_name":"output","tensor_shape":[2,3],"data_type":"FLOAT","tensor_content":[0.0,2.0,4.0,6.0,8.0,10.0]}]}]})");
 }
 
+TEST(TensorflowParserTest, ConvertModelTensorsToJson) {
+  tensorflow::Tensor tensor(tensorflow::DT_INT32, tensorflow::TensorShape({2}));
+  tensor.flat<int32_t>()(0) = 1;
+  tensor.flat<int32_t>()(1) = 2;
+  std::vector<TensorWithName> tensors;
+  tensors.push_back(TensorWithName("output", tensor));
+
+  auto output = ConvertModelTensorsToJson("my_model", tensors);
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_EQ(
+      output.value(),
+      R"({"model_path":"my_model","tensors":[{"tensor_name":"output","tensor_shape":[2],"data_type":"INT32","tensor_content":[1,2]}]})");
+}
+
 TEST(TensorflowParserTest, ConvertTensorsToJson_UnsupportedFloat16Type) {
   tensorflow::Tensor half_tensor(tensorflow::DT_BFLOAT16);
 
@@ -266,5 +280,46 @@ TEST(TensorflowParserTest, TestConvertTensorsToJson_BatchOdModels) {
       R"({"response":[{"model_path":"my_bucket/models/pcvr_models/1/","tensors":[{"tensor_name":"output1","tensor_shape":[1,1],"data_type":"DOUBLE","tensor_content":[3.14]}]},{"model_path":"my_bucket/models/pctr_models/1/","tensors":[{"tensor_name":"output2","tensor_shape":[1,1],"data_type":"INT64","tensor_content":[1000]}]}]})");
 }
 
+TEST(TensorflowParserTest, TestConversion_BinaryContent) {
+  const int32_t values[] = {1, -2, 3, 4, 5, 6};
+  Tensor tensor;
+  tensor.data_type = DataType::kInt32;
+  tensor.tensor_bytes =
+      std::string(reinterpret_cast<const char*>(values), sizeof(values));
+  tensor.tensor_shape = {2, 3};
+
+  const absl::StatusOr<tensorflow::Tensor> result =
+      ConvertFlatArrayToTensor(tensor);
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_EQ(result->shape().dim_size(0), 2);
+  EXPECT_EQ(result->shape().dim_size(1), 3);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(result->flat<int32_t>()(i), values[i]);
+  }
+}
+
+TEST(TensorflowParserTest, ConvertTensorsToBinary) {
+  tensorflow::Tensor tensor(tensorflow::DT_FLOAT, tensorflow::TensorShape({2}));
+  tensor.flat<float>()(0) = 1.5;
+  tensor.flat<float>()(1) = -0.5;
+  std::vector<std::pair<std::string, std::vector<TensorWithName>>>
+      batch_outputs = {{"model", {TensorWithName("output", tensor)}}};
+
+  absl::StatusOr<BatchTensors> result = ConvertTensorsToBinary(batch_outputs);
+  ASSERT_TRUE(result.ok()) << result.status();
+  ASSERT_EQ(result->models_size(), 1);
+  EXPECT_EQ(result->models(0).model_path(), "model");
+  ASSERT_EQ(result->models(0).tensors_size(), 1);
+  const BinaryTensor& binary_tensor = result->models(0).tensors(0);
+  EXPECT_EQ(binary_tensor.tensor_name(), "output");
+  EXPECT_EQ(binary_tensor.data_type(), BinaryTensor::FLOAT);
+  ASSERT_EQ(binary_tensor.tensor_shape_size(), 1);
+  EXPECT_EQ(binary_tensor.tensor_shape(0), 2);
+  const float expected_values[] = {1.5, -0.5};
+  EXPECT_EQ(binary_tensor.tensor_content(),
+            std::string(reinterpret_cast<const char*>(expected_values),
+                        sizeof(expected_values)));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
@@ -18,6 +18,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 #include "modules/module_interface.h"
 #include "proto/inference_sidecar.pb.h"
@@ -217,6 +218,40 @@ TEST(TensorflowModuleTest, Success_Predict) {
             "content\":[0.019116628915071489]}]}]}");
 }
 
+constexpr char kJsonStringWrongInputType[] = R"json({
+  "request" : [{
+    "model_path" : "./benchmark_models/pcvr",
+    "tensors" : [
+    {
+      "tensor_name": "serving_default_double1:0",
+      "data_type": "FLOAT",
+      "tensor_shape": [
+        1, 1
+      ],
+      "tensor_content": ["0.32"]
+    }
+  ]
+}]
+    })json";
+
+TEST(TensorflowModuleTest, Failure_PredictWrongInputType) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(PopulateRegisterModelRequest(kModel1Dir, register_request).ok());
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kJsonStringWrongInputType);
+  absl::StatusOr predict_status = tensorflow_module->Predict(predict_request);
+  ASSERT_FALSE(predict_status.ok());
+  EXPECT_EQ(predict_status.status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_THAT(predict_status.status().message(),
+              HasSubstr("is of type float instead of double"));
+}
+
 constexpr char kJsonStringBatchSize2[] = R"json({
   "request" : [{
     "model_path" : "./benchmark_models/pcvr",
@@ -335,6 +370,87 @@ TEST(TensorflowModuleTest, Failure_PredictMissingTensorName) {
               HasSubstr("Name is required for each TensorFlow tensor input"));
 }
 
+TEST(TensorflowModuleTest, Success_RegisterNewModelVersion) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(PopulateRegisterModelRequest(kModel1Dir, register_request).ok());
+  register_request.mutable_model_spec()->set_version("1");
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kJsonString);
+  absl::StatusOr<PredictResponse> first_output =
+      tensorflow_module->Predict(predict_request);
+  ASSERT_TRUE(first_output.ok());
+
+  register_request.mutable_model_spec()->set_version("2");
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request).ok());
+  EXPECT_EQ(tensorflow_module->RegisterModel(register_request).status().code(),
+            absl::StatusCode::kAlreadyExists);
+  absl::StatusOr<PredictResponse> second_output =
+      tensorflow_module->Predict(predict_request);
+  ASSERT_TRUE(second_output.ok());
+  EXPECT_EQ(first_output->output(), second_output->output());
+}
+
+TEST(TensorflowModuleTest, Success_RegisterModelWithWarmUpRequest) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(PopulateRegisterModelRequest(kModel1Dir, register_request).ok());
+  (*register_request.mutable_model_files())[absl::StrCat(
+      kModel1Dir, "/warm_up_request.json")] = kJsonString;
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kJsonString);
+  absl::StatusOr<PredictResponse> predict_status =
+      tensorflow_module->Predict(predict_request);
+  ASSERT_TRUE(predict_status.ok());
+  EXPECT_EQ(predict_status->output(),
+            "{\"response\":[{\"model_path\":\"./benchmark_models/"
+            "pcvr\",\"tensors\":[{\"tensor_name\":\"StatefulPartitionedCall:"
+            "0\",\"tensor_shape\":[1,1],\"data_type\":\"FLOAT\",\"tensor_"
+            "content\":[0.019116628915071489]}]}]}");
+}
+
+TEST(TensorflowModuleTest, Failure_RegisterModelWarmUpError) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(PopulateRegisterModelRequest(kModel1Dir, register_request).ok());
+  (*register_request.mutable_model_files())[absl::StrCat(
+      kModel1Dir, "/warm_up_request.json")] = kJsonStringMissingTensorName;
+  absl::StatusOr<RegisterModelResponse> register_status =
+      tensorflow_module->RegisterModel(register_request);
+  ASSERT_FALSE(register_status.ok());
+  EXPECT_EQ(register_status.status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_THAT(register_status.status().message(),
+              HasSubstr("Name is required for each TensorFlow tensor input"));
+}
+
+TEST(TensorflowModuleTest, Failure_RegisterModelValidationWithoutWarmUp) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(PopulateRegisterModelRequest(kModel1Dir, register_request).ok());
+  ModelExecutionOptions* options =
+      register_request.mutable_model_spec()->mutable_execution_options();
+  options->set_xla_jit(true);
+  options->set_max_output_deviation(1e-4);
+  absl::StatusOr<RegisterModelResponse> register_status =
+      tensorflow_module->RegisterModel(register_request);
+  ASSERT_FALSE(register_status.ok());
+  EXPECT_EQ(register_status.status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 constexpr char kJsonStringWith2Model[] = R"json({
   "request" : [{
     "model_path" : "./benchmark_models/pcvr",
@@ -644,6 +760,28 @@ TEST(TensorflowModuleTest,
             "content\":[0.010360434651374817]}]}]}");
 }
 
+TEST(TensorflowModuleTest, Success_PredictBatchesRequestsAcrossCalls) {
+  InferenceSidecarRuntimeConfig config;
+  config.set_max_batch_size(2);
+  config.set_max_batch_queue_delay_us(10000000);
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(std::string(kModel1Dir), register_request)
+          .ok());
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request).ok());
+
+  // The two requests, of 2 and 1 rows, are evaluated as one batch of 3 rows
+  // and get their own rows back.
+  PredictRequest predict_request;
+  predict_request.set_input(kJsonStringWith1ModelVariedSize);
+  absl::StatusOr predict_status = tensorflow_module->Predict(predict_request);
+  ASSERT_TRUE(predict_status.ok()) << predict_status.status();
+  EXPECT_THAT(predict_status->output(), HasSubstr("\"tensor_shape\":[2,1]"));
+  EXPECT_THAT(predict_status->output(), HasSubstr("\"tensor_shape\":[1,1]"));
+}
+
 constexpr char kJsonStringEmbeddingModel[] = R"json({
   "request" : [{
     "model_path" : "./benchmark_models/embedding",
@@ -791,5 +929,38 @@ TEST(TensorflowModuleTest, PredictMultipleInvalidInputsReturnsFirstError) {
       HasSubstr("Error during inference for model './benchmark_models/pcvr'"));
 }
 
+TEST(TensorflowModuleTest, PredictMultipleInvalidInputsReturnsPartialResults) {
+  InferenceSidecarRuntimeConfig config;
+  std::unique_ptr<ModuleInterface> tensorflow_module =
+      ModuleInterface::Create(config);
+  RegisterModelRequest register_request_1;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(std::string(kModel1Dir), register_request_1)
+          .ok());
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request_1).ok());
+  RegisterModelRequest register_request_2;
+  ASSERT_TRUE(
+      PopulateRegisterModelRequest(std::string(kModel2Dir), register_request_2)
+          .ok());
+  ASSERT_TRUE(tensorflow_module->RegisterModel(register_request_2).ok());
+
+  PredictRequest predict_request;
+  predict_request.set_input(kJsonStringWithMultipleInvalidInputs);
+  predict_request.set_allow_partial_results(true);
+  absl::StatusOr predict_status = tensorflow_module->Predict(predict_request);
+  ASSERT_TRUE(predict_status.ok()) << predict_status.status();
+  // Each model holds its own error in place of the tensors.
+  EXPECT_THAT(predict_status->output(),
+              HasSubstr("{\"model_path\":\"./benchmark_models/pcvr\","
+                        "\"error\":{\"code\":13,"));
+  EXPECT_THAT(predict_status->output(),
+              HasSubstr("{\"model_path\":\"./benchmark_models/pctr\","
+                        "\"error\":{"));
+  ASSERT_EQ(predict_status->model_metrics_size(), 2);
+  for (const ModelMetrics& metrics : predict_status->model_metrics()) {
+    EXPECT_NE(metrics.error_code(), 0) << metrics.model_path();
+  }
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers::inference
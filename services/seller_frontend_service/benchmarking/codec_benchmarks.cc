@@ -0,0 +1,280 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the encoding, compression, framing and encryption done by SFE
+// on the requests from and the responses to clients, parameterized by the
+// size of the payload.
+
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "services/common/compression/gzip.h"
+#include "services/common/test/random.h"
+#include "services/common/test/utils/cbor_test_utils.h"
+#include "services/common/test/utils/ohttp_utils.h"
+#include "services/common/util/request_response_constants.h"
+#include "services/common/util/scoped_cbor.h"
+#include "services/seller_frontend_service/util/encryption_util.h"
+#include "services/seller_frontend_service/util/framing_utils.h"
+#include "services/seller_frontend_service/util/web_utils.h"
+#include "src/communication/encoding_utils.h"
+#include "src/communication/ohttp_utils.h"
+#include "src/encryption/key_fetcher/fake_key_fetcher_manager.h"
+
+#include "cbor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kTopLevelSeller[] = "https://top-level-seller.com";
+
+server_common::log::ContextImpl log_context{
+    {}, server_common::ConsentedDebugConfiguration()};
+
+std::string BuyerOrigin(int index) {
+  return absl::StrCat("https://buyer", index, ".com");
+}
+
+// Returns a CBOR encoded ProtectedAuctionInput with 10 buyers, whose
+// compressed BuyerInputs hold the given number of interest groups each.
+std::string MakeEncodedProtectedAuctionInput(int interest_groups_per_buyer) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  for (int buyer = 0; buyer < 10; ++buyer) {
+    BuyerInput& buyer_input = buyer_inputs[BuyerOrigin(buyer)];
+    for (int i = 0; i < interest_groups_per_buyer; ++i) {
+      buyer_input.mutable_interest_groups()->AddAllocated(
+          MakeARandomInterestGroupFromBrowser().release());
+    }
+  }
+  ProtectedAuctionInput protected_auction_input;
+  protected_auction_input.set_generation_id(MakeARandomString());
+  protected_auction_input.set_publisher_name(MakeARandomString());
+  auto encoded_buyer_inputs = GetEncodedBuyerInputMap(buyer_inputs);
+  CHECK_OK(encoded_buyer_inputs);
+  *protected_auction_input.mutable_buyer_input() =
+      *std::move(encoded_buyer_inputs);
+  auto encoded = CborEncodeProtectedAuctionProto(protected_auction_input);
+  CHECK_OK(encoded);
+  return *std::move(encoded);
+}
+
+// Returns a winning score and a bidding group map with the given number of
+// interest group indices, split between 10 buyers.
+std::pair<ScoreAdsResponse::AdScore,
+          google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>>
+MakeAuctionResultInputs(int num_bidding_interest_groups) {
+  ScoreAdsResponse::AdScore high_score = MakeARandomAdScore(
+      /*hob_buyer_entries=*/10, /*rejection_reason_ig_owners=*/0,
+      /*rejection_reason_ig_per_owner=*/0);
+  high_score.set_interest_group_owner(BuyerOrigin(0));
+  google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>
+      bidding_groups;
+  for (int i = 0; i < num_bidding_interest_groups; ++i) {
+    bidding_groups[BuyerOrigin(i % 10)].add_index(i / 10);
+  }
+  return {std::move(high_score), std::move(bidding_groups)};
+}
+
+std::string MakeEncodedAuctionResult(int num_bidding_interest_groups) {
+  auto [high_score, bidding_groups] =
+      MakeAuctionResultInputs(num_bidding_interest_groups);
+  auto encoded = Encode(high_score, bidding_groups, /*error=*/std::nullopt,
+                        [](const grpc::Status& status) {});
+  CHECK_OK(encoded);
+  return *std::move(encoded);
+}
+
+// Decodes the ProtectedAuctionInput, leaving its BuyerInputs compressed.
+static void BM_DecodeProtectedAuctionInput(benchmark::State& state) {
+  const std::string encoded = MakeEncodedProtectedAuctionInput(state.range(0));
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator(&log_context);
+    ProtectedAuctionInput decoded =
+        Decode<ProtectedAuctionInput>(encoded, error_accumulator);
+    benchmark::DoNotOptimize(decoded);
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_DecodeProtectedAuctionInput)->Arg(1)->Arg(10)->Arg(100);
+
+// Copies the compressed BuyerInputs out of a loaded CBOR tree.
+static void BM_DecodeBuyerInputKeys(benchmark::State& state) {
+  const std::string encoded = MakeEncodedProtectedAuctionInput(state.range(0));
+  cbor_load_result result;
+  ScopedCbor root(
+      cbor_load(reinterpret_cast<const unsigned char*>(encoded.data()),
+                encoded.size(), &result));
+  CHECK_EQ(result.error.code, CBOR_ERR_NONE);
+  cbor_item_t* buyer_inputs = nullptr;
+  for (const cbor_pair& entry :
+       absl::Span<cbor_pair>(cbor_map_handle(*root), cbor_map_size(*root))) {
+    if (CborStringView(entry.key) == kInterestGroups) {
+      buyer_inputs = entry.value;
+    }
+  }
+  CHECK(buyer_inputs != nullptr);
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator(&log_context);
+    auto decoded = DecodeBuyerInputKeys(*buyer_inputs, error_accumulator);
+    benchmark::DoNotOptimize(decoded);
+  }
+}
+BENCHMARK(BM_DecodeBuyerInputKeys)->Arg(1)->Arg(10)->Arg(100);
+
+// Encodes the AuctionResult of a single seller auction.
+static void BM_EncodeAuctionResult(benchmark::State& state) {
+  auto [high_score, bidding_groups] = MakeAuctionResultInputs(state.range(0));
+  for (auto _ : state) {
+    auto encoded = Encode(high_score, bidding_groups, /*error=*/std::nullopt,
+                          [](const grpc::Status& status) {});
+    CHECK_OK(encoded);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+BENCHMARK(BM_EncodeAuctionResult)->Arg(10)->Arg(100)->Arg(1000);
+
+// Encodes the AuctionResult of a component auction.
+static void BM_EncodeComponentAuctionResult(benchmark::State& state) {
+  auto [high_score, bidding_groups] = MakeAuctionResultInputs(state.range(0));
+  for (auto _ : state) {
+    auto encoded =
+        EncodeComponent(kTopLevelSeller, high_score, bidding_groups,
+                        /*error=*/std::nullopt,
+                        [](const grpc::Status& status) {});
+    CHECK_OK(encoded);
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+BENCHMARK(BM_EncodeComponentAuctionResult)->Arg(10)->Arg(100)->Arg(1000);
+
+// Decodes an AuctionResult, as top level sellers do with the results of
+// component auctions.
+static void BM_CborDecodeAuctionResultToProto(benchmark::State& state) {
+  const std::string encoded = MakeEncodedAuctionResult(state.range(0));
+  for (auto _ : state) {
+    auto decoded = CborDecodeAuctionResultToProto(encoded);
+    CHECK_OK(decoded);
+    benchmark::DoNotOptimize(decoded);
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_CborDecodeAuctionResultToProto)->Arg(10)->Arg(100)->Arg(1000);
+
+// Compresses an encoded AuctionResult, as the web response is.
+static void BM_GzipCompress(benchmark::State& state) {
+  const std::string encoded = MakeEncodedAuctionResult(state.range(0));
+  for (auto _ : state) {
+    auto compressed = GzipCompress(encoded);
+    CHECK_OK(compressed);
+    benchmark::DoNotOptimize(compressed);
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_GzipCompress)->Arg(10)->Arg(100)->Arg(1000);
+
+// Decompresses a BuyerInput of the given number of interest groups, as done
+// for each buyer of a web request.
+static void BM_GzipDecompress(benchmark::State& state) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  for (int i = 0; i < state.range(0); ++i) {
+    buyer_inputs[BuyerOrigin(0)].mutable_interest_groups()->AddAllocated(
+        MakeARandomInterestGroupFromBrowser().release());
+  }
+  auto encoded_buyer_inputs = GetEncodedBuyerInputMap(buyer_inputs);
+  CHECK_OK(encoded_buyer_inputs);
+  const std::string& compressed = encoded_buyer_inputs->at(BuyerOrigin(0));
+  for (auto _ : state) {
+    auto decompressed = GzipDecompress(compressed);
+    CHECK_OK(decompressed);
+    benchmark::DoNotOptimize(decompressed);
+  }
+  state.SetBytesProcessed(state.iterations() * compressed.size());
+}
+BENCHMARK(BM_GzipDecompress)->Arg(10)->Arg(100)->Arg(500);
+
+// Frames and pads a compressed response of the given size to the next power
+// of two.
+static void BM_EncodeResponsePayload(benchmark::State& state) {
+  const std::string compressed(state.range(0), 'a');
+  for (auto _ : state) {
+    auto framed = server_common::EncodeResponsePayload(
+        server_common::CompressionType::kGzip, compressed,
+        GetEncodedDataSize(compressed.size()));
+    CHECK_OK(framed);
+    benchmark::DoNotOptimize(framed);
+  }
+  state.SetBytesProcessed(state.iterations() * compressed.size());
+}
+BENCHMARK(BM_EncodeResponsePayload)->Range(1 << 8, 1 << 18);
+
+// Compresses an encoded AuctionResult straight into the framed response, as
+// both reactors do, in place of BM_GzipCompress and BM_EncodeResponsePayload.
+static void BM_CompressAndFrameResponse(benchmark::State& state) {
+  const std::string encoded = MakeEncodedAuctionResult(state.range(0));
+  for (auto _ : state) {
+    auto framed = CompressAndFrameResponse(encoded);
+    CHECK_OK(framed);
+    benchmark::DoNotOptimize(framed);
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+BENCHMARK(BM_CompressAndFrameResponse)->Arg(10)->Arg(100)->Arg(1000);
+
+// Decrypts an OHTTP encapsulated request of the given size.
+static void BM_DecryptOHTTPEncapsulatedHpkeCiphertext(
+    benchmark::State& state) {
+  server_common::FakeKeyFetcherManager key_fetcher_manager;
+  std::string plaintext(state.range(0), 'a');
+  auto request = CreateValidEncryptedRequest(plaintext, HpkeKeyset());
+  CHECK_OK(request);
+  const std::string ciphertext = request->EncapsulateAndSerialize();
+  for (auto _ : state) {
+    auto decrypted =
+        DecryptOHTTPEncapsulatedHpkeCiphertext(ciphertext, key_fetcher_manager);
+    CHECK_OK(decrypted);
+    benchmark::DoNotOptimize(decrypted);
+  }
+  state.SetBytesProcessed(state.iterations() * ciphertext.size());
+}
+BENCHMARK(BM_DecryptOHTTPEncapsulatedHpkeCiphertext)->Range(1 << 8, 1 << 18);
+
+// Encrypts and encapsulates a response of the given size for the client.
+static void BM_EncryptAndEncapsulateResponse(benchmark::State& state) {
+  server_common::FakeKeyFetcherManager key_fetcher_manager;
+  std::string request_plaintext = "request";
+  auto request = CreateValidEncryptedRequest(request_plaintext, HpkeKeyset());
+  CHECK_OK(request);
+  auto decrypted = DecryptOHTTPEncapsulatedHpkeCiphertext(
+      request->EncapsulateAndSerialize(), key_fetcher_manager);
+  CHECK_OK(decrypted);
+  const std::string response(state.range(0), 'a');
+  for (auto _ : state) {
+    auto encapsulated = server_common::EncryptAndEncapsulateResponse(
+        response, (*decrypted)->private_key, (*decrypted)->context,
+        (*decrypted)->request_label);
+    CHECK_OK(encapsulated);
+    benchmark::DoNotOptimize(encapsulated);
+  }
+  state.SetBytesProcessed(state.iterations() * response.size());
+}
+BENCHMARK(BM_EncryptAndEncapsulateResponse)->Range(1 << 8, 1 << 18);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
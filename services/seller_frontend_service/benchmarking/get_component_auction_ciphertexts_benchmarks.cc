@@ -0,0 +1,79 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the re-encryption of the protected auction ciphertext of a device
+// auction for its component sellers, with and without an executor to spread
+// the sellers over.
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "services/seller_frontend_service/get_component_auction_ciphertexts_reactor.h"
+#include "services/seller_frontend_service/util/select_ad_reactor_test_utils.h"
+#include "src/concurrent/event_engine_executor.h"
+#include "src/encryption/key_fetcher/fake_key_fetcher_manager.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+void ReEncryptForComponentSellers(benchmark::State& state,
+                                  server_common::Executor* executor) {
+  server_common::FakeKeyFetcherManager key_fetcher_manager;
+  absl::flat_hash_map<std::string, server_common::CloudPlatform>
+      seller_cloud_platforms;
+  GetComponentAuctionCiphertextsRequest request;
+  request.set_protected_auction_ciphertext(
+      GetFramedInputAndOhttpContext(std::string(4096, 'a')).first);
+  for (int i = 0; i < state.range(0); ++i) {
+    std::string seller = absl::StrCat("seller", i, ".example.com");
+    seller_cloud_platforms[seller] = i % 2 == 0
+                                         ? server_common::CloudPlatform::kGcp
+                                         : server_common::CloudPlatform::kAws;
+    request.add_component_sellers(std::move(seller));
+  }
+  for (auto _ : state) {
+    GetComponentAuctionCiphertextsResponse response;
+    GetComponentAuctionCiphertextsReactor reactor(
+        &request, &response, key_fetcher_manager, seller_cloud_platforms,
+        executor);
+    reactor.Execute();
+    CHECK_EQ(response.seller_component_ciphertexts_size(), state.range(0));
+    benchmark::DoNotOptimize(response);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GetComponentAuctionCiphertexts(benchmark::State& state) {
+  ReEncryptForComponentSellers(state, /*executor=*/nullptr);
+}
+BENCHMARK(BM_GetComponentAuctionCiphertexts)->DenseRange(2, 20, 6);
+
+static void BM_GetComponentAuctionCiphertexts_Executor(
+    benchmark::State& state) {
+  server_common::EventEngineExecutor executor(
+      grpc_event_engine::experimental::CreateEventEngine());
+  ReEncryptForComponentSellers(state, &executor);
+}
+BENCHMARK(BM_GetComponentAuctionCiphertexts_Executor)
+    ->DenseRange(2, 20, 6)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -76,6 +76,7 @@ class BuyerFrontEndAsyncClientStub : public BuyerFrontEndAsyncClient {
                                   GetBidsResponse::GetBidsRawResponse>>) &&>
           on_done,
       absl::Duration timeout) const override;
+  using BuyerFrontEndAsyncClient::ExecuteInternal;
 
  private:
   const std::string ad_render_url_;
@@ -152,6 +153,7 @@ class ScoringClientStub
                                   ScoreAdsResponse::ScoreAdsRawResponse>>) &&>
           on_done,
       absl::Duration timeout) const override;
+  using AsyncClient::ExecuteInternal;
 };
 
 absl::Status ScoringClientStub::Execute(
@@ -350,8 +352,7 @@ static void BM_PerformDebugReporting(benchmark::State& state) {
     grpc::CallbackServerContext context;
     SelectAdResponse response;
     metric::MetricContextMap<SelectAdRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     SelectAdReactorForWeb reactor(&context, &request, &response, clients,
                                   config_client);
     reactor.Execute();
@@ -402,8 +403,7 @@ static void BM_PerformCurrencyCheckingAndFiltering(benchmark::State& state) {
     grpc::CallbackServerContext context;
     SelectAdResponse response;
     metric::MetricContextMap<SelectAdRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request);
+        server_common::telemetry::BuildDependentConfig(config_proto));
     SelectAdReactorForWeb reactor(&context, &request, &response, clients,
                                   config_client);
     reactor.Execute();
@@ -0,0 +1,95 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "absl/log/check.h"
+#include "benchmark/benchmark.h"
+#include "services/common/compression/gzip.h"
+#include "services/common/test/random.h"
+#include "services/common/test/utils/cbor_test_utils.h"
+#include "services/common/util/scoped_cbor.h"
+#include "services/seller_frontend_service/util/web_utils.h"
+
+#include "cbor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kOwner[] = "https://buyer.com";
+
+server_common::log::ContextImpl log_context{
+    {}, server_common::ConsentedDebugConfiguration()};
+
+// Returns a gzip compressed, CBOR encoded BuyerInput from a browser with the
+// given number of interest groups.
+std::string MakeCompressedBuyerInput(int num_interest_groups) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  BuyerInput& buyer_input = buyer_inputs[kOwner];
+  for (int i = 0; i < num_interest_groups; ++i) {
+    buyer_input.mutable_interest_groups()->AddAllocated(
+        MakeARandomInterestGroupFromBrowser().release());
+  }
+  auto encoded_buyer_inputs = GetEncodedBuyerInputMap(buyer_inputs);
+  CHECK_OK(encoded_buyer_inputs);
+  return encoded_buyer_inputs->at(kOwner);
+}
+
+// Decodes the BuyerInput straight into the proto.
+static void BM_DecodeBuyerInput(benchmark::State& state) {
+  const std::string compressed_buyer_input =
+      MakeCompressedBuyerInput(state.range(0));
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator(&log_context);
+    BuyerInput buyer_input =
+        DecodeBuyerInput(kOwner, compressed_buyer_input, error_accumulator);
+    benchmark::DoNotOptimize(buyer_input);
+  }
+}
+BENCHMARK(BM_DecodeBuyerInput)->Arg(10)->Arg(100)->Arg(500);
+
+// Decompresses the BuyerInput and loads it into a tree of cbor_item_t, as the
+// decoding did before reading from the tree into the proto. This is a lower
+// bound of the cost of the tree based decoding.
+static void BM_DecompressAndLoadBuyerInputCborTree(benchmark::State& state) {
+  const std::string compressed_buyer_input =
+      MakeCompressedBuyerInput(state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<std::string> decompressed_buyer_input =
+        GzipDecompress(compressed_buyer_input);
+    cbor_load_result result;
+    ScopedCbor root(cbor_load(
+        reinterpret_cast<const unsigned char*>(decompressed_buyer_input->data()),
+        decompressed_buyer_input->size(), &result));
+    benchmark::DoNotOptimize(*root);
+  }
+}
+BENCHMARK(BM_DecompressAndLoadBuyerInputCborTree)->Arg(10)->Arg(100)->Arg(500);
+
+// Only decompresses the BuyerInput, the cost shared by both decodings.
+static void BM_DecompressBuyerInput(benchmark::State& state) {
+  const std::string compressed_buyer_input =
+      MakeCompressedBuyerInput(state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<std::string> decompressed_buyer_input =
+        GzipDecompress(compressed_buyer_input);
+    benchmark::DoNotOptimize(decompressed_buyer_input);
+  }
+}
+BENCHMARK(BM_DecompressBuyerInput)->Arg(10)->Arg(100)->Arg(500);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
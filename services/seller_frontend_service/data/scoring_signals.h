@@ -16,11 +16,13 @@
 #define FLEDGE_SERVICES_SELLER_FRONTEND_SERVICE_DATA_SCORING_SIGNALS_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "api/bidding_auction_servers.pb.h"
+#include "services/common/util/json_stream_scanner.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 using BuyerBidsResponseMap =
@@ -29,6 +31,9 @@ using BuyerBidsResponseMap =
 
 struct ScoringSignals {
   std::unique_ptr<std::string> scoring_signals;
+  // Offsets of the render URL signals within scoring_signals, if they were
+  // located as the signals streamed in.
+  std::optional<JsonPropertyOffsets> property_offsets;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
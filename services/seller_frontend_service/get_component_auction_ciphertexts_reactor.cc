@@ -14,9 +14,13 @@
 
 #include "services/seller_frontend_service/get_component_auction_ciphertexts_reactor.h"
 
+#include <optional>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/ascii.h"
+#include "services/common/util/parallel_for.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/seller_frontend_service/util/encryption_util.h"
 #include "src/util/status_macro/status_util.h"
@@ -47,8 +51,12 @@ void GetComponentAuctionCiphertextsReactor::Execute() {
     return;
   }
 
-  // Re-encrypt the decrypted data for each component seller and add to the
-  // response map
+  // Collect the component sellers to re-encrypt for, with the public key of
+  // their cloud platform, fetched once per platform.
+  std::vector<absl::string_view> sellers;
+  std::vector<server_common::CloudPlatform> seller_cloud_platforms;
+  absl::flat_hash_set<absl::string_view> seen_sellers;
+  absl::flat_hash_map<server_common::CloudPlatform, HpkePublicKey> public_keys;
   for (const auto& seller : request_->component_sellers()) {
     const auto& seller_cloud_platform_itr =
         seller_cloud_platforms_map_.find(absl::AsciiStrToLower(seller));
@@ -60,27 +68,53 @@ void GetComponentAuctionCiphertextsReactor::Execute() {
     }
 
     // Skip duplicates.
-    if (response_->mutable_seller_component_ciphertexts()->find(seller) !=
-        response_->mutable_seller_component_ciphertexts()->end()) {
+    if (!seen_sellers.insert(seller).second) {
       PS_LOG(WARNING, log_context_)
           << "Duplicate component seller in input: " << seller;
       continue;
     }
 
-    absl::StatusOr<OhttpHpkeEncryptedMessage> re_encrypted_data =
-        HpkeEncryptAndOHTTPEncapsulate(
-            (*decrypted_data)->plaintext, (*decrypted_data)->request_label,
-            key_fetcher_manager_, seller_cloud_platform_itr->second);
-    if (!re_encrypted_data.ok()) {
-      FinishWithStatus(
-          grpc::Status(server_common::FromAbslStatus(re_encrypted_data.status())
-                           .error_code(),
-                       absl::StrCat(kCiphertextEncryptionError,
-                                    re_encrypted_data.status().message())));
+    if (!public_keys.contains(seller_cloud_platform_itr->second)) {
+      absl::StatusOr<HpkePublicKey> public_key = GetHpkePublicKey(
+          key_fetcher_manager_, seller_cloud_platform_itr->second);
+      if (!public_key.ok()) {
+        FinishWithStatus(grpc::Status(
+            server_common::FromAbslStatus(public_key.status()).error_code(),
+            absl::StrCat(kCiphertextEncryptionError,
+                         public_key.status().message())));
+        return;
+      }
+      public_keys.emplace(seller_cloud_platform_itr->second,
+                          *std::move(public_key));
+    }
+    sellers.push_back(seller);
+    seller_cloud_platforms.push_back(seller_cloud_platform_itr->second);
+  }
+
+  // Re-encrypt the decrypted data for each component seller, in parallel, and
+  // add it to the response map.
+  std::vector<std::optional<absl::StatusOr<OhttpHpkeEncryptedMessage>>>
+      re_encrypted_data(sellers.size());
+  ParallelFor(executor_, static_cast<int>(sellers.size()),
+              [&decrypted_data, &seller_cloud_platforms, &public_keys,
+               &re_encrypted_data](int i) {
+                re_encrypted_data[i] = HpkeEncryptAndOHTTPEncapsulate(
+                    (*decrypted_data)->plaintext,
+                    (*decrypted_data)->request_label,
+                    public_keys.at(seller_cloud_platforms[i]));
+              });
+  for (int i = 0; i < sellers.size(); ++i) {
+    absl::StatusOr<OhttpHpkeEncryptedMessage>& seller_data =
+        *re_encrypted_data[i];
+    if (!seller_data.ok()) {
+      FinishWithStatus(grpc::Status(
+          server_common::FromAbslStatus(seller_data.status()).error_code(),
+          absl::StrCat(kCiphertextEncryptionError,
+                       seller_data.status().message())));
       return;
     }
-    (*response_->mutable_seller_component_ciphertexts())[seller] =
-        std::move(re_encrypted_data)->ciphertext;
+    (*response_->mutable_seller_component_ciphertexts())[sellers[i]] =
+        std::move(seller_data->ciphertext);
   }
 
   PS_VLOG(kSuccess, log_context_) << "Finishing RPC with success.";
@@ -106,11 +140,13 @@ GetComponentAuctionCiphertextsReactor::GetComponentAuctionCiphertextsReactor(
     GetComponentAuctionCiphertextsResponse* response,
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
     const absl::flat_hash_map<std::string, server_common::CloudPlatform>&
-        seller_cloud_platforms_map)
+        seller_cloud_platforms_map,
+    server_common::Executor* executor)
     : request_(request),
       response_(response),
       key_fetcher_manager_(key_fetcher_manager),
       seller_cloud_platforms_map_(seller_cloud_platforms_map),
+      executor_(executor),
       log_context_({}, server_common::ConsentedDebugConfiguration()) {}
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -25,6 +25,7 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
+#include "src/concurrent/executor.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 #include "src/logger/request_context_impl.h"
 
@@ -51,7 +52,9 @@ class GetComponentAuctionCiphertextsReactor : public grpc::ServerUnaryReactor {
       // This is currently performed while parsing the seller platform maps
       // config obtained from the parameter store.
       const absl::flat_hash_map<std::string, server_common::CloudPlatform>&
-          seller_cloud_platforms_map);
+          seller_cloud_platforms_map,
+      // Re-encrypts for the sellers in parallel on it, if set.
+      server_common::Executor* executor = nullptr);
   void Execute();
 
  private:
@@ -60,6 +63,7 @@ class GetComponentAuctionCiphertextsReactor : public grpc::ServerUnaryReactor {
   server_common::KeyFetcherManagerInterface& key_fetcher_manager_;
   const absl::flat_hash_map<std::string, server_common::CloudPlatform>&
       seller_cloud_platforms_map_;
+  server_common::Executor* executor_;
   server_common::log::ContextImpl log_context_;
 
   // Cleans up and deletes the GetComponentAuctionCiphertextsReactor. Called by
@@ -16,7 +16,11 @@
 
 #include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
@@ -61,10 +65,12 @@ class GetComponentAuctionCiphertextsReactorTest : public ::testing::Test {
   }
 
   GetComponentAuctionCiphertextsResponse CreateReactorAndRun(
-      const GetComponentAuctionCiphertextsRequest& request) {
+      const GetComponentAuctionCiphertextsRequest& request,
+      server_common::Executor* executor = nullptr) {
     GetComponentAuctionCiphertextsResponse response;
     auto class_under_test = GetComponentAuctionCiphertextsReactor(
-        &request, &response, *key_fetcher_manager_, seller_cloud_platform_map_);
+        &request, &response, *key_fetcher_manager_, seller_cloud_platform_map_,
+        executor);
     class_under_test.Execute();
     return response;
   }
@@ -157,4 +163,32 @@ TEST_F(GetComponentAuctionCiphertextsReactorTest, IgnoresUnknownSeller) {
   DecryptAndTestEncodedText(actual_response, kSeller2);
 }
 
+TEST_F(GetComponentAuctionCiphertextsReactorTest,
+       EncryptsCiphertextsForAllSellersOnExecutorThreads) {
+  std::vector<std::string> sellers;
+  for (int i = 0; i < 6; ++i) {
+    sellers.push_back(absl::StrCat("seller", i, ".example.com"));
+    seller_cloud_platform_map_[sellers.back()] =
+        i % 2 == 0 ? server_common::CloudPlatform::kGcp
+                   : server_common::CloudPlatform::kAws;
+    valid_request_.add_component_sellers(sellers.back());
+  }
+  MockExecutor executor;
+  std::vector<std::thread> threads;
+  EXPECT_CALL(executor, Run)
+      .WillRepeatedly([&threads](absl::AnyInvocable<void()> closure) {
+        threads.emplace_back(std::move(closure));
+      });
+
+  auto actual_response = CreateReactorAndRun(valid_request_, &executor);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // seller1 and seller2 are requested twice.
+  ASSERT_EQ(actual_response.seller_component_ciphertexts().size(), 6);
+  for (const std::string& seller : sellers) {
+    DecryptAndTestEncodedText(actual_response, seller);
+  }
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,341 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/seller_frontend_service/http_ingress.h"
+
+#include <netinet/in.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <event2/buffer.h>
+#include <event2/event.h>
+#include <event2/http.h>
+#include <event2/keyvalq_struct.h>
+#include <event2/listener.h>
+#include <event2/thread.h>
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/server_drain.h"
+#include "src/logger/request_context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Same as the limit of the gRPC server.
+constexpr size_t kMaxBodySize = 256L * 1024L * 1024L;
+constexpr char kJsonContentType[] = "application/json";
+
+void SendReply(evhttp_request* request, int code, absl::string_view body,
+               absl::string_view content_type = kJsonContentType) {
+  evhttp_add_header(evhttp_request_get_output_headers(request), "Content-Type",
+                    std::string(content_type).c_str());
+  evbuffer* buffer = evbuffer_new();
+  evbuffer_add(buffer, body.data(), body.size());
+  evhttp_send_reply(request, code, /*reason=*/nullptr, buffer);
+  evbuffer_free(buffer);
+}
+
+void SendStatus(evhttp_request* request, const grpc::Status& status) {
+  SendReply(request, GrpcToHttpStatus(status.error_code()),
+            GetSelectAdResponseJson(status, SelectAdResponse()));
+}
+
+}  // namespace
+
+int GrpcToHttpStatus(grpc::StatusCode code) {
+  switch (code) {
+    case grpc::StatusCode::OK:
+      return 200;
+    case grpc::StatusCode::CANCELLED:
+      return 499;
+    case grpc::StatusCode::INVALID_ARGUMENT:
+    case grpc::StatusCode::FAILED_PRECONDITION:
+    case grpc::StatusCode::OUT_OF_RANGE:
+      return 400;
+    case grpc::StatusCode::DEADLINE_EXCEEDED:
+      return 504;
+    case grpc::StatusCode::NOT_FOUND:
+      return 404;
+    case grpc::StatusCode::ALREADY_EXISTS:
+    case grpc::StatusCode::ABORTED:
+      return 409;
+    case grpc::StatusCode::PERMISSION_DENIED:
+      return 403;
+    case grpc::StatusCode::UNAUTHENTICATED:
+      return 401;
+    case grpc::StatusCode::RESOURCE_EXHAUSTED:
+      return 429;
+    case grpc::StatusCode::UNIMPLEMENTED:
+      return 501;
+    case grpc::StatusCode::UNAVAILABLE:
+      return 503;
+    default:
+      return 500;
+  }
+}
+
+bool IsForwardedHttpHeader(absl::string_view name) {
+  return absl::StartsWithIgnoreCase(name, "x-") ||
+         absl::EqualsIgnoreCase(name, kTraceParentKey);
+}
+
+absl::StatusOr<SelectAdRequest*> ParseSelectAdRequestJson(
+    absl::string_view json, google::protobuf::Arena& arena) {
+  auto* request =
+      google::protobuf::Arena::CreateMessage<SelectAdRequest>(&arena);
+  // Bytes fields, i.e. the ciphertexts, are base64 decoded by the parser.
+  auto status = google::protobuf::util::JsonStringToMessage(json, request);
+  if (!status.ok()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed SelectAdRequest JSON: ", status.message()));
+  }
+  return request;
+}
+
+std::string GetSelectAdResponseJson(const grpc::Status& status,
+                                    const SelectAdResponse& response) {
+  if (status.ok()) {
+    std::string json;
+    if (google::protobuf::util::MessageToJsonString(response, &json).ok()) {
+      return json;
+    }
+    return GetSelectAdResponseJson(
+        grpc::Status(grpc::StatusCode::INTERNAL,
+                     "Unable to convert the SelectAdResponse to JSON"),
+        response);
+  }
+  rapidjson::Document document(rapidjson::kObjectType);
+  document.AddMember("code", static_cast<int>(status.error_code()),
+                     document.GetAllocator());
+  document.AddMember(
+      "message",
+      rapidjson::Value(status.error_message().data(),
+                       status.error_message().size(), document.GetAllocator()),
+      document.GetAllocator());
+  return SerializeJsonDoc(document).value_or("{}");
+}
+
+// An event loop serving the port, with its own listening socket.
+struct HttpIngress::Loop {
+  HttpIngress* ingress;
+  event_base* base = nullptr;
+  evhttp* http = nullptr;
+  std::thread thread;
+  // Call in flight on each connection. Only used on the thread of the loop.
+  absl::flat_hash_map<evhttp_connection*, Call*> calls;
+};
+
+// A SelectAd request, from its HTTP request to its HTTP response.
+struct HttpIngress::Call {
+  Loop* loop;
+  // Null once the client closed the connection.
+  evhttp_request* request;
+  google::protobuf::Arena arena;
+  SelectAdResponse* response = nullptr;
+  grpc::ClientContext context;
+  grpc::Status status;
+  std::string body;
+};
+
+HttpIngress::HttpIngress(HttpIngressOptions options,
+                         std::shared_ptr<grpc::Channel> channel)
+    : options_(options), stub_(SellerFrontEnd::NewStub(std::move(channel))) {}
+
+HttpIngress::~HttpIngress() { Stop(); }
+
+absl::Status HttpIngress::Start() {
+  evthread_use_pthreads();
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(options_.port);
+  for (int i = 0; i < std::max(options_.num_threads, 1); ++i) {
+    auto loop = std::make_unique<Loop>();
+    loop->ingress = this;
+    loop->base = event_base_new();
+    loop->http = evhttp_new(loop->base);
+    evhttp_set_max_body_size(loop->http, kMaxBodySize);
+    evhttp_set_allowed_methods(loop->http, EVHTTP_REQ_GET | EVHTTP_REQ_POST);
+    evhttp_set_gencb(loop->http, &HttpIngress::HandleRequest, loop.get());
+    // Each loop accepts its own connections, balanced by the kernel.
+    evconnlistener* listener = evconnlistener_new_bind(
+        loop->base, /*cb=*/nullptr, /*ptr=*/nullptr,
+        LEV_OPT_REUSEABLE | LEV_OPT_REUSEABLE_PORT | LEV_OPT_CLOSE_ON_FREE |
+            LEV_OPT_CLOSE_ON_EXEC,
+        /*backlog=*/-1, reinterpret_cast<sockaddr*>(&address),
+        sizeof(address));
+    if (listener != nullptr &&
+        evhttp_bind_listener(loop->http, listener) == nullptr) {
+      evconnlistener_free(listener);
+      listener = nullptr;
+    }
+    if (listener == nullptr) {
+      evhttp_free(loop->http);
+      event_base_free(loop->base);
+      Stop();
+      return absl::UnavailableError(
+          absl::StrCat("Unable to listen on HTTP port ", options_.port));
+    }
+    loops_.push_back(std::move(loop));
+  }
+  for (auto& loop : loops_) {
+    loop->thread = std::thread(
+        [base = loop->base]() { event_base_dispatch(base); });
+  }
+  PS_LOG(INFO) << "HTTP ingress listening on port " << options_.port;
+  return absl::OkStatus();
+}
+
+void HttpIngress::Stop() {
+  if (loops_.empty()) {
+    return;
+  }
+  stopping_ = true;
+  {
+    absl::MutexLock lock(&mu_);
+    for (Call* call : calls_) {
+      call->context.TryCancel();
+    }
+    // The responses are sent by the event loops, still running.
+    mu_.Await(absl::Condition(
+        +[](absl::flat_hash_set<Call*>* calls) { return calls->empty(); },
+        &calls_));
+  }
+  for (auto& loop : loops_) {
+    event_base_loopbreak(loop->base);
+    if (loop->thread.joinable()) {
+      loop->thread.join();
+    }
+    evhttp_free(loop->http);
+    event_base_free(loop->base);
+  }
+  loops_.clear();
+}
+
+void HttpIngress::HandleRequest(evhttp_request* request, void* arg) {
+  auto* loop = static_cast<Loop*>(arg);
+  const char* path =
+      evhttp_uri_get_path(evhttp_request_get_evhttp_uri(request));
+  if (path != nullptr && path == kHealthCheckHttpPath) {
+    const bool serving =
+        !ServerDrain::Draining() && !loop->ingress->stopping_.load();
+    SendReply(request, serving ? 200 : 503, serving ? "OK" : "Draining",
+              "text/plain");
+    return;
+  }
+  if (path == nullptr || path != kSelectAdHttpPath) {
+    SendStatus(request, grpc::Status(grpc::StatusCode::NOT_FOUND,
+                                     "Unknown path"));
+    return;
+  }
+  if (evhttp_request_get_command(request) != EVHTTP_REQ_POST) {
+    SendStatus(request, grpc::Status(grpc::StatusCode::UNIMPLEMENTED,
+                                     "SelectAd only accepts POST"));
+    return;
+  }
+  loop->ingress->HandleSelectAd(*loop, request);
+}
+
+void HttpIngress::HandleSelectAd(Loop& loop, evhttp_request* request) {
+  if (stopping_.load()) {
+    SendStatus(request, grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                                     "The server is shutting down"));
+    return;
+  }
+  auto call = std::make_unique<Call>();
+  call->loop = &loop;
+  call->request = request;
+
+  evbuffer* input = evhttp_request_get_input_buffer(request);
+  const size_t length = evbuffer_get_length(input);
+  absl::StatusOr<SelectAdRequest*> select_ad_request =
+      ParseSelectAdRequestJson(
+          absl::string_view(
+              reinterpret_cast<const char*>(evbuffer_pullup(input, -1)),
+              length),
+          call->arena);
+  if (!select_ad_request.ok()) {
+    SendStatus(request,
+               grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                            std::string(select_ad_request.status().message())));
+    return;
+  }
+  call->response =
+      google::protobuf::Arena::CreateMessage<SelectAdResponse>(&call->arena);
+  const evkeyvalq* headers = evhttp_request_get_input_headers(request);
+  for (const evkeyval* header = headers->tqh_first; header != nullptr;
+       header = header->next.tqe_next) {
+    if (IsForwardedHttpHeader(header->key)) {
+      call->context.AddMetadata(absl::AsciiStrToLower(header->key),
+                                header->value);
+    }
+  }
+
+  // The loop learns of the clients closing their connection, to drop the
+  // requests freed with the connection and cancel their calls.
+  evhttp_connection* connection = evhttp_request_get_connection(request);
+  evhttp_connection_set_closecb(connection, &HttpIngress::HandleClose, &loop);
+  Call* raw_call = call.release();
+  loop.calls[connection] = raw_call;
+  {
+    absl::MutexLock lock(&mu_);
+    calls_.insert(raw_call);
+  }
+  stub_->async()->SelectAd(
+      &raw_call->context, *select_ad_request, raw_call->response,
+      [raw_call](grpc::Status status) {
+        // Converted off the event loop, which only sends the response.
+        raw_call->body = GetSelectAdResponseJson(status, *raw_call->response);
+        raw_call->status = std::move(status);
+        timeval now = {0, 0};
+        event_base_once(raw_call->loop->base, /*fd=*/-1, EV_TIMEOUT,
+                        &HttpIngress::SendResponse, raw_call, &now);
+      });
+}
+
+void HttpIngress::HandleClose(evhttp_connection* connection, void* arg) {
+  auto* loop = static_cast<Loop*>(arg);
+  auto it = loop->calls.find(connection);
+  if (it == loop->calls.end()) {
+    return;
+  }
+  it->second->request = nullptr;
+  it->second->context.TryCancel();
+  loop->calls.erase(it);
+}
+
+void HttpIngress::SendResponse(int fd, short events, void* arg) {
+  auto* call = static_cast<Call*>(arg);
+  if (call->request != nullptr) {
+    call->loop->calls.erase(evhttp_request_get_connection(call->request));
+    SendReply(call->request, GrpcToHttpStatus(call->status.error_code()),
+              call->body);
+  }
+  HttpIngress* ingress = call->loop->ingress;
+  {
+    absl::MutexLock lock(&ingress->mu_);
+    ingress->calls_.erase(call);
+  }
+  delete call;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
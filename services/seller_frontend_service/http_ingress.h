@@ -0,0 +1,119 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_HTTP_INGRESS_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_HTTP_INGRESS_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+#include <grpcpp/grpcpp.h>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "api/bidding_auction_servers.grpc.pb.h"
+
+struct evhttp_connection;
+struct evhttp_request;
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Paths served by the HTTP ingress, the same as with the gRPC-JSON
+// transcoding of Envoy.
+inline constexpr absl::string_view kSelectAdHttpPath = "/v1/selectAd";
+inline constexpr absl::string_view kHealthCheckHttpPath = "/healthcheck";
+
+// Returns the HTTP status of a response with the gRPC status `code`, mapped
+// as by the gRPC-JSON transcoding of Envoy.
+int GrpcToHttpStatus(grpc::StatusCode code);
+
+// Returns true if the header of an HTTP request is forwarded to the service
+// as metadata, i.e. the x- headers read by the reactors, and the trace
+// context.
+bool IsForwardedHttpHeader(absl::string_view name);
+
+// Parses the JSON body of an HTTP SelectAd request, with the ciphertexts in
+// base64, into a request allocated on `arena`.
+absl::StatusOr<SelectAdRequest*> ParseSelectAdRequestJson(
+    absl::string_view json, google::protobuf::Arena& arena);
+
+// Returns the JSON body of the HTTP response to a call: the response if
+// `status` is OK, else the status as google.rpc.Status, as Envoy does.
+std::string GetSelectAdResponseJson(const grpc::Status& status,
+                                    const SelectAdResponse& response);
+
+struct HttpIngressOptions {
+  int port = 0;
+  // Threads running an event loop each, with their own listening socket on
+  // the port.
+  int num_threads = 1;
+};
+
+// Serves SelectAd as JSON over HTTP/1.1 in the SFE process, so that ad
+// servers can call SFE without an Envoy proxy transcoding their requests.
+// Each request is parsed into an arena-allocated proto and handed to the
+// service over the in-process channel of the gRPC server, so that it goes
+// through the same reactor as a gRPC call, without another network hop. Also
+// serves a health check for HTTP load balancers, reporting the server as not
+// serving once it drains.
+class HttpIngress {
+ public:
+  // `channel` must be the in-process channel of the server of the
+  // SellerFrontEnd service.
+  HttpIngress(HttpIngressOptions options,
+              std::shared_ptr<grpc::Channel> channel);
+  // Stops the ingress if it is running.
+  ~HttpIngress();
+
+  // HttpIngress is neither copyable nor movable.
+  HttpIngress(const HttpIngress&) = delete;
+  HttpIngress& operator=(const HttpIngress&) = delete;
+
+  // Binds the port and starts serving.
+  absl::Status Start();
+
+  // Rejects the requests received from now on, cancels the ones in flight,
+  // then waits for their responses to be sent and stops the event loops.
+  void Stop();
+
+ private:
+  struct Loop;
+  struct Call;
+
+  static void HandleRequest(evhttp_request* request, void* arg);
+  static void HandleClose(evhttp_connection* connection, void* arg);
+  static void SendResponse(int fd, short events, void* arg);
+
+  void HandleSelectAd(Loop& loop, evhttp_request* request);
+
+  const HttpIngressOptions options_;
+  const std::unique_ptr<SellerFrontEnd::Stub> stub_;
+  std::vector<std::unique_ptr<Loop>> loops_;
+  std::atomic<bool> stopping_ = false;
+  absl::Mutex mu_;
+  // Calls in flight, cancelled by Stop.
+  absl::flat_hash_set<Call*> calls_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_HTTP_INGRESS_H_
@@ -0,0 +1,71 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/seller_frontend_service/http_ingress.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(HttpIngressTest, MapsGrpcStatusesAsEnvoy) {
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::OK), 200);
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::INVALID_ARGUMENT), 400);
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::DEADLINE_EXCEEDED), 504);
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::RESOURCE_EXHAUSTED), 429);
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::UNAVAILABLE), 503);
+  EXPECT_EQ(GrpcToHttpStatus(grpc::StatusCode::INTERNAL), 500);
+}
+
+TEST(HttpIngressTest, ForwardsClientHeadersAndTraceContext) {
+  EXPECT_TRUE(IsForwardedHttpHeader("X-BnA-Client-IP"));
+  EXPECT_TRUE(IsForwardedHttpHeader("x-user-agent"));
+  EXPECT_TRUE(IsForwardedHttpHeader("traceparent"));
+  EXPECT_FALSE(IsForwardedHttpHeader("Content-Length"));
+  EXPECT_FALSE(IsForwardedHttpHeader("Host"));
+}
+
+TEST(HttpIngressTest, ParsesRequestWithBase64Ciphertext) {
+  google::protobuf::Arena arena;
+  absl::StatusOr<SelectAdRequest*> request = ParseSelectAdRequestJson(
+      R"json({"protectedAuctionCiphertext": "AQID",
+              "auctionConfig": {"seller": "seller.com"},
+              "clientType": "CLIENT_TYPE_BROWSER"})json",
+      arena);
+  ASSERT_TRUE(request.ok()) << request.status();
+  EXPECT_EQ((*request)->GetArena(), &arena);
+  EXPECT_EQ((*request)->protected_auction_ciphertext(), "\x01\x02\x03");
+  EXPECT_EQ((*request)->auction_config().seller(), "seller.com");
+  EXPECT_EQ((*request)->client_type(), CLIENT_TYPE_BROWSER);
+
+  EXPECT_EQ(ParseSelectAdRequestJson("{\"unknownField\": 1}", arena)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(HttpIngressTest, WritesResponseOrStatus) {
+  SelectAdResponse response;
+  response.set_auction_result_ciphertext("\x01\x02\x03");
+  EXPECT_EQ(GetSelectAdResponseJson(grpc::Status::OK, response),
+            R"json({"auctionResultCiphertext":"AQID"})json");
+  EXPECT_EQ(
+      GetSelectAdResponseJson(
+          grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "bad \"input\""),
+          response),
+      R"json({"code":3,"message":"bad \"input\""})json");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
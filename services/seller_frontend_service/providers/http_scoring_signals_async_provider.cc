@@ -16,15 +16,115 @@
 
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "services/common/util/log_throttle.h"
+#include "services/common/util/request_response_constants.h"
+#include "services/seller_frontend_service/util/scoring_signals_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using OnScoringSignalsDone =
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>,
+                            GetByteSize) &&>;
+
+// Minimum interval between the logs of each KV failure site. While the KV
+// server is unavailable, every request fails.
+constexpr int kKvFailureLogIntervalSec = 1;
+
+// State shared by the seller KV requests of a sharded lookup. The last
+// request to finish merges the signals and invokes on_done.
+struct ShardedScoringSignalsFetch {
+  absl::Mutex mu;
+  int pending ABSL_GUARDED_BY(mu) = 0;
+  int failed ABSL_GUARDED_BY(mu) = 0;
+  // Last error of the failed requests.
+  absl::Status status ABSL_GUARDED_BY(mu);
+  std::vector<std::unique_ptr<ScoringSignals>> signals ABSL_GUARDED_BY(mu);
+  GetByteSize get_byte_size ABSL_GUARDED_BY(mu) = {};
+  OnScoringSignalsDone on_done;
+};
+
+// Splits the keys of the request into inputs of at most max_keys keys each,
+// with the same non-key params as the request. Keeps the sorted order of the
+// keys, so that the same key set always yields the same requests.
+std::vector<std::unique_ptr<GetSellerValuesInput>> ShardKeys(
+    const GetSellerValuesInput& request, int max_keys) {
+  std::vector<std::unique_ptr<GetSellerValuesInput>> shards;
+  int num_keys = max_keys;
+  auto next_shard = [&]() -> GetSellerValuesInput& {
+    if (num_keys == max_keys) {
+      auto shard = std::make_unique<GetSellerValuesInput>();
+      shard->client_type = request.client_type;
+      shard->seller_kv_experiment_group_id =
+          request.seller_kv_experiment_group_id;
+      shard->scan_properties = {kRenderUrlsProperty,
+                                kAdComponentRenderUrlsProperty};
+      shards.push_back(std::move(shard));
+      num_keys = 0;
+    }
+    ++num_keys;
+    return *shards.back();
+  };
+  for (absl::string_view key : request.render_urls) {
+    GetSellerValuesInput& shard = next_shard();
+    shard.render_urls.emplace_hint(shard.render_urls.end(), key);
+  }
+  for (absl::string_view key : request.ad_component_render_urls) {
+    GetSellerValuesInput& shard = next_shard();
+    shard.ad_component_render_urls.emplace_hint(
+        shard.ad_component_render_urls.end(), key);
+  }
+  return shards;
+}
+
+void OnShardDone(ShardedScoringSignalsFetch& fetch,
+                 absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>
+                     kv_output) {
+  absl::MutexLock lock(&fetch.mu);
+  if (kv_output.ok()) {
+    fetch.get_byte_size.request += (*kv_output)->request_size;
+    fetch.get_byte_size.response += (*kv_output)->response_size;
+    auto signals = std::make_unique<ScoringSignals>();
+    signals->scoring_signals =
+        std::make_unique<std::string>(std::move((*kv_output)->result));
+    signals->property_offsets = std::move((*kv_output)->property_offsets);
+    fetch.signals.push_back(std::move(signals));
+  } else {
+    ++fetch.failed;
+    fetch.status = kv_output.status();
+  }
+  if (--fetch.pending > 0) {
+    return;
+  }
+
+  if (fetch.signals.empty()) {
+    std::move(fetch.on_done)(fetch.status, fetch.get_byte_size);
+    return;
+  }
+  if (fetch.failed > 0) {
+    PS_VLOG(kNoisyWarn) << fetch.failed << " of "
+                        << fetch.failed + fetch.signals.size()
+                        << " seller KV requests failed, scoring with partial "
+                           "signals. Last error: "
+                        << fetch.status;
+  }
+  std::move(fetch.on_done)(MergeScoringSignals(fetch.signals),
+                           fetch.get_byte_size);
+}
+
+}  // namespace
 
 HttpScoringSignalsAsyncProvider::HttpScoringSignalsAsyncProvider(
     std::unique_ptr<AsyncClient<GetSellerValuesInput, GetSellerValuesOutput>>
         http_seller_kv_async_client,
-    bool enable_protected_app_signals)
+    bool enable_protected_app_signals,
+    HttpScoringSignalsFetchOptions fetch_options)
     : http_seller_kv_async_client_(std::move(http_seller_kv_async_client)),
-      enable_protected_app_signals_(enable_protected_app_signals) {}
+      enable_protected_app_signals_(enable_protected_app_signals),
+      fetch_options_(fetch_options) {}
 
 void HttpScoringSignalsAsyncProvider::Get(
     const ScoringSignalsRequest& scoring_signals_request,
@@ -33,22 +133,43 @@ void HttpScoringSignalsAsyncProvider::Get(
         on_done,
     absl::Duration timeout) const {
   auto request = std::make_unique<GetSellerValuesInput>();
+  auto add_render_url = [&request,
+                         &scoring_signals_request](absl::string_view url) {
+    if (!scoring_signals_request.cached_render_urls_.contains(url)) {
+      request->render_urls.emplace(url);
+    }
+  };
   for (const auto& [unused_buyer, get_bids_response] :
        scoring_signals_request.buyer_bids_map_) {
     for (const auto& ad : get_bids_response->bids()) {
-      request->render_urls.emplace(ad.render());
-      request->ad_component_render_urls.insert(ad.ad_components().begin(),
-                                               ad.ad_components().end());
+      add_render_url(ad.render());
+      for (const auto& ad_component : ad.ad_components()) {
+        if (!scoring_signals_request.cached_ad_component_render_urls_.contains(
+                ad_component)) {
+          request->ad_component_render_urls.emplace(ad_component);
+        }
+      }
     }
     if (enable_protected_app_signals_) {
       for (const auto& ad : get_bids_response->protected_app_signals_bids()) {
-        request->render_urls.emplace(ad.render());
+        add_render_url(ad.render());
       }
     }
   }
   request->client_type = scoring_signals_request.client_type_;
   request->seller_kv_experiment_group_id =
       scoring_signals_request.seller_kv_experiment_group_id_;
+  if (fetch_options_.scan_responses) {
+    request->scan_properties = {kRenderUrlsProperty,
+                                kAdComponentRenderUrlsProperty};
+  }
+  if (fetch_options_.max_keys_per_request > 0 &&
+      request->render_urls.size() + request->ad_component_render_urls.size() >
+          fetch_options_.max_keys_per_request) {
+    GetSharded(std::move(request), scoring_signals_request.filtering_metadata_,
+               std::move(on_done), timeout);
+    return;
+  }
   auto status = http_seller_kv_async_client_->Execute(
       std::move(request), scoring_signals_request.filtering_metadata_,
       [on_done = std::move(on_done)](
@@ -58,8 +179,10 @@ void HttpScoringSignalsAsyncProvider::Get(
         absl::StatusOr<std::unique_ptr<ScoringSignals>> res;
         if (kv_output.ok()) {
           res = std::make_unique<ScoringSignals>();
-          res.value()->scoring_signals =
-              std::make_unique<std::string>(kv_output.value()->result);
+          res.value()->scoring_signals = std::make_unique<std::string>(
+              std::move(kv_output.value()->result));
+          res.value()->property_offsets =
+              std::move(kv_output.value()->property_offsets);
           get_byte_size.request = kv_output.value()->request_size;
           get_byte_size.response = kv_output.value()->response_size;
         } else {
@@ -69,7 +192,34 @@ void HttpScoringSignalsAsyncProvider::Get(
       },
       timeout);
   if (!status.ok()) {
-    PS_LOG(ERROR) << "Unable to get seller KV signals: " << status;
+    PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+        << "Unable to get seller KV signals: " << status;
+  }
+}
+
+void HttpScoringSignalsAsyncProvider::GetSharded(
+    std::unique_ptr<GetSellerValuesInput> request,
+    const RequestMetadata& metadata, OnScoringSignalsDone on_done,
+    absl::Duration timeout) const {
+  std::vector<std::unique_ptr<GetSellerValuesInput>> shards =
+      ShardKeys(*request, fetch_options_.max_keys_per_request);
+  auto fetch = std::make_shared<ShardedScoringSignalsFetch>();
+  fetch->on_done = std::move(on_done);
+  {
+    absl::MutexLock lock(&fetch->mu);
+    fetch->pending = shards.size();
+  }
+  for (auto& shard : shards) {
+    auto status = http_seller_kv_async_client_->Execute(
+        std::move(shard), metadata,
+        [fetch](absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>
+                    kv_output) { OnShardDone(*fetch, std::move(kv_output)); },
+        timeout);
+    if (!status.ok()) {
+      PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+          << "Unable to get seller KV signals: " << status;
+      OnShardDone(*fetch, std::move(status));
+    }
   }
 }
 
@@ -23,12 +23,26 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+struct HttpScoringSignalsFetchOptions {
+  // Max number of render URL and ad component render URL keys looked up by a
+  // single seller KV request. Larger key sets are split into requests of at
+  // most this many keys, which are sent in parallel. 0 sends all the keys in
+  // a single request.
+  int max_keys_per_request = 0;
+  // Whether the render URL signals are located in the responses as they
+  // stream in, for the responses to be merged without being scanned again,
+  // e.g. when the signals are fetched per buyer. The responses of split
+  // requests are always scanned.
+  bool scan_responses = false;
+};
+
 class HttpScoringSignalsAsyncProvider final
     : public ScoringSignalsAsyncProvider {
  public:
   explicit HttpScoringSignalsAsyncProvider(
       std::unique_ptr<AsyncClient<GetSellerValuesInput, GetSellerValuesOutput>>,
-      bool enable_protected_app_signals = false);
+      bool enable_protected_app_signals = false,
+      HttpScoringSignalsFetchOptions fetch_options = {});
 
   // HttpScoringSignalsAsyncProvider is neither copyable nor movable.
   HttpScoringSignalsAsyncProvider(const HttpScoringSignalsAsyncProvider&) =
@@ -38,7 +52,10 @@ class HttpScoringSignalsAsyncProvider final
 
   // Obtains bidding signals by batching the keys in the buyer input
   // interest groups. When the output from all Key Value servers is obtained,
-  // the on_done function is invoked with the results.
+  // the on_done function is invoked with the results. If the keys are split
+  // into several requests, their responses are merged, and the signals of the
+  // requests that failed or timed out are left out. An error is returned only
+  // if all of the requests failed.
   void Get(const ScoringSignalsRequest& scoring_signals_request,
            absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
 
@@ -48,9 +65,20 @@ class HttpScoringSignalsAsyncProvider final
            absl::Duration timeout) const override;
 
  private:
+  // Looks up the keys with one seller KV request per shard of at most
+  // max_keys_per_request keys.
+  void GetSharded(
+      std::unique_ptr<GetSellerValuesInput> request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>,
+                              GetByteSize) &&>
+          on_done,
+      absl::Duration timeout) const;
+
   std::unique_ptr<AsyncClient<GetSellerValuesInput, GetSellerValuesOutput>>
       http_seller_kv_async_client_;
   const bool enable_protected_app_signals_;
+  const HttpScoringSignalsFetchOptions fetch_options_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
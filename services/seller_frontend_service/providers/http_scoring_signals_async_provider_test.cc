@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/notification.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
@@ -239,5 +240,162 @@ TEST(HttpScoringSignalsAsyncProviderTest, MapsResponseToScoringSignals) {
   notification.WaitForNotification();
 }
 
+// Returns a single buyer bids map with an ad per render URL, each with the
+// same ad components.
+BuyerBidsResponseMap MakeBuyerBidsMap(
+    const std::vector<std::string>& render_urls,
+    const std::vector<std::string>& ad_component_render_urls) {
+  auto get_bid_res = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+  for (const auto& render_url : render_urls) {
+    AdWithBid* ad_with_bid = get_bid_res->mutable_bids()->Add();
+    ad_with_bid->set_render(render_url);
+    for (const auto& ad_component_render_url : ad_component_render_urls) {
+      *ad_with_bid->mutable_ad_components()->Add() = ad_component_render_url;
+    }
+  }
+  BuyerBidsResponseMap buyer_bids_map;
+  buyer_bids_map.try_emplace("buyer.com", std::move(get_bid_res));
+  return buyer_bids_map;
+}
+
+// Responds to every seller KV request with the signals of its render URL
+// keys, and fails the requests for the render URL failed_render_url.
+void RespondWithRenderUrlSignals(
+    AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput>& mock_client,
+    int times, std::vector<int>& num_keys_per_request,
+    absl::string_view failed_render_url = "") {
+  EXPECT_CALL(
+      mock_client,
+      Execute(An<std::unique_ptr<GetSellerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetSellerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .Times(times)
+      .WillRepeatedly(
+          [&num_keys_per_request, failed_render_url](
+              std::unique_ptr<GetSellerValuesInput> input,
+              const RequestMetadata& metadata,
+              absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>)&&>
+                  callback,
+              absl::Duration timeout) {
+            EXPECT_EQ(input->client_type, ClientType::CLIENT_TYPE_BROWSER);
+            EXPECT_EQ(input->seller_kv_experiment_group_id, kSellerEgId);
+            num_keys_per_request.push_back(
+                input->render_urls.size() +
+                input->ad_component_render_urls.size());
+            if (input->render_urls.contains(failed_render_url)) {
+              std::move(callback)(absl::DeadlineExceededError("timeout"));
+              return absl::OkStatus();
+            }
+            std::vector<std::string> signals;
+            for (absl::string_view render_url : input->render_urls) {
+              signals.push_back(absl::StrCat("\"", render_url, "\":1"));
+            }
+            auto output = std::make_unique<GetSellerValuesOutput>();
+            output->result = absl::StrCat(
+                R"({"renderUrls":{)", absl::StrJoin(signals, ","), "}}");
+            output->request_size = 10;
+            output->response_size = output->result.size();
+            std::move(callback)(std::move(output));
+            return absl::OkStatus();
+          });
+}
+
+TEST(HttpScoringSignalsAsyncProviderTest, ShardsKeysAndMergesResponses) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput>>();
+  std::vector<int> num_keys_per_request;
+  RespondWithRenderUrlSignals(*mock_client, /*times=*/3, num_keys_per_request);
+  BuyerBidsResponseMap buyer_bids_map =
+      MakeBuyerBidsMap({"url1", "url2", "url3"}, {"comp1", "comp2"});
+
+  HttpScoringSignalsAsyncProvider class_under_test(
+      std::move(mock_client), /*enable_protected_app_signals=*/false,
+      {.max_keys_per_request = 2});
+  absl::Notification notification;
+  class_under_test.Get(
+      ScoringSignalsRequest(buyer_bids_map, {}, ClientType::CLIENT_TYPE_BROWSER,
+                            kSellerEgId),
+      [&notification](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals,
+                      GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        EXPECT_EQ(*(*signals)->scoring_signals,
+                  R"({"renderUrls":{"url1":1,"url2":1,"url3":1}})");
+        EXPECT_EQ(get_byte_size.request, 30);
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+  EXPECT_THAT(num_keys_per_request, testing::ElementsAre(2, 2, 1));
+}
+
+TEST(HttpScoringSignalsAsyncProviderTest, ReturnsPartialSignalsOnShardFailure) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput>>();
+  std::vector<int> num_keys_per_request;
+  RespondWithRenderUrlSignals(*mock_client, /*times=*/2, num_keys_per_request,
+                              /*failed_render_url=*/"url3");
+  BuyerBidsResponseMap buyer_bids_map =
+      MakeBuyerBidsMap({"url1", "url2", "url3"}, {});
+
+  HttpScoringSignalsAsyncProvider class_under_test(
+      std::move(mock_client), /*enable_protected_app_signals=*/false,
+      {.max_keys_per_request = 2});
+  absl::Notification notification;
+  class_under_test.Get(
+      ScoringSignalsRequest(buyer_bids_map, {}, ClientType::CLIENT_TYPE_BROWSER,
+                            kSellerEgId),
+      [&notification](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals,
+                      GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        EXPECT_EQ(*(*signals)->scoring_signals,
+                  R"({"renderUrls":{"url1":1,"url2":1}})");
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
+TEST(HttpScoringSignalsAsyncProviderTest, FailsIfAllShardsFail) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput>>();
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetSellerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetSellerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .Times(2)
+      .WillRepeatedly(
+          [](std::unique_ptr<GetSellerValuesInput> input,
+             const RequestMetadata& metadata,
+             absl::AnyInvocable<void(
+                 absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>)&&>
+                 callback,
+             absl::Duration timeout) {
+            std::move(callback)(absl::DeadlineExceededError("timeout"));
+            return absl::OkStatus();
+          });
+  BuyerBidsResponseMap buyer_bids_map = MakeBuyerBidsMap({"url1"}, {"comp1"});
+
+  HttpScoringSignalsAsyncProvider class_under_test(
+      std::move(mock_client), /*enable_protected_app_signals=*/false,
+      {.max_keys_per_request = 1});
+  absl::Notification notification;
+  class_under_test.Get(
+      ScoringSignalsRequest(buyer_bids_map, {}, ClientType::CLIENT_TYPE_BROWSER,
+                            kSellerEgId),
+      [&notification](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals,
+                      GetByteSize get_byte_size) {
+        EXPECT_EQ(signals.status().code(), absl::StatusCode::kDeadlineExceeded);
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/providers/kv_scoring_signals_async_provider.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+#include "services/common/util/log_throttle.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Minimum interval between the logs of each KV failure site. While the KV
+// server is unavailable, every request fails.
+constexpr int kKvFailureLogIntervalSec = 1;
+
+// Keys of a key group, without duplicates, in the order they were added.
+class KeyGroup {
+ public:
+  void Add(absl::string_view key) {
+    if (seen_.insert(key).second) {
+      keys_.push_back(key);
+    }
+  }
+
+  const std::vector<absl::string_view>& keys() const { return keys_; }
+
+ private:
+  absl::flat_hash_set<absl::string_view> seen_;
+  std::vector<absl::string_view> keys_;
+};
+
+}  // namespace
+
+KVScoringSignalsAsyncProvider::KVScoringSignalsAsyncProvider(
+    std::unique_ptr<KVAsyncClient> kv_async_client,
+    bool enable_protected_app_signals)
+    : kv_async_client_(std::move(kv_async_client)),
+      enable_protected_app_signals_(enable_protected_app_signals) {}
+
+void KVScoringSignalsAsyncProvider::Get(
+    const ScoringSignalsRequest& scoring_signals_request,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>,
+                            GetByteSize) &&>
+        on_done,
+    absl::Duration timeout) const {
+  KeyGroup render_urls;
+  KeyGroup ad_component_render_urls;
+  auto add_render_url = [&render_urls,
+                         &scoring_signals_request](absl::string_view url) {
+    if (!scoring_signals_request.cached_render_urls_.contains(url)) {
+      render_urls.Add(url);
+    }
+  };
+  for (const auto& [unused_buyer, get_bids_response] :
+       scoring_signals_request.buyer_bids_map_) {
+    for (const auto& ad : get_bids_response->bids()) {
+      add_render_url(ad.render());
+      for (const auto& ad_component : ad.ad_components()) {
+        if (!scoring_signals_request.cached_ad_component_render_urls_.contains(
+                ad_component)) {
+          ad_component_render_urls.Add(ad_component);
+        }
+      }
+    }
+    if (enable_protected_app_signals_) {
+      for (const auto& ad : get_bids_response->protected_app_signals_bids()) {
+        add_render_url(ad.render());
+      }
+    }
+  }
+
+  auto request = std::make_unique<GetValuesRequest>();
+  if (!scoring_signals_request.seller_kv_experiment_group_id_.empty()) {
+    (*request->mutable_metadata()->mutable_fields())[std::string(
+         kKVV2ExperimentGroupIdMetadata)]
+        .set_string_value(
+            scoring_signals_request.seller_kv_experiment_group_id_);
+  }
+  kv_server::v2::RequestPartition& partition = *request->add_partitions();
+  AddKVV2KeyGroup({kKVV2CustomTag, kKVV2RenderUrlsTag}, render_urls.keys(),
+                  partition);
+  if (!ad_component_render_urls.keys().empty()) {
+    AddKVV2KeyGroup({kKVV2CustomTag, kKVV2AdComponentRenderUrlsTag},
+                    ad_component_render_urls.keys(), partition);
+  }
+
+  const size_t request_size = request->ByteSizeLong();
+  auto status = kv_async_client_->ExecuteInternal(
+      std::move(request), scoring_signals_request.filtering_metadata_,
+      [request_size, on_done = std::move(on_done)](
+          absl::StatusOr<std::unique_ptr<GetValuesResponse>>
+              response) mutable {
+        GetByteSize get_byte_size = {.request = request_size, .response = 0};
+        if (!response.ok()) {
+          std::move(on_done)(response.status(), get_byte_size);
+          return;
+        }
+        get_byte_size.response = (*response)->ByteSizeLong();
+        absl::StatusOr<std::string> scoring_signals = ToKVV1Signals(
+            **response, {kKVV2RenderUrlsTag, kKVV2AdComponentRenderUrlsTag});
+        if (!scoring_signals.ok()) {
+          std::move(on_done)(scoring_signals.status(), get_byte_size);
+          return;
+        }
+        auto signals = std::make_unique<ScoringSignals>();
+        signals->scoring_signals =
+            std::make_unique<std::string>(*std::move(scoring_signals));
+        std::move(on_done)(std::move(signals), get_byte_size);
+      },
+      timeout);
+  if (!status.ok()) {
+    PS_LOG_EVERY_N_SEC(kKvFailureLogIntervalSec, ERROR)
+        << "Unable to get seller KV signals: " << status;
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
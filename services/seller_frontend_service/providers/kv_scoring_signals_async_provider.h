@@ -0,0 +1,55 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SFE_PROVIDERS_KV_SCORING_SIGNALS_ASYNC_PROVIDER_H_
+#define SERVICES_SFE_PROVIDERS_KV_SCORING_SIGNALS_ASYNC_PROVIDER_H_
+
+#include <memory>
+
+#include "services/common/clients/kv_server/kv_async_client.h"
+#include "services/seller_frontend_service/providers/scoring_signals_async_provider.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Fetches the scoring signals from a TEE KV server with the v2 GetValues API,
+// over gRPC with protobuf bodies, in a single request whatever the number of
+// render URLs. The signals are returned in the format of a v1 response.
+class KVScoringSignalsAsyncProvider final : public ScoringSignalsAsyncProvider {
+ public:
+  explicit KVScoringSignalsAsyncProvider(
+      std::unique_ptr<KVAsyncClient> kv_async_client,
+      bool enable_protected_app_signals = false);
+
+  // KVScoringSignalsAsyncProvider is neither copyable nor movable.
+  KVScoringSignalsAsyncProvider(const KVScoringSignalsAsyncProvider&) = delete;
+  KVScoringSignalsAsyncProvider& operator=(
+      const KVScoringSignalsAsyncProvider&) = delete;
+
+  void Get(const ScoringSignalsRequest& scoring_signals_request,
+           absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                       ScoringSignals>>,
+                                   GetByteSize) &&>
+               on_done,
+           absl::Duration timeout) const override;
+
+ private:
+  std::unique_ptr<KVAsyncClient> kv_async_client_;
+  const bool enable_protected_app_signals_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SFE_PROVIDERS_KV_SCORING_SIGNALS_ASYNC_PROVIDER_H_
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/providers/kv_scoring_signals_async_provider.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+#include "services/common/clients/kv_server/kv_v2_signals.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::An;
+
+BuyerBidsResponseMap GetBuyerBids() {
+  BuyerBidsResponseMap buyer_bids_map;
+  for (const char* buyer : {"buyer_1", "buyer_2"}) {
+    auto response = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+    auto* bid = response->add_bids();
+    bid->set_render("https://ad");
+    bid->add_ad_components(absl::StrCat("https://", buyer, "/component"));
+    buyer_bids_map.try_emplace(buyer, std::move(response));
+  }
+  return buyer_bids_map;
+}
+
+TEST(KVScoringSignalsAsyncProviderTest, SendsDistinctRenderUrls) {
+  auto mock_client = std::make_unique<KVAsyncClientMock>();
+  BuyerBidsResponseMap buyer_bids_map = GetBuyerBids();
+  absl::Notification notification;
+  EXPECT_CALL(
+      *mock_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GetValuesRequest>>(), An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        EXPECT_EQ(raw_request->metadata()
+                      .fields()
+                      .at(std::string(kKVV2ExperimentGroupIdMetadata))
+                      .string_value(),
+                  "1787");
+        EXPECT_EQ(raw_request->partitions_size(), 1);
+        const auto& arguments = raw_request->partitions(0).arguments();
+        EXPECT_EQ(arguments.size(), 2);
+        EXPECT_EQ(arguments[0].tags().values(1).string_value(),
+                  kKVV2RenderUrlsTag);
+        EXPECT_EQ(arguments[0].data().list_value().values_size(), 1);
+        EXPECT_EQ(arguments[1].tags().values(1).string_value(),
+                  kKVV2AdComponentRenderUrlsTag);
+        EXPECT_EQ(arguments[1].data().list_value().values_size(), 2);
+
+        auto response = std::make_unique<GetValuesResponse>();
+        response->mutable_single_partition()->set_string_output(
+            R"JSON({"keyGroupOutputs": [{"tags": ["custom", "renderUrls"],
+                "keyValues": {"https://ad": {"value": "1"}}}]})JSON");
+        std::move(on_done)(std::move(response));
+        return absl::OkStatus();
+      });
+
+  KVScoringSignalsAsyncProvider class_under_test(std::move(mock_client));
+  class_under_test.Get(
+      ScoringSignalsRequest(buyer_bids_map, {}, CLIENT_TYPE_BROWSER, "1787"),
+      [&notification](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals,
+                      GetByteSize get_byte_size) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        EXPECT_EQ(*(*signals)->scoring_signals,
+                  R"({"renderUrls":{"https://ad":"1"},)"
+                  R"("adComponentRenderUrls":{}})");
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
+TEST(KVScoringSignalsAsyncProviderTest, LeavesOutCachedRenderUrls) {
+  auto mock_client = std::make_unique<KVAsyncClientMock>();
+  BuyerBidsResponseMap buyer_bids_map = GetBuyerBids();
+  absl::Notification notification;
+  EXPECT_CALL(
+      *mock_client,
+      ExecuteInternal(
+          An<std::unique_ptr<GetValuesRequest>>(), An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<void(
+                  absl::StatusOr<std::unique_ptr<GetValuesResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetValuesRequest> raw_request,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(
+                       absl::StatusOr<std::unique_ptr<GetValuesResponse>>)&&>
+                       on_done,
+                   absl::Duration timeout) {
+        const auto& arguments = raw_request->partitions(0).arguments();
+        EXPECT_EQ(arguments.size(), 2);
+        EXPECT_EQ(arguments[0].data().list_value().values_size(), 0);
+        ASSERT_EQ(arguments[1].data().list_value().values_size(), 1);
+        EXPECT_EQ(arguments[1].data().list_value().values(0).string_value(),
+                  "https://buyer_2/component");
+        std::move(on_done)(std::make_unique<GetValuesResponse>());
+        return absl::OkStatus();
+      });
+
+  KVScoringSignalsAsyncProvider class_under_test(std::move(mock_client));
+  ScoringSignalsRequest request(buyer_bids_map, {}, CLIENT_TYPE_BROWSER);
+  request.cached_render_urls_ = {"https://ad"};
+  request.cached_ad_component_render_urls_ = {"https://buyer_1/component"};
+  class_under_test.Get(
+      request,
+      [&notification](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals,
+                      GetByteSize get_byte_size) { notification.Notify(); },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
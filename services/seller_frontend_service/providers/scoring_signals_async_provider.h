@@ -19,6 +19,8 @@
 #include <string>
 #include <utility>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
 #include "services/common/providers/async_provider.h"
 #include "services/seller_frontend_service/data/scoring_signals.h"
 
@@ -46,6 +48,11 @@ struct ScoringSignalsRequest {
   // [DSP] Optional ID for experiments conducted by buyer. By spec, valid values
   // are [0, 65535].
   std::string seller_kv_experiment_group_id_;
+
+  // Render URLs of the bids whose signals are already cached, left out of the
+  // lookup. The views point into the bids.
+  absl::flat_hash_set<absl::string_view> cached_render_urls_;
+  absl::flat_hash_set<absl::string_view> cached_ad_component_render_urls_;
 };
 
 // The classes implementing this interface provide the external signals
@@ -37,6 +37,10 @@ inline constexpr absl::string_view SELLER_ORIGIN_DOMAIN =
 inline constexpr absl::string_view AUCTION_SERVER_HOST = "AUCTION_SERVER_HOST";
 inline constexpr absl::string_view KEY_VALUE_SIGNALS_HOST =
     "KEY_VALUE_SIGNALS_HOST";
+inline constexpr absl::string_view SELLER_TEE_KV_SERVER_ADDR =
+    "SELLER_TEE_KV_SERVER_ADDR";
+inline constexpr absl::string_view SELLER_TEE_KV_SERVER_EGRESS_TLS =
+    "SELLER_TEE_KV_SERVER_EGRESS_TLS";
 inline constexpr absl::string_view BUYER_SERVER_HOSTS = "BUYER_SERVER_HOSTS";
 inline constexpr absl::string_view ENABLE_BUYER_COMPRESSION =
     "ENABLE_BUYER_COMPRESSION";
@@ -61,7 +65,71 @@ inline constexpr absl::string_view
 inline constexpr absl::string_view SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES =
     "SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES";
 
-inline constexpr int kNumRuntimeFlags = 22;
+inline constexpr absl::string_view ENABLE_PIPELINED_SCORING_SIGNALS_FETCH =
+    "ENABLE_PIPELINED_SCORING_SIGNALS_FETCH";
+inline constexpr absl::string_view GET_BID_HEDGE_DELAY_MS =
+    "GET_BID_HEDGE_DELAY_MS";
+inline constexpr absl::string_view GET_BID_DEADLINE_RESERVE_MS =
+    "GET_BID_DEADLINE_RESERVE_MS";
+inline constexpr absl::string_view ENABLE_GET_BIDS_BATCHING =
+    "ENABLE_GET_BIDS_BATCHING";
+inline constexpr absl::string_view SELLER_KV_MIN_WARM_CONNECTIONS =
+    "SELLER_KV_MIN_WARM_CONNECTIONS";
+inline constexpr absl::string_view SELLER_KV_REWARM_INTERVAL_MS =
+    "SELLER_KV_REWARM_INTERVAL_MS";
+inline constexpr absl::string_view SELLER_KV_HEDGE_PERCENTILE =
+    "SELLER_KV_HEDGE_PERCENTILE";
+inline constexpr absl::string_view AUCTION_GRPC_NUM_CHANNELS =
+    "AUCTION_GRPC_NUM_CHANNELS";
+inline constexpr absl::string_view AUCTION_SERVER_ZONAL_HOSTS =
+    "AUCTION_SERVER_ZONAL_HOSTS";
+inline constexpr absl::string_view AUCTION_ZONE_SPILLOVER_RPCS =
+    "AUCTION_ZONE_SPILLOVER_RPCS";
+inline constexpr absl::string_view AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS =
+    "AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS";
+inline constexpr absl::string_view BUYER_GRPC_NUM_CHANNELS =
+    "BUYER_GRPC_NUM_CHANNELS";
+inline constexpr absl::string_view SFE_GRPC_KEEPALIVE_MS =
+    "SFE_GRPC_KEEPALIVE_MS";
+inline constexpr absl::string_view SFE_GRPC_STREAM_WINDOW_BYTES =
+    "SFE_GRPC_STREAM_WINDOW_BYTES";
+inline constexpr absl::string_view SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES =
+    "SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES";
+inline constexpr absl::string_view DEBUG_REPORTING_MAX_QUEUED_PINGS =
+    "DEBUG_REPORTING_MAX_QUEUED_PINGS";
+inline constexpr absl::string_view DEBUG_REPORTING_MAX_PINGS_PER_HOST =
+    "DEBUG_REPORTING_MAX_PINGS_PER_HOST";
+inline constexpr absl::string_view DEBUG_REPORTING_SAMPLING_PERCENT =
+    "DEBUG_REPORTING_SAMPLING_PERCENT";
+inline constexpr absl::string_view DEBUG_REPORTING_MAX_CONNECTIONS =
+    "DEBUG_REPORTING_MAX_CONNECTIONS";
+inline constexpr absl::string_view DEBUG_REPORTING_KV_PENDING_THRESHOLD =
+    "DEBUG_REPORTING_KV_PENDING_THRESHOLD";
+inline constexpr absl::string_view SELLER_KV_MAX_KEYS_PER_REQUEST =
+    "SELLER_KV_MAX_KEYS_PER_REQUEST";
+inline constexpr absl::string_view SELLER_KV_POST_KEYS = "SELLER_KV_POST_KEYS";
+
+inline constexpr absl::string_view MAX_BIDS_PER_BUYER = "MAX_BIDS_PER_BUYER";
+inline constexpr absl::string_view MAX_BIDS_PER_AUCTION =
+    "MAX_BIDS_PER_AUCTION";
+inline constexpr absl::string_view SCORING_SIGNALS_CACHE_TTL_MS =
+    "SCORING_SIGNALS_CACHE_TTL_MS";
+inline constexpr absl::string_view BUYER_INPUT_COMPRESSION_DICTIONARY =
+    "BUYER_INPUT_COMPRESSION_DICTIONARY";
+inline constexpr absl::string_view SFE_BACKEND_PRECONNECT_TIMEOUT_MS =
+    "SFE_BACKEND_PRECONNECT_TIMEOUT_MS";
+inline constexpr absl::string_view SFE_BACKEND_READY_PERCENT =
+    "SFE_BACKEND_READY_PERCENT";
+inline constexpr absl::string_view SFE_REQUEST_CAPTURE_PATH =
+    "SFE_REQUEST_CAPTURE_PATH";
+inline constexpr absl::string_view SFE_HTTP_INGRESS_PORT =
+    "SFE_HTTP_INGRESS_PORT";
+inline constexpr absl::string_view SFE_HTTP_INGRESS_THREADS =
+    "SFE_HTTP_INGRESS_THREADS";
+inline constexpr absl::string_view GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK =
+    "GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK";
+
+inline constexpr int kNumRuntimeFlags = 56;
 inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     PORT,
     HEALTHCHECK_PORT,
@@ -71,6 +139,8 @@ inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     SELLER_ORIGIN_DOMAIN,
     AUCTION_SERVER_HOST,
     KEY_VALUE_SIGNALS_HOST,
+    SELLER_TEE_KV_SERVER_ADDR,
+    SELLER_TEE_KV_SERVER_EGRESS_TLS,
     BUYER_SERVER_HOSTS,
     ENABLE_BUYER_COMPRESSION,
     ENABLE_AUCTION_COMPRESSION,
@@ -85,6 +155,38 @@ inline constexpr std::array<absl::string_view, kNumRuntimeFlags> kFlags = {
     SELLER_CLOUD_PLATFORMS_MAP,
     SFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND,
     SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES,
+    ENABLE_PIPELINED_SCORING_SIGNALS_FETCH,
+    GET_BID_HEDGE_DELAY_MS,
+    GET_BID_DEADLINE_RESERVE_MS,
+    ENABLE_GET_BIDS_BATCHING,
+    SELLER_KV_MIN_WARM_CONNECTIONS,
+    SELLER_KV_REWARM_INTERVAL_MS,
+    SELLER_KV_HEDGE_PERCENTILE,
+    AUCTION_GRPC_NUM_CHANNELS,
+    AUCTION_SERVER_ZONAL_HOSTS,
+    AUCTION_ZONE_SPILLOVER_RPCS,
+    AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS,
+    BUYER_GRPC_NUM_CHANNELS,
+    SFE_GRPC_KEEPALIVE_MS,
+    SFE_GRPC_STREAM_WINDOW_BYTES,
+    SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES,
+    DEBUG_REPORTING_MAX_QUEUED_PINGS,
+    DEBUG_REPORTING_MAX_PINGS_PER_HOST,
+    DEBUG_REPORTING_SAMPLING_PERCENT,
+    DEBUG_REPORTING_MAX_CONNECTIONS,
+    DEBUG_REPORTING_KV_PENDING_THRESHOLD,
+    SELLER_KV_MAX_KEYS_PER_REQUEST,
+    SELLER_KV_POST_KEYS,
+    MAX_BIDS_PER_BUYER,
+    MAX_BIDS_PER_AUCTION,
+    SCORING_SIGNALS_CACHE_TTL_MS,
+    BUYER_INPUT_COMPRESSION_DICTIONARY,
+    SFE_BACKEND_PRECONNECT_TIMEOUT_MS,
+    SFE_BACKEND_READY_PERCENT,
+    SFE_REQUEST_CAPTURE_PATH,
+    SFE_HTTP_INGRESS_PORT,
+    SFE_HTTP_INGRESS_THREADS,
+    GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
@@ -15,10 +15,14 @@
 #include "services/seller_frontend_service/select_ad_reactor.h"
 
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
@@ -29,14 +33,25 @@
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "quiche/oblivious_http/oblivious_http_gateway.h"
+#include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/reporters/async_reporter.h"
 #include "services/common/util/auction_scope_util.h"
+#include "services/common/util/bid_budget.h"
+#include "services/common/util/parallel_for.h"
 #include "services/common/util/reporting_util.h"
+#include "services/common/util/request_capture.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/seller_frontend_service/util/framing_utils.h"
 #include "services/seller_frontend_service/util/key_fetcher_utils.h"
+#include "services/seller_frontend_service/util/proto_mapping_util.h"
+#include "services/seller_frontend_service/util/scoring_signals_cache.h"
+#include "services/seller_frontend_service/util/scoring_signals_util.h"
+#include "services/seller_frontend_service/util/select_ad_capture.h"
+#include "services/seller_frontend_service/util/seller_frontend_config.h"
 #include "services/seller_frontend_service/util/web_utils.h"
 #include "src/communication/ohttp_utils.h"
+#include "src/concurrent/executor.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
 #include "src/telemetry/telemetry.h"
 
@@ -63,50 +78,59 @@ SelectAdReactor::SelectAdReactor(
       response_(response),
       clients_(clients),
       config_client_(config_client),
+      config_(GetSellerFrontEndConfig(clients, config_client)),
       auction_scope_(GetAuctionScope(*request_)),
       // TODO(b/278039901): Add integration test for metadata forwarding.
       buyer_metadata_(GrpcMetadataToRequestMetadata(context->client_metadata(),
                                                     kBuyerMetadataKeysMap)),
       log_context_({}, server_common::ConsentedDebugConfiguration(),
                    [this]() { return response_->mutable_debug_info(); }),
+      debug_log_(log_context_),
       error_accumulator_(&log_context_),
       fail_fast_(fail_fast),
       is_protected_auction_request_(false),
       // PAS should only be enabled for single seller auctions.
       is_pas_enabled_(
-          config_client_.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS) &&
+          config_->enable_protected_app_signals &&
           (auction_scope_ == AuctionScope::AUCTION_SCOPE_SINGLE_SELLER)),
-      is_protected_audience_enabled_(
-          config_client_.GetBooleanParameter(ENABLE_PROTECTED_AUDIENCE)),
+      is_protected_audience_enabled_(config_->enable_protected_audience),
       max_buyers_solicited_(max_buyers_solicited),
+      get_bid_hedge_delay_(config_->get_bid_hedge_delay),
+      get_bid_deadline_reserve_(config_->get_bid_deadline_reserve),
+      enable_pipelined_scoring_signals_fetch_(
+          config_->enable_pipelined_scoring_signals_fetch),
+      max_bids_per_buyer_(config_->max_bids_per_buyer),
+      max_bids_per_auction_(config_->max_bids_per_auction),
+      // Tracks the buyers once the size of the buyer list is validated.
       async_task_tracker_(
-          request->auction_config().buyer_list_size(), log_context_,
-          [this](bool successful) { OnAllBidsDone(successful); }) {
-  if (config_client_.GetBooleanParameter(ENABLE_SELLER_FRONTEND_BENCHMARKING)) {
+          /*num_tasks_to_track=*/0, log_context_,
+          [this](bool successful) {
+            phase_tracer_.End(RequestPhase::kFanOut);
+            OnAllBidsDone(successful);
+          }) {
+  if (config_->enable_seller_frontend_benchmarking) {
     benchmarking_logger_ =
         std::make_unique<BuildInputProcessResponseBenchmarkingLogger>(
             FormatTime(absl::Now()));
   } else {
     benchmarking_logger_ = std::make_unique<NoOpsLogger>();
   }
-  CHECK_OK([this]() {
-    PS_ASSIGN_OR_RETURN(metric_context_,
-                        metric::SfeContextMap()->Remove(request_));
-    return absl::OkStatus();
-  }()) << "SfeContextMap()->Get(request) should have been called";
+  metric_context_ = metric::CreateMetricContext<SelectAdRequest>();
+  LogCommonMetric(request_, response_, *metric_context_);
 }
 
 AdWithBidMetadata SelectAdReactor::BuildAdWithBidMetadata(
-    const AdWithBid& input, absl::string_view interest_group_owner) {
+    AdWithBid& input, absl::string_view interest_group_owner) {
   AdWithBidMetadata result;
-  // First copy all the fields that can be copied directly.
+  // First move the ad payloads, which are not used after scoring.
   if (input.has_ad()) {
-    *result.mutable_ad() = input.ad();
+    result.mutable_ad()->Swap(input.mutable_ad());
   }
+  result.set_render(std::move(*input.mutable_render()));
+  result.mutable_ad_components()->Swap(input.mutable_ad_components());
+  // Then copy all the fields that can be copied directly.
   result.set_bid(input.bid());
-  result.set_render(input.render());
   result.set_allow_component_auction(input.allow_component_auction());
-  result.mutable_ad_components()->CopyFrom(input.ad_components());
   result.set_interest_group_name(input.interest_group_name());
   result.set_ad_cost(input.ad_cost());
   result.set_modeling_signals(input.modeling_signals());
@@ -116,10 +140,13 @@ AdWithBidMetadata SelectAdReactor::BuildAdWithBidMetadata(
   result.set_interest_group_owner(interest_group_owner);
 
   // Finally, find the AdWithBid's IG and copy the last fields from there.
-  const BuyerInput& buyer_input =
-      buyer_inputs_->find(interest_group_owner)->second;
-  for (const auto& interest_group : buyer_input.interest_groups()) {
-    if (interest_group.name() == result.interest_group_name()) {
+  if (auto indexes_it = interest_group_indexes_.find(interest_group_owner);
+      indexes_it != interest_group_indexes_.end()) {
+    if (auto it = indexes_it->second.find(result.interest_group_name());
+        it != indexes_it->second.end()) {
+      const BuyerInput& buyer_input =
+          buyer_inputs_->find(interest_group_owner)->second;
+      const auto& interest_group = buyer_input.interest_groups(it->second);
       result.set_interest_group_origin(interest_group.origin());
       if (request_->client_type() == CLIENT_TYPE_BROWSER) {
         result.set_join_count(interest_group.browser_signals().join_count());
@@ -136,8 +163,6 @@ AdWithBidMetadata SelectAdReactor::BuildAdWithBidMetadata(
               interest_group.browser_signals().recency() / kSecsInMinute));
         }
       }
-      // May as well skip further iterations.
-      break;
     }
   }
   if (!input.buyer_reporting_id().empty()) {
@@ -185,8 +210,10 @@ grpc::Status SelectAdReactor::DecryptRequest() {
              << (is_protected_auction_request_ ? "auction" : "audience")
              << " ciphertext: " << absl::Base64Escape(encapsulated_req);
 
+  phase_tracer_.Start(RequestPhase::kDecrypt);
   auto decrypted_hpke_req = DecryptOHTTPEncapsulatedHpkeCiphertext(
       encapsulated_req, clients_.key_fetcher_manager_);
+  phase_tracer_.End(RequestPhase::kDecrypt);
   if (!decrypted_hpke_req.ok()) {
     PS_VLOG(kNoisyWarn) << "Error decrypting the protected "
                         << (is_protected_auction_request_ ? "auction"
@@ -202,6 +229,16 @@ grpc::Status SelectAdReactor::DecryptRequest() {
              << " input ciphertext";
 
   decrypted_request_ = std::move(*decrypted_hpke_req);
+  absl::StatusOr<const CompressionCodec*> buyer_input_codec =
+      GetBuyerInputCodec(decrypted_request_->plaintext);
+  if (!buyer_input_codec.ok()) {
+    PS_VLOG(kNoisyWarn) << "Unsupported buyer input compression: "
+                        << buyer_input_codec.status();
+    return {grpc::StatusCode::INVALID_ARGUMENT,
+            std::string(buyer_input_codec.status().message())};
+  }
+  buyer_input_codec_ = *buyer_input_codec;
+  ScopedRequestPhase decode_phase(phase_tracer_, RequestPhase::kDecode);
   if (is_protected_auction_request_) {
     protected_auction_input_ =
         GetDecodedProtectedAuctionInput(decrypted_request_->plaintext);
@@ -221,72 +258,51 @@ grpc::Status SelectAdReactor::DecryptRequest() {
 }
 
 void SelectAdReactor::MayPopulateAdServerVisibleErrors() {
-  if (request_->auction_config().seller_signals().empty()) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kEmptySellerSignals,
-                ErrorCode::CLIENT_SIDE);
-  }
-
-  if (request_->auction_config().auction_signals().empty()) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kEmptyAuctionSignals,
-                ErrorCode::CLIENT_SIDE);
-  }
-
-  if (request_->auction_config().buyer_list().empty()) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kEmptyBuyerList,
-                ErrorCode::CLIENT_SIDE);
-  }
-
-  if (request_->auction_config().seller().empty()) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kEmptySeller,
-                ErrorCode::CLIENT_SIDE);
-  }
-
-  if (!request_->auction_config().seller_currency().empty()) {
-    if (!std::regex_match(request_->auction_config().seller_currency(),
-                          kValidCurrencyCodeRegex)) {
-      ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kInvalidSellerCurrency,
-                  ErrorCode::CLIENT_SIDE);
-    }
-  }
-
-  if (config_client_.GetStringParameter(SELLER_ORIGIN_DOMAIN) !=
-      request_->auction_config().seller()) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kWrongSellerDomain,
-                ErrorCode::CLIENT_SIDE);
-  }
+  RequestValidator validator(error_accumulator_,
+                             ErrorVisibility::AD_SERVER_VISIBLE);
+  const SelectAdRequest::AuctionConfig& auction_config =
+      request_->auction_config();
+  validator.Check(!auction_config.seller_signals().empty(),
+                  kEmptySellerSignals);
+  validator.Check(!auction_config.auction_signals().empty(),
+                  kEmptyAuctionSignals);
+  validator.Check(!auction_config.buyer_list().empty(), kEmptyBuyerList);
+  validator.Check(
+      auction_config.buyer_list_size() <= AsyncTaskTracker::kMaxTasksToTrack,
+      [&auction_config]() {
+        return absl::StrFormat(kTooManyBuyers, auction_config.buyer_list_size(),
+                               AsyncTaskTracker::kMaxTasksToTrack);
+      });
+  validator.Check(!auction_config.seller().empty(), kEmptySeller);
+  validator.Check(auction_config.seller_currency().empty() ||
+                      IsValidCurrencyCode(auction_config.seller_currency()),
+                  kInvalidSellerCurrency);
+  validator.Check(config_->seller_origin_domain == auction_config.seller(),
+                  kWrongSellerDomain);
 
   for (const auto& [buyer, per_buyer_config] :
-       request_->auction_config().per_buyer_config()) {
-    if (buyer.empty()) {
-      ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
-                  kEmptyBuyerInPerBuyerConfig, ErrorCode::CLIENT_SIDE);
-    }
-    if (per_buyer_config.buyer_signals().empty()) {
-      ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
-                  absl::StrFormat(kEmptyBuyerSignals, buyer),
-                  ErrorCode::CLIENT_SIDE);
-    }
-    if (!per_buyer_config.buyer_currency().empty()) {
-      if (!std::regex_match(per_buyer_config.buyer_currency(),
-                            kValidCurrencyCodeRegex)) {
-        ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kInvalidBuyerCurrency,
-                    ErrorCode::CLIENT_SIDE);
-      }
-    }
+       auction_config.per_buyer_config()) {
+    validator.Check(!buyer.empty(), kEmptyBuyerInPerBuyerConfig);
+    validator.Check(!per_buyer_config.buyer_signals().empty(),
+                    [&buyer = buyer]() {
+                      return absl::StrFormat(kEmptyBuyerSignals, buyer);
+                    });
+    validator.Check(per_buyer_config.buyer_currency().empty() ||
+                        IsValidCurrencyCode(per_buyer_config.buyer_currency()),
+                    kInvalidBuyerCurrency);
+    validator.Check(per_buyer_config.bid_floor() >= 0, kNegativeBidFloor);
   }
+  validator.Check(auction_config.bid_floor() >= 0, kNegativeBidFloor);
 
-  if (request_->client_type() == CLIENT_TYPE_UNKNOWN) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE, kUnknownClientType,
-                ErrorCode::CLIENT_SIDE);
-  }
+  validator.Check(request_->client_type() != CLIENT_TYPE_UNKNOWN,
+                  kUnknownClientType);
 
   // Device Component Auction not allowed with Android client type.
-  if (request_->client_type() == CLIENT_TYPE_ANDROID &&
-      auction_scope_ ==
-          AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER) {
-    ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
-                kDeviceComponentAuctionWithAndroid, ErrorCode::CLIENT_SIDE);
-  }
+  validator.Check(
+      request_->client_type() != CLIENT_TYPE_ANDROID ||
+          auction_scope_ !=
+              AuctionScope::AUCTION_SCOPE_DEVICE_COMPONENT_MULTI_SELLER,
+      kDeviceComponentAuctionWithAndroid);
 }
 
 void SelectAdReactor::MayLogBuyerInput() {
@@ -305,8 +321,30 @@ void SelectAdReactor::MayLogBuyerInput() {
   }
 }
 
+void SelectAdReactor::MayCaptureRequest() {
+  if (!log_context_.is_consented() || !RequestCapture::Get().enabled() ||
+      !buyer_inputs_.ok()) {
+    return;
+  }
+  absl::StatusOr<std::string> capture_json = std::visit(
+      [this](const auto& protected_input) {
+        auto input = protected_input;
+        input.clear_buyer_input();
+        return GetSelectAdCaptureJson(request_->auction_config(), input,
+                                      *buyer_inputs_, request_->client_type());
+      },
+      protected_auction_input_);
+  if (!capture_json.ok()) {
+    PS_LOG(ERROR, log_context_)
+        << "Failed to capture the request: " << capture_json.status();
+    return;
+  }
+  RequestCapture::Get().Capture(kSelectAdCaptureKind, *capture_json);
+}
+
 void SelectAdReactor::Execute() {
   grpc::Status decrypt_status = DecryptRequest();
+  critical_path_.EndDecode(request_timer_.Elapsed());
 
   // Populates the logging context needed for request tracing. should be called
   // after decrypting and decoding the request.
@@ -324,15 +362,25 @@ void SelectAdReactor::Execute() {
             return protected_input.consented_debug_config();
           },
           protected_auction_input_));
+  debug_log_.set_emit_inline(std::visit(
+      [](const auto& protected_input) {
+        return protected_input.consented_debug_config()
+            .is_debug_info_in_response();
+      },
+      protected_auction_input_));
 
+  const std::string generation_id = std::visit(
+      [](const auto& protected_input) -> std::string {
+        return {protected_input.generation_id()};
+      },
+      protected_auction_input_);
   if (log_context_.is_consented()) {
-    std::string generation_id = std::visit(
-        [](const auto& protected_input) -> std::string {
-          return {protected_input.generation_id()};
-        },
-        protected_auction_input_);
     metric_context_->SetConsented(generation_id);
   }
+  trace_.Start("SelectAd", generation_id,
+               RequestTrace::GetTraceParent(context_->client_metadata()),
+               /*setup_span_name=*/"decrypt_and_decode");
+  phase_tracer_.set_listener(&trace_);
 
   if (is_protected_auction_request_) {
     LogIfError(metric_context_->LogHistogram<metric::kProtectedCiphertextSize>(
@@ -344,8 +392,7 @@ void SelectAdReactor::Execute() {
   LogIfError(metric_context_->LogHistogram<metric::kAuctionConfigSize>(
       (int)request_->auction_config().ByteSizeLong()));
 
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted SelectAdRequest:\n"
-                                    << request_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted SelectAdRequest:\n", *request_);
   PS_VLOG(kPlain, log_context_)
       << "Headers:\n"
       << absl::StrJoin(context_->client_metadata(), "\n",
@@ -359,11 +406,11 @@ void SelectAdReactor::Execute() {
   }
   std::visit(
       [this](const auto& input) {
-        PS_VLOG(kPlain, log_context_)
-            << (is_protected_auction_request_ ? "ProtectedAuctionInput"
-                                              : "ProtectedAudienceInput")
-            << ":\n"
-            << input.ShortDebugString();
+        debug_log_.AddMessage(kPlain,
+                              is_protected_auction_request_
+                                  ? "ProtectedAuctionInput:\n"
+                                  : "ProtectedAudienceInput:\n",
+                              input);
       },
       protected_auction_input_);
   MayLogBuyerInput();
@@ -405,6 +452,7 @@ void SelectAdReactor::Execute() {
     return;
   }
   PS_VLOG(kNoisyInfo, log_context_) << "No client / Adtech server errors found";
+  MayCaptureRequest();
 
   benchmarking_logger_->Begin();
 
@@ -416,6 +464,16 @@ void SelectAdReactor::Execute() {
       request_->auction_config().buyer_list().begin(),
       request_->auction_config().buyer_list().end());
 
+  async_task_tracker_.SetNumTasksToTrack(
+      request_->auction_config().buyer_list_size());
+  // Ended by async_task_tracker_ once all the buyers are done.
+  phase_tracer_.Start(RequestPhase::kFanOut);
+  // The reactor may be gone as soon as the batched calls are sent, when the
+  // scope ends.
+  std::optional<GetBidsBatchScope> batch_scope;
+  if (config_->enable_get_bids_batching) {
+    batch_scope.emplace();
+  }
   for (const auto& buyer_ig_owner : request_->auction_config().buyer_list()) {
     if (buyer_set.erase(buyer_ig_owner) == 0) {
       PS_VLOG(kNoisyWarn, log_context_)
@@ -433,13 +491,13 @@ void SelectAdReactor::Execute() {
       continue;
     }
 
-    const auto& buyer_input_iterator = buyer_inputs_->find(buyer_ig_owner);
+    auto buyer_input_iterator = buyer_inputs_->find(buyer_ig_owner);
     if (buyer_input_iterator == buyer_inputs_->end()) {
       PS_VLOG(kNoisyWarn, log_context_)
           << "No buyer input found for buyer: " << buyer_ig_owner
           << ", skipping buyer";
 
-      // Pending bids count is set on reactor construction to
+      // Pending bids count is set before the fan-out to
       // buyer_list_size(). If no BuyerInput is found for a buyer in
       // buyer_list, must decrement pending bids count.
       async_task_tracker_.TaskCompleted(TaskStatus::SKIPPED);
@@ -455,7 +513,7 @@ void SelectAdReactor::Execute() {
 
 std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
 SelectAdReactor::CreateGetBidsRequest(const std::string& buyer_ig_owner,
-                                      const BuyerInput& buyer_input) {
+                                      BuyerInput& buyer_input) {
   auto get_bids_request = std::make_unique<GetBidsRequest::GetBidsRawRequest>();
   get_bids_request->set_is_chaff(false);
   get_bids_request->set_seller(request_->auction_config().seller());
@@ -477,7 +535,11 @@ SelectAdReactor::CreateGetBidsRequest(const std::string& buyer_ig_owner,
           per_buyer_config_itr->second.buyer_signals());
     }
   }
-  *get_bids_request->mutable_buyer_input() = buyer_input;
+  MoveBuyerInputRetainingIgMetadata(buyer_input,
+                                    *get_bids_request->mutable_buyer_input());
+  // Indexes the retained interest groups, which outlive the bids.
+  interest_group_indexes_[buyer_ig_owner] =
+      IndexInterestGroupsByName(buyer_input);
   get_bids_request->set_top_level_seller(
       request_->auction_config().top_level_seller());
   std::visit(
@@ -509,8 +571,26 @@ SelectAdReactor::CreateGetBidsRequest(const std::string& buyer_ig_owner,
   return get_bids_request;
 }
 
+struct SelectAdReactor::GetBidsCallState {
+  absl::Mutex mu;
+  // Set once a call was handed to OnFetchBidsDone.
+  bool done ABSL_GUARDED_BY(mu) = false;
+  // Whether the timeout of the calls was shortened to meet the deadline of the
+  // request.
+  bool cut_short_for_deadline = false;
+  // Measures the duration of the calls to the buyer. Destroyed by the call
+  // that is handed to OnFetchBidsDone, while the reactor is still alive.
+  std::unique_ptr<metric::InitiatedRequest<metric::SfeContext>> bfe_request
+      ABSL_GUARDED_BY(mu);
+  // Pending task that sends the hedged request.
+  std::optional<server_common::TaskId> hedge_task_id ABSL_GUARDED_BY(mu);
+  // Span of the calls to the buyer if the request is traced. Ended by the call
+  // that is handed to OnFetchBidsDone.
+  RequestSpan span;
+};
+
 void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
-                               const BuyerInput& buyer_input) {
+                               BuyerInput& buyer_input) {
   auto buyer_client = clients_.buyer_factory.Get(buyer_ig_owner);
   if (buyer_client == nullptr) {
     PS_VLOG(kNoisyWarn, log_context_)
@@ -519,35 +599,80 @@ void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
     async_task_tracker_.TaskCompleted(TaskStatus::SKIPPED);
   } else {
     PS_VLOG(6, log_context_) << "Getting bid from a BFE";
-    absl::Duration timeout = absl::Milliseconds(
-        config_client_.GetIntParameter(GET_BID_RPC_TIMEOUT_MS));
+    absl::Duration timeout = config_->get_bid_rpc_timeout;
     if (request_->auction_config().buyer_timeout_ms() > 0) {
       timeout =
           absl::Milliseconds(request_->auction_config().buyer_timeout_ms());
     }
+    auto call_state = std::make_shared<GetBidsCallState>();
+    if (std::optional<absl::Duration> budget = RemainingGetBidsBudget();
+        budget.has_value() && *budget < timeout) {
+      LogIfError(metric_context_->AccumulateMetric<
+                 metric::kSfeInitiatedRequestCancelledCountByBuyer>(
+          1, buyer_ig_owner));
+      if (*budget <= absl::ZeroDuration()) {
+        PS_VLOG(kNoisyWarn, log_context_)
+            << "Skipping buyer " << buyer_ig_owner
+            << " since no time is left before the request deadline.";
+        async_task_tracker_.TaskCompleted(TaskStatus::ERROR);
+        return;
+      }
+      timeout = *budget;
+      call_state->cut_short_for_deadline = true;
+    }
     auto get_bids_request = CreateGetBidsRequest(buyer_ig_owner, buyer_input);
-    auto bfe_request =
-        metric::MakeInitiatedRequest(metric::kBfe, metric_context_.get());
-    bfe_request->SetBuyer(buyer_ig_owner);
-    bfe_request->SetRequestSize((int)get_bids_request->ByteSizeLong());
+    std::unique_ptr<GetBidsRequest::GetBidsRawRequest> hedged_get_bids_request;
+    if (clients_.executor != nullptr &&
+        get_bid_hedge_delay_ > absl::ZeroDuration() &&
+        get_bid_hedge_delay_ < timeout) {
+      hedged_get_bids_request =
+          std::make_unique<GetBidsRequest::GetBidsRawRequest>(
+              *get_bids_request);
+    }
+    {
+      absl::MutexLock lock(&call_state->mu);
+      call_state->bfe_request =
+          metric::MakeInitiatedRequest(metric::kBfe, metric_context_.get());
+      call_state->bfe_request->SetBuyer(buyer_ig_owner);
+      call_state->bfe_request->SetRequestSize(
+          (int)get_bids_request->ByteSizeLong());
+    }
+    // The buyer continues the trace of the request under the span of its
+    // calls.
+    const RequestMetadata* buyer_metadata = &buyer_metadata_;
+    RequestMetadata traced_buyer_metadata;
+    if (trace_.enabled()) {
+      call_state->span = trace_.StartSpan("get_bids");
+      call_state->span.SetAttribute("buyer", buyer_ig_owner);
+      traced_buyer_metadata = buyer_metadata_;
+      call_state->span.Inject(traced_buyer_metadata);
+      buyer_metadata = &traced_buyer_metadata;
+    }
+    // The hedge is scheduled first since the reactor may be gone as soon as
+    // the request to the last buyer is sent.
+    if (hedged_get_bids_request != nullptr) {
+      ScheduleHedgedGetBids(buyer_ig_owner, buyer_client,
+                            std::move(hedged_get_bids_request),
+                            *buyer_metadata, call_state, timeout);
+    }
     absl::Status execute_result = buyer_client->ExecuteInternal(
-        std::move(get_bids_request), buyer_metadata_,
-        [buyer_ig_owner, this, bfe_request = std::move(bfe_request)](
-            absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
-                response) mutable {
-          {
-            int response_size =
-                response.ok() ? (int)response->get()->ByteSizeLong() : 0;
-            bfe_request->SetResponseSize(response_size);
-
-            // destruct bfe_request, destructor measures request time
-            auto not_used = std::move(bfe_request);
-          }
-          PS_VLOG(6, log_context_) << "Received a response from a BFE";
-          OnFetchBidsDone(std::move(response), buyer_ig_owner);
-        },
-        timeout);
+        std::move(get_bids_request), *buyer_metadata,
+        MakeGetBidsCallback(buyer_ig_owner, call_state), timeout,
+        cancellation_);
     if (!execute_result.ok()) {
+      std::unique_ptr<metric::InitiatedRequest<metric::SfeContext>>
+          bfe_request;
+      std::optional<server_common::TaskId> hedge_task_id;
+      {
+        absl::MutexLock lock(&call_state->mu);
+        call_state->done = true;
+        bfe_request = std::move(call_state->bfe_request);
+        hedge_task_id = call_state->hedge_task_id;
+      }
+      if (hedge_task_id.has_value()) {
+        clients_.executor->Cancel(*hedge_task_id);
+      }
+      call_state->span.End(server_common::FromAbslStatus(execute_result));
       LogIfError(
           metric_context_->AccumulateMetric<metric::kSfeErrorCountByErrorCode>(
               1, metric::kSfeGetBidsFailedToCall));
@@ -562,6 +687,104 @@ void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
   }
 }
 
+absl::AnyInvocable<
+    void(absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>)
+        &&>
+SelectAdReactor::MakeGetBidsCallback(
+    const std::string& buyer_ig_owner,
+    std::shared_ptr<GetBidsCallState> call_state) {
+  return [buyer_ig_owner, this, call_state = std::move(call_state)](
+             absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
+                 response) mutable {
+    std::unique_ptr<metric::InitiatedRequest<metric::SfeContext>> bfe_request;
+    std::optional<server_common::TaskId> hedge_task_id;
+    {
+      absl::MutexLock lock(&call_state->mu);
+      // The reactor may already be gone if another call was handed over.
+      if (call_state->done) {
+        return;
+      }
+      call_state->done = true;
+      bfe_request = std::move(call_state->bfe_request);
+      hedge_task_id = call_state->hedge_task_id;
+    }
+    if (hedge_task_id.has_value()) {
+      clients_.executor->Cancel(*hedge_task_id);
+    }
+    call_state->span.End(
+        response.ok() ? grpc::Status::OK
+                      : server_common::FromAbslStatus(response.status()));
+    {
+      int response_size =
+          response.ok() ? (int)response->get()->ByteSizeLong() : 0;
+      bfe_request->SetResponseSize(response_size);
+
+      // destruct bfe_request, destructor measures request time
+      auto not_used = std::move(bfe_request);
+    }
+    if (call_state->cut_short_for_deadline && !response.ok() &&
+        response.status().code() == absl::StatusCode::kDeadlineExceeded) {
+      PS_VLOG(kNoisyWarn, log_context_)
+          << "GetBids call to buyer " << buyer_ig_owner
+          << " was cancelled to meet the request deadline.";
+    }
+    PS_VLOG(6, log_context_) << "Received a response from a BFE";
+    OnFetchBidsDone(std::move(response), buyer_ig_owner);
+  };
+}
+
+void SelectAdReactor::ScheduleHedgedGetBids(
+    const std::string& buyer_ig_owner,
+    std::shared_ptr<const BuyerFrontEndAsyncClient> buyer_client,
+    std::unique_ptr<GetBidsRequest::GetBidsRawRequest> get_bids_request,
+    const RequestMetadata& buyer_metadata,
+    std::shared_ptr<GetBidsCallState> call_state, absl::Duration timeout) {
+  // The task only accesses the reactor while no call was handed over, since
+  // the reactor can't finish before that. The metadata is copied so that the
+  // request can be sent without holding the lock.
+  server_common::TaskId hedge_task_id = clients_.executor->RunAfter(
+      get_bid_hedge_delay_,
+      [this, buyer_ig_owner, buyer_client = std::move(buyer_client),
+       get_bids_request = std::move(get_bids_request), call_state,
+       buyer_metadata = buyer_metadata, cancellation = cancellation_,
+       timeout = timeout - get_bid_hedge_delay_]() mutable {
+        absl::AnyInvocable<void(
+            absl::StatusOr<
+                std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>) &&>
+            on_done;
+        {
+          absl::MutexLock lock(&call_state->mu);
+          call_state->hedge_task_id.reset();
+          if (call_state->done) {
+            return;
+          }
+          LogIfError(metric_context_->AccumulateMetric<
+                     metric::kSfeInitiatedRequestHedgedCountByBuyer>(
+              1, buyer_ig_owner));
+          on_done = MakeGetBidsCallback(buyer_ig_owner, call_state);
+        }
+        // If the hedged request can't be sent, the first call is still
+        // pending and completes the task.
+        buyer_client
+            ->ExecuteInternal(std::move(get_bids_request), buyer_metadata,
+                              std::move(on_done), timeout,
+                              std::move(cancellation))
+            .IgnoreError();
+      });
+  absl::MutexLock lock(&call_state->mu);
+  if (!call_state->done) {
+    call_state->hedge_task_id = hedge_task_id;
+  }
+}
+
+std::optional<absl::Duration> SelectAdReactor::RemainingGetBidsBudget() const {
+  if (context_->deadline() == std::chrono::system_clock::time_point::max()) {
+    return std::nullopt;
+  }
+  return absl::FromChrono(context_->deadline()) - absl::Now() -
+         get_bid_deadline_reserve_;
+}
+
 void SelectAdReactor::LogInitiatedRequestErrorMetrics(
     absl::string_view server_name, const absl::Status& status,
     absl::string_view buyer) {
@@ -592,25 +815,51 @@ void SelectAdReactor::OnFetchBidsDone(
     absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
         response,
     const std::string& buyer_ig_owner) {
+  critical_path_.EndGetBids(buyer_ig_owner, request_timer_.Elapsed());
   PS_VLOG(5, log_context_) << "Received response from a BFE ... ";
   if (response.ok()) {
     auto& found_response = *response;
-    PS_VLOG(kOriginated, log_context_) << "\nGetBidsResponse:\n"
-                                       << found_response->DebugString();
+    debug_log_.AddMessage(kOriginated, "\nGetBidsResponse:\n", *found_response);
     if (found_response->has_debug_info()) {
       server_common::DebugInfo& bfe_log =
           *response_->mutable_debug_info()->add_downstream_servers();
       bfe_log = std::move(*found_response->mutable_debug_info());
       bfe_log.set_server_name(buyer_ig_owner);
     }
+    // Filters the bids as they arrive, so that the scoring signals are only
+    // fetched for the bids that are scored.
+    const int num_rejected_bids =
+        FilterBidsWithMismatchingCurrency(buyer_ig_owner, *found_response);
+    const int num_bids_below_floor =
+        FilterBidsBelowFloor(buyer_ig_owner, *found_response);
+    KeepTopBidsOfBuyer(*found_response);
     if ((!is_protected_audience_enabled_ || found_response->bids().empty()) &&
         (!is_pas_enabled_ ||
          found_response->protected_app_signals_bids().empty())) {
+      if (num_rejected_bids > 0) {
+        PS_VLOG(kNoisyWarn, log_context_)
+            << "Skipping buyer " << buyer_ig_owner
+            << " due to all bids having a mismatching currency.";
+        async_task_tracker_.TaskCompleted(TaskStatus::SUCCESS, [this]() {
+          any_buyer_bids_rejected_for_currency_ = true;
+        });
+        return;
+      }
+      if (num_bids_below_floor > 0) {
+        PS_VLOG(kNoisyWarn, log_context_)
+            << "Skipping buyer " << buyer_ig_owner
+            << " due to all bids being under the bid floor.";
+        async_task_tracker_.TaskCompleted(TaskStatus::SUCCESS);
+        return;
+      }
       PS_VLOG(kNoisyWarn, log_context_) << "Skipping buyer " << buyer_ig_owner
                                         << " due to empty GetBidsResponse.";
 
       async_task_tracker_.TaskCompleted(TaskStatus::EMPTY_RESPONSE);
     } else {
+      if (enable_pipelined_scoring_signals_fetch_) {
+        FetchScoringSignalsForBuyer(buyer_ig_owner, *response);
+      }
       async_task_tracker_.TaskCompleted(
           TaskStatus::SUCCESS,
           [this, &buyer_ig_owner, response = *std::move(response)]() mutable {
@@ -633,12 +882,26 @@ void SelectAdReactor::OnFetchBidsDone(
 }
 
 void SelectAdReactor::OnAllBidsDone(bool any_successful_bids) {
+  // The reactor must outlive the pending scoring signals fetches, so they are
+  // waited for even if the request is finished right away.
+  if (enable_pipelined_scoring_signals_fetch_ &&
+      !AllBuyerScoringSignalsFetched(any_successful_bids)) {
+    return;
+  }
   if (context_->IsCancelled()) {
     // Early return if request is cancelled. DO NOT move to next step.
     FinishWithStatus(grpc::Status(grpc::ABORTED, kRequestCancelled));
     return;
   }
 
+  // All the bids received were rejected for their currency.
+  if (shared_buyer_bids_map_.empty() && any_buyer_bids_rejected_for_currency_) {
+    PS_VLOG(kNoisyWarn, log_context_) << kAllBidsRejectedBuyerCurrencyMismatch;
+    FinishWithStatus(grpc::Status(grpc::INVALID_ARGUMENT,
+                                  kAllBidsRejectedBuyerCurrencyMismatch));
+    return;
+  }
+
   // No successful bids received.
   if (shared_buyer_bids_map_.empty()) {
     PS_VLOG(kNoisyWarn, log_context_) << kNoBidsReceived;
@@ -659,121 +922,295 @@ void SelectAdReactor::OnAllBidsDone(bool any_successful_bids) {
     return;
   }
 
-  // Must fulfill preconditions:
-  // That the shared_buyer_bids_map_ is non-empty was just checked above
-  // That each buyer has bids was checked in OnFetchBidsDone().
-  // Thus the preconditions of the following method are satisfied.
-  if (!FilterBidsWithMismatchingCurrency()) {
-    PS_VLOG(kNoisyWarn, log_context_) << kAllBidsRejectedBuyerCurrencyMismatch;
-    FinishWithStatus(grpc::Status(grpc::INVALID_ARGUMENT,
-                                  kAllBidsRejectedBuyerCurrencyMismatch));
+  KeepTopBidsOfAuction();
+  if (enable_pipelined_scoring_signals_fetch_) {
+    OnFetchScoringSignalsDone(MergeBuyerScoringSignals());
   } else {
     FetchScoringSignals();
   }
 }
 
+void SelectAdReactor::FetchScoringSignalsForBuyer(
+    const std::string& buyer_ig_owner,
+    std::unique_ptr<GetBidsResponse::GetBidsRawResponse>& response) {
+  {
+    absl::MutexLock lock(&buyer_scoring_signals_mu_);
+    ++pending_buyer_scoring_signals_fetches_;
+  }
+  // The provider only reads the bids while building the KV request, so the
+  // response is handed back right after the call.
+  BuyerBidsResponseMap buyer_bids_map;
+  auto it = buyer_bids_map.try_emplace(buyer_ig_owner, std::move(response));
+  GetScoringSignals(
+      buyer_bids_map,
+      [this, buyer_ig_owner](
+          absl::StatusOr<std::unique_ptr<ScoringSignals>> result) {
+        critical_path_.EndBuyerScoringSignals(buyer_ig_owner,
+                                              request_timer_.Elapsed());
+        OnFetchScoringSignalsForBuyerDone(std::move(result));
+      });
+  response = std::move(it.first->second);
+}
+
+void SelectAdReactor::OnFetchScoringSignalsForBuyerDone(
+    absl::StatusOr<std::unique_ptr<ScoringSignals>> result) {
+  std::optional<bool> any_successful_bids;
+  {
+    absl::MutexLock lock(&buyer_scoring_signals_mu_);
+    buyer_scoring_signals_.push_back(std::move(result));
+    if (--pending_buyer_scoring_signals_fetches_ > 0) {
+      return;
+    }
+    any_successful_bids = any_successful_bids_;
+  }
+  // If bids are still pending, the async task tracker calls OnAllBidsDone
+  // once they are done.
+  if (any_successful_bids.has_value()) {
+    OnAllBidsDone(*any_successful_bids);
+  }
+}
+
+bool SelectAdReactor::AllBuyerScoringSignalsFetched(bool any_successful_bids) {
+  absl::MutexLock lock(&buyer_scoring_signals_mu_);
+  any_successful_bids_ = any_successful_bids;
+  return pending_buyer_scoring_signals_fetches_ == 0;
+}
+
+absl::StatusOr<std::unique_ptr<ScoringSignals>>
+SelectAdReactor::MergeBuyerScoringSignals() {
+  absl::MutexLock lock(&buyer_scoring_signals_mu_);
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_scoring_signals;
+  buyer_scoring_signals.reserve(buyer_scoring_signals_.size());
+  for (auto& result : buyer_scoring_signals_) {
+    if (!result.ok()) {
+      return result.status();
+    }
+    buyer_scoring_signals.push_back(*std::move(result));
+  }
+  return MergeScoringSignals(buyer_scoring_signals);
+}
+
 template <typename T>
-void SelectAdReactor::FilterBidsWithMismatchingCurrencyHelper(
+int SelectAdReactor::FilterBidsWithMismatchingCurrencyHelper(
     google::protobuf::RepeatedPtrField<T>* ads_with_bids,
     absl::string_view buyer_currency) {
-  int i = 0;
-  int remove_starting_at = ads_with_bids->size();
-  while (i < remove_starting_at) {
+  // Compacts the kept bids to the front in a single pass, keeping their order,
+  // and deletes the rejected ones at the back at once.
+  int num_kept = 0;
+  for (int i = 0; i < ads_with_bids->size(); ++i) {
     const T& ad_with_bid = (*ads_with_bids)[i];
     if (!ad_with_bid.bid_currency().empty() &&
         buyer_currency != ad_with_bid.bid_currency()) {
-      // Swap to last. Mark for removal and make sure we don't check it again
-      ads_with_bids->SwapElements(i, --remove_starting_at);
-      LogIfError(
-          metric_context_->AccumulateMetric<metric::kAuctionBidRejectedCount>(
-              1, ToSellerRejectionReasonString(
-                     SellerRejectionReason::
-                         BID_FROM_GENERATE_BID_FAILED_CURRENCY_CHECK)));
-      // Leave index un-incremented so swapped element is checked.
-    } else {
-      i++;
+      continue;
+    }
+    if (i != num_kept) {
+      ads_with_bids->SwapElements(i, num_kept);
     }
+    ++num_kept;
   }
-  // Delete all mismatched pas_bids.
-  if (remove_starting_at < ads_with_bids->size()) {
-    ads_with_bids->DeleteSubrange(remove_starting_at,
-                                  ads_with_bids->size() - remove_starting_at);
+  const int num_removed = ads_with_bids->size() - num_kept;
+  if (num_removed > 0) {
+    ads_with_bids->DeleteSubrange(num_kept, num_removed);
   }
+  return num_removed;
 }
 
-bool SelectAdReactor::FilterBidsWithMismatchingCurrency() {
-  DCHECK(!shared_buyer_bids_map_.empty())
-      << "PRECONDITION 1: shared_buyer_bids_map_ must have at least one entry.";
-  DCHECK(([shared_buyer_bids_map_ptr = &(shared_buyer_bids_map_),
-           is_protected_audience_enabled = is_protected_audience_enabled_,
-           is_pas_enabled = is_pas_enabled_]() {
-    for (const auto& [buyer_ig_owner, get_bid_response] :
-         *shared_buyer_bids_map_ptr) {
-      // Check if no bids are present.
-      if ((!is_protected_audience_enabled ||
-           get_bid_response->bids().empty()) &&
-          (!is_pas_enabled ||
-           get_bid_response->protected_app_signals_bids().empty())) {
-        return false;
-      }
+int SelectAdReactor::FilterBidsWithMismatchingCurrency(
+    const std::string& buyer_ig_owner,
+    GetBidsResponse::GetBidsRawResponse& get_bids_raw_response) {
+  // It is possible for a buyer to have no buyer_config.
+  const auto& buyer_config_itr =
+      request_->auction_config().per_buyer_config().find(buyer_ig_owner);
+  if (buyer_config_itr == request_->auction_config().per_buyer_config().end()) {
+    return 0;
+  }
+  // Not all buyers have an expected currency specified.
+  absl::string_view buyer_currency = buyer_config_itr->second.buyer_currency();
+  if (buyer_currency.empty()) {
+    return 0;
+  }
+
+  const int rejected_bid_count =
+      FilterBidsWithMismatchingCurrencyHelper<AdWithBid>(
+          get_bids_raw_response.mutable_bids(), buyer_currency) +
+      FilterBidsWithMismatchingCurrencyHelper<ProtectedAppSignalsAdWithBid>(
+          get_bids_raw_response.mutable_protected_app_signals_bids(),
+          buyer_currency);
+  if (rejected_bid_count > 0) {
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kAuctionBidRejectedCount>(
+            rejected_bid_count,
+            ToSellerRejectionReasonString(
+                SellerRejectionReason::
+                    BID_FROM_GENERATE_BID_FAILED_CURRENCY_CHECK)));
+  }
+  return rejected_bid_count;
+}
+
+template <typename T>
+int SelectAdReactor::FilterBidsBelowFloorHelper(
+    const std::string& buyer_ig_owner,
+    google::protobuf::RepeatedPtrField<T>* ads_with_bids,
+    absl::string_view buyer_currency, float buyer_bid_floor) {
+  const auto& auction_config = request_->auction_config();
+  // Compacts the kept bids to the front like
+  // FilterBidsWithMismatchingCurrencyHelper.
+  int num_kept = 0;
+  for (int i = 0; i < ads_with_bids->size(); ++i) {
+    const T& ad_with_bid = (*ads_with_bids)[i];
+    // Bids without a currency are in that of their buyer, if any.
+    absl::string_view bid_currency = ad_with_bid.bid_currency().empty()
+                                         ? buyer_currency
+                                         : ad_with_bid.bid_currency();
+    float bid_floor = buyer_bid_floor;
+    if (auction_config.seller_currency().empty() || bid_currency.empty() ||
+        auction_config.seller_currency() == bid_currency) {
+      bid_floor = std::max(bid_floor, auction_config.bid_floor());
     }
-    return true;
-  }()))
-      << "PRECONDITION 2: each buyer in shared_buyer_bids_map must be "
-         "non-empty.";
-  bool any_valid_bids = false;
-  // Check that each AdWithBid's currency is as-expected.
-  // Throw out the AdWithBids which do not match.
-  for (auto& [buyer_ig_owner, get_bids_raw_response] : shared_buyer_bids_map_) {
-    // It is possible for a buyer to have no buyer_config.
-    const auto& buyer_config_itr =
-        request_->auction_config().per_buyer_config().find(buyer_ig_owner);
-    if (buyer_config_itr ==
-        request_->auction_config().per_buyer_config().end()) {
-      // Preconditions mean bids must be present.
-      any_valid_bids = true;
+    if (ad_with_bid.bid() < bid_floor) {
       continue;
     }
-    // Not all buyers have an expected currency specified.
-    absl::string_view buyer_currency =
-        buyer_config_itr->second.buyer_currency();
-    if (buyer_currency.empty()) {
-      // Preconditions mean bids must be present.
-      any_valid_bids = true;
-      continue;
+    if (i != num_kept) {
+      ads_with_bids->SwapElements(i, num_kept);
     }
+    ++num_kept;
+  }
+  const int num_removed = ads_with_bids->size() - num_kept;
+  if (num_removed == 0) {
+    return 0;
+  }
+  // Only the bids of interest groups are debug reported.
+  if constexpr (std::is_same_v<T, AdWithBid>) {
+    absl::MutexLock lock(&bids_below_floor_mu_);
+    for (int i = num_kept; i < ads_with_bids->size(); ++i) {
+      AdWithBid& ad_with_bid = (*ads_with_bids)[i];
+      if (ad_with_bid.debug_report_urls().auction_debug_loss_url().empty()) {
+        continue;
+      }
+      bids_below_floor_.push_back(
+          {buyer_ig_owner,
+           std::move(*ad_with_bid.mutable_interest_group_name()),
+           std::move(*ad_with_bid.mutable_debug_report_urls()
+                          ->mutable_auction_debug_loss_url())});
+    }
+  }
+  ads_with_bids->DeleteSubrange(num_kept, num_removed);
+  return num_removed;
+}
+
+int SelectAdReactor::FilterBidsBelowFloor(
+    const std::string& buyer_ig_owner,
+    GetBidsResponse::GetBidsRawResponse& get_bids_raw_response) {
+  absl::string_view buyer_currency;
+  float buyer_bid_floor = 0;
+  const auto& per_buyer_config = request_->auction_config().per_buyer_config();
+  if (const auto it = per_buyer_config.find(buyer_ig_owner);
+      it != per_buyer_config.end()) {
+    buyer_currency = it->second.buyer_currency();
+    buyer_bid_floor = it->second.bid_floor();
+  }
+  if (buyer_bid_floor <= 0 && request_->auction_config().bid_floor() <= 0) {
+    return 0;
+  }
 
-    FilterBidsWithMismatchingCurrencyHelper<AdWithBid>(
-        get_bids_raw_response->mutable_bids(), buyer_currency);
-    FilterBidsWithMismatchingCurrencyHelper<ProtectedAppSignalsAdWithBid>(
-        get_bids_raw_response->mutable_protected_app_signals_bids(),
-        buyer_currency);
-
-    // Check if any bids remain.
-    if ((is_protected_audience_enabled_ &&
-         !get_bids_raw_response->bids().empty()) ||
-        (is_pas_enabled_ &&
-         !get_bids_raw_response->protected_app_signals_bids().empty())) {
-      any_valid_bids = true;
+  const int rejected_bid_count =
+      FilterBidsBelowFloorHelper<AdWithBid>(
+          buyer_ig_owner, get_bids_raw_response.mutable_bids(), buyer_currency,
+          buyer_bid_floor) +
+      FilterBidsBelowFloorHelper<ProtectedAppSignalsAdWithBid>(
+          buyer_ig_owner,
+          get_bids_raw_response.mutable_protected_app_signals_bids(),
+          buyer_currency, buyer_bid_floor);
+  if (rejected_bid_count > 0) {
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kAuctionBidRejectedCount>(
+            rejected_bid_count,
+            ToSellerRejectionReasonString(
+                SellerRejectionReason::BID_BELOW_AUCTION_FLOOR)));
+  }
+  return rejected_bid_count;
+}
+
+void SelectAdReactor::KeepTopBidsOfBuyer(
+    GetBidsResponse::GetBidsRawResponse& get_bids_raw_response) {
+  const int num_truncated_bids =
+      KeepTopBids(max_bids_per_buyer_, *get_bids_raw_response.mutable_bids()) +
+      KeepTopBids(max_bids_per_buyer_,
+                  *get_bids_raw_response.mutable_protected_app_signals_bids());
+  if (num_truncated_bids > 0) {
+    LogIfError(
+        metric_context_->LogUpDownCounter<metric::kSfeTruncatedBidsCount>(
+            num_truncated_bids));
+  }
+}
+
+void SelectAdReactor::KeepTopBidsOfAuction() {
+  if (max_bids_per_auction_ <= 0) {
+    return;
+  }
+  std::vector<float> bids;
+  for (const auto& [unused_buyer, get_bids_raw_response] :
+       shared_buyer_bids_map_) {
+    for (const auto& ad_with_bid : get_bids_raw_response->bids()) {
+      bids.push_back(ad_with_bid.bid());
     }
+    for (const auto& ad_with_bid :
+         get_bids_raw_response->protected_app_signals_bids()) {
+      bids.push_back(ad_with_bid.bid());
+    }
+  }
+  if (static_cast<int>(bids.size()) <= max_bids_per_auction_) {
+    return;
   }
-  // Clear buyers with no remaining bids.
-  absl::erase_if(
+  // Finds the lowest kept bid, and how many bids equal to it fit in the budget
+  // next to the higher ones.
+  auto min_kept = bids.begin() + max_bids_per_auction_ - 1;
+  std::nth_element(bids.begin(), min_kept, bids.end(), std::greater<float>());
+  const float min_bid = *min_kept;
+  int num_min_bids = std::count(bids.begin(), min_kept + 1, min_bid);
+  int num_truncated_bids = 0;
+  for (auto& [unused_buyer, get_bids_raw_response] : shared_buyer_bids_map_) {
+    num_truncated_bids +=
+        KeepBidsAbove(min_bid, num_min_bids,
+                      *get_bids_raw_response->mutable_bids()) +
+        KeepBidsAbove(
+            min_bid, num_min_bids,
+            *get_bids_raw_response->mutable_protected_app_signals_bids());
+  }
+  PS_VLOG(kNoisyWarn, log_context_)
+      << "Dropped " << num_truncated_bids
+      << " bids exceeding the bid budget of the auction";
+  LogIfError(metric_context_->LogUpDownCounter<metric::kSfeTruncatedBidsCount>(
+      num_truncated_bids));
+}
+
+void SelectAdReactor::FetchScoringSignals() {
+  // Pipelined fetches overlap with the fan-out and are not traced apart.
+  phase_tracer_.Start(RequestPhase::kKvLookup);
+  GetScoringSignals(
       shared_buyer_bids_map_,
-      [is_p_aud_enabled = is_protected_audience_enabled_,
-       is_pas_enabled = is_pas_enabled_](const auto& buyer_to_bids_pair) {
-        const auto& get_bids_raw_response = buyer_to_bids_pair.second;
-        // Check if any bids remain.
-        return ((!is_p_aud_enabled || get_bids_raw_response->bids().empty()) &&
-                (!is_pas_enabled ||
-                 get_bids_raw_response->protected_app_signals_bids().empty()));
+      [this](absl::StatusOr<std::unique_ptr<ScoringSignals>> result) {
+        phase_tracer_.End(RequestPhase::kKvLookup);
+        critical_path_.EndScoringSignals(request_timer_.Elapsed());
+        OnFetchScoringSignalsDone(std::move(result));
       });
-  return any_valid_bids;
 }
 
-void SelectAdReactor::FetchScoringSignals() {
-  ScoringSignalsRequest scoring_signals_request(
-      shared_buyer_bids_map_, buyer_metadata_, request_->client_type());
+void SelectAdReactor::GetScoringSignals(
+    const BuyerBidsResponseMap& buyer_bids_map,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+        on_done) {
+  // The KV server continues the trace of the request, under the span of the
+  // lookup phase if it is running.
+  const RequestMetadata* kv_metadata = &buyer_metadata_;
+  RequestMetadata traced_kv_metadata;
+  if (trace_.enabled()) {
+    traced_kv_metadata = buyer_metadata_;
+    trace_.Inject(RequestPhase::kKvLookup, traced_kv_metadata);
+    kv_metadata = &traced_kv_metadata;
+  }
+  ScoringSignalsRequest scoring_signals_request(buyer_bids_map, *kv_metadata,
+                                                request_->client_type());
   if (request_->auction_config().has_code_experiment_spec() &&
       request_->auction_config()
           .code_experiment_spec()
@@ -783,11 +1220,28 @@ void SelectAdReactor::FetchScoringSignals() {
                          .code_experiment_spec()
                          .seller_kv_experiment_group_id());
   }
+  // Only the render URLs whose signals are not cached are looked up.
+  std::unique_ptr<CachedScoringSignals> cached;
+  if (clients_.scoring_signals_cache != nullptr) {
+    cached = std::make_unique<CachedScoringSignals>(
+        *clients_.scoring_signals_cache,
+        scoring_signals_request.seller_kv_experiment_group_id_);
+    cached->LookUp(buyer_bids_map, config_->enable_protected_app_signals,
+                   scoring_signals_request.cached_render_urls_,
+                   scoring_signals_request.cached_ad_component_render_urls_);
+    if (!cached->HasMisses()) {
+      PS_VLOG(kNoisyInfo, log_context_)
+          << "All scoring signals found in the cache";
+      std::move(on_done)(cached->CacheAndMerge(nullptr));
+      return;
+    }
+  }
   auto kv_request =
       metric::MakeInitiatedRequest(metric::kKv, metric_context_.get());
   clients_.scoring_signals_async_provider.Get(
       scoring_signals_request,
-      [this, kv_request = std::move(kv_request)](
+      [kv_request = std::move(kv_request), cached = std::move(cached),
+       on_done = std::move(on_done)](
           absl::StatusOr<std::unique_ptr<ScoringSignals>> result,
           GetByteSize get_byte_size) mutable {
         {
@@ -801,10 +1255,12 @@ void SelectAdReactor::FetchScoringSignals() {
           // destruct kv_request, destructor measures request time
           auto not_used = std::move(kv_request);
         }
-        OnFetchScoringSignalsDone(std::move(result));
+        if (cached != nullptr && result.ok()) {
+          result = cached->CacheAndMerge(*std::move(result));
+        }
+        std::move(on_done)(std::move(result));
       },
-      absl::Milliseconds(config_client_.GetIntParameter(
-          KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS)));
+      config_->key_value_signals_fetch_rpc_timeout);
 }
 
 void SelectAdReactor::OnFetchScoringSignalsDone(
@@ -843,9 +1299,10 @@ SelectAdReactor::CreateScoreAdsRequest() {
     // If protected audience support is not enabled then buyers should not
     // be returning bids anyway for Protected Audience but this check is placed
     // here for safety as well as efficiency.
-    for (const auto& [buyer_ig_owner, get_bid_response] :
-         shared_buyer_bids_map_) {
-      for (const AdWithBid& ad_with_bid : get_bid_response->bids()) {
+    // The ad payloads are moved out of the bids, which keep the fields used
+    // after scoring, such as the interest group names and debug report URLs.
+    for (auto& [buyer_ig_owner, get_bid_response] : shared_buyer_bids_map_) {
+      for (AdWithBid& ad_with_bid : *get_bid_response->mutable_bids()) {
         raw_request->mutable_ad_bids()->Add(
             BuildAdWithBidMetadata(ad_with_bid, buyer_ig_owner));
       }
@@ -900,8 +1357,7 @@ void SelectAdReactor::ScoreAds() {
     OnScoreAdsDone(std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>());
     return;
   }
-  PS_VLOG(kOriginated, log_context_) << "ScoreAdsRawRequest:\n"
-                                     << raw_request->DebugString();
+  debug_log_.AddMessage(kOriginated, "ScoreAdsRawRequest:\n", *raw_request);
 
   auto auction_request =
       metric::MakeInitiatedRequest(metric::kAs, metric_context_.get());
@@ -910,6 +1366,8 @@ void SelectAdReactor::ScoreAds() {
       [this, auction_request = std::move(auction_request)](
           absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
               result) mutable {
+        phase_tracer_.End(RequestPhase::kWinnerSelection);
+        critical_path_.EndScoreAds(request_timer_.Elapsed());
         {
           int response_size =
               result.ok() ? (int)result->get()->ByteSizeLong() : 0;
@@ -919,10 +1377,12 @@ void SelectAdReactor::ScoreAds() {
         }
         OnScoreAdsDone(std::move(result));
       };
+  phase_tracer_.Start(RequestPhase::kWinnerSelection);
+  RequestMetadata scoring_metadata;
+  trace_.Inject(RequestPhase::kWinnerSelection, scoring_metadata);
   absl::Status execute_result = clients_.scoring.ExecuteInternal(
-      std::move(raw_request), {}, std::move(on_scoring_done),
-      absl::Milliseconds(
-          config_client_.GetIntParameter(SCORE_ADS_RPC_TIMEOUT_MS)));
+      std::move(raw_request), scoring_metadata, std::move(on_scoring_done),
+      config_->score_ads_rpc_timeout, cancellation_);
   if (!execute_result.ok()) {
     LogIfError(
         metric_context_->AccumulateMetric<metric::kSfeErrorCountByErrorCode>(
@@ -941,12 +1401,41 @@ void SelectAdReactor::FinishWithStatus(const grpc::Status& status) {
   }
   if (metric_context_->CustomState(kWinningAd).ok()) {
     LogIfError(metric_context_->LogHistogram<metric::kSfeWithWinnerTimeMs>(
-        static_cast<int>((absl::Now() - start_) / absl::Milliseconds(1))));
+        static_cast<int>(request_timer_.Elapsed() / absl::Milliseconds(1))));
   }
+  metric::LogRequestPhases(phase_tracer_, *metric_context_);
+  LogCriticalPath();
+  trace_.End(status);
   benchmarking_logger_->End();
   Finish(status);
 }
 
+void SelectAdReactor::LogCriticalPath() {
+  std::optional<AuctionCriticalPathResult> critical_path =
+      critical_path_.Compute(request_timer_.Elapsed());
+  if (!critical_path.has_value()) {
+    return;
+  }
+  for (int i = 0; i < kNumAuctionStages; ++i) {
+    LogIfError(metric_context_->AccumulateMetric<
+               metric::kSfeCriticalPathStageDuration>(
+        static_cast<int>(critical_path->stage_durations[i] /
+                         absl::Microseconds(1)),
+        kAuctionStageNames[i]));
+  }
+  if (!critical_path->buyer.empty()) {
+    LogIfError(metric_context_->AccumulateMetric<
+               metric::kSfeCriticalPathBuyerDuration>(
+        static_cast<int>(critical_path->buyer_duration /
+                         absl::Microseconds(1)),
+        critical_path->buyer));
+  }
+  if (log_context_.is_consented()) {
+    PS_VLOG(kStats, log_context_)
+        << "SelectAd critical path: " << critical_path->ToJson();
+  }
+}
+
 void SelectAdReactor::OnScoreAdsDone(
     absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
         response) {
@@ -985,7 +1474,7 @@ void SelectAdReactor::OnScoreAdsDone(
     const auto& found_response = *response;
     if (found_response->has_ad_score() &&
         found_response->ad_score().buyer_bid() > 0) {
-      high_score = found_response->ad_score();
+      high_score = std::move(*found_response->mutable_ad_score());
       LogIfError(
           metric_context_->LogUpDownCounter<metric::kRequestWithWinnerCount>(
               1));
@@ -1014,19 +1503,50 @@ void SelectAdReactor::OnScoreAdsDone(
     return;
   }
 
-  PS_VLOG(kEncrypted, log_context_) << "Encrypted SelectAdResponse:\n"
-                                    << response_->ShortDebugString();
+  debug_log_.AddMessage(kEncrypted, "Encrypted SelectAdResponse:\n",
+                        *response_);
 
   FinishWithStatus(grpc::Status::OK);
 }
 
 DecodedBuyerInputs SelectAdReactor::GetDecodedBuyerinputs(
     const EncodedBuyerInputs& encoded_buyer_inputs) {
-  return DecodeBuyerInputs(encoded_buyer_inputs, error_accumulator_,
-                           fail_fast_);
+  std::vector<const EncodedBuyerInputs::value_type*> encoded_entries;
+  encoded_entries.reserve(encoded_buyer_inputs.size());
+  std::vector<std::unique_ptr<ErrorAccumulator>> error_accumulators;
+  error_accumulators.reserve(encoded_buyer_inputs.size());
+  for (const auto& entry : encoded_buyer_inputs) {
+    encoded_entries.push_back(&entry);
+    error_accumulators.push_back(
+        std::make_unique<ErrorAccumulator>(&log_context_));
+  }
+  std::vector<std::optional<BuyerInput>> buyer_inputs(encoded_entries.size());
+  ParallelFor(clients_.executor, static_cast<int>(encoded_entries.size()),
+              [this, &encoded_entries, &error_accumulators,
+               &buyer_inputs](int i) {
+                const auto& [owner, encoded_buyer_input] = *encoded_entries[i];
+                buyer_inputs[i] = GetDecodedBuyerInput(
+                    owner, encoded_buyer_input, *error_accumulators[i]);
+              });
+
+  DecodedBuyerInputs decoded_buyer_inputs;
+  for (int i = 0; i < encoded_entries.size(); ++i) {
+    error_accumulator_.MergeFrom(*error_accumulators[i]);
+    if (buyer_inputs[i].has_value()) {
+      decoded_buyer_inputs.insert(
+          {encoded_entries[i]->first, *std::move(buyer_inputs[i])});
+    }
+    // As when decoding one buyer after the other, the buyers after the first
+    // one with errors are dropped.
+    if (fail_fast_ && error_accumulators[i]->HasErrors()) {
+      break;
+    }
+  }
+  return decoded_buyer_inputs;
 }
 
 bool SelectAdReactor::EncryptResponse(std::string plaintext_response) {
+  ScopedRequestPhase encrypt_phase(phase_tracer_, RequestPhase::kEncrypt);
   absl::StatusOr<std::string> encapsulated_response;
   if (auction_scope_ ==
       AuctionScope::AUCTION_SCOPE_SERVER_COMPONENT_MULTI_SELLER) {
@@ -1069,15 +1589,9 @@ bool SelectAdReactor::EncryptResponse(std::string plaintext_response) {
 
 void SelectAdReactor::PerformDebugReporting(
     const std::optional<AdScore>& high_score) {
-  // Create new metric context.
-  metric::MetricContextMap<SelectAdRequest>()->Get(request_);
-  // Make metric_context a unique_ptr by releasing the ownership of the context
-  // from ContextMap.
-  absl::StatusOr<std::unique_ptr<metric::SfeContext>> metric_context =
-      metric::MetricContextMap<SelectAdRequest>()->Remove(request_);
-  CHECK_OK(metric_context);
+  // Create new metric context, shared by the debug reporting callbacks.
   std::shared_ptr<metric::SfeContext> shared_context =
-      *std::move(metric_context);
+      metric::CreateMetricContext<SelectAdRequest>();
 
   bool enable_debug_reporting = false;
   std::visit(
@@ -1090,6 +1604,33 @@ void SelectAdReactor::PerformDebugReporting(
     return;
   }
 
+  // Sends the debug report of an interest group of `ig_owner`.
+  auto report = [this](absl::string_view debug_url,
+                       const DebugReportingPlaceholder& placeholder_data,
+                       bool is_win_debug_url, const std::string& ig_owner,
+                       const std::string& ig_name) {
+    absl::AnyInvocable<void(absl::StatusOr<absl::string_view>)> done_cb;
+    if (server_common::log::PS_VLOG_IS_ON(5)) {
+      done_cb =
+          [ig_owner, ig_name](
+              absl::StatusOr<absl::string_view> result) mutable {  // NOLINT
+            if (result.ok()) {
+              PS_VLOG(5) << "Performed debug reporting for:" << ig_owner
+                         << ", interest_group: " << ig_name;
+            } else {
+              PS_VLOG(5) << "Error while performing debug reporting for:"
+                         << ig_owner << ", interest_group: " << ig_name
+                         << " ,status:" << result.status();
+            }
+          };
+    } else {
+      done_cb = [](absl::StatusOr<absl::string_view> result) {};  // NOLINT
+    }
+    HTTPRequest http_request = CreateDebugReportingHttpRequest(
+        debug_url, placeholder_data, is_win_debug_url);
+    clients_.reporting->DoReport(http_request, std::move(done_cb));
+  };
+
   PostAuctionSignals post_auction_signals = GeneratePostAuctionSignals(
       high_score, request_->auction_config().seller_currency());
   for (const auto& [ig_owner, get_bid_response] : shared_buyer_bids_map_) {
@@ -1112,40 +1653,33 @@ void SelectAdReactor::PerformDebugReporting(
       if (debug_url.empty()) {
         continue;
       }
-
-      absl::AnyInvocable<void(absl::StatusOr<absl::string_view>)> done_cb;
-      if (server_common::log::PS_VLOG_IS_ON(5)) {
-        done_cb =
-            [ig_owner = ig_owner, ig_name](
-                absl::StatusOr<absl::string_view> result) mutable {  // NOLINT
-              if (result.ok()) {
-                PS_VLOG(5) << "Performed debug reporting for:" << ig_owner
-                           << ", interest_group: " << ig_name;
-              } else {
-                PS_VLOG(5) << "Error while performing debug reporting for:"
-                           << ig_owner << ", interest_group: " << ig_name
-                           << " ,status:" << result.status();
-              }
-            };
-      } else {
-        done_cb = [](absl::StatusOr<absl::string_view> result) {};  // NOLINT
-      }
-      HTTPRequest http_request = CreateDebugReportingHttpRequest(
-          debug_url,
-          GetPlaceholderDataForInterestGroup(ig_owner, ig_name,
-                                             post_auction_signals),
-          is_win_debug_url);
-      clients_.reporting->DoReport(http_request, std::move(done_cb));
+      report(debug_url,
+             GetPlaceholderDataForInterestGroup(ig_owner, ig_name,
+                                                post_auction_signals),
+             is_win_debug_url, ig_owner, ig_name);
     }
   }
-}
 
-void SelectAdReactor::OnDone() { delete this; }
+  // The bids under the bid floor lost without being scored.
+  absl::MutexLock lock(&bids_below_floor_mu_);
+  for (const BidBelowFloor& bid : bids_below_floor_) {
+    DebugReportingPlaceholder placeholder_data =
+        GetPlaceholderDataForInterestGroup(bid.ig_owner, bid.ig_name,
+                                           post_auction_signals);
+    placeholder_data.rejection_reason =
+        SellerRejectionReason::BID_BELOW_AUCTION_FLOOR;
+    report(bid.debug_loss_url, placeholder_data, /*is_win_debug_url=*/false,
+           bid.ig_owner, bid.ig_name);
+  }
+}
 
-void SelectAdReactor::OnCancel() {
-  // TODO(b/245982466): Handle early abort and errors.
+void SelectAdReactor::OnDone() {
+  debug_log_.Flush();
+  delete this;
 }
 
+void SelectAdReactor::OnCancel() { cancellation_->Cancel(); }
+
 void SelectAdReactor::ReportError(
     log::ParamWithSourceLoc<ErrorVisibility> error_visibility_with_loc,
     const std::string& msg, ErrorCode error_code) {
@@ -22,26 +22,39 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
 #include "quiche/oblivious_http/oblivious_http_gateway.h"
+#include "services/common/compression/compression_codec.h"
 #include "services/common/loggers/build_input_process_response_benchmarking_logger.h"
+#include "services/common/loggers/deferred_debug_log.h"
 #include "services/common/loggers/no_ops_logger.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_trace.h"
 #include "services/common/util/async_task_tracker.h"
+#include "services/common/util/cycle_clock.h"
 #include "services/common/util/error_accumulator.h"
 #include "services/common/util/error_reporter.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/request_cancellation.h"
 #include "services/common/util/request_metadata.h"
+#include "services/common/util/request_phase_tracer.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/request_validator.h"
 #include "services/seller_frontend_service/data/scoring_signals.h"
 #include "services/seller_frontend_service/seller_frontend_service.h"
+#include "services/seller_frontend_service/util/auction_critical_path.h"
 #include "services/seller_frontend_service/util/encryption_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -53,6 +66,7 @@ inline constexpr std::array<std::pair<std::string_view, std::string_view>, 3>
 // Constants for service errors.
 inline constexpr char kInvalidBuyerCurrency[] = "Invalid Buyer Currency";
 inline constexpr char kInvalidSellerCurrency[] = "Invalid Seller Currency";
+inline constexpr char kNegativeBidFloor[] = "Bid floor must not be negative";
 
 inline constexpr char kNoBidsReceived[] = "No bids received.";
 
@@ -61,9 +75,6 @@ inline constexpr char kAllBidsRejectedBuyerCurrencyMismatch[] =
 
 inline constexpr absl::string_view kWinningAd = "winning_ad";
 
-inline constexpr char kValidCurrencyCodePattern[] = "^[A-Z]{3}$";
-const std::regex kValidCurrencyCodeRegex(kValidCurrencyCodePattern);
-
 // This is a gRPC reactor that serves a single GenerateBidsRequest.
 // It stores state relevant to the request and after the
 // response is finished being served, SelectAdReactor cleans up all
@@ -79,6 +90,11 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Initiate the asynchronous execution of the SelectAdRequest.
   virtual void Execute();
 
+  // Holds the memory reserved for the request until the reactor is done.
+  void HoldMemoryReservation(MemoryReservation memory_reservation) {
+    memory_reservation_ = std::move(memory_reservation);
+  }
+
  protected:
   using ErrorHandlerSignature = const std::function<void(absl::string_view)>&;
   using AuctionConfig = SelectAdRequest::AuctionConfig;
@@ -100,14 +116,26 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
       absl::string_view encoded_data) = 0;
 
   // Returns the decoded BuyerInput from the encoded/compressed BuyerInput.
-  // Any errors while decoding are reported to error accumulator object.
+  // Any errors while decoding are reported to error accumulator object. The
+  // buyers are decoded in parallel, on the executor if available, with
+  // GetDecodedBuyerInput.
   virtual absl::flat_hash_map<absl::string_view, BuyerInput>
   GetDecodedBuyerinputs(const google::protobuf::Map<std::string, std::string>&
-                            encoded_buyer_inputs) = 0;
-
+                            encoded_buyer_inputs);
+
+  // Decodes the encoded/compressed BuyerInput of a single buyer. Errors are
+  // reported to error_accumulator rather than the one of the reactor, since
+  // buyers are decoded concurrently. Returns nullopt if the buyer is to be
+  // left out of the decoded buyer inputs.
+  virtual std::optional<BuyerInput> GetDecodedBuyerInput(
+      absl::string_view owner, absl::string_view encoded_buyer_input,
+      ErrorAccumulator& error_accumulator) = 0;
+
+  // Creates the GetBids request for a buyer. The interest groups in
+  // buyer_input are moved into the request rather than copied.
   virtual std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
   CreateGetBidsRequest(const std::string& buyer_ig_owner,
-                       const BuyerInput& buyer_input);
+                       BuyerInput& buyer_input);
 
   virtual std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
   CreateScoreAdsRequest();
@@ -118,70 +146,94 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Checks if any ad server visible errors have been observed.
   bool HaveAdServerVisibleErrors();
 
-  // Checks that all AdWithBids match the specified buyer_currency, and throws
-  // out those which do not match.
-  // PRECONDITION 1: shared_buyer_bids_map_ must have at least one entry.
-  // PRECONDITION 2: each buyer in shared_buyer_bids_map must be non-empty.
-  // RETURNS: True if any bids remain to be scored and false otherwise.
-  bool FilterBidsWithMismatchingCurrency();
+  // Drops the lowest bids of a buyer above the per buyer bid budget.
+  void KeepTopBidsOfBuyer(
+      GetBidsResponse::GetBidsRawResponse& get_bids_raw_response);
 
+  // Drops the lowest bids of all the buyers above the per auction bid budget.
+  void KeepTopBidsOfAuction();
+
+  // Throws out the bids of a buyer which do not match the buyer_currency
+  // specified for the buyer, if any.
+  // RETURNS: The number of bids thrown out.
+  int FilterBidsWithMismatchingCurrency(
+      const std::string& buyer_ig_owner,
+      GetBidsResponse::GetBidsRawResponse& get_bids_raw_response);
+
+  // Removes the bids not in `buyer_currency` and returns how many there were.
   template <typename T>
-  void FilterBidsWithMismatchingCurrencyHelper(
+  int FilterBidsWithMismatchingCurrencyHelper(
       google::protobuf::RepeatedPtrField<T>* ads_with_bids,
       absl::string_view buyer_currency);
 
+  // Throws out the bids of a buyer under the bid floor of the seller or of the
+  // buyer, if any, which scoreAd would reject anyway. The debug loss URLs of
+  // the bids thrown out are kept to be reported with their rejection reason.
+  // RETURNS: The number of bids thrown out.
+  int FilterBidsBelowFloor(
+      const std::string& buyer_ig_owner,
+      GetBidsResponse::GetBidsRawResponse& get_bids_raw_response);
+
+  // Removes the bids under their floor and returns how many there were.
+  template <typename T>
+  int FilterBidsBelowFloorHelper(
+      const std::string& buyer_ig_owner,
+      google::protobuf::RepeatedPtrField<T>* ads_with_bids,
+      absl::string_view buyer_currency, float buyer_bid_floor);
+
   // Validates the mandatory fields in the request. Reports any errors to the
   // error accumulator.
   template <typename T>
   void ValidateProtectedAuctionInput(const T& protected_auction_input) {
-    if (protected_auction_input.generation_id().empty()) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE, kMissingGenerationId,
-                  ErrorCode::CLIENT_SIDE);
-    }
-
-    if (protected_auction_input.publisher_name().empty()) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE, kMissingPublisherName,
-                  ErrorCode::CLIENT_SIDE);
-    }
+    RequestValidator validator(error_accumulator_,
+                               ErrorVisibility::CLIENT_VISIBLE);
+    validator.Check(!protected_auction_input.generation_id().empty(),
+                    kMissingGenerationId);
+    validator.Check(!protected_auction_input.publisher_name().empty(),
+                    kMissingPublisherName);
 
     // Validate Buyer Inputs.
-    if (buyer_inputs_->empty()) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE, kMissingBuyerInputs,
-                  ErrorCode::CLIENT_SIDE);
-    } else {
-      bool is_any_buyer_input_valid = false;
-      std::set<std::string> observed_errors;
-      for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
-        bool any_error = false;
-        if (buyer.empty()) {
-          observed_errors.insert(kEmptyInterestGroupOwner);
-          any_error = true;
-        }
-        if (buyer_input.interest_groups().empty() &&
-            !buyer_input.has_protected_app_signals()) {
-          observed_errors.insert(absl::StrFormat(
-              kMissingInterestGroupsAndProtectedSignals, buyer));
-          any_error = true;
-        }
-        if (any_error) {
-          continue;
-        }
-        is_any_buyer_input_valid = true;
+    if (!validator.Check(!buyer_inputs_->empty(), kMissingBuyerInputs)) {
+      return;
+    }
+    bool is_any_buyer_input_valid = false;
+    // The error messages are only built if a buyer input is malformed.
+    std::vector<absl::string_view> malformed_buyers;
+    for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
+      if (buyer.empty() || (buyer_input.interest_groups().empty() &&
+                            !buyer_input.has_protected_app_signals())) {
+        malformed_buyers.push_back(buyer);
+        continue;
+      }
+      is_any_buyer_input_valid = true;
+    }
+    if (malformed_buyers.empty()) {
+      return;
+    }
+    std::set<std::string> observed_errors;
+    for (absl::string_view buyer : malformed_buyers) {
+      if (buyer.empty()) {
+        observed_errors.insert(kEmptyInterestGroupOwner);
       }
-      // Buyer inputs have keys but none of the key/value pairs are usable to
-      // get bids from buyers.
-      if (!is_any_buyer_input_valid) {
-        std::string error =
-            absl::StrFormat(kNonEmptyBuyerInputMalformed,
-                            absl::StrJoin(observed_errors, kErrorDelimiter));
-        ReportError(ErrorVisibility::CLIENT_VISIBLE, error,
-                    ErrorCode::CLIENT_SIDE);
-      } else {
-        // Log but don't report the errors for malformed buyer inputs because we
-        // have found at least one buyer input that is well formed.
-        for (const auto& observed_error : observed_errors) {
-          PS_VLOG(kNoisyWarn, log_context_) << observed_error;
-        }
+      const BuyerInput& buyer_input = buyer_inputs_->at(buyer);
+      if (buyer_input.interest_groups().empty() &&
+          !buyer_input.has_protected_app_signals()) {
+        observed_errors.insert(
+            absl::StrFormat(kMissingInterestGroupsAndProtectedSignals, buyer));
+      }
+    }
+    // Buyer inputs have keys but none of the key/value pairs are usable to
+    // get bids from buyers.
+    if (!is_any_buyer_input_valid) {
+      validator.Check(false, [&observed_errors]() {
+        return absl::StrFormat(kNonEmptyBuyerInputMalformed,
+                               absl::StrJoin(observed_errors, kErrorDelimiter));
+      });
+    } else {
+      // Log but don't report the errors for malformed buyer inputs because we
+      // have found at least one buyer input that is well formed.
+      for (const auto& observed_error : observed_errors) {
+        PS_VLOG(kNoisyWarn, log_context_) << observed_error;
       }
     }
   }
@@ -189,6 +241,10 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Logs the decoded buyer inputs if available.
   void MayLogBuyerInput();
 
+  // Captures the decoded request of consented debugging when the server
+  // captures requests, see RequestCapture.
+  void MayCaptureRequest();
+
   // Populates the errors that need to be sent to the client (in the encrypted
   // response).
   void MayPopulateClientVisibleErrors();
@@ -207,9 +263,37 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // rpc.
   //
   // buyer: a string representing the buyer, identified as an IG owner.
-  // buyer_input: input for bidding.
-  void FetchBid(const std::string& buyer_ig_owner,
-                const BuyerInput& buyer_input);
+  // buyer_input: input for bidding, moved into the request except for the
+  // interest group metadata needed after the call.
+  void FetchBid(const std::string& buyer_ig_owner, BuyerInput& buyer_input);
+
+  // State shared by the GetBids calls sent to a single buyer.
+  struct GetBidsCallState;
+
+  // Returns the callback of a GetBids call to a buyer. Only the first call to
+  // complete is handed to OnFetchBidsDone. The others are dropped without
+  // accessing the reactor.
+  absl::AnyInvocable<
+      void(absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>)
+          &&>
+  MakeGetBidsCallback(const std::string& buyer_ig_owner,
+                      std::shared_ptr<GetBidsCallState> call_state);
+
+  // Sends a second GetBids request to the buyer if the first one did not
+  // complete after the hedge delay. The buyer client load balances requests
+  // across the BFE replicas, so the hedged request usually reaches another
+  // replica.
+  void ScheduleHedgedGetBids(
+      const std::string& buyer_ig_owner,
+      std::shared_ptr<const BuyerFrontEndAsyncClient> buyer_client,
+      std::unique_ptr<GetBidsRequest::GetBidsRawRequest> get_bids_request,
+      const RequestMetadata& buyer_metadata,
+      std::shared_ptr<GetBidsCallState> call_state, absl::Duration timeout);
+
+  // Returns the time left for GetBids calls before the deadline of the
+  // request, minus the time reserved for scoring. Returns nullopt if the
+  // request has no deadline.
+  std::optional<absl::Duration> RemainingGetBidsBudget() const;
   // Handles recording the fetched bid to state.
   // This is called by the grpc buyer client when the request is finished,
   // and will subsequently call update pending bids state which will update how
@@ -225,9 +309,38 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
 
   // Calls FetchScoringSignals or calls Finish on the reactor depending on
   // if there were any successful bids or if the request was cancelled by the
-  // client.
+  // client. With pipelined scoring signals fetch, this waits for the scoring
+  // signals of all buyers and then uses them instead of fetching them.
   void OnAllBidsDone(bool any_successful_bids);
 
+  // Initiates the asynchronous fetch of the scoring signals for the bids of a
+  // single buyer, so that the key value lookup overlaps with the pending
+  // GetBids calls of the other buyers.
+  void FetchScoringSignalsForBuyer(
+      const std::string& buyer_ig_owner,
+      std::unique_ptr<GetBidsResponse::GetBidsRawResponse>& response);
+
+  // Records the scoring signals fetched for a single buyer and resumes
+  // OnAllBidsDone if the bids and signals of all buyers are done.
+  void OnFetchScoringSignalsForBuyerDone(
+      absl::StatusOr<std::unique_ptr<ScoringSignals>> result);
+
+  // Returns whether the scoring signals fetched for all buyers are available.
+  // If not, the last pending fetch calls OnAllBidsDone again.
+  bool AllBuyerScoringSignalsFetched(bool any_successful_bids);
+
+  // Merges the scoring signals fetched for each buyer. Returns the first
+  // error if any of the fetches failed.
+  absl::StatusOr<std::unique_ptr<ScoringSignals>> MergeBuyerScoringSignals();
+
+  // Calls the scoring signals provider for the bids in `buyer_bids_map` and
+  // records the KV request metrics.
+  void GetScoringSignals(
+      const BuyerBidsResponseMap& buyer_bids_map,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+          on_done);
+
   // Initiates the asynchronous grpc request to fetch scoring signals
   // from the key value server. The ad_render_url in the GetBid response from
   // each Buyer is used as a key for the Seller Key-Value lookup.
@@ -269,19 +382,26 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   void OnDone() override;
 
   // Abandons the entire SelectAdRequest. Called by the grpc library if the
-  // client cancels the request.
+  // client cancels the request. Cancels the outstanding GetBids and ScoreAds
+  // calls, which then complete with errors.
   void OnCancel() override;
 
   // Finishes the RPC call with a status.
   void FinishWithStatus(const grpc::Status& status);
 
+  // Logs the critical path of the request, if tracked, as metrics and, for
+  // consented requests, as a structured record.
+  void LogCriticalPath();
+
   // Reports an error to the error accumulator object.
   void ReportError(
       log::ParamWithSourceLoc<ErrorVisibility> error_visibility_with_loc,
       const std::string& msg, ErrorCode error_code);
 
+  // Builds the scoring input of a bid, moving the ad, render URL and ad
+  // components out of `input` instead of copying them.
   ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata BuildAdWithBidMetadata(
-      const AdWithBid& input, absl::string_view interest_group_owner);
+      AdWithBid& input, absl::string_view interest_group_owner);
 
   // Initialization
   grpc::CallbackServerContext* context_;
@@ -292,6 +412,8 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   AuctionResult::Error error_;
   const ClientRegistry& clients_;
   const TrustedServersConfigClient& config_client_;
+  // Runtime config of this request, unchanged by later config updates.
+  const std::shared_ptr<const SellerFrontEndConfig> config_;
   // Scope for current auction (single seller, top level or component)
   const AuctionScope auction_scope_;
 
@@ -301,6 +423,11 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Metadata to be sent to buyers.
   RequestMetadata buyer_metadata_;
 
+  // Cancellation of the request by the client, shared with the GetBids and
+  // ScoreAds calls made for it.
+  std::shared_ptr<RequestCancellation> cancellation_ =
+      std::make_shared<RequestCancellation>();
+
   // Get Bid Results
   // Multiple threads can be writing buyer bid responses so this map
   // gets locked when async_task_tracker_ updates the state of pending bids.
@@ -308,18 +435,45 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // completed.
   BuyerBidsResponseMap shared_buyer_bids_map_;
 
+  // Whether all the bids of a buyer were rejected for their currency. Guarded
+  // by async_task_tracker_ like shared_buyer_bids_map_.
+  bool any_buyer_bids_rejected_for_currency_ = false;
+
   // Benchmarking Logger to benchmark the service
   std::unique_ptr<BenchmarkingLogger> benchmarking_logger_;
 
+  // Distributed trace of a sampled share of the requests, from the start of
+  // the reactor so that it covers the decryption.
+  RequestTrace trace_;
+  // Times the phases of a sampled share of the requests.
+  RequestPhaseTracer phase_tracer_;
+  // Attributes the latency of the requests whose phases are timed to their
+  // stages and buyers.
+  AuctionCriticalPath critical_path_{phase_tracer_.enabled()};
+
+  MemoryReservation memory_reservation_;
+
   // Encryption context needed throughout the lifecycle of the request.
   std::unique_ptr<OhttpHpkeDecryptedMessage> decrypted_request_;
 
   server_common::log::ContextImpl log_context_;
+  // Dumps of the protos of the request, formatted off the request thread.
+  DeferredDebugLog debug_log_;
+
+  // Codec the client compressed the buyer inputs with, gzip unless the
+  // request says otherwise.
+  const CompressionCodec* buyer_input_codec_ = *GetCompressionCodec(kGzipCodec);
 
   // Decompressed and decoded buyer inputs.
   absl::StatusOr<absl::flat_hash_map<absl::string_view, BuyerInput>>
       buyer_inputs_;
 
+  // Interest groups of the buyer input of each buyer solicited for bids,
+  // indexed by name once their GetBids request is built. Read once all the
+  // bids are in, to find the interest groups of the bids.
+  absl::flat_hash_map<std::string, InterestGroupIndexByName>
+      interest_group_indexes_;
+
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::SfeContext> metric_context_;
 
@@ -346,6 +500,43 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Temporary workaround for compliance, will be removed (b/308032414).
   const int max_buyers_solicited_;
 
+  // Delay after which a GetBids request is hedged. Zero if disabled.
+  const absl::Duration get_bid_hedge_delay_;
+
+  // Time reserved for scoring before the deadline of the request.
+  const absl::Duration get_bid_deadline_reserve_;
+
+  // Indicates whether scoring signals are fetched for each buyer as soon as
+  // its bids arrive instead of once for all buyers after all bids are done.
+  const bool enable_pipelined_scoring_signals_fetch_;
+
+  // Max number of bids of a buyer, and of all the buyers, that are scored.
+  // No limit if 0.
+  const int max_bids_per_buyer_;
+  const int max_bids_per_auction_;
+
+  // State of the pipelined scoring signals fetch.
+  absl::Mutex buyer_scoring_signals_mu_;
+  // Number of scoring signals fetches that did not complete yet.
+  int pending_buyer_scoring_signals_fetches_
+      ABSL_GUARDED_BY(buyer_scoring_signals_mu_) = 0;
+  // Set with the outcome of the GetBids calls once all bids are done.
+  std::optional<bool> any_successful_bids_
+      ABSL_GUARDED_BY(buyer_scoring_signals_mu_);
+  // Scoring signals fetched for each buyer.
+  std::vector<absl::StatusOr<std::unique_ptr<ScoringSignals>>>
+      buyer_scoring_signals_ ABSL_GUARDED_BY(buyer_scoring_signals_mu_);
+
+  // Bid thrown out for being under the bid floor, with a debug loss URL.
+  struct BidBelowFloor {
+    std::string ig_owner;
+    std::string ig_name;
+    std::string debug_loss_url;
+  };
+  absl::Mutex bids_below_floor_mu_;
+  std::vector<BidBelowFloor> bids_below_floor_
+      ABSL_GUARDED_BY(bids_below_floor_mu_);
+
  private:
   // Keeps track of how many buyer bids were expected initially and how many
   // were erroneous. If all bids ended up in an error state then that should be
@@ -358,7 +549,7 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
                                        const absl::Status& status,
                                        absl::string_view buyer = "");
 
-  absl::Time start_ = absl::Now();
+  CycleTimer request_timer_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
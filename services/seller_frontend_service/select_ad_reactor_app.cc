@@ -18,7 +18,6 @@
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "services/common/compression/gzip.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/seller_frontend_service/util/framing_utils.h"
 #include "services/seller_frontend_service/util/proto_mapping_util.h"
@@ -29,8 +28,6 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 using BiddingGroupsMap =
     ::google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>;
-using EncodedBuyerInputs = ::google::protobuf::Map<std::string, std::string>;
-using DecodedBuyerInputs = absl::flat_hash_map<absl::string_view, BuyerInput>;
 using ReportErrorSignature = std::function<void(
     log::ParamWithSourceLoc<ErrorVisibility> error_visibility_with_loc,
     const std::string& msg, ErrorCode error_code)>;
@@ -79,7 +76,8 @@ absl::StatusOr<std::string> SelectAdReactorForApp::GetNonEncryptedResponse(
   AuctionResult auction_result;
   if (high_score.has_value()) {
     auction_result = AdScoreToAuctionResult(
-        high_score, GetBiddingGroups(shared_buyer_bids_map_, *buyer_inputs_),
+        high_score,
+        GetBiddingGroups(shared_buyer_bids_map_, interest_group_indexes_),
         error, auction_scope_, request_->auction_config().seller(),
         protected_auction_input_,
         request_->auction_config().top_level_seller());
@@ -93,20 +91,16 @@ absl::StatusOr<std::string> SelectAdReactorForApp::GetNonEncryptedResponse(
   PS_VLOG(kPlain, log_context_) << "AuctionResult:\n"
                                 << auction_result.ShortDebugString();
 
-  // Serialized the data to bytes array.
-  std::string serialized_result = auction_result.SerializeAsString();
-
-  // Compress the bytes array before framing it with pre-amble and padding.
-  absl::StatusOr<std::string> compressed_data = GzipCompress(serialized_result);
-  if (!compressed_data.ok()) {
+  // Compress the serialized result into a buffer framed with pre-amble and
+  // padding.
+  absl::StatusOr<std::string> framed_data =
+      CompressAndFrameResponse(auction_result.SerializeAsString());
+  if (!framed_data.ok()) {
     std::string error_str = "Failed to compress the serialized response data\n";
     FinishWithStatus(grpc::Status(grpc::INTERNAL, error_str));
     return absl::InternalError("");
   }
-
-  return server_common::EncodeResponsePayload(
-      server_common::CompressionType::kGzip, *compressed_data,
-      GetEncodedDataSize(compressed_data->size()));
+  return framed_data;
 }
 
 ProtectedAudienceInput SelectAdReactorForApp::GetDecodedProtectedAudienceInput(
@@ -129,32 +123,29 @@ ProtectedAuctionInput SelectAdReactorForApp::GetDecodedProtectedAuctionInput(
       error_accumulator_);
 }
 
-DecodedBuyerInputs SelectAdReactorForApp::GetDecodedBuyerinputs(
-    const EncodedBuyerInputs& encoded_buyer_inputs) {
-  DecodedBuyerInputs decoded_buyer_inputs;
-  for (const auto& [owner, compressed_buyer_input] : encoded_buyer_inputs) {
-    absl::StatusOr<std::string> decompressed_buyer_input =
-        GzipDecompress(compressed_buyer_input);
-    if (!decompressed_buyer_input.ok()) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE,
-                  absl::StrFormat(kBadCompressedBuyerInput, owner),
-                  ErrorCode::CLIENT_SIDE);
-      continue;
-    }
-
-    BuyerInput buyer_input;
-    if (!buyer_input.ParseFromArray(decompressed_buyer_input->data(),
-                                    decompressed_buyer_input->size())) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE,
-                  absl::StrFormat(kBadBuyerInputProto, owner),
-                  ErrorCode::CLIENT_SIDE);
-      continue;
-    }
-
-    decoded_buyer_inputs.insert({owner, std::move(buyer_input)});
+std::optional<BuyerInput> SelectAdReactorForApp::GetDecodedBuyerInput(
+    absl::string_view owner, absl::string_view encoded_buyer_input,
+    ErrorAccumulator& error_accumulator) {
+  std::string decompressed_buyer_input;
+  if (!buyer_input_codec_->Decompress(encoded_buyer_input,
+                                      decompressed_buyer_input)
+           .ok()) {
+    error_accumulator.ReportError(
+        ErrorVisibility::CLIENT_VISIBLE,
+        absl::StrFormat(kBadCompressedBuyerInput, owner),
+        ErrorCode::CLIENT_SIDE);
+    return std::nullopt;
   }
 
-  return decoded_buyer_inputs;
+  BuyerInput buyer_input;
+  if (!buyer_input.ParseFromArray(decompressed_buyer_input.data(),
+                                  decompressed_buyer_input.size())) {
+    error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE,
+                                  absl::StrFormat(kBadBuyerInputProto, owner),
+                                  ErrorCode::CLIENT_SIDE);
+    return std::nullopt;
+  }
+  return buyer_input;
 }
 
 void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBuyerInput(
@@ -215,7 +206,7 @@ void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBuyerInput(
 
 std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
 SelectAdReactorForApp::CreateGetBidsRequest(const std::string& buyer_ig_owner,
-                                            const BuyerInput& buyer_input) {
+                                            BuyerInput& buyer_input) {
   auto request =
       SelectAdReactor::CreateGetBidsRequest(buyer_ig_owner, buyer_input);
   MayPopulateProtectedAppSignalsBuyerInput(buyer_ig_owner, request.get());
@@ -231,20 +222,20 @@ SelectAdReactorForApp::CreateScoreAdsRequest() {
 
 ProtectedAppSignalsAdWithBidMetadata
 SelectAdReactorForApp::BuildProtectedAppSignalsAdWithBidMetadata(
-    absl::string_view buyer_owner, const ProtectedAppSignalsAdWithBid& input) {
+    absl::string_view buyer_owner, ProtectedAppSignalsAdWithBid& input) {
   ProtectedAppSignalsAdWithBidMetadata result;
   if (input.has_ad()) {
-    *result.mutable_ad() = input.ad();
+    result.mutable_ad()->Swap(input.mutable_ad());
   }
   result.set_bid(input.bid());
-  result.set_render(input.render());
+  result.set_render(std::move(*input.mutable_render()));
   result.set_modeling_signals(input.modeling_signals());
   result.set_ad_cost(input.ad_cost());
   result.set_owner(buyer_owner);
   result.set_bid_currency(input.bid_currency());
-  result.set_egress_payload(input.egress_payload());
+  result.set_egress_payload(std::move(*input.mutable_egress_payload()));
   result.set_temporary_unlimited_egress_payload(
-      input.temporary_unlimited_egress_payload());
+      std::move(*input.mutable_temporary_unlimited_egress_payload()));
   return result;
 }
 
@@ -259,11 +250,12 @@ void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBids(
   PS_VLOG(kNoisyInfo, log_context_)
       << "Protected App signals, may add protected app "
          "signals bids to score ads request";
-  for (const auto& [buyer_owner, get_bid_response] : shared_buyer_bids_map_) {
+  for (auto& [buyer_owner, get_bid_response] : shared_buyer_bids_map_) {
     for (int i = 0; i < get_bid_response->protected_app_signals_bids_size();
          i++) {
       auto ad_with_bid_metadata = BuildProtectedAppSignalsAdWithBidMetadata(
-          buyer_owner, get_bid_response->protected_app_signals_bids().at(i));
+          buyer_owner,
+          *get_bid_response->mutable_protected_app_signals_bids(i));
       score_ads_raw_request->mutable_protected_app_signals_ad_bids()->Add(
           std::move(ad_with_bid_metadata));
     }
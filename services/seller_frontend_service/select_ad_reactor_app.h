@@ -51,9 +51,9 @@ class SelectAdReactorForApp : public SelectAdReactor {
   ProtectedAuctionInput GetDecodedProtectedAuctionInput(
       absl::string_view encoded_data) override;
 
-  absl::flat_hash_map<absl::string_view, BuyerInput> GetDecodedBuyerinputs(
-      const google::protobuf::Map<std::string, std::string>&
-          encoded_buyer_inputs) override;
+  std::optional<BuyerInput> GetDecodedBuyerInput(
+      absl::string_view owner, absl::string_view encoded_buyer_input,
+      ErrorAccumulator& error_accumulator) override;
 
   // Protected App Signals (PAS) related methods follow.
 
@@ -69,16 +69,17 @@ class SelectAdReactorForApp : public SelectAdReactor {
   // specified PAS, then the created GetBid request will have separate PA and
   // PAS buyer inputs populated properly.
   std::unique_ptr<GetBidsRequest::GetBidsRawRequest> CreateGetBidsRequest(
-      const std::string& buyer_ig_owner,
-      const BuyerInput& buyer_input) override;
+      const std::string& buyer_ig_owner, BuyerInput& buyer_input) override;
 
   // Populates PAS bids in the scoring request to be sent to auction service.
   void MayPopulateProtectedAppSignalsBids(
       ScoreAdsRequest::ScoreAdsRawRequest* score_ads_raw_request);
 
+  // Builds the scoring input of a PAS bid, moving the ad, render URL and
+  // egress payloads out of `input` instead of copying them.
   ScoreAdsRequest::ScoreAdsRawRequest::ProtectedAppSignalsAdWithBidMetadata
   BuildProtectedAppSignalsAdWithBidMetadata(
-      absl::string_view buyer, const ProtectedAppSignalsAdWithBid& input);
+      absl::string_view buyer, ProtectedAppSignalsAdWithBid& input);
 
   std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> CreateScoreAdsRequest()
       override;
@@ -57,4 +57,10 @@ SelectAdReactorInvalidClient::GetDecodedBuyerinputs(
   return {};
 }
 
+std::optional<BuyerInput> SelectAdReactorInvalidClient::GetDecodedBuyerInput(
+    absl::string_view owner, absl::string_view encoded_buyer_input,
+    ErrorAccumulator& error_accumulator) {
+  return std::nullopt;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -59,6 +59,10 @@ class SelectAdReactorInvalidClient : public SelectAdReactor {
       const google::protobuf::Map<std::string, std::string>&
           encoded_buyer_inputs) override;
 
+  std::optional<BuyerInput> GetDecodedBuyerInput(
+      absl::string_view owner, absl::string_view encoded_buyer_input,
+      ErrorAccumulator& error_accumulator) override;
+
   ClientType client_type_;
 };
 
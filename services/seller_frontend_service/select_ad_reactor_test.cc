@@ -17,6 +17,7 @@
 
 #include <gmock/gmock-matchers.h>
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -34,6 +35,7 @@
 #include "absl/flags/flag.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/time/time.h"
@@ -59,6 +61,7 @@ inline constexpr absl::string_view kProtectedAudienceInput =
 using ::google::protobuf::TextFormat;
 using ::testing::_;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 using ::testing::Pointee;
 using ::testing::Property;
 using ::testing::Return;
@@ -110,8 +113,7 @@ class SellerFrontEndServiceTest : public ::testing::Test {
     server_common::telemetry::TelemetryConfig config_proto;
     config_proto.set_mode(server_common::telemetry::TelemetryConfig::PROD);
     metric::MetricContextMap<SelectAdRequest>(
-        server_common::telemetry::BuildDependentConfig(config_proto))
-        ->Get(&request_);
+        server_common::telemetry::BuildDependentConfig(config_proto));
   }
 
   void SetupRequest(int num_buyers, bool set_buyer_egid = false,
@@ -257,6 +259,59 @@ TYPED_TEST(SellerFrontEndServiceTest, FetchesBidsFromAllBuyers) {
       RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
 }
 
+TYPED_TEST(SellerFrontEndServiceTest, DecodesBuyerInputsOnExecutor) {
+  this->SetupRequest(/*num_buyers=*/3);
+  ScoringAsyncClientMock scoring_client;
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals> scoring_provider;
+
+  // All but one of the buyers are decoded on the executor.
+  MockExecutor executor;
+  EXPECT_CALL(executor, Run)
+      .Times(2)
+      .WillRepeatedly(
+          [](absl::AnyInvocable<void()> closure) { std::move(closure)(); });
+
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  ErrorAccumulator error_accumulator;
+  for (const auto& buyer_ig_owner :
+       this->request_.auction_config().buyer_list()) {
+    BuyerInput buyer_input = DecodeBuyerInput(
+        buyer_ig_owner,
+        this->protected_auction_input_.buyer_input().at(buyer_ig_owner),
+        error_accumulator);
+    ASSERT_FALSE(error_accumulator.HasErrors());
+    EXPECT_CALL(buyer_clients, Get(buyer_ig_owner))
+        .WillOnce([buyer_input](absl::string_view hostname) {
+          auto buyer = std::make_shared<BuyerFrontEndAsyncClientMock>();
+          EXPECT_CALL(*buyer, ExecuteInternal)
+              .WillOnce([buyer_input](
+                            std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+                                get_bids_request,
+                            const RequestMetadata& metadata,
+                            GetBidDoneCallback on_done,
+                            absl::Duration timeout) {
+                EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+                    buyer_input, get_bids_request->buyer_input()));
+                return absl::OkStatus();
+              });
+          return buyer;
+        });
+  }
+
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  ClientRegistry clients{scoring_provider,
+                         scoring_client,
+                         buyer_clients,
+                         this->key_fetcher_manager_,
+                         /* crypto_client = */ nullptr,
+                         std::move(async_reporter),
+                         &executor};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
 TYPED_TEST(SellerFrontEndServiceTest,
            FetchesThreeBidsGivenThreeBuyersWhenLimitUpped) {
   // Should only serve two buyers despite having 3 in request.
@@ -580,6 +635,108 @@ TYPED_TEST(SellerFrontEndServiceTest,
       RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
 }
 
+TYPED_TEST(SellerFrontEndServiceTest,
+           FetchesScoringSignalsForBidsInBuyerCurrencyOnly) {
+  this->SetupRequest(/*num_buyers=*/2, /*set_buyer_egid=*/false,
+                     /*set_seller_egid=*/false, /*seller_currency=*/"",
+                     /*buyer_currency=*/kUsdIsoCode);
+  // Scoring Client
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal).Times(0);
+
+  absl::flat_hash_map<std::string, std::string> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  // Buyer Clients
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  BuyerBidsResponseMap expected_buyer_bids;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    AdUrl url = buyer_to_ad_url.at(buyer);
+    auto get_bids_response = BuildGetBidsResponseWithSingleAd(
+        url, "testIgName", 1.9, false, kDefaultNumAdComponents, kUsdIsoCode);
+    expected_buyer_bids.try_emplace(
+        buyer, std::make_unique<GetBidsResponse::GetBidsRawResponse>(
+                   get_bids_response));
+    // The bids in another currency are thrown out before fetching signals,
+    // wherever they are in the response.
+    AdWithBid* rejected_bid = get_bids_response.add_bids();
+    *rejected_bid = get_bids_response.bids(0);
+    rejected_bid->set_render(absl::StrCat(url, "/rejected"));
+    rejected_bid->set_bid_currency(kEurosIsoCode);
+    get_bids_response.mutable_bids()->SwapElements(0, 1);
+    SetupBuyerClientMock(buyer, buyer_clients, get_bids_response);
+  }
+
+  // Scoring Signals Provider
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  SetupScoringProviderMock(
+      /*provider=*/scoring_signals_provider,
+      /*expected_buyer_bids=*/expected_buyer_bids,
+      /*scoring_signals_value=*/std::nullopt);
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  // Client Registry
+  ClientRegistry clients{
+      scoring_signals_provider,      scoring_client,           buyer_clients,
+      this->key_fetcher_manager_,
+      /* crypto_client = */ nullptr, std::move(async_reporter)};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
+TYPED_TEST(SellerFrontEndServiceTest,
+           FetchesScoringSignalsForTopBidsOfBuyerOnly) {
+  this->SetupRequest(/*num_buyers=*/2);
+  this->config_.SetFlagForTest("1", MAX_BIDS_PER_BUYER);
+  // Scoring Client
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal).Times(0);
+
+  absl::flat_hash_map<std::string, std::string> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  // Buyer Clients
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  BuyerBidsResponseMap expected_buyer_bids;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    AdUrl url = buyer_to_ad_url.at(buyer);
+    auto get_bids_response =
+        BuildGetBidsResponseWithSingleAd(url, "testIgName", 1.9, false);
+    expected_buyer_bids.try_emplace(
+        buyer, std::make_unique<GetBidsResponse::GetBidsRawResponse>(
+                   get_bids_response));
+    // The lower bid above the budget is dropped before fetching signals.
+    AdWithBid* dropped_bid = get_bids_response.add_bids();
+    *dropped_bid = get_bids_response.bids(0);
+    dropped_bid->set_render(absl::StrCat(url, "/dropped"));
+    dropped_bid->set_bid(0.5);
+    get_bids_response.mutable_bids()->SwapElements(0, 1);
+    SetupBuyerClientMock(buyer, buyer_clients, get_bids_response);
+  }
+
+  // Scoring Signals Provider
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  SetupScoringProviderMock(
+      /*provider=*/scoring_signals_provider,
+      /*expected_buyer_bids=*/expected_buyer_bids,
+      /*scoring_signals_value=*/std::nullopt);
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  // Client Registry
+  ClientRegistry clients{
+      scoring_signals_provider,      scoring_client,           buyer_clients,
+      this->key_fetcher_manager_,
+      /* crypto_client = */ nullptr, std::move(async_reporter)};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
 /**
  * This test also tests that specifying a currency on an AdWithBid, when no
  * buyer or seller currency is specified, breaks nothing.
@@ -725,6 +882,158 @@ TYPED_TEST(SellerFrontEndServiceTest, DoesNotScoreAdsAfterGettingEmptySignals) {
   EXPECT_TRUE(auction_result.is_chaff());
 }
 
+TYPED_TEST(SellerFrontEndServiceTest,
+           PipelinedFetchScoresAdsWithSignalsOfAllBuyers) {
+  this->config_.SetFlagForTest(kTrue, ENABLE_PIPELINED_SCORING_SIGNALS_FETCH);
+  this->SetupRequest(/*num_buyers=*/2);
+  absl::flat_hash_map<BuyerHostname, AdUrl> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+
+  // Buyer Clients
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    SetupBuyerClientMock(
+        buyer, buyer_clients,
+        BuildGetBidsResponseWithSingleAd(buyer_to_ad_url.at(buyer)));
+  }
+
+  // Scoring signals are fetched separately for the bids of each buyer.
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  EXPECT_CALL(scoring_signals_provider, Get)
+      .Times(2)
+      .WillRepeatedly(
+          [](const ScoringSignalsRequest& scoring_signals_request,
+             absl::AnyInvocable<
+                 void(absl::StatusOr<std::unique_ptr<ScoringSignals>>,
+                      GetByteSize) &&>
+                 on_done,
+             absl::Duration timeout) {
+            EXPECT_EQ(scoring_signals_request.buyer_bids_map_.size(), 1);
+            const auto& get_bids_response =
+                *scoring_signals_request.buyer_bids_map_.begin()->second;
+            auto scoring_signals = std::make_unique<ScoringSignals>();
+            scoring_signals->scoring_signals = std::make_unique<std::string>(
+                absl::StrCat(R"JSON({"renderUrls":{")JSON",
+                             get_bids_response.bids(0).render(),
+                             R"JSON(":{"someKey":"someValue"}}})JSON"));
+            std::move(on_done)(std::move(scoring_signals), GetByteSize());
+          });
+
+  // Scoring Client
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .WillOnce([&buyer_to_ad_url](
+                    std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
+                        score_ads_raw_request,
+                    const RequestMetadata& metadata,
+                    ScoreAdsDoneCallback on_done, absl::Duration timeout) {
+        EXPECT_EQ(score_ads_raw_request->ad_bids_size(), 2);
+        for (const auto& [unused, url] : buyer_to_ad_url) {
+          EXPECT_THAT(score_ads_raw_request->scoring_signals(), HasSubstr(url));
+        }
+        return absl::OkStatus();
+      });
+
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  // Client Registry
+  ClientRegistry clients{
+      scoring_signals_provider,      scoring_client,           buyer_clients,
+      this->key_fetcher_manager_,
+      /* crypto_client = */ nullptr, std::move(async_reporter)};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
+TYPED_TEST(SellerFrontEndServiceTest, UsesFirstResponseOfHedgedGetBids) {
+  this->config_.SetFlagForTest("10", GET_BID_HEDGE_DELAY_MS);
+  this->SetupRequest(/*num_buyers=*/1);
+  absl::flat_hash_map<BuyerHostname, AdUrl> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  const std::string buyer =
+      this->protected_auction_input_.buyer_input().begin()->first;
+  GetBidsResponse::GetBidsRawResponse get_bids_response =
+      BuildGetBidsResponseWithSingleAd(buyer_to_ad_url.at(buyer));
+
+  // The executor sends the hedged request right away, so the hedged request
+  // completes while the first request is still pending.
+  MockExecutor executor;
+  EXPECT_CALL(executor, RunAfter(absl::Milliseconds(10), _))
+      .WillOnce([](absl::Duration duration,
+                   absl::AnyInvocable<void()> closure) {
+        std::move(closure)();
+        return server_common::TaskId();
+      });
+  GetBidDoneCallback pending_on_done;
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  EXPECT_CALL(buyer_clients, Get(buyer))
+      .WillOnce([&get_bids_response, &pending_on_done](absl::string_view) {
+        auto buyer_client = std::make_shared<BuyerFrontEndAsyncClientMock>();
+        EXPECT_CALL(*buyer_client, ExecuteInternal)
+            .WillOnce([&get_bids_response](
+                          std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+                              get_bids_request,
+                          const RequestMetadata& metadata,
+                          GetBidDoneCallback on_done, absl::Duration timeout) {
+              std::move(on_done)(
+                  std::make_unique<GetBidsResponse::GetBidsRawResponse>(
+                      get_bids_response));
+              return absl::OkStatus();
+            })
+            .WillOnce([&pending_on_done](
+                          std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+                              get_bids_request,
+                          const RequestMetadata& metadata,
+                          GetBidDoneCallback on_done, absl::Duration timeout) {
+              pending_on_done = std::move(on_done);
+              return absl::OkStatus();
+            });
+        return buyer_client;
+      });
+
+  BuyerBidsResponseMap expected_buyer_bids;
+  expected_buyer_bids.try_emplace(
+      buyer,
+      std::make_unique<GetBidsResponse::GetBidsRawResponse>(get_bids_response));
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  SetupScoringProviderMock(
+      scoring_signals_provider, expected_buyer_bids,
+      R"JSON({"someAdRenderUrl":{"someKey":"someValue"}})JSON");
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .WillOnce([](std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
+                       score_ads_raw_request,
+                   const RequestMetadata& metadata,
+                   ScoreAdsDoneCallback on_done, absl::Duration timeout) {
+        EXPECT_EQ(score_ads_raw_request->ad_bids_size(), 1);
+        return absl::OkStatus();
+      });
+
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  // Client Registry
+  ClientRegistry clients{scoring_signals_provider,
+                         scoring_client,
+                         buyer_clients,
+                         this->key_fetcher_manager_,
+                         /* crypto_client = */ nullptr,
+                         std::move(async_reporter),
+                         &executor};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+
+  // The late response of the first request is dropped.
+  ASSERT_TRUE(pending_on_done);
+  std::move(pending_on_done)(absl::DeadlineExceededError("Too late"));
+}
+
 TYPED_TEST(SellerFrontEndServiceTest, ReturnsWinningAdAfterScoring) {
   std::string decision_logic = "function scoreAds(){}";
 
@@ -1354,6 +1663,169 @@ TYPED_TEST(SellerFrontEndServiceTest, PerformsDebugReportingAfterScoring) {
   reporting_count.Wait();
 }
 
+TYPED_TEST(SellerFrontEndServiceTest, FiltersBidsBelowFloorBeforeScoring) {
+  this->SetupRequest(/*num_buyers=*/2);
+  this->request_.mutable_auction_config()->set_bid_floor(1.0);
+  absl::flat_hash_map<std::string, std::string> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  // Buyer Clients
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  BuyerBidsResponseMap expected_buyer_bids;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    auto get_bid_response = BuildGetBidsResponseWithSingleAd(
+        buyer_to_ad_url.at(buyer), "testIgName", 1.9, true);
+    expected_buyer_bids.try_emplace(
+        buyer, std::make_unique<GetBidsResponse::GetBidsRawResponse>(
+                   get_bid_response));
+    AdWithBid* bid_below_floor = get_bid_response.add_bids();
+    *bid_below_floor = BuildNewAdWithBid(buyer_to_ad_url.at(buyer),
+                                         "lowIgName", 0.5, true);
+    bid_below_floor->mutable_debug_report_urls()->set_auction_debug_loss_url(
+        "https://test.com/debugLoss?reason=${rejectReason}");
+    SetupBuyerClientMock(buyer, buyer_clients, get_bid_response);
+  }
+
+  // Scoring signal provider
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  // The bids below the floor are not fetched scoring signals for.
+  std::string scoring_signals_value =
+      R"JSON({"someAdRenderUrl":{"someKey":"someValue"}})JSON";
+  SetupScoringProviderMock(scoring_signals_provider, expected_buyer_bids,
+                           scoring_signals_value);
+
+  // Scoring Client
+  ScoringAsyncClientMock scoring_client;
+  absl::Notification scoring_done;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .Times(1)
+      .WillOnce(
+          [&scoring_done](
+              std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> request,
+              const RequestMetadata& metadata, ScoreAdsDoneCallback on_done,
+              absl::Duration timeout) {
+            ScoreAdsResponse::ScoreAdsRawResponse response;
+            EXPECT_EQ(request->ad_bids_size(), 2);
+            for (const auto& bid : request->ad_bids()) {
+              EXPECT_EQ(bid.interest_group_name(), "testIgName");
+              AdScore& score = *response.mutable_ad_score();
+              score.set_render(bid.render());
+              score.set_desirability(1);
+              score.set_buyer_bid(bid.bid());
+              score.set_interest_group_name(bid.interest_group_name());
+              score.set_interest_group_owner(bid.interest_group_owner());
+            }
+            std::move(on_done)(
+                std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>(
+                    response));
+            scoring_done.Notify();
+            return absl::OkStatus();
+          });
+
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  absl::BlockingCounter reporting_count(4);
+  std::atomic<int> num_below_floor_reports = 0;
+  EXPECT_CALL(*async_reporter, DoReport)
+      .Times(4)
+      .WillRepeatedly(
+          [&reporting_count, &num_below_floor_reports](
+              const HTTPRequest& reporting_request,
+              absl::AnyInvocable<void(absl::StatusOr<absl::string_view>)&&>
+                  done_callback) {
+            if (reporting_request.url ==
+                "https://test.com/debugLoss?reason=bid-below-auction-floor") {
+              ++num_below_floor_reports;
+            }
+            reporting_count.DecrementCount();
+          });
+
+  // Client Registry
+  ClientRegistry clients{
+      scoring_signals_provider,      scoring_client,           buyer_clients,
+      this->key_fetcher_manager_,
+      /* crypto_client = */ nullptr, std::move(async_reporter)};
+
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+  scoring_done.WaitForNotification();
+  reporting_count.Wait();
+  EXPECT_EQ(num_below_floor_reports, 2);
+}
+
+TYPED_TEST(SellerFrontEndServiceTest, AppliesBidFloorOfBuyerInItsCurrency) {
+  this->SetupRequest(/*num_buyers=*/2, /*set_buyer_egid=*/false,
+                     /*set_seller_egid=*/false, /*seller_currency=*/kUsdIsoCode,
+                     /*buyer_currency=*/kEurosIsoCode);
+  // The floor of the seller is in another currency than the bids.
+  this->request_.mutable_auction_config()->set_bid_floor(100.0);
+  for (auto& [unused, per_buyer_config] :
+       *this->request_.mutable_auction_config()->mutable_per_buyer_config()) {
+    per_buyer_config.set_bid_floor(1.0);
+  }
+  absl::flat_hash_map<std::string, std::string> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  // Buyer Clients
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  BuyerBidsResponseMap expected_buyer_bids;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    auto get_bid_response = BuildGetBidsResponseWithSingleAd(
+        buyer_to_ad_url.at(buyer), "testIgName", 1.9, false,
+        kDefaultNumAdComponents, kEurosIsoCode);
+    expected_buyer_bids.try_emplace(
+        buyer, std::make_unique<GetBidsResponse::GetBidsRawResponse>(
+                   get_bid_response));
+    *get_bid_response.add_bids() = BuildNewAdWithBid(
+        buyer_to_ad_url.at(buyer), "lowIgName", 0.5, false,
+        kDefaultNumAdComponents, kEurosIsoCode);
+    SetupBuyerClientMock(buyer, buyer_clients, get_bid_response);
+  }
+
+  // Scoring signal provider
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  std::string scoring_signals_value =
+      R"JSON({"someAdRenderUrl":{"someKey":"someValue"}})JSON";
+  SetupScoringProviderMock(scoring_signals_provider, expected_buyer_bids,
+                           scoring_signals_value);
+
+  // Scoring Client
+  ScoringAsyncClientMock scoring_client;
+  absl::Notification scoring_done;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .Times(1)
+      .WillOnce(
+          [&scoring_done](
+              std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> request,
+              const RequestMetadata& metadata, ScoreAdsDoneCallback on_done,
+              absl::Duration timeout) {
+            EXPECT_EQ(request->ad_bids_size(), 2);
+            for (const auto& bid : request->ad_bids()) {
+              EXPECT_EQ(bid.interest_group_name(), "testIgName");
+            }
+            std::move(on_done)(
+                std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>());
+            scoring_done.Notify();
+            return absl::OkStatus();
+          });
+
+  // Client Registry
+  ClientRegistry clients{
+      scoring_signals_provider,      scoring_client,           buyer_clients,
+      this->key_fetcher_manager_,
+      /* crypto_client = */ nullptr,
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>())};
+
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+  scoring_done.WaitForNotification();
+}
+
 TYPED_TEST(SellerFrontEndServiceTest,
            DoesntPerformDebugReportingAfterScoringFails) {
   this->SetupRequest(/*num_buyers=*/2);
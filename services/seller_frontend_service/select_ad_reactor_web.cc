@@ -20,7 +20,6 @@
 
 #include "absl/functional/bind_front.h"
 #include "absl/strings/str_format.h"
-#include "services/common/compression/gzip.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/seller_frontend_service/util/framing_utils.h"
 #include "services/seller_frontend_service/util/proto_mapping_util.h"
@@ -32,8 +31,6 @@ namespace privacy_sandbox::bidding_auction_servers {
 
 using BiddingGroupsMap =
     ::google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>;
-using EncodedBuyerInputs = ::google::protobuf::Map<std::string, std::string>;
-using DecodedBuyerInputs = absl::flat_hash_map<absl::string_view, BuyerInput>;
 using ReportErrorSignature = std::function<void(
     log::ParamWithSourceLoc<ErrorVisibility> error_visibility_with_loc,
     const std::string& msg, ErrorCode error_code)>;
@@ -84,8 +81,8 @@ absl::StatusOr<std::string> SelectAdReactorForWeb::GetNonEncryptedResponse(
         encoded_data,
         EncodeComponent(
             request_->auction_config().top_level_seller(), high_score,
-            GetBiddingGroups(shared_buyer_bids_map_, *buyer_inputs_), error,
-            error_handler));
+            GetBiddingGroups(shared_buyer_bids_map_, interest_group_indexes_),
+            error, error_handler));
     PS_VLOG(kPlain, log_context_) << "AuctionResult:\n" << (decode_lambda());
   } else if (auction_scope_ ==
              AuctionScope::AUCTION_SCOPE_SERVER_COMPONENT_MULTI_SELLER) {
@@ -93,7 +90,8 @@ absl::StatusOr<std::string> SelectAdReactorForWeb::GetNonEncryptedResponse(
     AuctionResult auction_result;
     if (high_score.has_value()) {
       auction_result = AdScoreToAuctionResult(
-          high_score, GetBiddingGroups(shared_buyer_bids_map_, *buyer_inputs_),
+          high_score,
+          GetBiddingGroups(shared_buyer_bids_map_, interest_group_indexes_),
           error, auction_scope_, request_->auction_config().seller(),
           protected_auction_input_,
           request_->auction_config().top_level_seller());
@@ -111,28 +109,27 @@ absl::StatusOr<std::string> SelectAdReactorForWeb::GetNonEncryptedResponse(
     // SINGLE_SELLER or SERVER_TOP_LEVEL Auction
     PS_ASSIGN_OR_RETURN(
         encoded_data,
-        Encode(high_score,
-               GetBiddingGroups(shared_buyer_bids_map_, *buyer_inputs_), error,
-               error_handler));
+        Encode(
+            high_score,
+            GetBiddingGroups(shared_buyer_bids_map_, interest_group_indexes_),
+            error, error_handler));
     PS_VLOG(kPlain, log_context_) << "AuctionResult:\n" << (decode_lambda());
   }
 
   absl::string_view data_to_compress = absl::string_view(
       reinterpret_cast<char*>(encoded_data.data()), encoded_data.size());
 
-  absl::StatusOr<std::string> compressed_data = GzipCompress(data_to_compress);
-  if (!compressed_data.ok()) {
+  absl::StatusOr<std::string> framed_data =
+      CompressAndFrameResponse(data_to_compress);
+  if (!framed_data.ok()) {
     PS_LOG(ERROR, log_context_)
         << "Failed to compress the CBOR serialized data: "
-        << compressed_data.status().message();
+        << framed_data.status().message();
     FinishWithStatus(
         grpc::Status(grpc::INTERNAL, "Failed to compress CBOR data"));
     return absl::InternalError("");
   }
-
-  return server_common::EncodeResponsePayload(
-      server_common::CompressionType::kGzip, *compressed_data,
-      GetEncodedDataSize(compressed_data->size()));
+  return framed_data;
 }
 
 ProtectedAudienceInput SelectAdReactorForWeb::GetDecodedProtectedAudienceInput(
@@ -155,10 +152,16 @@ ProtectedAuctionInput SelectAdReactorForWeb::GetDecodedProtectedAuctionInput(
       error_accumulator_);
 }
 
-DecodedBuyerInputs SelectAdReactorForWeb::GetDecodedBuyerinputs(
-    const EncodedBuyerInputs& encoded_buyer_inputs) {
-  return DecodeBuyerInputs(encoded_buyer_inputs, error_accumulator_,
-                           fail_fast_);
+std::optional<BuyerInput> SelectAdReactorForWeb::GetDecodedBuyerInput(
+    absl::string_view owner, absl::string_view encoded_buyer_input,
+    ErrorAccumulator& error_accumulator) {
+  BuyerInput buyer_input =
+      DecodeBuyerInput(owner, encoded_buyer_input, *buyer_input_codec_,
+                       error_accumulator, fail_fast_);
+  if (fail_fast_ && error_accumulator.HasErrors()) {
+    return std::nullopt;
+  }
+  return buyer_input;
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -52,9 +52,9 @@ class SelectAdReactorForWeb : public SelectAdReactor {
   ProtectedAuctionInput GetDecodedProtectedAuctionInput(
       absl::string_view encoded_data) override;
 
-  absl::flat_hash_map<absl::string_view, BuyerInput> GetDecodedBuyerinputs(
-      const google::protobuf::Map<std::string, std::string>&
-          encoded_buyer_inputs) override;
+  std::optional<BuyerInput> GetDecodedBuyerInput(
+      absl::string_view owner, absl::string_view encoded_buyer_input,
+      ErrorAccumulator& error_accumulator) override;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -68,7 +68,8 @@ void SelectAuctionResultReactor::LogRequestMetrics() {
 }
 
 void SelectAuctionResultReactor::ScoreAds(
-    std::vector<AuctionResult>& component_auction_results) {
+    google::protobuf::RepeatedPtrField<AuctionResult>&
+        component_auction_results) {
   auto raw_request = CreateTopLevelScoreAdsRawRequest(
       request_->auction_config(), protected_auction_input_,
       component_auction_results);
@@ -92,8 +93,7 @@ void SelectAuctionResultReactor::ScoreAds(
       };
   absl::Status execute_result = clients_.scoring.ExecuteInternal(
       std::move(raw_request), {}, std::move(on_scoring_done),
-      absl::Milliseconds(
-          config_client_.GetIntParameter(SCORE_ADS_RPC_TIMEOUT_MS)));
+      config_->score_ads_rpc_timeout);
   if (!execute_result.ok()) {
     LogIfError(
         metric_context_->AccumulateMetric<metric::kSfeErrorCountByErrorCode>(
@@ -164,7 +164,7 @@ void SelectAuctionResultReactor::FinishWithStatus(const grpc::Status& status) {
     LogIfError(
         metric_context_->LogUpDownCounter<metric::kRequestWithWinnerCount>(1));
     LogIfError(metric_context_->LogHistogram<metric::kSfeWithWinnerTimeMs>(
-        static_cast<int>((absl::Now() - start_) / absl::Milliseconds(1))));
+        static_cast<int>(request_timer_.Elapsed() / absl::Milliseconds(1))));
   }
   Finish(status);
 }
@@ -271,14 +271,15 @@ void SelectAuctionResultReactor::Execute() {
   }
 
   // Decrypt and validate AuctionResults.
-  std::vector<AuctionResult> component_auction_results =
+  DecryptedComponentAuctionResults component_auction_results =
       DecryptAndValidateComponentAuctionResults(
           request_, seller_domain_, request_generation_id_,
           *clients_.crypto_client_ptr_, clients_.key_fetcher_manager_,
-          error_accumulator_, log_context_);
+          clients_.executor, error_accumulator_, log_context_);
 
   // No valid auction results found.
-  if (component_auction_results.empty()) {
+  if (component_auction_results.auction_results.empty() &&
+      !component_auction_results.has_chaff) {
     std::string error_msg = error_accumulator_.GetAccumulatedErrorString(
         ErrorVisibility::AD_SERVER_VISIBLE);
     PS_LOG(ERROR, log_context_) << error_msg;
@@ -287,13 +288,13 @@ void SelectAuctionResultReactor::Execute() {
   }
 
   // Keep bidding groups for adding to response.
-  for (auto& car : component_auction_results) {
+  for (auto& car : component_auction_results.auction_results) {
     component_auction_bidding_groups_.push_back(
         std::move(*car.mutable_bidding_groups()));
   }
 
   // Map and Call Auction Service.
-  ScoreAds(component_auction_results);
+  ScoreAds(component_auction_results.auction_results);
 }
 
 void SelectAuctionResultReactor::OnDone() { delete this; }
@@ -312,10 +313,11 @@ SelectAuctionResultReactor::SelectAuctionResultReactor(
           !request_->protected_auction_ciphertext().empty()),
       clients_(clients),
       config_client_(config_client),
+      config_(GetSellerFrontEndConfig(clients, config_client)),
       log_context_({}, server_common::ConsentedDebugConfiguration(),
                    [this]() { return response_->mutable_debug_info(); }),
       error_accumulator_(&log_context_) {
-  seller_domain_ = config_client_.GetStringParameter(SELLER_ORIGIN_DOMAIN);
+  seller_domain_ = config_->seller_origin_domain;
   CHECK_OK([this]() {
     PS_ASSIGN_OR_RETURN(metric_context_,
                         metric::SfeContextMap()->Remove(request_));
@@ -29,10 +29,12 @@
 #include "include/grpcpp/impl/codegen/server_callback.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/util/cycle_clock.h"
 #include "services/common/util/error_accumulator.h"
 #include "services/seller_frontend_service/seller_frontend_service.h"
 #include "services/seller_frontend_service/util/encryption_util.h"
 #include "services/seller_frontend_service/util/proto_mapping_util.h"
+#include "services/seller_frontend_service/util/seller_frontend_config.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 // Marker to set state of request in metric context.
@@ -79,6 +81,8 @@ class SelectAuctionResultReactor : public grpc::ServerUnaryReactor {
   std::vector<IgsWithBidsMap> component_auction_bidding_groups_;
   const ClientRegistry& clients_;
   const TrustedServersConfigClient& config_client_;
+  // Runtime config of this request, unchanged by later config updates.
+  const std::shared_ptr<const SellerFrontEndConfig> config_;
 
   server_common::log::ContextImpl log_context_;
 
@@ -92,8 +96,8 @@ class SelectAuctionResultReactor : public grpc::ServerUnaryReactor {
   // Encryption context needed throughout the lifecycle of the request.
   std::unique_ptr<OhttpHpkeDecryptedMessage> decrypted_request_;
 
-  // Start time of request.
-  absl::Time start_ = absl::Now();
+  // Times the request from its start.
+  CycleTimer request_timer_;
 
   // Finishes the RPC call with a status and publishes metrics.
   void FinishWithStatus(const grpc::Status& status);
@@ -105,7 +109,8 @@ class SelectAuctionResultReactor : public grpc::ServerUnaryReactor {
   // This function moves the elements from component_auction_results and
   // signals fields from auction_config and protected_auction_input.
   // These fields should not be used after this function has been called.
-  void ScoreAds(std::vector<AuctionResult>& component_auction_results);
+  void ScoreAds(google::protobuf::RepeatedPtrField<AuctionResult>&
+                    component_auction_results);
 
   // Called after score ads RPC is complete to collate the result.
   void OnScoreAdsDone(
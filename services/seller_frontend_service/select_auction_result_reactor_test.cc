@@ -185,6 +185,82 @@ TYPED_TEST(SelectAuctionResultReactorTest, AbortsAuctionWithDuplicateResults) {
   EXPECT_EQ(response.auction_result_ciphertext().size(), 0);
 }
 
+TYPED_TEST(SelectAuctionResultReactorTest,
+           DecryptsComponentAuctionsOnExecutor) {
+  absl::Notification scoring_done;
+  this->SetupComponentAuctionResults(3);
+  // All but one of the results are decrypted on the executor.
+  MockExecutor executor;
+  EXPECT_CALL(executor, Run)
+      .Times(2)
+      .WillRepeatedly(
+          [](absl::AnyInvocable<void()> closure) { std::move(closure)(); });
+  EXPECT_CALL(this->scoring_client_, ExecuteInternal)
+      .WillOnce([&scoring_done](
+                    std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
+                        score_ads_request,
+                    const RequestMetadata& metadata,
+                    absl::AnyInvocable<void(
+                        absl::StatusOr<std::unique_ptr<
+                            ScoreAdsResponse::ScoreAdsRawResponse>>)&&>
+                        on_done,
+                    absl::Duration timeout) {
+        EXPECT_EQ(score_ads_request->component_auction_results_size(), 3);
+        std::move(on_done)(
+            std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>());
+        scoring_done.Notify();
+        return absl::OkStatus();
+      });
+  ClientRegistry clients = {
+      MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>(),
+      this->scoring_client_,
+      BuyerFrontEndAsyncClientFactoryMock(),
+      this->key_fetcher_manager_,
+      &this->crypto_client_,
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>()),
+      &executor};
+  auto response = RunRequest(this->config_, clients, this->request_);
+  scoring_done.WaitForNotification();
+}
+
+TYPED_TEST(SelectAuctionResultReactorTest, CallsScoringForChaffOnly) {
+  absl::Notification scoring_done;
+  this->SetupComponentAuctionResults(0);
+  AuctionResult chaff;
+  chaff.set_is_chaff(true);
+  auto* chaff_car = this->request_.mutable_component_auction_results()->Add();
+  chaff_car->set_key_id(std::to_string(HpkeKeyset{}.key_id));
+  chaff_car->set_auction_result_ciphertext(
+      FrameAndCompressProto(chaff.SerializeAsString()));
+  EXPECT_CALL(this->scoring_client_, ExecuteInternal)
+      .WillOnce([&scoring_done](
+                    std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
+                        score_ads_request,
+                    const RequestMetadata& metadata,
+                    absl::AnyInvocable<void(
+                        absl::StatusOr<std::unique_ptr<
+                            ScoreAdsResponse::ScoreAdsRawResponse>>)&&>
+                        on_done,
+                    absl::Duration timeout) {
+        EXPECT_EQ(score_ads_request->component_auction_results_size(), 0);
+        std::move(on_done)(
+            std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>());
+        scoring_done.Notify();
+        return absl::OkStatus();
+      });
+  ClientRegistry clients = {
+      MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>(),
+      this->scoring_client_,
+      BuyerFrontEndAsyncClientFactoryMock(),
+      this->key_fetcher_manager_,
+      &this->crypto_client_,
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>())};
+  auto response = RunRequest(this->config_, clients, this->request_);
+  scoring_done.WaitForNotification();
+}
+
 TYPED_TEST(SelectAuctionResultReactorTest,
            ReturnsErrorForNoValidComponentAuctions) {
   this->SetupComponentAuctionResults(0);
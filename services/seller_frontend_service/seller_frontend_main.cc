@@ -23,6 +23,7 @@
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
@@ -30,14 +31,29 @@
 #include "grpcpp/ext/proto_server_reflection_plugin.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/health_check_service_interface.h"
+#include "services/common/clients/async_grpc/grpc_compression.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/compression/compression_codec.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/reporters/batching_async_reporter.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/request_trace.h"
+#include "services/common/util/arena_message_allocator.h"
+#include "services/common/util/cpu_placement.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/large_buffer_pool.h"
+#include "services/common/util/memory_admission_controller.h"
+#include "services/common/util/request_capture.h"
+#include "services/common/util/request_phase_tracer.h"
+#include "services/common/util/server_drain.h"
 #include "services/common/util/tcmalloc_utils.h"
+#include "services/seller_frontend_service/http_ingress.h"
 #include "services/seller_frontend_service/runtime_flags.h"
 #include "services/seller_frontend_service/seller_frontend_service.h"
+#include "services/seller_frontend_service/util/framing_utils.h"
 #include "services/seller_frontend_service/util/key_fetcher_utils.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
 #include "src/public/cpio/interface/cpio.h"
@@ -59,7 +75,15 @@ ABSL_FLAG(
 ABSL_FLAG(std::optional<std::string>, auction_server_host, std::nullopt,
           "Domain address of the auction server used for ad scoring.");
 ABSL_FLAG(std::optional<std::string>, key_value_signals_host, std::nullopt,
-          "Domain address of the Key-Value server for the scoring signals.");
+          "Domain address of the Key-Value server for the scoring signals. "
+          "Replicas of the server may be listed separated by commas, for the "
+          "lookups to be spread across them.");
+ABSL_FLAG(std::optional<std::string>, seller_tee_kv_server_addr, "",
+          "Address of a TEE seller KV server. If set, the scoring signals are "
+          "fetched from it with the KV v2 gRPC API instead of from "
+          "key_value_signals_host.");
+ABSL_FLAG(std::optional<bool>, seller_tee_kv_server_egress_tls, true,
+          "If true, the gRPC client of the TEE seller KV server uses TLS.");
 ABSL_FLAG(std::optional<std::string>, buyer_server_hosts, std::nullopt,
           "Comma seperated list of domain addresses of the BuyerFrontEnd "
           "services for getting bids.");
@@ -100,6 +124,117 @@ ABSL_FLAG(std::optional<int64_t>, sfe_tcmalloc_max_total_thread_cache_bytes,
           std::nullopt,
           "Maximum amount of cached memory in bytes across all threads (or "
           "logical CPUs)");
+ABSL_FLAG(std::optional<bool>, enable_pipelined_scoring_signals_fetch, false,
+          "Fetch the scoring signals for each buyer as soon as its bids "
+          "arrive instead of once all buyers responded. False by default.");
+ABSL_FLAG(std::optional<int>, get_bid_hedge_delay_ms, 0,
+          "Delay after which a second GetBids request is sent to a buyer that "
+          "has not responded yet, e.g. the buyer's p95 latency. Hedging is "
+          "disabled when 0 (default).");
+ABSL_FLAG(std::optional<int>, get_bid_deadline_reserve_ms, 0,
+          "Time reserved for scoring before the deadline of a SelectAd "
+          "request. GetBids requests are cut short to leave this much time.");
+ABSL_FLAG(std::optional<bool>, enable_get_bids_batching, false,
+          "Send the GetBids requests of a SelectAd request to buyers hosted "
+          "on the same BFE in a single GetBidsBatch call. False by default.");
+ABSL_FLAG(std::optional<int>, seller_kv_min_warm_connections, 1,
+          "Number of connections to the seller KV server that are opened on "
+          "startup and on every re-warm.");
+ABSL_FLAG(std::optional<int>, seller_kv_rewarm_interval_ms, 0,
+          "Interval at which connections to the seller KV server are "
+          "re-warmed, e.g. to reach new replicas. Disabled if 0.");
+ABSL_FLAG(std::optional<int>, seller_kv_hedge_percentile, 0,
+          "If set, e.g. to 95, and key_value_signals_host lists several "
+          "replicas, a seller KV lookup with no response by this percentile "
+          "of the recent lookup latencies is sent to another replica as "
+          "well. Lookups are not hedged if 0.");
+ABSL_FLAG(std::optional<int>, auction_grpc_num_channels, 1,
+          "Number of gRPC channels, each with its own connection, to the "
+          "auction server. RPCs go to the channel with the fewest in flight.");
+ABSL_FLAG(std::optional<std::string>, auction_server_zonal_hosts, "",
+          "Addresses of the auction servers of each zone, as "
+          "zone=address,... If set, RPCs stay in the zone of this server "
+          "while its auction servers are not busier than the others. "
+          "auction_server_host is used if empty.");
+ABSL_FLAG(std::optional<int>, auction_zone_spillover_rpcs, 0,
+          "Number of RPCs in flight the auction servers of this zone may "
+          "have beyond those of another zone before RPCs spill over to it. "
+          "RPCs never leave the zone if negative.");
+ABSL_FLAG(std::optional<int>, auction_load_report_wait_per_rpc_ms, 0,
+          "Roma wait reported by a auction server that weighs as much as one "
+          "more RPC in flight to it when picking the channel of an RPC. The "
+          "load reports are ignored if 0.");
+ABSL_FLAG(std::optional<int>, buyer_grpc_num_channels, 1,
+          "Number of gRPC channels, each with its own connection, to each "
+          "buyer frontend server.");
+ABSL_FLAG(std::optional<int>, sfe_grpc_keepalive_ms, 0,
+          "Interval of the keepalive pings on the gRPC channels to the "
+          "auction and buyer frontend servers. Disabled if 0.");
+ABSL_FLAG(std::optional<int>, sfe_grpc_stream_window_bytes, 0,
+          "Initial HTTP/2 stream window of the gRPC channels to the auction "
+          "and buyer frontend servers. The gRPC default if 0.");
+ABSL_FLAG(std::optional<int>, sfe_grpc_min_compressed_request_bytes, 0,
+          "Requests to the auction and buyer frontend servers with a smaller "
+          "payload are sent uncompressed even if compression is enabled.");
+ABSL_FLAG(std::optional<int>, debug_reporting_max_queued_pings, 10'000,
+          "Debug reporting pings waiting to be sent, beyond which new pings "
+          "are dropped.");
+ABSL_FLAG(std::optional<int>, debug_reporting_max_pings_per_host, 16,
+          "Debug reporting pings in flight to a single host. Further pings to "
+          "the host wait in the queue.");
+ABSL_FLAG(std::optional<int>, debug_reporting_sampling_percent, 100,
+          "Percent of the debug reporting pings that are sent, in [0, 100].");
+ABSL_FLAG(std::optional<int>, debug_reporting_max_connections, 64,
+          "Connections the debug reporting fetcher may open. Unlimited if 0.");
+ABSL_FLAG(std::optional<int64_t>, debug_reporting_kv_pending_threshold, 256,
+          "While more seller KV fetches than this are in flight, debug "
+          "reporting pings are sent one at a time. Never throttled if 0.");
+ABSL_FLAG(std::optional<int>, seller_kv_max_keys_per_request, 0,
+          "Max render URL and ad component keys looked up by a single seller "
+          "KV request. Larger key sets are split into parallel requests whose "
+          "responses are merged. All keys go in one request if 0.");
+ABSL_FLAG(std::optional<bool>, seller_kv_post_keys, false,
+          "POST the seller KV keys as a JSON body instead of listing them in "
+          "the URL. Requires a seller KV server that accepts such requests.");
+ABSL_FLAG(std::optional<int>, max_bids_per_buyer, 0,
+          "Max number of bids of a single buyer that are scored. Only the "
+          "highest bids are kept above it. No limit if 0.");
+ABSL_FLAG(std::optional<int>, max_bids_per_auction, 0,
+          "Max number of bids of all the buyers of an auction that are "
+          "scored. Only the highest bids are kept above it. No limit if 0.");
+ABSL_FLAG(std::optional<int>, scoring_signals_cache_ttl_ms, 0,
+          "Time in milliseconds for which the seller KV signals of a render "
+          "URL are reused by the auctions bidding it, rather than looked up "
+          "again. Not cached if 0.");
+ABSL_FLAG(std::optional<std::string>, buyer_input_compression_dictionary,
+          std::nullopt,
+          "Base64 encoded dictionary with which clients may compress the "
+          "buyer inputs of a request, signaled by compression bits 3 in its "
+          "framing header. Not accepted if empty.");
+ABSL_FLAG(std::optional<int>, sfe_backend_preconnect_timeout_ms, 0,
+          "Time in milliseconds given to each round of connections to the "
+          "Auction Service and the BuyerFrontEnds at startup, during which "
+          "the health check reports the server as not serving. Backends are "
+          "connected on their first request if 0.");
+ABSL_FLAG(std::optional<int>, sfe_backend_ready_percent, 0,
+          "Percent of the channels to the backends that must be connected at "
+          "startup before the health check reports the server as serving.");
+ABSL_FLAG(std::optional<std::string>, sfe_request_capture_path,
+          std::nullopt,
+          "File to which the plaintext of the consented SelectAd requests is "
+          "appended, for request_replayer to replay them. Only allowed in "
+          "test mode. Nothing is captured if empty.");
+ABSL_FLAG(std::optional<int>, sfe_http_ingress_port, 0,
+          "Port on which SelectAd is also served as JSON over HTTP/1.1 at "
+          "/v1/selectAd, as with the gRPC-JSON transcoding of Envoy. Not "
+          "served if 0.");
+ABSL_FLAG(std::optional<int>, sfe_http_ingress_threads, 1,
+          "Threads accepting and reading the HTTP requests, each with its "
+          "own listening socket.");
+ABSL_FLAG(std::optional<int>, get_bids_stream_interest_groups_per_chunk, 0,
+          "Interest groups per chunk when streaming them to a BuyerFrontEnd "
+          "over GetBidsStream, for the requests of a buyer with more of them. "
+          "GetBids carries all of them at once if 0.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -119,6 +254,10 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_seller_origin_domain, SELLER_ORIGIN_DOMAIN);
   config_client.SetFlag(FLAGS_auction_server_host, AUCTION_SERVER_HOST);
   config_client.SetFlag(FLAGS_key_value_signals_host, KEY_VALUE_SIGNALS_HOST);
+  config_client.SetFlag(FLAGS_seller_tee_kv_server_addr,
+                        SELLER_TEE_KV_SERVER_ADDR);
+  config_client.SetFlag(FLAGS_seller_tee_kv_server_egress_tls,
+                        SELLER_TEE_KV_SERVER_EGRESS_TLS);
   config_client.SetFlag(FLAGS_buyer_server_hosts, BUYER_SERVER_HOSTS);
   config_client.SetFlag(FLAGS_enable_buyer_compression,
                         ENABLE_BUYER_COMPRESSION);
@@ -170,6 +309,41 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   config_client.SetFlag(FLAGS_enable_protected_audience,
                         ENABLE_PROTECTED_AUDIENCE);
   config_client.SetFlag(FLAGS_ps_verbosity, PS_VERBOSITY);
+  config_client.SetFlag(FLAGS_request_phase_tracing_per_mille,
+                        REQUEST_PHASE_TRACING_PER_MILLE);
+  config_client.SetFlag(FLAGS_trace_sampling_per_mille,
+                        TRACE_SAMPLING_PER_MILLE);
+  config_client.SetFlag(FLAGS_enable_profiling, ENABLE_PROFILING);
+  config_client.SetFlag(FLAGS_profiling_interval_ms, PROFILING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_memory_admission_heap_limit_mb,
+                        MEMORY_ADMISSION_HEAP_LIMIT_MB);
+  config_client.SetFlag(FLAGS_memory_admission_request_size_factor,
+                        MEMORY_ADMISSION_REQUEST_SIZE_FACTOR);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_server_max_pollers, GRPC_SERVER_MAX_POLLERS);
+  config_client.SetFlag(FLAGS_grpc_server_max_memory_mb,
+                        GRPC_SERVER_MAX_MEMORY_MB);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads, GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_cpu_placement, CPU_PLACEMENT);
+  config_client.SetFlag(FLAGS_drain_health_check_grace_ms,
+                        DRAIN_HEALTH_CHECK_GRACE_MS);
+  config_client.SetFlag(FLAGS_drain_deadline_ms, DRAIN_DEADLINE_MS);
+  config_client.SetFlag(FLAGS_key_warm_up_timeout_ms, KEY_WARM_UP_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_work_stealing_executor_workers,
+                        WORK_STEALING_EXECUTOR_WORKERS);
+  config_client.SetFlag(FLAGS_large_buffer_pool_mb, LARGE_BUFFER_POOL_MB);
+  config_client.SetFlag(FLAGS_large_buffer_huge_pages,
+                        LARGE_BUFFER_HUGE_PAGES);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_interval_ms,
+                        TCMALLOC_TUNING_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_thread_cache_mb,
+                        TCMALLOC_TUNING_MIN_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_thread_cache_mb,
+                        TCMALLOC_TUNING_MAX_THREAD_CACHE_MB);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_min_release_mb_per_second,
+                        TCMALLOC_TUNING_MIN_RELEASE_MB_PER_SECOND);
+  config_client.SetFlag(FLAGS_tcmalloc_tuning_max_release_mb_per_second,
+                        TCMALLOC_TUNING_MAX_RELEASE_MB_PER_SECOND);
   config_client.SetFlag(FLAGS_seller_cloud_platforms_map,
                         SELLER_CLOUD_PLATFORMS_MAP);
   config_client.SetFlag(
@@ -177,6 +351,63 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
       SFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND);
   config_client.SetFlag(FLAGS_sfe_tcmalloc_max_total_thread_cache_bytes,
                         SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES);
+  config_client.SetFlag(FLAGS_enable_pipelined_scoring_signals_fetch,
+                        ENABLE_PIPELINED_SCORING_SIGNALS_FETCH);
+  config_client.SetFlag(FLAGS_get_bid_hedge_delay_ms, GET_BID_HEDGE_DELAY_MS);
+  config_client.SetFlag(FLAGS_get_bid_deadline_reserve_ms,
+                        GET_BID_DEADLINE_RESERVE_MS);
+  config_client.SetFlag(FLAGS_enable_get_bids_batching,
+                        ENABLE_GET_BIDS_BATCHING);
+  config_client.SetFlag(FLAGS_seller_kv_min_warm_connections,
+                        SELLER_KV_MIN_WARM_CONNECTIONS);
+  config_client.SetFlag(FLAGS_seller_kv_rewarm_interval_ms,
+                        SELLER_KV_REWARM_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_seller_kv_hedge_percentile,
+                        SELLER_KV_HEDGE_PERCENTILE);
+  config_client.SetFlag(FLAGS_auction_grpc_num_channels,
+                        AUCTION_GRPC_NUM_CHANNELS);
+  config_client.SetFlag(FLAGS_auction_server_zonal_hosts,
+                        AUCTION_SERVER_ZONAL_HOSTS);
+  config_client.SetFlag(FLAGS_auction_zone_spillover_rpcs,
+                        AUCTION_ZONE_SPILLOVER_RPCS);
+  config_client.SetFlag(FLAGS_auction_load_report_wait_per_rpc_ms,
+                        AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS);
+  config_client.SetFlag(FLAGS_buyer_grpc_num_channels, BUYER_GRPC_NUM_CHANNELS);
+  config_client.SetFlag(FLAGS_sfe_grpc_keepalive_ms, SFE_GRPC_KEEPALIVE_MS);
+  config_client.SetFlag(FLAGS_sfe_grpc_stream_window_bytes,
+                        SFE_GRPC_STREAM_WINDOW_BYTES);
+  config_client.SetFlag(FLAGS_sfe_grpc_min_compressed_request_bytes,
+                        SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES);
+  config_client.SetFlag(FLAGS_debug_reporting_max_queued_pings,
+                        DEBUG_REPORTING_MAX_QUEUED_PINGS);
+  config_client.SetFlag(FLAGS_debug_reporting_max_pings_per_host,
+                        DEBUG_REPORTING_MAX_PINGS_PER_HOST);
+  config_client.SetFlag(FLAGS_debug_reporting_sampling_percent,
+                        DEBUG_REPORTING_SAMPLING_PERCENT);
+  config_client.SetFlag(FLAGS_debug_reporting_max_connections,
+                        DEBUG_REPORTING_MAX_CONNECTIONS);
+  config_client.SetFlag(FLAGS_debug_reporting_kv_pending_threshold,
+                        DEBUG_REPORTING_KV_PENDING_THRESHOLD);
+  config_client.SetFlag(FLAGS_seller_kv_max_keys_per_request,
+                        SELLER_KV_MAX_KEYS_PER_REQUEST);
+  config_client.SetFlag(FLAGS_seller_kv_post_keys, SELLER_KV_POST_KEYS);
+  config_client.SetFlag(FLAGS_max_bids_per_buyer, MAX_BIDS_PER_BUYER);
+  config_client.SetFlag(FLAGS_max_bids_per_auction, MAX_BIDS_PER_AUCTION);
+  config_client.SetFlag(FLAGS_scoring_signals_cache_ttl_ms,
+                        SCORING_SIGNALS_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_buyer_input_compression_dictionary,
+                        BUYER_INPUT_COMPRESSION_DICTIONARY);
+  config_client.SetFlag(FLAGS_sfe_backend_preconnect_timeout_ms,
+                        SFE_BACKEND_PRECONNECT_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_sfe_backend_ready_percent,
+                        SFE_BACKEND_READY_PERCENT);
+  config_client.SetFlag(FLAGS_sfe_request_capture_path,
+                        SFE_REQUEST_CAPTURE_PATH);
+  config_client.SetFlag(FLAGS_sfe_http_ingress_port, SFE_HTTP_INGRESS_PORT);
+  config_client.SetFlag(FLAGS_sfe_http_ingress_threads,
+                        SFE_HTTP_INGRESS_THREADS);
+  config_client.SetFlag(FLAGS_get_bids_stream_interest_groups_per_chunk,
+                        GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK);
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
         << "Config client failed to initialize.";
@@ -184,6 +415,34 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
   // Set verbosity
   server_common::log::PS_VLOG_IS_ON(
       0, config_client.GetIntParameter(PS_VERBOSITY));
+  RequestPhaseTracer::SetSamplingPerMille(
+      config_client.GetIntParameter(REQUEST_PHASE_TRACING_PER_MILLE));
+  RequestTrace::SetSamplingPerMille(
+      config_client.GetIntParameter(TRACE_SAMPLING_PER_MILLE));
+  MemoryAdmissionController::Get().Configure(
+      {.heap_limit_bytes =
+           config_client.GetInt64Parameter(MEMORY_ADMISSION_HEAP_LIMIT_MB) *
+           1024 * 1024,
+       .request_size_factor = config_client.GetIntParameter(
+           MEMORY_ADMISSION_REQUEST_SIZE_FACTOR)});
+  if (config_client.HasParameter(SFE_REQUEST_CAPTURE_PATH)) {
+    PS_RETURN_IF_ERROR(RequestCapture::Get().Configure(
+        config_client.GetStringParameter(SFE_REQUEST_CAPTURE_PATH),
+        config_client.GetBooleanParameter(TEST_MODE)));
+  }
+  if (config_client.HasParameter(BUYER_INPUT_COMPRESSION_DICTIONARY) &&
+      !config_client.GetStringParameter(BUYER_INPUT_COMPRESSION_DICTIONARY)
+           .empty()) {
+    std::string dictionary;
+    if (!absl::Base64Unescape(config_client.GetStringParameter(
+                                  BUYER_INPUT_COMPRESSION_DICTIONARY),
+                              &dictionary)) {
+      return absl::InvalidArgumentError(
+          "Buyer input compression dictionary is not valid base64.");
+    }
+    PS_RETURN_IF_ERROR(RegisterCompressionCodec(
+        kBuyerInputDictionaryCodec, CreateDeflateCodec(std::move(dictionary))));
+  }
 
   const bool enable_protected_audience =
       config_client.GetBooleanParameter(ENABLE_PROTECTED_AUDIENCE);
@@ -206,16 +465,38 @@ absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_ASSIGN_OR_RETURN(
+      const CpuPlacement cpu_placement,
+      ParseCpuPlacement(config_client.GetStringParameter(CPU_PLACEMENT)));
 
   MaySetBackgroundReleaseRate(config_client.GetInt64Parameter(
       SFE_TCMALLOC_BACKGROUND_RELEASE_RATE_BYTES_PER_SECOND));
   MaySetMaxTotalThreadCacheBytes(config_client.GetInt64Parameter(
       SFE_TCMALLOC_MAX_TOTAL_THREAD_CACHE_BYTES));
+  PS_ASSIGN_OR_RETURN(const HugePages large_buffer_huge_pages,
+                      ParseHugePages(config_client.GetStringParameter(
+                          LARGE_BUFFER_HUGE_PAGES)));
+  LargeBufferPool::Configure(
+      {.huge_pages = large_buffer_huge_pages,
+       .max_pooled_bytes = static_cast<size_t>(config_client.GetInt64Parameter(
+                               LARGE_BUFFER_POOL_MB)) *
+                           1024 * 1024});
 
   InitTelemetry<SelectAdRequest>(
       config_util, config_client, metric::kSfe,
       FetchIgOwnerList(ParseIgOwnerToBfeDomainMap(
           config_client.GetStringParameter(BUYER_SERVER_HOSTS))));
+  metric::SfeContextMap()->AddObserverable(
+      metric::kSfeDebugReportingCount, BatchingAsyncReporter::GetReportCounts);
+  metric::SfeContextMap()->AddObserverable(
+      metric::kHttpFetcherReuseRatio,
+      MultiCurlHttpFetcherAsync::GetReuseRatios);
+  metric::SfeContextMap()->AddObserverable(
+      metric::kGrpcRequestCompressionShare, GetGrpcRequestCompressionShares);
+  std::unique_ptr<ProfilingService> profiling_service =
+      MayStartProfiling(config_client);
+  std::unique_ptr<TcmallocTuner> tcmalloc_tuner =
+      MayStartTcmallocTuning(config_client);
 
   std::string server_address =
       absl::StrCat("0.0.0.0:", config_client.GetStringParameter(PORT));
@@ -227,7 +508,7 @@ absl::Status RunServer() {
   SellerFrontEndService seller_frontend_service(
       &config_client,
       CreateKeyFetcherManager(config_client, std::move(public_key_fetcher)),
-      CreateCryptoClient());
+      CreateCryptoClient(), config_util.GetZone());
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
   ServerBuilder builder;
@@ -268,17 +549,77 @@ absl::Status RunServer() {
   // Set max message size to 256 MB.
   builder.AddChannelArgument(GRPC_ARG_MAX_RECEIVE_MESSAGE_LENGTH,
                              256L * 1024L * 1024L);
+  ApplyGrpcServerOptions(
+      {.num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_pollers = config_client.GetIntParameter(GRPC_SERVER_MAX_POLLERS),
+       .max_memory_bytes =
+           config_client.GetInt64Parameter(GRPC_SERVER_MAX_MEMORY_MB) * 1024 *
+           1024,
+       .max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS)},
+      builder);
+  // The messages of each call are on an arena freed at once with the call.
+  ArenaMessageAllocator<SelectAdRequest, SelectAdResponse> select_ad_allocator;
+  seller_frontend_service.SetMessageAllocatorFor_SelectAd(&select_ad_allocator);
+  ArenaMessageAllocator<GetComponentAuctionCiphertextsRequest,
+                        GetComponentAuctionCiphertextsResponse>
+      ciphertexts_allocator;
+  seller_frontend_service.SetMessageAllocatorFor_GetComponentAuctionCiphertexts(
+      &ciphertexts_allocator);
   builder.RegisterService(&seller_frontend_service);
 
-  std::unique_ptr<Server> server(builder.BuildAndStart());
+  std::unique_ptr<Server> server;
+  {
+    // The threads serving the completion queues start with the server.
+    ScopedCpuPlacement grpc_placement("gRPC threads", cpu_placement.grpc_cpus);
+    server = builder.BuildAndStart();
+  }
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
 
   PS_LOG(INFO) << "Server listening on " << server_address;
-  // Wait for the server to shutdown. Note that some other thread must be
-  // responsible for shutting down the server for this call to ever return.
-  server->Wait();
+  PreconnectBackends(
+      {.timeout = absl::Milliseconds(config_client.GetIntParameter(
+           SFE_BACKEND_PRECONNECT_TIMEOUT_MS)),
+       .ready_percent =
+           config_client.GetIntParameter(SFE_BACKEND_READY_PERCENT)},
+      [&seller_frontend_service](absl::Time deadline) {
+        return seller_frontend_service.ConnectBackends(deadline)
+            .ConnectedPercent();
+      },
+      *server);
+  // Serves the HTTP requests through the in-process channel of the server.
+  std::optional<HttpIngress> http_ingress;
+  if (const int http_port =
+          config_client.GetIntParameter(SFE_HTTP_INGRESS_PORT);
+      http_port > 0) {
+    http_ingress.emplace(
+        HttpIngressOptions{
+            .port = http_port,
+            .num_threads =
+                config_client.GetIntParameter(SFE_HTTP_INGRESS_THREADS)},
+        server->InProcessChannel(grpc::ChannelArguments()));
+    PS_RETURN_IF_ERROR(http_ingress->Start());
+  }
+  // Drains the server on SIGTERM.
+  ServerDrain drain(
+      {.health_check_grace = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_HEALTH_CHECK_GRACE_MS)),
+       .deadline = absl::Milliseconds(
+           config_client.GetInt64Parameter(DRAIN_DEADLINE_MS))});
+  // The HTTP requests in flight were cancelled with the server.
+  drain.AddStep("http_ingress", [&http_ingress](absl::Time deadline) {
+    if (http_ingress.has_value()) {
+      http_ingress->Stop();
+    }
+  });
+  drain.AddStep("reporters", [&seller_frontend_service](absl::Time deadline) {
+    if (!seller_frontend_service.FlushReports(deadline)) {
+      PS_LOG(WARNING) << "Debug reports left unsent at the drain deadline";
+    }
+  });
+  drain.AddStep("telemetry", FlushTelemetry);
+  drain.Wait(*server);
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,16 +14,22 @@
 
 #include "services/seller_frontend_service/seller_frontend_service.h"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
 #include "api/bidding_auction_servers.pb.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
+#include "services/common/clients/async_grpc/default_async_grpc_client.h"
+#include "services/common/clients/http/connection_warmer.h"
 #include "services/common/clients/http_kv_server/seller/fake_seller_key_value_async_http_client.h"
 #include "services/common/clients/http_kv_server/seller/seller_key_value_async_http_client.h"
+#include "services/common/clients/kv_server/kv_async_client.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/util/auction_scope_util.h"
+#include "services/common/util/memory_admission_controller.h"
 #include "services/seller_frontend_service/get_component_auction_ciphertexts_reactor.h"
 #include "services/seller_frontend_service/select_ad_reactor.h"
 #include "services/seller_frontend_service/select_ad_reactor_app.h"
@@ -31,6 +37,7 @@
 #include "services/seller_frontend_service/select_ad_reactor_web.h"
 #include "services/seller_frontend_service/select_auction_result_reactor.h"
 #include "src/telemetry/telemetry.h"
+#include "src/util/status_macro/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -62,25 +69,94 @@ SellerFrontEndService::CreateKVClient() {
     return std::make_unique<FakeSellerKeyValueAsyncHttpClient>(
         config_client_.GetStringParameter(KEY_VALUE_SIGNALS_HOST));
   } else {
+    ConnectionWarmingOptions warming_options = {.executor = executor_.get()};
+    if (config_client_.HasParameter(SELLER_KV_MIN_WARM_CONNECTIONS)) {
+      warming_options.min_warm_connections =
+          config_client_.GetIntParameter(SELLER_KV_MIN_WARM_CONNECTIONS);
+    }
+    if (config_client_.HasParameter(SELLER_KV_REWARM_INTERVAL_MS)) {
+      warming_options.rewarm_interval = absl::Milliseconds(
+          config_client_.GetIntParameter(SELLER_KV_REWARM_INTERVAL_MS));
+    }
+    KvEndpointOptions endpoint_options = {.executor = executor_.get()};
+    if (config_client_.HasParameter(SELLER_KV_HEDGE_PERCENTILE)) {
+      endpoint_options.hedge_percentile =
+          config_client_.GetIntParameter(SELLER_KV_HEDGE_PERCENTILE);
+    }
     return std::make_unique<SellerKeyValueAsyncHttpClient>(
         config_client_.GetStringParameter(KEY_VALUE_SIGNALS_HOST),
-        std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()), true);
+        std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()), true,
+        warming_options,
+        config_client_.HasParameter(SELLER_KV_POST_KEYS) &&
+            config_client_.GetBooleanParameter(SELLER_KV_POST_KEYS),
+        std::move(endpoint_options));
   }
 }
 
+std::unique_ptr<ScoringSignalsAsyncProvider>
+SellerFrontEndService::CreateScoringSignalsAsyncProvider() {
+  const bool enable_protected_app_signals =
+      config_client_.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS);
+  if (config_client_.HasParameter(SELLER_TEE_KV_SERVER_ADDR) &&
+      !config_client_.GetStringParameter(SELLER_TEE_KV_SERVER_ADDR).empty()) {
+    return std::make_unique<KVScoringSignalsAsyncProvider>(
+        std::make_unique<KVAsyncGrpcClient>(
+            key_fetcher_manager_.get(),
+            kv_server::v2::KeyValueService::NewStub(CreateChannel(
+                config_client_.GetStringParameter(SELLER_TEE_KV_SERVER_ADDR),
+                /*compression=*/true,
+                /*secure=*/
+                !config_client_.HasParameter(SELLER_TEE_KV_SERVER_EGRESS_TLS) ||
+                    config_client_.GetBooleanParameter(
+                        SELLER_TEE_KV_SERVER_EGRESS_TLS)))),
+        enable_protected_app_signals);
+  }
+  return std::make_unique<HttpScoringSignalsAsyncProvider>(
+      CreateKVClient(), enable_protected_app_signals,
+      GetScoringSignalsFetchOptions(config_client_));
+}
+
+ChannelConnectivity SellerFrontEndService::ConnectBackends(
+    absl::Time deadline) const {
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  if (scoring_ != nullptr) {
+    channels = scoring_->channels();
+  }
+  if (buyer_factory_ != nullptr) {
+    for (auto& channel : buyer_factory_->channels()) {
+      channels.push_back(std::move(channel));
+    }
+  }
+  return ConnectChannels(channels, deadline);
+}
+
+bool SellerFrontEndService::FlushReports(absl::Time deadline) const {
+  return clients_.reporting == nullptr ||
+         clients_.reporting->Flush(deadline);
+}
+
 grpc::ServerUnaryReactor* SellerFrontEndService::SelectAd(
     grpc::CallbackServerContext* context, const SelectAdRequest* request,
     SelectAdResponse* response) {
-  LogCommonMetric(request, response);
   if (AuctionScope auction_scope = GetAuctionScope(*request);
       auction_scope == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
+    LogCommonMetric(request, response);
     auto reactor = std::make_unique<SelectAuctionResultReactor>(
         context, request, response, clients_, config_client_);
     reactor->Execute();
     return reactor.release();
   }
+  absl::StatusOr<MemoryReservation> memory_reservation =
+      MemoryAdmissionController::Get().Admit(request->ByteSizeLong());
+  if (!memory_reservation.ok()) {
+    LogRejectedRequestMetric(request, response, memory_reservation.status());
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    reactor->Finish(server_common::FromAbslStatus(memory_reservation.status()));
+    return reactor;
+  }
   std::unique_ptr<SelectAdReactor> reactor =
       GetSelectAdReactor(context, request, response, clients_, config_client_);
+  reactor->HoldMemoryReservation(*std::move(memory_reservation));
   reactor->Execute();
   return reactor.release();
 }
@@ -91,7 +167,7 @@ grpc::ServerUnaryReactor* SellerFrontEndService::GetComponentAuctionCiphertexts(
     GetComponentAuctionCiphertextsResponse* response) {
   auto reactor = std::make_unique<GetComponentAuctionCiphertextsReactor>(
       request, response, clients_.key_fetcher_manager_,
-      seller_cloud_platforms_map_);
+      seller_cloud_platforms_map_, clients_.executor);
   reactor->Execute();
   return reactor.release();
 }
@@ -18,21 +18,31 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
+#include "services/common/clients/async_grpc/grpc_channel_pool.h"
 #include "services/common/clients/auction_server/scoring_async_client.h"
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client_factory.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/concurrent/work_stealing_executor.h"
 #include "services/common/reporters/async_reporter.h"
+#include "services/common/reporters/batching_async_reporter.h"
+#include "services/common/util/config_snapshot.h"
 #include "services/seller_frontend_service/providers/http_scoring_signals_async_provider.h"
+#include "services/seller_frontend_service/providers/kv_scoring_signals_async_provider.h"
 #include "services/seller_frontend_service/providers/scoring_signals_async_provider.h"
 #include "services/seller_frontend_service/runtime_flags.h"
 #include "services/seller_frontend_service/util/config_param_parser.h"
+#include "services/seller_frontend_service/util/scoring_signals_cache.h"
+#include "services/seller_frontend_service/util/seller_frontend_config.h"
 #include "src/concurrent/event_engine_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
@@ -48,6 +58,74 @@ ParseSellerCloudPlarformMap(absl::string_view seller_platforms_map_json) {
   return *seller_cloud_platform_parse_status;
 }
 
+// Channel pool to a backend with the given flag for its number of channels.
+static inline GrpcChannelPoolConfig GetChannelPoolConfig(
+    const TrustedServersConfigClient& config_client,
+    absl::string_view num_channels_flag) {
+  return {
+      .num_channels = config_client.GetIntParameter(num_channels_flag),
+      .keepalive_time = absl::Milliseconds(
+          config_client.GetIntParameter(SFE_GRPC_KEEPALIVE_MS)),
+      .http2_stream_window_bytes =
+          config_client.GetIntParameter(SFE_GRPC_STREAM_WINDOW_BYTES)};
+}
+
+// Compression of the requests to the auction and buyer frontend servers.
+static inline GrpcCompressionPolicy GetCompressionPolicy(
+    const TrustedServersConfigClient& config_client) {
+  return {.min_compressed_bytes = config_client.GetIntParameter(
+              SFE_GRPC_MIN_COMPRESSED_REQUEST_BYTES)};
+}
+
+// Channel pool to the auction servers, which keeps the RPCs in `local_zone`
+// if the auction servers of each zone are configured, and away from the
+// auction servers reporting long Roma waits if enabled.
+static inline GrpcChannelPoolConfig GetAuctionChannelPoolConfig(
+    const TrustedServersConfigClient& config_client,
+    absl::string_view local_zone) {
+  GrpcChannelPoolConfig pool_config =
+      GetChannelPoolConfig(config_client, AUCTION_GRPC_NUM_CHANNELS);
+  absl::StatusOr<std::vector<ZonalAddress>> zonal_addresses =
+      ParseZonalAddresses(
+          config_client.GetStringParameter(AUCTION_SERVER_ZONAL_HOSTS));
+  CHECK_OK(zonal_addresses);
+  pool_config.zonal_addresses = *std::move(zonal_addresses);
+  pool_config.local_zone = std::string(local_zone);
+  pool_config.zone_spillover_rpcs =
+      config_client.GetIntParameter(AUCTION_ZONE_SPILLOVER_RPCS);
+  pool_config.load_report_wait_per_rpc = absl::Milliseconds(
+      config_client.GetIntParameter(AUCTION_LOAD_REPORT_WAIT_PER_RPC_MS));
+  return pool_config;
+}
+
+// Options for splitting the seller KV lookups into parallel requests.
+static inline HttpScoringSignalsFetchOptions GetScoringSignalsFetchOptions(
+    const TrustedServersConfigClient& config_client) {
+  HttpScoringSignalsFetchOptions options;
+  if (config_client.HasParameter(SELLER_KV_MAX_KEYS_PER_REQUEST)) {
+    options.max_keys_per_request =
+        config_client.GetIntParameter(SELLER_KV_MAX_KEYS_PER_REQUEST);
+  }
+  // Per buyer signals are merged once all of them are fetched.
+  options.scan_responses =
+      config_client.HasParameter(ENABLE_PIPELINED_SCORING_SIGNALS_FETCH) &&
+      config_client.GetBooleanParameter(ENABLE_PIPELINED_SCORING_SIGNALS_FETCH);
+  return options;
+}
+
+// Cache of the seller KV signals of render URLs, if enabled.
+static inline std::shared_ptr<ScoringSignalsCache> MayCreateScoringSignalsCache(
+    const TrustedServersConfigClient& config_client) {
+  if (!config_client.HasParameter(SCORING_SIGNALS_CACHE_TTL_MS) ||
+      config_client.GetIntParameter(SCORING_SIGNALS_CACHE_TTL_MS) <= 0) {
+    return nullptr;
+  }
+  return CreateScoringSignalsCache(
+      kScoringSignalsCacheMaxBytes,
+      absl::Milliseconds(
+          config_client.GetIntParameter(SCORING_SIGNALS_CACHE_TTL_MS)));
+}
+
 // This a utility class that acts as a wrapper for the clients that are used
 // by SellerFrontEndService.
 struct ClientRegistry {
@@ -58,8 +136,52 @@ struct ClientRegistry {
   server_common::KeyFetcherManagerInterface& key_fetcher_manager_;
   CryptoClientWrapperInterface* const crypto_client_ptr_;
   std::unique_ptr<AsyncReporter> reporting;
+  // Used to schedule hedged GetBids requests. Hedging is disabled if null.
+  server_common::Executor* executor = nullptr;
+  // Pre-parsed runtime config. The reactors parse the config client
+  // themselves if null.
+  const ConfigSnapshot<SellerFrontEndConfig>* config_snapshot = nullptr;
+  // Seller KV signals of render URLs shared across requests. Not cached if
+  // null.
+  ScoringSignalsCache* scoring_signals_cache = nullptr;
 };
 
+// Returns the clients with their config snapshot set.
+static inline ClientRegistry WithConfigSnapshot(
+    ClientRegistry clients,
+    const ConfigSnapshot<SellerFrontEndConfig>* config_snapshot) {
+  clients.config_snapshot = config_snapshot;
+  return clients;
+}
+
+// Returns the current config of the clients, or parses the config client if
+// the clients have no config snapshot.
+static inline std::shared_ptr<const SellerFrontEndConfig>
+GetSellerFrontEndConfig(const ClientRegistry& clients,
+                        const TrustedServersConfigClient& config_client) {
+  if (clients.config_snapshot != nullptr) {
+    return clients.config_snapshot->Get();
+  }
+  return std::make_shared<const SellerFrontEndConfig>(
+      ParseSellerFrontEndConfig(config_client));
+}
+
+// Returns the executor of the async work of the service: a work-stealing
+// executor if configured with workers, else the executor of an event engine.
+static inline std::unique_ptr<server_common::Executor> CreateExecutor(
+    const TrustedServersConfigClient& config_client) {
+  if (config_client.HasParameter(WORK_STEALING_EXECUTOR_WORKERS) &&
+      config_client.GetIntParameter(WORK_STEALING_EXECUTOR_WORKERS) > 0) {
+    return std::make_unique<WorkStealingExecutor>(WorkStealingExecutorOptions{
+        .num_workers =
+            config_client.GetIntParameter(WORK_STEALING_EXECUTOR_WORKERS)});
+  }
+  return std::make_unique<server_common::EventEngineExecutor>(
+      config_client.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
+          ? grpc_event_engine::experimental::CreateEventEngine()
+          : grpc_event_engine::experimental::GetDefaultEventEngine());
+}
+
 // SellerFrontEndService implements business logic to orchestrate requests
 // to the Buyers participating in an ad auction. In addition, fetch the AdTech's
 // proprietary code for scoring ads, looks up realtime seller's signals
@@ -71,18 +193,15 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
       const TrustedServersConfigClient* config_client,
       std::unique_ptr<server_common::KeyFetcherManagerInterface>
           key_fetcher_manager,
-      std::unique_ptr<CryptoClientWrapperInterface> crypto_client)
+      std::unique_ptr<CryptoClientWrapperInterface> crypto_client,
+      absl::string_view local_zone = "")
       : config_client_(*config_client),
+        config_snapshot_(ParseSellerFrontEndConfig(config_client_)),
         key_fetcher_manager_(std::move(key_fetcher_manager)),
         crypto_client_(std::move(crypto_client)),
-        executor_(std::make_unique<server_common::EventEngineExecutor>(
-            config_client_.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
-                ? grpc_event_engine::experimental::CreateEventEngine()
-                : grpc_event_engine::experimental::GetDefaultEventEngine())),
-        scoring_signals_async_provider_(
-            std::make_unique<HttpScoringSignalsAsyncProvider>(
-                CreateKVClient(), config_client_.GetBooleanParameter(
-                                      ENABLE_PROTECTED_APP_SIGNALS))),
+        executor_(CreateExecutor(config_client_)),
+        scoring_signals_async_provider_(CreateScoringSignalsAsyncProvider()),
+        scoring_signals_cache_(MayCreateScoringSignalsCache(config_client_)),
         scoring_(std::make_unique<ScoringAsyncGrpcClient>(
             key_fetcher_manager_.get(), crypto_client_.get(),
             AuctionServiceClientConfig{
@@ -91,8 +210,11 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
                         .data(),
                 .compression = config_client_.GetBooleanParameter(
                     ENABLE_AUCTION_COMPRESSION),
+                .compression_policy = GetCompressionPolicy(config_client_),
                 .secure_client =
-                    config_client_.GetBooleanParameter(AUCTION_EGRESS_TLS)})),
+                    config_client_.GetBooleanParameter(AUCTION_EGRESS_TLS),
+                .channel_pool = GetAuctionChannelPoolConfig(config_client_,
+                                                            local_zone)})),
         buyer_factory_([this]() {
           absl::StatusOr<absl::flat_hash_map<std::string, BuyerServiceEndpoint>>
               ig_owner_to_bfe_domain_map = ParseIgOwnerToBfeDomainMap(
@@ -104,8 +226,17 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
               BuyerServiceClientConfig{
                   .compression = config_client_.GetBooleanParameter(
                       ENABLE_BUYER_COMPRESSION),
+                  .compression_policy = GetCompressionPolicy(config_client_),
                   .secure_client =
-                      config_client_.GetBooleanParameter(BUYER_EGRESS_TLS)});
+                      config_client_.GetBooleanParameter(BUYER_EGRESS_TLS),
+                  .channel_pool = GetChannelPoolConfig(
+                      config_client_, BUYER_GRPC_NUM_CHANNELS),
+                  .stream_interest_groups_per_chunk =
+                      config_client_.HasParameter(
+                          GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK)
+                          ? config_client_.GetIntParameter(
+                                GET_BIDS_STREAM_INTEREST_GROUPS_PER_CHUNK)
+                          : 0});
         }()),
         clients_{
             *scoring_signals_async_provider_,
@@ -113,8 +244,27 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
             *buyer_factory_,
             *key_fetcher_manager_,
             crypto_client_.get(),
-            std::make_unique<AsyncReporter>(
-                std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()))} {
+            std::make_unique<BatchingAsyncReporter>(
+                std::make_unique<MultiCurlHttpFetcherAsync>(
+                    executor_.get(),
+                    HttpFetcherLaneOptions{
+                        .priority = HttpFetcherPriority::kLow,
+                        .max_connections = config_client_.GetIntParameter(
+                            DEBUG_REPORTING_MAX_CONNECTIONS),
+                        .max_host_connections = config_client_.GetIntParameter(
+                            DEBUG_REPORTING_MAX_PINGS_PER_HOST),
+                        .throttle_above_high_priority_pending =
+                            config_client_.GetInt64Parameter(
+                                DEBUG_REPORTING_KV_PENDING_THRESHOLD)}),
+                BatchingReporterOptions{
+                    .max_queued_reports = config_client_.GetIntParameter(
+                        DEBUG_REPORTING_MAX_QUEUED_PINGS),
+                    .max_in_flight_per_host = config_client_.GetIntParameter(
+                        DEBUG_REPORTING_MAX_PINGS_PER_HOST),
+                    .sampling_percent = config_client_.GetIntParameter(
+                        DEBUG_REPORTING_SAMPLING_PERCENT)}),
+            executor_.get(), &config_snapshot_,
+            scoring_signals_cache_.get()} {
     if (config_client_.HasParameter(SELLER_CLOUD_PLATFORMS_MAP)) {
       seller_cloud_platforms_map_ = ParseSellerCloudPlarformMap(
           config_client_.GetStringParameter(SELLER_CLOUD_PLATFORMS_MAP));
@@ -123,7 +273,9 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
 
   SellerFrontEndService(const TrustedServersConfigClient* config_client,
                         ClientRegistry clients)
-      : config_client_(*config_client), clients_(std::move(clients)) {
+      : config_client_(*config_client),
+        config_snapshot_(ParseSellerFrontEndConfig(config_client_)),
+        clients_(WithConfigSnapshot(std::move(clients), &config_snapshot_)) {
     if (config_client_.HasParameter(SELLER_CLOUD_PLATFORMS_MAP)) {
       seller_cloud_platforms_map_ = ParseSellerCloudPlarformMap(
           config_client_.GetStringParameter(SELLER_CLOUD_PLATFORMS_MAP));
@@ -133,6 +285,11 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
   std::unique_ptr<AsyncClient<GetSellerValuesInput, GetSellerValuesOutput>>
   CreateKVClient();
 
+  // Fetches the scoring signals from the TEE seller KV server with the KV v2
+  // gRPC API if its address is set, otherwise from the seller KV server.
+  std::unique_ptr<ScoringSignalsAsyncProvider>
+  CreateScoringSignalsAsyncProvider();
+
   // Selects a winning ad by running an ad auction.
   //
   // This is an rpc endpoint which will lead to further requests (rpc and http)
@@ -169,16 +326,28 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
       bidding_auction_servers::GetComponentAuctionCiphertextsResponse* response)
       override;
 
+  // Connects the channels to the Auction Service and to all the
+  // BuyerFrontEnds ahead of the first SelectAd calls, waiting until they are
+  // connected or until `deadline`. Services made with a ClientRegistry have no
+  // channels to connect.
+  ChannelConnectivity ConnectBackends(absl::Time deadline) const;
+
+  // Waits for the debug reports made so far to be sent, or until `deadline`,
+  // once the server drained. Returns false if some are left.
+  bool FlushReports(absl::Time deadline) const;
+
  private:
   const TrustedServersConfigClient& config_client_;
+  // Runtime config read by the reactors. Can be updated without a restart.
+  ConfigSnapshot<SellerFrontEndConfig> config_snapshot_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
   std::unique_ptr<server_common::Executor> executor_;
   std::unique_ptr<ScoringSignalsAsyncProvider> scoring_signals_async_provider_;
-  std::unique_ptr<ScoringAsyncClient> scoring_;
-  std::unique_ptr<ClientFactory<BuyerFrontEndAsyncClient, absl::string_view>>
-      buyer_factory_;
+  std::shared_ptr<ScoringSignalsCache> scoring_signals_cache_;
+  std::unique_ptr<ScoringAsyncGrpcClient> scoring_;
+  std::unique_ptr<BuyerFrontEndAsyncClientFactory> buyer_factory_;
   const ClientRegistry clients_;
   absl::flat_hash_map<std::string, server_common::CloudPlatform>
       seller_cloud_platforms_map_;
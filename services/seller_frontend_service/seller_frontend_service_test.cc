@@ -274,6 +274,50 @@ TYPED_TEST(SellerFrontEndServiceTest, ReturnsInvalidInputOnEmptyBuyerList) {
   ASSERT_EQ(status.error_message(), kEmptyBuyerList);
 }
 
+TYPED_TEST(SellerFrontEndServiceTest, ReturnsInvalidInputOnTooManyBuyers) {
+  this->config_.SetFlagForTest(kSampleSellerDomain, SELLER_ORIGIN_DOMAIN);
+
+  server_common::MockKeyFetcherManager key_fetcher_manager;
+  EXPECT_CALL(key_fetcher_manager, GetPrivateKey)
+      .WillRepeatedly(Return(GetPrivateKey()));
+  // Reporting Client.
+  std::unique_ptr<MockAsyncReporter> async_reporter =
+      std::make_unique<MockAsyncReporter>(
+          std::make_unique<MockHttpFetcherAsync>());
+  auto async_provider =
+      MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>();
+  auto scoring = ScoringAsyncClientMock();
+  auto bfe_client = BuyerFrontEndAsyncClientFactoryMock();
+  ClientRegistry clients{async_provider,
+                         scoring,
+                         bfe_client,
+                         key_fetcher_manager,
+                         /* crypto_client= */ nullptr,
+                         std::move(async_reporter)};
+
+  SellerFrontEndService seller_frontend_service(&this->config_,
+                                                std::move(clients));
+  auto start_sfe_result = StartLocalService(&seller_frontend_service);
+  auto stub = CreateServiceStub<SellerFrontEnd>(start_sfe_result.port);
+
+  grpc::ClientContext context;
+  auto [protected_auction_input, request, encryption_context] =
+      GetSampleSelectAdRequest<TypeParam>(CLIENT_TYPE_ANDROID,
+                                          kSampleSellerDomain);
+  for (int i = request.auction_config().buyer_list_size();
+       i <= AsyncTaskTracker::kMaxTasksToTrack; ++i) {
+    request.mutable_auction_config()->add_buyer_list(absl::StrCat("buyer", i));
+  }
+  SelectAdResponse response;
+  grpc::Status status = stub->SelectAd(&context, request, &response);
+
+  ASSERT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+  ASSERT_EQ(status.error_message(),
+            absl::StrFormat(kTooManyBuyers,
+                            AsyncTaskTracker::kMaxTasksToTrack + 1,
+                            AsyncTaskTracker::kMaxTasksToTrack));
+}
+
 TYPED_TEST(SellerFrontEndServiceTest,
            ReturnsInvalidInputOnInvalidSellerCurrency) {
   this->config_.SetFlagForTest(kSampleSellerDomain, SELLER_ORIGIN_DOMAIN);
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/auction_critical_path.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "services/common/util/json_span_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+int64_t ToMicros(absl::Duration duration) {
+  return absl::ToInt64Microseconds(duration);
+}
+
+// Walks the stages of the critical path in order, attributing to each the
+// time from the end of the previous one to its own end.
+class PathBuilder {
+ public:
+  explicit PathBuilder(AuctionCriticalPathResult& result) : result_(result) {}
+
+  void Add(AuctionStage stage, std::optional<absl::Duration> end) {
+    if (!end.has_value()) {
+      return;
+    }
+    result_.stage_durations[static_cast<int>(stage)] +=
+        std::max(*end - previous_end_, absl::ZeroDuration());
+    previous_end_ = std::max(previous_end_, *end);
+  }
+
+  absl::Duration previous_end() const { return previous_end_; }
+
+ private:
+  AuctionCriticalPathResult& result_;
+  absl::Duration previous_end_ = absl::ZeroDuration();
+};
+
+}  // namespace
+
+std::string AuctionCriticalPathResult::ToJson() const {
+  std::string json = absl::StrCat("{\"total_us\":", ToMicros(total),
+                                  ",\"stages_us\":{");
+  for (int i = 0; i < kNumAuctionStages; ++i) {
+    absl::StrAppend(&json, i > 0 ? "," : "", "\"", kAuctionStageNames[i],
+                    "\":", ToMicros(stage_durations[i]));
+  }
+  json.append("},\"buyer\":");
+  AppendJsonString(buyer, json);
+  absl::StrAppend(&json, ",\"buyer_us\":", ToMicros(buyer_duration), "}");
+  return json;
+}
+
+void AuctionCriticalPath::EndDecode(absl::Duration at) {
+  if (enabled_) {
+    absl::MutexLock lock(&mu_);
+    decode_end_ = at;
+  }
+}
+
+void AuctionCriticalPath::EndGetBids(absl::string_view buyer,
+                                     absl::Duration at) {
+  if (enabled_) {
+    absl::MutexLock lock(&mu_);
+    buyers_[buyer].get_bids_end = at;
+  }
+}
+
+void AuctionCriticalPath::EndBuyerScoringSignals(absl::string_view buyer,
+                                                 absl::Duration at) {
+  if (enabled_) {
+    absl::MutexLock lock(&mu_);
+    buyers_[buyer].scoring_signals_end = at;
+  }
+}
+
+void AuctionCriticalPath::EndScoringSignals(absl::Duration at) {
+  if (enabled_) {
+    absl::MutexLock lock(&mu_);
+    scoring_signals_end_ = at;
+  }
+}
+
+void AuctionCriticalPath::EndScoreAds(absl::Duration at) {
+  if (enabled_) {
+    absl::MutexLock lock(&mu_);
+    score_ads_end_ = at;
+  }
+}
+
+std::optional<AuctionCriticalPathResult> AuctionCriticalPath::Compute(
+    absl::Duration end) const {
+  if (!enabled_) {
+    return std::nullopt;
+  }
+  AuctionCriticalPathResult result;
+  PathBuilder path(result);
+  absl::MutexLock lock(&mu_);
+  path.Add(AuctionStage::kDecode, decode_end_);
+
+  // The scoring waits for every buyer, so the buyer ready last gates it.
+  const BuyerStages* gating_stages = nullptr;
+  absl::Duration gating_ready_at;
+  for (const auto& [buyer, stages] : buyers_) {
+    if (!stages.get_bids_end.has_value()) {
+      continue;
+    }
+    const absl::Duration ready_at =
+        stages.scoring_signals_end.value_or(*stages.get_bids_end);
+    if (gating_stages == nullptr || ready_at > gating_ready_at) {
+      gating_stages = &stages;
+      gating_ready_at = ready_at;
+      result.buyer = buyer;
+    }
+  }
+  if (gating_stages != nullptr) {
+    const absl::Duration buyer_start = path.previous_end();
+    path.Add(AuctionStage::kGetBids, gating_stages->get_bids_end);
+    path.Add(AuctionStage::kScoringSignals,
+             gating_stages->scoring_signals_end);
+    result.buyer_duration = path.previous_end() - buyer_start;
+  }
+
+  path.Add(AuctionStage::kScoringSignals, scoring_signals_end_);
+  path.Add(AuctionStage::kScoreAds, score_ads_end_);
+  path.Add(AuctionStage::kReporting, end);
+  result.total = std::max(end, path.previous_end());
+  return result;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
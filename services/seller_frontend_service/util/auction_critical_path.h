@@ -0,0 +1,124 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_AUCTION_CRITICAL_PATH_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_AUCTION_CRITICAL_PATH_H_
+
+#include <array>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Stages of a SelectAd request on its critical path.
+enum class AuctionStage : int {
+  // Decrypting and decoding the request.
+  kDecode = 0,
+  // Waiting for the bids of the buyer that gated the scoring.
+  kGetBids,
+  // Waiting for the scoring signals, of that buyer when they are fetched as
+  // its bids arrive.
+  kScoringSignals,
+  // Waiting for the auction server to score the ads.
+  kScoreAds,
+  // Reporting, encrypting the response, and whatever ran after the last
+  // stage that ended, e.g. when the request failed early.
+  kReporting,
+  kNumStages,
+};
+
+inline constexpr int kNumAuctionStages =
+    static_cast<int>(AuctionStage::kNumStages);
+
+// Names of the stages, by AuctionStage, as partitions of the metrics.
+inline constexpr std::array<absl::string_view, kNumAuctionStages>
+    kAuctionStageNames = {"decode", "get_bids", "scoring_signals", "score_ads",
+                          "reporting"};
+
+// Critical path of a SelectAd request, from its start to its end.
+struct AuctionCriticalPathResult {
+  // Time attributed to each stage, by AuctionStage. The gap between the end of
+  // a stage and the start of the next one, e.g. filtering the bids, is
+  // attributed to the next one, so the durations add up to the total.
+  std::array<absl::Duration, kNumAuctionStages> stage_durations = {};
+  // Buyer whose bids, and scoring signals if fetched per buyer, were ready
+  // last and gated the scoring. Empty if no buyer responded.
+  std::string buyer;
+  // Time the path spent waiting for that buyer.
+  absl::Duration buyer_duration;
+  absl::Duration total;
+
+  // Structured record of the path, as a JSON object.
+  std::string ToJson() const;
+};
+
+// Tracks when the stages of a SelectAd request end, per buyer for those that
+// run per buyer, to work out at the end of the request which stage and which
+// buyer its latency went to. The stages depend on each other as
+//
+//   decode -> get_bids of each buyer -> [scoring_signals of the buyer] ->
+//     [scoring_signals] -> score_ads -> reporting
+//
+// so the critical path goes through the buyer that was ready last. Only a
+// sampled share of the requests is tracked, as the phase timers are, and the
+// calls are a single branch for the others. Thread-safe.
+class AuctionCriticalPath {
+ public:
+  explicit AuctionCriticalPath(bool enabled) : enabled_(enabled) {}
+
+  // AuctionCriticalPath is neither copyable nor movable.
+  AuctionCriticalPath(const AuctionCriticalPath&) = delete;
+  AuctionCriticalPath& operator=(const AuctionCriticalPath&) = delete;
+
+  bool enabled() const { return enabled_; }
+
+  // The times passed to the methods below are relative to the start of the
+  // request.
+  void EndDecode(absl::Duration at);
+  void EndGetBids(absl::string_view buyer, absl::Duration at);
+  // Ends the fetch of the scoring signals of a buyer, as its bids arrived.
+  void EndBuyerScoringSignals(absl::string_view buyer, absl::Duration at);
+  // Ends the fetch of the scoring signals of every buyer, once all the bids
+  // arrived.
+  void EndScoringSignals(absl::Duration at);
+  void EndScoreAds(absl::Duration at);
+
+  // Returns the critical path of the request ending at `end`, if tracked.
+  std::optional<AuctionCriticalPathResult> Compute(absl::Duration end) const;
+
+ private:
+  struct BuyerStages {
+    std::optional<absl::Duration> get_bids_end;
+    std::optional<absl::Duration> scoring_signals_end;
+  };
+
+  const bool enabled_;
+  mutable absl::Mutex mu_;
+  std::optional<absl::Duration> decode_end_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, BuyerStages> buyers_ ABSL_GUARDED_BY(mu_);
+  std::optional<absl::Duration> scoring_signals_end_ ABSL_GUARDED_BY(mu_);
+  std::optional<absl::Duration> score_ads_end_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_AUCTION_CRITICAL_PATH_H_
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/auction_critical_path.h"
+
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+absl::Duration Ms(int ms) { return absl::Milliseconds(ms); }
+
+absl::Duration StageDuration(const AuctionCriticalPathResult& result,
+                             AuctionStage stage) {
+  return result.stage_durations[static_cast<int>(stage)];
+}
+
+TEST(AuctionCriticalPathTest, NotComputedIfDisabled) {
+  AuctionCriticalPath critical_path(/*enabled=*/false);
+  critical_path.EndDecode(Ms(1));
+  EXPECT_FALSE(critical_path.Compute(Ms(2)).has_value());
+}
+
+TEST(AuctionCriticalPathTest, GoesThroughBuyerReadyLast) {
+  AuctionCriticalPath critical_path(/*enabled=*/true);
+  critical_path.EndDecode(Ms(2));
+  critical_path.EndGetBids("fast", Ms(10));
+  critical_path.EndGetBids("slow", Ms(50));
+  critical_path.EndScoringSignals(Ms(60));
+  critical_path.EndScoreAds(Ms(90));
+
+  std::optional<AuctionCriticalPathResult> result =
+      critical_path.Compute(Ms(95));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->buyer, "slow");
+  EXPECT_EQ(result->buyer_duration, Ms(48));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kDecode), Ms(2));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kGetBids), Ms(48));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kScoringSignals), Ms(10));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kScoreAds), Ms(30));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kReporting), Ms(5));
+  EXPECT_EQ(result->total, Ms(95));
+}
+
+TEST(AuctionCriticalPathTest, CountsScoringSignalsFetchedPerBuyer) {
+  AuctionCriticalPath critical_path(/*enabled=*/true);
+  critical_path.EndDecode(Ms(2));
+  // The bids of "a" arrive last, but its scoring signals are ready first.
+  critical_path.EndGetBids("a", Ms(40));
+  critical_path.EndBuyerScoringSignals("a", Ms(45));
+  critical_path.EndGetBids("b", Ms(20));
+  critical_path.EndBuyerScoringSignals("b", Ms(70));
+  critical_path.EndScoreAds(Ms(80));
+
+  std::optional<AuctionCriticalPathResult> result =
+      critical_path.Compute(Ms(80));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->buyer, "b");
+  EXPECT_EQ(result->buyer_duration, Ms(68));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kGetBids), Ms(18));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kScoringSignals), Ms(50));
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kReporting),
+            absl::ZeroDuration());
+}
+
+TEST(AuctionCriticalPathTest, AttributesRestOfFailedRequestToReporting) {
+  AuctionCriticalPath critical_path(/*enabled=*/true);
+  critical_path.EndDecode(Ms(3));
+
+  std::optional<AuctionCriticalPathResult> result =
+      critical_path.Compute(Ms(10));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_TRUE(result->buyer.empty());
+  EXPECT_EQ(StageDuration(*result, AuctionStage::kReporting), Ms(7));
+  EXPECT_EQ(result->ToJson(),
+            "{\"total_us\":10000,\"stages_us\":{\"decode\":3000,"
+            "\"get_bids\":0,\"scoring_signals\":0,\"score_ads\":0,"
+            "\"reporting\":7000},\"buyer\":\"\",\"buyer_us\":0}");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,218 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_stream_reader.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// See https://www.rfc-editor.org/rfc/rfc8949.html#section-3 for the encoding.
+inline constexpr uint8_t kMajorTypeShift = 5;
+inline constexpr uint8_t kAdditionalInfoMask = 0x1f;
+inline constexpr uint8_t kMaxInlineArgument = 23;
+inline constexpr uint8_t kOneByteArgument = 24;
+inline constexpr uint8_t kEightByteArgument = 27;
+inline constexpr uint8_t kIndefiniteLengthInfo = 31;
+inline constexpr uint8_t kBreak = 0xff;
+
+struct ItemHeader {
+  cbor_type type;
+  // Value of ints, length of strings, number of entries of containers.
+  uint64_t argument;
+  // Set for containers of indefinite length and for breaks.
+  bool indefinite;
+};
+
+// Reads the header of the item at pos and advances past it. Returns false if
+// the header is truncated or malformed.
+bool ReadHeader(absl::string_view data, size_t& pos, ItemHeader& header) {
+  if (pos >= data.size()) {
+    return false;
+  }
+  const uint8_t initial_byte = static_cast<uint8_t>(data[pos++]);
+  header.type = static_cast<cbor_type>(initial_byte >> kMajorTypeShift);
+  const uint8_t info = initial_byte & kAdditionalInfoMask;
+  header.argument = 0;
+  header.indefinite = false;
+  if (info <= kMaxInlineArgument) {
+    header.argument = info;
+  } else if (info <= kEightByteArgument) {
+    const size_t num_bytes = size_t{1} << (info - kOneByteArgument);
+    if (data.size() - pos < num_bytes) {
+      return false;
+    }
+    for (size_t i = 0; i < num_bytes; ++i) {
+      header.argument =
+          (header.argument << 8) | static_cast<uint8_t>(data[pos++]);
+    }
+  } else if (info == kIndefiniteLengthInfo) {
+    switch (header.type) {
+      case CBOR_TYPE_ARRAY:
+      case CBOR_TYPE_MAP:
+      case CBOR_TYPE_FLOAT_CTRL:
+        header.indefinite = true;
+        break;
+      default:
+        return false;
+    }
+  } else {
+    // Reserved additional information.
+    return false;
+  }
+  return true;
+}
+
+// Advances pos past the item at pos, with all its nested items. Returns false
+// if the item is not well-formed.
+bool SkipItem(absl::string_view data, size_t& pos) {
+  // Number of items left in each of the containers the item is nested in.
+  absl::InlinedVector<uint64_t, 16> pending = {1};
+  while (!pending.empty()) {
+    uint64_t& remaining = pending.back();
+    if (remaining == CborStreamReader::kIndefiniteLength) {
+      if (pos >= data.size()) {
+        return false;
+      }
+      if (static_cast<uint8_t>(data[pos]) == kBreak) {
+        ++pos;
+        pending.pop_back();
+        continue;
+      }
+    } else if (remaining == 0) {
+      pending.pop_back();
+      continue;
+    } else {
+      --remaining;
+    }
+
+    ItemHeader header;
+    if (!ReadHeader(data, pos, header)) {
+      return false;
+    }
+    // Every nested item takes at least a byte, which bounds the lengths
+    // before they are used.
+    const uint64_t bytes_left = data.size() - pos;
+    switch (header.type) {
+      case CBOR_TYPE_BYTESTRING:
+      case CBOR_TYPE_STRING:
+        if (header.argument > bytes_left) {
+          return false;
+        }
+        pos += header.argument;
+        break;
+      case CBOR_TYPE_ARRAY:
+        if (header.indefinite) {
+          pending.push_back(CborStreamReader::kIndefiniteLength);
+        } else if (header.argument > bytes_left) {
+          return false;
+        } else {
+          pending.push_back(header.argument);
+        }
+        break;
+      case CBOR_TYPE_MAP:
+        if (header.indefinite) {
+          pending.push_back(CborStreamReader::kIndefiniteLength);
+        } else if (header.argument > bytes_left / 2) {
+          return false;
+        } else {
+          pending.push_back(2 * header.argument);
+        }
+        break;
+      case CBOR_TYPE_TAG:
+        pending.push_back(1);
+        break;
+      case CBOR_TYPE_FLOAT_CTRL:
+        // A break outside of a container of indefinite length.
+        if (header.indefinite) {
+          return false;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool CborStreamReader::IsWellFormed(absl::string_view data) {
+  size_t pos = 0;
+  return SkipItem(data, pos);
+}
+
+cbor_type CborStreamReader::PeekType() const {
+  DCHECK_LT(pos_, data_.size());
+  return static_cast<cbor_type>(static_cast<uint8_t>(data_[pos_]) >>
+                                kMajorTypeShift);
+}
+
+bool CborStreamReader::IsInt() const {
+  const cbor_type type = PeekType();
+  return type == CBOR_TYPE_UINT || type == CBOR_TYPE_NEGINT;
+}
+
+bool CborStreamReader::IsString() const {
+  return PeekType() == CBOR_TYPE_STRING;
+}
+
+bool CborStreamReader::IsArray() const { return PeekType() == CBOR_TYPE_ARRAY; }
+
+bool CborStreamReader::IsMap() const { return PeekType() == CBOR_TYPE_MAP; }
+
+absl::string_view CborStreamReader::ReadString() {
+  ItemHeader header;
+  CHECK(ReadHeader(data_, pos_, header));
+  DCHECK(header.type == CBOR_TYPE_STRING ||
+         header.type == CBOR_TYPE_BYTESTRING);
+  absl::string_view value = data_.substr(pos_, header.argument);
+  pos_ += header.argument;
+  return value;
+}
+
+uint64_t CborStreamReader::ReadInt() {
+  ItemHeader header;
+  CHECK(ReadHeader(data_, pos_, header));
+  DCHECK(header.type == CBOR_TYPE_UINT || header.type == CBOR_TYPE_NEGINT);
+  return header.argument;
+}
+
+uint64_t CborStreamReader::ReadContainerHeader() {
+  ItemHeader header;
+  CHECK(ReadHeader(data_, pos_, header));
+  DCHECK(header.type == CBOR_TYPE_ARRAY || header.type == CBOR_TYPE_MAP);
+  return header.indefinite ? kIndefiniteLength : header.argument;
+}
+
+bool CborStreamReader::NextEntry(uint64_t& remaining) {
+  if (remaining == kIndefiniteLength) {
+    if (pos_ < data_.size() && static_cast<uint8_t>(data_[pos_]) == kBreak) {
+      ++pos_;
+      return false;
+    }
+    return true;
+  }
+  if (remaining == 0) {
+    return false;
+  }
+  --remaining;
+  return true;
+}
+
+void CborStreamReader::Skip() { CHECK(SkipItem(data_, pos_)); }
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_STREAM_READER_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_STREAM_READER_H_
+
+#include <cstdint>
+#include <limits>
+
+#include "absl/strings/string_view.h"
+
+#include "cbor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Reads a CBOR data item item by item, straight from the encoded buffer, as
+// opposed to cbor_load which first builds a tree of cbor_item_t. Strings are
+// returned as views into the buffer, so the buffer must outlive the reader and
+// the views.
+//
+// The reader does not validate as it reads. Callers must check the buffer with
+// IsWellFormed before reading from it, and must only read an item with the
+// method matching its type. The reader is cheap to copy, a copy can be used to
+// come back to an item later.
+class CborStreamReader {
+ public:
+  // Returned as the number of entries of arrays and maps of indefinite length,
+  // which are terminated by a break instead.
+  static constexpr uint64_t kIndefiniteLength =
+      std::numeric_limits<uint64_t>::max();
+
+  // Checks that data starts with a single well-formed data item. As with
+  // cbor_load, bytes after the item are ignored. Strings of indefinite length
+  // are not supported and are reported as malformed.
+  static bool IsWellFormed(absl::string_view data);
+
+  explicit CborStreamReader(absl::string_view data) : data_(data) {}
+
+  // Type of the next item. The types are the ones of libcbor, so that errors
+  // read the same as for cbor_item_t.
+  cbor_type PeekType() const;
+  bool IsInt() const;
+  bool IsString() const;
+  bool IsArray() const;
+  bool IsMap() const;
+
+  // Reads a text string or a bytestring.
+  absl::string_view ReadString();
+
+  // Reads an int. As cbor_get_int, returns the encoded value, which is
+  // -1 - value for negative ints.
+  uint64_t ReadInt();
+
+  // Reads the header of an array or a map and returns its number of entries
+  // (key-value pairs for maps), or kIndefiniteLength. The entries are then
+  // iterated with NextEntry.
+  uint64_t ReadContainerHeader();
+
+  // Returns whether another entry of the container is left, given the number
+  // of entries remaining as returned by ReadContainerHeader. Consumes the
+  // break closing containers of indefinite length.
+  bool NextEntry(uint64_t& remaining);
+
+  // Skips the next item, with all the items nested in it.
+  void Skip();
+
+ private:
+  absl::string_view data_;
+  size_t pos_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_STREAM_READER_H_
@@ -0,0 +1,147 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_stream_reader.h"
+
+#include <string>
+
+#include "absl/strings/escaping.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string FromHex(absl::string_view hex) {
+  return absl::HexStringToBytes(hex);
+}
+
+TEST(CborStreamReaderTest, ReadsNestedItems) {
+  // {"a": [1, -2, "xy"], "b": h'00'}
+  const std::string data = FromHex("a2616183012162787961624100");
+  ASSERT_TRUE(CborStreamReader::IsWellFormed(data));
+
+  CborStreamReader reader(data);
+  ASSERT_TRUE(reader.IsMap());
+  uint64_t remaining = reader.ReadContainerHeader();
+  EXPECT_EQ(remaining, 2);
+
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  ASSERT_TRUE(reader.IsString());
+  EXPECT_EQ(reader.ReadString(), "a");
+  ASSERT_TRUE(reader.IsArray());
+  uint64_t array_remaining = reader.ReadContainerHeader();
+  ASSERT_TRUE(reader.NextEntry(array_remaining));
+  ASSERT_TRUE(reader.IsInt());
+  EXPECT_EQ(reader.PeekType(), CBOR_TYPE_UINT);
+  EXPECT_EQ(reader.ReadInt(), 1);
+  ASSERT_TRUE(reader.NextEntry(array_remaining));
+  EXPECT_EQ(reader.PeekType(), CBOR_TYPE_NEGINT);
+  // Encoded as -1 - 1, as returned by cbor_get_int.
+  EXPECT_EQ(reader.ReadInt(), 1);
+  ASSERT_TRUE(reader.NextEntry(array_remaining));
+  EXPECT_EQ(reader.ReadString(), "xy");
+  EXPECT_FALSE(reader.NextEntry(array_remaining));
+
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  EXPECT_EQ(reader.ReadString(), "b");
+  EXPECT_EQ(reader.PeekType(), CBOR_TYPE_BYTESTRING);
+  EXPECT_EQ(reader.ReadString(), std::string(1, '\0'));
+  EXPECT_FALSE(reader.NextEntry(remaining));
+}
+
+TEST(CborStreamReaderTest, ReadsMultiByteArguments) {
+  // [1000, 4294967296]
+  const std::string data = FromHex("821903e81b0000000100000000");
+  ASSERT_TRUE(CborStreamReader::IsWellFormed(data));
+
+  CborStreamReader reader(data);
+  uint64_t remaining = reader.ReadContainerHeader();
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  EXPECT_EQ(reader.ReadInt(), 1000);
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  EXPECT_EQ(reader.ReadInt(), uint64_t{1} << 32);
+  EXPECT_FALSE(reader.NextEntry(remaining));
+}
+
+TEST(CborStreamReaderTest, IteratesContainersOfIndefiniteLength) {
+  // [_ 1, {_ "k": 2}], 3 follows.
+  const std::string data = FromHex("9f01bf616b02ffff03");
+  ASSERT_TRUE(CborStreamReader::IsWellFormed(data));
+
+  CborStreamReader reader(data);
+  uint64_t remaining = reader.ReadContainerHeader();
+  EXPECT_EQ(remaining, CborStreamReader::kIndefiniteLength);
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  EXPECT_EQ(reader.ReadInt(), 1);
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  uint64_t map_remaining = reader.ReadContainerHeader();
+  ASSERT_TRUE(reader.NextEntry(map_remaining));
+  EXPECT_EQ(reader.ReadString(), "k");
+  EXPECT_EQ(reader.ReadInt(), 2);
+  EXPECT_FALSE(reader.NextEntry(map_remaining));
+  EXPECT_FALSE(reader.NextEntry(remaining));
+  EXPECT_EQ(reader.ReadInt(), 3);
+}
+
+TEST(CborStreamReaderTest, SkipsNestedItems) {
+  // [{"a": [1, 2]}, 6("t"), 1.5], 7 follows.
+  const std::string data = FromHex("83a16161820102c66174f93e0007");
+  ASSERT_TRUE(CborStreamReader::IsWellFormed(data));
+
+  CborStreamReader reader(data);
+  reader.Skip();
+  EXPECT_EQ(reader.ReadInt(), 7);
+}
+
+TEST(CborStreamReaderTest, CopiesReadIndependently) {
+  // ["a", "b"]
+  const std::string data = FromHex("8261616162");
+  CborStreamReader reader(data);
+  uint64_t remaining = reader.ReadContainerHeader();
+  ASSERT_TRUE(reader.NextEntry(remaining));
+  CborStreamReader first = reader;
+  reader.Skip();
+  EXPECT_EQ(reader.ReadString(), "b");
+  EXPECT_EQ(first.ReadString(), "a");
+}
+
+TEST(CborStreamReaderTest, RejectsMalformedData) {
+  // Truncated array.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("830102")));
+  // Truncated string.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("6361")));
+  // Truncated argument.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("19ff")));
+  // Reserved additional information.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("1c")));
+  // Containers of indefinite length without a break.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("9f01")));
+  // Break outside of a container.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("ff")));
+  // Ints of indefinite length.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("1f")));
+  // Strings of indefinite length are not supported.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("7f6161ff")));
+  // Map with more entries than bytes left.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(FromHex("bb7fffffffffffffff")));
+  // Empty.
+  EXPECT_FALSE(CborStreamReader::IsWellFormed(""));
+}
+
+TEST(CborStreamReaderTest, IgnoresTrailingBytes) {
+  EXPECT_TRUE(CborStreamReader::IsWellFormed(FromHex("01ff")));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -22,8 +22,25 @@
 #include "services/common/util/oblivious_http_utils.h"
 #include "services/common/util/request_response_constants.h"
 #include "src/include/openssl/hpke.h"
+#include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+absl::Status ValidateRequestLabel(absl::string_view request_label) {
+  if (request_label != server_common::kBiddingAuctionOhttpRequestLabel &&
+      request_label !=
+          quiche::ObliviousHttpHeaderKeyConfig::kOhttpRequestLabel) {
+    return absl::Status(
+        absl::StatusCode::kInvalidArgument,
+        absl::StrCat("Request label must be one of: ",
+                     server_common::kBiddingAuctionOhttpRequestLabel, ", ",
+                     quiche::ObliviousHttpHeaderKeyConfig::kOhttpRequestLabel));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
 
 absl::StatusOr<std::unique_ptr<OhttpHpkeDecryptedMessage>>
 DecryptOHTTPEncapsulatedHpkeCiphertext(
@@ -85,19 +102,9 @@ DecryptOHTTPEncapsulatedHpkeCiphertext(
       *ohttp_request, *private_key, parsed_encapsulated_request->request_label);
 }
 
-absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
-    std::string plaintext, absl::string_view request_label,
+absl::StatusOr<HpkePublicKey> GetHpkePublicKey(
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
     const server_common::CloudPlatform& cloud_platform) {
-  if (request_label != server_common::kBiddingAuctionOhttpRequestLabel &&
-      request_label !=
-          quiche::ObliviousHttpHeaderKeyConfig::kOhttpRequestLabel) {
-    return absl::Status(
-        absl::StatusCode::kInvalidArgument,
-        absl::StrCat("Request label must be one of: ",
-                     server_common::kBiddingAuctionOhttpRequestLabel, ", ",
-                     quiche::ObliviousHttpHeaderKeyConfig::kOhttpRequestLabel));
-  }
   auto public_key = key_fetcher_manager.GetPublicKey(cloud_platform);
   if (!public_key.ok()) {
     std::string error =
@@ -107,16 +114,23 @@ absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
     return absl::InternalError(std::move(error));
   }
 
-  std::string unescaped_public_key_bytes;
+  HpkePublicKey hpke_public_key;
   if (!absl::Base64Unescape(public_key->public_key(),
-                            &unescaped_public_key_bytes)) {
+                            &hpke_public_key.key_bytes)) {
     return absl::InternalError(
         absl::StrCat("Failed to base64 decode the fetched public key: ",
                      public_key->public_key()));
   }
+  hpke_public_key.key_id = std::stoi(public_key->key_id());
+  return hpke_public_key;
+}
 
+absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
+    std::string plaintext, absl::string_view request_label,
+    const HpkePublicKey& public_key) {
+  PS_RETURN_IF_ERROR(ValidateRequestLabel(request_label));
   auto request = ToObliviousHTTPRequest(
-      plaintext, unescaped_public_key_bytes, std::stoi(public_key->key_id()),
+      plaintext, public_key.key_bytes, public_key.key_id,
       // Must match the ones used by server_common::DecryptEncapsulatedRequest.
       EVP_HPKE_DHKEM_X25519_HKDF_SHA256, EVP_HPKE_HKDF_SHA256,
       EVP_HPKE_AES_256_GCM, request_label);
@@ -126,6 +140,17 @@ absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
   return OhttpHpkeEncryptedMessage(*std::move(request), request_label);
 }
 
+absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
+    std::string plaintext, absl::string_view request_label,
+    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+    const server_common::CloudPlatform& cloud_platform) {
+  PS_RETURN_IF_ERROR(ValidateRequestLabel(request_label));
+  PS_ASSIGN_OR_RETURN(HpkePublicKey public_key,
+                      GetHpkePublicKey(key_fetcher_manager, cloud_platform));
+  return HpkeEncryptAndOHTTPEncapsulate(std::move(plaintext), request_label,
+                                        public_key);
+}
+
 OhttpHpkeEncryptedMessage::OhttpHpkeEncryptedMessage(
     quiche::ObliviousHttpRequest ohttp_request, absl::string_view request_label)
     // Prepend with a zero byte to follow the new B&A request format that uses
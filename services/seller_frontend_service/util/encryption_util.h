@@ -17,6 +17,7 @@
 #ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_ENCRYPTION_UTIL_H_
 #define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_ENCRYPTION_UTIL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -90,6 +91,25 @@ struct OhttpHpkeEncryptedMessage {
                                      absl::string_view request_label);
 };
 
+// Public key of a cloud platform, fetched and decoded once to encrypt many
+// payloads with.
+struct HpkePublicKey {
+  // Decoded key bytes.
+  std::string key_bytes;
+
+  uint8_t key_id;
+};
+
+// Fetches the public key of the cloud platform and decodes it.
+absl::StatusOr<HpkePublicKey> GetHpkePublicKey(
+    server_common::KeyFetcherManagerInterface& key_fetcher_manager,
+    const server_common::CloudPlatform& cloud_platform);
+
+// As below, with a public key already fetched with GetHpkePublicKey.
+absl::StatusOr<OhttpHpkeEncryptedMessage> HpkeEncryptAndOHTTPEncapsulate(
+    std::string plaintext, absl::string_view request_label,
+    const HpkePublicKey& public_key);
+
 // Encrypt a payload using HPKE key and encapsulate in OHTTP format.
 // It first creates an OHTTP object with CreateClientObliviousRequest
 // and then encrypts it using EncapsulateAndSerialize.
@@ -16,13 +16,20 @@
 #include <algorithm>
 
 #include "absl/numeric/bits.h"
+#include "services/common/compression/gzip.h"
 #include "services/common/util/request_response_constants.h"
+#include "src/communication/encoding_utils.h"
+#include "src/util/status_macro/status_macros.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 // 1 byte for version + compression details.
 constexpr int kVersionCompressionSize = 1;
 
+// The version is in the 3 high bits of the byte, the compression in the 5 low
+// bits.
+constexpr uint8_t kCompressionMask = 0x1F;
+
 // 4-bytes specifying the size of the actual payload.
 constexpr int kPayloadLength = 4;
 
@@ -37,4 +44,34 @@ size_t GetEncodedDataSize(size_t encapsulated_payload_size) {
   return std::max(absl::bit_ceil(total_payload_size), kMinAuctionResultBytes);
 }
 
+absl::StatusOr<std::string> CompressAndFrameResponse(
+    absl::string_view payload) {
+  constexpr size_t kHeaderSize = kVersionCompressionSize + kPayloadLength;
+  std::string framed(kHeaderSize, '\0');
+  // Gzip rarely grows the payload, so the buffer is not reallocated while
+  // compressing into it nor while padding it.
+  framed.reserve(GetEncodedDataSize(payload.size()));
+  PS_RETURN_IF_ERROR(GzipCompress(payload, framed));
+  const size_t compressed_size = framed.size() - kHeaderSize;
+  // Version 0 in the high bits, so the byte is the compression type.
+  framed[0] = static_cast<char>(server_common::CompressionType::kGzip);
+  for (int i = 0; i < kPayloadLength; ++i) {
+    // The size is big endian.
+    framed[kVersionCompressionSize + i] = static_cast<char>(
+        (compressed_size >> (8 * (kPayloadLength - 1 - i))) & 0xFF);
+  }
+  framed.resize(GetEncodedDataSize(compressed_size), '\0');
+  return framed;
+}
+
+absl::StatusOr<const CompressionCodec*> GetBuyerInputCodec(
+    absl::string_view framed_request) {
+  if (framed_request.empty() ||
+      (static_cast<uint8_t>(framed_request[0]) & kCompressionMask) !=
+          kBuyerInputDictionaryCompression) {
+    return GetCompressionCodec(kGzipCodec);
+  }
+  return GetCompressionCodec(kBuyerInputDictionaryCodec);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,15 +18,46 @@
 #define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_FRAMING_UTILS_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "services/common/compression/compression_codec.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Name of the codec of the buyer inputs compressed with the dictionary that
+// the seller publishes to its clients. The dictionary is trained on buyer
+// inputs, whose interest group names and keys repeat across clients.
+inline constexpr absl::string_view kBuyerInputDictionaryCodec =
+    "buyer-input-dictionary";
+
+// Compression bits of the version and compression byte of requests whose
+// buyer inputs are compressed with kBuyerInputDictionaryCodec instead of gzip.
+inline constexpr uint8_t kBuyerInputDictionaryCompression = 3;
+
 // Gets size of the complete payload including the preamble expected by
 // client, which is: 1 byte (containing version, compression details), 4 bytes
 // indicating the length of the actual encoded response and any other padding
 // required to make the complete payload a power of 2.
 size_t GetEncodedDataSize(size_t encapsulated_payload_size);
 
+// Gzip compresses the payload and frames it into a response plaintext laid
+// out as server_common::EncodeResponsePayload does, padded to
+// GetEncodedDataSize of the compressed size. The compressed payload is written
+// straight into the framed buffer, which can then be moved into encryption,
+// instead of being copied into it.
+absl::StatusOr<std::string> CompressAndFrameResponse(absl::string_view payload);
+
+// Returns the codec the buyer inputs of the framed request are compressed
+// with, given by the compression bits of its first byte: gzip unless they are
+// kBuyerInputDictionaryCompression. Fails if the request uses the dictionary
+// codec but none is registered.
+absl::StatusOr<const CompressionCodec*> GetBuyerInputCodec(
+    absl::string_view framed_request);
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_FRAMING_UTILS_H_
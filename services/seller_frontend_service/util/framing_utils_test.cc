@@ -0,0 +1,67 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/framing_utils.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "services/common/compression/gzip.h"
+#include "src/communication/encoding_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns a framed request of version 0 with the given compression bits.
+std::string MakeFramedRequest(uint8_t compression) {
+  return std::string(1, static_cast<char>(compression)) + "payload";
+}
+
+TEST(GetBuyerInputCodecTest, UsesGzipUnlessTheDictionaryIsRequested) {
+  const CompressionCodec* gzip = *GetCompressionCodec(kGzipCodec);
+  EXPECT_EQ(*GetBuyerInputCodec(MakeFramedRequest(0)), gzip);
+  EXPECT_EQ(*GetBuyerInputCodec(MakeFramedRequest(2)), gzip);
+  // The version bits are ignored.
+  EXPECT_EQ(*GetBuyerInputCodec(MakeFramedRequest(0xE2)), gzip);
+  EXPECT_EQ(*GetBuyerInputCodec(""), gzip);
+}
+
+TEST(GetBuyerInputCodecTest, UsesTheRegisteredDictionaryCodec) {
+  const std::string request =
+      MakeFramedRequest(0x20 | kBuyerInputDictionaryCompression);
+  EXPECT_FALSE(GetBuyerInputCodec(request).ok());
+
+  ASSERT_TRUE(RegisterCompressionCodec(kBuyerInputDictionaryCodec,
+                                       CreateDeflateCodec("interest group"))
+                  .ok());
+  EXPECT_EQ(*GetBuyerInputCodec(request),
+            *GetCompressionCodec(kBuyerInputDictionaryCodec));
+}
+
+TEST(CompressAndFrameResponseTest, MatchesEncodeResponsePayload) {
+  const std::string payload(3000, 'a');
+  absl::StatusOr<std::string> framed = CompressAndFrameResponse(payload);
+  ASSERT_TRUE(framed.ok()) << framed.status();
+
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok());
+  absl::StatusOr<std::string> expected = server_common::EncodeResponsePayload(
+      server_common::CompressionType::kGzip, *compressed,
+      GetEncodedDataSize(compressed->size()));
+  ASSERT_TRUE(expected.ok());
+  EXPECT_EQ(*framed, *expected);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
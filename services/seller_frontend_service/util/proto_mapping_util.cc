@@ -14,6 +14,12 @@
 
 #include "services/seller_frontend_service/util/proto_mapping_util.h"
 
+#include <algorithm>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/util/parallel_for.h"
 #include "services/seller_frontend_service/util/framing_utils.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -88,31 +94,43 @@ AuctionResult MapAdScoreToAuctionResult(
   return auction_result;
 }
 
-absl::StatusOr<std::string> PackageAuctionResultCiphertext(
-    absl::string_view serialized_auction_result,
-    OhttpHpkeDecryptedMessage& decrypted_request) {
+// Compresses, frames and pads a serialized auction result into the plaintext
+// of its ciphertext.
+absl::StatusOr<std::string> EncodeAuctionResultPlaintext(
+    absl::string_view serialized_auction_result) {
   // Gzip compress.
   PS_ASSIGN_OR_RETURN(std::string compressed_data,
                       GzipCompress(serialized_auction_result));
 
   // Frame(set bits) and pad.
-  PS_ASSIGN_OR_RETURN(
-      std::string encoded_plaintext,
-      server_common::EncodeResponsePayload(
-          server_common::CompressionType::kGzip, compressed_data,
-          GetEncodedDataSize(compressed_data.size())));
+  return server_common::EncodeResponsePayload(
+      server_common::CompressionType::kGzip, compressed_data,
+      GetEncodedDataSize(compressed_data.size()));
+}
 
+absl::StatusOr<std::string> EncryptAuctionResultPlaintext(
+    std::string encoded_plaintext,
+    OhttpHpkeDecryptedMessage& decrypted_request) {
   // Encapsulate and encrypt with corresponding private key.
   return server_common::EncryptAndEncapsulateResponse(
       std::move(encoded_plaintext), decrypted_request.private_key,
       decrypted_request.context, decrypted_request.request_label);
 }
 
-absl::StatusOr<std::string> PackageAuctionResultForWeb(
+absl::StatusOr<std::string> PackageAuctionResultCiphertext(
+    absl::string_view serialized_auction_result,
+    OhttpHpkeDecryptedMessage& decrypted_request) {
+  PS_ASSIGN_OR_RETURN(std::string encoded_plaintext,
+                      EncodeAuctionResultPlaintext(serialized_auction_result));
+  return EncryptAuctionResultPlaintext(std::move(encoded_plaintext),
+                                       decrypted_request);
+}
+
+absl::StatusOr<std::string> SerializeAuctionResultForWeb(
     const std::optional<ScoreAdsResponse::AdScore>& high_score,
     const std::optional<IgsWithBidsMap>& maybe_bidding_group_map,
     const std::optional<AuctionResult::Error>& error,
-    OhttpHpkeDecryptedMessage& decrypted_request, ContextImpl& log_context) {
+    ContextImpl& log_context) {
   std::string error_msg;
   absl::Notification wait_for_error_callback;
   auto error_handler = [&wait_for_error_callback,
@@ -142,21 +160,103 @@ absl::StatusOr<std::string> PackageAuctionResultForWeb(
                                 : result.status().ToString();
            }(*serialized_data);
   }
-  absl::string_view data_to_compress =
-      absl::string_view(reinterpret_cast<char*>((*serialized_data).data()),
-                        (*serialized_data).size());
-  return PackageAuctionResultCiphertext(data_to_compress, decrypted_request);
+  return std::move(serialized_data);
 }
 
-absl::StatusOr<std::string> PackageAuctionResultForApp(
+absl::StatusOr<std::string> PackageAuctionResultForWeb(
     const std::optional<ScoreAdsResponse::AdScore>& high_score,
+    const std::optional<IgsWithBidsMap>& maybe_bidding_group_map,
     const std::optional<AuctionResult::Error>& error,
     OhttpHpkeDecryptedMessage& decrypted_request, ContextImpl& log_context) {
+  PS_ASSIGN_OR_RETURN(std::string serialized_data,
+                      SerializeAuctionResultForWeb(
+                          high_score, maybe_bidding_group_map, error,
+                          log_context));
+  return PackageAuctionResultCiphertext(serialized_data, decrypted_request);
+}
+
+std::string SerializeAuctionResultForApp(
+    const std::optional<ScoreAdsResponse::AdScore>& high_score,
+    const std::optional<AuctionResult::Error>& error,
+    ContextImpl& log_context) {
   // Map to AuctionResult proto and serialized to bytes array.
   std::string serialized_result =
       MapAdScoreToAuctionResult(high_score, error).SerializeAsString();
   PS_VLOG(kPlain, log_context) << "AuctionResult:\n" << serialized_result;
-  return PackageAuctionResultCiphertext(serialized_result, decrypted_request);
+  return serialized_result;
+}
+
+absl::StatusOr<std::string> PackageAuctionResultForApp(
+    const std::optional<ScoreAdsResponse::AdScore>& high_score,
+    const std::optional<AuctionResult::Error>& error,
+    OhttpHpkeDecryptedMessage& decrypted_request, ContextImpl& log_context) {
+  return PackageAuctionResultCiphertext(
+      SerializeAuctionResultForApp(high_score, error, log_context),
+      decrypted_request);
+}
+
+// Caches the encoded plaintexts of the auction results without a winner,
+// i.e. chaff and errors, which only depend on the client type and the error.
+// Only their encryption is left to do per request, so that heavy chaff or
+// error traffic costs about the same as the encryption alone.
+class NoWinnerPlaintextCache {
+ public:
+  // Returns the encoded plaintext of the chaff of the client type if error is
+  // not set, otherwise of the error. The client type must be supported.
+  absl::StatusOr<std::string> Get(
+      ClientType client_type, const std::optional<AuctionResult::Error>& error,
+      ContextImpl& log_context) {
+    std::string key =
+        absl::StrCat(client_type, error.has_value() ? "e" : "c",
+                     error.has_value() ? error->SerializeAsString() : "");
+    {
+      absl::ReaderMutexLock lock(&mu_);
+      if (auto it = plaintexts_.find(key); it != plaintexts_.end()) {
+        return it->second;
+      }
+    }
+    std::string serialized_result;
+    if (client_type == CLIENT_TYPE_ANDROID) {
+      serialized_result = SerializeAuctionResultForApp(
+          /*high_score=*/std::nullopt, error, log_context);
+    } else {
+      PS_ASSIGN_OR_RETURN(
+          serialized_result,
+          SerializeAuctionResultForWeb(
+              /*high_score=*/std::nullopt,
+              /*maybe_bidding_group_map=*/std::nullopt, error, log_context));
+    }
+    PS_ASSIGN_OR_RETURN(std::string encoded_plaintext,
+                        EncodeAuctionResultPlaintext(serialized_result));
+    absl::MutexLock lock(&mu_);
+    // Error messages may vary, so the cache stops growing once full.
+    if (plaintexts_.size() < kMaxPlaintexts) {
+      plaintexts_.try_emplace(std::move(key), encoded_plaintext);
+    }
+    return encoded_plaintext;
+  }
+
+ private:
+  static constexpr int kMaxPlaintexts = 256;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::string> plaintexts_
+      ABSL_GUARDED_BY(mu_);
+};
+
+NoWinnerPlaintextCache& NoWinnerPlaintexts() {
+  static NoWinnerPlaintextCache* cache = new NoWinnerPlaintextCache();
+  return *cache;
+}
+
+absl::StatusOr<std::string> PackageNoWinnerAuctionResult(
+    ClientType client_type, const std::optional<AuctionResult::Error>& error,
+    OhttpHpkeDecryptedMessage& decrypted_request, ContextImpl& log_context) {
+  PS_ASSIGN_OR_RETURN(
+      std::string encoded_plaintext,
+      NoWinnerPlaintexts().Get(client_type, error, log_context));
+  return EncryptAuctionResultPlaintext(std::move(encoded_plaintext),
+                                       decrypted_request);
 }
 
 absl::StatusOr<std::string> PackageAuctionResultForInvalid(
@@ -202,23 +302,23 @@ CreateTopLevelScoreAdsRawRequest(
     const SelectAdRequest::AuctionConfig& auction_config,
     std::variant<ProtectedAudienceInput, ProtectedAuctionInput>&
         protected_auction_input,
-    std::vector<AuctionResult>& component_auction_results) {
+    google::protobuf::RepeatedPtrField<AuctionResult>&
+        component_auction_results) {
   auto raw_request = std::make_unique<ScoreAdsRequest::ScoreAdsRawRequest>();
   *raw_request->mutable_auction_signals() = auction_config.auction_signals();
   *raw_request->mutable_seller_signals() = auction_config.seller_signals();
   *raw_request->mutable_seller() = auction_config.seller();
   *raw_request->mutable_seller_currency() = auction_config.seller_currency();
-  // Move Component Auctions Results.
-  for (auto component_auction_itr =
-           std::make_move_iterator(component_auction_results.begin());
-       component_auction_itr !=
-       std::make_move_iterator(component_auction_results.end());
-       ++component_auction_itr) {
-    if (!component_auction_itr->is_chaff()) {
-      raw_request->mutable_component_auction_results()->Add(
-          std::move(*component_auction_itr));
-    }
-  }
+  // Move Component Auctions Results, leaving out chaff.
+  auto* raw_component_auction_results =
+      raw_request->mutable_component_auction_results();
+  raw_component_auction_results->Swap(&component_auction_results);
+  raw_component_auction_results->erase(
+      std::remove_if(
+          raw_component_auction_results->begin(),
+          raw_component_auction_results->end(),
+          [](const AuctionResult& result) { return result.is_chaff(); }),
+      raw_component_auction_results->end());
   std::visit(
       [&raw_request, &auction_config](const auto& protected_auction_input) {
         raw_request->set_publisher_hostname(
@@ -261,13 +361,9 @@ absl::StatusOr<std::string> CreateErrorAuctionResultCiphertext(
     OhttpHpkeDecryptedMessage& decrypted_request, ContextImpl& log_context) {
   switch (client_type) {
     case CLIENT_TYPE_ANDROID:
-      return PackageAuctionResultForApp(
-          /*high_score=*/std::nullopt, auction_error, decrypted_request,
-          log_context);
     case CLIENT_TYPE_BROWSER:
-      return PackageAuctionResultForWeb(
-          /*high_score=*/std::nullopt, /*maybe_bidding_group_map=*/std::nullopt,
-          auction_error, decrypted_request, log_context);
+      return PackageNoWinnerAuctionResult(client_type, auction_error,
+                                          decrypted_request, log_context);
     default:
       return PackageAuctionResultForInvalid(client_type);
   }
@@ -278,13 +374,9 @@ absl::StatusOr<std::string> CreateChaffAuctionResultCiphertext(
     ContextImpl& log_context) {
   switch (client_type) {
     case CLIENT_TYPE_ANDROID:
-      return PackageAuctionResultForApp(
-          /*high_score=*/std::nullopt, /*error =*/std::nullopt,
-          decrypted_request, log_context);
     case CLIENT_TYPE_BROWSER:
-      return PackageAuctionResultForWeb(
-          /*high_score=*/std::nullopt, /*maybe_bidding_group_map=*/std::nullopt,
-          /*error =*/std::nullopt, decrypted_request, log_context);
+      return PackageNoWinnerAuctionResult(client_type, /*error=*/std::nullopt,
+                                          decrypted_request, log_context);
     default:
       return PackageAuctionResultForInvalid(client_type);
   }
@@ -357,19 +449,30 @@ absl::StatusOr<AuctionResult> UnpackageServerAuctionComponentResult(
   return proto;
 }
 
-std::vector<AuctionResult> DecryptAndValidateComponentAuctionResults(
+DecryptedComponentAuctionResults DecryptAndValidateComponentAuctionResults(
     const SelectAdRequest* request, absl::string_view seller_domain,
     absl::string_view request_generation_id,
     CryptoClientWrapperInterface& crypto_client,
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
-    ErrorAccumulator& error_accumulator, ContextImpl& log_context) {
-  std::vector<AuctionResult> component_auction_results;
+    server_common::Executor* executor, ErrorAccumulator& error_accumulator,
+    ContextImpl& log_context) {
+  const auto& enc_auction_results = request->component_auction_results();
+  std::vector<absl::StatusOr<AuctionResult>> auction_results(
+      enc_auction_results.size(), absl::UnknownError(""));
+  // Decryption and decompression dominate, and do not depend on each other.
+  ParallelFor(executor, enc_auction_results.size(),
+              [&enc_auction_results, &auction_results, &crypto_client,
+               &key_fetcher_manager](int i) {
+                auction_results[i] = UnpackageServerAuctionComponentResult(
+                    enc_auction_results[i], crypto_client,
+                    key_fetcher_manager);
+              });
+
+  DecryptedComponentAuctionResults component_auction_results;
   // Keep track of encountered sellers.
   absl::flat_hash_set<std::string> component_sellers;
-  component_auction_results.reserve(request->component_auction_results_size());
-  for (const auto& enc_auction_result : request->component_auction_results()) {
-    auto auction_result = UnpackageServerAuctionComponentResult(
-        enc_auction_result, crypto_client, key_fetcher_manager);
+  component_auction_results.auction_results.Reserve(auction_results.size());
+  for (auto& auction_result : auction_results) {
     if (!auction_result.ok()) {
       std::string error_msg =
           absl::StrFormat(kErrorDecryptingAuctionResultError,
@@ -382,6 +485,10 @@ std::vector<AuctionResult> DecryptAndValidateComponentAuctionResults(
                                     ErrorCode::CLIENT_SIDE);
       continue;
     }
+    if (auction_result->is_chaff()) {
+      component_auction_results.has_chaff = true;
+      continue;
+    }
     PS_VLOG(kSuccess, log_context)
         << "Successfully decrypted auction result ciphertext for: "
         << auction_result->auction_params().component_seller();
@@ -409,13 +516,14 @@ std::vector<AuctionResult> DecryptAndValidateComponentAuctionResults(
       error_accumulator.ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
                                     std::move(error_msg),
                                     ErrorCode::CLIENT_SIDE);
-      // Return empty vector to abort auction.
-      return std::vector<AuctionResult>();
+      // Return no results to abort auction.
+      return DecryptedComponentAuctionResults();
     }
     PS_VLOG(kSuccess, log_context)
         << "Successfully validated auction result for: "
         << auction_result->auction_params().component_seller();
-    component_auction_results.push_back(*std::move(auction_result));
+    *component_auction_results.auction_results.Add() =
+        *std::move(auction_result);
   }
   return component_auction_results;
 }
@@ -468,33 +576,67 @@ ProtectedAuctionInput DecryptProtectedAuctionInput(
   return protected_auction_input;
 }
 
+InterestGroupIndexByName IndexInterestGroupsByName(
+    const BuyerInput& buyer_input) {
+  InterestGroupIndexByName index_by_name;
+  index_by_name.reserve(buyer_input.interest_groups_size());
+  for (int i = 0; i < buyer_input.interest_groups_size(); ++i) {
+    index_by_name.try_emplace(buyer_input.interest_groups(i).name(), i);
+  }
+  return index_by_name;
+}
+
 IgsWithBidsMap GetBiddingGroups(
     const BuyerBidsResponseMap& shared_buyer_bids_map,
-    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs) {
+    const absl::flat_hash_map<std::string, InterestGroupIndexByName>&
+        interest_group_indexes) {
   IgsWithBidsMap bidding_groups;
   for (const auto& [buyer, ad_with_bids] : shared_buyer_bids_map) {
-    // Mapping from buyer to interest groups that are associated with non-zero
-    // bids.
-    absl::flat_hash_set<absl::string_view> buyer_interest_groups;
-    for (const auto& ad_with_bid : ad_with_bids->bids()) {
-      if (ad_with_bid.bid() > 0) {
-        buyer_interest_groups.insert(ad_with_bid.interest_group_name());
-      }
-    }
-    const auto& buyer_input = buyer_inputs.at(buyer);
     AuctionResult::InterestGroupIndex ar_interest_group_index;
-    int ig_index = 0;
-    for (const auto& interest_group : buyer_input.interest_groups()) {
-      // If the interest group name is one of the groups returned by the bidding
-      // service then record its index.
-      if (buyer_interest_groups.contains(interest_group.name())) {
-        ar_interest_group_index.add_index(ig_index);
+    if (auto indexes_it = interest_group_indexes.find(buyer);
+        indexes_it != interest_group_indexes.end()) {
+      const InterestGroupIndexByName& index_by_name = indexes_it->second;
+      // Indexes of the interest groups with non-zero bids, in the order of
+      // the buyer input.
+      std::vector<int> ig_indexes;
+      for (const auto& ad_with_bid : ad_with_bids->bids()) {
+        if (ad_with_bid.bid() <= 0) {
+          continue;
+        }
+        if (auto it = index_by_name.find(ad_with_bid.interest_group_name());
+            it != index_by_name.end()) {
+          ig_indexes.push_back(it->second);
+        }
       }
-      ig_index++;
+      std::sort(ig_indexes.begin(), ig_indexes.end());
+      ig_indexes.erase(std::unique(ig_indexes.begin(), ig_indexes.end()),
+                       ig_indexes.end());
+      ar_interest_group_index.mutable_index()->Add(ig_indexes.begin(),
+                                                   ig_indexes.end());
     }
     bidding_groups.try_emplace(buyer, std::move(ar_interest_group_index));
   }
   return bidding_groups;
 }
 
+void MoveBuyerInputRetainingIgMetadata(BuyerInput& buyer_input,
+                                       BuyerInput& target) {
+  target = std::move(buyer_input);
+  buyer_input.Clear();
+  buyer_input.mutable_interest_groups()->Reserve(
+      target.interest_groups_size());
+  for (const auto& interest_group : target.interest_groups()) {
+    auto* metadata = buyer_input.add_interest_groups();
+    metadata->set_name(interest_group.name());
+    metadata->set_origin(interest_group.origin());
+    const auto& browser_signals = interest_group.browser_signals();
+    auto* metadata_browser_signals = metadata->mutable_browser_signals();
+    metadata_browser_signals->set_join_count(browser_signals.join_count());
+    metadata_browser_signals->set_recency(browser_signals.recency());
+    if (browser_signals.has_recency_ms()) {
+      metadata_browser_signals->set_recency_ms(browser_signals.recency_ms());
+    }
+  }
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
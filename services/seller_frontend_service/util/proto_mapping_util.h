@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/common/compression/gzip.h"
@@ -30,6 +31,7 @@
 #include "services/seller_frontend_service/util/validation_utils.h"
 #include "services/seller_frontend_service/util/web_utils.h"
 #include "src/communication/encoding_utils.h"
+#include "src/concurrent/executor.h"
 #include "src/encryption/key_fetcher/key_fetcher_manager.h"
 #include "src/logger/request_context_impl.h"
 #include "src/util/status_macro/status_macros.h"
@@ -58,7 +60,8 @@ CreateTopLevelScoreAdsRawRequest(
     const SelectAdRequest::AuctionConfig& auction_config,
     std::variant<ProtectedAudienceInput, ProtectedAuctionInput>&
         protected_auction_input,
-    std::vector<AuctionResult>& component_auction_results);
+    google::protobuf::RepeatedPtrField<AuctionResult>&
+        component_auction_results);
 
 // Encodes, compresses and encrypts AdScore and bidding groups map
 // as auction_result_ciphertext.
@@ -92,14 +95,25 @@ absl::StatusOr<AuctionResult> UnpackageServerAuctionComponentResult(
     CryptoClientWrapperInterface& crypto_client,
     server_common::KeyFetcherManagerInterface& key_fetcher_manager);
 
+// Component auction results of a top-level auction, once decrypted and
+// validated.
+struct DecryptedComponentAuctionResults {
+  // Valid results that are not chaff, in the order of the request.
+  google::protobuf::RepeatedPtrField<AuctionResult> auction_results;
+  // Whether any result was chaff. Chaff is dropped once decrypted, but the
+  // auction server is still called for it.
+  bool has_chaff = false;
+};
+
 // Decrypts Component Auction Result ciphertext and validate AuctionResult
-// objects.
-std::vector<AuctionResult> DecryptAndValidateComponentAuctionResults(
+// objects. The ciphertexts are decrypted and decompressed in parallel, on the
+// executor if not null.
+DecryptedComponentAuctionResults DecryptAndValidateComponentAuctionResults(
     const SelectAdRequest* request, absl::string_view seller_domain,
     absl::string_view request_generation_id,
     CryptoClientWrapperInterface& crypto_client,
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
-    ErrorAccumulator& error_accumulator,
+    server_common::Executor* executor, ErrorAccumulator& error_accumulator,
     server_common::log::ContextImpl& log_context);
 
 template <typename T>
@@ -153,11 +167,28 @@ ProtectedAuctionInput DecryptProtectedAuctionInput(
     server_common::KeyFetcherManagerInterface& key_fetcher_manager,
     ClientType client_type, ErrorAccumulator& error_accumulator);
 
-// Gets the bidding groups after scoring is done.
+// Index of each interest group of a buyer input by name, to find the interest
+// group of a bid without scanning them all. The names are views into the
+// buyer input. If names repeat, the first interest group is indexed.
+using InterestGroupIndexByName = absl::flat_hash_map<absl::string_view, int>;
+
+InterestGroupIndexByName IndexInterestGroupsByName(
+    const BuyerInput& buyer_input);
+
+// Gets the bidding groups after scoring is done, from the interest groups of
+// each buyer indexed by name.
 google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>
 GetBiddingGroups(
     const BuyerBidsResponseMap& shared_buyer_bids_map,
-    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs);
+    const absl::flat_hash_map<std::string, InterestGroupIndexByName>&
+        interest_group_indexes);
+
+// Moves buyer_input into target without copying the interest groups. Leaves
+// behind in buyer_input only the interest group fields still read once the
+// GetBids requests are sent: name, origin and the join count and recency
+// browser signals. The order of the interest groups is preserved.
+void MoveBuyerInputRetainingIgMetadata(BuyerInput& buyer_input,
+                                       BuyerInput& target);
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
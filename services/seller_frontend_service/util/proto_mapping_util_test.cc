@@ -17,6 +17,8 @@
 #include <gmock/gmock.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "gtest/gtest.h"
@@ -229,7 +231,8 @@ ScoreAdsRequest::ScoreAdsRawRequest MapScoreAdsRawRequest(
     const SelectAdRequest::AuctionConfig& auction_config,
     std::variant<ProtectedAudienceInput, ProtectedAuctionInput>&
         protected_auction_input,
-    std::vector<AuctionResult>& component_auction_results) {
+    google::protobuf::RepeatedPtrField<AuctionResult>&
+        component_auction_results) {
   ScoreAdsRequest::ScoreAdsRawRequest raw_request;
   *raw_request.mutable_auction_signals() = auction_config.auction_signals();
   *raw_request.mutable_seller_signals() = auction_config.seller_signals();
@@ -261,8 +264,7 @@ class CreateScoreAdsRawRequestTest : public ::testing::Test {
  protected:
   void SetUp() override {
     for (int i = 0; i < 10; i++) {
-      component_auctions_list_.emplace_back(
-          MakeARandomSingleSellerAuctionResult());
+      *component_auctions_list_.Add() = MakeARandomSingleSellerAuctionResult();
     }
     auto [protected_auction_input, request, context] =
         GetSampleSelectAdRequest<T>(CLIENT_TYPE_BROWSER, kTestSeller,
@@ -275,7 +277,7 @@ class CreateScoreAdsRawRequestTest : public ::testing::Test {
   }
 
  public:
-  std::vector<AuctionResult> component_auctions_list_;
+  google::protobuf::RepeatedPtrField<AuctionResult> component_auctions_list_;
   ScoreAdsRequest::ScoreAdsRawRequest expected_;
   std::variant<ProtectedAudienceInput, ProtectedAuctionInput>
       protected_auction_input_;
@@ -299,8 +301,9 @@ TYPED_TEST(CreateScoreAdsRawRequestTest, MapsAllFields) {
 TYPED_TEST(CreateScoreAdsRawRequestTest, IgnoresChaffResults) {
   AuctionResult chaff_res;
   chaff_res.set_is_chaff(true);
-  std::vector<AuctionResult> list_with_chaff = this->component_auctions_list_;
-  list_with_chaff.push_back(chaff_res);
+  google::protobuf::RepeatedPtrField<AuctionResult> list_with_chaff =
+      this->component_auctions_list_;
+  *list_with_chaff.Add() = chaff_res;
   MapScoreAdsRawRequest(this->request_.auction_config(),
                         this->protected_auction_input_,
                         this->component_auctions_list_);
@@ -518,6 +521,40 @@ TEST_F(CreateAuctionResultCiphertextTest, ConvertsChaffForWeb) {
   EXPECT_TRUE(decrypted_output.is_chaff());
 }
 
+TEST_F(CreateAuctionResultCiphertextTest, EncryptsCachedChaffPerRequest) {
+  auto first_message = MakeDecryptedMessage();
+  auto second_message = MakeDecryptedMessage();
+  auto first = CreateChaffAuctionResultCiphertext(
+      ClientType::CLIENT_TYPE_BROWSER, *first_message, *this->log_context_);
+  auto second = CreateChaffAuctionResultCiphertext(
+      ClientType::CLIENT_TYPE_BROWSER, *second_message, *this->log_context_);
+
+  ASSERT_TRUE(first.ok()) << first.status();
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_NE(*first, *second);
+  EXPECT_EQ(first->size(), second->size());
+  EXPECT_TRUE(DecryptBrowserAuctionResult(*second, second_message->context)
+                  .is_chaff());
+}
+
+TEST_F(CreateAuctionResultCiphertextTest, CachesErrorsPerMessage) {
+  auto decrypted_message = MakeDecryptedMessage();
+  AuctionResult::Error other_error = this->valid_error_;
+  other_error.set_message(absl::StrCat(other_error.message(), " other"));
+  ASSERT_TRUE(CreateErrorAuctionResultCiphertext(
+                  this->valid_error_, ClientType::CLIENT_TYPE_ANDROID,
+                  *decrypted_message, *this->log_context_)
+                  .ok());
+  decrypted_message = MakeDecryptedMessage();
+  auto output = CreateErrorAuctionResultCiphertext(
+      other_error, ClientType::CLIENT_TYPE_ANDROID, *decrypted_message,
+      *this->log_context_);
+
+  ASSERT_TRUE(output.ok()) << output.status();
+  EXPECT_THAT(DecryptAppProtoAuctionResult(*output, decrypted_message->context),
+              EqualsProto(MapBasicErrorFieldsToAuctionResult(other_error)));
+}
+
 TEST_F(CreateAuctionResultCiphertextTest, ReturnsErrorForInvalidClientChaff) {
   auto decrypted_message = MakeDecryptedMessage();
   auto output = CreateChaffAuctionResultCiphertext(
@@ -526,5 +563,71 @@ TEST_F(CreateAuctionResultCiphertextTest, ReturnsErrorForInvalidClientChaff) {
   ASSERT_FALSE(output.ok());
 }
 
+TEST(MoveBuyerInputRetainingIgMetadataTest, MovesInterestGroupsIntoTarget) {
+  BuyerInput buyer_input;
+  for (absl::string_view name : {"ig_b", "ig_a"}) {
+    auto* interest_group = buyer_input.add_interest_groups();
+    interest_group->set_name(name);
+    interest_group->set_origin("https://origin.com");
+    interest_group->set_user_bidding_signals(R"JSON({"signal": 1})JSON");
+    interest_group->add_bidding_signals_keys("key");
+    interest_group->add_ad_render_ids("ad");
+    auto* browser_signals = interest_group->mutable_browser_signals();
+    browser_signals->set_join_count(3);
+    browser_signals->set_bid_count(4);
+    browser_signals->set_recency(5);
+    browser_signals->set_recency_ms(5000);
+    browser_signals->set_prev_wins("[]");
+  }
+  const BuyerInput expected_target = buyer_input;
+
+  BuyerInput target;
+  MoveBuyerInputRetainingIgMetadata(buyer_input, target);
+
+  EXPECT_THAT(target, EqualsProto(expected_target));
+  BuyerInput expected_metadata;
+  for (absl::string_view name : {"ig_b", "ig_a"}) {
+    auto* interest_group = expected_metadata.add_interest_groups();
+    interest_group->set_name(name);
+    interest_group->set_origin("https://origin.com");
+    auto* browser_signals = interest_group->mutable_browser_signals();
+    browser_signals->set_join_count(3);
+    browser_signals->set_recency(5);
+    browser_signals->set_recency_ms(5000);
+  }
+  EXPECT_THAT(buyer_input, EqualsProto(expected_metadata));
+}
+
+TEST(GetBiddingGroupsTest, IndexesInterestGroupsWithPositiveBids) {
+  BuyerInput buyer_input;
+  for (absl::string_view name : {"ig_a", "ig_b", "ig_c", "ig_d"}) {
+    buyer_input.add_interest_groups()->set_name(name);
+  }
+  absl::flat_hash_map<std::string, InterestGroupIndexByName>
+      interest_group_indexes;
+  interest_group_indexes[kBuyer1] = IndexInterestGroupsByName(buyer_input);
+
+  auto get_bids_response =
+      std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+  for (const auto& [name, bid] :
+       std::vector<std::pair<std::string, float>>{{"ig_d", 1},
+                                                  {"ig_b", 2},
+                                                  {"ig_d", 3},
+                                                  {"ig_c", 0},
+                                                  {"ig_unknown", 4}}) {
+    auto* ad_with_bid = get_bids_response->add_bids();
+    ad_with_bid->set_interest_group_name(name);
+    ad_with_bid->set_bid(bid);
+  }
+  BuyerBidsResponseMap buyer_bids;
+  buyer_bids.try_emplace(kBuyer1, std::move(get_bids_response));
+
+  IgsWithBidsMap bidding_groups =
+      GetBiddingGroups(buyer_bids, interest_group_indexes);
+  ASSERT_EQ(bidding_groups.count(kBuyer1), 1);
+  EXPECT_THAT(bidding_groups.at(kBuyer1).index(),
+              ::testing::ElementsAre(1, 3));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
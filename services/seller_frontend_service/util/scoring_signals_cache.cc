@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/scoring_signals_cache.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "services/common/util/json_span_util.h"
+#include "services/seller_frontend_service/util/scoring_signals_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Kinds of render URLs, cached apart.
+constexpr char kRenderUrlKind = 'r';
+constexpr char kAdComponentRenderUrlKind = 'c';
+
+}  // namespace
+
+std::shared_ptr<ScoringSignalsCache> CreateScoringSignalsCache(
+    int64_t max_bytes, absl::Duration ttl) {
+  ScoringSignalsCache::Options options;
+  options.max_weight = max_bytes;
+  options.ttl = ttl;
+  options.weigher = [](const std::string& key, const std::string& signals) {
+    return static_cast<int64_t>(key.size() + signals.size());
+  };
+  return std::make_shared<ScoringSignalsCache>(std::move(options));
+}
+
+CachedScoringSignals::CachedScoringSignals(
+    ScoringSignalsCache& cache, absl::string_view seller_kv_experiment_group_id)
+    : cache_(cache),
+      seller_kv_experiment_group_id_(seller_kv_experiment_group_id) {}
+
+void CachedScoringSignals::LookUp(
+    const BuyerBidsResponseMap& buyer_bids_map,
+    bool include_protected_app_signals_bids,
+    absl::flat_hash_set<absl::string_view>& cached_render_urls,
+    absl::flat_hash_set<absl::string_view>& cached_ad_component_render_urls) {
+  auto look_up_render_url = [this, &cached_render_urls](absl::string_view url) {
+    if (!cached_render_urls.contains(url) &&
+        LookUpUrl(url, kRenderUrlKind, render_url_hits_,
+                  missed_render_urls_)) {
+      cached_render_urls.insert(url);
+    }
+  };
+  for (const auto& [unused_buyer, get_bids_response] : buyer_bids_map) {
+    for (const auto& ad : get_bids_response->bids()) {
+      look_up_render_url(ad.render());
+      for (const auto& ad_component : ad.ad_components()) {
+        if (!cached_ad_component_render_urls.contains(ad_component) &&
+            LookUpUrl(ad_component, kAdComponentRenderUrlKind,
+                      ad_component_render_url_hits_,
+                      missed_ad_component_render_urls_)) {
+          cached_ad_component_render_urls.insert(ad_component);
+        }
+      }
+    }
+    if (include_protected_app_signals_bids) {
+      for (const auto& ad : get_bids_response->protected_app_signals_bids()) {
+        look_up_render_url(ad.render());
+      }
+    }
+  }
+}
+
+bool CachedScoringSignals::LookUpUrl(absl::string_view url, char kind,
+                                     Hits& hits,
+                                     absl::flat_hash_set<std::string>& misses) {
+  if (misses.contains(url)) {
+    return false;
+  }
+  std::shared_ptr<const std::string> signals = cache_.LookUp(Key(kind, url));
+  if (signals == nullptr) {
+    misses.emplace(url);
+    return false;
+  }
+  hits.emplace_back(std::string(url), std::move(signals));
+  return true;
+}
+
+std::string CachedScoringSignals::Key(char kind, absl::string_view url) const {
+  return absl::StrCat(absl::string_view(&kind, 1),
+                      seller_kv_experiment_group_id_, "|", url);
+}
+
+void CachedScoringSignals::CacheFound(const JsonObjectSpans& spans,
+                                      char kind) {
+  for (const auto& [url, signals] : spans.members) {
+    if (signals.data() != nullptr) {
+      cache_.Insert(Key(kind, url),
+                    std::make_shared<const std::string>(signals));
+    }
+  }
+}
+
+void CachedScoringSignals::AppendHits(absl::string_view property,
+                                      const Hits& hits, std::string& json) {
+  json.push_back('"');
+  json.append(property.data(), property.size());
+  json.append("\":{");
+  for (size_t i = 0; i < hits.size(); ++i) {
+    if (i > 0) {
+      json.push_back(',');
+    }
+    AppendJsonString(hits[i].first, json);
+    json.push_back(':');
+    json.append(*hits[i].second);
+  }
+  json.push_back('}');
+}
+
+absl::StatusOr<std::unique_ptr<ScoringSignals>>
+CachedScoringSignals::CacheAndMerge(std::unique_ptr<ScoringSignals> fetched) {
+  if (fetched == nullptr || fetched->scoring_signals == nullptr) {
+    fetched = std::make_unique<ScoringSignals>();
+    fetched->scoring_signals = std::make_unique<std::string>();
+  }
+  if (HasMisses() && !fetched->scoring_signals->empty()) {
+    JsonObjectSpans render_url_spans;
+    for (const std::string& url : missed_render_urls_) {
+      render_url_spans.members[url];
+    }
+    JsonObjectSpans ad_component_render_url_spans;
+    for (const std::string& url : missed_ad_component_render_urls_) {
+      ad_component_render_url_spans.members[url];
+    }
+    PS_RETURN_IF_ERROR(FindJsonMemberSpans(
+        *fetched->scoring_signals,
+        {{kRenderUrlsProperty, &render_url_spans},
+         {kAdComponentRenderUrlsProperty, &ad_component_render_url_spans}}));
+    CacheFound(render_url_spans, kRenderUrlKind);
+    CacheFound(ad_component_render_url_spans, kAdComponentRenderUrlKind);
+  }
+  if (render_url_hits_.empty() && ad_component_render_url_hits_.empty()) {
+    return fetched;
+  }
+
+  auto cached = std::make_unique<ScoringSignals>();
+  cached->scoring_signals = std::make_unique<std::string>("{");
+  AppendHits(kRenderUrlsProperty, render_url_hits_, *cached->scoring_signals);
+  cached->scoring_signals->push_back(',');
+  AppendHits(kAdComponentRenderUrlsProperty, ad_component_render_url_hits_,
+             *cached->scoring_signals);
+  cached->scoring_signals->push_back('}');
+  std::vector<std::unique_ptr<ScoringSignals>> parts;
+  parts.push_back(std::move(fetched));
+  parts.push_back(std::move(cached));
+  return MergeScoringSignals(parts);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_CACHE_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "services/common/concurrent/sharded_local_cache.h"
+#include "services/common/util/json_span_util.h"
+#include "services/seller_frontend_service/data/scoring_signals.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr int64_t kScoringSignalsCacheMaxBytes = 64 << 20;
+
+// Cache of the seller KV signals of render URLs, shared across SelectAd
+// requests. The same creatives are bid by the same buyers in many auctions,
+// so the signals of their render URLs are looked up once per time to live.
+// Values are the raw JSON of the signals of a single render URL.
+using ScoringSignalsCache = ShardedLocalCache<std::string, const std::string>;
+
+// Creates a cache holding up to `max_bytes` of signals, each returned for
+// `ttl` after it is cached.
+std::shared_ptr<ScoringSignalsCache> CreateScoringSignalsCache(
+    int64_t max_bytes, absl::Duration ttl);
+
+// Signals of the render URLs of the bids of an auction, split into those found
+// in the cache and those to fetch from the seller KV server.
+class CachedScoringSignals {
+ public:
+  // Signals of a KV experiment group are cached apart from the others.
+  CachedScoringSignals(ScoringSignalsCache& cache,
+                       absl::string_view seller_kv_experiment_group_id);
+
+  // Looks up the render URLs and ad component render URLs of the bids, and
+  // adds those found to `cached_render_urls` and
+  // `cached_ad_component_render_urls`, to be left out of the KV lookup.
+  void LookUp(const BuyerBidsResponseMap& buyer_bids_map,
+              bool include_protected_app_signals_bids,
+              absl::flat_hash_set<absl::string_view>& cached_render_urls,
+              absl::flat_hash_set<absl::string_view>&
+                  cached_ad_component_render_urls);
+
+  // Whether any render URL was not found in the cache.
+  bool HasMisses() const {
+    return !missed_render_urls_.empty() ||
+           !missed_ad_component_render_urls_.empty();
+  }
+
+  // Caches the signals `fetched` has for the render URLs missed, and returns
+  // them merged with the signals found in the cache. `fetched` is null if
+  // nothing was missed.
+  absl::StatusOr<std::unique_ptr<ScoringSignals>> CacheAndMerge(
+      std::unique_ptr<ScoringSignals> fetched);
+
+ private:
+  using Hits =
+      std::vector<std::pair<std::string, std::shared_ptr<const std::string>>>;
+
+  // Looks up `url`, recording it as a hit or a miss.
+  bool LookUpUrl(absl::string_view url, char kind, Hits& hits,
+                 absl::flat_hash_set<std::string>& misses);
+
+  // Caches the signals of the members of a fetched property found.
+  void CacheFound(const JsonObjectSpans& spans, char kind);
+
+  // Appends `"property":{"url":signals,...}` to `json`.
+  static void AppendHits(absl::string_view property, const Hits& hits,
+                         std::string& json);
+
+  std::string Key(char kind, absl::string_view url) const;
+
+  ScoringSignalsCache& cache_;
+  const std::string seller_kv_experiment_group_id_;
+  Hits render_url_hits_;
+  Hits ad_component_render_url_hits_;
+  absl::flat_hash_set<std::string> missed_render_urls_;
+  absl::flat_hash_set<std::string> missed_ad_component_render_urls_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_CACHE_H_
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/scoring_signals_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::unique_ptr<ScoringSignals> MakeScoringSignals(std::string json) {
+  auto signals = std::make_unique<ScoringSignals>();
+  signals->scoring_signals = std::make_unique<std::string>(std::move(json));
+  return signals;
+}
+
+BuyerBidsResponseMap MakeBids() {
+  auto response = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+  auto* bid = response->add_bids();
+  bid->set_render("a.com");
+  bid->add_ad_components("c.com");
+  response->add_bids()->set_render("b.com");
+  BuyerBidsResponseMap bids;
+  bids.emplace("buyer.com", std::move(response));
+  return bids;
+}
+
+TEST(CachedScoringSignalsTest, FetchesOnlyTheRenderUrlsNotCached) {
+  auto cache = CreateScoringSignalsCache(/*max_bytes=*/1 << 20,
+                                         absl::Minutes(1));
+  BuyerBidsResponseMap bids = MakeBids();
+  {
+    CachedScoringSignals cached(*cache, /*seller_kv_experiment_group_id=*/"");
+    absl::flat_hash_set<absl::string_view> cached_render_urls;
+    absl::flat_hash_set<absl::string_view> cached_ad_component_render_urls;
+    cached.LookUp(bids, /*include_protected_app_signals_bids=*/false,
+                  cached_render_urls, cached_ad_component_render_urls);
+    EXPECT_TRUE(cached.HasMisses());
+    EXPECT_TRUE(cached_render_urls.empty());
+    // b.com has no signals, so it is not cached.
+    auto merged = cached.CacheAndMerge(MakeScoringSignals(
+        R"JSON({"renderUrls": {"a.com": [1]},
+                "adComponentRenderUrls": {"c.com": "x"}})JSON"));
+    ASSERT_TRUE(merged.ok()) << merged.status();
+  }
+
+  CachedScoringSignals cached(*cache, /*seller_kv_experiment_group_id=*/"");
+  absl::flat_hash_set<absl::string_view> cached_render_urls;
+  absl::flat_hash_set<absl::string_view> cached_ad_component_render_urls;
+  cached.LookUp(bids, /*include_protected_app_signals_bids=*/false,
+                cached_render_urls, cached_ad_component_render_urls);
+  EXPECT_TRUE(cached.HasMisses());
+  EXPECT_EQ(cached_render_urls,
+            (absl::flat_hash_set<absl::string_view>{"a.com"}));
+  EXPECT_EQ(cached_ad_component_render_urls,
+            (absl::flat_hash_set<absl::string_view>{"c.com"}));
+  auto merged = cached.CacheAndMerge(
+      MakeScoringSignals(R"JSON({"renderUrls": {"b.com": 2}})JSON"));
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_EQ(
+      *(*merged)->scoring_signals,
+      R"JSON({"renderUrls":{"b.com": 2,"a.com":[1]},"adComponentRenderUrls":{"c.com":"x"}})JSON");
+}
+
+TEST(CachedScoringSignalsTest, CachesExperimentGroupsApart) {
+  auto cache = CreateScoringSignalsCache(/*max_bytes=*/1 << 20,
+                                         absl::Minutes(1));
+  BuyerBidsResponseMap bids = MakeBids();
+  absl::flat_hash_set<absl::string_view> cached_render_urls;
+  absl::flat_hash_set<absl::string_view> cached_ad_component_render_urls;
+  CachedScoringSignals control(*cache, /*seller_kv_experiment_group_id=*/"");
+  control.LookUp(bids, /*include_protected_app_signals_bids=*/false,
+                 cached_render_urls, cached_ad_component_render_urls);
+  ASSERT_TRUE(control
+                  .CacheAndMerge(MakeScoringSignals(
+                      R"JSON({"renderUrls": {"a.com": 1, "b.com": 2}})JSON"))
+                  .ok());
+
+  CachedScoringSignals experiment(*cache,
+                                  /*seller_kv_experiment_group_id=*/"7");
+  experiment.LookUp(bids, /*include_protected_app_signals_bids=*/false,
+                    cached_render_urls, cached_ad_component_render_urls);
+  EXPECT_TRUE(cached_render_urls.empty());
+}
+
+TEST(CachedScoringSignalsTest, SkipsTheFetchWhenAllRenderUrlsAreCached) {
+  auto cache = CreateScoringSignalsCache(/*max_bytes=*/1 << 20,
+                                         absl::Minutes(1));
+  cache->Insert("r|a.com", std::make_shared<const std::string>("1"));
+  cache->Insert("r|b.com", std::make_shared<const std::string>("2"));
+  cache->Insert("c|c.com", std::make_shared<const std::string>("3"));
+  BuyerBidsResponseMap bids = MakeBids();
+  CachedScoringSignals cached(*cache, /*seller_kv_experiment_group_id=*/"");
+  absl::flat_hash_set<absl::string_view> cached_render_urls;
+  absl::flat_hash_set<absl::string_view> cached_ad_component_render_urls;
+  cached.LookUp(bids, /*include_protected_app_signals_bids=*/false,
+                cached_render_urls, cached_ad_component_render_urls);
+  EXPECT_FALSE(cached.HasMisses());
+  auto merged = cached.CacheAndMerge(nullptr);
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_EQ(
+      *(*merged)->scoring_signals,
+      R"JSON({"renderUrls":{"a.com":1,"b.com":2},"adComponentRenderUrls":{"c.com":3}})JSON");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,103 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/seller_frontend_service/util/scoring_signals_util.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/string_view.h"
+#include "services/common/util/json_span_util.h"
+#include "services/common/util/json_stream_scanner.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Appends the members of the raw JSON object `object` to the members already
+// in `out`. Values that are not objects contain no signals and are skipped.
+void AppendObjectMembers(absl::string_view object, std::string& out) {
+  object = absl::StripAsciiWhitespace(object);
+  if (object.size() < 2 || object.front() != '{') {
+    return;
+  }
+  object = absl::StripAsciiWhitespace(object.substr(1, object.size() - 2));
+  if (object.empty()) {
+    return;
+  }
+  if (!out.empty()) {
+    out.push_back(',');
+  }
+  out.append(object);
+}
+
+// Fills the spans of `json` from the offsets of its properties located as it
+// streamed in, instead of scanning it again.
+void SpansFromOffsets(absl::string_view json,
+                      const JsonPropertyOffsets& offsets,
+                      JsonPropertySpans& spans) {
+  for (auto& [property, span] : spans) {
+    auto it = offsets.find(property);
+    if (it != offsets.end() && it->second.end <= json.size()) {
+      span = json.substr(it->second.begin, it->second.end - it->second.begin);
+    }
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<ScoringSignals>> MergeScoringSignals(
+    const std::vector<std::unique_ptr<ScoringSignals>>& buyer_scoring_signals) {
+  std::string render_urls;
+  std::string ad_component_render_urls;
+  for (const auto& signals : buyer_scoring_signals) {
+    if (signals == nullptr || signals->scoring_signals == nullptr ||
+        signals->scoring_signals->empty()) {
+      continue;
+    }
+    JsonPropertySpans spans = {{kRenderUrlsProperty, {}},
+                               {kAdComponentRenderUrlsProperty, {}}};
+    if (signals->property_offsets.has_value()) {
+      SpansFromOffsets(*signals->scoring_signals, *signals->property_offsets,
+                       spans);
+    } else {
+      PS_RETURN_IF_ERROR(
+          FindJsonPropertySpans(*signals->scoring_signals, spans));
+    }
+    AppendObjectMembers(spans[kRenderUrlsProperty], render_urls);
+    AppendObjectMembers(spans[kAdComponentRenderUrlsProperty],
+                        ad_component_render_urls);
+  }
+
+  auto merged = std::make_unique<ScoringSignals>();
+  merged->scoring_signals = std::make_unique<std::string>();
+  if (render_urls.empty()) {
+    return merged;
+  }
+  std::string& json = *merged->scoring_signals;
+  json.reserve(render_urls.size() + ad_component_render_urls.size() + 64);
+  json.append("{\"").append(kRenderUrlsProperty).append("\":{");
+  json.append(render_urls);
+  json.push_back('}');
+  if (!ad_component_render_urls.empty()) {
+    json.append(",\"").append(kAdComponentRenderUrlsProperty).append("\":{");
+    json.append(ad_component_render_urls);
+    json.push_back('}');
+  }
+  json.push_back('}');
+  return merged;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_UTIL_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_UTIL_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "services/seller_frontend_service/data/scoring_signals.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kRenderUrlsProperty[] = "renderUrls";
+inline constexpr char kAdComponentRenderUrlsProperty[] =
+    "adComponentRenderUrls";
+
+// Merges the scoring signals fetched separately for each buyer into a single
+// seller KV response, i.e. the members of the "renderUrls" and
+// "adComponentRenderUrls" objects of every response are concatenated without
+// parsing the signal values. Returns empty scoring signals if none of the
+// responses have any render URL signals. Returns an error if any of the
+// responses is malformed. Responses with property_offsets are not scanned
+// again.
+absl::StatusOr<std::unique_ptr<ScoringSignals>> MergeScoringSignals(
+    const std::vector<std::unique_ptr<ScoringSignals>>& buyer_scoring_signals);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SCORING_SIGNALS_UTIL_H_
@@ -0,0 +1,94 @@
+//  Copyright 2024 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/seller_frontend_service/util/scoring_signals_util.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::unique_ptr<ScoringSignals> MakeScoringSignals(std::string json) {
+  auto signals = std::make_unique<ScoringSignals>();
+  signals->scoring_signals = std::make_unique<std::string>(std::move(json));
+  return signals;
+}
+
+TEST(MergeScoringSignalsTest, ConcatenatesSignalsOfAllBuyers) {
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_signals;
+  buyer_signals.push_back(MakeScoringSignals(
+      R"JSON({"renderUrls": {"a.com": [1]}, "adComponentRenderUrls": {}})JSON"));
+  buyer_signals.push_back(MakeScoringSignals(
+      R"JSON({"renderUrls": {"b.com": {"x": 2}, "c.com": null},
+              "adComponentRenderUrls": {"d.com": "e"}})JSON"));
+
+  auto merged = MergeScoringSignals(buyer_signals);
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_EQ(*(*merged)->scoring_signals,
+            R"JSON({"renderUrls":{"a.com": [1],"b.com": {"x": 2}, "c.com": null},"adComponentRenderUrls":{"d.com": "e"}})JSON");
+}
+
+TEST(MergeScoringSignalsTest, SkipsEmptySignals) {
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_signals;
+  buyer_signals.push_back(MakeScoringSignals(""));
+  buyer_signals.push_back(nullptr);
+  buyer_signals.push_back(
+      MakeScoringSignals(R"JSON({"renderUrls": {"a.com": 1}})JSON"));
+
+  auto merged = MergeScoringSignals(buyer_signals);
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_EQ(*(*merged)->scoring_signals,
+            R"JSON({"renderUrls":{"a.com": 1}})JSON");
+}
+
+TEST(MergeScoringSignalsTest, ReturnsEmptySignalsWithoutRenderUrls) {
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_signals;
+  buyer_signals.push_back(MakeScoringSignals(R"JSON({"renderUrls": {}})JSON"));
+
+  auto merged = MergeScoringSignals(buyer_signals);
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_TRUE((*merged)->scoring_signals->empty());
+}
+
+TEST(MergeScoringSignalsTest, UsesOffsetsOfScannedSignals) {
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_signals;
+  buyer_signals.push_back(
+      MakeScoringSignals(R"JSON({"renderUrls": {"a.com": 1}})JSON"));
+  // Offsets located while the signals streamed in. The signals are not
+  // scanned again.
+  buyer_signals.back()->property_offsets =
+      JsonPropertyOffsets({{"renderUrls", {.begin = 15, .end = 27}}});
+  buyer_signals.push_back(
+      MakeScoringSignals(R"JSON({"renderUrls": {"b.com": 2}})JSON"));
+
+  auto merged = MergeScoringSignals(buyer_signals);
+  ASSERT_TRUE(merged.ok()) << merged.status();
+  EXPECT_EQ(*(*merged)->scoring_signals,
+            R"JSON({"renderUrls":{"a.com": 1,"b.com": 2}})JSON");
+}
+
+TEST(MergeScoringSignalsTest, FailsOnMalformedSignals) {
+  std::vector<std::unique_ptr<ScoringSignals>> buyer_signals;
+  buyer_signals.push_back(MakeScoringSignals(R"JSON({"renderUrls": {)JSON"));
+
+  EXPECT_FALSE(MergeScoringSignals(buyer_signals).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/select_ad_capture.h"
+
+#include <utility>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+#include "src/util/status_macro/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+inline constexpr char kAuctionConfigField[] = "auction_config";
+inline constexpr char kProtectedAuctionInputField[] =
+    "raw_protected_audience_input";
+inline constexpr char kBuyerInputMapField[] = "raw_buyer_input";
+
+absl::StatusOr<rapidjson::Value> MessageToJsonValue(
+    const google::protobuf::Message& message,
+    rapidjson::Document::AllocatorType& allocator) {
+  std::string json;
+  PS_RETURN_IF_ERROR(
+      google::protobuf::util::MessageToJsonString(message, &json));
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(json));
+  return rapidjson::Value(document, allocator);
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> GetSelectAdCaptureJson(
+    const SelectAdRequest::AuctionConfig& auction_config,
+    const google::protobuf::Message& protected_auction_input,
+    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs,
+    ClientType client_type) {
+  rapidjson::Document capture;
+  capture.SetObject();
+  auto& allocator = capture.GetAllocator();
+
+  rapidjson::Value buyer_input_map(rapidjson::kObjectType);
+  for (const auto& [buyer, buyer_input] : buyer_inputs) {
+    PS_ASSIGN_OR_RETURN(rapidjson::Value buyer_input_json,
+                        MessageToJsonValue(buyer_input, allocator));
+    buyer_input_map.AddMember(
+        rapidjson::Value(buyer.data(), buyer.size(), allocator),
+        std::move(buyer_input_json), allocator);
+  }
+  PS_ASSIGN_OR_RETURN(rapidjson::Value protected_auction_input_json,
+                      MessageToJsonValue(protected_auction_input, allocator));
+  protected_auction_input_json.AddMember(kBuyerInputMapField,
+                                         std::move(buyer_input_map), allocator);
+
+  PS_ASSIGN_OR_RETURN(rapidjson::Value auction_config_json,
+                      MessageToJsonValue(auction_config, allocator));
+  capture.AddMember(kAuctionConfigField, std::move(auction_config_json),
+                    allocator);
+  capture.AddMember(kProtectedAuctionInputField,
+                    std::move(protected_auction_input_json), allocator);
+  const std::string& client_type_name = ClientType_Name(client_type);
+  capture.AddMember(
+      kCapturedClientTypeField,
+      rapidjson::Value(client_type_name.data(), client_type_name.size(),
+                       allocator),
+      allocator);
+  return SerializeJsonDoc(capture);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
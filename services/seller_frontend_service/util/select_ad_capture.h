@@ -0,0 +1,48 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELECT_AD_CAPTURE_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELECT_AD_CAPTURE_H_
+
+#include <string>
+
+#include <google/protobuf/message.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Field of the captured SelectAd requests holding the type of the client, as
+// in the ClientType enum, for the replay to encode the request as it was.
+inline constexpr char kCapturedClientTypeField[] = "client_type";
+
+// Returns the plaintext of a decoded SelectAd request as a single line of
+// JSON in the format secure_invoke takes, i.e. with the decoded buyer inputs
+// in `raw_protected_audience_input.raw_buyer_input`, see
+// tools/secure_invoke/payload_generator/payload_packaging.h.
+// `protected_auction_input` must have its encoded buyer inputs cleared.
+absl::StatusOr<std::string> GetSelectAdCaptureJson(
+    const SelectAdRequest::AuctionConfig& auction_config,
+    const google::protobuf::Message& protected_auction_input,
+    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs,
+    ClientType client_type);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELECT_AD_CAPTURE_H_
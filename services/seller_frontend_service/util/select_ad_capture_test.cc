@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/select_ad_capture.h"
+
+#include <google/protobuf/util/json_util.h>
+
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(SelectAdCaptureTest, WritesDecodedRequestForSecureInvoke) {
+  SelectAdRequest::AuctionConfig auction_config;
+  auction_config.set_seller("seller.com");
+  auction_config.add_buyer_list("buyer.com");
+  ProtectedAuctionInput protected_auction_input;
+  protected_auction_input.set_generation_id("generation-id");
+  protected_auction_input.set_publisher_name("publisher.com");
+  BuyerInput buyer_input;
+  buyer_input.add_interest_groups()->set_name("ig");
+  absl::flat_hash_map<absl::string_view, BuyerInput> buyer_inputs = {
+      {"buyer.com", buyer_input}};
+
+  absl::StatusOr<std::string> json =
+      GetSelectAdCaptureJson(auction_config, protected_auction_input,
+                             buyer_inputs, CLIENT_TYPE_ANDROID);
+  ASSERT_TRUE(json.ok()) << json.status();
+  EXPECT_EQ(json->find('\n'), std::string::npos);
+
+  absl::StatusOr<rapidjson::Document> document = ParseJsonString(*json);
+  ASSERT_TRUE(document.ok()) << document.status();
+  EXPECT_STREQ((*document)["auction_config"]["seller"].GetString(),
+               "seller.com");
+  const rapidjson::Value& input = (*document)["raw_protected_audience_input"];
+  EXPECT_STREQ(input["publisherName"].GetString(), "publisher.com");
+  EXPECT_STREQ(input["raw_buyer_input"]["buyer.com"]["interestGroups"][0]
+                    ["name"]
+                        .GetString(),
+               "ig");
+  EXPECT_STREQ((*document)[kCapturedClientTypeField].GetString(),
+               "CLIENT_TYPE_ANDROID");
+
+  // The captured auction config is read back by the replay as is.
+  absl::StatusOr<std::string> auction_config_json =
+      SerializeJsonDoc((*document)["auction_config"]);
+  ASSERT_TRUE(auction_config_json.ok());
+  SelectAdRequest::AuctionConfig parsed_auction_config;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(
+                  *auction_config_json, &parsed_auction_config)
+                  .ok());
+  EXPECT_EQ(parsed_auction_config.seller(), "seller.com");
+  EXPECT_EQ(parsed_auction_config.buyer_list(0), "buyer.com");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -444,7 +444,6 @@ SelectAdResponse RunReactorRequest(
     const TrustedServersConfigClient& config_client,
     const ClientRegistry& clients, const SelectAdRequest& request,
     bool fail_fast = false) {
-  metric::SfeContextMap()->Get(&request);
   grpc::CallbackServerContext context;
   SelectAdResponse response;
   T reactor(&context, &request, &response, clients, config_client, fail_fast);
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/seller_frontend_config.h"
+
+#include "services/seller_frontend_service/runtime_flags.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+bool GetOptionalBool(const TrustedServersConfigClient& config_client,
+                     absl::string_view name) {
+  return config_client.HasParameter(name) &&
+         config_client.GetBooleanParameter(name);
+}
+
+absl::Duration GetOptionalDurationMs(
+    const TrustedServersConfigClient& config_client, absl::string_view name) {
+  if (!config_client.HasParameter(name)) {
+    return absl::ZeroDuration();
+  }
+  return absl::Milliseconds(config_client.GetIntParameter(name));
+}
+
+int GetOptionalInt(const TrustedServersConfigClient& config_client,
+                   absl::string_view name) {
+  return config_client.HasParameter(name) ? config_client.GetIntParameter(name)
+                                          : 0;
+}
+
+}  // namespace
+
+SellerFrontEndConfig ParseSellerFrontEndConfig(
+    const TrustedServersConfigClient& config_client) {
+  SellerFrontEndConfig config;
+  if (config_client.HasParameter(SELLER_ORIGIN_DOMAIN)) {
+    config.seller_origin_domain =
+        config_client.GetStringParameter(SELLER_ORIGIN_DOMAIN);
+  }
+  config.get_bid_rpc_timeout =
+      GetOptionalDurationMs(config_client, GET_BID_RPC_TIMEOUT_MS);
+  config.key_value_signals_fetch_rpc_timeout = GetOptionalDurationMs(
+      config_client, KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS);
+  config.score_ads_rpc_timeout =
+      GetOptionalDurationMs(config_client, SCORE_ADS_RPC_TIMEOUT_MS);
+  config.enable_protected_app_signals =
+      GetOptionalBool(config_client, ENABLE_PROTECTED_APP_SIGNALS);
+  config.enable_protected_audience =
+      GetOptionalBool(config_client, ENABLE_PROTECTED_AUDIENCE);
+  config.enable_seller_frontend_benchmarking =
+      GetOptionalBool(config_client, ENABLE_SELLER_FRONTEND_BENCHMARKING);
+  config.enable_pipelined_scoring_signals_fetch =
+      GetOptionalBool(config_client, ENABLE_PIPELINED_SCORING_SIGNALS_FETCH);
+  config.get_bid_hedge_delay =
+      GetOptionalDurationMs(config_client, GET_BID_HEDGE_DELAY_MS);
+  config.get_bid_deadline_reserve =
+      GetOptionalDurationMs(config_client, GET_BID_DEADLINE_RESERVE_MS);
+  config.enable_get_bids_batching =
+      GetOptionalBool(config_client, ENABLE_GET_BIDS_BATCHING);
+  config.max_bids_per_buyer = GetOptionalInt(config_client, MAX_BIDS_PER_BUYER);
+  config.max_bids_per_auction =
+      GetOptionalInt(config_client, MAX_BIDS_PER_AUCTION);
+  return config;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELLER_FRONTEND_CONFIG_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELLER_FRONTEND_CONFIG_H_
+
+#include <string>
+
+#include "absl/time/time.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Typed runtime config read by the SelectAd reactors, parsed once from the
+// config client instead of being looked up and parsed on every request.
+// Flags that are not set keep the defaults below.
+struct SellerFrontEndConfig {
+  std::string seller_origin_domain;
+  absl::Duration get_bid_rpc_timeout = absl::ZeroDuration();
+  absl::Duration key_value_signals_fetch_rpc_timeout = absl::ZeroDuration();
+  absl::Duration score_ads_rpc_timeout = absl::ZeroDuration();
+  bool enable_protected_app_signals = false;
+  bool enable_protected_audience = false;
+  bool enable_seller_frontend_benchmarking = false;
+  bool enable_pipelined_scoring_signals_fetch = false;
+  // Delay after which a GetBids request is hedged. Zero if disabled.
+  absl::Duration get_bid_hedge_delay = absl::ZeroDuration();
+  // Time reserved for scoring before the deadline of the request.
+  absl::Duration get_bid_deadline_reserve = absl::ZeroDuration();
+  // Whether the GetBids requests to buyers on the same BFE are batched.
+  bool enable_get_bids_batching = false;
+  // Max number of bids of a buyer, and of all the buyers of an auction, that
+  // are scored. Only the highest bids are kept above them. No limit if 0.
+  int max_bids_per_buyer = 0;
+  int max_bids_per_auction = 0;
+};
+
+// Parses the runtime config of the SelectAd reactors from the config client.
+SellerFrontEndConfig ParseSellerFrontEndConfig(
+    const TrustedServersConfigClient& config_client);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_SELLER_FRONTEND_CONFIG_H_
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2024 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/seller_frontend_config.h"
+
+#include "gtest/gtest.h"
+#include "services/seller_frontend_service/runtime_flags.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ParseSellerFrontEndConfigTest, ParsesFlags) {
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest("https://seller.com", SELLER_ORIGIN_DOMAIN);
+  config_client.SetFlagForTest("100", GET_BID_RPC_TIMEOUT_MS);
+  config_client.SetFlagForTest("200", KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS);
+  config_client.SetFlagForTest("300", SCORE_ADS_RPC_TIMEOUT_MS);
+  config_client.SetFlagForTest(kTrue, ENABLE_PROTECTED_APP_SIGNALS);
+  config_client.SetFlagForTest("TRUE", ENABLE_PROTECTED_AUDIENCE);
+  config_client.SetFlagForTest(kFalse, ENABLE_SELLER_FRONTEND_BENCHMARKING);
+  config_client.SetFlagForTest(kTrue, ENABLE_PIPELINED_SCORING_SIGNALS_FETCH);
+  config_client.SetFlagForTest("10", GET_BID_HEDGE_DELAY_MS);
+  config_client.SetFlagForTest("20", GET_BID_DEADLINE_RESERVE_MS);
+  config_client.SetFlagForTest(kTrue, ENABLE_GET_BIDS_BATCHING);
+  config_client.SetFlagForTest("30", MAX_BIDS_PER_BUYER);
+  config_client.SetFlagForTest("40", MAX_BIDS_PER_AUCTION);
+
+  SellerFrontEndConfig config = ParseSellerFrontEndConfig(config_client);
+  EXPECT_EQ(config.seller_origin_domain, "https://seller.com");
+  EXPECT_EQ(config.get_bid_rpc_timeout, absl::Milliseconds(100));
+  EXPECT_EQ(config.key_value_signals_fetch_rpc_timeout,
+            absl::Milliseconds(200));
+  EXPECT_EQ(config.score_ads_rpc_timeout, absl::Milliseconds(300));
+  EXPECT_TRUE(config.enable_protected_app_signals);
+  EXPECT_TRUE(config.enable_protected_audience);
+  EXPECT_FALSE(config.enable_seller_frontend_benchmarking);
+  EXPECT_TRUE(config.enable_pipelined_scoring_signals_fetch);
+  EXPECT_EQ(config.get_bid_hedge_delay, absl::Milliseconds(10));
+  EXPECT_EQ(config.get_bid_deadline_reserve, absl::Milliseconds(20));
+  EXPECT_TRUE(config.enable_get_bids_batching);
+  EXPECT_EQ(config.max_bids_per_buyer, 30);
+  EXPECT_EQ(config.max_bids_per_auction, 40);
+}
+
+TEST(ParseSellerFrontEndConfigTest, DefaultsUnsetFlags) {
+  TrustedServersConfigClient config_client({});
+  SellerFrontEndConfig config = ParseSellerFrontEndConfig(config_client);
+  EXPECT_TRUE(config.seller_origin_domain.empty());
+  EXPECT_EQ(config.get_bid_rpc_timeout, absl::ZeroDuration());
+  EXPECT_FALSE(config.enable_protected_audience);
+  EXPECT_FALSE(config.enable_pipelined_scoring_signals_fetch);
+  EXPECT_EQ(config.get_bid_hedge_delay, absl::ZeroDuration());
+  EXPECT_FALSE(config.enable_get_bids_batching);
+  EXPECT_EQ(config.max_bids_per_auction, 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
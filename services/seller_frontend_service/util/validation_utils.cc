@@ -14,40 +14,44 @@
 
 #include "services/seller_frontend_service/util/validation_utils.h"
 
+#include "absl/strings/str_format.h"
+#include "services/common/util/request_validator.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns the builder of the message of an error in an auction result.
+auto ErrorInAuctionResult(absl::string_view error) {
+  return [error]() { return absl::StrFormat(kErrorInAuctionResult, error); };
+}
+
+}  // namespace
 
 bool ValidateEncryptedSelectAdRequest(const SelectAdRequest& request,
                                       AuctionScope auction_scope,
                                       absl::string_view seller_domain,
                                       ErrorAccumulator& error_accumulator) {
-  bool valid = true;
-  auto report_error_lambda = [&error_accumulator, &valid](
-                                 bool has_error, absl::string_view error_msg) {
-    if (has_error) {
-      valid = false;
-      error_accumulator.ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
-                                    error_msg, ErrorCode::CLIENT_SIDE);
-    }
-  };
-  report_error_lambda(request.protected_auction_ciphertext().empty() &&
-                          request.protected_audience_ciphertext().empty(),
-                      kEmptyProtectedAuctionCiphertextError);
+  RequestValidator validator(error_accumulator,
+                             ErrorVisibility::AD_SERVER_VISIBLE);
+  validator.Check(!request.protected_auction_ciphertext().empty() ||
+                      !request.protected_audience_ciphertext().empty(),
+                  kEmptyProtectedAuctionCiphertextError);
   const SelectAdRequest::AuctionConfig& auction_config =
       request.auction_config();
 
-  report_error_lambda(auction_config.seller_signals().empty(),
-                      kEmptySellerSignals);
-  report_error_lambda(auction_config.auction_signals().empty(),
-                      kEmptyAuctionSignals);
-  report_error_lambda(auction_config.seller().empty(), kEmptySeller);
-  report_error_lambda(seller_domain != auction_config.seller(),
-                      kWrongSellerDomain);
-  report_error_lambda(request.client_type() == CLIENT_TYPE_UNKNOWN,
-                      kUnknownClientType);
+  validator.Check(!auction_config.seller_signals().empty(),
+                  kEmptySellerSignals);
+  validator.Check(!auction_config.auction_signals().empty(),
+                  kEmptyAuctionSignals);
+  validator.Check(!auction_config.seller().empty(), kEmptySeller);
+  validator.Check(seller_domain == auction_config.seller(),
+                  kWrongSellerDomain);
+  validator.Check(request.client_type() != CLIENT_TYPE_UNKNOWN,
+                  kUnknownClientType);
 
   if (auction_scope == AuctionScope::AUCTION_SCOPE_SERVER_TOP_LEVEL_SELLER) {
-    report_error_lambda(request.component_auction_results_size() == 0,
-                        kNoComponentAuctionResults);
+    validator.Check(request.component_auction_results_size() != 0,
+                    kNoComponentAuctionResults);
     int valid_results = 0;
     for (const auto& auction_result : request.component_auction_results()) {
       if (auction_result.auction_result_ciphertext().empty() ||
@@ -56,11 +60,11 @@ bool ValidateEncryptedSelectAdRequest(const SelectAdRequest& request,
       }
       ++valid_results;
     }
-    report_error_lambda(
-        valid_results == 0 && request.component_auction_results_size() != 0,
+    validator.Check(
+        valid_results != 0 || request.component_auction_results_size() == 0,
         kEmptyComponentAuctionResults);
   }
-  return valid;
+  return validator.valid();
 }
 
 bool ValidateComponentAuctionResult(const AuctionResult& auction_result,
@@ -73,44 +77,28 @@ bool ValidateComponentAuctionResult(const AuctionResult& auction_result,
     return true;
   }
 
-  bool valid = true;
-  auto report_error_lambda = [&error_accumulator, &valid](
-                                 bool has_error, absl::string_view error_msg) {
-    if (has_error) {
-      valid = false;
-      error_accumulator.ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
-                                    error_msg, ErrorCode::CLIENT_SIDE);
-    }
-  };
-
-  report_error_lambda(
-      auction_result.auction_params().ciphertext_generation_id() !=
-          request_generation_id,
-      absl::StrFormat(kErrorInAuctionResult,
+  RequestValidator validator(error_accumulator,
+                             ErrorVisibility::AD_SERVER_VISIBLE);
+  validator.Check(auction_result.auction_params().ciphertext_generation_id() ==
+                      request_generation_id,
+                  ErrorInAuctionResult(
                       kMismatchedGenerationIdInAuctionResultError));
-  report_error_lambda(
-      auction_result.top_level_seller() != seller_domain,
-      absl::StrFormat(kErrorInAuctionResult,
-                      kMismatchedTopLevelSellerInAuctionResultError));
-
-  report_error_lambda(
-      auction_result.auction_params().component_seller().empty(),
-      absl::StrFormat(kErrorInAuctionResult,
-                      kEmptyComponentSellerInAuctionResultError));
-
-  report_error_lambda(
-      auction_result.ad_type() != AdType::AD_TYPE_PROTECTED_AUDIENCE_AD,
-      absl::StrFormat(kErrorInAuctionResult,
-                      kUnsupportedAdTypeInAuctionResultError));
-
-  report_error_lambda(
-      !auction_result.win_reporting_urls()
-           .top_level_seller_reporting_urls()
-           .reporting_url()
-           .empty(),
-      absl::StrFormat(kErrorInAuctionResult,
+  validator.Check(
+      auction_result.top_level_seller() == seller_domain,
+      ErrorInAuctionResult(kMismatchedTopLevelSellerInAuctionResultError));
+  validator.Check(
+      !auction_result.auction_params().component_seller().empty(),
+      ErrorInAuctionResult(kEmptyComponentSellerInAuctionResultError));
+  validator.Check(
+      auction_result.ad_type() == AdType::AD_TYPE_PROTECTED_AUDIENCE_AD,
+      ErrorInAuctionResult(kUnsupportedAdTypeInAuctionResultError));
+  validator.Check(auction_result.win_reporting_urls()
+                      .top_level_seller_reporting_urls()
+                      .reporting_url()
+                      .empty(),
+                  ErrorInAuctionResult(
                       kTopLevelWinReportingUrlsInAuctionResultError));
-  return valid;
+  return validator.valid();
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -26,7 +26,8 @@
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
-#include "services/common/compression/gzip.h"
+#include "services/common/compression/compression_codec.h"
+#include "services/seller_frontend_service/util/cbor_stream_reader.h"
 #include "src/util/status_macro/status_macros.h"
 
 #include "cbor.h"
@@ -77,18 +78,41 @@ absl::Status AddKVToMap(absl::string_view key, absl::string_view value,
   return absl::OkStatus();
 }
 
-// Decodes a Span of cbor* string objects and adds them to the provided list.
-RepeatedStringProto DecodeStringArray(absl::Span<cbor_item_t*> span,
+// Stream counterpart of IsTypeValid. Items of another type are reported and
+// skipped.
+bool IsTypeValid(bool (CborStreamReader::*is_valid_type)() const,
+                 CborStreamReader& reader, absl::string_view field_name,
+                 absl::string_view expected_type,
+                 ErrorAccumulator& error_accumulator) {
+  if ((reader.*is_valid_type)()) {
+    return true;
+  }
+  absl::string_view actual_type = kCborDataTypesLookup[reader.PeekType()];
+  std::string error = absl::StrFormat(kInvalidTypeError, field_name,
+                                      expected_type, actual_type);
+  PS_VLOG(kNoisyWarn) << "CBOR type validation failure: " << error;
+  error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, error,
+                                ErrorCode::CLIENT_SIDE);
+  reader.Skip();
+  return false;
+}
+
+// Decodes an array of strings.
+RepeatedStringProto DecodeStringArray(CborStreamReader& reader,
                                       absl::string_view field_name,
                                       ErrorAccumulator& error_accumulator,
                                       bool fail_fast) {
   RepeatedStringProto repeated_field;
-  for (const cbor_item_t* ad : span) {
-    bool is_valid = IsTypeValid(&cbor_isa_string, ad, field_name, kString,
-                                error_accumulator);
+  uint64_t remaining = reader.ReadContainerHeader();
+  if (remaining != CborStreamReader::kIndefiniteLength) {
+    repeated_field.Reserve(static_cast<int>(remaining));
+  }
+  while (reader.NextEntry(remaining)) {
+    bool is_valid = IsTypeValid(&CborStreamReader::IsString, reader,
+                                field_name, kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, repeated_field);
     if (is_valid) {
-      repeated_field.Add(DecodeCborString(ad));
+      repeated_field.Add(std::string(reader.ReadString()));
     }
   }
 
@@ -97,7 +121,7 @@ RepeatedStringProto DecodeStringArray(absl::Span<cbor_item_t*> span,
 
 // Collects the prevWins arrays into a JSON array and stringifies the result.
 absl::StatusOr<std::string> GetStringifiedPrevWins(
-    absl::Span<cbor_item_t*> prev_wins_entries, absl::string_view owner,
+    CborStreamReader& reader, absl::string_view owner,
     ErrorAccumulator& error_accumulator, bool fail_fast) {
   rapidjson::Document document;
   document.SetArray();
@@ -105,32 +129,48 @@ absl::StatusOr<std::string> GetStringifiedPrevWins(
 
   // Previous win entries should be in the form [relative_time, ad_render_id]
   // where relative_time is an int and ad_render_id is a string.
-  for (const cbor_item_t* prev_win : prev_wins_entries) {
-    bool is_valid = IsTypeValid(&cbor_isa_array, prev_win, kPrevWinsEntry,
-                                kArray, error_accumulator);
+  uint64_t remaining = reader.ReadContainerHeader();
+  while (reader.NextEntry(remaining)) {
+    bool is_valid = IsTypeValid(&CborStreamReader::IsArray, reader,
+                                kPrevWinsEntry, kArray, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
     if (!is_valid) {
       continue;
     }
 
-    if (cbor_array_size(prev_win) != 2) {
+    // Keeps readers of the first two entries, to be read once the length of
+    // the array is known.
+    std::optional<CborStreamReader> relative_time;
+    std::optional<CborStreamReader> maybe_ad_render_id;
+    uint64_t num_entries = 0;
+    uint64_t entries_remaining = reader.ReadContainerHeader();
+    while (reader.NextEntry(entries_remaining)) {
+      if (num_entries == kRelativeTimeIndex) {
+        relative_time = reader;
+      } else if (num_entries == kAdRenderIdIndex) {
+        maybe_ad_render_id = reader;
+      }
+      ++num_entries;
+      reader.Skip();
+    }
+
+    if (num_entries != 2) {
       const std::string error =
           absl::StrFormat(kPrevWinsNotCorrectLengthError, owner);
       error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, error,
                                     ErrorCode::CLIENT_SIDE);
       RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
     }
+    if (!relative_time.has_value() || !maybe_ad_render_id.has_value()) {
+      continue;
+    }
 
-    // cbor_array_get calls cbor_incref() on the returned object, so call
-    // cbor_move().
-    ScopedCbor relative_time(cbor_array_get(prev_win, kRelativeTimeIndex));
-    IsTypeValid(&cbor_is_int, *relative_time, kPrevWinsTimeEntry, kInt,
-                error_accumulator);
+    IsTypeValid(&CborStreamReader::IsInt, *relative_time, kPrevWinsTimeEntry,
+                kInt, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
 
-    ScopedCbor maybe_ad_render_id(cbor_array_get(prev_win, kAdRenderIdIndex));
-    IsTypeValid(&cbor_isa_string, *maybe_ad_render_id, kPrevWinsAdRenderIdEntry,
-                kString, error_accumulator);
+    IsTypeValid(&CborStreamReader::IsString, *maybe_ad_render_id,
+                kPrevWinsAdRenderIdEntry, kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
 
     if (error_accumulator.HasErrors()) {
@@ -139,14 +179,14 @@ absl::StatusOr<std::string> GetStringifiedPrevWins(
       continue;
     }
 
-    const int time = cbor_get_int(*relative_time);
-    const std::string ad_render_id = DecodeCborString(*maybe_ad_render_id);
+    const int time = relative_time->ReadInt();
+    const absl::string_view ad_render_id = maybe_ad_render_id->ReadString();
 
     // Convert to JSON array and add to the running JSON document.
     rapidjson::Value array(rapidjson::kArrayType);
     array.PushBack(time, allocator);
     rapidjson::Value ad_render_id_value(rapidjson::kStringType);
-    ad_render_id_value.SetString(ad_render_id.c_str(), ad_render_id.length(),
+    ad_render_id_value.SetString(ad_render_id.data(), ad_render_id.length(),
                                  allocator);
     array.PushBack(ad_render_id_value, allocator);
     document.PushBack(array, allocator);
@@ -159,84 +199,85 @@ absl::StatusOr<std::string> GetStringifiedPrevWins(
 }
 
 // Decodes browser signals object and sets it in the 'buyer_interest_group'.
-BrowserSignals DecodeBrowserSignals(const cbor_item_t* root,
+BrowserSignals DecodeBrowserSignals(CborStreamReader& reader,
                                     absl::string_view owner,
                                     ErrorAccumulator& error_accumulator,
                                     bool fail_fast) {
   BrowserSignals signals;
-  bool is_signals_valid_type = IsTypeValid(&cbor_isa_map, root, kBrowserSignals,
-                                           kMap, error_accumulator);
+  bool is_signals_valid_type =
+      IsTypeValid(&CborStreamReader::IsMap, reader, kBrowserSignals, kMap,
+                  error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator, /*fail_fast=*/!is_signals_valid_type,
                         signals);
 
-  absl::Span<cbor_pair> browser_signal_entries(cbor_map_handle(root),
-                                               cbor_map_size(root));
-  for (const cbor_pair& signal : browser_signal_entries) {
+  uint64_t remaining = reader.ReadContainerHeader();
+  while (reader.NextEntry(remaining)) {
     bool is_valid_key_type =
-        IsTypeValid(&cbor_isa_string, signal.key, kBrowserSignalsKey, kString,
-                    error_accumulator);
+        IsTypeValid(&CborStreamReader::IsString, reader, kBrowserSignalsKey,
+                    kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
     if (!is_valid_key_type) {
+      reader.Skip();
       continue;
     }
 
-    const int index =
-        FindItemIndex(kBrowserSignalKeys, DecodeCborString(signal.key));
+    const int index = FindItemIndex(kBrowserSignalKeys, reader.ReadString());
     switch (index) {
       case 0: {  // Bid count.
         bool is_count_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsBidCount,
-                        kInt, error_accumulator);
+            IsTypeValid(&CborStreamReader::IsInt, reader,
+                        kBrowserSignalsBidCount, kInt, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
         if (is_count_valid_type) {
-          signals.set_bid_count(cbor_get_int(signal.value));
+          signals.set_bid_count(reader.ReadInt());
         }
         break;
       }
       case 1: {  // Join count.
         bool is_count_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsJoinCount,
-                        kInt, error_accumulator);
+            IsTypeValid(&CborStreamReader::IsInt, reader,
+                        kBrowserSignalsJoinCount, kInt, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
         if (is_count_valid_type) {
-          signals.set_join_count(cbor_get_int(signal.value));
+          signals.set_join_count(reader.ReadInt());
         }
         break;
       }
       case 2: {  // Recency.
         bool is_recency_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsRecency,
-                        kInt, error_accumulator);
+            IsTypeValid(&CborStreamReader::IsInt, reader,
+                        kBrowserSignalsRecency, kInt, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
         if (is_recency_valid_type) {
-          signals.set_recency(cbor_get_int(signal.value));
+          signals.set_recency(reader.ReadInt());
         }
         break;
       }
       case 3: {  // Previous wins.
         bool is_win_valid_type =
-            IsTypeValid(&cbor_isa_array, signal.value, kBrowserSignalsPrevWins,
-                        kArray, error_accumulator);
+            IsTypeValid(&CborStreamReader::IsArray, reader,
+                        kBrowserSignalsPrevWins, kArray, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
         if (is_win_valid_type) {
-          absl::Span<cbor_item_t*> prev_wins_entries(
-              cbor_array_handle(signal.value), cbor_array_size(signal.value));
           absl::StatusOr<std::string> prev_wins = GetStringifiedPrevWins(
-              prev_wins_entries, owner, error_accumulator, fail_fast);
+              reader, owner, error_accumulator, fail_fast);
+          RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
           *signals.mutable_prev_wins() = std::move(*prev_wins);
         }
         break;
       }
       case 4: {  // RecencyMs.
         bool is_recency_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsRecencyMs,
-                        kInt, error_accumulator);
+            IsTypeValid(&CborStreamReader::IsInt, reader,
+                        kBrowserSignalsRecencyMs, kInt, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
         if (is_recency_valid_type) {
-          signals.set_recency_ms(cbor_get_int(signal.value));
+          signals.set_recency_ms(reader.ReadInt());
         }
         break;
       }
+      default:
+        reader.Skip();
     }
   }
 
@@ -657,7 +698,7 @@ server_common::ConsentedDebugConfiguration DecodeConsentedDebugConfig(
     }
 
     const int index =
-        FindItemIndex(kConsentedDebugConfigKeys, DecodeCborString(entry.key));
+        FindItemIndex(kConsentedDebugConfigKeys, CborStringView(entry.key));
     switch (index) {
       case 0: {  // IsConsented.
         bool is_valid_type = IsTypeValid(&cbor_is_bool, entry.value,
@@ -733,10 +774,10 @@ EncodedBuyerInputs DecodeBuyerInputKeys(
     if (!is_ig_val_valid_type) {
       continue;
     }
-    const std::string compressed_igs(
+    std::string compressed_igs(
         reinterpret_cast<char*>(cbor_bytestring_handle(interest_group.value)),
         cbor_bytestring_length(interest_group.value));
-    encoded_buyer_inputs.insert({std::move(owner), compressed_igs});
+    encoded_buyer_inputs.insert({std::move(owner), std::move(compressed_igs)});
   }
 
   return encoded_buyer_inputs;
@@ -762,8 +803,12 @@ bool IsTypeValid(absl::AnyInvocable<bool(const cbor_item_t*)> is_valid_type,
 }
 
 std::string DecodeCborString(const cbor_item_t* item) {
-  return std::string(reinterpret_cast<char*>(cbor_string_handle(item)),
-                     cbor_string_length(item));
+  return std::string(CborStringView(item));
+}
+
+absl::string_view CborStringView(const cbor_item_t* item) {
+  return absl::string_view(reinterpret_cast<char*>(cbor_string_handle(item)),
+                           cbor_string_length(item));
 }
 
 cbor_item_t* cbor_build_uint(uint32_t input) {
@@ -986,10 +1031,20 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
                             absl::string_view compressed_buyer_input,
                             ErrorAccumulator& error_accumulator,
                             bool fail_fast) {
+  return DecodeBuyerInput(owner, compressed_buyer_input,
+                          **GetCompressionCodec(kGzipCodec), error_accumulator,
+                          fail_fast);
+}
+
+BuyerInput DecodeBuyerInput(absl::string_view owner,
+                            absl::string_view compressed_buyer_input,
+                            const CompressionCodec& codec,
+                            ErrorAccumulator& error_accumulator,
+                            bool fail_fast) {
   BuyerInput buyer_input;
-  const absl::StatusOr<std::string> decompressed_buyer_input =
-      GzipDecompress(compressed_buyer_input);
-  if (!decompressed_buyer_input.ok()) {
+  std::string decompressed_buyer_input;
+  if (!codec.Decompress(compressed_buyer_input, decompressed_buyer_input)
+           .ok()) {
     error_accumulator.ReportError(
         ErrorVisibility::CLIENT_VISIBLE,
         absl::StrFormat(kMalformedCompressedIgError, owner),
@@ -997,31 +1052,33 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
     return buyer_input;
   }
 
-  cbor_load_result result;
-  ScopedCbor root(cbor_load(
-      reinterpret_cast<const unsigned char*>(decompressed_buyer_input->data()),
-      decompressed_buyer_input->size(), &result));
-
-  if (result.error.code != CBOR_ERR_NONE) {
+  // The interest groups are decoded straight from the buffer, without
+  // building a tree of cbor_item_t first.
+  if (!CborStreamReader::IsWellFormed(decompressed_buyer_input)) {
     error_accumulator.ReportError(
         ErrorVisibility::CLIENT_VISIBLE,
         absl::StrFormat(kInvalidBuyerInputCborError, owner),
         ErrorCode::CLIENT_SIDE);
     return buyer_input;
   }
+  CborStreamReader reader(decompressed_buyer_input);
 
-  bool is_buyer_input_valid_type = IsTypeValid(
-      &cbor_isa_array, *root, kBuyerInput, kArray, error_accumulator);
+  bool is_buyer_input_valid_type =
+      IsTypeValid(&CborStreamReader::IsArray, reader, kBuyerInput, kArray,
+                  error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator,
                         /*fail_fast=*/!is_buyer_input_valid_type, buyer_input);
 
-  absl::Span<cbor_item_t*> interest_groups(cbor_array_handle(*root),
-                                           cbor_array_size(*root));
-  for (const cbor_item_t* interest_group : interest_groups) {
+  uint64_t remaining_interest_groups = reader.ReadContainerHeader();
+  if (remaining_interest_groups != CborStreamReader::kIndefiniteLength) {
+    buyer_input.mutable_interest_groups()->Reserve(
+        static_cast<int>(remaining_interest_groups));
+  }
+  while (reader.NextEntry(remaining_interest_groups)) {
     auto* buyer_interest_group = buyer_input.add_interest_groups();
 
     bool is_igs_valid_type =
-        IsTypeValid(&cbor_isa_map, interest_group, kBuyerInputEntry, kMap,
+        IsTypeValid(&CborStreamReader::IsMap, reader, kBuyerInputEntry, kMap,
                     error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
@@ -1029,95 +1086,90 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
       continue;
     }
 
-    absl::Span<cbor_pair> ig_entries(cbor_map_handle(interest_group),
-                                     cbor_map_size(interest_group));
-    for (const cbor_pair& ig_entry : ig_entries) {
+    uint64_t remaining_ig_entries = reader.ReadContainerHeader();
+    while (reader.NextEntry(remaining_ig_entries)) {
       bool is_key_valid_type =
-          IsTypeValid(&cbor_isa_string, ig_entry.key, kBuyerInputKey, kString,
-                      error_accumulator);
+          IsTypeValid(&CborStreamReader::IsString, reader, kBuyerInputKey,
+                      kString, error_accumulator);
       RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
       if (!is_key_valid_type) {
+        reader.Skip();
         continue;
       }
 
-      const int index =
-          FindItemIndex(kInterestGroupKeys, DecodeCborString(ig_entry.key));
+      const int index = FindItemIndex(kInterestGroupKeys, reader.ReadString());
       switch (index) {
         case 0: {  // Name.
           bool is_name_valid_type =
-              IsTypeValid(&cbor_isa_string, ig_entry.value, kIgName, kString,
-                          error_accumulator);
+              IsTypeValid(&CborStreamReader::IsString, reader, kIgName,
+                          kString, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
           if (is_name_valid_type) {
-            buyer_interest_group->set_name(DecodeCborString(ig_entry.value));
+            buyer_interest_group->set_name(std::string(reader.ReadString()));
           }
           break;
         }
         case 1: {  // Bidding signal keys.
           bool is_bs_valid_type =
-              IsTypeValid(&cbor_isa_array, ig_entry.value, kIgBiddingSignalKeys,
-                          kArray, error_accumulator);
+              IsTypeValid(&CborStreamReader::IsArray, reader,
+                          kIgBiddingSignalKeys, kArray, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_bs_valid_type) {
-            absl::Span<cbor_item_t*> bidding_signals_list(
-                cbor_array_handle(ig_entry.value),
-                cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_bidding_signals_keys() =
-                DecodeStringArray(bidding_signals_list,
-                                  kIgBiddingSignalKeysEntry, error_accumulator,
-                                  fail_fast);
+                DecodeStringArray(reader, kIgBiddingSignalKeysEntry,
+                                  error_accumulator, fail_fast);
           }
           break;
         }
         case 2: {  // User bidding signals.
           bool is_bs_valid_type =
-              IsTypeValid(&cbor_isa_string, ig_entry.value, kUserBiddingSignals,
-                          kString, error_accumulator);
+              IsTypeValid(&CborStreamReader::IsString, reader,
+                          kUserBiddingSignals, kString, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_bs_valid_type) {
-            *buyer_interest_group->mutable_user_bidding_signals() =
-                DecodeCborString(ig_entry.value);
+            buyer_interest_group->set_user_bidding_signals(
+                std::string(reader.ReadString()));
           }
           break;
         }
         case 3: {  // Ad render IDs.
-          bool is_ad_render_valid_type = IsTypeValid(
-              &cbor_isa_array, ig_entry.value, kAds, kArray, error_accumulator);
+          bool is_ad_render_valid_type =
+              IsTypeValid(&CborStreamReader::IsArray, reader, kAds, kArray,
+                          error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_ad_render_valid_type) {
-            absl::Span<cbor_item_t*> ads(cbor_array_handle(ig_entry.value),
-                                         cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_ad_render_ids() = DecodeStringArray(
-                ads, kAdRenderId, error_accumulator, fail_fast);
+                reader, kAdRenderId, error_accumulator, fail_fast);
           }
           break;
         }
         case 4: {  // Component ads.
           bool is_component_valid_type =
-              IsTypeValid(&cbor_isa_array, ig_entry.value, kAdComponent, kArray,
-                          error_accumulator);
+              IsTypeValid(&CborStreamReader::IsArray, reader, kAdComponent,
+                          kArray, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_component_valid_type) {
-            absl::Span<cbor_item_t*> component_ads(
-                cbor_array_handle(ig_entry.value),
-                cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_component_ads() = DecodeStringArray(
-                component_ads, kAdComponentEntry, error_accumulator, fail_fast);
+                reader, kAdComponentEntry, error_accumulator, fail_fast);
           }
           break;
         }
         case 5: {  // Browser signals.
           *buyer_interest_group->mutable_browser_signals() =
-              DecodeBrowserSignals(ig_entry.value, kIgBiddingSignalKeysEntry,
+              DecodeBrowserSignals(reader, kIgBiddingSignalKeysEntry,
                                    error_accumulator, fail_fast);
-          RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
+          break;
         }
+        default:
+          reader.Skip();
       }
+      // The reader is left within the entry when a nested decoder fails fast.
+      RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
     }
   }
 
@@ -27,6 +27,7 @@
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
+#include "services/common/compression/compression_codec.h"
 #include "services/common/util/error_accumulator.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/common/util/scoped_cbor.h"
@@ -171,6 +172,11 @@ bool IsTypeValid(
 // before calling this method.
 std::string DecodeCborString(const cbor_item_t* item);
 
+// Views a cbor string item without copying it. The view is only valid as long
+// as the item is alive. Caller must verify that the item is a string before
+// calling this method.
+absl::string_view CborStringView(const cbor_item_t* item);
+
 // Decodes the key (i.e. owner) in the BuyerInputs in ProtectedAudienceInput
 // and copies the corresponding value (i.e. BuyerInput) as-is. Note: this method
 // doesn't decode the value.
@@ -203,7 +209,7 @@ T DecodeProtectedAuctionInput(cbor_item_t* root,
     }
 
     const int index =
-        FindItemIndex(kRequestRootKeys, DecodeCborString(entry.key));
+        FindItemIndex(kRequestRootKeys, CborStringView(entry.key));
     switch (index) {
       case 0: {  // Schema version.
         bool is_valid_schema_type = IsTypeValid(
@@ -313,6 +319,13 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
                             ErrorAccumulator& error_accumulator,
                             bool fail_fast = true);
 
+// Same as above, for a BuyerInput compressed with `codec` rather than gzip.
+BuyerInput DecodeBuyerInput(absl::string_view owner,
+                            absl::string_view compressed_buyer_input,
+                            const CompressionCodec& codec,
+                            ErrorAccumulator& error_accumulator,
+                            bool fail_fast = true);
+
 // Minimally encodes an unsigned int into CBOR. Caller is responsible for
 // decrementing the reference once done with the returned int.
 cbor_item_t* cbor_build_uint(uint32_t input);
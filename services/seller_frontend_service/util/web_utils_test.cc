@@ -472,6 +472,75 @@ TEST(ChromeRequestUtils, Decode_FailOnMalformedCompresedBytestring) {
       kMalformedCompressedBytestring));
 }
 
+TEST(ChromeRequestUtils, DecodeBuyerInput_SkipsUnrecognizedKeys) {
+  ScopedCbor ig_array(cbor_new_definite_array(1));
+  cbor_item_t* interest_group = cbor_new_definite_map(2);
+  cbor_item_t* unrecognized_value = cbor_new_definite_map(1);
+  cbor_item_t* nested_array = cbor_new_definite_array(2);
+  EXPECT_TRUE(cbor_array_push(nested_array, cbor_move(cbor_build_uint8(1))));
+  EXPECT_TRUE(cbor_array_push(nested_array, cbor_move(cbor_build_uint8(2))));
+  EXPECT_TRUE(cbor_map_add(unrecognized_value,
+                           {cbor_move(cbor_build_string("nested")),
+                            cbor_move(nested_array)}));
+  EXPECT_TRUE(cbor_map_add(interest_group,
+                           {cbor_move(cbor_build_string("unrecognized")),
+                            cbor_move(unrecognized_value)}));
+  EXPECT_TRUE(
+      cbor_map_add(interest_group, BuildStringMapPair(kName, kSampleIgName)));
+  EXPECT_TRUE(cbor_array_push(*ig_array, cbor_move(interest_group)));
+  ScopedCbor ig_bytestring(CompressInterestGroups(ig_array));
+  std::string compressed_buyer_input(
+      reinterpret_cast<char*>(cbor_bytestring_handle(*ig_bytestring)),
+      cbor_bytestring_length(*ig_bytestring));
+
+  ErrorAccumulator error_accumulator(&log_context);
+  BuyerInput buyer_input = DecodeBuyerInput(
+      kSampleIgOwner, compressed_buyer_input, error_accumulator);
+  ASSERT_FALSE(error_accumulator.HasErrors());
+  ASSERT_EQ(buyer_input.interest_groups_size(), 1);
+  EXPECT_EQ(buyer_input.interest_groups(0).name(), kSampleIgName);
+}
+
+TEST(ChromeRequestUtils, DecodeBuyerInput_FailsOnTruncatedCbor) {
+  ScopedCbor ig_array(cbor_new_definite_array(1));
+  EXPECT_TRUE(cbor_array_push(*ig_array, BuildSampleCborInterestGroup()));
+  std::string serialized_ig_array = SerializeCbor(*ig_array);
+  serialized_ig_array.resize(serialized_ig_array.size() / 2);
+  absl::StatusOr<std::string> compressed_buyer_input =
+      GzipCompress(serialized_ig_array);
+  ASSERT_TRUE(compressed_buyer_input.ok());
+
+  ErrorAccumulator error_accumulator(&log_context);
+  DecodeBuyerInput(kSampleIgOwner, *compressed_buyer_input, error_accumulator);
+  ASSERT_TRUE(error_accumulator.HasErrors());
+  EXPECT_TRUE(ContainsClientError(
+      error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE),
+      absl::StrFormat(kInvalidBuyerInputCborError, kSampleIgOwner)));
+}
+
+TEST(ChromeRequestUtils, DecodeBuyerInput_DecompressesWithTheGivenCodec) {
+  ScopedCbor ig_array(cbor_new_definite_array(1));
+  EXPECT_TRUE(cbor_array_push(*ig_array, BuildSampleCborInterestGroup()));
+  const std::string serialized_ig_array = SerializeCbor(*ig_array);
+  std::unique_ptr<CompressionCodec> codec =
+      CreateDeflateCodec(/*dictionary=*/serialized_ig_array);
+  std::string compressed_buyer_input;
+  ASSERT_TRUE(
+      codec->Compress(serialized_ig_array, compressed_buyer_input).ok());
+
+  ErrorAccumulator error_accumulator(&log_context);
+  BuyerInput buyer_input = DecodeBuyerInput(
+      kSampleIgOwner, compressed_buyer_input, *codec, error_accumulator);
+  ASSERT_FALSE(error_accumulator.HasErrors());
+  EXPECT_EQ(buyer_input.interest_groups_size(), 1);
+
+  // The payload cannot be read as gzip.
+  DecodeBuyerInput(kSampleIgOwner, compressed_buyer_input, error_accumulator);
+  EXPECT_TRUE(ContainsClientError(
+      error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE),
+      absl::StrFormat(kMalformedCompressedIgError, kSampleIgOwner)));
+}
+
 TEST(ChromeResponseUtils, VerifyBiddingGroupBuyerOriginOrdering) {
   const std::string interest_group_owner_1 = "ig1";
   const std::string interest_group_owner_2 = "zi";
@@ -0,0 +1,216 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/benchmark_suite/benchmark_comparison.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+double Median(std::vector<double> values) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  const size_t middle = values.size() / 2;
+  return values.size() % 2 == 1 ? values[middle]
+                                : (values[middle - 1] + values[middle]) / 2;
+}
+
+std::string FormatNanos(double ns) {
+  if (ns >= 1e9) {
+    return absl::StrFormat("%.3f s", ns / 1e9);
+  }
+  if (ns >= 1e6) {
+    return absl::StrFormat("%.3f ms", ns / 1e6);
+  }
+  if (ns >= 1e3) {
+    return absl::StrFormat("%.3f us", ns / 1e3);
+  }
+  return absl::StrFormat("%.1f ns", ns);
+}
+
+absl::string_view VerdictName(BenchmarkVerdict verdict) {
+  switch (verdict) {
+    case BenchmarkVerdict::kUnchanged:
+      return "";
+    case BenchmarkVerdict::kRegression:
+      return "REGRESSION";
+    case BenchmarkVerdict::kImprovement:
+      return "improvement";
+    case BenchmarkVerdict::kOnlyInBaseline:
+      return "only in baseline";
+    case BenchmarkVerdict::kOnlyInCandidate:
+      return "only in candidate";
+  }
+  return "";
+}
+
+// "<binary>/<benchmark>" out of the name of a benchmark with its parameters.
+absl::string_view BenchmarkFamily(absl::string_view name) {
+  const size_t binary_end = name.find('/');
+  if (binary_end == absl::string_view::npos) {
+    return name;
+  }
+  return name.substr(0, name.find('/', binary_end + 1));
+}
+
+}  // namespace
+
+MannWhitneyResult MannWhitneyU(absl::Span<const double> a,
+                               absl::Span<const double> b) {
+  const double n1 = a.size();
+  const double n2 = b.size();
+  if (a.size() < 2 || b.size() < 2) {
+    return {};
+  }
+  // Samples with the side they come from, ranked together.
+  std::vector<std::pair<double, bool>> samples;
+  samples.reserve(a.size() + b.size());
+  for (double value : a) {
+    samples.push_back({value, true});
+  }
+  for (double value : b) {
+    samples.push_back({value, false});
+  }
+  std::sort(samples.begin(), samples.end());
+  double rank_sum_a = 0;
+  // Sum of t^3 - t over the groups of t tied samples.
+  double ties = 0;
+  for (size_t start = 0; start < samples.size();) {
+    size_t end = start + 1;
+    while (end < samples.size() && samples[end].first == samples[start].first) {
+      ++end;
+    }
+    // Tied samples share the mean of their ranks, which start at 1.
+    const double rank = (start + 1 + end) / 2.0;
+    for (size_t i = start; i < end; ++i) {
+      if (samples[i].second) {
+        rank_sum_a += rank;
+      }
+    }
+    const double t = end - start;
+    ties += t * t * t - t;
+    start = end;
+  }
+
+  MannWhitneyResult result;
+  result.u = rank_sum_a - n1 * (n1 + 1) / 2;
+  const double n = n1 + n2;
+  const double variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+  if (variance <= 0) {
+    // All the samples are equal.
+    return result;
+  }
+  const double z = std::max(std::abs(result.u - n1 * n2 / 2) - 0.5, 0.0) /
+                   std::sqrt(variance);
+  result.p_value = std::erfc(z / std::sqrt(2.0));
+  return result;
+}
+
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkSamples& baseline, const BenchmarkSamples& candidate,
+    const ComparisonOptions& options) {
+  std::vector<BenchmarkComparison> comparisons;
+  auto baseline_it = baseline.begin();
+  auto candidate_it = candidate.begin();
+  while (baseline_it != baseline.end() || candidate_it != candidate.end()) {
+    BenchmarkComparison comparison;
+    if (candidate_it == candidate.end() ||
+        (baseline_it != baseline.end() &&
+         baseline_it->first < candidate_it->first)) {
+      comparison.name = baseline_it->first;
+      comparison.baseline_median_ns = Median(baseline_it->second);
+      comparison.verdict = BenchmarkVerdict::kOnlyInBaseline;
+      ++baseline_it;
+    } else if (baseline_it == baseline.end() ||
+               candidate_it->first < baseline_it->first) {
+      comparison.name = candidate_it->first;
+      comparison.candidate_median_ns = Median(candidate_it->second);
+      comparison.verdict = BenchmarkVerdict::kOnlyInCandidate;
+      ++candidate_it;
+    } else {
+      comparison.name = baseline_it->first;
+      comparison.baseline_median_ns = Median(baseline_it->second);
+      comparison.candidate_median_ns = Median(candidate_it->second);
+      if (comparison.baseline_median_ns > 0) {
+        comparison.relative_change =
+            (comparison.candidate_median_ns - comparison.baseline_median_ns) /
+            comparison.baseline_median_ns;
+      }
+      comparison.p_value =
+          MannWhitneyU(baseline_it->second, candidate_it->second).p_value;
+      if (comparison.p_value < options.alpha) {
+        if (comparison.relative_change > options.min_relative_change) {
+          comparison.verdict = BenchmarkVerdict::kRegression;
+        } else if (comparison.relative_change < -options.min_relative_change) {
+          comparison.verdict = BenchmarkVerdict::kImprovement;
+        }
+      }
+      ++baseline_it;
+      ++candidate_it;
+    }
+    comparisons.push_back(std::move(comparison));
+  }
+  return comparisons;
+}
+
+std::string FormatComparisons(
+    const std::vector<BenchmarkComparison>& comparisons) {
+  std::string output;
+  // Benchmarks with their number of parameters, regressions and improvements,
+  // in the order of the comparisons.
+  struct FamilyCounts {
+    std::string family;
+    int total = 0;
+    int regressions = 0;
+    int improvements = 0;
+  };
+  std::vector<FamilyCounts> families;
+  for (const BenchmarkComparison& comparison : comparisons) {
+    absl::StrAppendFormat(
+        &output, "%-80s %12s %12s %+7.1f%% p=%.3f %s\n", comparison.name,
+        FormatNanos(comparison.baseline_median_ns),
+        FormatNanos(comparison.candidate_median_ns),
+        comparison.relative_change * 100, comparison.p_value,
+        VerdictName(comparison.verdict));
+    const absl::string_view family = BenchmarkFamily(comparison.name);
+    if (families.empty() || families.back().family != family) {
+      families.push_back({.family = std::string(family)});
+    }
+    FamilyCounts& counts = families.back();
+    ++counts.total;
+    counts.regressions +=
+        comparison.verdict == BenchmarkVerdict::kRegression ? 1 : 0;
+    counts.improvements +=
+        comparison.verdict == BenchmarkVerdict::kImprovement ? 1 : 0;
+  }
+  absl::StrAppend(&output, "\n");
+  for (const FamilyCounts& counts : families) {
+    absl::StrAppendFormat(&output, "%-80s %d of %d regressed, %d improved\n",
+                          counts.family, counts.regressions, counts.total,
+                          counts.improvements);
+  }
+  return output;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
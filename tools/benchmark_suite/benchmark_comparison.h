@@ -0,0 +1,85 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_BENCHMARK_SUITE_BENCHMARK_COMPARISON_H_
+#define TOOLS_BENCHMARK_SUITE_BENCHMARK_COMPARISON_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/types/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Real time in nanoseconds of each repetition of the benchmarks of a run of
+// the suite, by "<binary>/<benchmark>/<parameters>", e.g.
+// "crypto_benchmarks/BM_HpkeEncrypt/1024/threads:1/real_time".
+using BenchmarkSamples = absl::btree_map<std::string, std::vector<double>>;
+
+struct MannWhitneyResult {
+  double u = 0;
+  // Two-sided probability of samples as far apart if both come from the
+  // same distribution.
+  double p_value = 1;
+};
+
+// Mann-Whitney U test of whether `a` and `b` come from the same distribution,
+// which unlike a t-test does not assume benchmark times to be normal. The
+// p-value uses the normal approximation with tie and continuity corrections,
+// which is close enough from about 5 samples on each side. The p-value is 1
+// if either side has fewer than 2 samples.
+MannWhitneyResult MannWhitneyU(absl::Span<const double> a,
+                               absl::Span<const double> b);
+
+struct ComparisonOptions {
+  // Significance level under which a change is not put down to noise.
+  double alpha = 0.05;
+  // Relative change of the median under which a significant change is still
+  // not reported, e.g. 0.02 for 2%.
+  double min_relative_change = 0.02;
+};
+
+enum class BenchmarkVerdict {
+  kUnchanged,
+  kRegression,
+  kImprovement,
+  kOnlyInBaseline,
+  kOnlyInCandidate,
+};
+
+// Comparison of a benchmark with given parameters between two runs.
+struct BenchmarkComparison {
+  std::string name;
+  double baseline_median_ns = 0;
+  double candidate_median_ns = 0;
+  // (candidate - baseline) / baseline, positive when slower.
+  double relative_change = 0;
+  double p_value = 1;
+  BenchmarkVerdict verdict = BenchmarkVerdict::kUnchanged;
+};
+
+// Compares every benchmark of either run, in the order of their names.
+std::vector<BenchmarkComparison> CompareBenchmarks(
+    const BenchmarkSamples& baseline, const BenchmarkSamples& candidate,
+    const ComparisonOptions& options = {});
+
+// A line per benchmark and parameters, then a line per benchmark with the
+// number of its parameters that regressed or improved.
+std::string FormatComparisons(
+    const std::vector<BenchmarkComparison>& comparisons);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_BENCHMARK_SUITE_BENCHMARK_COMPARISON_H_
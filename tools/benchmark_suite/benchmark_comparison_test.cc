@@ -0,0 +1,102 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/benchmark_suite/benchmark_comparison.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(MannWhitneyUTest, SeparatedSamplesDiffer) {
+  const std::vector<double> a = {1, 2, 3, 4, 5};
+  const std::vector<double> b = {6, 7, 8, 9, 10};
+  const MannWhitneyResult result = MannWhitneyU(a, b);
+  EXPECT_EQ(result.u, 0);
+  // As computed by scipy.stats.mannwhitneyu(method="asymptotic").
+  EXPECT_NEAR(result.p_value, 0.01219, 1e-4);
+  EXPECT_NEAR(MannWhitneyU(b, a).p_value, result.p_value, 1e-12);
+  EXPECT_EQ(MannWhitneyU(b, a).u, 25);
+}
+
+TEST(MannWhitneyUTest, InterleavedSamplesDoNotDiffer) {
+  const std::vector<double> a = {1, 3, 5, 7, 9};
+  const std::vector<double> b = {2, 4, 6, 8, 10};
+  EXPECT_GT(MannWhitneyU(a, b).p_value, 0.5);
+}
+
+TEST(MannWhitneyUTest, CorrectsForTies) {
+  const std::vector<double> a = {1, 1, 1, 2, 2};
+  const std::vector<double> b = {2, 2, 3, 3, 3};
+  const MannWhitneyResult result = MannWhitneyU(a, b);
+  EXPECT_EQ(result.u, 2);
+  // As computed by scipy.stats.mannwhitneyu(method="asymptotic").
+  EXPECT_NEAR(result.p_value, 0.02689, 1e-4);
+}
+
+TEST(MannWhitneyUTest, CannotTellWithoutEnoughSamples) {
+  EXPECT_EQ(MannWhitneyU(std::vector<double>{1}, {2, 3, 4}).p_value, 1);
+  EXPECT_EQ(MannWhitneyU(std::vector<double>{5, 5, 5}, {5, 5}).p_value, 1);
+}
+
+TEST(CompareBenchmarksTest, FlagsSignificantChangesOnly) {
+  const BenchmarkSamples baseline = {
+      {"a/BM_X/1", {100, 101, 102, 103, 104}},
+      {"a/BM_X/2", {100, 101, 102, 103, 104}},
+      {"a/BM_X/3", {100, 101, 102, 103, 104}},
+      {"a/BM_Y/1", {100, 101, 102, 103, 104}},
+      {"a/BM_Z", {10, 10}},
+  };
+  const BenchmarkSamples candidate = {
+      {"a/BM_X/1", {120, 121, 122, 123, 124}},
+      {"a/BM_X/2", {80, 81, 82, 83, 84}},
+      {"a/BM_X/3", {100, 102, 101, 104, 103}},
+      // Significant, but within the minimum relative change.
+      {"a/BM_Y/1", {101, 102, 103, 104, 105}},
+      {"b/BM_W", {10, 10}},
+  };
+  const std::vector<BenchmarkComparison> comparisons =
+      CompareBenchmarks(baseline, candidate);
+  ASSERT_EQ(comparisons.size(), 6);
+  EXPECT_EQ(comparisons[0].name, "a/BM_X/1");
+  EXPECT_EQ(comparisons[0].verdict, BenchmarkVerdict::kRegression);
+  EXPECT_NEAR(comparisons[0].relative_change, 20.0 / 102, 1e-9);
+  EXPECT_EQ(comparisons[1].verdict, BenchmarkVerdict::kImprovement);
+  EXPECT_EQ(comparisons[2].verdict, BenchmarkVerdict::kUnchanged);
+  EXPECT_EQ(comparisons[3].verdict, BenchmarkVerdict::kUnchanged);
+  EXPECT_EQ(comparisons[4].name, "a/BM_Z");
+  EXPECT_EQ(comparisons[4].verdict, BenchmarkVerdict::kOnlyInBaseline);
+  EXPECT_EQ(comparisons[5].name, "b/BM_W");
+  EXPECT_EQ(comparisons[5].verdict, BenchmarkVerdict::kOnlyInCandidate);
+}
+
+TEST(FormatComparisonsTest, SummarizesEachBenchmark) {
+  const std::string output = FormatComparisons(CompareBenchmarks(
+      {{"a/BM_X/1", {100, 101, 102, 103, 104}},
+       {"a/BM_X/2", {100, 101, 102, 103, 104}}},
+      {{"a/BM_X/1", {120, 121, 122, 123, 124}},
+       {"a/BM_X/2", {100, 101, 102, 103, 104}}}));
+  EXPECT_THAT(output, HasSubstr("REGRESSION"));
+  EXPECT_THAT(output, HasSubstr("102.0 ns"));
+  EXPECT_THAT(output, HasSubstr("1 of 2 regressed, 0 improved"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
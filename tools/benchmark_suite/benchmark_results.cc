@@ -0,0 +1,211 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/benchmark_suite/benchmark_results.h"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+absl::StatusOr<rapidjson::Document> ParseJson(absl::string_view json) {
+  rapidjson::Document document;
+  document.Parse(json.data(), json.size());
+  if (document.HasParseError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid JSON at offset ", document.GetErrorOffset(), ": ",
+                     rapidjson::GetParseError_En(document.GetParseError())));
+  }
+  if (!document.IsObject()) {
+    return absl::InvalidArgumentError("Expected a JSON object");
+  }
+  return document;
+}
+
+absl::string_view GetString(const rapidjson::Value& object,
+                            absl::string_view name) {
+  auto it = object.FindMember(rapidjson::StringRef(name.data(), name.size()));
+  if (it == object.MemberEnd() || !it->value.IsString()) {
+    return "";
+  }
+  return {it->value.GetString(), it->value.GetStringLength()};
+}
+
+bool GetBool(const rapidjson::Value& object, absl::string_view name) {
+  auto it = object.FindMember(rapidjson::StringRef(name.data(), name.size()));
+  return it != object.MemberEnd() && it->value.IsBool() && it->value.GetBool();
+}
+
+int GetInt(const rapidjson::Value& object, absl::string_view name) {
+  auto it = object.FindMember(rapidjson::StringRef(name.data(), name.size()));
+  if (it == object.MemberEnd() || !it->value.IsNumber()) {
+    return 0;
+  }
+  return static_cast<int>(it->value.GetDouble());
+}
+
+// Nanoseconds in a time unit of Google Benchmark, 0 if unknown.
+double NanosPerUnit(absl::string_view unit) {
+  if (unit == "ns") {
+    return 1;
+  }
+  if (unit == "us") {
+    return 1e3;
+  }
+  if (unit == "ms") {
+    return 1e6;
+  }
+  if (unit == "s") {
+    return 1e9;
+  }
+  return 0;
+}
+
+// The name of a benchmark with its parameters, without the repetitions set
+// in the binary, so that runs with different repetitions compare.
+std::string BenchmarkName(const rapidjson::Value& benchmark) {
+  absl::string_view name = GetString(benchmark, "run_name");
+  if (name.empty()) {
+    name = GetString(benchmark, "name");
+  }
+  std::string result(name);
+  if (const size_t repeats = result.find("/repeats:");
+      repeats != std::string::npos) {
+    const size_t end = result.find('/', repeats + 1);
+    result.erase(repeats, end == std::string::npos ? end : end - repeats);
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<BenchmarkContext> AddBenchmarkOutput(absl::string_view binary,
+                                                    absl::string_view json,
+                                                    BenchmarkSamples& samples) {
+  absl::StatusOr<rapidjson::Document> document = ParseJson(json);
+  if (!document.ok()) {
+    return document.status();
+  }
+  auto benchmarks = document->FindMember("benchmarks");
+  if (benchmarks == document->MemberEnd() || !benchmarks->value.IsArray()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("No benchmarks in the output of ", binary));
+  }
+  for (const rapidjson::Value& benchmark : benchmarks->value.GetArray()) {
+    if (!benchmark.IsObject() ||
+        GetString(benchmark, "run_type") == "aggregate" ||
+        GetBool(benchmark, "error_occurred")) {
+      continue;
+    }
+    auto real_time = benchmark.FindMember("real_time");
+    const double nanos_per_unit =
+        NanosPerUnit(GetString(benchmark, "time_unit"));
+    if (real_time == benchmark.MemberEnd() || !real_time->value.IsNumber() ||
+        nanos_per_unit == 0) {
+      continue;
+    }
+    samples[absl::StrCat(binary, "/", BenchmarkName(benchmark))].push_back(
+        real_time->value.GetDouble() * nanos_per_unit);
+  }
+
+  BenchmarkContext context;
+  if (auto it = document->FindMember("context");
+      it != document->MemberEnd() && it->value.IsObject()) {
+    context.num_cpus = GetInt(it->value, "num_cpus");
+    context.mhz_per_cpu = GetInt(it->value, "mhz_per_cpu");
+    context.cpu_scaling_enabled = GetBool(it->value, "cpu_scaling_enabled");
+    context.debug_build =
+        GetString(it->value, "library_build_type") == "debug";
+  }
+  return context;
+}
+
+std::string MachineTypeOf(const BenchmarkContext& context) {
+  return absl::StrCat(context.num_cpus, "cpu-", context.mhz_per_cpu, "mhz");
+}
+
+std::string SerializeSuiteResults(const SuiteResults& results) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  writer.Key("commit");
+  writer.String(results.commit.data(), results.commit.size());
+  writer.Key("machine_type");
+  writer.String(results.machine_type.data(), results.machine_type.size());
+  writer.Key("benchmarks");
+  writer.StartObject();
+  for (const auto& [name, real_times_ns] : results.samples) {
+    writer.Key(name.data(), name.size());
+    writer.StartArray();
+    for (double real_time_ns : real_times_ns) {
+      writer.Double(real_time_ns);
+    }
+    writer.EndArray();
+  }
+  writer.EndObject();
+  writer.EndObject();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+absl::StatusOr<SuiteResults> ParseSuiteResults(absl::string_view json) {
+  absl::StatusOr<rapidjson::Document> document = ParseJson(json);
+  if (!document.ok()) {
+    return document.status();
+  }
+  SuiteResults results;
+  results.commit = GetString(*document, "commit");
+  results.machine_type = GetString(*document, "machine_type");
+  auto benchmarks = document->FindMember("benchmarks");
+  if (benchmarks == document->MemberEnd() || !benchmarks->value.IsObject()) {
+    return absl::InvalidArgumentError("No benchmarks in the baseline");
+  }
+  for (const auto& benchmark : benchmarks->value.GetObject()) {
+    if (!benchmark.value.IsArray()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid samples of ", benchmark.name.GetString()));
+    }
+    std::vector<double>& real_times_ns =
+        results.samples[std::string(benchmark.name.GetString(),
+                                    benchmark.name.GetStringLength())];
+    for (const rapidjson::Value& real_time_ns : benchmark.value.GetArray()) {
+      if (!real_time_ns.IsNumber()) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Invalid samples of ", benchmark.name.GetString()));
+      }
+      real_times_ns.push_back(real_time_ns.GetDouble());
+    }
+  }
+  return results;
+}
+
+std::string BaselinePath(absl::string_view baseline_dir,
+                         absl::string_view machine_type,
+                         absl::string_view commit) {
+  return (std::filesystem::path(baseline_dir) / machine_type /
+          absl::StrCat(commit, ".json"))
+      .string();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
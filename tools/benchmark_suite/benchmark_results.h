@@ -0,0 +1,68 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_BENCHMARK_SUITE_BENCHMARK_RESULTS_H_
+#define TOOLS_BENCHMARK_SUITE_BENCHMARK_RESULTS_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "tools/benchmark_suite/benchmark_comparison.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Machine a benchmark binary ran on, as reported by Google Benchmark.
+struct BenchmarkContext {
+  int num_cpus = 0;
+  int mhz_per_cpu = 0;
+  // Results are noisier with frequency scaling, and meaningless for a debug
+  // build of the benchmark library.
+  bool cpu_scaling_enabled = false;
+  bool debug_build = false;
+};
+
+// Adds the real time of every repetition in the JSON output of a benchmark
+// binary (--benchmark_format=json) to `samples`, under the name of the
+// benchmark with its parameters prefixed by `binary`. Aggregates and runs
+// that errored are skipped. Returns the context of the run.
+absl::StatusOr<BenchmarkContext> AddBenchmarkOutput(absl::string_view binary,
+                                                    absl::string_view json,
+                                                    BenchmarkSamples& samples);
+
+// Machine type a baseline is recorded for if not given, e.g. "64cpu-2450mhz".
+std::string MachineTypeOf(const BenchmarkContext& context);
+
+// Results of a run of the suite, stored as a baseline.
+struct SuiteResults {
+  std::string commit;
+  std::string machine_type;
+  BenchmarkSamples samples;
+};
+
+// Baselines are JSON objects with the commit, the machine type and the real
+// times in nanoseconds of each benchmark:
+//   {"commit": "abc123", "machine_type": "64cpu-2450mhz",
+//    "benchmarks": {"crypto_benchmarks/BM_HpkeEncrypt/1024": [1.5e4, ...]}}
+std::string SerializeSuiteResults(const SuiteResults& results);
+absl::StatusOr<SuiteResults> ParseSuiteResults(absl::string_view json);
+
+// Path of the baseline of `commit` on `machine_type` under `baseline_dir`.
+std::string BaselinePath(absl::string_view baseline_dir,
+                         absl::string_view machine_type,
+                         absl::string_view commit);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_BENCHMARK_SUITE_BENCHMARK_RESULTS_H_
@@ -0,0 +1,89 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/benchmark_suite/benchmark_results.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+constexpr char kBenchmarkOutput[] = R"json({
+  "context": {
+    "num_cpus": 8,
+    "mhz_per_cpu": 2200,
+    "cpu_scaling_enabled": true,
+    "library_build_type": "release"
+  },
+  "benchmarks": [
+    {"name": "BM_X/8", "run_name": "BM_X/8", "run_type": "iteration",
+     "real_time": 1.5, "time_unit": "us"},
+    {"name": "BM_X/8", "run_name": "BM_X/8", "run_type": "iteration",
+     "real_time": 2.5, "time_unit": "us"},
+    {"name": "BM_X/8_mean", "run_name": "BM_X/8", "run_type": "aggregate",
+     "real_time": 2.0, "time_unit": "us"},
+    {"name": "BM_Y/repeats:2", "run_name": "BM_Y/repeats:2",
+     "run_type": "iteration", "real_time": 3, "time_unit": "ms"},
+    {"name": "BM_Z", "run_type": "iteration", "error_occurred": true,
+     "real_time": 0, "time_unit": "ns"}
+  ]
+})json";
+
+TEST(AddBenchmarkOutputTest, AddsTheRepetitionsInNanoseconds) {
+  BenchmarkSamples samples;
+  absl::StatusOr<BenchmarkContext> context =
+      AddBenchmarkOutput("binary", kBenchmarkOutput, samples);
+  ASSERT_TRUE(context.ok()) << context.status();
+  EXPECT_THAT(samples,
+              ElementsAre(Pair("binary/BM_X/8", ElementsAre(1500, 2500)),
+                          Pair("binary/BM_Y", ElementsAre(3e6))));
+  EXPECT_EQ(context->num_cpus, 8);
+  EXPECT_TRUE(context->cpu_scaling_enabled);
+  EXPECT_FALSE(context->debug_build);
+  EXPECT_EQ(MachineTypeOf(*context), "8cpu-2200mhz");
+}
+
+TEST(AddBenchmarkOutputTest, RejectsInvalidOutput) {
+  BenchmarkSamples samples;
+  EXPECT_FALSE(AddBenchmarkOutput("binary", "not json", samples).ok());
+  EXPECT_FALSE(AddBenchmarkOutput("binary", "{}", samples).ok());
+}
+
+TEST(SuiteResultsTest, RoundTrips) {
+  const SuiteResults results = {
+      .commit = "abc123",
+      .machine_type = "8cpu-2200mhz",
+      .samples = {{"binary/BM_X/8", {1500, 2500}}, {"binary/BM_Y", {3e6}}},
+  };
+  absl::StatusOr<SuiteResults> parsed =
+      ParseSuiteResults(SerializeSuiteResults(results));
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_EQ(parsed->commit, results.commit);
+  EXPECT_EQ(parsed->machine_type, results.machine_type);
+  EXPECT_EQ(parsed->samples, results.samples);
+}
+
+TEST(SuiteResultsTest, KeysBaselinesByMachineTypeAndCommit) {
+  EXPECT_EQ(BaselinePath("/baselines", "8cpu-2200mhz", "abc123"),
+            "/baselines/8cpu-2200mhz/abc123.json");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
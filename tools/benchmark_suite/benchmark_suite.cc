@@ -0,0 +1,211 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runs a set of benchmark binaries with repetitions, pinned to CPUs, records
+// their results as the baseline of a commit on a machine type, and compares
+// them to the baseline of another commit, flagging the benchmarks whose
+// times changed significantly. See README.md.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "services/common/util/cpu_placement.h"
+#include "tools/benchmark_suite/benchmark_comparison.h"
+#include "tools/benchmark_suite/benchmark_results.h"
+
+ABSL_FLAG(std::vector<std::string>, benchmarks, {},
+          "Paths of the benchmark binaries to run, e.g. "
+          "bazel-bin/services/seller_frontend_service/benchmarking/"
+          "select_ad_reactor_benchmarks.");
+ABSL_FLAG(std::string, benchmark_filter, "",
+          "Regex of the benchmarks to run in each binary. All if empty.");
+ABSL_FLAG(int, repetitions, 10,
+          "Repetitions of each benchmark, the samples of the comparison.");
+ABSL_FLAG(std::string, cpus, "",
+          "CPUs to pin the benchmarks to, in the cpuset format, e.g. \"2-5\". "
+          "Not pinned if empty.");
+ABSL_FLAG(std::string, baseline_dir, "",
+          "Directory of the baselines, one JSON file per machine type and "
+          "commit.");
+ABSL_FLAG(std::string, commit, "",
+          "Commit the benchmarks were built at. The results are recorded as "
+          "its baseline if set.");
+ABSL_FLAG(std::string, machine_type, "",
+          "Machine type the baseline is recorded and looked up for. Derived "
+          "from the CPUs and their frequency if empty.");
+ABSL_FLAG(std::string, compare_to, "",
+          "Commit whose baseline on this machine type the results are "
+          "compared to.");
+ABSL_FLAG(double, alpha, 0.05,
+          "Significance level of the Mann-Whitney U test of each benchmark.");
+ABSL_FLAG(double, min_relative_change, 0.02,
+          "Change of the median time under which a benchmark is not flagged.");
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  CHECK(file) << "Could not open " << path;
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+// Runs a benchmark binary with its output written as JSON to `output_path`.
+// The console output of the binary is left on stdout to follow the run.
+void RunBenchmark(const std::string& binary, const std::string& output_path) {
+  std::vector<std::string> args = {
+      binary,
+      absl::StrCat("--benchmark_repetitions=",
+                   absl::GetFlag(FLAGS_repetitions)),
+      absl::StrCat("--benchmark_out=", output_path),
+      "--benchmark_out_format=json",
+  };
+  if (!absl::GetFlag(FLAGS_benchmark_filter).empty()) {
+    args.push_back(absl::StrCat("--benchmark_filter=",
+                                absl::GetFlag(FLAGS_benchmark_filter)));
+  }
+  std::vector<char*> argv;
+  for (std::string& arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+
+  LOG(INFO) << "Running " << binary;
+  const pid_t pid = fork();
+  PCHECK(pid >= 0) << "Could not fork";
+  if (pid == 0) {
+    execv(binary.c_str(), argv.data());
+    PLOG(FATAL) << "Could not run " << binary;
+  }
+  int status = 0;
+  PCHECK(waitpid(pid, &status, 0) == pid);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0)
+      << binary << " failed with status " << status;
+}
+
+void WriteBaseline(const SuiteResults& results) {
+  const std::filesystem::path path =
+      BaselinePath(absl::GetFlag(FLAGS_baseline_dir), results.machine_type,
+                   results.commit);
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream file(path);
+  file << SerializeSuiteResults(results);
+  CHECK(file) << "Could not write " << path;
+  LOG(INFO) << "Recorded the baseline of " << results.commit << " to "
+            << path;
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  using ::privacy_sandbox::bidding_auction_servers::AddBenchmarkOutput;
+  using ::privacy_sandbox::bidding_auction_servers::BaselinePath;
+  using ::privacy_sandbox::bidding_auction_servers::BenchmarkComparison;
+  using ::privacy_sandbox::bidding_auction_servers::BenchmarkContext;
+  using ::privacy_sandbox::bidding_auction_servers::BenchmarkVerdict;
+  using ::privacy_sandbox::bidding_auction_servers::CompareBenchmarks;
+  using ::privacy_sandbox::bidding_auction_servers::FormatComparisons;
+  using ::privacy_sandbox::bidding_auction_servers::MachineTypeOf;
+  using ::privacy_sandbox::bidding_auction_servers::ParseCpuList;
+  using ::privacy_sandbox::bidding_auction_servers::ParseSuiteResults;
+  using ::privacy_sandbox::bidding_auction_servers::ReadFile;
+  using ::privacy_sandbox::bidding_auction_servers::RunBenchmark;
+  using ::privacy_sandbox::bidding_auction_servers::ScopedCpuPlacement;
+  using ::privacy_sandbox::bidding_auction_servers::SuiteResults;
+  using ::privacy_sandbox::bidding_auction_servers::WriteBaseline;
+
+  absl::ParseCommandLine(argc, argv);
+  CHECK(!absl::GetFlag(FLAGS_benchmarks).empty())
+      << "Please specify --benchmarks";
+  CHECK_GT(absl::GetFlag(FLAGS_repetitions), 1)
+      << "The comparison needs several repetitions of each benchmark";
+  const bool record = !absl::GetFlag(FLAGS_commit).empty();
+  const bool compare = !absl::GetFlag(FLAGS_compare_to).empty();
+  CHECK(!(record || compare) || !absl::GetFlag(FLAGS_baseline_dir).empty())
+      << "Please specify --baseline_dir to record or compare baselines";
+
+  absl::StatusOr<std::vector<int>> cpus =
+      ParseCpuList(absl::GetFlag(FLAGS_cpus));
+  CHECK_OK(cpus);
+  SuiteResults results = {.commit = absl::GetFlag(FLAGS_commit)};
+  BenchmarkContext context;
+  {
+    // The benchmark processes inherit the placement.
+    ScopedCpuPlacement placement("benchmarks", *cpus);
+    LOG_IF(WARNING, !placement.status().ok())
+        << "Could not place the benchmarks: " << placement.status();
+    for (const std::string& binary : absl::GetFlag(FLAGS_benchmarks)) {
+      const std::string name =
+          std::filesystem::path(binary).filename().string();
+      const std::string output_path =
+          (std::filesystem::temp_directory_path() /
+           absl::StrCat("benchmark_suite_", getpid(), "_", name, ".json"))
+              .string();
+      RunBenchmark(binary, output_path);
+      absl::StatusOr<BenchmarkContext> binary_context =
+          AddBenchmarkOutput(name, ReadFile(output_path), results.samples);
+      CHECK_OK(binary_context);
+      std::filesystem::remove(output_path);
+      context = *binary_context;
+      LOG_IF(WARNING, context.cpu_scaling_enabled)
+          << "CPU frequency scaling is enabled, " << name
+          << " results will be noisier";
+      LOG_IF(WARNING, context.debug_build)
+          << name << " was built in debug mode, build with -c opt";
+    }
+  }
+  results.machine_type = absl::GetFlag(FLAGS_machine_type).empty()
+                             ? MachineTypeOf(context)
+                             : absl::GetFlag(FLAGS_machine_type);
+  if (record) {
+    WriteBaseline(results);
+  }
+  if (!compare) {
+    return 0;
+  }
+
+  absl::StatusOr<SuiteResults> baseline = ParseSuiteResults(ReadFile(
+      BaselinePath(absl::GetFlag(FLAGS_baseline_dir), results.machine_type,
+                   absl::GetFlag(FLAGS_compare_to))));
+  CHECK_OK(baseline);
+  const std::vector<BenchmarkComparison> comparisons = CompareBenchmarks(
+      baseline->samples, results.samples,
+      {.alpha = absl::GetFlag(FLAGS_alpha),
+       .min_relative_change = absl::GetFlag(FLAGS_min_relative_change)});
+  std::cout << "Compared to " << baseline->commit << " on "
+            << results.machine_type << ":\n"
+            << FormatComparisons(comparisons);
+  const bool regressed =
+      std::any_of(comparisons.begin(), comparisons.end(),
+                  [](const BenchmarkComparison& comparison) {
+                    return comparison.verdict == BenchmarkVerdict::kRegression;
+                  });
+  return regressed ? 1 : 0;
+}
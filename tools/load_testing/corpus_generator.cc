@@ -0,0 +1,93 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Writes corpora of SelectAd, GetBids and ScoreAds requests shaped by a
+// CorpusConfig, for the load generator and the benchmarks to replay.
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "google/protobuf/util/json_util.h"
+#include "tools/load_testing/corpus_config.pb.h"
+#include "tools/load_testing/request_corpus.h"
+#include "tools/load_testing/request_generator.h"
+
+ABSL_FLAG(std::string, config, "",
+          "Path to a CorpusConfig JSON file describing the distributions of "
+          "the requests.");
+ABSL_FLAG(std::string, output_dir, "",
+          "Directory to write select_ad.corpus, get_bids.corpus and "
+          "score_ads.corpus to.");
+ABSL_FLAG(int, num_requests, 1000, "Number of requests of each corpus.");
+ABSL_FLAG(uint64_t, seed, 1, "Seed of the shapes of the requests.");
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+load_testing::CorpusConfig LoadConfig(const std::string& path) {
+  std::ifstream file(path);
+  CHECK(file) << "Could not open " << path;
+  std::stringstream json;
+  json << file.rdbuf();
+  load_testing::CorpusConfig config;
+  CHECK_OK(google::protobuf::util::JsonStringToMessage(json.str(), &config));
+  return config;
+}
+
+void WriteCorpus(RequestCorpusWriter& writer, const std::string& name) {
+  const std::filesystem::path path =
+      std::filesystem::path(absl::GetFlag(FLAGS_output_dir)) / name;
+  CHECK_OK(writer.Write(path.string()));
+  LOG(INFO) << "Wrote " << writer.size() << " requests to " << path;
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  using ::privacy_sandbox::bidding_auction_servers::CorpusRecordType;
+  using ::privacy_sandbox::bidding_auction_servers::LoadConfig;
+  using ::privacy_sandbox::bidding_auction_servers::RequestCorpusWriter;
+  using ::privacy_sandbox::bidding_auction_servers::RequestGenerator;
+  using ::privacy_sandbox::bidding_auction_servers::WriteCorpus;
+
+  absl::ParseCommandLine(argc, argv);
+  CHECK(!absl::GetFlag(FLAGS_config).empty()) << "Please specify --config";
+  CHECK(!absl::GetFlag(FLAGS_output_dir).empty())
+      << "Please specify --output_dir";
+  const int num_requests = absl::GetFlag(FLAGS_num_requests);
+  CHECK_GT(num_requests, 0);
+
+  RequestGenerator generator(LoadConfig(absl::GetFlag(FLAGS_config)),
+                             absl::GetFlag(FLAGS_seed));
+  RequestCorpusWriter select_ad(CorpusRecordType::kSelectAdInputJson);
+  RequestCorpusWriter get_bids(CorpusRecordType::kGetBidsRawRequest);
+  RequestCorpusWriter score_ads(CorpusRecordType::kScoreAdsRawRequest);
+  for (int i = 0; i < num_requests; ++i) {
+    select_ad.Add(generator.GenerateSelectAdInputJson());
+    get_bids.Add(generator.GenerateGetBidsRawRequest().SerializeAsString());
+    score_ads.Add(generator.GenerateScoreAdsRawRequest().SerializeAsString());
+  }
+  std::filesystem::create_directories(absl::GetFlag(FLAGS_output_dir));
+  WriteCorpus(select_ad, "select_ad.corpus");
+  WriteCorpus(get_bids, "get_bids.corpus");
+  WriteCorpus(score_ads, "score_ads.corpus");
+  return 0;
+}
@@ -0,0 +1,124 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/numeric/bits.h"
+#include "absl/strings/str_format.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+// Values below 2^kSubBucketBits are counted exactly. Above, each power of two
+// range is split in 2^(kSubBucketBits - 1) sub-buckets.
+constexpr int kSubBucketBits = 7;
+constexpr int64_t kSubBucketCount = int64_t{1} << kSubBucketBits;
+constexpr int64_t kSubBucketHalfCount = kSubBucketCount / 2;
+constexpr int kMaxValueBits = 40;
+constexpr int64_t kMaxValueUs = (int64_t{1} << kMaxValueBits) - 1;
+constexpr int kNumBuckets =
+    kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalfCount;
+
+int BucketIndex(int64_t value_us) {
+  if (value_us < kSubBucketCount) {
+    return value_us;
+  }
+  const int shift = (64 - absl::countl_zero(static_cast<uint64_t>(value_us))) -
+                    kSubBucketBits;
+  const int64_t sub_bucket = value_us >> shift;
+  return kSubBucketCount + (shift - 1) * kSubBucketHalfCount +
+         (sub_bucket - kSubBucketHalfCount);
+}
+
+// Highest value counted in the bucket at `index`.
+int64_t BucketUpperBound(int index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const int64_t offset = index - kSubBucketCount;
+  const int shift = offset / kSubBucketHalfCount + 1;
+  const int64_t sub_bucket = offset % kSubBucketHalfCount + kSubBucketHalfCount;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram() : counts_(kNumBuckets, 0) {}
+
+void LatencyHistogram::Record(absl::Duration latency) {
+  const int64_t value_us =
+      std::clamp(absl::ToInt64Microseconds(latency), int64_t{0}, kMaxValueUs);
+  ++counts_[BucketIndex(value_us)];
+  ++count_;
+  sum_us_ += value_us;
+  min_us_ = std::min(min_us_, value_us);
+  max_us_ = std::max(max_us_, value_us);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_us_ += other.sum_us_;
+  min_us_ = std::min(min_us_, other.min_us_);
+  max_us_ = std::max(max_us_, other.max_us_);
+}
+
+absl::Duration LatencyHistogram::min() const {
+  return count_ == 0 ? absl::ZeroDuration() : absl::Microseconds(min_us_);
+}
+
+absl::Duration LatencyHistogram::max() const {
+  return absl::Microseconds(max_us_);
+}
+
+absl::Duration LatencyHistogram::mean() const {
+  return count_ == 0 ? absl::ZeroDuration()
+                     : absl::Microseconds(sum_us_) / count_;
+}
+
+absl::Duration LatencyHistogram::ValueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return absl::ZeroDuration();
+  }
+  const double clamped = std::clamp(percentile, 0.0, 100.0);
+  const int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(clamped / 100.0 * count_)));
+  int64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return absl::Microseconds(std::min(BucketUpperBound(i), max_us_));
+    }
+  }
+  return max();
+}
+
+std::string LatencyHistogram::Summary() const {
+  return absl::StrFormat(
+      "count=%d mean=%s p50=%s p90=%s p99=%s p99.9=%s max=%s", count_,
+      absl::FormatDuration(mean()),
+      absl::FormatDuration(ValueAtPercentile(50)),
+      absl::FormatDuration(ValueAtPercentile(90)),
+      absl::FormatDuration(ValueAtPercentile(99)),
+      absl::FormatDuration(ValueAtPercentile(99.9)),
+      absl::FormatDuration(max()));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,64 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_LOAD_TESTING_LATENCY_HISTOGRAM_H_
+#define TOOLS_LOAD_TESTING_LATENCY_HISTOGRAM_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Histogram of latencies with a bounded relative error, in the manner of
+// HdrHistogram: microsecond values are counted in power of two ranges, each
+// split in 64 linear sub-buckets, so any recorded value and percentile is
+// reported within 1.6% of its actual value, whatever its magnitude. Memory is
+// fixed and recording is a couple of shifts. Not thread-safe.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  // Records a latency, clamped to [0, ~12 days].
+  void Record(absl::Duration latency);
+
+  // Adds the counts of `other` to this histogram.
+  void Merge(const LatencyHistogram& other);
+
+  int64_t count() const { return count_; }
+  absl::Duration min() const;
+  absl::Duration max() const;
+  absl::Duration mean() const;
+
+  // Latency under which `percentile` (in [0, 100]) percent of the recorded
+  // latencies fall. The upper bound of the bucket is reported, so the
+  // percentile is never underestimated. Zero if nothing was recorded.
+  absl::Duration ValueAtPercentile(double percentile) const;
+
+  // A line with the count, mean and the usual percentiles of the latencies.
+  std::string Summary() const;
+
+ private:
+  std::vector<int64_t> counts_;
+  int64_t count_ = 0;
+  int64_t sum_us_ = 0;
+  int64_t min_us_ = INT64_MAX;
+  int64_t max_us_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_LOAD_TESTING_LATENCY_HISTOGRAM_H_
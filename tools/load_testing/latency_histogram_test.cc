@@ -0,0 +1,69 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/latency_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(LatencyHistogramTest, ReportsZeroWhenEmpty) {
+  LatencyHistogram histogram;
+
+  EXPECT_EQ(histogram.count(), 0);
+  EXPECT_EQ(histogram.ValueAtPercentile(99), absl::ZeroDuration());
+  EXPECT_EQ(histogram.mean(), absl::ZeroDuration());
+}
+
+TEST(LatencyHistogramTest, CountsSmallValuesExactly) {
+  LatencyHistogram histogram;
+  for (int us = 1; us <= 100; ++us) {
+    histogram.Record(absl::Microseconds(us));
+  }
+
+  EXPECT_EQ(histogram.count(), 100);
+  EXPECT_EQ(histogram.min(), absl::Microseconds(1));
+  EXPECT_EQ(histogram.ValueAtPercentile(50), absl::Microseconds(50));
+  EXPECT_EQ(histogram.ValueAtPercentile(99), absl::Microseconds(99));
+  EXPECT_EQ(histogram.ValueAtPercentile(100), absl::Microseconds(100));
+}
+
+TEST(LatencyHistogramTest, BoundsRelativeErrorOfLargeValues) {
+  LatencyHistogram histogram;
+  for (int ms = 1; ms <= 1000; ++ms) {
+    histogram.Record(absl::Milliseconds(ms));
+  }
+
+  const absl::Duration p90 = histogram.ValueAtPercentile(90);
+  EXPECT_GE(p90, absl::Milliseconds(900));
+  EXPECT_LE(p90, absl::Milliseconds(900) * 1.016);
+  EXPECT_EQ(histogram.ValueAtPercentile(100), absl::Seconds(1));
+}
+
+TEST(LatencyHistogramTest, MergesCounts) {
+  LatencyHistogram fast;
+  LatencyHistogram slow;
+  fast.Record(absl::Milliseconds(1));
+  slow.Record(absl::Seconds(2));
+
+  fast.Merge(slow);
+
+  EXPECT_EQ(fast.count(), 2);
+  EXPECT_EQ(fast.min(), absl::Milliseconds(1));
+  EXPECT_EQ(fast.max(), absl::Seconds(2));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
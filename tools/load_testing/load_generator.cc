@@ -0,0 +1,278 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Open-loop load generator for SFE. Pre-encrypts a corpus of SelectAdRequests
+// the way secure_invoke does and sends them at a fixed rate, regardless of how
+// fast the server responds. Latencies are measured from the time each request
+// was scheduled to be sent, so a stalled server is not hidden by the generator
+// waiting on it (coordinated omission).
+
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.grpc.pb.h"
+#include "services/common/clients/seller_frontend_server/seller_frontend_async_client.h"
+#include "services/common/test/utils/ohttp_utils.h"
+#include "src/encryption/key_fetcher/key_fetcher_utils.h"
+#include "tools/load_testing/latency_histogram.h"
+#include "tools/load_testing/request_corpus.h"
+#include "tools/secure_invoke/flags.h"
+#include "tools/secure_invoke/payload_generator/payload_packaging.h"
+#include "tools/secure_invoke/secure_invoke_lib.h"
+
+ABSL_FLAG(std::vector<std::string>, input_files, {},
+          "Comma separated paths to plaintext SelectAdRequest JSON files, in "
+          "the format accepted by secure_invoke.");
+ABSL_FLAG(std::string, corpus, "",
+          "Path to a select_ad.corpus written by corpus_generator, used "
+          "instead of --input_files.");
+ABSL_FLAG(std::vector<std::string>, client_types, {"browser"},
+          "Comma separated client types (browser, android) to package each "
+          "input file for.");
+ABSL_FLAG(int, corpus_size, 1000,
+          "Number of distinct encrypted requests to prepare before sending. "
+          "Input files and client types are cycled through.");
+ABSL_FLAG(int, rps, 100, "Target requests per second.");
+ABSL_FLAG(absl::Duration, duration, absl::Seconds(60),
+          "How long to send requests for.");
+ABSL_FLAG(int, num_threads, 4,
+          "Number of threads sending requests, each with its own channel.");
+ABSL_FLAG(absl::Duration, request_timeout, absl::Seconds(60),
+          "Deadline of each request.");
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+struct CorpusEntry {
+  SelectAdRequest request;
+  ClientType client_type;
+};
+
+absl::string_view ClientTypeName(ClientType client_type) {
+  return client_type == CLIENT_TYPE_ANDROID ? "app" : "web";
+}
+
+ClientType ParseClientType(absl::string_view client_type) {
+  const std::string upper = absl::AsciiStrToUpper(client_type);
+  if (upper == "ANDROID" || upper == "CLIENT_TYPE_ANDROID") {
+    return CLIENT_TYPE_ANDROID;
+  }
+  CHECK(upper == "BROWSER" || upper == "CLIENT_TYPE_BROWSER")
+      << "Unsupported client type: " << client_type;
+  return CLIENT_TYPE_BROWSER;
+}
+
+HpkeKeyset KeysetFromFlags() {
+  std::string public_key_bytes;
+  CHECK(
+      absl::Base64Unescape(absl::GetFlag(FLAGS_public_key), &public_key_bytes))
+      << "Failed to unescape public key.";
+  std::string private_key_bytes;
+  CHECK(absl::Base64Unescape(absl::GetFlag(FLAGS_private_key),
+                             &private_key_bytes))
+      << "Failed to unescape private key.";
+  std::string id = server_common::ToOhttpKeyId(absl::GetFlag(FLAGS_key_id));
+  return {
+      .public_key = absl::BytesToHexString(public_key_bytes),
+      .private_key = absl::BytesToHexString(private_key_bytes),
+      .key_id = static_cast<uint8_t>(stoi(id)),
+  };
+}
+
+// Encrypts every request ahead of time, so that the cost of packaging does
+// not eat into the send schedule. Each entry is encrypted separately, like
+// requests from distinct clients.
+std::vector<CorpusEntry> BuildCorpus(const HpkeKeyset& keyset) {
+  std::vector<std::string> inputs;
+  if (const std::string corpus_path = absl::GetFlag(FLAGS_corpus);
+      !corpus_path.empty()) {
+    auto input_corpus =
+        RequestCorpus::Open(corpus_path, CorpusRecordType::kSelectAdInputJson);
+    CHECK_OK(input_corpus.status());
+    CHECK_GT((*input_corpus)->size(), 0) << "Empty corpus: " << corpus_path;
+    inputs.reserve((*input_corpus)->size());
+    for (int64_t i = 0; i < (*input_corpus)->size(); ++i) {
+      inputs.emplace_back((*input_corpus)->record(i));
+    }
+  } else {
+    const std::vector<std::string> input_files =
+        absl::GetFlag(FLAGS_input_files);
+    CHECK(!input_files.empty()) << "Please specify --input_files or --corpus";
+    inputs.reserve(input_files.size());
+    for (const auto& input_file : input_files) {
+      inputs.push_back(LoadFile(input_file));
+      CHECK(!inputs.back().empty()) << "Empty or missing input: " << input_file;
+    }
+  }
+  std::vector<ClientType> client_types;
+  for (const auto& client_type : absl::GetFlag(FLAGS_client_types)) {
+    client_types.push_back(ParseClientType(client_type));
+  }
+  CHECK(!client_types.empty()) << "Please specify --client_types";
+
+  const int corpus_size = absl::GetFlag(FLAGS_corpus_size);
+  CHECK_GT(corpus_size, 0);
+  std::vector<CorpusEntry> corpus;
+  corpus.reserve(corpus_size);
+  for (int i = 0; i < corpus_size; ++i) {
+    const ClientType client_type = client_types[i % client_types.size()];
+    auto request = PackagePlainTextSelectAdRequest(
+        inputs[(i / client_types.size()) % inputs.size()], client_type, keyset,
+        absl::GetFlag(FLAGS_enable_debug_reporting),
+        absl::GetFlag(FLAGS_pas_buyer_input_json),
+        absl::GetFlag(FLAGS_enable_unlimited_egress));
+    corpus.push_back(
+        {.request = std::move(*request.first), .client_type = client_type});
+  }
+  return corpus;
+}
+
+// Latencies by client type and response status. Thread-safe.
+class LatencyRecorder {
+ public:
+  void Record(ClientType client_type, absl::StatusCode code,
+              absl::Duration latency) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    histograms_[{std::string(ClientTypeName(client_type)),
+                 absl::StatusCodeToString(code)}]
+        .Record(latency);
+  }
+
+  void Report(absl::Duration elapsed, int num_failed_sends) const
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    std::map<std::string, LatencyHistogram> by_client_type;
+    LatencyHistogram total;
+    for (const auto& [key, histogram] : histograms_) {
+      by_client_type[key.first].Merge(histogram);
+      total.Merge(histogram);
+    }
+    std::cout << "Completed " << total.count() << " requests in " << elapsed
+              << " (" << total.count() / absl::ToDoubleSeconds(elapsed)
+              << " rps), " << num_failed_sends << " could not be sent.\n"
+              << "all: " << total.Summary() << "\n";
+    for (const auto& [client_type, histogram] : by_client_type) {
+      std::cout << client_type << ": " << histogram.Summary() << "\n";
+    }
+    for (const auto& [key, histogram] : histograms_) {
+      std::cout << key.first << " " << key.second << ": "
+                << histogram.Summary() << "\n";
+    }
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  std::map<std::pair<std::string, std::string>, LatencyHistogram> histograms_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// Sends every `num_threads`-th request of the schedule, starting with the
+// `thread_index`-th. Returns once all its requests are done.
+int SendRequests(int thread_index, absl::Time start, absl::Time end,
+                 const std::vector<CorpusEntry>& corpus,
+                 LatencyRecorder& recorder) {
+  const int num_threads = absl::GetFlag(FLAGS_num_threads);
+  const absl::Duration interval = absl::Seconds(1) / absl::GetFlag(FLAGS_rps);
+  const absl::Duration timeout = absl::GetFlag(FLAGS_request_timeout);
+  RequestMetadata metadata = {
+      {"x-bna-client-ip", absl::GetFlag(FLAGS_client_ip)},
+      {"x-user-agent", absl::GetFlag(FLAGS_client_user_agent)},
+      {"x-accept-language", absl::GetFlag(FLAGS_client_accept_language)},
+  };
+  int num_failed_sends = 0;
+  // Waits for the requests in flight when destroyed.
+  SellerFrontEndGrpcClient client({
+      .server_addr = absl::GetFlag(FLAGS_host_addr),
+      .secure_client = !absl::GetFlag(FLAGS_insecure),
+  });
+  for (int64_t i = thread_index;; i += num_threads) {
+    const absl::Time scheduled = start + interval * i;
+    if (scheduled >= end) {
+      break;
+    }
+    absl::SleepFor(scheduled - absl::Now());
+    const CorpusEntry& entry = corpus[i % corpus.size()];
+    absl::Status status = client.Execute(
+        std::make_unique<SelectAdRequest>(entry.request), metadata,
+        [&recorder, scheduled, client_type = entry.client_type](
+            absl::StatusOr<std::unique_ptr<SelectAdResponse>> response) {
+          recorder.Record(client_type, response.status().code(),
+                          absl::Now() - scheduled);
+        },
+        timeout);
+    if (!status.ok()) {
+      ++num_failed_sends;
+    }
+  }
+  return num_failed_sends;
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  using ::privacy_sandbox::bidding_auction_servers::BuildCorpus;
+  using ::privacy_sandbox::bidding_auction_servers::CorpusEntry;
+  using ::privacy_sandbox::bidding_auction_servers::KeysetFromFlags;
+  using ::privacy_sandbox::bidding_auction_servers::LatencyRecorder;
+  using ::privacy_sandbox::bidding_auction_servers::SendRequests;
+
+  absl::ParseCommandLine(argc, argv);
+  CHECK(!absl::GetFlag(FLAGS_host_addr).empty())
+      << "Please specify --host_addr";
+  CHECK(!absl::GetFlag(FLAGS_client_ip).empty())
+      << "Please specify --client_ip";
+  CHECK_GT(absl::GetFlag(FLAGS_rps), 0);
+  const int num_threads = absl::GetFlag(FLAGS_num_threads);
+  CHECK_GT(num_threads, 0);
+
+  const std::vector<CorpusEntry> corpus = BuildCorpus(KeysetFromFlags());
+  LOG(INFO) << "Encrypted " << corpus.size() << " requests, sending "
+            << absl::GetFlag(FLAGS_rps) << " rps for "
+            << absl::GetFlag(FLAGS_duration);
+
+  LatencyRecorder recorder;
+  const absl::Time start = absl::Now();
+  const absl::Time end = start + absl::GetFlag(FLAGS_duration);
+  std::vector<int> num_failed_sends(num_threads, 0);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&, i]() {
+      num_failed_sends[i] = SendRequests(i, start, end, corpus, recorder);
+    });
+  }
+  int total_failed_sends = 0;
+  for (int i = 0; i < num_threads; ++i) {
+    threads[i].join();
+    total_failed_sends += num_failed_sends[i];
+  }
+  recorder.Report(absl::Now() - start, total_failed_sends);
+  return 0;
+}
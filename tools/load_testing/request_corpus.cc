@@ -0,0 +1,136 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/request_corpus.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+constexpr char kMagic[] = "BACORPUS";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  char magic[kMagicSize];
+  uint32_t version;
+  uint32_t type;
+  uint64_t count;
+};
+
+uint64_t OffsetAt(const char* data, int64_t index) {
+  uint64_t offset;
+  std::memcpy(&offset, data + sizeof(Header) + index * sizeof(uint64_t),
+              sizeof(offset));
+  return offset;
+}
+
+}  // namespace
+
+absl::Status RequestCorpusWriter::Write(absl::string_view path) const {
+  Header header;
+  std::memcpy(header.magic, kMagic, kMagicSize);
+  header.version = kVersion;
+  header.type = static_cast<uint32_t>(type_);
+  header.count = records_.size();
+  std::vector<uint64_t> offsets;
+  offsets.reserve(records_.size() + 1);
+  uint64_t offset = sizeof(Header) + (records_.size() + 1) * sizeof(uint64_t);
+  for (const auto& record : records_) {
+    offsets.push_back(offset);
+    offset += record.size();
+  }
+  offsets.push_back(offset);
+
+  std::ofstream file(std::string(path), std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return absl::InternalError(absl::StrCat("Could not open ", path));
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(offsets.data()),
+             offsets.size() * sizeof(uint64_t));
+  for (const auto& record : records_) {
+    file.write(record.data(), record.size());
+  }
+  file.close();
+  if (!file) {
+    return absl::InternalError(absl::StrCat("Could not write ", path));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<RequestCorpus>> RequestCorpus::Open(
+    absl::string_view path, CorpusRecordType type) {
+  const int fd = open(std::string(path).c_str(), O_RDONLY);
+  if (fd < 0) {
+    return absl::NotFoundError(absl::StrCat("Could not open ", path));
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(Header)) {
+    close(fd);
+    return absl::DataLossError(absl::StrCat("Truncated corpus: ", path));
+  }
+  const size_t length = file_stat.st_size;
+  void* mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping outlives the descriptor.
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return absl::InternalError(absl::StrCat("Could not map ", path));
+  }
+  const char* data = static_cast<const char*>(mapping);
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  absl::Status status;
+  if (std::memcmp(header.magic, kMagic, kMagicSize) != 0 ||
+      header.version != kVersion) {
+    status = absl::DataLossError(absl::StrCat("Not a corpus: ", path));
+  } else if (header.type != static_cast<uint32_t>(type)) {
+    status = absl::InvalidArgumentError(
+        absl::StrCat("Corpus ", path, " holds records of type ", header.type,
+                     " instead of ", static_cast<uint32_t>(type)));
+  } else if (sizeof(Header) + (header.count + 1) * sizeof(uint64_t) > length ||
+             OffsetAt(data, header.count) != length) {
+    status = absl::DataLossError(absl::StrCat("Truncated corpus: ", path));
+  }
+  if (!status.ok()) {
+    munmap(mapping, length);
+    return status;
+  }
+  return std::unique_ptr<RequestCorpus>(
+      new RequestCorpus(data, length, header.count));
+}
+
+RequestCorpus::~RequestCorpus() {
+  munmap(const_cast<char*>(data_), length_);
+}
+
+absl::string_view RequestCorpus::record(int64_t index) const {
+  DCHECK(index >= 0 && index < count_);
+  const uint64_t begin = OffsetAt(data_, index);
+  return absl::string_view(data_ + begin, OffsetAt(data_, index + 1) - begin);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,104 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_LOAD_TESTING_REQUEST_CORPUS_H_
+#define TOOLS_LOAD_TESTING_REQUEST_CORPUS_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Kind of the records of a corpus.
+enum class CorpusRecordType : uint32_t {
+  // Plaintext SelectAdRequest JSON, in the format of secure_invoke, so that
+  // it can be encrypted for any key by PackagePlainTextSelectAdRequest.
+  kSelectAdInputJson = 1,
+  // Serialized GetBidsRequest::GetBidsRawRequest.
+  kGetBidsRawRequest = 2,
+  // Serialized ScoreAdsRequest::ScoreAdsRawRequest.
+  kScoreAdsRawRequest = 3,
+};
+
+// Writes a corpus file. The file is laid out to be mapped in memory and read
+// in place:
+//   header:  "BACORPUS", uint32 version, uint32 record type, uint64 count
+//   offsets: uint64[count + 1], from the start of the file
+//   records: the bytes of each record, back to back
+// Integers are in host byte order; the file is not meant to leave the
+// machines of a load test.
+class RequestCorpusWriter {
+ public:
+  explicit RequestCorpusWriter(CorpusRecordType type) : type_(type) {}
+
+  void Add(std::string record) { records_.push_back(std::move(record)); }
+
+  int64_t size() const { return records_.size(); }
+
+  // Writes the records added so far to `path`, replacing it.
+  absl::Status Write(absl::string_view path) const;
+
+ private:
+  CorpusRecordType type_;
+  std::vector<std::string> records_;
+};
+
+// A corpus file mapped in memory. Records are views into the mapping, valid
+// for the lifetime of the corpus, and are never copied. Thread-safe.
+class RequestCorpus {
+ public:
+  // Maps the corpus at `path`, failing if it is malformed or its records are
+  // not of `type`.
+  static absl::StatusOr<std::unique_ptr<RequestCorpus>> Open(
+      absl::string_view path, CorpusRecordType type);
+
+  ~RequestCorpus();
+
+  RequestCorpus(const RequestCorpus&) = delete;
+  RequestCorpus& operator=(const RequestCorpus&) = delete;
+
+  int64_t size() const { return count_; }
+
+  absl::string_view record(int64_t index) const;
+
+  // Parses the record at `index` into a proto.
+  template <typename T>
+  absl::StatusOr<T> Get(int64_t index) const {
+    T message;
+    absl::string_view bytes = record(index);
+    if (!message.ParseFromArray(bytes.data(), bytes.size())) {
+      return absl::DataLossError("Could not parse corpus record");
+    }
+    return message;
+  }
+
+ private:
+  RequestCorpus(const char* data, size_t length, int64_t count)
+      : data_(data), length_(length), count_(count) {}
+
+  const char* data_;
+  size_t length_;
+  int64_t count_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_LOAD_TESTING_REQUEST_CORPUS_H_
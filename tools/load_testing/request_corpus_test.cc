@@ -0,0 +1,97 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/request_corpus.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string TempPath(absl::string_view name) {
+  return (std::filesystem::path(::testing::TempDir()) / std::string(name))
+      .string();
+}
+
+TEST(RequestCorpusTest, ReadsBackWrittenRecords) {
+  const std::string path = TempPath("records.corpus");
+  RequestCorpusWriter writer(CorpusRecordType::kGetBidsRawRequest);
+  writer.Add("first");
+  writer.Add("");
+  writer.Add(std::string("with\0null", 9));
+  ASSERT_TRUE(writer.Write(path).ok());
+
+  auto corpus = RequestCorpus::Open(path, CorpusRecordType::kGetBidsRawRequest);
+
+  ASSERT_TRUE(corpus.ok()) << corpus.status();
+  ASSERT_EQ((*corpus)->size(), 3);
+  EXPECT_EQ((*corpus)->record(0), "first");
+  EXPECT_EQ((*corpus)->record(1), "");
+  EXPECT_EQ((*corpus)->record(2), std::string("with\0null", 9));
+}
+
+TEST(RequestCorpusTest, ReadsEmptyCorpus) {
+  const std::string path = TempPath("empty.corpus");
+  ASSERT_TRUE(RequestCorpusWriter(CorpusRecordType::kScoreAdsRawRequest)
+                  .Write(path)
+                  .ok());
+
+  auto corpus =
+      RequestCorpus::Open(path, CorpusRecordType::kScoreAdsRawRequest);
+
+  ASSERT_TRUE(corpus.ok()) << corpus.status();
+  EXPECT_EQ((*corpus)->size(), 0);
+}
+
+TEST(RequestCorpusTest, RejectsOtherRecordType) {
+  const std::string path = TempPath("select_ad.corpus");
+  RequestCorpusWriter writer(CorpusRecordType::kSelectAdInputJson);
+  writer.Add("{}");
+  ASSERT_TRUE(writer.Write(path).ok());
+
+  EXPECT_EQ(RequestCorpus::Open(path, CorpusRecordType::kGetBidsRawRequest)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(RequestCorpusTest, RejectsTruncatedFile) {
+  const std::string path = TempPath("truncated.corpus");
+  RequestCorpusWriter writer(CorpusRecordType::kSelectAdInputJson);
+  writer.Add("a record long enough to be cut");
+  ASSERT_TRUE(writer.Write(path).ok());
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+
+  EXPECT_EQ(RequestCorpus::Open(path, CorpusRecordType::kSelectAdInputJson)
+                .status()
+                .code(),
+            absl::StatusCode::kDataLoss);
+}
+
+TEST(RequestCorpusTest, RejectsOtherFiles) {
+  const std::string path = TempPath("not_a.corpus");
+  std::ofstream(path) << "This is not a corpus, but it is long enough.";
+
+  EXPECT_EQ(RequestCorpus::Open(path, CorpusRecordType::kSelectAdInputJson)
+                .status()
+                .code(),
+            absl::StatusCode::kDataLoss);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,214 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/request_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "google/protobuf/util/json_util.h"
+#include "services/common/test/random.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+namespace {
+
+using load_testing::CorpusConfig;
+using load_testing::Distribution;
+
+constexpr char kSeller[] = "https://seller.example.com";
+constexpr char kPublisher[] = "publisher.example.com";
+constexpr char kRenderUrlPrefix[] = "https://ads.example.com/";
+// Size of the JSON around the padding of JsonOfSize().
+constexpr int64_t kJsonOverhead = sizeof(R"({"p":""})") - 1;
+
+std::string BuyerOrigin(int index) {
+  return absl::StrCat("https://buyer", index, ".example.com");
+}
+
+std::string ToJson(const google::protobuf::Message& message) {
+  std::string json;
+  CHECK_OK(google::protobuf::util::MessageToJsonString(message, &json));
+  return json;
+}
+
+}  // namespace
+
+RequestGenerator::RequestGenerator(CorpusConfig config, uint64_t seed)
+    : config_(std::move(config)), rng_(seed) {}
+
+int64_t RequestGenerator::Sample(const Distribution& distribution) {
+  switch (distribution.kind_case()) {
+    case Distribution::kConstant:
+      return std::max<int64_t>(distribution.constant(), 0);
+    case Distribution::kUniform: {
+      const auto& uniform = distribution.uniform();
+      return std::uniform_int_distribution<int64_t>(
+          std::max<int64_t>(uniform.min(), 0),
+          std::max(uniform.min(), uniform.max()))(rng_);
+    }
+    case Distribution::kLogNormal: {
+      const auto& log_normal = distribution.log_normal();
+      int64_t sample = std::llround(std::lognormal_distribution<double>(
+          log_normal.mu(), log_normal.sigma())(rng_));
+      if (log_normal.max() > 0) {
+        sample = std::min(sample, log_normal.max());
+      }
+      return std::max(sample, std::max<int64_t>(log_normal.min(), 0));
+    }
+    case Distribution::kEmpirical: {
+      const auto& buckets = distribution.empirical().buckets();
+      if (buckets.empty()) {
+        return 0;
+      }
+      std::vector<double> weights;
+      weights.reserve(buckets.size());
+      for (const auto& bucket : buckets) {
+        weights.push_back(bucket.weight());
+      }
+      const int index = std::discrete_distribution<int>(weights.begin(),
+                                                        weights.end())(rng_);
+      return std::max<int64_t>(buckets[index].value(), 0);
+    }
+    case Distribution::KIND_NOT_SET:
+      return 0;
+  }
+  return 0;
+}
+
+std::string RequestGenerator::JsonOfSize(int64_t size) {
+  return absl::StrCat(R"({"p":")",
+                      std::string(std::max(size - kJsonOverhead, int64_t{0}),
+                                  'x'),
+                      R"("})");
+}
+
+BuyerInput RequestGenerator::GenerateBuyerInput(absl::string_view buyer) {
+  BuyerInput buyer_input;
+  const int64_t num_interest_groups =
+      Sample(config_.interest_groups_per_buyer());
+  const int64_t key_cardinality = config_.bidding_signals_key_cardinality();
+  for (int64_t ig = 0; ig < num_interest_groups; ++ig) {
+    auto* interest_group = buyer_input.add_interest_groups();
+    interest_group->set_name(absl::StrCat("ig_", ig));
+    interest_group->set_origin(buyer);
+    const int64_t num_keys =
+        Sample(config_.bidding_signals_keys_per_interest_group());
+    for (int64_t i = 0; i < num_keys; ++i) {
+      const int64_t key =
+          key_cardinality > 0
+              ? std::uniform_int_distribution<int64_t>(
+                    0, key_cardinality - 1)(rng_)
+              : next_key_++;
+      interest_group->add_bidding_signals_keys(absl::StrCat("key_", key));
+    }
+    const int64_t num_ads = Sample(config_.ads_per_interest_group());
+    for (int64_t ad = 0; ad < num_ads; ++ad) {
+      interest_group->add_ad_render_ids(absl::StrCat("ad_", ig, "_", ad));
+    }
+    const int64_t num_component_ads =
+        Sample(config_.component_ads_per_interest_group());
+    for (int64_t ad = 0; ad < num_component_ads; ++ad) {
+      interest_group->add_component_ads(
+          absl::StrCat("component_", ig, "_", ad));
+    }
+    interest_group->set_user_bidding_signals(
+        JsonOfSize(Sample(config_.user_bidding_signals_size())));
+    *interest_group->mutable_browser_signals() =
+        MakeRandomBrowserSignalsForIG(interest_group->ad_render_ids());
+  }
+  return buyer_input;
+}
+
+std::string RequestGenerator::GenerateSelectAdInputJson() {
+  SelectAdRequest::AuctionConfig auction_config;
+  auction_config.set_seller(kSeller);
+  auction_config.set_seller_signals(
+      JsonOfSize(Sample(config_.seller_signals_size())));
+  auction_config.set_auction_signals(
+      JsonOfSize(Sample(config_.auction_signals_size())));
+  std::vector<std::string> buyer_inputs;
+  const int64_t num_buyers = Sample(config_.buyers_per_auction());
+  for (int64_t buyer = 0; buyer < num_buyers; ++buyer) {
+    const std::string origin = BuyerOrigin(buyer);
+    auction_config.add_buyer_list(origin);
+    (*auction_config.mutable_per_buyer_config())[origin].set_buyer_signals(
+        JsonOfSize(Sample(config_.buyer_signals_size())));
+    buyer_inputs.push_back(absl::StrCat(
+        "\"", origin, "\": ", ToJson(GenerateBuyerInput(origin))));
+  }
+  return absl::StrCat(R"({"auction_config": )", ToJson(auction_config),
+                      R"(, "raw_protected_audience_input": {)",
+                      R"("raw_buyer_input": {)",
+                      absl::StrJoin(buyer_inputs, ", "), R"(}, )",
+                      R"("publisher_name": ")", kPublisher, R"("}})");
+}
+
+GetBidsRequest::GetBidsRawRequest
+RequestGenerator::GenerateGetBidsRawRequest() {
+  GetBidsRequest::GetBidsRawRequest request;
+  const std::string buyer = BuyerOrigin(0);
+  *request.mutable_buyer_input() = GenerateBuyerInput(buyer);
+  request.set_auction_signals(
+      JsonOfSize(Sample(config_.auction_signals_size())));
+  request.set_buyer_signals(JsonOfSize(Sample(config_.buyer_signals_size())));
+  request.set_seller(kSeller);
+  request.set_publisher_name(kPublisher);
+  request.set_client_type(CLIENT_TYPE_BROWSER);
+  return request;
+}
+
+ScoreAdsRequest::ScoreAdsRawRequest
+RequestGenerator::GenerateScoreAdsRawRequest() {
+  ScoreAdsRequest::ScoreAdsRawRequest request;
+  std::vector<std::string> scoring_signals;
+  const int64_t num_bids = Sample(config_.bids_per_score_ads());
+  for (int64_t i = 0; i < num_bids; ++i) {
+    auto* ad_bid = request.add_ad_bids();
+    const std::string render = absl::StrCat(kRenderUrlPrefix, "ad_", i);
+    ad_bid->set_render(render);
+    ad_bid->set_bid(std::uniform_real_distribution<float>(0.01, 10)(rng_));
+    ad_bid->set_interest_group_name(absl::StrCat("ig_", i));
+    ad_bid->set_interest_group_owner(BuyerOrigin(0));
+    ad_bid->set_interest_group_origin(BuyerOrigin(0));
+    google::protobuf::Value metadata;
+    metadata.set_string_value(
+        std::string(Sample(config_.ad_metadata_size()), 'm'));
+    (*ad_bid->mutable_ad()->mutable_struct_value()->mutable_fields())
+        ["metadata"] = std::move(metadata);
+    const int64_t num_component_ads =
+        Sample(config_.component_ads_per_interest_group());
+    for (int64_t ad = 0; ad < num_component_ads; ++ad) {
+      ad_bid->add_ad_components(
+          absl::StrCat(kRenderUrlPrefix, "component_", i, "_", ad));
+    }
+    scoring_signals.push_back(absl::StrCat(
+        "\"", render, "\": ",
+        JsonOfSize(Sample(config_.scoring_signals_size_per_ad()))));
+  }
+  request.set_scoring_signals(absl::StrCat(
+      R"({"renderUrls": {)", absl::StrJoin(scoring_signals, ", "), "}}"));
+  request.set_seller_signals(JsonOfSize(Sample(config_.seller_signals_size())));
+  request.set_auction_signals(
+      JsonOfSize(Sample(config_.auction_signals_size())));
+  request.set_publisher_hostname(kPublisher);
+  return request;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
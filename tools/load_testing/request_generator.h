@@ -0,0 +1,62 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_LOAD_TESTING_REQUEST_GENERATOR_H_
+#define TOOLS_LOAD_TESTING_REQUEST_GENERATOR_H_
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "tools/load_testing/corpus_config.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Generates requests whose counts and sizes follow the distributions of a
+// CorpusConfig, unlike the fixed shapes of services/common/test/random.h.
+// The shapes drawn are reproducible for a given seed. Not thread-safe.
+class RequestGenerator {
+ public:
+  RequestGenerator(load_testing::CorpusConfig config, uint64_t seed);
+
+  // Draws a sample from `distribution`, never negative.
+  int64_t Sample(const load_testing::Distribution& distribution);
+
+  // Plaintext SelectAdRequest in the JSON format of secure_invoke.
+  std::string GenerateSelectAdInputJson();
+
+  // GetBids request of a single buyer, as SFE sends it to BFE.
+  GetBidsRequest::GetBidsRawRequest GenerateGetBidsRawRequest();
+
+  // ScoreAds request with the bids of the auction and their scoring signals,
+  // as SFE sends it to the auction service.
+  ScoreAdsRequest::ScoreAdsRawRequest GenerateScoreAdsRawRequest();
+
+ private:
+  BuyerInput GenerateBuyerInput(absl::string_view buyer);
+
+  // A JSON object of about `size` bytes.
+  std::string JsonOfSize(int64_t size);
+
+  load_testing::CorpusConfig config_;
+  std::mt19937_64 rng_;
+  // Source of unique bidding signals keys when their cardinality is not
+  // bounded.
+  int64_t next_key_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_LOAD_TESTING_REQUEST_GENERATOR_H_
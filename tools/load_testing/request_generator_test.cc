@@ -0,0 +1,122 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/load_testing/request_generator.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "google/protobuf/text_format.h"
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using load_testing::CorpusConfig;
+using load_testing::Distribution;
+
+Distribution ParseDistribution(absl::string_view text) {
+  Distribution distribution;
+  CHECK(google::protobuf::TextFormat::ParseFromString(std::string(text),
+                                                      &distribution));
+  return distribution;
+}
+
+TEST(RequestGeneratorTest, SamplesWithinBounds) {
+  RequestGenerator generator(CorpusConfig(), /*seed=*/1);
+  const Distribution uniform =
+      ParseDistribution("uniform { min: 3 max: 7 }");
+  const Distribution log_normal =
+      ParseDistribution("log_normal { mu: 3 sigma: 2 min: 5 max: 50 }");
+  for (int i = 0; i < 1000; ++i) {
+    const int64_t uniform_sample = generator.Sample(uniform);
+    EXPECT_GE(uniform_sample, 3);
+    EXPECT_LE(uniform_sample, 7);
+    const int64_t log_normal_sample = generator.Sample(log_normal);
+    EXPECT_GE(log_normal_sample, 5);
+    EXPECT_LE(log_normal_sample, 50);
+  }
+  EXPECT_EQ(generator.Sample(Distribution()), 0);
+  EXPECT_EQ(generator.Sample(ParseDistribution("constant: 4")), 4);
+}
+
+TEST(RequestGeneratorTest, SamplesEmpiricalValuesByWeight) {
+  RequestGenerator generator(CorpusConfig(), /*seed=*/1);
+  const Distribution empirical = ParseDistribution(R"pb(
+    empirical {
+      buckets { value: 1 weight: 0 }
+      buckets { value: 2 weight: 3 }
+    })pb");
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(generator.Sample(empirical), 2);
+  }
+}
+
+TEST(RequestGeneratorTest, ShapesGetBidsRequests) {
+  CorpusConfig config;
+  config.mutable_interest_groups_per_buyer()->set_constant(5);
+  config.mutable_bidding_signals_keys_per_interest_group()->set_constant(4);
+  config.set_bidding_signals_key_cardinality(3);
+  config.mutable_ads_per_interest_group()->set_constant(2);
+  config.mutable_user_bidding_signals_size()->set_constant(100);
+  RequestGenerator generator(config, /*seed=*/1);
+
+  const auto request = generator.GenerateGetBidsRawRequest();
+
+  ASSERT_EQ(request.buyer_input().interest_groups_size(), 5);
+  absl::flat_hash_set<std::string> keys;
+  for (const auto& interest_group : request.buyer_input().interest_groups()) {
+    EXPECT_EQ(interest_group.bidding_signals_keys_size(), 4);
+    EXPECT_EQ(interest_group.ad_render_ids_size(), 2);
+    EXPECT_EQ(interest_group.component_ads_size(), 0);
+    EXPECT_EQ(interest_group.user_bidding_signals().size(), 100);
+    keys.insert(interest_group.bidding_signals_keys().begin(),
+                interest_group.bidding_signals_keys().end());
+  }
+  EXPECT_LE(keys.size(), 3);
+}
+
+TEST(RequestGeneratorTest, ShapesScoreAdsRequests) {
+  CorpusConfig config;
+  config.mutable_bids_per_score_ads()->set_constant(10);
+  config.mutable_scoring_signals_size_per_ad()->set_constant(50);
+  RequestGenerator generator(config, /*seed=*/1);
+
+  const auto request = generator.GenerateScoreAdsRawRequest();
+
+  EXPECT_EQ(request.ad_bids_size(), 10);
+  rapidjson::Document scoring_signals;
+  scoring_signals.Parse(request.scoring_signals().c_str());
+  ASSERT_FALSE(scoring_signals.HasParseError());
+  EXPECT_EQ(scoring_signals["renderUrls"].MemberCount(), 10);
+}
+
+TEST(RequestGeneratorTest, GeneratesSelectAdInputJson) {
+  CorpusConfig config;
+  config.mutable_buyers_per_auction()->set_constant(3);
+  config.mutable_interest_groups_per_buyer()->set_constant(2);
+  RequestGenerator generator(config, /*seed=*/1);
+
+  rapidjson::Document input;
+  input.Parse(generator.GenerateSelectAdInputJson().c_str());
+
+  ASSERT_FALSE(input.HasParseError());
+  EXPECT_EQ(input["auction_config"]["buyerList"].Size(), 3);
+  EXPECT_EQ(
+      input["raw_protected_audience_input"]["raw_buyer_input"].MemberCount(),
+      3);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
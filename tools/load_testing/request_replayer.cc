@@ -0,0 +1,268 @@
+// Copyright 2024 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays the requests captured by SFE or BFE in test mode, see
+// services/common/util/request_capture.h, against a server. The plaintext
+// requests are encrypted again with the given test keys and sent at the times
+// they were captured at, optionally sped up or slowed down. Latencies are
+// measured from the time each request was scheduled to be sent, as in
+// load_generator.
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.grpc.pb.h"
+#include "rapidjson/document.h"
+#include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
+#include "services/common/clients/seller_frontend_server/seller_frontend_async_client.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/test/utils/ohttp_utils.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/request_capture.h"
+#include "src/encryption/key_fetcher/fake_key_fetcher_manager.h"
+#include "src/encryption/key_fetcher/key_fetcher_utils.h"
+#include "tools/load_testing/latency_histogram.h"
+#include "tools/secure_invoke/flags.h"
+#include "tools/secure_invoke/payload_generator/payload_packaging.h"
+
+ABSL_FLAG(std::string, capture, "",
+          "Path to the corpus of requests captured by the server with "
+          "--sfe_request_capture_path or --bfe_request_capture_path.");
+ABSL_FLAG(double, time_scale, 1.0,
+          "Speed of the replay relative to the capture, e.g. 2 sends the "
+          "requests twice as fast as they were received.");
+ABSL_FLAG(absl::Duration, request_timeout, absl::Seconds(60),
+          "Deadline of each request.");
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Field of the captured SelectAd requests with their client type, see
+// services/seller_frontend_service/util/select_ad_capture.h.
+constexpr char kClientTypeField[] = "client_type";
+
+using GetBidsRawResponse = GetBidsResponse::GetBidsRawResponse;
+
+struct ReplayedRequest {
+  absl::Duration offset;
+  std::unique_ptr<SelectAdRequest> select_ad_request;
+  std::unique_ptr<GetBidsRequest::GetBidsRawRequest> get_bids_request;
+};
+
+struct Capture {
+  // kSelectAdCaptureKind or kGetBidsCaptureKind, the same for every request.
+  absl::string_view kind;
+  std::vector<ReplayedRequest> requests;
+};
+
+HpkeKeyset KeysetFromFlags() {
+  std::string public_key_bytes;
+  CHECK(
+      absl::Base64Unescape(absl::GetFlag(FLAGS_public_key), &public_key_bytes))
+      << "Failed to unescape public key.";
+  std::string private_key_bytes;
+  CHECK(absl::Base64Unescape(absl::GetFlag(FLAGS_private_key),
+                             &private_key_bytes))
+      << "Failed to unescape private key.";
+  std::string id = server_common::ToOhttpKeyId(absl::GetFlag(FLAGS_key_id));
+  return {
+      .public_key = absl::BytesToHexString(public_key_bytes),
+      .private_key = absl::BytesToHexString(private_key_bytes),
+      .key_id = static_cast<uint8_t>(stoi(id)),
+  };
+}
+
+ClientType GetCapturedClientType(absl::string_view json) {
+  auto document = ParseJsonString(json);
+  CHECK_OK(document.status());
+  ClientType client_type = CLIENT_TYPE_BROWSER;
+  if (document->HasMember(kClientTypeField)) {
+    CHECK(ClientType_Parse((*document)[kClientTypeField].GetString(),
+                           &client_type))
+        << "Unsupported client type: "
+        << (*document)[kClientTypeField].GetString();
+  }
+  return client_type;
+}
+
+// Reads the capture and encrypts its SelectAd requests ahead of time, so that
+// packaging does not delay the replay. GetBids requests are encrypted by the
+// client as they are sent.
+Capture ReadCapture(const HpkeKeyset& keyset) {
+  const std::string path = absl::GetFlag(FLAGS_capture);
+  std::ifstream file(path);
+  CHECK(file.is_open()) << "Unable to open the capture " << path;
+  Capture capture;
+  for (std::string line; std::getline(file, line);) {
+    if (line.empty()) {
+      continue;
+    }
+    absl::StatusOr<CapturedRequest> captured = ParseCapturedRequest(line);
+    CHECK_OK(captured.status());
+    CHECK(captured->kind == kSelectAdCaptureKind ||
+          captured->kind == kGetBidsCaptureKind)
+        << "Unsupported kind of request: " << captured->kind;
+    if (capture.requests.empty()) {
+      capture.kind = captured->kind == kSelectAdCaptureKind
+                         ? kSelectAdCaptureKind
+                         : kGetBidsCaptureKind;
+    }
+    CHECK_EQ(captured->kind, capture.kind)
+        << "Requests of different servers can't be replayed together";
+    ReplayedRequest request = {.offset = captured->offset};
+    if (capture.kind == kSelectAdCaptureKind) {
+      request.select_ad_request =
+          std::move(PackagePlainTextSelectAdRequest(
+                        captured->json, GetCapturedClientType(captured->json),
+                        keyset, absl::GetFlag(FLAGS_enable_debug_reporting),
+                        /*protected_app_signals_json=*/"",
+                        absl::GetFlag(FLAGS_enable_unlimited_egress))
+                        .first);
+    } else {
+      request.get_bids_request =
+          std::make_unique<GetBidsRequest::GetBidsRawRequest>();
+      auto status = google::protobuf::util::JsonStringToMessage(
+          captured->json, request.get_bids_request.get());
+      CHECK(status.ok()) << status;
+    }
+    capture.requests.push_back(std::move(request));
+  }
+  CHECK(!capture.requests.empty()) << "Empty capture: " << path;
+  return capture;
+}
+
+// Latencies by response status. Thread-safe.
+class LatencyRecorder {
+ public:
+  void Record(absl::StatusCode code, absl::Duration latency)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    histograms_[absl::StatusCodeToString(code)].Record(latency);
+  }
+
+  void Report(absl::Duration captured, absl::Duration elapsed,
+              int num_failed_sends) const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    LatencyHistogram total;
+    for (const auto& [code, histogram] : histograms_) {
+      total.Merge(histogram);
+    }
+    std::cout << "Replayed " << total.count() << " requests captured over "
+              << captured << " in " << elapsed << ", " << num_failed_sends
+              << " could not be sent.\n"
+              << "all: " << total.Summary() << "\n";
+    for (const auto& [code, histogram] : histograms_) {
+      std::cout << code << ": " << histogram.Summary() << "\n";
+    }
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  std::map<std::string, LatencyHistogram> histograms_ ABSL_GUARDED_BY(mu_);
+};
+
+void Replay() {
+  const double time_scale = absl::GetFlag(FLAGS_time_scale);
+  CHECK_GT(time_scale, 0);
+
+  const HpkeKeyset keyset = KeysetFromFlags();
+  Capture capture = ReadCapture(keyset);
+  const absl::string_view kind = capture.kind;
+  std::vector<ReplayedRequest>& requests = capture.requests;
+  LOG(INFO) << "Replaying " << requests.size() << " " << kind << " requests";
+
+  const absl::Duration timeout = absl::GetFlag(FLAGS_request_timeout);
+  RequestMetadata metadata = {
+      {"x-bna-client-ip", absl::GetFlag(FLAGS_client_ip)},
+      {"x-user-agent", absl::GetFlag(FLAGS_client_user_agent)},
+      {"x-accept-language", absl::GetFlag(FLAGS_client_accept_language)},
+  };
+  SellerFrontEndGrpcClient sfe_client({
+      .server_addr = absl::GetFlag(FLAGS_host_addr),
+      .secure_client = !absl::GetFlag(FLAGS_insecure),
+  });
+  server_common::FakeKeyFetcherManager key_fetcher_manager(
+      keyset.public_key, "unused", std::to_string(keyset.key_id));
+  auto crypto_client = CreateCryptoClient();
+  BuyerFrontEndAsyncGrpcClient bfe_client(
+      &key_fetcher_manager, crypto_client.get(),
+      {.server_addr = absl::GetFlag(FLAGS_host_addr),
+       .secure_client = !absl::GetFlag(FLAGS_insecure)});
+
+  LatencyRecorder recorder;
+  absl::BlockingCounter pending(requests.size());
+  int num_failed_sends = 0;
+  const absl::Time start = absl::Now();
+  for (ReplayedRequest& request : requests) {
+    const absl::Time scheduled = start + request.offset / time_scale;
+    absl::SleepFor(scheduled - absl::Now());
+    absl::Status status;
+    if (kind == kSelectAdCaptureKind) {
+      status = sfe_client.Execute(
+          std::move(request.select_ad_request), metadata,
+          [&recorder, &pending, scheduled](
+              absl::StatusOr<std::unique_ptr<SelectAdResponse>> response) {
+            recorder.Record(response.status().code(), absl::Now() - scheduled);
+            pending.DecrementCount();
+          },
+          timeout);
+    } else {
+      status = bfe_client.ExecuteInternal(
+          std::move(request.get_bids_request), metadata,
+          [&recorder, &pending, scheduled](
+              absl::StatusOr<std::unique_ptr<GetBidsRawResponse>> response) {
+            recorder.Record(response.status().code(), absl::Now() - scheduled);
+            pending.DecrementCount();
+          },
+          timeout);
+    }
+    if (!status.ok()) {
+      ++num_failed_sends;
+      pending.DecrementCount();
+    }
+  }
+  pending.Wait();
+  recorder.Report(requests.back().offset, absl::Now() - start,
+                  num_failed_sends);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  CHECK(!absl::GetFlag(FLAGS_host_addr).empty())
+      << "Please specify --host_addr";
+  CHECK(!absl::GetFlag(FLAGS_client_ip).empty())
+      << "Please specify --client_ip";
+  privacy_sandbox::bidding_auction_servers::Replay();
+  return 0;
+}